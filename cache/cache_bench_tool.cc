@@ -4,6 +4,7 @@
 //  (found in the LICENSE.Apache file in the root directory).
 
 #ifdef GFLAGS
+#include <array>
 #include <cinttypes>
 #include <cstddef>
 #include <cstdio>
@@ -25,8 +26,10 @@
 #include "rocksdb/secondary_cache.h"
 #include "rocksdb/system_clock.h"
 #include "rocksdb/table_properties.h"
+#include "rocksdb/trace_reader_writer.h"
 #include "table/block_based/block_based_table_reader.h"
 #include "table/block_based/cachable_entry.h"
+#include "trace_replay/block_cache_tracer.h"
 #include "util/coding.h"
 #include "util/distributed_mutex.h"
 #include "util/gflags_compat.h"
@@ -119,6 +122,16 @@ DEFINE_string(secondary_cache_uri, "",
 
 DEFINE_string(cache_type, "lru_cache", "Type of block cache.");
 
+DEFINE_string(block_cache_trace_file, "",
+              "If set, replay the block accesses of a trace recorded with "
+              "DB::StartBlockCacheTrace rather than generating operations. "
+              "The blocks are divided among the threads, and -cache_type, "
+              "-cache_size and -secondary_cache_uri still apply.");
+
+DEFINE_double(trace_replay_speedup, 0.0,
+              "Replay the trace this many times faster than it was recorded. "
+              "0 = as fast as possible.");
+
 DEFINE_bool(use_jemalloc_no_dump_allocator, false,
             "Whether to use JemallocNoDumpAllocator");
 
@@ -332,6 +345,55 @@ Cache::CacheItemHelper helper3_wos(CacheEntryRole::kFilterBlock, DeleteFn);
 Cache::CacheItemHelper helper3(CacheEntryRole::kFilterBlock, DeleteFn, SizeFn,
                                SaveToFn, CreateFn, &helper3_wos);
 
+// A replayed block access. Trace values start with their size, for the
+// secondary cache callbacks.
+struct TraceAccess {
+  // Since the first access of the trace
+  uint64_t time_us;
+  std::array<char, kCacheKeySize> key;
+  const Cache::CacheItemHelper* helper;
+  uint32_t charge;
+  Cache::Priority priority;
+  bool no_insert;
+};
+
+Cache::ObjectPtr createTraceValue(Random64& rnd, size_t size,
+                                  MemoryAllocator* alloc) {
+  size = std::max(size, sizeof(uint64_t));
+  char* rv = AllocateBlock(size, alloc).release();
+  EncodeFixed64(rv, size);
+  for (size_t i = sizeof(uint64_t); i + sizeof(uint64_t) <= size;
+       i += sizeof(uint64_t)) {
+    EncodeFixed64(rv + i, rnd.Next());
+  }
+  return rv;
+}
+
+size_t TraceSizeFn(Cache::ObjectPtr obj) {
+  return DecodeFixed64(static_cast<char*>(obj));
+}
+
+Cache::CacheItemHelper trace_data_helper_wos(CacheEntryRole::kDataBlock,
+                                             DeleteFn);
+Cache::CacheItemHelper trace_data_helper(CacheEntryRole::kDataBlock, DeleteFn,
+                                         TraceSizeFn, SaveToFn, CreateFn,
+                                         &trace_data_helper_wos);
+Cache::CacheItemHelper trace_index_helper_wos(CacheEntryRole::kIndexBlock,
+                                              DeleteFn);
+Cache::CacheItemHelper trace_index_helper(CacheEntryRole::kIndexBlock,
+                                          DeleteFn, TraceSizeFn, SaveToFn,
+                                          CreateFn, &trace_index_helper_wos);
+Cache::CacheItemHelper trace_filter_helper_wos(CacheEntryRole::kFilterBlock,
+                                               DeleteFn);
+Cache::CacheItemHelper trace_filter_helper(CacheEntryRole::kFilterBlock,
+                                           DeleteFn, TraceSizeFn, SaveToFn,
+                                           CreateFn, &trace_filter_helper_wos);
+Cache::CacheItemHelper trace_other_helper_wos(CacheEntryRole::kOtherBlock,
+                                              DeleteFn);
+Cache::CacheItemHelper trace_other_helper(CacheEntryRole::kOtherBlock,
+                                          DeleteFn, TraceSizeFn, SaveToFn,
+                                          CreateFn, &trace_other_helper_wos);
+
 void ConfigureSecondaryCache(ShardedCacheOptions& opts) {
   if (!FLAGS_secondary_cache_uri.empty()) {
     std::shared_ptr<SecondaryCache> secondary_cache;
@@ -427,6 +489,79 @@ class CacheBench {
 
   ~CacheBench() = default;
 
+  // Loads the accesses of FLAGS_block_cache_trace_file, dividing them among
+  // the threads by block so that each block is accessed in trace order.
+  void LoadTrace() {
+    std::unique_ptr<TraceReader> trace_reader;
+    Status s = NewFileTraceReader(Env::Default(), EnvOptions(),
+                                  FLAGS_block_cache_trace_file, &trace_reader);
+    BlockCacheTraceReader reader(std::move(trace_reader));
+    BlockCacheTraceHeader header;
+    if (s.ok()) {
+      s = reader.ReadHeader(&header);
+    }
+    if (!s.ok()) {
+      fprintf(stderr, "Failed to open block cache trace %s: %s\n",
+              FLAGS_block_cache_trace_file.c_str(), s.ToString().c_str());
+      exit(1);
+    }
+    trace_accesses_.resize(FLAGS_threads);
+    uint64_t first_time_us = 0;
+    uint64_t traced_hits = 0;
+    for (;;) {
+      BlockCacheTraceRecord record;
+      if (!reader.ReadAccess(&record).ok()) {
+        // End of trace
+        break;
+      }
+      if (num_trace_accesses_ == 0) {
+        first_time_us = record.access_timestamp;
+      }
+      TraceAccess access;
+      access.time_us =
+          record.access_timestamp - std::min(record.access_timestamp,
+                                             first_time_us);
+      if (record.block_key.size() == kCacheKeySize) {
+        memcpy(access.key.data(), record.block_key.data(), kCacheKeySize);
+      } else {
+        uint64_t hi, lo;
+        Hash2x64(record.block_key.data(), record.block_key.size(), &hi, &lo);
+        EncodeFixed64(access.key.data(), lo);
+        EncodeFixed64(access.key.data() + 8, hi);
+      }
+      access.priority = Cache::Priority::HIGH;
+      switch (record.block_type) {
+        case TraceType::kBlockTraceDataBlock:
+          access.helper = &trace_data_helper;
+          access.priority = Cache::Priority::LOW;
+          break;
+        case TraceType::kBlockTraceIndexBlock:
+          access.helper = &trace_index_helper;
+          break;
+        case TraceType::kBlockTraceFilterBlock:
+          access.helper = &trace_filter_helper;
+          break;
+        default:
+          access.helper = &trace_other_helper;
+          break;
+      }
+      access.charge = static_cast<uint32_t>(record.block_size);
+      access.no_insert = record.no_insert;
+      traced_hits += record.is_cache_hit;
+      uint32_t thread = FastRange32(
+          Lower32of64(Hash64(access.key.data(), kCacheKeySize)), FLAGS_threads);
+      trace_accesses_[thread].push_back(access);
+      ++num_trace_accesses_;
+    }
+    if (num_trace_accesses_ == 0) {
+      fprintf(stderr, "No block accesses in trace %s\n",
+              FLAGS_block_cache_trace_file.c_str());
+      exit(1);
+    }
+    printf("Trace loaded (%" PRIu64 " accesses, traced hit ratio %g)\n",
+           num_trace_accesses_, 1.0 * traced_hits / num_trace_accesses_);
+  }
+
   void PopulateCache() {
     Random64 rnd(FLAGS_seed);
     KeyGen keygen;
@@ -517,8 +652,11 @@ class CacheBench {
     // Wall clock time - includes idle time if threads
     // finish at different times (not ideal).
     double elapsed_secs = static_cast<double>(end_time - start_time) * 1e-6;
-    uint32_t ops_per_sec = static_cast<uint32_t>(
-        1.0 * FLAGS_threads * FLAGS_ops_per_thread / elapsed_secs);
+    const uint64_t total_ops = IsReplayingTrace()
+                                   ? num_trace_accesses_
+                                   : FLAGS_threads * FLAGS_ops_per_thread;
+    uint32_t ops_per_sec =
+        static_cast<uint32_t>(1.0 * total_ops / elapsed_secs);
     printf("Complete in %.3f s; Rough parallel ops/sec = %u\n", elapsed_secs,
            ops_per_sec);
 
@@ -527,8 +665,7 @@ class CacheBench {
     for (uint32_t i = 0; i < FLAGS_threads; i++) {
       elapsed_secs += threads[i]->duration_us * 1e-6;
     }
-    ops_per_sec = static_cast<uint32_t>(1.0 * FLAGS_threads *
-                                        FLAGS_ops_per_thread / elapsed_secs);
+    ops_per_sec = static_cast<uint32_t>(1.0 * total_ops / elapsed_secs);
     printf("Thread ops/sec = %u\n", ops_per_sec);
 
     printf("Lookup hit ratio: %g\n", shared.GetLookupHitRatio());
@@ -573,6 +710,11 @@ class CacheBench {
   const uint64_t blind_insert_threshold_;
   const uint64_t lookup_threshold_;
   const uint64_t erase_threshold_;
+  // Per thread, when replaying a trace
+  std::vector<std::vector<TraceAccess>> trace_accesses_;
+  uint64_t num_trace_accesses_ = 0;
+
+  bool IsReplayingTrace() const { return num_trace_accesses_ > 0; }
 
   // A benchmark version of gathering stats on an active block cache by
   // iterating over it. The primary purpose is to measure the impact of
@@ -669,7 +811,11 @@ class CacheBench {
         shared->GetCondVar()->Wait();
       }
     }
-    thread->shared->GetCacheBench()->OperateCache(thread);
+    if (thread->shared->GetCacheBench()->IsReplayingTrace()) {
+      thread->shared->GetCacheBench()->ReplayTrace(thread);
+    } else {
+      thread->shared->GetCacheBench()->OperateCache(thread);
+    }
 
     {
       MutexLock l(shared->GetMutex());
@@ -806,6 +952,53 @@ class CacheBench {
     thread->duration_us = clock->NowMicros() - start_time;
   }
 
+  void ReplayTrace(ThreadState* thread) {
+    uint64_t lookup_misses = 0;
+    uint64_t lookup_hits = 0;
+    const auto clock = SystemClock::Default().get();
+    uint64_t start_time = clock->NowMicros();
+    StopWatchNano timer(clock);
+
+    for (const TraceAccess& access : trace_accesses_[thread->tid]) {
+      if (FLAGS_trace_replay_speedup > 0.0) {
+        uint64_t due = start_time + static_cast<uint64_t>(
+                                        access.time_us /
+                                        FLAGS_trace_replay_speedup);
+        uint64_t now = clock->NowMicros();
+        if (due > now) {
+          clock->SleepForMicroseconds(static_cast<int>(due - now));
+        }
+      }
+      if (FLAGS_histograms) {
+        timer.Start();
+      }
+      Slice key(access.key.data(), access.key.size());
+      auto handle = cache_->Lookup(key, access.helper, /*context*/ nullptr,
+                                   access.priority);
+      if (handle) {
+        ++lookup_hits;
+        cache_->Release(handle);
+      } else {
+        ++lookup_misses;
+        if (!access.no_insert) {
+          Status s = cache_->Insert(
+              key,
+              createTraceValue(thread->rnd, access.charge,
+                               cache_->memory_allocator()),
+              access.helper, access.charge, /*handle=*/nullptr,
+              access.priority);
+          assert(s.ok());
+        }
+      }
+      if (FLAGS_histograms) {
+        thread->latency_ns_hist.Add(timer.ElapsedNanos());
+      }
+    }
+    thread->shared->AddLookupStats(lookup_hits, lookup_misses,
+                                   /*pinned_count=*/0);
+    thread->duration_us = clock->NowMicros() - start_time;
+  }
+
   void PrintEnv() const {
 #if defined(__GNUC__) && !defined(__OPTIMIZE__)
     printf(
@@ -819,7 +1012,14 @@ class CacheBench {
     printf("Cache impl name     : %s\n", cache_->Name());
     printf("DMutex impl name    : %s\n", DMutex::kName());
     printf("Number of threads   : %u\n", FLAGS_threads);
-    printf("Ops per thread      : %" PRIu64 "\n", FLAGS_ops_per_thread);
+    if (IsReplayingTrace()) {
+      printf("Block cache trace   : %s\n",
+             FLAGS_block_cache_trace_file.c_str());
+      printf("Trace accesses      : %" PRIu64 "\n", num_trace_accesses_);
+      printf("Replay speedup      : %g\n", FLAGS_trace_replay_speedup);
+    } else {
+      printf("Ops per thread      : %" PRIu64 "\n", FLAGS_ops_per_thread);
+    }
     printf("Cache size          : %s\n",
            BytesToHumanString(FLAGS_cache_size).c_str());
     printf("Num shard bits      : %d\n",
@@ -1163,7 +1363,10 @@ int cache_bench_tool(int argc, char** argv) {
   }
 
   ROCKSDB_NAMESPACE::CacheBench bench;
-  if (FLAGS_populate_cache) {
+  if (!FLAGS_block_cache_trace_file.empty()) {
+    // The trace starts from whatever it finds, so nothing to populate
+    bench.LoadTrace();
+  } else if (FLAGS_populate_cache) {
     bench.PopulateCache();
   }
   if (bench.Run()) {
@@ -22,14 +22,20 @@
 #include <string>
 #include <thread>
 #include <type_traits>
+#ifdef NUMA
+#include <numa.h>
+#endif
 
 #include "cache/cache_key.h"
+#include "cache/compressed_tier_cache.h"
 #include "cache/secondary_cache_adapter.h"
 #include "logging/logging.h"
 #include "monitoring/perf_context_imp.h"
 #include "monitoring/statistics_impl.h"
 #include "port/lang.h"
 #include "rocksdb/env.h"
+#include "test_util/sync_point.h"
+#include "util/coding.h"
 #include "util/hash.h"
 #include "util/math.h"
 #include "util/random.h"
@@ -730,6 +736,11 @@ FixedHyperClockTable::FixedHyperClockTable(
       occupancy_limit_(static_cast<size_t>((uint64_t{1} << length_bits_) *
                                            kStrictLoadFactor)),
       array_(new HandleImpl[size_t{1} << length_bits_]) {
+  if (opts.numa_group != 0) {
+    for (size_t i = 0; i < GetTableSize(); i++) {
+      array_[i].numa_group = opts.numa_group;
+    }
+  }
   if (metadata_charge_policy ==
       CacheMetadataChargePolicy::kFullChargeCacheMetadata) {
     usage_.FetchAddRelaxed(size_t{GetTableSize()} * sizeof(HandleImpl));
@@ -1418,12 +1429,57 @@ BaseHyperClockCache<Table>::BaseHyperClockCache(
   // get to table entries
   size_t per_shard = this->GetPerShardCapacity();
   MemoryAllocator* alloc = this->memory_allocator();
+  if (Table::kSupportsNumaGroups && opts.numa_local_shards) {
+#ifdef NUMA
+    if (numa_available() >= 0 && numa_max_node() > 0) {
+      numa_group_bits_ = std::min(FloorLog2(numa_max_node() + 1), 8);
+      int num_cpus = numa_num_configured_cpus();
+      cpu_numa_groups_.resize(std::max(num_cpus, 0));
+      for (int cpu = 0; cpu < num_cpus; cpu++) {
+        int node = numa_node_of_cpu(cpu);
+        cpu_numa_groups_[cpu] = static_cast<uint8_t>(
+            node >= 0 ? node & ((1 << numa_group_bits_) - 1) : 0);
+      }
+    }
+#endif
+    TEST_SYNC_POINT_CALLBACK("BaseHyperClockCache::NumaGroupBits",
+                             &numa_group_bits_);
+    numa_group_bits_ = std::min(numa_group_bits_, this->GetNumShardBits());
+  }
+  numa_group_shift_ = this->GetNumShardBits() - numa_group_bits_;
+  numa_within_group_mask_ = this->shard_mask_ >> numa_group_bits_;
+  Shard* first_shard = &this->GetShardAt(0);
   this->InitShards([&](Shard* cs) {
     typename Table::Opts table_opts{opts};
+    table_opts.numa_group = static_cast<uint8_t>(
+        static_cast<uint32_t>(cs - first_shard) >> numa_group_shift_);
+#ifdef NUMA
+    // Fault in the table on the node of the group
+    if (numa_group_bits_ > 0) {
+      numa_set_preferred(table_opts.numa_group);
+    }
+#endif
     new (cs) Shard(per_shard, opts.strict_capacity_limit,
                    opts.metadata_charge_policy, alloc,
                    &this->eviction_callback_, &this->hash_seed_, table_opts);
   });
+#ifdef NUMA
+  if (numa_group_bits_ > 0) {
+    numa_set_localalloc();
+  }
+#endif
+}
+
+template <class Table>
+uint32_t BaseHyperClockCache<Table>::GetLocalNumaGroup() const {
+  uint32_t group = 0;
+  int cpu = port::PhysicalCoreID();
+  if (cpu >= 0 && static_cast<size_t>(cpu) < cpu_numa_groups_.size()) {
+    group = cpu_numa_groups_[cpu];
+  }
+  TEST_SYNC_POINT_CALLBACK("BaseHyperClockCache::GetLocalNumaGroup", &group);
+  assert(group < GetNumNumaGroups());
+  return group;
 }
 
 template <class Table>
@@ -1559,6 +1615,155 @@ void BaseHyperClockCache<Table>::ReportProblems(
   }
 }
 
+FixedHyperClockCache::FixedHyperClockCache(const HyperClockCacheOptions& opts)
+    : BaseHyperClockCache(opts),
+      numa_duplicate_ratio_(numa_group_bits_ > 0 ? opts.numa_duplicate_ratio
+                                                 : 0.0) {
+  if (numa_duplicate_ratio_ > 0.0) {
+    numa_group_charges_.reset(new NumaGroupCharges[GetNumNumaGroups()]);
+  }
+}
+
+Status FixedHyperClockCache::Insert(const Slice& key, ObjectPtr obj,
+                                    const CacheItemHelper* helper,
+                                    size_t charge, Handle** handle,
+                                    Priority priority,
+                                    const Slice& compressed_value,
+                                    CompressionType type) {
+  if (numa_group_bits_ == 0) {
+    return BaseHyperClockCache::Insert(key, obj, helper, charge, handle,
+                                       priority, compressed_value, type);
+  }
+  assert(helper);
+  HashVal hash = Shard::ComputeHash(key, hash_seed_);
+  uint32_t group = GetLocalNumaGroup();
+  auto h_out = reinterpret_cast<HandleImpl**>(handle);
+  Status s = GetNumaShard(group, hash).Insert(key, hash, obj, helper, charge,
+                                              h_out, priority);
+  if (h_out && *h_out && (*h_out)->IsStandalone()) {
+    (*h_out)->numa_group = static_cast<uint8_t>(group);
+  }
+  if (numa_group_charges_ && s.ok()) {
+    numa_group_charges_[group].inserted.FetchAddRelaxed(charge);
+  }
+  return s;
+}
+
+Cache::Handle* FixedHyperClockCache::CreateStandalone(
+    const Slice& key, ObjectPtr obj, const CacheItemHelper* helper,
+    size_t charge, bool allow_uncharged) {
+  if (numa_group_bits_ == 0) {
+    return BaseHyperClockCache::CreateStandalone(key, obj, helper, charge,
+                                                 allow_uncharged);
+  }
+  assert(helper);
+  HashVal hash = Shard::ComputeHash(key, hash_seed_);
+  uint32_t group = GetLocalNumaGroup();
+  HandleImpl* result = GetNumaShard(group, hash).CreateStandalone(
+      key, hash, obj, helper, charge, allow_uncharged);
+  if (result) {
+    result->numa_group = static_cast<uint8_t>(group);
+  }
+  return static_cast<Handle*>(result);
+}
+
+Cache::Handle* FixedHyperClockCache::Lookup(const Slice& key,
+                                            const CacheItemHelper* helper,
+                                            CreateContext* create_context,
+                                            Priority priority,
+                                            Statistics* stats) {
+  if (numa_group_bits_ == 0) {
+    return BaseHyperClockCache::Lookup(key, helper, create_context, priority,
+                                       stats);
+  }
+  HashVal hash = Shard::ComputeHash(key, hash_seed_);
+  uint32_t local_group = GetLocalNumaGroup();
+  HandleImpl* result = GetNumaShard(local_group, hash).Lookup(key, hash);
+  // Visit the other groups in an order that depends on the local one, to
+  // spread the probes of misses.
+  for (uint32_t i = 1; result == nullptr && i < GetNumNumaGroups(); i++) {
+    result = GetNumaShard(local_group ^ i, hash).Lookup(key, hash);
+    if (result && numa_duplicate_ratio_ > 0.0) {
+      MaybeDuplicate(key, hash, result, local_group, helper, create_context,
+                     priority);
+    }
+  }
+  return static_cast<Handle*>(result);
+}
+
+void FixedHyperClockCache::MaybeDuplicate(
+    const Slice& key, const UniqueId64x2& hashed_key, const HandleImpl* h,
+    uint32_t local_group, const CacheItemHelper* helper,
+    CreateContext* create_context, Priority priority) {
+  // Sampling favors the entries with many remote hits
+  constexpr int kDuplicateOneIn = 8;
+  if (create_context == nullptr || helper == nullptr ||
+      !helper->IsSecondaryCacheCompatible() ||
+      !h->helper->IsSecondaryCacheCompatible() ||
+      !Random::GetTLSInstance()->OneIn(kDuplicateOneIn)) {
+    return;
+  }
+  NumaGroupCharges& charges = numa_group_charges_[local_group];
+  size_t duplicated = charges.duplicated.LoadRelaxed();
+  size_t inserted = charges.inserted.LoadRelaxed();
+  size_t charge = h->GetTotalCharge();
+  if (duplicated + charge >
+      numa_duplicate_ratio_ * static_cast<double>(inserted + charge)) {
+    return;
+  }
+  size_t size = h->helper->size_cb(h->value);
+  std::unique_ptr<char[]> buf(new char[size]);
+  Status s = h->helper->saveto_cb(h->value, 0, size, buf.get());
+  ObjectPtr value = nullptr;
+  size_t value_charge = 0;
+  if (s.ok()) {
+    s = helper->create_cb(Slice(buf.get(), size), kNoCompression,
+                          CacheTier::kVolatileTier, create_context,
+                          memory_allocator(), &value, &value_charge);
+  }
+  if (!s.ok()) {
+    return;
+  }
+  s = GetNumaShard(local_group, hashed_key)
+          .Insert(key, hashed_key, value, helper, value_charge,
+                  /*handle=*/nullptr, priority);
+  if (s.ok()) {
+    charges.inserted.FetchAddRelaxed(value_charge);
+    charges.duplicated.FetchAddRelaxed(value_charge);
+  } else if (helper->del_cb) {
+    helper->del_cb(value, memory_allocator());
+  }
+}
+
+void FixedHyperClockCache::Erase(const Slice& key) {
+  if (numa_group_bits_ == 0) {
+    BaseHyperClockCache::Erase(key);
+    return;
+  }
+  HashVal hash = Shard::ComputeHash(key, hash_seed_);
+  for (uint32_t group = 0; group < GetNumNumaGroups(); group++) {
+    GetNumaShard(group, hash).Erase(key, hash);
+  }
+}
+
+bool FixedHyperClockCache::Release(Handle* handle, bool useful,
+                                   bool erase_if_last_ref) {
+  if (numa_group_bits_ == 0) {
+    return BaseHyperClockCache::Release(handle, useful, erase_if_last_ref);
+  }
+  auto h = static_cast<HandleImpl*>(handle);
+  return GetNumaShard(h->numa_group, h->GetHash())
+      .Release(h, useful, erase_if_last_ref);
+}
+
+bool FixedHyperClockCache::Ref(Handle* handle) {
+  if (numa_group_bits_ == 0) {
+    return BaseHyperClockCache::Ref(handle);
+  }
+  auto h = static_cast<HandleImpl*>(handle);
+  return GetNumaShard(h->numa_group, h->GetHash()).Ref(h);
+}
+
 void FixedHyperClockCache::ReportProblems(
     const std::shared_ptr<Logger>& info_log) const {
   BaseHyperClockCache::ReportProblems(info_log);
@@ -3149,6 +3354,10 @@ AutoHyperClockTable::HandleImpl* AutoHyperClockTable::Lookup(
         if (LIKELY(h->hashed_key == hashed_key) &&
             LIKELY(old_meta & (uint64_t{ClockHandle::kStateVisibleBit}
                                << ClockHandle::kStateShift))) {
+          // Update the hit bit, as in the full Lookup below
+          if (eviction_callback_) {
+            h->meta.FetchOrRelaxed(uint64_t{1} << ClockHandle::kHitBitShift);
+          }
           return h;
         } else {
           Unref(*h);
@@ -3616,6 +3825,126 @@ void AutoHyperClockCache::ReportProblems(
   }
 }
 
+namespace {
+struct HashedKeyRowEntry {
+  std::string key;
+  Cache::ObjectPtr value;
+  const Cache::CacheItemHelper* helper;
+};
+
+void DeleteHashedKeyRowEntry(Cache::ObjectPtr obj, MemoryAllocator* allocator) {
+  auto entry = static_cast<HashedKeyRowEntry*>(obj);
+  if (entry->helper->del_cb != nullptr) {
+    entry->helper->del_cb(entry->value, allocator);
+  }
+  delete entry;
+}
+
+const Cache::CacheItemHelper kHashedKeyRowHelper{CacheEntryRole::kMisc,
+                                                 &DeleteHashedKeyRowEntry};
+
+// A RowCache on top of a HyperClockCache, which only supports 16-byte keys.
+// Rows are keyed by a 128-bit hash of their key and keep the key, which
+// lookups check so that a collision of the hashes is only a miss.
+class HashedKeyRowCache : public CacheWrapper {
+ public:
+  explicit HashedKeyRowCache(std::shared_ptr<Cache> target)
+      : CacheWrapper(std::move(target)) {}
+
+  const char* Name() const override { return "HashedKeyRowCache"; }
+
+  Status Insert(const Slice& key, ObjectPtr value,
+                const CacheItemHelper* helper, size_t charge,
+                Handle** handle = nullptr, Priority priority = Priority::LOW,
+                const Slice& /*compressed_value*/ = Slice(),
+                CompressionType /*type*/ = kNoCompression) override {
+    char buf[kCacheKeySize];
+    auto entry = new HashedKeyRowEntry{key.ToString(), value, helper};
+    Status s = target_->Insert(HashKey(key, buf), entry, &kHashedKeyRowHelper,
+                               GetEntryCharge(key, charge), handle, priority);
+    if (!s.ok()) {
+      // The caller keeps the value
+      delete entry;
+    }
+    return s;
+  }
+
+  Handle* CreateStandalone(const Slice& key, ObjectPtr obj,
+                           const CacheItemHelper* helper, size_t charge,
+                           bool allow_uncharged) override {
+    char buf[kCacheKeySize];
+    return target_->CreateStandalone(
+        HashKey(key, buf), new HashedKeyRowEntry{key.ToString(), obj, helper},
+        &kHashedKeyRowHelper, GetEntryCharge(key, charge), allow_uncharged);
+  }
+
+  Handle* Lookup(const Slice& key, const CacheItemHelper* /*helper*/,
+                 CreateContext* /*create_context*/,
+                 Priority priority = Priority::LOW,
+                 Statistics* stats = nullptr) override {
+    char buf[kCacheKeySize];
+    Handle* handle = target_->Lookup(HashKey(key, buf), /*helper=*/nullptr,
+                                     /*create_context=*/nullptr, priority,
+                                     stats);
+    if (handle != nullptr && key != GetEntry(handle)->key) {
+      target_->Release(handle);
+      return nullptr;
+    }
+    return handle;
+  }
+
+  ObjectPtr Value(Handle* handle) override { return GetEntry(handle)->value; }
+
+  const CacheItemHelper* GetCacheItemHelper(Handle* handle) const override {
+    return GetEntry(handle)->helper;
+  }
+
+  void Erase(const Slice& key) override {
+    char buf[kCacheKeySize];
+    target_->Erase(HashKey(key, buf));
+  }
+
+  void ApplyToAllEntries(
+      const std::function<void(const Slice& key, ObjectPtr value, size_t charge,
+                               const CacheItemHelper* helper)>& callback,
+      const ApplyToAllEntriesOptions& opts) override {
+    target_->ApplyToAllEntries(
+        [&callback](const Slice& /*hashed_key*/, ObjectPtr value,
+                    size_t charge, const CacheItemHelper* /*helper*/) {
+          auto entry = static_cast<const HashedKeyRowEntry*>(value);
+          callback(entry->key, entry->value, charge, entry->helper);
+        },
+        opts);
+  }
+
+  // Looked up synchronously, with the hashed key
+  void StartAsyncLookup(AsyncLookupHandle& async_handle) override {
+    Cache::StartAsyncLookup(async_handle);
+  }
+
+  void WaitAll(AsyncLookupHandle* async_handles, size_t count) override {
+    Cache::WaitAll(async_handles, count);
+  }
+
+ private:
+  static Slice HashKey(const Slice& key, char* buf) {
+    uint64_t hi, lo;
+    Hash2x64(key.data(), key.size(), &hi, &lo);
+    EncodeFixed64(buf, lo);
+    EncodeFixed64(buf + 8, hi);
+    return Slice(buf, kCacheKeySize);
+  }
+
+  static size_t GetEntryCharge(const Slice& key, size_t charge) {
+    return charge + sizeof(HashedKeyRowEntry) + key.size();
+  }
+
+  HashedKeyRowEntry* GetEntry(Handle* handle) const {
+    return static_cast<HashedKeyRowEntry*>(target_->Value(handle));
+  }
+};
+}  // namespace
+
 }  // namespace clock_cache
 
 // DEPRECATED (see public API)
@@ -3651,7 +3980,28 @@ std::shared_ptr<Cache> HyperClockCacheOptions::MakeSharedCache() const {
     cache = std::make_shared<CacheWithSecondaryAdapter>(cache,
                                                         opts.secondary_cache);
   }
+  if (opts.demotion_compression_type != kNoCompression) {
+    if (opts.secondary_cache ||
+        !CacheWithCompressedTier::IsSupported(
+            opts.demotion_compression_type)) {
+      return nullptr;
+    }
+    cache = std::make_shared<CacheWithCompressedTier>(
+        cache, opts.demotion_compression_type);
+  }
   return cache;
 }
 
+std::shared_ptr<RowCache> HyperClockCacheOptions::MakeSharedRowCache() const {
+  if (secondary_cache) {
+    // Not allowed for a RowCache
+    return nullptr;
+  }
+  std::shared_ptr<Cache> cache = MakeSharedCache();
+  if (cache == nullptr) {
+    return nullptr;
+  }
+  return std::make_shared<clock_cache::HashedKeyRowCache>(std::move(cache));
+}
+
 }  // namespace ROCKSDB_NAMESPACE
@@ -16,6 +16,7 @@
 #include <cstdint>
 #include <memory>
 #include <string>
+#include <vector>
 
 #include "cache/cache_key.h"
 #include "cache/sharded_cache.h"
@@ -381,6 +382,10 @@ class BaseClockTable {
     explicit BaseOpts(const HyperClockCacheOptions& opts)
         : BaseOpts(opts.eviction_effort_cap) {}
     int eviction_effort_cap;
+    // The NUMA group of the shard owning the table (see
+    // HyperClockCacheOptions::numa_local_shards), for tables that
+    // kSupportsNumaGroups.
+    uint8_t numa_group = 0;
   };
 
   BaseClockTable(CacheMetadataChargePolicy metadata_charge_policy,
@@ -534,11 +539,17 @@ class FixedHyperClockTable : public BaseClockTable {
     // regression.
     bool standalone = false;
 
+    // The NUMA group of the shard owning the handle, so that handles can be
+    // released without searching the groups. Fits in the padding.
+    uint8_t numa_group = 0;
+
     inline bool IsStandalone() const { return standalone; }
 
     inline void SetStandalone() { standalone = true; }
   };  // struct HandleImpl
 
+  static constexpr bool kSupportsNumaGroups = true;
+
   struct Opts : public BaseOpts {
     explicit Opts(size_t _estimated_value_size, int _eviction_effort_cap)
         : BaseOpts(_eviction_effort_cap),
@@ -828,6 +839,9 @@ class AutoHyperClockTable : public BaseClockTable {
     }
   };  // struct HandleImpl
 
+  // No room in the handles to record their group
+  static constexpr bool kSupportsNumaGroups = false;
+
   struct Opts : public BaseOpts {
     explicit Opts(size_t _min_avg_value_size, int _eviction_effort_cap)
         : BaseOpts(_eviction_effort_cap),
@@ -1130,6 +1144,27 @@ class BaseHyperClockCache : public ShardedCache<ClockCacheShard<Table>> {
 
   void ReportProblems(
       const std::shared_ptr<Logger>& /*info_log*/) const override;
+
+ protected:
+  uint32_t GetNumNumaGroups() const { return uint32_t{1} << numa_group_bits_; }
+
+  // The group of the NUMA node of the calling thread's CPU
+  uint32_t GetLocalNumaGroup() const;
+
+  // The shard of the group that a key with this hash maps to. Each group
+  // owns a contiguous range of the shards.
+  Shard& GetNumaShard(uint32_t group, const UniqueId64x2& hashed_key) {
+    return this->GetShardAt(
+        (group << numa_group_shift_) |
+        (Shard::HashPieceForSharding(hashed_key) & numa_within_group_mask_));
+  }
+
+  // 0 unless numa_local_shards takes effect
+  int numa_group_bits_ = 0;
+  int numa_group_shift_ = 0;
+  uint32_t numa_within_group_mask_ = 0;
+  // Group of each CPU
+  std::vector<uint8_t> cpu_numa_groups_;
 };
 
 class FixedHyperClockCache
@@ -1138,12 +1173,56 @@ class FixedHyperClockCache
 #endif
     : public BaseHyperClockCache<FixedHyperClockTable> {
  public:
-  using BaseHyperClockCache::BaseHyperClockCache;
+  explicit FixedHyperClockCache(const HyperClockCacheOptions& opts);
 
   const char* Name() const override { return "FixedHyperClockCache"; }
 
+  // With several NUMA groups, these route the operations to the shards of
+  // the right groups.
+  Status Insert(
+      const Slice& key, ObjectPtr obj, const CacheItemHelper* helper,
+      size_t charge, Handle** handle = nullptr,
+      Priority priority = Priority::LOW,
+      const Slice& compressed_value = Slice(),
+      CompressionType type = CompressionType::kNoCompression) override;
+
+  Handle* CreateStandalone(const Slice& key, ObjectPtr obj,
+                           const CacheItemHelper* helper, size_t charge,
+                           bool allow_uncharged) override;
+
+  Handle* Lookup(const Slice& key, const CacheItemHelper* helper = nullptr,
+                 CreateContext* create_context = nullptr,
+                 Priority priority = Priority::LOW,
+                 Statistics* stats = nullptr) override;
+
+  void Erase(const Slice& key) override;
+
+  using BaseHyperClockCache::Release;
+  bool Release(Handle* handle, bool useful,
+               bool erase_if_last_ref = false) override;
+
+  bool Ref(Handle* handle) override;
+
   void ReportProblems(
       const std::shared_ptr<Logger>& /*info_log*/) const override;
+
+ private:
+  // Maybe copies an entry found in another group into the local group, as
+  // long as the copies stay within numa_duplicate_ratio.
+  void MaybeDuplicate(const Slice& key, const UniqueId64x2& hashed_key,
+                      const HandleImpl* h, uint32_t local_group,
+                      const CacheItemHelper* helper,
+                      CreateContext* create_context, Priority priority);
+
+  // Charge inserted into the shards of a group, and how much of it copied
+  // entries found in other groups. Only tracked with numa_duplicate_ratio.
+  struct ALIGN_AS(CACHE_LINE_SIZE) NumaGroupCharges {
+    RelaxedAtomic<size_t> inserted{};
+    RelaxedAtomic<size_t> duplicated{};
+  };
+
+  const double numa_duplicate_ratio_;
+  std::unique_ptr<NumaGroupCharges[]> numa_group_charges_;
 };  // class FixedHyperClockCache
 
 class AutoHyperClockCache
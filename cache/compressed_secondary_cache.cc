@@ -13,6 +13,7 @@
 #include "monitoring/perf_context_imp.h"
 #include "util/coding.h"
 #include "util/compression.h"
+#include "util/random.h"
 #include "util/string_util.h"
 
 namespace ROCKSDB_NAMESPACE {
@@ -24,9 +25,50 @@ CompressedSecondaryCache::CompressedSecondaryCache(
       cache_res_mgr_(std::make_shared<ConcurrentCacheReservationManager>(
           std::make_shared<CacheReservationManagerImpl<CacheEntryRole::kMisc>>(
               cache_))),
-      disable_cache_(opts.capacity == 0) {}
+      disable_cache_(opts.capacity == 0),
+      use_dictionary_(opts.compression_opts.max_dict_bytes > 0 &&
+                      !opts.enable_custom_split_merge &&
+                      (opts.compression_type == kZSTD ||
+                       opts.compression_type == kZSTDNotFinalCompression ||
+                       opts.compression_type == kLZ4Compression ||
+                       opts.compression_type == kLZ4HCCompression ||
+                       opts.compression_type == kZlibCompression)),
+      pending_cv_(&pending_mutex_) {
+  compression_levels_.push_back(opts.compression_opts.level);
+  for (const auto& role_level : opts.compression_level_by_role) {
+    compression_levels_.push_back(role_level.second);
+  }
+  std::sort(compression_levels_.begin(), compression_levels_.end());
+  compression_levels_.erase(
+      std::unique(compression_levels_.begin(), compression_levels_.end()),
+      compression_levels_.end());
+  if (opts.max_pending_compression_bytes > 0 &&
+      opts.compression_type != kNoCompression) {
+    compression_thread_ = port::Thread([this] { CompressionThread(); });
+  }
+}
+
+CompressedSecondaryCache::~CompressedSecondaryCache() {
+  if (compression_thread_.joinable()) {
+    {
+      MutexLock l(&pending_mutex_);
+      shutdown_ = true;
+      pending_cv_.SignalAll();
+    }
+    compression_thread_.join();
+  }
+}
 
-CompressedSecondaryCache::~CompressedSecondaryCache() = default;
+CompressedSecondaryCache::Dictionary::Dictionary(
+    uint32_t _generation, const std::string& dict, CompressionType type,
+    const std::vector<int>& levels)
+    : generation(_generation),
+      uncompression_dict(dict, type == kZSTD ||
+                                   type == kZSTDNotFinalCompression) {
+  for (int level : levels) {
+    compression_dicts[level].reset(new CompressionDict(dict, type, level));
+  }
+}
 
 std::unique_ptr<SecondaryCacheResultHandle> CompressedSecondaryCache::Lookup(
     const Slice& key, const Cache::CacheItemHelper* helper,
@@ -61,6 +103,7 @@ std::unique_ptr<SecondaryCacheResultHandle> CompressedSecondaryCache::Lookup(
   const char* data_ptr = nullptr;
   CacheTier source = CacheTier::kVolatileCompressedTier;
   CompressionType type = cache_options_.compression_type;
+  uint32_t dictionary_generation = 0;
   if (cache_options_.enable_custom_split_merge) {
     CacheValueChunk* value_chunk_ptr =
         reinterpret_cast<CacheValueChunk*>(handle_value);
@@ -79,6 +122,8 @@ std::unique_ptr<SecondaryCacheResultHandle> CompressedSecondaryCache::Lookup(
     data_ptr = GetVarint32Ptr(data_ptr, data_ptr + 1,
                               static_cast<uint32_t*>(&source_32));
     source = static_cast<CacheTier>(source_32);
+    data_ptr = GetVarint32Ptr(data_ptr, ptr->get() + handle_value_charge,
+                              &dictionary_generation);
     handle_value_charge -= (data_ptr - ptr->get());
   }
   MemoryAllocator* allocator = cache_options_.memory_allocator.get();
@@ -93,11 +138,22 @@ std::unique_ptr<SecondaryCacheResultHandle> CompressedSecondaryCache::Lookup(
                             kNoCompression, CacheTier::kVolatileTier,
                             create_context, allocator, &value, &charge);
     } else {
+      std::shared_ptr<const Dictionary> dictionary;
+      if (dictionary_generation != 0) {
+        dictionary = GetDictionary(dictionary_generation);
+        if (dictionary == nullptr) {
+          // Compressed with a dictionary that is no longer kept
+          cache_->Release(lru_handle, /*erase_if_last_ref=*/true);
+          return nullptr;
+        }
+      }
       UncompressionContext uncompression_context(
           cache_options_.compression_type);
-      UncompressionInfo uncompression_info(uncompression_context,
-                                           UncompressionDict::GetEmptyDict(),
-                                           cache_options_.compression_type);
+      UncompressionInfo uncompression_info(
+          uncompression_context,
+          dictionary ? dictionary->uncompression_dict
+                     : UncompressionDict::GetEmptyDict(),
+          cache_options_.compression_type);
 
       size_t uncompressed_size{0};
       CacheAllocationPtr uncompressed =
@@ -169,10 +225,12 @@ Status CompressedSecondaryCache::InsertInternal(
   }
 
   auto internal_helper = GetHelper(cache_options_.enable_custom_split_merge);
-  char header[10];
+  char header[15];
   char* payload = header;
   payload = EncodeVarint32(payload, static_cast<uint32_t>(type));
   payload = EncodeVarint32(payload, static_cast<uint32_t>(source));
+  // No compression dictionary
+  payload = EncodeVarint32(payload, 0);
 
   size_t header_size = payload - header;
   size_t data_size = (*helper->size_cb)(value);
@@ -185,54 +243,246 @@ Status CompressedSecondaryCache::InsertInternal(
   if (!s.ok()) {
     return s;
   }
-  Slice val(data_ptr, data_size);
 
-  std::string compressed_val;
   if (cache_options_.compression_type != kNoCompression &&
       type == kNoCompression &&
       !cache_options_.do_not_compress_roles.Contains(helper->role)) {
-    PERF_COUNTER_ADD(compressed_sec_cache_uncompressed_bytes, data_size);
-    CompressionContext compression_context(cache_options_.compression_type,
-                                           cache_options_.compression_opts);
-    uint64_t sample_for_compression{0};
-    CompressionInfo compression_info(
-        cache_options_.compression_opts, compression_context,
-        CompressionDict::GetEmptyDict(), cache_options_.compression_type,
-        sample_for_compression);
-
-    bool success =
-        CompressData(val, compression_info,
-                     cache_options_.compress_format_version, &compressed_val);
-
-    if (!success) {
-      return Status::Corruption("Error compressing value.");
+    if (compression_thread_.joinable() &&
+        MaybeEnqueueCompression(key, std::move(ptr), header_size, data_size,
+                                helper->role)) {
+      return Status::OK();
     }
+    return CompressAndInsert(key, std::move(ptr), header_size, data_size,
+                             helper->role);
+  }
 
-    val = Slice(compressed_val);
-    data_size = compressed_val.size();
-    total_size = header_size + data_size;
-    PERF_COUNTER_ADD(compressed_sec_cache_compressed_bytes, data_size);
+  PERF_COUNTER_ADD(compressed_sec_cache_insert_real_count, 1);
+  if (cache_options_.enable_custom_split_merge) {
+    size_t charge{0};
+    CacheValueChunk* value_chunks_head =
+        SplitValueIntoChunks(Slice(data_ptr, data_size),
+                             cache_options_.compression_type, charge);
+    return cache_->Insert(key, value_chunks_head, internal_helper, charge);
+  } else {
+    std::memcpy(ptr.get(), header, header_size);
+    CacheAllocationPtr* buf = new CacheAllocationPtr(std::move(ptr));
+    return cache_->Insert(key, buf, internal_helper, total_size);
+  }
+}
 
-    if (!cache_options_.enable_custom_split_merge) {
-      ptr = AllocateBlock(total_size, cache_options_.memory_allocator.get());
-      data_ptr = ptr.get() + header_size;
-      memcpy(data_ptr, compressed_val.data(), data_size);
-    }
+Status CompressedSecondaryCache::CompressAndInsert(const Slice& key,
+                                                   CacheAllocationPtr&& data,
+                                                   size_t header_size,
+                                                   size_t data_size,
+                                                   CacheEntryRole role) {
+  Slice val(data.get() + header_size, data_size);
+  PERF_COUNTER_ADD(compressed_sec_cache_uncompressed_bytes, data_size);
+  MaybeSampleForDictionary(val);
+  std::shared_ptr<const Dictionary> dictionary;
+  if (use_dictionary_) {
+    dictionary = GetDictionary(/*generation=*/0);
+  }
+
+  CompressionOptions compression_opts = cache_options_.compression_opts;
+  compression_opts.level = GetCompressionLevel(role);
+  CompressionContext compression_context(cache_options_.compression_type,
+                                         compression_opts);
+  uint64_t sample_for_compression{0};
+  CompressionInfo compression_info(
+      compression_opts, compression_context,
+      dictionary ? *dictionary->compression_dicts.at(compression_opts.level)
+                 : CompressionDict::GetEmptyDict(),
+      cache_options_.compression_type, sample_for_compression);
+
+  std::string compressed_val;
+  bool success =
+      CompressData(val, compression_info,
+                   cache_options_.compress_format_version, &compressed_val);
+
+  if (!success) {
+    return Status::Corruption("Error compressing value.");
   }
+  data.reset();
+  PERF_COUNTER_ADD(compressed_sec_cache_compressed_bytes,
+                   compressed_val.size());
 
   PERF_COUNTER_ADD(compressed_sec_cache_insert_real_count, 1);
+  auto internal_helper = GetHelper(cache_options_.enable_custom_split_merge);
   if (cache_options_.enable_custom_split_merge) {
     size_t charge{0};
-    CacheValueChunk* value_chunks_head =
-        SplitValueIntoChunks(val, cache_options_.compression_type, charge);
+    CacheValueChunk* value_chunks_head = SplitValueIntoChunks(
+        compressed_val, cache_options_.compression_type, charge);
     return cache_->Insert(key, value_chunks_head, internal_helper, charge);
   } else {
+    char header[15];
+    char* payload = header;
+    payload = EncodeVarint32(payload, static_cast<uint32_t>(kNoCompression));
+    payload = EncodeVarint32(
+        payload, static_cast<uint32_t>(CacheTier::kVolatileCompressedTier));
+    payload =
+        EncodeVarint32(payload, dictionary ? dictionary->generation : 0);
+    header_size = payload - header;
+    size_t total_size = header_size + compressed_val.size();
+    CacheAllocationPtr ptr =
+        AllocateBlock(total_size, cache_options_.memory_allocator.get());
     std::memcpy(ptr.get(), header, header_size);
+    std::memcpy(ptr.get() + header_size, compressed_val.data(),
+                compressed_val.size());
     CacheAllocationPtr* buf = new CacheAllocationPtr(std::move(ptr));
     return cache_->Insert(key, buf, internal_helper, total_size);
   }
 }
 
+std::shared_ptr<const CompressedSecondaryCache::Dictionary>
+CompressedSecondaryCache::GetDictionary(uint32_t generation) {
+  MutexLock l(&dictionary_mutex_);
+  if (generation == 0) {
+    // The latest
+    generation = dictionary_generation_;
+    if (generation == 0) {
+      return nullptr;
+    }
+  }
+  const auto& dictionary = dictionaries_[generation % kNumDictionaries];
+  if (dictionary == nullptr || dictionary->generation != generation) {
+    return nullptr;
+  }
+  return dictionary;
+}
+
+void CompressedSecondaryCache::MaybeSampleForDictionary(const Slice& value) {
+  if (!use_dictionary_) {
+    return;
+  }
+  const CompressionOptions& opts = cache_options_.compression_opts;
+  const size_t sample_limit = opts.zstd_max_train_bytes > 0
+                                  ? opts.zstd_max_train_bytes
+                                  : opts.max_dict_bytes;
+  std::string samples;
+  std::vector<size_t> sample_lens;
+  uint32_t generation;
+  {
+    MutexLock l(&dictionary_mutex_);
+    bytes_since_dictionary_ += value.size();
+    if (dictionary_samples_.size() < sample_limit &&
+        Random::GetTLSInstance()->OneIn(kDictionarySampleOneIn)) {
+      size_t len =
+          std::min(value.size(), sample_limit - dictionary_samples_.size());
+      dictionary_samples_.append(value.data(), len);
+      dictionary_sample_lens_.push_back(len);
+    }
+    // Rebuild about once per turnover of the cache
+    if (building_dictionary_ || dictionary_samples_.size() < sample_limit ||
+        (dictionary_generation_ > 0 &&
+         bytes_since_dictionary_ < cache_->GetCapacity())) {
+      return;
+    }
+    samples.swap(dictionary_samples_);
+    sample_lens.swap(dictionary_sample_lens_);
+    generation = dictionary_generation_ + 1;
+    building_dictionary_ = true;
+  }
+
+  std::string dict;
+  if (opts.zstd_max_train_bytes > 0 &&
+      (cache_options_.compression_type == kZSTD ||
+       cache_options_.compression_type == kZSTDNotFinalCompression)) {
+    if (opts.use_zstd_dict_trainer) {
+      if (ZSTD_TrainDictionarySupported()) {
+        dict = ZSTD_TrainDictionary(samples, sample_lens, opts.max_dict_bytes);
+      }
+    } else if (ZSTD_FinalizeDictionarySupported()) {
+      dict = ZSTD_FinalizeDictionary(samples, sample_lens, opts.max_dict_bytes,
+                                     opts.level);
+    }
+  } else {
+    // The most recent samples as a raw dictionary
+    size_t dict_size = std::min(samples.size(), size_t{opts.max_dict_bytes});
+    dict = samples.substr(samples.size() - dict_size);
+  }
+  std::shared_ptr<const Dictionary> dictionary;
+  if (!dict.empty()) {
+    dictionary = std::make_shared<const Dictionary>(
+        generation, dict, cache_options_.compression_type,
+        compression_levels_);
+  }
+
+  MutexLock l(&dictionary_mutex_);
+  if (dictionary) {
+    dictionaries_[generation % kNumDictionaries] = std::move(dictionary);
+    dictionary_generation_ = generation;
+    bytes_since_dictionary_ = 0;
+  }
+  building_dictionary_ = false;
+}
+
+bool CompressedSecondaryCache::MaybeEnqueueCompression(
+    const Slice& key, CacheAllocationPtr&& data, size_t header_size,
+    size_t data_size, CacheEntryRole role) {
+  MutexLock l(&pending_mutex_);
+  if (shutdown_ || pending_bytes_ + data_size >
+                       cache_options_.max_pending_compression_bytes) {
+    return false;
+  }
+  pending_bytes_ += data_size;
+  pending_.push_back(
+      {key.ToString(), std::move(data), header_size, data_size, role});
+  // Also wakes up TEST_WaitForPendingCompressions(), so wake up all
+  pending_cv_.SignalAll();
+  return true;
+}
+
+void CompressedSecondaryCache::CompressionThread() {
+  pending_mutex_.Lock();
+  while (true) {
+    while (!shutdown_ && pending_.empty()) {
+      pending_cv_.Wait();
+    }
+    if (shutdown_) {
+      break;
+    }
+    PendingCompression item = std::move(pending_.front());
+    pending_.pop_front();
+    compressing_key_ = item.key;
+    compressing_ = true;
+    compressing_key_erased_ = false;
+    pending_mutex_.Unlock();
+
+    CompressAndInsert(item.key, std::move(item.data), item.header_size,
+                      item.data_size, item.role)
+        .PermitUncheckedError();
+
+    pending_mutex_.Lock();
+    if (compressing_key_erased_) {
+      cache_->Erase(item.key);
+    }
+    pending_bytes_ -= item.data_size;
+    compressing_ = false;
+    pending_cv_.SignalAll();
+  }
+  pending_mutex_.Unlock();
+}
+
+int CompressedSecondaryCache::GetCompressionLevel(CacheEntryRole role) const {
+  auto it = cache_options_.compression_level_by_role.find(role);
+  if (it != cache_options_.compression_level_by_role.end()) {
+    return it->second;
+  }
+  return cache_options_.compression_opts.level;
+}
+
+void CompressedSecondaryCache::TEST_WaitForPendingCompressions() {
+  MutexLock l(&pending_mutex_);
+  while (!pending_.empty() || compressing_) {
+    pending_cv_.Wait();
+  }
+}
+
+uint32_t CompressedSecondaryCache::TEST_GetDictionaryGeneration() {
+  MutexLock l(&dictionary_mutex_);
+  return dictionary_generation_;
+}
+
 Status CompressedSecondaryCache::Insert(const Slice& key,
                                         Cache::ObjectPtr value,
                                         const Cache::CacheItemHelper* helper,
@@ -266,7 +516,23 @@ Status CompressedSecondaryCache::InsertSaved(
       slice_helper, type, source);
 }
 
-void CompressedSecondaryCache::Erase(const Slice& key) { cache_->Erase(key); }
+void CompressedSecondaryCache::Erase(const Slice& key) {
+  if (compression_thread_.joinable()) {
+    MutexLock l(&pending_mutex_);
+    for (auto it = pending_.begin(); it != pending_.end();) {
+      if (key == it->key) {
+        pending_bytes_ -= it->data_size;
+        it = pending_.erase(it);
+      } else {
+        ++it;
+      }
+    }
+    if (compressing_ && key == compressing_key_) {
+      compressing_key_erased_ = true;
+    }
+  }
+  cache_->Erase(key);
+}
 
 Status CompressedSecondaryCache::SetCapacity(size_t capacity) {
   MutexLock l(&capacity_mutex_);
@@ -299,6 +565,16 @@ std::string CompressedSecondaryCache::GetPrintableOptions() const {
   snprintf(buffer, kBufferSize, "    compress_format_version : %d\n",
            cache_options_.compress_format_version);
   ret.append(buffer);
+  for (const auto& role_level : cache_options_.compression_level_by_role) {
+    snprintf(buffer, kBufferSize, "    compression_level[%s] : %d\n",
+             GetCacheEntryRoleName(role_level.first).c_str(),
+             role_level.second);
+    ret.append(buffer);
+  }
+  snprintf(buffer, kBufferSize,
+           "    max_pending_compression_bytes : %" ROCKSDB_PRIszt "\n",
+           cache_options_.max_pending_compression_bytes);
+  ret.append(buffer);
   return ret;
 }
 
@@ -7,7 +7,11 @@
 
 #include <array>
 #include <cstddef>
+#include <deque>
+#include <map>
 #include <memory>
+#include <string>
+#include <vector>
 
 #include "cache/cache_reservation_manager.h"
 #include "cache/lru_cache.h"
@@ -106,6 +110,12 @@ class CompressedSecondaryCache : public SecondaryCache {
 
   size_t TEST_GetUsage() { return cache_->GetUsage(); }
 
+  // Waits until the values pending compression are in the cache
+  void TEST_WaitForPendingCompressions();
+
+  // The generation of the latest compression dictionary, 0 if none
+  uint32_t TEST_GetDictionaryGeneration();
+
  private:
   friend class CompressedSecondaryCacheTestBase;
   static constexpr std::array<uint16_t, 8> malloc_bin_sizes_{
@@ -139,6 +149,45 @@ class CompressedSecondaryCache : public SecondaryCache {
                         const Cache::CacheItemHelper* helper,
                         CompressionType type, CacheTier source);
 
+  // Compresses a value saved after header_size bytes of data and inserts it
+  Status CompressAndInsert(const Slice& key, CacheAllocationPtr&& data,
+                           size_t header_size, size_t data_size,
+                           CacheEntryRole role);
+
+  // A compression dictionary of the cache, with its digested forms for each
+  // compression level in use.
+  struct Dictionary {
+    Dictionary(uint32_t _generation, const std::string& dict,
+               CompressionType type, const std::vector<int>& levels);
+
+    const uint32_t generation;
+    std::map<int, std::unique_ptr<CompressionDict>> compression_dicts;
+    UncompressionDict uncompression_dict;
+  };
+
+  // Values compressed with one of the last kNumDictionaries dictionaries can
+  // be read.
+  static constexpr uint32_t kNumDictionaries = 4;
+
+  // Only one in this many values is sampled for building dictionaries
+  static constexpr int kDictionarySampleOneIn = 8;
+
+  std::shared_ptr<const Dictionary> GetDictionary(uint32_t generation);
+
+  // Maybe adds a value to the samples, and builds a new dictionary once
+  // there are enough samples and enough has been inserted since the last one.
+  void MaybeSampleForDictionary(const Slice& value);
+
+  // Enqueues a value for the compression thread, unless too many bytes are
+  // already pending.
+  bool MaybeEnqueueCompression(const Slice& key, CacheAllocationPtr&& data,
+                               size_t header_size, size_t data_size,
+                               CacheEntryRole role);
+
+  void CompressionThread();
+
+  int GetCompressionLevel(CacheEntryRole role) const;
+
   // TODO: clean up to use cleaner interfaces in typed_cache.h
   const Cache::CacheItemHelper* GetHelper(bool enable_custom_split_merge) const;
   std::shared_ptr<Cache> cache_;
@@ -146,6 +195,40 @@ class CompressedSecondaryCache : public SecondaryCache {
   mutable port::Mutex capacity_mutex_;
   std::shared_ptr<ConcurrentCacheReservationManager> cache_res_mgr_;
   bool disable_cache_;
+
+  // Distinct compression levels of the options, for digesting dictionaries
+  std::vector<int> compression_levels_;
+
+  const bool use_dictionary_;
+  port::Mutex dictionary_mutex_;
+  // The latest dictionaries, indexed by generation modulo kNumDictionaries
+  std::array<std::shared_ptr<const Dictionary>, kNumDictionaries>
+      dictionaries_;
+  uint32_t dictionary_generation_ = 0;
+  std::string dictionary_samples_;
+  std::vector<size_t> dictionary_sample_lens_;
+  size_t bytes_since_dictionary_ = 0;
+  bool building_dictionary_ = false;
+
+  struct PendingCompression {
+    std::string key;
+    CacheAllocationPtr data;
+    size_t header_size;
+    size_t data_size;
+    CacheEntryRole role;
+  };
+
+  port::Mutex pending_mutex_;
+  port::CondVar pending_cv_;
+  std::deque<PendingCompression> pending_;
+  size_t pending_bytes_ = 0;
+  // The key being compressed by the compression thread, if any, and whether
+  // it was erased meanwhile.
+  std::string compressing_key_;
+  bool compressing_ = false;
+  bool compressing_key_erased_ = false;
+  bool shutdown_ = false;
+  port::Thread compression_thread_;
 };
 
 }  // namespace ROCKSDB_NAMESPACE
@@ -977,6 +977,142 @@ TEST_P(CompressedSecondaryCacheTest, SplictValueAndMergeChunksTest) {
   SplictValueAndMergeChunksTest();
 }
 
+namespace {
+// 16 bytes for HCC compatibility
+std::string NumberedKey(int i) {
+  char buf[17];
+  snprintf(buf, sizeof(buf), "____%012d", i);
+  return buf;
+}
+}  // namespace
+
+TEST_P(CompressedSecondaryCacheTest, Dictionary) {
+  if (!Zlib_Supported()) {
+    ROCKSDB_GTEST_SKIP("This test requires Zlib support.");
+    return;
+  }
+  CompressedSecondaryCacheOptions opts;
+  opts.capacity = 256 << 10;
+  opts.num_shard_bits = 0;
+  opts.compression_type = kZlibCompression;
+  opts.compression_opts.max_dict_bytes = 4096;
+  opts.compression_level_by_role[CacheEntryRole::kIndexBlock] = 1;
+  std::shared_ptr<SecondaryCache> sec_cache = NewCompressedSecondaryCache(opts);
+  auto* comp_sec_cache =
+      static_cast<CompressedSecondaryCache*>(sec_cache.get());
+
+  // Values that barely compress on their own but share most of their bytes
+  Random rnd(301);
+  const std::string base = rnd.RandomString(1000);
+  auto value_of = [&](int i) {
+    std::string value = base;
+    value.replace(0, 16, NumberedKey(i));
+    return value;
+  };
+  std::vector<std::string> values;
+  auto insert = [&](int i) {
+    values.push_back(value_of(i));
+    TestItem item(values.back().data(), values.back().size());
+    CacheEntryRole role =
+        (i % 2) ? CacheEntryRole::kIndexBlock : CacheEntryRole::kDataBlock;
+    ASSERT_OK(sec_cache->Insert(NumberedKey(i), &item, GetHelper(role),
+                                /*force_insert=*/true));
+  };
+  auto lookup = [&](int i) -> bool {
+    bool kept_in_sec_cache{true};
+    CacheEntryRole role =
+        (i % 2) ? CacheEntryRole::kIndexBlock : CacheEntryRole::kDataBlock;
+    std::unique_ptr<SecondaryCacheResultHandle> handle = sec_cache->Lookup(
+        NumberedKey(i), GetHelper(role), this, true, /*advise_erase=*/false,
+        /*stats=*/nullptr, kept_in_sec_cache);
+    if (handle == nullptr) {
+      return false;
+    }
+    std::unique_ptr<TestItem> val(static_cast<TestItem*>(handle->Value()));
+    EXPECT_EQ(values[i], std::string(val->Buf(), val->Size()));
+    return true;
+  };
+
+  int i = 0;
+  for (; comp_sec_cache->TEST_GetDictionaryGeneration() == 0; i++) {
+    ASSERT_LT(i, 1000);
+    insert(i);
+  }
+  // Compressed before and after the dictionary
+  ASSERT_TRUE(lookup(0));
+  ASSERT_TRUE(lookup(i - 1));
+  for (int role = 0; role < 2; role++) {
+    get_perf_context()->Reset();
+    insert(i++);
+    ASSERT_EQ(get_perf_context()->compressed_sec_cache_uncompressed_bytes,
+              1000);
+    ASSERT_LT(get_perf_context()->compressed_sec_cache_compressed_bytes, 500);
+    ASSERT_TRUE(lookup(i - 1));
+  }
+
+  // Rebuilt after about a capacity of insertions, keeping the old one
+  const int with_first = i - 1;
+  for (; comp_sec_cache->TEST_GetDictionaryGeneration() == 1; i++) {
+    ASSERT_LT(i, 2000);
+    insert(i);
+  }
+  ASSERT_TRUE(lookup(with_first));
+  ASSERT_TRUE(lookup(i - 1));
+
+  // Until there are too many newer ones
+  for (; comp_sec_cache->TEST_GetDictionaryGeneration() <= 4; i++) {
+    ASSERT_LT(i, 10000);
+    insert(i);
+  }
+  ASSERT_FALSE(lookup(with_first));
+  ASSERT_TRUE(lookup(i - 1));
+}
+
+TEST_P(CompressedSecondaryCacheTest, BackgroundCompression) {
+  if (!Zlib_Supported()) {
+    ROCKSDB_GTEST_SKIP("This test requires Zlib support.");
+    return;
+  }
+  CompressedSecondaryCacheOptions opts;
+  opts.capacity = 1 << 20;
+  opts.num_shard_bits = 0;
+  opts.compression_type = kZlibCompression;
+  opts.max_pending_compression_bytes = 4096;
+  std::shared_ptr<SecondaryCache> sec_cache = NewCompressedSecondaryCache(opts);
+  auto* comp_sec_cache =
+      static_cast<CompressedSecondaryCache*>(sec_cache.get());
+
+  Random rnd(301);
+  std::vector<std::string> values;
+  for (int i = 0; i < 100; i++) {
+    // Compressible
+    values.push_back(rnd.RandomString(100) + std::string(900, 'a'));
+    TestItem item(values.back().data(), values.back().size());
+    ASSERT_OK(sec_cache->Insert(NumberedKey(i), &item, GetHelper(),
+                                /*force_insert=*/true));
+    if (i % 10 == 0) {
+      // Wherever the value is, it is gone
+      sec_cache->Erase(NumberedKey(i));
+    }
+  }
+  comp_sec_cache->TEST_WaitForPendingCompressions();
+
+  for (int i = 0; i < 100; i++) {
+    bool kept_in_sec_cache{true};
+    std::unique_ptr<SecondaryCacheResultHandle> handle = sec_cache->Lookup(
+        NumberedKey(i), GetHelper(), this, true, /*advise_erase=*/false,
+        /*stats=*/nullptr, kept_in_sec_cache);
+    if (i % 10 == 0) {
+      ASSERT_EQ(handle, nullptr);
+      continue;
+    }
+    ASSERT_NE(handle, nullptr);
+    std::unique_ptr<TestItem> val(static_cast<TestItem*>(handle->Value()));
+    ASSERT_EQ(values[i], std::string(val->Buf(), val->Size()));
+  }
+  ASSERT_LT(comp_sec_cache->TEST_GetUsage(), 90 * 1000);
+}
+
 using secondary_cache_test_util::WithCacheType;
 
 class CompressedSecCacheTestWithTiered
@@ -1370,6 +1506,130 @@ INSTANTIATE_TEST_CASE_P(
         std::make_tuple(PrimaryCacheType::kCacheTypeHCC,
                         TieredAdmissionPolicy::kAdmPolicyAllowCacheHits)));
 
+class CompressedTierCacheTest : public testing::Test, public WithCacheType {
+ public:
+  const std::string& Type() const override {
+    static const std::string kType = kAutoHyperClock;
+    return kType;
+  }
+};
+
+TEST_F(CompressedTierCacheTest, DemoteAndPromote) {
+  if (!Zlib_Supported()) {
+    ROCKSDB_GTEST_SKIP("This test requires Zlib support.");
+    return;
+  }
+  const size_t kValueSize = 1000;
+  const size_t kCapacity = 64 * kValueSize;
+  std::shared_ptr<Cache> cache =
+      NewCache(kCapacity, [](ShardedCacheOptions& opts) {
+        opts.num_shard_bits = 0;
+        static_cast<HyperClockCacheOptions&>(opts).demotion_compression_type =
+            kZlibCompression;
+      });
+  ASSERT_NE(cache, nullptr);
+
+  // Compressible values, each hit once after its insertion
+  const int kNumKeys = 256;
+  auto make_key = [](int i) {
+    char key[17];
+    snprintf(key, sizeof(key), "%016d", i);
+    return std::string(key, 16);
+  };
+  auto make_value = [](int i) {
+    return std::string(kValueSize, static_cast<char>('a' + i % 26));
+  };
+  for (int i = 0; i < kNumKeys; i++) {
+    std::string value = make_value(i);
+    ASSERT_OK(cache->Insert(make_key(i),
+                            new TestItem(value.data(), value.size()),
+                            GetHelper(), value.size()));
+    Cache::Handle* handle = cache->Lookup(make_key(i), GetHelper(), this);
+    ASSERT_NE(handle, nullptr);
+    cache->Release(handle);
+  }
+  ASSERT_LE(cache->GetUsage(), kCapacity + kValueSize);
+
+  // More entries than fit uncompressed are found, demoted or not
+  int num_found = 0;
+  for (int i = kNumKeys - 1; i >= 0; i--) {
+    Cache::Handle* handle = cache->Lookup(make_key(i), GetHelper(), this);
+    if (handle == nullptr) {
+      continue;
+    }
+    num_found++;
+    ASSERT_EQ(static_cast<TestItem*>(cache->Value(handle))->ToString(),
+              make_value(i));
+    cache->Release(handle);
+  }
+  ASSERT_GT(num_found, static_cast<int>(kCapacity / kValueSize));
+
+  // Demotion is not supported together with a secondary cache
+  HyperClockCacheOptions opts(kCapacity, /*estimated_entry_charge=*/0);
+  opts.demotion_compression_type = kZlibCompression;
+  opts.secondary_cache =
+      NewCompressedSecondaryCache(CompressedSecondaryCacheOptions());
+  ASSERT_EQ(opts.MakeSharedCache(), nullptr);
+}
+
+#ifndef NDEBUG  // Needs sync points
+TEST_F(CompressedTierCacheTest, DemotedAfterReinsert) {
+  if (!Zlib_Supported()) {
+    ROCKSDB_GTEST_SKIP("This test requires Zlib support.");
+    return;
+  }
+  const size_t kValueSize = 1000;
+  const size_t kCapacity = 4 * kValueSize;
+  std::shared_ptr<Cache> cache =
+      NewCache(kCapacity, [](ShardedCacheOptions& opts) {
+        opts.num_shard_bits = 0;
+        static_cast<HyperClockCacheOptions&>(opts).demotion_compression_type =
+            kZlibCompression;
+      });
+  ASSERT_NE(cache, nullptr);
+
+  const std::string key(16, 'k');
+  const std::string value(kValueSize, 'v');
+  ASSERT_OK(cache->Insert(key, new TestItem(value.data(), value.size()),
+                          GetHelper(), value.size()));
+  Cache::Handle* handle = cache->Lookup(key, GetHelper(), this);
+  ASSERT_NE(handle, nullptr);
+  cache->Release(handle);
+
+  // The entry is inserted again, as after a miss, between its eviction and
+  // the insertion of its compressed copy
+  TestItem* reinserted = nullptr;
+  SyncPoint::GetInstance()->SetCallBack(
+      "CacheWithCompressedTier::InsertDemoted", [&](void* arg) {
+        if (reinserted != nullptr ||
+            *static_cast<std::string*>(arg) != key) {
+          return;
+        }
+        reinserted = new TestItem(value.data(), value.size());
+        ASSERT_OK(cache->Insert(key, reinserted, GetHelper(), value.size()));
+      });
+  SyncPoint::GetInstance()->EnableProcessing();
+
+  for (int i = 0; i < 100 && reinserted == nullptr; i++) {
+    std::string other_key(16, 'a');
+    other_key.replace(0, 4, std::to_string(1000 + i));
+    std::string other_value(kValueSize, static_cast<char>('a' + i % 26));
+    ASSERT_OK(cache->Insert(other_key,
+                            new TestItem(other_value.data(), other_value.size()),
+                            GetHelper(), other_value.size()));
+  }
+  SyncPoint::GetInstance()->DisableProcessing();
+  SyncPoint::GetInstance()->ClearAllCallBacks();
+  ASSERT_NE(reinserted, nullptr);
+
+  // The copy did not take the place of the new entry
+  handle = cache->Lookup(key, GetHelper(), this);
+  ASSERT_NE(handle, nullptr);
+  ASSERT_EQ(cache->Value(handle), reinserted);
+  cache->Release(handle);
+}
+#endif  // NDEBUG
+
 }  // namespace ROCKSDB_NAMESPACE
 
 int main(int argc, char** argv) {
@@ -0,0 +1,218 @@
+//  Copyright (c) Meta Platforms, Inc. and affiliates.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+
+#include "cache/compressed_tier_cache.h"
+
+#include <array>
+#include <utility>
+
+#include "monitoring/perf_context_imp.h"
+#include "test_util/sync_point.h"
+#include "util/compression.h"
+#include "util/mutexlock.h"
+
+namespace ROCKSDB_NAMESPACE {
+
+namespace {
+// The format of the compressed copies, which are never persisted
+constexpr uint32_t kCompressFormatVersion = 2;
+
+void DeleteCompressed(Cache::ObjectPtr obj, MemoryAllocator* /*alloc*/) {
+  delete static_cast<std::string*>(obj);
+}
+
+template <size_t... kRoles>
+std::array<Cache::CacheItemHelper, kNumCacheEntryRoles> MakeCompressedHelpers(
+    std::index_sequence<kRoles...>) {
+  return {{Cache::CacheItemHelper(static_cast<CacheEntryRole>(kRoles),
+                                  &DeleteCompressed)...}};
+}
+
+// Helpers of the compressed copies, keeping the role of their entries
+const Cache::CacheItemHelper* GetCompressedHelper(CacheEntryRole role) {
+  static const std::array<Cache::CacheItemHelper, kNumCacheEntryRoles>
+      kHelpers = MakeCompressedHelpers(
+          std::make_index_sequence<kNumCacheEntryRoles>());
+  return &kHelpers[static_cast<size_t>(role)];
+}
+
+bool IsCompressed(const Cache::CacheItemHelper* helper) {
+  return helper != nullptr && helper->del_cb == &DeleteCompressed;
+}
+}  // namespace
+
+CacheWithCompressedTier::CacheWithCompressedTier(
+    std::shared_ptr<Cache> target, CompressionType compression_type)
+    : CacheWrapper(std::move(target)), compression_type_(compression_type) {
+  target_->SetEvictionCallback(
+      [this](const Slice& key, Handle* handle, bool was_hit) {
+        return EvictionHandler(key, handle, was_hit);
+      });
+}
+
+CacheWithCompressedTier::~CacheWithCompressedTier() {
+  // `*this` will be destroyed before `*target_`, so we have to prevent
+  // use after free
+  target_->SetEvictionCallback({});
+}
+
+bool CacheWithCompressedTier::IsSupported(CompressionType compression_type) {
+  return CompressionTypeSupported(compression_type);
+}
+
+bool CacheWithCompressedTier::EvictionHandler(const Slice& key, Handle* handle,
+                                              bool was_hit) {
+  const CacheItemHelper* helper = target_->GetCacheItemHelper(handle);
+  // Entries never hit since their insertion are cold enough to drop
+  if (!was_hit || !helper->IsSecondaryCacheCompatible()) {
+    return false;
+  }
+  ObjectPtr obj = target_->Value(handle);
+  const size_t size = helper->size_cb(obj);
+  std::string raw(size, '\0');
+  if (!helper->saveto_cb(obj, 0, size, raw.data()).ok()) {
+    return false;
+  }
+
+  CompressionOptions compression_opts;
+  CompressionContext compression_context(compression_type_, compression_opts);
+  CompressionInfo compression_info(compression_opts, compression_context,
+                                   CompressionDict::GetEmptyDict(),
+                                   compression_type_,
+                                   /*sample_for_compression=*/0);
+  std::string compressed;
+  if (!CompressData(raw, compression_info, kCompressFormatVersion,
+                    &compressed) ||
+      compressed.size() >= size) {
+    return false;
+  }
+
+  MutexLock l(&demoted_mutex_);
+  demoted_.push_back(Demoted{key.ToString(), std::move(compressed),
+                             helper->role});
+  num_demoted_.store(demoted_.size(), std::memory_order_relaxed);
+  // The cache still destroys obj
+  return false;
+}
+
+void CacheWithCompressedTier::InsertDemoted() {
+  if (num_demoted_.load(std::memory_order_relaxed) == 0) {
+    return;
+  }
+  std::vector<Demoted> demoted;
+  {
+    MutexLock l(&demoted_mutex_);
+    demoted.swap(demoted_);
+    num_demoted_.store(0, std::memory_order_relaxed);
+  }
+  // Evictions by these insertions are demoted for the next call
+  for (Demoted& d : demoted) {
+    TEST_SYNC_POINT_CALLBACK("CacheWithCompressedTier::InsertDemoted",
+                             &d.key);
+    // The entry may have been inserted again since it was evicted, and the
+    // copy must not take its place
+    Handle* existing = target_->Lookup(d.key);
+    if (existing != nullptr) {
+      target_->Release(existing);
+      continue;
+    }
+    auto* data = new std::string(std::move(d.data));
+    Status s = target_->Insert(d.key, data, GetCompressedHelper(d.role),
+                               data->size());
+    if (!s.ok()) {
+      DeleteCompressed(data, nullptr);
+    }
+  }
+}
+
+Status CacheWithCompressedTier::Insert(const Slice& key, ObjectPtr value,
+                                       const CacheItemHelper* helper,
+                                       size_t charge, Handle** handle,
+                                       Priority priority,
+                                       const Slice& compressed_value,
+                                       CompressionType type) {
+  Status s = target_->Insert(key, value, helper, charge, handle, priority,
+                             compressed_value, type);
+  InsertDemoted();
+  return s;
+}
+
+Cache::Handle* CacheWithCompressedTier::Lookup(const Slice& key,
+                                               const CacheItemHelper* helper,
+                                               CreateContext* create_context,
+                                               Priority priority,
+                                               Statistics* stats) {
+  Handle* result =
+      target_->Lookup(key, helper, create_context, priority, stats);
+  if (result != nullptr && IsCompressed(target_->GetCacheItemHelper(result))) {
+    result = Promote(key, result, helper, create_context, priority);
+  }
+  return result;
+}
+
+void CacheWithCompressedTier::StartAsyncLookup(
+    AsyncLookupHandle& async_handle) {
+  // Synchronous, through Lookup() above
+  Cache::StartAsyncLookup(async_handle);
+}
+
+Cache::Handle* CacheWithCompressedTier::Promote(
+    const Slice& key, Handle* handle, const CacheItemHelper* helper,
+    CreateContext* create_context, Priority priority) {
+  Status s;
+  ObjectPtr obj = nullptr;
+  size_t charge = 0;
+  if (helper == nullptr || !helper->IsSecondaryCacheCompatible() ||
+      create_context == nullptr) {
+    // The caller cannot recreate the entry, so it is a miss
+    s = Status::NotSupported();
+  } else {
+    const auto* data = static_cast<const std::string*>(target_->Value(handle));
+    UncompressionContext uncompression_context(compression_type_);
+    UncompressionInfo uncompression_info(uncompression_context,
+                                         UncompressionDict::GetEmptyDict(),
+                                         compression_type_);
+    size_t uncompressed_size = 0;
+    CacheAllocationPtr uncompressed = UncompressData(
+        uncompression_info, data->data(), data->size(), &uncompressed_size,
+        kCompressFormatVersion, target_->memory_allocator());
+    if (!uncompressed) {
+      s = Status::Corruption("Error uncompressing a cache entry");
+    } else {
+      s = helper->create_cb(Slice(uncompressed.get(), uncompressed_size),
+                            kNoCompression, CacheTier::kVolatileTier,
+                            create_context, target_->memory_allocator(), &obj,
+                            &charge);
+    }
+  }
+  target_->Release(handle, /*erase_if_last_ref=*/s.IsCorruption());
+  if (!s.ok()) {
+    return nullptr;
+  }
+
+  // Replaces the compressed copy
+  Handle* result = nullptr;
+  s = target_->Insert(key, obj, helper, charge, &result, priority);
+  if (!s.ok()) {
+    // Avoid reading the entry from storage even if the cache is full
+    result = target_->CreateStandalone(key, obj, helper, charge,
+                                       /*allow_uncharged=*/true);
+    PERF_COUNTER_ADD(block_cache_standalone_handle_count, 1);
+  } else {
+    PERF_COUNTER_ADD(block_cache_real_handle_count, 1);
+  }
+  InsertDemoted();
+  return result;
+}
+
+std::string CacheWithCompressedTier::GetPrintableOptions() const {
+  std::string str = target_->GetPrintableOptions();
+  str.append("    demotion_compression_type : ");
+  str.append(CompressionTypeToString(compression_type_));
+  str.append("\n");
+  return str;
+}
+
+}  // namespace ROCKSDB_NAMESPACE
@@ -0,0 +1,80 @@
+//  Copyright (c) Meta Platforms, Inc. and affiliates.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+
+#pragma once
+
+#include <atomic>
+#include <string>
+#include <vector>
+
+#include "port/port.h"
+#include "rocksdb/advanced_cache.h"
+
+namespace ROCKSDB_NAMESPACE {
+
+// Keeps a tier of compressed entries inside the wrapped cache, see
+// HyperClockCacheOptions::demotion_compression_type. Secondary cache
+// compatible entries that the cache evicts after they were hit are demoted
+// to a compressed copy under the same key, charged for its compressed size.
+// A lookup finding a copy recreates the entry with the create callback of
+// its helper, and inserts it in place of the copy. Copies are evicted like
+// the other entries, without another demotion.
+//
+// The eviction callback cannot insert into the cache, so the copies made by
+// an insertion are inserted once it returns.
+class CacheWithCompressedTier : public CacheWrapper {
+ public:
+  CacheWithCompressedTier(std::shared_ptr<Cache> target,
+                          CompressionType compression_type);
+
+  ~CacheWithCompressedTier() override;
+
+  // Whether entries can be demoted with compression_type in this build.
+  static bool IsSupported(CompressionType compression_type);
+
+  const char* Name() const override { return "CacheWithCompressedTier"; }
+
+  Status Insert(
+      const Slice& key, ObjectPtr value, const CacheItemHelper* helper,
+      size_t charge, Handle** handle = nullptr,
+      Priority priority = Priority::LOW,
+      const Slice& compressed_value = Slice(),
+      CompressionType type = CompressionType::kNoCompression) override;
+
+  Handle* Lookup(const Slice& key, const CacheItemHelper* helper,
+                 CreateContext* create_context,
+                 Priority priority = Priority::LOW,
+                 Statistics* stats = nullptr) override;
+
+  void StartAsyncLookup(AsyncLookupHandle& async_handle) override;
+
+  std::string GetPrintableOptions() const override;
+
+ private:
+  struct Demoted {
+    std::string key;
+    std::string data;
+    CacheEntryRole role;
+  };
+
+  bool EvictionHandler(const Slice& key, Handle* handle, bool was_hit);
+
+  // Inserts the copies demoted since the last call, unless their key is in
+  // the cache again.
+  void InsertDemoted();
+
+  // Recreates the entry compressed in handle, which is released, and
+  // inserts it. Returns nullptr if it cannot be recreated.
+  Handle* Promote(const Slice& key, Handle* handle,
+                  const CacheItemHelper* helper, CreateContext* create_context,
+                  Priority priority);
+
+  const CompressionType compression_type_;
+  port::Mutex demoted_mutex_;
+  std::vector<Demoted> demoted_;
+  std::atomic<size_t> num_demoted_{0};
+};
+
+}  // namespace ROCKSDB_NAMESPACE
@@ -0,0 +1,77 @@
+//  Copyright (c) 2011-present, Facebook, Inc.  All rights reserved.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+
+#include "cache/frequency_sketch.h"
+
+#include <algorithm>
+
+#include "util/math.h"
+
+namespace ROCKSDB_NAMESPACE {
+
+FrequencySketch::FrequencySketch(size_t num_counters) {
+  // At least one word per row.
+  num_counters = std::max(num_counters, size_t{16});
+  row_bits_ = FloorLog2(num_counters);
+  if ((size_t{1} << row_bits_) < num_counters) {
+    row_bits_++;
+  }
+  num_words_ = (size_t{kDepth} << row_bits_) / 16;
+  table_.reset(new uint64_t[num_words_]());
+  sample_size_ = size_t{10} << row_bits_;
+}
+
+size_t FrequencySketch::CounterIndex(uint32_t hash, int row) const {
+  // A different multiplier per row keeps the rows independent, and the
+  // upper bits of the product depend on all bits of the hash.
+  static constexpr uint64_t kMultipliers[kDepth] = {
+      0x9E3779B97F4A7C15U, 0xC2B2AE3D27D4EB4FU, 0x165667B19E3779F9U,
+      0xD6E8FEB86659FD93U};
+  const uint64_t h = (uint64_t{hash} + 1) * kMultipliers[row];
+  return (static_cast<size_t>(row) << row_bits_) +
+         static_cast<size_t>(h >> (64 - row_bits_));
+}
+
+uint32_t FrequencySketch::GetCounter(size_t index) const {
+  return static_cast<uint32_t>(table_[index / 16] >> (index % 16 * 4)) &
+         kMaxCount;
+}
+
+void FrequencySketch::Increment(uint32_t hash) {
+  bool added = false;
+  for (int row = 0; row < kDepth; row++) {
+    const size_t index = CounterIndex(hash, row);
+    if (GetCounter(index) < kMaxCount) {
+      table_[index / 16] += uint64_t{1} << (index % 16 * 4);
+      added = true;
+    }
+  }
+  if (added && ++additions_ >= sample_size_) {
+    Age();
+  }
+}
+
+uint32_t FrequencySketch::Estimate(uint32_t hash) const {
+  uint32_t count = kMaxCount;
+  for (int row = 0; row < kDepth; row++) {
+    count = std::min(count, GetCounter(CounterIndex(hash, row)));
+  }
+  return count;
+}
+
+void FrequencySketch::Age() {
+  for (size_t i = 0; i < num_words_; i++) {
+    // Shift every counter right by one, dropping the bit that moves into the
+    // counter below it.
+    table_[i] = (table_[i] >> 1) & 0x7777777777777777U;
+  }
+  additions_ /= 2;
+}
+
+size_t FrequencySketch::ApproximateMemoryUsage() const {
+  return sizeof(*this) + num_words_ * sizeof(uint64_t);
+}
+
+}  // namespace ROCKSDB_NAMESPACE
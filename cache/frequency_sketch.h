@@ -0,0 +1,57 @@
+//  Copyright (c) 2011-present, Facebook, Inc.  All rights reserved.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+#include "rocksdb/rocksdb_namespace.h"
+
+namespace ROCKSDB_NAMESPACE {
+
+// A count-min sketch of how often each key of a cache was accessed recently,
+// as used by the TinyLFU admission policy. Each key has a 4-bit counter in
+// each of four rows, and its estimated frequency is the smallest of them.
+// Once the number of increments reaches ten times the number of counters in
+// a row, all counters are halved, so that the sketch follows changes of the
+// working set.
+//
+// This class is not thread-safe.
+class FrequencySketch {
+ public:
+  // The sketch has at least `num_counters` counters per row, rounded up to
+  // a power of two, for about as many distinct keys.
+  explicit FrequencySketch(size_t num_counters);
+
+  // Records an access to the key with the given hash.
+  void Increment(uint32_t hash);
+
+  // Returns the estimated number of recent accesses to the key, at most 15.
+  uint32_t Estimate(uint32_t hash) const;
+
+  size_t ApproximateMemoryUsage() const;
+
+ private:
+  static constexpr int kDepth = 4;
+  static constexpr uint32_t kMaxCount = 15;
+
+  // The counter of the key in the row, counting from the start of the table.
+  size_t CounterIndex(uint32_t hash, int row) const;
+  uint32_t GetCounter(size_t index) const;
+
+  // Halves all counters.
+  void Age();
+
+  int row_bits_;
+  size_t num_words_;
+  // kDepth rows of 4-bit counters, 16 per word.
+  std::unique_ptr<uint64_t[]> table_;
+  size_t additions_ = 0;
+  size_t sample_size_;
+};
+
+}  // namespace ROCKSDB_NAMESPACE
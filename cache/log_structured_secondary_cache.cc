@@ -0,0 +1,395 @@
+//  Copyright (c) Meta Platforms, Inc. and affiliates.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+
+#include "cache/log_structured_secondary_cache.h"
+
+#include <cinttypes>
+
+#include "file/file_util.h"
+#include "util/coding.h"
+#include "util/crc32c.h"
+#include "util/hash.h"
+#include "util/mutexlock.h"
+#include "util/string_util.h"
+
+namespace ROCKSDB_NAMESPACE {
+
+LogStructuredSecondaryCacheResultHandle::
+    ~LogStructuredSecondaryCacheResultHandle() {
+  if (io_handle_ != nullptr) {
+    // The read must not outlive buf_, and nobody takes the value
+    cache_->WaitAll({this});
+    if (value_ != nullptr) {
+      helper_->del_cb(value_, /*allocator=*/nullptr);
+    }
+  }
+}
+
+void LogStructuredSecondaryCacheResultHandle::Wait() {
+  if (!ready_) {
+    cache_->WaitAll({this});
+  }
+}
+
+void LogStructuredSecondaryCacheResultHandle::OnReadDone(FSReadRequest& req,
+                                                         void* cb_arg) {
+  auto handle = static_cast<LogStructuredSecondaryCacheResultHandle*>(cb_arg);
+  handle->req_.status = req.status;
+  handle->req_.result = req.result;
+  handle->read_done_ = true;
+}
+
+LogStructuredSecondaryCache::LogStructuredSecondaryCache(
+    const LogStructuredSecondaryCacheOptions& opts)
+    : opts_(opts),
+      fs_(opts.fs ? opts.fs : FileSystem::Default()),
+      file_name_(opts.path + "/secondary_cache.dat"),
+      segment_size_(opts.segment_size / kRecordAlignment * kRecordAlignment),
+      num_segments_(opts.capacity / segment_size_) {
+  segment_keys_.resize(num_segments_);
+}
+
+Status LogStructuredSecondaryCache::Open(
+    const LogStructuredSecondaryCacheOptions& opts,
+    std::shared_ptr<SecondaryCache>* result) {
+  if (opts.path.empty()) {
+    return Status::InvalidArgument("No path for the secondary cache");
+  }
+  if (opts.segment_size < kRecordAlignment ||
+      opts.segment_size > kMaxSegmentSize) {
+    return Status::InvalidArgument("segment_size must be at most 16MB");
+  }
+  if (opts.capacity / opts.segment_size < 2) {
+    return Status::InvalidArgument(
+        "capacity must be at least two segments of segment_size");
+  }
+  std::unique_ptr<LogStructuredSecondaryCache> cache(
+      new LogStructuredSecondaryCache(opts));
+  FileSystem* fs = cache->fs_.get();
+  IOStatus s = fs->CreateDirIfMissing(opts.path, IOOptions(), nullptr);
+  if (s.ok()) {
+    // Creates or truncates the file
+    std::unique_ptr<FSWritableFile> file;
+    s = fs->NewWritableFile(cache->file_name_, FileOptions(), &file, nullptr);
+    if (s.ok()) {
+      s = file->Close(IOOptions(), nullptr);
+    }
+  }
+  if (s.ok()) {
+    s = fs->NewRandomRWFile(cache->file_name_, FileOptions(), &cache->writer_,
+                            nullptr);
+  }
+  if (s.ok()) {
+    s = fs->NewRandomAccessFile(cache->file_name_, FileOptions(),
+                                &cache->reader_, nullptr);
+  }
+  if (!s.ok()) {
+    return s;
+  }
+  cache->use_async_io_ = CheckFSFeatureSupport(fs, FSSupportedOps::kAsyncIO);
+  result->reset(cache.release());
+  return Status::OK();
+}
+
+LogStructuredSecondaryCache::~LogStructuredSecondaryCache() {
+  reader_.reset();
+  if (writer_) {
+    writer_->Close(IOOptions(), nullptr).PermitUncheckedError();
+    writer_.reset();
+    fs_->DeleteFile(file_name_, IOOptions(), nullptr).PermitUncheckedError();
+  }
+}
+
+Status LogStructuredSecondaryCache::Insert(const Slice& key,
+                                           Cache::ObjectPtr value,
+                                           const Cache::CacheItemHelper* helper,
+                                           bool /*force_insert*/) {
+  if (helper == nullptr || !helper->IsSecondaryCacheCompatible()) {
+    return Status::OK();
+  }
+  const size_t size = (*helper->size_cb)(value);
+  if (size > segment_size_ ||
+      (opts_.max_value_size > 0 && size > opts_.max_value_size)) {
+    return Status::OK();
+  }
+  std::string saved(size, '\0');
+  Status s = (*helper->saveto_cb)(value, 0, size, &saved[0]);
+  if (!s.ok()) {
+    return s;
+  }
+  return InsertSaved(key, saved, kNoCompression, CacheTier::kVolatileTier);
+}
+
+Status LogStructuredSecondaryCache::InsertSaved(const Slice& key,
+                                                const Slice& saved,
+                                                CompressionType type,
+                                                CacheTier source) {
+  if (opts_.max_value_size > 0 && saved.size() > opts_.max_value_size) {
+    return Status::OK();
+  }
+  std::string record(sizeof(uint32_t), '\0');
+  PutVarint32(&record, static_cast<uint32_t>(key.size()));
+  PutVarint32(&record, static_cast<uint32_t>(saved.size()));
+  record.push_back(static_cast<char>(type));
+  record.push_back(static_cast<char>(source));
+  record.append(key.data(), key.size());
+  if (record.size() + saved.size() > segment_size_ ||
+      record.size() + saved.size() >= kMaxSegmentSize) {
+    return Status::OK();
+  }
+  record.append(saved.data(), saved.size());
+  EncodeFixed32(&record[0],
+                crc32c::Mask(crc32c::Value(record.data() + sizeof(uint32_t),
+                                           record.size() - sizeof(uint32_t))));
+  const size_t padded_size =
+      (record.size() + kRecordAlignment - 1) / kRecordAlignment *
+      kRecordAlignment;
+
+  const uint64_t hash = GetSliceNPHash64(key);
+  MutexLock l(&mutex_);
+  if (!write_status_.ok()) {
+    return write_status_;
+  }
+  if (index_.find(hash) != index_.end()) {
+    return Status::OK();
+  }
+  const uint64_t segment_start = uint64_t{cur_segment_} * segment_size_;
+  if (buffer_offset_ + buffer_.size() - segment_start + padded_size >
+      segment_size_) {
+    Status s = NextSegment();
+    if (!s.ok()) {
+      return s;
+    }
+  }
+  const uint64_t offset = buffer_offset_ + buffer_.size();
+  buffer_.append(record);
+  buffer_.resize(buffer_.size() + padded_size - record.size(), '\0');
+  index_[hash] = PackLocation(offset, record.size());
+  segment_keys_[cur_segment_].push_back(hash);
+  if (buffer_.size() >= opts_.write_buffer_size) {
+    return FlushBuffer();
+  }
+  return Status::OK();
+}
+
+Status LogStructuredSecondaryCache::FlushBuffer() {
+  mutex_.AssertHeld();
+  if (buffer_.empty()) {
+    return Status::OK();
+  }
+  IOStatus s = writer_->Write(buffer_offset_, buffer_, IOOptions(), nullptr);
+  if (!s.ok()) {
+    // Lookups of the records lost fail their checksum
+    write_status_ = s;
+  }
+  buffer_offset_ += buffer_.size();
+  buffer_.clear();
+  return s;
+}
+
+Status LogStructuredSecondaryCache::NextSegment() {
+  mutex_.AssertHeld();
+  Status s = FlushBuffer();
+  cur_segment_ = (cur_segment_ + 1) % num_segments_;
+  for (uint64_t hash : segment_keys_[cur_segment_]) {
+    auto it = index_.find(hash);
+    // Unless replaced by a later record of a colliding key
+    if (it != index_.end() &&
+        LocationOffset(it->second) / segment_size_ == cur_segment_) {
+      index_.erase(it);
+    }
+  }
+  segment_keys_[cur_segment_].clear();
+  buffer_offset_ = uint64_t{cur_segment_} * segment_size_;
+  return s;
+}
+
+std::unique_ptr<SecondaryCacheResultHandle> LogStructuredSecondaryCache::Lookup(
+    const Slice& key, const Cache::CacheItemHelper* helper,
+    Cache::CreateContext* create_context, bool wait, bool /*advise_erase*/,
+    Statistics* /*stats*/, bool& kept_in_sec_cache) {
+  kept_in_sec_cache = false;
+  if (helper == nullptr || helper->create_cb == nullptr) {
+    return nullptr;
+  }
+  const uint64_t hash = GetSliceNPHash64(key);
+  std::unique_ptr<LogStructuredSecondaryCacheResultHandle> handle(
+      new LogStructuredSecondaryCacheResultHandle());
+  uint64_t offset;
+  size_t size;
+  {
+    MutexLock l(&mutex_);
+    auto it = index_.find(hash);
+    if (it == index_.end()) {
+      return nullptr;
+    }
+    offset = LocationOffset(it->second);
+    size = LocationSize(it->second);
+    handle->buf_.reset(new char[size]);
+    if (offset >= buffer_offset_ &&
+        offset < buffer_offset_ + buffer_.size()) {
+      // Not written yet
+      memcpy(handle->buf_.get(), buffer_.data() + (offset - buffer_offset_),
+             size);
+      handle->req_.result = Slice(handle->buf_.get(), size);
+      handle->read_done_ = true;
+    }
+  }
+  handle->cache_ = this;
+  handle->key_ = key.ToString();
+  handle->helper_ = helper;
+  handle->create_context_ = create_context;
+  handle->req_.offset = offset;
+  handle->req_.len = size;
+  handle->req_.scratch = handle->buf_.get();
+  kept_in_sec_cache = true;
+
+  if (!handle->read_done_) {
+    if (wait || !use_async_io_) {
+      ReadRecord(handle.get(), offset, size);
+    } else {
+      IOStatus s = reader_->ReadAsync(
+          handle->req_, IOOptions(),
+          &LogStructuredSecondaryCacheResultHandle::OnReadDone, handle.get(),
+          &handle->io_handle_, &handle->del_fn_, nullptr);
+      if (!s.ok()) {
+        // For example without an io_uring for this thread
+        assert(handle->io_handle_ == nullptr);
+        ReadRecord(handle.get(), offset, size);
+      } else if (handle->io_handle_ != nullptr) {
+        // Completed by WaitAll
+        return handle;
+      }
+    }
+  }
+  FinishLookup(handle.get());
+  return handle;
+}
+
+void LogStructuredSecondaryCache::ReadRecord(
+    LogStructuredSecondaryCacheResultHandle* handle, uint64_t offset,
+    size_t size) {
+  handle->req_.status =
+      reader_->Read(offset, size, IOOptions(), &handle->req_.result,
+                    handle->buf_.get(), nullptr);
+  handle->read_done_ = true;
+}
+
+void LogStructuredSecondaryCache::FinishLookup(
+    LogStructuredSecondaryCacheResultHandle* handle) {
+  assert(handle->read_done_);
+  handle->ready_ = true;
+  Slice record = handle->req_.result;
+  if (!handle->req_.status.ok() || record.size() != handle->req_.len ||
+      record.size() < sizeof(uint32_t) ||
+      crc32c::Unmask(DecodeFixed32(record.data())) !=
+          crc32c::Value(record.data() + sizeof(uint32_t),
+                        record.size() - sizeof(uint32_t))) {
+    handle->buf_.reset();
+    return;
+  }
+  record.remove_prefix(sizeof(uint32_t));
+  uint32_t key_size = 0;
+  uint32_t data_size = 0;
+  if (!GetVarint32(&record, &key_size) || !GetVarint32(&record, &data_size) ||
+      record.size() != 2 + uint64_t{key_size} + data_size ||
+      Slice(record.data() + 2, key_size) != handle->key_) {
+    // Another key with the same hash
+    handle->buf_.reset();
+    return;
+  }
+  const auto type = static_cast<CompressionType>(record[0]);
+  const auto source = static_cast<CacheTier>(record[1]);
+  const Slice data(record.data() + 2 + key_size, data_size);
+  Status s = handle->helper_->create_cb(data, type, source,
+                                        handle->create_context_,
+                                        /*allocator=*/nullptr, &handle->value_,
+                                        &handle->size_);
+  if (!s.ok()) {
+    handle->value_ = nullptr;
+    handle->size_ = 0;
+  }
+  handle->buf_.reset();
+}
+
+void LogStructuredSecondaryCache::WaitAll(
+    std::vector<SecondaryCacheResultHandle*> handles) {
+  std::vector<LogStructuredSecondaryCacheResultHandle*> pending;
+  std::vector<void*> io_handles;
+  for (auto handle : handles) {
+    auto h = static_cast<LogStructuredSecondaryCacheResultHandle*>(handle);
+    if (h->io_handle_ != nullptr) {
+      pending.push_back(h);
+      io_handles.push_back(h->io_handle_);
+    }
+  }
+  if (!io_handles.empty()) {
+    IOStatus s = fs_->Poll(io_handles, io_handles.size());
+    if (!s.ok()) {
+      fs_->AbortIO(io_handles).PermitUncheckedError();
+    }
+  }
+  for (auto h : pending) {
+    h->del_fn_(h->io_handle_);
+    h->io_handle_ = nullptr;
+    if (!h->read_done_ || !h->req_.status.ok() ||
+        h->req_.result.size() != h->req_.len) {
+      // Retry an aborted or short read
+      ReadRecord(h, h->req_.offset, h->req_.len);
+    }
+    FinishLookup(h);
+  }
+}
+
+void LogStructuredSecondaryCache::Erase(const Slice& key) {
+  MutexLock l(&mutex_);
+  index_.erase(GetSliceNPHash64(key));
+}
+
+Status LogStructuredSecondaryCache::GetCapacity(size_t& capacity) {
+  capacity = num_segments_ * segment_size_;
+  return Status::OK();
+}
+
+std::string LogStructuredSecondaryCache::GetPrintableOptions() const {
+  std::string ret;
+  ret.reserve(20000);
+  const int kBufferSize{200};
+  char buffer[kBufferSize];
+  snprintf(buffer, kBufferSize, "    path : %s\n", opts_.path.c_str());
+  ret.append(buffer);
+  snprintf(buffer, kBufferSize, "    capacity : %" ROCKSDB_PRIszt "\n",
+           num_segments_ * segment_size_);
+  ret.append(buffer);
+  snprintf(buffer, kBufferSize, "    segment_size : %" ROCKSDB_PRIszt "\n",
+           segment_size_);
+  ret.append(buffer);
+  snprintf(buffer, kBufferSize, "    write_buffer_size : %" ROCKSDB_PRIszt "\n",
+           opts_.write_buffer_size);
+  ret.append(buffer);
+  snprintf(buffer, kBufferSize, "    max_value_size : %" ROCKSDB_PRIszt "\n",
+           opts_.max_value_size);
+  ret.append(buffer);
+  snprintf(buffer, kBufferSize, "    async_io : %d\n", use_async_io_);
+  ret.append(buffer);
+  return ret;
+}
+
+Status LogStructuredSecondaryCache::TEST_Flush() {
+  MutexLock l(&mutex_);
+  return FlushBuffer();
+}
+
+size_t LogStructuredSecondaryCache::TEST_GetNumEntries() {
+  MutexLock l(&mutex_);
+  return index_.size();
+}
+
+Status LogStructuredSecondaryCacheOptions::MakeSharedSecondaryCache(
+    std::shared_ptr<SecondaryCache>* result) const {
+  return LogStructuredSecondaryCache::Open(*this, result);
+}
+
+}  // namespace ROCKSDB_NAMESPACE
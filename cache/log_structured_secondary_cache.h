@@ -0,0 +1,159 @@
+//  Copyright (c) Meta Platforms, Inc. and affiliates.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+
+#pragma once
+
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "port/port.h"
+#include "rocksdb/cache.h"
+#include "rocksdb/file_system.h"
+#include "rocksdb/secondary_cache.h"
+
+namespace ROCKSDB_NAMESPACE {
+
+class LogStructuredSecondaryCache;
+
+// The result of a lookup, which may be waiting for an asynchronous read
+class LogStructuredSecondaryCacheResultHandle
+    : public SecondaryCacheResultHandle {
+ public:
+  ~LogStructuredSecondaryCacheResultHandle() override;
+
+  bool IsReady() override { return ready_; }
+
+  void Wait() override;
+
+  Cache::ObjectPtr Value() override { return value_; }
+
+  size_t Size() override { return size_; }
+
+ private:
+  friend class LogStructuredSecondaryCache;
+
+  static void OnReadDone(FSReadRequest& req, void* cb_arg);
+
+  LogStructuredSecondaryCache* cache_ = nullptr;
+  std::string key_;
+  const Cache::CacheItemHelper* helper_ = nullptr;
+  Cache::CreateContext* create_context_ = nullptr;
+  std::unique_ptr<char[]> buf_;
+  FSReadRequest req_;
+  void* io_handle_ = nullptr;
+  IOHandleDeleter del_fn_;
+  bool read_done_ = false;
+  Cache::ObjectPtr value_ = nullptr;
+  size_t size_ = 0;
+  bool ready_ = false;
+};
+
+// A SecondaryCache on local flash, see LogStructuredSecondaryCacheOptions.
+//
+// The cache file is a ring of segments, each filled with records
+//   crc32c | varint32 key size | varint32 data size | compression type |
+//   source tier | key | data
+// aligned to kRecordAlignment. When the segment being written is full, the
+// next one is reclaimed by dropping the index entries of its records. A read
+// that races with the reclamation of its segment fails the checksum or key
+// check and is a miss.
+//
+// The index maps a 64-bit hash of each key to the offset and size of its
+// record, packed into 64 bits. Records of keys with colliding hashes replace
+// each other, and lookups check the key stored in the record.
+class LogStructuredSecondaryCache : public SecondaryCache {
+ public:
+  // Use LogStructuredSecondaryCacheOptions::MakeSharedSecondaryCache()
+  static Status Open(const LogStructuredSecondaryCacheOptions& opts,
+                     std::shared_ptr<SecondaryCache>* result);
+
+  ~LogStructuredSecondaryCache() override;
+
+  const char* Name() const override { return "LogStructuredSecondaryCache"; }
+
+  Status Insert(const Slice& key, Cache::ObjectPtr value,
+                const Cache::CacheItemHelper* helper,
+                bool force_insert) override;
+
+  Status InsertSaved(const Slice& key, const Slice& saved, CompressionType type,
+                     CacheTier source) override;
+
+  std::unique_ptr<SecondaryCacheResultHandle> Lookup(
+      const Slice& key, const Cache::CacheItemHelper* helper,
+      Cache::CreateContext* create_context, bool wait, bool advise_erase,
+      Statistics* stats, bool& kept_in_sec_cache) override;
+
+  bool SupportForceErase() const override { return false; }
+
+  void Erase(const Slice& key) override;
+
+  void WaitAll(std::vector<SecondaryCacheResultHandle*> handles) override;
+
+  Status GetCapacity(size_t& capacity) override;
+
+  std::string GetPrintableOptions() const override;
+
+  // Writes the buffered records to the file
+  Status TEST_Flush();
+
+  size_t TEST_GetNumEntries();
+
+ private:
+  friend class LogStructuredSecondaryCacheResultHandle;
+
+  static constexpr size_t kRecordAlignment = 8;
+  static constexpr int kSizeBits = 24;
+  static constexpr size_t kMaxSegmentSize = size_t{1} << kSizeBits;
+
+  explicit LogStructuredSecondaryCache(
+      const LogStructuredSecondaryCacheOptions& opts);
+
+  static uint64_t PackLocation(uint64_t offset, size_t size) {
+    return ((offset / kRecordAlignment) << kSizeBits) | size;
+  }
+  static uint64_t LocationOffset(uint64_t loc) {
+    return (loc >> kSizeBits) * kRecordAlignment;
+  }
+  static size_t LocationSize(uint64_t loc) {
+    return static_cast<size_t>(loc & (kMaxSegmentSize - 1));
+  }
+
+  // Requires mutex_ held
+  Status FlushBuffer();
+  // Moves on to the next segment, dropping the records it had. Requires
+  // mutex_ held.
+  Status NextSegment();
+
+  // Reads a record synchronously into handle->buf_
+  void ReadRecord(LogStructuredSecondaryCacheResultHandle* handle,
+                  uint64_t offset, size_t size);
+  // Checks the record read for the handle and creates its value
+  void FinishLookup(LogStructuredSecondaryCacheResultHandle* handle);
+
+  const LogStructuredSecondaryCacheOptions opts_;
+  std::shared_ptr<FileSystem> fs_;
+  std::string file_name_;
+  std::unique_ptr<FSRandomRWFile> writer_;
+  std::unique_ptr<FSRandomAccessFile> reader_;
+  const size_t segment_size_;
+  const size_t num_segments_;
+  bool use_async_io_ = false;
+
+  port::Mutex mutex_;
+  // Key hash -> packed location of its record
+  std::unordered_map<uint64_t, uint64_t> index_;
+  // Key hashes of the records of each segment, for reclaiming it
+  std::vector<std::vector<uint64_t>> segment_keys_;
+  size_t cur_segment_ = 0;
+  // The records not yet written, from file offset buffer_offset_
+  std::string buffer_;
+  uint64_t buffer_offset_ = 0;
+  // Status of the last failed write, after which nothing is inserted
+  Status write_status_;
+};
+
+}  // namespace ROCKSDB_NAMESPACE
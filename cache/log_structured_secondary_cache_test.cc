@@ -0,0 +1,363 @@
+//  Copyright (c) Meta Platforms, Inc. and affiliates.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+
+#include "cache/log_structured_secondary_cache.h"
+
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "cache/tiered_secondary_cache.h"
+#include "rocksdb/cache.h"
+#include "rocksdb/file_system.h"
+#include "test_util/secondary_cache_test_util.h"
+#include "test_util/testharness.h"
+#include "util/random.h"
+
+namespace ROCKSDB_NAMESPACE {
+
+using secondary_cache_test_util::WithCacheType;
+
+// A FileSystem with asynchronous reads that are only done when polled
+class DeferredReadFileSystem : public FileSystemWrapper {
+ public:
+  explicit DeferredReadFileSystem(const std::shared_ptr<FileSystem>& target)
+      : FileSystemWrapper(target) {}
+
+  static const char* kClassName() { return "DeferredReadFileSystem"; }
+  const char* Name() const override { return kClassName(); }
+
+  void SupportedOps(int64_t& supported_ops) override {
+    supported_ops = 1 << FSSupportedOps::kAsyncIO;
+  }
+
+  IOStatus NewRandomAccessFile(const std::string& fname,
+                               const FileOptions& file_opts,
+                               std::unique_ptr<FSRandomAccessFile>* result,
+                               IODebugContext* dbg) override {
+    std::unique_ptr<FSRandomAccessFile> file;
+    IOStatus s = target()->NewRandomAccessFile(fname, file_opts, &file, dbg);
+    if (s.ok()) {
+      result->reset(new File(std::move(file)));
+    }
+    return s;
+  }
+
+  IOStatus Poll(std::vector<void*>& io_handles,
+                size_t /*min_completions*/) override {
+    for (void* io_handle : io_handles) {
+      auto read = static_cast<PendingRead*>(io_handle);
+      if (!read->done) {
+        FSReadRequest req;
+        req.offset = read->offset;
+        req.len = read->len;
+        req.scratch = read->scratch;
+        req.status = read->file->Read(req.offset, req.len, IOOptions(),
+                                      &req.result, req.scratch, nullptr);
+        read->cb(req, read->cb_arg);
+        read->done = true;
+        num_polled_++;
+      }
+    }
+    return IOStatus::OK();
+  }
+
+  IOStatus AbortIO(std::vector<void*>& /*io_handles*/) override {
+    return IOStatus::OK();
+  }
+
+  int num_polled_ = 0;
+
+ private:
+  struct PendingRead {
+    FSRandomAccessFile* file;
+    uint64_t offset;
+    size_t len;
+    char* scratch;
+    std::function<void(FSReadRequest&, void*)> cb;
+    void* cb_arg;
+    bool done = false;
+  };
+
+  class File : public FSRandomAccessFileOwnerWrapper {
+   public:
+    using FSRandomAccessFileOwnerWrapper::FSRandomAccessFileOwnerWrapper;
+
+    IOStatus ReadAsync(FSReadRequest& req, const IOOptions& /*opts*/,
+                       std::function<void(FSReadRequest&, void*)> cb,
+                       void* cb_arg, void** io_handle, IOHandleDeleter* del_fn,
+                       IODebugContext* /*dbg*/) override {
+      auto read = new PendingRead{target(), req.offset, req.len,
+                                  req.scratch, cb, cb_arg};
+      *io_handle = read;
+      *del_fn = [](void* arg) { delete static_cast<PendingRead*>(arg); };
+      return IOStatus::OK();
+    }
+  };
+};
+
+class LogStructuredSecondaryCacheTest : public testing::Test,
+                                        public WithCacheType {
+ public:
+  LogStructuredSecondaryCacheTest() {
+    opts_.path = test::PerThreadDBPath("log_structured_secondary_cache_test");
+    opts_.capacity = 4 << 16;
+    opts_.segment_size = 1 << 16;
+    opts_.write_buffer_size = 4 << 10;
+  }
+
+  const std::string& Type() const override {
+    static const std::string kType = kLRU;
+    return kType;
+  }
+
+ protected:
+  void Open() {
+    sec_cache_.reset();
+    ASSERT_OK(opts_.MakeSharedSecondaryCache(&sec_cache_));
+  }
+
+  LogStructuredSecondaryCache* cache() {
+    return static_cast<LogStructuredSecondaryCache*>(sec_cache_.get());
+  }
+
+  // 16 bytes for HCC compatibility
+  static std::string Key(int i) {
+    std::string key = std::to_string(i);
+    return std::string(16 - key.size(), '_') + key;
+  }
+
+  // Returns the value looked up for the key, empty for a miss
+  std::string Lookup(const std::string& key, bool wait = true) {
+    bool kept_in_sec_cache = false;
+    auto handle =
+        sec_cache_->Lookup(key, GetHelper(), this, wait,
+                           /*advise_erase=*/false, nullptr, kept_in_sec_cache);
+    if (handle == nullptr) {
+      return "";
+    }
+    EXPECT_TRUE(kept_in_sec_cache);
+    handle->Wait();
+    std::unique_ptr<TestItem> item(static_cast<TestItem*>(handle->Value()));
+    return item ? item->ToString() : "";
+  }
+
+  LogStructuredSecondaryCacheOptions opts_;
+  std::shared_ptr<SecondaryCache> sec_cache_;
+};
+
+TEST_F(LogStructuredSecondaryCacheTest, BasicTest) {
+  Open();
+  ASSERT_EQ(Lookup(Key(0)), "");
+
+  Random rnd(301);
+  std::string str1 = rnd.RandomString(1000);
+  TestItem item1(str1.data(), str1.size());
+  ASSERT_OK(sec_cache_->Insert(Key(1), &item1, GetHelper(), false));
+  std::string str2 = rnd.RandomString(2000);
+  ASSERT_OK(sec_cache_->InsertSaved(Key(2), str2));
+
+  // From the write buffer
+  ASSERT_EQ(Lookup(Key(1)), str1);
+  ASSERT_EQ(Lookup(Key(2)), str2);
+  // From the file
+  ASSERT_OK(cache()->TEST_Flush());
+  ASSERT_EQ(Lookup(Key(1)), str1);
+  ASSERT_EQ(Lookup(Key(2)), str2);
+  ASSERT_EQ(Lookup(Key(3)), "");
+
+  // Failing to create the value is a miss
+  SetFailCreate(true);
+  ASSERT_EQ(Lookup(Key(1)), "");
+  SetFailCreate(false);
+
+  sec_cache_->Erase(Key(1));
+  ASSERT_EQ(Lookup(Key(1)), "");
+  ASSERT_EQ(Lookup(Key(2)), str2);
+
+  size_t capacity = 0;
+  ASSERT_OK(sec_cache_->GetCapacity(capacity));
+  ASSERT_EQ(capacity, opts_.capacity);
+}
+
+TEST_F(LogStructuredSecondaryCacheTest, AsyncLookup) {
+  auto fs = std::make_shared<DeferredReadFileSystem>(FileSystem::Default());
+  opts_.fs = fs;
+  Open();
+  Random rnd(301);
+  std::vector<std::string> values;
+  for (int i = 0; i < 20; i++) {
+    values.push_back(rnd.RandomString(500 + i * 50));
+    ASSERT_OK(sec_cache_->InsertSaved(Key(i), values.back()));
+  }
+  // The last ones stay in the write buffer
+  ASSERT_OK(cache()->TEST_Flush());
+  values.push_back(rnd.RandomString(100));
+  ASSERT_OK(sec_cache_->InsertSaved(Key(20), values.back()));
+
+  std::vector<std::unique_ptr<SecondaryCacheResultHandle>> handles;
+  std::vector<SecondaryCacheResultHandle*> to_wait;
+  for (int i = 0; i <= 20; i++) {
+    bool kept_in_sec_cache = false;
+    handles.push_back(sec_cache_->Lookup(Key(i), GetHelper(), this,
+                                         /*wait=*/false,
+                                         /*advise_erase=*/false, nullptr,
+                                         kept_in_sec_cache));
+    ASSERT_NE(handles.back(), nullptr);
+    to_wait.push_back(handles.back().get());
+  }
+  for (int i = 0; i < 20; i++) {
+    ASSERT_FALSE(handles[i]->IsReady());
+  }
+  // Served from the write buffer
+  ASSERT_TRUE(handles[20]->IsReady());
+  sec_cache_->WaitAll(to_wait);
+  ASSERT_EQ(fs->num_polled_, 20);
+  for (int i = 0; i <= 20; i++) {
+    ASSERT_TRUE(handles[i]->IsReady());
+    std::unique_ptr<TestItem> item(static_cast<TestItem*>(handles[i]->Value()));
+    ASSERT_NE(item, nullptr);
+    ASSERT_EQ(item->ToString(), values[i]);
+    ASSERT_EQ(handles[i]->Size(), values[i].size());
+  }
+
+  // Waiting on a single handle, and destroying one not waited for
+  ASSERT_EQ(Lookup(Key(3), /*wait=*/false), values[3]);
+  bool kept_in_sec_cache = false;
+  auto handle = sec_cache_->Lookup(Key(4), GetHelper(), this, /*wait=*/false,
+                                   /*advise_erase=*/false, nullptr,
+                                   kept_in_sec_cache);
+  ASSERT_NE(handle, nullptr);
+  handle.reset();
+  ASSERT_EQ(fs->num_polled_, 22);
+}
+
+TEST_F(LogStructuredSecondaryCacheTest, SegmentReclamation) {
+  Open();
+  Random rnd(301);
+  std::vector<std::string> values;
+  // About four times the capacity
+  const int kNumValues = 1000;
+  for (int i = 0; i < kNumValues; i++) {
+    values.push_back(rnd.RandomString(1000));
+    ASSERT_OK(sec_cache_->InsertSaved(Key(i), values.back()));
+  }
+  ASSERT_LE(cache()->TEST_GetNumEntries(), opts_.capacity / 1000);
+  ASSERT_GE(cache()->TEST_GetNumEntries(), opts_.capacity / 1000 / 2);
+  ASSERT_EQ(Lookup(Key(0)), "");
+  ASSERT_EQ(Lookup(Key(kNumValues / 2)), "");
+  for (int i = kNumValues - 100; i < kNumValues; i++) {
+    ASSERT_EQ(Lookup(Key(i)), values[i]);
+  }
+  ASSERT_EQ(Lookup(Key(kNumValues - 100), /*wait=*/false),
+            values[kNumValues - 100]);
+}
+
+TEST_F(LogStructuredSecondaryCacheTest, SizeAwareAdmission) {
+  opts_.max_value_size = 1000;
+  Open();
+  Random rnd(301);
+  std::string small = rnd.RandomString(1000);
+  std::string large = rnd.RandomString(1001);
+  ASSERT_OK(sec_cache_->InsertSaved(Key(1), small));
+  ASSERT_OK(sec_cache_->InsertSaved(Key(2), large));
+  TestItem item(large.data(), large.size());
+  ASSERT_OK(sec_cache_->Insert(Key(3), &item, GetHelper(), false));
+  ASSERT_EQ(Lookup(Key(1)), small);
+  ASSERT_EQ(Lookup(Key(2)), "");
+  ASSERT_EQ(Lookup(Key(3)), "");
+
+  // Nor values that do not fit in a segment
+  opts_.max_value_size = 0;
+  Open();
+  std::string huge = rnd.RandomString(opts_.segment_size);
+  ASSERT_OK(sec_cache_->InsertSaved(Key(4), huge));
+  ASSERT_EQ(Lookup(Key(4)), "");
+  ASSERT_EQ(cache()->TEST_GetNumEntries(), 0);
+}
+
+TEST_F(LogStructuredSecondaryCacheTest, InvalidOptions) {
+  std::shared_ptr<SecondaryCache> sec_cache;
+  LogStructuredSecondaryCacheOptions opts = opts_;
+  opts.capacity = opts.segment_size;
+  ASSERT_TRUE(opts.MakeSharedSecondaryCache(&sec_cache).IsInvalidArgument());
+  opts = opts_;
+  opts.segment_size = 32 << 20;
+  ASSERT_TRUE(opts.MakeSharedSecondaryCache(&sec_cache).IsInvalidArgument());
+  opts = opts_;
+  opts.path.clear();
+  ASSERT_TRUE(opts.MakeSharedSecondaryCache(&sec_cache).IsInvalidArgument());
+  ASSERT_EQ(sec_cache, nullptr);
+}
+
+TEST_F(LogStructuredSecondaryCacheTest, WithPrimaryCache) {
+  Open();
+  std::shared_ptr<Cache> cache = NewCache(4096, /*num_shard_bits=*/0,
+                                          /*strict_capacity_limit=*/false,
+                                          sec_cache_);
+  Random rnd(301);
+  std::vector<std::string> values;
+  for (int i = 0; i < 10; i++) {
+    values.push_back(rnd.RandomString(1000));
+    auto item = new TestItem(values.back().data(), values.back().size());
+    ASSERT_OK(cache->Insert(Key(i), item, GetHelper(), values.back().size()));
+  }
+  // Evicted from the primary cache to this one
+  ASSERT_EQ(Lookup(Key(0)), values[0]);
+  Cache::Handle* handle =
+      cache->Lookup(Key(0), GetHelper(), this, Cache::Priority::LOW);
+  ASSERT_NE(handle, nullptr);
+  ASSERT_EQ(static_cast<TestItem*>(cache->Value(handle))->ToString(),
+            values[0]);
+  cache->Release(handle);
+}
+
+TEST_F(LogStructuredSecondaryCacheTest, AsNvmTier) {
+  Open();
+  CompressedSecondaryCacheOptions comp_opts;
+  comp_opts.capacity = 1 << 20;
+  comp_opts.compression_type = kNoCompression;
+  TieredSecondaryCache tiered(comp_opts.MakeSharedSecondaryCache(),
+                              sec_cache_,
+                              TieredAdmissionPolicy::kAdmPolicyThreeQueue);
+  Random rnd(301);
+  std::vector<std::string> values;
+  for (int i = 0; i < 10; i++) {
+    values.push_back(rnd.RandomString(1000));
+    ASSERT_OK(tiered.InsertSaved(Key(i), values.back()));
+  }
+  ASSERT_OK(cache()->TEST_Flush());
+
+  std::vector<std::string> keys;
+  std::vector<std::unique_ptr<SecondaryCacheResultHandle>> handles;
+  std::vector<SecondaryCacheResultHandle*> to_wait;
+  for (int i = 0; i < 10; i++) {
+    keys.push_back(Key(i));
+  }
+  for (const auto& key : keys) {
+    bool kept_in_sec_cache = false;
+    handles.push_back(tiered.Lookup(key, GetHelper(), this, /*wait=*/false,
+                                    /*advise_erase=*/false, nullptr,
+                                    kept_in_sec_cache));
+    ASSERT_NE(handles.back(), nullptr);
+    to_wait.push_back(handles.back().get());
+  }
+  tiered.WaitAll(to_wait);
+  for (int i = 0; i < 10; i++) {
+    ASSERT_TRUE(handles[i]->IsReady());
+    std::unique_ptr<TestItem> item(static_cast<TestItem*>(handles[i]->Value()));
+    ASSERT_NE(item, nullptr);
+    ASSERT_EQ(item->ToString(), values[i]);
+  }
+}
+
+}  // namespace ROCKSDB_NAMESPACE
+
+int main(int argc, char** argv) {
+  ROCKSDB_NAMESPACE::port::InstallStackTraceHandler();
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -120,7 +120,8 @@ LRUCacheShard::LRUCacheShard(size_t capacity, bool strict_capacity_limit,
                              CacheMetadataChargePolicy metadata_charge_policy,
                              int max_upper_hash_bits,
                              MemoryAllocator* allocator,
-                             const Cache::EvictionCallback* eviction_callback)
+                             const Cache::EvictionCallback* eviction_callback,
+                             bool use_frequency_admission)
     : CacheShardBase(metadata_charge_policy),
       capacity_(0),
       high_pri_pool_usage_(0),
@@ -140,6 +141,11 @@ LRUCacheShard::LRUCacheShard(size_t capacity, bool strict_capacity_limit,
   lru_.prev = &lru_;
   lru_low_pri_ = &lru_;
   lru_bottom_pri_ = &lru_;
+  if (use_frequency_admission) {
+    // Four counters per entry of a typical block size keep collisions rare
+    // even with many more distinct keys than entries.
+    frequency_sketch_.reset(new FrequencySketch(capacity / 1024));
+  }
   SetCapacity(capacity);
 }
 
@@ -370,6 +376,18 @@ void LRUCacheShard::SetStrictCapacityLimit(bool strict_capacity_limit) {
   strict_capacity_limit_ = strict_capacity_limit;
 }
 
+bool LRUCacheShard::AdmitItem(const LRUHandle* e, LRUHandle** handle) {
+  if (frequency_sketch_ == nullptr || handle != nullptr ||
+      usage_ + e->total_charge <= capacity_ || lru_.next == &lru_) {
+    return true;
+  }
+  // A replacement of an existing entry is always admitted, so that the cache
+  // does not keep a stale value.
+  return frequency_sketch_->Estimate(e->hash) >
+             frequency_sketch_->Estimate(lru_.next->hash) ||
+         table_.Lookup(e->key(), e->hash) != nullptr;
+}
+
 Status LRUCacheShard::InsertItem(LRUHandle* e, LRUHandle** handle) {
   Status s = Status::OK();
   autovector<LRUHandle*> last_reference_list;
@@ -377,12 +395,15 @@ Status LRUCacheShard::InsertItem(LRUHandle* e, LRUHandle** handle) {
   {
     DMutexLock l(mutex_);
 
-    // Free the space following strict LRU policy until enough space
-    // is freed or the lru list is empty.
-    EvictFromLRU(e->total_charge, &last_reference_list);
+    bool admitted = AdmitItem(e, handle);
+    if (admitted) {
+      // Free the space following strict LRU policy until enough space
+      // is freed or the lru list is empty.
+      EvictFromLRU(e->total_charge, &last_reference_list);
+    }
 
-    if ((usage_ + e->total_charge) > capacity_ &&
-        (strict_capacity_limit_ || handle == nullptr)) {
+    if (!admitted || ((usage_ + e->total_charge) > capacity_ &&
+                      (strict_capacity_limit_ || handle == nullptr))) {
       e->SetInCache(false);
       if (handle == nullptr) {
         // Don't insert the entry but still return ok, as if the entry inserted
@@ -434,6 +455,9 @@ LRUHandle* LRUCacheShard::Lookup(const Slice& key, uint32_t hash,
                                  Cache::Priority /*priority*/,
                                  Statistics* /*stats*/) {
   DMutexLock l(mutex_);
+  if (frequency_sketch_ != nullptr) {
+    frequency_sketch_->Increment(hash);
+  }
   LRUHandle* e = table_.Lookup(key, hash);
   if (e != nullptr) {
     assert(e->InCache());
@@ -645,6 +669,9 @@ void LRUCacheShard::AppendPrintableOptions(std::string& str) const {
              high_pri_pool_ratio_);
     snprintf(buffer + strlen(buffer), kBufferSize - strlen(buffer),
              "    low_pri_pool_ratio: %.3lf\n", low_pri_pool_ratio_);
+    snprintf(buffer + strlen(buffer), kBufferSize - strlen(buffer),
+             "    use_frequency_admission: %d\n",
+             frequency_sketch_ != nullptr);
   }
   str.append(buffer);
 }
@@ -657,7 +684,8 @@ LRUCache::LRUCache(const LRUCacheOptions& opts) : ShardedCache(opts) {
                            opts.high_pri_pool_ratio, opts.low_pri_pool_ratio,
                            opts.use_adaptive_mutex, opts.metadata_charge_policy,
                            /* max_upper_hash_bits */ 32 - opts.num_shard_bits,
-                           alloc, &eviction_callback_);
+                           alloc, &eviction_callback_,
+                           opts.use_frequency_admission);
   });
 }
 
@@ -11,6 +11,7 @@
 #include <memory>
 #include <string>
 
+#include "cache/frequency_sketch.h"
 #include "cache/sharded_cache.h"
 #include "port/lang.h"
 #include "port/likely.h"
@@ -271,7 +272,8 @@ class ALIGN_AS(CACHE_LINE_SIZE) LRUCacheShard final : public CacheShardBase {
                 bool use_adaptive_mutex,
                 CacheMetadataChargePolicy metadata_charge_policy,
                 int max_upper_hash_bits, MemoryAllocator* allocator,
-                const Cache::EvictionCallback* eviction_callback);
+                const Cache::EvictionCallback* eviction_callback,
+                bool use_frequency_admission);
 
  public:  // Type definitions expected as parameter to ShardedCache
   using HandleImpl = LRUHandle;
@@ -356,6 +358,10 @@ class ALIGN_AS(CACHE_LINE_SIZE) LRUCacheShard final : public CacheShardBase {
   // non-OK status.
   Status InsertItem(LRUHandle* item, LRUHandle** handle);
 
+  // Whether the frequency sketch admits `e` into the cache, which it always
+  // does if no other entry has to be evicted for it.
+  bool AdmitItem(const LRUHandle* e, LRUHandle** handle);
+
   void LRU_Remove(LRUHandle* e);
   void LRU_Insert(LRUHandle* e);
 
@@ -431,6 +437,9 @@ class ALIGN_AS(CACHE_LINE_SIZE) LRUCacheShard final : public CacheShardBase {
   // Memory size for entries residing only in the LRU list.
   size_t lru_usage_;
 
+  // Recent lookups, if entries are admitted by frequency.
+  std::unique_ptr<FrequencySketch> frequency_sketch_;
+
   // mutex_ protects the following state.
   // We don't count mutex_ as the cache's internal state so semantically we
   // don't mind mutex_ invoking the non-const actions.
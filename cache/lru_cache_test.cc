@@ -45,7 +45,8 @@ class LRUCacheTest : public testing::Test {
 
   void NewCache(size_t capacity, double high_pri_pool_ratio = 0.0,
                 double low_pri_pool_ratio = 1.0,
-                bool use_adaptive_mutex = kDefaultToAdaptiveMutex) {
+                bool use_adaptive_mutex = kDefaultToAdaptiveMutex,
+                bool use_frequency_admission = false) {
     DeleteCache();
     cache_ = static_cast<LRUCacheShard*>(
         port::cacheline_aligned_alloc(sizeof(LRUCacheShard)));
@@ -53,7 +54,8 @@ class LRUCacheTest : public testing::Test {
                                high_pri_pool_ratio, low_pri_pool_ratio,
                                use_adaptive_mutex, kDontChargeCacheMetadata,
                                /*max_upper_hash_bits=*/24,
-                               /*allocator*/ nullptr, &eviction_callback_);
+                               /*allocator*/ nullptr, &eviction_callback_,
+                               use_frequency_admission);
   }
 
   void Insert(const std::string& key,
@@ -1024,6 +1026,106 @@ TYPED_TEST(ClockCacheTest, TableSizesTest) {
   }
 }
 
+namespace {
+// Values that can be copied between NUMA groups
+void DeleteString(Cache::ObjectPtr obj, MemoryAllocator* /*alloc*/) {
+  delete static_cast<std::string*>(obj);
+}
+
+size_t StringSize(Cache::ObjectPtr obj) {
+  return static_cast<std::string*>(obj)->size();
+}
+
+Status SaveString(Cache::ObjectPtr obj, size_t from_offset, size_t length,
+                  char* out_buf) {
+  memcpy(out_buf, static_cast<std::string*>(obj)->data() + from_offset,
+         length);
+  return Status::OK();
+}
+
+Status CreateString(const Slice& data, CompressionType /*type*/,
+                    CacheTier /*source*/, Cache::CreateContext* /*context*/,
+                    MemoryAllocator* /*allocator*/, Cache::ObjectPtr* out_obj,
+                    size_t* out_charge) {
+  *out_obj = new std::string(data.ToString());
+  *out_charge = data.size();
+  return Status::OK();
+}
+
+const Cache::CacheItemHelper kStringHelperWithoutCompat{CacheEntryRole::kMisc,
+                                                        &DeleteString};
+const Cache::CacheItemHelper kStringHelper{
+    CacheEntryRole::kMisc, &DeleteString, &StringSize, &SaveString,
+    &CreateString, &kStringHelperWithoutCompat};
+}  // namespace
+
+#ifndef NDEBUG  // Needs sync points
+TEST(HyperClockCacheNumaTest, LocalShards) {
+  // Pretend that there are two NUMA nodes
+  uint32_t local_group = 0;
+  SyncPoint::GetInstance()->SetCallBack(
+      "BaseHyperClockCache::NumaGroupBits",
+      [](void* arg) { *static_cast<int*>(arg) = 1; });
+  SyncPoint::GetInstance()->SetCallBack(
+      "BaseHyperClockCache::GetLocalNumaGroup",
+      [&](void* arg) { *static_cast<uint32_t*>(arg) = local_group; });
+  SyncPoint::GetInstance()->EnableProcessing();
+
+  for (double ratio : {0.0, 0.01, 1.0}) {
+    HyperClockCacheOptions opts(1 << 20, 100, /*num_shard_bits=*/2);
+    opts.metadata_charge_policy = kDontChargeCacheMetadata;
+    opts.numa_local_shards = true;
+    opts.numa_duplicate_ratio = ratio;
+    auto cache = opts.MakeSharedCache();
+    struct : public Cache::CreateContext {
+    } context;
+    const std::string key1(16, 'a');
+    const std::string key2(16, 'b');
+
+    // An entry is found from both groups, and its handle released to the
+    // group that owns it.
+    ASSERT_OK(cache->Insert(key1, new std::string(100, 'x'), &kStringHelper,
+                            100));
+    ASSERT_EQ(1, cache->GetOccupancyCount());
+    for (int i = 0; i < 400; i++) {
+      local_group = i % 2;
+      Cache::Handle* h = cache->Lookup(key1, &kStringHelper, &context);
+      ASSERT_NE(nullptr, h);
+      ASSERT_EQ(std::string(100, 'x'),
+                *static_cast<std::string*>(cache->Value(h)));
+      ASSERT_TRUE(cache->Ref(h));
+      cache->Release(h);
+      cache->Release(h);
+    }
+    ASSERT_EQ(0, cache->GetPinnedUsage());
+    // Copies only within the budget
+    ASSERT_EQ(ratio == 1.0 ? 2 : 1, cache->GetOccupancyCount());
+
+    // Inserts go to the local group, and Erase finds all copies
+    local_group = 1;
+    ASSERT_OK(cache->Insert(key1, new std::string(100, 'y'), &kStringHelper,
+                            100));
+    ASSERT_EQ(2, cache->GetOccupancyCount());
+    cache->Erase(key1);
+    ASSERT_EQ(0, cache->GetOccupancyCount());
+    ASSERT_EQ(nullptr, cache->Lookup(key1));
+
+    // Standalone handles too
+    local_group = 1;
+    Cache::Handle* h =
+        cache->CreateStandalone(key2, new std::string(100, 'z'),
+                                &kStringHelper, 100, /*allow_uncharged=*/true);
+    ASSERT_NE(nullptr, h);
+    local_group = 0;
+    cache->Release(h);
+    ASSERT_EQ(0, cache->GetUsage());
+  }
+
+  SyncPoint::GetInstance()->DisableProcessing();
+  SyncPoint::GetInstance()->ClearAllCallBacks();
+}
+#endif  // !NDEBUG
+
 }  // namespace clock_cache
 
 class TestSecondaryCache : public SecondaryCache {
@@ -2723,6 +2825,61 @@ TEST_F(LRUCacheTest, InsertAfterReducingCapacity) {
   Insert("aaa", Cache::Priority::LOW, /*charge=*/3);
 }
 
+TEST_F(LRUCacheTest, FrequencyAdmission) {
+  constexpr size_t kCharge = 4096;
+  constexpr int kNumHotKeys = 64;
+  // Looks up a key and inserts it on a miss, like a block cache read.
+  auto read = [&](const std::string& key) {
+    const uint32_t hash = LRUCacheShard::ComputeHash(key, 0 /*seed*/);
+    LRUHandle* handle = cache_->Lookup(key, hash, nullptr, nullptr,
+                                       Cache::Priority::LOW, nullptr);
+    if (handle != nullptr) {
+      cache_->Release(handle, true /*useful*/, false /*erase*/);
+      return true;
+    }
+    EXPECT_OK(cache_->Insert(key, hash, nullptr /*value*/,
+                             &kNoopCacheItemHelper, kCharge,
+                             nullptr /*handle*/, Cache::Priority::LOW));
+    return false;
+  };
+  auto hot_key = [](int i) { return "hot" + std::to_string(i); };
+  auto cold_key = [](int i) { return "cold" + std::to_string(i); };
+
+  for (bool use_frequency_admission : {false, true}) {
+    NewCache(kNumHotKeys * kCharge, 0.0 /*high_pri_pool_ratio*/,
+             1.0 /*low_pri_pool_ratio*/, kDefaultToAdaptiveMutex,
+             use_frequency_admission);
+    for (int round = 0; round < 3; round++) {
+      for (int i = 0; i < kNumHotKeys; i++) {
+        ASSERT_EQ(round > 0, read(hot_key(i)));
+      }
+    }
+    // A scan that reads each block once.
+    for (int i = 0; i < 4 * kNumHotKeys; i++) {
+      ASSERT_FALSE(read(cold_key(i)));
+    }
+    ASSERT_EQ(kNumHotKeys, cache_->GetOccupancyCount());
+    int hot_hits = 0;
+    for (int i = 0; i < kNumHotKeys; i++) {
+      hot_hits += read(hot_key(i)) ? 1 : 0;
+    }
+    if (!use_frequency_admission) {
+      ASSERT_EQ(0, hot_hits);
+      continue;
+    }
+    // All but the few hot keys whose counters collide with a cold key are
+    // kept.
+    ASSERT_GE(hot_hits, kNumHotKeys * 9 / 10);
+
+    // A key that is read often enough takes the place of a hot one.
+    for (int i = 0; i < 10; i++) {
+      read("new");
+    }
+    ASSERT_TRUE(read("new"));
+    ASSERT_EQ(kNumHotKeys, cache_->GetOccupancyCount());
+  }
+}
+
 }  // namespace ROCKSDB_NAMESPACE
 
 int main(int argc, char** argv) {
@@ -300,6 +300,11 @@ class ShardedCache : public ShardedCacheBase {
     return SumOverShards([fn](CacheShard& cs) { return (cs.*fn)(); });
   }
 
+  CacheShard& GetShardAt(uint32_t index) {
+    assert(index < GetNumShards());
+    return shards_[index];
+  }
+
   // Must be called exactly once by derived class constructor
   void InitShards(const std::function<void(CacheShard*)>& placement_new) {
     ForEachShard(placement_new);
@@ -0,0 +1,198 @@
+//  Copyright (c) Meta Platforms, Inc. and affiliates.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+
+#include "cache/tenant_cache.h"
+
+#include <cstring>
+
+#include "util/cast_util.h"
+#include "util/mutexlock.h"
+
+namespace ROCKSDB_NAMESPACE {
+
+void TenantCacheGroup::AddTenant(const std::shared_ptr<TenantCache>& tenant) {
+  MutexLock l(&mutex_);
+  tenants_.push_back(tenant);
+}
+
+void TenantCacheGroup::SetTotalCapacity(size_t total_capacity) {
+  MutexLock l(&mutex_);
+  total_capacity_ = total_capacity;
+  RebalanceLocked(true /* force */);
+}
+
+void TenantCacheGroup::Rebalance() {
+  MutexLock l(&mutex_);
+  RebalanceLocked(false /* force */);
+}
+
+void TenantCacheGroup::RebalanceLocked(bool force) {
+  mutex_.AssertHeld();
+  std::vector<std::shared_ptr<TenantCache>> tenants;
+  double total_share = 0;
+  for (const auto& weak_tenant : tenants_) {
+    auto tenant = weak_tenant.lock();
+    if (tenant) {
+      total_share += tenant->share_;
+      tenants.push_back(std::move(tenant));
+    }
+  }
+  if (tenants.empty()) {
+    return;
+  }
+
+  // A tenant is under pressure if it missed since the last rebalance while
+  // its cache was nearly full.
+  std::vector<size_t> guaranteed(tenants.size());
+  std::vector<bool> pressured(tenants.size());
+  size_t num_pressured = 0;
+  size_t total_capacity = 0;
+  for (size_t i = 0; i < tenants.size(); i++) {
+    TenantCache& tenant = *tenants[i];
+    guaranteed[i] = static_cast<size_t>(static_cast<double>(total_capacity_) *
+                                        tenant.share_ / total_share);
+    const uint64_t misses = tenant.TotalMisses();
+    const size_t capacity = tenant.GetCapacity();
+    pressured[i] = misses > tenant.misses_at_rebalance_ &&
+                   tenant.GetUsage() >= capacity - capacity / 8;
+    tenant.misses_at_rebalance_ = misses;
+    num_pressured += pressured[i] ? 1 : 0;
+    total_capacity += capacity;
+  }
+  if (num_pressured == 0) {
+    if (!force && total_capacity <= total_capacity_) {
+      // Nobody needs more memory than it has.
+      return;
+    }
+    pressured.assign(tenants.size(), true);
+    num_pressured = tenants.size();
+  }
+
+  // Each tenant under pressure gets its share, and the others keep what they
+  // use with some headroom, up to their share. What is left is divided among
+  // the tenants under pressure by their shares.
+  std::vector<size_t> capacities(tenants.size());
+  size_t assigned = 0;
+  double pressured_share = 0;
+  for (size_t i = 0; i < tenants.size(); i++) {
+    if (pressured[i]) {
+      capacities[i] = guaranteed[i];
+      pressured_share += tenants[i]->share_;
+    } else {
+      capacities[i] = std::min(guaranteed[i], tenants[i]->GetUsage() +
+                                                  guaranteed[i] / 8);
+    }
+    assigned += capacities[i];
+  }
+  const size_t spare = total_capacity_ - std::min(assigned, total_capacity_);
+  for (size_t i = 0; i < tenants.size(); i++) {
+    if (pressured[i]) {
+      capacities[i] += static_cast<size_t>(static_cast<double>(spare) *
+                                           tenants[i]->share_ /
+                                           pressured_share);
+    }
+    tenants[i]->target_->SetCapacity(capacities[i]);
+  }
+}
+
+Status TenantCache::Insert(const Slice& key, ObjectPtr obj,
+                           const CacheItemHelper* helper, size_t charge,
+                           Handle** handle, Priority priority,
+                           const Slice& compressed_val, CompressionType type) {
+  Status s = target_->Insert(key, obj, helper, charge, handle, priority,
+                             compressed_val, type);
+  group_->OnInsert();
+  return s;
+}
+
+Cache::Handle* TenantCache::Lookup(const Slice& key,
+                                   const CacheItemHelper* helper,
+                                   CreateContext* create_context,
+                                   Priority priority, Statistics* stats) {
+  Handle* handle =
+      target_->Lookup(key, helper, create_context, priority, stats);
+  const size_t role = static_cast<size_t>(
+      helper != nullptr ? helper->role : CacheEntryRole::kMisc);
+  (handle != nullptr ? hits_ : misses_)[role].FetchAddRelaxed(1);
+  return handle;
+}
+
+void TenantCache::SetCapacity(size_t capacity) {
+  group_->SetTotalCapacity(capacity);
+}
+
+uint64_t TenantCache::TotalMisses() const {
+  uint64_t total = 0;
+  for (const auto& misses : misses_) {
+    total += misses.LoadRelaxed();
+  }
+  return total;
+}
+
+void TenantCache::GetStats(TenantCacheStats* stats) const {
+  stats->capacity = target_->GetCapacity();
+  stats->usage = target_->GetUsage();
+  for (size_t i = 0; i < kNumCacheEntryRoles; i++) {
+    stats->hits[i] = hits_[i].LoadRelaxed();
+    stats->misses[i] = misses_[i].LoadRelaxed();
+  }
+}
+
+std::vector<std::shared_ptr<Cache>> NewTenantCaches(
+    const TenantCacheOptions& opts) {
+  std::vector<std::shared_ptr<Cache>> caches;
+  if (opts.cache_opts == nullptr || opts.shares.empty() ||
+      opts.cache_type >= PrimaryCacheType::kCacheTypeMax) {
+    return caches;
+  }
+  for (double share : opts.shares) {
+    if (!(share > 0)) {
+      return caches;
+    }
+  }
+
+  auto group = std::make_shared<TenantCacheGroup>(opts.total_capacity,
+                                                  opts.rebalance_period);
+  for (double share : opts.shares) {
+    // Each cache is created with the total capacity, which it may borrow, so
+    // that its shards and tables are sized for it.
+    std::shared_ptr<Cache> cache;
+    if (opts.cache_type == PrimaryCacheType::kCacheTypeLRU) {
+      LRUCacheOptions cache_opts =
+          *(static_cast_with_check<LRUCacheOptions, ShardedCacheOptions>(
+              opts.cache_opts));
+      cache_opts.capacity = opts.total_capacity;
+      cache_opts.secondary_cache = nullptr;
+      cache = cache_opts.MakeSharedCache();
+    } else {
+      HyperClockCacheOptions cache_opts =
+          *(static_cast_with_check<HyperClockCacheOptions, ShardedCacheOptions>(
+              opts.cache_opts));
+      cache_opts.capacity = opts.total_capacity;
+      cache_opts.secondary_cache = nullptr;
+      cache = cache_opts.MakeSharedCache();
+    }
+    if (!cache) {
+      caches.clear();
+      return caches;
+    }
+    auto tenant = std::make_shared<TenantCache>(std::move(cache), group, share);
+    group->AddTenant(tenant);
+    caches.push_back(std::move(tenant));
+  }
+  group->SetTotalCapacity(opts.total_capacity);
+  return caches;
+}
+
+Status GetTenantCacheStats(const std::shared_ptr<Cache>& cache,
+                           TenantCacheStats* stats) {
+  if (!cache || strcmp(cache->Name(), TenantCache::kClassName())) {
+    return Status::InvalidArgument();
+  }
+  static_cast<TenantCache*>(cache.get())->GetStats(stats);
+  return Status::OK();
+}
+
+}  // namespace ROCKSDB_NAMESPACE
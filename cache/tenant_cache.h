@@ -0,0 +1,101 @@
+//  Copyright (c) Meta Platforms, Inc. and affiliates.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <memory>
+#include <vector>
+
+#include "port/port.h"
+#include "rocksdb/advanced_cache.h"
+#include "rocksdb/cache.h"
+#include "util/atomic.h"
+
+namespace ROCKSDB_NAMESPACE {
+
+class TenantCache;
+
+// Divides a total capacity among the caches of a set of tenants (see
+// TenantCacheOptions). Each tenant is guaranteed its share once it needs it,
+// and the tenants that miss in their full caches borrow what the others do
+// not use.
+class TenantCacheGroup {
+ public:
+  TenantCacheGroup(size_t total_capacity, uint32_t rebalance_period)
+      : total_capacity_(total_capacity),
+        rebalance_period_(std::max(rebalance_period, uint32_t{1})) {}
+
+  void AddTenant(const std::shared_ptr<TenantCache>& tenant);
+
+  // Called after each insertion into a tenant cache.
+  void OnInsert() {
+    if (inserts_.FetchAddRelaxed(1) % rebalance_period_ ==
+        rebalance_period_ - 1) {
+      Rebalance();
+    }
+  }
+
+  void SetTotalCapacity(size_t total_capacity);
+
+  // Sets the capacity of each tenant from its share, its usage and whether
+  // it missed in its full cache since the last rebalance.
+  void Rebalance();
+
+ private:
+  void RebalanceLocked(bool force);
+
+  port::Mutex mutex_;
+  size_t total_capacity_;
+  const uint32_t rebalance_period_;
+  RelaxedAtomic<uint64_t> inserts_{0};
+  // Not owned, since each tenant owns the group.
+  std::vector<std::weak_ptr<TenantCache>> tenants_;
+};
+
+// The cache of one tenant, which forwards to its own cache and counts the
+// hits and misses of its lookups.
+class TenantCache : public CacheWrapper {
+ public:
+  TenantCache(std::shared_ptr<Cache> target,
+              std::shared_ptr<TenantCacheGroup> group, double share)
+      : CacheWrapper(std::move(target)),
+        group_(std::move(group)),
+        share_(share) {}
+
+  static const char* kClassName() { return "TenantCache"; }
+  const char* Name() const override { return kClassName(); }
+
+  Status Insert(
+      const Slice& key, ObjectPtr obj, const CacheItemHelper* helper,
+      size_t charge, Handle** handle = nullptr,
+      Priority priority = Priority::LOW, const Slice& compressed_val = Slice(),
+      CompressionType type = CompressionType::kNoCompression) override;
+
+  Handle* Lookup(const Slice& key, const CacheItemHelper* helper = nullptr,
+                 CreateContext* create_context = nullptr,
+                 Priority priority = Priority::LOW,
+                 Statistics* stats = nullptr) override;
+
+  // Sets the total capacity of the group.
+  void SetCapacity(size_t capacity) override;
+
+  void GetStats(TenantCacheStats* stats) const;
+
+ private:
+  friend class TenantCacheGroup;
+
+  uint64_t TotalMisses() const;
+
+  const std::shared_ptr<TenantCacheGroup> group_;
+  const double share_;
+  std::array<RelaxedAtomic<uint64_t>, kNumCacheEntryRoles> hits_;
+  std::array<RelaxedAtomic<uint64_t>, kNumCacheEntryRoles> misses_;
+  // Guarded by the mutex of the group.
+  uint64_t misses_at_rebalance_ = 0;
+};
+
+}  // namespace ROCKSDB_NAMESPACE
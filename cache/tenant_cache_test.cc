@@ -0,0 +1,162 @@
+//  Copyright (c) Meta Platforms, Inc. and affiliates.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+
+#include "cache/tenant_cache.h"
+
+#include <string>
+#include <vector>
+
+#include "rocksdb/advanced_cache.h"
+#include "rocksdb/cache.h"
+#include "test_util/testharness.h"
+
+namespace ROCKSDB_NAMESPACE {
+
+class TenantCacheTest : public testing::Test,
+                        public testing::WithParamInterface<PrimaryCacheType> {
+ protected:
+  static constexpr size_t kCharge = 1024;
+  static constexpr size_t kTotalCapacity = 1024 * kCharge;
+
+  TenantCacheTest() : hcc_opts_(0 /* capacity */, kCharge) {
+    lru_opts_.num_shard_bits = 0;
+    lru_opts_.metadata_charge_policy = kDontChargeCacheMetadata;
+    hcc_opts_.num_shard_bits = 0;
+    hcc_opts_.metadata_charge_policy = kDontChargeCacheMetadata;
+  }
+
+  std::vector<std::shared_ptr<Cache>> NewCaches(
+      const std::vector<double>& shares) {
+    TenantCacheOptions opts;
+    opts.cache_type = GetParam();
+    if (opts.cache_type == PrimaryCacheType::kCacheTypeLRU) {
+      opts.cache_opts = &lru_opts_;
+    } else {
+      opts.cache_opts = &hcc_opts_;
+    }
+    opts.total_capacity = kTotalCapacity;
+    opts.shares = shares;
+    opts.rebalance_period = 16;
+    return NewTenantCaches(opts);
+  }
+
+  // Looks up a key and inserts it on a miss, like a block cache read.
+  static bool Read(Cache* cache, const std::string& key) {
+    // Cache keys of the fixed size that HyperClockCache expects.
+    std::string cache_key = key;
+    cache_key.resize(16, ' ');
+    Cache::Handle* handle = cache->Lookup(cache_key, &kDataBlockHelper);
+    if (handle != nullptr) {
+      cache->Release(handle);
+      return true;
+    }
+    EXPECT_OK(cache->Insert(cache_key, nullptr, &kDataBlockHelper, kCharge));
+    return false;
+  }
+
+  static size_t Capacity(Cache* cache) { return cache->GetCapacity(); }
+
+  static const Cache::CacheItemHelper kDataBlockHelper;
+
+  LRUCacheOptions lru_opts_;
+  HyperClockCacheOptions hcc_opts_;
+};
+
+const Cache::CacheItemHelper TenantCacheTest::kDataBlockHelper{
+    CacheEntryRole::kDataBlock};
+
+TEST_P(TenantCacheTest, InvalidOptions) {
+  ASSERT_TRUE(NewCaches({}).empty());
+  ASSERT_TRUE(NewCaches({1.0, 0.0}).empty());
+  TenantCacheOptions opts;
+  opts.total_capacity = kTotalCapacity;
+  opts.shares = {1.0};
+  ASSERT_TRUE(NewTenantCaches(opts).empty());
+
+  TenantCacheStats stats;
+  ASSERT_TRUE(GetTenantCacheStats(NewLRUCache(kTotalCapacity), &stats)
+                  .IsInvalidArgument());
+}
+
+TEST_P(TenantCacheTest, Shares) {
+  auto caches = NewCaches({1.0, 3.0});
+  ASSERT_EQ(2, caches.size());
+  ASSERT_EQ(kTotalCapacity / 4, Capacity(caches[0].get()));
+  ASSERT_EQ(kTotalCapacity / 4 * 3, Capacity(caches[1].get()));
+
+  // Setting the capacity of a tenant sets the total.
+  caches[0]->SetCapacity(kTotalCapacity / 2);
+  ASSERT_EQ(kTotalCapacity / 8, Capacity(caches[0].get()));
+  ASSERT_EQ(kTotalCapacity / 8 * 3, Capacity(caches[1].get()));
+}
+
+TEST_P(TenantCacheTest, BorrowAndReclaim) {
+  auto caches = NewCaches({1.0, 1.0});
+  Cache* noisy = caches[0].get();
+  Cache* quiet = caches[1].get();
+
+  // The quiet tenant has a small working set, which it reads often.
+  constexpr int kQuietKeys = 64;
+  for (int i = 0; i < kQuietKeys; i++) {
+    Read(quiet, "quiet" + std::to_string(i));
+  }
+  // The noisy tenant scans much more than the total capacity and borrows
+  // what the quiet one does not use.
+  for (int i = 0; i < 4 * static_cast<int>(kTotalCapacity / kCharge); i++) {
+    Read(noisy, "noisy" + std::to_string(i));
+  }
+  ASSERT_GT(Capacity(noisy), kTotalCapacity * 3 / 4);
+  ASSERT_LE(Capacity(noisy) + Capacity(quiet), kTotalCapacity);
+  ASSERT_GE(Capacity(quiet), kQuietKeys * kCharge);
+  for (int i = 0; i < kQuietKeys; i++) {
+    ASSERT_TRUE(Read(quiet, "quiet" + std::to_string(i)));
+  }
+
+  // Once the quiet tenant needs more, it gets at least its share back.
+  for (int round = 0; round < 2; round++) {
+    for (int i = 0; i < static_cast<int>(kTotalCapacity / kCharge); i++) {
+      Read(quiet, "more" + std::to_string(i));
+      Read(noisy, "noisy" + std::to_string(i));
+    }
+  }
+  ASSERT_GE(Capacity(quiet), kTotalCapacity / 2);
+  ASSERT_LE(Capacity(noisy) + Capacity(quiet), kTotalCapacity);
+}
+
+TEST_P(TenantCacheTest, Stats) {
+  auto caches = NewCaches({1.0, 1.0});
+  ASSERT_FALSE(Read(caches[0].get(), "a"));
+  ASSERT_TRUE(Read(caches[0].get(), "a"));
+  ASSERT_TRUE(Read(caches[0].get(), "a"));
+  Cache::Handle* handle = caches[1]->Lookup(std::string(16, 'b'));
+  ASSERT_EQ(nullptr, handle);
+
+  TenantCacheStats stats;
+  ASSERT_OK(GetTenantCacheStats(caches[0], &stats));
+  const size_t data_block = static_cast<size_t>(CacheEntryRole::kDataBlock);
+  const size_t misc = static_cast<size_t>(CacheEntryRole::kMisc);
+  ASSERT_EQ(2, stats.hits[data_block]);
+  ASSERT_EQ(1, stats.misses[data_block]);
+  ASSERT_EQ(0, stats.misses[misc]);
+  ASSERT_EQ(kCharge, stats.usage);
+  ASSERT_EQ(kTotalCapacity / 2, stats.capacity);
+
+  ASSERT_OK(GetTenantCacheStats(caches[1], &stats));
+  ASSERT_EQ(0, stats.hits[data_block]);
+  ASSERT_EQ(1, stats.misses[misc]);
+  ASSERT_EQ(0, stats.usage);
+}
+
+INSTANTIATE_TEST_CASE_P(TenantCacheTest, TenantCacheTest,
+                        testing::Values(PrimaryCacheType::kCacheTypeLRU,
+                                        PrimaryCacheType::kCacheTypeHCC));
+
+}  // namespace ROCKSDB_NAMESPACE
+
+int main(int argc, char** argv) {
+  ROCKSDB_NAMESPACE::port::InstallStackTraceHandler();
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -4,6 +4,7 @@
 #ifdef USE_AWS
 
 #include <aws/core/Aws.h>
+#include <aws/core/utils/HashingUtils.h>
 
 #include "rocksdb/rocksdb_namespace.h"
 
@@ -12,6 +13,22 @@ inline Aws::String ToAwsString(const std::string& s) {
   return Aws::String(s.data(), s.size());
 }
 
+// Converts a crc32c in the format of CloudObjectInformation::crc32c to the
+// base64 encoding of the x-amz-checksum-crc32c header, and back.
+inline Aws::String ToAwsChecksum(const std::string& crc32c) {
+  Aws::Utils::ByteBuffer bytes(
+      reinterpret_cast<const unsigned char*>(crc32c.data()), crc32c.size());
+  return Aws::Utils::HashingUtils::Base64Encode(bytes);
+}
+inline std::string FromAwsChecksum(const Aws::String& checksum) {
+  if (checksum.empty()) {
+    return std::string();
+  }
+  auto bytes = Aws::Utils::HashingUtils::Base64Decode(checksum);
+  return std::string(reinterpret_cast<const char*>(bytes.GetUnderlyingData()),
+                     bytes.GetLength());
+}
+
 }  // namespace ROCKSDB_NAMESPACE
 
 #endif /* USE_AWS */
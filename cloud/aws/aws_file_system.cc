@@ -277,6 +277,17 @@ int CloudFileSystemImpl::RegisterAwsObjects(ObjectLibrary& library,
         return guard->get();
       });
   count++;
+  library.AddFactory<CloudStorageProvider>(  // s3-crt
+      CloudStorageProviderImpl::kS3Crt(),
+      [](const std::string& /*uri*/,
+         std::unique_ptr<CloudStorageProvider>* guard, std::string* errmsg) {
+        Status s = CloudStorageProviderImpl::CreateS3CrtProvider(guard);
+        if (!s.ok()) {
+          *errmsg = s.ToString();
+        }
+        return guard->get();
+      });
+  count++;
   return count;
 }
 
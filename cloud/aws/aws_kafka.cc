@@ -5,8 +5,11 @@
 //
 
 #include <cinttypes>
+#include <condition_variable>
 #include <fstream>
 #include <iostream>
+#include <mutex>
+#include <set>
 
 #include "cloud/cloud_log_controller_impl.h"
 #include "rocksdb/cloud/cloud_file_system.h"
@@ -25,6 +28,59 @@ namespace kafka {
 /***************************************************/
 /*                KafkaWritableFile                */
 /***************************************************/
+
+// Tracks the delivery of the records that a file produced asynchronously.
+// It is shared with the records in flight, which may outlive the file.
+struct KafkaDeliveryState {
+  std::mutex mu;
+  std::condition_variable cv;
+  // Records are numbered from 1 in the order they are produced.
+  uint64_t produced = 0;
+  // All the records up to this one were delivered.
+  uint64_t delivered = 0;
+  // Delivered records after the first one that is still in flight.
+  std::set<uint64_t> delivered_out_of_order;
+  // Set while a waiter polls the producer for delivery reports.
+  bool polling = false;
+  IOStatus status;
+
+  void OnDelivery(uint64_t seq, RdKafka::ErrorCode err) {
+    std::lock_guard<std::mutex> lk(mu);
+    if (err != RdKafka::ERR_NO_ERROR && status.ok()) {
+      status = IOStatus::IOError("Kafka delivery failed",
+                                 RdKafka::err2str(err).c_str());
+    }
+    delivered_out_of_order.insert(seq);
+    while (!delivered_out_of_order.empty() &&
+           *delivered_out_of_order.begin() == delivered + 1) {
+      delivered_out_of_order.erase(delivered_out_of_order.begin());
+      delivered++;
+    }
+    cv.notify_all();
+  }
+};
+
+// A record produced asynchronously. The producer reads the payload in place,
+// so the record is owned by the producer until its delivery report.
+struct KafkaPendingRecord {
+  std::string payload;
+  std::shared_ptr<KafkaDeliveryState> state;
+  uint64_t seq;
+};
+
+// Serves the delivery reports of all the files of a producer.
+class KafkaDeliveryReporter : public RdKafka::DeliveryReportCb {
+ public:
+  void dr_cb(RdKafka::Message& message) override {
+    // Records produced synchronously carry no opaque.
+    std::unique_ptr<KafkaPendingRecord> record(
+        static_cast<KafkaPendingRecord*>(message.msg_opaque()));
+    if (record) {
+      record->state->OnDelivery(record->seq, message.err());
+    }
+  }
+};
+
 class KafkaWritableFile : public CloudLogWritableFile {
  public:
   static const std::chrono::microseconds kFlushTimeout;
@@ -36,9 +92,15 @@ class KafkaWritableFile : public CloudLogWritableFile {
       : CloudLogWritableFile(env, cloud_fs, fname, options),
         producer_(std::move(producer)),
         topic_(std::move(topic)),
+        compressor_(cloud_fs_->GetCloudFileSystemOptions()),
         current_offset_(0) {
+    if (cloud_fs_->GetCloudFileSystemOptions()
+            .kafka_log_options.async_produce) {
+      delivery_ = std::make_shared<KafkaDeliveryState>();
+    }
     Log(InfoLogLevel::DEBUG_LEVEL, cloud_fs_->GetLogger(),
-        "[kafka] WritableFile opened file %s", fname_.c_str());
+        "[kafka] WritableFile opened file %s%s", fname_.c_str(),
+        delivery_ ? " in async mode" : "");
   }
 
   ~KafkaWritableFile() {}
@@ -52,10 +114,15 @@ class KafkaWritableFile : public CloudLogWritableFile {
   IOStatus LogDelete() override;
 
  private:
-  IOStatus ProduceRaw(const std::string& operation_name, const Slice& message);
+  IOStatus ProduceRaw(const std::string& operation_name, std::string&& message);
+  // Waits for the delivery of the records produced so far in async mode.
+  IOStatus WaitForDelivery();
 
   std::shared_ptr<RdKafka::Producer> producer_;
   std::shared_ptr<RdKafka::Topic> topic_;
+  // Set in async mode
+  std::shared_ptr<KafkaDeliveryState> delivery_;
+  CloudLogAppendCompressor compressor_;
 
   uint64_t current_offset_;
 };
@@ -63,21 +130,42 @@ const std::chrono::microseconds KafkaWritableFile::kFlushTimeout =
     std::chrono::seconds(10);
 
 IOStatus KafkaWritableFile::ProduceRaw(const std::string& operation_name,
-                                       const Slice& message) {
+                                       std::string&& message) {
   if (!status_.ok()) {
     return status_;
   }
 
   RdKafka::ErrorCode resp;
-  resp = producer_->produce(
-      topic_.get(), RdKafka::Topic::PARTITION_UA /* UnAssigned */,
-      RdKafka::Producer::RK_MSG_COPY /* Copy payload */, (void*)message.data(),
-      message.size(), &fname_ /* Partitioning key */, nullptr);
+  size_t size = message.size();
+  if (delivery_) {
+    std::unique_ptr<KafkaPendingRecord> record(new KafkaPendingRecord());
+    record->payload = std::move(message);
+    record->state = delivery_;
+    {
+      std::lock_guard<std::mutex> lk(delivery_->mu);
+      record->seq = delivery_->produced + 1;
+    }
+    resp = producer_->produce(
+        topic_.get(), RdKafka::Topic::PARTITION_UA /* UnAssigned */,
+        0 /* Payload is owned by the record */, &record->payload[0], size,
+        &fname_ /* Partitioning key */, record.get());
+    if (resp == RdKafka::ERR_NO_ERROR) {
+      // The delivery report frees the record.
+      record.release();
+      std::lock_guard<std::mutex> lk(delivery_->mu);
+      delivery_->produced++;
+    }
+  } else {
+    resp = producer_->produce(
+        topic_.get(), RdKafka::Topic::PARTITION_UA /* UnAssigned */,
+        RdKafka::Producer::RK_MSG_COPY /* Copy payload */,
+        (void*)message.data(), size, &fname_ /* Partitioning key */, nullptr);
+  }
 
   if (resp == RdKafka::ERR_NO_ERROR) {
     Log(InfoLogLevel::DEBUG_LEVEL, cloud_fs_->GetLogger(),
         "[kafka] WritableFile %s file %s %ld", fname_.c_str(),
-        operation_name.c_str(), message.size());
+        operation_name.c_str(), size);
     return IOStatus::OK();
   } else if (resp == RdKafka::ERR__QUEUE_FULL) {
     const std::string formatted_err = RdKafka::err2str(resp);
@@ -96,18 +184,55 @@ IOStatus KafkaWritableFile::ProduceRaw(const std::string& operation_name,
     return IOStatus::IOError(topic_->name().c_str(),
                              RdKafka::err2str(resp).c_str());
   }
-  current_offset_ += message.size();
+}
 
-  return IOStatus::OK();
+IOStatus KafkaWritableFile::WaitForDelivery() {
+  std::chrono::microseconds start(env_->NowMicros());
+  std::unique_lock<std::mutex> lk(delivery_->mu);
+  const uint64_t target = delivery_->produced;
+  while (delivery_->status.ok() && delivery_->delivered < target) {
+    if (std::chrono::microseconds(env_->NowMicros()) - start > kFlushTimeout) {
+      Log(InfoLogLevel::DEBUG_LEVEL, cloud_fs_->GetLogger(),
+          "[kafka] WritableFile src %s Sync timed out after %" PRId64 "us",
+          fname_.c_str(), kFlushTimeout.count());
+      return IOStatus::TimedOut();
+    }
+    if (delivery_->polling) {
+      // Another waiter serves the delivery reports for everyone.
+      delivery_->cv.wait_for(lk, std::chrono::milliseconds(100));
+      continue;
+    }
+    delivery_->polling = true;
+    lk.unlock();
+    producer_->poll(100);
+    lk.lock();
+    delivery_->polling = false;
+    delivery_->cv.notify_all();
+  }
+  if (!delivery_->status.ok()) {
+    status_ = delivery_->status;
+  }
+  return delivery_->status;
 }
 
 IOStatus KafkaWritableFile::Append(const Slice& data, const IOOptions& /*opts*/,
                                    IODebugContext* /*dbg*/) {
   std::string serialized_data;
-  CloudLogControllerImpl::SerializeLogRecordAppend(
-      fname_, data, current_offset_, &serialized_data);
+  std::string dict_record;
+  compressor_.SerializeAppend(fname_, data, current_offset_, &serialized_data,
+                              &dict_record);
 
-  return ProduceRaw("Append", serialized_data);
+  IOStatus st;
+  if (!dict_record.empty()) {
+    st = ProduceRaw("Dictionary", std::move(dict_record));
+  }
+  if (st.ok()) {
+    st = ProduceRaw("Append", std::move(serialized_data));
+  }
+  if (st.ok()) {
+    current_offset_ += data.size();
+  }
+  return st;
 }
 
 IOStatus KafkaWritableFile::Close(const IOOptions& /*opts*/,
@@ -119,17 +244,31 @@ IOStatus KafkaWritableFile::Close(const IOOptions& /*opts*/,
   CloudLogControllerImpl::SerializeLogRecordClosed(fname_, current_offset_,
                                                    &serialized_data);
 
-  return ProduceRaw("Close", serialized_data);
+  auto st = ProduceRaw("Close", std::move(serialized_data));
+  if (st.ok() && delivery_) {
+    st = WaitForDelivery();
+  }
+  return st;
 }
 
 bool KafkaWritableFile::IsSyncThreadSafe() const { return true; }
 
 IOStatus KafkaWritableFile::Sync(const IOOptions& opts, IODebugContext* dbg) {
+  if (delivery_) {
+    if (!status_.ok()) {
+      return status_;
+    }
+    return WaitForDelivery();
+  }
   return Flush(opts, dbg);
 }
 
 IOStatus KafkaWritableFile::Flush(const IOOptions& /*opts*/,
                                   IODebugContext* /*dbg*/) {
+  if (delivery_) {
+    // Records are only waited for on Sync()
+    return status_;
+  }
   std::chrono::microseconds start(env_->NowMicros());
 
   bool done = false;
@@ -168,7 +307,7 @@ IOStatus KafkaWritableFile::LogDelete() {
   std::string serialized_data;
   CloudLogControllerImpl::SerializeLogRecordDelete(fname_, &serialized_data);
 
-  return ProduceRaw("Delete", serialized_data);
+  return ProduceRaw("Delete", std::move(serialized_data));
 }
 
 /***************************************************/
@@ -215,6 +354,8 @@ class KafkaController : public CloudLogControllerImpl {
  private:
   Status InitializePartitions();
 
+  // Outlives the producer, which calls it
+  KafkaDeliveryReporter delivery_reporter_;
   std::shared_ptr<RdKafka::Producer> producer_;
   std::shared_ptr<RdKafka::Consumer> consumer_;
 
@@ -253,6 +394,16 @@ Status KafkaController::PrepareOptions(const ConfigOptions& options) {
     }
   }
 
+  if (conf->set("dr_cb", &delivery_reporter_, conf_errstr) !=
+      RdKafka::Conf::CONF_OK) {
+    Status s = Status::InvalidArgument(
+        "Failed setting the Kafka delivery report callback",
+        conf_errstr.c_str());
+    Log(InfoLogLevel::ERROR_LEVEL, cfs->GetLogger(),
+        "Kafka conf set error: %s", s.ToString().c_str());
+    return s;
+  }
+
   producer_.reset(RdKafka::Producer::create(conf.get(), producer_errstr));
   consumer_.reset(RdKafka::Consumer::create(conf.get(), consumer_errstr));
 
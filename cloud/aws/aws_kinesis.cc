@@ -4,8 +4,13 @@
 // A log file maps to a stream in Kinesis.
 //
 
+#include <chrono>
+#include <condition_variable>
 #include <fstream>
 #include <iostream>
+#include <mutex>
+#include <thread>
+#include <vector>
 
 #include "cloud/cloud_log_controller_impl.h"
 #include "rocksdb/cloud/cloud_file_system.h"
@@ -19,20 +24,28 @@
 #include <aws/core/utils/Outcome.h>
 #include <aws/kinesis/KinesisClient.h>
 #include <aws/kinesis/KinesisErrors.h>
+#include <aws/kinesis/model/ConsumerStatus.h>
 #include <aws/kinesis/model/CreateStreamRequest.h>
+#include <aws/kinesis/model/DescribeStreamConsumerRequest.h>
+#include <aws/kinesis/model/DescribeStreamConsumerResult.h>
 #include <aws/kinesis/model/DescribeStreamRequest.h>
 #include <aws/kinesis/model/DescribeStreamResult.h>
 #include <aws/kinesis/model/GetRecordsRequest.h>
 #include <aws/kinesis/model/GetRecordsResult.h>
 #include <aws/kinesis/model/GetShardIteratorRequest.h>
 #include <aws/kinesis/model/GetShardIteratorResult.h>
-#include <aws/kinesis/model/PutRecordRequest.h>
-#include <aws/kinesis/model/PutRecordResult.h>
 #include <aws/kinesis/model/PutRecordsRequest.h>
 #include <aws/kinesis/model/PutRecordsRequestEntry.h>
+#include <aws/kinesis/model/PutRecordsResult.h>
+#include <aws/kinesis/model/PutRecordsResultEntry.h>
 #include <aws/kinesis/model/Record.h>
+#include <aws/kinesis/model/RegisterStreamConsumerRequest.h>
+#include <aws/kinesis/model/RegisterStreamConsumerResult.h>
 #include <aws/kinesis/model/ShardIteratorType.h>
+#include <aws/kinesis/model/StartingPosition.h>
 #include <aws/kinesis/model/StreamDescription.h>
+#include <aws/kinesis/model/SubscribeToShardHandler.h>
+#include <aws/kinesis/model/SubscribeToShardRequest.h>
 namespace ROCKSDB_NAMESPACE {
 namespace cloud {
 namespace kinesis {
@@ -40,25 +53,48 @@ namespace kinesis {
 /***************************************************/
 /*              KinesisWritableFile                */
 /***************************************************/
+//
+// Records are buffered and sent with PutRecords requests when a request is
+// full, on Sync() and on Close(). Flush() does not send anything, since the
+// WAL writer flushes after every record.
+//
 class KinesisWritableFile : public CloudLogWritableFile {
  public:
+  // The limits of one PutRecords request
+  static const size_t kMaxBatchRecords = 500;
+  static const size_t kMaxBatchBytes = 5 * 1024 * 1024;
+  // Attempts at sending the records of a batch that keep failing
+  static const int kMaxBatchAttempts = 8;
+  static const std::chrono::microseconds kRetryBackoff;
+
   KinesisWritableFile(
       Env* env, CloudFileSystem* cloud_fs, const std::string& fname,
       const FileOptions& options,
       const std::shared_ptr<Aws::Kinesis::KinesisClient>& kinesis_client)
       : CloudLogWritableFile(env, cloud_fs, fname, options),
         kinesis_client_(kinesis_client),
-        current_offset_(0) {
+        compressor_(cloud_fs_->GetCloudFileSystemOptions()),
+        current_offset_(0),
+        pending_bytes_(0) {
     Log(InfoLogLevel::DEBUG_LEVEL, cloud_fs_->GetLogger(),
         "[kinesis] WritableFile opened file %s", fname_.c_str());
     std::string bucket = cloud_fs_->GetSrcBucketName();
     topic_ = Aws::String(bucket.c_str(), bucket.size());
+    partition_key_ = Aws::String(fname_.c_str(), fname_.size());
+  }
+  virtual ~KinesisWritableFile() {
+    if (status_.ok() && !pending_records_.empty()) {
+      SendPendingRecords("Destroy").PermitUncheckedError();
+    }
   }
-  virtual ~KinesisWritableFile() {}
 
   using CloudLogWritableFile::Append;
   IOStatus Append(const Slice& data, const IOOptions& io_opts,
                   IODebugContext* dbg) override;
+  IOStatus Flush(const IOOptions& /*opts*/, IODebugContext* /*dbg*/) override {
+    return status_;
+  }
+  IOStatus Sync(const IOOptions& io_opts, IODebugContext* dbg) override;
   IOStatus Close(const IOOptions& io_opts, IODebugContext* dbg) override;
   IOStatus LogDelete() override;
   uint64_t GetFileSize(const IOOptions& /*options*/,
@@ -67,81 +103,162 @@ class KinesisWritableFile : public CloudLogWritableFile {
   }
 
  private:
+  // Adds a serialized record to the pending batch, and sends the batch first
+  // if the record does not fit in it.
+  IOStatus AddRecord(std::string&& record, const char* op);
+  // Sends the pending records. When some records of a request fail, the
+  // records from the first failed one on are sent again, so that the stream
+  // keeps their order. Records that succeeded after a failed one are then
+  // duplicated, which the tailer tolerates since appends carry their offset.
+  IOStatus SendPendingRecords(const char* op);
+
   std::shared_ptr<Aws::Kinesis::KinesisClient> kinesis_client_;
   Aws::String topic_;
+  Aws::String partition_key_;
+  CloudLogAppendCompressor compressor_;
   uint64_t current_offset_;
+  std::vector<std::string> pending_records_;
+  size_t pending_bytes_;
 };
 
+const std::chrono::microseconds KinesisWritableFile::kRetryBackoff =
+    std::chrono::milliseconds(50);
+
+IOStatus KinesisWritableFile::AddRecord(std::string&& record, const char* op) {
+  size_t bytes = record.size() + partition_key_.size();
+  if (!pending_records_.empty() &&
+      (pending_records_.size() >= kMaxBatchRecords ||
+       pending_bytes_ + bytes > kMaxBatchBytes)) {
+    auto st = SendPendingRecords(op);
+    if (!st.ok()) {
+      return st;
+    }
+  }
+  pending_records_.push_back(std::move(record));
+  pending_bytes_ += bytes;
+  return IOStatus::OK();
+}
+
+IOStatus KinesisWritableFile::SendPendingRecords(const char* op) {
+  size_t first = 0;
+  auto backoff = kRetryBackoff;
+  for (int attempt = 1; first < pending_records_.size(); attempt++) {
+    Aws::Kinesis::Model::PutRecordsRequest request;
+    request.SetStreamName(topic_);
+    for (size_t i = first; i < pending_records_.size(); i++) {
+      const auto& record = pending_records_[i];
+      request.AddRecords(
+          Aws::Kinesis::Model::PutRecordsRequestEntry()
+              .WithPartitionKey(partition_key_)
+              .WithData(Aws::Utils::ByteBuffer(
+                  (const unsigned char*)record.c_str(), record.size())));
+    }
+
+    // write to stream
+    const auto& outcome = kinesis_client_->PutRecords(request);
+    std::string errmsg;
+    if (!outcome.IsSuccess()) {
+      errmsg = outcome.GetError().GetMessage().c_str();
+    } else {
+      const auto& entries = outcome.GetResult().GetRecords();
+      size_t sent = pending_records_.size() - first;
+      if (outcome.GetResult().GetFailedRecordCount() > 0) {
+        for (sent = 0; sent < entries.size(); sent++) {
+          if (!entries[sent].GetErrorCode().empty()) {
+            errmsg = entries[sent].GetErrorMessage().c_str();
+            break;
+          }
+        }
+      }
+      first += sent;
+    }
+    if (first == pending_records_.size()) {
+      break;
+    }
+    if (attempt == kMaxBatchAttempts) {
+      Log(InfoLogLevel::ERROR_LEVEL, cloud_fs_->GetLogger(),
+          "[kinesis] WritableFile src %s %s error %s, %" ROCKSDB_PRIszt
+          " records not sent",
+          fname_.c_str(), op, errmsg.c_str(), pending_records_.size() - first);
+      status_ = IOStatus::IOError(fname_, errmsg.c_str());
+      return status_;
+    }
+    Log(InfoLogLevel::DEBUG_LEVEL, cloud_fs_->GetLogger(),
+        "[kinesis] WritableFile src %s %s retrying %" ROCKSDB_PRIszt
+        " records: %s",
+        fname_.c_str(), op, pending_records_.size() - first, errmsg.c_str());
+    env_->SleepForMicroseconds(static_cast<int>(backoff.count()));
+    backoff *= 2;
+  }
+  Log(InfoLogLevel::DEBUG_LEVEL, cloud_fs_->GetLogger(),
+      "[kinesis] WritableFile %s file %s sent %" ROCKSDB_PRIszt
+      " records of %" ROCKSDB_PRIszt " bytes",
+      op, fname_.c_str(), pending_records_.size(), pending_bytes_);
+  pending_records_.clear();
+  pending_bytes_ = 0;
+  return IOStatus::OK();
+}
+
 IOStatus KinesisWritableFile::Append(const Slice& data,
                                      const IOOptions& /*opts*/,
                                      IODebugContext* /*dbg*/) {
-  assert(status_.ok());
-
-  // create write request
-  Aws::Kinesis::Model::PutRecordRequest request;
-  request.SetStreamName(topic_);
-  request.SetPartitionKey(Aws::String(fname_.c_str(), fname_.size()));
+  if (!status_.ok()) {
+    return status_;
+  }
 
   // serialize write record
   std::string buffer;
-  CloudLogControllerImpl::SerializeLogRecordAppend(fname_, data,
-                                                   current_offset_, &buffer);
-  request.SetData(Aws::Utils::ByteBuffer((const unsigned char*)buffer.c_str(),
-                                         buffer.size()));
-
-  // write to stream
-  const auto& outcome = kinesis_client_->PutRecord(request);
-  bool isSuccess = outcome.IsSuccess();
-
-  if (!isSuccess) {
-    const Aws::Client::AWSError<Aws::Kinesis::KinesisErrors>& error =
-        outcome.GetError();
-    Log(InfoLogLevel::DEBUG_LEVEL, cloud_fs_->GetLogger(),
-        "[kinesis] NewWritableFile src %s Append error %s", fname_.c_str(),
-        error.GetMessage().c_str());
-    return IOStatus::IOError(fname_, error.GetMessage().c_str());
+  std::string dict_record;
+  compressor_.SerializeAppend(fname_, data, current_offset_, &buffer,
+                              &dict_record);
+  IOStatus st;
+  if (!dict_record.empty()) {
+    st = AddRecord(std::move(dict_record), "Dictionary");
+  }
+  if (st.ok()) {
+    st = AddRecord(std::move(buffer), "Append");
+  }
+  if (!st.ok()) {
+    return st;
   }
   current_offset_ += data.size();
   Log(InfoLogLevel::DEBUG_LEVEL, cloud_fs_->GetLogger(),
-      "[kinesis] WritableFile Append file %s %ld %ld", fname_.c_str(),
-      data.size(), buffer.size());
+      "[kinesis] WritableFile Append file %s %ld", fname_.c_str(),
+      data.size());
   return IOStatus::OK();
 }
 
+IOStatus KinesisWritableFile::Sync(const IOOptions& /*opts*/,
+                                   IODebugContext* /*dbg*/) {
+  if (!status_.ok()) {
+    return status_;
+  }
+  return SendPendingRecords("Sync");
+}
+
 IOStatus KinesisWritableFile::Close(const IOOptions& /*opts*/,
                                     IODebugContext* /*dbg*/) {
   Log(InfoLogLevel::DEBUG_LEVEL, cloud_fs_->GetLogger(),
       "[kinesis] S3WritableFile closing %s", fname_.c_str());
-  assert(status_.ok());
-
-  // create write request
-  Aws::Kinesis::Model::PutRecordRequest request;
-  request.SetStreamName(topic_);
-  request.SetPartitionKey(Aws::String(fname_.c_str(), fname_.size()));
+  if (!status_.ok()) {
+    return status_;
+  }
 
   // serialize write record
   std::string buffer;
   CloudLogControllerImpl::SerializeLogRecordClosed(fname_, current_offset_,
                                                    &buffer);
-  request.SetData(Aws::Utils::ByteBuffer((const unsigned char*)buffer.c_str(),
-                                         buffer.size()));
-
-  // write to stream
-  const auto& outcome = kinesis_client_->PutRecord(request);
-  bool isSuccess = outcome.IsSuccess();
-
-  if (!isSuccess) {
-    const Aws::Client::AWSError<Aws::Kinesis::KinesisErrors>& error =
-        outcome.GetError();
-    Log(InfoLogLevel::DEBUG_LEVEL, cloud_fs_->GetLogger(),
-        "[kinesis] NewWritableFile src %s Close error %s", fname_.c_str(),
-        error.GetMessage().c_str());
-    return IOStatus::IOError(fname_, error.GetMessage().c_str());
+  size_t size = buffer.size();
+  auto st = AddRecord(std::move(buffer), "Close");
+  if (st.ok()) {
+    st = SendPendingRecords("Close");
+  }
+  if (!st.ok()) {
+    return st;
   }
-  current_offset_ += buffer.size();
+  current_offset_ += size;
   Log(InfoLogLevel::DEBUG_LEVEL, cloud_fs_->GetLogger(),
-      "[kinesis] WritableFile Close file %s %ld", fname_.c_str(),
-      buffer.size());
+      "[kinesis] WritableFile Close file %s %ld", fname_.c_str(), size);
   return IOStatus::OK();
 }
 
@@ -151,34 +268,23 @@ IOStatus KinesisWritableFile::Close(const IOOptions& /*opts*/,
 IOStatus KinesisWritableFile::LogDelete() {
   Log(InfoLogLevel::DEBUG_LEVEL, cloud_fs_->GetLogger(),
       "[kinesis] LogDelete %s", fname_.c_str());
-  assert(status_.ok());
-
-  // create write request
-  Aws::Kinesis::Model::PutRecordRequest request;
-  request.SetStreamName(topic_);
-  request.SetPartitionKey(Aws::String(fname_.c_str(), fname_.size()));
+  if (!status_.ok()) {
+    return status_;
+  }
 
   // serialize write record
   std::string buffer;
   CloudLogControllerImpl::SerializeLogRecordDelete(fname_, &buffer);
-  request.SetData(Aws::Utils::ByteBuffer((const unsigned char*)buffer.c_str(),
-                                         buffer.size()));
-
-  // write to stream
-  const Aws::Kinesis::Model::PutRecordOutcome& outcome =
-      kinesis_client_->PutRecord(request);
-  bool isSuccess = outcome.IsSuccess();
-
-  if (!isSuccess) {
-    const Aws::Client::AWSError<Aws::Kinesis::KinesisErrors>& error =
-        outcome.GetError();
-    Log(InfoLogLevel::DEBUG_LEVEL, cloud_fs_->GetLogger(),
-        "[kinesis] LogDelete src %s error %s", fname_.c_str(),
-        error.GetMessage().c_str());
-    return IOStatus::IOError(fname_, error.GetMessage().c_str());
+  size_t size = buffer.size();
+  auto st = AddRecord(std::move(buffer), "LogDelete");
+  if (st.ok()) {
+    st = SendPendingRecords("LogDelete");
+  }
+  if (!st.ok()) {
+    return st;
   }
   Log(InfoLogLevel::DEBUG_LEVEL, cloud_fs_->GetLogger(),
-      "[kinesis] LogDelete file %s %ld", fname_.c_str(), buffer.size());
+      "[kinesis] LogDelete file %s %ld", fname_.c_str(), size);
   return IOStatus::OK();
 }
 
@@ -202,6 +308,10 @@ class KinesisController : public CloudLogControllerImpl {
 
   IOStatus CreateStream(const std::string& bucket) override;
   IOStatus WaitForStreamReady(const std::string& bucket) override;
+  // Tails every shard of the stream in its own thread. Records of a log file
+  // all go to the shard of its partition key, so they are applied in order.
+  // After a resharding, the children of a shard are only read once the
+  // parent is done.
   IOStatus TailStream() override;
 
   CloudLogWritableFile* CreateWritableFile(const std::string& fname,
@@ -211,20 +321,46 @@ class KinesisController : public CloudLogControllerImpl {
   Status PrepareOptions(const ConfigOptions& options) override;
 
  private:
+  // Position of the tailer in a shard
+  struct ShardState {
+    Aws::Kinesis::Model::Shard shard;
+    Aws::String iterator;
+    // Sequence number of the last record applied from the shard
+    Aws::String position;
+    // Set once all the records of a closed shard were applied
+    bool finished = false;
+  };
+
   std::shared_ptr<Aws::Kinesis::KinesisClient> kinesis_client_;
 
   Aws::String topic_;
+  Aws::String stream_arn_;
+  // Set when reading with enhanced fan-out
+  Aws::String consumer_arn_;
 
-  // list of shards and their positions
-  Aws::Vector<Aws::Kinesis::Model::Shard> shards_;
-  Aws::Vector<Aws::String> shards_iterator_;
-  std::vector<Aws::String> shards_position_;
+  // list of shards and their positions, fixed once tailing starts
+  std::vector<ShardState> shards_;
+  std::mutex shards_mutex_;
+  std::condition_variable shards_cv_;
 
   Status InitializeShards();
-
-  // Set shard iterator for every shard to position specified by
-  // shards_position_.
-  void SeekShards();
+  // Registers the fan-out consumer, or finds the one already registered, and
+  // waits for it to be active.
+  Status InitializeConsumer(const std::string& consumer_name);
+
+  // Set the shard iterator of a shard to the position after the last record
+  // applied from it.
+  Status SeekShard(ShardState* state);
+
+  // Waits until the parents of the shard, if any, are finished.
+  void WaitForParentShards(const ShardState& state);
+  void FinishShard(ShardState* state);
+
+  // Applies the records of a shard, by polling or through a subscription.
+  Status TailShard(ShardState* state);
+  Status SubscribeToShard(ShardState* state);
+  void ApplyRecord(ShardState* state,
+                   const Aws::Kinesis::Model::Record& record);
 };
 
 Status KinesisController::PrepareOptions(const ConfigOptions& config_options) {
@@ -256,25 +392,89 @@ Status KinesisController::PrepareOptions(const ConfigOptions& config_options) {
 
 IOStatus KinesisController::TailStream() {
   status_ = InitializeShards();
+  const auto& consumer_name = cloud_fs_->GetCloudFileSystemOptions()
+                                  .kinesis_log_options.fan_out_consumer_name;
+  if (status_.ok() && !consumer_name.empty()) {
+    status_ = InitializeConsumer(consumer_name);
+  }
 
   Log(InfoLogLevel::DEBUG_LEVEL, cloud_fs_->GetLogger(),
-      "[%s] TailStream topic %s %s", Name(), topic_.c_str(),
+      "[%s] TailStream topic %s %" ROCKSDB_PRIszt " shards%s %s", Name(),
+      topic_.c_str(), shards_.size(),
+      consumer_arn_.empty() ? "" : " with enhanced fan-out",
       status_.ToString().c_str());
+  if (!status_.ok()) {
+    return status_to_io_status(status());
+  }
+
+  std::vector<Status> results(shards_.size());
+  std::vector<std::thread> threads;
+  for (size_t i = 0; i < shards_.size(); i++) {
+    threads.emplace_back([this, i, &results]() {
+      results[i] = consumer_arn_.empty() ? TailShard(&shards_[i])
+                                         : SubscribeToShard(&shards_[i]);
+    });
+  }
+  for (auto& t : threads) {
+    t.join();
+  }
+  for (const auto& st : results) {
+    if (!st.ok()) {
+      status_ = st;
+      break;
+    }
+  }
+  return status_to_io_status(status());
+}
+
+void KinesisController::ApplyRecord(
+    ShardState* state, const Aws::Kinesis::Model::Record& record) {
+  // extract payload from log record
+  const Aws::Utils::ByteBuffer& b = record.GetData();
+  const unsigned char* data = b.GetUnderlyingData();
+  Slice sl((const char*)data, b.GetLength());
+
+  // apply the payload to local filesystem
+  auto st = Apply(sl);
+  if (!st.ok()) {
+    Log(InfoLogLevel::DEBUG_LEVEL, cloud_fs_->GetLogger(),
+        "[%s] error processing message size %ld "
+        "extracted from stream %s shard %s %s",
+        Name(), b.GetLength(), topic_.c_str(),
+        state->shard.GetShardId().c_str(), st.ToString().c_str());
+  } else {
+    Log(InfoLogLevel::DEBUG_LEVEL, cloud_fs_->GetLogger(),
+        "[%s] successfully processed message size %ld "
+        "extracted from stream %s shard %s",
+        Name(), b.GetLength(), topic_.c_str(),
+        state->shard.GetShardId().c_str());
+  }
+
+  // remember last read seqno from stream
+  state->position = record.GetSequenceNumber();
+}
+
+Status KinesisController::TailShard(ShardState* state) {
+  WaitForParentShards(*state);
+  Status st = SeekShard(state);
 
   Status lastErrorStatus;
   int retryAttempt = 0;
   while (IsRunning()) {
     if (retryAttempt > 10) {
-      status_ = lastErrorStatus;
-      break;
+      return lastErrorStatus;
+    }
+    if (!st.ok()) {
+      lastErrorStatus = st;
+      ++retryAttempt;
+      std::this_thread::sleep_for(std::chrono::milliseconds(200));
+      st = SeekShard(state);
+      continue;
     }
-
-    // Count the number of records that were read in one iteration
-    size_t num_read = 0;
 
     // Issue a read from Kinesis stream
     Aws::Kinesis::Model::GetRecordsRequest request;
-    request.SetShardIterator(shards_iterator_[0]);
+    request.SetShardIterator(state->iterator);
     Aws::Kinesis::Model::GetRecordsOutcome outcome =
         kinesis_client_->GetRecords(request);
     bool isSuccess = outcome.IsSuccess();
@@ -286,8 +486,7 @@ IOStatus KinesisController::TailStream() {
         Log(InfoLogLevel::DEBUG_LEVEL, cloud_fs_->GetLogger(),
             "[%s] expired shard iterator for %s. Reseeking...", Name(),
             topic_.c_str());
-        shards_iterator_[0] = "";
-        SeekShards();  // read position at last seqno
+        st = SeekShard(state);  // read position at last seqno
       } else {
         Log(InfoLogLevel::DEBUG_LEVEL, cloud_fs_->GetLogger(),
             "[%s] error reading %s %s", Name(), topic_.c_str(),
@@ -302,42 +501,111 @@ IOStatus KinesisController::TailStream() {
     retryAttempt = 0;
     Aws::Kinesis::Model::GetRecordsResult& res = outcome.GetResult();
     const Aws::Vector<Aws::Kinesis::Model::Record>& records = res.GetRecords();
+    for (const auto& r : records) {
+      ApplyRecord(state, r);
+    }
 
     // skip to the next position in the shard iterator
-    const Aws::String& next = res.GetNextShardIterator();
-    shards_iterator_[0] = next;
-
-    // read data into buffer
-    num_read = records.size();
-    for (auto r : records) {
-      // extract payload from log record
-      const Aws::Utils::ByteBuffer& b = r.GetData();
-      const unsigned char* data = b.GetUnderlyingData();
-      Slice sl((const char*)data, b.GetLength());
-
-      // apply the payload to local filesystem
-      status_ = Apply(sl);
-      if (!status_.ok()) {
-        Log(InfoLogLevel::DEBUG_LEVEL, cloud_fs_->GetLogger(),
-            "[%s] error processing message size %ld "
-            "extracted from stream %s %s",
-            Name(), b.GetLength(), topic_.c_str(), status_.ToString().c_str());
-      } else {
-        Log(InfoLogLevel::DEBUG_LEVEL, cloud_fs_->GetLogger(),
-            "[%s] successfully processed message size %ld "
-            "extracted from stream %s %s",
-            Name(), b.GetLength(), topic_.c_str(), status_.ToString().c_str());
-      }
+    state->iterator = res.GetNextShardIterator();
+    if (state->iterator.empty()) {
+      // The shard was closed by a resharding and is fully read
+      FinishShard(state);
+      break;
+    }
+    // Kinesis serves five GetRecords calls per second per shard
+    if (records.empty() && res.GetMillisBehindLatest() == 0) {
+      std::this_thread::sleep_for(std::chrono::milliseconds(200));
+    }
+  }
+  return Status::OK();
+}
 
-      // remember last read seqno from stream
-      shards_position_[0] = r.GetSequenceNumber();
+Status KinesisController::SubscribeToShard(ShardState* state) {
+  WaitForParentShards(*state);
+
+  Status lastErrorStatus;
+  int retryAttempt = 0;
+  bool shard_closed = false;
+  // A subscription lasts up to five minutes, it is renewed from the last
+  // record applied.
+  while (IsRunning() && !shard_closed) {
+    if (retryAttempt > 10) {
+      return lastErrorStatus;
     }
-    // If no records were read in last iteration, then sleep for 50 millis
-    if (num_read == 0 && status_.ok()) {
-      std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    Aws::Kinesis::Model::StartingPosition start;
+    if (state->position.empty()) {
+      start.SetType(Aws::Kinesis::Model::ShardIteratorType::TRIM_HORIZON);
+    } else {
+      start.SetType(
+          Aws::Kinesis::Model::ShardIteratorType::AFTER_SEQUENCE_NUMBER);
+      start.SetSequenceNumber(state->position);
     }
+
+    Aws::Kinesis::Model::SubscribeToShardHandler handler;
+    handler.SetSubscribeToShardEventCallback(
+        [&](const Aws::Kinesis::Model::SubscribeToShardEvent& event) {
+          for (const auto& r : event.GetRecords()) {
+            ApplyRecord(state, r);
+          }
+          // A closed shard has no continuation once it is fully read
+          if (event.GetContinuationSequenceNumber().empty()) {
+            shard_closed = true;
+          }
+        });
+
+    Aws::Kinesis::Model::SubscribeToShardRequest request;
+    request.SetConsumerARN(consumer_arn_);
+    request.SetShardId(state->shard.GetShardId());
+    request.SetStartingPosition(start);
+    request.SetEventStreamHandler(handler);
+    // Stop receiving events when the tailer stops
+    request.SetContinueRequestHandler(
+        [this](const Aws::Http::HttpRequest*) { return IsRunning(); });
+
+    auto outcome = kinesis_client_->SubscribeToShard(request);
+    if (!outcome.IsSuccess() && IsRunning() && !shard_closed) {
+      const auto& error = outcome.GetError();
+      Log(InfoLogLevel::DEBUG_LEVEL, cloud_fs_->GetLogger(),
+          "[%s] error subscribing to %s shard %s %s", Name(), topic_.c_str(),
+          state->shard.GetShardId().c_str(), error.GetMessage().c_str());
+      lastErrorStatus =
+          Status::IOError(topic_.c_str(), error.GetMessage().c_str());
+      ++retryAttempt;
+      std::this_thread::sleep_for(std::chrono::milliseconds(200));
+      continue;
+    }
+    retryAttempt = 0;
   }
-  return status_to_io_status(status());
+  if (shard_closed) {
+    FinishShard(state);
+  }
+  return Status::OK();
+}
+
+void KinesisController::WaitForParentShards(const ShardState& state) {
+  std::unique_lock<std::mutex> lk(shards_mutex_);
+  auto parents_finished = [&]() {
+    for (const auto& s : shards_) {
+      const auto& id = s.shard.GetShardId();
+      if (!s.finished && (id == state.shard.GetParentShardId() ||
+                          id == state.shard.GetAdjacentParentShardId())) {
+        return false;
+      }
+    }
+    return true;
+  };
+  while (IsRunning() && !parents_finished()) {
+    shards_cv_.wait_for(lk, std::chrono::milliseconds(100));
+  }
+}
+
+void KinesisController::FinishShard(ShardState* state) {
+  Log(InfoLogLevel::DEBUG_LEVEL, cloud_fs_->GetLogger(),
+      "[%s] finished reading closed shard %s of %s", Name(),
+      state->shard.GetShardId().c_str(), topic_.c_str());
+  std::lock_guard<std::mutex> lk(shards_mutex_);
+  state->finished = true;
+  shards_cv_.notify_all();
 }
 
 IOStatus KinesisController::CreateStream(const std::string& bucket) {
@@ -379,7 +647,7 @@ IOStatus KinesisController::WaitForStreamReady(const std::string& bucket) {
   IOStatus st;
 
   while (!isSuccess) {
-    // Find the number of shards for this stream. It should be 1 shard.
+    // The stream is ready once it has shards.
     st = IOStatus::OK();
     Aws::Kinesis::Model::DescribeStreamRequest request;
     request.SetStreamName(topic);
@@ -398,7 +666,7 @@ IOStatus KinesisController::WaitForStreamReady(const std::string& bucket) {
       const Aws::Kinesis::Model::StreamDescription& description =
           result.GetStreamDescription();
       auto& shards = description.GetShards();
-      if (shards.size() != 1) {
+      if (shards.empty()) {
         isSuccess = false;
         std::string msg = "Kinesis timedout initialize shards " +
                           std::string(topic.c_str(), topic.size());
@@ -423,75 +691,115 @@ Status KinesisController::InitializeShards() {
     return st;
   }
 
-  // Find the number of shards for this stream. It should be 1 shard.
-  Aws::Kinesis::Model::DescribeStreamRequest request;
-  request.SetStreamName(topic_);
-  auto outcome = kinesis_client_->DescribeStream(request);
-  bool isSuccess = outcome.IsSuccess();
-  if (!isSuccess) {
-    const Aws::Client::AWSError<Aws::Kinesis::KinesisErrors>& error =
-        outcome.GetError();
-    st = Status::IOError(topic_.c_str(), error.GetMessage().c_str()),
-    Log(InfoLogLevel::DEBUG_LEVEL, cloud_fs_->GetLogger(),
-        "[%s] S3ReadableFile file %s Unable to find shards %s", Name(),
-        topic_.c_str(), st.ToString().c_str());
-  } else {
+  // Find all the shards of this stream, which are listed in pages.
+  shards_.clear();
+  Aws::String last_shard_id;
+  bool more_shards = true;
+  while (st.ok() && more_shards) {
+    Aws::Kinesis::Model::DescribeStreamRequest request;
+    request.SetStreamName(topic_);
+    if (!last_shard_id.empty()) {
+      request.SetExclusiveStartShardId(last_shard_id);
+    }
+    auto outcome = kinesis_client_->DescribeStream(request);
+    bool isSuccess = outcome.IsSuccess();
+    if (!isSuccess) {
+      const Aws::Client::AWSError<Aws::Kinesis::KinesisErrors>& error =
+          outcome.GetError();
+      st = Status::IOError(topic_.c_str(), error.GetMessage().c_str());
+      Log(InfoLogLevel::DEBUG_LEVEL, cloud_fs_->GetLogger(),
+          "[%s] S3ReadableFile file %s Unable to find shards %s", Name(),
+          topic_.c_str(), st.ToString().c_str());
+      break;
+    }
     const Aws::Kinesis::Model::DescribeStreamResult& result =
         outcome.GetResult();
     const Aws::Kinesis::Model::StreamDescription& description =
         result.GetStreamDescription();
+    stream_arn_ = description.GetStreamARN();
 
     // append all shards to global list
-    auto& shards = description.GetShards();
-    assert(shards.size() == 1);
-    for (auto s : shards) {
-      shards_.push_back(s);
-      shards_iterator_.push_back("");
-      shards_position_.push_back("");
+    for (const auto& shard : description.GetShards()) {
+      ShardState state;
+      state.shard = shard;
+      shards_.push_back(std::move(state));
+      last_shard_id = shard.GetShardId();
     }
-  }
-  if (st.ok()) {
-    SeekShards();
+    more_shards = description.GetHasMoreShards() && !last_shard_id.empty();
   }
   return st;
 }
 
-void KinesisController::SeekShards() {
-  // Check all shard iterators
-  for (size_t i = 0; i < shards_.size(); i++) {
-    if (shards_iterator_[i].size() != 0) {
-      continue;  // iterator is still valid, nothing to do
+Status KinesisController::InitializeConsumer(const std::string& consumer_name) {
+  Aws::String name(consumer_name.c_str(), consumer_name.size());
+  Aws::Kinesis::Model::RegisterStreamConsumerRequest request;
+  request.SetStreamARN(stream_arn_);
+  request.SetConsumerName(name);
+  auto outcome = kinesis_client_->RegisterStreamConsumer(request);
+  if (outcome.IsSuccess()) {
+    consumer_arn_ = outcome.GetResult().GetConsumer().GetConsumerARN();
+  } else if (outcome.GetError().GetErrorType() !=
+             Aws::Kinesis::KinesisErrors::RESOURCE_IN_USE) {
+    // Another tailer may have registered the consumer already
+    return Status::IOError(topic_.c_str(),
+                           outcome.GetError().GetMessage().c_str());
+  }
+
+  // Wait for the consumer to be active
+  const std::chrono::microseconds start(env_->NowMicros());
+  while (true) {
+    Aws::Kinesis::Model::DescribeStreamConsumerRequest describe;
+    describe.SetStreamARN(stream_arn_);
+    describe.SetConsumerName(name);
+    auto described = kinesis_client_->DescribeStreamConsumer(describe);
+    if (!described.IsSuccess()) {
+      return Status::IOError(topic_.c_str(),
+                             described.GetError().GetMessage().c_str());
     }
-    // create new shard iterator at specified seqno
-    Aws::Kinesis::Model::GetShardIteratorRequest request;
-    request.SetStreamName(topic_);
-    request.SetShardId(shards_[i].GetShardId());
-    if (shards_position_[i].size() == 0) {
-      request.SetShardIteratorType(
-          Aws::Kinesis::Model::ShardIteratorType::TRIM_HORIZON);
-    } else {
-      request.SetShardIteratorType(
-          Aws::Kinesis::Model::ShardIteratorType::AFTER_SEQUENCE_NUMBER);
-      request.SetStartingSequenceNumber(shards_position_[i]);
+    const auto& consumer = described.GetResult().GetConsumerDescription();
+    consumer_arn_ = consumer.GetConsumerARN();
+    if (consumer.GetConsumerStatus() ==
+        Aws::Kinesis::Model::ConsumerStatus::ACTIVE) {
+      return Status::OK();
     }
-    Aws::Kinesis::Model::GetShardIteratorOutcome outcome =
-        kinesis_client_->GetShardIterator(request);
-    bool isSuccess = outcome.IsSuccess();
-    if (!isSuccess) {
-      const Aws::Client::AWSError<Aws::Kinesis::KinesisErrors>& error =
-          outcome.GetError();
-      status_ = Status::IOError(topic_.c_str(), error.GetMessage().c_str());
-      Log(InfoLogLevel::DEBUG_LEVEL, cloud_fs_->GetLogger(),
-          "[%s] S3ReadableFile file %s Unable to find shards %s", Name(),
-          topic_.c_str(), status_.ToString().c_str());
-    } else {
-      const Aws::Kinesis::Model::GetShardIteratorResult& result =
-          outcome.GetResult();
-      shards_iterator_[i] = result.GetShardIterator();
+    if (start + kRetryPeriod < std::chrono::microseconds(env_->NowMicros())) {
+      return Status::TimedOut("Kinesis consumer not active", consumer_name);
     }
+    std::this_thread::sleep_for(std::chrono::milliseconds(1000));
   }
 }
 
+Status KinesisController::SeekShard(ShardState* state) {
+  // create new shard iterator at specified seqno
+  Aws::Kinesis::Model::GetShardIteratorRequest request;
+  request.SetStreamName(topic_);
+  request.SetShardId(state->shard.GetShardId());
+  if (state->position.size() == 0) {
+    request.SetShardIteratorType(
+        Aws::Kinesis::Model::ShardIteratorType::TRIM_HORIZON);
+  } else {
+    request.SetShardIteratorType(
+        Aws::Kinesis::Model::ShardIteratorType::AFTER_SEQUENCE_NUMBER);
+    request.SetStartingSequenceNumber(state->position);
+  }
+  Aws::Kinesis::Model::GetShardIteratorOutcome outcome =
+      kinesis_client_->GetShardIterator(request);
+  bool isSuccess = outcome.IsSuccess();
+  if (!isSuccess) {
+    const Aws::Client::AWSError<Aws::Kinesis::KinesisErrors>& error =
+        outcome.GetError();
+    Status st = Status::IOError(topic_.c_str(), error.GetMessage().c_str());
+    Log(InfoLogLevel::DEBUG_LEVEL, cloud_fs_->GetLogger(),
+        "[%s] S3ReadableFile file %s Unable to find shards %s", Name(),
+        topic_.c_str(), st.ToString().c_str());
+    return st;
+  }
+  const Aws::Kinesis::Model::GetShardIteratorResult& result =
+      outcome.GetResult();
+  state->iterator = result.GetShardIterator();
+  return Status::OK();
+}
+
 CloudLogWritableFile* KinesisController::CreateWritableFile(
     const std::string& fname, const FileOptions& options,
     IODebugContext* /*dbg*/) {
@@ -5,7 +5,9 @@
 #include <cinttypes>
 
 #include "cloud/aws/aws_file.h"
+#include "cloud/cloud_request_stats.h"
 #include "rocksdb/cloud/cloud_file_system.h"
+#include "rocksdb/cloud/cloud_rate_limiter.h"
 #ifdef USE_AWS
 #include <aws/core/client/AWSError.h>
 #include <aws/core/client/ClientConfiguration.h>
@@ -57,8 +59,20 @@ class AwsRetryStrategy : public Aws::Client::RetryStrategy {
 
   // The number of times an internal-error failure should be retried
   const int internal_failure_num_retries_{10};
+
+  bool DoShouldRetry(
+      const Aws::Client::AWSError<Aws::Client::CoreErrors>& error,
+      long attemptedRetries) const;
 };
 
+// Returns true if the storage rejected the request to shed load.
+static bool IsThrottled(
+    const Aws::Client::AWSError<Aws::Client::CoreErrors>& error) {
+  auto ce = error.GetErrorType();
+  return ce == Aws::Client::CoreErrors::THROTTLING ||
+         ce == Aws::Client::CoreErrors::SLOW_DOWN;
+}
+
 //
 // Returns true if the error can be retried given the error and the number of
 // times already tried.
@@ -66,6 +80,22 @@ class AwsRetryStrategy : public Aws::Client::RetryStrategy {
 bool AwsRetryStrategy::ShouldRetry(
     const Aws::Client::AWSError<Aws::Client::CoreErrors>& error,
     long attemptedRetries) const {
+  bool retry = DoShouldRetry(error, attemptedRetries);
+  const auto& limiter = cfs_->GetCloudFileSystemOptions().cloud_rate_limiter;
+  if (limiter && IsThrottled(error)) {
+    limiter->OnThrottled();
+  }
+  if (retry) {
+    RecordCloudRequestRetry(
+        cfs_->GetCloudFileSystemOptions().statistics.get(),
+        IsThrottled(error));
+  }
+  return retry;
+}
+
+bool AwsRetryStrategy::DoShouldRetry(
+    const Aws::Client::AWSError<Aws::Client::CoreErrors>& error,
+    long attemptedRetries) const {
   auto ce = error.GetErrorType();
   const Aws::String errmsg = error.GetMessage();
   const Aws::String exceptionMsg = error.GetExceptionName();
@@ -10,17 +10,26 @@
 #include <aws/core/utils/Outcome.h>
 #include <aws/core/utils/crypto/CryptoStream.h>
 #include <aws/core/utils/memory/stl/AWSStreamFwd.h>
+#include <aws/core/utils/stream/PreallocatedStreamBuf.h>
 #include <aws/s3/S3Client.h>
 #include <aws/s3/S3Errors.h>
+#include <aws/s3/model/AbortMultipartUploadRequest.h>
 #include <aws/s3/model/BucketLocationConstraint.h>
+#include <aws/s3/model/CompleteMultipartUploadRequest.h>
+#include <aws/s3/model/CompletedMultipartUpload.h>
+#include <aws/s3/model/CompletedPart.h>
 #include <aws/s3/model/CopyObjectRequest.h>
 #include <aws/s3/model/CopyObjectResult.h>
 #include <aws/s3/model/CreateBucketConfiguration.h>
 #include <aws/s3/model/CreateBucketRequest.h>
 #include <aws/s3/model/CreateBucketResult.h>
+#include <aws/s3/model/CreateMultipartUploadRequest.h>
+#include <aws/s3/model/Delete.h>
 #include <aws/s3/model/DeleteBucketRequest.h>
 #include <aws/s3/model/DeleteObjectRequest.h>
 #include <aws/s3/model/DeleteObjectResult.h>
+#include <aws/s3/model/DeleteObjectsRequest.h>
+#include <aws/s3/model/DeleteObjectsResult.h>
 #include <aws/s3/model/GetBucketVersioningRequest.h>
 #include <aws/s3/model/GetBucketVersioningResult.h>
 #include <aws/s3/model/GetObjectRequest.h>
@@ -30,10 +39,20 @@
 #include <aws/s3/model/HeadObjectResult.h>
 #include <aws/s3/model/ListObjectsRequest.h>
 #include <aws/s3/model/ListObjectsResult.h>
+#include <aws/s3/model/ObjectIdentifier.h>
 #include <aws/s3/model/PutObjectRequest.h>
 #include <aws/s3/model/PutObjectResult.h>
 #include <aws/s3/model/ServerSideEncryption.h>
+#include <aws/s3/model/UploadPartRequest.h>
 #include <aws/transfer/TransferManager.h>
+#ifdef USE_AWS_CRT
+#include <aws/s3-crt/ClientConfiguration.h>
+#include <aws/s3-crt/S3CrtClient.h>
+#include <aws/s3-crt/S3CrtErrors.h>
+#include <aws/s3-crt/model/GetObjectRequest.h>
+#include <aws/s3-crt/model/PutObjectRequest.h>
+#include <aws/s3-crt/model/ServerSideEncryption.h>
+#endif  // USE_AWS_CRT
 #endif  // USE_AWS
 
 #include <cassert>
@@ -44,6 +63,7 @@
 #include "cloud/aws/aws_file.h"
 #include "cloud/aws/aws_file_system.h"
 #include "rocksdb/cloud/cloud_storage_provider_impl.h"
+#include "cloud/cloud_request_stats.h"
 #include "cloud/filename.h"
 #include "file/read_write_util.h"
 #include "file/writable_file_writer.h"
@@ -64,12 +84,19 @@ namespace ROCKSDB_NAMESPACE {
 class CloudRequestCallbackGuard {
  public:
   CloudRequestCallbackGuard(CloudRequestCallback* callback,
-                            CloudRequestOpType type, uint64_t size = 0)
-      : callback_(callback), type_(type), size_(size), start_(now()) {}
+                            Statistics* statistics, CloudRequestOpType type,
+                            uint64_t size = 0)
+      : callback_(callback),
+        statistics_(statistics),
+        type_(type),
+        size_(size),
+        start_(now()) {}
 
   ~CloudRequestCallbackGuard() {
+    auto micros = now() - start_;
+    RecordCloudRequest(statistics_, type_, size_, micros, success_);
     if (callback_) {
-      (*callback_)(type_, size_, now() - start_, success_);
+      (*callback_)(type_, size_, micros, success_);
     }
   }
 
@@ -84,6 +111,7 @@ class CloudRequestCallbackGuard {
         .count();
   }
   CloudRequestCallback* callback_;
+  Statistics* statistics_;
   CloudRequestOpType type_;
   uint64_t size_;
   bool success_{false};
@@ -113,7 +141,8 @@ class AwsS3ClientWrapper {
       const std::shared_ptr<Aws::Auth::AWSCredentialsProvider>& creds,
       const Aws::Client::ClientConfiguration& config,
       const CloudFileSystemOptions& cloud_options)
-      : cloud_request_callback_(cloud_options.cloud_request_callback) {
+      : cloud_request_callback_(cloud_options.cloud_request_callback),
+        statistics_(cloud_options.statistics.get()) {
     if (cloud_options.s3_client_factory) {
       client_ = cloud_options.s3_client_factory(creds, config);
     } else if (creds) {
@@ -139,7 +168,7 @@ class AwsS3ClientWrapper {
 
   Aws::S3::Model::ListObjectsOutcome ListCloudObjects(
       const Aws::S3::Model::ListObjectsRequest& request) {
-    CloudRequestCallbackGuard t(cloud_request_callback_.get(),
+    CloudRequestCallbackGuard t(cloud_request_callback_.get(), statistics_,
                                 CloudRequestOpType::kListOp);
     auto outcome = client_->ListObjects(request);
     t.SetSuccess(outcome.IsSuccess());
@@ -148,7 +177,7 @@ class AwsS3ClientWrapper {
 
   Aws::S3::Model::CreateBucketOutcome CreateBucket(
       const Aws::S3::Model::CreateBucketRequest& request) {
-    CloudRequestCallbackGuard t(cloud_request_callback_.get(),
+    CloudRequestCallbackGuard t(cloud_request_callback_.get(), statistics_,
                                 CloudRequestOpType::kCreateOp);
     auto outcome = client_->CreateBucket(request);
     t.SetSuccess(outcome.IsSuccess());
@@ -157,7 +186,7 @@ class AwsS3ClientWrapper {
 
   Aws::S3::Model::HeadBucketOutcome HeadBucket(
       const Aws::S3::Model::HeadBucketRequest& request) {
-    CloudRequestCallbackGuard t(cloud_request_callback_.get(),
+    CloudRequestCallbackGuard t(cloud_request_callback_.get(), statistics_,
                                 CloudRequestOpType::kInfoOp);
     auto outcome = client_->HeadBucket(request);
     t.SetSuccess(outcome.IsSuccess());
@@ -165,16 +194,24 @@ class AwsS3ClientWrapper {
   }
   Aws::S3::Model::DeleteObjectOutcome DeleteCloudObject(
       const Aws::S3::Model::DeleteObjectRequest& request) {
-    CloudRequestCallbackGuard t(cloud_request_callback_.get(),
+    CloudRequestCallbackGuard t(cloud_request_callback_.get(), statistics_,
                                 CloudRequestOpType::kDeleteOp);
     auto outcome = client_->DeleteObject(request);
     t.SetSuccess(outcome.IsSuccess());
     return outcome;
   }
+  Aws::S3::Model::DeleteObjectsOutcome DeleteCloudObjects(
+      const Aws::S3::Model::DeleteObjectsRequest& request) {
+    CloudRequestCallbackGuard t(cloud_request_callback_.get(), statistics_,
+                                CloudRequestOpType::kDeleteOp);
+    auto outcome = client_->DeleteObjects(request);
+    t.SetSuccess(outcome.IsSuccess());
+    return outcome;
+  }
 
   Aws::S3::Model::CopyObjectOutcome CopyCloudObject(
       const Aws::S3::Model::CopyObjectRequest& request) {
-    CloudRequestCallbackGuard t(cloud_request_callback_.get(),
+    CloudRequestCallbackGuard t(cloud_request_callback_.get(), statistics_,
                                 CloudRequestOpType::kCopyOp);
     auto outcome = client_->CopyObject(request);
     t.SetSuccess(outcome.IsSuccess());
@@ -183,7 +220,7 @@ class AwsS3ClientWrapper {
 
   Aws::S3::Model::GetObjectOutcome GetCloudObject(
       const Aws::S3::Model::GetObjectRequest& request) {
-    CloudRequestCallbackGuard t(cloud_request_callback_.get(),
+    CloudRequestCallbackGuard t(cloud_request_callback_.get(), statistics_,
                                 CloudRequestOpType::kReadOp);
     auto outcome = client_->GetObject(request);
     if (outcome.IsSuccess()) {
@@ -195,7 +232,7 @@ class AwsS3ClientWrapper {
 
   template <class... Args>
   std::shared_ptr<Aws::Transfer::TransferHandle> DownloadFile(Args... args) {
-    CloudRequestCallbackGuard guard(cloud_request_callback_.get(),
+    CloudRequestCallbackGuard guard(cloud_request_callback_.get(), statistics_,
                                     CloudRequestOpType::kReadOp);
     auto handle = transfer_manager_->DownloadFile(std::forward<Args>(args)...);
 
@@ -211,17 +248,53 @@ class AwsS3ClientWrapper {
 
   Aws::S3::Model::PutObjectOutcome PutCloudObject(
       const Aws::S3::Model::PutObjectRequest& request, uint64_t size_hint = 0) {
-    CloudRequestCallbackGuard t(cloud_request_callback_.get(),
+    CloudRequestCallbackGuard t(cloud_request_callback_.get(), statistics_,
                                 CloudRequestOpType::kWriteOp, size_hint);
     auto outcome = client_->PutObject(request);
     t.SetSuccess(outcome.IsSuccess());
     return outcome;
   }
 
+  Aws::S3::Model::CreateMultipartUploadOutcome CreateMultipartUpload(
+      const Aws::S3::Model::CreateMultipartUploadRequest& request) {
+    CloudRequestCallbackGuard t(cloud_request_callback_.get(), statistics_,
+                                CloudRequestOpType::kWriteOp);
+    auto outcome = client_->CreateMultipartUpload(request);
+    t.SetSuccess(outcome.IsSuccess());
+    return outcome;
+  }
+
+  Aws::S3::Model::UploadPartOutcome UploadPart(
+      const Aws::S3::Model::UploadPartRequest& request, uint64_t size) {
+    CloudRequestCallbackGuard t(cloud_request_callback_.get(), statistics_,
+                                CloudRequestOpType::kWriteOp, size);
+    auto outcome = client_->UploadPart(request);
+    t.SetSuccess(outcome.IsSuccess());
+    return outcome;
+  }
+
+  Aws::S3::Model::CompleteMultipartUploadOutcome CompleteMultipartUpload(
+      const Aws::S3::Model::CompleteMultipartUploadRequest& request) {
+    CloudRequestCallbackGuard t(cloud_request_callback_.get(), statistics_,
+                                CloudRequestOpType::kWriteOp);
+    auto outcome = client_->CompleteMultipartUpload(request);
+    t.SetSuccess(outcome.IsSuccess());
+    return outcome;
+  }
+
+  Aws::S3::Model::AbortMultipartUploadOutcome AbortMultipartUpload(
+      const Aws::S3::Model::AbortMultipartUploadRequest& request) {
+    CloudRequestCallbackGuard t(cloud_request_callback_.get(), statistics_,
+                                CloudRequestOpType::kDeleteOp);
+    auto outcome = client_->AbortMultipartUpload(request);
+    t.SetSuccess(outcome.IsSuccess());
+    return outcome;
+  }
+
   std::shared_ptr<Aws::Transfer::TransferHandle> UploadFile(
       const Aws::String& bucket_name, const Aws::String& object_path,
       const Aws::String& destination, uint64_t file_size) {
-    CloudRequestCallbackGuard guard(cloud_request_callback_.get(),
+    CloudRequestCallbackGuard guard(cloud_request_callback_.get(), statistics_,
                                     CloudRequestOpType::kWriteOp, file_size);
 
     auto handle = transfer_manager_->UploadFile(
@@ -236,7 +309,7 @@ class AwsS3ClientWrapper {
 
   Aws::S3::Model::HeadObjectOutcome HeadObject(
       const Aws::S3::Model::HeadObjectRequest& request) {
-    CloudRequestCallbackGuard t(cloud_request_callback_.get(),
+    CloudRequestCallbackGuard t(cloud_request_callback_.get(), statistics_,
                                 CloudRequestOpType::kInfoOp);
     auto outcome = client_->HeadObject(request);
     t.SetSuccess(outcome.IsSuccess());
@@ -256,6 +329,7 @@ class AwsS3ClientWrapper {
   std::shared_ptr<Aws::S3::S3Client> client_;
   std::shared_ptr<Aws::Transfer::TransferManager> transfer_manager_;
   std::shared_ptr<CloudRequestCallback> cloud_request_callback_;
+  Statistics* statistics_;
 };
 
 static bool IsNotFound(const Aws::S3::S3Errors& s3err) {
@@ -270,11 +344,15 @@ class S3ReadableFile : public CloudStorageReadableFileImpl {
   S3ReadableFile(const std::shared_ptr<AwsS3ClientWrapper>& s3client,
                  Logger* info_log, const std::string& bucket,
                  const std::string& fname, uint64_t size,
-                 std::string content_hash)
-      : CloudStorageReadableFileImpl(info_log, bucket, fname, size),
+                 std::string content_hash,
+                 const CloudFileSystemOptions* cloud_fs_options)
+      : CloudStorageReadableFileImpl(info_log, bucket, fname, size,
+                                     cloud_fs_options),
         s3client_(s3client),
         content_hash_(std::move(content_hash)) {}
 
+  ~S3ReadableFile() override { WaitForHedgedReads(); }
+
   virtual const char* Type() const { return "s3"; }
 
   virtual size_t GetUniqueId(char* id, size_t max_size) const override {
@@ -288,9 +366,17 @@ class S3ReadableFile : public CloudStorageReadableFileImpl {
   }
 
   // random access, read data from specified offset in file
-  IOStatus DoCloudRead(uint64_t offset, size_t n, const IOOptions& /*options*/,
+  IOStatus DoCloudRead(uint64_t offset, size_t n, const IOOptions& options,
                        char* scratch, uint64_t* bytes_read,
-                       IODebugContext* /*dbg*/) const override {
+                       IODebugContext* dbg) const override {
+    return DoCancellableCloudRead(offset, n, options, scratch, bytes_read, dbg,
+                                  nullptr /*cancelled*/);
+  }
+
+  IOStatus DoCancellableCloudRead(
+      uint64_t offset, size_t n, const IOOptions& /*options*/, char* scratch,
+      uint64_t* bytes_read, IODebugContext* /*dbg*/,
+      const std::atomic<bool>* cancelled) const override {
     // create a range read request
     // Ranges are inclusive, so we can't read 0 bytes; read 1 instead and
     // drop it later.
@@ -312,6 +398,13 @@ class S3ReadableFile : public CloudStorageReadableFileImpl {
     request.SetBucket(ToAwsString(bucket_));
     request.SetKey(ToAwsString(fname_));
     request.SetRange(range);
+    if (cancelled != nullptr) {
+      // Aborts the transfer once the other request of a hedged read won.
+      request.SetContinueRequestHandler(
+          [cancelled](const Aws::Http::HttpRequest*) {
+            return !cancelled->load();
+          });
+    }
 
     Aws::S3::Model::GetObjectOutcome outcome =
         s3client_->GetCloudObject(request);
@@ -378,30 +471,19 @@ class S3StorageProvider : public CloudStorageProviderImpl {
   IOStatus ExistsBucket(const std::string& bucket) override;
   IOStatus EmptyBucket(const std::string& bucket_name,
                        const std::string& object_path) override;
-  IOStatus DeleteCloudObject(const std::string& bucket_name,
-                             const std::string& object_path) override;
   IOStatus ListCloudObjects(const std::string& bucket_name,
                             const std::string& object_path,
                             std::vector<std::string>* result) override;
-  IOStatus ExistsCloudObject(const std::string& bucket_name,
-                             const std::string& object_path) override;
-  IOStatus GetCloudObjectSize(const std::string& bucket_name,
-                              const std::string& object_path,
-                              uint64_t* filesize) override;
-  IOStatus GetCloudObjectModificationTime(const std::string& bucket_name,
-                                          const std::string& object_path,
-                                          uint64_t* time) override;
-  IOStatus GetCloudObjectMetadata(const std::string& bucket_name,
-                                  const std::string& object_path,
-                                  CloudObjectInformation* info) override;
-
-  IOStatus PutCloudObjectMetadata(
-      const std::string& bucket_name, const std::string& object_path,
-      const std::unordered_map<std::string, std::string>& metadata) override;
-  IOStatus CopyCloudObject(const std::string& bucket_name_src,
-                           const std::string& object_path_src,
-                           const std::string& bucket_name_dest,
-                           const std::string& object_path_dest) override;
+  IOStatus CreateMultipartUpload(const std::string& bucket_name,
+                                 const std::string& object_path,
+                                 std::string* upload_id) override;
+  IOStatus UploadPart(const std::string& bucket_name,
+                      const std::string& object_path,
+                      const std::string& upload_id, int part_number,
+                      const Slice& data, std::string* part_id) override;
+  IOStatus AbortMultipartUpload(const std::string& bucket_name,
+                                const std::string& object_path,
+                                const std::string& upload_id) override;
   IOStatus DoNewCloudReadableFile(
       const std::string& bucket, const std::string& fname, uint64_t fsize,
       const std::string& content_hash, const FileOptions& options,
@@ -414,14 +496,38 @@ class S3StorageProvider : public CloudStorageProviderImpl {
       IODebugContext* dbg) override;
   Status PrepareOptions(const ConfigOptions& options) override;
  protected:
+  IOStatus DoVisitCloudObjects(const std::string& bucket_name,
+                               const std::string& object_path,
+                               const std::string& start_after,
+                               const std::string& last,
+                               const CloudObjectVisitor& visitor) override;
+  IOStatus DoGetCloudObjectMetadata(const std::string& bucket_name,
+                                    const std::string& object_path,
+                                    CloudObjectInformation* info) override;
+  IOStatus DoDeleteCloudObject(const std::string& bucket_name,
+                               const std::string& object_path) override;
+  IOStatus DoDeleteCloudObjects(
+      const std::string& bucket_name,
+      const std::vector<std::string>& object_paths) override;
+  IOStatus DoCopyCloudObject(const std::string& bucket_name_src,
+                             const std::string& object_path_src,
+                             const std::string& bucket_name_dest,
+                             const std::string& object_path_dest) override;
+  IOStatus DoPutCloudObjectMetadata(
+      const std::string& bucket_name, const std::string& object_path,
+      const std::unordered_map<std::string, std::string>& metadata) override;
+  IOStatus DoCompleteMultipartUpload(
+      const std::string& bucket_name, const std::string& object_path,
+      const std::string& upload_id,
+      const std::vector<std::string>& part_ids) override;
   IOStatus DoGetCloudObject(const std::string& bucket_name,
                             const std::string& object_path,
                             const std::string& destination,
                             uint64_t* remote_size) override;
   IOStatus DoPutCloudObject(const std::string& local_file,
                             const std::string& bucket_name,
-                            const std::string& object_path,
-                            uint64_t file_size) override;
+                            const std::string& object_path, uint64_t file_size,
+                            const std::string& crc32c) override;
 
  private:
   struct HeadObjectResult {
@@ -430,6 +536,8 @@ class S3StorageProvider : public CloudStorageProviderImpl {
     uint64_t* size = nullptr;
     uint64_t* modtime = nullptr;
     std::string* etag = nullptr;
+    // Empty if the object was not uploaded with a crc32c.
+    std::string* crc32c = nullptr;
   };
 
   // Retrieves metadata from an object
@@ -564,19 +672,20 @@ IOStatus S3StorageProvider::EmptyBucket(const std::string& bucket_name,
       results.size(), bucket_name.c_str());
 
   // Delete all objects from bucket
-  for (const auto& path : results) {
-    st = DeleteCloudObject(bucket_name, object_path + "/" + path);
-    if (!st.ok()) {
-      Log(InfoLogLevel::ERROR_LEVEL, cfs_->GetLogger(),
-          "[s3] EmptyBucket Unable to delete %s in bucket %s %s", path.c_str(),
-          bucket_name.c_str(), st.ToString().c_str());
-    }
+  for (auto& path : results) {
+    path = object_path + "/" + path;
+  }
+  st = DeleteCloudObjects(bucket_name, results);
+  if (!st.ok()) {
+    Log(InfoLogLevel::ERROR_LEVEL, cfs_->GetLogger(),
+        "[s3] EmptyBucket Unable to delete objects in bucket %s %s",
+        bucket_name.c_str(), st.ToString().c_str());
   }
   return st;
 }
 
-IOStatus S3StorageProvider::DeleteCloudObject(const std::string& bucket_name,
-                                              const std::string& object_path) {
+IOStatus S3StorageProvider::DoDeleteCloudObject(
+    const std::string& bucket_name, const std::string& object_path) {
   IOStatus st;
 
   // create request
@@ -605,6 +714,65 @@ IOStatus S3StorageProvider::DeleteCloudObject(const std::string& bucket_name,
   return st;
 }
 
+//
+// Deletes the objects with DeleteObjects requests of up to
+// kMaxDeleteObjectsKeys keys each
+//
+IOStatus S3StorageProvider::DoDeleteCloudObjects(
+    const std::string& bucket_name,
+    const std::vector<std::string>& object_paths) {
+  // The S3 limit on the number of keys in one DeleteObjects request
+  static constexpr size_t kMaxDeleteObjectsKeys = 1000;
+  IOStatus result;
+  for (size_t start = 0; start < object_paths.size();
+       start += kMaxDeleteObjectsKeys) {
+    size_t end =
+        std::min(object_paths.size(), start + kMaxDeleteObjectsKeys);
+    Aws::Vector<Aws::S3::Model::ObjectIdentifier> objects;
+    objects.reserve(end - start);
+    for (size_t i = start; i < end; ++i) {
+      objects.push_back(Aws::S3::Model::ObjectIdentifier().WithKey(
+          ToAwsString(object_paths[i])));
+    }
+    Aws::S3::Model::DeleteObjectsRequest request;
+    request.SetBucket(ToAwsString(bucket_name));
+    // Quiet mode only reports the keys that failed to be deleted
+    request.SetDelete(Aws::S3::Model::Delete()
+                          .WithObjects(std::move(objects))
+                          .WithQuiet(true));
+
+    IOStatus st;
+    auto outcome = s3client_->DeleteCloudObjects(request);
+    if (!outcome.IsSuccess()) {
+      const auto& error = outcome.GetError();
+      std::string errmsg(error.GetMessage().c_str());
+      st = IOStatus::IOError(bucket_name, errmsg.c_str());
+    } else {
+      for (const auto& error : outcome.GetResult().GetErrors()) {
+        if (error.GetCode() == "NoSuchKey") {
+          continue;
+        }
+        Log(InfoLogLevel::ERROR_LEVEL, cfs_->GetLogger(),
+            "[s3] DeleteObjects unable to delete %s/%s: %s %s",
+            bucket_name.c_str(), error.GetKey().c_str(),
+            error.GetCode().c_str(), error.GetMessage().c_str());
+        if (st.ok()) {
+          st = IOStatus::IOError(error.GetKey().c_str(),
+                                 error.GetMessage().c_str());
+        }
+      }
+    }
+
+    Log(InfoLogLevel::INFO_LEVEL, cfs_->GetLogger(),
+        "[s3] DeleteObjects %s %" ROCKSDB_PRIszt " objects, status %s",
+        bucket_name.c_str(), end - start, st.ToString().c_str());
+    if (!st.ok() && result.ok()) {
+      result = st;
+    }
+  }
+  return result;
+}
+
 //
 // Appends the names of all children of the specified path from S3
 // into the result set.
@@ -612,6 +780,17 @@ IOStatus S3StorageProvider::DeleteCloudObject(const std::string& bucket_name,
 IOStatus S3StorageProvider::ListCloudObjects(const std::string& bucket_name,
                                              const std::string& object_path,
                                              std::vector<std::string>* result) {
+  return DoVisitCloudObjects(bucket_name, object_path, "", "",
+                             [result](const std::string& name) {
+                               result->push_back(name);
+                               return true;
+                             });
+}
+
+IOStatus S3StorageProvider::DoVisitCloudObjects(
+    const std::string& bucket_name, const std::string& object_path,
+    const std::string& start_after, const std::string& last,
+    const CloudObjectVisitor& visitor) {
   // S3 paths don't start with '/'
   auto prefix = ltrim_if(object_path, '/');
   // S3 paths better end with '/', otherwise we might also get a list of files
@@ -619,6 +798,9 @@ IOStatus S3StorageProvider::ListCloudObjects(const std::string& bucket_name,
   prefix = ensure_ends_with_pathsep(std::move(prefix));
   // the starting object marker
   Aws::String marker;
+  if (!start_after.empty()) {
+    marker = ToAwsString(prefix + start_after);
+  }
   bool loop = true;
 
   // get info of bucket+object
@@ -657,7 +839,17 @@ IOStatus S3StorageProvider::ListCloudObjects(const std::string& bucket_name,
         return IOStatus::IOError("Unexpected result from AWS S3: " + keystr);
       }
       auto fname = keystr.substr(prefix.size());
-      result->push_back(std::move(fname));
+      CloudObjectInformation info;
+      info.size = o.GetSize();
+      info.modification_time = o.GetLastModified().Millis();
+      info.content_hash =
+          std::string(o.GetETag().data(), o.GetETag().length());
+      CacheObjectMetadata(
+          bucket_name, keystr,
+          kCachedSize | kCachedModificationTime | kCachedContentHash, info);
+      if ((!last.empty() && fname > last) || !visitor(fname)) {
+        return IOStatus::OK();
+      }
     }
 
     // If there are no more entries, then we are done.
@@ -677,31 +869,7 @@ IOStatus S3StorageProvider::ListCloudObjects(const std::string& bucket_name,
   return IOStatus::OK();
 }
 
-// check existence of the cloud object
-IOStatus S3StorageProvider::ExistsCloudObject(const std::string& bucket_name,
-                                              const std::string& object_path) {
-  HeadObjectResult result;
-  return HeadObject(bucket_name, object_path, &result);
-}
-
-// Return size of cloud object
-IOStatus S3StorageProvider::GetCloudObjectSize(const std::string& bucket_name,
-                                               const std::string& object_path,
-                                               uint64_t* filesize) {
-  HeadObjectResult result;                                             
-  result.size = filesize;
-  return HeadObject(bucket_name, object_path, &result);
-}
-
-IOStatus S3StorageProvider::GetCloudObjectModificationTime(
-    const std::string& bucket_name, const std::string& object_path,
-    uint64_t* time) {
-  HeadObjectResult result;
-  result.modtime = time;
-  return HeadObject(bucket_name, object_path, &result);
-}
-
-IOStatus S3StorageProvider::GetCloudObjectMetadata(
+IOStatus S3StorageProvider::DoGetCloudObjectMetadata(
     const std::string& bucket_name, const std::string& object_path,
     CloudObjectInformation* info) {
   assert(info != nullptr);
@@ -710,10 +878,11 @@ IOStatus S3StorageProvider::GetCloudObjectMetadata(
   result.size = &info->size;
   result.modtime = &info->modification_time;
   result.etag = &info->content_hash;
+  result.crc32c = &info->crc32c;
   return HeadObject(bucket_name, object_path, &result);
 }
 
-IOStatus S3StorageProvider::PutCloudObjectMetadata(
+IOStatus S3StorageProvider::DoPutCloudObjectMetadata(
     const std::string& bucket_name, const std::string& object_path,
     const std::unordered_map<std::string, std::string>& metadata) {
   Aws::S3::Model::PutObjectRequest request;
@@ -745,7 +914,8 @@ IOStatus S3StorageProvider::DoNewCloudReadableFile(
     std::unique_ptr<CloudStorageReadableFile>* result,
     IODebugContext* /*dbg*/) {
   result->reset(new S3ReadableFile(s3client_, cfs_->GetLogger(), bucket, fname,
-                                   fsize, content_hash));
+                                   fsize, content_hash,
+                                   &cfs_->GetCloudFileSystemOptions()));
   return IOStatus::OK();
 }
 
@@ -765,6 +935,9 @@ IOStatus S3StorageProvider::HeadObject(const std::string& bucket_name,
   Aws::S3::Model::HeadObjectRequest request;
   request.SetBucket(ToAwsString(bucket_name));
   request.SetKey(ToAwsString(object_path));
+  if (result->crc32c != nullptr) {
+    request.SetChecksumMode(Aws::S3::Model::ChecksumMode::ENABLED);
+  }
   return HeadObject(request, result);
 }
 
@@ -799,12 +972,15 @@ IOStatus S3StorageProvider::HeadObject(
   if ((result->etag) != nullptr) {
     *(result->etag) = std::string(res.GetETag().data(), res.GetETag().length());
   }
+  if (result->crc32c != nullptr) {
+    *(result->crc32c) = FromAwsChecksum(res.GetChecksumCRC32C());
+  }
   return IOStatus::OK();
 }
 
 // Copy the specified cloud object from one location in the cloud
 // storage to another location in cloud storage
-IOStatus S3StorageProvider::CopyCloudObject(
+IOStatus S3StorageProvider::DoCopyCloudObject(
     const std::string& bucket_name_src, const std::string& object_path_src,
     const std::string& bucket_name_dest, const std::string& object_path_dest) {
   Aws::String src_bucket = ToAwsString(bucket_name_src);
@@ -907,6 +1083,34 @@ class IOStreamWithOwnedBuf : public std::iostream {
   std::unique_ptr<T> s_;
 };
 
+// Returns a factory for the stream that a GetObject response is written to.
+// The stream writes to destination on the base file system and closes it when
+// destroyed, saving the status of the close in fileCloseStatus.
+std::function<Aws::IOStream*()> NewDownloadStreamFactory(
+    CloudFileSystem* cfs, const std::string& destination,
+    IOStatus* fileCloseStatus) {
+  return [cfs, destination, fileCloseStatus]() -> Aws::IOStream* {
+    FileOptions foptions;
+    foptions.use_direct_writes =
+        cfs->GetCloudFileSystemOptions().use_direct_io_for_cloud_download;
+    std::unique_ptr<FSWritableFile> file;
+    auto st = NewWritableFile(cfs->GetBaseFileSystem().get(), destination,
+                              &file, foptions);
+    if (!st.ok()) {
+      // fallback to FStream
+      return Aws::New<Aws::FStream>(Aws::Utils::ARRAY_ALLOCATION_TAG,
+                                    destination,
+                                    std::ios_base::out | std::ios_base::trunc);
+    }
+    return Aws::New<IOStreamWithOwnedBuf<WritableFileStreamBuf>>(
+        Aws::Utils::ARRAY_ALLOCATION_TAG,
+        std::unique_ptr<WritableFileStreamBuf>(new WritableFileStreamBuf(
+            fileCloseStatus,
+            std::unique_ptr<WritableFileWriter>(new WritableFileWriter(
+                std::move(file), destination, foptions)))));
+  };
+}
+
 }  // namespace
 
 IOStatus S3StorageProvider::DoGetCloudObject(const std::string& bucket_name,
@@ -950,31 +1154,11 @@ IOStatus S3StorageProvider::DoGetCloudObject(const std::string& bucket_name,
       // Close() will be called in the destructor of the object returned by
       // this factory. Adding an inner scope so that the destructor is called
       // before checking fileCloseStatus.
-      auto ioStreamFactory = [this, destination, &fileCloseStatus]() -> Aws::IOStream* {
-        FileOptions foptions;
-        foptions.use_direct_writes =
-            cfs_->GetCloudFileSystemOptions().use_direct_io_for_cloud_download;
-        std::unique_ptr<FSWritableFile> file;
-        auto st = NewWritableFile(cfs_->GetBaseFileSystem().get(), destination,
-                                  &file, foptions);
-        if (!st.ok()) {
-          // fallback to FStream
-          return Aws::New<Aws::FStream>(
-              Aws::Utils::ARRAY_ALLOCATION_TAG, destination,
-              std::ios_base::out | std::ios_base::trunc);
-        }
-        return Aws::New<IOStreamWithOwnedBuf<WritableFileStreamBuf>>(
-            Aws::Utils::ARRAY_ALLOCATION_TAG,
-            std::unique_ptr<WritableFileStreamBuf>(new WritableFileStreamBuf(
-                &fileCloseStatus,
-                std::unique_ptr<WritableFileWriter>(new WritableFileWriter(
-                        std::move(file), destination, foptions)))));
-      };
-
       Aws::S3::Model::GetObjectRequest request;
       request.SetBucket(ToAwsString(bucket_name));
       request.SetKey(ToAwsString(object_path));
-      request.SetResponseStreamFactory(std::move(ioStreamFactory));
+      request.SetResponseStreamFactory(
+          NewDownloadStreamFactory(cfs_, destination, &fileCloseStatus));
 
       auto outcome = s3client_->GetCloudObject(request);
       if (outcome.IsSuccess()) {
@@ -1010,7 +1194,9 @@ IOStatus S3StorageProvider::DoGetCloudObject(const std::string& bucket_name,
 IOStatus S3StorageProvider::DoPutCloudObject(const std::string& local_file,
                                              const std::string& bucket_name,
                                              const std::string& object_path,
-                                             uint64_t file_size) {
+                                             uint64_t file_size,
+                                             const std::string& crc32c) {
+  // The transfer manager computes the checksums of its parts itself.
   if (s3client_->HasTransferManager()) {
     auto handle = s3client_->UploadFile(ToAwsString(bucket_name),
                                         ToAwsString(object_path),
@@ -1032,6 +1218,9 @@ IOStatus S3StorageProvider::DoPutCloudObject(const std::string& local_file,
     putRequest.SetBucket(ToAwsString(bucket_name));
     putRequest.SetKey(ToAwsString(object_path));
     putRequest.SetBody(inputData);
+    if (!crc32c.empty()) {
+      putRequest.SetChecksumCRC32C(ToAwsChecksum(crc32c));
+    }
     SetEncryptionParameters(cfs_->GetCloudFileSystemOptions(), putRequest);
 
     auto outcome = s3client_->PutCloudObject(putRequest, file_size);
@@ -1050,6 +1239,310 @@ IOStatus S3StorageProvider::DoPutCloudObject(const std::string& local_file,
   return IOStatus::OK();
 }
 
+IOStatus S3StorageProvider::CreateMultipartUpload(
+    const std::string& bucket_name, const std::string& object_path,
+    std::string* upload_id) {
+  Aws::S3::Model::CreateMultipartUploadRequest request;
+  request.SetBucket(ToAwsString(bucket_name));
+  request.SetKey(ToAwsString(object_path));
+  SetEncryptionParameters(cfs_->GetCloudFileSystemOptions(), request);
+
+  auto outcome = s3client_->CreateMultipartUpload(request);
+  if (!outcome.IsSuccess()) {
+    const auto& error = outcome.GetError();
+    std::string errmsg(error.GetMessage().c_str(), error.GetMessage().size());
+    Log(InfoLogLevel::ERROR_LEVEL, cfs_->GetLogger(),
+        "[s3] CreateMultipartUpload %s/%s, ERROR %s", bucket_name.c_str(),
+        object_path.c_str(), errmsg.c_str());
+    return IOStatus::IOError(object_path, errmsg);
+  }
+  const auto& id = outcome.GetResult().GetUploadId();
+  upload_id->assign(id.c_str(), id.size());
+  return IOStatus::OK();
+}
+
+IOStatus S3StorageProvider::UploadPart(const std::string& bucket_name,
+                                       const std::string& object_path,
+                                       const std::string& upload_id,
+                                       int part_number, const Slice& data,
+                                       std::string* part_id) {
+  auto buf = std::make_unique<Aws::Utils::Stream::PreallocatedStreamBuf>(
+      reinterpret_cast<unsigned char*>(const_cast<char*>(data.data())),
+      data.size());
+  auto body = Aws::MakeShared<
+      IOStreamWithOwnedBuf<Aws::Utils::Stream::PreallocatedStreamBuf>>(
+      object_path.c_str(), std::move(buf));
+
+  Aws::S3::Model::UploadPartRequest request;
+  request.SetBucket(ToAwsString(bucket_name));
+  request.SetKey(ToAwsString(object_path));
+  request.SetUploadId(ToAwsString(upload_id));
+  request.SetPartNumber(part_number);
+  request.SetContentLength(static_cast<long long>(data.size()));
+  request.SetBody(body);
+
+  auto outcome = s3client_->UploadPart(request, data.size());
+  if (!outcome.IsSuccess()) {
+    const auto& error = outcome.GetError();
+    std::string errmsg(error.GetMessage().c_str(), error.GetMessage().size());
+    Log(InfoLogLevel::ERROR_LEVEL, cfs_->GetLogger(),
+        "[s3] UploadPart %s/%s, part %d, size %" ROCKSDB_PRIszt ", ERROR %s",
+        bucket_name.c_str(), object_path.c_str(), part_number, data.size(),
+        errmsg.c_str());
+    return IOStatus::IOError(object_path, errmsg);
+  }
+  const auto& etag = outcome.GetResult().GetETag();
+  part_id->assign(etag.c_str(), etag.size());
+  return IOStatus::OK();
+}
+
+IOStatus S3StorageProvider::DoCompleteMultipartUpload(
+    const std::string& bucket_name, const std::string& object_path,
+    const std::string& upload_id, const std::vector<std::string>& part_ids) {
+  Aws::S3::Model::CompletedMultipartUpload upload;
+  for (size_t i = 0; i < part_ids.size(); i++) {
+    Aws::S3::Model::CompletedPart part;
+    part.SetPartNumber(static_cast<int>(i + 1));
+    part.SetETag(ToAwsString(part_ids[i]));
+    upload.AddParts(std::move(part));
+  }
+  Aws::S3::Model::CompleteMultipartUploadRequest request;
+  request.SetBucket(ToAwsString(bucket_name));
+  request.SetKey(ToAwsString(object_path));
+  request.SetUploadId(ToAwsString(upload_id));
+  request.SetMultipartUpload(std::move(upload));
+
+  auto outcome = s3client_->CompleteMultipartUpload(request);
+  if (!outcome.IsSuccess()) {
+    const auto& error = outcome.GetError();
+    std::string errmsg(error.GetMessage().c_str(), error.GetMessage().size());
+    Log(InfoLogLevel::ERROR_LEVEL, cfs_->GetLogger(),
+        "[s3] CompleteMultipartUpload %s/%s, ERROR %s", bucket_name.c_str(),
+        object_path.c_str(), errmsg.c_str());
+    return IOStatus::IOError(object_path, errmsg);
+  }
+  Log(InfoLogLevel::INFO_LEVEL, cfs_->GetLogger(),
+      "[s3] CompleteMultipartUpload %s/%s, %" ROCKSDB_PRIszt " parts, OK",
+      bucket_name.c_str(), object_path.c_str(), part_ids.size());
+  return IOStatus::OK();
+}
+
+IOStatus S3StorageProvider::AbortMultipartUpload(
+    const std::string& bucket_name, const std::string& object_path,
+    const std::string& upload_id) {
+  Aws::S3::Model::AbortMultipartUploadRequest request;
+  request.SetBucket(ToAwsString(bucket_name));
+  request.SetKey(ToAwsString(object_path));
+  request.SetUploadId(ToAwsString(upload_id));
+
+  auto outcome = s3client_->AbortMultipartUpload(request);
+  if (!outcome.IsSuccess()) {
+    const auto& error = outcome.GetError();
+    std::string errmsg(error.GetMessage().c_str(), error.GetMessage().size());
+    Log(InfoLogLevel::ERROR_LEVEL, cfs_->GetLogger(),
+        "[s3] AbortMultipartUpload %s/%s, ERROR %s", bucket_name.c_str(),
+        object_path.c_str(), errmsg.c_str());
+    return IOStatus::IOError(object_path, errmsg);
+  }
+  return IOStatus::OK();
+}
+
+#ifdef USE_AWS_CRT
+/******************** S3CrtClientWrapper ******************/
+
+// Moves whole objects with the AWS CRT S3 client, which splits every GET and
+// PUT into parallel ranged requests and multipart uploads over a pool of
+// connections driven by its own event loop.
+class AwsS3CrtClientWrapper {
+ public:
+  AwsS3CrtClientWrapper(
+      const std::shared_ptr<Aws::Auth::AWSCredentialsProvider>& creds,
+      const Aws::S3Crt::ClientConfiguration& config,
+      const CloudFileSystemOptions& cloud_options)
+      : cloud_request_callback_(cloud_options.cloud_request_callback),
+        statistics_(cloud_options.statistics.get()) {
+    if (creds) {
+      client_ = std::make_shared<Aws::S3Crt::S3CrtClient>(
+          creds, config,
+          Aws::Client::AWSAuthV4Signer::PayloadSigningPolicy::Never,
+          true /* useVirtualAddressing */);
+    } else {
+      client_ = std::make_shared<Aws::S3Crt::S3CrtClient>(config);
+    }
+  }
+
+  Aws::S3Crt::Model::GetObjectOutcome GetCloudObject(
+      const Aws::S3Crt::Model::GetObjectRequest& request) {
+    CloudRequestCallbackGuard t(cloud_request_callback_.get(), statistics_,
+                                CloudRequestOpType::kReadOp);
+    auto outcome = client_->GetObject(request);
+    if (outcome.IsSuccess()) {
+      t.SetSize(outcome.GetResult().GetContentLength());
+      t.SetSuccess(true);
+    }
+    return outcome;
+  }
+
+  Aws::S3Crt::Model::PutObjectOutcome PutCloudObject(
+      const Aws::S3Crt::Model::PutObjectRequest& request,
+      uint64_t size_hint = 0) {
+    CloudRequestCallbackGuard t(cloud_request_callback_.get(), statistics_,
+                                CloudRequestOpType::kWriteOp, size_hint);
+    auto outcome = client_->PutObject(request);
+    t.SetSuccess(outcome.IsSuccess());
+    return outcome;
+  }
+
+ private:
+  std::shared_ptr<Aws::S3Crt::S3CrtClient> client_;
+  std::shared_ptr<CloudRequestCallback> cloud_request_callback_;
+  Statistics* statistics_;
+};
+
+static bool IsNotFound(const Aws::S3Crt::S3CrtErrors& s3err) {
+  return (s3err == Aws::S3Crt::S3CrtErrors::NO_SUCH_BUCKET ||
+          s3err == Aws::S3Crt::S3CrtErrors::NO_SUCH_KEY ||
+          s3err == Aws::S3Crt::S3CrtErrors::RESOURCE_NOT_FOUND);
+}
+
+/******************** S3CrtStorageProvider ******************/
+
+// An S3 provider whose downloads and uploads of whole objects go through the
+// AWS CRT S3 client. Ranged reads of cloud files, multipart uploads of
+// streamed SST files and all the metadata requests still use the classic
+// client.
+class S3CrtStorageProvider : public S3StorageProvider {
+ public:
+  const char* Name() const override { return kS3Crt(); }
+  Status PrepareOptions(const ConfigOptions& options) override;
+
+ protected:
+  IOStatus DoGetCloudObject(const std::string& bucket_name,
+                            const std::string& object_path,
+                            const std::string& destination,
+                            uint64_t* remote_size) override;
+  IOStatus DoPutCloudObject(const std::string& local_file,
+                            const std::string& bucket_name,
+                            const std::string& object_path, uint64_t file_size,
+                            const std::string& crc32c) override;
+
+ private:
+  std::shared_ptr<AwsS3CrtClientWrapper> crt_client_;
+};
+
+Status S3CrtStorageProvider::PrepareOptions(const ConfigOptions& options) {
+  auto status = S3StorageProvider::PrepareOptions(options);
+  if (!status.ok()) {
+    return status;
+  }
+  const auto& cloud_opts = cfs_->GetCloudFileSystemOptions();
+  Aws::Client::ClientConfiguration config;
+  status = AwsCloudOptions::GetClientConfiguration(
+      cfs_, cloud_opts.src_bucket.GetRegion(), &config);
+  if (!status.ok()) {
+    return status;
+  }
+  std::shared_ptr<Aws::Auth::AWSCredentialsProvider> creds;
+  status = cloud_opts.credentials.GetCredentialsProvider(&creds);
+  if (!status.ok()) {
+    return status;
+  }
+  // Same endpoint, timeouts and retries as the classic client.
+  Aws::S3Crt::ClientConfiguration crt_config;
+  static_cast<Aws::Client::ClientConfiguration&>(crt_config) = config;
+  crt_config.throughputTargetGbps = cloud_opts.s3_crt_throughput_target_gbps;
+  crt_config.partSize = cloud_opts.s3_crt_part_size;
+  Header(cfs_->GetLogger(),
+         "S3 CRT client in region: %s, target %.1f Gbps, part size %" PRIu64,
+         crt_config.region.c_str(), crt_config.throughputTargetGbps,
+         cloud_opts.s3_crt_part_size);
+  crt_client_ =
+      std::make_shared<AwsS3CrtClientWrapper>(creds, crt_config, cloud_opts);
+  return status;
+}
+
+IOStatus S3CrtStorageProvider::DoGetCloudObject(const std::string& bucket_name,
+                                                const std::string& object_path,
+                                                const std::string& destination,
+                                                uint64_t* remote_size) {
+  IOStatus fileCloseStatus;
+  {
+    // The file is closed when the response stream is destroyed, at the end
+    // of this scope.
+    Aws::S3Crt::Model::GetObjectRequest request;
+    request.SetBucket(ToAwsString(bucket_name));
+    request.SetKey(ToAwsString(object_path));
+    request.SetResponseStreamFactory(
+        NewDownloadStreamFactory(cfs_, destination, &fileCloseStatus));
+
+    auto outcome = crt_client_->GetCloudObject(request);
+    if (!outcome.IsSuccess()) {
+      const auto& error = outcome.GetError();
+      std::string errmsg(error.GetMessage().c_str(), error.GetMessage().size());
+      Log(InfoLogLevel::ERROR_LEVEL, cfs_->GetLogger(),
+          "[s3-crt] GetObject %s/%s error %s.", bucket_name.c_str(),
+          object_path.c_str(), errmsg.c_str());
+      if (IsNotFound(error.GetErrorType())) {
+        return IOStatus::NotFound(std::move(errmsg));
+      }
+      return IOStatus::IOError(std::move(errmsg));
+    }
+    *remote_size = outcome.GetResult().GetContentLength();
+  }
+  if (!fileCloseStatus.ok()) {
+    std::string errmsg = fileCloseStatus.ToString();
+    Log(InfoLogLevel::ERROR_LEVEL, cfs_->GetLogger(),
+        "[s3-crt] GetObject %s/%s error closing file %s.", bucket_name.c_str(),
+        object_path.c_str(), errmsg.c_str());
+    return IOStatus::IOError(std::move(errmsg));
+  }
+  return IOStatus::OK();
+}
+
+IOStatus S3CrtStorageProvider::DoPutCloudObject(const std::string& local_file,
+                                                const std::string& bucket_name,
+                                                const std::string& object_path,
+                                                uint64_t file_size,
+                                                const std::string& crc32c) {
+  auto inputData =
+      Aws::MakeShared<Aws::FStream>(object_path.c_str(), local_file.c_str(),
+                                    std::ios_base::in | std::ios_base::binary);
+
+  Aws::S3Crt::Model::PutObjectRequest putRequest;
+  putRequest.SetBucket(ToAwsString(bucket_name));
+  putRequest.SetKey(ToAwsString(object_path));
+  putRequest.SetBody(inputData);
+  if (!crc32c.empty()) {
+    putRequest.SetChecksumCRC32C(ToAwsChecksum(crc32c));
+  }
+  const auto& cloud_opts = cfs_->GetCloudFileSystemOptions();
+  if (cloud_opts.server_side_encryption) {
+    if (cloud_opts.encryption_key_id.empty()) {
+      putRequest.SetServerSideEncryption(
+          Aws::S3Crt::Model::ServerSideEncryption::AES256);
+    } else {
+      putRequest.SetServerSideEncryption(
+          Aws::S3Crt::Model::ServerSideEncryption::aws_kms);
+      putRequest.SetSSEKMSKeyId(cloud_opts.encryption_key_id.c_str());
+    }
+  }
+
+  auto outcome = crt_client_->PutCloudObject(putRequest, file_size);
+  if (!outcome.IsSuccess()) {
+    const auto& error = outcome.GetError();
+    std::string errmsg(error.GetMessage().c_str(), error.GetMessage().size());
+    Log(InfoLogLevel::ERROR_LEVEL, cfs_->GetLogger(),
+        "[s3-crt] PutCloudObject %s/%s, size %" PRIu64 ", ERROR %s",
+        bucket_name.c_str(), object_path.c_str(), file_size, errmsg.c_str());
+    return IOStatus::IOError(local_file, errmsg);
+  }
+  Log(InfoLogLevel::INFO_LEVEL, cfs_->GetLogger(),
+      "[s3-crt] PutCloudObject %s/%s, size %" PRIu64 ", OK",
+      bucket_name.c_str(), object_path.c_str(), file_size);
+  return IOStatus::OK();
+}
+#endif  // USE_AWS_CRT
+
 #endif /* USE_AWS */
 
 Status CloudStorageProviderImpl::CreateS3Provider(
@@ -1063,5 +1556,18 @@ Status CloudStorageProviderImpl::CreateS3Provider(
   return Status::OK();
 #endif /* USE_AWS */
 }
+
+Status CloudStorageProviderImpl::CreateS3CrtProvider(
+    std::unique_ptr<CloudStorageProvider>* provider) {
+#ifndef USE_AWS_CRT
+  provider->reset();
+  return Status::NotSupported(
+      "In order to use the S3 CRT client, make sure you're compiling with "
+      "USE_AWS=1 and USE_AWS_CRT=1");
+#else
+  provider->reset(new S3CrtStorageProvider());
+  return Status::OK();
+#endif /* USE_AWS_CRT */
+}
 }  // namespace ROCKSDB_NAMESPACE
 #endif  // ROCKSDB_LITE
@@ -0,0 +1,10 @@
+#!/usr/bin/env bash
+# Leader/follower replication benchmark. Runs a leader with 8 writer threads
+# and 2 in-process followers over a transport with 1 ms of latency, reporting
+# the leader's write throughput, the followers' apply throughput and the
+# replication lag percentiles.
+#
+# Usage: replication_bench.sh [extra db_repl_bench flags]
+
+echo "Replicate 8M writes of 1 KB values to 2 followers....."
+./db_repl_bench --db=/tmp/rocksdb_repl_bench --num=1000000 --threads=8 --batch_size=1 --key_size=16 --value_size=1024 --followers=2 --transport_latency_us=1000 --write_buffer_size=134217728 --report_interval_seconds=10 "$@"
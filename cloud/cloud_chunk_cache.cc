@@ -0,0 +1,329 @@
+//  Copyright (c) 2016-present, Rockset, Inc.  All rights reserved.
+
+#include "rocksdb/cloud/cloud_chunk_cache.h"
+
+#include <cinttypes>
+
+#include "util/coding.h"
+#include "util/crc32c.h"
+#include "util/hash.h"
+
+namespace ROCKSDB_NAMESPACE {
+
+namespace {
+const uint64_t kIndexMagic = 0x6b6e756863646c63ULL;  // "cldchunk"
+// The index file starts with a header record, followed by one record per
+// slot. Both have the same size.
+const size_t kIndexRecordSize = 32;
+
+std::string IndexFileName(const std::string& path) {
+  return path + "/INDEX";
+}
+std::string DataFileName(const std::string& path) { return path + "/DATA"; }
+std::string LockFileName(const std::string& path) { return path + "/LOCK"; }
+
+IOStatus OpenOrCreateRWFile(FileSystem* fs, const std::string& fname,
+                            std::unique_ptr<FSRandomRWFile>* result) {
+  IOStatus s = fs->FileExists(fname, IOOptions(), nullptr);
+  if (s.IsNotFound()) {
+    std::unique_ptr<FSWritableFile> file;
+    s = fs->NewWritableFile(fname, FileOptions(), &file, nullptr);
+    if (s.ok()) {
+      s = file->Close(IOOptions(), nullptr);
+    }
+  }
+  if (s.ok()) {
+    s = fs->NewRandomRWFile(fname, FileOptions(), result, nullptr);
+  }
+  return s;
+}
+}  // namespace
+
+IOStatus CloudChunkCache::Open(const CloudChunkCacheOptions& options,
+                               std::shared_ptr<CloudChunkCache>* cache) {
+  if (options.path.empty()) {
+    return IOStatus::InvalidArgument("CloudChunkCache: path is empty");
+  }
+  if (options.chunk_size == 0 || options.capacity < options.chunk_size) {
+    return IOStatus::InvalidArgument(
+        "CloudChunkCache: capacity must hold at least one chunk");
+  }
+
+  // All the users of a path in this process share the same cache.
+  static std::mutex registry_mutex;
+  static std::unordered_map<std::string, std::weak_ptr<CloudChunkCache>>
+      registry;
+  std::lock_guard<std::mutex> lk(registry_mutex);
+  auto existing = registry[options.path].lock();
+  if (existing) {
+    if (existing->options_.chunk_size != options.chunk_size ||
+        existing->GetCapacity() != (options.capacity / options.chunk_size) *
+                                       options.chunk_size) {
+      return IOStatus::InvalidArgument(
+          "CloudChunkCache: " + options.path +
+          " is already open with a different capacity or chunk size");
+    }
+    *cache = existing;
+    return IOStatus::OK();
+  }
+
+  CloudChunkCacheOptions opts = options;
+  if (!opts.fs) {
+    opts.fs = FileSystem::Default();
+  }
+  std::shared_ptr<CloudChunkCache> result(
+      new CloudChunkCache(opts, opts.capacity / opts.chunk_size));
+  auto s = result->Init();
+  if (!s.ok()) {
+    return s;
+  }
+  registry[options.path] = result;
+  *cache = std::move(result);
+  return IOStatus::OK();
+}
+
+CloudChunkCache::CloudChunkCache(const CloudChunkCacheOptions& options,
+                                 uint64_t num_slots)
+    : options_(options), num_slots_(num_slots), slots_(num_slots) {}
+
+CloudChunkCache::~CloudChunkCache() {
+  if (data_file_) {
+    data_file_->Close(IOOptions(), nullptr).PermitUncheckedError();
+  }
+  if (index_file_) {
+    index_file_->Close(IOOptions(), nullptr).PermitUncheckedError();
+  }
+  if (lock_ != nullptr) {
+    options_.fs->UnlockFile(lock_, IOOptions(), nullptr)
+        .PermitUncheckedError();
+  }
+}
+
+IOStatus CloudChunkCache::Init() {
+  auto* fs = options_.fs.get();
+  auto s = fs->CreateDirIfMissing(options_.path, IOOptions(), nullptr);
+  if (s.ok()) {
+    s = fs->LockFile(LockFileName(options_.path), IOOptions(), &lock_,
+                     nullptr);
+  }
+  if (s.ok()) {
+    s = OpenOrCreateRWFile(fs, DataFileName(options_.path), &data_file_);
+  }
+  if (s.ok()) {
+    s = OpenOrCreateRWFile(fs, IndexFileName(options_.path), &index_file_);
+  }
+  if (!s.ok()) {
+    return s;
+  }
+
+  // Load the index. If it was written with a different geometry, or its
+  // header is damaged, the cache starts empty.
+  std::string buf((num_slots_ + 1) * kIndexRecordSize, '\0');
+  Slice index;
+  s = index_file_->Read(0, buf.size(), IOOptions(), &index, &buf[0], nullptr);
+  if (!s.ok()) {
+    return s;
+  }
+  bool reuse = false;
+  if (index.size() >= kIndexRecordSize) {
+    const char* p = index.data();
+    reuse = DecodeFixed64(p) == kIndexMagic &&
+            DecodeFixed64(p + 8) == options_.chunk_size &&
+            DecodeFixed64(p + 16) == num_slots_ &&
+            DecodeFixed32(p + 24) == crc32c::Value(p, 24);
+  }
+  if (reuse) {
+    uint64_t loaded = (index.size() / kIndexRecordSize) - 1;
+    for (uint64_t i = 0; i < loaded; i++) {
+      const char* p = index.data() + (i + 1) * kIndexRecordSize;
+      if (DecodeFixed32(p + 24) != crc32c::Value(p, 24)) {
+        // Never written or torn.
+        continue;
+      }
+      ChunkKey key{DecodeFixed64(p), DecodeFixed64(p + 8)};
+      uint32_t length = DecodeFixed32(p + 16);
+      if (length == 0 || length > options_.chunk_size ||
+          slot_of_key_.count(key) > 0) {
+        continue;
+      }
+      auto& slot = slots_[i];
+      slot.key = key;
+      slot.length = length;
+      slot.checksum = DecodeFixed32(p + 20);
+      slot.valid = true;
+      slot_of_key_[key] = i;
+      usage_ += length;
+    }
+    return IOStatus::OK();
+  }
+
+  char header[kIndexRecordSize] = {};
+  EncodeFixed64(header, kIndexMagic);
+  EncodeFixed64(header + 8, options_.chunk_size);
+  EncodeFixed64(header + 16, num_slots_);
+  EncodeFixed32(header + 24, crc32c::Value(header, 24));
+  // Drop the records of the previous geometry before writing the header, so
+  // that they are never read back under the new one.
+  std::string empty_records(num_slots_ * kIndexRecordSize, '\0');
+  s = index_file_->Write(kIndexRecordSize, empty_records, IOOptions(),
+                         nullptr);
+  if (s.ok()) {
+    s = index_file_->Sync(IOOptions(), nullptr);
+  }
+  if (s.ok()) {
+    s = index_file_->Write(0, Slice(header, sizeof(header)), IOOptions(),
+                           nullptr);
+  }
+  if (s.ok()) {
+    s = index_file_->Sync(IOOptions(), nullptr);
+  }
+  return s;
+}
+
+CloudChunkCache::ChunkKey CloudChunkCache::MakeKey(const Slice& file_id,
+                                                   uint64_t chunk_index) {
+  ChunkKey key;
+  Hash2x64(file_id.data(), file_id.size(), chunk_index, &key.hi, &key.lo);
+  return key;
+}
+
+IOStatus CloudChunkCache::WriteIndexRecord(uint64_t slot_idx,
+                                           const Slot& slot) {
+  char record[kIndexRecordSize] = {};
+  EncodeFixed64(record, slot.key.hi);
+  EncodeFixed64(record + 8, slot.key.lo);
+  EncodeFixed32(record + 16, slot.length);
+  EncodeFixed32(record + 20, slot.checksum);
+  EncodeFixed32(record + 24, crc32c::Value(record, 24));
+  return index_file_->Write((slot_idx + 1) * kIndexRecordSize,
+                            Slice(record, sizeof(record)), IOOptions(),
+                            nullptr);
+}
+
+uint64_t CloudChunkCache::FindVictim() {
+  // Two sweeps are enough to clear every reference bit.
+  for (uint64_t i = 0; i < 2 * num_slots_; i++) {
+    auto idx = clock_hand_;
+    clock_hand_ = (clock_hand_ + 1) % num_slots_;
+    auto& slot = slots_[idx];
+    if (slot.pins > 0) {
+      continue;
+    }
+    if (slot.valid && slot.referenced) {
+      slot.referenced = false;
+      continue;
+    }
+    return idx;
+  }
+  return num_slots_;
+}
+
+bool CloudChunkCache::Lookup(const Slice& file_id, uint64_t chunk_index,
+                             std::string* data) {
+  auto key = MakeKey(file_id, chunk_index);
+  uint64_t idx;
+  uint32_t length, checksum;
+  {
+    std::lock_guard<std::mutex> lk(mutex_);
+    auto it = slot_of_key_.find(key);
+    if (it == slot_of_key_.end()) {
+      misses_.fetch_add(1, std::memory_order_relaxed);
+      return false;
+    }
+    idx = it->second;
+    auto& slot = slots_[idx];
+    slot.referenced = true;
+    slot.pins++;
+    length = slot.length;
+    checksum = slot.checksum;
+  }
+
+  data->resize(length);
+  Slice result;
+  auto s = data_file_->Read(idx * options_.chunk_size, length, IOOptions(),
+                            &result, &(*data)[0], nullptr);
+  bool found = s.ok() && result.size() == length &&
+               crc32c::Value(result.data(), result.size()) == checksum;
+  if (found && result.data() != data->data()) {
+    data->assign(result.data(), result.size());
+  }
+
+  {
+    std::lock_guard<std::mutex> lk(mutex_);
+    auto& slot = slots_[idx];
+    slot.pins--;
+    if (!found && slot.valid && slot.key == key) {
+      // The chunk on disk is damaged, typically by a crash in the middle of
+      // an insert. Recycle the slot.
+      slot.valid = false;
+      slot_of_key_.erase(key);
+      usage_ -= slot.length;
+    }
+  }
+  if (found) {
+    hits_.fetch_add(1, std::memory_order_relaxed);
+  } else {
+    misses_.fetch_add(1, std::memory_order_relaxed);
+    data->clear();
+  }
+  return found;
+}
+
+void CloudChunkCache::Insert(const Slice& file_id, uint64_t chunk_index,
+                             const Slice& data) {
+  if (data.empty() || data.size() > options_.chunk_size) {
+    return;
+  }
+  auto key = MakeKey(file_id, chunk_index);
+  uint64_t idx;
+  {
+    std::lock_guard<std::mutex> lk(mutex_);
+    if (slot_of_key_.count(key) > 0) {
+      return;
+    }
+    idx = FindVictim();
+    if (idx == num_slots_) {
+      return;
+    }
+    auto& slot = slots_[idx];
+    if (slot.valid) {
+      slot_of_key_.erase(slot.key);
+      usage_ -= slot.length;
+      slot.valid = false;
+    }
+    slot.pins++;
+  }
+
+  // The old index record of the slot stays in place until the new chunk is
+  // written. Its checksum no longer matches, so it reads as a miss.
+  Slot filled;
+  filled.key = key;
+  filled.length = static_cast<uint32_t>(data.size());
+  filled.checksum = crc32c::Value(data.data(), data.size());
+  auto s = data_file_->Write(idx * options_.chunk_size, data, IOOptions(),
+                             nullptr);
+  if (s.ok()) {
+    s = WriteIndexRecord(idx, filled);
+  }
+
+  std::lock_guard<std::mutex> lk(mutex_);
+  auto& slot = slots_[idx];
+  slot.pins--;
+  // Someone else may have cached the same chunk meanwhile.
+  if (s.ok() && slot_of_key_.count(key) == 0) {
+    slot.key = filled.key;
+    slot.length = filled.length;
+    slot.checksum = filled.checksum;
+    slot.valid = true;
+    slot.referenced = true;
+    slot_of_key_[key] = idx;
+    usage_ += filled.length;
+  }
+}
+
+uint64_t CloudChunkCache::GetUsage() const {
+  std::lock_guard<std::mutex> lk(mutex_);
+  return usage_;
+}
+
+}  // namespace ROCKSDB_NAMESPACE
@@ -0,0 +1,227 @@
+//  Copyright (c) 2016-present, Rockset, Inc.  All rights reserved.
+
+#include "rocksdb/cloud/cloud_compaction_prefetcher.h"
+
+#include <algorithm>
+#include <cstring>
+#include <map>
+
+#include "rocksdb/cloud/cloud_storage_provider_impl.h"
+#include "rocksdb/env.h"
+#include "util/threadpool_imp.h"
+
+namespace ROCKSDB_NAMESPACE {
+
+struct CloudCompactionPrefetcher::Chunk {
+  enum State { kQueued, kReading, kDone };
+
+  Chunk(uint64_t _offset, uint64_t _len) : offset(_offset), len(_len) {}
+
+  const uint64_t offset;
+  const uint64_t len;
+  State state = kQueued;
+  // Set once the chunk is no longer part of its file.
+  bool dropped = false;
+  std::string data;
+  IOStatus status;
+};
+
+struct CloudCompactionPrefetcher::File {
+  std::unique_ptr<CloudStorageReadableFileImpl> reader;
+  uint64_t size = 0;
+  // Number of the compactions reading the file.
+  int refs = 1;
+  // Set once the downloads of the file started.
+  bool started = false;
+  // The inputs of the first compaction that added the file.
+  std::shared_ptr<FileGroup> group;
+  std::map<uint64_t, std::shared_ptr<Chunk>> chunks;
+};
+
+CloudCompactionPrefetcher::CloudCompactionPrefetcher(
+    const CloudCompactionPrefetcherOptions& options)
+    : options_(options), pool_(new ThreadPoolImpl()) {
+  pool_->SetBackgroundThreads(std::max(1, options_.threads));
+}
+
+CloudCompactionPrefetcher::~CloudCompactionPrefetcher() {
+  {
+    std::lock_guard<std::mutex> lk(mutex_);
+    queue_.clear();
+  }
+  pool_->JoinAllThreads();
+}
+
+void CloudCompactionPrefetcher::AddFiles(
+    std::vector<std::unique_ptr<CloudStorageReadableFileImpl>> readers) {
+  auto group = std::make_shared<FileGroup>();
+  std::lock_guard<std::mutex> lk(mutex_);
+  for (auto& reader : readers) {
+    auto key = reader->bucket_ + "/" + reader->fname_;
+    auto it = files_.find(key);
+    if (it != files_.end()) {
+      it->second->refs++;
+      continue;
+    }
+    // The reader downloads for the prefetcher, which must not own itself.
+    reader->compaction_prefetcher_.reset();
+    auto file = std::make_shared<File>();
+    file->size = reader->file_size_;
+    file->reader = std::move(reader);
+    file->group = group;
+    group->push_back(file);
+    files_.emplace(std::move(key), std::move(file));
+  }
+}
+
+void CloudCompactionPrefetcher::RemoveFile(const std::string& bucket,
+                                           const std::string& object_path) {
+  std::lock_guard<std::mutex> lk(mutex_);
+  auto it = files_.find(bucket + "/" + object_path);
+  if (it == files_.end() || --it->second->refs > 0) {
+    return;
+  }
+  auto file = it->second;
+  files_.erase(it);
+  while (!file->chunks.empty()) {
+    DropChunk(file.get(), file->chunks.begin()->first);
+  }
+  StartDownloads();
+}
+
+uint64_t CloudCompactionPrefetcher::Read(const std::string& bucket,
+                                         const std::string& object_path,
+                                         uint64_t offset, size_t n,
+                                         char* scratch) {
+  std::unique_lock<std::mutex> lk(mutex_);
+  auto it = files_.find(bucket + "/" + object_path);
+  if (it == files_.end()) {
+    return 0;
+  }
+  auto file = it->second;
+  if (!file->started) {
+    // The first read of the compaction.
+    StartGroup(*file->group);
+    StartDownloads();
+  }
+  uint64_t copied = 0;
+  while (copied < n && offset + copied < file->size) {
+    uint64_t pos = offset + copied;
+    uint64_t index = pos / options_.chunk_size;
+    auto c = file->chunks.find(index);
+    if (c == file->chunks.end() || c->second->state == Chunk::kQueued) {
+      // Not downloaded ahead, like at the start of a subcompaction: the
+      // caller reads it, and the chunks that follow are downloaded.
+      if (c != file->chunks.end()) {
+        DropChunk(file.get(), index);
+      }
+      WantChunks(file, index + 1);
+      break;
+    }
+    auto chunk = c->second;
+    cv_.wait(lk, [&] { return chunk->state == Chunk::kDone; });
+    uint64_t chunk_pos = pos - chunk->offset;
+    if (!chunk->status.ok() || chunk_pos >= chunk->data.size()) {
+      if (!chunk->dropped) {
+        DropChunk(file.get(), index);
+      }
+      WantChunks(file, index + 1);
+      break;
+    }
+    size_t len = static_cast<size_t>(
+        std::min<uint64_t>(chunk->data.size() - chunk_pos, n - copied));
+    memcpy(scratch + copied, chunk->data.data() + chunk_pos, len);
+    copied += len;
+    if (chunk_pos + len == chunk->data.size()) {
+      // The compaction is done with the chunk, move its window on.
+      if (!chunk->dropped) {
+        DropChunk(file.get(), index);
+      }
+      WantChunks(file, index + 1);
+    }
+  }
+  StartDownloads();
+  served_bytes_.fetch_add(copied, std::memory_order_relaxed);
+  return copied;
+}
+
+void CloudCompactionPrefetcher::StartGroup(const FileGroup& group) {
+  for (const auto& f : group) {
+    auto file = f.lock();
+    if (file && !file->started) {
+      file->started = true;
+      WantChunks(file, 0);
+    }
+  }
+}
+
+void CloudCompactionPrefetcher::WantChunks(const std::shared_ptr<File>& file,
+                                           uint64_t index) {
+  uint64_t end = index + std::max(1, options_.chunks_per_file);
+  for (; index < end; ++index) {
+    uint64_t offset = index * options_.chunk_size;
+    if (offset >= file->size) {
+      break;
+    }
+    if (file->chunks.count(index) > 0) {
+      continue;
+    }
+    auto chunk = std::make_shared<Chunk>(
+        offset, std::min(options_.chunk_size, file->size - offset));
+    file->chunks.emplace(index, chunk);
+    queue_.emplace_back(file, std::move(chunk));
+  }
+}
+
+void CloudCompactionPrefetcher::DropChunk(File* file, uint64_t index) {
+  auto it = file->chunks.find(index);
+  auto& chunk = it->second;
+  chunk->dropped = true;
+  if (chunk->state == Chunk::kDone) {
+    buffered_bytes_ -= chunk->len;
+  }
+  // A chunk being downloaded releases its space once it is.
+  file->chunks.erase(it);
+}
+
+void CloudCompactionPrefetcher::StartDownloads() {
+  while (!queue_.empty()) {
+    auto file = queue_.front().first;
+    auto chunk = queue_.front().second;
+    if (chunk->dropped) {
+      queue_.pop_front();
+      continue;
+    }
+    // A chunk larger than the buffer is downloaded alone.
+    if (buffered_bytes_ > 0 &&
+        buffered_bytes_ + chunk->len > options_.buffer_bytes) {
+      break;
+    }
+    queue_.pop_front();
+    chunk->state = Chunk::kReading;
+    buffered_bytes_ += chunk->len;
+    pool_->SubmitJob([this, file, chunk]() {
+      std::string data(static_cast<size_t>(chunk->len), '\0');
+      uint64_t bytes_read = 0;
+      IOOptions opts;
+      opts.rate_limiter_priority = Env::IO_LOW;
+      opts.io_activity = Env::IOActivity::kCompaction;
+      auto s = file->reader->CloudRead(chunk->offset, chunk->len, opts,
+                                       &data[0], &bytes_read, nullptr);
+      data.resize(static_cast<size_t>(bytes_read));
+      prefetched_bytes_.fetch_add(bytes_read, std::memory_order_relaxed);
+
+      std::lock_guard<std::mutex> lk(mutex_);
+      chunk->data = std::move(data);
+      chunk->status = s;
+      chunk->state = Chunk::kDone;
+      if (chunk->dropped) {
+        buffered_bytes_ -= chunk->len;
+        StartDownloads();
+      }
+      cv_.notify_all();
+    });
+  }
+}
+
+}  // namespace ROCKSDB_NAMESPACE
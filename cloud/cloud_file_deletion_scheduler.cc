@@ -9,9 +9,10 @@ namespace ROCKSDB_NAMESPACE {
 
 std::shared_ptr<CloudFileDeletionScheduler> CloudFileDeletionScheduler::Create(
      const std::shared_ptr<CloudScheduler>& scheduler,
-     std::chrono::seconds file_deletion_delay) {
-  return std::make_shared<CloudFileDeletionScheduler>(PrivateTag(), scheduler,
-                                                      file_deletion_delay);
+     std::chrono::seconds file_deletion_delay,
+     BatchDeletionRunnable batch_runnable) {
+  return std::make_shared<CloudFileDeletionScheduler>(
+      PrivateTag(), scheduler, file_deletion_delay, std::move(batch_runnable));
 }
 
 CloudFileDeletionScheduler::~CloudFileDeletionScheduler() {
@@ -24,25 +25,56 @@ CloudFileDeletionScheduler::~CloudFileDeletionScheduler() {
 }
 
 void CloudFileDeletionScheduler::UnscheduleFileDeletion(const std::string& filename) {
-  std::lock_guard<std::mutex> lk(files_to_delete_mutex_);
-  auto itr = files_to_delete_.find(filename);
-  if (itr != files_to_delete_.end()) {
-    scheduler_->CancelJob(itr->second);
+  long handle;
+  {
+    std::lock_guard<std::mutex> lk(files_to_delete_mutex_);
+    auto itr = files_to_delete_.find(filename);
+    if (itr == files_to_delete_.end()) {
+      return;
+    }
+    handle = itr->second.handle;
     files_to_delete_.erase(itr);
   }
+  // Not under the lock: a running deletion waits for it, and finds the file
+  // no longer due.
+  scheduler_->CancelJob(handle);
 }
 
 rocksdb::IOStatus CloudFileDeletionScheduler::ScheduleFileDeletion(
     const std::string& fname, FileDeletionRunnable runnable) {
+  FileDeletion deletion;
+  deletion.runnable = std::move(runnable);
+  return DoScheduleFileDeletion(fname, std::move(deletion));
+}
+
+rocksdb::IOStatus CloudFileDeletionScheduler::ScheduleObjectDeletion(
+    const std::string& fname, std::string object_path) {
+  if (!batch_runnable_) {
+    return IOStatus::InvalidArgument(
+        "Object deletions require a batch deletion runnable", fname);
+  }
+  FileDeletion deletion;
+  deletion.object_path = std::move(object_path);
+  return DoScheduleFileDeletion(fname, std::move(deletion));
+}
+
+bool CloudFileDeletionScheduler::IsFileDeletionScheduled(
+    const std::string& filename) const {
+  std::lock_guard<std::mutex> lk(files_to_delete_mutex_);
+  return files_to_delete_.find(filename) != files_to_delete_.end();
+}
+
+rocksdb::IOStatus CloudFileDeletionScheduler::DoScheduleFileDeletion(
+    const std::string& fname, FileDeletion deletion) {
   auto wp = this->weak_from_this();
-  auto doDeleteFile = [wp = std::move(wp), fname, runnable = std::move(runnable)](void*) {
+  auto doDeleteFile = [wp = std::move(wp), fname](void*) {
     TEST_SYNC_POINT(
         "CloudFileDeletionScheduler::ScheduleFileDeletion:BeforeFileDeletion");
     auto sp = wp.lock();
     bool file_deleted = false;
     if (sp) {
       file_deleted = true;
-      sp->DoDeleteFile(std::move(fname), std::move(runnable));
+      sp->DoDeleteFile(fname);
     }
     TEST_SYNC_POINT_CALLBACK(
         "CloudFileDeletionScheduler::ScheduleFileDeletion:AfterFileDeletion",
@@ -57,15 +89,19 @@ rocksdb::IOStatus CloudFileDeletionScheduler::ScheduleFileDeletion(
       return IOStatus::OK();
     }
 
-    auto handle = scheduler_->ScheduleJob(file_deletion_delay_,
-                                          std::move(doDeleteFile), nullptr);
-    files_to_delete_.emplace(fname, std::move(handle));
+    deletion.deadline =
+        std::chrono::steady_clock::now() + file_deletion_delay_;
+    deletion.handle = scheduler_->ScheduleJob(
+        file_deletion_delay_, std::move(doDeleteFile), nullptr,
+        CloudScheduler::JobClass::kFileDeletion);
+    files_to_delete_.emplace(fname, std::move(deletion));
   }
   return IOStatus::OK();
 }
 
-void CloudFileDeletionScheduler::DoDeleteFile(const std::string& fname,
-                                              FileDeletionRunnable runnable) {
+void CloudFileDeletionScheduler::DoDeleteFile(const std::string& fname) {
+  FileDeletionRunnable runnable;
+  std::vector<std::string> object_paths;
   {
     std::lock_guard<std::mutex> lk(files_to_delete_mutex_);
     auto itr = files_to_delete_.find(fname);
@@ -73,10 +109,33 @@ void CloudFileDeletionScheduler::DoDeleteFile(const std::string& fname,
       // File was removed from files_to_delete_, do not delete!
       return;
     }
-    files_to_delete_.erase(itr);
+    if (itr->second.runnable) {
+      runnable = std::move(itr->second.runnable);
+      files_to_delete_.erase(itr);
+    } else {
+      // Coalesce all the object deletions that are due into one batch. Their
+      // own jobs are cancelled; this job is running, so it is not the one
+      // `CancelJob` would wait for.
+      object_paths.push_back(std::move(itr->second.object_path));
+      files_to_delete_.erase(itr);
+      auto now = std::chrono::steady_clock::now();
+      for (auto it = files_to_delete_.begin(); it != files_to_delete_.end();) {
+        if (!it->second.runnable && it->second.deadline <= now) {
+          scheduler_->CancelJob(it->second.handle);
+          object_paths.push_back(std::move(it->second.object_path));
+          it = files_to_delete_.erase(it);
+        } else {
+          ++it;
+        }
+      }
+    }
   }
 
-  runnable();
+  if (runnable) {
+    runnable();
+  } else {
+    batch_runnable_(object_paths);
+  }
 }
 
 #ifndef NDEBUG
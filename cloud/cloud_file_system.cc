@@ -7,6 +7,7 @@
 #else
 #include <windows.h>
 #endif
+#include <cinttypes>
 #include <unordered_map>
 
 #include "cloud/aws/aws_file_system.h"
@@ -19,6 +20,7 @@
 #include "options/options_helper.h"
 #include "port/likely.h"
 #include "rocksdb/cloud/cloud_file_system_impl.h"
+#include "rocksdb/cloud/cloud_chunk_cache.h"
 #include "rocksdb/cloud/cloud_log_controller.h"
 #include "rocksdb/cloud/cloud_storage_provider_impl.h"
 #include "rocksdb/db.h"
@@ -54,6 +56,12 @@ void CloudFileSystemOptions::Dump(Logger* log) const {
          keep_local_sst_files);
   Header(log, "               COptions.keep_local_log_files: %d",
          keep_local_log_files);
+  Header(log, "             COptions.replay_log_from_stream: %d",
+         replay_log_from_stream);
+  Header(log, "                    COptions.log_compression: %d",
+         static_cast<int>(log_compression));
+  Header(log, "     COptions.log_compression_max_dict_bytes: %" PRIu32,
+         log_compression_max_dict_bytes);
   Header(log, "             COptions.server_side_encryption: %d",
          server_side_encryption);
   Header(log, "                  COptions.encryption_key_id: %s",
@@ -62,6 +70,8 @@ void CloudFileSystemOptions::Dump(Logger* log) const {
          create_bucket_if_missing ? "true" : "false");
   Header(log, "                         COptions.run_purger: %s",
          run_purger ? "true" : "false");
+  Header(log, "COptions.purger_full_listing_periodicity_millis: %" PRIu64,
+         purger_full_listing_periodicity_millis);
   Header(log, "           COptions.resync_on_open: %s",
          resync_on_open ? "true" : "false");
   Header(log, "             COptions.skip_dbid_verification: %s",
@@ -80,6 +90,80 @@ void CloudFileSystemOptions::Dump(Logger* log) const {
          new_cookie_on_open.c_str());
   Header(log, "COptions.delete_cloud_invisible_files_on_open: %d",
          delete_cloud_invisible_files_on_open);
+  Header(log, "     COptions.multi_read_coalesce_gap_bytes: %" PRIu64,
+         multi_read_coalesce_gap_bytes);
+  Header(log, "        COptions.multi_read_max_parallelism: %" ROCKSDB_PRIszt,
+         multi_read_max_parallelism);
+  Header(log, "                COptions.async_read_threads: %d",
+         async_read_threads);
+  Header(log, "              COptions.share_inflight_reads: %d",
+         share_inflight_reads);
+  Header(log, "        COptions.multipart_upload_part_size: %" PRIu64,
+         multipart_upload_part_size);
+  Header(log, "          COptions.multipart_upload_threads: %d",
+         multipart_upload_threads);
+  Header(log, "       COptions.parallel_download_part_size: %" PRIu64,
+         parallel_download_part_size);
+  Header(log, "         COptions.parallel_download_threads: %d",
+         parallel_download_threads);
+  Header(log, "                 COptions.defer_sst_uploads: %d",
+         defer_sst_uploads);
+  Header(log, "                COptions.sst_upload_threads: %d",
+         sst_upload_threads);
+  Header(log, "            COptions.max_concurrent_uploads: %d",
+         max_concurrent_uploads);
+  Header(log, "              COptions.sst_upload_checksums: %d",
+         sst_upload_checksums);
+  Header(log, "            COptions.manifest_delta_uploads: %d",
+         manifest_delta_uploads);
+  Header(log, "               COptions.manifest_max_deltas: %d",
+         manifest_max_deltas);
+  Header(log, "                    COptions.express_bucket: %s",
+         express_bucket.c_str());
+  Header(log, "        COptions.prefetch_sst_files_on_open: %d",
+         prefetch_sst_files_on_open);
+  Header(log, "              COptions.prefetch_sst_threads: %d",
+         prefetch_sst_threads);
+  Header(log, "                     COptions.parallel_open: %d",
+         parallel_open);
+  Header(log, "               COptions.lazy_open_sst_files: %d",
+         lazy_open_sst_files);
+  Header(log, "            COptions.local_sst_budget_bytes: %" PRIu64,
+         local_sst_budget_bytes);
+  Header(log, "                   COptions.zero_copy_clone: %d",
+         zero_copy_clone);
+  Header(log, "     COptions.s3_crt_throughput_target_gbps: %.1f",
+         s3_crt_throughput_target_gbps);
+  Header(log, "                  COptions.s3_crt_part_size: %" PRIu64,
+         s3_crt_part_size);
+  Header(log, "                 COptions.sst_object_shards: %" PRIu32,
+         sst_object_shards);
+  Header(log, "          COptions.list_objects_parallelism: %" PRIu32,
+         list_objects_parallelism);
+  Header(log, "     COptions.object_metadata_cache_entries: %" PRIu64,
+         object_metadata_cache_entries);
+  Header(log, "              COptions.chunk_cache_capacity: %" PRIu64,
+         chunk_cache ? chunk_cache->GetCapacity() : 0);
+  Header(log, "                        COptions.statistics: %p",
+         statistics.get());
+  Header(log, "                COptions.cloud_rate_limiter: %p",
+         cloud_rate_limiter.get());
+  Header(log, "                       COptions.read_hedger: %p",
+         read_hedger.get());
+  Header(log, "             COptions.compaction_prefetcher: %p",
+         compaction_prefetcher.get());
+  Header(log, "               COptions.local_sst_max_level: %d",
+         local_sst_max_level);
+  Header(log, "             COptions.local_sst_temperature: %d",
+         static_cast<int>(local_sst_temperature));
+  Header(log, "                  COptions.dump_block_cache: %d",
+         dump_block_cache);
+  Header(log, "      COptions.block_cache_dump_period_secs: %" PRIu64,
+         block_cache_dump_period_secs);
+  Header(log, "           COptions.block_cache_load_target: %p",
+         block_cache_load_target.get());
+  Header(log, "         COptions.stats_history_period_secs: %" PRIu64,
+         stats_history_period_secs);
   if (cloud_file_deletion_delay) {
     Header(log, "          COptions.cloud_file_deletion_delay: %ld",
            cloud_file_deletion_delay->count());
@@ -308,6 +392,15 @@ const std::unordered_map<std::string, OptionTypeInfo>
         {"keep_local_log_files",
          {offset_of(&CloudFileSystemOptions::keep_local_log_files),
           OptionType::kBoolean}},
+        {"replay_log_from_stream",
+         {offset_of(&CloudFileSystemOptions::replay_log_from_stream),
+          OptionType::kBoolean}},
+        {"log_compression",
+         {offset_of(&CloudFileSystemOptions::log_compression),
+          OptionType::kCompressionType}},
+        {"log_compression_max_dict_bytes",
+         {offset_of(&CloudFileSystemOptions::log_compression_max_dict_bytes),
+          OptionType::kUInt32T}},
         {"create_bucket_if_missing",
          {offset_of(&CloudFileSystemOptions::create_bucket_if_missing),
           OptionType::kBoolean}},
@@ -333,6 +426,103 @@ const std::unordered_map<std::string, OptionTypeInfo>
         {"purger_periodicity_ms",
          {offset_of(&CloudFileSystemOptions::purger_periodicity_millis),
           OptionType::kUInt64T}},
+        {"purger_full_listing_periodicity_ms",
+         {offset_of(
+              &CloudFileSystemOptions::purger_full_listing_periodicity_millis),
+          OptionType::kUInt64T}},
+        {"multi_read_coalesce_gap_bytes",
+         {offset_of(&CloudFileSystemOptions::multi_read_coalesce_gap_bytes),
+          OptionType::kUInt64T}},
+        {"multi_read_max_parallelism",
+         {offset_of(&CloudFileSystemOptions::multi_read_max_parallelism),
+          OptionType::kSizeT}},
+        {"async_read_threads",
+         {offset_of(&CloudFileSystemOptions::async_read_threads),
+          OptionType::kInt}},
+        {"share_inflight_reads",
+         {offset_of(&CloudFileSystemOptions::share_inflight_reads),
+          OptionType::kBoolean}},
+        {"multipart_upload_part_size",
+         {offset_of(&CloudFileSystemOptions::multipart_upload_part_size),
+          OptionType::kUInt64T}},
+        {"multipart_upload_threads",
+         {offset_of(&CloudFileSystemOptions::multipart_upload_threads),
+          OptionType::kInt}},
+        {"parallel_download_part_size",
+         {offset_of(&CloudFileSystemOptions::parallel_download_part_size),
+          OptionType::kUInt64T}},
+        {"parallel_download_threads",
+         {offset_of(&CloudFileSystemOptions::parallel_download_threads),
+          OptionType::kInt}},
+        {"defer_sst_uploads",
+         {offset_of(&CloudFileSystemOptions::defer_sst_uploads),
+          OptionType::kBoolean}},
+        {"sst_upload_threads",
+         {offset_of(&CloudFileSystemOptions::sst_upload_threads),
+          OptionType::kInt}},
+        {"max_concurrent_uploads",
+         {offset_of(&CloudFileSystemOptions::max_concurrent_uploads),
+          OptionType::kInt}},
+        {"sst_upload_checksums",
+         {offset_of(&CloudFileSystemOptions::sst_upload_checksums),
+          OptionType::kBoolean}},
+        {"manifest_delta_uploads",
+         {offset_of(&CloudFileSystemOptions::manifest_delta_uploads),
+          OptionType::kBoolean}},
+        {"manifest_max_deltas",
+         {offset_of(&CloudFileSystemOptions::manifest_max_deltas),
+          OptionType::kInt}},
+        {"express_bucket",
+         {offset_of(&CloudFileSystemOptions::express_bucket),
+          OptionType::kString}},
+        {"prefetch_sst_files_on_open",
+         {offset_of(&CloudFileSystemOptions::prefetch_sst_files_on_open),
+          OptionType::kBoolean}},
+        {"prefetch_sst_threads",
+         {offset_of(&CloudFileSystemOptions::prefetch_sst_threads),
+          OptionType::kInt}},
+        {"parallel_open",
+         {offset_of(&CloudFileSystemOptions::parallel_open),
+          OptionType::kBoolean}},
+        {"lazy_open_sst_files",
+         {offset_of(&CloudFileSystemOptions::lazy_open_sst_files),
+          OptionType::kBoolean}},
+        {"local_sst_budget_bytes",
+         {offset_of(&CloudFileSystemOptions::local_sst_budget_bytes),
+          OptionType::kUInt64T}},
+        {"zero_copy_clone",
+         {offset_of(&CloudFileSystemOptions::zero_copy_clone),
+          OptionType::kBoolean}},
+        {"s3_crt_throughput_target_gbps",
+         {offset_of(&CloudFileSystemOptions::s3_crt_throughput_target_gbps),
+          OptionType::kDouble}},
+        {"s3_crt_part_size",
+         {offset_of(&CloudFileSystemOptions::s3_crt_part_size),
+          OptionType::kUInt64T}},
+        {"sst_object_shards",
+         {offset_of(&CloudFileSystemOptions::sst_object_shards),
+          OptionType::kUInt32T}},
+        {"list_objects_parallelism",
+         {offset_of(&CloudFileSystemOptions::list_objects_parallelism),
+          OptionType::kUInt32T}},
+        {"object_metadata_cache_entries",
+         {offset_of(&CloudFileSystemOptions::object_metadata_cache_entries),
+          OptionType::kUInt64T}},
+        {"local_sst_max_level",
+         {offset_of(&CloudFileSystemOptions::local_sst_max_level),
+          OptionType::kInt}},
+        {"local_sst_temperature",
+         {offset_of(&CloudFileSystemOptions::local_sst_temperature),
+          OptionType::kTemperature}},
+        {"dump_block_cache",
+         {offset_of(&CloudFileSystemOptions::dump_block_cache),
+          OptionType::kBoolean}},
+        {"block_cache_dump_period_secs",
+         {offset_of(&CloudFileSystemOptions::block_cache_dump_period_secs),
+          OptionType::kUInt64T}},
+        {"stats_history_period_secs",
+         {offset_of(&CloudFileSystemOptions::stats_history_period_secs),
+          OptionType::kUInt64T}},
 
         {"provider",
          {offset_of(&CloudFileSystemOptions::storage_provider),
@@ -464,6 +654,19 @@ int DoRegisterCloudObjects(ObjectLibrary& library, const std::string& arg) {
 
   count += CloudFileSystemImpl::RegisterAwsObjects(library, arg);
 
+  // Register the storage providers that do not depend on a cloud vendor
+  library.AddFactory<CloudStorageProvider>(
+      CloudStorageProviderImpl::kSimulated(),
+      [](const std::string& /*uri*/,
+         std::unique_ptr<CloudStorageProvider>* guard, std::string* errmsg) {
+        Status s = CloudStorageProviderImpl::CreateSimulatedProvider(guard);
+        if (!s.ok()) {
+          *errmsg = s.ToString();
+        }
+        return guard->get();
+      });
+  count++;
+
   // Register the Cloud Log Controllers
 
   library.AddFactory<CloudLogController>(
@@ -3,20 +3,25 @@
 
 #include "rocksdb/cloud/cloud_file_system_impl.h"
 
+#include <algorithm>
 #include <cinttypes>
 
 #include "cloud/cloud_log_controller_impl.h"
 #include "cloud/cloud_manifest.h"
 #include "cloud/cloud_scheduler.h"
+#include "cloud/cloud_upload_scheduler.h"
 #include "cloud/filename.h"
 #include "cloud/manifest_reader.h"
 #include "file/file_util.h"
 #include "file/filename.h"
 #include "file/writable_file_writer.h"
 #include "port/port_posix.h"
+#include "rocksdb/cloud/cloud_compaction_prefetcher.h"
 #include "rocksdb/cloud/cloud_file_deletion_scheduler.h"
 #include "rocksdb/cloud/cloud_log_controller.h"
+#include "rocksdb/cloud/cloud_rate_limiter.h"
 #include "rocksdb/cloud/cloud_storage_provider.h"
+#include "rocksdb/cloud/cloud_storage_provider_impl.h"
 #include "rocksdb/db.h"
 #include "rocksdb/env.h"
 #include "rocksdb/io_status.h"
@@ -24,6 +29,8 @@
 #include "rocksdb/status.h"
 #include "rocksdb/utilities/options_type.h"
 #include "test_util/sync_point.h"
+#include "util/crc32c.h"
+#include "util/threadpool_imp.h"
 #include "util/xxhash.h"
 
 namespace ROCKSDB_NAMESPACE {
@@ -37,13 +44,45 @@ CloudFileSystemImpl::CloudFileSystemImpl(
       purger_is_running_(true) {
   RegisterOptions(&cloud_fs_options,
                   &CloudFileSystemOptions::cloud_fs_option_type_info);
-  if (opts.cloud_file_deletion_delay) {
-    cloud_file_deletion_scheduler_ = CloudFileDeletionScheduler::Create(
-        CloudScheduler::Get(), *opts.cloud_file_deletion_delay);
-  }
 }
 
 CloudFileSystemImpl::~CloudFileSystemImpl() {
+  if (cloud_manifest_fetch_.valid()) {
+    cloud_manifest_fetch_.wait();
+  }
+  if (upload_pool_ || upload_scheduler_) {
+    WaitForAllUploadsToDest().PermitUncheckedError();
+  }
+  if (upload_pool_) {
+    upload_pool_->JoinAllThreads();
+  }
+  upload_scheduler_.reset();
+  {
+    // The queued copies of the express bucket are drained first.
+    std::lock_guard<std::mutex> lk(express_mutex_);
+    express_stop_ = true;
+    express_cv_.notify_all();
+  }
+  if (express_thread_.joinable()) {
+    express_thread_.join();
+  }
+  if (prefetch_pool_) {
+    {
+      // Drop the downloads that did not start.
+      std::lock_guard<std::mutex> lk(prefetch_mutex_);
+      prefetches_.clear();
+    }
+    prefetch_pool_->JoinAllThreads();
+  }
+  {
+    std::lock_guard<std::mutex> lk(compaction_inputs_mutex_);
+    for (const auto& job : compaction_inputs_) {
+      for (const auto& f : job.second) {
+        cloud_fs_options.compaction_prefetcher->RemoveFile(f.first, f.second);
+      }
+    }
+    compaction_inputs_.clear();
+  }
   if (cloud_fs_options.cloud_log_controller) {
     cloud_fs_options.cloud_log_controller->StopTailingStream();
   }
@@ -65,19 +104,89 @@ IOStatus CloudFileSystemImpl::ExistsCloudObject(const std::string& fname) {
   return st;
 }
 
-IOStatus CloudFileSystemImpl::GetCloudObject(const std::string& fname) {
+IOStatus CloudFileSystemImpl::GetCloudObject(const std::string& fname,
+                                             Env::IOPriority pri) {
+  auto* limiter = cloud_fs_options.cloud_rate_limiter.get();
+  auto download = [&](const std::string& bucket, const std::string& object) {
+    if (limiter == nullptr) {
+      return FetchCloudObject(bucket, object, fname);
+    }
+    // The size of the object is not known upfront, its bytes are charged
+    // once it is downloaded.
+    limiter->Request(CloudRateLimiter::Direction::kDownload, 0, pri);
+    auto s = FetchCloudObject(bucket, object, fname);
+    uint64_t size = 0;
+    if (s.ok() &&
+        base_fs_->GetFileSize(fname, IOOptions(), &size, nullptr).ok()) {
+      limiter->ChargeBytes(CloudRateLimiter::Direction::kDownload, size, pri);
+    }
+    return s;
+  };
+
   auto st = IOStatus::NotFound();
-  if (HasDestBucket()) {
-    st = GetStorageProvider()->GetCloudObject(GetDestBucketName(),
-                                              destname(fname), fname);
+  const bool manifest = IsManifestFile(fname);
+  const bool sst = GetFileType(fname) == RocksDBFileType::kSstFile;
+  const bool src_first = sst && IsEpochInSrc(fname);
+  auto from_dest = [&]() {
+    st = download(GetDestBucketName(), destname(fname));
+    if (st.ok() && manifest) {
+      st = FetchManifestDeltas(GetDestBucketName(), destname(fname), fname);
+    }
+    if (st.ok() && sst) {
+      SetEpochInSrc(fname, false);
+    }
+  };
+  if (HasDestBucket() && !src_first) {
+    from_dest();
+  }
+  if (IsZeroCopyClone() && sst) {
+    // The SST files of the source are read from the src bucket in place.
+    return st;
   }
   if (st.IsNotFound() && HasSrcBucket() && !SrcMatchesDest()) {
-    st = GetStorageProvider()->GetCloudObject(GetSrcBucketName(),
-                                              srcname(fname), fname);
+    st = download(GetSrcBucketName(), srcname(fname));
+    if (st.ok() && manifest) {
+      st = FetchManifestDeltas(GetSrcBucketName(), srcname(fname), fname);
+    }
+    if (st.ok() && sst) {
+      SetEpochInSrc(fname, true);
+    } else if (st.IsNotFound() && src_first && HasDestBucket()) {
+      from_dest();
+    }
+  }
+  if (st.ok() && sst) {
+    TouchLocalSstFile(fname, true /* added */);
   }
   return st;
 }
 
+bool CloudFileSystemImpl::IsEpochInSrc(const std::string& fname) {
+  if (!HasSrcBucket() || !HasDestBucket() || SrcMatchesDest()) {
+    return false;
+  }
+  const auto epoch = GetEpochOfFile(fname);
+  if (epoch.empty() ||
+      (cloud_manifest_ && epoch == cloud_manifest_->GetCurrentEpoch())) {
+    // The files of the current epoch are written to the dest bucket.
+    return false;
+  }
+  std::lock_guard<std::mutex> lk(epoch_in_src_mutex_);
+  auto it = epoch_in_src_.find(epoch);
+  return it != epoch_in_src_.end() && it->second;
+}
+
+void CloudFileSystemImpl::SetEpochInSrc(const std::string& fname,
+                                        bool in_src) {
+  if (!HasSrcBucket() || !HasDestBucket() || SrcMatchesDest()) {
+    return;
+  }
+  const auto epoch = GetEpochOfFile(fname);
+  if (!epoch.empty()) {
+    std::lock_guard<std::mutex> lk(epoch_in_src_mutex_);
+    epoch_in_src_[epoch] = in_src;
+  }
+}
+
 IOStatus CloudFileSystemImpl::GetCloudObjectSize(const std::string& fname,
                                                  uint64_t* remote_size) {
   auto st = IOStatus::NotFound();
@@ -109,10 +218,15 @@ IOStatus CloudFileSystemImpl::GetCloudObjectModificationTime(
 IOStatus CloudFileSystemImpl::ListCloudObjects(
     const std::string& path, std::vector<std::string>* result) {
   IOStatus st;
+  auto boundaries = GetListBoundaries();
+  auto add_child = [result](const std::string& name) {
+    result->push_back(RemoveSstObjectShard(name));
+    return true;
+  };
   // Fetch the list of children from both cloud buckets
   if (HasSrcBucket()) {
-    st = GetStorageProvider()->ListCloudObjects(GetSrcBucketName(),
-                                                GetSrcObjectPath(), result);
+    st = GetStorageProvider()->VisitCloudObjects(
+        GetSrcBucketName(), GetSrcObjectPath(), boundaries, add_child);
     if (!st.ok()) {
       Log(InfoLogLevel::ERROR_LEVEL, info_log_,
           "[%s] GetChildren src bucket %s %s error from %s %s", Name(),
@@ -122,8 +236,8 @@ IOStatus CloudFileSystemImpl::ListCloudObjects(
     }
   }
   if (HasDestBucket() && !SrcMatchesDest()) {
-    st = GetStorageProvider()->ListCloudObjects(GetDestBucketName(),
-                                                GetDestObjectPath(), result);
+    st = GetStorageProvider()->VisitCloudObjects(
+        GetDestBucketName(), GetDestObjectPath(), boundaries, add_child);
     if (!st.ok()) {
       Log(InfoLogLevel::ERROR_LEVEL, info_log_,
           "[%s] GetChildren dest bucket %s %s error from %s %s", Name(),
@@ -134,13 +248,52 @@ IOStatus CloudFileSystemImpl::ListCloudObjects(
   return st;
 }
 
+std::vector<std::string> CloudFileSystemImpl::GetListBoundaries() const {
+  std::vector<std::string> boundaries;
+  const uint32_t partitions = cloud_fs_options.list_objects_parallelism;
+  if (partitions <= 1 || !cloud_manifest_) {
+    return boundaries;
+  }
+  const uint32_t shards = cloud_manifest_->GetSstObjectShards();
+  if (shards > 0) {
+    // Hashed sub-prefixes hold about the same number of objects each
+    for (uint32_t i = 1; i < partitions; ++i) {
+      auto shard = static_cast<uint32_t>(uint64_t{shards} * i / partitions);
+      auto name = SstObjectShardName(shard, shards);
+      if (boundaries.empty() || boundaries.back() < name) {
+        boundaries.push_back(std::move(name));
+      }
+    }
+  } else {
+    // Without shards, split the file numbers up to the start of the current
+    // epoch. Files created since then go to the last partition.
+    const uint64_t max_file_number =
+        cloud_manifest_->GetCurrentEpochStartFileNumber();
+    for (uint32_t i = 1; i < partitions; ++i) {
+      auto name = MakeTableFileName(max_file_number * i / partitions);
+      if (boundaries.empty() || boundaries.back() < name) {
+        boundaries.push_back(std::move(name));
+      }
+    }
+  }
+  return boundaries;
+}
+
 IOStatus CloudFileSystemImpl::NewCloudReadableFile(
     const std::string& fname, const FileOptions& options,
     std::unique_ptr<CloudStorageReadableFile>* result, IODebugContext* dbg) {
   auto st = IOStatus::NotFound();
-  if (HasDestBucket()) {  // read from destination
+  const bool sst = GetFileType(fname) == RocksDBFileType::kSstFile;
+  const bool src_first = sst && IsEpochInSrc(fname);
+  auto from_dest = [&]() {
     st = GetStorageProvider()->NewCloudReadableFile(
         GetDestBucketName(), destname(fname), options, result, dbg);
+    if (st.ok() && sst) {
+      SetEpochInSrc(fname, false);
+    }
+  };
+  if (HasDestBucket() && !src_first) {  // read from destination
+    from_dest();
     if (st.ok()) {
       return st;
     }
@@ -148,6 +301,11 @@ IOStatus CloudFileSystemImpl::NewCloudReadableFile(
   if (HasSrcBucket() && !SrcMatchesDest()) {  // read from src bucket
     st = GetStorageProvider()->NewCloudReadableFile(
         GetSrcBucketName(), srcname(fname), options, result, dbg);
+    if (st.ok() && sst) {
+      SetEpochInSrc(fname, true);
+    } else if (!st.ok() && src_first && HasDestBucket()) {
+      from_dest();
+    }
   }
   return st;
 }
@@ -171,15 +329,30 @@ IOStatus CloudFileSystemImpl::NewSequentialFile(
   }
 
   if (sstfile || manifest || identity) {
-    if (cloud_fs_options.keep_local_sst_files || !sstfile) {
+    if (sstfile && cloud_fs_options.keep_local_sst_files) {
+      WaitForPrefetch(fname);
+    }
+    if (cloud_fs_options.keep_local_sst_files || !sstfile ||
+        (cloud_fs_options.TiersLocalSstFiles() &&
+         base_fs_->FileExists(fname, IOOptions(), dbg).ok())) {
       // We read first from local storage and then from cloud storage.
       st = base_fs_->NewSequentialFile(fname, file_opts, result, dbg);
+      if (st.ok() && sstfile) {
+        TouchLocalSstFile(fname, false /* added */);
+      }
       if (!st.ok()) {
         // copy the file to the local storage if keep_local_sst_files is true
         st = GetCloudObject(fname);
         if (st.ok()) {
           // we successfully copied the file, try opening it locally now
           st = base_fs_->NewSequentialFile(fname, file_opts, result, dbg);
+        } else if (st.IsNotFound() && sstfile && IsZeroCopyClone()) {
+          // A file of the source, read it from the src bucket.
+          std::unique_ptr<CloudStorageReadableFile> file;
+          st = NewCloudReadableFile(fname, file_opts, &file, dbg);
+          if (st.ok()) {
+            result->reset(file.release());
+          }
         }
       }
     } else {
@@ -203,6 +376,119 @@ IOStatus CloudFileSystemImpl::NewSequentialFile(
   return base_fs_->NewSequentialFile(fname, file_opts, result, dbg);
 }
 
+namespace {
+struct ManifestDelta {
+  uint64_t offset;
+  uint32_t prefix_crc;
+  std::string object_path;
+};
+
+// Lists the deltas of the MANIFEST object object_path, see
+// CloudFileSystemOptions::manifest_delta_uploads.
+IOStatus ListManifestDeltas(CloudStorageProvider* provider,
+                            const std::string& bucket,
+                            const std::string& object_path,
+                            std::vector<ManifestDelta>* deltas) {
+  std::vector<std::string> objects;
+  auto dir = dirname(object_path);
+  auto st = provider->ListCloudObjects(bucket, dir, &objects);
+  if (st.IsNotFound()) {
+    return IOStatus::OK();
+  }
+  for (const auto& o : objects) {
+    ManifestDelta delta;
+    std::string manifest;
+    delta.object_path = dir.empty() ? o : dir + pathsep + o;
+    if (ParseManifestDeltaFile(delta.object_path, &manifest, &delta.offset,
+                               &delta.prefix_crc) &&
+        manifest == object_path) {
+      deltas->push_back(std::move(delta));
+    }
+  }
+  return st;
+}
+
+// Removes from deltas and returns the delta that continues a MANIFEST of
+// the given size and crc32c. Returns false if there is none.
+bool TakeNextManifestDelta(std::vector<ManifestDelta>* deltas, uint64_t size,
+                           uint32_t crc, ManifestDelta* next) {
+  for (auto it = deltas->begin(); it != deltas->end(); ++it) {
+    if (it->offset == size && it->prefix_crc == crc) {
+      *next = std::move(*it);
+      deltas->erase(it);
+      return true;
+    }
+  }
+  return false;
+}
+
+// Reads a MANIFEST object followed by its deltas.
+class ManifestWithDeltasFile : public FSSequentialFile {
+ public:
+  ManifestWithDeltasFile(std::shared_ptr<CloudStorageProvider> provider,
+                         const std::string& bucket,
+                         const FileOptions& file_opts,
+                         std::unique_ptr<FSSequentialFile>&& base,
+                         std::vector<ManifestDelta>&& deltas)
+      : provider_(std::move(provider)),
+        bucket_(bucket),
+        file_opts_(file_opts),
+        current_(std::move(base)),
+        deltas_(std::move(deltas)) {}
+
+  IOStatus Read(size_t n, const IOOptions& opts, Slice* result, char* scratch,
+                IODebugContext* dbg) override {
+    while (true) {
+      auto s = current_->Read(n, opts, result, scratch, dbg);
+      if (!s.ok()) {
+        return s;
+      }
+      if (!result->empty()) {
+        size_ += result->size();
+        crc_ = crc32c::Extend(crc_, result->data(), result->size());
+        return s;
+      }
+      ManifestDelta delta;
+      if (!TakeNextManifestDelta(&deltas_, size_, crc_, &delta)) {
+        return s;
+      }
+      std::unique_ptr<CloudStorageReadableFile> file;
+      s = provider_->NewCloudReadableFile(bucket_, delta.object_path,
+                                          file_opts_, &file, dbg);
+      if (!s.ok()) {
+        return s;
+      }
+      current_ = std::move(file);
+    }
+  }
+
+  IOStatus Skip(uint64_t n) override {
+    // Skipped data is still needed to checksum the MANIFEST.
+    std::string scratch(static_cast<size_t>(std::min<uint64_t>(n, 64 << 10)),
+                        '\0');
+    while (n > 0) {
+      Slice result;
+      auto s = Read(static_cast<size_t>(std::min<uint64_t>(n, scratch.size())),
+                    IOOptions(), &result, &scratch[0], nullptr);
+      if (!s.ok() || result.empty()) {
+        return s;
+      }
+      n -= result.size();
+    }
+    return IOStatus::OK();
+  }
+
+ private:
+  std::shared_ptr<CloudStorageProvider> provider_;
+  std::string bucket_;
+  FileOptions file_opts_;
+  std::unique_ptr<FSSequentialFile> current_;
+  std::vector<ManifestDelta> deltas_;
+  uint64_t size_ = 0;
+  uint32_t crc_ = 0;
+};
+}  // namespace
+
 // Ability to read a file directly from cloud storage
 IOStatus CloudFileSystemImpl::NewSequentialFileCloud(
     const std::string& bucket, const std::string& fname,
@@ -215,16 +501,86 @@ IOStatus CloudFileSystemImpl::NewSequentialFileCloud(
     return st;
   }
 
-  result->reset(file.release());
+  std::vector<ManifestDelta> deltas;
+  if (IsManifestFile(fname) && !IsManifestDeltaFile(fname)) {
+    st = ListManifestDeltas(GetStorageProvider().get(), bucket, fname, &deltas);
+    if (!st.ok()) {
+      return st;
+    }
+  }
+  if (!deltas.empty()) {
+    result->reset(new ManifestWithDeltasFile(GetStorageProvider(), bucket,
+                                             file_opts, std::move(file),
+                                             std::move(deltas)));
+  } else {
+    result->reset(file.release());
+  }
   return st;
 }
 
+IOStatus CloudFileSystemImpl::FetchManifestDeltas(
+    const std::string& bucket, const std::string& object_path,
+    const std::string& local_fname) {
+  std::vector<ManifestDelta> deltas;
+  auto st = ListManifestDeltas(GetStorageProvider().get(), bucket, object_path,
+                               &deltas);
+  if (!st.ok() || deltas.empty()) {
+    return st;
+  }
+
+  std::string contents;
+  st = ReadFileToString(base_fs_.get(), local_fname, &contents);
+  if (!st.ok()) {
+    return st;
+  }
+  const auto base_size = contents.size();
+  auto crc = crc32c::Value(contents.data(), contents.size());
+  auto tmp = local_fname + ".delta.tmp";
+  ManifestDelta delta;
+  size_t num_deltas = 0;
+  while (TakeNextManifestDelta(&deltas, contents.size(), crc, &delta)) {
+    std::string data;
+    st = GetStorageProvider()->GetCloudObject(bucket, delta.object_path, tmp);
+    if (st.ok()) {
+      st = ReadFileToString(base_fs_.get(), tmp, &data);
+    }
+    base_fs_->DeleteFile(tmp, IOOptions(), nullptr).PermitUncheckedError();
+    if (!st.ok()) {
+      return st;
+    }
+    crc = crc32c::Extend(crc, data.data(), data.size());
+    contents.append(data);
+    num_deltas++;
+  }
+  if (num_deltas == 0) {
+    return st;
+  }
+  Log(InfoLogLevel::INFO_LEVEL, info_log_,
+      "[%s] FetchManifestDeltas: appended %" ROCKSDB_PRIszt
+      " deltas of %" ROCKSDB_PRIszt " bytes to manifest %s",
+      Name(), num_deltas, contents.size() - base_size, local_fname.c_str());
+  return WriteStringToFile(base_fs_.get(), contents, local_fname,
+                           true /* should_sync */);
+}
+
 // open a file for random reading
 IOStatus CloudFileSystemImpl::NewRandomAccessFile(
     const std::string& logical_fname, const FileOptions& file_opts,
     std::unique_ptr<FSRandomAccessFile>* result, IODebugContext* dbg) {
   result->reset();
 
+  std::string bucket, object_path;
+  if (ParseCloudObjectUri(logical_fname, &bucket, &object_path)) {
+    // An external object being ingested, only its metadata is read.
+    std::unique_ptr<CloudStorageReadableFile> file;
+    auto st = GetStorageProvider()->NewCloudReadableFile(
+        bucket, object_path, file_opts, &file, dbg);
+    if (st.ok()) {
+      result->reset(file.release());
+    }
+    return st;
+  }
+
   auto fname = RemapFilename(logical_fname);
   auto file_type = GetFileType(fname);
   bool sstfile = (file_type == RocksDBFileType::kSstFile),
@@ -239,10 +595,41 @@ IOStatus CloudFileSystemImpl::NewRandomAccessFile(
   }
 
   const IOOptions io_opts;
+  if (sstfile &&
+      (!cloud_fs_options.keep_local_sst_files ||
+       cloud_fs_options.validate_filesize)) {
+    // The file has to be in the cloud, its upload may still be pending.
+    st = WaitForUploadToDest(fname);
+    if (!st.ok()) {
+      return st;
+    }
+  }
   if (sstfile || manifest || identity) {
-    if (cloud_fs_options.keep_local_sst_files || !sstfile) {
+    bool read_from_cloud = sstfile && !cloud_fs_options.keep_local_sst_files;
+    if (read_from_cloud && cloud_fs_options.TiersLocalSstFiles() &&
+        base_fs_->FileExists(fname, io_opts, dbg).ok()) {
+      // A tiered file with a local copy, see local_sst_max_level.
+      read_from_cloud = false;
+    }
+    if (sstfile && cloud_fs_options.keep_local_sst_files) {
+      if (cloud_fs_options.lazy_open_sst_files &&
+          base_fs_->FileExists(fname, io_opts, dbg).IsNotFound()) {
+        // Read from cloud storage until the file is downloaded.
+        std::lock_guard<std::mutex> lk(prefetch_mutex_);
+        if (prefetches_.count(fname) == 0) {
+          QueueSstDownload(fname);
+        }
+        read_from_cloud = true;
+      } else {
+        WaitForPrefetch(fname);
+      }
+    }
+    if (!read_from_cloud) {
       // Read from local storage and then from cloud storage.
       st = base_fs_->NewRandomAccessFile(fname, file_opts, result, dbg);
+      if (st.ok() && sstfile) {
+        TouchLocalSstFile(fname, false /* added */);
+      }
 
       if (!st.ok() && !base_fs_->FileExists(fname, io_opts, dbg).IsNotFound()) {
         // if status is not OK, but file does exist locally, something is wrong
@@ -255,6 +642,18 @@ IOStatus CloudFileSystemImpl::NewRandomAccessFile(
         if (st.ok()) {
           // we successfully copied the file, try opening it locally now
           st = base_fs_->NewRandomAccessFile(fname, file_opts, result, dbg);
+        } else if (st.IsNotFound() && sstfile && IsZeroCopyClone()) {
+          // A file of the source, read it from the src bucket. There is no
+          // local copy to validate the size of.
+          std::unique_ptr<CloudStorageReadableFile> file;
+          st = NewCloudReadableFile(fname, file_opts, &file, dbg);
+          if (st.ok()) {
+            result->reset(file.release());
+          }
+          Log(InfoLogLevel::DEBUG_LEVEL, info_log_,
+              "[%s] NewRandomAccessFile file %s from src %s", Name(),
+              fname.c_str(), st.ToString().c_str());
+          return st;
         }
       }
       // If we are being paranoic, then we validate that our file size is
@@ -283,7 +682,8 @@ IOStatus CloudFileSystemImpl::NewRandomAccessFile(
         }
       }
     } else {
-      // Only execute this code path if files are not cached locally
+      // Only execute this code path if files are not cached locally, or not
+      // yet with lazy_open_sst_files
       std::unique_ptr<CloudStorageReadableFile> file;
       st = NewCloudReadableFile(fname, file_opts, &file, dbg);
       if (st.ok()) {
@@ -359,6 +759,41 @@ IOStatus CloudFileSystemImpl::NewWritableFile(
   return s;
 }
 
+IOStatus CloudFileSystemImpl::Poll(std::vector<void*>& io_handles,
+                                   size_t min_completions) {
+  if (cloud_fs_options.keep_local_sst_files) {
+    return base_fs_->Poll(io_handles, min_completions);
+  }
+  return CloudStorageReadableFileImpl::PollAsyncReads(io_handles,
+                                                      min_completions);
+}
+
+IOStatus CloudFileSystemImpl::AbortIO(std::vector<void*>& io_handles) {
+  if (cloud_fs_options.keep_local_sst_files) {
+    return base_fs_->AbortIO(io_handles);
+  }
+  return CloudStorageReadableFileImpl::AbortAsyncReads(io_handles);
+}
+
+void CloudFileSystemImpl::SupportedOps(int64_t& supported_ops) {
+  if (cloud_fs_options.keep_local_sst_files) {
+    base_fs_->SupportedOps(supported_ops);
+    if (IsZeroCopyClone() || cloud_fs_options.lazy_open_sst_files) {
+      // Poll() cannot mix the local files with the ones read in place from
+      // the src bucket, or from the cloud until they are downloaded.
+      supported_ops &= ~(1 << FSSupportedOps::kAsyncIO);
+    }
+    return;
+  }
+  supported_ops = 0;
+  // Poll() cannot mix the local copies of tiered SST files with the files
+  // read from the cloud.
+  if (cloud_fs_options.async_read_threads > 0 &&
+      !cloud_fs_options.TiersLocalSstFiles()) {
+    supported_ops |= (1 << FSSupportedOps::kAsyncIO);
+  }
+}
+
 IOStatus CloudFileSystemImpl::ReopenWritableFile(
     const std::string& fname, const FileOptions& file_opts,
     std::unique_ptr<FSWritableFile>* result, IODebugContext* dbg) {
@@ -366,6 +801,13 @@ IOStatus CloudFileSystemImpl::ReopenWritableFile(
   // an provider file in append mode. We still need to support this because
   // rocksdb's ExternalSstFileIngestionJob invokes this api to reopen
   // a pre-created file to flush/sync it.
+  if (IsSstFile(fname) &&
+      base_fs_->FileExists(RemapFilename(fname), IOOptions(), dbg)
+          .IsNotFound()) {
+    // A file copied into the cloud by LinkFile(), there is nothing to sync.
+    // Reopening it would create an empty local file.
+    return IOStatus::NotSupported();
+  }
   return base_fs_->ReopenWritableFile(fname, file_opts, result, dbg);
 }
 
@@ -377,6 +819,11 @@ IOStatus CloudFileSystemImpl::FileExists(const std::string& logical_fname,
                                          IODebugContext* dbg) {
   IOStatus st;
 
+  std::string bucket, object_path;
+  if (ParseCloudObjectUri(logical_fname, &bucket, &object_path)) {
+    return GetStorageProvider()->ExistsCloudObject(bucket, object_path);
+  }
+
   auto fname = RemapFilename(logical_fname);
   auto file_type = GetFileType(fname);
   bool sstfile = (file_type == RocksDBFileType::kSstFile),
@@ -432,14 +879,19 @@ IOStatus CloudFileSystemImpl::GetChildren(const std::string& path,
   }
 
   // Remove all results that are not supposed to be visible.
+  std::string remapped;
   result->erase(
       std::remove_if(result->begin(), result->end(),
                      [&](const std::string& f) {
+                       if (IsManifestDeltaFile(f)) {
+                         return true;
+                       }
                        auto noepoch = RemoveEpoch(f);
                        if (!IsSstFile(noepoch) && !IsManifestFile(noepoch)) {
                          return false;
                        }
-                       return RemapFilename(noepoch) != f;
+                       RemapFilename(noepoch, &remapped);
+                       return remapped != f;
                      }),
       result->end());
   // Remove the epoch, remap into RocksDB's domain
@@ -465,6 +917,11 @@ IOStatus CloudFileSystemImpl::GetFileSize(const std::string& logical_fname,
                                           uint64_t* size, IODebugContext* dbg) {
   *size = 0L;
 
+  std::string bucket, object_path;
+  if (ParseCloudObjectUri(logical_fname, &bucket, &object_path)) {
+    return GetStorageProvider()->GetCloudObjectSize(bucket, object_path, size);
+  }
+
   auto fname = RemapFilename(logical_fname);
   auto file_type = GetFileType(fname);
   bool sstfile = (file_type == RocksDBFileType::kSstFile),
@@ -532,13 +989,9 @@ IOStatus CloudFileSystemImpl::RenameFile(const std::string& logical_src,
        identity = (file_type == RocksDBFileType::kIdentityFile),
        logfile = (file_type == RocksDBFileType::kLogFile);
 
-  // Rename should never be called on sst files.
+  // SST files are only renamed to install the outputs of remote compactions.
   if (sstfile) {
-    Log(InfoLogLevel::DEBUG_LEVEL, info_log_,
-        "[%s] RenameFile source sstfile %s %s is not supported", Name(),
-        src.c_str(), target.c_str());
-    assert(0);
-    return IOStatus::NotSupported(Slice(src), Slice(target));
+    return RenameCompactionOutput(logical_src, src, target);
   } else if (logfile) {
     // Rename should never be called on log files as well
     Log(InfoLogLevel::ERROR_LEVEL, info_log_,
@@ -575,10 +1028,68 @@ IOStatus CloudFileSystemImpl::RenameFile(const std::string& logical_src,
   return st;
 }
 
+IOStatus CloudFileSystemImpl::RenameCompactionOutput(
+    const std::string& logical_src, const std::string& src,
+    const std::string& target) {
+  IOStatus st;
+  if (base_fs_->FileExists(src, IOOptions(), nullptr).ok()) {
+    // Written to the local file system by the worker.
+    st = base_fs_->RenameFile(src, target, IOOptions(), nullptr);
+    if (st.ok() && HasDestBucket()) {
+      st = RunUpload(CloudUploadClass::kCompaction, [&]() {
+        return CopyLocalFileToDest(target, destname(target), Env::IO_LOW);
+      });
+      if (st.ok() && !cloud_fs_options.keep_local_sst_files &&
+          !cloud_fs_options.TiersLocalSstFiles()) {
+        st = base_fs_->DeleteFile(target, IOOptions(), nullptr);
+      }
+    }
+  } else if (HasDestBucket()) {
+    // Uploaded to the dest bucket by the worker, see
+    // DBCloud::OpenAndCompact(): logical_src is the object path.
+    st = GetStorageProvider()->CopyCloudObject(
+        GetDestBucketName(), logical_src, GetDestBucketName(),
+        destname(target));
+    if (st.ok() && cloud_fs_options.keep_local_sst_files) {
+      st = GetCloudObject(target, Env::IO_LOW);
+    }
+    if (st.ok()) {
+      auto s = GetStorageProvider()->DeleteCloudObject(GetDestBucketName(),
+                                                       logical_src);
+      if (!s.ok()) {
+        Log(InfoLogLevel::WARN_LEVEL, info_log_,
+            "[%s] RenameFile failed to delete compaction output %s: %s",
+            Name(), logical_src.c_str(), s.ToString().c_str());
+      }
+    }
+  } else {
+    st = IOStatus::NotFound(src);
+  }
+  Log(InfoLogLevel::INFO_LEVEL, info_log_,
+      "[%s] RenameFile compaction output %s target %s: %s", Name(),
+      logical_src.c_str(), target.c_str(), st.ToString().c_str());
+  return st;
+}
+
 IOStatus CloudFileSystemImpl::LinkFile(const std::string& src,
                                        const std::string& target,
                                        const IOOptions& io_opts,
                                        IODebugContext* dbg) {
+  std::string src_bucket, src_object;
+  if (ParseCloudObjectUri(src, &src_bucket, &src_object)) {
+    // An external object being ingested: copy it into the destination
+    // bucket, under the name of the new file, without downloading it.
+    if (!HasDestBucket() || !IsSstFile(target)) {
+      return IOStatus::NotSupported();
+    }
+    auto target_remapped = RemapFilename(target);
+    auto st = GetStorageProvider()->CopyCloudObject(
+        src_bucket, src_object, GetDestBucketName(), destname(target_remapped));
+    Log(InfoLogLevel::INFO_LEVEL, info_log_,
+        "[%s] LinkFile copied %s to %s: %s", Name(), src.c_str(),
+        target_remapped.c_str(), st.ToString().c_str());
+    return st;
+  }
   // We only know how to link file if both src and dest buckets are empty
   if (HasDestBucket() || HasSrcBucket()) {
     return IOStatus::NotSupported();
@@ -693,6 +1204,12 @@ IOStatus CloudFileSystemImpl::DeleteDir(const std::string& dirname,
 IOStatus CloudFileSystemImpl::DeleteFile(const std::string& logical_fname,
                                          const IOOptions& io_opts,
                                          IODebugContext* dbg) {
+  std::string bucket, object_path;
+  if (ParseCloudObjectUri(logical_fname, &bucket, &object_path)) {
+    // The external object of an ingested file, which was copied
+    return GetStorageProvider()->DeleteCloudObject(bucket, object_path);
+  }
+
   auto fname = RemapFilename(logical_fname);
   auto file_type = GetFileType(fname);
   bool sstfile = (file_type == RocksDBFileType::kSstFile),
@@ -729,12 +1246,20 @@ IOStatus CloudFileSystemImpl::DeleteFile(const std::string& logical_fname,
   IOStatus st;
   // Delete from destination bucket and local dir
   if (sstfile || manifest || identity) {
+    if (sstfile) {
+      // Do not race with a deferred upload or a download of the file.
+      WaitForUploadToDest(fname).PermitUncheckedError();
+      WaitForPrefetch(fname);
+    }
     if (HasDestBucket()) {
       // add the remote file deletion to the queue
       st = DeleteCloudFileFromDest(basename(fname));
     }
     // delete from local, too. Ignore the result, though. The file might not be
     // there locally.
+    if (sstfile) {
+      ForgetLocalSstFile(fname);
+    }
     base_fs_->DeleteFile(fname, io_opts, dbg);
   } else if (logfile && !cloud_fs_options.keep_local_log_files) {
     // read from Log Controller
@@ -763,46 +1288,153 @@ IOStatus CloudFileSystemImpl::DeleteFile(const std::string& logical_fname,
 }
 
 IOStatus CloudFileSystemImpl::CopyLocalFileToDest(
-    const std::string& local_name, const std::string& dest_name) {
+    const std::string& local_name, const std::string& dest_name,
+    Env::IOPriority pri, const std::string& crc32c) {
+  if (cloud_file_deletion_scheduler_) {
+    // Remove file from deletion queue
+    cloud_file_deletion_scheduler_->UnscheduleFileDeletion(
+        basename(local_name));
+  }
+  ForgetPurgeCandidate(basename(local_name));
+  if (cloud_fs_options.cloud_rate_limiter) {
+    // Uploads of unknown priority, such as the MANIFEST's, go with the
+    // flushes.
+    uint64_t size = 0;
+    base_fs_->GetFileSize(local_name, IOOptions(), &size, nullptr)
+        .PermitUncheckedError();
+    cloud_fs_options.cloud_rate_limiter->Request(
+        CloudRateLimiter::Direction::kUpload, size,
+        pri == Env::IO_TOTAL ? Env::IO_HIGH : pri);
+  }
+  auto st = PutDestCloudObject(local_name, dest_name, crc32c);
+  if (st.ok() && IsSstFile(basename(local_name))) {
+    TouchLocalSstFile(local_name, true /* added */);
+  }
+  return st;
+}
+
+CloudUploadScheduler* CloudFileSystemImpl::GetUploadScheduler() {
+  if (cloud_fs_options.max_concurrent_uploads <= 0) {
+    return nullptr;
+  }
+  std::lock_guard<std::mutex> lk(uploads_mutex_);
+  if (!upload_scheduler_) {
+    upload_scheduler_.reset(
+        new CloudUploadScheduler(cloud_fs_options.max_concurrent_uploads,
+                                 cloud_fs_options.statistics));
+  }
+  return upload_scheduler_.get();
+}
+
+IOStatus CloudFileSystemImpl::RunUpload(
+    CloudUploadClass cls, const std::function<IOStatus()>& upload) {
+  auto* scheduler = GetUploadScheduler();
+  if (scheduler == nullptr) {
+    return upload();
+  }
+  return scheduler->Run(cls, upload);
+}
+
+void CloudFileSystemImpl::ScheduleUploadToDest(
+    const std::string& local_name, CloudUploadClass cls,
+    std::function<IOStatus()>&& upload) {
+  auto* scheduler = GetUploadScheduler();
+  uint64_t seq;
+  {
+    std::lock_guard<std::mutex> lk(uploads_mutex_);
+    if (!scheduler && !upload_pool_) {
+      upload_pool_.reset(new ThreadPoolImpl());
+      upload_pool_->SetBackgroundThreads(
+          std::max(1, cloud_fs_options.sst_upload_threads));
+    }
+    seq = next_upload_seq_++;
+    pending_uploads_[seq] = local_name;
+  }
+  Log(InfoLogLevel::DEBUG_LEVEL, info_log_,
+      "[%s] Deferred upload %" PRIu64 " of %s", Name(), seq,
+      local_name.c_str());
+  auto job = [this, seq, upload = std::move(upload)]() {
+    auto s = upload();
+    std::lock_guard<std::mutex> lk(uploads_mutex_);
+    if (!s.ok() && deferred_upload_status_.ok()) {
+      Log(InfoLogLevel::ERROR_LEVEL, info_log_,
+          "[%s] Deferred upload of %s failed %s", Name(),
+          pending_uploads_[seq].c_str(), s.ToString().c_str());
+      deferred_upload_status_ = s;
+    }
+    pending_uploads_.erase(seq);
+    uploads_cv_.notify_all();
+  };
+  if (scheduler) {
+    scheduler->Schedule(cls, std::move(job));
+  } else {
+    upload_pool_->SubmitJob(std::move(job));
+  }
+}
+
+IOStatus CloudFileSystemImpl::WaitForUploadToDest(
+    const std::string& local_name) {
+  std::unique_lock<std::mutex> lk(uploads_mutex_);
+  uploads_cv_.wait(lk, [&] {
+    for (const auto& pending : pending_uploads_) {
+      if (pending.second == local_name) {
+        return false;
+      }
+    }
+    return true;
+  });
+  return deferred_upload_status_;
+}
+
+bool CloudFileSystemImpl::HasPendingUpload(const std::string& local_name) {
+  std::lock_guard<std::mutex> lk(uploads_mutex_);
+  for (const auto& pending : pending_uploads_) {
+    if (pending.second == local_name) {
+      return true;
+    }
+  }
+  return false;
+}
+
+IOStatus CloudFileSystemImpl::WaitForAllUploadsToDest() {
+  std::unique_lock<std::mutex> lk(uploads_mutex_);
+  // Uploads scheduled while waiting are not waited for.
+  const uint64_t barrier = next_upload_seq_;
+  uploads_cv_.wait(lk, [&] {
+    return pending_uploads_.empty() ||
+           pending_uploads_.begin()->first >= barrier;
+  });
+  IOStatus st = deferred_upload_status_;
+  lk.unlock();
+  IOStatus express_st = WaitForExpressCopies();
+  return st.ok() ? express_st : st;
+}
+
+IOStatus CloudFileSystemImpl::CompleteMultipartUploadToDest(
+    const std::string& local_name, const std::string& dest_name,
+    const std::string& upload_id, const std::vector<std::string>& part_ids) {
   if (cloud_file_deletion_scheduler_) {
     // Remove file from deletion queue
     cloud_file_deletion_scheduler_->UnscheduleFileDeletion(
         basename(local_name));
   }
-  return GetStorageProvider()->PutCloudObject(local_name, GetDestBucketName(),
-                                              dest_name);
+  ForgetPurgeCandidate(basename(local_name));
+  return GetStorageProvider()->CompleteMultipartUpload(
+      GetDestBucketName(), dest_name, upload_id, part_ids);
 }
 
 IOStatus CloudFileSystemImpl::DeleteCloudFileFromDest(
     const std::string& fname) {
   assert(HasDestBucket());
   auto base = basename(fname);
-  auto path = GetDestObjectPath() + pathsep + base;
+  auto path = destname(fname);
   auto bucket = GetDestBucketName();
+  AddPurgeCandidate(base);
   if (!cloud_file_deletion_scheduler_) {
     return GetStorageProvider()->DeleteCloudObject(bucket, path);
   }
-  std::weak_ptr<Logger> info_log_wp = info_log_;
-  std::weak_ptr<CloudStorageProvider> storage_provider_wp =
-      GetStorageProvider();
-  auto file_deletion_runnable =
-      [path = std::move(path), bucket = std::move(bucket),
-       info_log_wp = std::move(info_log_wp),
-       storage_provider_wp = std::move(storage_provider_wp)]() {
-        auto storage_provider = storage_provider_wp.lock();
-        auto info_log = info_log_wp.lock();
-        if (!storage_provider || !info_log) {
-          return;
-        }
-        auto st = storage_provider->DeleteCloudObject(bucket, path);
-        if (!st.ok() && !st.IsNotFound()) {
-          Log(InfoLogLevel::ERROR_LEVEL, info_log,
-              "[CloudFileSystemImpl] DeleteFile file %s error %s", path.c_str(),
-              st.ToString().c_str());
-        }
-      };
-  return cloud_file_deletion_scheduler_->ScheduleFileDeletion(
-      base, std::move(file_deletion_runnable));
+  return cloud_file_deletion_scheduler_->ScheduleObjectDeletion(
+      base, std::move(path));
 }
 
 // Copy my IDENTITY file to cloud storage. Update dbid registry.
@@ -817,8 +1449,7 @@ IOStatus CloudFileSystemImpl::SaveIdentityToCloud(const std::string& localfile,
 
   // Upload ID file to provider
   if (st.ok()) {
-    st = GetStorageProvider()->PutCloudObject(localfile, GetDestBucketName(),
-                                              idfile);
+    st = PutDestCloudObject(localfile, idfile);
   }
 
   // Save mapping from ID to cloud pathname
@@ -851,13 +1482,26 @@ IOStatus CloudFileSystemImpl::LoadLocalCloudManifest(
   if (cloud_manifest_) {
     cloud_manifest_.reset();
   }
-  return CloudFileSystemEnv::LoadCloudManifest(dbname, GetBaseFileSystem(),
-                                               cookie, &cloud_manifest_);
+  auto st = CloudFileSystemEnv::LoadCloudManifest(dbname, GetBaseFileSystem(),
+                                                  cookie, &cloud_manifest_);
+  if (st.ok() && cloud_manifest_->GetSstObjectShards() !=
+                     cloud_fs_options.sst_object_shards) {
+    Log(InfoLogLevel::INFO_LEVEL, info_log_,
+        "[%s] %s keeps the SST object layout of its CLOUDMANIFEST, %" PRIu32
+        " shards, over sst_object_shards %" PRIu32,
+        Name(), dbname.c_str(), cloud_manifest_->GetSstObjectShards(),
+        cloud_fs_options.sst_object_shards);
+  }
+  return st;
 }
 
-std::string RemapFilenameWithCloudManifest(const std::string& logical_path,
-                                           CloudManifest* cloud_manifest) {
-  auto file_name = basename(logical_path);
+void RemapFilenameWithCloudManifest(const std::string& logical_path,
+                                    const CloudManifest* cloud_manifest,
+                                    std::string* result) {
+  const auto pos = logical_path.rfind('/');
+  // Short enough for the small string buffer.
+  const std::string file_name(
+      logical_path, pos == std::string::npos ? 0 : pos + 1);
   uint64_t fileNumber;
   FileType type;
   WalFileType walType;
@@ -866,47 +1510,77 @@ std::string RemapFilenameWithCloudManifest(const std::string& logical_path,
   } else {
     bool ok = ParseFileName(file_name, &fileNumber, &type, &walType);
     if (!ok) {
-      return logical_path;
+      *result = logical_path;
+      return;
     }
   }
-  std::string epoch;
+  const std::string* epoch;
   switch (type) {
     case kTableFile:
       // We should not be accessing sst files before CLOUDMANIFEST is loaded
       assert(cloud_manifest);
-      epoch = cloud_manifest->GetEpoch(fileNumber);
+      epoch = &cloud_manifest->GetEpoch(fileNumber);
       break;
     case kDescriptorFile:
       // We should not be accessing MANIFEST files before CLOUDMANIFEST is
       // loaded
       // Even though logical file might say MANIFEST-000001, we cut the number
       // suffix and store MANIFEST-[epoch] in the cloud and locally.
-      file_name = "MANIFEST";
       assert(cloud_manifest);
-      epoch = cloud_manifest->GetCurrentEpoch();
+      epoch = &cloud_manifest->GetCurrentEpoch();
       break;
     default:
-      return logical_path;
+      *result = logical_path;
+      return;
   };
-  auto dir = dirname(logical_path);
-  return dir + (dir.empty() ? "" : "/") + file_name +
-         (epoch.empty() ? "" : ("-" + epoch));
+  result->clear();
+  if (pos != std::string::npos && pos > 0) {
+    // The directory, with its separator
+    result->append(logical_path, 0, pos + 1);
+  }
+  result->append(type == kDescriptorFile ? "MANIFEST" : file_name);
+  if (!epoch->empty()) {
+    result->push_back('-');
+    result->append(*epoch);
+  }
 }
 
 std::string CloudFileSystemImpl::RemapFilename(
     const std::string& logical_path) const {
+  std::string result;
+  RemapFilename(logical_path, &result);
+  return result;
+}
+
+void CloudFileSystemImpl::RemapFilename(const std::string& logical_path,
+                                        std::string* result) const {
   if (UNLIKELY(test_disable_cloud_manifest_)) {
-    return logical_path;
+    *result = logical_path;
+    return;
   }
-  return RemapFilenameWithCloudManifest(logical_path, cloud_manifest_.get());
+  RemapFilenameWithCloudManifest(logical_path, cloud_manifest_.get(), result);
+}
+
+std::string CloudFileSystemImpl::CloudObjectName(
+    const std::string& object_path, const std::string& fname) const {
+  uint32_t shards =
+      cloud_manifest_ ? cloud_manifest_->GetSstObjectShards() : 0;
+  return object_path + pathsep + AddSstObjectShard(basename(fname), shards);
 }
 
 IOStatus CloudFileSystemImpl::DeleteCloudInvisibleFiles(
     const std::vector<std::string>& active_cookies) {
   assert(HasDestBucket());
-  std::vector<std::string> pathnames;
-  auto s = GetStorageProvider()->ListCloudObjects(
-      GetDestBucketName(), GetDestObjectPath(), &pathnames);
+  std::vector<std::string> invisible_files;
+  auto s = GetStorageProvider()->VisitCloudObjects(
+      GetDestBucketName(), GetDestObjectPath(), GetListBoundaries(),
+      [&](const std::string& name) {
+        auto fname = RemoveSstObjectShard(name);
+        if (IsFileInvisible(active_cookies, fname)) {
+          invisible_files.push_back(std::move(fname));
+        }
+        return true;
+      });
   if (!s.ok()) {
     Log(InfoLogLevel::WARN_LEVEL, info_log_,
         "Files in cloud are not scheduled to be deleted since listing cloud "
@@ -915,14 +1589,12 @@ IOStatus CloudFileSystemImpl::DeleteCloudInvisibleFiles(
     return s;
   }
 
-  for (auto& fname : pathnames) {
-    if (IsFileInvisible(active_cookies, fname)) {
-      // Ignore returned status on purpose.
-      Log(InfoLogLevel::INFO_LEVEL, info_log_,
-          "DeleteCloudInvisibleFiles deleting %s from destination bucket",
-          fname.c_str());
-      DeleteCloudFileFromDest(fname);
-    }
+  for (auto& fname : invisible_files) {
+    // Ignore returned status on purpose.
+    Log(InfoLogLevel::INFO_LEVEL, info_log_,
+        "DeleteCloudInvisibleFiles deleting %s from destination bucket",
+        fname.c_str());
+    DeleteCloudFileFromDest(fname);
   }
   return s;
 }
@@ -975,6 +1647,13 @@ bool CloudFileSystemImpl::IsFileInvisible(
 
     return !is_active;
   } else {
+    std::string manifest;
+    uint64_t offset;
+    uint32_t prefix_crc;
+    if (ParseManifestDeltaFile(fname, &manifest, &offset, &prefix_crc)) {
+      // Deltas go with their MANIFEST.
+      return IsFileInvisible(active_cookies, manifest);
+    }
     auto noepoch = RemoveEpoch(fname);
     if ((IsSstFile(noepoch) || IsManifestFile(noepoch)) &&
         (RemapFilename(noepoch) != fname)) {
@@ -1075,8 +1754,8 @@ Status CloudFileSystemImpl::CheckOption(const FileOptions& file_opts) {
 //
 std::string CloudFileSystemImpl::srcname(const std::string& localname) {
   assert(cloud_fs_options.src_bucket.IsValid());
-  return cloud_fs_options.src_bucket.GetObjectPath() + "/" +
-         basename(localname);
+  return CloudObjectName(cloud_fs_options.src_bucket.GetObjectPath(),
+                         localname);
 }
 
 //
@@ -1084,8 +1763,8 @@ std::string CloudFileSystemImpl::srcname(const std::string& localname) {
 //
 std::string CloudFileSystemImpl::destname(const std::string& localname) {
   assert(cloud_fs_options.dest_bucket.IsValid());
-  return cloud_fs_options.dest_bucket.GetObjectPath() + "/" +
-         basename(localname);
+  return CloudObjectName(cloud_fs_options.dest_bucket.GetObjectPath(),
+                         localname);
 }
 
 //
@@ -1427,8 +2106,8 @@ IOStatus CloudFileSystemImpl::GetCloudDbid(const std::string& local_dir,
 
   // Read dbid from dest bucket if it exists
   if (HasDestBucket()) {
-    auto st = GetStorageProvider()->GetCloudObject(
-        GetDestBucketName(), GetDestObjectPath() + "/IDENTITY", tmpfile);
+    auto st = FetchCloudObject(GetDestBucketName(),
+                               GetDestObjectPath() + "/IDENTITY", tmpfile);
     if (!st.ok() && !st.IsNotFound()) {
       return st;
     }
@@ -1453,7 +2132,8 @@ IOStatus CloudFileSystemImpl::GetCloudDbid(const std::string& local_dir,
 IOStatus CloudFileSystemImpl::MigrateFromPureRocksDB(
     const std::string& local_dbname) {
   std::unique_ptr<CloudManifest> manifest;
-  CloudManifest::CreateForEmptyDatabase("", &manifest);
+  CloudManifest::CreateForEmptyDatabase("", &manifest,
+                                        cloud_fs_options.sst_object_shards);
   auto st = WriteCloudManifest(manifest.get(), CloudManifestFile(local_dbname));
   if (!st.ok()) {
     return st;
@@ -1522,14 +2202,29 @@ IOStatus CloudFileSystemImpl::PreloadCloudManifest(
 
 IOStatus CloudFileSystemImpl::LoadCloudManifest(const std::string& local_dbname,
                                                 bool read_only) {
-  // Init cloud manifest
-  auto st = FetchCloudManifest(local_dbname);
+  // Init cloud manifest, unless SanitizeLocalDirectory() started fetching it
+  auto st = cloud_manifest_fetch_.valid() ? cloud_manifest_fetch_.get()
+                                          : FetchCloudManifest(local_dbname);
   if (st.ok()) {
     // Inits CloudFileSystemImpl::cloud_manifest_, which will enable us to
     // read files from the cloud
     st = LoadLocalCloudManifest(local_dbname);
   }
 
+  std::vector<std::string> active_cookies{cloud_fs_options.cookie_on_open,
+                                          cloud_fs_options.new_cookie_on_open};
+  const bool delete_cloud_invisible_files =
+      st.ok() && !read_only &&
+      cloud_fs_options.delete_cloud_invisible_files_on_open && HasDestBucket();
+  std::future<IOStatus> cloud_cleanup;
+  if (delete_cloud_invisible_files && cloud_fs_options.parallel_open &&
+      cloud_fs_options.resync_on_open) {
+    // The listing of the destination does not depend on the MANIFEST.
+    cloud_cleanup = std::async(std::launch::async, [this, &active_cookies]() {
+      return DeleteCloudInvisibleFiles(active_cookies);
+    });
+  }
+
   if (st.ok() && cloud_fs_options.resync_on_open) {
     auto epoch = cloud_manifest_->GetCurrentEpoch();
     st = FetchManifest(local_dbname, epoch);
@@ -1552,11 +2247,8 @@ IOStatus CloudFileSystemImpl::LoadCloudManifest(const std::string& local_dbname,
   // before rolling the epoch, so that newly generated CM/M files won't be
   // cleaned up.
   if (st.ok() && !read_only) {
-    std::vector<std::string> active_cookies{
-        cloud_fs_options.cookie_on_open, cloud_fs_options.new_cookie_on_open};
     st = DeleteLocalInvisibleFiles(local_dbname, active_cookies);
-    if (st.ok() && cloud_fs_options.delete_cloud_invisible_files_on_open &&
-        HasDestBucket()) {
+    if (st.ok() && delete_cloud_invisible_files && !cloud_cleanup.valid()) {
       st = DeleteCloudInvisibleFiles(active_cookies);
     }
     if (!st.ok()) {
@@ -1566,6 +2258,13 @@ IOStatus CloudFileSystemImpl::LoadCloudManifest(const std::string& local_dbname,
       st = IOStatus::OK();
     }
   }
+  if (cloud_cleanup.valid()) {
+    auto s = cloud_cleanup.get();
+    if (!s.ok()) {
+      Log(InfoLogLevel::INFO_LEVEL, info_log_,
+          "Failed to delete invisible files: %s", s.ToString().c_str());
+    }
+  }
 
   if (st.ok() && cloud_fs_options.roll_cloud_manifest_on_open) {
     // Rolls the new epoch in CLOUDMANIFEST (only for existing databases)
@@ -1645,6 +2344,14 @@ IOStatus CloudFileSystemImpl::SanitizeLocalDirectory(
     }
   }
 
+  if (IsZeroCopyClone()) {
+    Log(InfoLogLevel::INFO_LEVEL, info_log_,
+        "[cloud_fs_impl] SanitizeDirectory info.  "
+        " options.zero_copy_clone is set. The sst files from src bucket %s "
+        "are read in place, only the new ones are stored in local dir %s",
+        GetSrcObjectPath().c_str(), local_name.c_str());
+  }
+
   if (!do_reinit) {
     Log(InfoLogLevel::INFO_LEVEL, info_log_,
         "[cloud_fs_impl] SanitizeDirectory local directory %s is good",
@@ -1710,33 +2417,29 @@ IOStatus CloudFileSystemImpl::SanitizeLocalDirectory(
       "[cloud_fs_impl] SanitizeDirectory dest_equal_src = %d",
       SrcMatchesDest());
 
-  bool got_identity_from_dest = false, got_identity_from_src = false;
+  if (cloud_fs_options.parallel_open) {
+    // The CLOUDMANIFEST does not depend on the IDENTITY file.
+    cloud_manifest_fetch_ = std::async(
+        std::launch::async,
+        [this, local_name]() { return FetchCloudManifest(local_name); });
+  }
 
   // Download IDENTITY, first try destination, then source
-  if (HasDestBucket()) {
-    // download IDENTITY from dest
-    st = GetStorageProvider()->GetCloudObject(
-        GetDestBucketName(), IdentityFileName(GetDestObjectPath()),
-        IdentityFileName(local_name));
-    if (!st.ok() && !st.IsNotFound()) {
-      // If there was an error and it's not IsNotFound() we need to bail
-      return st;
-    }
-    got_identity_from_dest = st.ok();
-  }
-  if (!got_identity_from_dest && HasSrcBucket() && !SrcMatchesDest()) {
-    // download IDENTITY from src
-    st = GetStorageProvider()->GetCloudObject(
-        GetSrcBucketName(), IdentityFileName(GetSrcObjectPath()),
-        IdentityFileName(local_name));
-    if (!st.ok() && !st.IsNotFound()) {
-      // If there was an error and it's not IsNotFound() we need to bail
-      return st;
-    }
-    got_identity_from_src = st.ok();
+  bool got_identity_from_src = false;
+  st = FetchFromDestOrSrc(
+      [this](const std::string& bucket, const std::string& object_path,
+             const std::string& local_file) {
+        return GetStorageProvider()->GetCloudObject(
+            bucket, IdentityFileName(object_path), local_file);
+      },
+      IdentityFileName(local_name), true /* dest_error_is_final */,
+      &got_identity_from_src);
+  if (!st.ok() && !st.IsNotFound()) {
+    // If there was an error and it's not IsNotFound() we need to bail
+    return st;
   }
 
-  if (!got_identity_from_src && !got_identity_from_dest) {
+  if (st.IsNotFound()) {
     // There isn't a valid db in either the src or dest bucket.
     // Return with a success code so that a new DB can be created.
     Log(InfoLogLevel::INFO_LEVEL, info_log_,
@@ -1803,95 +2506,64 @@ IOStatus CloudFileSystemImpl::FetchCloudManifest(
         cloudmanifest.c_str());
     return IOStatus::OK();
   }
-  // first try to get cloudmanifest from dest
-  if (HasDestBucket()) {
-    auto st = GetStorageProvider()->GetCloudObject(
-        GetDestBucketName(), MakeCloudManifestFile(GetDestObjectPath(), cookie),
-        cloudmanifest);
-    if (!st.ok() && !st.IsNotFound()) {
-      // something went wrong, bail out
-      Log(InfoLogLevel::INFO_LEVEL, info_log_,
-          "[cloud_fs_impl] FetchCloudManifest: Failed to fetch "
-          " cloud manifest %s from dest %s",
-          cloudmanifest.c_str(), GetDestBucketName().c_str());
-      return st;
-    }
-    if (st.ok()) {
-      // found it!
-      Log(InfoLogLevel::INFO_LEVEL, info_log_,
-          "[cloud_fs_impl] FetchCloudManifest: Fetched"
-          " cloud manifest %s from dest %s",
-          cloudmanifest.c_str(), GetDestBucketName().c_str());
-      return st;
-    }
+  // first try to get cloudmanifest from dest, then from src
+  bool from_src = false;
+  auto st = FetchFromDestOrSrc(
+      [this, &cookie](const std::string& bucket, const std::string& object_path,
+                      const std::string& local_file) {
+        return FetchCloudObject(
+            bucket, MakeCloudManifestFile(object_path, cookie), local_file);
+      },
+      cloudmanifest, true /* dest_error_is_final */, &from_src);
+  if (st.IsNotFound()) {
+    Log(InfoLogLevel::INFO_LEVEL, info_log_,
+        "[cloud_fs_impl] FetchCloudManifest: No cloud manifest");
+    return IOStatus::NotFound();
   }
-  // we couldn't get cloud manifest from dest, need to try from src?
-  if (HasSrcBucket() && !SrcMatchesDest()) {
-    auto st = GetStorageProvider()->GetCloudObject(
-        GetSrcBucketName(), MakeCloudManifestFile(GetSrcObjectPath(), cookie),
-        cloudmanifest);
-    if (!st.ok() && !st.IsNotFound()) {
-      // something went wrong, bail out
-      Log(InfoLogLevel::INFO_LEVEL, info_log_,
-          "[cloud_fs_impl] FetchCloudManifest: Failed to fetch "
-          " cloud manifest %s from src %s",
-          cloudmanifest.c_str(), GetSrcBucketName().c_str());
-      return st;
-    }
-    if (st.ok()) {
-      // found it!
-      Log(InfoLogLevel::INFO_LEVEL, info_log_,
-          "[cloud_fs_impl] FetchCloudManifest: Fetched"
-          " cloud manifest %s from src %s",
-          cloudmanifest.c_str(), GetSrcBucketName().c_str());
-      return st;
-    }
+  const auto& bucket = from_src ? GetSrcBucketName() : GetDestBucketName();
+  if (!st.ok()) {
+    // something went wrong, bail out
+    Log(InfoLogLevel::INFO_LEVEL, info_log_,
+        "[cloud_fs_impl] FetchCloudManifest: Failed to fetch "
+        " cloud manifest %s from %s %s",
+        cloudmanifest.c_str(), from_src ? "src" : "dest", bucket.c_str());
+    return st;
   }
+  // found it!
   Log(InfoLogLevel::INFO_LEVEL, info_log_,
-      "[cloud_fs_impl] FetchCloudManifest: No cloud manifest");
-  return IOStatus::NotFound();
+      "[cloud_fs_impl] FetchCloudManifest: Fetched"
+      " cloud manifest %s from %s %s",
+      cloudmanifest.c_str(), from_src ? "src" : "dest", bucket.c_str());
+  return st;
 }
 
 IOStatus CloudFileSystemImpl::FetchManifest(const std::string& local_dbname,
                                             const std::string& epoch) {
   auto local_manifest_file = ManifestFileWithEpoch(local_dbname, epoch);
-  if (HasDestBucket()) {
-    auto st = GetStorageProvider()->GetCloudObject(
-        GetDestBucketName(), ManifestFileWithEpoch(GetDestObjectPath(), epoch),
-        local_manifest_file);
-    if (!st.ok() && !st.IsNotFound()) {
-      Log(InfoLogLevel::INFO_LEVEL, info_log_,
-          "[cloud_fs_impl] FetchManifest: Failed to fetch manifest %s from "
-          "dest %s",
-          local_manifest_file.c_str(), GetDestBucketName().c_str());
-    }
-
-    if (st.ok()) {
-      Log(InfoLogLevel::INFO_LEVEL, info_log_,
-          "[cloud_fs_impl] FetchManifest: Fetched manifest %s from dest: %s",
-          local_manifest_file.c_str(), GetDestBucketName().c_str());
-      return st;
-    }
-  }
-
-  if (HasSrcBucket() && !SrcMatchesDest()) {
-    auto st = GetStorageProvider()->GetCloudObject(
-        GetSrcBucketName(), ManifestFileWithEpoch(GetSrcObjectPath(), epoch),
-        local_manifest_file);
-    if (!st.ok() && !st.IsNotFound()) {
-      Log(InfoLogLevel::INFO_LEVEL, info_log_,
-          "[cloud_fs_impl] FetchManifest: Failed to fetch manifest %s from "
-          "src %s",
-          local_manifest_file.c_str(), GetSrcBucketName().c_str());
-    }
-    if (st.ok()) {
-      Log(InfoLogLevel::INFO_LEVEL, info_log_,
-          "[cloud_fs_impl] FetchManifest: Fetched manifest %s from "
-          "src %s",
-          local_manifest_file.c_str(), GetSrcBucketName().c_str());
-
-      return st;
-    }
+  bool from_src = false;
+  auto st = FetchFromDestOrSrc(
+      [this, &epoch](const std::string& bucket, const std::string& object_path,
+                     const std::string& local_file) {
+        auto manifest = ManifestFileWithEpoch(object_path, epoch);
+        auto s = FetchCloudObject(bucket, manifest, local_file);
+        if (s.ok()) {
+          s = FetchManifestDeltas(bucket, manifest, local_file);
+        }
+        if (!s.ok() && !s.IsNotFound()) {
+          Log(InfoLogLevel::INFO_LEVEL, info_log_,
+              "[cloud_fs_impl] FetchManifest: Failed to fetch manifest %s "
+              "from %s: %s",
+              local_file.c_str(), bucket.c_str(), s.ToString().c_str());
+        }
+        return s;
+      },
+      local_manifest_file, false /* dest_error_is_final */, &from_src);
+  if (st.ok()) {
+    Log(InfoLogLevel::INFO_LEVEL, info_log_,
+        "[cloud_fs_impl] FetchManifest: Fetched manifest %s from %s %s",
+        local_manifest_file.c_str(), from_src ? "src" : "dest",
+        (from_src ? GetSrcBucketName() : GetDestBucketName()).c_str());
+    return st;
   }
 
   Log(InfoLogLevel::INFO_LEVEL, info_log_,
@@ -1899,11 +2571,67 @@ IOStatus CloudFileSystemImpl::FetchManifest(const std::string& local_dbname,
   return IOStatus::NotFound();
 }
 
+IOStatus CloudFileSystemImpl::FetchFromDestOrSrc(
+    const std::function<IOStatus(const std::string& bucket,
+                                 const std::string& object_path,
+                                 const std::string& local_file)>& fetch,
+    const std::string& local_file, bool dest_error_is_final, bool* from_src) {
+  *from_src = false;
+  const bool has_src = HasSrcBucket() && !SrcMatchesDest();
+  const bool parallel =
+      cloud_fs_options.parallel_open && HasDestBucket() && has_src;
+  // When both are asked at once, the copy of the source is staged aside
+  // so that the copy of the destination wins.
+  const std::string src_file = parallel ? local_file + ".src" : local_file;
+  std::future<IOStatus> src_fetch;
+  if (parallel) {
+    src_fetch = std::async(std::launch::async, [&]() {
+      return fetch(GetSrcBucketName(), GetSrcObjectPath(), src_file);
+    });
+  }
+
+  IOStatus dest_st = IOStatus::NotFound();
+  if (HasDestBucket()) {
+    dest_st = fetch(GetDestBucketName(), GetDestObjectPath(), local_file);
+  }
+  const bool dest_done =
+      dest_st.ok() || (!dest_st.IsNotFound() && dest_error_is_final);
+  IOStatus src_st = IOStatus::NotFound();
+  if (parallel) {
+    src_st = src_fetch.get();
+  } else if (has_src && !dest_done) {
+    src_st = fetch(GetSrcBucketName(), GetSrcObjectPath(), src_file);
+  }
+
+  const auto& base_fs = GetBaseFileSystem();
+  if (dest_done) {
+    if (parallel && src_st.ok()) {
+      base_fs->DeleteFile(src_file, IOOptions(), nullptr /*dbg*/)
+          .PermitUncheckedError();
+    }
+    return dest_st;
+  }
+  if (src_st.IsNotFound()) {
+    // The error of the destination, if any.
+    return dest_st;
+  }
+  *from_src = true;
+  if (!src_st.ok()) {
+    return src_st;
+  }
+  if (parallel) {
+    return base_fs->RenameFile(src_file, local_file, IOOptions(),
+                               nullptr /*dbg*/);
+  }
+  return src_st;
+}
+
 IOStatus CloudFileSystemImpl::CreateCloudManifest(
     const std::string& local_dbname, const std::string& cookie) {
   // No cloud manifest, create an empty one
   std::unique_ptr<CloudManifest> manifest;
-  CloudManifest::CreateForEmptyDatabase(GenerateNewEpochId(), &manifest);
+  CloudManifest::CreateForEmptyDatabase(GenerateNewEpochId(), &manifest,
+                                        cloud_fs_options.sst_object_shards);
   auto st = WriteCloudManifest(manifest.get(),
                                MakeCloudManifestFile(local_dbname, cookie));
   if (st.ok()) {
@@ -1960,9 +2688,9 @@ IOStatus CloudFileSystemImpl::UploadManifest(const std::string& local_dbname,
         "Dest bucket has to be specified when uploading manifest files");
   }
 
-  auto st = GetStorageProvider()->PutCloudObject(
-      ManifestFileWithEpoch(local_dbname, epoch), GetDestBucketName(),
-      ManifestFileWithEpoch(GetDestObjectPath(), epoch));
+  auto st =
+      PutDestCloudObject(ManifestFileWithEpoch(local_dbname, epoch),
+                         ManifestFileWithEpoch(GetDestObjectPath(), epoch));
 
   TEST_SYNC_POINT_CALLBACK(
       "CloudFileSystemImpl::UploadManifest:AfterUploadManifest", &st);
@@ -1977,9 +2705,9 @@ IOStatus CloudFileSystemImpl::UploadCloudManifest(
   }
   // upload the cloud manifest file corresponds to cookie (i.e.,
   // CLOUDMANIFEST-cookie)
-  auto st = GetStorageProvider()->PutCloudObject(
-      MakeCloudManifestFile(local_dbname, cookie), GetDestBucketName(),
-      MakeCloudManifestFile(GetDestObjectPath(), cookie));
+  auto st =
+      PutDestCloudObject(MakeCloudManifestFile(local_dbname, cookie),
+                         MakeCloudManifestFile(GetDestObjectPath(), cookie));
   if (!st.ok()) {
     return st;
   }
@@ -1987,6 +2715,95 @@ IOStatus CloudFileSystemImpl::UploadCloudManifest(
   return st;
 }
 
+bool CloudFileSystemImpl::IsExpressObject(
+    const std::string& object_path) const {
+  if (cloud_fs_options.express_bucket.empty() || !HasDestBucket()) {
+    return false;
+  }
+  return (IsManifestFile(object_path) && !IsManifestDeltaFile(object_path)) ||
+         IsCloudManifestFile(object_path) || IsIdentityFile(object_path);
+}
+
+IOStatus CloudFileSystemImpl::PutDestCloudObject(
+    const std::string& local_file, const std::string& object_path,
+    const std::string& crc32c) const {
+  if (!IsExpressObject(object_path)) {
+    return GetStorageProvider()->PutCloudObjectWithChecksum(
+        local_file, GetDestBucketName(), object_path, crc32c);
+  }
+  auto st = GetStorageProvider()->PutCloudObjectWithChecksum(
+      local_file, cloud_fs_options.express_bucket, object_path, crc32c);
+  if (st.ok()) {
+    ScheduleExpressCopy(object_path);
+  }
+  return st;
+}
+
+IOStatus CloudFileSystemImpl::FetchCloudObject(
+    const std::string& bucket, const std::string& object_path,
+    const std::string& local_file) const {
+  if (bucket == GetDestBucketName() && IsExpressObject(object_path)) {
+    // The express bucket has the latest version, the destination bucket
+    // lags behind it by the queued copies.
+    auto st = GetStorageProvider()->GetCloudObject(
+        cloud_fs_options.express_bucket, object_path, local_file);
+    if (!st.IsNotFound()) {
+      return st;
+    }
+  }
+  return GetStorageProvider()->GetCloudObject(bucket, object_path, local_file);
+}
+
+void CloudFileSystemImpl::ScheduleExpressCopy(
+    const std::string& object_path) const {
+  std::lock_guard<std::mutex> lk(express_mutex_);
+  if (std::find(express_copies_.begin(), express_copies_.end(),
+                object_path) == express_copies_.end()) {
+    express_copies_.push_back(object_path);
+  }
+  if (!express_thread_.joinable()) {
+    express_thread_ = std::thread([this]() { ExpressCopyLoop(); });
+  }
+  express_cv_.notify_all();
+}
+
+void CloudFileSystemImpl::ExpressCopyLoop() const {
+  std::unique_lock<std::mutex> lk(express_mutex_);
+  while (true) {
+    express_cv_.wait(
+        lk, [this] { return express_stop_ || !express_copies_.empty(); });
+    if (express_copies_.empty()) {
+      break;
+    }
+    std::string object_path = std::move(express_copies_.front());
+    express_copies_.pop_front();
+    express_copying_ = true;
+    lk.unlock();
+    auto st = GetStorageProvider()->CopyCloudObject(
+        cloud_fs_options.express_bucket, object_path, GetDestBucketName(),
+        object_path);
+    if (!st.ok()) {
+      Log(InfoLogLevel::ERROR_LEVEL, info_log_,
+          "[cloud_fs_impl] Copy of %s from express bucket %s to %s failed: %s",
+          object_path.c_str(), cloud_fs_options.express_bucket.c_str(),
+          GetDestBucketName().c_str(), st.ToString().c_str());
+    }
+    lk.lock();
+    express_copying_ = false;
+    if (!st.ok() && express_copy_status_.ok()) {
+      express_copy_status_ = st;
+    }
+    express_cv_.notify_all();
+  }
+}
+
+IOStatus CloudFileSystemImpl::WaitForExpressCopies() const {
+  std::unique_lock<std::mutex> lk(express_mutex_);
+  express_cv_.wait(
+      lk, [this] { return express_copies_.empty() && !express_copying_; });
+  return express_copy_status_;
+}
+
 IOStatus CloudFileSystemImpl::ApplyCloudManifestDelta(
     const CloudManifestDelta& delta, bool* delta_applied) {
   *delta_applied = cloud_manifest_->AddEpoch(delta.file_num, delta.epoch);
@@ -2214,6 +3031,35 @@ Status CloudFileSystemImpl::PrepareOptions(const ConfigOptions& options) {
   if (!status.ok()) {
     return status;
   }
+  if (cloud_fs_options.cloud_file_deletion_delay &&
+      !cloud_file_deletion_scheduler_) {
+    // Deletions from the destination bucket that are due together are sent
+    // to the storage provider as one batch
+    std::weak_ptr<Logger> info_log_wp = info_log_;
+    std::weak_ptr<CloudStorageProvider> storage_provider_wp =
+        cloud_fs_options.storage_provider;
+    auto batch_deletion_runnable =
+        [bucket = GetDestBucketName(), info_log_wp = std::move(info_log_wp),
+         storage_provider_wp = std::move(storage_provider_wp)](
+            const std::vector<std::string>& paths) {
+          auto storage_provider = storage_provider_wp.lock();
+          if (!storage_provider) {
+            return;
+          }
+          auto st = storage_provider->DeleteCloudObjects(bucket, paths);
+          auto info_log = info_log_wp.lock();
+          if (!st.ok() && info_log) {
+            Log(InfoLogLevel::ERROR_LEVEL, info_log,
+                "[CloudFileSystemImpl] DeleteFile %" ROCKSDB_PRIszt
+                " files error %s",
+                paths.size(), st.ToString().c_str());
+          }
+        };
+    cloud_file_deletion_scheduler_ = CloudFileDeletionScheduler::Create(
+        CloudScheduler::Get(cloud_fs_options.statistics),
+        *cloud_fs_options.cloud_file_deletion_delay,
+        std::move(batch_deletion_runnable));
+  }
   // start the purge thread only if there is a destination bucket
   if (cloud_fs_options.dest_bucket.IsValid() && cloud_fs_options.run_purger) {
     CloudFileSystemImpl* cloud = this;
@@ -2251,6 +3097,14 @@ Status CloudFileSystemImpl::CheckValidity() const {
              !cloud_fs_options.cloud_log_controller) {
     return Status::InvalidArgument(
         "Log controller required for remote log files");
+  } else if (!cloud_fs_options.express_bucket.empty() &&
+             cloud_fs_options.dest_bucket.GetBucketName().empty()) {
+    return Status::InvalidArgument(
+        "An express bucket requires a dest bucket");
+  } else if (cloud_fs_options.local_sst_budget_bytes > 0 &&
+             cloud_fs_options.dest_bucket.GetBucketName().empty()) {
+    return Status::InvalidArgument(
+        "A local SST budget requires a dest bucket");
   } else {
     return Status::OK();
   }
@@ -2264,7 +3118,7 @@ void CloudFileSystemImpl::RemapFileNumbers(
   size_t idx = 0;
   for (auto num : file_numbers) {
     std::string logical_path = MakeTableFileName("" /* path */, num);
-    (*sst_file_names)[idx] = RemapFilename(logical_path);
+    RemapFilename(logical_path, &(*sst_file_names)[idx]);
     idx++;
   }
 }
@@ -2306,6 +3160,298 @@ IOStatus CloudFileSystemImpl::FindLiveFilesFromLocalManifest(
   return IOStatus::OK();
 }
 
+IOStatus CloudFileSystemImpl::PrefetchSstFiles(
+    const std::string& local_dbname) {
+  if (!cloud_fs_options.prefetch_sst_files_on_open ||
+      !cloud_fs_options.keep_local_sst_files) {
+    return IOStatus::OK();
+  }
+  auto manifest_file =
+      RemapFilename(ManifestFileWithEpoch(local_dbname, "" /* epoch */));
+  std::vector<LiveSstFileInfo> files;
+  LocalManifestReader extractor(info_log_, this);
+  auto st = extractor.GetManifestLiveFiles(manifest_file, &files);
+  if (!st.ok()) {
+    return st;
+  }
+
+  // Lower levels first: every read goes through L0, and the lower levels are
+  // the smallest ones, so most of the DB becomes local the soonest.
+  std::sort(files.begin(), files.end(),
+            [](const LiveSstFileInfo& a, const LiveSstFileInfo& b) {
+              return std::make_pair(a.level, a.file_size) <
+                     std::make_pair(b.level, b.file_size);
+            });
+  std::vector<std::string> to_fetch;
+  uint64_t bytes = 0;
+  uint64_t budgeted_bytes = 0;
+  std::lock_guard<std::mutex> queue_lk(prefetch_mutex_);
+  for (const auto& f : files) {
+    budgeted_bytes += f.file_size;
+    if (cloud_fs_options.local_sst_budget_bytes > 0 &&
+        budgeted_bytes > cloud_fs_options.local_sst_budget_bytes) {
+      // The files of the higher levels stay in the cloud until opened.
+      break;
+    }
+    auto fname = RemapFilename(MakeTableFileName(local_dbname, f.number));
+    // Skip the local files and the ones queued by an earlier call.
+    if (prefetches_.count(fname) > 0 ||
+        base_fs_->FileExists(fname, IOOptions(), nullptr).ok()) {
+      continue;
+    }
+    to_fetch.push_back(std::move(fname));
+    bytes += f.file_size;
+  }
+  if (to_fetch.empty()) {
+    return st;
+  }
+  Log(InfoLogLevel::INFO_LEVEL, info_log_,
+      "[%s] PrefetchSstFiles: downloading %" ROCKSDB_PRIszt
+      " files of %" PRIu64 " bytes into %s",
+      Name(), to_fetch.size(), bytes, local_dbname.c_str());
+  for (const auto& fname : to_fetch) {
+    QueueSstDownload(fname);
+  }
+  return st;
+}
+
+void CloudFileSystemImpl::PrefetchCompactionInputs(
+    int job_id, const std::vector<std::string>& input_files) {
+  const auto& prefetcher = cloud_fs_options.compaction_prefetcher;
+  if (!prefetcher || cloud_fs_options.keep_local_sst_files) {
+    return;
+  }
+  std::vector<std::unique_ptr<CloudStorageReadableFileImpl>> readers;
+  std::vector<std::pair<std::string, std::string>> objects;
+  for (const auto& f : input_files) {
+    auto fname = RemapFilename(f);
+    if (cloud_fs_options.TiersLocalSstFiles() &&
+        base_fs_->FileExists(fname, IOOptions(), nullptr).ok()) {
+      // Read from its local copy.
+      continue;
+    }
+    std::unique_ptr<CloudStorageReadableFile> file;
+    auto st = NewCloudReadableFile(fname, FileOptions(), &file, nullptr);
+    auto* impl = dynamic_cast<CloudStorageReadableFileImpl*>(file.get());
+    if (!st.ok() || impl == nullptr) {
+      // The compaction reads the file from the cloud as usual.
+      continue;
+    }
+    objects.emplace_back(impl->bucket(), impl->object_path());
+    file.release();
+    readers.emplace_back(impl);
+  }
+  if (readers.empty()) {
+    return;
+  }
+  prefetcher->AddFiles(std::move(readers));
+  std::lock_guard<std::mutex> lk(compaction_inputs_mutex_);
+  auto& inputs = compaction_inputs_[job_id];
+  inputs.insert(inputs.end(), objects.begin(), objects.end());
+}
+
+void CloudFileSystemImpl::ReleaseCompactionInputs(int job_id) {
+  std::vector<std::pair<std::string, std::string>> objects;
+  {
+    std::lock_guard<std::mutex> lk(compaction_inputs_mutex_);
+    auto it = compaction_inputs_.find(job_id);
+    if (it == compaction_inputs_.end()) {
+      return;
+    }
+    objects = std::move(it->second);
+    compaction_inputs_.erase(it);
+  }
+  for (const auto& f : objects) {
+    cloud_fs_options.compaction_prefetcher->RemoveFile(f.first, f.second);
+  }
+}
+
+void CloudFileSystemImpl::UpdateLocalSstFiles(
+    const std::string& local_dbname,
+    const std::vector<LiveFileMetaData>& live_files) {
+  if (!cloud_fs_options.TiersLocalSstFiles() || !HasDestBucket()) {
+    return;
+  }
+  const auto temperature = cloud_fs_options.local_sst_temperature;
+  std::lock_guard<std::mutex> lk(local_sst_mutex_);
+  std::unordered_map<std::string, bool> placements;
+  size_t fetched = 0;
+  size_t dropped = 0;
+  for (const auto& f : live_files) {
+    auto fname = RemapFilename(MakeTableFileName(local_dbname, f.file_number));
+    bool local = f.level <= cloud_fs_options.local_sst_max_level ||
+                 (temperature != Temperature::kUnknown &&
+                  f.temperature == temperature);
+    auto it = local_sst_files_.find(fname);
+    if (it != local_sst_files_.end() && it->second == local) {
+      placements.emplace(std::move(fname), local);
+      continue;
+    }
+    if (local) {
+      std::lock_guard<std::mutex> queue_lk(prefetch_mutex_);
+      if (prefetches_.count(fname) == 0 &&
+          base_fs_->FileExists(fname, IOOptions(), nullptr).IsNotFound()) {
+        QueueSstDownload(fname);
+        fetched++;
+      }
+    } else {
+      // Cancels the download of the file, or waits for it.
+      WaitForPrefetch(fname);
+      if (base_fs_->FileExists(fname, IOOptions(), nullptr).ok()) {
+        // The local copy is only dropped once the file is in the cloud.
+        auto st = WaitForUploadToDest(fname);
+        if (st.ok()) {
+          st = base_fs_->DeleteFile(fname, IOOptions(), nullptr);
+        }
+        if (st.ok()) {
+          dropped++;
+        } else {
+          Log(InfoLogLevel::WARN_LEVEL, info_log_,
+              "[%s] UpdateLocalSstFiles unable to drop %s: %s", Name(),
+              fname.c_str(), st.ToString().c_str());
+          // Retried on the next call.
+          local = true;
+        }
+      }
+    }
+    placements.emplace(std::move(fname), local);
+  }
+  local_sst_files_ = std::move(placements);
+  if (fetched > 0 || dropped > 0) {
+    Log(InfoLogLevel::INFO_LEVEL, info_log_,
+        "[%s] UpdateLocalSstFiles: downloading %" ROCKSDB_PRIszt
+        " files, dropped the local copies of %" ROCKSDB_PRIszt " files",
+        Name(), fetched, dropped);
+  }
+}
+
+void CloudFileSystemImpl::QueueSstDownload(const std::string& fname) {
+  if (!prefetch_pool_) {
+    prefetch_pool_.reset(new ThreadPoolImpl());
+    prefetch_pool_->SetBackgroundThreads(
+        std::max(1, cloud_fs_options.prefetch_sst_threads));
+  }
+  prefetches_[fname] = false;
+  prefetch_pool_->SubmitJob([this, fname]() {
+    {
+      std::lock_guard<std::mutex> lk(prefetch_mutex_);
+      auto it = prefetches_.find(fname);
+      if (it == prefetches_.end()) {
+        // Taken over by an open, or deleted.
+        return;
+      }
+      it->second = true;
+    }
+    auto s = GetCloudObject(fname, Env::IO_LOW);
+    // The files of the source of a zero-copy clone are not downloaded.
+    if (!s.ok() && !(s.IsNotFound() && IsZeroCopyClone())) {
+      // The file is fetched again when it is opened.
+      Log(InfoLogLevel::WARN_LEVEL, info_log_,
+          "[%s] Failed to download %s: %s", Name(), fname.c_str(),
+          s.ToString().c_str());
+    }
+    std::lock_guard<std::mutex> lk(prefetch_mutex_);
+    prefetches_.erase(fname);
+    prefetch_cv_.notify_all();
+  });
+}
+
+void CloudFileSystemImpl::TouchLocalSstFile(const std::string& fname,
+                                            bool added) {
+  const uint64_t budget = cloud_fs_options.local_sst_budget_bytes;
+  if (budget == 0 || !cloud_fs_options.keep_local_sst_files) {
+    return;
+  }
+  {
+    std::lock_guard<std::mutex> lk(local_sst_lru_mutex_);
+    auto it = local_sst_lru_index_.find(fname);
+    if (it != local_sst_lru_index_.end()) {
+      local_sst_lru_.splice(local_sst_lru_.begin(), local_sst_lru_,
+                            it->second);
+      if (!added) {
+        return;
+      }
+    }
+  }
+  // A local copy is only counted once it is known to be in the cloud,
+  // otherwise evicting it would lose the file. A file written by the DB is
+  // counted when its upload completes, see CopyLocalFileToDest(). Until then
+  // it is not in the cloud, whether its upload is deferred or in flight.
+  if (!added &&
+      (HasPendingUpload(fname) || !ExistsCloudObject(fname).ok())) {
+    return;
+  }
+  uint64_t size = 0;
+  if (!base_fs_->GetFileSize(fname, IOOptions(), &size, nullptr).ok()) {
+    return;
+  }
+
+  std::vector<std::string> evicted;
+  uint64_t evicted_bytes = 0;
+  {
+    std::lock_guard<std::mutex> lk(local_sst_lru_mutex_);
+    auto it = local_sst_lru_index_.find(fname);
+    if (it != local_sst_lru_index_.end()) {
+      local_sst_lru_bytes_ -= it->second->second;
+      it->second->second = size;
+    } else {
+      local_sst_lru_.emplace_front(fname, size);
+      local_sst_lru_index_[fname] = local_sst_lru_.begin();
+    }
+    local_sst_lru_bytes_ += size;
+    // The copy just used is kept even if it is larger than the budget.
+    while (local_sst_lru_bytes_ > budget && local_sst_lru_.size() > 1) {
+      auto& victim = local_sst_lru_.back();
+      local_sst_lru_bytes_ -= victim.second;
+      evicted_bytes += victim.second;
+      local_sst_lru_index_.erase(victim.first);
+      evicted.push_back(std::move(victim.first));
+      local_sst_lru_.pop_back();
+    }
+  }
+  if (evicted.empty()) {
+    return;
+  }
+  for (const auto& victim : evicted) {
+    auto s = base_fs_->DeleteFile(victim, IOOptions(), nullptr);
+    if (!s.ok() && !s.IsNotFound()) {
+      Log(InfoLogLevel::WARN_LEVEL, info_log_,
+          "[%s] Failed to evict the local copy of %s: %s", Name(),
+          victim.c_str(), s.ToString().c_str());
+    }
+  }
+  Log(InfoLogLevel::INFO_LEVEL, info_log_,
+      "[%s] Evicted the local copies of %" ROCKSDB_PRIszt
+      " SST files of %" PRIu64 " bytes to make room for %s",
+      Name(), evicted.size(), evicted_bytes, fname.c_str());
+}
+
+void CloudFileSystemImpl::ForgetLocalSstFile(const std::string& fname) {
+  if (cloud_fs_options.local_sst_budget_bytes == 0) {
+    return;
+  }
+  std::lock_guard<std::mutex> lk(local_sst_lru_mutex_);
+  auto it = local_sst_lru_index_.find(fname);
+  if (it != local_sst_lru_index_.end()) {
+    local_sst_lru_bytes_ -= it->second->second;
+    local_sst_lru_.erase(it->second);
+    local_sst_lru_index_.erase(it);
+  }
+}
+
+void CloudFileSystemImpl::WaitForPrefetch(const std::string& fname) {
+  std::unique_lock<std::mutex> lk(prefetch_mutex_);
+  auto it = prefetches_.find(fname);
+  if (it == prefetches_.end()) {
+    return;
+  }
+  if (!it->second) {
+    prefetches_.erase(it);
+    return;
+  }
+  prefetch_cv_.wait(lk, [&] { return prefetches_.count(fname) == 0; });
+}
+
 std::string CloudFileSystemImpl::CloudManifestFile(const std::string& dbname) {
   if (dbname.empty()) {
     return MakeCloudManifestFile(cloud_fs_options.cookie_on_open);
@@ -2,13 +2,41 @@
 
 #include "rocksdb/cloud/cloud_file_system.h"
 
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <future>
+#include <set>
+#include <thread>
+
 #include "cloud/cloud_log_controller_impl.h"
+#include "cloud/cloud_manifest.h"
+#include "cloud/cloud_request_stats.h"
+#include "cloud/cloud_stats_history.h"
+#include "cloud/cloud_upload_scheduler.h"
+#include "cloud/filename.h"
+#include "file/file_util.h"
+#include "rocksdb/cloud/cloud_chunk_cache.h"
+#include "rocksdb/cloud/cloud_compaction_prefetcher.h"
+#include "rocksdb/cloud/cloud_file_system_impl.h"
 #include "rocksdb/cloud/cloud_log_controller.h"
+#include "rocksdb/cloud/cloud_rate_limiter.h"
+#include "rocksdb/cloud/cloud_read_hedger.h"
 #include "rocksdb/cloud/cloud_storage_provider.h"
 #include "rocksdb/cloud/cloud_storage_provider_impl.h"
+#include "rocksdb/cloud/simulated_storage_provider.h"
 #include "rocksdb/convenience.h"
+#include "rocksdb/db.h"
 #include "rocksdb/env.h"
+#include "rocksdb/perf_context.h"
+#include "rocksdb/statistics.h"
 #include "test_util/testharness.h"
+#include "util/coding.h"
+#include "util/compression.h"
+#include "util/crc32c.h"
+#include "util/file_checksum_helper.h"
+#include "util/random.h"
 #include "util/string_util.h"
 
 namespace ROCKSDB_NAMESPACE {
@@ -28,6 +56,29 @@ TEST(CloudFileSystemTest, TestBucket) {
   ASSERT_TRUE(copts.dest_bucket.IsValid());
 }
 
+TEST(CloudFileSystemTest, SstObjectShards) {
+  ASSERT_EQ(AddSstObjectShard("000010-e1.sst", 0), "000010-e1.sst");
+  ASSERT_EQ(AddSstObjectShard("MANIFEST-e1", 16), "MANIFEST-e1");
+  std::set<std::string> shards;
+  for (int i = 0; i < 1000; i++) {
+    auto fname = std::to_string(100000 + i) + "-e1.sst";
+    auto name = AddSstObjectShard(fname, 256);
+    // Two hex digits, stable across calls.
+    ASSERT_EQ(name.size(), fname.size() + 3);
+    ASSERT_EQ(name.substr(3), fname);
+    ASSERT_EQ(AddSstObjectShard(fname, 256), name);
+    ASSERT_EQ(RemoveSstObjectShard(name), fname);
+    shards.insert(name.substr(0, 2));
+  }
+  ASSERT_GT(shards.size(), 200);
+  ASSERT_EQ(AddSstObjectShard("000010.sst", 4096).find('/'), 3);
+  // Other objects are left as they are.
+  ASSERT_EQ(RemoveSstObjectShard("000010-e1.sst"), "000010-e1.sst");
+  ASSERT_EQ(RemoveSstObjectShard("ab/MANIFEST-e1"), "ab/MANIFEST-e1");
+  ASSERT_EQ(RemoveSstObjectShard("xy/000010.sst"), "xy/000010.sst");
+  ASSERT_EQ(RemoveSstObjectShard("ab/cd/000010.sst"), "ab/cd/000010.sst");
+}
+
 TEST(CloudFileSystemTest, ConfigureOptions) {
   ConfigOptions config_options;
   CloudFileSystemOptions copts, copy;
@@ -105,6 +156,1530 @@ TEST(CloudFileSystemTest, ConfigureBucketOptions) {
   ASSERT_EQ(copts.dest_bucket.GetRegion(), copy.dest_bucket.GetRegion());
 }
 
+TEST(CloudFileSystemTest, ConfigureMultiReadOptions) {
+  ConfigOptions config_options;
+  CloudFileSystemOptions copts, copy;
+  copts.multi_read_coalesce_gap_bytes = 4096;
+  copts.multi_read_max_parallelism = 3;
+  copts.async_read_threads = 5;
+  copts.multipart_upload_part_size = 8 << 20;
+  copts.multipart_upload_threads = 2;
+  copts.parallel_download_part_size = 16 << 20;
+  copts.parallel_download_threads = 3;
+  copts.defer_sst_uploads = true;
+  copts.sst_upload_threads = 3;
+  copts.max_concurrent_uploads = 6;
+  copts.sst_upload_checksums = true;
+  copts.manifest_delta_uploads = true;
+  copts.manifest_max_deltas = 7;
+  copts.prefetch_sst_files_on_open = true;
+  copts.prefetch_sst_threads = 9;
+  copts.parallel_open = true;
+  copts.replay_log_from_stream = true;
+  copts.log_compression = kZSTD;
+  copts.log_compression_max_dict_bytes = 16 << 10;
+  copts.lazy_open_sst_files = true;
+  copts.s3_crt_throughput_target_gbps = 25;
+  copts.s3_crt_part_size = 16 << 20;
+  copts.sst_object_shards = 64;
+  copts.object_metadata_cache_entries = 1000;
+  copts.local_sst_max_level = 3;
+  copts.local_sst_temperature = Temperature::kHot;
+  copts.dump_block_cache = true;
+  copts.block_cache_dump_period_secs = 600;
+  copts.stats_history_period_secs = 60;
+
+  std::string str;
+  ASSERT_OK(copts.Serialize(config_options, &str));
+  ASSERT_OK(copy.Configure(config_options, str));
+  ASSERT_EQ(copy.multi_read_coalesce_gap_bytes, 4096);
+  ASSERT_EQ(copy.multi_read_max_parallelism, 3);
+  ASSERT_EQ(copy.async_read_threads, 5);
+  ASSERT_EQ(copy.multipart_upload_part_size, 8 << 20);
+  ASSERT_EQ(copy.multipart_upload_threads, 2);
+  ASSERT_EQ(copy.parallel_download_part_size, 16 << 20);
+  ASSERT_EQ(copy.parallel_download_threads, 3);
+  ASSERT_TRUE(copy.defer_sst_uploads);
+  ASSERT_EQ(copy.sst_upload_threads, 3);
+  ASSERT_EQ(copy.max_concurrent_uploads, 6);
+  ASSERT_TRUE(copy.sst_upload_checksums);
+  ASSERT_TRUE(copy.manifest_delta_uploads);
+  ASSERT_EQ(copy.manifest_max_deltas, 7);
+  ASSERT_TRUE(copy.prefetch_sst_files_on_open);
+  ASSERT_EQ(copy.prefetch_sst_threads, 9);
+  ASSERT_TRUE(copy.parallel_open);
+  ASSERT_TRUE(copy.replay_log_from_stream);
+  ASSERT_EQ(copy.log_compression, kZSTD);
+  ASSERT_EQ(copy.log_compression_max_dict_bytes, 16 << 10);
+  ASSERT_TRUE(copy.lazy_open_sst_files);
+  ASSERT_EQ(copy.s3_crt_throughput_target_gbps, 25);
+  ASSERT_EQ(copy.s3_crt_part_size, 16 << 20);
+  ASSERT_EQ(copy.sst_object_shards, 64);
+  ASSERT_EQ(copy.object_metadata_cache_entries, 1000);
+  ASSERT_EQ(copy.local_sst_max_level, 3);
+  ASSERT_EQ(copy.local_sst_temperature, Temperature::kHot);
+  ASSERT_TRUE(copy.dump_block_cache);
+  ASSERT_EQ(copy.block_cache_dump_period_secs, 600);
+  ASSERT_EQ(copy.stats_history_period_secs, 60);
+}
+
+namespace {
+// A cloud readable file backed by an in-memory string that counts the number
+// of reads that reach the "cloud".
+class StringCloudReadableFile : public CloudStorageReadableFileImpl {
+ public:
+  StringCloudReadableFile(const std::string& data,
+                          const CloudFileSystemOptions* copts,
+                          const std::string& fname = "file")
+      : CloudStorageReadableFileImpl(nullptr /*info_log*/, "bucket", fname,
+                                     data.size(), copts),
+        data_(data) {}
+  ~StringCloudReadableFile() override { WaitForHedgedReads(); }
+
+  size_t NumCloudReads() const { return num_cloud_reads_.load(); }
+  // The next n cloud reads take an extra 500ms.
+  void SetSlowReads(int n) { slow_reads_ = n; }
+
+ protected:
+  IOStatus DoCloudRead(uint64_t offset, size_t n, const IOOptions& /*opts*/,
+                       char* scratch, uint64_t* bytes_read,
+                       IODebugContext* /*dbg*/) const override {
+    num_cloud_reads_++;
+    if (slow_reads_.fetch_sub(1) > 0) {
+      std::this_thread::sleep_for(std::chrono::milliseconds(500));
+    }
+    memcpy(scratch, data_.data() + offset, n);
+    *bytes_read = n;
+    return IOStatus::OK();
+  }
+
+ private:
+  std::string data_;
+  mutable std::atomic<size_t> num_cloud_reads_{0};
+  mutable std::atomic<int> slow_reads_{0};
+};
+}  // namespace
+
+TEST(CloudFileSystemTest, MultiReadCoalescesRanges) {
+  std::string data;
+  for (int i = 0; i < 10000; i++) {
+    data.push_back(static_cast<char>('a' + (i % 26)));
+  }
+  CloudFileSystemOptions copts;
+  copts.multi_read_coalesce_gap_bytes = 100;
+  copts.multi_read_max_parallelism = 4;
+  StringCloudReadableFile file(data, &copts);
+
+  // Unsorted, with two nearby groups, one isolated range and one range that
+  // runs past the end of the file.
+  const std::vector<std::pair<uint64_t, size_t>> ranges = {
+      {1050, 20}, {0, 10}, {5000, 100}, {10, 90}, {1000, 40}, {9990, 50}};
+  std::vector<std::string> scratches(ranges.size());
+  std::vector<FSReadRequest> reqs(ranges.size());
+  for (size_t i = 0; i < ranges.size(); i++) {
+    scratches[i].resize(ranges[i].second);
+    reqs[i].offset = ranges[i].first;
+    reqs[i].len = ranges[i].second;
+    reqs[i].scratch = &scratches[i][0];
+  }
+  ASSERT_OK(file.MultiRead(reqs.data(), reqs.size(), IOOptions(), nullptr));
+  // {0, 10}+{10, 90}, {1000, 40}+{1050, 20}, {5000, 100} and {9990, 50}
+  ASSERT_EQ(file.NumCloudReads(), 4);
+  for (size_t i = 0; i < ranges.size(); i++) {
+    ASSERT_OK(reqs[i].status);
+    size_t expected_len =
+        std::min<size_t>(ranges[i].second, data.size() - ranges[i].first);
+    ASSERT_EQ(reqs[i].result.ToString(),
+              data.substr(ranges[i].first, expected_len));
+  }
+
+  // Without options, only adjacent ranges are merged.
+  StringCloudReadableFile serial_file(data, nullptr);
+  for (size_t i = 0; i < ranges.size(); i++) {
+    reqs[i].result = Slice();
+  }
+  ASSERT_OK(
+      serial_file.MultiRead(reqs.data(), reqs.size(), IOOptions(), nullptr));
+  ASSERT_EQ(serial_file.NumCloudReads(), 5);
+  for (size_t i = 0; i < ranges.size(); i++) {
+    ASSERT_OK(reqs[i].status);
+    size_t expected_len =
+        std::min<size_t>(ranges[i].second, data.size() - ranges[i].first);
+    ASSERT_EQ(reqs[i].result.ToString(),
+              data.substr(ranges[i].first, expected_len));
+  }
+}
+
+TEST(CloudFileSystemTest, SharedInflightReads) {
+  std::string data;
+  for (int i = 0; i < 4096; i++) {
+    data.push_back(static_cast<char>('a' + (i % 26)));
+  }
+  for (bool share : {true, false}) {
+    CloudFileSystemOptions copts;
+    copts.share_inflight_reads = share;
+    StringCloudReadableFile file(data, &copts);
+    auto check_read = [&](uint64_t offset, size_t n) {
+      std::string scratch(n, '\0');
+      Slice result;
+      ASSERT_OK(
+          file.Read(offset, n, IOOptions(), &result, &scratch[0], nullptr));
+      ASSERT_EQ(result.ToString(), data.substr(offset, n));
+    };
+
+    // While a slow read is in flight, the reads it covers wait for it and
+    // the others go to the cloud.
+    file.SetSlowReads(1);
+    std::thread slow_reader([&] { check_read(0, 2000); });
+    while (file.NumCloudReads() == 0) {
+      std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    std::vector<std::thread> readers;
+    readers.emplace_back([&] { check_read(0, 2000); });
+    readers.emplace_back([&] { check_read(100, 200); });
+    readers.emplace_back([&] { check_read(1500, 1000); });
+    for (auto& reader : readers) {
+      reader.join();
+    }
+    slow_reader.join();
+    ASSERT_EQ(file.NumCloudReads(), share ? 2 : 4);
+  }
+}
+
+TEST(CloudFileSystemTest, ReadThroughChunkCache) {
+  std::string data;
+  for (int i = 0; i < 10000; i++) {
+    data.push_back(static_cast<char>('a' + (i % 26)));
+  }
+  CloudChunkCacheOptions cache_opts;
+  cache_opts.path = test::PerThreadDBPath("cloud_fs_chunk_cache");
+  cache_opts.chunk_size = 1024;
+  cache_opts.capacity = 64 * 1024;
+  DestroyDir(Env::Default(), cache_opts.path).PermitUncheckedError();
+  CloudFileSystemOptions copts;
+  ASSERT_OK(CloudChunkCache::Open(cache_opts, &copts.chunk_cache));
+
+  auto check_read = [&](StringCloudReadableFile& file, uint64_t offset,
+                        size_t n) {
+    std::string scratch(n, '\0');
+    Slice result;
+    ASSERT_OK(file.Read(offset, n, IOOptions(), &result, &scratch[0], nullptr));
+    ASSERT_EQ(result.ToString(), data.substr(offset, n));
+  };
+
+  StringCloudReadableFile sst(data, &copts, "000001.sst");
+  // Spans chunks 0 to 2.
+  check_read(sst, 1000, 1500);
+  ASSERT_EQ(sst.NumCloudReads(), 3);
+  check_read(sst, 1024, 100);
+  check_read(sst, 0, 3072);
+  ASSERT_EQ(sst.NumCloudReads(), 3);
+  // The last chunk of the file is short.
+  check_read(sst, 9000, 2000);
+  check_read(sst, 9990, 10);
+  ASSERT_EQ(sst.NumCloudReads(), 5);
+
+  // Other files do not go through the cache.
+  StringCloudReadableFile other(data, &copts, "MANIFEST-000001");
+  check_read(other, 1000, 1500);
+  check_read(other, 1000, 1500);
+  ASSERT_EQ(other.NumCloudReads(), 2);
+
+  copts.chunk_cache.reset();
+  DestroyDir(Env::Default(), cache_opts.path).PermitUncheckedError();
+}
+
+TEST(CloudFileSystemTest, CloudRateLimiter) {
+  CloudRateLimiterOptions limiter_opts;
+  limiter_opts.download_bytes_per_sec = 1 << 30;
+  limiter_opts.download_requests_per_sec = 1000;
+  limiter_opts.upload_requests_per_sec = 3;
+  limiter_opts.throttle_recovery_micros = 1000;
+  CloudFileSystemOptions copts;
+  copts.cloud_rate_limiter = std::make_shared<CloudRateLimiter>(limiter_opts);
+  auto* limiter = copts.cloud_rate_limiter.get();
+  using Direction = CloudRateLimiter::Direction;
+
+  std::string data(4096, 'x');
+  StringCloudReadableFile file(data, &copts);
+  std::string scratch(data.size(), '\0');
+  Slice result;
+  IOOptions io_opts;
+  io_opts.rate_limiter_priority = Env::IO_LOW;
+  ASSERT_OK(file.Read(0, 1000, io_opts, &result, &scratch[0], nullptr));
+  ASSERT_OK(file.Read(1000, 5000, IOOptions(), &result, &scratch[0], nullptr));
+  ASSERT_EQ(limiter->GetTotalRequests(Direction::kDownload), 2);
+  // The second read is trimmed to the end of the file.
+  ASSERT_EQ(limiter->GetTotalBytes(Direction::kDownload), 4096);
+  ASSERT_EQ(limiter->GetTotalRequests(Direction::kUpload), 0);
+
+  // Throttles halve the request budgets, down to one request per second.
+  limiter->OnThrottled();
+  ASSERT_EQ(limiter->GetRequestsPerSecond(Direction::kDownload), 500);
+  ASSERT_EQ(limiter->GetRequestsPerSecond(Direction::kUpload), 1);
+  limiter->OnThrottled();
+  ASSERT_EQ(limiter->GetRequestsPerSecond(Direction::kDownload), 250);
+  ASSERT_EQ(limiter->GetRequestsPerSecond(Direction::kUpload), 1);
+  ASSERT_EQ(limiter->GetThrottles(), 2);
+
+  // Without throttling, the budgets grow back to their configured values.
+  for (int i = 0; i < 100 &&
+                  limiter->GetRequestsPerSecond(Direction::kDownload) < 1000;
+       i++) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(2));
+    limiter->Request(Direction::kDownload, 0, Env::IO_USER);
+  }
+  ASSERT_EQ(limiter->GetRequestsPerSecond(Direction::kDownload), 1000);
+  ASSERT_EQ(limiter->GetRequestsPerSecond(Direction::kUpload), 3);
+
+  // Unset budgets are unlimited.
+  CloudRateLimiter unlimited{CloudRateLimiterOptions()};
+  unlimited.Request(Direction::kUpload, 1 << 20, Env::IO_LOW);
+  unlimited.OnThrottled();
+  ASSERT_EQ(unlimited.GetRequestsPerSecond(Direction::kUpload), 0);
+  ASSERT_EQ(unlimited.GetTotalBytes(Direction::kUpload), 1 << 20);
+}
+
+TEST(CloudFileSystemTest, HedgedCloudReads) {
+  CloudReadHedgerOptions hedger_opts;
+  hedger_opts.percentile = 90;
+  hedger_opts.min_delay_micros = 10 * 1000;
+  hedger_opts.max_hedge_ratio = 0;
+  hedger_opts.max_hedge_burst = 1;
+  CloudFileSystemOptions copts;
+  copts.read_hedger = std::make_shared<CloudReadHedger>(hedger_opts);
+  auto* hedger = copts.read_hedger.get();
+
+  std::string data;
+  for (int i = 0; i < 4096; i++) {
+    data.push_back(static_cast<char>('a' + (i % 26)));
+  }
+  StringCloudReadableFile file(data, &copts);
+  auto check_read = [&](uint64_t offset, size_t n) {
+    std::string scratch(n, '\0');
+    Slice result;
+    ASSERT_OK(file.Read(offset, n, IOOptions(), &result, &scratch[0], nullptr));
+    ASSERT_EQ(result.ToString(), data.substr(offset, n));
+  };
+
+  // Reads are not hedged until enough latencies were sampled.
+  file.SetSlowReads(1);
+  check_read(0, 100);
+  ASSERT_EQ(hedger->GetDelayMicros(), 0);
+  for (int i = 1; i < 64; i++) {
+    check_read(i, 100);
+  }
+  ASSERT_EQ(hedger->GetReads(), 64);
+  // The sampled reads are fast, the delay is the minimum.
+  ASSERT_EQ(hedger->GetDelayMicros(), hedger_opts.min_delay_micros);
+  ASSERT_EQ(hedger->GetHedges(), 0);
+
+  // A slow read gets a duplicate request, which serves it.
+  file.SetSlowReads(1);
+  check_read(1000, 500);
+  ASSERT_EQ(hedger->GetHedges(), 1);
+  ASSERT_EQ(hedger->GetHedgeWins(), 1);
+
+  // Once the budget is spent, slow reads wait for their single request.
+  file.SetSlowReads(1);
+  auto reads = file.NumCloudReads();
+  check_read(2000, 500);
+  ASSERT_EQ(hedger->GetHedges(), 1);
+  ASSERT_EQ(file.NumCloudReads(), reads + 1);
+}
+
+TEST(CloudFileSystemTest, CompactionPrefetcher) {
+  CloudCompactionPrefetcherOptions prefetcher_opts;
+  prefetcher_opts.buffer_bytes = 4096;
+  prefetcher_opts.chunk_size = 1024;
+  prefetcher_opts.chunks_per_file = 2;
+  prefetcher_opts.threads = 2;
+  CloudFileSystemOptions copts;
+  copts.compaction_prefetcher =
+      std::make_shared<CloudCompactionPrefetcher>(prefetcher_opts);
+  auto* prefetcher = copts.compaction_prefetcher.get();
+
+  std::string data;
+  for (int i = 0; i < 10000; i++) {
+    data.push_back(static_cast<char>('a' + (i % 26)));
+  }
+  std::vector<std::unique_ptr<CloudStorageReadableFileImpl>> inputs;
+  inputs.emplace_back(new StringCloudReadableFile(data, &copts, "000001.sst"));
+  inputs.emplace_back(new StringCloudReadableFile(data, &copts, "000002.sst"));
+  prefetcher->AddFiles(std::move(inputs));
+  // Nothing is downloaded until the compaction reads its inputs.
+  ASSERT_EQ(prefetcher->GetPrefetchedBytes(), 0);
+
+  IOOptions compaction_opts;
+  compaction_opts.io_activity = Env::IOActivity::kCompaction;
+  auto check_read = [&](StringCloudReadableFile& file, const IOOptions& opts,
+                        uint64_t offset, size_t n) {
+    std::string scratch(n, '\0');
+    Slice result;
+    ASSERT_OK(file.Read(offset, n, opts, &result, &scratch[0], nullptr));
+    ASSERT_EQ(result.ToString(), data.substr(offset, n));
+  };
+
+  // The compaction reads the first file through, from the prefetcher only.
+  StringCloudReadableFile first(data, &copts, "000001.sst");
+  for (uint64_t offset = 0; offset < data.size(); offset += 500) {
+    check_read(first, compaction_opts, offset,
+               std::min<size_t>(500, data.size() - offset));
+  }
+  ASSERT_EQ(first.NumCloudReads(), 0);
+  ASSERT_EQ(prefetcher->GetServedBytes(), data.size());
+  // Other reads go to the cloud.
+  check_read(first, IOOptions(), 0, 100);
+  ASSERT_EQ(first.NumCloudReads(), 1);
+
+  // A subcompaction starting in the middle of the second file reads its
+  // first chunk from the cloud, and the chunks that follow are prefetched.
+  StringCloudReadableFile second(data, &copts, "000002.sst");
+  check_read(second, compaction_opts, 5000, 100);
+  ASSERT_EQ(second.NumCloudReads(), 1);
+  check_read(second, compaction_opts, 5120, 1500);
+  ASSERT_EQ(second.NumCloudReads(), 1);
+  ASSERT_EQ(prefetcher->GetServedBytes(), data.size() + 1500);
+
+  // Once the compaction completed, its inputs are read from the cloud.
+  prefetcher->RemoveFile("bucket", "000001.sst");
+  prefetcher->RemoveFile("bucket", "000002.sst");
+  check_read(second, compaction_opts, 7000, 100);
+  ASSERT_EQ(second.NumCloudReads(), 2);
+}
+
+TEST(CloudFileSystemTest, ReadAsyncOnCloudFile) {
+  std::string data(4096, 'x');
+  for (size_t i = 0; i < data.size(); i++) {
+    data[i] = static_cast<char>('a' + (i % 26));
+  }
+  CloudFileSystemOptions copts;
+  copts.async_read_threads = 2;
+  StringCloudReadableFile file(data, &copts);
+
+  struct Completion {
+    int calls = 0;
+    IOStatus status;
+    std::string result;
+  };
+  auto cb = [](FSReadRequest& req, void* arg) {
+    auto* c = static_cast<Completion*>(arg);
+    c->calls++;
+    c->status = req.status;
+    c->result = req.result.ToString();
+  };
+
+  std::vector<Completion> completions(3);
+  std::vector<std::string> scratches(3, std::string(100, '\0'));
+  std::vector<void*> handles(3, nullptr);
+  std::vector<IOHandleDeleter> deleters(3);
+  for (size_t i = 0; i < 3; i++) {
+    FSReadRequest req;
+    req.offset = i * 1000;
+    req.len = 100;
+    req.scratch = &scratches[i][0];
+    ASSERT_OK(file.ReadAsync(req, IOOptions(), cb, &completions[i],
+                             &handles[i], &deleters[i], nullptr));
+  }
+  ASSERT_OK(CloudStorageReadableFileImpl::PollAsyncReads(handles, 3));
+  for (size_t i = 0; i < 3; i++) {
+    ASSERT_EQ(completions[i].calls, 1);
+    ASSERT_OK(completions[i].status);
+    ASSERT_EQ(completions[i].result, data.substr(i * 1000, 100));
+  }
+  // Polling again does not invoke the callbacks a second time.
+  ASSERT_OK(CloudStorageReadableFileImpl::PollAsyncReads(handles, 3));
+  for (size_t i = 0; i < 3; i++) {
+    ASSERT_EQ(completions[i].calls, 1);
+    deleters[i](handles[i]);
+  }
+  ASSERT_EQ(file.NumCloudReads(), 3);
+
+  // Aborted reads never invoke their callback.
+  Completion aborted;
+  std::string scratch(100, '\0');
+  FSReadRequest req;
+  req.offset = 0;
+  req.len = 100;
+  req.scratch = &scratch[0];
+  void* handle = nullptr;
+  IOHandleDeleter deleter;
+  ASSERT_OK(file.ReadAsync(req, IOOptions(), cb, &aborted, &handle, &deleter,
+                           nullptr));
+  std::vector<void*> abort_handles{handle};
+  ASSERT_OK(CloudStorageReadableFileImpl::AbortAsyncReads(abort_handles));
+  ASSERT_OK(CloudStorageReadableFileImpl::PollAsyncReads(abort_handles, 1));
+  ASSERT_EQ(aborted.calls, 0);
+  deleter(handle);
+}
+
+namespace {
+// A storage provider that keeps uploaded objects in memory. Only uploads are
+// supported.
+class MemoryStorageProvider : public CloudStorageProvider {
+ public:
+  const char* Name() const override { return "memory"; }
+  IOStatus CreateBucket(const std::string& /*bucket_name*/) override {
+    return IOStatus::NotSupported();
+  }
+  IOStatus ExistsBucket(const std::string& /*bucket_name*/) override {
+    return IOStatus::NotSupported();
+  }
+  IOStatus EmptyBucket(const std::string& /*bucket_name*/,
+                       const std::string& /*object_path*/) override {
+    return IOStatus::NotSupported();
+  }
+  IOStatus DeleteCloudObject(const std::string& /*bucket_name*/,
+                             const std::string& object_path) override {
+    std::lock_guard<std::mutex> lk(mu_);
+    return objects_.erase(object_path) > 0 ? IOStatus::OK()
+                                           : IOStatus::NotFound();
+  }
+  IOStatus ListCloudObjects(const std::string& /*bucket_name*/,
+                            const std::string& object_path,
+                            std::vector<std::string>* result) override {
+    std::lock_guard<std::mutex> lk(mu_);
+    auto prefix = object_path + "/";
+    for (const auto& o : objects_) {
+      if (StartsWith(o.first, prefix)) {
+        result->push_back(o.first.substr(prefix.size()));
+      }
+    }
+    return IOStatus::OK();
+  }
+  IOStatus ExistsCloudObject(const std::string& /*bucket_name*/,
+                             const std::string& object_path) override {
+    std::lock_guard<std::mutex> lk(mu_);
+    return objects_.count(object_path) > 0 ? IOStatus::OK()
+                                            : IOStatus::NotFound();
+  }
+  IOStatus GetCloudObjectSize(const std::string& /*bucket_name*/,
+                              const std::string& object_path,
+                              uint64_t* size) override {
+    std::lock_guard<std::mutex> lk(mu_);
+    auto it = objects_.find(object_path);
+    if (it == objects_.end()) {
+      return IOStatus::NotFound();
+    }
+    *size = it->second.size();
+    return IOStatus::OK();
+  }
+  IOStatus GetCloudObjectModificationTime(const std::string& /*bucket_name*/,
+                                          const std::string& /*object_path*/,
+                                          uint64_t* /*time*/) override {
+    return IOStatus::NotSupported();
+  }
+  IOStatus GetCloudObjectMetadata(const std::string& /*bucket_name*/,
+                                  const std::string& /*object_path*/,
+                                  CloudObjectInformation* /*info*/) override {
+    return IOStatus::NotSupported();
+  }
+  IOStatus CopyCloudObject(const std::string& /*src_bucket_name*/,
+                           const std::string& src_object_path,
+                           const std::string& /*dest_bucket_name*/,
+                           const std::string& dest_object_path) override {
+    std::lock_guard<std::mutex> lk(mu_);
+    auto it = objects_.find(src_object_path);
+    if (it == objects_.end()) {
+      return IOStatus::NotFound();
+    }
+    num_copies_++;
+    objects_[dest_object_path] = it->second;
+    return IOStatus::OK();
+  }
+  IOStatus GetCloudObject(const std::string& /*bucket_name*/,
+                          const std::string& object_path,
+                          const std::string& local_path) override {
+    std::lock_guard<std::mutex> lk(mu_);
+    get_order_.push_back(object_path);
+    auto it = objects_.find(object_path);
+    if (it == objects_.end()) {
+      return IOStatus::NotFound();
+    }
+    return WriteStringToFile(FileSystem::Default().get(), it->second,
+                             local_path);
+  }
+  IOStatus PutCloudObjectMetadata(
+      const std::string& /*bucket_name*/, const std::string& /*object_path*/,
+      const std::unordered_map<std::string, std::string>& /*metadata*/)
+      override {
+    return IOStatus::NotSupported();
+  }
+  IOStatus NewCloudWritableFile(
+      const std::string& /*local_path*/, const std::string& /*bucket_name*/,
+      const std::string& /*object_path*/, const FileOptions& /*options*/,
+      std::unique_ptr<CloudStorageWritableFile>* /*result*/,
+      IODebugContext* /*dbg*/) override {
+    return IOStatus::NotSupported();
+  }
+  IOStatus NewCloudReadableFile(
+      const std::string& /*bucket*/, const std::string& fname,
+      const FileOptions& /*options*/,
+      std::unique_ptr<CloudStorageReadableFile>* result,
+      IODebugContext* /*dbg*/) override {
+    std::lock_guard<std::mutex> lk(mu_);
+    open_order_.push_back(fname);
+    auto it = objects_.find(fname);
+    if (it == objects_.end()) {
+      return IOStatus::NotFound();
+    }
+    result->reset(new StringCloudReadableFile(it->second, nullptr, fname));
+    return IOStatus::OK();
+  }
+
+  IOStatus PutCloudObject(const std::string& local_path,
+                          const std::string& /*bucket_name*/,
+                          const std::string& object_path) override {
+    if (IsSstFile(object_path) && sst_put_delay_ms_ > 0) {
+      std::this_thread::sleep_for(
+          std::chrono::milliseconds(sst_put_delay_ms_));
+    }
+    if (before_put_) {
+      before_put_(object_path);
+    }
+    std::lock_guard<std::mutex> lk(mu_);
+    if (fail_puts_) {
+      return IOStatus::IOError("injected");
+    }
+    num_puts_++;
+    put_order_.push_back(object_path);
+    return ReadFileToString(FileSystem::Default().get(), local_path,
+                            &objects_[object_path]);
+  }
+  IOStatus CreateMultipartUpload(const std::string& /*bucket_name*/,
+                                 const std::string& object_path,
+                                 std::string* upload_id) override {
+    std::lock_guard<std::mutex> lk(mu_);
+    *upload_id = "upload-" + object_path;
+    uploads_[*upload_id].clear();
+    return IOStatus::OK();
+  }
+  IOStatus UploadPart(const std::string& /*bucket_name*/,
+                      const std::string& /*object_path*/,
+                      const std::string& upload_id, int part_number,
+                      const Slice& data, std::string* part_id) override {
+    std::lock_guard<std::mutex> lk(mu_);
+    if (fail_parts_) {
+      return IOStatus::IOError("injected");
+    }
+    auto& parts = uploads_[upload_id];
+    if (parts.size() < static_cast<size_t>(part_number)) {
+      parts.resize(part_number);
+    }
+    parts[part_number - 1] = data.ToString();
+    *part_id = "part" + std::to_string(part_number);
+    return IOStatus::OK();
+  }
+  IOStatus CompleteMultipartUpload(
+      const std::string& /*bucket_name*/, const std::string& object_path,
+      const std::string& upload_id,
+      const std::vector<std::string>& part_ids) override {
+    std::lock_guard<std::mutex> lk(mu_);
+    auto& parts = uploads_[upload_id];
+    if (parts.size() != part_ids.size()) {
+      return IOStatus::InvalidArgument("missing parts");
+    }
+    std::string object;
+    for (size_t i = 0; i < parts.size(); i++) {
+      if (part_ids[i] != "part" + std::to_string(i + 1)) {
+        return IOStatus::InvalidArgument("bad part id");
+      }
+      object += parts[i];
+    }
+    objects_[object_path] = object;
+    num_parts_ += parts.size();
+    uploads_.erase(upload_id);
+    return IOStatus::OK();
+  }
+  IOStatus AbortMultipartUpload(const std::string& /*bucket_name*/,
+                                const std::string& /*object_path*/,
+                                const std::string& upload_id) override {
+    std::lock_guard<std::mutex> lk(mu_);
+    num_aborts_++;
+    uploads_.erase(upload_id);
+    return IOStatus::OK();
+  }
+
+  std::mutex mu_;
+  bool fail_parts_ = false;
+  bool fail_puts_ = false;
+  int sst_put_delay_ms_ = 0;
+  // Called before each object is put, outside of mu_.
+  std::function<void(const std::string&)> before_put_;
+  int num_copies_ = 0;
+  std::vector<std::string> put_order_;
+  std::vector<std::string> get_order_;
+  std::vector<std::string> open_order_;
+  std::unordered_map<std::string, std::string> objects_;
+  std::unordered_map<std::string, std::vector<std::string>> uploads_;
+  int num_puts_ = 0;
+  size_t num_parts_ = 0;
+  int num_aborts_ = 0;
+};
+}  // namespace
+
+TEST(CloudFileSystemTest, StreamSstFileWithMultipartUpload) {
+  auto provider = std::make_shared<MemoryStorageProvider>();
+  CloudFileSystemOptions copts;
+  copts.keep_local_sst_files = true;
+  copts.multipart_upload_part_size = 1000;
+  copts.storage_provider = provider;
+  CloudFileSystemImpl cfs(copts, FileSystem::Default(), nullptr);
+  const std::string dir = test::PerThreadDBPath("cloud_fs_multipart");
+  ASSERT_OK(FileSystem::Default()->CreateDirIfMissing(dir, IOOptions(),
+                                                      nullptr));
+
+  auto write_file = [&](const std::string& name, size_t size) {
+    std::string data;
+    for (size_t i = 0; i < size; i++) {
+      data.push_back(static_cast<char>('a' + (i % 26)));
+    }
+    CloudStorageWritableFileImpl file(&cfs, dir + "/" + name, "bucket",
+                                      "db/" + name, FileOptions());
+    EXPECT_OK(file.status());
+    for (size_t pos = 0; pos < size; pos += 700) {
+      EXPECT_OK(file.Append(Slice(data.data() + pos,
+                                  std::min<size_t>(700, size - pos)),
+                            IOOptions(), nullptr));
+    }
+    EXPECT_OK(file.Close(IOOptions(), nullptr));
+    EXPECT_EQ(provider->objects_["db/" + name], data);
+  };
+
+  // 1400 + 1400 + 700 bytes
+  write_file("000010.sst", 3500);
+  ASSERT_EQ(provider->num_parts_, 3);
+  ASSERT_EQ(provider->num_puts_, 0);
+
+  // Smaller than a part.
+  write_file("000011.sst", 500);
+  ASSERT_EQ(provider->num_parts_, 3);
+  ASSERT_EQ(provider->num_puts_, 1);
+
+  // Failed parts fall back to a whole upload.
+  provider->fail_parts_ = true;
+  write_file("000012.sst", 3500);
+  ASSERT_EQ(provider->num_parts_, 3);
+  ASSERT_EQ(provider->num_puts_, 2);
+  ASSERT_EQ(provider->num_aborts_, 1);
+  ASSERT_TRUE(provider->uploads_.empty());
+
+  DestroyDir(Env::Default(), dir).PermitUncheckedError();
+}
+
+TEST(CloudFileSystemTest, DeferredSstUploads) {
+  auto provider = std::make_shared<MemoryStorageProvider>();
+  provider->sst_put_delay_ms_ = 100;
+  CloudFileSystemOptions copts;
+  copts.keep_local_sst_files = true;
+  copts.defer_sst_uploads = true;
+  copts.storage_provider = provider;
+  CloudFileSystemImpl cfs(copts, FileSystem::Default(), nullptr);
+  const std::string dir = test::PerThreadDBPath("cloud_fs_deferred");
+  ASSERT_OK(FileSystem::Default()->CreateDirIfMissing(dir, IOOptions(),
+                                                      nullptr));
+
+  auto write_file = [&](const std::string& name) {
+    CloudStorageWritableFileImpl file(&cfs, dir + "/" + name, "bucket",
+                                      "db/" + name, FileOptions());
+    EXPECT_OK(file.status());
+    EXPECT_OK(file.Append(std::string(100, 'x'), IOOptions(), nullptr));
+    auto s = file.Sync(IOOptions(), nullptr);
+    EXPECT_OK(file.Close(IOOptions(), nullptr));
+    return s;
+  };
+
+  // Close() returns before the upload is done, and the MANIFEST only goes
+  // to the cloud after the SST files queued before its Sync().
+  ASSERT_OK(write_file("000020.sst"));
+  ASSERT_OK(write_file("000021.sst"));
+  ASSERT_OK(write_file("MANIFEST-000001"));
+  ASSERT_EQ(provider->put_order_.size(), 3);
+  ASSERT_EQ(provider->put_order_[2], "db/MANIFEST-000001");
+  ASSERT_OK(cfs.WaitForUploadToDest(dir + "/000021.sst"));
+
+  // A failed upload fails the next MANIFEST Sync().
+  provider->sst_put_delay_ms_ = 0;
+  provider->fail_puts_ = true;
+  ASSERT_OK(write_file("000022.sst"));
+  provider->fail_puts_ = false;
+  ASSERT_NOK(write_file("MANIFEST-000001"));
+  ASSERT_NOK(cfs.WaitForAllUploadsToDest());
+  ASSERT_EQ(provider->put_order_.size(), 3);
+
+  DestroyDir(Env::Default(), dir).PermitUncheckedError();
+}
+
+TEST(CloudFileSystemTest, UploadScheduler) {
+  auto stats = CreateDBStatistics();
+  std::vector<CloudUploadClass> order;
+  {
+    CloudUploadScheduler scheduler(1, stats);
+    // Hold the only slot while the uploads queue up.
+    std::promise<void> started, release;
+    std::thread holder([&]() {
+      ASSERT_OK(scheduler.Run(CloudUploadClass::kFlush, [&]() {
+        started.set_value();
+        release.get_future().wait();
+        // Nested uploads reuse the slot of the thread.
+        return scheduler.Run(CloudUploadClass::kCheckpoint,
+                             []() { return IOStatus::OK(); });
+      }));
+    });
+    started.get_future().wait();
+    auto schedule = [&](CloudUploadClass cls) {
+      scheduler.Schedule(cls, [&order, cls]() { order.push_back(cls); });
+    };
+    schedule(CloudUploadClass::kCheckpoint);
+    for (int i = 0; i < 10; i++) {
+      schedule(CloudUploadClass::kFlush);
+    }
+    schedule(CloudUploadClass::kCompaction);
+    schedule(CloudUploadClass::kL0Compaction);
+    ASSERT_EQ(scheduler.QueueDepth(), 13);
+    release.set_value();
+    holder.join();
+  }
+  ASSERT_EQ(order.size(), 13);
+  // Flushes go first, but do not starve the other classes.
+  auto position = [&](CloudUploadClass cls) {
+    return static_cast<size_t>(std::find(order.begin(), order.end(), cls) -
+                               order.begin());
+  };
+  ASSERT_EQ(order[0], CloudUploadClass::kFlush);
+  ASSERT_LT(position(CloudUploadClass::kCheckpoint), order.size() - 1);
+  ASSERT_LT(position(CloudUploadClass::kL0Compaction),
+            position(CloudUploadClass::kCompaction));
+  ASSERT_LT(position(CloudUploadClass::kCompaction),
+            position(CloudUploadClass::kCheckpoint));
+
+  HistogramData depth;
+  stats->histogramData(CLOUD_UPLOAD_QUEUE_DEPTH, &depth);
+  ASSERT_EQ(depth.count, 14);
+  ASSERT_EQ(depth.max, 13);
+}
+
+TEST(CloudFileSystemTest, ListBoundaries) {
+  auto provider = std::make_shared<MemoryStorageProvider>();
+  CloudFileSystemOptions copts;
+  copts.storage_provider = provider;
+  copts.list_objects_parallelism = 4;
+  CloudFileSystemImpl cfs(copts, FileSystem::Default(), nullptr);
+  // Nothing to split on before the CLOUDMANIFEST knows any file number
+  ASSERT_TRUE(cfs.GetListBoundaries().empty());
+  cfs.TEST_InitEmptyCloudManifest();
+  ASSERT_TRUE(cfs.GetListBoundaries().empty());
+
+  cfs.GetCloudManifest()->AddEpoch(1000, "e1");
+  std::vector<std::string> expected = {"000250.sst", "000500.sst",
+                                       "000750.sst"};
+  ASSERT_EQ(cfs.GetListBoundaries(), expected);
+
+  // Every object is visited once whatever the partitions
+  for (int i = 0; i < 20; i++) {
+    provider->objects_["db/" + MakeTableFileName(i * 100) + "-e1"] = "";
+  }
+  provider->objects_["db/CLOUDMANIFEST"] = "";
+  std::vector<std::string> objects;
+  ASSERT_OK(provider->VisitCloudObjects("bucket", "db",
+                                        cfs.GetListBoundaries(),
+                                        [&](const std::string& name) {
+                                          objects.push_back(name);
+                                          return true;
+                                        }));
+  ASSERT_EQ(objects.size(), 21);
+}
+
+TEST(CloudFileSystemTest, IncrementalPurge) {
+  auto provider = std::make_shared<MemoryStorageProvider>();
+  CloudFileSystemOptions copts;
+  copts.storage_provider = provider;
+  copts.dest_bucket.SetBucketName("bucket");
+  copts.dest_bucket.SetObjectPath("db");
+  copts.run_purger = true;
+  copts.purger_full_listing_periodicity_millis = 60 * 60 * 1000;
+  CloudFileSystemImpl cfs(copts, FileSystem::Default(), nullptr);
+  // See CloudFileSystemImpl::kDbIdRegistry()
+  const std::string registry = "/.rockset/dbid/";
+  provider->objects_[registry + "/db1"] = "";
+
+  // As of the last full listing. 000012.sst is shared with a clone.
+  std::set<std::string> dbids = {"db1"};
+  std::set<std::string> live_files = {"db/000012.sst"};
+
+  for (std::string fname :
+       {"000010.sst-e1", "000011.sst-e1", "000012.sst-e1"}) {
+    provider->objects_["db/" + fname] = "";
+    ASSERT_OK(cfs.DeleteCloudFileFromDest(fname));
+  }
+  // The deletions of 000010.sst and 000012.sst leaked
+  provider->objects_["db/000010.sst-e1"] = "";
+  provider->objects_["db/000012.sst-e1"] = "";
+
+  std::vector<std::string> obsolete;
+  bool needs_full_listing = true;
+  ASSERT_OK(cfs.FindObsoleteCandidates(cfs.GetDestBucketName(), dbids,
+                                       live_files, &obsolete,
+                                       &needs_full_listing));
+  ASSERT_FALSE(needs_full_listing);
+  ASSERT_EQ(obsolete, std::vector<std::string>{"db/000010.sst-e1"});
+
+  // The candidates are checked once
+  obsolete.clear();
+  ASSERT_OK(cfs.FindObsoleteCandidates(cfs.GetDestBucketName(), dbids,
+                                       live_files, &obsolete,
+                                       &needs_full_listing));
+  ASSERT_FALSE(needs_full_listing);
+  ASSERT_TRUE(obsolete.empty());
+
+  // A new DB may use the deleted files
+  provider->objects_["db/000013.sst-e1"] = "";
+  ASSERT_OK(cfs.DeleteCloudFileFromDest("000013.sst-e1"));
+  provider->objects_["db/000013.sst-e1"] = "";
+  provider->objects_[registry + "/db2"] = "";
+  ASSERT_OK(cfs.FindObsoleteCandidates(cfs.GetDestBucketName(), dbids,
+                                       live_files, &obsolete,
+                                       &needs_full_listing));
+  ASSERT_TRUE(needs_full_listing);
+  ASSERT_TRUE(obsolete.empty());
+}
+
+TEST(CloudFileSystemTest, ManifestDeltaUploads) {
+  auto provider = std::make_shared<MemoryStorageProvider>();
+  CloudFileSystemOptions copts;
+  copts.manifest_delta_uploads = true;
+  copts.manifest_max_deltas = 2;
+  copts.storage_provider = provider;
+  CloudFileSystemImpl cfs(copts, FileSystem::Default(), nullptr);
+  const std::string dir = test::PerThreadDBPath("cloud_fs_manifest_deltas");
+  ASSERT_OK(FileSystem::Default()->CreateDirIfMissing(dir, IOOptions(),
+                                                      nullptr));
+  const std::string object = "db/MANIFEST-000001";
+
+  auto read_stitched = [&]() {
+    std::unique_ptr<FSSequentialFile> file;
+    EXPECT_OK(cfs.NewSequentialFileCloud("bucket", object, FileOptions(),
+                                         &file, nullptr));
+    std::string contents;
+    char scratch[100];
+    Slice result;
+    do {
+      EXPECT_OK(file->Read(sizeof(scratch), IOOptions(), &result, scratch,
+                           nullptr));
+      contents.append(result.data(), result.size());
+    } while (!result.empty());
+    return contents;
+  };
+
+  std::string data;
+  CloudStorageWritableFileImpl file(&cfs, dir + "/MANIFEST-000001", "bucket",
+                                    object, FileOptions());
+  ASSERT_OK(file.status());
+  auto append_and_sync = [&](char c) {
+    std::string record(150, c);
+    data += record;
+    EXPECT_OK(file.Append(record, IOOptions(), nullptr));
+    EXPECT_OK(file.Sync(IOOptions(), nullptr));
+  };
+
+  // The first Sync() uploads the whole MANIFEST, the next ones only deltas.
+  append_and_sync('a');
+  ASSERT_EQ(provider->objects_[object], data);
+  append_and_sync('b');
+  append_and_sync('c');
+  ASSERT_EQ(provider->num_puts_, 3);
+  ASSERT_EQ(provider->objects_[object], std::string(150, 'a'));
+  ASSERT_EQ(provider->objects_.size(), 3);
+  ASSERT_EQ(read_stitched(), data);
+
+  // A delta left by an earlier MANIFEST with the same name is ignored.
+  auto stale = MakeManifestDeltaFile(object, data.size(), 0);
+  provider->objects_[stale] = "junk";
+  ASSERT_EQ(read_stitched(), data);
+  provider->objects_.erase(stale);
+
+  auto local = dir + "/MANIFEST-copy";
+  ASSERT_OK(WriteStringToFile(FileSystem::Default().get(),
+                              provider->objects_[object], local));
+  ASSERT_OK(cfs.FetchManifestDeltas("bucket", object, local));
+  std::string fetched;
+  ASSERT_OK(ReadFileToString(FileSystem::Default().get(), local, &fetched));
+  ASSERT_EQ(fetched, data);
+
+  // Past manifest_max_deltas, the whole MANIFEST is uploaded again and the
+  // deltas are deleted.
+  append_and_sync('d');
+  ASSERT_EQ(provider->num_puts_, 4);
+  ASSERT_EQ(provider->objects_[object], data);
+  ASSERT_EQ(provider->objects_.size(), 1);
+  ASSERT_EQ(read_stitched(), data);
+  append_and_sync('e');
+  ASSERT_EQ(read_stitched(), data);
+  ASSERT_OK(file.Close(IOOptions(), nullptr));
+
+  DestroyDir(Env::Default(), dir).PermitUncheckedError();
+}
+
+TEST(CloudFileSystemTest, PrefetchSstFiles) {
+  const std::string src = test::PerThreadDBPath("cloud_fs_prefetch_src");
+  const std::string dir = test::PerThreadDBPath("cloud_fs_prefetch");
+  auto local_fs = FileSystem::Default();
+  DestroyDir(Env::Default(), src).PermitUncheckedError();
+  DestroyDir(Env::Default(), dir).PermitUncheckedError();
+  ASSERT_OK(local_fs->CreateDirIfMissing(dir, IOOptions(), nullptr));
+
+  // A DB with a compacted file and two newer L0 files.
+  {
+    Options options;
+    options.create_if_missing = true;
+    options.disable_auto_compactions = true;
+    DB* db = nullptr;
+    ASSERT_OK(DB::Open(options, src, &db));
+    ASSERT_OK(db->Put(WriteOptions(), "a", "1"));
+    ASSERT_OK(db->Put(WriteOptions(), "b", "1"));
+    ASSERT_OK(db->Flush(FlushOptions()));
+    ASSERT_OK(db->CompactRange(CompactRangeOptions(), nullptr, nullptr));
+    ASSERT_OK(db->Put(WriteOptions(), "c", "1"));
+    ASSERT_OK(db->Flush(FlushOptions()));
+    ASSERT_OK(db->Put(WriteOptions(), "d", "1"));
+    ASSERT_OK(db->Flush(FlushOptions()));
+    delete db;
+  }
+
+  auto provider = std::make_shared<MemoryStorageProvider>();
+  std::vector<std::string> children, ssts;
+  ASSERT_OK(local_fs->GetChildren(src, IOOptions(), &children, nullptr));
+  for (const auto& child : children) {
+    std::string contents;
+    if (IsSstFile(child)) {
+      ASSERT_OK(ReadFileToString(local_fs.get(), src + "/" + child, &contents));
+      provider->objects_["db/" + child] = contents;
+      ssts.push_back(child);
+    } else if (StartsWith(child, "MANIFEST-")) {
+      ASSERT_OK(ReadFileToString(local_fs.get(), src + "/" + child, &contents));
+      ASSERT_OK(WriteStringToFile(local_fs.get(), contents, dir + "/MANIFEST"));
+    }
+  }
+  std::sort(ssts.begin(), ssts.end());
+  ASSERT_EQ(ssts.size(), 3);
+
+  CloudFileSystemOptions copts;
+  copts.dest_bucket.SetBucketName("bucket");
+  copts.dest_bucket.SetObjectPath("db");
+  copts.keep_local_sst_files = true;
+  copts.prefetch_sst_files_on_open = true;
+  copts.prefetch_sst_threads = 1;
+  copts.storage_provider = provider;
+  {
+    CloudFileSystemImpl cfs(copts, local_fs, nullptr);
+    cfs.TEST_DisableCloudManifest();
+    ASSERT_OK(cfs.PrefetchSstFiles(dir));
+    // Opening a file waits for its download.
+    for (const auto& sst : ssts) {
+      std::unique_ptr<FSRandomAccessFile> file;
+      ASSERT_OK(cfs.NewRandomAccessFile(dir + "/" + sst, FileOptions(), &file,
+                                        nullptr));
+    }
+  }
+  for (const auto& sst : ssts) {
+    std::string contents;
+    ASSERT_OK(ReadFileToString(local_fs.get(), dir + "/" + sst, &contents));
+    ASSERT_EQ(contents, provider->objects_["db/" + sst]);
+  }
+  // Each file was downloaded once.
+  ASSERT_EQ(provider->get_order_.size(), 3);
+
+  // The newer L0 files go first when nothing else gets in the way.
+  for (const auto& sst : ssts) {
+    ASSERT_OK(local_fs->DeleteFile(dir + "/" + sst, IOOptions(), nullptr));
+  }
+  provider->get_order_.clear();
+  {
+    CloudFileSystemImpl cfs(copts, local_fs, nullptr);
+    cfs.TEST_DisableCloudManifest();
+    ASSERT_OK(cfs.PrefetchSstFiles(dir));
+    for (int i = 0; i < 1000; i++) {
+      {
+        std::lock_guard<std::mutex> lk(provider->mu_);
+        if (provider->get_order_.size() == 3) {
+          break;
+        }
+      }
+      Env::Default()->SleepForMicroseconds(10000);
+    }
+  }
+  ASSERT_EQ(provider->get_order_.size(), 3);
+  ASSERT_EQ(provider->get_order_[2], "db/" + ssts[0]);
+
+  DestroyDir(Env::Default(), src).PermitUncheckedError();
+  DestroyDir(Env::Default(), dir).PermitUncheckedError();
+}
+
+TEST(CloudFileSystemTest, LazyOpenSstFiles) {
+  const std::string dir = test::PerThreadDBPath("cloud_fs_lazy_open");
+  auto local_fs = FileSystem::Default();
+  DestroyDir(Env::Default(), dir).PermitUncheckedError();
+  ASSERT_OK(local_fs->CreateDirIfMissing(dir, IOOptions(), nullptr));
+  auto provider = std::make_shared<MemoryStorageProvider>();
+  const std::string data(5000, 'x');
+  provider->objects_["db/000010.sst"] = data;
+
+  CloudFileSystemOptions copts;
+  copts.dest_bucket.SetBucketName("bucket");
+  copts.dest_bucket.SetObjectPath("db");
+  copts.keep_local_sst_files = true;
+  copts.lazy_open_sst_files = true;
+  copts.storage_provider = provider;
+  CloudFileSystemImpl cfs(copts, local_fs, nullptr);
+  cfs.TEST_DisableCloudManifest();
+  const std::string fname = dir + "/000010.sst";
+
+  // The first open reads from the cloud and downloads the file meanwhile.
+  std::unique_ptr<FSRandomAccessFile> file;
+  ASSERT_OK(cfs.NewRandomAccessFile(fname, FileOptions(), &file, nullptr));
+  ASSERT_NE(dynamic_cast<StringCloudReadableFile*>(file.get()), nullptr);
+  char scratch[10];
+  Slice result;
+  ASSERT_OK(file->Read(4990, 10, IOOptions(), &result, scratch, nullptr));
+  ASSERT_EQ(result, Slice(data.data() + 4990, 10));
+  for (int i = 0; i < 1000; i++) {
+    if (local_fs->FileExists(fname, IOOptions(), nullptr).ok()) {
+      break;
+    }
+    Env::Default()->SleepForMicroseconds(10000);
+  }
+
+  // The next opens use the local copy.
+  ASSERT_OK(cfs.NewRandomAccessFile(fname, FileOptions(), &file, nullptr));
+  ASSERT_EQ(dynamic_cast<StringCloudReadableFile*>(file.get()), nullptr);
+  ASSERT_OK(file->Read(4990, 10, IOOptions(), &result, scratch, nullptr));
+  ASSERT_EQ(result, Slice(data.data() + 4990, 10));
+  ASSERT_EQ(provider->get_order_.size(), 1);
+
+  DestroyDir(Env::Default(), dir).PermitUncheckedError();
+}
+
+TEST(CloudFileSystemTest, LazyOpenSstFilesAsyncIO) {
+  auto local_fs = FileSystem::Default();
+  CloudFileSystemOptions copts;
+  copts.dest_bucket.SetBucketName("bucket");
+  copts.dest_bucket.SetObjectPath("db");
+  copts.keep_local_sst_files = true;
+  copts.storage_provider = std::make_shared<MemoryStorageProvider>();
+  int64_t base_ops = 0;
+  local_fs->SupportedOps(base_ops);
+  {
+    CloudFileSystemImpl cfs(copts, local_fs, nullptr);
+    int64_t ops = 0;
+    cfs.SupportedOps(ops);
+    ASSERT_EQ(ops, base_ops);
+  }
+
+  // Poll() cannot tell the handles of the files read from the cloud from
+  // the local ones.
+  copts.lazy_open_sst_files = true;
+  CloudFileSystemImpl cfs(copts, local_fs, nullptr);
+  int64_t ops = 0;
+  cfs.SupportedOps(ops);
+  ASSERT_EQ(ops & (1 << FSSupportedOps::kAsyncIO), 0);
+  ASSERT_EQ(ops, base_ops & ~(int64_t{1} << FSSupportedOps::kAsyncIO));
+}
+
+TEST(CloudFileSystemTest, RouteLookupsByEpoch) {
+  const std::string dir = test::PerThreadDBPath("cloud_fs_epoch_routing");
+  auto local_fs = FileSystem::Default();
+  auto provider = std::make_shared<MemoryStorageProvider>();
+  provider->objects_["src/000010.sst-e1"] = "a";
+  provider->objects_["src/000011.sst-e1"] = "b";
+  provider->objects_["db/000012.sst-e1"] = "c";
+  provider->objects_["db/000013.sst-e2"] = "d";
+
+  CloudFileSystemOptions copts;
+  copts.src_bucket.SetBucketName("source");
+  copts.src_bucket.SetObjectPath("src");
+  copts.dest_bucket.SetBucketName("bucket");
+  copts.dest_bucket.SetObjectPath("db");
+  copts.storage_provider = provider;
+  CloudFileSystemImpl cfs(copts, local_fs, nullptr);
+  cfs.TEST_DisableCloudManifest();
+  auto open = [&](const std::string& name) {
+    provider->open_order_.clear();
+    std::unique_ptr<FSRandomAccessFile> file;
+    EXPECT_OK(cfs.NewRandomAccessFile(dir + "/" + name, FileOptions(), &file,
+                                      nullptr));
+    return provider->open_order_;
+  };
+  using Lookups = std::vector<std::string>;
+
+  // The first file of an epoch is looked up in the dest bucket first, the
+  // next ones go straight to the bucket it was found in.
+  ASSERT_EQ(open("000010.sst-e1"),
+            Lookups({"db/000010.sst-e1", "src/000010.sst-e1"}));
+  ASSERT_EQ(open("000011.sst-e1"), Lookups({"src/000011.sst-e1"}));
+  // A file missing from that bucket is still looked up in the other one.
+  ASSERT_EQ(open("000012.sst-e1"),
+            Lookups({"src/000012.sst-e1", "db/000012.sst-e1"}));
+  ASSERT_EQ(open("000013.sst-e2"), Lookups({"db/000013.sst-e2"}));
+}
+
+TEST(CloudFileSystemTest, TieredLocalSstFiles) {
+  const std::string dir = test::PerThreadDBPath("cloud_fs_tiered");
+  auto local_fs = FileSystem::Default();
+  DestroyDir(Env::Default(), dir).PermitUncheckedError();
+  ASSERT_OK(local_fs->CreateDirIfMissing(dir, IOOptions(), nullptr));
+  auto provider = std::make_shared<MemoryStorageProvider>();
+  provider->objects_["db/000010.sst"] = std::string(5000, 'x');
+  provider->objects_["db/000011.sst"] = std::string(5000, 'y');
+  // The local copy of a file that was in L0.
+  ASSERT_OK(WriteStringToFile(local_fs.get(), std::string(5000, 'y'),
+                              dir + "/000011.sst"));
+
+  CloudFileSystemOptions copts;
+  copts.dest_bucket.SetBucketName("bucket");
+  copts.dest_bucket.SetObjectPath("db");
+  copts.local_sst_max_level = 1;
+  copts.local_sst_temperature = Temperature::kHot;
+  copts.prefetch_sst_threads = 1;
+  copts.storage_provider = provider;
+  ASSERT_TRUE(copts.TiersLocalSstFiles());
+  CloudFileSystemImpl cfs(copts, local_fs, nullptr);
+  cfs.TEST_DisableCloudManifest();
+
+  auto live_file = [](uint64_t number, int level,
+                      Temperature temperature = Temperature::kUnknown) {
+    LiveFileMetaData f;
+    f.file_number = number;
+    f.level = level;
+    f.temperature = temperature;
+    return f;
+  };
+  auto wait_for_local = [&](const std::string& fname) {
+    for (int i = 0; i < 1000; i++) {
+      if (local_fs->FileExists(fname, IOOptions(), nullptr).ok()) {
+        break;
+      }
+      Env::Default()->SleepForMicroseconds(10000);
+    }
+  };
+  auto is_local = [&](const std::string& fname) {
+    std::unique_ptr<FSRandomAccessFile> file;
+    EXPECT_OK(cfs.NewRandomAccessFile(fname, FileOptions(), &file, nullptr));
+    return dynamic_cast<StringCloudReadableFile*>(file.get()) == nullptr;
+  };
+  const std::string f10 = dir + "/000010.sst";
+  const std::string f11 = dir + "/000011.sst";
+
+  // L0 is downloaded, and L3 is read from the cloud.
+  cfs.UpdateLocalSstFiles(dir, {live_file(10, 0), live_file(11, 3)});
+  ASSERT_TRUE(local_fs->FileExists(f11, IOOptions(), nullptr).IsNotFound());
+  wait_for_local(f10);
+  ASSERT_TRUE(is_local(f10));
+  ASSERT_FALSE(is_local(f11));
+
+  // Files moved to a lower level are dropped, hot files are kept
+  cfs.UpdateLocalSstFiles(
+      dir, {live_file(10, 2), live_file(11, 3, Temperature::kHot)});
+  ASSERT_TRUE(local_fs->FileExists(f10, IOOptions(), nullptr).IsNotFound());
+  wait_for_local(f11);
+  ASSERT_FALSE(is_local(f10));
+  ASSERT_TRUE(is_local(f11));
+  ASSERT_EQ(provider->get_order_.size(), 2);
+
+  // Nothing to do when no file moved
+  cfs.UpdateLocalSstFiles(
+      dir, {live_file(10, 2), live_file(11, 3, Temperature::kHot)});
+  ASSERT_EQ(provider->get_order_.size(), 2);
+
+  DestroyDir(Env::Default(), dir).PermitUncheckedError();
+}
+
+TEST(CloudFileSystemTest, LocalSstBudget) {
+  const std::string dir = test::PerThreadDBPath("cloud_fs_local_sst_budget");
+  auto local_fs = FileSystem::Default();
+  DestroyDir(Env::Default(), dir).PermitUncheckedError();
+  ASSERT_OK(local_fs->CreateDirIfMissing(dir, IOOptions(), nullptr));
+  auto provider = std::make_shared<MemoryStorageProvider>();
+  for (const auto* object : {"db/000010.sst", "db/000011.sst",
+                             "db/000012.sst"}) {
+    provider->objects_[object] = std::string(1000, 'x');
+  }
+
+  CloudFileSystemOptions copts;
+  copts.dest_bucket.SetBucketName("bucket");
+  copts.dest_bucket.SetObjectPath("db");
+  copts.keep_local_sst_files = true;
+  copts.validate_filesize = false;
+  copts.local_sst_budget_bytes = 2500;
+  copts.storage_provider = provider;
+  CloudFileSystemImpl cfs(copts, local_fs, nullptr);
+  cfs.TEST_DisableCloudManifest();
+
+  auto open = [&](const std::string& fname) {
+    std::unique_ptr<FSRandomAccessFile> file;
+    ASSERT_OK(cfs.NewRandomAccessFile(fname, FileOptions(), &file, nullptr));
+  };
+  auto is_local = [&](const std::string& fname) {
+    return local_fs->FileExists(fname, IOOptions(), nullptr).ok();
+  };
+  const std::string f10 = dir + "/000010.sst";
+  const std::string f11 = dir + "/000011.sst";
+  const std::string f12 = dir + "/000012.sst";
+
+  // The third download evicts the copy opened least recently.
+  open(f10);
+  open(f11);
+  open(f12);
+  ASSERT_FALSE(is_local(f10));
+  ASSERT_TRUE(is_local(f11));
+  ASSERT_TRUE(is_local(f12));
+  ASSERT_EQ(provider->get_order_.size(), 3);
+
+  // An evicted file is downloaded again when it is opened, and the local
+  // copies that were opened since stay.
+  open(f11);
+  open(f10);
+  ASSERT_TRUE(is_local(f10));
+  ASSERT_TRUE(is_local(f11));
+  ASSERT_FALSE(is_local(f12));
+  ASSERT_EQ(provider->get_order_.size(), 4);
+
+  // A deleted file no longer counts against the budget.
+  ASSERT_OK(cfs.DeleteFile(f10, IOOptions(), nullptr));
+  open(f12);
+  ASSERT_TRUE(is_local(f11));
+  ASSERT_TRUE(is_local(f12));
+
+  DestroyDir(Env::Default(), dir).PermitUncheckedError();
+}
+
+TEST(CloudFileSystemTest, LocalSstBudgetWithUploadInFlight) {
+  const std::string dir =
+      test::PerThreadDBPath("cloud_fs_local_sst_budget_upload");
+  auto local_fs = FileSystem::Default();
+  DestroyDir(Env::Default(), dir).PermitUncheckedError();
+  ASSERT_OK(local_fs->CreateDirIfMissing(dir, IOOptions(), nullptr));
+  auto provider = std::make_shared<MemoryStorageProvider>();
+  for (const auto* object : {"db/000010.sst", "db/000011.sst",
+                             "db/000012.sst"}) {
+    provider->objects_[object] = std::string(1000, 'x');
+  }
+  // Holds the upload of 000013.sst until released.
+  std::promise<void> put_started;
+  std::promise<void> release_put;
+  auto released = release_put.get_future().share();
+  provider->before_put_ = [&](const std::string& object_path) {
+    if (object_path == "db/000013.sst") {
+      put_started.set_value();
+      released.wait();
+    }
+  };
+
+  CloudFileSystemOptions copts;
+  copts.dest_bucket.SetBucketName("bucket");
+  copts.dest_bucket.SetObjectPath("db");
+  copts.keep_local_sst_files = true;
+  copts.validate_filesize = false;
+  copts.local_sst_budget_bytes = 2500;
+  copts.storage_provider = provider;
+  CloudFileSystemImpl cfs(copts, local_fs, nullptr);
+  cfs.TEST_DisableCloudManifest();
+
+  auto open = [&](const std::string& fname) {
+    std::unique_ptr<FSRandomAccessFile> file;
+    ASSERT_OK(cfs.NewRandomAccessFile(fname, FileOptions(), &file, nullptr));
+  };
+  auto is_local = [&](const std::string& fname) {
+    return local_fs->FileExists(fname, IOOptions(), nullptr).ok();
+  };
+  const std::string f10 = dir + "/000010.sst";
+  const std::string f11 = dir + "/000011.sst";
+  const std::string f12 = dir + "/000012.sst";
+  const std::string f13 = dir + "/000013.sst";
+
+  // A file written by the DB, whose upload is not done.
+  ASSERT_OK(WriteStringToFile(local_fs.get(), std::string(1000, 'z'), f13));
+  std::thread upload([&]() {
+    EXPECT_OK(cfs.CopyLocalFileToDest(f13, "db/000013.sst"));
+  });
+  put_started.get_future().wait();
+
+  // The file is opened, then the downloads go beyond the budget. Its only
+  // copy is local, so it is not evicted.
+  open(f13);
+  open(f10);
+  open(f11);
+  open(f12);
+  ASSERT_TRUE(is_local(f13));
+  ASSERT_FALSE(is_local(f10));
+  ASSERT_TRUE(is_local(f11));
+  ASSERT_TRUE(is_local(f12));
+
+  // Once uploaded, it counts against the budget.
+  release_put.set_value();
+  upload.join();
+  ASSERT_EQ(provider->objects_["db/000013.sst"], std::string(1000, 'z'));
+  ASSERT_TRUE(is_local(f13));
+  ASSERT_FALSE(is_local(f11));
+  ASSERT_TRUE(is_local(f12));
+
+  DestroyDir(Env::Default(), dir).PermitUncheckedError();
+}
+
+TEST(CloudFileSystemTest, IngestCloudObject) {
+  const std::string dir = test::PerThreadDBPath("cloud_fs_ingest_object");
+  auto local_fs = FileSystem::Default();
+  DestroyDir(Env::Default(), dir).PermitUncheckedError();
+  ASSERT_OK(local_fs->CreateDirIfMissing(dir, IOOptions(), nullptr));
+  auto provider = std::make_shared<MemoryStorageProvider>();
+  const std::string data(5000, 'x');
+  provider->objects_["bulk/000001.sst"] = data;
+
+  CloudFileSystemOptions copts;
+  copts.dest_bucket.SetBucketName("bucket");
+  copts.dest_bucket.SetObjectPath("db");
+  copts.storage_provider = provider;
+  CloudFileSystemImpl cfs(copts, local_fs, nullptr);
+  cfs.TEST_DisableCloudManifest();
+
+  const std::string external = "cloud://pipeline/bulk/000001.sst";
+  const std::string internal = dir + "/000012.sst";
+  ASSERT_OK(cfs.FileExists(external, IOOptions(), nullptr));
+  ASSERT_TRUE(cfs.FileExists("cloud://pipeline/bulk/000002.sst", IOOptions(),
+                             nullptr)
+                  .IsNotFound());
+  uint64_t size = 0;
+  ASSERT_OK(cfs.GetFileSize(external, IOOptions(), &size, nullptr));
+  ASSERT_EQ(size, data.size());
+
+  // The object is read remotely
+  std::unique_ptr<FSRandomAccessFile> file;
+  ASSERT_OK(cfs.NewRandomAccessFile(external, FileOptions(), &file, nullptr));
+  ASSERT_NE(dynamic_cast<StringCloudReadableFile*>(file.get()), nullptr);
+  ASSERT_EQ(provider->get_order_.size(), 0);
+
+  // and copied into the destination bucket, without a local file to sync
+  ASSERT_OK(cfs.LinkFile(external, internal, IOOptions(), nullptr));
+  ASSERT_EQ(provider->num_copies_, 1);
+  ASSERT_EQ(provider->objects_["db/000012.sst"], data);
+  std::unique_ptr<FSWritableFile> writable;
+  ASSERT_TRUE(cfs.ReopenWritableFile(internal, FileOptions(), &writable,
+                                     nullptr)
+                  .IsNotSupported());
+  ASSERT_TRUE(local_fs->FileExists(internal, IOOptions(), nullptr)
+                  .IsNotFound());
+
+  // Once ingested, the external object is deleted
+  ASSERT_OK(cfs.DeleteFile(external, IOOptions(), nullptr));
+  ASSERT_EQ(provider->objects_.count("bulk/000001.sst"), 0);
+  ASSERT_EQ(provider->objects_["db/000012.sst"], data);
+  ASSERT_EQ(provider->get_order_.size(), 0);
+
+  DestroyDir(Env::Default(), dir).PermitUncheckedError();
+}
+
+TEST(CloudFileSystemTest, StatsSnapshots) {
+  auto stats = CreateDBStatistics();
+  auto cloud_stats = CreateDBStatistics();
+  stats->recordTick(NUMBER_KEYS_WRITTEN, 10);
+  stats->recordTick(CLOUD_READ_REQUESTS, 99);
+  stats->reportTimeToHistogram(DB_GET, 20);
+  cloud_stats->recordTick(CLOUD_READ_REQUESTS, 3);
+  cloud_stats->recordTick(NUMBER_KEYS_WRITTEN, 99);
+
+  // The cloud stats come from the cloud statistics, the others from the DB
+  // statistics, and the zero ones are left out.
+  CloudStatsSnapshot snapshot;
+  snapshot.instance = "host-1";
+  snapshot.timestamp_micros = 2000000;
+  TakeCloudStatsSnapshot(stats.get(), cloud_stats.get(), &snapshot);
+  ASSERT_EQ(snapshot.stats["rocksdb.number.keys.written"], 10);
+  ASSERT_EQ(snapshot.stats["rocksdb.cloud.read.requests"], 3);
+  ASSERT_EQ(snapshot.stats["rocksdb.db.get.micros.count"], 1);
+  ASSERT_EQ(snapshot.stats["rocksdb.db.get.micros.sum"], 20);
+  ASSERT_EQ(snapshot.stats.count("rocksdb.number.keys.read"), 0);
+  ASSERT_EQ(CloudStatsSnapshotObjectName(snapshot),
+            "STATS_HISTORY/host-1/00000000000002000000");
+
+  std::string data;
+  EncodeCloudStatsSnapshot(snapshot, &data);
+  CloudStatsSnapshot decoded;
+  ASSERT_OK(DecodeCloudStatsSnapshot(data, &decoded));
+  ASSERT_EQ(decoded.instance, snapshot.instance);
+  ASSERT_EQ(decoded.timestamp_micros, snapshot.timestamp_micros);
+  ASSERT_EQ(decoded.stats, snapshot.stats);
+
+  std::string corrupted = data;
+  corrupted[corrupted.size() / 2] ^= 1;
+  ASSERT_TRUE(DecodeCloudStatsSnapshot(corrupted, &decoded).IsCorruption());
+  ASSERT_TRUE(
+      DecodeCloudStatsSnapshot(Slice(data.data(), data.size() - 1), &decoded)
+          .IsCorruption());
+
+  // The snapshots of each instance are merged in time order, with the zeros
+  // left out of a snapshot put back.
+  CloudStatsSnapshot later;
+  later.instance = "host-1";
+  later.timestamp_micros = 3000000;
+  later.stats["rocksdb.cloud.read.requests"] = 5;
+  CloudStatsSnapshot other;
+  other.instance = "host-2";
+  other.timestamp_micros = 1000000;
+  other.stats["rocksdb.number.keys.written"] = 7;
+  std::map<std::string, std::map<std::string, CloudStatsSeries>> series;
+  MergeCloudStatsSnapshots({later, other, decoded}, &series);
+  ASSERT_EQ(series.size(), 2);
+  auto& host1 = series["host-1"];
+  ASSERT_EQ(host1.size(), snapshot.stats.size());
+  ASSERT_EQ(host1["rocksdb.cloud.read.requests"],
+            CloudStatsSeries({{2000000, 3}, {3000000, 5}}));
+  ASSERT_EQ(host1["rocksdb.number.keys.written"],
+            CloudStatsSeries({{2000000, 10}, {3000000, 0}}));
+  ASSERT_EQ(series["host-2"]["rocksdb.number.keys.written"],
+            CloudStatsSeries({{1000000, 7}}));
+}
+
+TEST(CloudFileSystemTest, RecordCloudRequestStats) {
+  auto stats = CreateDBStatistics();
+  SetPerfLevel(PerfLevel::kEnableTimeExceptForMutex);
+  get_perf_context()->Reset();
+
+  RecordCloudRequest(stats.get(), CloudRequestOpType::kReadOp, 100, 5, true);
+  RecordCloudRequest(stats.get(), CloudRequestOpType::kReadOp, 0, 7, false);
+  RecordCloudRequest(stats.get(), CloudRequestOpType::kWriteOp, 200, 3, true);
+  RecordCloudRequest(stats.get(), CloudRequestOpType::kListOp, 0, 1, true);
+  RecordCloudRequestRetry(stats.get(), false);
+  RecordCloudRequestRetry(stats.get(), true);
+  // Without statistics, only the perf context counts the request.
+  RecordCloudRequest(nullptr, CloudRequestOpType::kCopyOp, 0, 2, true);
+  RecordCloudRequestRetry(nullptr, true);
+
+  ASSERT_EQ(stats->getTickerCount(CLOUD_READ_REQUESTS), 2);
+  ASSERT_EQ(stats->getTickerCount(CLOUD_WRITE_REQUESTS), 1);
+  ASSERT_EQ(stats->getTickerCount(CLOUD_LIST_REQUESTS), 1);
+  ASSERT_EQ(stats->getTickerCount(CLOUD_COPY_REQUESTS), 0);
+  ASSERT_EQ(stats->getTickerCount(CLOUD_REQUEST_FAILURES), 1);
+  ASSERT_EQ(stats->getTickerCount(CLOUD_BYTES_READ), 100);
+  ASSERT_EQ(stats->getTickerCount(CLOUD_BYTES_WRITTEN), 200);
+  ASSERT_EQ(stats->getTickerCount(CLOUD_REQUEST_RETRIES), 2);
+  ASSERT_EQ(stats->getTickerCount(CLOUD_REQUEST_THROTTLES), 1);
+
+  HistogramData hist;
+  stats->histogramData(CLOUD_READ_MICROS, &hist);
+  ASSERT_EQ(hist.count, 2);
+  ASSERT_EQ(hist.sum, 12);
+  stats->histogramData(CLOUD_WRITE_MICROS, &hist);
+  ASSERT_EQ(hist.count, 1);
+  stats->histogramData(CLOUD_COPY_MICROS, &hist);
+  ASSERT_EQ(hist.count, 0);
+
+  auto* perf = get_perf_context();
+  ASSERT_EQ(perf->cloud_request_count, 5);
+  ASSERT_EQ(perf->cloud_read_byte, 100);
+  ASSERT_EQ(perf->cloud_write_byte, 200);
+  ASSERT_EQ(perf->cloud_request_nanos, 18000);
+  SetPerfLevel(PerfLevel::kDisable);
+}
+
 TEST(CloudFileSystemTest, ConfigureEnv) {
   std::unique_ptr<CloudFileSystem> cfs;
 
@@ -199,6 +1774,24 @@ TEST(CloudFileSystemTest, ConfigureS3Provider) {
 #endif
 }
 
+TEST(CloudFileSystemTest, ConfigureS3CrtProvider) {
+  std::unique_ptr<CloudFileSystem> cfs;
+
+  ConfigOptions config_options;
+  Status s = CloudFileSystemEnv::CreateFromString(
+      config_options, "id=aws; provider=s3-crt", &cfs);
+#ifdef USE_AWS_CRT
+  ASSERT_OK(s);
+  ASSERT_STREQ(cfs->Name(), "aws");
+  ASSERT_NE(cfs->GetStorageProvider(), nullptr);
+  ASSERT_STREQ(cfs->GetStorageProvider()->Name(),
+               CloudStorageProviderImpl::kS3Crt());
+#else
+  ASSERT_NOK(s);
+  ASSERT_EQ(cfs, nullptr);
+#endif
+}
+
 // Test is disabled until we have a mock provider and authentication issues are
 // resolved
 TEST(CloudFileSystemTest, DISABLED_ConfigureKinesisController) {
@@ -238,6 +1831,494 @@ TEST(CloudFileSystemTest, ConfigureKafkaController) {
 #endif
 }
 
+namespace {
+// Creates a cloud file system on a simulated storage provider, with a
+// destination bucket if with_dest and the given cloud file system options.
+SimulatedStorageProvider* NewSimulatedCloudFileSystem(
+    const std::string& provider_options, std::unique_ptr<CloudFileSystem>* cfs,
+    bool with_dest = true, const std::string& cfs_options = "") {
+  ConfigOptions config_options;
+  EXPECT_OK(CloudFileSystemEnv::CreateFromString(
+      config_options,
+      std::string("id=cloud; keep_local_log_files=true; ") +
+          (with_dest ? "dest.bucket=simulated; dest.object=/db; " : "") +
+          cfs_options +
+          "provider={id=simulated;" + provider_options + "}",
+      cfs));
+  if (*cfs == nullptr) {
+    return nullptr;
+  }
+  return dynamic_cast<SimulatedStorageProvider*>(
+      (*cfs)->GetStorageProvider().get());
+}
+}  // namespace
+
+TEST(CloudFileSystemTest, SimulatedStorageProvider) {
+  std::unique_ptr<CloudFileSystem> cfs;
+  auto provider = NewSimulatedCloudFileSystem(
+      "read_latency_micros=2000; upload_bytes_per_sec=1000000", &cfs);
+  ASSERT_NE(provider, nullptr);
+  ASSERT_STREQ(provider->Name(), CloudStorageProviderImpl::kSimulated());
+  const auto bucket = cfs->GetDestBucketName();
+  ASSERT_OK(provider->ExistsBucket(bucket));
+  ASSERT_TRUE(provider->ExistsBucket("missing").IsNotFound());
+
+  const auto fs = FileSystem::Default();
+  const std::string dir = test::PerThreadDBPath("simulated_provider");
+  ASSERT_OK(fs->CreateDirIfMissing(dir, IOOptions(), nullptr));
+  std::string data(100000, 'x');
+  for (size_t i = 0; i < data.size(); i += 7) {
+    data[i] = static_cast<char>('a' + (i % 26));
+  }
+  ASSERT_OK(WriteStringToFile(fs.get(), data, dir + "/local"));
+
+  // 100KB at 1MB/s
+  auto start = std::chrono::steady_clock::now();
+  ASSERT_OK(provider->PutCloudObject(dir + "/local", bucket, "db/a.sst"));
+  ASSERT_GE(std::chrono::steady_clock::now() - start,
+            std::chrono::milliseconds(100));
+  ASSERT_OK(provider->CopyCloudObject(bucket, "db/a.sst", bucket, "db/b.sst"));
+
+  std::vector<std::string> names;
+  ASSERT_OK(provider->ListCloudObjects(bucket, "db", &names));
+  ASSERT_EQ(names, std::vector<std::string>({"a.sst", "b.sst"}));
+  uint64_t size = 0;
+  ASSERT_OK(provider->GetCloudObjectSize(bucket, "db/b.sst", &size));
+  ASSERT_EQ(size, data.size());
+
+  std::unique_ptr<CloudStorageReadableFile> file;
+  ASSERT_OK(provider->NewCloudReadableFile(bucket, "db/b.sst", FileOptions(),
+                                           &file, nullptr));
+  std::string scratch(1000, '\0');
+  Slice result;
+  start = std::chrono::steady_clock::now();
+  ASSERT_OK(static_cast<FSRandomAccessFile*>(file.get())
+                ->Read(5000, scratch.size(), IOOptions(), &result,
+                       &scratch[0], nullptr));
+  ASSERT_GE(std::chrono::steady_clock::now() - start,
+            std::chrono::milliseconds(2));
+  ASSERT_EQ(result.ToString(), data.substr(5000, 1000));
+
+  ASSERT_OK(provider->GetCloudObject(bucket, "db/a.sst", dir + "/copy"));
+  std::string copy;
+  ASSERT_OK(ReadFileToString(fs.get(), dir + "/copy", &copy));
+  ASSERT_EQ(copy, data);
+
+  ASSERT_TRUE(provider->DeleteCloudObject(bucket, "db/c.sst").IsNotFound());
+  ASSERT_OK(provider->DeleteCloudObjects(bucket, {"db/a.sst", "db/c.sst"}));
+  ASSERT_TRUE(provider->ExistsCloudObject(bucket, "db/a.sst").IsNotFound());
+  ASSERT_OK(provider->ExistsCloudObject(bucket, "db/b.sst"));
+
+  auto stats = provider->GetStats();
+  ASSERT_EQ(stats.write_requests, 1);
+  ASSERT_EQ(stats.copy_requests, 1);
+  ASSERT_EQ(stats.bytes_written, data.size());
+  ASSERT_EQ(stats.read_requests, 2);
+  ASSERT_EQ(stats.bytes_read, data.size() + 1000);
+  ASSERT_EQ(stats.delete_requests, 2);
+  ASSERT_GT(stats.cost, 0);
+  provider->ResetStats();
+  ASSERT_EQ(provider->GetStats().read_requests, 0);
+}
+
+TEST(CloudFileSystemTest, SimulatedStorageThrottling) {
+  std::unique_ptr<CloudFileSystem> cfs;
+  auto provider = NewSimulatedCloudFileSystem(
+      "throttle_probability=1; throttle_max_retries=2; "
+      "throttle_backoff_micros=10",
+      &cfs, false /*with_dest*/);
+  ASSERT_NE(provider, nullptr);
+  // The first attempt and two retries
+  ASSERT_TRUE(provider->ExistsCloudObject("bucket", "db/a").IsBusy());
+  ASSERT_EQ(provider->GetStats().throttled_requests, 3);
+  ASSERT_EQ(provider->GetStats().info_requests, 0);
+}
+
+TEST(CloudFileSystemTest, ObjectMetadataCache) {
+  std::unique_ptr<CloudFileSystem> cfs;
+  auto provider = NewSimulatedCloudFileSystem(
+      "", &cfs, true /*with_dest*/, "object_metadata_cache_entries=2; ");
+  ASSERT_NE(provider, nullptr);
+  const auto bucket = cfs->GetDestBucketName();
+  const auto fs = FileSystem::Default();
+  const std::string dir = test::PerThreadDBPath("metadata_cache");
+  ASSERT_OK(fs->CreateDirIfMissing(dir, IOOptions(), nullptr));
+  ASSERT_OK(WriteStringToFile(fs.get(), "data", dir + "/local"));
+
+  // The upload records the size of the object
+  ASSERT_OK(provider->PutCloudObject(dir + "/local", bucket, "db/a.sst"));
+  uint64_t size = 0;
+  ASSERT_OK(provider->GetCloudObjectSize(bucket, "db/a.sst", &size));
+  ASSERT_EQ(size, 4);
+  ASSERT_OK(provider->ExistsCloudObject(bucket, "db/a.sst"));
+  ASSERT_EQ(provider->GetStats().info_requests, 0);
+
+  // Opening the object needs its content hash
+  std::unique_ptr<CloudStorageReadableFile> file;
+  ASSERT_OK(provider->NewCloudReadableFile(bucket, "db/a.sst", FileOptions(),
+                                           &file, nullptr));
+  ASSERT_OK(provider->NewCloudReadableFile(bucket, "db/a.sst", FileOptions(),
+                                           &file, nullptr));
+  uint64_t time = 0;
+  ASSERT_OK(provider->GetCloudObjectModificationTime(bucket, "db/a.sst",
+                                                     &time));
+  ASSERT_EQ(provider->GetStats().info_requests, 1);
+
+  // Listings fill the cache, which keeps the 2 most recently used objects
+  ASSERT_OK(provider->CopyCloudObject(bucket, "db/a.sst", bucket, "db/b.sst"));
+  ASSERT_OK(provider->CopyCloudObject(bucket, "db/a.sst", bucket, "db/c.sst"));
+  std::vector<std::string> names;
+  ASSERT_OK(provider->ListCloudObjects(bucket, "db", &names));
+  ASSERT_EQ(names.size(), 3);
+  ASSERT_OK(provider->NewCloudReadableFile(bucket, "db/b.sst", FileOptions(),
+                                           &file, nullptr));
+  ASSERT_OK(provider->GetCloudObjectSize(bucket, "db/c.sst", &size));
+  ASSERT_EQ(provider->GetStats().info_requests, 1);
+  ASSERT_OK(provider->GetCloudObjectSize(bucket, "db/a.sst", &size));
+  ASSERT_EQ(provider->GetStats().info_requests, 2);
+
+  // Deleted objects are dropped from the cache
+  ASSERT_OK(provider->DeleteCloudObject(bucket, "db/a.sst"));
+  ASSERT_TRUE(provider->ExistsCloudObject(bucket, "db/a.sst").IsNotFound());
+  ASSERT_EQ(provider->GetStats().info_requests, 3);
+
+  // Only SST objects are cached
+  ASSERT_OK(provider->PutCloudObject(dir + "/local", bucket, "db/IDENTITY"));
+  ASSERT_OK(provider->GetCloudObjectSize(bucket, "db/IDENTITY", &size));
+  ASSERT_OK(provider->GetCloudObjectSize(bucket, "db/IDENTITY", &size));
+  ASSERT_EQ(provider->GetStats().info_requests, 5);
+}
+
+TEST(CloudFileSystemTest, SstUploadChecksums) {
+  std::unique_ptr<CloudFileSystem> cfs;
+  auto provider = NewSimulatedCloudFileSystem(
+      "", &cfs, true /*with_dest*/, "sst_upload_checksums=true; ");
+  ASSERT_NE(provider, nullptr);
+  const auto bucket = cfs->GetDestBucketName();
+  const auto fs = FileSystem::Default();
+  const std::string dir = test::PerThreadDBPath("sst_upload_checksums");
+  ASSERT_OK(fs->CreateDirIfMissing(dir, IOOptions(), nullptr));
+
+  // The checksum is extended with the data, or combined with the handoff
+  // checksum of the data when RocksDB passes one.
+  const std::string first(5000, 'a'), second = "some more data";
+  {
+    CloudStorageWritableFileImpl file(cfs.get(), dir + "/000010.sst", bucket,
+                                      "db/000010.sst", FileOptions());
+    ASSERT_OK(file.status());
+    ASSERT_OK(file.Append(first, IOOptions(), nullptr));
+    char handoff[sizeof(uint32_t)];
+    EncodeFixed32(handoff, crc32c::Value(second.data(), second.size()));
+    DataVerificationInfo verification_info;
+    verification_info.checksum = Slice(handoff, sizeof(handoff));
+    ASSERT_OK(file.Append(second, IOOptions(), verification_info, nullptr));
+    ASSERT_OK(file.Close(IOOptions(), nullptr));
+  }
+
+  // The object keeps the checksum the DB records for the file.
+  FileChecksumGenCrc32c gen{FileChecksumGenContext()};
+  gen.Update(first.data(), first.size());
+  gen.Update(second.data(), second.size());
+  gen.Finalize();
+  CloudObjectInformation info;
+  ASSERT_OK(provider->GetCloudObjectMetadata(bucket, "db/000010.sst", &info));
+  ASSERT_EQ(info.size, first.size() + second.size());
+  ASSERT_EQ(info.crc32c, gen.GetChecksum());
+
+  // An upload whose checksum does not match is rejected.
+  ASSERT_OK(WriteStringToFile(fs.get(), "data", dir + "/local"));
+  ASSERT_NOK(provider->PutCloudObjectWithChecksum(
+      dir + "/local", bucket, "db/000011.sst", std::string(4, '\0')));
+  ASSERT_TRUE(provider->ExistsCloudObject(bucket, "db/000011.sst")
+                  .IsNotFound());
+  ASSERT_OK(provider->PutCloudObject(dir + "/local", bucket, "db/000011.sst"));
+  ASSERT_OK(provider->GetCloudObjectMetadata(bucket, "db/000011.sst", &info));
+  ASSERT_TRUE(info.crc32c.empty());
+
+  DestroyDir(Env::Default(), dir).PermitUncheckedError();
+}
+
+TEST(CloudFileSystemTest, ParallelDownload) {
+  std::unique_ptr<CloudFileSystem> cfs;
+  auto provider = NewSimulatedCloudFileSystem(
+      "", &cfs, true /*with_dest*/, "parallel_download_part_size=1000; ");
+  ASSERT_NE(provider, nullptr);
+  const auto bucket = cfs->GetDestBucketName();
+  const auto fs = FileSystem::Default();
+  const std::string dir = test::PerThreadDBPath("parallel_download");
+  ASSERT_OK(fs->CreateDirIfMissing(dir, IOOptions(), nullptr));
+
+  Random rnd(301);
+  const std::string data = rnd.RandomString(10500);
+  ASSERT_OK(WriteStringToFile(fs.get(), data, dir + "/local"));
+  FileChecksumGenCrc32c gen{FileChecksumGenContext()};
+  gen.Update(data.data(), data.size());
+  gen.Finalize();
+  ASSERT_OK(provider->PutCloudObjectWithChecksum(
+      dir + "/local", bucket, "db/000010.sst", gen.GetChecksum()));
+  ASSERT_OK(provider->PutCloudObject(dir + "/local", bucket, "db/000011.sst"));
+  ASSERT_OK(provider->PutCloudObject(dir + "/local", bucket, "db/MANIFEST"));
+
+  // An SST object is read in parts, checked against its checksum if it has
+  // one.
+  for (const auto* object : {"db/000010.sst", "db/000011.sst"}) {
+    auto reads = provider->GetStats().read_requests;
+    ASSERT_OK(provider->GetCloudObject(bucket, object, dir + "/copy"));
+    ASSERT_EQ(provider->GetStats().read_requests, reads + 11);
+    std::string copy;
+    ASSERT_OK(ReadFileToString(fs.get(), dir + "/copy", &copy));
+    ASSERT_EQ(copy, data);
+  }
+
+  // The other objects are read with a single GET.
+  auto reads = provider->GetStats().read_requests;
+  ASSERT_OK(provider->GetCloudObject(bucket, "db/MANIFEST", dir + "/copy"));
+  ASSERT_EQ(provider->GetStats().read_requests, reads + 1);
+  ASSERT_TRUE(provider->GetCloudObject(bucket, "db/000012.sst", dir + "/copy")
+                  .IsNotFound());
+
+  DestroyDir(Env::Default(), dir).PermitUncheckedError();
+}
+
+namespace {
+// A log controller whose records are applied by the test instead of being
+// tailed from a stream.
+class TestLogController : public CloudLogControllerImpl {
+ public:
+  const char* Name() const override { return "test"; }
+  IOStatus CreateStream(const std::string& /*topic*/) override {
+    return IOStatus::OK();
+  }
+  IOStatus WaitForStreamReady(const std::string& /*topic*/) override {
+    return IOStatus::OK();
+  }
+  IOStatus TailStream() override { return IOStatus::OK(); }
+  CloudLogWritableFile* CreateWritableFile(const std::string& /*fname*/,
+                                           const FileOptions& /*options*/,
+                                           IODebugContext* /*dbg*/) override {
+    return nullptr;
+  }
+  using CloudLogControllerImpl::Apply;
+};
+}  // namespace
+
+TEST(CloudFileSystemTest, SharedInflightDownloads) {
+  std::unique_ptr<CloudFileSystem> cfs;
+  auto provider =
+      NewSimulatedCloudFileSystem("read_latency_micros=200000", &cfs);
+  ASSERT_NE(provider, nullptr);
+  const auto bucket = cfs->GetDestBucketName();
+  const auto fs = FileSystem::Default();
+  const std::string dir = test::PerThreadDBPath("shared_downloads");
+  ASSERT_OK(fs->CreateDirIfMissing(dir, IOOptions(), nullptr));
+  const std::string data(1000, 'x');
+  ASSERT_OK(WriteStringToFile(fs.get(), data, dir + "/local"));
+  ASSERT_OK(provider->PutCloudObject(dir + "/local", bucket, "db/MANIFEST"));
+
+  // The concurrent downloads to the same file share one GET, the download
+  // to another file has its own.
+  auto reads = provider->GetStats().read_requests;
+  std::vector<std::thread> threads;
+  for (const auto* copy : {"/copy", "/copy", "/copy", "/other"}) {
+    threads.emplace_back([&, copy] {
+      ASSERT_OK(provider->GetCloudObject(bucket, "db/MANIFEST", dir + copy));
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  ASSERT_EQ(provider->GetStats().read_requests, reads + 2);
+  for (const auto* copy : {"/copy", "/other"}) {
+    std::string content;
+    ASSERT_OK(ReadFileToString(fs.get(), dir + copy, &content));
+    ASSERT_EQ(content, data);
+  }
+
+  DestroyDir(Env::Default(), dir).PermitUncheckedError();
+}
+
+TEST(CloudFileSystemTest, ExpressBucket) {
+  std::unique_ptr<CloudFileSystem> cfs;
+  auto provider = NewSimulatedCloudFileSystem(
+      "", &cfs, true /*with_dest*/, "express_bucket=express; ");
+  ASSERT_NE(provider, nullptr);
+  ASSERT_OK(provider->CreateBucket("express"));
+  const auto bucket = cfs->GetDestBucketName();
+  const auto fs = FileSystem::Default();
+  const std::string dir = test::PerThreadDBPath("express_bucket");
+  ASSERT_OK(fs->CreateDirIfMissing(dir, IOOptions(), nullptr));
+  ASSERT_OK(WriteStringToFile(fs.get(), "manifest", dir + "/MANIFEST-000001"));
+  ASSERT_OK(WriteStringToFile(fs.get(), "table", dir + "/000010.sst"));
+
+  // A MANIFEST is written to the express bucket and copied to the
+  // destination bucket in the background.
+  ASSERT_OK(cfs->CopyLocalFileToDest(dir + "/MANIFEST-000001",
+                                     "db/MANIFEST-000001"));
+  ASSERT_OK(provider->ExistsCloudObject("express", "db/MANIFEST-000001"));
+  ASSERT_OK(cfs->WaitForAllUploadsToDest());
+  ASSERT_OK(provider->ExistsCloudObject(bucket, "db/MANIFEST-000001"));
+
+  // An SST goes to the destination bucket only.
+  ASSERT_OK(cfs->CopyLocalFileToDest(dir + "/000010.sst", "db/000010.sst"));
+  ASSERT_OK(provider->ExistsCloudObject(bucket, "db/000010.sst"));
+  ASSERT_TRUE(
+      provider->ExistsCloudObject("express", "db/000010.sst").IsNotFound());
+
+  DestroyDir(Env::Default(), dir).PermitUncheckedError();
+}
+
+TEST(CloudFileSystemTest, ReplayLogFromStream) {
+  std::unique_ptr<CloudFileSystem> cfs;
+  ASSERT_NE(NewSimulatedCloudFileSystem("", &cfs, true /*with_dest*/,
+                                        "replay_log_from_stream=true; "),
+            nullptr);
+  std::shared_ptr<FileSystem> fs(cfs.release());
+  auto env = NewCompositeEnv(fs);
+  TestLogController controller;
+  ConfigOptions config_options;
+  config_options.env = env.get();
+  ASSERT_OK(controller.PrepareOptions(config_options));
+
+  const std::string fname = "/db/000005.log";
+  std::string record;
+  CloudLogControllerImpl::SerializeLogRecordAppend(fname, "hello ", 0,
+                                                   &record);
+  ASSERT_OK(controller.Apply(record));
+  // A redelivered record does not duplicate its bytes.
+  ASSERT_OK(controller.Apply(record));
+
+  std::unique_ptr<FSSequentialFile> file;
+  ASSERT_OK(controller.NewSequentialFile(fname, FileOptions(), &file,
+                                         nullptr /*dbg*/));
+  char scratch[64];
+  Slice result;
+  ASSERT_OK(file->Read(3, IOOptions(), &result, scratch, nullptr /*dbg*/));
+  ASSERT_EQ(result.ToString(), "hel");
+
+  // The records tailed after the file was opened are read too.
+  record.clear();
+  CloudLogControllerImpl::SerializeLogRecordAppend(fname, "world", 6,
+                                                   &record);
+  ASSERT_OK(controller.Apply(record));
+  ASSERT_OK(file->Read(sizeof(scratch), IOOptions(), &result, scratch,
+                       nullptr /*dbg*/));
+  ASSERT_EQ(result.ToString(), "lo world");
+  ASSERT_OK(file->Read(sizeof(scratch), IOOptions(), &result, scratch,
+                       nullptr /*dbg*/));
+  ASSERT_TRUE(result.empty());
+
+  uint64_t size = 0;
+  ASSERT_OK(controller.GetFileSize(fname, &size));
+  ASSERT_EQ(size, 11);
+  std::unique_ptr<FSRandomAccessFile> random;
+  ASSERT_OK(controller.NewRandomAccessFile(fname, FileOptions(), &random,
+                                           nullptr /*dbg*/));
+  ASSERT_OK(random->Read(4, 4, IOOptions(), &result, scratch,
+                         nullptr /*dbg*/));
+  ASSERT_EQ(result.ToString(), "o wo");
+
+  // Nothing was written to the cache directory.
+  ASSERT_TRUE(fs->FileExists(controller.GetCacheDir() + "/000005.log",
+                             IOOptions(), nullptr /*dbg*/)
+                  .IsNotFound());
+
+  // An open file keeps its records when the deletion of the log is tailed.
+  record.clear();
+  CloudLogControllerImpl::SerializeLogRecordDelete(fname, &record);
+  ASSERT_OK(controller.Apply(record));
+  ASSERT_OK(random->Read(0, 5, IOOptions(), &result, scratch,
+                         nullptr /*dbg*/));
+  ASSERT_EQ(result.ToString(), "hello");
+  controller.StopTailingStream();
+  DestroyDir(Env::Default(), controller.GetCacheDir()).PermitUncheckedError();
+}
+
+TEST(CloudFileSystemTest, LogCompression) {
+  if (!ZSTD_Supported() || !ZSTD_TrainDictionarySupported()) {
+    ROCKSDB_GTEST_SKIP("Test requires ZSTD dictionary training");
+    return;
+  }
+  std::unique_ptr<CloudFileSystem> cfs;
+  ASSERT_NE(NewSimulatedCloudFileSystem("", &cfs, true /*with_dest*/,
+                                        "replay_log_from_stream=true; "),
+            nullptr);
+  std::shared_ptr<FileSystem> fs(cfs.release());
+  auto env = NewCompositeEnv(fs);
+  TestLogController controller;
+  ConfigOptions config_options;
+  config_options.env = env.get();
+  ASSERT_OK(controller.PrepareOptions(config_options));
+
+  CloudFileSystemOptions copts;
+  copts.log_compression = kZSTD;
+  copts.log_compression_max_dict_bytes = 1024;
+  CloudLogAppendCompressor compressor(copts);
+  const std::string fname = "/db/000007.log";
+  std::string contents;
+  size_t stream_bytes = 0;
+  bool trained = false;
+  for (int i = 0; i < 2000; i++) {
+    const std::string data = "{\"id\": " + std::to_string(i) +
+                             ", \"name\": \"user" + std::to_string(i % 7) +
+                             "\", \"tags\": [\"a\", \"b\"], \"score\": " +
+                             std::to_string(i * 31 % 1000) + "}";
+    std::string record;
+    std::string dict_record;
+    compressor.SerializeAppend(fname, data, contents.size(), &record,
+                               &dict_record);
+    if (!dict_record.empty()) {
+      trained = true;
+      stream_bytes += dict_record.size();
+      ASSERT_OK(controller.Apply(dict_record));
+    }
+    stream_bytes += record.size();
+    ASSERT_OK(controller.Apply(record));
+    contents += data;
+  }
+  ASSERT_TRUE(trained);
+  ASSERT_LT(stream_bytes, contents.size());
+
+  // The tailer decompresses the appends.
+  std::unique_ptr<FSSequentialFile> file;
+  ASSERT_OK(controller.NewSequentialFile(fname, FileOptions(), &file,
+                                         nullptr /*dbg*/));
+  std::string scratch(contents.size() + 1, '\0');
+  Slice result;
+  ASSERT_OK(file->Read(scratch.size(), IOOptions(), &result, &scratch[0],
+                       nullptr /*dbg*/));
+  ASSERT_EQ(result.ToString(), contents);
+  controller.StopTailingStream();
+  DestroyDir(Env::Default(), controller.GetCacheDir()).PermitUncheckedError();
+}
+
+TEST(CloudFileSystemTest, SimulatedStorageDirectory) {
+  const auto fs = FileSystem::Default();
+  const std::string dir = test::PerThreadDBPath("simulated_storage");
+  ASSERT_OK(DestroyDir(Env::Default(), dir));
+  ASSERT_OK(fs->CreateDirIfMissing(dir, IOOptions(), nullptr));
+  ASSERT_OK(WriteStringToFile(fs.get(), "data", dir + "/local"));
+  {
+    std::unique_ptr<CloudFileSystem> cfs;
+    auto provider =
+        NewSimulatedCloudFileSystem("root_dir=" + dir + "/store", &cfs);
+    ASSERT_NE(provider, nullptr);
+    ASSERT_OK(provider->PutCloudObject(dir + "/local",
+                                       cfs->GetDestBucketName(), "db/a/b"));
+  }
+  // The objects outlive the provider
+  std::unique_ptr<CloudFileSystem> cfs;
+  auto provider =
+      NewSimulatedCloudFileSystem("root_dir=" + dir + "/store", &cfs);
+  ASSERT_NE(provider, nullptr);
+  std::vector<std::string> names;
+  ASSERT_OK(provider->ListCloudObjects(cfs->GetDestBucketName(), "db", &names));
+  ASSERT_EQ(names, std::vector<std::string>({"a/b"}));
+  uint64_t size = 0;
+  ASSERT_OK(
+      provider->GetCloudObjectSize(cfs->GetDestBucketName(), "db/a/b", &size));
+  ASSERT_EQ(size, 4);
+}
+
 }  // namespace ROCKSDB_NAMESPACE
 
 int main(int argc, char** argv) {
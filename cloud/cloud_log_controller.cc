@@ -6,7 +6,9 @@
 
 #include "rocksdb/cloud/cloud_log_controller.h"
 
+#include <algorithm>
 #include <cinttypes>
+#include <cstring>
 #include <fstream>
 #include <iostream>
 
@@ -17,6 +19,7 @@
 #include "rocksdb/status.h"
 #include "rocksdb/utilities/object_registry.h"
 #include "util/coding.h"
+#include "util/compression.h"
 #include "util/stderr_logger.h"
 #include "util/string_util.h"
 
@@ -42,6 +45,178 @@ Status CloudLogController::CreateFromString(
   }
 }
 
+namespace {
+// Compressed appends carry their uncompressed size.
+const uint32_t kLogCompressFormatVersion = 2;
+// The dictionary of a log file is trained on appends of up to this many
+// times its size.
+const size_t kDictTrainingRatio = 100;
+}  // namespace
+
+CloudLogAppendCompressor::CloudLogAppendCompressor(
+    const CloudFileSystemOptions& options)
+    : type_(options.log_compression) {
+  opts_.max_dict_bytes = options.log_compression_max_dict_bytes;
+  if (type_ != kNoCompression) {
+    context_.reset(new CompressionContext(type_, opts_));
+  }
+  training_ = type_ == kZSTD && opts_.max_dict_bytes > 0 &&
+              ZSTD_TrainDictionarySupported();
+}
+
+CloudLogAppendCompressor::~CloudLogAppendCompressor() {}
+
+void CloudLogAppendCompressor::SerializeAppend(const Slice& filename,
+                                               const Slice& data,
+                                               uint64_t offset,
+                                               std::string* out,
+                                               std::string* dict_record) {
+  if (type_ == kNoCompression) {
+    CloudLogControllerImpl::SerializeLogRecordAppend(filename, data, offset,
+                                                     out);
+    return;
+  }
+  std::string compressed;
+  const CompressionInfo info(opts_, *context_,
+                             dict_ ? *dict_ : CompressionDict::GetEmptyDict(),
+                             type_, 0 /* sample_for_compression */);
+  if (CompressData(data, info, kLogCompressFormatVersion, &compressed) &&
+      compressed.size() < data.size()) {
+    CloudLogControllerImpl::SerializeLogRecordAppendCompressed(
+        filename, compressed, type_, dict_ != nullptr, offset, out);
+  } else {
+    CloudLogControllerImpl::SerializeLogRecordAppend(filename, data, offset,
+                                                     out);
+  }
+
+  if (training_) {
+    samples_.append(data.data(), data.size());
+    sample_lens_.push_back(data.size());
+    if (samples_.size() >= kDictTrainingRatio * opts_.max_dict_bytes) {
+      training_ = false;
+      std::string dict =
+          ZSTD_TrainDictionary(samples_, sample_lens_, opts_.max_dict_bytes);
+      std::string().swap(samples_);
+      std::vector<size_t>().swap(sample_lens_);
+      // The appends go on without a dictionary if the training failed.
+      if (!dict.empty()) {
+        CloudLogControllerImpl::SerializeLogRecordDictionary(filename, dict,
+                                                             dict_record);
+        dict_.reset(new CompressionDict(std::move(dict), type_, opts_.level));
+      }
+    }
+  }
+}
+
+// The records tailed for a log file, keyed by the offset of their first
+// byte. Redelivered or rewritten bytes overwrite the ones buffered already.
+class CloudLogStreamBuffer {
+ public:
+  void Write(uint64_t offset, const Slice& data, uint64_t mtime) {
+    std::lock_guard<std::mutex> lk(mutex_);
+    mtime_ = mtime;
+    if (offset > size_) {
+      // Reads of a hole see zeros, as for a file.
+      records_.emplace(size_, std::string(offset - size_, '\0'));
+      size_ = offset;
+    }
+    size_t done = 0;
+    if (offset < size_) {
+      auto it = std::prev(records_.upper_bound(offset));
+      for (; done < data.size() && it != records_.end(); ++it) {
+        const size_t in_record = offset + done - it->first;
+        const size_t n =
+            std::min(it->second.size() - in_record, data.size() - done);
+        memcpy(&it->second[in_record], data.data() + done, n);
+        done += n;
+      }
+    }
+    if (done < data.size()) {
+      records_.emplace(size_, std::string(data.data() + done,
+                                          data.size() - done));
+      size_ += data.size() - done;
+    }
+  }
+
+  // Copies up to n bytes at offset to scratch, returns the number copied.
+  size_t Read(uint64_t offset, size_t n, char* scratch) const {
+    std::lock_guard<std::mutex> lk(mutex_);
+    if (offset >= size_) {
+      return 0;
+    }
+    n = static_cast<size_t>(std::min<uint64_t>(n, size_ - offset));
+    size_t done = 0;
+    for (auto it = std::prev(records_.upper_bound(offset)); done < n; ++it) {
+      const size_t in_record = offset + done - it->first;
+      const size_t m = std::min(it->second.size() - in_record, n - done);
+      memcpy(scratch + done, it->second.data() + in_record, m);
+      done += m;
+    }
+    return done;
+  }
+
+  uint64_t Size() const {
+    std::lock_guard<std::mutex> lk(mutex_);
+    return size_;
+  }
+
+  uint64_t ModificationTime() const {
+    std::lock_guard<std::mutex> lk(mutex_);
+    return mtime_;
+  }
+
+ private:
+  mutable std::mutex mutex_;
+  std::map<uint64_t, std::string> records_;
+  uint64_t size_ = 0;
+  uint64_t mtime_ = 0;
+};
+
+namespace {
+// Reads a log file from the records tailed for it. A read past the records
+// tailed so far returns what there is, as a read of the cache file would.
+class CloudLogStreamSequentialFile : public FSSequentialFile {
+ public:
+  explicit CloudLogStreamSequentialFile(
+      std::shared_ptr<CloudLogStreamBuffer> buffer)
+      : buffer_(std::move(buffer)) {}
+
+  IOStatus Read(size_t n, const IOOptions& /*opts*/, Slice* result,
+                char* scratch, IODebugContext* /*dbg*/) override {
+    const size_t r = buffer_->Read(offset_, n, scratch);
+    offset_ += r;
+    *result = Slice(scratch, r);
+    return IOStatus::OK();
+  }
+
+  IOStatus Skip(uint64_t n) override {
+    offset_ += n;
+    return IOStatus::OK();
+  }
+
+ private:
+  std::shared_ptr<CloudLogStreamBuffer> buffer_;
+  uint64_t offset_ = 0;
+};
+
+class CloudLogStreamRandomAccessFile : public FSRandomAccessFile {
+ public:
+  explicit CloudLogStreamRandomAccessFile(
+      std::shared_ptr<CloudLogStreamBuffer> buffer)
+      : buffer_(std::move(buffer)) {}
+
+  IOStatus Read(uint64_t offset, size_t n, const IOOptions& /*opts*/,
+                Slice* result, char* scratch,
+                IODebugContext* /*dbg*/) const override {
+    *result = Slice(scratch, buffer_->Read(offset, n, scratch));
+    return IOStatus::OK();
+  }
+
+ private:
+  std::shared_ptr<CloudLogStreamBuffer> buffer_;
+};
+}  // namespace
+
 CloudLogControllerImpl::CloudLogControllerImpl() : running_(false) {}
 
 CloudLogControllerImpl::~CloudLogControllerImpl() {
@@ -82,6 +257,8 @@ Status CloudLogControllerImpl::PrepareOptions(const ConfigOptions& options) {
   if (status_.ok()) {
     status_ = base->CreateDirIfMissing(cache_dir_, io_opts, dbg);
   }
+  replay_from_stream_ =
+      cloud_fs_->GetCloudFileSystemOptions().replay_log_from_stream;
   if (status_.ok()) {
     status_ = StartTailingStream(cloud_fs_->GetSrcBucketName());
   }
@@ -128,6 +305,21 @@ bool CloudLogControllerImpl::ExtractLogRecord(
         !GetLengthPrefixedSlice(&in, filename)) {  // extract filename
       return false;
     }
+  } else if (*operation == kAppendCompressed) {
+    *file_size = 0;
+    if (!GetFixed64(&in, offset_in_file) ||        // extract offset in file
+        !GetLengthPrefixedSlice(&in, filename)) {  // extract filename
+      return false;
+    }
+    // The compression and the compressed contents are parsed by Apply().
+    *data = in;
+  } else if (*operation == kDictionary) {
+    *file_size = 0;
+    *offset_in_file = 0;
+    if (!GetLengthPrefixedSlice(&in, filename) ||  // extract filename
+        !GetLengthPrefixedSlice(&in, data)) {      // extract dictionary
+      return false;
+    }
   } else {
     return false;
   }
@@ -149,11 +341,76 @@ IOStatus CloudLogControllerImpl::Apply(const Slice& in) {
 
   // Convert original pathname to a local file path.
   std::string pathname = GetCachePath(original_pathname);
+  std::lock_guard<std::mutex> lk(cache_fds_mutex_);
 
   const FileOptions fo;
   const IOOptions io_opts;
   IODebugContext* dbg = nullptr;
 
+  if (operation == kDictionary) {
+    stream_dicts_[pathname].reset(
+        new UncompressionDict(payload.ToString(), true /* using_zstd */));
+    Log(InfoLogLevel::DEBUG_LEVEL, cloud_fs_->GetLogger(),
+        "[%s] Tailer: Compression dictionary of %" PRIu64 " bytes for %s",
+        Name(), static_cast<uint64_t>(payload.size()), pathname.c_str());
+    return st;
+  }
+  CacheAllocationPtr uncompressed;
+  if (operation == kAppendCompressed) {
+    uint32_t type = 0;
+    uint32_t with_dict = 0;
+    Slice compressed;
+    if (!GetVarint32(&payload, &type) || !GetVarint32(&payload, &with_dict) ||
+        !GetLengthPrefixedSlice(&payload, &compressed)) {
+      return IOStatus::IOError("Unable to parse payload from stream");
+    }
+    const UncompressionDict* dict = &UncompressionDict::GetEmptyDict();
+    if (with_dict) {
+      auto iter = stream_dicts_.find(pathname);
+      if (iter == stream_dicts_.end()) {
+        return IOStatus::Corruption("No compression dictionary tailed for",
+                                    pathname);
+      }
+      dict = iter->second.get();
+    }
+    const auto compression_type = static_cast<CompressionType>(type);
+    const UncompressionContext context(compression_type);
+    const UncompressionInfo info(context, *dict, compression_type);
+    size_t size = 0;
+    uncompressed = UncompressData(info, compressed.data(), compressed.size(),
+                                  &size, kLogCompressFormatVersion);
+    if (!uncompressed) {
+      return IOStatus::Corruption("Unable to uncompress log record of",
+                                  pathname);
+    }
+    payload = Slice(uncompressed.get(), size);
+    operation = kAppend;
+  } else if (operation == kDelete) {
+    stream_dicts_.erase(pathname);
+  }
+
+  if (replay_from_stream_) {
+    if (operation == kAppend) {
+      auto& buffer = stream_buffers_[pathname];
+      if (!buffer) {
+        buffer = std::make_shared<CloudLogStreamBuffer>();
+      }
+      buffer->Write(offset_in_file, payload, env_->NowMicros() / 1000000);
+    } else if (operation == kDelete) {
+      // Open readers keep their records.
+      stream_buffers_.erase(pathname);
+    } else if (operation != kClosed) {
+      st = IOStatus::IOError("Unknown operation");
+    }
+    Log(InfoLogLevel::DEBUG_LEVEL, cloud_fs_->GetLogger(),
+        "[%s] Tailer: Operation '%x' on buffered file %s: %" PRIu64
+        " bytes at offset %" PRIu64 " %s",
+        Name(), operation, pathname.c_str(),
+        static_cast<uint64_t>(payload.size()), offset_in_file,
+        st.ToString().c_str());
+    return st;
+  }
+
   // Apply operation on cache file.
   if (operation == kAppend) {
     Log(InfoLogLevel::DEBUG_LEVEL, cloud_fs_->GetLogger(),
@@ -267,6 +524,38 @@ void CloudLogControllerImpl::SerializeLogRecordClosed(const Slice& filename,
   PutLengthPrefixedSlice(out, filename);
 }
 
+void CloudLogControllerImpl::SerializeLogRecordAppendCompressed(
+    const Slice& filename, const Slice& compressed, CompressionType type,
+    bool with_dict, uint64_t offset, std::string* out) {
+  // write the operation type
+  PutVarint32(out, kAppendCompressed);
+
+  // write out the offset in file where the data needs to be written
+  PutFixed64(out, offset);
+
+  // write out the filename
+  PutLengthPrefixedSlice(out, filename);
+
+  // write out how the data is compressed
+  PutVarint32(out, type);
+  PutVarint32(out, with_dict ? 1 : 0);
+
+  // write out the compressed data
+  PutLengthPrefixedSlice(out, compressed);
+}
+
+void CloudLogControllerImpl::SerializeLogRecordDictionary(
+    const Slice& filename, const Slice& dict, std::string* out) {
+  // write the operation type
+  PutVarint32(out, kDictionary);
+
+  // write out the filename
+  PutLengthPrefixedSlice(out, filename);
+
+  // write out the dictionary
+  PutLengthPrefixedSlice(out, dict);
+}
+
 void CloudLogControllerImpl::SerializeLogRecordDelete(
     const std::string& filename, std::string* out) {
   // write the operation type
@@ -324,6 +613,18 @@ IOStatus CloudLogControllerImpl::Retry(RetryType func) {
   return stat;
 }
 
+IOStatus CloudLogControllerImpl::GetStreamBuffer(
+    const std::string& pathname,
+    std::shared_ptr<CloudLogStreamBuffer>* buffer) {
+  std::lock_guard<std::mutex> lk(cache_fds_mutex_);
+  auto iter = stream_buffers_.find(pathname);
+  if (iter == stream_buffers_.end()) {
+    return IOStatus::NotFound("No records tailed for", pathname);
+  }
+  *buffer = iter->second;
+  return IOStatus::OK();
+}
+
 IOStatus CloudLogControllerImpl::GetFileModificationTime(
     const std::string& fname, uint64_t* time) {
   auto st = status_to_io_status(status());
@@ -335,6 +636,14 @@ IOStatus CloudLogControllerImpl::GetFileModificationTime(
         "ok");
 
     auto lambda = [this, pathname = std::move(pathname), time]() {
+      if (replay_from_stream_) {
+        std::shared_ptr<CloudLogStreamBuffer> buffer;
+        auto s = GetStreamBuffer(pathname, &buffer);
+        if (s.ok()) {
+          *time = buffer->ModificationTime();
+        }
+        return s;
+      }
       return cloud_fs_->GetBaseFileSystem()->GetFileModificationTime(
           pathname, IOOptions(), time, nullptr /*dbg*/);
     };
@@ -355,6 +664,14 @@ IOStatus CloudLogControllerImpl::NewSequentialFile(
 
     auto lambda = [this, pathname = std::move(pathname), &result, &file_opts,
                    dbg]() {
+      if (replay_from_stream_) {
+        std::shared_ptr<CloudLogStreamBuffer> buffer;
+        auto s = GetStreamBuffer(pathname, &buffer);
+        if (s.ok()) {
+          result->reset(new CloudLogStreamSequentialFile(std::move(buffer)));
+        }
+        return s;
+      }
       return cloud_fs_->GetBaseFileSystem()->NewSequentialFile(
           pathname, file_opts, result, dbg);
     };
@@ -376,6 +693,14 @@ IOStatus CloudLogControllerImpl::NewRandomAccessFile(
 
     auto lambda = [this, pathname = std::move(pathname), &result, &file_opts,
                    dbg]() {
+      if (replay_from_stream_) {
+        std::shared_ptr<CloudLogStreamBuffer> buffer;
+        auto s = GetStreamBuffer(pathname, &buffer);
+        if (s.ok()) {
+          result->reset(new CloudLogStreamRandomAccessFile(std::move(buffer)));
+        }
+        return s;
+      }
       return cloud_fs_->GetBaseFileSystem()->NewRandomAccessFile(
           pathname, file_opts, result, dbg);
     };
@@ -393,6 +718,10 @@ IOStatus CloudLogControllerImpl::FileExists(const std::string& fname) {
         "[%s] FileExists logfile %s %s", Name(), pathname.c_str(), "ok");
 
     auto lambda = [this, pathname = std::move(pathname)]() {
+      if (replay_from_stream_) {
+        std::shared_ptr<CloudLogStreamBuffer> buffer;
+        return GetStreamBuffer(pathname, &buffer);
+      }
       return cloud_fs_->GetBaseFileSystem()->FileExists(pathname, IOOptions(),
                                                         nullptr /*dbg*/);
     };
@@ -411,6 +740,14 @@ IOStatus CloudLogControllerImpl::GetFileSize(const std::string& fname,
         "[%s] GetFileSize logfile %s %s", Name(), pathname.c_str(), "ok");
 
     auto lambda = [this, pathname, size]() {
+      if (replay_from_stream_) {
+        std::shared_ptr<CloudLogStreamBuffer> buffer;
+        auto s = GetStreamBuffer(pathname, &buffer);
+        if (s.ok()) {
+          *size = buffer->Size();
+        }
+        return s;
+      }
       return cloud_fs_->GetBaseFileSystem()->GetFileSize(pathname, IOOptions(),
                                                          size, nullptr /*dbg*/);
     };
@@ -3,12 +3,48 @@
 #pragma once
 
 #include <atomic>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
 #include <thread>
+#include <vector>
 
 #include "rocksdb/cloud/cloud_log_controller.h"
 
 namespace ROCKSDB_NAMESPACE {
 class CloudFileSystem;
+class CloudFileSystemOptions;
+class CloudLogStreamBuffer;
+class CompressionContext;
+class CompressionDict;
+class UncompressionDict;
+
+// Frames the appends to a log file, compressed as configured by
+// CloudFileSystemOptions::log_compression. Not thread safe, as the appends
+// to a file are not.
+class CloudLogAppendCompressor {
+ public:
+  explicit CloudLogAppendCompressor(const CloudFileSystemOptions& options);
+  ~CloudLogAppendCompressor();
+
+  // Serializes the append of data at offset of filename into out. If the
+  // appends so far trained a dictionary, also serializes the record that
+  // publishes it into dict_record, which has to be written before out.
+  void SerializeAppend(const Slice& filename, const Slice& data,
+                       uint64_t offset, std::string* out,
+                       std::string* dict_record);
+
+ private:
+  const CompressionType type_;
+  CompressionOptions opts_;
+  std::unique_ptr<CompressionContext> context_;
+  std::unique_ptr<CompressionDict> dict_;
+  // The appends to train the dictionary on, until it is trained.
+  std::string samples_;
+  std::vector<size_t> sample_lens_;
+  bool training_ = false;
+};
 
 class CloudLogControllerImpl : public CloudLogController {
  public:
@@ -26,6 +62,10 @@ class CloudLogControllerImpl : public CloudLogController {
   static const uint32_t kAppend = 0x1;  // add a new record to a logfile
   static const uint32_t kDelete = 0x2;  // delete a log file
   static const uint32_t kClosed = 0x4;  // closing a file
+  // append compressed data to a logfile
+  static const uint32_t kAppendCompressed = 0x8;
+  // publish the compression dictionary of a logfile
+  static const uint32_t kDictionary = 0x10;
 
   CloudLogControllerImpl();
   virtual ~CloudLogControllerImpl();
@@ -46,6 +86,17 @@ class CloudLogControllerImpl : public CloudLogController {
                                        uint64_t file_size, std::string* out);
   static void SerializeLogRecordDelete(const std::string& filename,
                                        std::string* out);
+  // Records the compressed data appended at offset, and whether it was
+  // compressed with the dictionary of the file.
+  static void SerializeLogRecordAppendCompressed(const Slice& filename,
+                                                 const Slice& compressed,
+                                                 CompressionType type,
+                                                 bool with_dict,
+                                                 uint64_t offset,
+                                                 std::string* out);
+  static void SerializeLogRecordDictionary(const Slice& filename,
+                                           const Slice& dict,
+                                           std::string* out);
   IOStatus GetFileModificationTime(const std::string& fname,
                                    uint64_t* time) override;
   IOStatus NewSequentialFile(const std::string& fname,
@@ -78,10 +129,26 @@ class CloudLogControllerImpl : public CloudLogController {
   std::string cache_dir_;
   // A cache of pathnames to their open file _escriptors
   std::map<std::string, std::unique_ptr<FSRandomRWFile>> cache_fds_;
+  std::mutex cache_fds_mutex_;
+  // The records tailed for each cache pathname, if the logs are replayed
+  // from the stream, see CloudFileSystemOptions::replay_log_from_stream.
+  // Guarded by cache_fds_mutex_.
+  std::map<std::string, std::shared_ptr<CloudLogStreamBuffer>>
+      stream_buffers_;
+  bool replay_from_stream_ = false;
+  // The compression dictionaries tailed for each cache pathname. Guarded by
+  // cache_fds_mutex_.
+  std::map<std::string, std::unique_ptr<UncompressionDict>> stream_dicts_;
 
+  // Thread safe, for controllers that tail several partitions of the stream
+  // in parallel. Records of a file must be applied in order.
   IOStatus Apply(const Slice& data);
   bool IsRunning() const { return running_; }
 
+  // Finds the records tailed for the log file at the cache pathname.
+  IOStatus GetStreamBuffer(const std::string& pathname,
+                           std::shared_ptr<CloudLogStreamBuffer>* buffer);
+
  private:
   // Background thread to tail stream
   std::unique_ptr<std::thread> tid_;
@@ -29,15 +29,17 @@ struct CorruptionReporter : public log::Reader::Reporter {
 enum class RecordTags : uint32_t {
   kPastEpoch = 1,
   kCurrentEpoch = 2,
+  kSstObjectShards = 3,
 };
 
 }  // namespace
 
 // Format:
 // header: format_version (varint) number of records (varint)
-// record: tag (varint, 1 or 2)
+// record: tag (varint, 1, 2 or 3)
 // record 1: epoch (slice), file number
 // record 2: current epoch
+// record 3: number of SST object shards (varint), since format version 2
 IOStatus CloudManifest::LoadFromLog(std::unique_ptr<SequentialFileReader> log,
                                     std::unique_ptr<CloudManifest>* manifest) {
   Status status;
@@ -52,11 +54,12 @@ IOStatus CloudManifest::LoadFromLog(std::unique_ptr<SequentialFileReader> log,
   uint32_t recordsRead = 0;
   std::string currentEpoch;
   std::vector<std::pair<uint64_t, std::string>> pastEpochs;
+  uint32_t formatVersion = 0;
+  uint32_t sstObjectShards = 0;
   while (reader.ReadRecord(&record, &scratch,
                            WALRecoveryMode::kAbsoluteConsistency) &&
          status.ok()) {
     if (!headerRead) {
-      uint32_t formatVersion;
       bool ok = GetVarint32(&record, &formatVersion);
       if (ok) {
         ok = GetVarint32(&record, &expectedRecords);
@@ -64,7 +67,8 @@ IOStatus CloudManifest::LoadFromLog(std::unique_ptr<SequentialFileReader> log,
       if (!ok) {
         return IOStatus::Corruption("Corruption in cloud manifest header");
       }
-      if (formatVersion != kCurrentFormatVersion) {
+      if (formatVersion != kFormatVersion &&
+          formatVersion != kFormatVersionWithSstShards) {
         return IOStatus::Corruption("Unknown cloud manifest format version");
       }
       headerRead = true;
@@ -94,6 +98,11 @@ IOStatus CloudManifest::LoadFromLog(std::unique_ptr<SequentialFileReader> log,
           }
           break;
         }
+        case static_cast<uint32_t>(RecordTags::kSstObjectShards): {
+          ok = formatVersion >= kFormatVersionWithSstShards &&
+               GetVarint32(&record, &sstObjectShards);
+          break;
+        }
         default:
           ok = false;
       }
@@ -111,21 +120,55 @@ IOStatus CloudManifest::LoadFromLog(std::unique_ptr<SequentialFileReader> log,
                       [](auto& e1, auto& e2) { return e1.first < e2.first; })) {
     return IOStatus::Corruption("Cloud manifest records not sorted");
   }
-  manifest->reset(
-      new CloudManifest(std::move(pastEpochs), std::move(currentEpoch)));
+  manifest->reset(new CloudManifest(std::move(pastEpochs),
+                                    std::move(currentEpoch), sstObjectShards));
   return status_to_io_status(std::move(status));
 }
 
+CloudManifest::CloudManifest(
+    std::vector<std::pair<uint64_t, std::string>> pastEpochs,
+    std::string currentEpoch, uint32_t sstObjectShards)
+    : pastEpochs_(std::move(pastEpochs)),
+      currentEpoch_(std::move(currentEpoch)),
+      sstObjectShards_(sstObjectShards) {
+  auto snapshot = std::make_unique<EpochSnapshot>();
+  snapshot->pastEpochs.reserve(pastEpochs_.size());
+  for (const auto& pe : pastEpochs_) {
+    internedEpochs_.push_back(pe.second);
+    snapshot->pastEpochs.emplace_back(pe.first, &internedEpochs_.back());
+  }
+  internedEpochs_.push_back(currentEpoch_);
+  snapshot->currentEpoch = &internedEpochs_.back();
+  snapshot_.store(snapshot.get(), std::memory_order_release);
+  snapshots_.push_back(std::move(snapshot));
+}
+
+void CloudManifest::PublishSnapshot() {
+  const auto* last = snapshots_.back().get();
+  auto snapshot = std::make_unique<EpochSnapshot>();
+  snapshot->pastEpochs.reserve(last->pastEpochs.size() + 1);
+  snapshot->pastEpochs = last->pastEpochs;
+  snapshot->pastEpochs.emplace_back(pastEpochs_.back().first,
+                                    last->currentEpoch);
+  assert(snapshot->pastEpochs.size() == pastEpochs_.size());
+  internedEpochs_.push_back(currentEpoch_);
+  snapshot->currentEpoch = &internedEpochs_.back();
+  snapshot_.store(snapshot.get(), std::memory_order_release);
+  snapshots_.push_back(std::move(snapshot));
+}
+
 IOStatus CloudManifest::CreateForEmptyDatabase(
-    std::string currentEpoch, std::unique_ptr<CloudManifest>* manifest) {
-  manifest->reset(new CloudManifest({}, std::move(currentEpoch)));
+    std::string currentEpoch, std::unique_ptr<CloudManifest>* manifest,
+    uint32_t sstObjectShards) {
+  manifest->reset(
+      new CloudManifest({}, std::move(currentEpoch), sstObjectShards));
   return IOStatus::OK();
 }
 
 std::unique_ptr<CloudManifest> CloudManifest::clone() const {
   ReadLock lck(&mutex_);
   return std::unique_ptr<CloudManifest>(
-      new CloudManifest(pastEpochs_, currentEpoch_));
+      new CloudManifest(pastEpochs_, currentEpoch_, sstObjectShards_));
 }
 
 // Serialization format is quite simple:
@@ -136,6 +179,8 @@ std::unique_ptr<CloudManifest> CloudManifest::clone() const {
 // Record:
 // * (kPastEpoch tag: 1 byte) (epochId: length-prefixed-string) (file_number:
 // varint)
+// * (kSstObjectShards tag: 1 byte) (number_of_shards: varint), only written
+// when the SST objects are sharded
 //
 // Header comes first, and is followed with number_of_records Records.
 IOStatus CloudManifest::WriteToLog(
@@ -146,8 +191,10 @@ IOStatus CloudManifest::WriteToLog(
   ReadLock lck(&mutex_);
 
   // 1. write header
-  PutVarint32(&record, kCurrentFormatVersion);
-  PutVarint32(&record, static_cast<uint32_t>(pastEpochs_.size() + 1));
+  PutVarint32(&record, sstObjectShards_ > 0 ? kFormatVersionWithSstShards
+                                            : kFormatVersion);
+  PutVarint32(&record, static_cast<uint32_t>(pastEpochs_.size() + 1 +
+                                             (sstObjectShards_ > 0 ? 1 : 0)));
   auto status = writer.AddRecord({}, record);
   if (!status.ok()) {
     return status;
@@ -174,6 +221,17 @@ IOStatus CloudManifest::WriteToLog(
   if (!status.ok()) {
     return status;
   }
+
+  // 4. put the SST object layout
+  if (sstObjectShards_ > 0) {
+    record.clear();
+    PutVarint32(&record, static_cast<uint32_t>(RecordTags::kSstObjectShards));
+    PutVarint32(&record, sstObjectShards_);
+    status = writer.AddRecord({}, record);
+    if (!status.ok()) {
+      return status;
+    }
+  }
   return writer.file()->Sync({}, true);
 }
 
@@ -199,26 +257,33 @@ bool CloudManifest::AddEpoch(uint64_t startFileNumber, std::string epochId) {
 
   pastEpochs_.emplace_back(startFileNumber, std::move(currentEpoch_));
   currentEpoch_ = std::move(epochId);
+  PublishSnapshot();
   return true;
 }
 
-std::string CloudManifest::GetEpoch(uint64_t fileNumber) {
-  ReadLock lck(&mutex_);
+const std::string& CloudManifest::GetEpoch(uint64_t fileNumber) const {
+  const auto* snapshot = snapshot_.load(std::memory_order_acquire);
   // Note: We are looking for fileNumber + 1 because fileNumbers in pastEpochs_
   // are exclusive. In other words, if pastEpochs_ contains (10, "x"), it means
   // that "x" epoch ends at 9, not 10.
-  auto itr =
-      std::lower_bound(pastEpochs_.begin(), pastEpochs_.end(),
-                       std::pair<uint64_t, std::string>(fileNumber + 1, ""));
-  if (itr == pastEpochs_.end()) {
-    return currentEpoch_;
+  auto itr = std::lower_bound(
+      snapshot->pastEpochs.begin(), snapshot->pastEpochs.end(), fileNumber + 1,
+      [](const std::pair<uint64_t, const std::string*>& e, uint64_t n) {
+        return e.first < n;
+      });
+  if (itr == snapshot->pastEpochs.end()) {
+    return *snapshot->currentEpoch;
   }
-  return itr->second;
+  return *itr->second;
 }
 
-std::string CloudManifest::GetCurrentEpoch() {
+const std::string& CloudManifest::GetCurrentEpoch() const {
+  return *snapshot_.load(std::memory_order_acquire)->currentEpoch;
+}
+
+uint64_t CloudManifest::GetCurrentEpochStartFileNumber() const {
   ReadLock lck(&mutex_);
-  return currentEpoch_;
+  return pastEpochs_.empty() ? 0 : pastEpochs_.back().first;
 }
 
 std::vector<std::pair<uint64_t, std::string>>
@@ -238,6 +303,9 @@ std::string CloudManifest::ToString(bool include_past_epochs) {
     oss << "]\n";
   }
   oss << "Current Epoch: " << currentEpoch_;
+  if (sstObjectShards_ > 0) {
+    oss << ", SST Object Shards: " << sstObjectShards_;
+  }
   return oss.str();
 }
 
@@ -3,6 +3,9 @@
 #pragma once
 #include <rocksdb/status.h>
 
+#include <atomic>
+#include <deque>
+#include <memory>
 #include <vector>
 
 #include "db/log_reader.h"
@@ -32,6 +35,8 @@ namespace ROCKSDB_NAMESPACE {
 // In this case, we should expect to see files 1-[e1], 2-[e1], 3-[e1] and
 // 4-[e2]. Files with same file number, but different suffix should be
 // eliminated.
+// The cloud manifest also records how the SST objects of the database are
+// laid out in the cloud, see CloudFileSystemOptions::sst_object_shards.
 // CloudManifest is thread safe after Finalize() is called.
 class CloudManifest {
  public:
@@ -39,7 +44,8 @@ class CloudManifest {
                               std::unique_ptr<CloudManifest>* manifest);
   // Creates CloudManifest for an empty database
   static IOStatus CreateForEmptyDatabase(
-      std::string currentEpoch, std::unique_ptr<CloudManifest>* manifest);
+      std::string currentEpoch, std::unique_ptr<CloudManifest>* manifest,
+      uint32_t sstObjectShards = 0);
 
   std::unique_ptr<CloudManifest> clone() const;
 
@@ -57,27 +63,59 @@ class CloudManifest {
   // existing epochs(same sequence of <filenumm, epoch> is re-added)
   bool AddEpoch(uint64_t startFileNumber, std::string epochId);
 
-  std::string GetEpoch(uint64_t fileNumber);
-
-  std::string GetCurrentEpoch();
+  // The epoch of the file number. Does not lock, and the epoch returned
+  // stays valid as long as the manifest.
+  const std::string& GetEpoch(uint64_t fileNumber) const;
+
+  // Does not lock, and the epoch returned stays valid as long as the
+  // manifest.
+  const std::string& GetCurrentEpoch() const;
+  // First file number of the current epoch, 0 if there is no past epoch.
+  uint64_t GetCurrentEpochStartFileNumber() const;
+  // Number of hashed sub-prefixes the SST objects are spread over, 0 if they
+  // are all stored directly under the object path.
+  uint32_t GetSstObjectShards() const { return sstObjectShards_; }
   std::string ToString(bool include_past_epochs=false);
   std::vector<std::pair<uint64_t, std::string>> TEST_GetPastEpochs() const;
 
  private:
   CloudManifest(std::vector<std::pair<uint64_t, std::string>> pastEpochs,
-                std::string currentEpoch)
-      : pastEpochs_(std::move(pastEpochs)),
-        currentEpoch_(std::move(currentEpoch)) {}
+                std::string currentEpoch, uint32_t sstObjectShards);
+
+  // An immutable copy of the epochs, read by GetEpoch() and
+  // GetCurrentEpoch() without locking. AddEpoch() publishes a new one rather
+  // than changing it. The snapshots replaced are kept, and point to interned
+  // epochs, so that what the readers got stays valid.
+  struct EpochSnapshot {
+    // As pastEpochs_
+    std::vector<std::pair<uint64_t, const std::string*>> pastEpochs;
+    const std::string* currentEpoch = nullptr;
+  };
+  // Publishes the snapshot of the epochs once AddEpoch() ended the current
+  // one.
+  // REQUIRES: mutex_ held for writing
+  void PublishSnapshot();
 
   mutable port::RWMutex mutex_;
 
+  // All the epochs ever published, at stable addresses. Guarded by mutex_.
+  std::deque<std::string> internedEpochs_;
+  // All the snapshots ever published. Guarded by mutex_.
+  std::vector<std::unique_ptr<EpochSnapshot>> snapshots_;
+  std::atomic<const EpochSnapshot*> snapshot_{nullptr};
+
   // sorted
   // a set of (fileNumber, epochId) where fileNumber is the last file number
   // (exclusive) of an epoch
   std::vector<std::pair<uint64_t, std::string>> pastEpochs_;
   std::string currentEpoch_;
+  // Set when the database is created, never changes.
+  const uint32_t sstObjectShards_;
 
-  static constexpr uint32_t kCurrentFormatVersion = 1;
+  // Manifests of unsharded databases are written in the first version, so
+  // that older releases can still read them.
+  static constexpr uint32_t kFormatVersion = 1;
+  static constexpr uint32_t kFormatVersionWithSstShards = 2;
 };
 
 }  // namespace ROCKSDB_NAMESPACE
@@ -2,6 +2,9 @@
 
 #include "cloud/cloud_manifest.h"
 
+#include <atomic>
+#include <thread>
+
 #include "env/composite_env_wrapper.h"
 #include "file/writable_file_writer.h"
 #include "rocksdb/env.h"
@@ -81,6 +84,26 @@ TEST_F(CloudManifestTest, BasicTest) {
   }
 }
 
+TEST_F(CloudManifestTest, SstObjectShardsTest) {
+  std::unique_ptr<CloudManifest> manifest;
+  ASSERT_OK(CloudManifest::CreateForEmptyDatabase("firstEpoch", &manifest));
+  ASSERT_EQ(manifest->GetSstObjectShards(), 0);
+  std::string filepath;
+  ASSERT_OK(DumpToRandomFile(manifest.get(), &filepath));
+  ASSERT_OK(LoadFromFile(filepath, &manifest));
+  ASSERT_EQ(manifest->GetSstObjectShards(), 0);
+
+  ASSERT_OK(
+      CloudManifest::CreateForEmptyDatabase("firstEpoch", &manifest, 256));
+  EXPECT_TRUE(manifest->AddEpoch(10, "secondEpoch"));
+  ASSERT_EQ(manifest->clone()->GetSstObjectShards(), 256);
+  ASSERT_OK(DumpToRandomFile(manifest.get(), &filepath));
+  ASSERT_OK(LoadFromFile(filepath, &manifest));
+  ASSERT_EQ(manifest->GetSstObjectShards(), 256);
+  ASSERT_EQ(manifest->GetEpoch(5), "firstEpoch");
+  ASSERT_EQ(manifest->GetCurrentEpoch(), "secondEpoch");
+}
+
 TEST_F(CloudManifestTest, IdempotencyTest) {
   std::unique_ptr<CloudManifest> manifest;
   ASSERT_OK(CloudManifest::CreateForEmptyDatabase("epoch1", &manifest));
@@ -118,6 +141,33 @@ TEST_F(CloudManifestTest, IdempotencyTest) {
   ASSERT_OK(LoadFromFile(filepath, &manifest));
 }
 
+TEST_F(CloudManifestTest, LookupsDuringAddEpoch) {
+  std::unique_ptr<CloudManifest> manifest;
+  ASSERT_OK(CloudManifest::CreateForEmptyDatabase("epoch0", &manifest));
+  const std::string& first = manifest->GetCurrentEpoch();
+
+  std::atomic<bool> stop{false};
+  std::thread reader([&]() {
+    while (!stop.load()) {
+      // File 5 stays in the first epoch whatever the epochs added.
+      ASSERT_EQ(manifest->GetEpoch(5), "epoch0");
+      ASSERT_FALSE(manifest->GetCurrentEpoch().empty());
+    }
+  });
+  for (int i = 1; i <= 1000; i++) {
+    ASSERT_TRUE(manifest->AddEpoch(10 * i, "epoch" + std::to_string(i)));
+  }
+  stop.store(true);
+  reader.join();
+
+  // The epochs returned before stay valid.
+  ASSERT_EQ(first, "epoch0");
+  ASSERT_EQ(manifest->GetEpoch(15), "epoch1");
+  ASSERT_EQ(manifest->GetEpoch(9999), "epoch999");
+  ASSERT_EQ(manifest->GetEpoch(10000), "epoch1000");
+  ASSERT_EQ(manifest->GetCurrentEpoch(), "epoch1000");
+}
+
 }  //  namespace ROCKSDB_NAMESPACE
 
 int main(int argc, char** argv) {
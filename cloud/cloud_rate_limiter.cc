@@ -0,0 +1,145 @@
+//  Copyright (c) 2016-present, Rockset, Inc.  All rights reserved.
+
+#include "rocksdb/cloud/cloud_rate_limiter.h"
+
+#include <algorithm>
+#include <cmath>
+
+#include "rocksdb/rate_limiter.h"
+#include "rocksdb/system_clock.h"
+
+namespace ROCKSDB_NAMESPACE {
+
+namespace {
+// A request is worth this many units of its GenericRateLimiter, so that a
+// budget of a few requests per second still refills every period.
+const int64_t kRequestUnits = 1000;
+
+Env::IOPriority Sanitize(Env::IOPriority pri) {
+  return pri == Env::IO_TOTAL ? Env::IO_USER : pri;
+}
+
+std::unique_ptr<RateLimiter> NewLimiter(const CloudRateLimiterOptions& options,
+                                        int64_t rate,
+                                        int64_t single_burst_bytes = 0) {
+  if (rate <= 0) {
+    return nullptr;
+  }
+  return std::unique_ptr<RateLimiter>(NewGenericRateLimiter(
+      rate, options.refill_period_us, options.fairness,
+      RateLimiter::Mode::kAllIo, false /* auto_tuned */, single_burst_bytes));
+}
+}  // namespace
+
+CloudRateLimiter::CloudRateLimiter(const CloudRateLimiterOptions& options)
+    : options_(options), clock_(SystemClock::Default()) {
+  download_.bytes = NewLimiter(options_, options_.download_bytes_per_sec);
+  upload_.bytes = NewLimiter(options_, options_.upload_bytes_per_sec);
+  download_.max_requests_per_sec =
+      std::max<int64_t>(0, options_.download_requests_per_sec);
+  upload_.max_requests_per_sec =
+      std::max<int64_t>(0, options_.upload_requests_per_sec);
+  for (auto* budget : {&download_, &upload_}) {
+    budget->requests_per_sec = budget->max_requests_per_sec;
+    budget->requests =
+        NewLimiter(options_, budget->requests_per_sec * kRequestUnits,
+                   kRequestUnits);
+  }
+}
+
+CloudRateLimiter::~CloudRateLimiter() {}
+
+void CloudRateLimiter::Request(Direction direction, uint64_t bytes,
+                               Env::IOPriority pri) {
+  auto& budget = GetBudget(direction);
+  budget.total_requests.fetch_add(1, std::memory_order_relaxed);
+  if (budget.requests) {
+    MaybeRecover();
+    budget.requests->Request(kRequestUnits, Sanitize(pri), nullptr);
+  }
+  ChargeBytes(direction, bytes, pri);
+}
+
+void CloudRateLimiter::ChargeBytes(Direction direction, uint64_t bytes,
+                                   Env::IOPriority pri) {
+  auto& budget = GetBudget(direction);
+  budget.total_bytes.fetch_add(bytes, std::memory_order_relaxed);
+  if (!budget.bytes) {
+    return;
+  }
+  // Large transfers are charged one burst at a time.
+  pri = Sanitize(pri);
+  while (bytes > 0) {
+    auto burst = static_cast<uint64_t>(
+        std::max<int64_t>(1, budget.bytes->GetSingleBurstBytes()));
+    auto n = std::min(bytes, burst);
+    budget.bytes->Request(static_cast<int64_t>(n), pri, nullptr);
+    bytes -= n;
+  }
+}
+
+void CloudRateLimiter::SetRequestsPerSecond(Budget* budget,
+                                            int64_t requests_per_sec) {
+  if (!budget->requests) {
+    return;
+  }
+  requests_per_sec = std::min(budget->max_requests_per_sec,
+                              std::max<int64_t>(1, requests_per_sec));
+  if (requests_per_sec != budget->requests_per_sec) {
+    budget->requests_per_sec = requests_per_sec;
+    budget->requests->SetBytesPerSecond(requests_per_sec * kRequestUnits);
+  }
+}
+
+void CloudRateLimiter::OnThrottled() {
+  throttles_.fetch_add(1, std::memory_order_relaxed);
+  std::lock_guard<std::mutex> lk(mutex_);
+  for (auto* budget : {&download_, &upload_}) {
+    SetRequestsPerSecond(budget,
+                         static_cast<int64_t>(std::floor(
+                             budget->requests_per_sec *
+                             options_.throttle_backoff)));
+  }
+  backoff_micros_.store(clock_->NowMicros(), std::memory_order_relaxed);
+}
+
+void CloudRateLimiter::MaybeRecover() {
+  auto since = backoff_micros_.load(std::memory_order_relaxed);
+  if (since == 0 ||
+      clock_->NowMicros() < since + options_.throttle_recovery_micros) {
+    return;
+  }
+  std::lock_guard<std::mutex> lk(mutex_);
+  since = backoff_micros_.load(std::memory_order_relaxed);
+  auto now = clock_->NowMicros();
+  if (since == 0 || now < since + options_.throttle_recovery_micros) {
+    return;
+  }
+  bool recovered = true;
+  for (auto* budget : {&download_, &upload_}) {
+    if (options_.throttle_backoff > 0 && options_.throttle_backoff < 1) {
+      SetRequestsPerSecond(
+          budget, static_cast<int64_t>(std::ceil(budget->requests_per_sec /
+                                                 options_.throttle_backoff)));
+    } else {
+      SetRequestsPerSecond(budget, budget->max_requests_per_sec);
+    }
+    recovered &= budget->requests_per_sec == budget->max_requests_per_sec;
+  }
+  backoff_micros_.store(recovered ? 0 : now, std::memory_order_relaxed);
+}
+
+int64_t CloudRateLimiter::GetRequestsPerSecond(Direction direction) const {
+  std::lock_guard<std::mutex> lk(mutex_);
+  return GetBudget(direction).requests_per_sec;
+}
+
+uint64_t CloudRateLimiter::GetTotalBytes(Direction direction) const {
+  return GetBudget(direction).total_bytes.load(std::memory_order_relaxed);
+}
+
+uint64_t CloudRateLimiter::GetTotalRequests(Direction direction) const {
+  return GetBudget(direction).total_requests.load(std::memory_order_relaxed);
+}
+
+}  // namespace ROCKSDB_NAMESPACE
@@ -0,0 +1,61 @@
+//  Copyright (c) 2016-present, Rockset, Inc.  All rights reserved.
+
+#include "rocksdb/cloud/cloud_read_hedger.h"
+
+#include <algorithm>
+
+#include "rocksdb/system_clock.h"
+
+namespace ROCKSDB_NAMESPACE {
+
+namespace {
+// Number of recent latencies the hedging delay is derived from.
+const size_t kLatencyWindow = 1024;
+// The delay is recomputed every that many reads, the first time once that
+// many latencies were sampled.
+const size_t kDelayRefreshInterval = 64;
+}  // namespace
+
+CloudReadHedger::CloudReadHedger(const CloudReadHedgerOptions& options)
+    : options_(options),
+      clock_(SystemClock::Default()),
+      budget_(options.max_hedge_burst) {
+  latencies_.reserve(kLatencyWindow);
+}
+
+CloudReadHedger::~CloudReadHedger() {}
+
+void CloudReadHedger::RecordRead(uint64_t micros) {
+  auto reads = reads_.fetch_add(1, std::memory_order_relaxed) + 1;
+  std::lock_guard<std::mutex> lk(mutex_);
+  budget_ =
+      std::min(options_.max_hedge_burst, budget_ + options_.max_hedge_ratio);
+  if (latencies_.size() < kLatencyWindow) {
+    latencies_.push_back(micros);
+  } else {
+    latencies_[next_latency_] = micros;
+    next_latency_ = (next_latency_ + 1) % kLatencyWindow;
+  }
+  if (reads % kDelayRefreshInterval != 0) {
+    return;
+  }
+  std::vector<uint64_t> sorted(latencies_);
+  double pct = std::max(0.0, std::min(100.0, options_.percentile));
+  auto rank = std::min(sorted.size() - 1,
+                       static_cast<size_t>(sorted.size() * pct / 100));
+  std::nth_element(sorted.begin(), sorted.begin() + rank, sorted.end());
+  delay_micros_.store(std::max(options_.min_delay_micros, sorted[rank]),
+                      std::memory_order_relaxed);
+}
+
+bool CloudReadHedger::TryAcquireHedge() {
+  std::lock_guard<std::mutex> lk(mutex_);
+  if (budget_ < 1) {
+    return false;
+  }
+  budget_ -= 1;
+  hedges_.fetch_add(1, std::memory_order_relaxed);
+  return true;
+}
+
+}  // namespace ROCKSDB_NAMESPACE
@@ -0,0 +1,87 @@
+// Copyright (c) 2017 Rockset
+
+#include "cloud/cloud_request_stats.h"
+
+#include "monitoring/perf_context_imp.h"
+#include "monitoring/statistics_impl.h"
+
+namespace ROCKSDB_NAMESPACE {
+
+namespace {
+void GetRequestStats(CloudRequestOpType type, Tickers* ticker,
+                     Histograms* histogram) {
+  switch (type) {
+    case CloudRequestOpType::kReadOp:
+      *ticker = CLOUD_READ_REQUESTS;
+      *histogram = CLOUD_READ_MICROS;
+      break;
+    case CloudRequestOpType::kWriteOp:
+      *ticker = CLOUD_WRITE_REQUESTS;
+      *histogram = CLOUD_WRITE_MICROS;
+      break;
+    case CloudRequestOpType::kListOp:
+      *ticker = CLOUD_LIST_REQUESTS;
+      *histogram = CLOUD_LIST_MICROS;
+      break;
+    case CloudRequestOpType::kCreateOp:
+      *ticker = CLOUD_CREATE_REQUESTS;
+      *histogram = CLOUD_CREATE_MICROS;
+      break;
+    case CloudRequestOpType::kDeleteOp:
+      *ticker = CLOUD_DELETE_REQUESTS;
+      *histogram = CLOUD_DELETE_MICROS;
+      break;
+    case CloudRequestOpType::kCopyOp:
+      *ticker = CLOUD_COPY_REQUESTS;
+      *histogram = CLOUD_COPY_MICROS;
+      break;
+    case CloudRequestOpType::kInfoOp:
+      *ticker = CLOUD_INFO_REQUESTS;
+      *histogram = CLOUD_INFO_MICROS;
+      break;
+  }
+}
+}  // namespace
+
+void RecordCloudRequest(Statistics* statistics, CloudRequestOpType type,
+                        uint64_t size, uint64_t micros, bool success) {
+  const bool is_read = type == CloudRequestOpType::kReadOp;
+  const bool is_write = type == CloudRequestOpType::kWriteOp;
+  PERF_COUNTER_ADD(cloud_request_count, 1);
+  if (is_read) {
+    PERF_COUNTER_ADD(cloud_read_byte, size);
+  } else if (is_write) {
+    PERF_COUNTER_ADD(cloud_write_byte, size);
+  }
+#if !defined(NPERF_CONTEXT)
+  if (PerfLevelEnabled(PerfLevel::kEnableTimeExceptForMutex)) {
+    perf_context.cloud_request_nanos += micros * 1000;
+  }
+#endif
+
+  if (statistics == nullptr) {
+    return;
+  }
+  Tickers ticker = CLOUD_READ_REQUESTS;
+  Histograms histogram = CLOUD_READ_MICROS;
+  GetRequestStats(type, &ticker, &histogram);
+  RecordTick(statistics, ticker);
+  RecordTimeToHistogram(statistics, histogram, micros);
+  if (!success) {
+    RecordTick(statistics, CLOUD_REQUEST_FAILURES);
+  }
+  if (is_read) {
+    RecordTick(statistics, CLOUD_BYTES_READ, size);
+  } else if (is_write) {
+    RecordTick(statistics, CLOUD_BYTES_WRITTEN, size);
+  }
+}
+
+void RecordCloudRequestRetry(Statistics* statistics, bool throttled) {
+  RecordTick(statistics, CLOUD_REQUEST_RETRIES);
+  if (throttled) {
+    RecordTick(statistics, CLOUD_REQUEST_THROTTLES);
+  }
+}
+
+}  // namespace ROCKSDB_NAMESPACE
@@ -0,0 +1,25 @@
+// Copyright (c) 2017 Rockset
+
+#pragma once
+
+#include <cstdint>
+
+#include "rocksdb/cloud/cloud_file_system.h"
+
+namespace ROCKSDB_NAMESPACE {
+
+class Statistics;
+
+// Records one completed request to the cloud storage: its count, latency and
+// bytes by type of request in statistics, if not null, and in the
+// PerfContext of the calling thread. micros covers the whole request,
+// retries included. size is the number of bytes transferred.
+void RecordCloudRequest(Statistics* statistics, CloudRequestOpType type,
+                        uint64_t size, uint64_t micros, bool success);
+
+// Records that a request to the cloud storage is about to be retried.
+// throttled is true if the storage rejected the previous attempt because of
+// throttling.
+void RecordCloudRequestRetry(Statistics* statistics, bool throttled);
+
+}  // namespace ROCKSDB_NAMESPACE
@@ -2,40 +2,54 @@
 #ifndef ROCKSDB_LITE
 #include "cloud/cloud_scheduler.h"
 
+#include <algorithm>
 #include <chrono>
 #include <condition_variable>
 #include <memory>
 #include <mutex>
 #include <thread>
+#include <tuple>
 #include <unordered_map>
+#include <vector>
 
+#include "monitoring/statistics_impl.h"
 #include "test_util/sync_point.h"
 
 namespace ROCKSDB_NAMESPACE {
 
+namespace {
+constexpr int kNumThreads = 4;
+constexpr int kNumJobClasses =
+    static_cast<int>(CloudScheduler::JobClass::kFileDeletion) + 1;
+
+// The scheduler whose job the calling thread is running, if any.
+thread_local const void* t_running_job_of = nullptr;
+}  // namespace
+
 struct ScheduledJob {
-  ScheduledJob(long _id, std::chrono::steady_clock::time_point _when,
+  ScheduledJob(std::chrono::steady_clock::time_point _when,
                std::chrono::microseconds _frequency,
-               std::function<void(void*)> _callback, void* _arg)
-      : id(_id),
-        when(_when),
+               std::function<void(void*)> _callback, void* _arg,
+               CloudScheduler::JobClass _job_class,
+               std::shared_ptr<Statistics> _statistics)
+      : when(_when),
         frequency(_frequency),
-        callback(_callback),
-        arg(_arg) {}
+        callback(std::move(_callback)),
+        arg(_arg),
+        job_class(_job_class),
+        statistics(std::move(_statistics)) {}
 
-  long id;
   std::chrono::steady_clock::time_point when;
   std::chrono::microseconds frequency;
   std::function<void(void*)> callback;
 
   // Caller is responsible for the lifetime of arg.
   void* arg;
-};
-
-struct Comp {
-  bool operator()(const ScheduledJob& a, const ScheduledJob& b) const {
-    return a.when < b.when;
-  }
+  CloudScheduler::JobClass job_class;
+  std::shared_ptr<Statistics> statistics;
+  bool running = false;
+  // Canceled while running: not rescheduled.
+  bool canceled = false;
 };
 
 class CloudSchedulerImpl : public CloudScheduler {
@@ -43,34 +57,56 @@ class CloudSchedulerImpl : public CloudScheduler {
   CloudSchedulerImpl();
   ~CloudSchedulerImpl();
   long ScheduleJob(std::chrono::microseconds when,
-                   std::function<void(void*)> callback, void* arg) override;
+                   std::function<void(void*)> callback, void* arg,
+                   JobClass job_class = JobClass::kDefault) override {
+    return DoScheduleJob(when, std::chrono::microseconds(0),
+                         std::move(callback), arg, job_class, nullptr);
+  }
   long ScheduleRecurringJob(std::chrono::microseconds when,
                             std::chrono::microseconds frequency,
-                            std::function<void(void*)> callback,
-                            void* arg) override;
+                            std::function<void(void*)> callback, void* arg,
+                            JobClass job_class = JobClass::kDefault) override {
+    return DoScheduleJob(when, frequency, std::move(callback), arg, job_class,
+                         nullptr);
+  }
   bool CancelJob(long handle) override;
   bool IsScheduled(long handle) override;
 
   size_t TEST_NumScheduledJobs() const override {
     std::lock_guard<std::mutex> lk(mutex_);
-    return scheduled_jobs_.size();
+    return jobs_.size();
   }
 
+  long DoScheduleJob(std::chrono::microseconds when,
+                     std::chrono::microseconds frequency,
+                     std::function<void(void*)> callback, void* arg,
+                     JobClass job_class,
+                     std::shared_ptr<Statistics> statistics);
+  int SetConcurrencyLimit(JobClass job_class, int limit);
+
  private:
   void DoWork();
+  // Adds the job to the timers of its class, and wakes up a thread if it
+  // is the earliest.
+  void ArmLocked(long id, const ScheduledJob& job);
   long next_id_;
 
   mutable std::mutex mutex_;
-  // Notified when the earliest job to be scheduled has changed or
-  // currently_running_ has changed.
+  // Notified when the earliest job to be scheduled has changed or a job
+  // has finished running.
   std::condition_variable jobs_changed_cv_;
-  std::multiset<ScheduledJob, Comp> scheduled_jobs_;
-  // Whether the job in the front of scheduled_jobs_ is running
-  bool currently_running_;
+  // The scheduled and running jobs by id. A job is in the timers of its
+  // class while it waits, so that it is found in O(log n) both when it is
+  // due and when it is canceled.
+  std::unordered_map<long, ScheduledJob> jobs_;
+  std::set<std::pair<std::chrono::steady_clock::time_point, long>>
+      timers_[kNumJobClasses];
+  int running_[kNumJobClasses] = {};
+  int limits_[kNumJobClasses];
 
   bool shutting_down_{false};
 
-  std::unique_ptr<std::thread> thread_;
+  std::vector<std::thread> threads_;
 };
 // Implementation of a CloudScheduler that keeps track of the jobs
 // it scheduled.  Only cleans up those jobs on exit or cancel.
@@ -81,18 +117,18 @@ class LocalCloudScheduler
 
  public:
   static std::shared_ptr<CloudScheduler> Create(
-      const std::shared_ptr<CloudScheduler>& scheduler, long local_id) {
+      const std::shared_ptr<CloudSchedulerImpl>& scheduler, long local_id,
+      std::shared_ptr<Statistics> statistics) {
     return std::make_shared<LocalCloudScheduler>(
-      PrivateTag(),
-      scheduler,
-      local_id);
+        PrivateTag(), scheduler, local_id, std::move(statistics));
   }
 
-  explicit LocalCloudScheduler(PrivateTag,
-                      const std::shared_ptr<CloudScheduler>& scheduler,
-                      long local_id)
+  explicit LocalCloudScheduler(
+      PrivateTag, const std::shared_ptr<CloudSchedulerImpl>& scheduler,
+      long local_id, std::shared_ptr<Statistics> statistics)
       : scheduler_(scheduler),
-        next_local_id_(local_id) {}
+        next_local_id_(local_id),
+        statistics_(std::move(statistics)) {}
   ~LocalCloudScheduler() override {
     TEST_SYNC_POINT(
         "LocalCloudScheduler::~LocalCloudScheduler:BeforeCancelJobs1");
@@ -109,7 +145,8 @@ class LocalCloudScheduler
   }
 
   long ScheduleJob(std::chrono::microseconds when,
-                   std::function<void(void*)> callback, void* arg) override {
+                   std::function<void(void*)> callback, void* arg,
+                   JobClass job_class = JobClass::kDefault) override {
     std::lock_guard<std::mutex> lk(job_mutex_);
     long local_id = next_local_id_++;
     auto wp = this->weak_from_this();
@@ -127,15 +164,18 @@ class LocalCloudScheduler
       // make sure `job_erased` is not unused variable when compiling in release mode
       (void)job_erased;
     };
-    jobs_[local_id] = scheduler_->ScheduleJob(when, job, arg);
+    jobs_[local_id] =
+        scheduler_->DoScheduleJob(when, std::chrono::microseconds(0), job, arg,
+                                  job_class, statistics_);
     return local_id;
   }
 
   long ScheduleRecurringJob(std::chrono::microseconds when,
                             std::chrono::microseconds frequency,
-                            std::function<void(void*)> callback,
-                            void* arg) override {
-    auto job = scheduler_->ScheduleRecurringJob(when, frequency, callback, arg);
+                            std::function<void(void*)> callback, void* arg,
+                            JobClass job_class = JobClass::kDefault) override {
+    auto job = scheduler_->DoScheduleJob(when, frequency, callback, arg,
+                                         job_class, statistics_);
     std::lock_guard<std::mutex> lk(job_mutex_);
     long local_id = next_local_id_++;
     jobs_[local_id] = job;
@@ -184,8 +224,9 @@ class LocalCloudScheduler
 
  private:
   mutable std::mutex job_mutex_;
-  std::shared_ptr<CloudScheduler> scheduler_;
+  std::shared_ptr<CloudSchedulerImpl> scheduler_;
   long next_local_id_;
+  std::shared_ptr<Statistics> statistics_;
   std::unordered_map<long, long> jobs_;
 
   void DoEraseJob(long local_id) {
@@ -194,81 +235,94 @@ class LocalCloudScheduler
   }
 };
 
-std::shared_ptr<CloudScheduler> CloudScheduler::Get() {
+namespace {
+const std::shared_ptr<CloudSchedulerImpl>& GetSchedulerImpl() {
   static std::shared_ptr<CloudSchedulerImpl> scheduler =
       std::make_shared<CloudSchedulerImpl>();
+  return scheduler;
+}
+}  // namespace
+
+std::shared_ptr<CloudScheduler> CloudScheduler::Get(
+    std::shared_ptr<Statistics> statistics) {
+  const auto& scheduler = GetSchedulerImpl();
   static long local_scheduler_id = 0;
 
-  std::shared_ptr<CloudScheduler> result =
-      LocalCloudScheduler::Create(scheduler, local_scheduler_id);
+  std::shared_ptr<CloudScheduler> result = LocalCloudScheduler::Create(
+      scheduler, local_scheduler_id, std::move(statistics));
   local_scheduler_id += 10000;
   return result;
 }
 
+int CloudScheduler::SetConcurrencyLimit(JobClass job_class, int limit) {
+  return GetSchedulerImpl()->SetConcurrencyLimit(job_class, limit);
+}
+
 CloudSchedulerImpl::CloudSchedulerImpl() {
   next_id_ = 1;
-  currently_running_ = false;
-  auto lambda = [this]() { DoWork(); };
-  thread_.reset(new std::thread(lambda));
+  for (int i = 0; i < kNumJobClasses; i++) {
+    limits_[i] = kNumThreads;
+  }
+  limits_[static_cast<int>(JobClass::kFileDeletion)] = kNumThreads - 1;
+  for (int i = 0; i < kNumThreads; i++) {
+    threads_.emplace_back([this]() { DoWork(); });
+  }
 }
 
 CloudSchedulerImpl::~CloudSchedulerImpl() {
   {
     std::lock_guard<std::mutex> lk(mutex_);
     shutting_down_ = true;
-    scheduled_jobs_.clear();
+    for (auto& timers : timers_) {
+      timers.clear();
+    }
     jobs_changed_cv_.notify_all();
   }
-  if (thread_ && thread_->joinable()) {
-    thread_->join();
+  for (auto& t : threads_) {
+    t.join();
   }
-  thread_.reset();
+  threads_.clear();
+  jobs_.clear();
 }
 
-long CloudSchedulerImpl::ScheduleJob(std::chrono::microseconds when,
-                                     std::function<void(void*)> callback,
-                                     void* arg) {
+long CloudSchedulerImpl::DoScheduleJob(
+    std::chrono::microseconds when, std::chrono::microseconds frequency,
+    std::function<void(void*)> callback, void* arg, JobClass job_class,
+    std::shared_ptr<Statistics> statistics) {
   std::lock_guard<std::mutex> lk(mutex_);
   long id = next_id_++;
 
   auto time = std::chrono::steady_clock::now() + when;
-  auto itr = scheduled_jobs_.emplace(id, time, std::chrono::microseconds(0),
-                                     callback, arg);
+  auto itr = jobs_.emplace(
+      std::piecewise_construct, std::forward_as_tuple(id),
+      std::forward_as_tuple(time, frequency, std::move(callback), arg,
+                            job_class, std::move(statistics)));
+  ArmLocked(id, itr.first->second);
+  return id;
+}
 
-  if (itr == scheduled_jobs_.begin()) {
+void CloudSchedulerImpl::ArmLocked(long id, const ScheduledJob& job) {
+  auto& timers = timers_[static_cast<int>(job.job_class)];
+  auto itr = timers.emplace(job.when, id).first;
+  if (itr == timers.begin()) {
     jobs_changed_cv_.notify_all();
   }
-  return id;
 }
 
-long CloudSchedulerImpl::ScheduleRecurringJob(
-    std::chrono::microseconds when, std::chrono::microseconds frequency,
-    std::function<void(void*)> callback, void* arg) {
+int CloudSchedulerImpl::SetConcurrencyLimit(JobClass job_class, int limit) {
   std::lock_guard<std::mutex> lk(mutex_);
-  long id = next_id_++;
-
-  auto time = std::chrono::steady_clock::now() + when;
-  auto itr = scheduled_jobs_.emplace(id, time, frequency, callback, arg);
-  if (itr == scheduled_jobs_.begin()) {
-    jobs_changed_cv_.notify_all();
-  }
-  return id;
+  int old_limit = limits_[static_cast<int>(job_class)];
+  limits_[static_cast<int>(job_class)] = std::max(1, limit);
+  jobs_changed_cv_.notify_all();
+  return old_limit;
 }
 
 bool CloudSchedulerImpl::IsScheduled(long id) {
   if (id < 0) {
     return false;
-  } else {
-    std::unique_lock<std::mutex> lk(mutex_);
-    if (!scheduled_jobs_.empty()) {
-      for (const auto& job : scheduled_jobs_) {
-        if (job.id == id) {
-          return true;
-        }
-      }
-    }
-    return false;
   }
+  std::lock_guard<std::mutex> lk(mutex_);
+  return jobs_.find(id) != jobs_.end();
 }
 
 bool CloudSchedulerImpl::CancelJob(long id) {
@@ -277,37 +331,39 @@ bool CloudSchedulerImpl::CancelJob(long id) {
   }
 
   std::unique_lock<std::mutex> lk(mutex_);
-  jobs_changed_cv_.wait(lk, [this, id]() {
-    // No job is scheduled. Good to continue.
-    if (scheduled_jobs_.empty()) {
-      return true;
-    }
-
-    // Front of the queue is not this job. That means this job is not running.
-    // We're clear to cancel this job.
-    if (scheduled_jobs_.begin()->id != id) {
-      return true;
-    }
-
-    // Front of the queue is the current job. That means only continue if this
-    // job is not running. If it's still running, wait.
-    return !currently_running_;
-  });
-
-  for (auto it = scheduled_jobs_.begin(); it != scheduled_jobs_.end(); ++it) {
-    if (it->id == id) {
-      bool is_first = (it == scheduled_jobs_.begin());
-      scheduled_jobs_.erase(it);
-      if (is_first) {
-        jobs_changed_cv_.notify_all();
-      }
+  auto itr = jobs_.find(id);
+  if (itr != jobs_.end() && itr->second.running) {
+    if (t_running_job_of == this) {
+      // Called from a job. The running job may be waiting for this one, so
+      // it is only kept from running again.
+      itr->second.canceled = true;
       return true;
     }
+    // Wait for the job to finish running.
+    jobs_changed_cv_.wait(lk, [this, id]() {
+      auto it = jobs_.find(id);
+      return it == jobs_.end() || !it->second.running;
+    });
+    itr = jobs_.find(id);
+  }
+  if (itr == jobs_.end()) {
+    return false;
+  }
+  auto& timers = timers_[static_cast<int>(itr->second.job_class)];
+  auto timer = timers.find(std::make_pair(itr->second.when, id));
+  bool is_first = (timer == timers.begin());
+  if (timer != timers.end()) {
+    timers.erase(timer);
+  }
+  jobs_.erase(itr);
+  if (is_first) {
+    jobs_changed_cv_.notify_all();
   }
-  return false;
+  return true;
 }
 
 void CloudSchedulerImpl::DoWork() {
+  t_running_job_of = this;
   while (true) {
     // This sync point has to be put before locking mutex_, otherwise
     // CancelJob won't be able to acquire mutex when called
@@ -316,37 +372,64 @@ void CloudSchedulerImpl::DoWork() {
     if (shutting_down_) {
       break;
     }
-    if (scheduled_jobs_.empty()) {
+    // The earliest job among the classes below their limit.
+    int job_class = -1;
+    for (int i = 0; i < kNumJobClasses; i++) {
+      if (timers_[i].empty() || running_[i] >= limits_[i]) {
+        continue;
+      }
+      if (job_class < 0 ||
+          timers_[i].begin()->first < timers_[job_class].begin()->first) {
+        job_class = i;
+      }
+    }
+    if (job_class < 0) {
       jobs_changed_cv_.wait(lk);
       continue;
     }
-    auto earliest_job = scheduled_jobs_.begin();
-    auto earliest_job_time = earliest_job->when;
-    if (earliest_job_time >= std::chrono::steady_clock::now()) {
+    auto now = std::chrono::steady_clock::now();
+    auto earliest_job_time = timers_[job_class].begin()->first;
+    if (earliest_job_time >= now) {
       jobs_changed_cv_.wait_until(lk, earliest_job_time);
       continue;
     }
 
-    currently_running_ = true;
+    long id = timers_[job_class].begin()->second;
+    timers_[job_class].erase(timers_[job_class].begin());
+    auto& job = jobs_.at(id);
+    job.running = true;
+    running_[job_class]++;
+    auto callback = job.callback;
+    auto arg = job.arg;
+    RecordInHistogram(
+        job.statistics.get(), CLOUD_SCHEDULER_LAG_MICROS,
+        std::chrono::duration_cast<std::chrono::microseconds>(
+            now - earliest_job_time)
+            .count());
     lk.unlock();
 
     // invoke the function
-    earliest_job->callback(earliest_job->arg);
+    callback(arg);
 
     lk.lock();
-    // Finished running the job. Remove it from the queue.
-    currently_running_ = false;
-
-    // If this is a recurring job, add back to the queue.
-    if (earliest_job->frequency.count() > 0) {
-      ScheduledJob new_job = *earliest_job;
-      new_job.when = std::chrono::steady_clock::now() + new_job.frequency;
-      scheduled_jobs_.emplace(new_job);
+    // Finished running the job.
+    running_[job_class]--;
+    auto itr = jobs_.find(id);
+    if (itr != jobs_.end()) {
+      // If this is a recurring job, add back to the queue.
+      if (itr->second.frequency.count() > 0 && !itr->second.canceled &&
+          !shutting_down_) {
+        itr->second.running = false;
+        itr->second.when =
+            std::chrono::steady_clock::now() + itr->second.frequency;
+        ArmLocked(id, itr->second);
+      } else {
+        jobs_.erase(itr);
+      }
     }
-    scheduled_jobs_.erase(earliest_job);
 
-    // We might be waiting for the change in currently_running_job_id_ when
-    // cancelling a job.
+    // We might be waiting for the job to finish when cancelling it, or for
+    // a slot of its class.
     jobs_changed_cv_.notify_all();
   }
 }
@@ -12,29 +12,44 @@
 
 namespace ROCKSDB_NAMESPACE {
 #ifndef ROCKSDB_LITE
-// Class for scheduling jobs to run on a separate thread
+class Statistics;
+
+// Class for scheduling jobs to run on a pool of threads shared by the
+// process. The CLOUD_SCHEDULER_LAG_MICROS histogram records how late the
+// jobs start.
 class CloudScheduler {
  public:
+  // The jobs of a class run at most SetConcurrencyLimit() at once, so that
+  // a class of slow jobs does not hold all the threads.
+  enum class JobClass {
+    kDefault,
+    // Delayed deletions of cloud files, see CloudFileDeletionScheduler.
+    kFileDeletion,
+  };
+
   virtual ~CloudScheduler() {}
 
   // Schedules a job to run after "when" microseconds have elapsed,
   // invoking the specified callback with the specified arg
   // Returns a handle to the scheduled job so that it may be canceled
   virtual long ScheduleJob(std::chrono::microseconds when,
-                           std::function<void(void *)> callback, void *arg) = 0;
+                           std::function<void(void *)> callback, void *arg,
+                           JobClass job_class = JobClass::kDefault) = 0;
 
   // Schedules a job to run after "when" microseconds have elapsed,
   // invoking the specified callback with the specified arg
   // Returns a handle to the scheduled job so that it may be canceled.
   // The callback will be invoked every frequency microseconds until
   // the job is canceled or the scheduler is shutdown
-  virtual long ScheduleRecurringJob(std::chrono::microseconds when,
-                                    std::chrono::microseconds frequency,
-                                    std::function<void(void *)> callback,
-                                    void *arg) = 0;
+  virtual long ScheduleRecurringJob(
+      std::chrono::microseconds when, std::chrono::microseconds frequency,
+      std::function<void(void *)> callback, void *arg,
+      JobClass job_class = JobClass::kDefault) = 0;
 
   // Cancels the job represented by handle.  Returns true if the job
   // was canceled, false otherwise.
+  // If the job is running, waits for it to finish, unless called from a
+  // job: a job does not wait for the others, which may be waiting for it.
   virtual bool CancelJob(long handle) = 0;
 
   // Get number of running jobs
@@ -47,7 +62,16 @@ class CloudScheduler {
   virtual bool IsScheduled(long handle) = 0;
   // Returns a new instance of a cloud scheduler.  The caller is responsible
   // for freeing the scheduler when it is no longer required.
-  static std::shared_ptr<CloudScheduler> Get();
+  // The lag of its jobs is recorded in statistics, if not null.
+  static std::shared_ptr<CloudScheduler> Get(
+      std::shared_ptr<Statistics> statistics = nullptr);
+
+  // Sets the number of jobs of job_class that may run at once in the
+  // process, out of the 4 threads of the pool, and returns the previous
+  // limit. Applies to the jobs that start after the call.
+  // Default: 4, and 3 for kFileDeletion so that the other jobs always have a
+  // thread
+  static int SetConcurrencyLimit(JobClass job_class, int limit);
 };
 #endif  // ROCKSDB_LITE
 }  // namespace ROCKSDB_NAMESPACE
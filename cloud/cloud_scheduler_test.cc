@@ -12,6 +12,7 @@
 #include <thread>
 #include <unordered_set>
 
+#include "rocksdb/statistics.h"
 #include "test_util/sync_point.h"
 
 namespace ROCKSDB_NAMESPACE {
@@ -216,6 +217,101 @@ TEST_F(CloudSchedulerTest, JobErasedTest) {
   }
 }
 
+// A long job does not hold the other jobs.
+TEST_F(CloudSchedulerTest, ConcurrentJobs) {
+  std::atomic<bool> release{false};
+  std::atomic<bool> done{false};
+  auto h1 = scheduler_->ScheduleJob(
+      std::chrono::microseconds(0),
+      [&release](void *) {
+        while (!release) {
+          usleep(100);
+        }
+      },
+      nullptr);
+  auto h2 = scheduler_->ScheduleJob(
+      std::chrono::microseconds(100), [&done](void *) { done = true; },
+      nullptr);
+  WaitForJobs({h2}, 100);
+  ASSERT_TRUE(done);
+  ASSERT_TRUE(scheduler_->IsScheduled(h1));
+  release = true;
+  WaitForJobs({h1}, 100);
+}
+
+// The jobs of a class run at most its limit at once.
+TEST_F(CloudSchedulerTest, ConcurrencyLimit) {
+  auto old_limit = CloudScheduler::SetConcurrencyLimit(
+      CloudScheduler::JobClass::kFileDeletion, 1);
+  std::atomic<int> running{0};
+  std::atomic<int> max_running{0};
+  auto doJob = [&](void *) {
+    int r = ++running;
+    int m = max_running.load();
+    while (r > m && !max_running.compare_exchange_weak(m, r)) {
+    }
+    usleep(10000);
+    running--;
+  };
+  std::vector<long> handles;
+  for (int i = 0; i < 4; i++) {
+    handles.push_back(
+        scheduler_->ScheduleJob(std::chrono::microseconds(0), doJob, nullptr,
+                                CloudScheduler::JobClass::kFileDeletion));
+  }
+  WaitForJobs(handles, 100);
+  ASSERT_EQ(max_running, 1);
+  CloudScheduler::SetConcurrencyLimit(CloudScheduler::JobClass::kFileDeletion,
+                                      old_limit);
+}
+
+// A job cancels another running job without waiting for it.
+TEST_F(CloudSchedulerTest, CancelFromJob) {
+  std::atomic<bool> release{false};
+  std::atomic<int> runs{0};
+  std::atomic<bool> finished{false};
+  auto h1 = scheduler_->ScheduleRecurringJob(
+      std::chrono::microseconds(0), std::chrono::microseconds(100),
+      [&](void *) {
+        runs++;
+        while (!release) {
+          usleep(100);
+        }
+        finished = true;
+      },
+      nullptr);
+  while (runs == 0) {
+    usleep(100);
+  }
+  std::atomic<bool> canceled{false};
+  auto h2 = scheduler_->ScheduleJob(
+      std::chrono::microseconds(0),
+      [&](void *) { canceled = scheduler_->CancelJob(h1); }, nullptr);
+  WaitForJobs({h2}, 100);
+  ASSERT_TRUE(canceled);
+  release = true;
+  while (!finished) {
+    usleep(100);
+  }
+  // The recurring job is not rescheduled.
+  usleep(1000);
+  ASSERT_EQ(runs, 1);
+}
+
+TEST(CloudSchedulerStatsTest, Lag) {
+  auto stats = CreateDBStatistics();
+  auto scheduler = CloudScheduler::Get(stats);
+  std::atomic<int> runs{0};
+  scheduler->ScheduleJob(
+      std::chrono::microseconds(0), [&runs](void *) { runs++; }, nullptr);
+  while (runs == 0 || scheduler->TEST_NumScheduledJobs() > 0) {
+    usleep(100);
+  }
+  HistogramData data;
+  stats->histogramData(CLOUD_SCHEDULER_LAG_MICROS, &data);
+  ASSERT_EQ(data.count, 1);
+}
+
 }  //  namespace ROCKSDB_NAMESPACE
 
 int main(int argc, char **argv) {
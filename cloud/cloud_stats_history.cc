@@ -0,0 +1,180 @@
+// Copyright (c) 2017 Rockset
+
+#include "cloud/cloud_stats_history.h"
+
+#include <algorithm>
+#include <cinttypes>
+#include <cmath>
+#include <cstdio>
+
+#include "rocksdb/statistics.h"
+#include "util/coding.h"
+#include "util/crc32c.h"
+
+namespace ROCKSDB_NAMESPACE {
+
+const char* const kCloudStatsHistoryDir = "STATS_HISTORY";
+
+namespace {
+const uint32_t kCloudStatsFormatVersion = 1;
+const char* const kCloudStatPrefix = "rocksdb.cloud.";
+
+Statistics* SourceOf(const std::string& name, Statistics* statistics,
+                     Statistics* cloud_statistics) {
+  if (cloud_statistics != nullptr && name.rfind(kCloudStatPrefix, 0) == 0) {
+    return cloud_statistics;
+  }
+  return statistics;
+}
+
+uint64_t Round(double value) {
+  return value > 0 ? static_cast<uint64_t>(std::llround(value)) : 0;
+}
+}  // namespace
+
+std::string CloudStatsSnapshotObjectName(const CloudStatsSnapshot& snapshot) {
+  char timestamp[24];
+  snprintf(timestamp, sizeof(timestamp), "%020" PRIu64,
+           snapshot.timestamp_micros);
+  return std::string(kCloudStatsHistoryDir) + "/" + snapshot.instance + "/" +
+         timestamp;
+}
+
+void TakeCloudStatsSnapshot(Statistics* statistics,
+                            Statistics* cloud_statistics,
+                            CloudStatsSnapshot* snapshot) {
+  snapshot->stats.clear();
+  for (const auto& ticker : TickersNameMap) {
+    auto* source = SourceOf(ticker.second, statistics, cloud_statistics);
+    if (source == nullptr) {
+      continue;
+    }
+    uint64_t count = source->getTickerCount(ticker.first);
+    if (count > 0) {
+      snapshot->stats[ticker.second] = count;
+    }
+  }
+  for (const auto& histogram : HistogramsNameMap) {
+    auto* source = SourceOf(histogram.second, statistics, cloud_statistics);
+    if (source == nullptr) {
+      continue;
+    }
+    HistogramData data;
+    source->histogramData(histogram.first, &data);
+    if (data.count == 0) {
+      continue;
+    }
+    const std::string& name = histogram.second;
+    snapshot->stats[name + ".count"] = data.count;
+    snapshot->stats[name + ".sum"] = data.sum;
+    snapshot->stats[name + ".max"] = Round(data.max);
+    snapshot->stats[name + ".p50"] = Round(data.median);
+    snapshot->stats[name + ".p95"] = Round(data.percentile95);
+    snapshot->stats[name + ".p99"] = Round(data.percentile99);
+  }
+}
+
+void EncodeCloudStatsSnapshot(const CloudStatsSnapshot& snapshot,
+                              std::string* dst) {
+  const size_t start = dst->size();
+  PutVarint32(dst, kCloudStatsFormatVersion);
+  PutLengthPrefixedSlice(dst, snapshot.instance);
+  PutVarint64(dst, snapshot.timestamp_micros);
+  PutVarint32(dst, static_cast<uint32_t>(snapshot.stats.size()));
+  Slice prev;
+  for (const auto& stat : snapshot.stats) {
+    const std::string& name = stat.first;
+    size_t shared = 0;
+    const size_t limit = std::min(prev.size(), name.size());
+    while (shared < limit && prev[shared] == name[shared]) {
+      shared++;
+    }
+    PutVarint32(dst, static_cast<uint32_t>(shared));
+    PutLengthPrefixedSlice(dst, Slice(name.data() + shared,
+                                      name.size() - shared));
+    PutVarint64(dst, stat.second);
+    prev = name;
+  }
+  PutFixed32(dst, crc32c::Mask(crc32c::Value(dst->data() + start,
+                                             dst->size() - start)));
+}
+
+Status DecodeCloudStatsSnapshot(const Slice& input,
+                                CloudStatsSnapshot* snapshot) {
+  if (input.size() < sizeof(uint32_t)) {
+    return Status::Corruption("Truncated stats snapshot");
+  }
+  const size_t body_size = input.size() - sizeof(uint32_t);
+  const uint32_t crc = crc32c::Unmask(DecodeFixed32(input.data() + body_size));
+  if (crc != crc32c::Value(input.data(), body_size)) {
+    return Status::Corruption("Stats snapshot checksum mismatch");
+  }
+  Slice body(input.data(), body_size);
+  uint32_t version = 0;
+  Slice instance;
+  uint32_t num_stats = 0;
+  if (!GetVarint32(&body, &version) ||
+      !GetLengthPrefixedSlice(&body, &instance) ||
+      !GetVarint64(&body, &snapshot->timestamp_micros) ||
+      !GetVarint32(&body, &num_stats)) {
+    return Status::Corruption("Bad stats snapshot header");
+  }
+  if (version != kCloudStatsFormatVersion) {
+    return Status::NotSupported("Unknown stats snapshot format version " +
+                                std::to_string(version));
+  }
+  snapshot->instance = instance.ToString();
+  snapshot->stats.clear();
+  std::string name;
+  for (uint32_t i = 0; i < num_stats; i++) {
+    uint32_t shared = 0;
+    Slice suffix;
+    uint64_t value = 0;
+    if (!GetVarint32(&body, &shared) || shared > name.size() ||
+        !GetLengthPrefixedSlice(&body, &suffix) ||
+        !GetVarint64(&body, &value)) {
+      return Status::Corruption("Bad stat in stats snapshot");
+    }
+    name.resize(shared);
+    name.append(suffix.data(), suffix.size());
+    snapshot->stats.emplace_hint(snapshot->stats.end(), name, value);
+  }
+  if (!body.empty()) {
+    return Status::Corruption("Trailing bytes in stats snapshot");
+  }
+  return Status::OK();
+}
+
+void MergeCloudStatsSnapshots(
+    const std::vector<CloudStatsSnapshot>& snapshots,
+    std::map<std::string, std::map<std::string, CloudStatsSeries>>* series) {
+  series->clear();
+  std::map<std::string, std::vector<const CloudStatsSnapshot*>> by_instance;
+  for (const auto& snapshot : snapshots) {
+    by_instance[snapshot.instance].push_back(&snapshot);
+  }
+  for (auto& instance : by_instance) {
+    auto& sorted = instance.second;
+    std::sort(sorted.begin(), sorted.end(),
+              [](const CloudStatsSnapshot* a, const CloudStatsSnapshot* b) {
+                return a->timestamp_micros < b->timestamp_micros;
+              });
+    auto& stats = (*series)[instance.first];
+    for (const auto* snapshot : sorted) {
+      for (const auto& stat : snapshot->stats) {
+        stats[stat.first];
+      }
+    }
+    for (auto& stat : stats) {
+      stat.second.reserve(sorted.size());
+      for (const auto* snapshot : sorted) {
+        auto it = snapshot->stats.find(stat.first);
+        stat.second.emplace_back(
+            snapshot->timestamp_micros,
+            it == snapshot->stats.end() ? 0 : it->second);
+      }
+    }
+  }
+}
+
+}  // namespace ROCKSDB_NAMESPACE
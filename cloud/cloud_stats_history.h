@@ -0,0 +1,68 @@
+// Copyright (c) 2017 Rockset
+
+#pragma once
+
+#include <cstdint>
+#include <map>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "rocksdb/slice.h"
+#include "rocksdb/status.h"
+
+namespace ROCKSDB_NAMESPACE {
+
+class Statistics;
+
+// The statistics of a DB at one point in time, as uploaded to the
+// destination bucket every CloudFileSystemOptions::stats_history_period_secs
+// seconds. Each snapshot is a new object, so that the history of a DB
+// survives the instance that ran it. Stats are cumulative since the
+// statistics object was created, and those that are zero are left out.
+struct CloudStatsSnapshot {
+  // Identifies the process that took the snapshot: the host name and the DB
+  // session id, so that the counters of a series never go back to zero.
+  std::string instance;
+  uint64_t timestamp_micros = 0;
+  // The tickers by name, and the count, sum, max and percentiles of each
+  // histogram as "<name>.count", "<name>.sum", "<name>.max", "<name>.p50",
+  // "<name>.p95" and "<name>.p99".
+  std::map<std::string, uint64_t> stats;
+};
+
+// Name of the directory of the snapshots under the object path of the
+// destination bucket. Each instance has a directory below it.
+extern const char* const kCloudStatsHistoryDir;
+
+// Returns the object path of the snapshot, relative to the object path of
+// the bucket. The names of the objects of an instance sort by time.
+std::string CloudStatsSnapshotObjectName(const CloudStatsSnapshot& snapshot);
+
+// Sets the stats of snapshot from the tickers and histograms of statistics.
+// The CLOUD_* stats are taken from cloud_statistics instead if it is not
+// null, see CloudFileSystemOptions::statistics. Either may be null.
+void TakeCloudStatsSnapshot(Statistics* statistics,
+                            Statistics* cloud_statistics,
+                            CloudStatsSnapshot* snapshot);
+
+// Appends the encoding of the snapshot to dst. Names are prefix-compressed
+// against the previous one and the object ends with a checksum.
+void EncodeCloudStatsSnapshot(const CloudStatsSnapshot& snapshot,
+                              std::string* dst);
+// Returns Corruption if input is not a whole, valid snapshot.
+Status DecodeCloudStatsSnapshot(const Slice& input,
+                                CloudStatsSnapshot* snapshot);
+
+// The values of one stat of one instance, in time order, as pairs of the
+// timestamp in microseconds and the value.
+using CloudStatsSeries = std::vector<std::pair<uint64_t, uint64_t>>;
+
+// Merges the snapshots, in any order, into the series of each stat of each
+// instance, replacing the content of series: series[instance][stat]. A stat
+// left out of a snapshot of its instance is zero in the series at that time.
+void MergeCloudStatsSnapshots(
+    const std::vector<CloudStatsSnapshot>& snapshots,
+    std::map<std::string, std::map<std::string, CloudStatsSeries>>* series);
+
+}  // namespace ROCKSDB_NAMESPACE
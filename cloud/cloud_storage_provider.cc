@@ -3,36 +3,138 @@
 
 #include "rocksdb/cloud/cloud_storage_provider.h"
 
+#include <algorithm>
+#include <atomic>
 #include <cinttypes>
+#include <condition_variable>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <numeric>
 
 #include "cloud/filename.h"
 #include "file/filename.h"
+#include "monitoring/op_trace_impl.h"
+#include "rocksdb/cloud/cloud_chunk_cache.h"
+#include "rocksdb/cloud/cloud_compaction_prefetcher.h"
 #include "rocksdb/cloud/cloud_file_system.h"
 #include "rocksdb/cloud/cloud_file_system_impl.h"
+#include "rocksdb/cloud/cloud_rate_limiter.h"
+#include "rocksdb/cloud/cloud_read_hedger.h"
 #include "rocksdb/cloud/cloud_storage_provider_impl.h"
 #include "rocksdb/convenience.h"
 #include "rocksdb/env.h"
 #include "rocksdb/options.h"
 #include "rocksdb/status.h"
+#include "rocksdb/system_clock.h"
+#include "port/port.h"
 #include "rocksdb/utilities/object_registry.h"
+#include "util/coding.h"
+#include "util/crc32c.h"
+#include "util/math.h"
 #include "util/random.h"
 #include "util/string_util.h"
+#include "util/threadpool_imp.h"
 
 namespace ROCKSDB_NAMESPACE {
 #ifndef ROCKSDB_LITE
 /******************** Readablefile ******************/
 CloudStorageReadableFileImpl::CloudStorageReadableFileImpl(
     Logger* info_log, const std::string& bucket, const std::string& fname,
-    uint64_t file_size)
+    uint64_t file_size, const CloudFileSystemOptions* cloud_fs_options)
     : info_log_(info_log),
       bucket_(bucket),
       fname_(fname),
       offset_(0),
-      file_size_(file_size) {
+      file_size_(file_size),
+      multi_read_coalesce_gap_bytes_(
+          cloud_fs_options ? cloud_fs_options->multi_read_coalesce_gap_bytes
+                           : 0),
+      multi_read_max_parallelism_(
+          cloud_fs_options
+              ? std::max<size_t>(1,
+                                 cloud_fs_options->multi_read_max_parallelism)
+              : 1),
+      async_read_threads_(
+          cloud_fs_options ? cloud_fs_options->async_read_threads : 0),
+      share_inflight_reads_(cloud_fs_options &&
+                            cloud_fs_options->share_inflight_reads) {
+  if (cloud_fs_options && IsSstFile(fname_)) {
+    chunk_cache_ = cloud_fs_options->chunk_cache;
+    compaction_prefetcher_ = cloud_fs_options->compaction_prefetcher;
+  }
+  if (cloud_fs_options) {
+    rate_limiter_ = cloud_fs_options->cloud_rate_limiter;
+    read_hedger_ = cloud_fs_options->read_hedger;
+  }
   Log(InfoLogLevel::DEBUG_LEVEL, info_log_,
       "[%s] CloudReadableFile opening file %s", Name(), fname_.c_str());
 }
 
+CloudStorageReadableFileImpl::~CloudStorageReadableFileImpl() {
+  WaitForHedgedReads();
+}
+
+IOStatus CloudStorageReadableFileImpl::CloudRead(uint64_t offset, size_t n,
+                                                 const IOOptions& options,
+                                                 char* scratch,
+                                                 uint64_t* bytes_read,
+                                                 IODebugContext* dbg) const {
+  if (!share_inflight_reads_) {
+    return IssueCloudRead(offset, n, options, scratch, bytes_read, dbg);
+  }
+  std::unique_lock<std::mutex> lock(inflight_reads_mu_);
+  for (InflightRead* read : inflight_reads_) {
+    if (read->offset <= offset && offset + n <= read->offset + read->n) {
+      read->waiters++;
+      inflight_reads_cv_.wait(lock, [read] { return read->done; });
+      IOStatus s = read->status;
+      const uint64_t skip = offset - read->offset;
+      *bytes_read = read->bytes_read > skip
+                        ? std::min<uint64_t>(read->bytes_read - skip, n)
+                        : 0;
+      lock.unlock();
+      if (s.ok()) {
+        memcpy(scratch, read->scratch + skip, static_cast<size_t>(*bytes_read));
+      }
+      lock.lock();
+      if (--read->waiters == 0) {
+        inflight_reads_cv_.notify_all();
+      }
+      return s;
+    }
+  }
+  InflightRead read;
+  read.offset = offset;
+  read.n = n;
+  read.scratch = scratch;
+  auto pos = inflight_reads_.insert(inflight_reads_.end(), &read);
+  lock.unlock();
+  read.status =
+      IssueCloudRead(offset, n, options, scratch, &read.bytes_read, dbg);
+  lock.lock();
+  inflight_reads_.erase(pos);
+  read.done = true;
+  inflight_reads_cv_.notify_all();
+  inflight_reads_cv_.wait(lock, [&read] { return read.waiters == 0; });
+  *bytes_read = read.bytes_read;
+  return read.status;
+}
+
+IOStatus CloudStorageReadableFileImpl::IssueCloudRead(
+    uint64_t offset, size_t n, const IOOptions& options, char* scratch,
+    uint64_t* bytes_read, IODebugContext* dbg) const {
+  OP_TRACE_SPAN("cloud_get");
+  if (rate_limiter_) {
+    rate_limiter_->Request(CloudRateLimiter::Direction::kDownload, n,
+                           options.rate_limiter_priority);
+  }
+  if (read_hedger_) {
+    return HedgedCloudRead(offset, n, options, scratch, bytes_read);
+  }
+  return DoCloudRead(offset, n, options, scratch, bytes_read, dbg);
+}
+
 IOStatus CloudStorageReadableFileImpl::Read(size_t n, const IOOptions& options,
                                             Slice* result, char* scratch,
                                             IODebugContext* dbg) {
@@ -75,8 +177,25 @@ IOStatus CloudStorageReadableFileImpl::Read(uint64_t offset, size_t n,
         " trimmed size %ld",
         Name(), fname_.c_str(), offset, n);
   }
-  uint64_t bytes_read;
-  auto st = DoCloudRead(offset, n, options, scratch, &bytes_read, dbg);
+  // Compactions read what was downloaded ahead of them first.
+  uint64_t prefetched = 0;
+  if (compaction_prefetcher_ &&
+      options.io_activity == Env::IOActivity::kCompaction) {
+    prefetched =
+        compaction_prefetcher_->Read(bucket_, fname_, offset, n, scratch);
+  }
+  uint64_t bytes_read = 0;
+  IOStatus st;
+  if (prefetched < n) {
+    uint64_t pos = offset + prefetched;
+    size_t len = n - static_cast<size_t>(prefetched);
+    st = chunk_cache_ ? ReadThroughChunkCache(pos, len, options,
+                                              scratch + prefetched,
+                                              &bytes_read, dbg)
+                      : CloudRead(pos, len, options, scratch + prefetched,
+                                  &bytes_read, dbg);
+  }
+  bytes_read += prefetched;
   if (st.ok()) {
     *result = Slice(scratch, bytes_read);
     Log(InfoLogLevel::DEBUG_LEVEL, info_log_,
@@ -87,6 +206,433 @@ IOStatus CloudStorageReadableFileImpl::Read(uint64_t offset, size_t n,
   return st;
 }
 
+IOStatus CloudStorageReadableFileImpl::ReadThroughChunkCache(
+    uint64_t offset, size_t n, const IOOptions& options, char* scratch,
+    uint64_t* bytes_read, IODebugContext* dbg) const {
+  // Chunks are keyed by the object's identity in the cloud, and by its
+  // content hash when the provider exposes one.
+  std::string file_id =
+      bucket_ + "/" + fname_ + "/" + std::to_string(file_size_) + "/";
+  char unique_id[64];
+  size_t unique_id_len = GetUniqueId(unique_id, sizeof(unique_id));
+  file_id.append(unique_id, unique_id_len);
+
+  const size_t chunk_size = chunk_cache_->chunk_size();
+  const uint64_t end = offset + n;
+  uint64_t pos = offset;
+  std::string chunk;
+  *bytes_read = 0;
+  while (pos < end) {
+    uint64_t chunk_index = pos / chunk_size;
+    uint64_t chunk_offset = chunk_index * chunk_size;
+    if (!chunk_cache_->Lookup(file_id, chunk_index, &chunk)) {
+      size_t chunk_len = static_cast<size_t>(
+          std::min<uint64_t>(chunk_size, file_size_ - chunk_offset));
+      chunk.resize(chunk_len);
+      uint64_t chunk_read;
+      auto st = CloudRead(chunk_offset, chunk_len, options, &chunk[0],
+                          &chunk_read, dbg);
+      if (!st.ok()) {
+        return st;
+      }
+      chunk.resize(static_cast<size_t>(chunk_read));
+      if (chunk_read == chunk_len) {
+        chunk_cache_->Insert(file_id, chunk_index, chunk);
+      }
+    }
+    size_t chunk_pos = static_cast<size_t>(pos - chunk_offset);
+    if (chunk.size() <= chunk_pos) {
+      // Short read from the cloud.
+      break;
+    }
+    size_t len = static_cast<size_t>(
+        std::min<uint64_t>(chunk.size() - chunk_pos, end - pos));
+    memcpy(scratch + (pos - offset), chunk.data() + chunk_pos, len);
+    pos += len;
+    *bytes_read += len;
+    if (chunk.size() < chunk_size && pos < end) {
+      break;
+    }
+  }
+  return IOStatus::OK();
+}
+
+namespace {
+// Runs background cloud I/O on behalf of cloud files. Each kind of I/O has a
+// single executor shared by all cloud files in the process.
+class CloudIOExecutor {
+ public:
+  // Serves CloudStorageReadableFileImpl::ReadAsync().
+  static CloudIOExecutor* GetReadExecutor(int num_threads) {
+    static CloudIOExecutor executor;
+    executor.pool_.IncBackgroundThreadsIfNeeded(num_threads);
+    return &executor;
+  }
+
+  // Uploads the parts of streamed SST files.
+  static CloudIOExecutor* GetUploadExecutor(int num_threads) {
+    static CloudIOExecutor executor;
+    executor.pool_.IncBackgroundThreadsIfNeeded(num_threads);
+    return &executor;
+  }
+
+  // Issues the requests of hedged reads.
+  static CloudIOExecutor* GetHedgeExecutor(int num_threads) {
+    static CloudIOExecutor executor;
+    executor.pool_.IncBackgroundThreadsIfNeeded(num_threads);
+    return &executor;
+  }
+
+  // Downloads the parts of SST objects, see
+  // CloudStorageProviderImpl::ParallelGetCloudObject().
+  static CloudIOExecutor* GetDownloadExecutor(int num_threads) {
+    static CloudIOExecutor executor;
+    executor.pool_.IncBackgroundThreadsIfNeeded(num_threads);
+    return &executor;
+  }
+
+  // Issues the coalesced reads of CloudStorageReadableFileImpl::MultiRead().
+  static CloudIOExecutor* GetMultiReadExecutor(int num_threads) {
+    static CloudIOExecutor executor;
+    executor.pool_.IncBackgroundThreadsIfNeeded(num_threads);
+    return &executor;
+  }
+
+  // Lists the partitions of VisitCloudObjects().
+  static CloudIOExecutor* GetListExecutor(int num_threads) {
+    static CloudIOExecutor executor;
+    executor.pool_.IncBackgroundThreadsIfNeeded(num_threads);
+    return &executor;
+  }
+
+  ~CloudIOExecutor() { pool_.JoinAllThreads(); }
+
+  void Submit(std::function<void()>&& job) { pool_.SubmitJob(std::move(job)); }
+
+ private:
+  ThreadPoolImpl pool_;
+};
+
+// A single cloud read that serves one or more of the FSReadRequests passed
+// to MultiRead().
+struct CoalescedCloudRead {
+  uint64_t offset;
+  uint64_t end;
+  std::vector<size_t> req_indexes;
+};
+}  // namespace
+
+IOStatus CloudStorageReadableFileImpl::MultiRead(FSReadRequest* reqs,
+                                                 size_t num_reqs,
+                                                 const IOOptions& options,
+                                                 IODebugContext* dbg) {
+  assert(reqs != nullptr);
+  if (num_reqs == 0) {
+    return IOStatus::OK();
+  }
+
+  // Merge the requests, in offset order, into as few cloud reads as possible.
+  std::vector<size_t> order(num_reqs);
+  std::iota(order.begin(), order.end(), 0);
+  std::sort(order.begin(), order.end(), [reqs](size_t a, size_t b) {
+    return reqs[a].offset < reqs[b].offset;
+  });
+  std::vector<CoalescedCloudRead> reads;
+  for (auto idx : order) {
+    const auto& req = reqs[idx];
+    uint64_t end = req.offset + req.len;
+    if (!reads.empty() &&
+        req.offset <= reads.back().end + multi_read_coalesce_gap_bytes_) {
+      auto& last = reads.back();
+      last.end = std::max(last.end, end);
+      last.req_indexes.push_back(idx);
+    } else {
+      reads.push_back({req.offset, end, {idx}});
+    }
+  }
+  Log(InfoLogLevel::DEBUG_LEVEL, info_log_,
+      "[%s] CloudReadableFile MultiRead %s %" ROCKSDB_PRIszt
+      " requests coalesced into %" ROCKSDB_PRIszt " reads",
+      Name(), fname_.c_str(), num_reqs, reads.size());
+
+  auto do_read = [&](const CoalescedCloudRead& read) {
+    if (read.req_indexes.size() == 1) {
+      // Nothing was merged, read straight into the caller's buffer.
+      auto& req = reqs[read.req_indexes[0]];
+      req.status =
+          Read(req.offset, req.len, options, &req.result, req.scratch, dbg);
+      return;
+    }
+    size_t len = static_cast<size_t>(read.end - read.offset);
+    std::unique_ptr<char[]> buf(new char[len]);
+    Slice result;
+    auto s = Read(read.offset, len, options, &result, buf.get(), dbg);
+    for (auto idx : read.req_indexes) {
+      auto& req = reqs[idx];
+      req.status = s;
+      req.result = Slice();
+      if (!s.ok()) {
+        continue;
+      }
+      // The read may come back short if it went past the end of the file.
+      uint64_t read_end = read.offset + result.size();
+      if (req.offset < read_end) {
+        size_t n = static_cast<size_t>(
+            std::min<uint64_t>(req.len, read_end - req.offset));
+        memcpy(req.scratch, result.data() + (req.offset - read.offset), n);
+        req.result = Slice(req.scratch, n);
+      }
+    }
+  };
+
+  std::atomic<size_t> next_read(0);
+  auto read_worker = [&]() {
+    while (true) {
+      size_t idx = next_read.fetch_add(1);
+      if (idx >= reads.size()) {
+        break;
+      }
+      do_read(reads[idx]);
+    }
+  };
+
+  // The calling thread acts as one of the workers, the others run on the
+  // executor shared by all cloud files. A worker that starts after the reads
+  // are all taken returns at once.
+  size_t num_workers = std::min(reads.size(), multi_read_max_parallelism_);
+  std::vector<std::future<void>> workers;
+  if (num_workers > 1) {
+    auto* executor = CloudIOExecutor::GetMultiReadExecutor(
+        static_cast<int>(multi_read_max_parallelism_));
+    workers.reserve(num_workers - 1);
+    for (size_t i = 1; i < num_workers; i++) {
+      auto done = std::make_shared<std::promise<void>>();
+      workers.push_back(done->get_future());
+      executor->Submit([&read_worker, done]() {
+        read_worker();
+        done->set_value();
+      });
+    }
+  }
+  read_worker();
+  for (auto& w : workers) {
+    w.wait();
+  }
+  return IOStatus::OK();
+}
+
+namespace {
+
+// State of a read submitted by ReadAsync(). It is shared between the io_handle
+// given to RocksDB and the job running on the executor.
+struct CloudAsyncReadState {
+  CloudAsyncReadState(const FSReadRequest& req,
+                      std::function<void(FSReadRequest&, void*)>&& _cb,
+                      void* _cb_arg)
+      : offset(req.offset),
+        len(req.len),
+        scratch(req.scratch),
+        cb(std::move(_cb)),
+        cb_arg(_cb_arg) {}
+
+  std::mutex mu;
+  std::condition_variable cv;
+  bool finished{false};
+  bool aborted{false};
+  bool callback_invoked{false};
+
+  const uint64_t offset;
+  const size_t len;
+  char* const scratch;
+  Slice result;
+  IOStatus status;
+  std::function<void(FSReadRequest&, void*)> cb;
+  void* cb_arg;
+};
+
+struct CloudAsyncReadHandle {
+  std::shared_ptr<CloudAsyncReadState> state;
+};
+
+// State of a read hedged by HedgedCloudRead(), shared with the requests
+// running on the executor. The first request to succeed serves the read.
+struct CloudHedgedReadState {
+  std::mutex mu;
+  std::condition_variable cv;
+  // Requests issued and not finished yet.
+  int pending{0};
+  bool done{false};
+  // Set once the read is served, for the other request to give up.
+  std::atomic<bool> cancelled{false};
+
+  IOStatus status;
+  std::string data;
+};
+}  // namespace
+
+IOStatus CloudStorageReadableFileImpl::HedgedCloudRead(
+    uint64_t offset, size_t n, const IOOptions& options, char* scratch,
+    uint64_t* bytes_read) const {
+  auto* hedger = read_hedger_.get();
+  auto* executor = CloudIOExecutor::GetHedgeExecutor(
+      std::max(2, hedger->GetOptions().threads));
+  auto state = std::make_shared<CloudHedgedReadState>();
+  auto issue = [&](bool hedge) {
+    {
+      std::lock_guard<std::mutex> lk(hedged_reads_mu_);
+      hedged_reads_inflight_++;
+    }
+    // The caller's IODebugContext may be gone by the time a losing request
+    // completes.
+    executor->Submit([this, state, hedger, hedge, offset, n, options]() {
+      IOStatus s;
+      std::string data;
+      if (!state->cancelled.load()) {
+        if (hedge && rate_limiter_) {
+          rate_limiter_->Request(CloudRateLimiter::Direction::kDownload, n,
+                                 options.rate_limiter_priority);
+        }
+        data.resize(n);
+        uint64_t read = 0;
+        auto start = hedger->GetClock()->NowMicros();
+        s = DoCancellableCloudRead(offset, n, options, &data[0], &read,
+                                   nullptr /*dbg*/, &state->cancelled);
+        // A request given up on took at least that long.
+        if (!hedge && (s.ok() || state->cancelled.load())) {
+          hedger->RecordRead(hedger->GetClock()->NowMicros() - start);
+        }
+        data.resize(static_cast<size_t>(read));
+      }
+      {
+        std::lock_guard<std::mutex> lk(state->mu);
+        state->pending--;
+        if (!state->done) {
+          if (s.ok() && !state->cancelled.load()) {
+            state->status = s;
+            state->data = std::move(data);
+            state->done = true;
+            if (hedge) {
+              hedger->RecordHedgeWin();
+            }
+          } else if (state->pending == 0) {
+            // Every request failed, return the last error.
+            state->status = s;
+            state->done = true;
+          }
+          state->cv.notify_all();
+        }
+      }
+      std::lock_guard<std::mutex> lk(hedged_reads_mu_);
+      if (--hedged_reads_inflight_ == 0) {
+        hedged_reads_cv_.notify_all();
+      }
+    });
+  };
+
+  std::unique_lock<std::mutex> lk(state->mu);
+  state->pending++;
+  lk.unlock();
+  issue(false /*hedge*/);
+  lk.lock();
+  auto delay = hedger->GetDelayMicros();
+  if (delay > 0 &&
+      !state->cv.wait_for(lk, std::chrono::microseconds(delay),
+                          [&state] { return state->done; }) &&
+      hedger->TryAcquireHedge()) {
+    Log(InfoLogLevel::DEBUG_LEVEL, info_log_,
+        "[%s] CloudReadableFile hedging read of %s at offset %" PRIu64
+        " size %" ROCKSDB_PRIszt " after %" PRIu64 " micros",
+        Name(), fname_.c_str(), offset, n, delay);
+    state->pending++;
+    lk.unlock();
+    issue(true /*hedge*/);
+    lk.lock();
+  }
+  state->cv.wait(lk, [&state] { return state->done; });
+  state->cancelled.store(true);
+  if (!state->status.ok()) {
+    return state->status;
+  }
+  memcpy(scratch, state->data.data(), state->data.size());
+  *bytes_read = state->data.size();
+  return IOStatus::OK();
+}
+
+void CloudStorageReadableFileImpl::WaitForHedgedReads() const {
+  std::unique_lock<std::mutex> lk(hedged_reads_mu_);
+  hedged_reads_cv_.wait(lk, [this] { return hedged_reads_inflight_ == 0; });
+}
+
+IOStatus CloudStorageReadableFileImpl::ReadAsync(
+    FSReadRequest& req, const IOOptions& opts,
+    std::function<void(FSReadRequest&, void*)> cb, void* cb_arg,
+    void** io_handle, IOHandleDeleter* del_fn, IODebugContext* dbg) {
+  if (async_read_threads_ <= 0) {
+    return CloudStorageReadableFile::ReadAsync(req, opts, cb, cb_arg, io_handle,
+                                               del_fn, dbg);
+  }
+  auto state =
+      std::make_shared<CloudAsyncReadState>(req, std::move(cb), cb_arg);
+  *io_handle = new CloudAsyncReadHandle{state};
+  *del_fn = [](void* handle) {
+    delete static_cast<CloudAsyncReadHandle*>(handle);
+  };
+  auto* executor = CloudIOExecutor::GetReadExecutor(async_read_threads_);
+  executor->Submit([this, state, opts]() {
+    {
+      std::lock_guard<std::mutex> lk(state->mu);
+      if (state->aborted) {
+        state->finished = true;
+        state->cv.notify_all();
+        return;
+      }
+    }
+    Slice result;
+    auto s = Read(state->offset, state->len, opts, &result, state->scratch,
+                  nullptr /*dbg*/);
+    std::lock_guard<std::mutex> lk(state->mu);
+    state->result = result;
+    state->status = std::move(s);
+    state->finished = true;
+    state->cv.notify_all();
+  });
+  return IOStatus::OK();
+}
+
+IOStatus CloudStorageReadableFileImpl::PollAsyncReads(
+    std::vector<void*>& io_handles, size_t /*min_completions*/) {
+  for (auto* handle : io_handles) {
+    auto& state = static_cast<CloudAsyncReadHandle*>(handle)->state;
+    {
+      std::unique_lock<std::mutex> lk(state->mu);
+      state->cv.wait(lk, [&state] { return state->finished; });
+      if (state->callback_invoked || state->aborted) {
+        continue;
+      }
+      state->callback_invoked = true;
+    }
+    FSReadRequest req;
+    req.offset = state->offset;
+    req.len = state->len;
+    req.scratch = state->scratch;
+    req.result = state->result;
+    req.status = state->status;
+    state->cb(req, state->cb_arg);
+  }
+  return IOStatus::OK();
+}
+
+IOStatus CloudStorageReadableFileImpl::AbortAsyncReads(
+    std::vector<void*>& io_handles) {
+  for (auto* handle : io_handles) {
+    auto& state = static_cast<CloudAsyncReadHandle*>(handle)->state;
+    std::unique_lock<std::mutex> lk(state->mu);
+    state->aborted = true;
+    state->cv.wait(lk, [&state] { return state->finished; });
+  }
+  return IOStatus::OK();
+}
+
 IOStatus CloudStorageReadableFileImpl::Skip(uint64_t n) {
   Log(InfoLogLevel::DEBUG_LEVEL, info_log_,
       "[%s] CloudReadableFile file %s skip %" PRIu64, Name(), fname_.c_str(),
@@ -101,6 +647,27 @@ IOStatus CloudStorageReadableFileImpl::Skip(uint64_t n) {
 
 /******************** Writablefile ******************/
 
+struct CloudStorageWritableFileImpl::MultipartUpload {
+  // Parts in flight per file, which bounds the memory held by a file.
+  static constexpr int kMaxInflightParts = 4;
+
+  uint64_t part_size;
+  int upload_threads;
+  // Empty until the first part is queued.
+  std::string upload_id;
+  // Appended data not yet queued for upload.
+  std::string buffer;
+  uint64_t bytes_appended{0};
+  bool disabled{false};
+
+  std::mutex mu;
+  std::condition_variable cv;
+  int inflight{0};
+  // Indexed by part number - 1.
+  std::vector<std::string> part_ids;
+  IOStatus status;
+};
+
 CloudStorageWritableFileImpl::CloudStorageWritableFileImpl(
     CloudFileSystem* fs, const std::string& local_fname,
     const std::string& bucket, const std::string& cloud_fname,
@@ -146,7 +713,225 @@ CloudStorageWritableFileImpl::CloudStorageWritableFileImpl(
         "[%s] CloudWritableFile src %s %s", Name(), fname_.c_str(),
         s.ToString().c_str());
     status_ = s;
+    return;
+  }
+
+  const auto& cloud_opts = cfs_->GetCloudFileSystemOptions();
+  manifest_deltas_enabled_ = is_manifest_ && cloud_opts.manifest_delta_uploads;
+  if (!is_manifest_ && cloud_opts.multipart_upload_part_size > 0 &&
+      !file_opts.use_direct_writes) {
+    multipart_ = std::make_shared<MultipartUpload>();
+    multipart_->part_size = cloud_opts.multipart_upload_part_size;
+    multipart_->upload_threads =
+        std::max(1, cloud_opts.multipart_upload_threads);
+  }
+  upload_checksum_ = !is_manifest_ && cloud_opts.sst_upload_checksums;
+}
+
+IOStatus CloudStorageWritableFileImpl::Append(const Slice& data,
+                                              const IOOptions& opts,
+                                              IODebugContext* dbg) {
+  return Append(data, opts, DataVerificationInfo(), dbg);
+}
+
+IOStatus CloudStorageWritableFileImpl::Append(
+    const Slice& data, const IOOptions& opts,
+    const DataVerificationInfo& verification_info, IODebugContext* dbg) {
+  assert(status_.ok());
+  // write to temporary file
+  auto s = local_file_->Append(data, opts, dbg);
+  if (s.ok() && upload_checksum_) {
+    ExtendUploadChecksum(data, verification_info.checksum);
+  }
+  if (s.ok() && multipart_ && !multipart_->disabled) {
+    multipart_->buffer.append(data.data(), data.size());
+    multipart_->bytes_appended += data.size();
+    if (multipart_->buffer.size() >= multipart_->part_size) {
+      UploadBufferedPart();
+    }
+  }
+  if (s.ok() && manifest_deltas_enabled_) {
+    manifest_pending_.append(data.data(), data.size());
+  }
+  return s;
+}
+
+IOStatus CloudStorageWritableFileImpl::Truncate(uint64_t size,
+                                                const IOOptions& opts,
+                                                IODebugContext* dbg) {
+  if (multipart_ && size != multipart_->bytes_appended) {
+    DisableMultipartUpload();
+  }
+  manifest_deltas_enabled_ = false;
+  if (size != upload_crc32c_size_) {
+    upload_checksum_ = false;
+  }
+  return local_file_->Truncate(size, opts, dbg);
+}
+
+void CloudStorageWritableFileImpl::ExtendUploadChecksum(const Slice& data,
+                                                        const Slice& handoff) {
+  if (handoff.size() == sizeof(uint32_t)) {
+    // The handoff checksum is the crc32c of data, see
+    // Options::checksum_handoff_file_types, so data is not read again.
+    upload_crc32c_ = crc32c::Crc32cCombine(
+        upload_crc32c_, DecodeFixed32(handoff.data()), data.size());
+  } else {
+    upload_crc32c_ = crc32c::Extend(upload_crc32c_, data.data(), data.size());
+  }
+  upload_crc32c_size_ += data.size();
+}
+
+std::string CloudStorageWritableFileImpl::GetUploadChecksum() const {
+  std::string checksum;
+  if (upload_checksum_) {
+    // Big endian, like FileChecksumGenCrc32c.
+    PutFixed32(&checksum, EndianSwapValue(upload_crc32c_));
+  }
+  return checksum;
+}
+
+void CloudStorageWritableFileImpl::UploadBufferedPart() {
+  auto mp = multipart_;
+  auto provider = cfs_->GetStorageProvider();
+  if (mp->upload_id.empty()) {
+    auto s = provider->CreateMultipartUpload(bucket_, cloud_fname_,
+                                             &mp->upload_id);
+    if (!s.ok()) {
+      Log(InfoLogLevel::INFO_LEVEL, cfs_->GetLogger(),
+          "[%s] CloudWritableFile %s cannot stream to the cloud, uploading it "
+          "on close: %s",
+          Name(), fname_.c_str(), s.ToString().c_str());
+      mp->upload_id.clear();
+      DisableMultipartUpload();
+      return;
+    }
+  }
+
+  int part_number;
+  {
+    std::unique_lock<std::mutex> lk(mp->mu);
+    mp->cv.wait(lk, [&mp] {
+      return mp->inflight < MultipartUpload::kMaxInflightParts;
+    });
+    if (!mp->status.ok()) {
+      // An earlier part failed, the upload is going to be abandoned.
+      mp->buffer.clear();
+      return;
+    }
+    mp->part_ids.emplace_back();
+    part_number = static_cast<int>(mp->part_ids.size());
+    mp->inflight++;
+  }
+  auto part = std::make_shared<std::string>(std::move(mp->buffer));
+  mp->buffer.clear();
+  auto* executor = CloudIOExecutor::GetUploadExecutor(mp->upload_threads);
+  executor->Submit([mp, provider, part, part_number, bucket = bucket_,
+                    object = cloud_fname_,
+                    limiter = cfs_->GetCloudFileSystemOptions()
+                                  .cloud_rate_limiter,
+                    pri = GetIOPriority()]() {
+    if (limiter) {
+      limiter->Request(CloudRateLimiter::Direction::kUpload, part->size(),
+                       pri == Env::IO_TOTAL ? Env::IO_HIGH : pri);
+    }
+    std::string part_id;
+    auto s = provider->UploadPart(bucket, object, mp->upload_id, part_number,
+                                  *part, &part_id);
+    std::lock_guard<std::mutex> lk(mp->mu);
+    if (s.ok()) {
+      mp->part_ids[part_number - 1] = std::move(part_id);
+    } else if (mp->status.ok()) {
+      mp->status = s;
+    }
+    mp->inflight--;
+    mp->cv.notify_all();
+  });
+}
+
+CloudUploadClass CloudStorageWritableFileImpl::GetUploadClass() {
+  if (GetIOPriority() != Env::IO_LOW) {
+    // Flushes, and compactions that run while the writes are stalled.
+    return CloudUploadClass::kFlush;
   }
+  // The write hint of a compaction output is derived from its level, see
+  // ColumnFamilyData::CalculateSSTWriteHint().
+  return GetWriteLifeTimeHint() == Env::WLTH_MEDIUM
+             ? CloudUploadClass::kL0Compaction
+             : CloudUploadClass::kCompaction;
+}
+
+void CloudStorageWritableFileImpl::DisableMultipartUpload() {
+  multipart_->disabled = true;
+  multipart_->buffer.clear();
+}
+
+IOStatus CloudStorageWritableFileImpl::UploadClosedFile(
+    CloudFileSystem* cfs, const char* name, const std::string& fname,
+    const std::string& bucket, const std::string& cloud_fname,
+    MultipartUpload* mp, Env::IOPriority pri, const std::string& crc32c) {
+  bool streamed = false;
+  if (mp != nullptr) {
+    // The tail part, if any, was queued by Close().
+    IOStatus s;
+    {
+      std::unique_lock<std::mutex> lk(mp->mu);
+      mp->cv.wait(lk, [mp] { return mp->inflight == 0; });
+      s = mp->status;
+    }
+    // Without an upload id, the file was smaller than a part or streaming
+    // was never possible.
+    if (!mp->upload_id.empty()) {
+      if (s.ok() && mp->disabled) {
+        s = IOStatus::Aborted("file was rewritten in place");
+      }
+      if (s.ok()) {
+        s = cfs->CompleteMultipartUploadToDest(fname, cloud_fname,
+                                               mp->upload_id, mp->part_ids);
+      }
+      if (s.ok()) {
+        Log(InfoLogLevel::DEBUG_LEVEL, cfs->GetLogger(),
+            "[%s] CloudWritableFile streamed %s to the cloud in %" ROCKSDB_PRIszt
+            " parts",
+            name, fname.c_str(), mp->part_ids.size());
+        streamed = true;
+      } else {
+        Log(InfoLogLevel::WARN_LEVEL, cfs->GetLogger(),
+            "[%s] CloudWritableFile multipart upload of %s failed, uploading "
+            "it as a whole: %s",
+            name, fname.c_str(), s.ToString().c_str());
+        cfs->GetStorageProvider()
+            ->AbortMultipartUpload(bucket, cloud_fname, mp->upload_id)
+            .PermitUncheckedError();
+      }
+    }
+  }
+
+  if (!streamed) {
+    auto s = cfs->CopyLocalFileToDest(fname, cloud_fname, pri, crc32c);
+    if (!s.ok()) {
+      Log(InfoLogLevel::ERROR_LEVEL, cfs->GetLogger(),
+          "[%s] CloudWritableFile closing PutObject failed on local file %s",
+          name, fname.c_str());
+      return s;
+    }
+  }
+
+  // delete local file, unless the DB places the local copies of its files
+  const auto& cloud_fs_options = cfs->GetCloudFileSystemOptions();
+  if (!cloud_fs_options.keep_local_sst_files &&
+      !cloud_fs_options.TiersLocalSstFiles()) {
+    auto s = cfs->GetBaseFileSystem()->DeleteFile(fname, IOOptions(), nullptr);
+    if (!s.ok()) {
+      Log(InfoLogLevel::ERROR_LEVEL, cfs->GetLogger(),
+          "[%s] CloudWritableFile closing delete failed on local file %s",
+          name, fname.c_str());
+      return s;
+    }
+  }
+  Log(InfoLogLevel::DEBUG_LEVEL, cfs->GetLogger(),
+      "[%s] CloudWritableFile closed file %s", name, fname.c_str());
+  return IOStatus::OK();
 }
 
 CloudStorageWritableFileImpl::~CloudStorageWritableFileImpl() {
@@ -175,26 +960,32 @@ IOStatus CloudStorageWritableFileImpl::Close(const IOOptions& opts,
   local_file_.reset();
 
   if (!is_manifest_) {
-    status_ = cfs_->CopyLocalFileToDest(fname_, cloud_fname_);
+    if (multipart_ && !multipart_->disabled &&
+        !multipart_->upload_id.empty() && !multipart_->buffer.empty()) {
+      UploadBufferedPart();
+    }
+    if (cfs_->GetCloudFileSystemOptions().defer_sst_uploads) {
+      // The MANIFEST Sync() that makes this file visible waits for the
+      // upload, see CloudFileSystem::WaitForAllUploadsToDest().
+      cfs_->ScheduleUploadToDest(
+          fname_, GetUploadClass(),
+          [cfs = cfs_, name = Name(), fname = fname_, bucket = bucket_,
+           cloud_fname = cloud_fname_, mp = std::move(multipart_),
+           pri = GetIOPriority(), crc32c = GetUploadChecksum()]() {
+            return UploadClosedFile(cfs, name, fname, bucket, cloud_fname,
+                                    mp.get(), pri, crc32c);
+          });
+      return IOStatus::OK();
+    }
+    status_ = cfs_->RunUpload(GetUploadClass(), [this]() {
+      return UploadClosedFile(cfs_, Name(), fname_, bucket_, cloud_fname_,
+                              multipart_.get(), GetIOPriority(),
+                              GetUploadChecksum());
+    });
+    multipart_.reset();
     if (!status_.ok()) {
-      Log(InfoLogLevel::ERROR_LEVEL, cfs_->GetLogger(),
-          "[%s] CloudWritableFile closing PutObject failed on local file %s",
-          Name(), fname_.c_str());
       return status_;
     }
-
-    // delete local file
-    if (!cfs_->GetCloudFileSystemOptions().keep_local_sst_files) {
-      status_ = cfs_->GetBaseFileSystem()->DeleteFile(fname_, opts, dbg);
-      if (!status_.ok()) {
-        Log(InfoLogLevel::ERROR_LEVEL, cfs_->GetLogger(),
-            "[%s] CloudWritableFile closing delete failed on local file %s",
-            Name(), fname_.c_str());
-        return status_;
-      }
-    }
-    Log(InfoLogLevel::DEBUG_LEVEL, cfs_->GetLogger(),
-        "[%s] CloudWritableFile closed file %s", Name(), fname_.c_str());
   }
   return IOStatus::OK();
 }
@@ -220,37 +1011,172 @@ IOStatus CloudStorageWritableFileImpl::Sync(const IOOptions& opts,
     tmp_file_.clear();
   }
 
+  // The edits being synced may reference SST files whose upload was
+  // deferred. They must be in the cloud before the MANIFEST is.
+  if (is_manifest_ && stat.ok()) {
+    stat = cfs_->WaitForAllUploadsToDest();
+  }
+
   // We copy MANIFEST to cloud on every Sync()
   if (is_manifest_ && stat.ok()) {
-    stat = cfs_->CopyLocalFileToDest(fname_, cloud_fname_);
-    if (stat.ok()) {
+    stat = UploadManifest();
+  }
+  return stat;
+}
+
+IOStatus CloudStorageWritableFileImpl::UploadManifest() {
+  const auto& cloud_opts = cfs_->GetCloudFileSystemOptions();
+  IOStatus st;
+  if (manifest_deltas_enabled_ && manifest_uploaded_ &&
+      static_cast<int>(manifest_deltas_.size()) <
+          cloud_opts.manifest_max_deltas) {
+    if (manifest_pending_.empty()) {
+      return st;
+    }
+    auto delta = MakeManifestDeltaFile(cloud_fname_, manifest_uploaded_size_,
+                                       manifest_uploaded_crc_);
+    auto tmp = fname_ + ".delta.tmp";
+    const auto& local_fs = cfs_->GetBaseFileSystem();
+    st = WriteStringToFile(local_fs.get(), manifest_pending_, tmp);
+    if (st.ok()) {
+      st = cfs_->GetStorageProvider()->PutCloudObject(tmp, bucket_, delta);
+    }
+    local_fs->DeleteFile(tmp, IOOptions(), nullptr).PermitUncheckedError();
+    if (st.ok()) {
+      manifest_uploaded_size_ += manifest_pending_.size();
+      manifest_uploaded_crc_ = crc32c::Extend(
+          manifest_uploaded_crc_, manifest_pending_.data(),
+          manifest_pending_.size());
+      manifest_pending_.clear();
+      manifest_deltas_.push_back(delta);
       Log(InfoLogLevel::DEBUG_LEVEL, cfs_->GetLogger(),
           "[%s] CloudWritableFile made manifest %s durable to "
           "bucket %s bucketpath %s.",
-          Name(), fname_.c_str(), bucket_.c_str(), cloud_fname_.c_str());
+          Name(), fname_.c_str(), bucket_.c_str(), delta.c_str());
     } else {
       Log(InfoLogLevel::ERROR_LEVEL, cfs_->GetLogger(),
           "[%s] CloudWritableFile failed to make manifest %s durable to "
           "bucket %s bucketpath %s: %s",
-          Name(), fname_.c_str(), bucket_.c_str(), cloud_fname_.c_str(),
-          stat.ToString().c_str());
+          Name(), fname_.c_str(), bucket_.c_str(), delta.c_str(),
+          st.ToString().c_str());
     }
+    return st;
   }
-  return stat;
+
+  st = cfs_->CopyLocalFileToDest(fname_, cloud_fname_);
+  if (st.ok()) {
+    Log(InfoLogLevel::DEBUG_LEVEL, cfs_->GetLogger(),
+        "[%s] CloudWritableFile made manifest %s durable to "
+        "bucket %s bucketpath %s.",
+        Name(), fname_.c_str(), bucket_.c_str(), cloud_fname_.c_str());
+  } else {
+    Log(InfoLogLevel::ERROR_LEVEL, cfs_->GetLogger(),
+        "[%s] CloudWritableFile failed to make manifest %s durable to "
+        "bucket %s bucketpath %s: %s",
+        Name(), fname_.c_str(), bucket_.c_str(), cloud_fname_.c_str(),
+        st.ToString().c_str());
+    return st;
+  }
+  if (manifest_deltas_enabled_) {
+    manifest_uploaded_size_ += manifest_pending_.size();
+    manifest_uploaded_crc_ =
+        crc32c::Extend(manifest_uploaded_crc_, manifest_pending_.data(),
+                       manifest_pending_.size());
+    manifest_pending_.clear();
+    DeleteManifestDeltas();
+    manifest_uploaded_ = true;
+  }
+  return st;
+}
+
+void CloudStorageWritableFileImpl::DeleteManifestDeltas() {
+  // The deltas of this file are already in the MANIFEST object, and readers
+  // ignore them since they start before its end. Deleting them is only
+  // housekeeping, so errors are ignored.
+  auto provider = cfs_->GetStorageProvider();
+  if (!manifest_uploaded_) {
+    // Also drop the deltas left by a previous incarnation of this MANIFEST.
+    std::vector<std::string> objects;
+    auto dir = dirname(cloud_fname_);
+    if (provider->ListCloudObjects(bucket_, dir, &objects).ok()) {
+      for (const auto& o : objects) {
+        std::string manifest;
+        uint64_t offset;
+        uint32_t prefix_crc;
+        auto path = dir.empty() ? o : dir + pathsep + o;
+        if (ParseManifestDeltaFile(path, &manifest, &offset, &prefix_crc) &&
+            manifest == cloud_fname_) {
+          manifest_deltas_.push_back(path);
+        }
+      }
+    }
+  }
+  for (const auto& delta : manifest_deltas_) {
+    provider->DeleteCloudObject(bucket_, delta).PermitUncheckedError();
+  }
+  manifest_deltas_.clear();
 }
 
 CloudStorageProvider::~CloudStorageProvider() {}
 
+IOStatus CloudStorageProvider::VisitCloudObjects(
+    const std::string& bucket_name, const std::string& object_path,
+    const std::vector<std::string>& /*boundaries*/,
+    const CloudObjectVisitor& visitor) {
+  std::vector<std::string> names;
+  auto st = ListCloudObjects(bucket_name, object_path, &names);
+  for (const auto& name : names) {
+    if (!st.ok() || !visitor(name)) {
+      break;
+    }
+  }
+  return st;
+}
+
+IOStatus CloudStorageProvider::DeleteCloudObjects(
+    const std::string& bucket_name,
+    const std::vector<std::string>& object_paths) {
+  IOStatus result;
+  for (const auto& path : object_paths) {
+    auto st = DeleteCloudObject(bucket_name, path);
+    if (!st.ok() && !st.IsNotFound() && result.ok()) {
+      result = st;
+    }
+  }
+  return result;
+}
+
 Status CloudStorageProvider::CreateFromString(
-    const ConfigOptions& /*config_options*/, const std::string& id,
+    const ConfigOptions& config_options, const std::string& value,
     std::shared_ptr<CloudStorageProvider>* provider) {
-  if (id.empty()) {
+  if (value.empty()) {
     provider->reset();
     return Status::OK();
-  } else {
+  } else if (value.find('=') == std::string::npos) {
     return ObjectRegistry::NewInstance()->NewSharedObject<CloudStorageProvider>(
-        id, provider);
+        value, provider);
   }
+  // "id=<provider>;<option>=<value>;..."
+  std::unordered_map<std::string, std::string> options;
+  Status s = StringToMap(value, &options);
+  if (!s.ok()) {
+    return s;
+  }
+  auto iter = options.find("id");
+  if (iter == options.end()) {
+    return Status::InvalidArgument("Missing id of the storage provider",
+                                   value);
+  }
+  s = ObjectRegistry::NewInstance()->NewSharedObject<CloudStorageProvider>(
+      iter->second, provider);
+  options.erase(iter);
+  if (s.ok() && !options.empty()) {
+    ConfigOptions copy = config_options;
+    // Prepared with the cloud file system
+    copy.invoke_prepare_options = false;
+    s = (*provider)->ConfigureFromMap(copy, options);
+  }
+  return s;
 }
 
 Status CloudStorageProviderImpl::PrepareOptions(const ConfigOptions& options) {
@@ -296,25 +1222,266 @@ IOStatus CloudStorageProviderImpl::NewCloudReadableFile(
     const FileOptions& options,
     std::unique_ptr<CloudStorageReadableFile>* result, IODebugContext* dbg) {
   CloudObjectInformation info;
-  auto st = GetCloudObjectMetadata(bucket, fname, &info);
-
-  if (!st.ok()) {
-    return st;
+  if (!LookupObjectMetadata(bucket, fname,
+                            kCachedSize | kCachedContentHash, &info)) {
+    auto st = GetCloudObjectMetadata(bucket, fname, &info);
+    if (!st.ok()) {
+      return st;
+    }
   }
   return DoNewCloudReadableFile(bucket, fname, info.size, info.content_hash,
                                 options, result, dbg);
 }
 
+IOStatus CloudStorageProviderImpl::ExistsCloudObject(
+    const std::string& bucket_name, const std::string& object_path) {
+  CloudObjectInformation info;
+  if (LookupObjectMetadata(bucket_name, object_path, 0, &info)) {
+    return IOStatus::OK();
+  }
+  return GetCloudObjectMetadata(bucket_name, object_path, &info);
+}
+
+IOStatus CloudStorageProviderImpl::GetCloudObjectSize(
+    const std::string& bucket_name, const std::string& object_path,
+    uint64_t* filesize) {
+  CloudObjectInformation info;
+  IOStatus st;
+  if (!LookupObjectMetadata(bucket_name, object_path, kCachedSize, &info)) {
+    st = GetCloudObjectMetadata(bucket_name, object_path, &info);
+  }
+  if (st.ok()) {
+    *filesize = info.size;
+  }
+  return st;
+}
+
+IOStatus CloudStorageProviderImpl::GetCloudObjectModificationTime(
+    const std::string& bucket_name, const std::string& object_path,
+    uint64_t* time) {
+  CloudObjectInformation info;
+  IOStatus st;
+  if (!LookupObjectMetadata(bucket_name, object_path,
+                            kCachedModificationTime, &info)) {
+    st = GetCloudObjectMetadata(bucket_name, object_path, &info);
+  }
+  if (st.ok()) {
+    *time = info.modification_time;
+  }
+  return st;
+}
+
+IOStatus CloudStorageProviderImpl::GetCloudObjectMetadata(
+    const std::string& bucket_name, const std::string& object_path,
+    CloudObjectInformation* info) {
+  assert(info != nullptr);
+  if (LookupObjectMetadata(bucket_name, object_path, kCachedAll, info)) {
+    return IOStatus::OK();
+  }
+  auto st = DoGetCloudObjectMetadata(bucket_name, object_path, info);
+  if (st.ok()) {
+    CacheObjectMetadata(bucket_name, object_path, kCachedAll, *info);
+  }
+  return st;
+}
+
+IOStatus CloudStorageProviderImpl::DeleteCloudObject(
+    const std::string& bucket_name, const std::string& object_path) {
+  EraseObjectMetadata(bucket_name, object_path);
+  return DoDeleteCloudObject(bucket_name, object_path);
+}
+
+IOStatus CloudStorageProviderImpl::DeleteCloudObjects(
+    const std::string& bucket_name,
+    const std::vector<std::string>& object_paths) {
+  for (const auto& object_path : object_paths) {
+    EraseObjectMetadata(bucket_name, object_path);
+  }
+  return DoDeleteCloudObjects(bucket_name, object_paths);
+}
+
+IOStatus CloudStorageProviderImpl::DoDeleteCloudObjects(
+    const std::string& bucket_name,
+    const std::vector<std::string>& object_paths) {
+  IOStatus result;
+  for (const auto& object_path : object_paths) {
+    auto st = DoDeleteCloudObject(bucket_name, object_path);
+    if (!st.ok() && !st.IsNotFound() && result.ok()) {
+      result = st;
+    }
+  }
+  return result;
+}
+
+IOStatus CloudStorageProviderImpl::CopyCloudObject(
+    const std::string& bucket_name_src, const std::string& object_path_src,
+    const std::string& bucket_name_dest,
+    const std::string& object_path_dest) {
+  EraseObjectMetadata(bucket_name_dest, object_path_dest);
+  return DoCopyCloudObject(bucket_name_src, object_path_src, bucket_name_dest,
+                           object_path_dest);
+}
+
+IOStatus CloudStorageProviderImpl::PutCloudObjectMetadata(
+    const std::string& bucket_name, const std::string& object_path,
+    const std::unordered_map<std::string, std::string>& metadata) {
+  EraseObjectMetadata(bucket_name, object_path);
+  return DoPutCloudObjectMetadata(bucket_name, object_path, metadata);
+}
+
+IOStatus CloudStorageProviderImpl::CompleteMultipartUpload(
+    const std::string& bucket_name, const std::string& object_path,
+    const std::string& upload_id, const std::vector<std::string>& part_ids) {
+  EraseObjectMetadata(bucket_name, object_path);
+  return DoCompleteMultipartUpload(bucket_name, object_path, upload_id,
+                                   part_ids);
+}
+
+uint64_t CloudStorageProviderImpl::MetadataCacheCapacity() const {
+  return cfs_ != nullptr
+             ? cfs_->GetCloudFileSystemOptions().object_metadata_cache_entries
+             : 0;
+}
+
+namespace {
+// The metadata cache only holds SST objects, which are never modified once
+// written.
+bool IsCachedObject(const std::string& object_path) {
+  return IsSstFile(RemoveEpoch(basename(object_path)));
+}
+
+std::string MetadataCacheKey(const std::string& bucket_name,
+                             const std::string& object_path) {
+  return bucket_name + pathsep + ltrim_if(object_path, '/');
+}
+}  // namespace
+
+void CloudStorageProviderImpl::CacheObjectMetadata(
+    const std::string& bucket_name, const std::string& object_path,
+    uint32_t fields, const CloudObjectInformation& info) {
+  const uint64_t capacity = MetadataCacheCapacity();
+  if (capacity == 0 || !IsCachedObject(object_path)) {
+    return;
+  }
+  auto key = MetadataCacheKey(bucket_name, object_path);
+  std::lock_guard<std::mutex> lk(metadata_mutex_);
+  auto it = metadata_cache_.find(key);
+  if (it == metadata_cache_.end()) {
+    metadata_lru_.push_front(key);
+    it = metadata_cache_.emplace(std::move(key), CachedObject()).first;
+    while (metadata_cache_.size() > capacity) {
+      metadata_cache_.erase(metadata_lru_.back());
+      metadata_lru_.pop_back();
+    }
+  } else {
+    metadata_lru_.splice(metadata_lru_.begin(), metadata_lru_,
+                         it->second.lru);
+  }
+  auto& cached = it->second;
+  cached.lru = metadata_lru_.begin();
+  if (fields & kCachedSize) {
+    cached.info.size = info.size;
+  }
+  if (fields & kCachedModificationTime) {
+    cached.info.modification_time = info.modification_time;
+  }
+  if (fields & kCachedContentHash) {
+    cached.info.content_hash = info.content_hash;
+  }
+  if (fields & kCachedMetadata) {
+    cached.info.metadata = info.metadata;
+  }
+  cached.fields |= fields;
+}
+
+bool CloudStorageProviderImpl::LookupObjectMetadata(
+    const std::string& bucket_name, const std::string& object_path,
+    uint32_t fields, CloudObjectInformation* info) {
+  if (MetadataCacheCapacity() == 0 || !IsCachedObject(object_path)) {
+    return false;
+  }
+  std::lock_guard<std::mutex> lk(metadata_mutex_);
+  auto it = metadata_cache_.find(MetadataCacheKey(bucket_name, object_path));
+  if (it == metadata_cache_.end() ||
+      (it->second.fields & fields) != fields) {
+    return false;
+  }
+  metadata_lru_.splice(metadata_lru_.begin(), metadata_lru_, it->second.lru);
+  *info = it->second.info;
+  return true;
+}
+
+void CloudStorageProviderImpl::EraseObjectMetadata(
+    const std::string& bucket_name, const std::string& object_path) {
+  if (!IsCachedObject(object_path)) {
+    return;
+  }
+  std::lock_guard<std::mutex> lk(metadata_mutex_);
+  auto it = metadata_cache_.find(MetadataCacheKey(bucket_name, object_path));
+  if (it != metadata_cache_.end()) {
+    metadata_lru_.erase(it->second.lru);
+    metadata_cache_.erase(it);
+  }
+}
+
 IOStatus CloudStorageProviderImpl::GetCloudObject(
     const std::string& bucket_name, const std::string& object_path,
     const std::string& local_destination) {
+  if (!cfs_->GetCloudFileSystemOptions().share_inflight_reads) {
+    return DownloadCloudObject(bucket_name, object_path, local_destination);
+  }
+  const std::string key = bucket_name + "/" + object_path + "\n" +
+                          local_destination;
+  std::shared_ptr<InflightDownload> download;
+  {
+    std::unique_lock<std::mutex> lock(inflight_downloads_mutex_);
+    auto it = inflight_downloads_.find(key);
+    if (it != inflight_downloads_.end()) {
+      // The object is being downloaded to the same file, wait for it.
+      download = it->second;
+      inflight_downloads_cv_.wait(lock, [&download] { return download->done; });
+      return download->status;
+    }
+    download = std::make_shared<InflightDownload>();
+    inflight_downloads_.emplace(key, download);
+  }
+  IOStatus s = DownloadCloudObject(bucket_name, object_path, local_destination);
+  {
+    std::lock_guard<std::mutex> lock(inflight_downloads_mutex_);
+    download->status = s;
+    download->done = true;
+    inflight_downloads_.erase(key);
+  }
+  inflight_downloads_cv_.notify_all();
+  return s;
+}
+
+IOStatus CloudStorageProviderImpl::DownloadCloudObject(
+    const std::string& bucket_name, const std::string& object_path,
+    const std::string& local_destination) {
   const auto& local_fs = cfs_->GetBaseFileSystem();
   std::string tmp_destination =
       local_destination + ".tmp-" + std::to_string(rng_->Next());
 
   uint64_t remote_size;
-  auto s =
-      DoGetCloudObject(bucket_name, object_path, tmp_destination, &remote_size);
+  IOStatus s;
+  const auto part_size =
+      cfs_->GetCloudFileSystemOptions().parallel_download_part_size;
+  CloudObjectInformation info;
+  if (part_size > 0 && IsCachedObject(object_path)) {
+    s = GetCloudObjectMetadata(bucket_name, object_path, &info);
+    if (s.IsNotFound()) {
+      return s;
+    }
+  }
+  if (part_size > 0 && s.ok() && info.size > part_size) {
+    remote_size = info.size;
+    s = ParallelGetCloudObject(bucket_name, object_path, tmp_destination,
+                               info);
+  } else {
+    s = DoGetCloudObject(bucket_name, object_path, tmp_destination,
+                         &remote_size);
+  }
   const IOOptions io_opts;
   IODebugContext* dbg = nullptr;
   if (!s.ok()) {
@@ -339,15 +1506,129 @@ IOStatus CloudStorageProviderImpl::GetCloudObject(
   if (s.ok()) {
     s = local_fs->RenameFile(tmp_destination, local_destination, io_opts, dbg);
   }
+  if (s.ok()) {
+    CloudObjectInformation downloaded_info;
+    downloaded_info.size = remote_size;
+    CacheObjectMetadata(bucket_name, object_path, kCachedSize,
+                        downloaded_info);
+  }
   Log(InfoLogLevel::INFO_LEVEL, cfs_->GetLogger(),
       "[%s] GetCloudObject %s/%s size %" PRIu64 ". %s", bucket_name.c_str(),
       Name(), object_path.c_str(), local_size, s.ToString().c_str());
   return s;
 }
 
+IOStatus CloudStorageProviderImpl::ParallelGetCloudObject(
+    const std::string& bucket_name, const std::string& object_path,
+    const std::string& local_path, const CloudObjectInformation& info) {
+  const auto& cloud_fs_options = cfs_->GetCloudFileSystemOptions();
+  const auto& local_fs = cfs_->GetBaseFileSystem();
+  const IOOptions io_opts;
+  IODebugContext* dbg = nullptr;
+
+  // Allocate the whole file once, so that the parts written at their offsets
+  // do not fragment it.
+  std::unique_ptr<FSWritableFile> writable;
+  auto s = local_fs->NewWritableFile(local_path, FileOptions(), &writable, dbg);
+  if (s.ok()) {
+    writable->Allocate(0, info.size, io_opts, dbg).PermitUncheckedError();
+    s = writable->Close(io_opts, dbg);
+  }
+  std::unique_ptr<FSRandomRWFile> file;
+  if (s.ok()) {
+    s = local_fs->NewRandomRWFile(local_path, FileOptions(), &file, dbg);
+  }
+  std::unique_ptr<CloudStorageReadableFile> reader;
+  if (s.ok()) {
+    s = DoNewCloudReadableFile(bucket_name, object_path, info.size,
+                               info.content_hash, FileOptions(), &reader,
+                               dbg);
+  }
+  if (!s.ok()) {
+    return s;
+  }
+  // Reads the cloud directly: the chunk cache is not filled with the file.
+  auto* cloud_reader = static_cast<CloudStorageReadableFileImpl*>(reader.get());
+
+  const uint64_t part_size = cloud_fs_options.parallel_download_part_size;
+  const size_t num_parts =
+      static_cast<size_t>((info.size + part_size - 1) / part_size);
+  const bool verify = info.crc32c.size() == sizeof(uint32_t);
+  std::mutex mu;
+  std::condition_variable cv;
+  size_t parts_done = 0;
+  std::vector<uint32_t> part_crcs(num_parts);
+  auto* executor = CloudIOExecutor::GetDownloadExecutor(
+      cloud_fs_options.parallel_download_threads);
+  for (size_t i = 0; i < num_parts; i++) {
+    executor->Submit([&, i]() {
+      const uint64_t offset = i * part_size;
+      const size_t n = static_cast<size_t>(
+          std::min<uint64_t>(part_size, info.size - offset));
+      IOStatus st;
+      {
+        std::lock_guard<std::mutex> lk(mu);
+        st = s;
+      }
+      if (st.ok()) {
+        // The download is abandoned once a part fails.
+        std::string buf(n, '\0');
+        uint64_t bytes_read = 0;
+        st = cloud_reader->CloudRead(offset, n, io_opts, &buf[0], &bytes_read,
+                                     dbg);
+        if (st.ok() && bytes_read != n) {
+          st = IOStatus::IOError("Short read of part of " + object_path);
+        }
+        if (st.ok()) {
+          st = file->Write(offset, buf, io_opts, dbg);
+        }
+        if (st.ok() && verify) {
+          part_crcs[i] = crc32c::Value(buf.data(), n);
+        }
+      }
+      std::lock_guard<std::mutex> lk(mu);
+      if (!st.ok() && s.ok()) {
+        s = st;
+      }
+      parts_done++;
+      cv.notify_all();
+    });
+  }
+  {
+    std::unique_lock<std::mutex> lk(mu);
+    cv.wait(lk, [&]() { return parts_done == num_parts; });
+  }
+  if (s.ok()) {
+    s = file->Close(io_opts, dbg);
+  }
+  if (s.ok() && verify) {
+    uint32_t crc = part_crcs[0];
+    for (size_t i = 1; i < num_parts; i++) {
+      const auto n = std::min<uint64_t>(part_size, info.size - i * part_size);
+      crc = crc32c::Crc32cCombine(crc, part_crcs[i], static_cast<size_t>(n));
+    }
+    // Big endian, like FileChecksumGenCrc32c.
+    if (EndianSwapValue(DecodeFixed32(info.crc32c.data())) != crc) {
+      s = IOStatus::Corruption("Checksum mismatch downloading " +
+                               object_path);
+    }
+  }
+  Log(InfoLogLevel::DEBUG_LEVEL, cfs_->GetLogger(),
+      "[%s] ParallelGetCloudObject %s/%s in %" ROCKSDB_PRIszt " parts. %s",
+      Name(), bucket_name.c_str(), object_path.c_str(), num_parts,
+      s.ToString().c_str());
+  return s;
+}
+
 IOStatus CloudStorageProviderImpl::PutCloudObject(
     const std::string& local_file, const std::string& bucket_name,
     const std::string& object_path) {
+  return PutCloudObjectWithChecksum(local_file, bucket_name, object_path, "");
+}
+
+IOStatus CloudStorageProviderImpl::PutCloudObjectWithChecksum(
+    const std::string& local_file, const std::string& bucket_name,
+    const std::string& object_path, const std::string& crc32c) {
   uint64_t fsize = 0;
   // debugging paranoia. Files uploaded to Cloud can never be zero size.
   auto st = cfs_->GetBaseFileSystem()->GetFileSize(local_file, IOOptions(),
@@ -365,7 +1646,82 @@ IOStatus CloudStorageProviderImpl::PutCloudObject(
     return IOStatus::IOError(local_file + " Zero size.");
   }
 
-  return DoPutCloudObject(local_file, bucket_name, object_path, fsize);
+  // A rewritten object has a new modification time and content hash.
+  EraseObjectMetadata(bucket_name, object_path);
+  st = DoPutCloudObject(local_file, bucket_name, object_path, fsize, crc32c);
+  if (st.ok()) {
+    CloudObjectInformation info;
+    info.size = fsize;
+    CacheObjectMetadata(bucket_name, object_path, kCachedSize, info);
+  }
+  return st;
+}
+
+IOStatus CloudStorageProviderImpl::VisitCloudObjects(
+    const std::string& bucket_name, const std::string& object_path,
+    const std::vector<std::string>& boundaries,
+    const CloudObjectVisitor& visitor) {
+  if (boundaries.empty()) {
+    return DoVisitCloudObjects(bucket_name, object_path, "", "", visitor);
+  }
+  assert(std::is_sorted(boundaries.begin(), boundaries.end()));
+  const size_t num_partitions = boundaries.size() + 1;
+  auto executor =
+      CloudIOExecutor::GetListExecutor(static_cast<int>(num_partitions));
+
+  // The partitions are listed by the executor while this thread waits, so
+  // they can refer to the arguments and to the locals below.
+  std::mutex mu;
+  std::condition_variable cv;
+  size_t pending = num_partitions;
+  bool stopped = false;
+  IOStatus result;
+  std::mutex visitor_mu;
+  CloudObjectVisitor serialized = [&](const std::string& name) {
+    std::lock_guard<std::mutex> lk(visitor_mu);
+    if (stopped) {
+      return false;
+    }
+    if (!visitor(name)) {
+      stopped = true;
+    }
+    return !stopped;
+  };
+  for (size_t i = 0; i < num_partitions; ++i) {
+    executor->Submit([&, i]() {
+      auto st = DoVisitCloudObjects(
+          bucket_name, object_path, i == 0 ? "" : boundaries[i - 1],
+          i + 1 < num_partitions ? boundaries[i] : "", serialized);
+      std::lock_guard<std::mutex> lk(mu);
+      if (!st.ok() && result.ok()) {
+        result = st;
+      }
+      if (--pending == 0) {
+        cv.notify_all();
+      }
+    });
+  }
+  std::unique_lock<std::mutex> lk(mu);
+  cv.wait(lk, [&] { return pending == 0; });
+  return result;
+}
+
+IOStatus CloudStorageProviderImpl::DoVisitCloudObjects(
+    const std::string& bucket_name, const std::string& object_path,
+    const std::string& start_after, const std::string& last,
+    const CloudObjectVisitor& visitor) {
+  std::vector<std::string> names;
+  auto st = ListCloudObjects(bucket_name, object_path, &names);
+  for (const auto& name : names) {
+    if (!st.ok()) {
+      break;
+    }
+    if ((start_after.empty() || name > start_after) &&
+        (last.empty() || name <= last) && !visitor(name)) {
+      break;
+    }
+  }
+  return st;
 }
 
 #endif  // ROCKSDB_LITE
@@ -0,0 +1,131 @@
+//  Copyright (c) 2016-present, Rockset, Inc.  All rights reserved.
+
+#include "cloud/cloud_upload_scheduler.h"
+
+#include <algorithm>
+#include <cassert>
+
+#include "monitoring/statistics_impl.h"
+
+namespace ROCKSDB_NAMESPACE {
+
+namespace {
+// Share of the slots of each class when all of them have waiting uploads,
+// indexed by CloudUploadClass. Flush outputs gate the write stalls, and
+// compactions into the base level gate the next flushes.
+const int64_t kClassWeights[] = {8, 4, 2, 1};
+
+// The slot held by the calling thread, if any.
+thread_local const CloudUploadScheduler* t_slot_holder = nullptr;
+}  // namespace
+
+CloudUploadScheduler::CloudUploadScheduler(
+    int max_concurrent_uploads, std::shared_ptr<Statistics> statistics)
+    : max_concurrent_uploads_(std::max(1, max_concurrent_uploads)),
+      statistics_(std::move(statistics)) {
+  static_assert(sizeof(kClassWeights) / sizeof(kClassWeights[0]) ==
+                    static_cast<size_t>(kNumClasses),
+                "a weight per upload class");
+  pool_.SetBackgroundThreads(max_concurrent_uploads_);
+}
+
+CloudUploadScheduler::~CloudUploadScheduler() {
+  {
+    std::unique_lock<std::mutex> lk(mutex_);
+    cv_.wait(lk, [this] { return queued_ == 0 && running_ == 0; });
+  }
+  pool_.JoinAllThreads();
+}
+
+IOStatus CloudUploadScheduler::Run(CloudUploadClass cls,
+                                   const std::function<IOStatus()>& upload) {
+  if (t_slot_holder == this) {
+    return upload();
+  }
+  bool granted = false;
+  {
+    std::unique_lock<std::mutex> lk(mutex_);
+    Waiter waiter;
+    waiter.granted = &granted;
+    Enqueue(cls, std::move(waiter));
+    GrantSlotsLocked();
+    cv_.wait(lk, [&granted] { return granted; });
+  }
+  t_slot_holder = this;
+  auto s = upload();
+  t_slot_holder = nullptr;
+  ReleaseSlot();
+  return s;
+}
+
+void CloudUploadScheduler::Schedule(CloudUploadClass cls,
+                                    std::function<void()>&& upload) {
+  std::lock_guard<std::mutex> lk(mutex_);
+  Waiter waiter;
+  waiter.job = std::move(upload);
+  Enqueue(cls, std::move(waiter));
+  GrantSlotsLocked();
+}
+
+size_t CloudUploadScheduler::QueueDepth() const {
+  std::lock_guard<std::mutex> lk(mutex_);
+  return queued_;
+}
+
+void CloudUploadScheduler::Enqueue(CloudUploadClass cls, Waiter&& waiter) {
+  queues_[static_cast<int>(cls)].push_back(std::move(waiter));
+  queued_++;
+  RecordInHistogram(statistics_.get(), CLOUD_UPLOAD_QUEUE_DEPTH, queued_);
+}
+
+void CloudUploadScheduler::GrantSlotsLocked() {
+  while (running_ < max_concurrent_uploads_ && queued_ > 0) {
+    auto& queue = queues_[PickClassLocked()];
+    Waiter waiter = std::move(queue.front());
+    queue.pop_front();
+    queued_--;
+    running_++;
+    if (waiter.granted != nullptr) {
+      *waiter.granted = true;
+      cv_.notify_all();
+      continue;
+    }
+    pool_.SubmitJob([this, job = std::move(waiter.job)]() {
+      t_slot_holder = this;
+      job();
+      t_slot_holder = nullptr;
+      ReleaseSlot();
+    });
+  }
+}
+
+int CloudUploadScheduler::PickClassLocked() {
+  // Every class with waiting uploads earns its weight, and the richest one
+  // pays for the slot with the weights of all of them.
+  int64_t total = 0;
+  int picked = -1;
+  for (int i = 0; i < kNumClasses; i++) {
+    if (queues_[i].empty()) {
+      // An idle class does not hoard credits.
+      credits_[i] = 0;
+      continue;
+    }
+    credits_[i] += kClassWeights[i];
+    total += kClassWeights[i];
+    if (picked < 0 || credits_[i] > credits_[picked]) {
+      picked = i;
+    }
+  }
+  assert(picked >= 0);
+  credits_[picked] -= total;
+  return picked;
+}
+
+void CloudUploadScheduler::ReleaseSlot() {
+  std::lock_guard<std::mutex> lk(mutex_);
+  running_--;
+  GrantSlotsLocked();
+  cv_.notify_all();
+}
+
+}  // namespace ROCKSDB_NAMESPACE
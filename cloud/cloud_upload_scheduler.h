@@ -0,0 +1,73 @@
+//  Copyright (c) 2016-present, Rockset, Inc.  All rights reserved.
+
+#pragma once
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+
+#include "rocksdb/cloud/cloud_file_system.h"
+#include "rocksdb/io_status.h"
+#include "util/threadpool_imp.h"
+
+namespace ROCKSDB_NAMESPACE {
+
+class Statistics;
+
+// Bounds the number of uploads to the cloud storage running at once, see
+// CloudFileSystemOptions::max_concurrent_uploads. When a slot frees up, it
+// goes to one of the classes with waiting uploads by smooth weighted round
+// robin, so that flush outputs go first but the other classes still get a
+// share of the slots under sustained load. Uploads of a class run in the
+// order they were queued.
+class CloudUploadScheduler {
+ public:
+  CloudUploadScheduler(int max_concurrent_uploads,
+                       std::shared_ptr<Statistics> statistics);
+  // Waits for the scheduled uploads.
+  ~CloudUploadScheduler();
+
+  // Runs upload on the calling thread once it gets a slot. Runs it right
+  // away if the calling thread already holds a slot of this scheduler, as
+  // the uploads scheduled in the background do.
+  IOStatus Run(CloudUploadClass cls, const std::function<IOStatus()>& upload);
+
+  // Runs upload on a background thread once it gets a slot.
+  void Schedule(CloudUploadClass cls, std::function<void()>&& upload);
+
+  // Number of uploads waiting for a slot.
+  size_t QueueDepth() const;
+
+ private:
+  static constexpr int kNumClasses =
+      static_cast<int>(CloudUploadClass::kCheckpoint) + 1;
+
+  // A waiting upload: a background job, or a thread blocked in Run() until
+  // granted is set.
+  struct Waiter {
+    std::function<void()> job;
+    bool* granted = nullptr;
+  };
+
+  void Enqueue(CloudUploadClass cls, Waiter&& waiter);
+  // Hands the free slots to the waiting uploads.
+  void GrantSlotsLocked();
+  // Picks the class of the next upload, among those with waiting uploads.
+  int PickClassLocked();
+  void ReleaseSlot();
+
+  const int max_concurrent_uploads_;
+  std::shared_ptr<Statistics> statistics_;
+
+  mutable std::mutex mutex_;
+  std::condition_variable cv_;
+  std::deque<Waiter> queues_[kNumClasses];
+  int64_t credits_[kNumClasses] = {};
+  size_t queued_ = 0;
+  int running_ = 0;
+  ThreadPoolImpl pool_;
+};
+
+}  // namespace ROCKSDB_NAMESPACE
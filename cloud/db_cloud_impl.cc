@@ -3,29 +3,73 @@
 
 #include "cloud/db_cloud_impl.h"
 
+#include <chrono>
 #include <cinttypes>
+#include <condition_variable>
+#include <cstring>
+#include <limits>
+#include <thread>
+#include <unordered_set>
 
 #include "cloud/cloud_manifest.h"
+#include "cloud/cloud_scheduler.h"
+#include "cloud/cloud_stats_history.h"
+#include "db/compaction/compaction_job.h"
 #include "cloud/filename.h"
 #include "cloud/manifest_reader.h"
 #include "env/composite_env_wrapper.h"
 #include "file/file_util.h"
 #include "file/sst_file_manager_impl.h"
 #include "logging/auto_roll_logger.h"
+#include "monitoring/statistics_impl.h"
 #include "rocksdb/cloud/cloud_file_system_impl.h"
 #include "rocksdb/cloud/cloud_storage_provider.h"
 #include "rocksdb/db.h"
 #include "rocksdb/env.h"
+#include "rocksdb/listener.h"
 #include "rocksdb/options.h"
 #include "rocksdb/persistent_cache.h"
 #include "rocksdb/status.h"
 #include "rocksdb/table.h"
+#include "rocksdb/utilities/cache_dump_load.h"
+#include "util/string_util.h"
+#include "util/threadpool_imp.h"
 #include "util/xxhash.h"
 #include "utilities/persistent_cache/block_cache_tier.h"
 
 namespace ROCKSDB_NAMESPACE {
 
 namespace {
+// Attempts of a single savepoint copy or checkpoint upload, and the delay
+// before the first retry. The delay doubles on every retry.
+const int kCloudTransferAttempts = 3;
+const uint64_t kCloudTransferRetryMicros = 100 * 1000;
+// The object a DB dumps its block cache to, in its object path.
+const char* const kBlockCacheDumpObject = "BLOCKCACHE";
+
+// The layout of the backups in their object path: the SST files of all the
+// backups in shared/, by their name in the cloud, and the other files of
+// each backup in backup-<id>/, with the META object listing the files of the
+// backup, which is written last.
+const char* const kCloudBackupSharedDir = "shared";
+const char* const kCloudBackupDirPrefix = "backup-";
+const char* const kCloudBackupMetaObject = "META";
+const char* const kCloudBackupMetaHeader = "rocksdb-cloud-backup 1";
+// The kinds of the files listed in META.
+const char* const kCloudBackupSst = "sst";
+const char* const kCloudBackupManifest = "manifest";
+const char* const kCloudBackupCloudManifest = "cloudmanifest";
+const char* const kCloudBackupIdentity = "identity";
+const char* const kCloudBackupCurrent = "current";
+const char* const kCloudBackupWal = "wal";
+// Transfers of a restore running at once.
+const int kCloudRestoreThreads = 8;
+
+std::string CloudBackupDir(const std::string& object_path,
+                           uint64_t backup_id) {
+  return object_path + "/" + kCloudBackupDirPrefix + std::to_string(backup_id);
+}
+
 /**
  * This ConstantSstFileManager uses the same size for every sst files added.
  */
@@ -52,12 +96,73 @@ class ConstantSizeSstFileManager : public SstFileManagerImpl {
  private:
   const int64_t constant_file_size_;
 };
+
+// Hands the input files of each compaction to the compaction prefetcher of
+// the cloud file system, see CloudFileSystemOptions::compaction_prefetcher.
+class CompactionPrefetchListener : public EventListener {
+ public:
+  explicit CompactionPrefetchListener(CloudFileSystem* cfs) : cfs_(cfs) {}
+
+  const char* Name() const override { return "CompactionPrefetchListener"; }
+
+  void OnCompactionBegin(DB* /*db*/, const CompactionJobInfo& ci) override {
+    cfs_->PrefetchCompactionInputs(ci.job_id, ci.input_files);
+  }
+
+  void OnCompactionCompleted(DB* /*db*/,
+                             const CompactionJobInfo& ci) override {
+    cfs_->ReleaseCompactionInputs(ci.job_id);
+  }
+
+ private:
+  CloudFileSystem* cfs_;
+};
+
+// Downloads or drops the local copies of the SST files of the DB as flushes
+// and compactions move them between levels, see
+// CloudFileSystemOptions::local_sst_max_level.
+class LocalSstPlacementListener : public EventListener {
+ public:
+  explicit LocalSstPlacementListener(CloudFileSystem* cfs) : cfs_(cfs) {}
+
+  const char* Name() const override { return "LocalSstPlacementListener"; }
+
+  void OnFlushCompleted(DB* db, const FlushJobInfo& /*info*/) override {
+    UpdateLocalSstFiles(db);
+  }
+
+  void OnCompactionCompleted(DB* db, const CompactionJobInfo& ci) override {
+    if (ci.status.ok()) {
+      UpdateLocalSstFiles(db);
+    }
+  }
+
+  void OnExternalFileIngested(
+      DB* db, const ExternalFileIngestionInfo& /*info*/) override {
+    UpdateLocalSstFiles(db);
+  }
+
+ private:
+  void UpdateLocalSstFiles(DB* db) {
+    std::vector<LiveFileMetaData> files;
+    db->GetLiveFilesMetaData(&files);
+    cfs_->UpdateLocalSstFiles(db->GetName(), files);
+  }
+
+  CloudFileSystem* cfs_;
+};
 }  // namespace
 
 DBCloudImpl::DBCloudImpl(DB* db, std::unique_ptr<Env> local_env)
     : DBCloud(db), cfs_(nullptr), local_env_(std::move(local_env)) {}
 
-DBCloudImpl::~DBCloudImpl() {}
+DBCloudImpl::~DBCloudImpl() {
+  StopBlockCacheDumps();
+  StopStatsHistory();
+  if (transfer_pool_) {
+    transfer_pool_->JoinAllThreads();
+  }
+}
 
 Status DBCloud::Open(const Options& options, const std::string& dbname,
                      const std::string& persistent_cache_path,
@@ -119,6 +224,15 @@ Status DBCloud::Open(const Options& opt, const std::string& local_dbname,
         64 * 1024 * 1024 /* bytes_max_delete_chunk */);
   }
 
+  // The time spent in each phase of the open, logged and recorded once the
+  // DB is opened.
+  const auto& clock = options.env->GetSystemClock();
+  Statistics* stats = cfs->GetCloudFileSystemOptions().statistics.get();
+  const uint64_t open_start_micros = clock->NowMicros();
+  uint64_t sanitize_micros = 0;
+  uint64_t load_cloud_manifest_micros = 0;
+  uint64_t db_open_micros = 0;
+
   const auto& local_fs = cfs->GetBaseFileSystem();
   const IOOptions io_opts;
   IODebugContext* dbg = nullptr;
@@ -131,10 +245,17 @@ Status DBCloud::Open(const Options& opt, const std::string& local_dbname,
   // If cloud manifest is already loaded, this means the directory has been
   // sanitized (possibly by the call to ListColumnFamilies())
   if (cfs->GetCloudManifest() == nullptr) {
+    uint64_t start_micros = clock->NowMicros();
     st = cfs->SanitizeLocalDirectory(options, local_dbname, read_only);
+    sanitize_micros = clock->NowMicros() - start_micros;
+    RecordInHistogram(stats, CLOUD_OPEN_SANITIZE_MICROS, sanitize_micros);
 
     if (st.ok()) {
+      start_micros = clock->NowMicros();
       st = cfs->LoadCloudManifest(local_dbname, read_only);
+      load_cloud_manifest_micros = clock->NowMicros() - start_micros;
+      RecordInHistogram(stats, CLOUD_OPEN_LOAD_CLOUD_MANIFEST_MICROS,
+                        load_cloud_manifest_micros);
     }
     if (st.IsNotFound()) {
       Log(InfoLogLevel::INFO_LEVEL, options.info_log,
@@ -157,6 +278,13 @@ Status DBCloud::Open(const Options& opt, const std::string& local_dbname,
       return st;
     }
   }
+  if (!new_db) {
+    // Fetch the SST files in the background while the DB opens.
+    st = cfs->PrefetchSstFiles(local_dbname);
+    if (!st.ok()) {
+      return st;
+    }
+  }
 
   // Local environment, to be owned by DBCloudImpl, so that it outlives the
   // cache object created below.
@@ -192,14 +320,28 @@ Status DBCloud::Open(const Options& opt, const std::string& local_dbname,
   // uploaded to S3 for every update, so always enable rolling of Manifest file
   options.max_manifest_file_size = DBCloudImpl::max_manifest_file_size;
 
+  const auto& cloud_fs_options = cfs->GetCloudFileSystemOptions();
+  if (!read_only && cloud_fs_options.compaction_prefetcher &&
+      !cloud_fs_options.keep_local_sst_files) {
+    options.listeners.push_back(
+        std::make_shared<CompactionPrefetchListener>(cfs));
+  }
+  if (!read_only && cloud_fs_options.TiersLocalSstFiles()) {
+    options.listeners.push_back(
+        std::make_shared<LocalSstPlacementListener>(cfs));
+  }
+
   DB* db = nullptr;
   std::string dbid;
+  const uint64_t db_open_start_micros = clock->NowMicros();
   if (read_only) {
     st = DB::OpenForReadOnly(options, local_dbname, column_families, handles,
                              &db);
   } else {
     st = DB::Open(options, local_dbname, column_families, handles, &db);
   }
+  db_open_micros = clock->NowMicros() - db_open_start_micros;
+  RecordInHistogram(stats, CLOUD_OPEN_DB_MICROS, db_open_micros);
 
   if (new_db && st.ok() && cfs->HasDestBucket() &&
       cfs->GetCloudFileSystemOptions().roll_cloud_manifest_on_open) {
@@ -219,14 +361,44 @@ Status DBCloud::Open(const Options& opt, const std::string& local_dbname,
         false;
   }
 
+  if (st.ok() && !read_only && cloud_fs_options.TiersLocalSstFiles()) {
+    // The files may have moved between levels since the local copies were
+    // placed, or the local directory may be new.
+    std::vector<LiveFileMetaData> files;
+    db->GetLiveFilesMetaData(&files);
+    cfs->UpdateLocalSstFiles(local_dbname, files);
+  }
+
   if (st.ok()) {
     DBCloudImpl* cloud = new DBCloudImpl(db, std::move(local_env));
     *dbptr = cloud;
     db->GetDbIdentity(dbid);
+    if (cloud_fs_options.block_cache_load_target) {
+      // A DB without the dump of its cache is still opened.
+      cloud->LoadBlockCacheFromCloud().PermitUncheckedError();
+    }
+    if (!read_only && cloud_fs_options.dump_block_cache &&
+        cfs->HasDestBucket()) {
+      cloud->dump_block_cache_on_close_ = true;
+      cloud->StartBlockCacheDumps();
+    }
+    if (cloud_fs_options.stats_history_period_secs > 0 &&
+        cfs->HasDestBucket()) {
+      cloud->StartStatsHistory();
+    }
+  }
+  const uint64_t open_micros = clock->NowMicros() - open_start_micros;
+  if (st.ok()) {
+    RecordInHistogram(stats, CLOUD_OPEN_MICROS, open_micros);
   }
   Log(InfoLogLevel::INFO_LEVEL, options.info_log,
       "Opened cloud db with local dir %s dbid %s. %s", local_dbname.c_str(),
       dbid.c_str(), st.ToString().c_str());
+  Log(InfoLogLevel::INFO_LEVEL, options.info_log,
+      "Cloud db open took %" PRIu64 " us: sanitize %" PRIu64
+      " us, load cloud manifest %" PRIu64 " us, db open %" PRIu64 " us",
+      open_micros, sanitize_micros, load_cloud_manifest_micros,
+      db_open_micros);
   return st;
 }
 
@@ -259,56 +431,142 @@ Status DBCloudImpl::Savepoint() {
   GetLiveFilesMetaData(&live_files);
 
   auto provider = cfs->GetStorageProvider();
-  // If an sst file does not exist in the destination path, then remember it
-  std::vector<std::string> to_copy;
-  for (auto onefile : live_files) {
+  const auto& dest_bucket = cfs->GetDestBucketName();
+  const auto& dest_path = cfs->GetDestObjectPath();
+  // A single listing of the destination tells which files it already has.
+  std::vector<std::string> dest_objects;
+  st = provider->ListCloudObjects(dest_bucket, dest_path, &dest_objects);
+  if (st.IsNotFound()) {
+    st = Status::OK();
+  }
+  if (!st.ok()) {
+    Log(InfoLogLevel::ERROR_LEVEL, default_options.info_log,
+        "Savepoint on cloud dbid %s could not list dest bucket %s path %s. %s",
+        dbid.c_str(), dest_bucket.c_str(), dest_path.c_str(),
+        st.ToString().c_str());
+    return st;
+  }
+  std::unordered_set<std::string> existing;
+  for (const auto& o : dest_objects) {
+    existing.insert(RemoveSstObjectShard(o));
+  }
+
+  // If an sst file does not exist in the destination path, then copy it
+  std::vector<CloudTransfer> to_copy;
+  for (const auto& onefile : live_files) {
     auto remapped_fname = cfs->RemapFilename(onefile.name);
-    std::string destpath = cfs->GetDestObjectPath() + "/" + remapped_fname;
-    if (!provider->ExistsCloudObject(cfs->GetDestBucketName(), destpath).ok()) {
-      to_copy.push_back(remapped_fname);
+    if (existing.count(remapped_fname) > 0) {
+      continue;
+    }
+    auto src_path = cfs->CloudObjectName(cfs->GetSrcObjectPath(),
+                                         remapped_fname);
+    auto dest_fname = cfs->CloudObjectName(dest_path, remapped_fname);
+    to_copy.push_back(
+        {remapped_fname, onefile.size, [cfs, provider, src_path, dest_fname]() {
+           return provider->CopyCloudObject(cfs->GetSrcBucketName(), src_path,
+                                            cfs->GetDestBucketName(),
+                                            dest_fname);
+         }});
+  }
+  Log(InfoLogLevel::INFO_LEVEL, default_options.info_log,
+      "Savepoint on cloud dbid %s: %" ROCKSDB_PRIszt
+      " of %" ROCKSDB_PRIszt " live files missing in dest bucket %s path %s",
+      dbid.c_str(), to_copy.size(), live_files.size(), dest_bucket.c_str(),
+      dest_path.c_str());
+  return RunCloudTransfers("Savepoint", &to_copy,
+                           default_options.max_file_opening_threads,
+                           default_options.info_log);
+}
+
+Status DBCloudImpl::RunCloudTransfers(const char* what,
+                                      std::vector<CloudTransfer>* jobs,
+                                      int max_threads,
+                                      const std::shared_ptr<Logger>& info_log) {
+  if (jobs->empty()) {
+    return Status::OK();
+  }
+  // Every worker runs the transfers one after the other, so the pool can be
+  // shared between calls with different limits.
+  int num_workers = static_cast<int>(
+      std::min(jobs->size(), static_cast<size_t>(std::max(1, max_threads))));
+  {
+    std::lock_guard<std::mutex> lk(transfer_pool_mutex_);
+    if (!transfer_pool_) {
+      transfer_pool_.reset(new ThreadPoolImpl());
     }
+    transfer_pool_->IncBackgroundThreadsIfNeeded(num_workers);
   }
 
-  // copy all files in parallel
-  std::atomic<size_t> next_file_meta_idx(0);
-  int max_threads = default_options.max_file_opening_threads;
+  uint64_t total_bytes = 0;
+  for (const auto& job : *jobs) {
+    total_bytes += job.size;
+  }
+  const size_t report_every = std::max<size_t>(1, jobs->size() / 10);
+  auto clock = GetEnv()->GetSystemClock();
+  auto* cfs =
+      dynamic_cast<CloudFileSystemImpl*>(GetEnv()->GetFileSystem().get());
+  assert(cfs);
 
-  std::function<void()> load_handlers_func = [&]() {
+  std::mutex mu;
+  std::condition_variable cv;
+  size_t next = 0;
+  size_t done = 0;
+  uint64_t done_bytes = 0;
+  int running = num_workers;
+  Status st;
+  auto worker = [&]() {
     while (true) {
-      size_t idx = next_file_meta_idx.fetch_add(1);
-      if (idx >= to_copy.size()) {
-        break;
+      CloudTransfer* job;
+      {
+        std::lock_guard<std::mutex> lk(mu);
+        if (!st.ok() || next >= jobs->size()) {
+          break;
+        }
+        job = &(*jobs)[next++];
+      }
+      IOStatus s;
+      for (int attempt = 1;; attempt++) {
+        // The transfers yield to the flush and compaction uploads.
+        s = cfs->RunUpload(CloudUploadClass::kCheckpoint, job->run);
+        // A missing source does not come back.
+        if (s.ok() || s.IsNotFound() || attempt >= kCloudTransferAttempts) {
+          break;
+        }
+        Log(InfoLogLevel::WARN_LEVEL, info_log,
+            "%s: attempt %d for %s failed, retrying. %s", what, attempt,
+            job->fname.c_str(), s.ToString().c_str());
+        clock->SleepForMicroseconds(kCloudTransferRetryMicros << (attempt - 1));
       }
-      auto& onefile = to_copy[idx];
-      auto s = provider->CopyCloudObject(
-          cfs->GetSrcBucketName(), cfs->GetSrcObjectPath() + "/" + onefile,
-          cfs->GetDestBucketName(), cfs->GetDestObjectPath() + "/" + onefile);
+
+      std::lock_guard<std::mutex> lk(mu);
       if (!s.ok()) {
-        Log(InfoLogLevel::INFO_LEVEL, default_options.info_log,
-            "Savepoint on cloud dbid  %s error in copying srcbucket %s srcpath "
-            "%s dest bucket %s dest path %s. %s",
-            dbid.c_str(), cfs->GetSrcBucketName().c_str(),
-            cfs->GetSrcObjectPath().c_str(), cfs->GetDestBucketName().c_str(),
-            cfs->GetDestObjectPath().c_str(), s.ToString().c_str());
         if (st.ok()) {
+          Log(InfoLogLevel::ERROR_LEVEL, info_log,
+              "%s: transfer of %s failed. %s", what, job->fname.c_str(),
+              s.ToString().c_str());
           st = s;  // save at least one error
         }
         break;
       }
+      done++;
+      done_bytes += job->size;
+      if (done % report_every == 0 || done == jobs->size()) {
+        Log(InfoLogLevel::INFO_LEVEL, info_log,
+            "%s: transferred %" ROCKSDB_PRIszt "/%" ROCKSDB_PRIszt
+            " files, %" PRIu64 "/%" PRIu64 " bytes",
+            what, done, jobs->size(), done_bytes, total_bytes);
+      }
     }
-  };
-
-  if (max_threads <= 1) {
-    load_handlers_func();
-  } else {
-    std::vector<port::Thread> threads;
-    for (int i = 0; i < max_threads; i++) {
-      threads.emplace_back(load_handlers_func);
-    }
-    for (auto& t : threads) {
-      t.join();
+    std::lock_guard<std::mutex> lk(mu);
+    if (--running == 0) {
+      cv.notify_all();
     }
+  };
+  for (int i = 0; i < num_workers; i++) {
+    transfer_pool_->SubmitJob(worker);
   }
+  std::unique_lock<std::mutex> lk(mu);
+  cv.wait(lk, [&]() { return running == 0; });
   return st;
 }
 
@@ -345,7 +603,84 @@ Status DBCloudImpl::DoCheckpointToCloud(
     return st;
   }
 
-  std::vector<std::pair<std::string, std::string>> files_to_copy;
+  Options db_options = GetOptions();
+  auto provider = cfs->GetStorageProvider();
+  auto upload_file = [&](const std::shared_ptr<CloudStorageProvider>& p,
+                         const std::string& localName,
+                         const std::string& destName) {
+    return p->PutCloudObject(
+        GetName() + "/" + localName, destination.GetBucketName(),
+        cfs->CloudObjectName(destination.GetObjectPath(), destName));
+  };
+
+  // In incremental mode, find out which files the destination already has
+  // and which ones the cloud storage of the DB can copy server-side.
+  std::unordered_map<uint64_t, LiveSstFileInfo> checkpointed;
+  std::unordered_set<std::string> dest_objects;
+  std::unordered_set<std::string> db_dest_objects;
+  std::unordered_set<std::string> db_src_objects;
+  if (options.incremental) {
+    auto list_objects = [&](const std::string& bucket, const std::string& path,
+                            std::unordered_set<std::string>* objects) {
+      std::vector<std::string> names;
+      auto s = provider->ListCloudObjects(bucket, path, &names);
+      for (const auto& name : names) {
+        objects->insert(RemoveSstObjectShard(name));
+      }
+      return s.IsNotFound() ? IOStatus::OK() : s;
+    };
+    auto same_as_dest = [&](const std::string& bucket,
+                            const std::string& path) {
+      return bucket == destination.GetBucketName() &&
+             path == destination.GetObjectPath();
+    };
+    IOStatus s = list_objects(destination.GetBucketName(),
+                              destination.GetObjectPath(), &dest_objects);
+    if (s.ok() && !dest_objects.empty()) {
+      std::set<uint64_t> numbers;
+      std::vector<LiveSstFileInfo> files;
+      ManifestReader reader(db_options.info_log, cfs,
+                            destination.GetBucketName());
+      s = reader.GetLiveFiles(destination.GetObjectPath(), &numbers, &files);
+      if (s.IsNotFound()) {
+        s = IOStatus::OK();
+      }
+      for (auto& f : files) {
+        checkpointed.emplace(f.number, std::move(f));
+      }
+    }
+    if (s.ok() && cfs->HasDestBucket() &&
+        !same_as_dest(cfs->GetDestBucketName(), cfs->GetDestObjectPath())) {
+      s = list_objects(cfs->GetDestBucketName(), cfs->GetDestObjectPath(),
+                       &db_dest_objects);
+    }
+    if (s.ok() && cfs->HasSrcBucket() && !cfs->SrcMatchesDest() &&
+        !same_as_dest(cfs->GetSrcBucketName(), cfs->GetSrcObjectPath())) {
+      s = list_objects(cfs->GetSrcBucketName(), cfs->GetSrcObjectPath(),
+                       &db_src_objects);
+    }
+    if (!s.ok()) {
+      Log(InfoLogLevel::WARN_LEVEL, db_options.info_log,
+          "CheckpointToCloud could not look up reusable files, uploading all "
+          "of them. %s",
+          s.ToString().c_str());
+      checkpointed.clear();
+      dest_objects.clear();
+      db_dest_objects.clear();
+      db_src_objects.clear();
+    }
+  }
+
+  std::vector<LiveFileMetaData> live_files_meta;
+  GetLiveFilesMetaData(&live_files_meta);
+  std::unordered_map<uint64_t, const LiveFileMetaData*> meta_of_file;
+  for (const auto& meta : live_files_meta) {
+    meta_of_file[meta.file_number] = &meta;
+  }
+
+  std::vector<CloudTransfer> transfers;
+  size_t num_reused = 0;
+  size_t num_copied = 0;
   for (auto& f : live_files) {
     uint64_t number = 0;
     FileType type;
@@ -358,7 +693,54 @@ Status DBCloudImpl::DoCheckpointToCloud(
       continue;
     }
     auto remapped_fname = cfs->RemapFilename(f);
-    files_to_copy.emplace_back(remapped_fname, remapped_fname);
+    uint64_t size = 0;
+    auto meta = meta_of_file.find(number);
+    if (meta != meta_of_file.end()) {
+      size = meta->second->size;
+      auto prev = checkpointed.find(number);
+      if (prev != checkpointed.end() &&
+          dest_objects.count(remapped_fname) > 0 &&
+          prev->second.file_size == size &&
+          prev->second.file_checksum == meta->second->file_checksum &&
+          prev->second.file_checksum_func_name ==
+              meta->second->file_checksum_func_name) {
+        num_reused++;
+        continue;
+      }
+    }
+
+    auto dest_fname =
+        cfs->CloudObjectName(destination.GetObjectPath(), remapped_fname);
+    std::function<IOStatus()> run;
+    if (db_dest_objects.count(remapped_fname) > 0) {
+      run = [&, remapped_fname, dest_fname]() {
+        return provider->CopyCloudObject(
+            cfs->GetDestBucketName(),
+            cfs->CloudObjectName(cfs->GetDestObjectPath(), remapped_fname),
+            destination.GetBucketName(), dest_fname);
+      };
+      num_copied++;
+    } else if (db_src_objects.count(remapped_fname) > 0) {
+      run = [&, remapped_fname, dest_fname]() {
+        return provider->CopyCloudObject(
+            cfs->GetSrcBucketName(),
+            cfs->CloudObjectName(cfs->GetSrcObjectPath(), remapped_fname),
+            destination.GetBucketName(), dest_fname);
+      };
+      num_copied++;
+    } else {
+      run = [&, remapped_fname]() {
+        return upload_file(provider, remapped_fname, remapped_fname);
+      };
+    }
+    transfers.push_back({remapped_fname, size, std::move(run)});
+  }
+  if (options.incremental) {
+    Log(InfoLogLevel::INFO_LEVEL, db_options.info_log,
+        "CheckpointToCloud reuses %" ROCKSDB_PRIszt
+        " files of the destination, copies %" ROCKSDB_PRIszt
+        " and uploads %" ROCKSDB_PRIszt,
+        num_reused, num_copied, transfers.size() - num_copied);
   }
 
   // IDENTITY file
@@ -368,83 +750,835 @@ Status DBCloudImpl::DoCheckpointToCloud(
     return st;
   }
   dbid = rtrim_if(trim(dbid), '\n');
-  files_to_copy.emplace_back(IdentityFileName(""), IdentityFileName(""));
+  transfers.push_back({IdentityFileName(""), dbid.size(), [&]() {
+                         return upload_file(provider, IdentityFileName(""),
+                                            IdentityFileName(""));
+                       }});
 
-  std::atomic<size_t> next_file_to_copy{0};
-  int thread_count = std::max(1, options.thread_count);
-  std::vector<Status> thread_statuses;
-  thread_statuses.resize(thread_count);
+  st = RunCloudTransfers("CheckpointToCloud", &transfers, options.thread_count,
+                         db_options.info_log);
+  if (!st.ok()) {
+    return st;
+  }
 
-  auto upload_file = [&](const std::shared_ptr<CloudStorageProvider>& provider,
-                         const std::string& localName,
-                         const std::string& destName) {
-    return provider->PutCloudObject(
-        GetName() + "/" + localName, destination.GetBucketName(),
-        destination.GetObjectPath() + "/" + destName);
-  };
-  auto do_copy = [&](size_t threadId) {
-    auto provider = cfs->GetStorageProvider();
-    while (true) {
-      size_t idx = next_file_to_copy.fetch_add(1);
-      if (idx >= files_to_copy.size()) {
-        break;
+  // Upload MANIFEST and CLOUDMANIFEST sequentially only after copying all data
+  // files
+
+  // MANIFEST file
+  st = upload_file(cfs->GetStorageProvider(), tmp_manifest_fname,
+                   manifest_fname);
+  if (!st.ok()) {
+    return st;
+  }
+
+  // CLOUDMANIFEST file
+  st = upload_file(cfs->GetStorageProvider(), cfs->CloudManifestFile(""),
+                   cfs->CloudManifestFile(""));
+  if (!st.ok()) {
+    return st;
+  }
+
+  // Ignore errors
+  local_fs->DeleteFile(tmp_manifest_fname, IOOptions(), nullptr /*dbg*/);
+
+  st = cfs->SaveDbid(destination.GetBucketName(), dbid,
+                     destination.GetObjectPath());
+  return st;
+}
+
+Status DBCloudImpl::BackupToCloud(const BucketOptions& destination,
+                                  const CloudBackupOptions& options,
+                                  uint64_t* backup_id) {
+  DisableFileDeletions();
+  auto st = DoBackupToCloud(destination, options, backup_id);
+  EnableFileDeletions();
+  return st;
+}
+
+Status DBCloudImpl::DoBackupToCloud(const BucketOptions& destination,
+                                    const CloudBackupOptions& options,
+                                    uint64_t* backup_id) {
+  auto* cfs = dynamic_cast<CloudFileSystem*>(GetEnv()->GetFileSystem().get());
+  assert(cfs);
+  const auto& local_fs = cfs->GetBaseFileSystem();
+  const auto& provider = cfs->GetStorageProvider();
+  Options db_options = GetOptions();
+  const std::string& bucket = destination.GetBucketName();
+  const std::string& path = destination.GetObjectPath();
+
+  // Find the SST files that the earlier backups hold and the id of the new
+  // one. The id of a backup that did not complete is not reused.
+  std::vector<std::string> objects;
+  IOStatus s = provider->ListCloudObjects(bucket, path, &objects);
+  if (!s.ok() && !s.IsNotFound()) {
+    return s;
+  }
+  const std::string shared_prefix = std::string(kCloudBackupSharedDir) + "/";
+  std::unordered_set<std::string> shared;
+  uint64_t last_id = 0;
+  for (const auto& name : objects) {
+    if (StartsWith(name, shared_prefix)) {
+      shared.insert(name.substr(shared_prefix.size()));
+      continue;
+    }
+    Slice rest(name);
+    uint64_t id = 0;
+    if (rest.starts_with(kCloudBackupDirPrefix)) {
+      rest.remove_prefix(strlen(kCloudBackupDirPrefix));
+      if (ConsumeDecimalNumber(&rest, &id) && rest.starts_with("/")) {
+        last_id = std::max(last_id, id);
       }
+    }
+  }
+  const uint64_t id = last_id + 1;
+  const std::string backup_dir = CloudBackupDir(path, id);
 
-      auto& f = files_to_copy[idx];
-      auto copy_st = upload_file(provider, f.first, f.second);
-      if (!copy_st.ok()) {
-        thread_statuses[threadId] = std::move(copy_st);
+  LiveFilesStorageInfoOptions live_options;
+  live_options.wal_size_for_flush = options.flush_memtable
+                                        ? 0
+                                        : std::numeric_limits<uint64_t>::max();
+  std::vector<LiveFileStorageInfo> live_files;
+  Status st = GetLiveFilesStorageInfo(live_options, &live_files);
+  if (!st.ok()) {
+    return st;
+  }
+
+  std::string meta = std::string(kCloudBackupMetaHeader) + "\n";
+  auto add_to_meta = [&meta](const char* kind, const std::string& name) {
+    meta.append(kind).append(" ").append(name).append("\n");
+  };
+  // Local copies made for the backup, deleted once it is done.
+  std::vector<std::string> tmp_files;
+  auto upload_file = [&](const std::string& local_file,
+                         const std::string& name) {
+    return provider->PutCloudObject(local_file, bucket,
+                                    backup_dir + "/" + name);
+  };
+  // Uploads the first size bytes of a file that the DB may still append to.
+  auto upload_prefix = [&](const std::string& local_file, uint64_t size,
+                           const std::string& name) {
+    const std::string tmp = GetName() + "/" + name + ".backup";
+    tmp_files.push_back(tmp);
+    return std::function<IOStatus()>([&, local_file, size, name, tmp]() {
+      auto r = CopyFile(local_fs.get(), local_file, Temperature::kUnknown, tmp,
+                        Temperature::kUnknown, size, false /*use_fsync*/,
+                        nullptr /*io_tracer*/);
+      return r.ok() ? upload_file(tmp, name) : r;
+    });
+  };
+
+  std::vector<CloudTransfer> transfers;
+  size_t num_shared = 0;
+  size_t num_ssts = 0;
+  for (const auto& f : live_files) {
+    if (f.file_type == kTableFile) {
+      auto remapped_fname = cfs->RemapFilename(f.relative_filename);
+      add_to_meta(kCloudBackupSst, remapped_fname);
+      num_ssts++;
+      if (shared.count(remapped_fname) > 0) {
+        num_shared++;
+        continue;
+      }
+      // Copied server-side from the bucket of the DB that holds the file,
+      // and uploaded if none does yet, e.g. with deferred uploads.
+      auto run = [&, remapped_fname,
+                  local_file = f.directory + "/" + remapped_fname]() {
+        const std::string dest_object =
+            path + "/" + shared_prefix + remapped_fname;
+        IOStatus r = IOStatus::NotFound();
+        if (cfs->HasDestBucket()) {
+          r = provider->CopyCloudObject(
+              cfs->GetDestBucketName(),
+              cfs->CloudObjectName(cfs->GetDestObjectPath(), remapped_fname),
+              bucket, dest_object);
+        }
+        if (r.IsNotFound() && cfs->HasSrcBucket() && !cfs->SrcMatchesDest()) {
+          r = provider->CopyCloudObject(
+              cfs->GetSrcBucketName(),
+              cfs->CloudObjectName(cfs->GetSrcObjectPath(), remapped_fname),
+              bucket, dest_object);
+        }
+        if (r.IsNotFound()) {
+          r = provider->PutCloudObject(local_file, bucket, dest_object);
+        }
+        return r;
+      };
+      transfers.push_back({remapped_fname, f.size, std::move(run)});
+    } else if (f.file_type == kDescriptorFile) {
+      auto remapped_fname = cfs->RemapFilename(f.relative_filename);
+      add_to_meta(kCloudBackupManifest, remapped_fname);
+      transfers.push_back(
+          {remapped_fname, f.size,
+           upload_prefix(f.directory + "/" + remapped_fname, f.size,
+                         remapped_fname)});
+    } else if (f.file_type == kWalFile) {
+      if (!cfs->GetCloudFileSystemOptions().keep_local_log_files) {
+        continue;
+      }
+      add_to_meta(kCloudBackupWal, f.relative_filename);
+      transfers.push_back(
+          {f.relative_filename, f.size,
+           upload_prefix(f.directory + "/" + f.relative_filename, f.size,
+                         f.relative_filename)});
+    } else if (f.file_type == kCurrentFile) {
+      const std::string tmp = GetName() + "/" + f.relative_filename + ".backup";
+      tmp_files.push_back(tmp);
+      st = WriteStringToFile(local_fs.get(), f.replacement_contents, tmp,
+                             false /*should_sync*/);
+      if (!st.ok()) {
         break;
       }
+      add_to_meta(kCloudBackupCurrent, f.relative_filename);
+      transfers.push_back({f.relative_filename, f.size, [&, tmp]() {
+                             return upload_file(tmp, kCurrentFileName);
+                           }});
+    } else if (f.file_type == kBlobFile) {
+      st = Status::NotSupported("BackupToCloud does not support blob files");
+      break;
     }
+  }
+  if (st.ok()) {
+    add_to_meta(kCloudBackupIdentity, IdentityFileName(""));
+    transfers.push_back({IdentityFileName(""), 0, [&]() {
+                           return upload_file(IdentityFileName(GetName()),
+                                              IdentityFileName(""));
+                         }});
+    add_to_meta(kCloudBackupCloudManifest, cfs->CloudManifestFile(""));
+    transfers.push_back({cfs->CloudManifestFile(""), 0, [&]() {
+                           return upload_file(cfs->CloudManifestFile(GetName()),
+                                              cfs->CloudManifestFile(""));
+                         }});
+    Log(InfoLogLevel::INFO_LEVEL, db_options.info_log,
+        "BackupToCloud %" PRIu64 " to %s/%s shares %" ROCKSDB_PRIszt
+        " of %" ROCKSDB_PRIszt " SST files with earlier backups",
+        id, bucket.c_str(), path.c_str(), num_shared, num_ssts);
+    st = RunCloudTransfers("BackupToCloud", &transfers, options.thread_count,
+                           db_options.info_log);
+  }
+  // The backup is complete once its META object is uploaded.
+  if (st.ok()) {
+    const std::string tmp =
+        GetName() + "/" + kCloudBackupMetaObject + ".backup";
+    tmp_files.push_back(tmp);
+    st = WriteStringToFile(local_fs.get(), meta, tmp, false /*should_sync*/);
+    if (st.ok()) {
+      st = upload_file(tmp, kCloudBackupMetaObject);
+    }
+  }
+  for (const auto& tmp : tmp_files) {
+    local_fs->DeleteFile(tmp, IOOptions(), nullptr).PermitUncheckedError();
+  }
+  Log(st.ok() ? InfoLogLevel::INFO_LEVEL : InfoLogLevel::ERROR_LEVEL,
+      db_options.info_log, "BackupToCloud %" PRIu64 " to %s/%s. %s", id,
+      bucket.c_str(), path.c_str(), st.ToString().c_str());
+  if (st.ok()) {
+    *backup_id = id;
+  }
+  return st;
+}
+
+Status DBCloudImpl::ExportColumnFamilyToCloud(
+    ColumnFamilyHandle* handle, const BucketOptions& destination,
+    const ExportColumnFamilyToCloudOptions& options,
+    ExportImportFilesMetaData** metadata) {
+  assert(metadata != nullptr);
+  assert(*metadata == nullptr);
+  auto st = Flush(FlushOptions(), handle);
+  if (!st.ok()) {
+    return st;
+  }
+  DisableFileDeletions();
+  st = DoExportColumnFamilyToCloud(handle, destination, options, metadata);
+  EnableFileDeletions();
+  return st;
+}
+
+Status DBCloudImpl::DoExportColumnFamilyToCloud(
+    ColumnFamilyHandle* handle, const BucketOptions& destination,
+    const ExportColumnFamilyToCloudOptions& options,
+    ExportImportFilesMetaData** metadata) {
+  auto* cfs = dynamic_cast<CloudFileSystem*>(GetEnv()->GetFileSystem().get());
+  assert(cfs);
+  const auto& provider = cfs->GetStorageProvider();
+  const auto info_log = GetDBOptions().info_log;
+  const std::string& bucket = destination.GetBucketName();
+  const std::string& path = destination.GetObjectPath();
+
+  // The cloud storage of the DB holds the files it wrote in its destination
+  // bucket, and those of the DB it was cloned from in its source bucket.
+  std::unordered_set<std::string> db_dest_objects;
+  std::unordered_set<std::string> db_src_objects;
+  auto list_objects = [&](const std::string& b, const std::string& p,
+                          std::unordered_set<std::string>* objects) {
+    std::vector<std::string> names;
+    auto s = provider->ListCloudObjects(b, p, &names);
+    for (const auto& name : names) {
+      objects->insert(RemoveSstObjectShard(name));
+    }
+    return s.IsNotFound() ? IOStatus::OK() : s;
   };
+  IOStatus s;
+  if (cfs->HasDestBucket()) {
+    s = list_objects(cfs->GetDestBucketName(), cfs->GetDestObjectPath(),
+                     &db_dest_objects);
+  }
+  if (s.ok() && cfs->HasSrcBucket() && !cfs->SrcMatchesDest()) {
+    s = list_objects(cfs->GetSrcBucketName(), cfs->GetSrcObjectPath(),
+                     &db_src_objects);
+  }
+  if (!s.ok()) {
+    return s;
+  }
 
-  if (thread_count == 1) {
-    do_copy(0);
-  } else {
-    std::vector<std::thread> threads;
-    for (int i = 0; i < thread_count; ++i) {
-      threads.emplace_back([&, i]() { do_copy(i); });
+  ColumnFamilyMetaData cf_metadata;
+  GetColumnFamilyMetaData(handle, &cf_metadata);
+  std::unique_ptr<ExportImportFilesMetaData> result(
+      new ExportImportFilesMetaData());
+  result->db_comparator_name = handle->GetComparator()->Name();
+  // The importer opens db_path + "/" + name, see ImportColumnFamilyJob.
+  const std::string export_uri =
+      std::string(CloudFileSystem::kCloudObjectUriPrefix()) + bucket + pathsep +
+      path;
+  std::vector<CloudTransfer> transfers;
+  size_t num_copied = 0;
+  for (const auto& level_metadata : cf_metadata.levels) {
+    for (const auto& file_metadata : level_metadata.files) {
+      const std::string& fname = file_metadata.relative_filename;
+      const std::string remapped_fname = basename(cfs->RemapFilename(fname));
+      const std::string dest_fname = path + pathsep + fname;
+      std::function<IOStatus()> run;
+      if (db_dest_objects.count(remapped_fname) > 0) {
+        run = [&, remapped_fname, dest_fname]() {
+          return provider->CopyCloudObject(
+              cfs->GetDestBucketName(),
+              cfs->CloudObjectName(cfs->GetDestObjectPath(), remapped_fname),
+              bucket, dest_fname);
+        };
+        num_copied++;
+      } else if (db_src_objects.count(remapped_fname) > 0) {
+        run = [&, remapped_fname, dest_fname]() {
+          return provider->CopyCloudObject(
+              cfs->GetSrcBucketName(),
+              cfs->CloudObjectName(cfs->GetSrcObjectPath(), remapped_fname),
+              bucket, dest_fname);
+        };
+        num_copied++;
+      } else {
+        run = [&, remapped_fname, dest_fname]() {
+          return provider->PutCloudObject(GetName() + "/" + remapped_fname,
+                                          bucket, dest_fname);
+        };
+      }
+      transfers.push_back({remapped_fname, file_metadata.size, std::move(run)});
+
+      LiveFileMetaData live_file_metadata;
+      static_cast<SstFileMetaData&>(live_file_metadata) = file_metadata;
+      live_file_metadata.name = fname;
+      live_file_metadata.db_path = export_uri;
+      live_file_metadata.directory = export_uri;
+      live_file_metadata.column_family_name = cf_metadata.name;
+      live_file_metadata.level = level_metadata.level;
+      result->files.push_back(std::move(live_file_metadata));
+    }
+  }
+
+  auto st = RunCloudTransfers("ExportColumnFamilyToCloud", &transfers,
+                              options.thread_count, info_log);
+  Log(st.ok() ? InfoLogLevel::INFO_LEVEL : InfoLogLevel::ERROR_LEVEL, info_log,
+      "ExportColumnFamilyToCloud [%s] to %s/%s copied %" ROCKSDB_PRIszt
+      " of %" ROCKSDB_PRIszt " files in the cloud. %s",
+      cf_metadata.name.c_str(), bucket.c_str(), path.c_str(), num_copied,
+      transfers.size(), st.ToString().c_str());
+  if (st.ok()) {
+    *metadata = result.release();
+  }
+  return st;
+}
+
+Status DBCloud::RestoreFromCloudBackup(Env* env, const BucketOptions& source,
+                                       uint64_t backup_id,
+                                       const std::string& local_dbname) {
+  auto* cfs = dynamic_cast<CloudFileSystemImpl*>(env->GetFileSystem().get());
+  if (cfs == nullptr || !cfs->HasDestBucket()) {
+    return Status::InvalidArgument(
+        "Restoring a backup requires a cloud env with a destination bucket");
+  }
+  const auto& local_fs = cfs->GetBaseFileSystem();
+  const auto& provider = cfs->GetStorageProvider();
+  const std::string& src_bucket = source.GetBucketName();
+  const std::string backup_dir =
+      CloudBackupDir(source.GetObjectPath(), backup_id);
+  const std::string& dest_bucket = cfs->GetDestBucketName();
+  const std::string& dest_path = cfs->GetDestObjectPath();
+
+  IOStatus s = local_fs->CreateDirIfMissing(local_dbname, IOOptions(), nullptr);
+  const std::string meta_file =
+      local_dbname + "/" + kCloudBackupMetaObject + ".restore";
+  if (s.ok()) {
+    s = provider->GetCloudObject(
+        src_bucket, backup_dir + "/" + kCloudBackupMetaObject, meta_file);
+  }
+  std::string meta;
+  if (s.ok()) {
+    s = ReadFileToString(local_fs.get(), meta_file, &meta);
+    local_fs->DeleteFile(meta_file, IOOptions(), nullptr)
+        .PermitUncheckedError();
+  }
+  if (!s.ok()) {
+    return s;
+  }
+
+  // The copies to the destination bucket and the downloads of the files
+  // that the DB reads locally.
+  std::vector<std::function<IOStatus()>> steps;
+  auto copy_to_dest = [&](const std::string& object,
+                          const std::string& dest_object) {
+    steps.push_back([&, object, dest_object]() {
+      return provider->CopyCloudObject(src_bucket, object, dest_bucket,
+                                       dest_object);
+    });
+  };
+  auto download = [&](const std::string& object,
+                      const std::string& local_file) {
+    steps.push_back([&, object, local_file]() {
+      return provider->GetCloudObject(src_bucket, object, local_file);
+    });
+  };
+  std::string identity_object;
+  std::vector<std::string> lines = StringSplit(meta, '\n');
+  if (lines.empty() || lines[0] != kCloudBackupMetaHeader) {
+    return Status::Corruption("Bad backup META in " + backup_dir);
+  }
+  for (size_t i = 1; i < lines.size(); i++) {
+    const auto& line = lines[i];
+    const auto sep = line.find(' ');
+    if (sep == std::string::npos) {
+      return Status::Corruption("Bad backup META in " + backup_dir, line);
     }
-    for (auto& t : threads) {
-      t.join();
+    const std::string kind = line.substr(0, sep);
+    const std::string name = line.substr(sep + 1);
+    const std::string object = backup_dir + "/" + name;
+    if (kind == kCloudBackupSst) {
+      copy_to_dest(source.GetObjectPath() + "/" + kCloudBackupSharedDir + "/" +
+                       name,
+                   cfs->CloudObjectName(dest_path, name));
+    } else if (kind == kCloudBackupManifest) {
+      copy_to_dest(object, dest_path + "/" + name);
+      download(object, local_dbname + "/" + name);
+    } else if (kind == kCloudBackupCloudManifest) {
+      copy_to_dest(object, cfs->CloudManifestFile(dest_path));
+      download(object, cfs->CloudManifestFile(local_dbname));
+    } else if (kind == kCloudBackupCurrent) {
+      download(object, CurrentFileName(local_dbname));
+    } else if (kind == kCloudBackupWal) {
+      download(object, local_dbname + "/" + name);
+    } else if (kind == kCloudBackupIdentity) {
+      identity_object = object;
+    } else {
+      return Status::Corruption("Bad backup META in " + backup_dir, line);
     }
   }
+  if (identity_object.empty()) {
+    return Status::Corruption("No IDENTITY in backup META in " + backup_dir);
+  }
 
-  for (auto& s : thread_statuses) {
-    if (!s.ok()) {
-      st = s;
-      break;
+  std::mutex mu;
+  size_t next = 0;
+  IOStatus first_error;
+  auto worker = [&]() {
+    while (true) {
+      size_t i;
+      {
+        std::lock_guard<std::mutex> lk(mu);
+        if (!first_error.ok() || next >= steps.size()) {
+          return;
+        }
+        i = next++;
+      }
+      auto r = steps[i]();
+      if (!r.ok()) {
+        std::lock_guard<std::mutex> lk(mu);
+        if (first_error.ok()) {
+          first_error = r;
+        }
+      }
     }
+  };
+  std::vector<std::thread> threads;
+  const size_t num_threads =
+      std::min(steps.size(), static_cast<size_t>(kCloudRestoreThreads));
+  for (size_t i = 0; i < num_threads; i++) {
+    threads.emplace_back(worker);
+  }
+  for (auto& t : threads) {
+    t.join();
+  }
+  if (!first_error.ok()) {
+    return first_error;
+  }
+
+  // The restored DB is a new DB, with a new dbid derived from the dbid of
+  // the backup, as for a clone.
+  const std::string identity_file = IdentityFileName(local_dbname);
+  std::string dbid;
+  s = provider->GetCloudObject(src_bucket, identity_object, identity_file);
+  if (s.ok()) {
+    s = ReadFileToString(local_fs.get(), identity_file, &dbid);
+  }
+  if (s.ok()) {
+    dbid = rtrim_if(trim(dbid), '\n') +
+           CloudFileSystemImpl::DBID_SEPARATOR +
+           Env::Default()->GenerateUniqueId();
+    s = WriteStringToFile(local_fs.get(), dbid, identity_file,
+                          true /*should_sync*/);
+  }
+  if (s.ok()) {
+    s = provider->PutCloudObject(identity_file, dest_bucket,
+                                 IdentityFileName(dest_path));
+  }
+  if (s.ok()) {
+    s = cfs->SaveDbid(dest_bucket, dbid, dest_path);
+  }
+  Log(s.ok() ? InfoLogLevel::INFO_LEVEL : InfoLogLevel::ERROR_LEVEL,
+      cfs->GetLogger(),
+      "Restored backup %" PRIu64 " of %s/%s to %s/%s and %s as dbid %s. %s",
+      backup_id, src_bucket.c_str(), source.GetObjectPath().c_str(),
+      dest_bucket.c_str(), dest_path.c_str(), local_dbname.c_str(),
+      dbid.c_str(), s.ToString().c_str());
+  return s;
+}
+
+Status DBCloud::OpenFollowerFromCloud(
+    const Options& options, const std::string& local_dbname,
+    const std::string& persistent_cache_path,
+    const uint64_t persistent_cache_size_gb,
+    std::vector<ColumnFamilyHandle*>* handles, DBCloud** dbptr,
+    std::string* replication_sequence) {
+  auto* cfs =
+      dynamic_cast<CloudFileSystem*>(options.env->GetFileSystem().get());
+  if (cfs == nullptr || !cfs->HasSrcBucket()) {
+    return Status::InvalidArgument(
+        "Opening a follower requires a cloud env with a source bucket");
   }
+  // The follower only changes through ApplyReplicationLogRecord().
+  Options follower_options = options;
+  follower_options.disable_auto_compactions = true;
+  follower_options.disable_auto_flush = true;
+  follower_options.replication_log_listener.reset();
 
+  std::vector<std::string> cf_names;
+  Status st = DBCloud::ListColumnFamilies(follower_options, local_dbname,
+                                          &cf_names);
   if (!st.ok()) {
     return st;
   }
+  std::vector<ColumnFamilyDescriptor> column_families;
+  for (const auto& name : cf_names) {
+    column_families.emplace_back(name, ColumnFamilyOptions(follower_options));
+  }
+  DBCloud* db = nullptr;
+  st = DBCloud::Open(follower_options, local_dbname, column_families,
+                     persistent_cache_path, persistent_cache_size_gb, handles,
+                     &db);
+  if (!st.ok()) {
+    return st;
+  }
+  st = db->GetPersistedReplicationSequence(replication_sequence);
+  if (!st.ok()) {
+    for (auto* h : *handles) {
+      delete h;
+    }
+    handles->clear();
+    delete db;
+    return st;
+  }
+  Log(InfoLogLevel::INFO_LEVEL, db->GetOptions().info_log,
+      "Opened follower %s with %" ROCKSDB_PRIszt
+      " column families from %s/%s%s",
+      local_dbname.c_str(), handles->size(), cfs->GetSrcBucketName().c_str(),
+      cfs->GetSrcObjectPath().c_str(),
+      replication_sequence->empty() ? ", no replication sequence" : "");
+  *dbptr = db;
+  return st;
+}
 
-  // Upload MANIFEST and CLOUDMANIFEST sequentially only after copying all data
-  // files
+Status DBCloudImpl::DumpBlockCacheToCloud() {
+  auto* cfs =
+      dynamic_cast<CloudFileSystemImpl*>(GetEnv()->GetFileSystem().get());
+  assert(cfs);
+  Options options = GetOptions();
+  if (!cfs->HasDestBucket()) {
+    return Status::InvalidArgument(
+        "Dumping the block cache requires a destination bucket");
+  }
+  auto* table_options =
+      options.table_factory->GetOptions<BlockBasedTableOptions>();
+  if (table_options == nullptr || !table_options->block_cache) {
+    return Status::NotSupported("The DB has no block cache to dump");
+  }
 
-  // MANIFEST file
-  st = upload_file(cfs->GetStorageProvider(), tmp_manifest_fname,
-                   manifest_fname);
+  std::lock_guard<std::mutex> lk(block_cache_dump_mutex_);
+  const auto& local_fs = cfs->GetBaseFileSystem();
+  const std::string local_file =
+      GetName() + "/" + kBlockCacheDumpObject + ".dump";
+  const std::string object =
+      cfs->GetDestObjectPath() + "/" + kBlockCacheDumpObject;
+  std::unique_ptr<CacheDumpWriter> writer;
+  Status st =
+      NewToFileCacheDumpWriter(local_fs, FileOptions(), local_file, &writer);
+  std::unique_ptr<CacheDumper> dumper;
+  if (st.ok()) {
+    CacheDumpOptions dump_options;
+    dump_options.clock = GetEnv()->GetSystemClock().get();
+    st = NewDefaultCacheDumper(dump_options, table_options->block_cache,
+                               std::move(writer), &dumper);
+  }
+  if (st.ok()) {
+    st = dumper->SetDumpFilter({GetBaseDB()});
+  }
+  if (st.ok()) {
+    st = dumper->DumpCacheEntriesToWriter();
+  }
+  if (st.ok()) {
+    st = cfs->GetStorageProvider()->PutCloudObject(
+        local_file, cfs->GetDestBucketName(), object);
+  }
+  local_fs->DeleteFile(local_file, IOOptions(), nullptr)
+      .PermitUncheckedError();
+  Log(st.ok() ? InfoLogLevel::INFO_LEVEL : InfoLogLevel::ERROR_LEVEL,
+      options.info_log, "Dumped the block cache to %s/%s. %s",
+      cfs->GetDestBucketName().c_str(), object.c_str(),
+      st.ToString().c_str());
+  return st;
+}
+
+Status DBCloudImpl::LoadBlockCacheFromCloud() {
+  auto* cfs =
+      dynamic_cast<CloudFileSystemImpl*>(GetEnv()->GetFileSystem().get());
+  assert(cfs);
+  Options options = GetOptions();
+  auto* table_options =
+      options.table_factory->GetOptions<BlockBasedTableOptions>();
+  if (!cfs->HasSrcBucket() || table_options == nullptr) {
+    return Status::OK();
+  }
+  const auto& local_fs = cfs->GetBaseFileSystem();
+  const std::string local_file =
+      GetName() + "/" + kBlockCacheDumpObject + ".load";
+  const std::string object =
+      cfs->GetSrcObjectPath() + "/" + kBlockCacheDumpObject;
+  Status st = cfs->GetStorageProvider()->GetCloudObject(
+      cfs->GetSrcBucketName(), object, local_file);
+  if (st.IsNotFound()) {
+    Log(InfoLogLevel::INFO_LEVEL, options.info_log,
+        "No block cache to load from %s/%s", cfs->GetSrcBucketName().c_str(),
+        object.c_str());
+    return Status::OK();
+  }
+  std::unique_ptr<CacheDumpReader> reader;
+  if (st.ok()) {
+    st = NewFromFileCacheDumpReader(local_fs, FileOptions(), local_file,
+                                    &reader);
+  }
+  std::unique_ptr<CacheDumpedLoader> loader;
+  if (st.ok()) {
+    CacheDumpOptions dump_options;
+    dump_options.clock = GetEnv()->GetSystemClock().get();
+    st = NewDefaultCacheDumpedLoader(
+        dump_options, *table_options,
+        cfs->GetCloudFileSystemOptions().block_cache_load_target,
+        std::move(reader), &loader);
+  }
+  if (st.ok()) {
+    st = loader->RestoreCacheEntriesToSecondaryCache();
+  }
+  local_fs->DeleteFile(local_file, IOOptions(), nullptr)
+      .PermitUncheckedError();
+  Log(st.ok() ? InfoLogLevel::INFO_LEVEL : InfoLogLevel::ERROR_LEVEL,
+      options.info_log, "Loaded the block cache from %s/%s. %s",
+      cfs->GetSrcBucketName().c_str(), object.c_str(),
+      st.ToString().c_str());
+  return st;
+}
+
+void DBCloudImpl::StartBlockCacheDumps() {
+  auto* cfs =
+      dynamic_cast<CloudFileSystemImpl*>(GetEnv()->GetFileSystem().get());
+  assert(cfs);
+  const uint64_t period_secs =
+      cfs->GetCloudFileSystemOptions().block_cache_dump_period_secs;
+  if (period_secs == 0) {
+    return;
+  }
+  dump_thread_ = std::thread([this, period_secs]() {
+    std::unique_lock<std::mutex> lk(dump_thread_mutex_);
+    while (!dump_thread_cv_.wait_for(lk, std::chrono::seconds(period_secs),
+                                     [this] { return dump_thread_stop_; })) {
+      lk.unlock();
+      // Logged, the next period retries.
+      DumpBlockCacheToCloud().PermitUncheckedError();
+      lk.lock();
+    }
+  });
+}
+
+void DBCloudImpl::StopBlockCacheDumps() {
+  {
+    std::lock_guard<std::mutex> lk(dump_thread_mutex_);
+    if (dump_thread_stop_) {
+      return;
+    }
+    dump_thread_stop_ = true;
+  }
+  dump_thread_cv_.notify_all();
+  if (dump_thread_.joinable()) {
+    dump_thread_.join();
+  }
+  if (dump_block_cache_on_close_) {
+    DumpBlockCacheToCloud().PermitUncheckedError();
+  }
+}
+
+Status DBCloudImpl::UploadStatsSnapshot() {
+  auto* cfs =
+      dynamic_cast<CloudFileSystemImpl*>(GetEnv()->GetFileSystem().get());
+  assert(cfs);
+  const auto& cloud_fs_options = cfs->GetCloudFileSystemOptions();
+  CloudStatsSnapshot snapshot;
+  snapshot.instance = stats_history_instance_;
+  snapshot.timestamp_micros = GetEnv()->NowMicros();
+  TakeCloudStatsSnapshot(GetDBOptions().statistics.get(),
+                         cloud_fs_options.statistics.get(), &snapshot);
+  std::string data;
+  EncodeCloudStatsSnapshot(snapshot, &data);
+
+  const auto& local_fs = cfs->GetBaseFileSystem();
+  const std::string local_file =
+      GetName() + "/" + kCloudStatsHistoryDir + ".upload";
+  const std::string object =
+      cfs->GetDestObjectPath() + "/" + CloudStatsSnapshotObjectName(snapshot);
+  Status st = WriteStringToFile(local_fs.get(), data, local_file,
+                                false /*should_sync*/);
+  if (st.ok()) {
+    st = cfs->GetStorageProvider()->PutCloudObject(
+        local_file, cfs->GetDestBucketName(), object);
+  }
+  local_fs->DeleteFile(local_file, IOOptions(), nullptr)
+      .PermitUncheckedError();
   if (!st.ok()) {
-    return st;
+    Log(InfoLogLevel::ERROR_LEVEL, GetDBOptions().info_log,
+        "Failed to upload the stats snapshot %s/%s. %s",
+        cfs->GetDestBucketName().c_str(), object.c_str(),
+        st.ToString().c_str());
   }
+  return st;
+}
 
-  // CLOUDMANIFEST file
-  st = upload_file(cfs->GetStorageProvider(), cfs->CloudManifestFile(""),
-                   cfs->CloudManifestFile(""));
+void DBCloudImpl::StartStatsHistory() {
+  auto* cfs =
+      dynamic_cast<CloudFileSystemImpl*>(GetEnv()->GetFileSystem().get());
+  assert(cfs);
+  const auto& cloud_fs_options = cfs->GetCloudFileSystemOptions();
+  std::string host;
+  if (!GetEnv()->GetHostNameString(&host).ok() || host.empty()) {
+    host = "localhost";
+  }
+  std::string session_id;
+  GetDbSessionId(session_id).PermitUncheckedError();
+  stats_history_instance_ = host + "-" + session_id;
+  stats_history_scheduler_ = CloudScheduler::Get(cloud_fs_options.statistics);
+  const std::chrono::seconds period(cloud_fs_options.stats_history_period_secs);
+  stats_history_job_ = stats_history_scheduler_->ScheduleRecurringJob(
+      period, period,
+      [this](void*) {
+        // Logged, the next period retries.
+        UploadStatsSnapshot().PermitUncheckedError();
+      },
+      nullptr);
+}
+
+void DBCloudImpl::StopStatsHistory() {
+  if (!stats_history_scheduler_) {
+    return;
+  }
+  // Waits for the upload in progress, if any.
+  stats_history_scheduler_->CancelJob(stats_history_job_);
+  stats_history_scheduler_.reset();
+  UploadStatsSnapshot().PermitUncheckedError();
+}
+
+Status DBCloudImpl::Close() {
+  StopBlockCacheDumps();
+  StopStatsHistory();
+  return DBCloud::Close();
+}
+
+Status DBCloud::OpenAndCompact(
+    const OpenAndCompactOptions& options, const std::string& local_dbname,
+    const std::string& output_object_path, const std::string& input,
+    std::string* output,
+    const CompactionServiceOptionsOverride& override_options) {
+  auto* cfs = dynamic_cast<CloudFileSystem*>(
+      override_options.env->GetFileSystem().get());
+  if (cfs == nullptr) {
+    return Status::InvalidArgument("OpenAndCompact needs a cloud env");
+  }
+  // The worker only reads the DB.
+  if (!cfs->HasSrcBucket() || cfs->HasDestBucket() ||
+      !cfs->GetCloudFileSystemOptions().resync_on_open) {
+    return Status::InvalidArgument(
+        "OpenAndCompact needs a src bucket, no dest bucket and "
+        "resync_on_open");
+  }
+  const auto& local_fs = cfs->GetBaseFileSystem();
+  auto st = local_fs->CreateDirIfMissing(local_dbname, IOOptions(),
+                                         nullptr /*dbg*/);
+  if (st.ok()) {
+    st = cfs->SanitizeLocalDirectory(DBOptions(), local_dbname, true);
+  }
+  if (st.ok()) {
+    st = cfs->LoadCloudManifest(local_dbname, true);
+  }
   if (!st.ok()) {
     return st;
   }
 
-  // Ignore errors
-  local_fs->DeleteFile(tmp_manifest_fname, IOOptions(), nullptr /*dbg*/);
+  const std::string output_dir =
+      local_dbname + "/compaction-" + Env::Default()->GenerateUniqueId();
+  std::string local_output;
+  Status s = DB::OpenAndCompact(options, local_dbname, output_dir, input,
+                                &local_output, override_options);
+  CompactionServiceResult result;
+  if (s.ok()) {
+    s = CompactionServiceResult::Read(local_output, &result);
+  }
+  for (size_t i = 0; s.ok() && i < result.output_files.size(); i++) {
+    const auto& fname = result.output_files[i].file_name;
+    s = cfs->GetStorageProvider()->PutCloudObject(
+        cfs->RemapFilename(output_dir + "/" + fname), cfs->GetSrcBucketName(),
+        output_object_path + "/" + fname);
+  }
+  if (s.ok()) {
+    result.output_path = output_object_path;
+    s = result.Write(output);
+  } else {
+    // The result carries the status of the compaction, if it ran.
+    result.status.PermitUncheckedError();
+    *output = std::move(local_output);
+  }
 
-  st = cfs->SaveDbid(destination.GetBucketName(), dbid,
-                     destination.GetObjectPath());
-  return st;
+  // The outputs are in the cloud, or the compaction failed.
+  std::vector<std::string> children;
+  if (local_fs->GetChildren(output_dir, IOOptions(), &children, nullptr)
+          .ok()) {
+    for (const auto& child : children) {
+      local_fs->DeleteFile(output_dir + "/" + child, IOOptions(), nullptr)
+          .PermitUncheckedError();
+    }
+    local_fs->DeleteDir(output_dir, IOOptions(), nullptr)
+        .PermitUncheckedError();
+  }
+  return s;
 }
 
 Status DBCloud::ListColumnFamilies(const DBOptions& db_options,
@@ -3,9 +3,13 @@
 #pragma once
 
 #ifndef ROCKSDB_LITE
+#include <condition_variable>
 #include <deque>
+#include <functional>
 #include <memory>
+#include <mutex>
 #include <string>
+#include <thread>
 #include <vector>
 
 #include "rocksdb/cloud/db_cloud.h"
@@ -13,7 +17,9 @@
 
 namespace ROCKSDB_NAMESPACE {
 
+class CloudScheduler;
 class Env;
+class ThreadPoolImpl;
 
 //
 // All writes to this DB can be configured to be persisted
@@ -29,13 +35,51 @@ class DBCloudImpl : public DBCloud {
   Status CheckpointToCloud(const BucketOptions& destination,
                            const CheckpointToCloudOptions& options) override;
 
+  Status DumpBlockCacheToCloud() override;
+
+  Status BackupToCloud(const BucketOptions& destination,
+                       const CloudBackupOptions& options,
+                       uint64_t* backup_id) override;
+
+  Status ExportColumnFamilyToCloud(
+      ColumnFamilyHandle* handle, const BucketOptions& destination,
+      const ExportColumnFamilyToCloudOptions& options,
+      ExportImportFilesMetaData** metadata) override;
+
+  // Dumps the block cache first if CloudFileSystemOptions::dump_block_cache
+  // is set.
+  Status Close() override;
+
  protected:
   // The CloudFileSystem used by this open instance.
   CloudFileSystem* cfs_;
 
  private:
+  // A copy or upload of one file to the destination bucket.
+  struct CloudTransfer {
+    std::string fname;
+    uint64_t size;
+    std::function<IOStatus()> run;
+  };
+
+  // Runs the transfers on transfer_pool_, at most max_threads at a time,
+  // as checkpoint uploads of the upload scheduler of the file system.
+  // A failed transfer is retried a few times; once one fails for good, the
+  // ones not yet started are dropped and its error is returned. what names
+  // the operation in the progress messages written to info_log.
+  Status RunCloudTransfers(const char* what, std::vector<CloudTransfer>* jobs,
+                           int max_threads,
+                           const std::shared_ptr<Logger>& info_log);
+
   Status DoCheckpointToCloud(const BucketOptions& destination,
                              const CheckpointToCloudOptions& options);
+  Status DoBackupToCloud(const BucketOptions& destination,
+                         const CloudBackupOptions& options,
+                         uint64_t* backup_id);
+  Status DoExportColumnFamilyToCloud(
+      ColumnFamilyHandle* handle, const BucketOptions& destination,
+      const ExportColumnFamilyToCloudOptions& options,
+      ExportImportFilesMetaData** metadata);
 
   // Maximum manifest file size
   static const uint64_t max_manifest_file_size = 4 * 1024L * 1024L;
@@ -43,6 +87,42 @@ class DBCloudImpl : public DBCloud {
   DBCloudImpl(DB* db, std::unique_ptr<Env> local_env);
 
   std::unique_ptr<Env> local_env_;
+
+  // Shared by savepoints and checkpoints, created on first use.
+  std::mutex transfer_pool_mutex_;
+  std::unique_ptr<ThreadPoolImpl> transfer_pool_;
+
+  // Loads the BLOCKCACHE object of the source bucket, if any, into
+  // CloudFileSystemOptions::block_cache_load_target.
+  Status LoadBlockCacheFromCloud();
+  // Starts the periodic dumps of the block cache, see
+  // CloudFileSystemOptions::dump_block_cache.
+  void StartBlockCacheDumps();
+  // Stops the periodic dumps and runs the dump on close, once.
+  void StopBlockCacheDumps();
+
+  // Serializes the dumps of the block cache.
+  std::mutex block_cache_dump_mutex_;
+  // Set by DBCloud::Open() if the block cache is dumped on close.
+  bool dump_block_cache_on_close_ = false;
+  std::mutex dump_thread_mutex_;
+  std::condition_variable dump_thread_cv_;
+  bool dump_thread_stop_ = false;
+  std::thread dump_thread_;
+
+  // Uploads a snapshot of the stats of the DB to the destination bucket, see
+  // CloudFileSystemOptions::stats_history_period_secs.
+  Status UploadStatsSnapshot();
+  // Starts the periodic uploads of the stats snapshots.
+  void StartStatsHistory();
+  // Stops the periodic uploads and uploads the last snapshot, once.
+  void StopStatsHistory();
+
+  // Set by StartStatsHistory(), null once the snapshots stopped.
+  std::shared_ptr<CloudScheduler> stats_history_scheduler_;
+  long stats_history_job_ = -1;
+  // The host name and the DB session id, see CloudStatsSnapshot::instance.
+  std::string stats_history_instance_;
 };
 }  // namespace ROCKSDB_NAMESPACE
 #endif  // ROCKSDB_LITE
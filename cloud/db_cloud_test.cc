@@ -13,9 +13,13 @@
 #include <chrono>
 #include <cinttypes>
 #include <filesystem>
+#include <map>
+#include <mutex>
 
+#include "cache/compressed_secondary_cache.h"
 #include "cloud/cloud_manifest.h"
 #include "cloud/cloud_scheduler.h"
+#include "cloud/cloud_stats_history.h"
 #include "cloud/db_cloud_impl.h"
 #include "cloud/filename.h"
 #include "cloud/manifest_reader.h"
@@ -28,6 +32,7 @@
 #include "rocksdb/cloud/cloud_file_system_impl.h"
 #include "rocksdb/cloud/cloud_storage_provider_impl.h"
 #include "rocksdb/options.h"
+#include "rocksdb/statistics.h"
 #include "rocksdb/status.h"
 #include "rocksdb/table.h"
 #include "test_util/sync_point.h"
@@ -594,6 +599,42 @@ TEST_F(CloudTest, GetChildrenTest) {
   EXPECT_EQ(sst_files, 1);
 }
 
+TEST_F(CloudTest, VisitCloudObjectsInPartitionsTest) {
+  OpenDB();
+  for (int i = 0; i < 5; i++) {
+    ASSERT_OK(db_->Put(WriteOptions(), "Hello" + std::to_string(i), "World"));
+    ASSERT_OK(db_->Flush(FlushOptions()));
+  }
+  GetDBImpl()->TEST_WaitForBackgroundWork();
+
+  auto cfs = GetCloudFileSystem();
+  auto provider = cfs->GetStorageProvider();
+  std::vector<std::string> expected;
+  ASSERT_OK(provider->ListCloudObjects(cfs->GetDestBucketName(),
+                                       cfs->GetDestObjectPath(), &expected));
+  std::sort(expected.begin(), expected.end());
+  ASSERT_GT(expected.size(), 5);
+
+  // Partitions that are empty, split the SST files, and hold everything else
+  std::vector<std::string> objects;
+  ASSERT_OK(provider->VisitCloudObjects(
+      cfs->GetDestBucketName(), cfs->GetDestObjectPath(),
+      {"0000", "000010.sst", "IDENTITY", "z"}, [&](const std::string& name) {
+        objects.push_back(name);
+        return true;
+      }));
+  std::sort(objects.begin(), objects.end());
+  EXPECT_EQ(objects, expected);
+
+  // The listing stops when the visitor says so
+  size_t visited = 0;
+  ASSERT_OK(provider->VisitCloudObjects(
+      cfs->GetDestBucketName(), cfs->GetDestObjectPath(), {"000010.sst"},
+      [&](const std::string& /*name*/) { return ++visited < 2; }));
+  EXPECT_EQ(visited, 2);
+  CloseDB();
+}
+
 TEST_F(CloudTest, FindLiveFilesFromLocalManifestTest) {
   OpenDB();
   ASSERT_OK(db_->Put(WriteOptions(), "Hello", "Universe"));
@@ -940,6 +981,59 @@ TEST_F(CloudTest, KeepLocalFiles) {
   }
 }
 
+TEST_F(CloudTest, LazyOpenSstFilesAsyncIO) {
+  cloud_fs_options_.keep_local_sst_files = true;
+  cloud_fs_options_.lazy_open_sst_files = true;
+  cloud_fs_options_.prefetch_sst_threads = 1;
+  auto key = [](int i) {
+    char buf[16];
+    snprintf(buf, sizeof(buf), "key%06d", i);
+    return std::string(buf);
+  };
+  OpenDB();
+  const int kNumKeys = 1000;
+  for (int i = 0; i < kNumKeys; i++) {
+    ASSERT_OK(db_->Put(WriteOptions(), key(i), "value" + std::to_string(i)));
+    if (i % 250 == 249) {
+      ASSERT_OK(db_->Flush(FlushOptions()));
+    }
+  }
+  CloseDB();
+
+  // Reopen without the local copies, so that the tables are read from the
+  // cloud while they are downloaded.
+  DestroyDir(dbname_);
+  OpenDB();
+  ReadOptions ro;
+  ro.async_io = true;
+  ro.readahead_size = 16 << 10;
+  std::unique_ptr<Iterator> iter(db_->NewIterator(ro));
+  int count = 0;
+  for (iter->SeekToFirst(); iter->Valid(); iter->Next()) {
+    ASSERT_EQ(iter->key().ToString(), key(count));
+    ASSERT_EQ(iter->value().ToString(), "value" + std::to_string(count));
+    count++;
+  }
+  ASSERT_OK(iter->status());
+  ASSERT_EQ(count, kNumKeys);
+  iter.reset();
+
+  std::vector<std::string> key_strs;
+  for (int i = 0; i < kNumKeys; i += 7) {
+    key_strs.push_back(key(i));
+  }
+  std::vector<Slice> keys(key_strs.begin(), key_strs.end());
+  std::vector<PinnableSlice> values(keys.size());
+  std::vector<Status> statuses(keys.size());
+  db_->MultiGet(ro, db_->DefaultColumnFamily(), keys.size(), keys.data(),
+                values.data(), statuses.data());
+  for (size_t i = 0; i < keys.size(); i++) {
+    ASSERT_OK(statuses[i]);
+    ASSERT_EQ(values[i].ToString(), "value" + std::to_string(i * 7));
+  }
+  CloseDB();
+}
+
 TEST_F(CloudTest, CopyToFromS3) {
   std::string fname = dbname_ + "/100000.sst";
 
@@ -1194,6 +1288,47 @@ TEST_F(CloudTest, KeepLocalLogKafka) {
 
   CloseDB();
 }
+
+TEST_F(CloudTest, KeepLocalLogKafkaAsyncProduce) {
+  cloud_fs_options_.keep_local_log_files = false;
+  cloud_fs_options_.log_type = LogType::kLogKafka;
+  cloud_fs_options_.kafka_log_options
+      .client_config_params["metadata.broker.list"] = "localhost:9092";
+  cloud_fs_options_.kafka_log_options.async_produce = true;
+
+  OpenDB();
+
+  // A synced write waits for its delivery report
+  WriteOptions wo;
+  wo.sync = true;
+  ASSERT_OK(db_->Put(wo, "Franz", "Kafka"));
+
+  // Destroy DB in memory and on local file system.
+  delete db_;
+  db_ = nullptr;
+  aenv_.reset();
+  DestroyDir(dbname_);
+  DestroyDir("/tmp/ROCKSET");
+
+  // Create new env.
+  CreateCloudEnv();
+
+  // Give env enough time to consume WALs
+  std::this_thread::sleep_for(std::chrono::seconds(3));
+
+  // Open DB.
+  cloud_fs_options_.keep_local_log_files = true;
+  auto* cimpl = GetCloudFileSystemImpl();
+  options_.wal_dir = cimpl->GetWALCacheDir();
+  OpenDB();
+
+  // Test read.
+  std::string value;
+  ASSERT_OK(db_->Get(ReadOptions(), "Franz", &value));
+  ASSERT_EQ(value, "Kafka");
+
+  CloseDB();
+}
 #endif /* USE_KAFKA */
 
 // TODO(igor): determine why this fails,
@@ -1798,6 +1933,294 @@ TEST_F(CloudTest, CheckpointToCloud) {
       checkpoint_bucket.GetBucketName(), checkpoint_bucket.GetObjectPath());
 }
 
+namespace {
+// Keeps the replication log of a leader, the replication sequence of a
+// record being its index in the log
+class ReplicationLogRecorder : public ReplicationLogListener {
+ public:
+  std::string OnReplicationLogRecord(ReplicationLogRecord record) override {
+    record.Own();
+    std::lock_guard<std::mutex> lk(mutex_);
+    records_.push_back(std::move(record));
+    return std::to_string(records_.size() - 1);
+  }
+
+  // Applies the records after replication_sequence to the follower
+  void CatchUp(DB* follower, const std::string& replication_sequence) {
+    std::lock_guard<std::mutex> lk(mutex_);
+    size_t next =
+        replication_sequence.empty() ? 0 : std::stoul(replication_sequence) + 1;
+    DB::ApplyReplicationLogRecordInfo info;
+    for (; next < records_.size(); next++) {
+      ASSERT_OK(follower->ApplyReplicationLogRecord(
+          records_[next], std::to_string(next),
+          [follower](Slice) {
+            return ColumnFamilyOptions(follower->GetOptions());
+          },
+          0 /* snapshot_replication_epoch */, &info));
+    }
+  }
+
+  size_t NumRecords() {
+    std::lock_guard<std::mutex> lk(mutex_);
+    return records_.size();
+  }
+
+ private:
+  std::mutex mutex_;
+  std::vector<ReplicationLogRecord> records_;
+};
+}  // namespace
+
+// A follower opens from the cloud storage of the leader and only applies the
+// records after the persisted replication sequence.
+TEST_F(CloudTest, OpenFollowerFromCloud) {
+  auto recorder = std::make_shared<ReplicationLogRecorder>();
+  options_.replication_log_listener = recorder;
+  options_.atomic_flush = true;
+  WriteOptions wo;
+  wo.disableWAL = true;
+
+  OpenDB();
+  for (int i = 0; i < 100; i++) {
+    ASSERT_OK(db_->Put(wo, "key" + std::to_string(i), "flushed"));
+  }
+  ASSERT_OK(db_->Flush(FlushOptions()));
+  ASSERT_OK(db_->Put(wo, "key0", "in memtable"));
+  ASSERT_OK(db_->Savepoint());
+  const size_t num_log_records = recorder->NumRecords();
+
+  auto copt = cloud_fs_options_;
+  copt.src_bucket = cloud_fs_options_.dest_bucket;
+  copt.dest_bucket = BucketOptions();
+  copt.keep_local_sst_files = true;
+  CloudFileSystem* cfs;
+  ASSERT_OK(CloudFileSystemEnv::NewAwsFileSystem(
+      base_env_->GetFileSystem(), copt, options_.info_log, &cfs));
+  auto follower_env = CloudFileSystemEnv::NewCompositeEnv(
+      base_env_, std::shared_ptr<FileSystem>(cfs));
+  Options follower_options = options_;
+  follower_options.env = follower_env.get();
+  std::vector<ColumnFamilyHandle*> handles;
+  DBCloud* follower_db = nullptr;
+  std::string replication_sequence;
+  ASSERT_OK(DBCloud::OpenFollowerFromCloud(
+      follower_options, clone_dir_ + "/follower", persistent_cache_path_,
+      persistent_cache_size_gb_, &handles, &follower_db,
+      &replication_sequence));
+  std::unique_ptr<DBCloud> follower(follower_db);
+  ASSERT_EQ(1, handles.size());
+  // The flush persisted a replication sequence, so the records before it are
+  // not applied again
+  ASSERT_FALSE(replication_sequence.empty());
+  ASSERT_LT(std::stoul(replication_sequence), num_log_records - 1);
+
+  std::string value;
+  ASSERT_OK(follower->Get(ReadOptions(), "key1", &value));
+  ASSERT_EQ("flushed", value);
+  recorder->CatchUp(follower.get(), replication_sequence);
+  ASSERT_OK(follower->Get(ReadOptions(), "key0", &value));
+  ASSERT_EQ("in memtable", value);
+
+  // The follower keeps tailing the log, with the SST files that the leader
+  // writes after the bootstrap
+  ASSERT_OK(db_->Put(wo, "key1", "flushed later"));
+  ASSERT_OK(db_->Flush(FlushOptions()));
+  recorder->CatchUp(follower.get(), std::to_string(num_log_records - 1));
+  ASSERT_OK(follower->Get(ReadOptions(), "key1", &value));
+  ASSERT_EQ("flushed later", value);
+
+  for (auto* h : handles) {
+    delete h;
+  }
+  follower.reset();
+  CloseDB();
+}
+
+TEST_F(CloudTest, BackupToCloud) {
+  cloud_fs_options_.keep_local_log_files = true;
+  options_.level0_file_num_compaction_trigger = 100;  // never compact
+
+  auto backup_bucket = cloud_fs_options_.dest_bucket;
+  backup_bucket.SetObjectPath(backup_bucket.GetObjectPath() + "-backups");
+
+  OpenDB();
+  ASSERT_OK(db_->Put(WriteOptions(), "a", "b"));
+  ASSERT_OK(db_->Flush(FlushOptions()));
+  uint64_t first_id = 0;
+  ASSERT_OK(db_->BackupToCloud(backup_bucket, CloudBackupOptions(), &first_id));
+  ASSERT_OK(db_->Put(WriteOptions(), "c", "d"));
+  ASSERT_OK(db_->Flush(FlushOptions()));
+  // Only in the WAL.
+  ASSERT_OK(db_->Put(WriteOptions(), "e", "f"));
+  uint64_t second_id = 0;
+  ASSERT_OK(
+      db_->BackupToCloud(backup_bucket, CloudBackupOptions(), &second_id));
+  ASSERT_EQ(first_id + 1, second_id);
+  std::string original_dbid = dbid_;
+  CloseDB();
+
+  // The SST file of the first backup is shared by the second one.
+  auto provider = GetCloudFileSystem()->GetStorageProvider();
+  std::vector<std::string> shared;
+  ASSERT_OK(provider->ListCloudObjects(
+      backup_bucket.GetBucketName(), backup_bucket.GetObjectPath() + "/shared",
+      &shared));
+  ASSERT_EQ(2, shared.size());
+
+  DestroyDir(dbname_);
+  cloud_fs_options_.src_bucket = BucketOptions();
+  cloud_fs_options_.dest_bucket.SetObjectPath(
+      cloud_fs_options_.dest_bucket.GetObjectPath() + "-restored");
+  CreateCloudEnv();
+  ASSERT_OK(DBCloud::RestoreFromCloudBackup(aenv_.get(), backup_bucket,
+                                            second_id, dbname_));
+  aenv_.reset();
+
+  OpenDB();
+  ASSERT_NE(original_dbid, dbid_);
+  std::string value;
+  ASSERT_OK(db_->Get(ReadOptions(), "a", &value));
+  ASSERT_EQ(value, "b");
+  ASSERT_OK(db_->Get(ReadOptions(), "c", &value));
+  ASSERT_EQ(value, "d");
+  ASSERT_OK(db_->Get(ReadOptions(), "e", &value));
+  ASSERT_EQ(value, "f");
+  CloseDB();
+
+  GetCloudFileSystem()->GetStorageProvider()->EmptyBucket(
+      backup_bucket.GetBucketName(), backup_bucket.GetObjectPath());
+}
+
+TEST_F(CloudTest, ExportColumnFamilyToCloud) {
+  options_.level0_file_num_compaction_trigger = 100;  // never compact
+
+  auto export_bucket = cloud_fs_options_.dest_bucket;
+  export_bucket.SetObjectPath(export_bucket.GetObjectPath() + "-export");
+
+  std::vector<ColumnFamilyHandle*> handles;
+  OpenDB(&handles);
+  ColumnFamilyHandle* cf = nullptr;
+  ASSERT_OK(db_->CreateColumnFamily(options_, "moved", &cf));
+  ASSERT_OK(db_->Put(WriteOptions(), cf, "a", "b"));
+  ASSERT_OK(db_->Flush(FlushOptions(), cf));
+  // Only in the memtable, flushed by the export.
+  ASSERT_OK(db_->Put(WriteOptions(), cf, "c", "d"));
+  ExportImportFilesMetaData* metadata = nullptr;
+  ASSERT_OK(db_->ExportColumnFamilyToCloud(
+      cf, export_bucket, ExportColumnFamilyToCloudOptions(), &metadata));
+  ASSERT_NE(metadata, nullptr);
+  ASSERT_EQ(2, metadata->files.size());
+  for (const auto& f : metadata->files) {
+    ASSERT_EQ(0, f.db_path.rfind(CloudFileSystem::kCloudObjectUriPrefix(), 0));
+  }
+  ASSERT_OK(db_->DestroyColumnFamilyHandle(cf));
+  CloseDB(&handles);
+
+  auto provider = GetCloudFileSystem()->GetStorageProvider();
+  std::vector<std::string> exported;
+  ASSERT_OK(provider->ListCloudObjects(export_bucket.GetBucketName(),
+                                       export_bucket.GetObjectPath(),
+                                       &exported));
+  ASSERT_EQ(2, exported.size());
+
+  // Another DB takes the column family over.
+  DestroyDir(dbname_);
+  cloud_fs_options_.src_bucket = BucketOptions();
+  cloud_fs_options_.dest_bucket.SetObjectPath(
+      cloud_fs_options_.dest_bucket.GetObjectPath() + "-importer");
+  OpenDB(&handles);
+  ImportColumnFamilyOptions import_options;
+  import_options.move_files = true;
+  ASSERT_OK(db_->CreateColumnFamilyWithImport(options_, "moved", import_options,
+                                              *metadata, &cf));
+  delete metadata;
+  std::string value;
+  ASSERT_OK(db_->Get(ReadOptions(), cf, "a", &value));
+  ASSERT_EQ(value, "b");
+  ASSERT_OK(db_->Get(ReadOptions(), cf, "c", &value));
+  ASSERT_EQ(value, "d");
+  ASSERT_OK(db_->DestroyColumnFamilyHandle(cf));
+  CloseDB(&handles);
+
+  // The exported objects were adopted.
+  exported.clear();
+  auto st = provider->ListCloudObjects(export_bucket.GetBucketName(),
+                                       export_bucket.GetObjectPath(),
+                                       &exported);
+  ASSERT_TRUE(st.ok() || st.IsNotFound());
+  ASSERT_TRUE(exported.empty());
+}
+
+TEST_F(CloudTest, IncrementalCheckpointToCloud) {
+  cloud_fs_options_.keep_local_sst_files = true;
+  options_.level0_file_num_compaction_trigger = 100;  // never compact
+
+  // Pre-create the bucket.
+  CreateCloudEnv();
+  aenv_.reset();
+
+  // S3 is eventual consistency.
+  std::this_thread::sleep_for(std::chrono::seconds(1));
+
+  auto checkpoint_bucket = cloud_fs_options_.dest_bucket;
+
+  cloud_fs_options_.src_bucket = BucketOptions();
+  cloud_fs_options_.dest_bucket = BucketOptions();
+
+  CheckpointToCloudOptions checkpoint_options;
+  checkpoint_options.incremental = true;
+  auto checkpoint_sst_files = [&]() {
+    auto provider = GetCloudFileSystem()->GetStorageProvider();
+    std::vector<std::string> objects;
+    EXPECT_OK(provider->ListCloudObjects(checkpoint_bucket.GetBucketName(),
+                                         checkpoint_bucket.GetObjectPath(),
+                                         &objects));
+    std::map<std::string, uint64_t> files;
+    for (const auto& o : objects) {
+      if (IsSstFile(o)) {
+        EXPECT_OK(provider->GetCloudObjectModificationTime(
+            checkpoint_bucket.GetBucketName(),
+            checkpoint_bucket.GetObjectPath() + "/" + o, &files[o]));
+      }
+    }
+    return files;
+  };
+
+  OpenDB();
+  ASSERT_OK(db_->Put(WriteOptions(), "a", "b"));
+  ASSERT_OK(db_->Flush(FlushOptions()));
+  ASSERT_OK(db_->CheckpointToCloud(checkpoint_bucket, checkpoint_options));
+  auto first = checkpoint_sst_files();
+  ASSERT_EQ(1, first.size());
+
+  // Modification times have a one second granularity.
+  std::this_thread::sleep_for(std::chrono::seconds(2));
+  ASSERT_OK(db_->Put(WriteOptions(), "c", "d"));
+  ASSERT_OK(db_->Flush(FlushOptions()));
+  ASSERT_OK(db_->CheckpointToCloud(checkpoint_bucket, checkpoint_options));
+  auto second = checkpoint_sst_files();
+  ASSERT_EQ(2, second.size());
+  // The file of the first checkpoint was not uploaded again.
+  ASSERT_EQ(first.begin()->second, second[first.begin()->first]);
+  CloseDB();
+
+  DestroyDir(dbname_);
+
+  cloud_fs_options_.src_bucket = checkpoint_bucket;
+
+  OpenDB();
+  std::string value;
+  ASSERT_OK(db_->Get(ReadOptions(), "a", &value));
+  ASSERT_EQ(value, "b");
+  ASSERT_OK(db_->Get(ReadOptions(), "c", &value));
+  ASSERT_EQ(value, "d");
+  CloseDB();
+
+  GetCloudFileSystem()->GetStorageProvider()->EmptyBucket(
+      checkpoint_bucket.GetBucketName(), checkpoint_bucket.GetObjectPath());
+}
+
 // Basic test to copy object within S3.
 TEST_F(CloudTest, CopyObjectTest) {
   CreateCloudEnv();
@@ -1917,6 +2340,294 @@ TEST_F(CloudTest, SharedBlockCache) {
       cloud_fs_options_.src_bucket.GetObjectPath() + "-clone");
 }
 
+TEST_F(CloudTest, ZeroCopyClone) {
+  cloud_fs_options_.keep_local_sst_files = true;
+  OpenDB();
+  ASSERT_OK(db_->Put(WriteOptions(), "Hello", "World"));
+  ASSERT_OK(db_->Flush(FlushOptions()));
+  CloseDB();
+
+  cloud_fs_options_.zero_copy_clone = true;
+  std::unique_ptr<Env> clone_env;
+  std::unique_ptr<DBCloud> clone_db;
+  const std::string clone_path =
+      cloud_fs_options_.src_bucket.GetObjectPath() + "-clone";
+  ASSERT_OK(CloneDB("newdb1", cloud_fs_options_.src_bucket.GetBucketName(),
+                    clone_path, &clone_db, &clone_env));
+  auto count_local_sst_files = [&]() {
+    std::vector<std::string> files;
+    EXPECT_OK(base_env_->GetChildren(clone_dir_ + "/newdb1", &files));
+    return std::count_if(
+        files.begin(), files.end(),
+        [](const std::string& file) { return IsSstFile(RemoveEpoch(file)); });
+  };
+
+  // The file of the source is read in place.
+  std::string value;
+  ASSERT_OK(clone_db->Get(ReadOptions(), "Hello", &value));
+  ASSERT_EQ(value, "World");
+  ASSERT_EQ(count_local_sst_files(), 0);
+
+  // Only the new file is stored by the clone.
+  ASSERT_OK(clone_db->Put(WriteOptions(), "Hello2", "World2"));
+  ASSERT_OK(clone_db->Flush(FlushOptions()));
+  ASSERT_EQ(count_local_sst_files(), 1);
+  auto* clone_cloud_fs =
+      dynamic_cast<CloudFileSystem*>(clone_env->GetFileSystem().get());
+  std::vector<std::string> objects;
+  ASSERT_OK(clone_cloud_fs->GetStorageProvider()->ListCloudObjects(
+      cloud_fs_options_.src_bucket.GetBucketName(), clone_path, &objects));
+  ASSERT_EQ(std::count_if(
+                objects.begin(), objects.end(),
+                [](const std::string& o) { return IsSstFile(RemoveEpoch(o)); }),
+            1);
+
+  clone_db->Close();
+  clone_cloud_fs->GetStorageProvider()->EmptyBucket(
+      cloud_fs_options_.src_bucket.GetBucketName(), clone_path);
+}
+
+TEST_F(CloudTest, ParallelOpen) {
+  OpenDB();
+  ASSERT_OK(db_->Put(WriteOptions(), "Hello", "World"));
+  ASSERT_OK(db_->Flush(FlushOptions()));
+  CloseDB();
+
+  // The clone looks its objects up in both buckets at once.
+  cloud_fs_options_.parallel_open = true;
+  auto stats = CreateDBStatistics();
+  cloud_fs_options_.statistics = stats;
+  const std::string clone_path =
+      cloud_fs_options_.src_bucket.GetObjectPath() + "-clone";
+  const std::string clone_dir = clone_dir_ + "/newdb1";
+  for (int i = 0; i < 2; i++) {
+    std::unique_ptr<Env> clone_env;
+    std::unique_ptr<DBCloud> clone_db;
+    ASSERT_OK(CloneDB("newdb1", cloud_fs_options_.src_bucket.GetBucketName(),
+                      clone_path, &clone_db, &clone_env));
+    std::string value;
+    ASSERT_OK(clone_db->Get(ReadOptions(), "Hello", &value));
+    ASSERT_EQ(value, "World");
+    if (i == 0) {
+      ASSERT_OK(clone_db->Put(WriteOptions(), "Hello2", "World2"));
+      ASSERT_OK(clone_db->Flush(FlushOptions()));
+    } else {
+      // The second open finds the clone in the destination.
+      ASSERT_OK(clone_db->Get(ReadOptions(), "Hello2", &value));
+      ASSERT_EQ(value, "World2");
+    }
+    // No copy of the source is left staged.
+    std::vector<std::string> files;
+    ASSERT_OK(base_env_->GetChildren(clone_dir, &files));
+    for (const auto& f : files) {
+      ASSERT_EQ(f.find(".src"), std::string::npos) << f;
+    }
+    clone_db->Close();
+    if (i == 1) {
+      auto* clone_cloud_fs =
+          dynamic_cast<CloudFileSystem*>(clone_env->GetFileSystem().get());
+      clone_cloud_fs->GetStorageProvider()->EmptyBucket(
+          cloud_fs_options_.src_bucket.GetBucketName(), clone_path);
+    }
+  }
+
+  HistogramData data;
+  stats->histogramData(CLOUD_OPEN_MICROS, &data);
+  ASSERT_EQ(data.count, 2);
+  stats->histogramData(CLOUD_OPEN_SANITIZE_MICROS, &data);
+  ASSERT_EQ(data.count, 2);
+  stats->histogramData(CLOUD_OPEN_LOAD_CLOUD_MANIFEST_MICROS, &data);
+  ASSERT_EQ(data.count, 2);
+  stats->histogramData(CLOUD_OPEN_DB_MICROS, &data);
+  ASSERT_EQ(data.count, 2);
+}
+
+namespace {
+// Runs the compactions of a DB with DBCloud::OpenAndCompact(), in process,
+// as a remote worker would.
+class TestCloudCompactionService : public CompactionService {
+ public:
+  TestCloudCompactionService(Env* worker_env, const std::string& worker_dir,
+                             const std::string& output_object_path)
+      : worker_env_(worker_env),
+        worker_dir_(worker_dir),
+        output_object_path_(output_object_path) {}
+
+  const char* Name() const override { return "TestCloudCompactionService"; }
+
+  CompactionServiceScheduleResponse Schedule(
+      const CompactionServiceJobInfo& info,
+      const std::string& compaction_service_input) override {
+    std::lock_guard<std::mutex> lk(mutex_);
+    auto id = std::to_string(info.job_id);
+    inputs_[id] = compaction_service_input;
+    return CompactionServiceScheduleResponse(
+        id, CompactionServiceJobStatus::kSuccess);
+  }
+
+  CompactionServiceJobStatus Wait(const std::string& scheduled_job_id,
+                                  std::string* result) override {
+    std::string input;
+    {
+      std::lock_guard<std::mutex> lk(mutex_);
+      input = std::move(inputs_[scheduled_job_id]);
+      inputs_.erase(scheduled_job_id);
+    }
+    CompactionServiceOptionsOverride override_options;
+    override_options.env = worker_env_;
+    override_options.table_factory.reset(NewBlockBasedTableFactory());
+    auto s = DBCloud::OpenAndCompact(
+        OpenAndCompactOptions(), worker_dir_ + "/" + scheduled_job_id,
+        output_object_path_ + "/" + scheduled_job_id, input, result,
+        override_options);
+    if (!s.ok()) {
+      return CompactionServiceJobStatus::kFailure;
+    }
+    compactions_++;
+    return CompactionServiceJobStatus::kSuccess;
+  }
+
+  int GetCompactions() const { return compactions_.load(); }
+
+ private:
+  Env* worker_env_;
+  const std::string worker_dir_;
+  const std::string output_object_path_;
+  std::mutex mutex_;
+  std::map<std::string, std::string> inputs_;
+  std::atomic<int> compactions_{0};
+};
+}  // namespace
+
+TEST_F(CloudTest, RemoteCompaction) {
+  // The worker reads the DB from the cloud, and has no dest bucket.
+  auto worker_fs_options = cloud_fs_options_;
+  worker_fs_options.dest_bucket.SetObjectPath("");
+  worker_fs_options.resync_on_open = true;
+  CloudFileSystem* worker_cfs;
+  ASSERT_OK(CloudFileSystemEnv::NewAwsFileSystem(
+      base_env_->GetFileSystem(), worker_fs_options, options_.info_log,
+      &worker_cfs));
+  auto worker_env = CloudFileSystemEnv::NewCompositeEnv(
+      base_env_, std::shared_ptr<FileSystem>(worker_cfs));
+
+  const std::string output_object_path = dbname_ + "-compaction";
+  ASSERT_OK(base_env_->CreateDirIfMissing(clone_dir_ + "/worker"));
+  auto service = std::make_shared<TestCloudCompactionService>(
+      worker_env.get(), clone_dir_ + "/worker", output_object_path);
+  options_.compaction_service = service;
+  options_.disable_auto_compactions = true;
+  OpenDB();
+  // Overlapping files, which are not trivially moved.
+  for (int i = 0; i < 2; i++) {
+    for (int k = 0; k < 10; k++) {
+      ASSERT_OK(db_->Put(WriteOptions(), "key" + std::to_string(k),
+                         "value" + std::to_string(i)));
+    }
+    ASSERT_OK(db_->Flush(FlushOptions()));
+  }
+  ASSERT_OK(db_->CompactRange(CompactRangeOptions(), nullptr, nullptr));
+  ASSERT_EQ(service->GetCompactions(), 1);
+
+  auto check_db = [&]() {
+    for (int k = 0; k < 10; k++) {
+      std::string value;
+      ASSERT_OK(db_->Get(ReadOptions(), "key" + std::to_string(k), &value));
+      ASSERT_EQ(value, "value1");
+    }
+  };
+  check_db();
+  std::vector<LiveFileMetaData> files;
+  db_->GetLiveFilesMetaData(&files);
+  ASSERT_EQ(files.size(), 1);
+  ASSERT_EQ(files[0].level, 1);
+
+  // The outputs were moved into the DB.
+  std::vector<std::string> objects;
+  ASSERT_OK(GetCloudFileSystem()->GetStorageProvider()->ListCloudObjects(
+      cloud_fs_options_.src_bucket.GetBucketName(), output_object_path,
+      &objects));
+  ASSERT_EQ(std::count_if(objects.begin(), objects.end(),
+                          [](const std::string& o) { return IsSstFile(o); }),
+            0);
+
+  CloseDB();
+  OpenDB();
+  check_db();
+}
+
+// Dump the block cache to the bucket and load it into the secondary cache of
+// a reopened DB.
+TEST_F(CloudTest, DumpBlockCacheToCloud) {
+  CompressedSecondaryCacheOptions secondary_opts;
+  secondary_opts.capacity = 10 * 1024 * 1024;
+  auto secondary_cache = NewCompressedSecondaryCache(secondary_opts);
+  LRUCacheOptions lru_opts;
+  lru_opts.capacity = 10 * 1024 * 1024;
+  lru_opts.secondary_cache = secondary_cache;
+  BlockBasedTableOptions bbto;
+  bbto.block_cache = NewLRUCache(lru_opts);
+  options_.table_factory.reset(NewBlockBasedTableFactory(bbto));
+  cloud_fs_options_.dump_block_cache = true;
+  cloud_fs_options_.block_cache_load_target = secondary_cache;
+
+  OpenDB();
+  ASSERT_OK(db_->Put({}, "a", "1"));
+  ASSERT_OK(db_->Flush({}));
+  std::string value;
+  ASSERT_OK(db_->Get({}, "a", &value));
+  ASSERT_EQ(value, "1");
+  ASSERT_OK(db_->DumpBlockCacheToCloud());
+  CloseDB();
+
+  // Closing the DB dumped the block cache once more.
+  ASSERT_OK(GetCloudFileSystem()->GetStorageProvider()->ExistsCloudObject(
+      cloud_fs_options_.dest_bucket.GetBucketName(),
+      cloud_fs_options_.dest_bucket.GetObjectPath() + "/BLOCKCACHE"));
+
+  auto compressed_cache =
+      static_cast<CompressedSecondaryCache*>(secondary_cache.get());
+  size_t usage_before = compressed_cache->TEST_GetUsage();
+  OpenDB();
+  ASSERT_GT(compressed_cache->TEST_GetUsage(), usage_before);
+  ASSERT_OK(db_->Get({}, "a", &value));
+  ASSERT_EQ(value, "1");
+  CloseDB();
+}
+
+// Closing the DB uploads a last snapshot of its stats to the bucket.
+TEST_F(CloudTest, StatsHistory) {
+  options_.statistics = CreateDBStatistics();
+  cloud_fs_options_.statistics = CreateDBStatistics();
+  cloud_fs_options_.stats_history_period_secs = 3600;
+
+  OpenDB();
+  ASSERT_OK(db_->Put({}, "a", "1"));
+  ASSERT_OK(db_->Flush({}));
+  CloseDB();
+
+  auto cfs = GetCloudFileSystem();
+  auto provider = cfs->GetStorageProvider();
+  const std::string dir =
+      cfs->GetDestObjectPath() + "/" + kCloudStatsHistoryDir;
+  std::vector<std::string> objects;
+  ASSERT_OK(
+      provider->ListCloudObjects(cfs->GetDestBucketName(), dir, &objects));
+  ASSERT_EQ(objects.size(), 1);
+
+  const std::string local_file = dbname_ + "/stats_snapshot";
+  ASSERT_OK(provider->GetCloudObject(cfs->GetDestBucketName(),
+                                     dir + "/" + objects[0], local_file));
+  std::string data;
+  ASSERT_OK(ReadFileToString(base_env_, local_file, &data));
+  CloudStatsSnapshot snapshot;
+  ASSERT_OK(DecodeCloudStatsSnapshot(data, &snapshot));
+  ASSERT_EQ(CloudStatsSnapshotObjectName(snapshot),
+            std::string(kCloudStatsHistoryDir) + "/" + objects[0]);
+  ASSERT_EQ(snapshot.stats["rocksdb.number.keys.written"], 1);
+  ASSERT_GT(snapshot.stats["rocksdb.cloud.write.requests"], 0);
+}
+
 TEST_F(CloudTest, FindLiveFilesFetchManifestTest) {
   OpenDB();
   ASSERT_OK(db_->Put({}, "a", "1"));
@@ -3075,6 +3786,56 @@ TEST_F(CloudTest, UnscheduleFileDeletionTest) {
   }
 }
 
+TEST_F(CloudTest, CoalesceObjectDeletionsTest) {
+  auto scheduler = CloudScheduler::Get();
+  std::mutex mu;
+  std::vector<std::vector<std::string>> batches;
+  auto deletion_scheduler = CloudFileDeletionScheduler::Create(
+      scheduler, std::chrono::seconds(0),
+      [&](const std::vector<std::string>& paths) {
+        std::lock_guard<std::mutex> lk(mu);
+        batches.push_back(paths);
+      });
+
+  // Hold the only slot of the deletions until all of them are due
+  auto old_limit = CloudScheduler::SetConcurrencyLimit(
+      CloudScheduler::JobClass::kFileDeletion, 1);
+  std::atomic<bool> release{false};
+  std::atomic<bool> holding{false};
+  scheduler->ScheduleJob(
+      std::chrono::microseconds(0),
+      [&](void*) {
+        holding = true;
+        while (!release) {
+          usleep(100);
+        }
+      },
+      nullptr, CloudScheduler::JobClass::kFileDeletion);
+  while (!holding) {
+    usleep(100);
+  }
+  int num_file_deletions = 10;
+  std::vector<std::string> objects;
+  for (int i = 0; i < num_file_deletions; i++) {
+    std::string filename = std::to_string(i) + ".sst";
+    objects.push_back("path/" + filename);
+    ASSERT_OK(
+        deletion_scheduler->ScheduleObjectDeletion(filename, objects.back()));
+  }
+  release = true;
+
+  while (scheduler->TEST_NumScheduledJobs() > 0) {
+    usleep(100);
+  }
+  CloudScheduler::SetConcurrencyLimit(CloudScheduler::JobClass::kFileDeletion,
+                                      old_limit);
+  std::lock_guard<std::mutex> lk(mu);
+  ASSERT_EQ(batches.size(), 1);
+  std::sort(batches[0].begin(), batches[0].end());
+  EXPECT_EQ(batches[0], objects);
+  EXPECT_EQ(deletion_scheduler->TEST_FilesToDelete().size(), 0);
+}
+
 TEST_F(CloudTest, UnscheduleUnknownFileTest) {
   auto scheduler = CloudScheduler::Get();
   auto deletion_scheduler =
@@ -154,11 +154,15 @@ int main() {
   // Create a clone of the db and and verify that all's well.
   // In real applications, a Clone would typically be created
   // by a separate process.
+  // The clone reads the sst files of the db in place, from the db's path,
+  // and only stores the files it writes itself in its own path.
   std::unique_ptr<DB> clone_db;
   std::unique_ptr<Env> clone_env;
+  CloudFileSystemOptions clone_fs_options = cloud_fs_options;
+  clone_fs_options.zero_copy_clone = true;
 
   s = CloneDB("clone1", kBucketSuffix, kDBPath, kBucketSuffix, kClonePath,
-              cloud_fs_options, &clone_db, &clone_env);
+              clone_fs_options, &clone_db, &clone_env);
   if (!s.ok()) {
     fprintf(stderr, "Unable to clone db at path %s in bucket %s. %s\n",
             kDBPath.c_str(), bucketName.c_str(), s.ToString().c_str());
@@ -5,9 +5,14 @@
 #include <rocksdb/slice.h>
 
 #include <algorithm>
+#include <cinttypes>
+#include <cstdio>
+#include <cstdlib>
 #include <functional>
 #include <string>
 
+#include "util/hash.h"
+
 //
 // These are inlined methods to deal with pathnames and filenames.
 
@@ -110,6 +115,20 @@ inline std::string RemoveEpoch(const std::string& path) {
   return path;
 }
 
+// The epoch suffix of a file name remapped by the cloud manifest, empty if
+// there is none.
+inline std::string GetEpochOfFile(const std::string& path) {
+  auto lastDash = path.rfind('-');
+  if (lastDash == std::string::npos) {
+    return "";
+  }
+  auto lastPathPos = path.rfind('/');
+  if (lastPathPos == std::string::npos || lastDash > lastPathPos) {
+    return path.substr(lastDash + 1);
+  }
+  return "";
+}
+
 // Get the cookie suffix from cloud manifest file path
 inline std::string GetCookie(const std::string& cloud_manifest_file_path) {
   auto cloud_manifest_fname = basename(cloud_manifest_file_path);
@@ -130,6 +149,25 @@ const std::string sst = ".sst";
 const std::string ldb = ".ldb";
 const std::string log = ".log";
 
+// Splits a path of the form cloud://<bucket>/<object path>, see
+// CloudFileSystem::kCloudObjectUriPrefix(), into the bucket and the object
+// path. Returns false for other paths.
+inline bool ParseCloudObjectUri(const std::string& path, std::string* bucket,
+                                std::string* object_path) {
+  static const std::string prefix = "cloud://";
+  if (path.compare(0, prefix.size(), prefix) != 0) {
+    return false;
+  }
+  auto pos = path.find('/', prefix.size());
+  if (pos == std::string::npos || pos == prefix.size() ||
+      pos + 1 == path.size()) {
+    return false;
+  }
+  *bucket = path.substr(prefix.size(), pos - prefix.size());
+  *object_path = path.substr(pos + 1);
+  return true;
+}
+
 // Is this a sst file, i.e. ends in ".sst" or ".ldb"
 inline bool IsSstFile(const std::string& pathname) {
   if (pathname.size() < sst.size()) {
@@ -170,6 +208,55 @@ inline bool IsManifestFile(const std::string& pathname) {
   return false;
 }
 
+// The data appended to a MANIFEST object after its last full upload is kept
+// in delta objects next to it. A delta is named after the MANIFEST, the
+// offset of its first byte and the crc32c of all the MANIFEST bytes before
+// it, so that a delta left by a previous incarnation of the MANIFEST is never
+// appended to the current one.
+const std::string manifest_delta = ".delta.";
+
+inline std::string MakeManifestDeltaFile(const std::string& manifest,
+                                         uint64_t offset, uint32_t prefix_crc) {
+  char buf[64];
+  snprintf(buf, sizeof(buf), "%016" PRIx64 ".%08" PRIx32, offset, prefix_crc);
+  return manifest + manifest_delta + buf;
+}
+
+// Splits the name of a MANIFEST delta into its parts. Returns false if
+// pathname is not a MANIFEST delta.
+inline bool ParseManifestDeltaFile(const std::string& pathname,
+                                   std::string* manifest, uint64_t* offset,
+                                   uint32_t* prefix_crc) {
+  auto pos = pathname.rfind(manifest_delta);
+  if (pos == std::string::npos || !IsManifestFile(pathname.substr(0, pos))) {
+    return false;
+  }
+  auto suffix = pathname.substr(pos + manifest_delta.size());
+  if (suffix.size() != 25 || suffix[16] != '.') {
+    return false;
+  }
+  char* end = nullptr;
+  auto off = std::strtoull(suffix.c_str(), &end, 16);
+  if (end != suffix.c_str() + 16) {
+    return false;
+  }
+  auto crc = std::strtoul(suffix.c_str() + 17, &end, 16);
+  if (end != suffix.c_str() + suffix.size()) {
+    return false;
+  }
+  *manifest = pathname.substr(0, pos);
+  *offset = off;
+  *prefix_crc = static_cast<uint32_t>(crc);
+  return true;
+}
+
+inline bool IsManifestDeltaFile(const std::string& pathname) {
+  std::string manifest;
+  uint64_t offset;
+  uint32_t prefix_crc;
+  return ParseManifestDeltaFile(pathname, &manifest, &offset, &prefix_crc);
+}
+
 inline bool IsIdentityFile(const std::string& pathname) {
   // extract last component of the path
   std::string fname;
@@ -198,6 +285,49 @@ inline bool IsCloudManifestFile(const std::string& pathname) {
   return false;
 }
 
+// Name of the sub-prefix of a shard: fixed-width hex, so that the shards
+// sort in numeric order.
+inline std::string SstObjectShardName(uint32_t shard, uint32_t num_shards) {
+  int width = 1;
+  for (uint32_t n = (num_shards - 1) >> 4; n > 0; n >>= 4) {
+    width++;
+  }
+  char buf[16];
+  snprintf(buf, sizeof(buf), "%0*" PRIx32, width, shard);
+  return buf;
+}
+
+// SST objects may be spread over hashed sub-prefixes of the object path of
+// their DB, see CloudFileSystemOptions::sst_object_shards. The sub-prefix
+// of an object only depends on its name and on the number of shards, which
+// the CLOUDMANIFEST records. Other objects are never sharded.
+inline std::string AddSstObjectShard(const std::string& fname,
+                                     uint32_t num_shards) {
+  if (num_shards == 0 || !IsSstFile(fname)) {
+    return fname;
+  }
+  auto shard = static_cast<uint32_t>(
+      ROCKSDB_NAMESPACE::Hash64(fname.data(), fname.size()) % num_shards);
+  return SstObjectShardName(shard, num_shards) + pathsep + fname;
+}
+
+// Turns the name of an object listed under the object path of a DB back
+// into the name of its file.
+inline std::string RemoveSstObjectShard(const std::string& object_name) {
+  auto pos = object_name.find('/');
+  if (pos == std::string::npos || pos == 0 || pos > 8 ||
+      !IsSstFile(object_name) ||
+      object_name.find('/', pos + 1) != std::string::npos) {
+    return object_name;
+  }
+  for (size_t i = 0; i < pos; i++) {
+    if (!isxdigit(static_cast<unsigned char>(object_name[i]))) {
+      return object_name;
+    }
+  }
+  return object_name.substr(pos + 1);
+}
+
 enum class RocksDBFileType {
   kSstFile,
   kLogFile,
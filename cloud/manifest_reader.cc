@@ -75,9 +75,25 @@ IOStatus LocalManifestReader::GetManifestLiveFiles(
   return GetLiveFilesFromFileReader(std::move(manifest_file_reader), list);
 }
 
+IOStatus LocalManifestReader::GetManifestLiveFiles(
+    const std::string& manifest_file,
+    std::vector<LiveSstFileInfo>* files) const {
+  std::unique_ptr<FSSequentialFile> file;
+  auto s = cfs_->NewSequentialFile(manifest_file, FileOptions(), &file,
+                                   nullptr /*dbg*/);
+  if (!s.ok()) {
+    return s;
+  }
+  std::set<uint64_t> list;
+  return GetLiveFilesFromFileReader(
+      std::unique_ptr<SequentialFileReader>(
+          new SequentialFileReader(std::move(file), manifest_file)),
+      &list, files);
+}
+
 IOStatus LocalManifestReader::GetLiveFilesFromFileReader(
     std::unique_ptr<SequentialFileReader> file_reader,
-    std::set<uint64_t>* list) const {
+    std::set<uint64_t>* list, std::vector<LiveSstFileInfo>* files) const {
   Status s;
   // create a callback that gets invoked whil looping through the log records
   VersionSet::LogReporter reporter;
@@ -89,9 +105,11 @@ IOStatus LocalManifestReader::GetLiveFilesFromFileReader(
   std::string scratch;
 
   // keep track of each CF's live files on each level
-  std::unordered_map<uint32_t,                // CF id
-                     std::unordered_map<int,  // level
-                                        std::unordered_set<uint64_t>>>
+  std::unordered_map<
+      uint32_t,                // CF id
+      std::unordered_map<int,  // level
+                         std::unordered_map<uint64_t,  // file number
+                                            LiveSstFileInfo>>>
       cf_live_files;
 
   while (reader.ReadRecord(&record, &scratch) && s.ok()) {
@@ -105,7 +123,9 @@ IOStatus LocalManifestReader::GetLiveFilesFromFileReader(
     std::vector<std::pair<int, FileMetaData>> new_files = edit.GetNewFiles();
     for (auto& one : new_files) {
       uint64_t num = one.second.fd.GetNumber();
-      cf_live_files[edit.GetColumnFamily()][one.first].insert(num);
+      cf_live_files[edit.GetColumnFamily()][one.first][num] = {
+          num, one.first, one.second.fd.GetFileSize(),
+          one.second.file_checksum, one.second.file_checksum_func_name};
     }
     // delete the files that are removed by this transaction
     std::set<std::pair<int, uint64_t>> deleted_files = edit.GetDeletedFiles();
@@ -134,7 +154,12 @@ IOStatus LocalManifestReader::GetLiveFilesFromFileReader(
     for (auto& [level, level_live_files] : live_files) {
       (void)cf_id;
       (void)level;
-      list->insert(level_live_files.begin(), level_live_files.end());
+      for (auto& [num, info] : level_live_files) {
+        list->insert(num);
+        if (files != nullptr) {
+          files->push_back(std::move(info));
+        }
+      }
     }
   }
 
@@ -152,8 +177,9 @@ ManifestReader::ManifestReader(std::shared_ptr<Logger> info_log,
 // Extract all the live files needed by this MANIFEST file and corresponding
 // cloud_manifest object
 //
-IOStatus ManifestReader::GetLiveFiles(const std::string& bucket_path,
-                                      std::set<uint64_t>* list) const {
+IOStatus ManifestReader::GetLiveFiles(
+    const std::string& bucket_path, std::set<uint64_t>* list,
+    std::vector<LiveSstFileInfo>* files) const {
   IOStatus s;
   std::unique_ptr<CloudManifest> cloud_manifest;
   const FileOptions file_opts;
@@ -190,7 +216,7 @@ IOStatus ManifestReader::GetLiveFiles(const std::string& bucket_path,
     file_reader.reset(new SequentialFileReader(std::move(file), manifestFile));
   }
 
-  return GetLiveFilesFromFileReader(std::move(file_reader), list);
+  return GetLiveFilesFromFileReader(std::move(file_reader), list, files);
 }
 
 IOStatus ManifestReader::GetMaxFileNumberFromManifest(FileSystem* fs,
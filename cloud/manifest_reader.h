@@ -3,8 +3,10 @@
 #pragma once
 
 #ifndef ROCKSDB_LITE
+#include <memory>
 #include <set>
 #include <string>
+#include <vector>
 
 #include "rocksdb/io_status.h"
 
@@ -15,6 +17,16 @@ class FileSystem;
 class Logger;
 class SequentialFileReader;
 
+// A live SST file of a MANIFEST and where it sits in the LSM tree.
+struct LiveSstFileInfo {
+  uint64_t number;
+  int level;
+  uint64_t file_size;
+  // As recorded by the DB; empty if file checksums are disabled.
+  std::string file_checksum;
+  std::string file_checksum_func_name;
+};
+
 // Operates on MANIFEST files stored locally
 class LocalManifestReader {
  public:
@@ -38,12 +50,17 @@ class LocalManifestReader {
   IOStatus GetManifestLiveFiles(const std::string& manifest_file,
                                 std::set<uint64_t>* list) const;
 
+  // Same as above, but also returns the level and size of each live file.
+  IOStatus GetManifestLiveFiles(const std::string& manifest_file,
+                                std::vector<LiveSstFileInfo>* files) const;
+
  protected:
   // Get all the live SST file numbers by reading version_edit records from
   // file_reader
   IOStatus GetLiveFilesFromFileReader(
       std::unique_ptr<SequentialFileReader> file_reader,
-      std::set<uint64_t>* list) const;
+      std::set<uint64_t>* list,
+      std::vector<LiveSstFileInfo>* files = nullptr) const;
 
   std::shared_ptr<Logger> info_log_;
   CloudFileSystem* cfs_;
@@ -61,8 +78,11 @@ class ManifestReader : public LocalManifestReader {
   // It will read from CLOUDMANIFEST and MANIFEST file in s3 directly
   // TODO(wei): remove this function. Reading from s3 directly is very slow for
   // large MANIFEST file
+  // If files is not null, it also gets the level, size and checksum of each
+  // live file.
   IOStatus GetLiveFiles(const std::string& bucket_path,
-                        std::set<uint64_t>* list) const;
+                        std::set<uint64_t>* list,
+                        std::vector<LiveSstFileInfo>* files = nullptr) const;
 
   static IOStatus GetMaxFileNumberFromManifest(FileSystem* fs,
                                                const std::string& fname,
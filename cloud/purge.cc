@@ -6,6 +6,7 @@
 #include <chrono>
 #include <set>
 
+#include "rocksdb/cloud/cloud_file_deletion_scheduler.h"
 #include "rocksdb/cloud/cloud_file_system_impl.h"
 #include "cloud/db_cloud_impl.h"
 #include "cloud/filename.h"
@@ -28,9 +29,16 @@ void CloudFileSystemImpl::Purger() {
   // Run purge once every period.
   auto period = std::chrono::milliseconds(
       GetCloudFileSystemOptions().purger_periodicity_millis);
+  const auto full_listing_period = std::chrono::milliseconds(
+      GetCloudFileSystemOptions().purger_full_listing_periodicity_millis);
 
   std::vector<std::string> to_be_deleted_paths;
   std::vector<std::string> to_be_deleted_dbids;
+  // As of the last full listing, if it succeeded
+  bool has_full_listing = false;
+  std::chrono::steady_clock::time_point last_full_listing;
+  std::set<std::string> dbids;
+  std::set<std::string> live_files;
 
   while (true) {
     std::unique_lock<std::mutex> lk(purger_lock_);
@@ -63,14 +71,121 @@ void CloudFileSystemImpl::Purger() {
 
     to_be_deleted_paths.clear();
     to_be_deleted_dbids.clear();
-    FindObsoleteFiles(GetDestBucketName(), &to_be_deleted_paths);
-    FindObsoleteDbid(GetDestBucketName(), &to_be_deleted_dbids);
+    auto now = std::chrono::steady_clock::now();
+    bool full_listing = full_listing_period.count() == 0 || !has_full_listing ||
+                        now - last_full_listing >= full_listing_period;
+    if (!full_listing) {
+      st = FindObsoleteCandidates(GetDestBucketName(), dbids, live_files,
+                                  &to_be_deleted_paths, &full_listing);
+      if (!st.ok()) {
+        Log(InfoLogLevel::ERROR_LEVEL, info_log_,
+            "[pg] FindObsoleteCandidates on bucket prefix %s. %s",
+            GetDestBucketName().c_str(), st.ToString().c_str());
+      }
+    }
+    if (full_listing) {
+      // The listing finds the candidates deleted until now
+      if (full_listing_period.count() > 0) {
+        std::lock_guard<std::mutex> candidates_lk(purge_candidates_mutex_);
+        purge_candidates_.clear();
+      }
+      dbids.clear();
+      live_files.clear();
+      st = FindObsoleteFiles(GetDestBucketName(), &to_be_deleted_paths, &dbids,
+                             &live_files);
+      has_full_listing = st.ok();
+      last_full_listing = now;
+      FindObsoleteDbid(GetDestBucketName(), &to_be_deleted_dbids);
+    }
   }
 }
 
+void CloudFileSystemImpl::AddPurgeCandidate(const std::string& fname) {
+  const auto& opts = GetCloudFileSystemOptions();
+  if (!opts.run_purger || opts.purger_full_listing_periodicity_millis == 0 ||
+      GetFileType(fname) != RocksDBFileType::kSstFile) {
+    return;
+  }
+  std::lock_guard<std::mutex> lk(purge_candidates_mutex_);
+  purge_candidates_.insert(fname);
+}
+
+void CloudFileSystemImpl::ForgetPurgeCandidate(const std::string& fname) {
+  std::lock_guard<std::mutex> lk(purge_candidates_mutex_);
+  purge_candidates_.erase(fname);
+}
+
+IOStatus CloudFileSystemImpl::FindObsoleteCandidates(
+    const std::string& bucket_name_prefix, const std::set<std::string>& dbids,
+    const std::set<std::string>& live_files,
+    std::vector<std::string>* pathnames, bool* needs_full_listing) {
+  *needs_full_listing = false;
+  // A new DB, such as a clone, may still use files that this DB deleted.
+  // Listing the registry is one request, while GetDbidList() would also
+  // fetch the path of every dbid.
+  std::vector<std::string> registered;
+  auto st = GetStorageProvider()->ListCloudObjects(
+      bucket_name_prefix, kDbIdRegistry(), &registered);
+  if (!st.ok()) {
+    return st;
+  }
+  for (const auto& dbid : registered) {
+    if (dbids.find(dbid) == dbids.end()) {
+      Log(InfoLogLevel::INFO_LEVEL, info_log_,
+          "[pg] dbid %s registered in bucket prefix %s since the last "
+          "full listing",
+          dbid.c_str(), bucket_name_prefix.c_str());
+      *needs_full_listing = true;
+      return IOStatus::OK();
+    }
+  }
+
+  // The candidates whose deletion is still pending are checked next time
+  std::vector<std::string> candidates;
+  {
+    std::lock_guard<std::mutex> lk(purge_candidates_mutex_);
+    for (auto it = purge_candidates_.begin(); it != purge_candidates_.end();) {
+      if (cloud_file_deletion_scheduler_ &&
+          cloud_file_deletion_scheduler_->IsFileDeletionScheduled(*it)) {
+        ++it;
+      } else {
+        candidates.push_back(*it);
+        it = purge_candidates_.erase(it);
+      }
+    }
+  }
+
+  for (const auto& fname : candidates) {
+    auto path = destname(fname);
+    st = GetStorageProvider()->ExistsCloudObject(bucket_name_prefix, path);
+    if (st.IsNotFound()) {
+      // Deleted as expected
+      st = IOStatus::OK();
+      continue;
+    }
+    if (!st.ok()) {
+      Log(InfoLogLevel::ERROR_LEVEL, info_log_,
+          "[pg] Unable to check object %s in bucket prefix %s. %s",
+          path.c_str(), bucket_name_prefix.c_str(), st.ToString().c_str());
+      AddPurgeCandidate(fname);
+      continue;
+    }
+    // Objects still shared with another DB are left to the next full
+    // listing
+    if (live_files.find(GetDestObjectPath() + pathsep + RemoveEpoch(fname)) ==
+        live_files.end()) {
+      Log(InfoLogLevel::DEBUG_LEVEL, info_log_,
+          "[pg] bucket prefix %s path %s marked for deletion",
+          bucket_name_prefix.c_str(), path.c_str());
+      pathnames->push_back(std::move(path));
+    }
+  }
+  return IOStatus::OK();
+}
+
 IOStatus CloudFileSystemImpl::FindObsoleteFiles(
-    const std::string& bucket_name_prefix,
-    std::vector<std::string>* pathnames) {
+    const std::string& bucket_name_prefix, std::vector<std::string>* pathnames,
+    std::set<std::string>* dbids, std::set<std::string>* live_files_out) {
   std::set<std::string> live_files;
 
   // fetch list of all registered dbids
@@ -97,6 +212,7 @@ IOStatus CloudFileSystemImpl::FindObsoleteFiles(
       new ManifestReader(info_log_, this, bucket_name_prefix));
 
   // Step2: from all MANIFEST files in Step 1, compile a list of all live files
+  bool all_live_files = true;
   for (auto iter = dbid_list.begin(); iter != dbid_list.end(); ++iter) {
     std::unique_ptr<SequentialFile> result;
     std::set<uint64_t> file_nums;
@@ -105,54 +221,64 @@ IOStatus CloudFileSystemImpl::FindObsoleteFiles(
       Log(InfoLogLevel::ERROR_LEVEL, info_log_,
           "[pg] dbid %s extracted files from path %s %s", iter->first.c_str(),
           iter->second.c_str(), st.ToString().c_str());
+      all_live_files = false;
     } else {
       // This file can reside either in this leaf db's path or reside in any of
       // the parent db's paths. Compute all possible paths and insert them into
       // live_files
+      auto parent_dbids = parents.find(iter->first);
       for (auto it = file_nums.begin(); it != file_nums.end(); ++it) {
-        // list of all parent dbids
-        const std::vector<std::string>& parent_dbids = parents[iter->first];
-
-        for (const auto& db : parent_dbids) {
-          // parent db's paths
-          const std::string& parent_path = dbid_list[db];
-          live_files.insert(MakeTableFileName(parent_path, *it));
+        live_files.insert(MakeTableFileName(iter->second, *it));
+        if (parent_dbids == parents.end()) {
+          continue;
+        }
+        for (const auto& db : parent_dbids->second) {
+          // parent db's paths. The parents registered in another bucket keep
+          // their own files alive.
+          auto parent = dbid_list.find(db);
+          if (parent != dbid_list.end()) {
+            live_files.insert(MakeTableFileName(parent->second, *it));
+          }
         }
       }
     }
   }
 
-  // Get all files from all dbpaths in this bucket
-  std::vector<std::string> all_files;
+  // Without the live files of every dbid, the runs until the next full
+  // listing cannot tell which deleted files are shared. Leaving the dbids
+  // out makes the next run a full listing.
+  if (all_live_files && dbids != nullptr && live_files_out != nullptr) {
+    for (const auto& dbid : dbid_list) {
+      dbids->insert(dbid.first);
+    }
+    *live_files_out = live_files;
+  }
 
-  // Scan all the db directories in this bucket. Retrieve the list
-  // of files in all these db directories.
+  // Scan all the db directories in this bucket. If a file does not belong to
+  // live_files, then the key of its object can be deleted
+  auto boundaries = GetListBoundaries();
   for (auto iter = dbid_list.begin(); iter != dbid_list.end(); ++iter) {
     std::unique_ptr<SequentialFile> result;
     std::string mpath = iter->second;
 
-    std::vector<std::string> objects;
-    st = GetStorageProvider()->ListCloudObjects(bucket_name_prefix, mpath,
-                                                &objects);
+    st = GetStorageProvider()->VisitCloudObjects(
+        bucket_name_prefix, mpath, boundaries, [&](const std::string& o) {
+          auto candidate = mpath + "/" + o;
+          if (ends_with(candidate, ".sst") &&
+              live_files.find(mpath + "/" + RemoveSstObjectShard(o)) ==
+                  live_files.end()) {
+            Log(InfoLogLevel::DEBUG_LEVEL, info_log_,
+                "[pg] bucket prefix %s path %s marked for deletion",
+                bucket_name_prefix.c_str(), candidate.c_str());
+            pathnames->push_back(std::move(candidate));
+          }
+          return true;
+        });
     if (!st.ok()) {
       Log(InfoLogLevel::ERROR_LEVEL, info_log_,
           "[pg] Unable to list objects in bucketprefix %s path_prefix %s. %s",
           bucket_name_prefix.c_str(), mpath.c_str(), st.ToString().c_str());
     }
-    for (auto& o : objects) {
-      all_files.push_back(mpath + "/" + o);
-    }
-  }
-
-  // If a file does not belong to live_files, then it can be deleted
-  for (const auto& candidate : all_files) {
-    if (live_files.find(candidate) == live_files.end() &&
-        ends_with(candidate, ".sst")) {
-      Log(InfoLogLevel::DEBUG_LEVEL, info_log_,
-          "[pg] bucket prefix %s path %s marked for deletion",
-          bucket_name_prefix.c_str(), candidate.c_str());
-      pathnames->push_back(candidate);
-    }
   }
   return IOStatus::OK();
 }
@@ -233,36 +359,28 @@ IOStatus CloudFileSystemImpl::extractParents(
       return st;
     }
 
-    // all_dbids is of the form 1x45-555rockset678a-6577rockset7789-9aef
+    // all_dbids is of the form 1x45-555rockset678a-6577rockset7789-9aef: a
+    // clone appends its own id to the dbid of its source, under which the
+    // source is registered. We want to return
+    // parents[1x45-555rockset678a-6577rockset7789-9aef] =
+    //     [1x45-555, 1x45-555rockset678a-6577]
     all_dbid = rtrim_if(trim(all_dbid), '\n');
 
-    // We want to return parents[1x45-555] = [678a-6577, 7789-9aef]
-    std::vector<std::string> parent_dbids;
-    size_t start = 0, end = 0;
-    while (end != std::string::npos) {
-      end = all_dbid.find(delimiter, start);
-
-      // If at end, use length=maxLength.  Else use length=end-start.
-      parent_dbids.push_back(all_dbid.substr(
-          start, (end == std::string::npos) ? std::string::npos : end - start));
-
-      // If at end, use start=maxSize.  Else use start=end+delimiter.
-      start = ((end > (std::string::npos - delimiter.size()))
-                   ? std::string::npos
-                   : end + delimiter.size());
+    // Verify that the dbid matches the one that we retrived from
+    // CloudFileSystem
+    if (all_dbid != iter->first) {
+      Log(InfoLogLevel::ERROR_LEVEL, info_log_,
+          "[pg] The IDENTITY file for dbid '%s' contains dbid '%s'. "
+          "Skipping...",
+          iter->first.c_str(), all_dbid.c_str());
+      continue;
     }
-    if (parent_dbids.size() > 0) {
-      std::string leaf_dbid = parent_dbids[parent_dbids.size() - 1];
-      // Verify that the leaf dbid matches the one that we retrived from
-      // CloudFileSystem
-      if (leaf_dbid != iter->first) {
-        Log(InfoLogLevel::ERROR_LEVEL, info_log_,
-            "[pg] The IDENTITY file for dbid '%s' contains leaf dbid as '%s'",
-            iter->first.c_str(), leaf_dbid.c_str());
-        return st;
-      }
-      (*parents)[leaf_dbid] = parent_dbids;
+    std::vector<std::string> parent_dbids;
+    for (size_t end = all_dbid.find(delimiter); end != std::string::npos;
+         end = all_dbid.find(delimiter, end + delimiter.size())) {
+      parent_dbids.push_back(all_dbid.substr(0, end));
     }
+    (*parents)[all_dbid] = std::move(parent_dbids);
   }
   return st;
 }
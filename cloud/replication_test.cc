@@ -8,9 +8,11 @@
 #include "cloud/filename.h"
 #include "db/column_family.h"
 #include "db/db_impl/db_impl.h"
+#include "db/write_callback.h"
 #include "file/file_util.h"
 #include "file/filename.h"
 #include "logging/logging.h"
+#include "rocksdb/convenience.h"
 #include "rocksdb/db.h"
 #include "rocksdb/listener.h"
 #include "rocksdb/options.h"
@@ -51,6 +53,12 @@ class Listener : public ReplicationLogListener {
       return "";
     }
     assert(state_ == TAILING);
+    if (compression_ != kNoCompression) {
+      auto s = CompressReplicationLogRecord(compression_, &record);
+      assert(s.ok());
+    }
+    // Pinned contents are only valid during the call
+    record.Own();
     {
       MutexLock lock(log_records_mutex_);
       std::string replication_sequence;
@@ -63,11 +71,17 @@ class Listener : public ReplicationLogListener {
 
   void UpdateEpoch(uint64_t epoch) { epoch_ = epoch; }
 
+  bool AcceptsPinnedContents() const override { return pinned_contents_; }
+  void setPinnedContents(bool pinned) { pinned_contents_ = pinned; }
+  void setCompression(CompressionType type) { compression_ = type; }
+
  private:
   port::Mutex* log_records_mutex_;
   LogRecordsVector* log_records_;
   State state_{OPEN};
   uint64_t epoch_{0};
+  std::atomic<bool> pinned_contents_{false};
+  std::atomic<CompressionType> compression_{kNoCompression};
 };
 
 class FollowerEnv : public EnvWrapper {
@@ -217,7 +231,8 @@ class ReplicationTest : public testing::Test {
   // it will catch up until end of log
   //
   // Returns the number of log records applied
-  size_t catchUpFollower(std::optional<size_t> num_records = std::nullopt);
+  size_t catchUpFollower(std::optional<size_t> num_records = std::nullopt,
+                         unsigned flags = DB::AR_EVICT_OBSOLETE_FILES);
 
   WriteOptions wo() const {
     WriteOptions w;
@@ -349,6 +364,15 @@ class ReplicationTest : public testing::Test {
   bool replicate_epoch_number_{true};
   bool consistency_check_on_epoch_replication{true};
   void resetFollowerSequence(int new_seq) { followerSequence_ = new_seq; }
+  Listener* listener() const { return listener_.get(); }
+  // Writes from several threads to a leader opened with options, whose
+  // records the follower must apply in order to catch up with it.
+  void verifyConcurrentWrites(Options options);
+  Status recordDebugString(size_t index, std::string* out) {
+    MutexLock lock(&log_records_mutex_);
+    return followerFull()->GetReplicationRecordDebugString(
+        log_records_[index].first, out);
+  }
 
  private:
   std::string test_dir_;
@@ -366,6 +390,36 @@ class ReplicationTest : public testing::Test {
   uint64_t snapshot_replication_epoch_{0};
 };
 
+void ReplicationTest::verifyConcurrentWrites(Options options) {
+  auto leader = openLeader(options);
+  openFollower(options);
+  createColumnFamily("cf1");
+
+  // Small memtables, so that the memtables are switched while writing.
+  std::vector<std::thread> threads;
+  for (int t = 0; t < 8; ++t) {
+    threads.emplace_back([&, t]() {
+      for (int i = 0; i < 2000; ++i) {
+        auto key = "key" + std::to_string(t * 2000 + i);
+        WriteBatch wb;
+        ASSERT_OK(wb.Put(key, std::string(100, 'a' + t)));
+        ASSERT_OK(wb.Put(leaderCF("cf1"), key, std::to_string(i)));
+        ASSERT_OK(leader->Write(wo(), &wb));
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  ASSERT_OK(leader->Flush({}));
+  ASSERT_OK(leaderFull()->TEST_WaitForBackgroundWork());
+  catchUpFollower();
+
+  EXPECT_EQ(followerFull()->GetLatestSequenceNumber(),
+            leaderFull()->GetLatestSequenceNumber());
+  verifyEqual();
+}
+
 Options ReplicationTest::leaderOptions() const {
   Options options;
   options.create_if_missing = true;
@@ -475,11 +529,11 @@ DB* ReplicationTest::openFollower(Options options) {
   return db;
 }
 
-size_t ReplicationTest::catchUpFollower(std::optional<size_t> num_records) {
+size_t ReplicationTest::catchUpFollower(std::optional<size_t> num_records,
+                                        unsigned flags) {
   MutexLock lock(&log_records_mutex_);
   DB::ApplyReplicationLogRecordInfo info;
   size_t ret = 0;
-  unsigned flags = DB::AR_EVICT_OBSOLETE_FILES;
   for (; followerSequence_ < (int)log_records_.size(); ++followerSequence_) {
     if (num_records && ret >= *num_records) {
       break;
@@ -1120,6 +1174,151 @@ TEST_F(ReplicationTest, NoMemSwitchRecordIfEmpty) {
   EXPECT_EQ(catchUpFollower(), 0);
 }
 
+TEST_F(ReplicationTest, NoMemtableWriteRecordIfCallbackFailed) {
+  class FailingCallback : public WriteCallback {
+   public:
+    Status Callback(DB*) override { return Status::Busy(); }
+    bool AllowWriteBatching() override { return true; }
+  };
+
+  auto leader = openLeader();
+  auto follower = openFollower();
+
+  WriteBatch wb;
+  ASSERT_OK(wb.Put("key1", "val1"));
+  FailingCallback callback;
+  ASSERT_TRUE(
+      leaderFull()->WriteWithCallback(wo(), &wb, &callback).IsBusy());
+  EXPECT_EQ(catchUpFollower(), 0);
+
+  ASSERT_OK(leader->Put(wo(), "key2", "val2"));
+  EXPECT_EQ(catchUpFollower(), 1);
+  std::string val;
+  ASSERT_TRUE(follower->Get(ReadOptions(), "key1", &val).IsNotFound());
+  ASSERT_OK(follower->Get(ReadOptions(), "key2", &val));
+  EXPECT_EQ(val, "val2");
+}
+
+TEST_F(ReplicationTest, ConcurrentMemtableWrites) {
+  auto leader = openLeader();
+  auto follower = openFollower();
+  createColumnFamily("cf1");
+  EXPECT_GT(catchUpFollower(), 0);
+
+  WriteBatch wb;
+  for (int i = 0; i < 10000; ++i) {
+    auto key = "key" + std::to_string(i);
+    ASSERT_OK(wb.Put(key, "val" + std::to_string(i)));
+    ASSERT_OK(wb.Put(leaderCF("cf1"), key, "cf1val" + std::to_string(i)));
+    if (i % 3 == 0) {
+      // Later entries for the same key land in other partitions
+      ASSERT_OK(wb.Delete(key));
+    }
+  }
+  ASSERT_OK(leader->Write(wo(), &wb));
+  EXPECT_EQ(catchUpFollower(std::nullopt,
+                            DB::AR_EVICT_OBSOLETE_FILES |
+                                DB::AR_CONCURRENT_MEMTABLE_WRITES),
+            1);
+
+  EXPECT_EQ(followerFull()->GetLatestSequenceNumber(),
+            leaderFull()->GetLatestSequenceNumber());
+  for (const auto& [name, cf] : leaderColumnFamilies()) {
+    auto leader_keys = getAllKeys(leader, cf.get());
+    EXPECT_EQ(leader_keys, getAllKeys(follower, followerCF(name)));
+    for (const auto& key : leader_keys) {
+      std::string leader_val, follower_val;
+      ASSERT_OK(leader->Get(ReadOptions(), cf.get(), key, &leader_val));
+      ASSERT_OK(
+          follower->Get(ReadOptions(), followerCF(name), key, &follower_val));
+      EXPECT_EQ(leader_val, follower_val);
+    }
+  }
+}
+
+TEST_F(ReplicationTest, PipelinedWrite) {
+  auto options = leaderOptions();
+  options.enable_pipelined_write = true;
+  verifyConcurrentWrites(options);
+}
+
+TEST_F(ReplicationTest, TwoWriteQueues) {
+  auto options = leaderOptions();
+  options.two_write_queues = true;
+  verifyConcurrentWrites(options);
+}
+
+TEST_F(ReplicationTest, PinnedAndCompressedContents) {
+  auto leader = openLeader();
+  auto follower = openFollower();
+  listener()->setPinnedContents(true);
+  for (auto type : GetSupportedCompressions()) {
+    if (type != kNoCompression) {
+      listener()->setCompression(type);
+      break;
+    }
+  }
+
+  for (int i = 0; i < 100; ++i) {
+    ASSERT_OK(leader->Put(wo(), "key" + std::to_string(i),
+                          std::string(1000, 'a' + (i % 26))));
+  }
+  ASSERT_OK(leader->Flush({}));
+  EXPECT_GT(catchUpFollower(), 100);
+
+  for (int i = 0; i < 100; ++i) {
+    std::string val;
+    ASSERT_OK(follower->Get(ReadOptions(), "key" + std::to_string(i), &val));
+    EXPECT_EQ(val, std::string(1000, 'a' + (i % 26)));
+  }
+  // Debug strings of compressed records are readable too
+  std::string debug;
+  ASSERT_OK(recordDebugString(0, &debug));
+}
+
+TEST_F(ReplicationTest, ApplyStatistics) {
+  auto leader_options = leaderOptions();
+  leader_options.statistics = CreateDBStatistics();
+  auto leader = openLeader(leader_options);
+  auto follower_options = leaderOptions();
+  follower_options.statistics = CreateDBStatistics();
+  auto follower = openFollower(follower_options);
+
+  std::string seq;
+  ASSERT_TRUE(follower->GetProperty(
+      DB::Properties::kLastAppliedReplicationSequence, &seq));
+  EXPECT_TRUE(seq.empty());
+  uint64_t time = 0;
+  ASSERT_TRUE(follower->GetIntProperty(
+      DB::Properties::kLastAppliedReplicationTime, &time));
+  EXPECT_EQ(time, 0);
+
+  ASSERT_OK(leader->Put(wo(), "key1", "val1"));
+  ASSERT_OK(leader->Flush({}));
+  auto applied = catchUpFollower();
+  EXPECT_GT(applied, 1);
+
+  auto* stats = follower_options.statistics.get();
+  EXPECT_EQ(stats->getTickerCount(REPLICATION_RECORDS_APPLIED), applied);
+  EXPECT_GT(stats->getTickerCount(REPLICATION_BYTES_APPLIED), 0);
+  HistogramData data;
+  stats->histogramData(REPLICATION_MEMTABLE_WRITE_APPLY_MICROS, &data);
+  EXPECT_EQ(data.count, 1);
+  stats->histogramData(REPLICATION_MANIFEST_WRITE_APPLY_MICROS, &data);
+  EXPECT_GT(data.count, 0);
+
+  ASSERT_TRUE(follower->GetProperty(
+      DB::Properties::kLastAppliedReplicationSequence, &seq));
+  EXPECT_FALSE(seq.empty());
+  ASSERT_TRUE(follower->GetIntProperty(
+      DB::Properties::kLastAppliedReplicationTime, &time));
+  EXPECT_GT(time, 0);
+
+  UpdateLeaderEpoch(2);
+  EXPECT_EQ(
+      leader_options.statistics->getTickerCount(REPLICATION_EPOCH_UPDATES), 1);
+}
+
 TEST_F(ReplicationTest, EvictObsoleteFiles) {
   auto leader = openLeader();
   leader->EnableFileDeletions();
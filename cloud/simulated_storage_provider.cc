@@ -0,0 +1,825 @@
+//  Copyright (c) 2016-present, Rockset, Inc.  All rights reserved.
+//
+#ifndef ROCKSDB_LITE
+
+#include "rocksdb/cloud/simulated_storage_provider.h"
+
+#include <algorithm>
+#include <cinttypes>
+
+#include "cloud/cloud_request_stats.h"
+#include "cloud/filename.h"
+#include "env/mock_env.h"
+#include "rocksdb/cloud/cloud_rate_limiter.h"
+#include "rocksdb/system_clock.h"
+#include "rocksdb/utilities/options_type.h"
+#include "util/coding.h"
+#include "util/crc32c.h"
+#include "util/math.h"
+#include "util/string_util.h"
+
+namespace ROCKSDB_NAMESPACE {
+
+namespace {
+// S3 deletes up to 1000 objects per DeleteObjects request.
+constexpr size_t kMaxObjectsPerDelete = 1000;
+// Backoffs of the retries of throttled requests are capped, like the AWS
+// SDK does.
+constexpr uint64_t kMaxThrottleBackoffMicros = 20 * 1000 * 1000;
+// Suffix of the files an object is written to before it replaces the
+// previous version, so that open readers keep reading the version they
+// opened.
+const char* kTmpSuffix = ".simtmp";
+
+SimulatedStorageOptions dummy_simulated_options;
+template <typename T1>
+int offset_of(T1 SimulatedStorageOptions::*member) {
+  return int(size_t(&(dummy_simulated_options.*member)) -
+             size_t(&dummy_simulated_options));
+}
+
+std::unordered_map<std::string, OptionTypeInfo>
+    simulated_storage_options_type_info = {
+        {"root_dir",
+         {offset_of(&SimulatedStorageOptions::root_dir),
+          OptionType::kString}},
+        {"read_latency_micros",
+         {offset_of(&SimulatedStorageOptions::read_latency_micros),
+          OptionType::kUInt64T}},
+        {"read_latency_jitter_micros",
+         {offset_of(&SimulatedStorageOptions::read_latency_jitter_micros),
+          OptionType::kUInt64T}},
+        {"write_latency_micros",
+         {offset_of(&SimulatedStorageOptions::write_latency_micros),
+          OptionType::kUInt64T}},
+        {"write_latency_jitter_micros",
+         {offset_of(&SimulatedStorageOptions::write_latency_jitter_micros),
+          OptionType::kUInt64T}},
+        {"metadata_latency_micros",
+         {offset_of(&SimulatedStorageOptions::metadata_latency_micros),
+          OptionType::kUInt64T}},
+        {"metadata_latency_jitter_micros",
+         {offset_of(&SimulatedStorageOptions::metadata_latency_jitter_micros),
+          OptionType::kUInt64T}},
+        {"tail_latency_probability",
+         {offset_of(&SimulatedStorageOptions::tail_latency_probability),
+          OptionType::kDouble}},
+        {"tail_latency_multiplier",
+         {offset_of(&SimulatedStorageOptions::tail_latency_multiplier),
+          OptionType::kDouble}},
+        {"download_bytes_per_sec",
+         {offset_of(&SimulatedStorageOptions::download_bytes_per_sec),
+          OptionType::kUInt64T}},
+        {"upload_bytes_per_sec",
+         {offset_of(&SimulatedStorageOptions::upload_bytes_per_sec),
+          OptionType::kUInt64T}},
+        {"throttle_probability",
+         {offset_of(&SimulatedStorageOptions::throttle_probability),
+          OptionType::kDouble}},
+        {"throttle_backoff_micros",
+         {offset_of(&SimulatedStorageOptions::throttle_backoff_micros),
+          OptionType::kUInt64T}},
+        {"throttle_max_retries",
+         {offset_of(&SimulatedStorageOptions::throttle_max_retries),
+          OptionType::kInt}},
+        {"write_request_price",
+         {offset_of(&SimulatedStorageOptions::write_request_price),
+          OptionType::kDouble}},
+        {"read_request_price",
+         {offset_of(&SimulatedStorageOptions::read_request_price),
+          OptionType::kDouble}},
+        {"transfer_price_per_gb",
+         {offset_of(&SimulatedStorageOptions::transfer_price_per_gb),
+          OptionType::kDouble}},
+        {"seed",
+         {offset_of(&SimulatedStorageOptions::seed),
+          OptionType::kUInt32T}},
+};
+
+uint64_t NowMicros() { return SystemClock::Default()->NowMicros(); }
+
+std::string ObjectKey(const std::string& object_path) {
+  // Like S3 paths, keys don't start with '/'
+  return ltrim_if(object_path, '/');
+}
+
+/******************** SimulatedReadableFile ******************/
+class SimulatedReadableFile : public CloudStorageReadableFileImpl {
+ public:
+  SimulatedReadableFile(const SimulatedStorageProvider* provider,
+                        std::unique_ptr<FSRandomAccessFile>&& file,
+                        Logger* info_log, const std::string& bucket,
+                        const std::string& fname, uint64_t size,
+                        std::string content_hash,
+                        const CloudFileSystemOptions* cloud_fs_options)
+      : CloudStorageReadableFileImpl(info_log, bucket, fname, size,
+                                     cloud_fs_options),
+        provider_(provider),
+        file_(std::move(file)),
+        content_hash_(std::move(content_hash)) {}
+
+  ~SimulatedReadableFile() override { WaitForHedgedReads(); }
+
+  virtual const char* Type() const {
+    return CloudStorageProviderImpl::kSimulated();
+  }
+
+  size_t GetUniqueId(char* id, size_t max_size) const override {
+    max_size = std::min(content_hash_.size(), max_size);
+    memcpy(id, content_hash_.c_str(), max_size);
+    return max_size;
+  }
+
+  IOStatus DoCloudRead(uint64_t offset, size_t n, const IOOptions& options,
+                       char* scratch, uint64_t* bytes_read,
+                       IODebugContext* dbg) const override {
+    uint64_t bytes =
+        offset < file_size_ ? std::min<uint64_t>(n, file_size_ - offset) : 0;
+    return provider_->Request(CloudRequestOpType::kReadOp, bytes, [&]() {
+      Slice result;
+      auto st = file_->Read(offset, n, options, &result, scratch, dbg);
+      if (st.ok()) {
+        if (result.data() != scratch) {
+          memcpy(scratch, result.data(), result.size());
+        }
+        *bytes_read = result.size();
+      }
+      return st;
+    });
+  }
+
+ private:
+  // The provider outlives its files, like the cloud file system does.
+  const SimulatedStorageProvider* provider_;
+  std::unique_ptr<FSRandomAccessFile> file_;
+  std::string content_hash_;
+};
+
+/******************** SimulatedWritableFile ******************/
+class SimulatedWritableFile : public CloudStorageWritableFileImpl {
+ public:
+  SimulatedWritableFile(CloudFileSystem* fs, const std::string& local_fname,
+                        const std::string& bucket,
+                        const std::string& cloud_fname,
+                        const FileOptions& options)
+      : CloudStorageWritableFileImpl(fs, local_fname, bucket, cloud_fname,
+                                     options) {}
+  const char* Name() const override {
+    return CloudStorageProviderImpl::kSimulated();
+  }
+};
+}  // namespace
+
+std::string SimulatedStorageStats::ToString() const {
+  char buf[512];
+  snprintf(buf, sizeof(buf),
+           "reads %" PRIu64 " writes %" PRIu64 " lists %" PRIu64
+           " creates %" PRIu64 " deletes %" PRIu64 " copies %" PRIu64
+           " infos %" PRIu64 " throttled %" PRIu64 " bytes read %" PRIu64
+           " bytes written %" PRIu64 " cost $%.6f",
+           read_requests, write_requests, list_requests, create_requests,
+           delete_requests, copy_requests, info_requests, throttled_requests,
+           bytes_read, bytes_written, cost);
+  return buf;
+}
+
+/******************** SimulatedStorageProvider ******************/
+SimulatedStorageProvider::SimulatedStorageProvider(
+    const SimulatedStorageOptions& options)
+    : options_(options) {
+  RegisterOptions("SimulatedStorageOptions", &options_,
+                  &simulated_storage_options_type_info);
+  ResetStats();
+}
+
+SimulatedStorageProvider::~SimulatedStorageProvider() {}
+
+Status SimulatedStorageProvider::PrepareOptions(const ConfigOptions& options) {
+  if (!store_) {
+    latency_rng_.seed(options_.seed);
+    IOStatus st;
+    if (options_.root_dir.empty()) {
+      store_ = std::make_shared<MockFileSystem>(SystemClock::Default());
+      store_root_ = "/simulated";
+      st = store_->CreateDirIfMissing(store_root_, IOOptions(), nullptr);
+    } else {
+      store_ = FileSystem::Default();
+      store_root_ = rtrim_if(options_.root_dir, '/');
+      st = store_->CreateDirIfMissing(store_root_, IOOptions(), nullptr);
+      if (st.ok()) {
+        st = LoadBuckets();
+      }
+    }
+    if (!st.ok()) {
+      store_.reset();
+      return st;
+    }
+  }
+  return CloudStorageProviderImpl::PrepareOptions(options);
+}
+
+IOStatus SimulatedStorageProvider::LoadBuckets() {
+  std::vector<std::string> children;
+  auto st = store_->GetChildren(store_root_, IOOptions(), &children, nullptr);
+  for (size_t i = 0; st.ok() && i < children.size(); i++) {
+    const auto dir = store_root_ + pathsep + children[i];
+    bool is_dir = false;
+    if (store_->IsDirectory(dir, IOOptions(), &is_dir, nullptr).ok() &&
+        is_dir) {
+      buckets_[children[i]];
+      st = LoadObjects(children[i], dir, "");
+    }
+  }
+  return st;
+}
+
+IOStatus SimulatedStorageProvider::LoadObjects(const std::string& bucket_name,
+                                               const std::string& dir,
+                                               const std::string& prefix) {
+  std::vector<std::string> children;
+  auto st = store_->GetChildren(dir, IOOptions(), &children, nullptr);
+  for (size_t i = 0; st.ok() && i < children.size(); i++) {
+    const auto path = dir + pathsep + children[i];
+    const auto key = prefix + children[i];
+    bool is_dir = false;
+    st = store_->IsDirectory(path, IOOptions(), &is_dir, nullptr);
+    if (!st.ok()) {
+      break;
+    } else if (is_dir) {
+      st = LoadObjects(bucket_name, path, key + pathsep);
+    } else if (ends_with(key, kTmpSuffix)) {
+      // An object that was being written when the process stopped
+      st = store_->DeleteFile(path, IOOptions(), nullptr);
+    } else {
+      Object& object = buckets_[bucket_name][key];
+      st = store_->GetFileSize(path, IOOptions(), &object.size, nullptr);
+      if (st.ok()) {
+        uint64_t mtime = 0;
+        st = store_->GetFileModificationTime(path, IOOptions(), &mtime,
+                                             nullptr);
+        object.modification_time = mtime * 1000;
+      }
+      object.content_hash = "simulated-" + std::to_string(next_id_++);
+    }
+  }
+  return st;
+}
+
+std::string SimulatedStorageProvider::ObjectFile(
+    const std::string& bucket_name, const std::string& object_path) const {
+  return store_root_ + pathsep + bucket_name + pathsep + ObjectKey(object_path);
+}
+
+IOStatus SimulatedStorageProvider::StoreObject(const std::string& bucket_name,
+                                               const std::string& object_path,
+                                               const Slice& data) {
+  const auto key = ObjectKey(object_path);
+  std::string tmp;
+  {
+    std::lock_guard<std::mutex> lk(mutex_);
+    if (buckets_.find(bucket_name) == buckets_.end()) {
+      return IOStatus::NotFound(bucket_name, "bucket does not exist");
+    }
+    tmp = ObjectFile(bucket_name, key) + "." + std::to_string(next_id_++) +
+          kTmpSuffix;
+  }
+  // Keys are sliced into directories at their separators
+  const auto bucket_dir = store_root_ + pathsep + bucket_name;
+  IOStatus st;
+  for (auto pos = key.find(pathsep); st.ok() && pos != std::string::npos;
+       pos = key.find(pathsep, pos + 1)) {
+    st = store_->CreateDirIfMissing(bucket_dir + pathsep + key.substr(0, pos),
+                                    IOOptions(), nullptr);
+  }
+  if (st.ok()) {
+    st = WriteStringToFile(store_.get(), data, tmp, false /*should_sync*/);
+  }
+  if (st.ok()) {
+    st = store_->RenameFile(tmp, ObjectFile(bucket_name, key), IOOptions(),
+                            nullptr);
+  }
+  if (!st.ok()) {
+    store_->DeleteFile(tmp, IOOptions(), nullptr).PermitUncheckedError();
+    return st;
+  }
+  std::lock_guard<std::mutex> lk(mutex_);
+  Object& object = buckets_[bucket_name][key];
+  object.size = data.size();
+  object.modification_time = NowMicros() / 1000;
+  object.content_hash = "simulated-" + std::to_string(next_id_++);
+  object.crc32c.clear();
+  object.metadata.clear();
+  return IOStatus::OK();
+}
+
+uint64_t SimulatedStorageProvider::SampleLatency(CloudRequestOpType type,
+                                                 bool* throttled) const {
+  uint64_t fixed = options_.metadata_latency_micros;
+  uint64_t jitter = options_.metadata_latency_jitter_micros;
+  if (type == CloudRequestOpType::kReadOp) {
+    fixed = options_.read_latency_micros;
+    jitter = options_.read_latency_jitter_micros;
+  } else if (type == CloudRequestOpType::kWriteOp) {
+    fixed = options_.write_latency_micros;
+    jitter = options_.write_latency_jitter_micros;
+  }
+  std::uniform_real_distribution<double> uniform(0, 1);
+  std::lock_guard<std::mutex> lk(latency_rng_mutex_);
+  double latency = static_cast<double>(fixed);
+  if (jitter > 0) {
+    latency += std::exponential_distribution<double>(
+        1.0 / static_cast<double>(jitter))(latency_rng_);
+  }
+  if (options_.tail_latency_probability > 0 &&
+      uniform(latency_rng_) < options_.tail_latency_probability) {
+    latency *= options_.tail_latency_multiplier;
+  }
+  *throttled = options_.throttle_probability > 0 &&
+               uniform(latency_rng_) < options_.throttle_probability;
+  return static_cast<uint64_t>(latency);
+}
+
+IOStatus SimulatedStorageProvider::SimulateLatency(
+    CloudRequestOpType type) const {
+  auto clock = SystemClock::Default();
+  for (int retries = 0;; retries++) {
+    bool throttled = false;
+    auto latency = SampleLatency(type, &throttled);
+    if (latency > 0) {
+      clock->SleepForMicroseconds(static_cast<int>(latency));
+    }
+    if (!throttled) {
+      requests_[static_cast<size_t>(type)].fetch_add(
+          1, std::memory_order_relaxed);
+      return IOStatus::OK();
+    }
+    throttled_requests_.fetch_add(1, std::memory_order_relaxed);
+    const CloudFileSystemOptions* cloud_opts =
+        cfs_ ? &cfs_->GetCloudFileSystemOptions() : nullptr;
+    if (cloud_opts && cloud_opts->cloud_rate_limiter) {
+      cloud_opts->cloud_rate_limiter->OnThrottled();
+    }
+    if (retries >= options_.throttle_max_retries) {
+      return IOStatus::Busy("Simulated throttling");
+    }
+    RecordCloudRequestRetry(cloud_opts ? cloud_opts->statistics.get() : nullptr,
+                            true /*throttled*/);
+    auto backoff = std::min(options_.throttle_backoff_micros << retries,
+                            kMaxThrottleBackoffMicros);
+    clock->SleepForMicroseconds(static_cast<int>(backoff));
+  }
+}
+
+void SimulatedStorageProvider::WaitForBandwidth(bool upload,
+                                                uint64_t bytes) const {
+  const uint64_t bytes_per_sec =
+      upload ? options_.upload_bytes_per_sec : options_.download_bytes_per_sec;
+  if (bytes_per_sec == 0 || bytes == 0) {
+    return;
+  }
+  // The transfers share the bandwidth in the order they start.
+  uint64_t now = NowMicros();
+  uint64_t done;
+  {
+    std::lock_guard<std::mutex> lk(bandwidth_mutex_);
+    uint64_t& free_micros = upload ? upload_free_micros_ : download_free_micros_;
+    done = std::max(now, free_micros) + bytes * 1000000 / bytes_per_sec;
+    free_micros = done;
+  }
+  if (done > now) {
+    SystemClock::Default()->SleepForMicroseconds(
+        static_cast<int>(done - now));
+  }
+}
+
+IOStatus SimulatedStorageProvider::Request(
+    CloudRequestOpType type, uint64_t bytes,
+    const std::function<IOStatus()>& op) const {
+  const uint64_t start = NowMicros();
+  auto st = SimulateLatency(type);
+  if (st.ok()) {
+    if (type == CloudRequestOpType::kReadOp) {
+      WaitForBandwidth(false /*upload*/, bytes);
+      bytes_read_.fetch_add(bytes, std::memory_order_relaxed);
+    } else if (type == CloudRequestOpType::kWriteOp) {
+      WaitForBandwidth(true /*upload*/, bytes);
+      bytes_written_.fetch_add(bytes, std::memory_order_relaxed);
+    }
+    st = op();
+  }
+  if (cfs_) {
+    const auto& cloud_opts = cfs_->GetCloudFileSystemOptions();
+    const uint64_t micros = NowMicros() - start;
+    RecordCloudRequest(cloud_opts.statistics.get(), type, bytes, micros,
+                       st.ok());
+    if (cloud_opts.cloud_request_callback) {
+      (*cloud_opts.cloud_request_callback)(type, bytes, micros, st.ok());
+    }
+  }
+  return st;
+}
+
+SimulatedStorageStats SimulatedStorageProvider::GetStats() const {
+  SimulatedStorageStats stats;
+  auto requests = [this](CloudRequestOpType type) {
+    return requests_[static_cast<size_t>(type)].load(
+        std::memory_order_relaxed);
+  };
+  stats.read_requests = requests(CloudRequestOpType::kReadOp);
+  stats.write_requests = requests(CloudRequestOpType::kWriteOp);
+  stats.list_requests = requests(CloudRequestOpType::kListOp);
+  stats.create_requests = requests(CloudRequestOpType::kCreateOp);
+  stats.delete_requests = requests(CloudRequestOpType::kDeleteOp);
+  stats.copy_requests = requests(CloudRequestOpType::kCopyOp);
+  stats.info_requests = requests(CloudRequestOpType::kInfoOp);
+  stats.throttled_requests = throttled_requests_.load(std::memory_order_relaxed);
+  stats.bytes_read = bytes_read_.load(std::memory_order_relaxed);
+  stats.bytes_written = bytes_written_.load(std::memory_order_relaxed);
+  const uint64_t write_class = stats.write_requests + stats.copy_requests +
+                               stats.list_requests + stats.create_requests;
+  const uint64_t read_class = stats.read_requests + stats.info_requests;
+  stats.cost = (static_cast<double>(write_class) * options_.write_request_price +
+                static_cast<double>(read_class) * options_.read_request_price) /
+                   1000 +
+               static_cast<double>(stats.bytes_read + stats.bytes_written) /
+                   (1ull << 30) * options_.transfer_price_per_gb;
+  return stats;
+}
+
+void SimulatedStorageProvider::ResetStats() {
+  for (auto& requests : requests_) {
+    requests.store(0, std::memory_order_relaxed);
+  }
+  throttled_requests_.store(0, std::memory_order_relaxed);
+  bytes_read_.store(0, std::memory_order_relaxed);
+  bytes_written_.store(0, std::memory_order_relaxed);
+}
+
+IOStatus SimulatedStorageProvider::CreateBucket(const std::string& bucket) {
+  return Request(CloudRequestOpType::kCreateOp, 0, [&]() {
+    auto st = store_->CreateDirIfMissing(store_root_ + pathsep + bucket,
+                                         IOOptions(), nullptr);
+    if (st.ok()) {
+      std::lock_guard<std::mutex> lk(mutex_);
+      buckets_[bucket];
+    }
+    return st;
+  });
+}
+
+IOStatus SimulatedStorageProvider::ExistsBucket(const std::string& bucket) {
+  return Request(CloudRequestOpType::kInfoOp, 0, [&]() {
+    std::lock_guard<std::mutex> lk(mutex_);
+    return buckets_.find(bucket) != buckets_.end() ? IOStatus::OK()
+                                                   : IOStatus::NotFound();
+  });
+}
+
+IOStatus SimulatedStorageProvider::EmptyBucket(const std::string& bucket_name,
+                                               const std::string& object_path) {
+  std::vector<std::string> results;
+  auto st = ListCloudObjects(bucket_name, object_path, &results);
+  if (!st.ok()) {
+    return st;
+  }
+  for (auto& path : results) {
+    path = object_path + pathsep + path;
+  }
+  return DeleteCloudObjects(bucket_name, results);
+}
+
+IOStatus SimulatedStorageProvider::RemoveObject(const std::string& bucket_name,
+                                                const std::string& object_path) {
+  const auto key = ObjectKey(object_path);
+  {
+    std::lock_guard<std::mutex> lk(mutex_);
+    auto bucket = buckets_.find(bucket_name);
+    if (bucket == buckets_.end()) {
+      return IOStatus::NotFound(bucket_name, "bucket does not exist");
+    } else if (bucket->second.erase(key) == 0) {
+      return IOStatus::NotFound(object_path);
+    }
+  }
+  return store_->DeleteFile(ObjectFile(bucket_name, key), IOOptions(),
+                            nullptr);
+}
+
+IOStatus SimulatedStorageProvider::DoDeleteCloudObject(
+    const std::string& bucket_name, const std::string& object_path) {
+  return Request(CloudRequestOpType::kDeleteOp, 0,
+                 [&]() { return RemoveObject(bucket_name, object_path); });
+}
+
+IOStatus SimulatedStorageProvider::DoDeleteCloudObjects(
+    const std::string& bucket_name,
+    const std::vector<std::string>& object_paths) {
+  IOStatus result;
+  for (size_t begin = 0; begin < object_paths.size();
+       begin += kMaxObjectsPerDelete) {
+    const size_t end =
+        std::min(object_paths.size(), begin + kMaxObjectsPerDelete);
+    auto st = Request(CloudRequestOpType::kDeleteOp, 0, [&]() {
+      IOStatus batch;
+      for (size_t i = begin; i < end; i++) {
+        auto s = RemoveObject(bucket_name, object_paths[i]);
+        if (!s.ok() && !s.IsNotFound() && batch.ok()) {
+          batch = s;
+        }
+      }
+      return batch;
+    });
+    if (!st.ok() && result.ok()) {
+      result = st;
+    }
+  }
+  return result;
+}
+
+IOStatus SimulatedStorageProvider::ListCloudObjects(
+    const std::string& bucket_name, const std::string& object_path,
+    std::vector<std::string>* result) {
+  return DoVisitCloudObjects(bucket_name, object_path, "", "",
+                             [result](const std::string& name) {
+                               result->push_back(name);
+                               return true;
+                             });
+}
+
+IOStatus SimulatedStorageProvider::DoVisitCloudObjects(
+    const std::string& bucket_name, const std::string& object_path,
+    const std::string& start_after, const std::string& last,
+    const CloudObjectVisitor& visitor) {
+  const auto prefix = ensure_ends_with_pathsep(ObjectKey(object_path));
+  const size_t page_size =
+      cfs_ && cfs_->GetCloudFileSystemOptions()
+                      .number_objects_listed_in_one_iteration > 0
+          ? cfs_->GetCloudFileSystemOptions()
+                .number_objects_listed_in_one_iteration
+          : 1000;
+  // Listed one page per request, the visitor is called between requests.
+  std::string marker = start_after.empty() ? "" : prefix + start_after;
+  for (bool done = false; !done;) {
+    std::vector<std::string> names;
+    std::vector<CloudObjectInformation> infos;
+    auto st = Request(CloudRequestOpType::kListOp, 0, [&]() {
+      std::lock_guard<std::mutex> lk(mutex_);
+      auto bucket = buckets_.find(bucket_name);
+      if (bucket == buckets_.end()) {
+        return IOStatus::NotFound(bucket_name, "bucket does not exist");
+      }
+      auto it = marker.empty() ? bucket->second.lower_bound(prefix)
+                               : bucket->second.upper_bound(marker);
+      for (; it != bucket->second.end() && names.size() < page_size; ++it) {
+        if (!StartsWith(it->first, prefix)) {
+          break;
+        }
+        names.push_back(it->first.substr(prefix.size()));
+        infos.emplace_back();
+        infos.back().size = it->second.size;
+        infos.back().modification_time = it->second.modification_time;
+        infos.back().content_hash = it->second.content_hash;
+      }
+      done = names.size() < page_size;
+      return IOStatus::OK();
+    });
+    if (!st.ok()) {
+      return st;
+    }
+    for (size_t i = 0; i < names.size(); i++) {
+      CacheObjectMetadata(
+          bucket_name, prefix + names[i],
+          kCachedSize | kCachedModificationTime | kCachedContentHash,
+          infos[i]);
+      if ((!last.empty() && names[i] > last) || !visitor(names[i])) {
+        return IOStatus::OK();
+      }
+    }
+    if (!names.empty()) {
+      marker = prefix + names.back();
+    }
+  }
+  return IOStatus::OK();
+}
+
+IOStatus SimulatedStorageProvider::DoGetCloudObjectMetadata(
+    const std::string& bucket_name, const std::string& object_path,
+    CloudObjectInformation* info) {
+  assert(info != nullptr);
+  return Request(CloudRequestOpType::kInfoOp, 0, [&]() {
+    std::lock_guard<std::mutex> lk(mutex_);
+    auto bucket = buckets_.find(bucket_name);
+    if (bucket == buckets_.end()) {
+      return IOStatus::NotFound(bucket_name, "bucket does not exist");
+    }
+    auto it = bucket->second.find(ObjectKey(object_path));
+    if (it == bucket->second.end()) {
+      return IOStatus::NotFound(object_path);
+    }
+    info->size = it->second.size;
+    info->modification_time = it->second.modification_time;
+    info->content_hash = it->second.content_hash;
+    info->crc32c = it->second.crc32c;
+    info->metadata = it->second.metadata;
+    return IOStatus::OK();
+  });
+}
+
+IOStatus SimulatedStorageProvider::DoPutCloudObjectMetadata(
+    const std::string& bucket_name, const std::string& object_path,
+    const std::unordered_map<std::string, std::string>& metadata) {
+  // Like S3, replaces the object with an empty one carrying the metadata.
+  return Request(CloudRequestOpType::kWriteOp, 0, [&]() {
+    auto st = StoreObject(bucket_name, object_path, Slice());
+    if (st.ok()) {
+      std::lock_guard<std::mutex> lk(mutex_);
+      buckets_[bucket_name][ObjectKey(object_path)].metadata = metadata;
+    }
+    return st;
+  });
+}
+
+IOStatus SimulatedStorageProvider::DoCopyCloudObject(
+    const std::string& src_bucket_name, const std::string& src_object_path,
+    const std::string& dest_bucket_name, const std::string& dest_object_path) {
+  return Request(CloudRequestOpType::kCopyOp, 0, [&]() {
+    std::string data;
+    auto st = ReadFileToString(store_.get(),
+                               ObjectFile(src_bucket_name, src_object_path),
+                               &data);
+    if (st.IsPathNotFound()) {
+      st = IOStatus::NotFound(src_object_path);
+    }
+    if (st.ok()) {
+      st = StoreObject(dest_bucket_name, dest_object_path, data);
+    }
+    return st;
+  });
+}
+
+IOStatus SimulatedStorageProvider::CreateMultipartUpload(
+    const std::string& bucket_name, const std::string& object_path,
+    std::string* upload_id) {
+  return Request(CloudRequestOpType::kWriteOp, 0, [&]() {
+    std::lock_guard<std::mutex> lk(mutex_);
+    if (buckets_.find(bucket_name) == buckets_.end()) {
+      return IOStatus::NotFound(bucket_name, "bucket does not exist");
+    }
+    *upload_id = "upload-" + std::to_string(next_id_++) + "-" +
+                 ObjectKey(object_path);
+    uploads_[*upload_id];
+    return IOStatus::OK();
+  });
+}
+
+IOStatus SimulatedStorageProvider::UploadPart(
+    const std::string& /*bucket_name*/, const std::string& /*object_path*/,
+    const std::string& upload_id, int part_number, const Slice& data,
+    std::string* part_id) {
+  return Request(CloudRequestOpType::kWriteOp, data.size(), [&]() {
+    std::lock_guard<std::mutex> lk(mutex_);
+    auto it = uploads_.find(upload_id);
+    if (it == uploads_.end()) {
+      return IOStatus::NotFound(upload_id, "no such upload");
+    } else if (part_number < 1) {
+      return IOStatus::InvalidArgument("part numbers start at 1");
+    }
+    auto& parts = it->second;
+    if (parts.size() < static_cast<size_t>(part_number)) {
+      parts.resize(part_number);
+    }
+    parts[part_number - 1] = data.ToString();
+    *part_id = "part-" + std::to_string(part_number);
+    return IOStatus::OK();
+  });
+}
+
+IOStatus SimulatedStorageProvider::DoCompleteMultipartUpload(
+    const std::string& bucket_name, const std::string& object_path,
+    const std::string& upload_id, const std::vector<std::string>& part_ids) {
+  return Request(CloudRequestOpType::kWriteOp, 0, [&]() {
+    std::string data;
+    {
+      std::lock_guard<std::mutex> lk(mutex_);
+      auto it = uploads_.find(upload_id);
+      if (it == uploads_.end()) {
+        return IOStatus::NotFound(upload_id, "no such upload");
+      }
+      const auto& parts = it->second;
+      if (parts.size() != part_ids.size()) {
+        return IOStatus::InvalidArgument(upload_id, "missing parts");
+      }
+      for (size_t i = 0; i < parts.size(); i++) {
+        if (part_ids[i] != "part-" + std::to_string(i + 1)) {
+          return IOStatus::InvalidArgument(upload_id, "bad part id");
+        }
+        data.append(parts[i]);
+      }
+      uploads_.erase(it);
+    }
+    return StoreObject(bucket_name, object_path, data);
+  });
+}
+
+IOStatus SimulatedStorageProvider::AbortMultipartUpload(
+    const std::string& /*bucket_name*/, const std::string& /*object_path*/,
+    const std::string& upload_id) {
+  return Request(CloudRequestOpType::kDeleteOp, 0, [&]() {
+    std::lock_guard<std::mutex> lk(mutex_);
+    uploads_.erase(upload_id);
+    return IOStatus::OK();
+  });
+}
+
+IOStatus SimulatedStorageProvider::NewCloudWritableFile(
+    const std::string& local_path, const std::string& bucket_name,
+    const std::string& object_path, const FileOptions& file_opts,
+    std::unique_ptr<CloudStorageWritableFile>* result,
+    IODebugContext* /*dbg*/) {
+  result->reset(new SimulatedWritableFile(cfs_, local_path, bucket_name,
+                                          object_path, file_opts));
+  return (*result)->status();
+}
+
+IOStatus SimulatedStorageProvider::DoNewCloudReadableFile(
+    const std::string& bucket, const std::string& fname, uint64_t fsize,
+    const std::string& content_hash, const FileOptions& options,
+    std::unique_ptr<CloudStorageReadableFile>* result, IODebugContext* dbg) {
+  std::unique_ptr<FSRandomAccessFile> file;
+  auto st = store_->NewRandomAccessFile(ObjectFile(bucket, fname), options,
+                                        &file, dbg);
+  if (st.IsPathNotFound()) {
+    st = IOStatus::NotFound(fname);
+  }
+  if (st.ok()) {
+    result->reset(new SimulatedReadableFile(
+        this, std::move(file), cfs_->GetLogger(), bucket, fname, fsize,
+        content_hash, &cfs_->GetCloudFileSystemOptions()));
+  }
+  return st;
+}
+
+IOStatus SimulatedStorageProvider::DoGetCloudObject(
+    const std::string& bucket_name, const std::string& object_path,
+    const std::string& local_path, uint64_t* remote_size) {
+  uint64_t size = 0;
+  {
+    std::lock_guard<std::mutex> lk(mutex_);
+    auto bucket = buckets_.find(bucket_name);
+    if (bucket != buckets_.end()) {
+      auto it = bucket->second.find(ObjectKey(object_path));
+      if (it != bucket->second.end()) {
+        size = it->second.size;
+      }
+    }
+  }
+  return Request(CloudRequestOpType::kReadOp, size, [&]() {
+    std::string data;
+    auto st = ReadFileToString(store_.get(),
+                               ObjectFile(bucket_name, object_path), &data);
+    if (st.IsPathNotFound()) {
+      st = IOStatus::NotFound(object_path);
+    }
+    if (st.ok()) {
+      *remote_size = data.size();
+      st = WriteStringToFile(cfs_->GetBaseFileSystem().get(), data,
+                             local_path, false /*should_sync*/);
+    }
+    return st;
+  });
+}
+
+IOStatus SimulatedStorageProvider::DoPutCloudObject(
+    const std::string& local_file, const std::string& bucket_name,
+    const std::string& object_path, uint64_t file_size,
+    const std::string& crc32c) {
+  return Request(CloudRequestOpType::kWriteOp, file_size, [&]() {
+    std::string data;
+    auto st = ReadFileToString(cfs_->GetBaseFileSystem().get(), local_file,
+                               &data);
+    if (st.ok() && !crc32c.empty()) {
+      std::string actual;
+      PutFixed32(&actual,
+                 EndianSwapValue(crc32c::Value(data.data(), data.size())));
+      if (actual != crc32c) {
+        st = IOStatus::IOError(object_path, "crc32c does not match the data");
+      }
+    }
+    if (st.ok()) {
+      st = StoreObject(bucket_name, object_path, data);
+    }
+    if (st.ok() && !crc32c.empty()) {
+      std::lock_guard<std::mutex> lk(mutex_);
+      buckets_[bucket_name][ObjectKey(object_path)].crc32c = crc32c;
+    }
+    return st;
+  });
+}
+
+Status CloudStorageProviderImpl::CreateSimulatedProvider(
+    std::unique_ptr<CloudStorageProvider>* provider) {
+  provider->reset(new SimulatedStorageProvider());
+  return Status::OK();
+}
+
+}  // namespace ROCKSDB_NAMESPACE
+#endif  // ROCKSDB_LITE
@@ -39,6 +39,26 @@ Status ArenaWrappedDBIter::GetProperty(std::string prop_name,
   return db_iter_->GetProperty(prop_name, prop);
 }
 
+void ArenaWrappedDBIter::ChargeMemory(DBImpl* db) {
+  assert(db != nullptr);
+  ReleaseMemory();
+  charged_db_ = db;
+  charged_bytes_ = sizeof(*this) + arena_.MemoryAllocatedBytes();
+  memory_charge_status_ =
+      db->ChargeIteratorMemory(charged_bytes_, &memory_charge_);
+  // Checked by the callers which fail the iterator, see
+  // DBImpl::NewIterator()
+  memory_charge_status_.PermitUncheckedError();
+}
+
+void ArenaWrappedDBIter::ReleaseMemory() {
+  if (charged_db_ != nullptr) {
+    memory_charge_.reset();
+    charged_db_->ReleaseIteratorMemory(charged_bytes_);
+    charged_bytes_ = 0;
+  }
+}
+
 void ArenaWrappedDBIter::Init(
     Env* env, const ReadOptions& read_options, const ImmutableOptions& ioptions,
     const MutableCFOptions& mutable_cf_options, const Version* version,
@@ -82,8 +102,10 @@ Status ArenaWrappedDBIter::Refresh(const Snapshot* snapshot) {
   TEST_SYNC_POINT("ArenaWrappedDBIter::Refresh:1");
   TEST_SYNC_POINT("ArenaWrappedDBIter::Refresh:2");
 
+  Status s;
   auto reinit_internal_iter = [&]() {
     Env* env = db_iter_->env();
+    ReleaseMemory();
     db_iter_->~DBIter();
     arena_.~Arena();
     new (&arena_) Arena();
@@ -104,6 +126,10 @@ Status ArenaWrappedDBIter::Refresh(const Snapshot* snapshot) {
         read_options_, cfd, sv, &arena_, read_seq,
         /* allow_unprepared_value */ true, /* db_iter */ this);
     SetIterUnderDBIter(internal_iter);
+    if (charged_db_ != nullptr) {
+      ChargeMemory(charged_db_);
+      s = memory_charge_status_;
+    }
   };
   while (true) {
     if (sv_number_ != cur_sv_number) {
@@ -159,7 +185,7 @@ Status ArenaWrappedDBIter::Refresh(const Snapshot* snapshot) {
       break;
     }
   }
-  return Status::OK();
+  return s;
 }
 
 ArenaWrappedDBIter* NewArenaWrappedDbIterator(
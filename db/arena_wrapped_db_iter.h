@@ -36,6 +36,7 @@ class Version;
 class ArenaWrappedDBIter : public Iterator {
  public:
   ~ArenaWrappedDBIter() override {
+    ReleaseMemory();
     if (db_iter_ != nullptr) {
       db_iter_->~DBIter();
     } else {
@@ -65,6 +66,7 @@ class ArenaWrappedDBIter : public Iterator {
   // 'target' does not contain timestamp, even if user timestamp feature is
   // enabled.
   void Seek(const Slice& target) override { db_iter_->Seek(target); }
+  void StartSeek(const Slice& target) override { db_iter_->StartSeek(target); }
   void SeekForPrev(const Slice& target) override {
     db_iter_->SeekForPrev(target);
   }
@@ -99,6 +101,12 @@ class ArenaWrappedDBIter : public Iterator {
     expose_blob_index_ = expose_blob_index;
   }
 
+  // Charges the memory of the arena to the iterator memory of `db`, see
+  // DBImpl::ChargeIteratorMemory(), until the iterator is destroyed. Refresh()
+  // charges the arena it rebuilds again, returning memory_charge_status().
+  void ChargeMemory(DBImpl* db);
+  const Status& memory_charge_status() const { return memory_charge_status_; }
+
   SequenceNumber get_sequence() const {
     if (!db_iter_) {
       return SequenceNumber(0);
@@ -107,6 +115,8 @@ class ArenaWrappedDBIter : public Iterator {
   }
 
  private:
+  void ReleaseMemory();
+
   DBIter* db_iter_ = nullptr;
   Arena arena_;
   uint64_t sv_number_;
@@ -118,6 +128,12 @@ class ArenaWrappedDBIter : public Iterator {
   // If this is nullptr, it means the mutable memtable does not contain range
   // tombstone when added under this DBIter.
   TruncatedRangeDelIterator** memtable_range_tombstone_iter_ = nullptr;
+  // Set by ChargeMemory()
+  DBImpl* charged_db_ = nullptr;
+  size_t charged_bytes_ = 0;
+  std::unique_ptr<CacheReservationManager::CacheReservationHandle>
+      memory_charge_;
+  Status memory_charge_status_;
 };
 
 // Generate the arena wrapped iterator class.
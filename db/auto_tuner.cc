@@ -0,0 +1,192 @@
+//  Copyright (c) Meta Platforms, Inc. and affiliates.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+
+#include "rocksdb/auto_tuner.h"
+
+#include <algorithm>
+#include <cinttypes>
+#include <map>
+#include <string>
+#include <unordered_map>
+
+#include "logging/logging.h"
+#include "rocksdb/db.h"
+#include "rocksdb/rate_limiter.h"
+#include "util/string_util.h"
+
+namespace ROCKSDB_NAMESPACE {
+
+namespace {
+template <typename T>
+T Bound(T value, T min_value, T max_value) {
+  return std::min(std::max(value, min_value), max_value);
+}
+
+uint64_t StallCount(const std::map<std::string, std::string>& stall_stats,
+                    const std::string& key) {
+  auto it = stall_stats.find(key);
+  return it == stall_stats.end() ? 0 : ParseUint64(it->second);
+}
+
+// The cumulative write stall counts of a column family
+struct CFStallCounts {
+  uint64_t stalls = 0;
+  uint64_t l0_stalls = 0;
+};
+
+CFStallCounts GetCFStallCounts(DB* db, ColumnFamilyHandle* cfh) {
+  CFStallCounts counts;
+  std::map<std::string, std::string> stall_stats;
+  if (!db->GetMapProperty(cfh, DB::Properties::kCFWriteStallStats,
+                          &stall_stats)) {
+    return counts;
+  }
+  counts.stalls =
+      StallCount(stall_stats, WriteStallStatsMapKeys::TotalStops()) +
+      StallCount(stall_stats, WriteStallStatsMapKeys::TotalDelays());
+  for (auto condition :
+       {WriteStallCondition::kStopped, WriteStallCondition::kDelayed}) {
+    counts.l0_stalls += StallCount(
+        stall_stats, WriteStallStatsMapKeys::CauseConditionCount(
+                         WriteStallCause::kL0FileCountLimit, condition));
+  }
+  return counts;
+}
+
+class AutoTunerImpl : public AutoTuner {
+ public:
+  explicit AutoTunerImpl(const AutoTunerOptions& options)
+      : options_(options) {}
+
+  void Tune(DB* db, const std::vector<ColumnFamilyHandle*>& cfs) override;
+
+  uint64_t PeriodSec() const override { return options_.period_sec; }
+
+ private:
+  const AutoTunerOptions options_;
+  // The stall counts of each column family as of the last round, by column
+  // family ID
+  std::unordered_map<uint32_t, CFStallCounts> last_stall_counts_;
+  uint64_t last_pending_compaction_bytes_ = 0;
+};
+
+void AutoTunerImpl::Tune(DB* db, const std::vector<ColumnFamilyHandle*>& cfs) {
+  uint64_t value = 0;
+  bool stalled =
+      (db->GetIntProperty(DB::Properties::kIsWriteStopped, &value) &&
+       value > 0) ||
+      (db->GetIntProperty(DB::Properties::kActualDelayedWriteRate, &value) &&
+       value > 0);
+
+  uint64_t pending_compaction_bytes = 0;
+  std::vector<bool> l0_stalled(cfs.size(), false);
+  std::unordered_map<uint32_t, CFStallCounts> stall_counts;
+  for (size_t i = 0; i < cfs.size(); ++i) {
+    if (db->GetIntProperty(
+            cfs[i], DB::Properties::kEstimatePendingCompactionBytes, &value)) {
+      pending_compaction_bytes += value;
+    }
+    const CFStallCounts counts = GetCFStallCounts(db, cfs[i]);
+    auto it = last_stall_counts_.find(cfs[i]->GetID());
+    if (it != last_stall_counts_.end()) {
+      stalled = stalled || counts.stalls > it->second.stalls;
+      l0_stalled[i] = counts.l0_stalls > it->second.l0_stalls;
+    }
+    stall_counts[cfs[i]->GetID()] = counts;
+  }
+  // Forgets the dropped column families
+  last_stall_counts_.swap(stall_counts);
+
+  uint64_t num_running_compactions = 0;
+  db->GetIntProperty(DB::Properties::kNumRunningCompactions,
+                     &num_running_compactions);
+  const bool backlog =
+      pending_compaction_bytes > 0 &&
+      pending_compaction_bytes >= last_pending_compaction_bytes_;
+  last_pending_compaction_bytes_ = pending_compaction_bytes;
+  const bool pressure = stalled || backlog;
+  const bool idle =
+      !stalled && pending_compaction_bytes == 0 && num_running_compactions == 0;
+
+  const DBOptions db_options = db->GetDBOptions();
+  Logger* info_log = db_options.info_log.get();
+  std::unordered_map<std::string, std::string> new_db_options;
+  if (options_.max_background_jobs > 0) {
+    const int jobs = db_options.max_background_jobs;
+    const int tuned = Bound(pressure ? jobs + 1 : (idle ? jobs - 1 : jobs),
+                            options_.min_background_jobs,
+                            options_.max_background_jobs);
+    if (tuned != jobs) {
+      new_db_options["max_background_jobs"] = std::to_string(tuned);
+    }
+  }
+  if (options_.max_compaction_readahead_size > 0) {
+    const size_t readahead = db_options.compaction_readahead_size;
+    const size_t tuned =
+        Bound(backlog ? readahead * 2 : (idle ? readahead / 2 : readahead),
+              options_.min_compaction_readahead_size,
+              options_.max_compaction_readahead_size);
+    if (tuned != readahead) {
+      new_db_options["compaction_readahead_size"] = std::to_string(tuned);
+    }
+  }
+  if (!new_db_options.empty()) {
+    Status s = db->SetDBOptions(new_db_options);
+    if (!s.ok()) {
+      ROCKS_LOG_WARN(info_log, "[AutoTuner] SetDBOptions failed: %s",
+                     s.ToString().c_str());
+    }
+  }
+
+  if (options_.max_rate_limiter_bytes_per_sec > 0 &&
+      db_options.rate_limiter != nullptr) {
+    const int64_t rate = db_options.rate_limiter->GetBytesPerSecond();
+    const int64_t tuned =
+        Bound(pressure ? rate + rate / 4 : (idle ? rate - rate / 10 : rate),
+              options_.min_rate_limiter_bytes_per_sec,
+              options_.max_rate_limiter_bytes_per_sec);
+    if (tuned != rate) {
+      ROCKS_LOG_INFO(info_log,
+                     "[AutoTuner] rate limiter bytes per second: %" PRId64
+                     " -> %" PRId64,
+                     rate, tuned);
+      db_options.rate_limiter->SetBytesPerSecond(tuned);
+    }
+  }
+
+  if (options_.max_level0_slowdown_writes_trigger > 0) {
+    for (size_t i = 0; i < cfs.size(); ++i) {
+      const Options cf_options = db->GetOptions(cfs[i]);
+      const int slowdown = cf_options.level0_slowdown_writes_trigger;
+      int tuned = slowdown;
+      if (l0_stalled[i]) {
+        tuned += std::max(slowdown / 4, 1);
+      } else if (idle) {
+        tuned -= 1;
+      }
+      tuned = Bound(tuned, options_.min_level0_slowdown_writes_trigger,
+                    options_.max_level0_slowdown_writes_trigger);
+      if (tuned == slowdown) {
+        continue;
+      }
+      const int stop =
+          cf_options.level0_stop_writes_trigger + (tuned - slowdown);
+      Status s = db->SetOptions(
+          cfs[i], {{"level0_slowdown_writes_trigger", std::to_string(tuned)},
+                   {"level0_stop_writes_trigger", std::to_string(stop)}});
+      if (!s.ok()) {
+        ROCKS_LOG_WARN(info_log, "[AutoTuner] [%s] SetOptions failed: %s",
+                       cfs[i]->GetName().c_str(), s.ToString().c_str());
+      }
+    }
+  }
+}
+}  // anonymous namespace
+
+std::shared_ptr<AutoTuner> NewAutoTuner(const AutoTunerOptions& options) {
+  return std::make_shared<AutoTunerImpl>(options);
+}
+
+}  // namespace ROCKSDB_NAMESPACE
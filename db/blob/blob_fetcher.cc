@@ -31,4 +31,15 @@ Status BlobFetcher::FetchBlob(const Slice& user_key,
                            blob_value, bytes_read);
 }
 
+void BlobFetcher::FetchBlobs(const std::vector<Slice>& user_keys,
+                             const std::vector<BlobIndex>& blob_indexes,
+                             std::vector<PinnableSlice>* blob_values,
+                             std::vector<Status>* statuses,
+                             uint64_t* bytes_read) const {
+  assert(version_);
+
+  version_->MultiGetBlob(read_options_, user_keys, blob_indexes, blob_values,
+                         statuses, bytes_read);
+}
+
 }  // namespace ROCKSDB_NAMESPACE
@@ -5,6 +5,8 @@
 
 #pragma once
 
+#include <vector>
+
 #include "rocksdb/options.h"
 #include "rocksdb/status.h"
 
@@ -30,6 +32,12 @@ class BlobFetcher {
                    FilePrefetchBuffer* prefetch_buffer,
                    PinnableSlice* blob_value, uint64_t* bytes_read) const;
 
+  // See Version::MultiGetBlob()
+  void FetchBlobs(const std::vector<Slice>& user_keys,
+                  const std::vector<BlobIndex>& blob_indexes,
+                  std::vector<PinnableSlice>* blob_values,
+                  std::vector<Status>* statuses, uint64_t* bytes_read) const;
+
  private:
   const Version* version_;
   ReadOptions read_options_;
@@ -5,7 +5,10 @@
 
 #include "db/blob/blob_source.h"
 
+#include <atomic>
 #include <cassert>
+#include <future>
+#include <memory>
 #include <string>
 
 #include "cache/cache_reservation_manager.h"
@@ -17,9 +20,30 @@
 #include "options/cf_options.h"
 #include "table/get_context.h"
 #include "table/multiget_context.h"
+#include "util/threadpool_imp.h"
 
 namespace ROCKSDB_NAMESPACE {
 
+namespace {
+// Reads the blob files of MultiGetBlob() concurrently, for all the
+// BlobSources of the process, see blob_multiget_threads.
+class MultiGetBlobExecutor {
+ public:
+  static MultiGetBlobExecutor* Get(int num_threads) {
+    static MultiGetBlobExecutor executor;
+    executor.pool_.IncBackgroundThreadsIfNeeded(num_threads);
+    return &executor;
+  }
+
+  ~MultiGetBlobExecutor() { pool_.JoinAllThreads(); }
+
+  void Submit(std::function<void()>&& job) { pool_.SubmitJob(std::move(job)); }
+
+ private:
+  ThreadPoolImpl pool_;
+};
+}  // namespace
+
 BlobSource::BlobSource(const ImmutableOptions* immutable_options,
                        const std::string& db_id,
                        const std::string& db_session_id,
@@ -29,7 +53,8 @@ BlobSource::BlobSource(const ImmutableOptions* immutable_options,
       statistics_(immutable_options->statistics.get()),
       blob_file_cache_(blob_file_cache),
       blob_cache_(immutable_options->blob_cache),
-      lowest_used_cache_tier_(immutable_options->lowest_used_cache_tier) {
+      lowest_used_cache_tier_(immutable_options->lowest_used_cache_tier),
+      multiget_threads_(std::max(immutable_options->blob_multiget_threads, 1)) {
   auto bbto =
       immutable_options->table_factory->GetOptions<BlockBasedTableOptions>();
   if (bbto &&
@@ -261,24 +286,50 @@ void BlobSource::MultiGetBlob(const ReadOptions& read_options,
                               uint64_t* bytes_read) {
   assert(blob_reqs.size() > 0);
 
-  uint64_t total_bytes_read = 0;
-  uint64_t bytes_read_in_file = 0;
-
-  for (auto& [file_number, file_size, blob_reqs_in_file] : blob_reqs) {
-    // sort blob_reqs_in_file by file offset.
-    std::sort(
-        blob_reqs_in_file.begin(), blob_reqs_in_file.end(),
-        [](const BlobReadRequest& lhs, const BlobReadRequest& rhs) -> bool {
-          return lhs.offset < rhs.offset;
-        });
-
-    MultiGetBlobFromOneFile(read_options, file_number, file_size,
-                            blob_reqs_in_file, &bytes_read_in_file);
-
-    total_bytes_read += bytes_read_in_file;
+  std::vector<uint64_t> bytes_read_in_files(blob_reqs.size(), 0);
+  std::atomic<size_t> next_file{0};
+  auto read_files = [&]() {
+    for (size_t i = next_file++; i < blob_reqs.size(); i = next_file++) {
+      auto& [file_number, file_size, blob_reqs_in_file] = blob_reqs[i];
+      // sort blob_reqs_in_file by file offset.
+      std::sort(
+          blob_reqs_in_file.begin(), blob_reqs_in_file.end(),
+          [](const BlobReadRequest& lhs, const BlobReadRequest& rhs) -> bool {
+            return lhs.offset < rhs.offset;
+          });
+
+      MultiGetBlobFromOneFile(read_options, file_number, file_size,
+                              blob_reqs_in_file, &bytes_read_in_files[i]);
+    }
+  };
+
+  // The calling thread reads files too, along with num_workers - 1 threads
+  // of the executor.
+  const size_t num_workers =
+      std::min(blob_reqs.size(), static_cast<size_t>(multiget_threads_));
+  std::vector<std::future<void>> workers_done;
+  if (num_workers > 1) {
+    MultiGetBlobExecutor* executor =
+        MultiGetBlobExecutor::Get(multiget_threads_);
+    for (size_t i = 1; i < num_workers; i++) {
+      auto done = std::make_shared<std::promise<void>>();
+      workers_done.push_back(done->get_future());
+      executor->Submit([read_files, done]() {
+        read_files();
+        done->set_value();
+      });
+    }
+  }
+  read_files();
+  for (auto& done : workers_done) {
+    done.wait();
   }
 
   if (bytes_read) {
+    uint64_t total_bytes_read = 0;
+    for (uint64_t bytes_read_in_file : bytes_read_in_files) {
+      total_bytes_read += bytes_read_in_file;
+    }
     *bytes_read = total_bytes_read;
   }
 }
@@ -65,6 +65,7 @@ class BlobSource {
   // Note:
   //  - The main difference between this function and MultiGetBlobFromOneFile is
   //    that this function can read multiple blobs from multiple blob files.
+  //    Up to blob_multiget_threads of the files are read concurrently.
   //
   //  - For consistency, whether the blob is found in the cache or on disk, sets
   //  "*bytes_read" to the total size of on-disk (possibly compressed) blob
@@ -156,6 +157,9 @@ class BlobSource {
   // isn't strictly speaking a non-volatile tier since the compressed cache in
   // this tier is in volatile memory).
   const CacheTier lowest_used_cache_tier_;
+
+  // The number of blob files MultiGetBlob() reads concurrently.
+  const int multiget_threads_;
 };
 
 }  // namespace ROCKSDB_NAMESPACE
@@ -232,6 +232,63 @@ TEST_F(DBBlobBasicTest, IterateBlobsFromCache) {
   }
 }
 
+TEST_F(DBBlobBasicTest, IterateBlobsWithReadahead) {
+  Options options = GetDefaultOptions();
+  options.enable_blob_files = true;
+  options.min_blob_size = 0;
+
+  Reopen(options);
+
+  constexpr int num_blobs = 16;
+  std::vector<std::string> keys;
+  std::vector<std::string> blobs;
+
+  for (int i = 0; i < num_blobs; ++i) {
+    keys.push_back("key" + std::to_string(i + 10));
+    blobs.push_back("blob" + std::to_string(i) + std::string(100, 'x'));
+    ASSERT_OK(Put(keys[i], blobs[i]));
+  }
+  ASSERT_OK(Flush());
+
+  size_t num_blob_reads = 0;
+  SyncPoint::GetInstance()->SetCallBack(
+      "BlobFileReader::GetBlob:ReadFromFile",
+      [&num_blob_reads](void* /* arg */) { ++num_blob_reads; });
+  SyncPoint::GetInstance()->EnableProcessing();
+
+  ReadOptions read_options;
+  read_options.blob_readahead_size = 1 << 20;
+
+  {
+    std::unique_ptr<Iterator> iter(db_->NewIterator(read_options));
+
+    int i = 0;
+    for (iter->SeekToFirst(); iter->Valid(); iter->Next()) {
+      ASSERT_EQ(iter->key().ToString(), keys[i]);
+      ASSERT_EQ(iter->value().ToString(), blobs[i]);
+      ++i;
+    }
+    ASSERT_OK(iter->status());
+    ASSERT_EQ(i, num_blobs);
+
+    // The values were read with the readahead of the first one
+    ASSERT_EQ(num_blob_reads, 0);
+
+    // Backward iteration reads each value
+    for (iter->SeekToLast(); iter->Valid(); iter->Prev()) {
+      --i;
+      ASSERT_EQ(iter->key().ToString(), keys[i]);
+      ASSERT_EQ(iter->value().ToString(), blobs[i]);
+    }
+    ASSERT_OK(iter->status());
+    ASSERT_EQ(i, 0);
+    ASSERT_EQ(num_blob_reads, num_blobs);
+  }
+
+  SyncPoint::GetInstance()->DisableProcessing();
+  SyncPoint::GetInstance()->ClearAllCallBacks();
+}
+
 TEST_F(DBBlobBasicTest, IterateBlobsFromCachePinning) {
   constexpr size_t min_blob_size = 6;
 
@@ -453,6 +510,46 @@ TEST_F(DBBlobBasicTest, MultiGetBlobs) {
   }
 }
 
+TEST_F(DBBlobBasicTest, MultiGetBlobsFromFilesInParallel) {
+  Options options = GetDefaultOptions();
+  options.enable_blob_files = true;
+  options.min_blob_size = 0;
+  options.disable_auto_compactions = true;
+  options.blob_multiget_threads = 4;
+
+  Reopen(options);
+
+  // Each flush writes a blob file, so the blobs are spread over
+  // kNumFiles files.
+  constexpr size_t kNumFiles = 8;
+  constexpr size_t kKeysPerFile = 4;
+  constexpr size_t kNumKeys = kNumFiles * kKeysPerFile;
+  for (size_t f = 0; f < kNumFiles; ++f) {
+    for (size_t k = 0; k < kKeysPerFile; ++k) {
+      const size_t i = k * kNumFiles + f;
+      ASSERT_OK(Put(Key(static_cast<int>(i)), "blob" + std::to_string(i)));
+    }
+    ASSERT_OK(Flush());
+  }
+
+  std::array<std::string, kNumKeys> key_strs;
+  std::array<Slice, kNumKeys> keys;
+  for (size_t i = 0; i < kNumKeys; ++i) {
+    key_strs[i] = Key(static_cast<int>(i));
+    keys[i] = key_strs[i];
+  }
+  std::array<PinnableSlice, kNumKeys> values;
+  std::array<Status, kNumKeys> statuses;
+
+  db_->MultiGet(ReadOptions(), db_->DefaultColumnFamily(), kNumKeys,
+                keys.data(), values.data(), statuses.data());
+
+  for (size_t i = 0; i < kNumKeys; ++i) {
+    ASSERT_OK(statuses[i]);
+    ASSERT_EQ("blob" + std::to_string(i), values[i]);
+  }
+}
+
 TEST_F(DBBlobBasicTest, MultiGetBlobsFromCache) {
   Options options = GetDefaultOptions();
 
@@ -775,6 +775,76 @@ TEST_F(DBBlobCompactionTest, CompactionReadaheadGarbageCollection) {
   Close();
 }
 
+TEST_F(DBBlobCompactionTest, CompactionReadBatchGarbageCollection) {
+  Options options = GetDefaultOptions();
+  options.enable_blob_files = true;
+  options.min_blob_size = 0;
+  options.enable_blob_garbage_collection = true;
+  options.blob_garbage_collection_age_cutoff = 1.0;
+  options.blob_compaction_read_batch_size = 16;
+  options.disable_auto_compactions = true;
+
+  Reopen(options);
+
+  ASSERT_OK(Put("key", "lime"));
+  ASSERT_OK(Put("foo", "bar"));
+  ASSERT_OK(Flush());
+
+  ASSERT_OK(Put("key", "pie"));
+  ASSERT_OK(Put("foo", "baz"));
+  ASSERT_OK(Flush());
+
+  size_t num_single_reads = 0;
+  size_t num_multi_reads = 0;
+  size_t num_blobs_fetched = 0;
+  SyncPoint::GetInstance()->SetCallBack(
+      "BlobFileReader::GetBlob:ReadFromFile",
+      [&num_single_reads](void* /* arg */) { ++num_single_reads; });
+  SyncPoint::GetInstance()->SetCallBack(
+      "BlobFileReader::MultiGetBlob:ReadFromFile",
+      [&num_multi_reads](void* /* arg */) { ++num_multi_reads; });
+  SyncPoint::GetInstance()->SetCallBack(
+      "BlobPrefetchIterator::FetchBlobs", [&num_blobs_fetched](void* arg) {
+        num_blobs_fetched += static_cast<std::vector<BlobIndex>*>(arg)->size();
+      });
+  SyncPoint::GetInstance()->EnableProcessing();
+
+  constexpr Slice* begin = nullptr;
+  constexpr Slice* end = nullptr;
+
+  ASSERT_OK(db_->CompactRange(CompactRangeOptions(), begin, end));
+
+  SyncPoint::GetInstance()->DisableProcessing();
+  SyncPoint::GetInstance()->ClearAllCallBacks();
+
+  // Only the newest versions are read, together
+  ASSERT_EQ(num_single_reads, 0);
+  ASSERT_EQ(num_multi_reads, 1);
+  ASSERT_EQ(num_blobs_fetched, 2);
+
+  ASSERT_EQ(Get("key"), "pie");
+  ASSERT_EQ(Get("foo"), "baz");
+
+  VersionSet* const versions = dbfull()->GetVersionSet();
+  assert(versions);
+  assert(versions->GetColumnFamilySet());
+
+  ColumnFamilyData* const cfd = versions->GetColumnFamilySet()->GetDefault();
+  assert(cfd);
+
+  Version* const current = cfd->current();
+  assert(current);
+
+  const VersionStorageInfo* const storage_info = current->storage_info();
+  assert(storage_info);
+
+  // Both blobs were relocated into a new blob file
+  const auto& blob_files = storage_info->GetBlobFiles();
+  ASSERT_EQ(blob_files.size(), 1);
+
+  Close();
+}
+
 TEST_F(DBBlobCompactionTest, CompactionReadaheadFilter) {
   Options options = GetDefaultOptions();
 
@@ -259,6 +259,10 @@ struct rocksdb_perfcontext_t {
 struct rocksdb_pinnableslice_t {
   PinnableSlice rep;
 };
+struct rocksdb_pinnableslices_t {
+  std::vector<PinnableSlice> rep;
+  std::vector<Status> statuses;
+};
 struct rocksdb_transactiondb_options_t {
   TransactionDBOptions rep;
 };
@@ -6660,6 +6664,117 @@ rocksdb_pinnableslice_t* rocksdb_get_pinned_cf(
 
 void rocksdb_pinnableslice_destroy(rocksdb_pinnableslice_t* v) { delete v; }
 
+rocksdb_pinnableslice_t* rocksdb_pinnableslice_create(void) {
+  return new rocksdb_pinnableslice_t;
+}
+
+void rocksdb_pinnableslice_reset(rocksdb_pinnableslice_t* v) { v->rep.Reset(); }
+
+unsigned char rocksdb_get_pinned_into(rocksdb_t* db,
+                                      const rocksdb_readoptions_t* options,
+                                      const char* key, size_t keylen,
+                                      rocksdb_pinnableslice_t* value,
+                                      char** errptr) {
+  return rocksdb_get_pinned_into_cf(db, options, nullptr, key, keylen, value,
+                                    errptr);
+}
+
+unsigned char rocksdb_get_pinned_into_cf(
+    rocksdb_t* db, const rocksdb_readoptions_t* options,
+    rocksdb_column_family_handle_t* column_family, const char* key,
+    size_t keylen, rocksdb_pinnableslice_t* value, char** errptr) {
+  value->rep.Reset();
+  Status s = db->rep->Get(options->rep,
+                          column_family ? column_family->rep
+                                        : db->rep->DefaultColumnFamily(),
+                          Slice(key, keylen), &value->rep);
+  if (!s.ok()) {
+    value->rep.Reset();
+    if (!s.IsNotFound()) {
+      SaveError(errptr, s);
+    }
+    return 0;
+  }
+  return 1;
+}
+
+static rocksdb_pinnableslices_t* MultiGetPinned(
+    rocksdb_t* db, const rocksdb_readoptions_t* options,
+    const rocksdb_column_family_handle_t* const* column_families,
+    size_t num_keys, const char* const* keys_list,
+    const size_t* keys_list_sizes, char** errs, unsigned char sorted_input) {
+  std::vector<Slice> keys(num_keys);
+  for (size_t i = 0; i < num_keys; ++i) {
+    keys[i] = Slice(keys_list[i], keys_list_sizes[i]);
+  }
+  rocksdb_pinnableslices_t* result = new rocksdb_pinnableslices_t;
+  result->rep.resize(num_keys);
+  result->statuses.resize(num_keys);
+  if (column_families == nullptr) {
+    db->rep->MultiGet(options->rep, db->rep->DefaultColumnFamily(), num_keys,
+                      keys.data(), result->rep.data(),
+                      result->statuses.data(), sorted_input);
+  } else {
+    std::vector<ColumnFamilyHandle*> cfs(num_keys);
+    for (size_t i = 0; i < num_keys; ++i) {
+      cfs[i] = column_families[i]->rep;
+    }
+    db->rep->MultiGet(options->rep, num_keys, cfs.data(), keys.data(),
+                      result->rep.data(), result->statuses.data(),
+                      sorted_input);
+  }
+  for (size_t i = 0; i < num_keys; ++i) {
+    const Status& s = result->statuses[i];
+    if (!s.ok()) {
+      result->rep[i].Reset();
+    }
+    if (s.ok() || s.IsNotFound()) {
+      errs[i] = nullptr;
+    } else {
+      errs[i] = strdup(s.ToString().c_str());
+    }
+  }
+  return result;
+}
+
+rocksdb_pinnableslices_t* rocksdb_multi_get_pinned(
+    rocksdb_t* db, const rocksdb_readoptions_t* options, size_t num_keys,
+    const char* const* keys_list, const size_t* keys_list_sizes, char** errs,
+    unsigned char sorted_input) {
+  return MultiGetPinned(db, options, nullptr, num_keys, keys_list,
+                        keys_list_sizes, errs, sorted_input);
+}
+
+rocksdb_pinnableslices_t* rocksdb_multi_get_pinned_cf(
+    rocksdb_t* db, const rocksdb_readoptions_t* options,
+    const rocksdb_column_family_handle_t* const* column_families,
+    size_t num_keys, const char* const* keys_list,
+    const size_t* keys_list_sizes, char** errs, unsigned char sorted_input) {
+  return MultiGetPinned(db, options, column_families, num_keys, keys_list,
+                        keys_list_sizes, errs, sorted_input);
+}
+
+size_t rocksdb_pinnableslices_count(const rocksdb_pinnableslices_t* v) {
+  return v->rep.size();
+}
+
+const char* rocksdb_pinnableslices_value(const rocksdb_pinnableslices_t* v,
+                                         size_t index, size_t* vlen) {
+  if (!v->statuses[index].ok()) {
+    *vlen = 0;
+    return nullptr;
+  }
+  *vlen = v->rep[index].size();
+  return v->rep[index].data();
+}
+
+void rocksdb_pinnableslices_reset(rocksdb_pinnableslices_t* v, size_t index) {
+  v->rep[index].Reset();
+  v->statuses[index] = Status::NotFound();
+}
+
+void rocksdb_pinnableslices_destroy(rocksdb_pinnableslices_t* v) { delete v; }
+
 const char* rocksdb_pinnableslice_value(const rocksdb_pinnableslice_t* v,
                                         size_t* vlen) {
   if (!v) {
@@ -1640,6 +1640,44 @@ int main(int argc, char** argv) {
       }
     }
 
+    {
+      const char* pinned_keys[4] = {"box", "buff", "barfooxx", "box"};
+      const size_t pinned_keys_sizes[4] = {3, 4, 8, 3};
+      const rocksdb_column_family_handle_t* pinned_handles[4] = {
+          handles[1], handles[1], handles[1], handles[0]};
+      const char* expected_value[4] = {"c", "rocksdb", NULL, NULL};
+      char* pinned_errs[4];
+      rocksdb_pinnableslices_t* pinned = rocksdb_multi_get_pinned_cf(
+          db, roptions, pinned_handles, 4, pinned_keys, pinned_keys_sizes,
+          pinned_errs, 0);
+      CheckCondition(rocksdb_pinnableslices_count(pinned) == 4);
+      const char* val;
+      size_t val_len;
+      for (i = 0; i < 4; ++i) {
+        CheckNoError(pinned_errs[i]);
+        val = rocksdb_pinnableslices_value(pinned, i, &val_len);
+        CheckEqual(expected_value[i], val, val_len);
+      }
+      rocksdb_pinnableslices_reset(pinned, 0);
+      val = rocksdb_pinnableslices_value(pinned, 0, &val_len);
+      CheckEqual(NULL, val, val_len);
+      rocksdb_pinnableslices_destroy(pinned);
+
+      rocksdb_pinnableslice_t* pval = rocksdb_pinnableslice_create();
+      CheckCondition(rocksdb_get_pinned_into_cf(db, roptions, handles[1],
+                                                "buff", 4, pval, &err));
+      CheckNoError(err);
+      val = rocksdb_pinnableslice_value(pval, &val_len);
+      CheckEqual("rocksdb", val, val_len);
+      CheckCondition(!rocksdb_get_pinned_into_cf(db, roptions, handles[1],
+                                                 "barfooxx", 8, pval, &err));
+      CheckNoError(err);
+      val = rocksdb_pinnableslice_value(pval, &val_len);
+      CheckCondition(val_len == 0);
+      rocksdb_pinnableslice_reset(pval);
+      rocksdb_pinnableslice_destroy(pval);
+    }
+
     {
       unsigned char value_found = 0;
 
@@ -161,10 +161,11 @@ Status CheckCompressionSupported(const ColumnFamilyOptions& cf_options) {
 }
 
 Status CheckConcurrentWritesSupported(const ColumnFamilyOptions& cf_options) {
-  if (cf_options.inplace_update_support) {
+  if (cf_options.inplace_update_support &&
+      cf_options.inplace_callback != nullptr) {
     return Status::InvalidArgument(
-        "In-place memtable updates (inplace_update_support) is not compatible "
-        "with concurrent writes (allow_concurrent_memtable_write)");
+        "In-place memtable update callbacks (inplace_callback) are not "
+        "compatible with concurrent writes (allow_concurrent_memtable_write)");
   }
   if (!cf_options.memtable_factory->IsInsertConcurrentlySupported()) {
     return Status::InvalidArgument(
@@ -596,6 +597,7 @@ ColumnFamilyData::ColumnFamilyData(
                           internal_stats_->GetBlobFileReadHist(), io_tracer));
     blob_source_.reset(new BlobSource(ioptions(), db_id, db_session_id,
                                       blob_file_cache_.get()));
+    compression_dict_manager_.reset(new CompressionDictManager(ioptions_.env));
 
     if (ioptions_.compaction_style == kCompactionStyleLevel) {
       compaction_picker_.reset(
@@ -904,6 +906,78 @@ uint64_t GetPendingCompactionBytesForCompactionSpeedup(
   return std::min(size_threshold, slowdown_threshold);
 }
 
+// How far value is from start to stop, clamped to [0, 1].
+double StallProgress(double value, double start, double stop) {
+  if (value <= start || stop <= start) {
+    return 0;
+  }
+  return std::min(1.0, (value - start) / (stop - start));
+}
+
+// Returns how close the column family is to a write stop, from 0 to 1, for
+// smooth_write_stall: the furthest of the unflushed memtables, the L0 files
+// and the pending compaction bytes along the way from where compactions are
+// sped up to where writes stop.
+double GetWriteStallPressure(int num_unflushed_memtables, int num_l0_files,
+                             uint64_t compaction_needed_bytes,
+                             uint64_t prev_compaction_needed_bytes,
+                             int min_write_buffer_number_to_merge,
+                             const MutableCFOptions& mutable_cf_options) {
+  double pressure = 0;
+  // One unflushed memtable, or as many as are merged into a flush, is the
+  // normal state.
+  if (!mutable_cf_options.disable_auto_flush &&
+      mutable_cf_options.max_write_buffer_number > 2) {
+    pressure = std::max(
+        pressure,
+        StallProgress(num_unflushed_memtables,
+                      std::max(1, min_write_buffer_number_to_merge),
+                      mutable_cf_options.max_write_buffer_number));
+  }
+  if (mutable_cf_options.level0_slowdown_writes_trigger >= 0) {
+    pressure = std::max(
+        pressure, StallProgress(
+                      num_l0_files,
+                      GetL0FileCountForCompactionSpeedup(
+                          mutable_cf_options.level0_file_num_compaction_trigger,
+                          mutable_cf_options.level0_slowdown_writes_trigger),
+                      mutable_cf_options.level0_stop_writes_trigger));
+  }
+  const uint64_t soft_limit =
+      mutable_cf_options.soft_pending_compaction_bytes_limit;
+  uint64_t hard_limit = mutable_cf_options.hard_pending_compaction_bytes_limit;
+  if (hard_limit == 0) {
+    hard_limit = soft_limit * 4;
+  }
+  if (soft_limit > 0 || hard_limit > 0) {
+    // Take the debt where it is headed rather than where it is, so that writes
+    // slow down before it gets there.
+    uint64_t predicted_bytes = compaction_needed_bytes;
+    if (prev_compaction_needed_bytes > 0 &&
+        compaction_needed_bytes > prev_compaction_needed_bytes) {
+      predicted_bytes += compaction_needed_bytes - prev_compaction_needed_bytes;
+    }
+    pressure = std::max(
+        pressure,
+        StallProgress(static_cast<double>(predicted_bytes),
+                      static_cast<double>(soft_limit / 4),
+                      static_cast<double>(hard_limit)));
+  }
+  return pressure;
+}
+
+std::unique_ptr<WriteControllerToken> SetupSmoothDelay(
+    WriteController* write_controller, double pressure) {
+  const uint64_t kMinWriteRate = 16 * 1024u;  // Minimum write rate 16KB/s.
+  const uint64_t max_write_rate = write_controller->max_delayed_write_rate();
+  uint64_t write_rate = static_cast<uint64_t>(
+      static_cast<double>(max_write_rate) * (1.0 - pressure));
+  if (write_rate < kMinWriteRate) {
+    write_rate = std::min(kMinWriteRate, max_write_rate);
+  }
+  return write_controller->GetRateDelayToken(write_rate);
+}
+
 uint64_t GetMarkedFileCountForCompactionSpeedup() {
   // When just one file is marked, it is not clear that parallel compaction will
   // help the compaction that the user nicely requested to happen sooner. When
@@ -992,8 +1066,31 @@ WriteStallCondition ColumnFamilyData::RecalculateWriteStallConditions(
     bool was_stopped = write_controller->IsStopped();
     bool needed_delay = write_controller->NeedsDelay();
 
-    if (write_stall_condition == WriteStallCondition::kStopped &&
-        write_stall_cause == WriteStallCause::kMemtableLimit) {
+    double stall_pressure = 0;
+    if (mutable_cf_options.smooth_write_stall &&
+        !mutable_cf_options_.disable_write_stall &&
+        !mutable_cf_options.disable_auto_compactions &&
+        write_stall_condition != WriteStallCondition::kStopped) {
+      stall_pressure = GetWriteStallPressure(
+          imm()->NumNotFlushed(), vstorage->l0_delay_trigger_count(),
+          compaction_needed_bytes, prev_compaction_needed_bytes_,
+          ioptions_.min_write_buffer_number_to_merge, mutable_cf_options);
+    }
+
+    if (stall_pressure > 0) {
+      write_controller_token_ =
+          SetupSmoothDelay(write_controller, stall_pressure);
+      write_stall_condition = WriteStallCondition::kDelayed;
+      ROCKS_LOG_INFO(
+          ioptions_.logger,
+          "[%s] Slowing down writes with %d immutable memtables, %d level-0 "
+          "files and estimated pending compaction bytes %" PRIu64
+          ", pressure %.2f rate %" PRIu64,
+          name_.c_str(), imm()->NumNotFlushed(),
+          vstorage->l0_delay_trigger_count(), compaction_needed_bytes,
+          stall_pressure, write_controller->delayed_write_rate());
+    } else if (write_stall_condition == WriteStallCondition::kStopped &&
+               write_stall_cause == WriteStallCause::kMemtableLimit) {
       write_controller_token_ = write_controller->GetStopToken();
       internal_stats_->AddCFStats(InternalStats::MEMTABLE_LIMIT_STOPS, 1);
       ROCKS_LOG_WARN(
@@ -1171,10 +1268,17 @@ uint64_t ColumnFamilyData::GetLiveSstFilesSize(bool include_bottommost) const {
   return current_->GetSstFilesSize(include_bottommost);
 }
 
+const std::shared_ptr<WriteBufferManager::Tenant>&
+ColumnFamilyData::write_buffer_mgr_tenant() const {
+  return column_family_set_->write_buffer_manager_tenant_;
+}
+
 MemTable* ColumnFamilyData::ConstructNewMemtable(
     const MutableCFOptions& mutable_cf_options, SequenceNumber earliest_seq) {
-  return new MemTable(internal_comparator_, ioptions_, mutable_cf_options,
-                      write_buffer_manager_, earliest_seq, id_);
+  auto* mem = new MemTable(internal_comparator_, ioptions_, mutable_cf_options,
+                           write_buffer_manager_, earliest_seq, id_);
+  mem->SetWriteBufferManagerTenant(write_buffer_mgr_tenant());
+  return mem;
 }
 
 void ColumnFamilyData::CreateNewMemtable(
@@ -1472,6 +1576,11 @@ Status ColumnFamilyData::ValidateOptions(
     s = Status::InvalidArgument(
         "max_successive_merges > 0 is incompatible with unordered_write");
   }
+  if (s.ok() && db_options.unordered_write &&
+      cf_options.inplace_update_support) {
+    s = Status::InvalidArgument(
+        "inplace_update_support is incompatible with unordered_write");
+  }
   if (s.ok()) {
     s = CheckCFPathsSupported(db_options, cf_options);
   }
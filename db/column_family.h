@@ -25,6 +25,7 @@
 #include "rocksdb/db.h"
 #include "rocksdb/env.h"
 #include "rocksdb/options.h"
+#include "table/compression_dict_manager.h"
 #include "trace_replay/block_cache_tracer.h"
 #include "util/cast_util.h"
 #include "util/hash_containers.h"
@@ -398,6 +399,9 @@ class ColumnFamilyData {
                          SequenceNumber earliest_seq);
 
   TableCache* table_cache() const { return table_cache_.get(); }
+  CompressionDictManager* compression_dict_manager() const {
+    return compression_dict_manager_.get();
+  }
   BlobSource* blob_source() const { return blob_source_.get(); }
 
   // See documentation in compaction_picker.h
@@ -540,6 +544,10 @@ class ColumnFamilyData {
 
   ThreadLocalPtr* TEST_GetLocalSV() { return local_sv_.get(); }
   WriteBufferManager* write_buffer_mgr() { return write_buffer_manager_; }
+  // The tenant that the memtables of this family are charged to in the
+  // WriteBufferManager, null if the DB has no weight.
+  const std::shared_ptr<WriteBufferManager::Tenant>& write_buffer_mgr_tenant()
+      const;
   std::shared_ptr<CacheReservationManager>
   GetFileMetadataCacheReservationManager() {
     return file_metadata_cache_res_mgr_;
@@ -608,6 +616,8 @@ class ColumnFamilyData {
 
   std::unique_ptr<InternalStats> internal_stats_;
 
+  std::unique_ptr<CompressionDictManager> compression_dict_manager_;
+
   WriteBufferManager* write_buffer_manager_;
 
   MemTable* mem_;
@@ -752,6 +762,12 @@ class ColumnFamilySet {
 
   WriteBufferManager* write_buffer_manager() { return write_buffer_manager_; }
 
+  // Must be set before the first memtable is created.
+  void set_write_buffer_manager_tenant(
+      std::shared_ptr<WriteBufferManager::Tenant> tenant) {
+    write_buffer_manager_tenant_ = std::move(tenant);
+  }
+
   WriteController* write_controller() { return write_controller_; }
 
  private:
@@ -793,6 +809,7 @@ class ColumnFamilySet {
   const ImmutableDBOptions* const db_options_;
   Cache* table_cache_;
   WriteBufferManager* write_buffer_manager_;
+  std::shared_ptr<WriteBufferManager::Tenant> write_buffer_manager_tenant_;
   WriteController* write_controller_;
   BlockCacheTracer* const block_cache_tracer_;
   std::shared_ptr<IOTracer> io_tracer_;
@@ -0,0 +1,138 @@
+//  Copyright (c) Meta Platforms, Inc. and affiliates.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+
+#include "db/compaction/blob_prefetch_iterator.h"
+
+#include "db/dbformat.h"
+#include "test_util/sync_point.h"
+
+namespace ROCKSDB_NAMESPACE {
+
+BlobPrefetchIterator::BlobPrefetchIterator(
+    InternalIterator* iter, const Comparator* ucmp,
+    std::unique_ptr<BlobFetcher>&& blob_fetcher, uint64_t cutoff_file_number,
+    size_t batch_size)
+    : iter_(iter),
+      ucmp_(ucmp),
+      blob_fetcher_(std::move(blob_fetcher)),
+      cutoff_file_number_(cutoff_file_number),
+      batch_size_(batch_size) {
+  assert(iter_);
+  assert(blob_fetcher_);
+  assert(batch_size_ > 0);
+  Fill();
+}
+
+BlobPrefetchIterator::~BlobPrefetchIterator() { DropBlobs(); }
+
+void BlobPrefetchIterator::Next() {
+  assert(Valid());
+  if (++pos_ == num_entries_) {
+    Fill();
+  }
+}
+
+void BlobPrefetchIterator::Seek(const Slice& target) {
+  // The entries from `target` start with a new user key, see
+  // CompactionIterator::SkipUntil()
+  has_prev_user_key_ = false;
+  iter_->Seek(target);
+  Fill();
+}
+
+bool BlobPrefetchIterator::GetBlob(const BlobIndex& blob_index,
+                                   PinnableSlice* blob_value, Status* s,
+                                   uint64_t* bytes_read) {
+  for (size_t i = next_blob_; i < blob_indexes_.size(); i++) {
+    if (blob_indexes_[i].file_number() != blob_index.file_number() ||
+        blob_indexes_[i].offset() != blob_index.offset()) {
+      continue;
+    }
+    if (!fetched_) {
+      FetchBlobs();
+    }
+    next_blob_ = i + 1;
+    *blob_value = std::move(blob_values_[i]);
+    *s = std::move(statuses_[i]);
+    *bytes_read = bytes_read_;
+    bytes_read_ = 0;
+    return true;
+  }
+  return false;
+}
+
+void BlobPrefetchIterator::Fill() {
+  num_entries_ = 0;
+  pos_ = 0;
+  DropBlobs();
+  while (num_entries_ < batch_size_ &&
+         blob_indexes_.size() < kMaxBlobsPerBatch && iter_->Valid()) {
+    if (num_entries_ == entries_.size()) {
+      entries_.emplace_back();
+    }
+    Entry& entry = entries_[num_entries_];
+    const Slice key = iter_->key();
+    const Slice value = iter_->value();
+    entry.key.assign(key.data(), key.size());
+    entry.value.assign(value.data(), value.size());
+    entry.is_range_del = iter_->IsDeleteRangeSentinelKey();
+
+    // Same as FilterBatchIterator: only the first version of a user key is
+    // likely to be relocated, the others are usually dropped
+    if (!entry.is_range_del) {
+      ParsedInternalKey ikey;
+      if (!ParseInternalKey(key, &ikey, /*log_err_key=*/false).ok()) {
+        has_prev_user_key_ = false;
+      } else if (!has_prev_user_key_ ||
+                 !ucmp_->Equal(ikey.user_key, prev_user_key_)) {
+        prev_user_key_.assign(ikey.user_key.data(), ikey.user_key.size());
+        has_prev_user_key_ = true;
+        BlobIndex blob_index;
+        // A corrupt blob index is reported by CompactionIterator
+        if (ikey.type == kTypeBlobIndex &&
+            blob_index.DecodeFrom(entry.value).ok() &&
+            !blob_index.IsInlined() && !blob_index.HasTTL() &&
+            blob_index.file_number() < cutoff_file_number_) {
+          blob_indexes_.push_back(blob_index);
+          candidates_.push_back(num_entries_);
+        }
+      }
+    }
+    ++num_entries_;
+    iter_->Next();
+  }
+}
+
+void BlobPrefetchIterator::DropBlobs() {
+  // The reads of the blobs not returned are ignored, as their entries were
+  // dropped or are read again with BlobFetcher::FetchBlob()
+  for (auto& s : statuses_) {
+    s.PermitUncheckedError();
+  }
+  blob_indexes_.clear();
+  candidates_.clear();
+  fetched_ = false;
+  next_blob_ = 0;
+}
+
+void BlobPrefetchIterator::FetchBlobs() {
+  assert(!fetched_);
+  fetched_ = true;
+  const size_t n = blob_indexes_.size();
+  // The user keys point into entries_, which does not grow until the next
+  // batch
+  user_keys_.resize(n);
+  for (size_t i = 0; i < n; i++) {
+    user_keys_[i] = ExtractUserKey(entries_[candidates_[i]].key);
+  }
+  blob_values_.resize(n);
+  statuses_.assign(n, Status::OK());
+  bytes_read_ = 0;
+  TEST_SYNC_POINT_CALLBACK("BlobPrefetchIterator::FetchBlobs", &blob_indexes_);
+  blob_fetcher_->FetchBlobs(user_keys_, blob_indexes_, &blob_values_,
+                            &statuses_, &bytes_read_);
+}
+
+}  // namespace ROCKSDB_NAMESPACE
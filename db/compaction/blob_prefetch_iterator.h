@@ -0,0 +1,115 @@
+//  Copyright (c) Meta Platforms, Inc. and affiliates.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+
+#pragma once
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "db/blob/blob_fetcher.h"
+#include "db/blob/blob_index.h"
+#include "rocksdb/comparator.h"
+#include "table/internal_iterator.h"
+
+namespace ROCKSDB_NAMESPACE {
+
+// An internal iterator that reads ahead the input of a CompactionIterator in
+// batches of up to `batch_size` entries, and fetches the blobs garbage
+// collection relocates for the newest version of each user key with one
+// BlobFetcher::FetchBlobs() call: those of the kTypeBlobIndex entries
+// referencing a blob file older than `cutoff_file_number`. The entries are
+// copied, so keys and values are never pinned.
+//
+// The blobs of a batch are fetched on the first GetBlob() call for one of
+// them, so a batch whose entries are all dropped reads nothing. Seek() drops
+// the batch.
+class BlobPrefetchIterator : public InternalIterator {
+ public:
+  // The cache lookups of BlobSource::MultiGetBlob() are tracked with a 64-bit
+  // mask.
+  static constexpr size_t kMaxBlobsPerBatch = 64;
+
+  // REQUIRES: `iter` is positioned, and batch_size > 0
+  BlobPrefetchIterator(InternalIterator* iter, const Comparator* ucmp,
+                       std::unique_ptr<BlobFetcher>&& blob_fetcher,
+                       uint64_t cutoff_file_number, size_t batch_size);
+  ~BlobPrefetchIterator() override;
+
+  bool Valid() const override { return pos_ < num_entries_; }
+  Status status() const override {
+    return Valid() ? Status::OK() : iter_->status();
+  }
+  void Next() override;
+  void Seek(const Slice& target) override;
+  Slice key() const override {
+    assert(Valid());
+    return entries_[pos_].key;
+  }
+  Slice value() const override {
+    assert(Valid());
+    return entries_[pos_].value;
+  }
+  bool IsDeleteRangeSentinelKey() const override {
+    assert(Valid());
+    return entries_[pos_].is_range_del;
+  }
+
+  // Unused InternalIterator methods
+  void SeekToFirst() override { assert(false); }
+  void Prev() override { assert(false); }
+  void SeekForPrev(const Slice& /* target */) override { assert(false); }
+  void SeekToLast() override { assert(false); }
+
+  // If the blob of `blob_index` was read ahead with the current batch, moves
+  // it into `blob_value`, sets `*s` to the status of its read and returns
+  // true. The bytes read by the batch are reported in `*bytes_read` of the
+  // first blob returned, and 0 for the others. Blobs are returned in the
+  // order of the input.
+  bool GetBlob(const BlobIndex& blob_index, PinnableSlice* blob_value,
+               Status* s, uint64_t* bytes_read);
+
+ private:
+  struct Entry {
+    std::string key;
+    std::string value;
+    bool is_range_del = false;
+  };
+
+  // Reads the next entries of iter_
+  void Fill();
+  void DropBlobs();
+  void FetchBlobs();
+
+  InternalIterator* const iter_;
+  const Comparator* const ucmp_;
+  const std::unique_ptr<BlobFetcher> blob_fetcher_;
+  const uint64_t cutoff_file_number_;
+  const size_t batch_size_;
+
+  // The first num_entries_ are the buffered entries. The strings of the
+  // others are kept to reuse their memory.
+  std::vector<Entry> entries_;
+  size_t num_entries_ = 0;
+  size_t pos_ = 0;
+
+  // The blobs to read ahead, and the indexes in entries_ of their entries
+  std::vector<BlobIndex> blob_indexes_;
+  std::vector<size_t> candidates_;
+  bool fetched_ = false;
+  std::vector<Slice> user_keys_;
+  std::vector<PinnableSlice> blob_values_;
+  std::vector<Status> statuses_;
+  uint64_t bytes_read_ = 0;
+  // The first blob GetBlob() may still return
+  size_t next_blob_ = 0;
+
+  // The user key of the last entry read, to find the first version of each
+  // user key across batches
+  std::string prev_user_key_;
+  bool has_prev_user_key_ = false;
+};
+
+}  // namespace ROCKSDB_NAMESPACE
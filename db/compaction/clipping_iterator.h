@@ -193,6 +193,25 @@ class ClippingIterator : public InternalIterator {
     return iter_->IsDeleteRangeSentinelKey();
   }
 
+  bool IsAtDataBlockStart(Slice* block_upper_bound) override {
+    assert(valid_);
+    if (!iter_->IsAtDataBlockStart(block_upper_bound)) {
+      return false;
+    }
+    if (!end_) {
+      return true;
+    }
+    // The block must end before end_. Sequence number 0 and kTypeDeletion,
+    // the smallest type, make the largest internal key of the user key.
+    const InternalKey block_largest(*block_upper_bound, 0, kTypeDeletion);
+    return cmp_->Compare(block_largest.Encode(), *end_) < 0;
+  }
+
+  Status GetRawDataBlock(RawDataBlock* block) override {
+    assert(valid_);
+    return iter_->GetRawDataBlock(block);
+  }
+
  private:
   void UpdateValid() {
     assert(!iter_->Valid() || iter_->status().ok());
@@ -876,6 +876,13 @@ bool Compaction::ShouldFormSubcompactions() const {
   }
 
   if (cfd_->ioptions()->compaction_style == kCompactionStyleLevel) {
+    if (start_level_ == 0 && output_level_ == 0) {
+      // The subcompactions of an L0->L0 compaction output non-overlapping
+      // files of the same epoch number, which is only allowed when all the
+      // files have one.
+      return input_vstorage_->GetEpochNumberRequirement() ==
+             EpochNumberRequirement::kMustPresent;
+    }
     return (start_level_ == 0 || is_manual_compaction_) && output_level_ > 0;
   } else if (cfd_->ioptions()->compaction_style == kCompactionStyleUniversal) {
     return number_levels_ > 1 && output_level_ > 0;
@@ -0,0 +1,58 @@
+//  Copyright (c) Meta Platforms, Inc. and affiliates.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+
+#include "rocksdb/compaction_cost_model.h"
+
+#include <algorithm>
+
+namespace ROCKSDB_NAMESPACE {
+
+namespace {
+class CloudCompactionCostModel : public CompactionCostModel {
+ public:
+  explicit CloudCompactionCostModel(
+      const CloudCompactionCostModelOptions& options)
+      : options_(options) {}
+
+  const char* Name() const override { return "CloudCompactionCostModel"; }
+
+  double FileCost(const FileCandidate& file) const override {
+    const uint64_t input_bytes = file.file_size + file.overlapping_bytes;
+    const uint64_t target_file_size =
+        std::max(file.target_file_size, uint64_t{1});
+    const uint64_t num_outputs =
+        std::max((input_bytes + target_file_size - 1) / target_file_size,
+                 uint64_t{1});
+    const uint64_t num_inputs = file.num_overlapping_files + 1;
+
+    double cost = static_cast<double>(num_outputs) * options_.put_request_cost;
+    if (options_.get_request_size > 0) {
+      const uint64_t num_gets =
+          (input_bytes + options_.get_request_size - 1) /
+              options_.get_request_size +
+          num_inputs;
+      cost += static_cast<double>(num_gets) * options_.get_request_cost;
+    }
+    cost += static_cast<double>(num_inputs) * options_.delete_request_cost;
+    cost += static_cast<double>(input_bytes) * options_.upload_cost_per_byte;
+    cost += static_cast<double>(input_bytes) *
+            options_.storage_cost_per_byte_second *
+            static_cast<double>(options_.file_deletion_delay_seconds);
+    return cost /
+           static_cast<double>(std::max(file.compensated_file_size,
+                                        uint64_t{1}));
+  }
+
+ private:
+  const CloudCompactionCostModelOptions options_;
+};
+}  // anonymous namespace
+
+std::shared_ptr<CompactionCostModel> NewCloudCompactionCostModel(
+    const CloudCompactionCostModelOptions& options) {
+  return std::make_shared<CloudCompactionCostModel>(options);
+}
+
+}  // namespace ROCKSDB_NAMESPACE
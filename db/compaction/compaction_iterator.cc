@@ -12,10 +12,13 @@
 #include "db/blob/blob_file_builder.h"
 #include "db/blob/blob_index.h"
 #include "db/blob/prefetch_buffer_collection.h"
+#include "db/compaction/blob_prefetch_iterator.h"
+#include "db/compaction/filter_batch_iterator.h"
 #include "db/snapshot_checker.h"
 #include "db/wide/wide_column_serialization.h"
 #include "db/wide/wide_columns_helper.h"
 #include "logging/logging.h"
+#include "monitoring/perf_context_imp.h"
 #include "port/likely.h"
 #include "rocksdb/listener.h"
 #include "table/internal_iterator.h"
@@ -24,7 +27,7 @@
 namespace ROCKSDB_NAMESPACE {
 CompactionIterator::CompactionIterator(
     InternalIterator* input, const Comparator* cmp, MergeHelper* merge_helper,
-    SequenceNumber last_sequence, std::vector<SequenceNumber>* snapshots,
+    SequenceNumber last_sequence, const std::vector<SequenceNumber>* snapshots,
     SequenceNumber earliest_write_conflict_snapshot,
     SequenceNumber job_snapshot, const SnapshotChecker* snapshot_checker,
     Env* env, bool report_detailed_time, bool expect_valid_internal_key,
@@ -53,7 +56,8 @@ CompactionIterator::CompactionIterator(
 
 CompactionIterator::CompactionIterator(
     InternalIterator* input, const Comparator* cmp, MergeHelper* merge_helper,
-    SequenceNumber /*last_sequence*/, std::vector<SequenceNumber>* snapshots,
+    SequenceNumber /*last_sequence*/,
+    const std::vector<SequenceNumber>* snapshots,
     SequenceNumber earliest_write_conflict_snapshot,
     SequenceNumber job_snapshot, const SnapshotChecker* snapshot_checker,
     Env* env, bool report_detailed_time, bool expect_valid_internal_key,
@@ -68,7 +72,15 @@ CompactionIterator::CompactionIterator(
     const std::string* full_history_ts_low,
     const SequenceNumber preserve_time_min_seqno,
     const SequenceNumber preclude_last_level_min_seqno)
-    : input_(input, cmp, must_count_input_entries),
+    : filter_batch_iter_(CreateFilterBatchIterIfNeeded(
+          input, cmp, compaction_filter, snapshot_checker)),
+      blob_prefetch_iter_(CreateBlobPrefetchIterIfNeeded(
+          filter_batch_iter_ ? filter_batch_iter_.get() : input, cmp,
+          compaction.get())),
+      input_(blob_prefetch_iter_   ? blob_prefetch_iter_.get()
+             : filter_batch_iter_ ? filter_batch_iter_.get()
+                                  : input,
+             cmp, must_count_input_entries),
       cmp_(cmp),
       merge_helper_(merge_helper),
       snapshots_(snapshots),
@@ -257,6 +269,23 @@ bool CompactionIterator::InvokeFilterIfNeeded(bool* need_skip,
 
   {
     StopWatchNano timer(clock_, report_detailed_time_);
+    PERF_TIMER_GUARD(compaction_filter_time);
+
+    if (filter_batch_iter_ && ikey_.type == kTypeValue) {
+      decision =
+          filter_batch_iter_->GetDecision(level_, &compaction_filter_value_);
+      if (decision != CompactionFilter::Decision::kUndetermined &&
+          decision != CompactionFilter::Decision::kKeep &&
+          decision != CompactionFilter::Decision::kRemove &&
+          decision != CompactionFilter::Decision::kPurge &&
+          decision != CompactionFilter::Decision::kChangeValue) {
+        status_ = Status::NotSupported(
+            "FilterBatch only supports kKeep, kRemove, kPurge and "
+            "kChangeValue");
+        validity_info_.Invalidate();
+        return false;
+      }
+    }
 
     if (ikey_.type == kTypeBlobIndex) {
       decision = compaction_filter_->FilterBlobByKey(
@@ -1179,18 +1208,24 @@ void CompactionIterator::GarbageCollectBlobIfNeeded() {
       return;
     }
 
-    FilePrefetchBuffer* prefetch_buffer =
-        prefetch_buffers_ ? prefetch_buffers_->GetOrCreatePrefetchBuffer(
-                                blob_index.file_number())
-                          : nullptr;
-
     uint64_t bytes_read = 0;
 
     {
-      assert(blob_fetcher_);
+      Status s;
 
-      const Status s = blob_fetcher_->FetchBlob(
-          user_key(), blob_index, prefetch_buffer, &blob_value_, &bytes_read);
+      if (!blob_prefetch_iter_ ||
+          !blob_prefetch_iter_->GetBlob(blob_index, &blob_value_, &s,
+                                        &bytes_read)) {
+        FilePrefetchBuffer* prefetch_buffer =
+            prefetch_buffers_ ? prefetch_buffers_->GetOrCreatePrefetchBuffer(
+                                    blob_index.file_number())
+                              : nullptr;
+
+        assert(blob_fetcher_);
+
+        s = blob_fetcher_->FetchBlob(user_key(), blob_index, prefetch_buffer,
+                                     &blob_value_, &bytes_read);
+      }
 
       if (!s.ok()) {
         status_ = s;
@@ -1493,4 +1528,54 @@ CompactionIterator::CreatePrefetchBufferCollectionIfNeeded(
       new PrefetchBufferCollection(readahead_size));
 }
 
+std::unique_ptr<FilterBatchIterator>
+CompactionIterator::CreateFilterBatchIterIfNeeded(
+    InternalIterator* input, const Comparator* cmp,
+    const CompactionFilter* compaction_filter,
+    const SnapshotChecker* snapshot_checker) {
+  if (!compaction_filter || compaction_filter->GetFilterBatchSize() == 0) {
+    return nullptr;
+  }
+
+  // With a snapshot checker, the filter applies to the first committed
+  // version of a user key, and with user-defined timestamps to more than one
+  // version, which cannot be told apart when reading ahead
+  if (!cmp || snapshot_checker || cmp->timestamp_size() > 0) {
+    return nullptr;
+  }
+
+  return std::unique_ptr<FilterBatchIterator>(
+      new FilterBatchIterator(input, cmp, compaction_filter));
+}
+
+std::unique_ptr<BlobPrefetchIterator>
+CompactionIterator::CreateBlobPrefetchIterIfNeeded(
+    InternalIterator* input, const Comparator* cmp,
+    const CompactionProxy* compaction) {
+  if (!cmp || !compaction) {
+    return nullptr;
+  }
+
+  const uint32_t batch_size = compaction->blob_compaction_read_batch_size();
+  if (!batch_size || !compaction->DoesInputReferenceBlobFiles()) {
+    return nullptr;
+  }
+
+  const uint64_t cutoff_file_number =
+      ComputeBlobGarbageCollectionCutoffFileNumber(compaction);
+  if (!cutoff_file_number) {
+    return nullptr;
+  }
+
+  std::unique_ptr<BlobFetcher> blob_fetcher =
+      CreateBlobFetcherIfNeeded(compaction);
+  if (!blob_fetcher) {
+    return nullptr;
+  }
+
+  return std::unique_ptr<BlobPrefetchIterator>(
+      new BlobPrefetchIterator(input, cmp, std::move(blob_fetcher),
+                               cutoff_file_number, batch_size));
+}
+
 }  // namespace ROCKSDB_NAMESPACE
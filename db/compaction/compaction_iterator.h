@@ -24,6 +24,8 @@ namespace ROCKSDB_NAMESPACE {
 
 class BlobFileBuilder;
 class BlobFetcher;
+class BlobPrefetchIterator;
+class FilterBatchIterator;
 class PrefetchBufferCollection;
 
 // A wrapper of internal iterator whose purpose is to count how
@@ -65,6 +67,7 @@ class SequenceIterWrapper : public InternalIterator {
   void SeekForPrev(const Slice& /* target */) override { assert(false); }
   void SeekToLast() override { assert(false); }
 
+  InternalIterator* inner_iter() const { return inner_iter_; }
   uint64_t NumItered() const { return num_itered_; }
   bool HasNumItered() const { return has_num_itered_; }
   bool IsDeleteRangeSentinelKey() const override {
@@ -110,6 +113,8 @@ class CompactionIterator {
 
     virtual uint64_t blob_compaction_readahead_size() const = 0;
 
+    virtual uint32_t blob_compaction_read_batch_size() const = 0;
+
     virtual const Version* input_version() const = 0;
 
     virtual bool DoesInputReferenceBlobFiles() const = 0;
@@ -170,6 +175,10 @@ class CompactionIterator {
       return compaction_->mutable_cf_options()->blob_compaction_readahead_size;
     }
 
+    uint32_t blob_compaction_read_batch_size() const override {
+      return compaction_->mutable_cf_options()->blob_compaction_read_batch_size;
+    }
+
     const Version* input_version() const override {
       return compaction_->input_version();
     }
@@ -202,7 +211,8 @@ class CompactionIterator {
   // `HasNumInputEntryScanned()` first in this case.
   CompactionIterator(
       InternalIterator* input, const Comparator* cmp, MergeHelper* merge_helper,
-      SequenceNumber last_sequence, std::vector<SequenceNumber>* snapshots,
+      SequenceNumber last_sequence,
+      const std::vector<SequenceNumber>* snapshots,
       SequenceNumber earliest_write_conflict_snapshot,
       SequenceNumber job_snapshot, const SnapshotChecker* snapshot_checker,
       Env* env, bool report_detailed_time, bool expect_valid_internal_key,
@@ -221,7 +231,8 @@ class CompactionIterator {
   // Constructor with custom CompactionProxy, used for tests.
   CompactionIterator(
       InternalIterator* input, const Comparator* cmp, MergeHelper* merge_helper,
-      SequenceNumber last_sequence, std::vector<SequenceNumber>* snapshots,
+      SequenceNumber last_sequence,
+      const std::vector<SequenceNumber>* snapshots,
       SequenceNumber earliest_write_conflict_snapshot,
       SequenceNumber job_snapshot, const SnapshotChecker* snapshot_checker,
       Env* env, bool report_detailed_time, bool expect_valid_internal_key,
@@ -276,6 +287,21 @@ class CompactionIterator {
 
   bool IsDeleteRangeSentinelKey() const { return is_range_del_; }
 
+  // Returns true if the current key is an input key, unchanged, at the
+  // start of a data block of an input file. See
+  // InternalIteratorBase::IsAtDataBlockStart().
+  bool IsAtInputDataBlockStart() const {
+    Slice block_upper_bound;
+    return !is_range_del_ && !at_next_ && input_.Valid() &&
+           input_.key() == key_ &&
+           input_.inner_iter()->IsAtDataBlockStart(&block_upper_bound);
+  }
+
+  // REQUIRES: IsAtInputDataBlockStart()
+  Status GetInputRawDataBlock(RawDataBlock* block) const {
+    return input_.inner_iter()->GetRawDataBlock(block);
+  }
+
  private:
   // Processes the input stream to find the next output
   void NextFromInput();
@@ -351,7 +377,20 @@ class CompactionIterator {
       const CompactionProxy* compaction);
   static std::unique_ptr<PrefetchBufferCollection>
   CreatePrefetchBufferCollectionIfNeeded(const CompactionProxy* compaction);
+  static std::unique_ptr<FilterBatchIterator> CreateFilterBatchIterIfNeeded(
+      InternalIterator* input, const Comparator* cmp,
+      const CompactionFilter* compaction_filter,
+      const SnapshotChecker* snapshot_checker);
+  static std::unique_ptr<BlobPrefetchIterator> CreateBlobPrefetchIterIfNeeded(
+      InternalIterator* input, const Comparator* cmp,
+      const CompactionProxy* compaction);
 
+  // Reads ahead the input for CompactionFilter::FilterBatch(), if the filter
+  // supports it. Declared before input_, which wraps it.
+  std::unique_ptr<FilterBatchIterator> filter_batch_iter_;
+  // Reads ahead the blobs relocated by garbage collection, if
+  // blob_compaction_read_batch_size is set. Wraps filter_batch_iter_ if any.
+  std::unique_ptr<BlobPrefetchIterator> blob_prefetch_iter_;
   SequenceIterWrapper input_;
   const Comparator* cmp_;
   MergeHelper* merge_helper_;
@@ -182,6 +182,8 @@ class FakeCompaction : public CompactionIterator::CompactionProxy {
 
   uint64_t blob_compaction_readahead_size() const override { return 0; }
 
+  uint32_t blob_compaction_read_batch_size() const override { return 0; }
+
   const Version* input_version() const override { return nullptr; }
 
   bool DoesInputReferenceBlobFiles() const override { return false; }
@@ -587,6 +589,89 @@ TEST_P(CompactionIteratorTest, CompactionFilterSkipUntil) {
   ASSERT_EQ(expected_actions, iter_->log);
 }
 
+TEST_P(CompactionIteratorTest, CompactionFilterBatch) {
+  class Filter : public CompactionFilter {
+   public:
+    Decision FilterV2(int /*level*/, const Slice& key, ValueType /*t*/,
+                      const Slice& /*existing_value*/, std::string* new_value,
+                      std::string* skip_until) const override {
+      std::string k = key.ToString();
+      filtered.push_back(k);
+      if (k == "a") {
+        return Decision::kRemove;
+      }
+      if (k == "b") {
+        *new_value = "bnew";
+        return Decision::kChangeValue;
+      }
+      if (k == "c") {
+        *skip_until = "e";
+        return Decision::kRemoveAndSkipUntil;
+      }
+      return Decision::kKeep;
+    }
+
+    size_t GetFilterBatchSize() const override { return 3; }
+
+    void FilterBatch(int /*level*/, const std::vector<BatchEntry>& entries,
+                     std::vector<Decision>* decisions,
+                     std::vector<std::string>* new_values) const override {
+      std::vector<std::string> keys;
+      for (size_t i = 0; i < entries.size(); i++) {
+        std::string k = entries[i].key.ToString();
+        keys.push_back(k);
+        EXPECT_EQ(ValueType::kValue, entries[i].value_type);
+        EXPECT_EQ(k + "v", entries[i].existing_value.ToString().substr(0, 2));
+        if (k == "a") {
+          (*decisions)[i] = Decision::kRemove;
+        } else if (k == "b") {
+          (*decisions)[i] = Decision::kChangeValue;
+          (*new_values)[i] = "bnew";
+        } else if (k != "c") {
+          // "c" is left to FilterV2()
+          (*decisions)[i] = Decision::kKeep;
+        }
+      }
+      batches.push_back(keys);
+    }
+
+    const char* Name() const override {
+      return "CompactionIteratorTest.CompactionFilterBatch::Filter";
+    }
+
+    mutable std::vector<std::vector<std::string>> batches;
+    mutable std::vector<std::string> filtered;
+  };
+
+  Filter filter;
+  RunTest(
+      {test::KeyStr("a", 50, kTypeValue), test::KeyStr("a", 40, kTypeValue),
+       test::KeyStr("b", 60, kTypeValue), test::KeyStr("c", 55, kTypeValue),
+       test::KeyStr("d", 70, kTypeValue), test::KeyStr("e", 80, kTypeValue),
+       test::KeyStr("f", 85, kTypeDeletion),
+       test::KeyStr("f", 75, kTypeValue), test::KeyStr("g", 90, kTypeValue)},
+      {"av50", "av40", "bv60", "cv55", "dv70", "ev80", "", "fv75", "gv90"},
+      {test::KeyStr("a", 50, kTypeDeletion), test::KeyStr("b", 60, kTypeValue),
+       test::KeyStr("e", 80, kTypeValue), test::KeyStr("f", 85, kTypeDeletion),
+       test::KeyStr("g", 90, kTypeValue)},
+      {"", "bnew", "ev80", "", "gv90"}, kMaxSequenceNumber,
+      nullptr /*merge_operator*/, &filter);
+
+  if (GetParam()) {
+    // No batches with a snapshot checker
+    ASSERT_TRUE(filter.batches.empty());
+    ASSERT_EQ(std::vector<std::string>({"a", "b", "c", "e", "g"}),
+              filter.filtered);
+  } else {
+    // The batch of "d" and "e" was dropped when skipping to "e", and the
+    // older versions of "a" and "f" were not passed
+    ASSERT_EQ(std::vector<std::vector<std::string>>(
+                  {{"a", "b"}, {"c", "d", "e"}, {"e"}, {"g"}}),
+              filter.batches);
+    ASSERT_EQ(std::vector<std::string>({"c"}), filter.filtered);
+  }
+}
+
 TEST_P(CompactionIteratorTest, ShuttingDownInFilter) {
   NoMergingMergeOp merge_op;
   StallingFilter filter;
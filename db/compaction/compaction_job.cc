@@ -51,6 +51,7 @@
 #include "rocksdb/status.h"
 #include "rocksdb/table.h"
 #include "rocksdb/utilities/options_type.h"
+#include "table/hot_key_ranges.h"
 #include "table/merging_iterator.h"
 #include "table/table_builder.h"
 #include "table/unique_id_impl.h"
@@ -134,7 +135,7 @@ CompactionJob::CompactionJob(
     FSDirectory* output_directory, FSDirectory* blob_output_directory,
     Statistics* stats, InstrumentedMutex* db_mutex,
     ErrorHandler* db_error_handler,
-    std::vector<SequenceNumber> existing_snapshots,
+    std::shared_ptr<const std::vector<SequenceNumber>> existing_snapshots,
     SequenceNumber earliest_write_conflict_snapshot,
     const SnapshotChecker* snapshot_checker, JobContext* job_context,
     std::shared_ptr<Cache> table_cache, EventLogger* event_logger,
@@ -173,7 +174,10 @@ CompactionJob::CompactionJob(
       blob_output_directory_(blob_output_directory),
       db_mutex_(db_mutex),
       db_error_handler_(db_error_handler),
-      existing_snapshots_(std::move(existing_snapshots)),
+      existing_snapshots_(
+          existing_snapshots != nullptr
+              ? std::move(existing_snapshots)
+              : std::make_shared<const std::vector<SequenceNumber>>()),
       earliest_write_conflict_snapshot_(earliest_write_conflict_snapshot),
       snapshot_checker_(snapshot_checker),
       job_context_(job_context),
@@ -457,7 +461,9 @@ void CompactionJob::GenSubcompactionBoundaries() {
   // the compaction input data into max_subcompactions ranges.
   // For every input file, we ask TableReader to estimate 128 anchor points
   // that evenly partition the input file into 128 ranges and the range
-  // sizes. This can be calculated by scanning index blocks of the file.
+  // sizes. This can be calculated by scanning index blocks of the file, or
+  // read from the anchors the file stores, see
+  // BlockBasedTableOptions::store_key_anchors.
   // Once we have the anchor points for all the input files, we merge them
   // together and try to find keys dividing ranges evenly.
   // For example, if we have two input files, and each returns following
@@ -541,15 +547,26 @@ void CompactionJob::GenSubcompactionBoundaries() {
                0;
       });
 
-  // Remove duplicated entries from boundaries.
-  all_anchors.erase(
-      std::unique(all_anchors.begin(), all_anchors.end(),
-                  [cfd_comparator](TableReader::Anchor& a,
-                                   TableReader::Anchor& b) -> bool {
-                    return cfd_comparator->CompareWithoutTimestamp(
-                               a.user_key, b.user_key) == 0;
-                  }),
-      all_anchors.end());
+  // Remove duplicated entries from boundaries, keeping the sizes of their
+  // ranges. Overlapping L0 files often end with the same keys, and dropping
+  // the ranges would skew the subcompactions towards the following ones.
+  size_t num_unique_anchors = 0;
+  for (size_t i = 0; i < all_anchors.size(); i++) {
+    if (num_unique_anchors > 0 &&
+        cfd_comparator->CompareWithoutTimestamp(
+            all_anchors[num_unique_anchors - 1].user_key,
+            all_anchors[i].user_key) == 0) {
+      all_anchors[num_unique_anchors - 1].range_size +=
+          all_anchors[i].range_size;
+    } else {
+      if (num_unique_anchors != i) {
+        all_anchors[num_unique_anchors] = std::move(all_anchors[i]);
+      }
+      num_unique_anchors++;
+    }
+  }
+  all_anchors.erase(all_anchors.begin() + num_unique_anchors,
+                    all_anchors.end());
 
   // Get the number of planned subcompactions, may update reserve threads
   // and update extra_num_subcompaction_threads_reserved_ for round-robin
@@ -624,12 +641,54 @@ void CompactionJob::GenSubcompactionBoundaries() {
                extra_num_subcompaction_threads_reserved_));
 }
 
+void CompactionJob::CollectHotKeyRanges() {
+  auto* c = compact_->compaction;
+  const auto* table_options =
+      c->immutable_options()
+          ->table_factory->GetOptions<BlockBasedTableOptions>();
+  if (table_options == nullptr ||
+      table_options->prepopulate_block_cache !=
+          BlockBasedTableOptions::PrepopulateBlockCache::
+              kFlushAndHotCompaction ||
+      table_options->prepopulate_block_cache_compaction_budget == 0 ||
+      table_options->block_cache == nullptr) {
+    return;
+  }
+  ReadOptions read_options(Env::IOActivity::kCompaction);
+  read_options.rate_limiter_priority = GetRateLimiterPriority();
+  auto* cfd = c->column_family_data();
+  const InternalKeyComparator& icomp = cfd->internal_comparator();
+
+  auto hot_key_ranges = std::make_unique<HotKeyRanges>(
+      cfd->user_comparator(),
+      table_options->prepopulate_block_cache_compaction_budget);
+  for (size_t lvl_idx = 0; lvl_idx < c->num_input_levels(); lvl_idx++) {
+    const LevelFilesBrief* flevel = c->input_levels(lvl_idx);
+    for (size_t i = 0; i < flevel->num_files; i++) {
+      FileMetaData* f = flevel->files[i].file_metadata;
+      std::vector<TableReader::KeyRange> ranges;
+      Status s = cfd->table_cache()->GetCachedKeyRanges(
+          read_options, icomp, *f,
+          c->mutable_cf_options()->block_protection_bytes_per_key, &ranges);
+      // A file whose ranges can't be found is considered cold
+      if (s.ok()) {
+        hot_key_ranges->Add(std::move(ranges));
+      }
+    }
+  }
+  hot_key_ranges->Finalize();
+  if (!hot_key_ranges->empty()) {
+    hot_key_ranges_ = std::move(hot_key_ranges);
+  }
+}
+
 Status CompactionJob::Run() {
   AutoThreadOperationStageUpdater stage_updater(
       ThreadStatus::STAGE_COMPACTION_RUN);
   TEST_SYNC_POINT("CompactionJob::Run():Start");
   log_buffer_->FlushBufferToLog();
   LogCompaction();
+  CollectHotKeyRanges();
 
   const size_t num_threads = compact_->sub_compact_states.size();
   assert(num_threads > 0);
@@ -873,6 +932,9 @@ Status CompactionJob::Install(const MutableCFOptions& mutable_cf_options,
   int output_level = compact_->compaction->output_level();
   cfd->internal_stats()->AddCompactionStats(output_level, thread_pri_,
                                             compaction_stats_);
+  if (measure_io_stats_) {
+    cfd->internal_stats()->AddCompactionStageStats(*compaction_job_stats_);
+  }
 
   if (status.ok()) {
     status = InstallCompactionResults(mutable_cf_options, compaction_released);
@@ -991,6 +1053,19 @@ Status CompactionJob::Install(const MutableCFOptions& mutable_cf_options,
     stream << "file_fsync_nanos" << compaction_job_stats_->file_fsync_nanos;
     stream << "file_prepare_write_nanos"
            << compaction_job_stats_->file_prepare_write_nanos;
+    stream << "file_read_nanos" << compaction_job_stats_->file_read_nanos;
+    stream << "block_decompress_nanos"
+           << compaction_job_stats_->block_decompress_nanos;
+    stream << "block_checksum_nanos"
+           << compaction_job_stats_->block_checksum_nanos;
+    stream << "block_compress_nanos"
+           << compaction_job_stats_->block_compress_nanos;
+    stream << "compaction_filter_nanos"
+           << compaction_job_stats_->compaction_filter_nanos;
+    stream << "merge_operator_nanos"
+           << compaction_job_stats_->merge_operator_nanos;
+    stream << "cloud_request_nanos"
+           << compaction_job_stats_->cloud_request_nanos;
   }
 
   stream << "lsm_state";
@@ -1116,7 +1191,7 @@ void CompactionJob::ProcessKeyValueCompaction(SubcompactionState* sub_compact) {
   NotifyOnSubcompactionBegin(sub_compact);
 
   auto range_del_agg = std::make_unique<CompactionRangeDelAggregator>(
-      &cfd->internal_comparator(), existing_snapshots_, &full_history_ts_low_,
+      &cfd->internal_comparator(), *existing_snapshots_, &full_history_ts_low_,
       &trim_ts_);
 
   // TODO: since we already use C++17, should use
@@ -1242,6 +1317,7 @@ void CompactionJob::ProcessKeyValueCompaction(SubcompactionState* sub_compact) {
   uint64_t prev_prepare_write_nanos = 0;
   uint64_t prev_cpu_write_nanos = 0;
   uint64_t prev_cpu_read_nanos = 0;
+  CompactionStageTimer stage_timer;
   if (measure_io_stats_) {
     prev_perf_level = GetPerfLevel();
     SetPerfLevel(PerfLevel::kEnableTimeAndCPUTimeExceptForMutex);
@@ -1251,13 +1327,14 @@ void CompactionJob::ProcessKeyValueCompaction(SubcompactionState* sub_compact) {
     prev_prepare_write_nanos = IOSTATS(prepare_write_nanos);
     prev_cpu_write_nanos = IOSTATS(cpu_write_nanos);
     prev_cpu_read_nanos = IOSTATS(cpu_read_nanos);
+    stage_timer.Start();
   }
 
   MergeHelper merge(
       env_, cfd->user_comparator(), cfd->ioptions()->merge_operator.get(),
       compaction_filter, db_options_.info_log.get(),
       false /* internal key corruption is expected */,
-      existing_snapshots_.empty() ? 0 : existing_snapshots_.back(),
+      existing_snapshots_->empty() ? 0 : existing_snapshots_->back(),
       snapshot_checker_, compact_->compaction->level(),
       db_options_.stats, shutting_down_);
 
@@ -1296,8 +1373,9 @@ void CompactionJob::ProcessKeyValueCompaction(SubcompactionState* sub_compact) {
 
   auto c_iter = std::make_unique<CompactionIterator>(
       input, cfd->user_comparator(), &merge, versions_->LastSequence(),
-      &existing_snapshots_, earliest_write_conflict_snapshot_, job_snapshot_seq,
-      snapshot_checker_, env_, ShouldReportDetailedTime(env_, stats_),
+      existing_snapshots_.get(), earliest_write_conflict_snapshot_,
+      job_snapshot_seq, snapshot_checker_, env_,
+      ShouldReportDetailedTime(env_, stats_),
       /*expect_valid_internal_key=*/true, range_del_agg.get(),
       blob_file_builder.get(), db_options_.allow_data_in_errors,
       db_options_.enforce_single_del_contracts, manual_compaction_canceled_,
@@ -1474,6 +1552,7 @@ void CompactionJob::ProcessKeyValueCompaction(SubcompactionState* sub_compact) {
         IOSTATS(range_sync_nanos) - prev_range_sync_nanos;
     sub_compact->compaction_job_stats.file_prepare_write_nanos +=
         IOSTATS(prepare_write_nanos) - prev_prepare_write_nanos;
+    stage_timer.AddTo(&sub_compact->compaction_job_stats);
     sub_compact->compaction_job_stats.cpu_micros -=
         (IOSTATS(cpu_write_nanos) - prev_cpu_write_nanos +
          IOSTATS(cpu_read_nanos) - prev_cpu_read_nanos) /
@@ -1563,8 +1642,8 @@ Status CompactionJob::FinishCompactionOutputFile(
 
   // Add range tombstones
   auto earliest_snapshot = kMaxSequenceNumber;
-  if (existing_snapshots_.size() > 0) {
-    earliest_snapshot = existing_snapshots_[0];
+  if (existing_snapshots_->size() > 0) {
+    earliest_snapshot = (*existing_snapshots_)[0];
   }
   if (s.ok()) {
     CompactionIterationStats range_del_out_stats;
@@ -1798,6 +1877,31 @@ Status CompactionJob::InstallCompactionResults(
     }
   }
 
+  // The next round-robin increment of universal compaction starts after the
+  // files of the second last sorted run compacted by this one
+  if (compaction->compaction_reason() ==
+          CompactionReason::kUniversalSizeAmplification &&
+      compaction->immutable_options()->compaction_style ==
+          kCompactionStyleUniversal &&
+      compaction->mutable_cf_options()
+          ->compaction_options_universal.incremental_round_robin &&
+      compaction->num_input_levels() >= 2) {
+    size_t which = compaction->num_input_levels() - 2;
+    int level = compaction->level(which);
+    const std::vector<FileMetaData*>* inputs = compaction->inputs(which);
+    if (level > 0 && !inputs->empty()) {
+      const std::vector<FileMetaData*>& files =
+          compaction->input_version()->storage_info()->LevelFiles(level);
+      auto it = std::find(files.begin(), files.end(), inputs->back());
+      assert(it != files.end());
+      if (it != files.end() && ++it != files.end()) {
+        edit->AddCompactCursor(level, (*it)->smallest);
+      } else {
+        edit->AddCompactCursor(level, files.front()->smallest);
+      }
+    }
+  }
+
   auto manifest_wcb = [&compaction, &compaction_released](const Status& s) {
     compaction->ReleaseCompactionFiles(s);
     *compaction_released = true;
@@ -1972,6 +2076,8 @@ Status CompactionJob::OpenCompactionOutputFile(SubcompactionState* sub_compact,
       bottommost_level_, TableFileCreationReason::kCompaction,
       0 /* oldest_key_time */, current_time, db_id_, db_session_id_,
       sub_compact->compaction->max_output_file_size(), file_number);
+  tboptions.compression_dict_manager = cfd->compression_dict_manager();
+  tboptions.hot_key_ranges = hot_key_ranges_.get();
 
   outputs.NewBuilder(tboptions);
 
@@ -2116,9 +2222,9 @@ void CompactionJob::LogCompaction() {
     }
     stream << "score" << compaction->score() << "input_data_size"
            << compaction->CalculateTotalInputSize() << "oldest_snapshot_seqno"
-           << (existing_snapshots_.empty()
+           << (existing_snapshots_->empty()
                    ? int64_t{-1}  // Use -1 for "none"
-                   : static_cast<int64_t>(existing_snapshots_[0]));
+                   : static_cast<int64_t>((*existing_snapshots_)[0]));
     if (compaction->SupportsPerKeyPlacement()) {
       stream << "preclude_last_level_min_seqno"
              << preclude_last_level_min_seqno_;
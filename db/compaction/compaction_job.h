@@ -50,6 +50,7 @@ namespace ROCKSDB_NAMESPACE {
 class Arena;
 class CompactionState;
 class ErrorHandler;
+class HotKeyRanges;
 class MemTable;
 class SnapshotChecker;
 class SystemClock;
@@ -153,7 +154,7 @@ class CompactionJob {
       FSDirectory* db_directory, FSDirectory* output_directory,
       FSDirectory* blob_output_directory, Statistics* stats,
       InstrumentedMutex* db_mutex, ErrorHandler* db_error_handler,
-      std::vector<SequenceNumber> existing_snapshots,
+      std::shared_ptr<const std::vector<SequenceNumber>> existing_snapshots,
       SequenceNumber earliest_write_conflict_snapshot,
       const SnapshotChecker* snapshot_checker, JobContext* job_context,
       std::shared_ptr<Cache> table_cache, EventLogger* event_logger,
@@ -242,6 +243,9 @@ class CompactionJob {
   // each consecutive pair of slices. Then it divides these ranges into
   // consecutive groups such that each group has a similar size.
   void GenSubcompactionBoundaries();
+  // Collects the key ranges of the input files in the block cache, with
+  // BlockBasedTableOptions::PrepopulateBlockCache::kFlushAndHotCompaction.
+  void CollectHotKeyRanges();
 
   // Get the number of planned subcompactions based on max_subcompactions and
   // extra reserved resources
@@ -312,7 +316,8 @@ class CompactionJob {
   // s2 and s1 < s2, and if we find two instances of a key k1 then lies
   // entirely within s1 and s2, then the earlier version of k1 can be safely
   // deleted because that version is not visible in any snapshot.
-  std::vector<SequenceNumber> existing_snapshots_;
+  // Shared with the other jobs started under the same snapshots.
+  std::shared_ptr<const std::vector<SequenceNumber>> existing_snapshots_;
 
   // This is the earliest snapshot that could be used for write-conflict
   // checking by a transaction.  For any user-key newer than this snapshot, we
@@ -331,6 +336,9 @@ class CompactionJob {
   bool measure_io_stats_;
   // Stores the Slices that designate the boundaries for each subcompaction
   std::vector<std::string> boundaries_;
+  // The key ranges of the output files to insert into the block cache, or
+  // nullptr if none.
+  std::unique_ptr<HotKeyRanges> hot_key_ranges_;
   Env::Priority thread_pri_;
   std::string full_history_ts_low_;
   std::string trim_ts_;
@@ -483,7 +491,7 @@ class CompactionServiceCompactionJob : private CompactionJob {
       const std::atomic<bool>* shutting_down, LogBuffer* log_buffer,
       FSDirectory* output_directory, Statistics* stats,
       InstrumentedMutex* db_mutex, ErrorHandler* db_error_handler,
-      std::vector<SequenceNumber> existing_snapshots,
+      std::shared_ptr<const std::vector<SequenceNumber>> existing_snapshots,
       std::shared_ptr<Cache> table_cache, EventLogger* event_logger,
       const std::string& dbname, const std::shared_ptr<IOTracer>& io_tracer,
       const std::atomic<bool>& manual_compaction_canceled,
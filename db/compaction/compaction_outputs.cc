@@ -403,6 +403,15 @@ Status CompactionOutputs::AddToOutput(
   }
 
   assert(builder_ != nullptr);
+  if (block_passthrough_ && c_iter.IsAtInputDataBlockStart()) {
+    RawDataBlock block;
+    s = c_iter.GetInputRawDataBlock(&block);
+    if (!s.ok()) {
+      return s;
+    }
+    builder_->BeginRawDataBlock(block);
+  }
+
   const Slice& value = c_iter.value();
   s = current_output().validator.Add(key, value);
   if (!s.ok()) {
@@ -789,6 +798,12 @@ CompactionOutputs::CompactionOutputs(const Compaction* compaction,
     FillFilesToCutForTtl();
   }
 
+  const auto* table_options = compaction->immutable_options()
+                                  ->table_factory
+                                  ->GetOptions<BlockBasedTableOptions>();
+  block_passthrough_ =
+      table_options != nullptr && table_options->compaction_block_passthrough;
+
   level_ptrs_ = std::vector<size_t>(compaction_->number_levels(), 0);
 }
 
@@ -313,6 +313,9 @@ class CompactionOutputs {
   const bool is_penultimate_level_;
   std::unique_ptr<CompactionRangeDelAggregator> range_del_agg_ = nullptr;
 
+  // See BlockBasedTableOptions::compaction_block_passthrough
+  bool block_passthrough_ = false;
+
   // partitioner information
   std::string last_key_for_partitioner_;
   std::unique_ptr<SstPartitioner> partitioner_;
@@ -13,6 +13,7 @@
 #include "db/compaction/compaction_picker_universal.h"
 #include "db/compaction/file_pri.h"
 #include "rocksdb/advanced_options.h"
+#include "rocksdb/compaction_cost_model.h"
 #include "table/unique_id_impl.h"
 #include "test_util/testharness.h"
 #include "test_util/testutil.h"
@@ -952,6 +953,58 @@ TEST_F(CompactionPickerTest, UniversalIncrementalSpace4) {
   ASSERT_EQ(11, compaction->num_input_files(1));
 }
 
+TEST_F(CompactionPickerTest, UniversalIncrementalRoundRobin) {
+  // Test that size amp increments start from the compact cursor, and over
+  // again from the first file once past the last one.
+  const uint64_t kFileSize = 100000;
+
+  mutable_cf_options_.max_compaction_bytes = 3200000;
+  mutable_cf_options_.compaction_options_universal.incremental = true;
+  mutable_cf_options_.compaction_options_universal.incremental_round_robin =
+      true;
+  mutable_cf_options_.compaction_options_universal
+      .max_size_amplification_percent = 30;
+  UniversalCompactionPicker universal_compaction_picker(ioptions_, &icmp_);
+
+  for (const char* cursor : {"3000", "9000"}) {
+    NewVersionStorage(5, kCompactionStyleUniversal);
+
+    Add(0, 1U, "150", "200", kFileSize, 0, 500, 550);
+    Add(2, 2U, "010", "080", kFileSize, 0, 200, 251);
+
+    // Generate files like following:
+    // L3: (1100, 1180) (1200, 1280) ... (7800, 7880)
+    // L4: (1130, 1150) (1160, 1210) (1230, 1250) (1260, 1310) ... (7860, 7910)
+    for (int i = 11; i < 79; i++) {
+      Add(3, 100 + i * 3, std::to_string(i * 100).c_str(),
+          std::to_string(i * 100 + 80).c_str(), kFileSize, 0, 200, 251);
+      Add(4, 100 + i * 3 + 1, std::to_string(i * 100 + 30).c_str(),
+          std::to_string(i * 100 + 50).c_str(), kFileSize, 0, 200, 251);
+      Add(4, 100 + i * 3 + 2, std::to_string(i * 100 + 60).c_str(),
+          std::to_string(i * 100 + 110).c_str(), kFileSize, 0, 200, 251);
+    }
+    UpdateVersionStorageInfo();
+    vstorage_->ResizeCompactCursors(5);
+    // As recorded by a compaction, the smallest key of the next file
+    vstorage_->AddCursorForOneLevel(3, InternalKey(cursor, 200, kTypeValue));
+
+    std::unique_ptr<Compaction> compaction(
+        universal_compaction_picker.PickCompaction(
+            cf_name_, mutable_cf_options_, mutable_db_options_,
+            vstorage_.get(), &log_buffer_));
+    ASSERT_TRUE(compaction);
+    ASSERT_EQ(CompactionReason::kUniversalSizeAmplification,
+              compaction->compaction_reason());
+    ASSERT_EQ(4, compaction->output_level());
+    ASSERT_EQ(3, compaction->start_level());
+    uint64_t first =
+        std::string(cursor) == "3000" ? 100 + 30 * 3 : 100 + 11 * 3;
+    ASSERT_EQ(first, compaction->input(0, 0)->fd.GetNumber());
+    ASSERT_LE(5U, compaction->num_input_files(0));
+    ASSERT_GE(6U, compaction->num_input_files(0));
+  }
+}
+
 TEST_F(CompactionPickerTest, UniversalIncrementalSpace5) {
   // Test compaction candidates always cover many files with some single
   // files larger than size threshold.
@@ -1466,6 +1519,66 @@ TEST_F(CompactionPickerTest, CompactionPriMinOverlapping4) {
   ASSERT_EQ(6U, compaction->input(0, 0)->fd.GetNumber());
 }
 
+TEST_F(CompactionPickerTest, CompactionPriMinOverlappingByReads) {
+  NewVersionStorage(6, kCompactionStyleLevel);
+  ioptions_.compaction_pri = kMinOverlappingRatioByReads;
+  mutable_cf_options_.target_file_size_base = 100000000000;
+  mutable_cf_options_.target_file_size_multiplier = 10;
+  mutable_cf_options_.max_bytes_for_level_base = 10 * 1024 * 1024;
+  mutable_cf_options_.RefreshDerivedOptions(ioptions_);
+
+  Add(2, 6U, "150", "179", 50000000U);  // Overlaps with file 26, 27
+  Add(2, 7U, "180", "220", 50000000U);  // Overlaps with file 28
+  Add(2, 8U, "321", "400", 50000000U);  // File not overlapping
+  Add(2, 9U, "721", "800", 50000000U);  // Overlaps with file 30
+
+  Add(3, 26U, "150", "170", 260000000U);
+  Add(3, 27U, "171", "179", 260000000U);
+  Add(3, 28U, "191", "220", 260000000U);
+  Add(3, 29U, "221", "300", 260000000U);
+  Add(3, 30U, "750", "900", 260000000U);
+  // File 8 would be picked by kMinOverlappingRatio, but is never read.
+  // File 7 overlaps half as much as file 6, and is read more.
+  file_map_[6U].first->stats.num_reads_sampled = 10;
+  file_map_[7U].first->stats.num_reads_sampled = 100;
+  file_map_[9U].first->stats.num_reads_sampled = 1;
+  UpdateVersionStorageInfo();
+
+  std::unique_ptr<Compaction> compaction(level_compaction_picker.PickCompaction(
+      cf_name_, mutable_cf_options_, mutable_db_options_, vstorage_.get(),
+      &log_buffer_));
+  ASSERT_TRUE(compaction.get() != nullptr);
+  ASSERT_EQ(1U, compaction->num_input_files(0));
+  ASSERT_EQ(7U, compaction->input(0, 0)->fd.GetNumber());
+}
+
+TEST_F(CompactionPickerTest, CompactionCostModel) {
+  NewVersionStorage(6, kCompactionStyleLevel);
+  ioptions_.compaction_pri = kMinOverlappingRatio;
+  ioptions_.compaction_cost_model = NewCloudCompactionCostModel();
+  mutable_cf_options_.target_file_size_base = 64 * 1024 * 1024;
+  mutable_cf_options_.target_file_size_multiplier = 1;
+  mutable_cf_options_.max_bytes_for_level_base = 10 * 1024 * 1024;
+  mutable_cf_options_.RefreshDerivedOptions(ioptions_);
+
+  // File 6 overlaps no file, but takes a PUT for 1MB. File 7 takes six PUTs
+  // and rewrites file 27, for 110MB.
+  Add(2, 6U, "150", "160", 1000000U);
+  Add(2, 7U, "201", "300", 110000000U);
+
+  Add(3, 26U, "100", "110", 260000000U);
+  Add(3, 27U, "250", "350", 260000000U);
+  Add(3, 28U, "600", "700", 260000000U);
+  UpdateVersionStorageInfo();
+
+  std::unique_ptr<Compaction> compaction(level_compaction_picker.PickCompaction(
+      cf_name_, mutable_cf_options_, mutable_db_options_, vstorage_.get(),
+      &log_buffer_));
+  ASSERT_TRUE(compaction.get() != nullptr);
+  ASSERT_EQ(1U, compaction->num_input_files(0));
+  ASSERT_EQ(7U, compaction->input(0, 0)->fd.GetNumber());
+}
+
 TEST_F(CompactionPickerTest, CompactionPriRoundRobin) {
   std::vector<InternalKey> test_cursors = {InternalKey("249", 100, kTypeValue),
                                            InternalKey("600", 100, kTypeValue),
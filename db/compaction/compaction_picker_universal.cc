@@ -96,6 +96,17 @@ class UniversalCompactionBuilder {
   //    total size of files to compact at other levels
   Compaction* PickIncrementalForReduceSizeAmp(double fanout_threshold);
 
+  // Pick the incremental compaction to reduce space amplification that
+  // starts at the compact cursor of the second last sorted run, see
+  // CompactionOptionsUniversal::incremental_round_robin. Returns null if
+  // its files are being compacted.
+  Compaction* PickRoundRobinForReduceSizeAmp();
+
+  // Form an incremental compaction from the files [start_idx, end_idx] of
+  // the second last sorted run, which is not in L0, with their overlapping
+  // files in the other sorted runs.
+  Compaction* PickIncrementalWithFiles(int start_idx, int end_idx);
+
   Compaction* PickDeleteTriggeredCompaction();
 
   // Form a compaction from the sorted run indicated by start_index to the
@@ -966,6 +977,13 @@ Compaction* UniversalCompactionBuilder::PickCompactionToReduceSizeAmp() {
   // This also prevent the case when compaction falls behind and we
   // need to compact more levels for compactions to catch up.
   if (mutable_cf_options_.compaction_options_universal.incremental) {
+    if (mutable_cf_options_.compaction_options_universal
+            .incremental_round_robin &&
+        sorted_runs_[sorted_runs_.size() - 2].level > 0) {
+      // The next increment waits for its files rather than compacting the
+      // whole sorted runs
+      return PickRoundRobinForReduceSizeAmp();
+    }
     double fanout_threshold = static_cast<double>(base_sr_size) /
                               static_cast<double>(candidate_size) * 1.8;
     Compaction* picked = PickIncrementalForReduceSizeAmp(fanout_threshold);
@@ -1117,13 +1135,85 @@ Compaction* UniversalCompactionBuilder::PickIncrementalForReduceSizeAmp(
     assert(picked_fanout == fanout_threshold);
     return nullptr;
   }
+  return PickIncrementalWithFiles(picked_start_idx, picked_end_idx);
+}
+
+Compaction* UniversalCompactionBuilder::PickRoundRobinForReduceSizeAmp() {
+  assert(sorted_runs_.size() >= 2);
+  int second_last_level = sorted_runs_[sorted_runs_.size() - 2].level;
+  assert(second_last_level > 0);
+  int output_level = sorted_runs_.back().level;
+  const std::vector<FileMetaData*>& bottom_files =
+      vstorage_->LevelFiles(output_level);
+  const std::vector<FileMetaData*>& files =
+      vstorage_->LevelFiles(second_last_level);
+  assert(!files.empty());
+
+  // Start at the first file from the cursor, or over again from the first
+  // file once past the last one
+  const InternalKey& cursor =
+      vstorage_->GetCompactCursors()[second_last_level];
+  int start_idx = 0;
+  if (cursor.size() != 0) {
+    while (start_idx < static_cast<int>(files.size()) &&
+           icmp_->Compare(files[start_idx]->smallest, cursor) < 0) {
+      start_idx++;
+    }
+    if (start_idx == static_cast<int>(files.size())) {
+      start_idx = 0;
+    }
+  }
+
+  // As in PickIncrementalForReduceSizeAmp(), keep growing the range until
+  // it reaches half the target compaction bytes, with its overlapping
+  // bottom files, to reserve room for the clean cut and the files of the
+  // other sorted runs.
+  const uint64_t comp_thres_size = mutable_cf_options_.max_compaction_bytes / 2;
+  size_t bottom_idx = 0;
+  while (bottom_idx < bottom_files.size() &&
+         icmp_->Compare(bottom_files[bottom_idx]->largest,
+                        files[start_idx]->smallest) < 0) {
+    bottom_idx++;
+  }
+  uint64_t size = 0;
+  int end_idx = start_idx;
+  for (; end_idx < static_cast<int>(files.size()); end_idx++) {
+    uint64_t file_size = files[end_idx]->fd.file_size;
+    // A bottom file crossing the end of this file is counted once, with it
+    while (bottom_idx < bottom_files.size() &&
+           icmp_->Compare(bottom_files[bottom_idx]->smallest,
+                          files[end_idx]->largest) <= 0) {
+      file_size += bottom_files[bottom_idx]->fd.file_size;
+      bottom_idx++;
+    }
+    if (end_idx > start_idx && size + file_size > comp_thres_size) {
+      break;
+    }
+    size += file_size;
+  }
+
+  ROCKS_LOG_BUFFER(log_buffer_,
+                   "[%s] Universal: round-robin increment of files "
+                   "[%d, %d] of L%d, %" PRIu64 " bytes with the overlapping "
+                   "files of L%d, to reduce size amp.\n",
+                   cf_name_.c_str(), start_idx, end_idx - 1, second_last_level,
+                   size, output_level);
+  return PickIncrementalWithFiles(start_idx, end_idx - 1);
+}
+
+Compaction* UniversalCompactionBuilder::PickIncrementalWithFiles(
+    int start_idx, int end_idx) {
+  int second_last_level = sorted_runs_[sorted_runs_.size() - 2].level;
+  int output_level = sorted_runs_.back().level;
+  const std::vector<FileMetaData*>& files =
+      vstorage_->LevelFiles(second_last_level);
 
   std::vector<CompactionInputFiles> inputs;
   CompactionInputFiles bottom_level_inputs;
   CompactionInputFiles second_last_level_inputs;
   second_last_level_inputs.level = second_last_level;
   bottom_level_inputs.level = output_level;
-  for (int i = picked_start_idx; i <= picked_end_idx; i++) {
+  for (int i = start_idx; i <= end_idx; i++) {
     if (files[i]->being_compacted) {
       return nullptr;
     }
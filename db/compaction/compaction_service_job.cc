@@ -45,7 +45,7 @@ CompactionJob::ProcessKeyValueCompactionWithCompactionService(
       compaction->column_family_data()->GetLatestCFOptions();
   compaction_input.db_options =
       BuildDBOptions(db_options_, mutable_db_options_copy_);
-  compaction_input.snapshots = existing_snapshots_;
+  compaction_input.snapshots = *existing_snapshots_;
   compaction_input.has_begin = sub_compact->start.has_value();
   compaction_input.begin =
       compaction_input.has_begin ? sub_compact->start->ToString() : "";
@@ -226,7 +226,7 @@ CompactionServiceCompactionJob::CompactionServiceCompactionJob(
     VersionSet* versions, const std::atomic<bool>* shutting_down,
     LogBuffer* log_buffer, FSDirectory* output_directory, Statistics* stats,
     InstrumentedMutex* db_mutex, ErrorHandler* db_error_handler,
-    std::vector<SequenceNumber> existing_snapshots,
+    std::shared_ptr<const std::vector<SequenceNumber>> existing_snapshots,
     std::shared_ptr<Cache> table_cache, EventLogger* event_logger,
     const std::string& dbname, const std::shared_ptr<IOTracer>& io_tracer,
     const std::atomic<bool>& manual_compaction_canceled,
@@ -611,6 +611,34 @@ static std::unordered_map<std::string, OptionTypeInfo>
          {offsetof(struct CompactionJobStats, file_prepare_write_nanos),
           OptionType::kUInt64T, OptionVerificationType::kNormal,
           OptionTypeFlags::kNone}},
+        {"file_read_nanos",
+         {offsetof(struct CompactionJobStats, file_read_nanos),
+          OptionType::kUInt64T, OptionVerificationType::kNormal,
+          OptionTypeFlags::kNone}},
+        {"block_decompress_nanos",
+         {offsetof(struct CompactionJobStats, block_decompress_nanos),
+          OptionType::kUInt64T, OptionVerificationType::kNormal,
+          OptionTypeFlags::kNone}},
+        {"block_checksum_nanos",
+         {offsetof(struct CompactionJobStats, block_checksum_nanos),
+          OptionType::kUInt64T, OptionVerificationType::kNormal,
+          OptionTypeFlags::kNone}},
+        {"block_compress_nanos",
+         {offsetof(struct CompactionJobStats, block_compress_nanos),
+          OptionType::kUInt64T, OptionVerificationType::kNormal,
+          OptionTypeFlags::kNone}},
+        {"compaction_filter_nanos",
+         {offsetof(struct CompactionJobStats, compaction_filter_nanos),
+          OptionType::kUInt64T, OptionVerificationType::kNormal,
+          OptionTypeFlags::kNone}},
+        {"merge_operator_nanos",
+         {offsetof(struct CompactionJobStats, merge_operator_nanos),
+          OptionType::kUInt64T, OptionVerificationType::kNormal,
+          OptionTypeFlags::kNone}},
+        {"cloud_request_nanos",
+         {offsetof(struct CompactionJobStats, cloud_request_nanos),
+          OptionType::kUInt64T, OptionVerificationType::kNormal,
+          OptionTypeFlags::kNone}},
         {"smallest_output_key_prefix",
          {offsetof(struct CompactionJobStats, smallest_output_key_prefix),
           OptionType::kEncodedString, OptionVerificationType::kNormal,
@@ -0,0 +1,116 @@
+//  Copyright (c) Meta Platforms, Inc. and affiliates.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+
+#include "db/compaction/filter_batch_iterator.h"
+
+#include "db/dbformat.h"
+
+namespace ROCKSDB_NAMESPACE {
+
+FilterBatchIterator::FilterBatchIterator(InternalIterator* iter,
+                                         const Comparator* ucmp,
+                                         const CompactionFilter* filter)
+    : iter_(iter),
+      ucmp_(ucmp),
+      filter_(filter),
+      batch_size_(filter->GetFilterBatchSize()) {
+  assert(iter_);
+  assert(batch_size_ > 0);
+  Fill();
+}
+
+void FilterBatchIterator::Next() {
+  assert(Valid());
+  if (++pos_ == num_entries_) {
+    Fill();
+  }
+}
+
+void FilterBatchIterator::Seek(const Slice& target) {
+  // The entries from `target` start with a new user key, see
+  // CompactionIterator::SkipUntil()
+  has_prev_user_key_ = false;
+  iter_->Seek(target);
+  Fill();
+}
+
+CompactionFilter::Decision FilterBatchIterator::GetDecision(
+    int level, std::string* new_value) {
+  assert(Valid());
+  const size_t i = entries_[pos_].batch_index;
+  if (i == kNotInBatch) {
+    return CompactionFilter::Decision::kUndetermined;
+  }
+  if (!evaluated_) {
+    EvaluateBatch(level);
+  }
+  if (decisions_[i] == CompactionFilter::Decision::kChangeValue) {
+    *new_value = std::move(new_values_[i]);
+  }
+  return decisions_[i];
+}
+
+void FilterBatchIterator::Fill() {
+  num_entries_ = 0;
+  pos_ = 0;
+  candidates_.clear();
+  evaluated_ = false;
+  while (num_entries_ < batch_size_ && iter_->Valid()) {
+    if (num_entries_ == entries_.size()) {
+      entries_.emplace_back();
+    }
+    Entry& entry = entries_[num_entries_];
+    const Slice key = iter_->key();
+    const Slice value = iter_->value();
+    entry.key.assign(key.data(), key.size());
+    entry.value.assign(value.data(), value.size());
+    entry.is_range_del = iter_->IsDeleteRangeSentinelKey();
+    entry.batch_index = kNotInBatch;
+
+    // Follows how CompactionIterator::NextFromInput() finds the first
+    // version of a user key: range tombstone sentinels are skipped, and a
+    // corrupt key is followed by a new user key.
+    if (!entry.is_range_del) {
+      ParsedInternalKey ikey;
+      if (!ParseInternalKey(key, &ikey, /*log_err_key=*/false).ok()) {
+        has_prev_user_key_ = false;
+      } else if (!has_prev_user_key_ ||
+                 !ucmp_->Equal(ikey.user_key, prev_user_key_)) {
+        prev_user_key_.assign(ikey.user_key.data(), ikey.user_key.size());
+        has_prev_user_key_ = true;
+        if (ikey.type == kTypeValue) {
+          entry.batch_index = candidates_.size();
+          candidates_.push_back(num_entries_);
+        }
+      }
+    }
+    ++num_entries_;
+    iter_->Next();
+  }
+}
+
+void FilterBatchIterator::EvaluateBatch(int level) {
+  assert(!evaluated_);
+  evaluated_ = true;
+  const size_t n = candidates_.size();
+  batch_.resize(n);
+  for (size_t i = 0; i < n; i++) {
+    const Entry& entry = entries_[candidates_[i]];
+    batch_[i].key = ExtractUserKey(entry.key);
+    batch_[i].value_type = CompactionFilter::ValueType::kValue;
+    batch_[i].existing_value = entry.value;
+  }
+  decisions_.assign(n, CompactionFilter::Decision::kUndetermined);
+  new_values_.resize(n);
+  for (auto& new_value : new_values_) {
+    new_value.clear();
+  }
+  filter_->FilterBatch(level, batch_, &decisions_, &new_values_);
+  // A filter growing or shrinking the outputs would index out of bounds
+  decisions_.resize(n, CompactionFilter::Decision::kUndetermined);
+  new_values_.resize(n);
+}
+
+}  // namespace ROCKSDB_NAMESPACE
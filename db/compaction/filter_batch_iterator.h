@@ -0,0 +1,103 @@
+//  Copyright (c) Meta Platforms, Inc. and affiliates.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include "rocksdb/comparator.h"
+#include "rocksdb/compaction_filter.h"
+#include "table/internal_iterator.h"
+
+namespace ROCKSDB_NAMESPACE {
+
+// An internal iterator that reads ahead the input of a CompactionIterator in
+// batches of CompactionFilter::GetFilterBatchSize() entries, and evaluates
+// the filter with FilterBatch() on the entries CompactionIterator would call
+// FilterV3() for as plain values: the newest version of each user key, if it
+// is a kTypeValue. The entries are copied, so keys and values are never
+// pinned.
+//
+// A batch is evaluated on the first GetDecision() call for one of its
+// entries, and dropped by Seek(), which discards the decisions of the
+// entries skipped. Only used without user-defined timestamps and snapshot
+// checker, where the first version of a user key is always filtered.
+class FilterBatchIterator : public InternalIterator {
+ public:
+  // REQUIRES: `iter` is positioned, and filter->GetFilterBatchSize() > 0
+  FilterBatchIterator(InternalIterator* iter, const Comparator* ucmp,
+                      const CompactionFilter* filter);
+
+  bool Valid() const override { return pos_ < num_entries_; }
+  Status status() const override {
+    return Valid() ? Status::OK() : iter_->status();
+  }
+  void Next() override;
+  void Seek(const Slice& target) override;
+  Slice key() const override {
+    assert(Valid());
+    return entries_[pos_].key;
+  }
+  Slice value() const override {
+    assert(Valid());
+    return entries_[pos_].value;
+  }
+  bool IsDeleteRangeSentinelKey() const override {
+    assert(Valid());
+    return entries_[pos_].is_range_del;
+  }
+
+  // Unused InternalIterator methods
+  void SeekToFirst() override { assert(false); }
+  void Prev() override { assert(false); }
+  void SeekForPrev(const Slice& /* target */) override { assert(false); }
+  void SeekToLast() override { assert(false); }
+
+  // Returns the decision of FilterBatch() for the current entry, moving its
+  // new value into `new_value` for kChangeValue, or kUndetermined if the
+  // entry was not passed to FilterBatch().
+  CompactionFilter::Decision GetDecision(int level, std::string* new_value);
+
+ private:
+  static constexpr size_t kNotInBatch = SIZE_MAX;
+
+  struct Entry {
+    std::string key;
+    std::string value;
+    bool is_range_del = false;
+    // Index of the entry in batch_, or kNotInBatch
+    size_t batch_index = kNotInBatch;
+  };
+
+  // Reads the next entries of iter_
+  void Fill();
+  void EvaluateBatch(int level);
+
+  InternalIterator* const iter_;
+  const Comparator* const ucmp_;
+  const CompactionFilter* const filter_;
+  const size_t batch_size_;
+
+  // The first num_entries_ are the buffered entries. The strings of the
+  // others are kept to reuse their memory.
+  std::vector<Entry> entries_;
+  size_t num_entries_ = 0;
+  size_t pos_ = 0;
+
+  // Indexes in entries_ of the entries passed to FilterBatch()
+  std::vector<size_t> candidates_;
+  bool evaluated_ = false;
+  std::vector<CompactionFilter::BatchEntry> batch_;
+  std::vector<CompactionFilter::Decision> decisions_;
+  std::vector<std::string> new_values_;
+
+  // The user key of the last entry read, to find the first version of each
+  // user key across batches
+  std::string prev_user_key_;
+  bool has_prev_user_key_ = false;
+};
+
+}  // namespace ROCKSDB_NAMESPACE
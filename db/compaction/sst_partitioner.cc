@@ -56,6 +56,64 @@ std::shared_ptr<SstPartitionerFactory> NewSstPartitionerFixedPrefixFactory(
   return std::make_shared<SstPartitionerFixedPrefixFactory>(prefix_len);
 }
 
+PartitionerResult SstPartitionerShardBoundaries::ShouldPartition(
+    const PartitionerRequest& request) {
+  return CanDoTrivialMove(*request.prev_user_key, *request.current_user_key)
+             ? kNotRequired
+             : kRequired;
+}
+
+bool SstPartitionerShardBoundaries::CanDoTrivialMove(
+    const Slice& smallest_user_key, const Slice& largest_user_key) {
+  // The first boundary after smallest_user_key must be past
+  // largest_user_key.
+  auto it = std::upper_bound(
+      boundaries_->begin(), boundaries_->end(), smallest_user_key,
+      [this](const Slice& key, const std::string& boundary) {
+        return comparator_->Compare(key, boundary) < 0;
+      });
+  return it == boundaries_->end() ||
+         comparator_->Compare(*it, largest_user_key) > 0;
+}
+
+SstPartitionerShardBoundariesFactory::SstPartitionerShardBoundariesFactory(
+    const Comparator* comparator, std::vector<std::string> boundaries)
+    : comparator_(comparator) {
+  SetBoundaries(std::move(boundaries));
+}
+
+std::unique_ptr<SstPartitioner>
+SstPartitionerShardBoundariesFactory::CreatePartitioner(
+    const SstPartitioner::Context& /* context */) const {
+  return std::unique_ptr<SstPartitioner>(
+      new SstPartitionerShardBoundaries(comparator_, GetBoundaries()));
+}
+
+void SstPartitionerShardBoundariesFactory::SetBoundaries(
+    std::vector<std::string> boundaries) {
+  std::sort(boundaries.begin(), boundaries.end(),
+            [this](const std::string& a, const std::string& b) {
+              return comparator_->Compare(a, b) < 0;
+            });
+  auto sorted =
+      std::make_shared<const std::vector<std::string>>(std::move(boundaries));
+  std::lock_guard<std::mutex> lock(mutex_);
+  boundaries_ = std::move(sorted);
+}
+
+std::shared_ptr<const std::vector<std::string>>
+SstPartitionerShardBoundariesFactory::GetBoundaries() const {
+  std::lock_guard<std::mutex> lock(mutex_);
+  return boundaries_;
+}
+
+std::shared_ptr<SstPartitionerShardBoundariesFactory>
+NewSstPartitionerShardBoundariesFactory(const Comparator* comparator,
+                                        std::vector<std::string> boundaries) {
+  return std::make_shared<SstPartitionerShardBoundariesFactory>(
+      comparator, std::move(boundaries));
+}
+
 namespace {
 static int RegisterSstPartitionerFactories(ObjectLibrary& library,
                                            const std::string& /*arg*/) {
@@ -67,7 +125,16 @@ static int RegisterSstPartitionerFactories(ObjectLibrary& library,
         guard->reset(new SstPartitionerFixedPrefixFactory(0));
         return guard->get();
       });
-  return 1;
+  library.AddFactory<SstPartitionerFactory>(
+      SstPartitionerShardBoundariesFactory::kClassName(),
+      [](const std::string& /*uri*/,
+         std::unique_ptr<SstPartitionerFactory>* guard,
+         std::string* /* errmsg */) {
+        guard->reset(
+            new SstPartitionerShardBoundariesFactory(BytewiseComparator()));
+        return guard->get();
+      });
+  return 2;
 }
 }  // namespace
 
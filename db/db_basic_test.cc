@@ -8,6 +8,7 @@
 // found in the LICENSE file. See the AUTHORS file for names of contributors.
 
 #include <cstring>
+#include <future>
 
 #include "db/db_test_util.h"
 #include "options/options_helper.h"
@@ -15,6 +16,7 @@
 #include "rocksdb/filter_policy.h"
 #include "rocksdb/flush_block_policy.h"
 #include "rocksdb/merge_operator.h"
+#include "rocksdb/op_trace.h"
 #include "rocksdb/perf_context.h"
 #include "rocksdb/table.h"
 #include "rocksdb/utilities/debug.h"
@@ -682,6 +684,108 @@ TEST_F(DBBasicTest, ManifestRollOver) {
   } while (ChangeCompactOptions());
 }
 
+TEST_F(DBBasicTest, RecoverLoadsTablesEarly) {
+  Options options = CurrentOptions();
+  options.max_open_files = -1;
+  options.disable_auto_compactions = true;
+  CreateAndReopenWithCF({"pikachu"}, options);
+  for (int i = 0; i < 3; i++) {
+    ASSERT_OK(Put(1, "key" + std::to_string(i), "value" + std::to_string(i)));
+    // Overlaps the files, which the compaction cannot just move
+    ASSERT_OK(Put(1, "key", "value" + std::to_string(i)));
+    ASSERT_OK(Flush(1));
+  }
+  // Deletes the files flushed so far, in the MANIFEST being recovered
+  ASSERT_OK(db_->CompactRange(CompactRangeOptions(), handles_[1], nullptr,
+                              nullptr));
+  ASSERT_OK(Put(0, "foo", "bar"));
+  ASSERT_OK(Flush(0));
+
+  std::vector<LiveFileMetaData> live_files;
+  db_->GetLiveFilesMetaData(&live_files);
+  std::set<uint64_t> live_file_numbers;
+  for (const auto& file : live_files) {
+    live_file_numbers.insert(file.file_number);
+  }
+  ASSERT_EQ(2, live_file_numbers.size());
+
+  std::set<uint64_t> queued_file_numbers;
+  SyncPoint::GetInstance()->SetCallBack(
+      "VersionEditHandler::MaybeLoadTableEarly:Queue", [&](void* arg) {
+        auto* file_meta = static_cast<FileMetaData*>(arg);
+        queued_file_numbers.insert(file_meta->fd.GetNumber());
+      });
+  SyncPoint::GetInstance()->EnableProcessing();
+  ReopenWithColumnFamilies({"default", "pikachu"}, options);
+  SyncPoint::GetInstance()->DisableProcessing();
+  SyncPoint::GetInstance()->ClearAllCallBacks();
+
+  ASSERT_EQ(live_file_numbers, queued_file_numbers);
+  ASSERT_EQ("bar", Get(0, "foo"));
+  for (int i = 0; i < 3; i++) {
+    ASSERT_EQ("value" + std::to_string(i), Get(1, "key" + std::to_string(i)));
+  }
+  ASSERT_EQ("value2", Get(1, "key"));
+}
+
+TEST_F(DBBasicTest, TableSummaryOpensTablesLazily) {
+  Options options = CurrentOptions();
+  options.max_open_files = -1;
+  options.disable_auto_compactions = true;
+  options.summarize_tables_on_shutdown = true;
+  Reopen(options);
+  for (int i = 0; i < 3; i++) {
+    ASSERT_OK(Put("key" + std::to_string(i), "value" + std::to_string(i)));
+    ASSERT_OK(Put("other" + std::to_string(i), "value"));
+    ASSERT_OK(Flush());
+  }
+  TablePropertiesCollection expected_props;
+  ASSERT_OK(db_->GetPropertiesOfAllTables(&expected_props));
+  ASSERT_EQ(3, expected_props.size());
+
+  std::atomic<int> num_opened{0};
+  SyncPoint::GetInstance()->SetCallBack(
+      "TableCache::GetTableReader:0",
+      [&](void* /*arg*/) { num_opened.fetch_add(1); });
+  SyncPoint::GetInstance()->EnableProcessing();
+  Reopen(options);
+  ASSERT_OK(env_->FileExists(TableSummaryFileName(dbname_)));
+  // The properties come from the summary
+  TablePropertiesCollection props;
+  ASSERT_OK(db_->GetPropertiesOfAllTables(&props));
+  ASSERT_EQ(0, num_opened.load());
+  ASSERT_EQ(expected_props.size(), props.size());
+  for (const auto& expected : expected_props) {
+    auto it = props.find(expected.first);
+    ASSERT_NE(props.end(), it);
+    ASSERT_EQ(expected.second->num_entries, it->second->num_entries);
+    ASSERT_EQ(expected.second->raw_key_size, it->second->raw_key_size);
+    ASSERT_EQ(expected.second->db_session_id, it->second->db_session_id);
+    ASSERT_EQ(expected.second->user_collected_properties,
+              it->second->user_collected_properties);
+  }
+
+  // Each table is opened on its first read
+  ASSERT_EQ("value1", Get("key1"));
+  ASSERT_GE(num_opened.load(), 1);
+  for (int i = 0; i < 3; i++) {
+    ASSERT_EQ("value" + std::to_string(i), Get("key" + std::to_string(i)));
+  }
+  ASSERT_EQ(3, num_opened.load());
+
+  // A corrupted summary is ignored
+  Close();
+  ASSERT_OK(WriteStringToFile(env_, "garbage", TableSummaryFileName(dbname_)));
+  num_opened.store(0);
+  Reopen(options);
+  ASSERT_EQ(3, num_opened.load());
+  SyncPoint::GetInstance()->DisableProcessing();
+  SyncPoint::GetInstance()->ClearAllCallBacks();
+  for (int i = 0; i < 3; i++) {
+    ASSERT_EQ("value" + std::to_string(i), Get("key" + std::to_string(i)));
+  }
+}
+
 TEST_F(DBBasicTest, IdentityAcrossRestarts) {
   constexpr size_t kMinIdSize = 10;
   do {
@@ -1117,6 +1221,57 @@ TEST_F(DBBasicTest, MultiGetSimple) {
   } while (ChangeCompactOptions());
 }
 
+TEST_F(DBBasicTest, GetAsyncAndMultiGetAsync) {
+  Options options = CurrentOptions();
+  options.async_read_threads = 2;
+  Reopen(options);
+  const int kNumKeys = 50;
+  for (int i = 0; i < kNumKeys; i++) {
+    ASSERT_OK(Put(Key(i), "v" + std::to_string(i)));
+    if (i % 10 == 9) {
+      ASSERT_OK(Flush());
+    }
+  }
+
+  ReadOptions read_options;
+  read_options.async_io = true;
+  std::vector<std::string> key_strs;
+  for (int i = 0; i <= kNumKeys; i++) {
+    key_strs.push_back(Key(i));
+  }
+  std::vector<Slice> keys(key_strs.begin(), key_strs.end());
+  std::vector<PinnableSlice> values(keys.size());
+  std::vector<Status> statuses(keys.size());
+  std::promise<void> multiget_done;
+  db_->MultiGetAsync(read_options, db_->DefaultColumnFamily(), keys.size(),
+                     keys.data(), values.data(), statuses.data(),
+                     [&]() { multiget_done.set_value(); });
+
+  PinnableSlice value;
+  std::promise<Status> get_done;
+  db_->GetAsync(read_options, db_->DefaultColumnFamily(), keys[7], &value,
+                [&](const Status& s) { get_done.set_value(s); });
+
+  multiget_done.get_future().wait();
+  for (int i = 0; i < kNumKeys; i++) {
+    ASSERT_OK(statuses[i]);
+    ASSERT_EQ("v" + std::to_string(i), values[i]);
+  }
+  ASSERT_TRUE(statuses[kNumKeys].IsNotFound());
+  ASSERT_OK(get_done.get_future().get());
+  ASSERT_EQ("v7", value);
+
+  // The lookups queued when the DB closes are made before it closes.
+  PinnableSlice queued_value;
+  Status queued_status = Status::Incomplete();
+  db_->GetAsync(read_options, db_->DefaultColumnFamily(), keys[3],
+                &queued_value,
+                [&](const Status& s) { queued_status = s; });
+  Close();
+  ASSERT_OK(queued_status);
+  ASSERT_EQ("v3", queued_value);
+}
+
 TEST_F(DBBasicTest, MultiGetEmpty) {
   do {
     CreateAndReopenWithCF({"pikachu"}, CurrentOptions());
@@ -1788,6 +1943,60 @@ TEST_P(DBMultiGetTestWithParam, MultiGetBatchedSortedMultiFile) {
   } while (ChangeOptions());
 }
 
+TEST_P(DBMultiGetTestWithParam, MultiGetBatchedBlockedHashIndex) {
+#ifndef USE_COROUTINES
+  if (std::get<1>(GetParam())) {
+    ROCKSDB_GTEST_SKIP("This test requires coroutine support");
+    return;
+  }
+#endif  // USE_COROUTINES
+  // Skip for unbatched MultiGet
+  if (!std::get<0>(GetParam())) {
+    ROCKSDB_GTEST_BYPASS("This test is only for batched MultiGet");
+    return;
+  }
+  Options options = CurrentOptions();
+  BlockBasedTableOptions table_options;
+  table_options.block_restart_interval = 4;
+  table_options.data_block_index_type =
+      BlockBasedTableOptions::kDataBlockBinaryAndBlockedHash;
+  options.table_factory.reset(NewBlockBasedTableFactory(table_options));
+  Reopen(options);
+
+  // Many keys per data block, and a newer file deleting some of them
+  const int kNumKeys = 200;
+  for (int i = 0; i < kNumKeys; i += 2) {
+    ASSERT_OK(Put(Key(i), "v" + std::to_string(i)));
+  }
+  ASSERT_OK(Flush());
+  for (int i = 0; i < kNumKeys; i += 10) {
+    ASSERT_OK(Delete(Key(i)));
+  }
+  ASSERT_OK(Flush());
+
+  std::vector<std::string> key_strs;
+  for (int i = 0; i < kNumKeys; ++i) {
+    key_strs.push_back(Key(i));
+  }
+  std::vector<Slice> keys(key_strs.begin(), key_strs.end());
+  std::vector<PinnableSlice> values(keys.size());
+  std::vector<Status> s(keys.size());
+
+  ReadOptions ro;
+  ro.async_io = std::get<1>(GetParam());
+  db_->MultiGet(ro, dbfull()->DefaultColumnFamily(), keys.size(),
+                keys.data(), values.data(), s.data(), true);
+
+  for (int i = 0; i < kNumKeys; ++i) {
+    if (i % 2 == 0 && i % 10 != 0) {
+      ASSERT_OK(s[i]);
+      ASSERT_EQ("v" + std::to_string(i), values[i].ToString());
+    } else {
+      ASSERT_TRUE(s[i].IsNotFound());
+    }
+  }
+}
+
 TEST_P(DBMultiGetTestWithParam, MultiGetBatchedDuplicateKeys) {
 #ifndef USE_COROUTINES
   if (std::get<1>(GetParam())) {
@@ -4816,6 +5025,34 @@ TEST_F(DBBasicTest, VerifyFileChecksumsReadahead) {
             (sst_size + alignment - 1) / (alignment));
 }
 
+TEST_F(DBBasicTest, VerifyChecksumsInParallel) {
+  Options options = GetDefaultOptions();
+  options.create_if_missing = true;
+  options.env = env_;
+  options.disable_auto_compactions = true;
+  options.file_checksum_gen_factory = GetFileChecksumGenCrc32cFactory();
+  DestroyAndReopen(options);
+  for (int i = 0; i < 8; ++i) {
+    ASSERT_OK(Put("key" + std::to_string(i), "value"));
+    ASSERT_OK(Flush());
+  }
+
+  ReadOptions ro;
+  ro.verify_checksum_threads = 4;
+  ASSERT_OK(db_->VerifyChecksum(ro));
+  ASSERT_OK(db_->VerifyFileChecksums(ro));
+
+  // A corrupted file fails the verification whichever thread verifies it
+  std::vector<LiveFileMetaData> files;
+  db_->GetLiveFilesMetaData(&files);
+  ASSERT_EQ(8, files.size());
+  ASSERT_OK(test::CorruptFile(
+      env_, files[3].directory + "/" + files[3].relative_filename, 0, 10,
+      false /* verify_checksum */));
+  ASSERT_TRUE(db_->VerifyFileChecksums(ro).IsCorruption());
+  ASSERT_TRUE(db_->VerifyChecksum(ro).IsCorruption());
+}
+
 // TODO: re-enable after we provide finer-grained control for WAL tracking to
 // meet the needs of different use cases, durability levels and recovery modes.
 TEST_F(DBBasicTest, DISABLED_ManualWalSync) {
@@ -4839,6 +5076,121 @@ TEST_F(DBBasicTest, DISABLED_ManualWalSync) {
   ASSERT_TRUE(TryReopen(options).IsCorruption());
 }
 
+namespace {
+class CollectingOpTraceSink : public OpTraceSink {
+ public:
+  void Export(const OpTrace& trace) override {
+    std::lock_guard<std::mutex> lock(mutex_);
+    traces_.push_back(trace);
+  }
+
+  std::vector<OpTrace> Take() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    std::vector<OpTrace> traces;
+    traces.swap(traces_);
+    return traces;
+  }
+
+ private:
+  std::mutex mutex_;
+  std::vector<OpTrace> traces_;
+};
+
+const OpTraceSpan* FindSpan(const OpTrace& trace, const std::string& name) {
+  for (const auto& span : trace.spans) {
+    if (name == span.name) {
+      return &span;
+    }
+  }
+  return nullptr;
+}
+}  // anonymous namespace
+
+TEST_F(DBBasicTest, OpTrace) {
+  auto sink = std::make_shared<CollectingOpTraceSink>();
+  Options options = CurrentOptions();
+  options.op_trace_sink = sink;
+  options.op_trace_sample_one_in = 1;
+  BlockBasedTableOptions table_options;
+  table_options.filter_policy.reset(NewBloomFilterPolicy(10));
+  options.table_factory.reset(NewBlockBasedTableFactory(table_options));
+  DestroyAndReopen(options);
+  sink->Take();
+
+  WriteOptions write_options;
+  write_options.sync = true;
+  ASSERT_OK(db_->Put(write_options, "a", "1"));
+  std::vector<OpTrace> traces = sink->Take();
+  ASSERT_EQ(traces.size(), 1U);
+  const OpTrace& write = traces[0];
+  ASSERT_STREQ(write.spans[0].name, "Write");
+  ASSERT_EQ(write.spans[0].parent, -1);
+  ASSERT_NE(FindSpan(write, "write_group_wait"), nullptr);
+  ASSERT_NE(FindSpan(write, "wal_write"), nullptr);
+  ASSERT_NE(FindSpan(write, "wal_sync"), nullptr);
+  ASSERT_NE(FindSpan(write, "memtable_insert"), nullptr);
+  for (size_t i = 1; i < write.spans.size(); ++i) {
+    const OpTraceSpan& span = write.spans[i];
+    ASSERT_GE(span.parent, 0);
+    ASSERT_LT(static_cast<size_t>(span.parent), i);
+    const OpTraceSpan& parent = write.spans[span.parent];
+    ASSERT_GE(span.start_nanos, parent.start_nanos);
+    ASSERT_LE(span.start_nanos + span.duration_nanos,
+              parent.start_nanos + parent.duration_nanos);
+  }
+
+  ASSERT_EQ(Get("a"), "1");
+  traces = sink->Take();
+  ASSERT_EQ(traces.size(), 1U);
+  ASSERT_STREQ(traces[0].spans[0].name, "Get");
+  ASSERT_NE(FindSpan(traces[0], "memtable_get"), nullptr);
+  ASSERT_EQ(FindSpan(traces[0], "sst_get"), nullptr);
+
+  ASSERT_OK(Flush());
+  std::vector<LiveFileMetaData> files;
+  db_->GetLiveFilesMetaData(&files);
+  ASSERT_EQ(files.size(), 1U);
+  sink->Take();
+
+  ASSERT_EQ(Get("a"), "1");
+  traces = sink->Take();
+  ASSERT_EQ(traces.size(), 1U);
+  const OpTraceSpan* table_get = FindSpan(traces[0], "table_get");
+  ASSERT_NE(table_get, nullptr);
+  ASSERT_EQ(table_get->file_number, files[0].file_number);
+  ASSERT_STREQ(traces[0].spans[table_get->parent].name, "sst_get");
+  ASSERT_NE(FindSpan(traces[0], "block_cache_lookup"), nullptr);
+  ASSERT_NE(FindSpan(traces[0], "filter"), nullptr);
+  ASSERT_NE(traces[0].ToString().find("table_get"), std::string::npos);
+
+  std::vector<std::string> values;
+  std::vector<Status> statuses =
+      db_->MultiGet(ReadOptions(), {db_->DefaultColumnFamily()},
+                    std::vector<Slice>{"a"}, &values);
+  ASSERT_OK(statuses[0]);
+  traces = sink->Take();
+  ASSERT_EQ(traces.size(), 1U);
+  ASSERT_STREQ(traces[0].spans[0].name, "MultiGet");
+  ASSERT_NE(FindSpan(traces[0], "sst_get"), nullptr);
+
+  {
+    std::unique_ptr<Iterator> iter(db_->NewIterator(ReadOptions()));
+    iter->Seek("a");
+    ASSERT_TRUE(iter->Valid());
+    traces = sink->Take();
+    ASSERT_EQ(traces.size(), 1U);
+    ASSERT_STREQ(traces[0].spans[0].name, "Seek");
+  }
+
+  // Tracing is off without sampling
+  options.op_trace_sample_one_in = 0;
+  Reopen(options);
+  sink->Take();
+  ASSERT_OK(Put("b", "2"));
+  ASSERT_EQ(Get("b"), "2");
+  ASSERT_TRUE(sink->Take().empty());
+}
+
 // A test class for intercepting random reads and injecting artificial
 // delays. Used for testing the deadline/timeout feature
 class DBBasicTestDeadline
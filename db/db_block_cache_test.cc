@@ -466,6 +466,76 @@ TEST_F(DBBlockCacheTest, WarmCacheWithDataBlocksDuringFlush) {
             options.statistics->getTickerCount(BLOCK_CACHE_DATA_ADD));
 }
 
+TEST_F(DBBlockCacheTest, WarmCacheWithHotDataBlocksDuringCompaction) {
+  Options options = CurrentOptions();
+  options.create_if_missing = true;
+  options.disable_auto_compactions = true;
+  options.statistics = ROCKSDB_NAMESPACE::CreateDBStatistics();
+
+  BlockBasedTableOptions table_options;
+  table_options.block_cache = NewLRUCache(1 << 25, 0, false);
+  table_options.cache_index_and_filter_blocks = false;
+  table_options.block_size = 1;
+  table_options.prepopulate_block_cache =
+      BlockBasedTableOptions::PrepopulateBlockCache::kFlushAndHotCompaction;
+  options.table_factory.reset(NewBlockBasedTableFactory(table_options));
+  DestroyAndReopen(options);
+
+  const int kNumKeys = 20;
+  std::string value(kValueSize, 'a');
+  for (int i = 0; i < kNumKeys; i++) {
+    ASSERT_OK(Put(Key(i), value));
+  }
+  ASSERT_OK(Flush());
+  for (int i = 0; i < kNumKeys; i += 2) {
+    ASSERT_OK(Put(Key(i), value));
+  }
+  ASSERT_OK(Flush());
+
+  // Start with an empty block cache and read the first keys only
+  table_options.block_cache = NewLRUCache(1 << 25, 0, false);
+  options.table_factory.reset(NewBlockBasedTableFactory(table_options));
+  Reopen(options);
+  const int kNumHotKeys = 4;
+  for (int i = 0; i < kNumHotKeys; i++) {
+    ASSERT_EQ(value, Get(Key(i)));
+  }
+
+  const uint64_t adds_before =
+      options.statistics->getTickerCount(BLOCK_CACHE_DATA_ADD);
+  ASSERT_OK(db_->CompactRange(CompactRangeOptions(), /*begin=*/nullptr,
+                              /*end=*/nullptr));
+  ASSERT_EQ("0,1", FilesPerLevel());
+  const uint64_t adds =
+      options.statistics->getTickerCount(BLOCK_CACHE_DATA_ADD) - adds_before;
+  ASSERT_GE(adds, static_cast<uint64_t>(kNumHotKeys));
+  ASSERT_LT(adds, static_cast<uint64_t>(kNumKeys));
+
+  // The hot keys are still in the block cache, the others were not inserted
+  const uint64_t misses_before =
+      options.statistics->getTickerCount(BLOCK_CACHE_DATA_MISS);
+  for (int i = 0; i < kNumHotKeys; i++) {
+    ASSERT_EQ(value, Get(Key(i)));
+  }
+  ASSERT_EQ(misses_before,
+            options.statistics->getTickerCount(BLOCK_CACHE_DATA_MISS));
+  ASSERT_EQ(value, Get(Key(kNumKeys - 1)));
+  ASSERT_EQ(misses_before + 1,
+            options.statistics->getTickerCount(BLOCK_CACHE_DATA_MISS));
+
+  // Nothing is inserted without a budget
+  ASSERT_OK(dbfull()->SetOptions(
+      {{"block_based_table_factory",
+        "{prepopulate_block_cache_compaction_budget=0;}"}}));
+  const uint64_t adds_before_no_budget =
+      options.statistics->getTickerCount(BLOCK_CACHE_DATA_ADD);
+  CompactRangeOptions cro;
+  cro.bottommost_level_compaction = BottommostLevelCompaction::kForce;
+  ASSERT_OK(db_->CompactRange(cro, /*begin=*/nullptr, /*end=*/nullptr));
+  ASSERT_EQ(adds_before_no_budget,
+            options.statistics->getTickerCount(BLOCK_CACHE_DATA_ADD));
+}
+
 // This test cache data, index and filter blocks during flush.
 class DBBlockCacheTest1 : public DBTestBase,
                           public ::testing::WithParamInterface<uint32_t> {
@@ -1812,6 +1882,89 @@ INSTANTIATE_TEST_CASE_P(DBBlockCacheKeyTest, DBBlockCacheKeyTest,
                         ::testing::Combine(::testing::Bool(),
                                            ::testing::Bool()));
 
+// Reports the names of the files as their unique ids, which identify their
+// contents in the test since file names are not reused.
+class FileNameUniqueIdFS : public FileSystemWrapper {
+ public:
+  explicit FileNameUniqueIdFS(const std::shared_ptr<FileSystem>& base)
+      : FileSystemWrapper(base) {}
+
+  static const char* kClassName() { return "FileNameUniqueIdFS"; }
+  const char* Name() const override { return kClassName(); }
+
+  IOStatus NewRandomAccessFile(const std::string& fname,
+                               const FileOptions& opts,
+                               std::unique_ptr<FSRandomAccessFile>* result,
+                               IODebugContext* dbg) override {
+    auto s = target()->NewRandomAccessFile(fname, opts, result, dbg);
+    if (s.ok()) {
+      result->reset(new File(std::move(*result), fname));
+    }
+    return s;
+  }
+
+ private:
+  class File : public FSRandomAccessFileOwnerWrapper {
+   public:
+    File(std::unique_ptr<FSRandomAccessFile>&& file, const std::string& fname)
+        : FSRandomAccessFileOwnerWrapper(std::move(file)), id_(fname) {}
+
+    size_t GetUniqueId(char* id, size_t max_size) const override {
+      size_t len = std::min(id_.size(), max_size);
+      memcpy(id, id_.data(), len);
+      return len;
+    }
+
+   private:
+    const std::string id_;
+  };
+};
+
+TEST_F(DBBlockCacheTest, CacheKeysFromFileUniqueId) {
+  auto test_fs = std::make_shared<FileNameUniqueIdFS>(env_->GetFileSystem());
+  std::unique_ptr<Env> test_env(new CompositeEnvWrapper(env_, test_fs));
+
+  Options options = CurrentOptions();
+  options.create_if_missing = true;
+  options.statistics = ROCKSDB_NAMESPACE::CreateDBStatistics();
+  options.env = test_env.get();
+  BlockBasedTableOptions table_options;
+  table_options.block_cache = NewLRUCache(1 << 25, 0, false);
+  table_options.cache_keys_from_file_unique_id = true;
+  options.table_factory.reset(NewBlockBasedTableFactory(table_options));
+
+  // Simulate old files, whose properties do not identify them.
+  ROCKSDB_NAMESPACE::SyncPoint::GetInstance()->SetCallBack(
+      "BlockBasedTableBuilder::BlockBasedTableBuilder:PreSetupBaseCacheKey",
+      [&](void* arg) {
+        TableProperties* props = static_cast<TableProperties*>(arg);
+        props->orig_file_number = 0;
+      });
+  ROCKSDB_NAMESPACE::SyncPoint::GetInstance()->EnableProcessing();
+
+  DestroyAndReopen(options);
+  constexpr int kNumKeys = 2;
+  for (int i = 0; i < kNumKeys; ++i) {
+    ASSERT_OK(Put(Key(i), "abc"));
+    ASSERT_OK(Flush());
+  }
+  for (int i = 0; i < kNumKeys; ++i) {
+    ASSERT_EQ(Get(Key(i)), "abc");
+  }
+  ASSERT_EQ(kNumKeys, options.statistics->getTickerCount(BLOCK_CACHE_DATA_ADD));
+
+  // The new DB session reads the blocks cached by the previous one.
+  Reopen(options);
+  for (int i = 0; i < kNumKeys; ++i) {
+    ASSERT_EQ(Get(Key(i)), "abc");
+  }
+  ASSERT_EQ(kNumKeys, options.statistics->getTickerCount(BLOCK_CACHE_DATA_ADD));
+
+  ROCKSDB_NAMESPACE::SyncPoint::GetInstance()->DisableProcessing();
+  ROCKSDB_NAMESPACE::SyncPoint::GetInstance()->ClearAllCallBacks();
+  Close();
+}
+
 class DBBlockCachePinningTest
     : public DBTestBase,
       public testing::WithParamInterface<
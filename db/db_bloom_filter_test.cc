@@ -3239,6 +3239,67 @@ TEST_F(DBBloomFilterTest, SeekForPrevWithPartitionedFilters) {
   it.reset();
 }
 
+TEST_F(DBBloomFilterTest, SeekPrefetchesPartitions) {
+  Options options = CurrentOptions();
+  options.create_if_missing = true;
+  options.prefix_extractor.reset(NewFixedPrefixTransform(4));
+  options.compression = kNoCompression;
+  BlockBasedTableOptions bbto;
+  bbto.filter_policy.reset(NewBloomFilterPolicy(10));
+  bbto.block_size = 128;
+  bbto.metadata_block_size = 128;
+  bbto.partition_filters = true;
+  bbto.index_type = BlockBasedTableOptions::IndexType::kTwoLevelIndexSearch;
+  bbto.block_cache = NewLRUCache(8 << 20);
+  options.table_factory.reset(NewBlockBasedTableFactory(bbto));
+  DestroyAndReopen(options);
+
+  constexpr int kNumKeys = 2000;
+  for (int i = 0; i < kNumKeys; ++i) {
+    std::ostringstream oss;
+    oss << std::setfill('0') << std::setw(4) << i;
+    ASSERT_OK(Put(oss.str(), std::string(32, 'v')));
+  }
+  ASSERT_OK(Flush());
+
+  int prefetches = 0;
+  SyncPoint::GetInstance()->SetCallBack(
+      "BlockBasedTable::PrefetchPartitions:Read",
+      [&](void* /*arg*/) { ++prefetches; });
+  SyncPoint::GetInstance()->EnableProcessing();
+
+  for (bool async_io : {false, true}) {
+    ReadOptions read_opts;
+    read_opts.async_io = async_io;
+    prefetches = 0;
+    for (int i = 0; i < kNumKeys; i += 97) {
+      // Only the top-level index and filter blocks, owned by the table
+      // reader, stay in memory
+      bbto.block_cache->EraseUnRefEntries();
+      std::unique_ptr<Iterator> it(db_->NewIterator(read_opts));
+      std::ostringstream oss;
+      oss << std::setfill('0') << std::setw(4) << i;
+      it->Seek(oss.str());
+      ASSERT_OK(it->status());
+      ASSERT_TRUE(it->Valid());
+      ASSERT_EQ(oss.str(), it->key());
+      // The partitions read are now cached
+      it->Seek(oss.str());
+      ASSERT_OK(it->status());
+      ASSERT_TRUE(it->Valid());
+      ASSERT_EQ(oss.str(), it->key());
+    }
+    if (async_io) {
+      ASSERT_GT(prefetches, 0);
+    } else {
+      ASSERT_EQ(prefetches, 0);
+    }
+  }
+
+  SyncPoint::GetInstance()->DisableProcessing();
+  SyncPoint::GetInstance()->ClearAllCallBacks();
+}
+
 namespace {
 class BackwardBytewiseComparator : public Comparator {
  public:
@@ -3887,6 +3948,69 @@ TEST_F(DBBloomFilterTest, SstQueryFilter) {
   EXPECT_EQ(TestGetAndResetTickerCount(options, NON_LAST_LEVEL_SEEK_DATA), 0);
 }
 
+TEST_F(DBBloomFilterTest, RangeFilter) {
+  Options options = CurrentOptions();
+  options.statistics = CreateDBStatistics();
+  options.disable_auto_compactions = true;
+  BlockBasedTableOptions table_options;
+  table_options.range_filter_key_width = 8;
+  options.table_factory.reset(NewBlockBasedTableFactory(table_options));
+  DestroyAndReopen(options);
+
+  // Two clusters of keys in each file.
+  for (int i = 0; i < 10; i++) {
+    ASSERT_OK(Put("a00" + std::to_string(i), "val"));
+    ASSERT_OK(Put("c00" + std::to_string(i), "val"));
+  }
+  ASSERT_OK(Flush());
+  for (int i = 0; i < 10; i++) {
+    ASSERT_OK(Put("e00" + std::to_string(i), "val"));
+    ASSERT_OK(Put("g00" + std::to_string(i), "val"));
+  }
+  ASSERT_OK(Flush());
+  MoveFilesToLevel(1);
+  ASSERT_EQ("0,2", FilesPerLevel());
+
+  using Keys = std::vector<std::string>;
+  auto RangeQueryKeys = [&](const std::string& lb, const std::string& ub) {
+    Slice ub_slice = ub;
+    ReadOptions ro;
+    ro.iterate_upper_bound = &ub_slice;
+    std::unique_ptr<Iterator> it(db_->NewIterator(ro));
+    Keys ret;
+    for (it->Seek(lb); it->Valid(); it->Next()) {
+      ret.push_back(it->key().ToString());
+    }
+    EXPECT_OK(it->status());
+    return ret;
+  };
+
+  // Ranges with keys are not filtered out.
+  EXPECT_EQ(RangeQueryKeys("a005", "a008"), Keys({"a005", "a006", "a007"}));
+  EXPECT_EQ(RangeQueryKeys("b", "c002"), Keys({"c000", "c001"}));
+  EXPECT_EQ(RangeQueryKeys("c008", "e001"), Keys({"c008", "c009", "e000"}));
+  EXPECT_EQ(TestGetAndResetTickerCount(options, NON_LAST_LEVEL_SEEK_FILTERED),
+            0);
+
+  // The gaps between the clusters are filtered out without reading any data
+  // block.
+  uint64_t data_misses = TestGetTickerCount(options, BLOCK_CACHE_DATA_MISS);
+  EXPECT_EQ(RangeQueryKeys("a1", "b9"), Keys({}));
+  EXPECT_EQ(RangeQueryKeys("e1", "f9"), Keys({}));
+  EXPECT_EQ(TestGetAndResetTickerCount(options, NON_LAST_LEVEL_SEEK_FILTERED),
+            2);
+  EXPECT_EQ(TestGetTickerCount(options, BLOCK_CACHE_DATA_MISS), data_misses);
+
+  // Without an upper bound, the filter is not used.
+  ReadOptions ro;
+  std::unique_ptr<Iterator> it(db_->NewIterator(ro));
+  it->Seek("a1");
+  ASSERT_TRUE(it->Valid());
+  ASSERT_EQ("c000", it->key());
+  EXPECT_EQ(TestGetAndResetTickerCount(options, NON_LAST_LEVEL_SEEK_FILTERED),
+            0);
+}
+
 }  // namespace ROCKSDB_NAMESPACE
 
 int main(int argc, char** argv) {
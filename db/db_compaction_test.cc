@@ -1087,6 +1087,54 @@ TEST_F(DBCompactionTest, CompactionSstPartitioner) {
   ASSERT_EQ("B", Get("bbbb1"));
 }
 
+TEST_F(DBCompactionTest, CompactionSstPartitionerShardBoundaries) {
+  Options options = CurrentOptions();
+  options.compaction_style = kCompactionStyleLevel;
+  options.level0_file_num_compaction_trigger = 3;
+  auto factory = NewSstPartitionerShardBoundariesFactory(
+      options.comparator, {"k3", "k6"});
+  options.sst_partitioner_factory = factory;
+
+  DestroyAndReopen(options);
+
+  for (int i = 0; i < 9; i++) {
+    ASSERT_OK(Put("k" + std::to_string(i), "v" + std::to_string(i)));
+  }
+  ASSERT_OK(Flush());
+  ASSERT_OK(dbfull()->CompactRange(CompactRangeOptions(), nullptr, nullptr));
+
+  // One file per shard, starting at its boundary.
+  auto check_files = [&](const std::vector<std::string>& smallest_keys) {
+    std::vector<LiveFileMetaData> files;
+    dbfull()->GetLiveFilesMetaData(&files);
+    std::vector<std::string> smallest;
+    for (const auto& file : files) {
+      smallest.push_back(file.smallestkey);
+    }
+    std::sort(smallest.begin(), smallest.end());
+    ASSERT_EQ(smallest_keys, smallest);
+  };
+  check_files({"k0", "k3", "k6"});
+
+  // A new boundary applies to the next compactions.
+  factory->SetBoundaries({"k6", "k3", "k5"});
+  CompactRangeOptions cro;
+  cro.bottommost_level_compaction = BottommostLevelCompaction::kForce;
+  ASSERT_OK(dbfull()->CompactRange(cro, nullptr, nullptr));
+  check_files({"k0", "k3", "k5", "k6"});
+
+  for (int i = 0; i < 9; i++) {
+    ASSERT_EQ("v" + std::to_string(i), Get("k" + std::to_string(i)));
+  }
+
+  std::unique_ptr<SstPartitioner> partitioner =
+      factory->CreatePartitioner(SstPartitioner::Context());
+  ASSERT_TRUE(partitioner->CanDoTrivialMove("k3", "k4"));
+  ASSERT_TRUE(partitioner->CanDoTrivialMove("k7", "k9"));
+  ASSERT_FALSE(partitioner->CanDoTrivialMove("k4", "k5"));
+  ASSERT_FALSE(partitioner->CanDoTrivialMove("k0", "k9"));
+}
+
 TEST_F(DBCompactionTest, CompactionSstPartitionWithManualCompaction) {
   Options options = CurrentOptions();
   options.compaction_style = kCompactionStyleLevel;
@@ -1441,6 +1489,56 @@ TEST_P(DBCompactionTestWithParam, TrivialMoveNonOverlappingFiles) {
   ROCKSDB_NAMESPACE::SyncPoint::GetInstance()->DisableProcessing();
 }
 
+TEST_F(DBCompactionTest, BatchedTrivialMoves) {
+  int32_t trivial_move = 0;
+  int32_t batched_trivial_move = 0;
+  int32_t non_trivial_move = 0;
+  ROCKSDB_NAMESPACE::SyncPoint::GetInstance()->SetCallBack(
+      "DBImpl::BackgroundCompaction:TrivialMove",
+      [&](void* /*arg*/) { trivial_move++; });
+  ROCKSDB_NAMESPACE::SyncPoint::GetInstance()->SetCallBack(
+      "DBImpl::BackgroundCompaction:BatchedTrivialMove",
+      [&](void* /*arg*/) { batched_trivial_move++; });
+  ROCKSDB_NAMESPACE::SyncPoint::GetInstance()->SetCallBack(
+      "DBImpl::BackgroundCompaction:NonTrivial",
+      [&](void* /*arg*/) { non_trivial_move++; });
+  ROCKSDB_NAMESPACE::SyncPoint::GetInstance()->EnableProcessing();
+
+  Options options = CurrentOptions();
+  options.disable_auto_compactions = true;
+  options.num_levels = 3;
+  options.level_compaction_dynamic_level_bytes = false;
+  options.trivial_move_batch_size = 10;
+  DestroyAndReopen(options);
+
+  const int kNumFiles = 5;
+  for (int i = 0; i < kNumFiles; i++) {
+    for (int j = 0; j < 10; j++) {
+      ASSERT_OK(Put(Key(i * 10 + j), "value"));
+    }
+    ASSERT_OK(Flush());
+  }
+  // Moves the non-overlapping files to L1
+  ASSERT_OK(db_->CompactRange(CompactRangeOptions(), nullptr, nullptr));
+  ASSERT_EQ("0," + std::to_string(kNumFiles), FilesPerLevel());
+  ASSERT_EQ(1, trivial_move);
+  trivial_move = 0;
+
+  // L1 is over its target size with any file, so each file is picked for a
+  // move of its own to L2, and all of them are applied together
+  ASSERT_OK(dbfull()->SetOptions({{"max_bytes_for_level_base", "1"},
+                                  {"disable_auto_compactions", "false"}}));
+  ASSERT_OK(dbfull()->TEST_WaitForCompact());
+  ASSERT_EQ("0,0," + std::to_string(kNumFiles), FilesPerLevel());
+  ASSERT_EQ(1, trivial_move);
+  ASSERT_EQ(kNumFiles - 1, batched_trivial_move);
+  ASSERT_EQ(0, non_trivial_move);
+  for (int i = 0; i < kNumFiles * 10; i++) {
+    ASSERT_EQ("value", Get(Key(i)));
+  }
+  ROCKSDB_NAMESPACE::SyncPoint::GetInstance()->DisableProcessing();
+}
+
 TEST_P(DBCompactionTestWithParam, TrivialMoveTargetLevel) {
   int32_t trivial_move = 0;
   int32_t non_trivial_move = 0;
@@ -10241,6 +10339,141 @@ TEST_F(DBCompactionTest, VerifyRecordCount) {
   ASSERT_TRUE(std::strstr(s.getState(), expect));
 }
 
+TEST_F(DBCompactionTest, DecompressionThreads) {
+  if (!Zlib_Supported()) {
+    ROCKSDB_GTEST_SKIP("Test requires Zlib support");
+    return;
+  }
+  Options options = CurrentOptions();
+  options.compression = kZlibCompression;
+  options.disable_auto_compactions = true;
+  BlockBasedTableOptions table_options;
+  table_options.block_size = 1024;
+  table_options.compaction_decompression_threads = 2;
+  options.table_factory.reset(NewBlockBasedTableFactory(table_options));
+  DestroyAndReopen(options);
+
+  // Create 2 overlapping L0 files of many compressed blocks
+  for (int i = 0; i < 2000; i += 2) {
+    ASSERT_OK(Put(Key(i), std::string(100, 'a' + i % 26)));
+  }
+  ASSERT_OK(Flush());
+  for (int i = 1; i < 2000; i += 2) {
+    ASSERT_OK(Put(Key(i), std::string(100, 'a' + i % 26)));
+  }
+  ASSERT_OK(Flush());
+
+  std::atomic<int> num_blocks{0};
+  SyncPoint::GetInstance()->SetCallBack(
+      "BlockDecompressionPipeline::GetBlock:Hit",
+      [&](void* /*arg*/) { num_blocks++; });
+  SyncPoint::GetInstance()->EnableProcessing();
+
+  ASSERT_OK(db_->CompactRange(CompactRangeOptions(), nullptr, nullptr));
+  SyncPoint::GetInstance()->DisableProcessing();
+  SyncPoint::GetInstance()->ClearAllCallBacks();
+  ASSERT_GT(num_blocks.load(), 2);
+
+  ASSERT_EQ("0,1", FilesPerLevel());
+  for (int i = 0; i < 2000; i++) {
+    ASSERT_EQ(std::string(100, 'a' + i % 26), Get(Key(i)));
+  }
+}
+
+TEST_F(DBCompactionTest, BlockPassthrough) {
+  if (!Zlib_Supported()) {
+    ROCKSDB_GTEST_SKIP("Test requires Zlib support");
+    return;
+  }
+  Options options = CurrentOptions();
+  options.compression = kZlibCompression;
+  options.disable_auto_compactions = true;
+  BlockBasedTableOptions table_options;
+  table_options.block_size = 1024;
+  table_options.compaction_block_passthrough = true;
+  options.table_factory.reset(NewBlockBasedTableFactory(table_options));
+  DestroyAndReopen(options);
+
+  std::atomic<int> num_passthrough{0};
+  SyncPoint::GetInstance()->SetCallBack(
+      "BlockBasedTableBuilder::Flush:PassthroughBlock",
+      [&](void* /*arg*/) { num_passthrough++; });
+  SyncPoint::GetInstance()->EnableProcessing();
+
+  // The keys get their sequence numbers zeroed out in the last level, which
+  // changes every block
+  for (int i = 0; i < 1000; i++) {
+    ASSERT_OK(Put(Key(i), std::string(100, 'a' + i % 26)));
+  }
+  ASSERT_OK(Flush());
+  CompactRangeOptions cro;
+  cro.bottommost_level_compaction = BottommostLevelCompaction::kForce;
+  ASSERT_OK(db_->CompactRange(cro, nullptr, nullptr));
+  ASSERT_EQ(0, num_passthrough.load());
+
+  // The blocks of the last level file that no new key falls in are copied
+  for (int i = 1000; i < 2000; i++) {
+    ASSERT_OK(Put(Key(i), std::string(100, 'a' + i % 26)));
+  }
+  ASSERT_OK(Flush());
+  ASSERT_OK(db_->CompactRange(cro, nullptr, nullptr));
+  SyncPoint::GetInstance()->DisableProcessing();
+  SyncPoint::GetInstance()->ClearAllCallBacks();
+  ASSERT_GT(num_passthrough.load(), 10);
+
+  for (int i = 0; i < 2000; i++) {
+    ASSERT_EQ(std::string(100, 'a' + i % 26), Get(Key(i)));
+  }
+  ASSERT_OK(db_->VerifyChecksum());
+}
+
+TEST_F(DBCompactionTest, LoserTreeMergeOfManySortedRuns) {
+  Options options = CurrentOptions();
+  options.disable_auto_compactions = true;
+  options.use_loser_tree_in_compaction = true;
+  DestroyAndReopen(options);
+
+  // Keys interleaved between the L0 files, some of them overwritten, deleted
+  // or covered by range tombstones
+  constexpr int kNumFiles = 37;
+  constexpr int kNumKeys = 2000;
+  Random rnd(301);
+  std::map<std::string, std::string> expected;
+  for (int file = 0; file < kNumFiles; file++) {
+    for (int i = file; i < kNumKeys; i += kNumFiles - file % 3) {
+      if (i % 11 == 0) {
+        ASSERT_OK(Delete(Key(i)));
+        expected.erase(Key(i));
+      } else {
+        std::string value = rnd.RandomString(10);
+        ASSERT_OK(Put(Key(i), value));
+        expected[Key(i)] = value;
+      }
+    }
+    if (file % 5 == 4) {
+      const int begin = static_cast<int>(rnd.Uniform(kNumKeys));
+      ASSERT_OK(db_->DeleteRange(WriteOptions(), Key(begin), Key(begin + 20)));
+      expected.erase(expected.lower_bound(Key(begin)),
+                     expected.lower_bound(Key(begin + 20)));
+    }
+    ASSERT_OK(Flush());
+  }
+  ASSERT_EQ(kNumFiles, NumTableFilesAtLevel(0));
+
+  ASSERT_OK(db_->CompactRange(CompactRangeOptions(), nullptr, nullptr));
+  ASSERT_EQ(0, NumTableFilesAtLevel(0));
+
+  std::unique_ptr<Iterator> iter(db_->NewIterator(ReadOptions()));
+  auto expected_it = expected.begin();
+  for (iter->SeekToFirst(); iter->Valid(); iter->Next(), ++expected_it) {
+    ASSERT_TRUE(expected_it != expected.end());
+    ASSERT_EQ(expected_it->first, iter->key().ToString());
+    ASSERT_EQ(expected_it->second, iter->value().ToString());
+  }
+  ASSERT_OK(iter->status());
+  ASSERT_TRUE(expected_it == expected.end());
+}
+
 TEST_F(DBCompactionTest, ErrorWhenReadFileHead) {
   // This is to test a bug that is fixed in
   // https://github.com/facebook/rocksdb/pull/11782.
@@ -310,6 +310,52 @@ TEST_F(DBFlushTest, ScheduleOnlyOneBgThread) {
 // memtable. Compression is another factor to make SST file smaller than
 // corresponding memtable, since data in memtable is uncompressed.
 
+TEST_F(DBFlushTest, SplitFlushIntoKeyRanges) {
+  Options options = CurrentOptions();
+  options.disable_auto_compactions = true;
+  options.write_buffer_size = 64 << 20;
+  options.max_background_flushes = 4;
+  options.max_flush_subjobs = 4;
+  options.env = env_;
+  Reopen(options);
+
+  Random rnd(301);
+  const int kNumKeys = 8000;
+  std::vector<std::string> values(kNumKeys);
+  for (int i = 0; i < kNumKeys; i++) {
+    values[i] = rnd.RandomString(1000);
+    ASSERT_OK(Put(Key(i), values[i]));
+  }
+  // Several versions of some keys, which stay in the same file.
+  for (int i = 0; i < kNumKeys; i += 7) {
+    values[i] = rnd.RandomString(10);
+    ASSERT_OK(Put(Key(i), values[i]));
+  }
+  ASSERT_OK(Flush());
+
+  // About 8MB of memtable entries, split into four key ranges.
+  ASSERT_EQ(4, NumTableFilesAtLevel(0));
+  std::vector<LiveFileMetaData> files;
+  db_->GetLiveFilesMetaData(&files);
+  ASSERT_EQ(4, files.size());
+  std::sort(files.begin(), files.end(),
+            [](const LiveFileMetaData& a, const LiveFileMetaData& b) {
+              return a.smallestkey < b.smallestkey;
+            });
+  for (size_t i = 0; i + 1 < files.size(); i++) {
+    ASSERT_LT(files[i].largestkey, files[i + 1].smallestkey);
+    ASSERT_EQ(files[i].epoch_number, files[i + 1].epoch_number);
+  }
+
+  for (int i = 0; i < kNumKeys; i++) {
+    ASSERT_EQ(values[i], Get(Key(i)));
+  }
+  Reopen(options);
+  for (int i = 0; i < kNumKeys; i++) {
+    ASSERT_EQ(values[i], Get(Key(i)));
+  }
+}
+
 TEST_F(DBFlushTest, StatisticsGarbageBasic) {
   Options options = CurrentOptions();
 
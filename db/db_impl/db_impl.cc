@@ -44,6 +44,7 @@
 #include "db/malloc_stats.h"
 #include "db/memtable.h"
 #include "db/memtable_list.h"
+#include "db/memtable_snapshot.h"
 #include "db/merge_context.h"
 #include "db/multi_cf_iterator.h"
 #include "db/periodic_task_scheduler.h"
@@ -66,6 +67,7 @@
 #include "monitoring/in_memory_stats_history.h"
 #include "monitoring/instrumented_mutex.h"
 #include "monitoring/iostats_context_imp.h"
+#include "monitoring/op_trace_impl.h"
 #include "monitoring/perf_context_imp.h"
 #include "monitoring/persistent_stats_history.h"
 #include "monitoring/thread_status_updater.h"
@@ -77,6 +79,7 @@
 #include "port/jemalloc_helper.h"
 #endif
 #include "port/port.h"
+#include "rocksdb/auto_tuner.h"
 #include "rocksdb/cache.h"
 #include "rocksdb/compaction_filter.h"
 #include "rocksdb/db.h"
@@ -274,6 +277,17 @@ DBImpl::DBImpl(const DBOptions& options, const std::string& dbname,
   // dealt with
   co.hash_seed = 0;
   table_cache_ = NewLRUCache(co);
+  if (immutable_db_options_.merge_result_cache) {
+    PutVarint64(&merge_result_cache_id_,
+                immutable_db_options_.merge_result_cache->NewId());
+  }
+  if (immutable_db_options_.iterator_memory_cache) {
+    iterator_memory_cache_res_mgr_ =
+        std::make_shared<ConcurrentCacheReservationManager>(
+            std::make_shared<
+                CacheReservationManagerImpl<CacheEntryRole::kIterator>>(
+                immutable_db_options_.iterator_memory_cache));
+  }
   SetDbSessionId();
   assert(!db_session_id_.empty());
 
@@ -287,6 +301,8 @@ DBImpl::DBImpl(const DBOptions& options, const std::string& dbname,
       PeriodicTaskType::kRecordSeqnoTime, [this]() {
         this->RecordSeqnoToTimeMapping(/*populate_historical_seconds=*/0);
       });
+  periodic_task_functions_.emplace(PeriodicTaskType::kAutoTune,
+                                   [this]() { this->AutoTune(); });
 
   versions_.reset(new VersionSet(
       dbname_, &immutable_db_options_, file_options_, table_cache_.get(),
@@ -306,6 +322,12 @@ DBImpl::DBImpl(const DBOptions& options, const std::string& dbname,
                             std::memory_order_relaxed);
   if (write_buffer_manager_) {
     wbm_stall_.reset(new WBMStallInterface());
+    if (immutable_db_options_.write_buffer_manager_weight > 0) {
+      wbm_tenant_ = write_buffer_manager_->RegisterTenant(
+          immutable_db_options_.write_buffer_manager_weight);
+      versions_->GetColumnFamilySet()->set_write_buffer_manager_tenant(
+          wbm_tenant_);
+    }
   }
 }
 
@@ -531,6 +553,11 @@ Status DBImpl::MaybeReleaseTimestampedSnapshotsAndCheck() {
 }
 
 Status DBImpl::CloseHelper() {
+  // The writes and lookups queued by WriteAsync(), GetAsync() and
+  // MultiGetAsync() are made while the DB is still open.
+  StopAsyncWrites();
+  StopAsyncReads();
+
   // Guarantee that there is no background error recovery in progress before
   // continuing with the shutdown
   mutex_.Lock();
@@ -627,11 +654,13 @@ Status DBImpl::CloseHelper() {
     job_context.Clean();
     mutex_.Lock();
   }
+  bool had_wals = false;
   {
     InstrumentedMutexLock lock(&log_write_mutex_);
     for (auto l : logs_to_free_) {
       delete l;
     }
+    had_wals = !logs_.empty();
     for (auto& log : logs_) {
       uint64_t log_number = log.writer->get_log_number();
       Status s = log.ClearWriter();
@@ -649,6 +678,11 @@ Status DBImpl::CloseHelper() {
     }
     logs_.clear();
   }
+  // Only a DB opened for writes has WALs
+  if (opened_successfully_ && had_wals) {
+    MaybeWriteMemTableSnapshot();
+    MaybeWriteTableSummary();
+  }
 
   // Table cache may have table handles holding blocks from the block cache.
   // We need to release them before the block cache is destroyed. The block
@@ -712,6 +746,9 @@ Status DBImpl::CloseHelper() {
   if (write_buffer_manager_ && wbm_stall_) {
     write_buffer_manager_->RemoveDBFromQueue(wbm_stall_.get());
   }
+  if (write_buffer_manager_ && wbm_tenant_) {
+    write_buffer_manager_->UnregisterTenant(wbm_tenant_.get());
+  }
 
   IOStatus io_s = directories_.Close(IOOptions(), nullptr /* dbg */);
   if (!io_s.ok()) {
@@ -727,6 +764,132 @@ Status DBImpl::CloseHelper() {
   return ret;
 }
 
+void DBImpl::MaybeWriteMemTableSnapshot() {
+  mutex_.AssertHeld();
+  if (!immutable_db_options_.snapshot_memtables_on_shutdown || allow_2pc() ||
+      immutable_db_options_.wal_filter != nullptr ||
+      has_unpersisted_data_.load(std::memory_order_relaxed) ||
+      !error_handler_.GetBGError().ok()) {
+    return;
+  }
+  bool has_data = false;
+  for (auto cfd : *versions_->GetColumnFamilySet()) {
+    if (!cfd->IsDropped() &&
+        (!cfd->mem()->IsEmpty() || cfd->imm()->NumNotFlushed() > 0)) {
+      has_data = true;
+      break;
+    }
+  }
+  if (!has_data) {
+    return;
+  }
+
+  // The WALs the next recovery would replay
+  MemTableSnapshotHeader header;
+  header.db_id = db_id_;
+  header.last_sequence = versions_->LastSequence();
+  const std::string& wal_dir = immutable_db_options_.GetWalDir();
+  const uint64_t min_wal_number = versions_->MinLogNumberWithUnflushedData();
+  std::vector<std::string> filenames;
+  IOStatus io_s = fs_->GetChildren(wal_dir, IOOptions(), &filenames, nullptr);
+  for (const auto& filename : filenames) {
+    if (!io_s.ok()) {
+      break;
+    }
+    uint64_t number = 0;
+    FileType type;
+    if (ParseFileName(filename, &number, &type) && type == kWalFile &&
+        number >= min_wal_number) {
+      uint64_t size = 0;
+      io_s = fs_->GetFileSize(LogFileName(wal_dir, number), IOOptions(), &size,
+                              nullptr);
+      header.wals.emplace_back(number, size);
+    }
+  }
+  std::sort(header.wals.begin(), header.wals.end());
+
+  const std::string fname = MemTableSnapshotFileName(dbname_);
+  const std::string tmp_fname = fname + ".tmp";
+  uint64_t num_entries = 0;
+  Status s = io_s;
+  if (s.ok()) {
+    s = WriteMemTableSnapshot(
+        fs_.get(), immutable_db_options_.clock, file_options_,
+        immutable_db_options_.use_fsync, tmp_fname, header,
+        versions_->GetColumnFamilySet(), &num_entries);
+  }
+  if (s.ok()) {
+    s = fs_->RenameFile(tmp_fname, fname, IOOptions(), nullptr);
+  }
+  if (s.ok() && directories_.GetDbDir() != nullptr) {
+    s = directories_.GetDbDir()->FsyncWithDirOptions(
+        IOOptions(), nullptr, DirFsyncOptions(fname));
+  }
+  if (s.ok()) {
+    ROCKS_LOG_INFO(immutable_db_options_.info_log,
+                   "Wrote memtable snapshot of %" PRIu64
+                   " entries up to seq #%" PRIu64,
+                   num_entries, header.last_sequence);
+  } else {
+    // The next recovery replays the WALs
+    ROCKS_LOG_WARN(immutable_db_options_.info_log,
+                   "Unable to write memtable snapshot: %s",
+                   s.ToString().c_str());
+    fs_->DeleteFile(tmp_fname, IOOptions(), nullptr).PermitUncheckedError();
+    fs_->DeleteFile(fname, IOOptions(), nullptr).PermitUncheckedError();
+  }
+}
+
+void DBImpl::MaybeWriteTableSummary() {
+  mutex_.AssertHeld();
+  if (!immutable_db_options_.summarize_tables_on_shutdown) {
+    return;
+  }
+  TableSummary table_summary;
+  for (auto cfd : *versions_->GetColumnFamilySet()) {
+    if (cfd->IsDropped()) {
+      continue;
+    }
+    const VersionStorageInfo* vstorage = cfd->current()->storage_info();
+    for (int level = 0; level < vstorage->num_levels(); level++) {
+      for (FileMetaData* f : vstorage->LevelFiles(level)) {
+        // The files only opened through the table cache are left out
+        std::shared_ptr<const TableProperties> props =
+            f->fd.table_reader != nullptr
+                ? f->fd.table_reader->GetTableProperties()
+                : versions_->GetSummarizedTableProperties(*f);
+        if (props != nullptr) {
+          table_summary.Add(*f, std::move(props));
+        }
+      }
+    }
+  }
+
+  const std::string fname = TableSummaryFileName(dbname_);
+  const std::string tmp_fname = fname + ".tmp";
+  Status s = table_summary.WriteToFile(fs_.get(), immutable_db_options_.clock,
+                                       file_options_,
+                                       immutable_db_options_.use_fsync,
+                                       tmp_fname);
+  if (s.ok()) {
+    s = fs_->RenameFile(tmp_fname, fname, IOOptions(), nullptr);
+  }
+  if (s.ok() && directories_.GetDbDir() != nullptr) {
+    s = directories_.GetDbDir()->FsyncWithDirOptions(
+        IOOptions(), nullptr, DirFsyncOptions(fname));
+  }
+  if (s.ok()) {
+    ROCKS_LOG_INFO(immutable_db_options_.info_log,
+                   "Wrote table summary of %" ROCKSDB_PRIszt " files",
+                   table_summary.NumFiles());
+  } else {
+    // A summary left from before still matches the files it lists
+    ROCKS_LOG_WARN(immutable_db_options_.info_log,
+                   "Unable to write table summary: %s", s.ToString().c_str());
+    fs_->DeleteFile(tmp_fname, IOOptions(), nullptr).PermitUncheckedError();
+  }
+}
+
 Status DBImpl::CloseImpl() { return CloseHelper(); }
 
 DBImpl::~DBImpl() {
@@ -817,6 +980,17 @@ Status DBImpl::StartPeriodicTaskScheduler() {
     }
   }
 
+  if (immutable_db_options_.auto_tuner != nullptr &&
+      immutable_db_options_.auto_tuner->PeriodSec() > 0) {
+    Status s = periodic_task_scheduler_.Register(
+        PeriodicTaskType::kAutoTune,
+        periodic_task_functions_.at(PeriodicTaskType::kAutoTune),
+        immutable_db_options_.auto_tuner->PeriodSec());
+    if (!s.ok()) {
+      return s;
+    }
+  }
+
   Status s = periodic_task_scheduler_.Register(
       PeriodicTaskType::kFlushInfoLog,
       periodic_task_functions_.at(PeriodicTaskType::kFlushInfoLog));
@@ -1206,6 +1380,31 @@ void DBImpl::FlushInfoLog() {
   LogFlush(immutable_db_options_.info_log);
 }
 
+void DBImpl::AutoTune() {
+  if (shutdown_initiated_) {
+    return;
+  }
+  TEST_SYNC_POINT("DBImpl::AutoTune:StartRunning");
+  // The handles unref their column family with the DB mutex, so they are
+  // destroyed after it is released
+  std::vector<std::unique_ptr<ColumnFamilyHandleImpl>> handles;
+  {
+    InstrumentedMutexLock l(&mutex_);
+    for (auto cfd : *versions_->GetColumnFamilySet()) {
+      if (!cfd->IsDropped() && cfd->initialized() &&
+          cfd->GetName() != kPersistentStatsColumnFamilyName) {
+        handles.emplace_back(new ColumnFamilyHandleImpl(cfd, this, &mutex_));
+      }
+    }
+  }
+  std::vector<ColumnFamilyHandle*> cfs;
+  cfs.reserve(handles.size());
+  for (const auto& handle : handles) {
+    cfs.push_back(handle.get());
+  }
+  immutable_db_options_.auto_tuner->Tune(this, cfs);
+}
+
 Status DBImpl::TablesRangeTombstoneSummary(ColumnFamilyHandle* column_family,
                                            int max_entries_to_print,
                                            std::string* out_str) {
@@ -1318,6 +1517,61 @@ std::string DescribeVersionEdit(const VersionEdit& e, ColumnFamilyData* cfd) {
 
 }  // namespace
 
+Status DBImpl::InsertReplicatedWriteBatch(const WriteBatch& batch,
+                                          bool concurrent,
+                                          SequenceNumber* next_seq) {
+  // Below this many entries per thread, starting the threads costs more than
+  // the inserts.
+  constexpr uint32_t kMinEntriesPerThread = 1024;
+  std::vector<WriteBatch> parts;
+  if (concurrent && immutable_db_options_.allow_concurrent_memtable_write &&
+      !seq_per_batch_) {
+    size_t max_parts = std::min<size_t>(
+        std::max(port::Thread::hardware_concurrency(), 1U),
+        WriteBatchInternal::Count(&batch) / kMinEntriesPerThread);
+    WriteBatchInternal::Partition(batch, max_parts, &parts);
+  }
+  if (parts.empty()) {
+    return WriteBatchInternal::InsertInto(
+        &batch, column_family_memtables_.get(), &flush_scheduler_,
+        &trim_history_scheduler_, true /* ignore_missing_column_families_ */,
+        0 /* log_number */, this, false /* concurrent_memtable_writes */,
+        next_seq, nullptr /* has_valid_writes */, seq_per_batch_,
+        batch_per_txn_);
+  }
+
+  // Each part is inserted with its own ColumnFamilyMemTables, as it caches
+  // the column family last looked up.
+  std::vector<Status> statuses(parts.size());
+  auto insert_part = [&](size_t i) {
+    ColumnFamilyMemTablesImpl column_family_memtables(
+        versions_->GetColumnFamilySet());
+    statuses[i] = WriteBatchInternal::InsertInto(
+        &parts[i], &column_family_memtables, &flush_scheduler_,
+        &trim_history_scheduler_, true /* ignore_missing_column_families_ */,
+        0 /* log_number */, this, true /* concurrent_memtable_writes */,
+        nullptr /* next_seq */, nullptr /* has_valid_writes */, seq_per_batch_,
+        batch_per_txn_);
+  };
+  std::vector<port::Thread> threads;
+  threads.reserve(parts.size() - 1);
+  for (size_t i = 1; i < parts.size(); i++) {
+    threads.emplace_back(insert_part, i);
+  }
+  insert_part(0);
+  for (auto& t : threads) {
+    t.join();
+  }
+  for (const auto& st : statuses) {
+    if (!st.ok()) {
+      return st;
+    }
+  }
+  *next_seq =
+      WriteBatchInternal::Sequence(&batch) + WriteBatchInternal::Count(&batch);
+  return Status::OK();
+}
+
 Status DBImpl::ApplyReplicationLogRecord(ReplicationLogRecord record,
                                          std::string replication_sequence,
                                          CFOptionsFactory cf_options_factory,
@@ -1325,9 +1579,22 @@ Status DBImpl::ApplyReplicationLogRecord(ReplicationLogRecord record,
                                          ApplyReplicationLogRecordInfo* info,
                                          unsigned flags) {
   JobContext job_context(0, false);
-  Status s;
+  Status s = UncompressReplicationLogRecord(&record);
+  if (!s.ok()) {
+    return s;
+  }
   bool evictObsoleteFiles = flags & AR_EVICT_OBSOLETE_FILES;
 
+  Histograms apply_histogram = REPLICATION_MEMTABLE_WRITE_APPLY_MICROS;
+  if (record.type == ReplicationLogRecord::kMemtableSwitch) {
+    apply_histogram = REPLICATION_MEMTABLE_SWITCH_APPLY_MICROS;
+  } else if (record.type == ReplicationLogRecord::kManifestWrite) {
+    apply_histogram = REPLICATION_MANIFEST_WRITE_APPLY_MICROS;
+  }
+  StopWatch apply_sw(immutable_db_options_.clock, stats_, apply_histogram);
+  RecordTick(stats_, REPLICATION_RECORDS_APPLIED);
+  RecordTick(stats_, REPLICATION_BYTES_APPLIED, record.contents.size());
+
   {
     WriteThread::Writer w;
     InstrumentedMutexLock l(&mutex_);
@@ -1351,12 +1618,8 @@ Status DBImpl::ApplyReplicationLogRecord(ReplicationLogRecord record,
 
         SequenceNumber next_seq{0};
         if (s.ok()) {
-          s = WriteBatchInternal::InsertInto(
-              &batch, column_family_memtables_.get(), &flush_scheduler_,
-              &trim_history_scheduler_,
-              true /* ignore_missing_column_families_ */, 0 /* log_number */,
-              this, false /* concurrent_memtable_writes */, &next_seq,
-              nullptr /* has_valid_writes */, seq_per_batch_, batch_per_txn_);
+          s = InsertReplicatedWriteBatch(
+              batch, flags & AR_CONCURRENT_MEMTABLE_WRITES, &next_seq);
         }
         if (s.ok()) {
           versions_->SetLastSequence(next_seq - 1);
@@ -1646,6 +1909,11 @@ Status DBImpl::ApplyReplicationLogRecord(ReplicationLogRecord record,
       }
     }
 
+    if (s.ok()) {
+      last_applied_replication_sequence_ = replication_sequence;
+      last_applied_replication_time_ =
+          immutable_db_options_.clock->NowMicros() / kMicrosInSecond;
+    }
     write_thread_.ExitUnbatched(&w);
   }
 
@@ -1721,10 +1989,14 @@ Status DBImpl::CheckNextEpochNumberConsistency(const VersionEdit& e, ColumnFamil
 }
 
 Status DBImpl::GetReplicationRecordDebugString(
-    const ReplicationLogRecord& record, std::string* out) const {
+    const ReplicationLogRecord& original_record, std::string* out) const {
   std::ostringstream oss;
 
-  auto s = Status::OK();
+  ReplicationLogRecord record = original_record;
+  auto s = UncompressReplicationLogRecord(&record);
+  if (!s.ok()) {
+    return s;
+  }
   switch (record.type) {
     case ReplicationLogRecord::kMemtableWrite: {
       if (record.contents.size() < 8) {
@@ -2580,6 +2852,10 @@ InternalIterator* DBImpl::NewInternalIterator(
                                            &merge_iter_builder,
                                            allow_unprepared_value);
     }
+    if (read_options.async_io) {
+      merge_iter_builder.SetMaxAsyncReadaheadReads(
+          read_options.max_async_readahead_reads);
+    }
     internal_iter = merge_iter_builder.Finish(
         read_options.ignore_range_deletions ? nullptr : db_iter);
     // Do not clean up the super version if super snapshot owns it
@@ -2746,6 +3022,14 @@ Status DBImpl::GetEntity(const ReadOptions& _read_options, const Slice& key,
   return s;
 }
 
+std::string DBImpl::MergeResultCacheKey(const ColumnFamilyData* cfd,
+                                        const Slice& user_key) const {
+  std::string key = merge_result_cache_id_;
+  PutVarint32(&key, cfd->GetID());
+  key.append(user_key.data(), user_key.size());
+  return key;
+}
+
 bool DBImpl::ShouldReferenceSuperVersion(const MergeContext& merge_context) {
   // If both thresholds are reached, a function returning merge operands as
   // `PinnableSlice`s should reference the `SuperVersion` to avoid large and/or
@@ -2801,15 +3085,31 @@ Status DBImpl::GetImpl(const ReadOptions& read_options, const Slice& key,
     get_impl_options.timestamp->clear();
   }
 
+  // Only locate the projected columns of an entity, the projection of a plain
+  // value is done once found
+  if (get_impl_options.columns && read_options.column_projection) {
+    get_impl_options.columns->SetColumnProjection(
+        read_options.column_projection);
+  }
+  Defer reset_column_projection([&get_impl_options]() {
+    if (get_impl_options.columns) {
+      get_impl_options.columns->SetColumnProjection(nullptr);
+    }
+  });
+
   GetWithTimestampReadCallback read_cb(0);  // Will call Refresh
 
+  OP_TRACE_OPERATION(immutable_db_options_, "Get");
+  PERF_SAMPLED_OPERATION_GUARD();
   PERF_CPU_TIMER_GUARD(get_cpu_nanos, immutable_db_options_.clock);
-  StopWatch sw(immutable_db_options_.clock, stats_, DB_GET);
-  PERF_TIMER_GUARD(get_snapshot_time);
-
   auto cfh = static_cast_with_check<ColumnFamilyHandleImpl>(
       get_impl_options.column_family);
   auto cfd = cfh->cfd();
+  // Also records into the statistics of the column family, if any
+  Statistics* const stats = cfd->ioptions()->stats;
+
+  StopWatch sw(immutable_db_options_.clock, stats, DB_GET);
+  PERF_TIMER_GUARD(get_snapshot_time);
 
   if (tracer_) {
     // TODO: This mutex should be removed later, to improve performance when
@@ -2912,6 +3212,40 @@ Status DBImpl::GetImpl(const ReadOptions& read_options, const Slice& key,
       get_impl_options.get_merge_operands_options;
   SequenceNumber max_covering_tombstone_seq = 0;
 
+  // A cached merge result is the value of the key as of the entry it was
+  // computed up to, so it is only valid for lookups that see all the entries
+  // of the key up to their snapshot, each with a distinct sequence number.
+  using MergeResultCacheInterface =
+      BasicTypedCacheInterface<std::string, CacheEntryRole::kMisc>;
+  MergeResultCacheInterface merge_result_cache{
+      immutable_db_options_.merge_result_cache.get()};
+  const bool use_merge_result_cache =
+      merge_result_cache && get_impl_options.get_value &&
+      get_impl_options.value != nullptr && !get_impl_options.callback &&
+      !get_impl_options.is_blob_index && !seq_per_batch_ &&
+      cfd->ioptions()->merge_operator != nullptr &&
+      !cfd->ioptions()->inplace_update_support &&
+      cfd->user_comparator()->timestamp_size() == 0;
+  std::string merge_result_cache_key;
+  MergeResultCacheInterface::TypedHandle* merge_result_handle = nullptr;
+  Defer release_merge_result([&]() {
+    if (merge_result_handle != nullptr) {
+      merge_result_cache.Release(merge_result_handle);
+    }
+  });
+  if (use_merge_result_cache) {
+    merge_result_cache_key = MergeResultCacheKey(cfd, key);
+    merge_result_handle = merge_result_cache.Lookup(merge_result_cache_key);
+    if (merge_result_handle != nullptr) {
+      Slice entry = *merge_result_cache.Value(merge_result_handle);
+      assert(entry.size() >= sizeof(uint64_t));
+      merge_context.memo_seq = DecodeFixed64(entry.data());
+      entry.remove_prefix(sizeof(uint64_t));
+      merge_context.memo_value = entry;
+      TEST_SYNC_POINT("DBImpl::GetImpl:MergeResultCacheHit");
+    }
+  }
+
   Status s;
   // First look in the memtable, then in the immutable memtable (if any).
   // s is both in/out. When in, s could either be OK or MergeInProgress.
@@ -2925,6 +3259,7 @@ Status DBImpl::GetImpl(const ReadOptions& read_options, const Slice& key,
   std::string* timestamp =
       ucmp->timestamp_size() > 0 ? get_impl_options.timestamp : nullptr;
   if (!skip_memtable) {
+    OP_TRACE_SPAN("memtable_get");
     // Get value associated with key
     if (get_impl_options.get_value) {
       if (sv->mem->Get(
@@ -2941,7 +3276,7 @@ Status DBImpl::GetImpl(const ReadOptions& read_options, const Slice& key,
           get_impl_options.value->PinSelf();
         }
 
-        RecordTick(stats_, MEMTABLE_HIT);
+        RecordTick(stats, MEMTABLE_HIT);
       } else if ((s.ok() || s.IsMergeInProgress()) &&
                  sv->imm->Get(lkey,
                               get_impl_options.value
@@ -2957,7 +3292,7 @@ Status DBImpl::GetImpl(const ReadOptions& read_options, const Slice& key,
           get_impl_options.value->PinSelf();
         }
 
-        RecordTick(stats_, MEMTABLE_HIT);
+        RecordTick(stats, MEMTABLE_HIT);
       }
     } else {
       // Get Merge Operands associated with key, Merge Operands should not be
@@ -2968,13 +3303,13 @@ Status DBImpl::GetImpl(const ReadOptions& read_options, const Slice& key,
                        false /* immutable_memtable */, nullptr, nullptr,
                        false)) {
         done = true;
-        RecordTick(stats_, MEMTABLE_HIT);
+        RecordTick(stats, MEMTABLE_HIT);
       } else if ((s.ok() || s.IsMergeInProgress()) &&
                  sv->imm->GetMergeOperands(lkey, &s, &merge_context,
                                            &max_covering_tombstone_seq,
                                            read_options)) {
         done = true;
-        RecordTick(stats_, MEMTABLE_HIT);
+        RecordTick(stats, MEMTABLE_HIT);
       }
     }
     // RocksDB-Cloud contribution begin
@@ -2989,6 +3324,7 @@ Status DBImpl::GetImpl(const ReadOptions& read_options, const Slice& key,
   PinnedIteratorsManager pinned_iters_mgr;
   if (!done) {
     PERF_TIMER_GUARD(get_from_output_files_time);
+    OP_TRACE_SPAN("sst_get");
     sv->current->Get(
         read_options, lkey, get_impl_options.value, get_impl_options.columns,
         timestamp, &s, &merge_context, &max_covering_tombstone_seq,
@@ -2998,14 +3334,34 @@ Status DBImpl::GetImpl(const ReadOptions& read_options, const Slice& key,
         get_impl_options.get_value ? get_impl_options.callback : nullptr,
         get_impl_options.get_value ? get_impl_options.is_blob_index : nullptr,
         get_impl_options.get_value);
-    RecordTick(stats_, MEMTABLE_MISS);
+    RecordTick(stats, MEMTABLE_MISS);
   }
 
   {
     PERF_TIMER_GUARD(get_post_process_time);
 
-    RecordTick(stats_, NUMBER_KEYS_READ);
+    RecordTick(stats, NUMBER_KEYS_READ);
     size_t size = 0;
+    if (use_merge_result_cache && s.ok() &&
+        merge_context.GetNumOperands() > 0 &&
+        merge_context.newest_seq != kMaxSequenceNumber &&
+        merge_context.newest_seq != 0 &&
+        (merge_result_handle == nullptr ||
+         merge_context.newest_seq > merge_context.memo_seq)) {
+      // The newest entry was merged into the value, so the value is the
+      // merge result as of that entry. A read at an older snapshot does not
+      // replace a newer result.
+      auto entry = new std::string();
+      PutFixed64(entry, merge_context.newest_seq);
+      entry->append(get_impl_options.value->data(),
+                    get_impl_options.value->size());
+      const size_t charge = entry->capacity() + sizeof(std::string);
+      Status cs = merge_result_cache.Insert(merge_result_cache_key, entry,
+                                            charge);
+      if (!cs.ok()) {
+        delete entry;
+      }
+    }
     if (s.ok()) {
       const auto& merge_threshold = read_options.merge_operand_count_threshold;
       if (merge_threshold.has_value() &&
@@ -3017,6 +3373,9 @@ Status DBImpl::GetImpl(const ReadOptions& read_options, const Slice& key,
         if (get_impl_options.value) {
           size = get_impl_options.value->size();
         } else if (get_impl_options.columns) {
+          if (read_options.column_projection) {
+            get_impl_options.columns->Project(*read_options.column_projection);
+          }
           size = get_impl_options.columns->serialized_size();
         }
       } else {
@@ -3084,7 +3443,7 @@ Status DBImpl::GetImpl(const ReadOptions& read_options, const Slice& key,
           }
         }
       }
-      RecordTick(stats_, BYTES_READ, size);
+      RecordTick(stats, BYTES_READ, size);
       PERF_COUNTER_ADD(get_read_bytes, size);
     }
 
@@ -3094,7 +3453,7 @@ Status DBImpl::GetImpl(const ReadOptions& read_options, const Slice& key,
     }
     // RocksDB-Cloud contribution end
 
-    RecordInHistogram(stats_, BYTES_PER_READ, size);
+    RecordInHistogram(stats, BYTES_PER_READ, size);
   }
   return s;
 }
@@ -3315,6 +3674,8 @@ void DBImpl::MultiGetCommon(const ReadOptions& read_options,
   if (num_keys == 0) {
     return;
   }
+  OP_TRACE_OPERATION(immutable_db_options_, "MultiGet");
+  PERF_SAMPLED_OPERATION_GUARD();
 
   bool should_fail = false;
   for (size_t i = 0; i < num_keys; ++i) {
@@ -3502,6 +3863,77 @@ void DBImpl::PrepareMultiGetKeys(
             CompareKeyContext());
 }
 
+void DBImpl::GetAsync(const ReadOptions& read_options,
+                      ColumnFamilyHandle* column_family, const Slice& key,
+                      PinnableSlice* value,
+                      std::function<void(const Status&)> callback) {
+  // The job owns copies of the options and the key slice, which point to
+  // memory the caller keeps valid.
+  if (!ScheduleAsyncRead([this, read_options, column_family, key, value,
+                          callback]() {
+        callback(Get(read_options, column_family, key, value));
+      })) {
+    callback(Status::ShutdownInProgress());
+  }
+}
+
+void DBImpl::MultiGetAsync(const ReadOptions& read_options,
+                           ColumnFamilyHandle* column_family, size_t num_keys,
+                           const Slice* keys, PinnableSlice* values,
+                           Status* statuses, std::function<void()> callback) {
+  if (!ScheduleAsyncRead([this, read_options, column_family, num_keys, keys,
+                          values, statuses, callback]() {
+        MultiGet(read_options, column_family, num_keys, keys, values,
+                 statuses);
+        callback();
+      })) {
+    for (size_t i = 0; i < num_keys; i++) {
+      statuses[i] = Status::ShutdownInProgress();
+    }
+    callback();
+  }
+}
+
+bool DBImpl::ScheduleAsyncRead(std::function<void()>&& job) {
+  std::lock_guard<std::mutex> lock(async_read_mutex_);
+  if (async_read_stop_) {
+    return false;
+  }
+  if (async_read_pool_ == nullptr) {
+    async_read_pool_.reset(new ThreadPoolImpl());
+    async_read_pool_->SetThreadPriority(Env::Priority::USER);
+    async_read_pool_->SetBackgroundThreads(
+        std::max(immutable_db_options_.async_read_threads, 1));
+  }
+  async_read_pool_->SubmitJob(std::move(job));
+  return true;
+}
+
+void DBImpl::StopAsyncReads() {
+  {
+    std::lock_guard<std::mutex> lock(async_read_mutex_);
+    async_read_stop_ = true;
+  }
+  // No job is submitted any more, so the pool is not reset concurrently.
+  if (async_read_pool_ != nullptr) {
+    async_read_pool_->WaitForJobsAndJoinAllThreads();
+  }
+}
+
+void DB::GetAsync(const ReadOptions& options, ColumnFamilyHandle* column_family,
+                  const Slice& key, PinnableSlice* value,
+                  std::function<void(const Status&)> callback) {
+  callback(Get(options, column_family, key, value));
+}
+
+void DB::MultiGetAsync(const ReadOptions& options,
+                       ColumnFamilyHandle* column_family, size_t num_keys,
+                       const Slice* keys, PinnableSlice* values,
+                       Status* statuses, std::function<void()> callback) {
+  MultiGet(options, column_family, num_keys, keys, values, statuses);
+  callback();
+}
+
 void DB::MultiGet(const ReadOptions& options, ColumnFamilyHandle* column_family,
                   const size_t num_keys, const Slice* keys,
                   PinnableSlice* values, std::string* timestamps,
@@ -3527,6 +3959,8 @@ void DBImpl::MultiGetCommon(const ReadOptions& read_options,
                             PinnableSlice* values, PinnableWideColumns* columns,
                             std::string* timestamps, Status* statuses,
                             bool sorted_input) {
+  OP_TRACE_OPERATION(immutable_db_options_, "MultiGet");
+  PERF_SAMPLED_OPERATION_GUARD();
   if (tracer_) {
     // TODO: This mutex should be removed later, to improve performance when
     // tracing is enabled.
@@ -3674,7 +4108,18 @@ Status DBImpl::MultiGetImpl(
     if (kctx->timestamp) {
       kctx->timestamp->clear();
     }
+    // See GetImpl()
+    if (kctx->columns && read_options.column_projection) {
+      kctx->columns->SetColumnProjection(read_options.column_projection);
+    }
   }
+  Defer reset_column_projection([sorted_keys]() {
+    for (auto* kctx : *sorted_keys) {
+      if (kctx->columns) {
+        kctx->columns->SetColumnProjection(nullptr);
+      }
+    }
+  });
 
   // For each of the given keys, apply the entire "get" process as follows:
   // First look in the memtable, then in the immutable memtable (if any).
@@ -3712,6 +4157,7 @@ Status DBImpl::MultiGetImpl(
         (read_options.read_tier == kPersistedTier &&
          has_unpersisted_data_.load(std::memory_order_relaxed));
     if (!skip_memtable) {
+      OP_TRACE_SPAN("memtable_get");
       super_version->mem->MultiGet(read_options, &range, callback,
                                    false /* immutable_memtable */);
       if (!range.empty()) {
@@ -3726,6 +4172,7 @@ Status DBImpl::MultiGetImpl(
     }
     if (lookup_current) {
       PERF_TIMER_GUARD(get_from_output_files_time);
+      OP_TRACE_SPAN("sst_get");
       super_version->current->MultiGet(read_options, &range, callback);
     }
     curr_value_size = range.GetValueSize();
@@ -3755,6 +4202,9 @@ Status DBImpl::MultiGetImpl(
         bytes_read += key->value->size();
       } else {
         assert(key->columns);
+        if (read_options.column_projection) {
+          key->columns->Project(*read_options.column_projection);
+        }
         bytes_read += key->columns->serialized_size();
       }
 
@@ -4299,11 +4749,18 @@ Iterator* DBImpl::NewIterator(const ReadOptions& _read_options,
     // Note: no need to consider the special case of
     // last_seq_same_as_publish_seq_==false since NewIterator is overridden in
     // WritePreparedTxnDB
-    result = NewIteratorImpl(read_options, cfh, sv,
-                             (read_options.snapshot != nullptr)
-                                 ? read_options.snapshot->GetSequenceNumber()
-                                 : kMaxSequenceNumber,
-                             nullptr /* read_callback */);
+    ArenaWrappedDBIter* db_iter =
+        NewIteratorImpl(read_options, cfh, sv,
+                        (read_options.snapshot != nullptr)
+                            ? read_options.snapshot->GetSequenceNumber()
+                            : kMaxSequenceNumber,
+                        nullptr /* read_callback */);
+    if (!db_iter->memory_charge_status().ok()) {
+      Status s = db_iter->memory_charge_status();
+      delete db_iter;
+      return NewErrorIterator(s);
+    }
+    result = db_iter;
   }
   return result;
 }
@@ -4382,10 +4839,21 @@ ArenaWrappedDBIter* DBImpl::NewIteratorImpl(
       db_iter->GetReadOptions(), cfh->cfd(), sv, db_iter->GetArena(), snapshot,
       /* allow_unprepared_value */ true, db_iter);
   db_iter->SetIterUnderDBIter(internal_iter);
+  db_iter->ChargeMemory(this);
 
   return db_iter;
 }
 
+Status DBImpl::ChargeIteratorMemory(
+    size_t bytes,
+    std::unique_ptr<CacheReservationManager::CacheReservationHandle>* handle) {
+  iterators_mem_usage_.fetch_add(bytes, std::memory_order_relaxed);
+  if (iterator_memory_cache_res_mgr_ == nullptr) {
+    return Status::OK();
+  }
+  return iterator_memory_cache_res_mgr_->MakeCacheReservation(bytes, handle);
+}
+
 std::unique_ptr<Iterator> DBImpl::NewMultiCfIterator(
     const ReadOptions& _read_options,
     const std::vector<ColumnFamilyHandle*>& column_families) {
@@ -4405,7 +4873,8 @@ std::unique_ptr<Iterator> DBImpl::NewMultiCfIterator(
   std::vector<Iterator*> child_iterators;
   Status s = NewIterators(_read_options, column_families, &child_iterators);
   if (s.ok()) {
-    return std::make_unique<MultiCfIterator>(first_comparator, column_families,
+    return std::make_unique<MultiCfIterator>(_read_options, first_comparator,
+                                             column_families,
                                              std::move(child_iterators));
   }
   return std::unique_ptr<Iterator>(NewErrorIterator(s));
@@ -4510,9 +4979,21 @@ Status DBImpl::NewIterators(
     auto snapshot = read_options.snapshot != nullptr
                         ? read_options.snapshot->GetSequenceNumber()
                         : versions_->LastSequence();
+    Status s;
     for (auto [cfh, sv] : cfh_to_sv) {
-      iterators->push_back(NewIteratorImpl(read_options, cfh, sv, snapshot,
-                                           nullptr /*read_callback*/));
+      ArenaWrappedDBIter* db_iter = NewIteratorImpl(
+          read_options, cfh, sv, snapshot, nullptr /*read_callback*/);
+      if (s.ok()) {
+        s = db_iter->memory_charge_status();
+      }
+      iterators->push_back(db_iter);
+    }
+    if (!s.ok()) {
+      for (auto* it : *iterators) {
+        delete it;
+      }
+      iterators->clear();
+      return s;
     }
   }
 
@@ -5034,6 +5515,13 @@ bool DBImpl::GetIntPropertyInternal(ColumnFamilyData* cfd,
   }
 }
 
+bool DBImpl::GetPropertyHandleLastAppliedReplicationSequence(
+    std::string* value) {
+  mutex_.AssertHeld();
+  *value = Slice(last_applied_replication_sequence_).ToString(true);
+  return true;
+}
+
 bool DBImpl::GetPropertyHandleOptionsStatistics(std::string* value) {
   assert(value != nullptr);
   Statistics* statistics = immutable_db_options_.stats;
@@ -5220,6 +5708,9 @@ Status DBImpl::GetApproximateSizes(const SizeApproximationOptions& options,
 
   // TODO: plumb Env::IOActivity, Env::IOPriority
   const ReadOptions read_options;
+  const size_t num_ranges = n > 0 ? static_cast<size_t>(n) : 0;
+  std::vector<InternalKey> starts(num_ranges);
+  std::vector<InternalKey> limits(num_ranges);
   for (int i = 0; i < n; i++) {
     // Add timestamp if needed
     std::string start_with_ts, limit_with_ts;
@@ -5229,17 +5720,31 @@ Status DBImpl::GetApproximateSizes(const SizeApproximationOptions& options,
     assert(start.has_value());
     assert(limit.has_value());
     // Convert user_key into a corresponding internal key.
-    InternalKey k1(start.value(), kMaxSequenceNumber, kValueTypeForSeek);
-    InternalKey k2(limit.value(), kMaxSequenceNumber, kValueTypeForSeek);
-    sizes[i] = 0;
-    if (options.include_files) {
-      sizes[i] += versions_->ApproximateSize(
-          options, read_options, v, k1.Encode(), k2.Encode(), /*start_level=*/0,
-          /*end_level=*/-1, TableReaderCaller::kUserApproximateSize);
-    }
-    if (options.include_memtables) {
-      sizes[i] += sv->mem->ApproximateStats(k1.Encode(), k2.Encode()).size;
-      sizes[i] += sv->imm->ApproximateStats(k1.Encode(), k2.Encode()).size;
+    starts[i].Set(start.value(), kMaxSequenceNumber, kValueTypeForSeek);
+    limits[i].Set(limit.value(), kMaxSequenceNumber, kValueTypeForSeek);
+  }
+
+  if (options.include_files) {
+    // The ranges are estimated together, sharing the searches of the levels
+    // and the offsets of common endpoints
+    std::vector<Slice> start_keys(num_ranges);
+    std::vector<Slice> limit_keys(num_ranges);
+    for (int i = 0; i < n; i++) {
+      start_keys[i] = starts[i].Encode();
+      limit_keys[i] = limits[i].Encode();
+    }
+    versions_->ApproximateSizes(options, read_options, v, start_keys.data(),
+                                limit_keys.data(), num_ranges, sizes,
+                                TableReaderCaller::kUserApproximateSize);
+  } else {
+    std::fill(sizes, sizes + num_ranges, 0);
+  }
+  if (options.include_memtables) {
+    for (int i = 0; i < n; i++) {
+      Slice k1 = starts[i].Encode();
+      Slice k2 = limits[i].Encode();
+      sizes[i] += sv->mem->ApproximateStats(k1, k2).size;
+      sizes[i] += sv->imm->ApproximateStats(k1, k2).size;
     }
   }
 
@@ -5792,6 +6297,8 @@ Status DestroyDB(const std::string& dbname, const Options& options,
         }
       }
     }
+    env->DeleteFile(MemTableSnapshotFileName(dbname)).PermitUncheckedError();
+    env->DeleteFile(TableSummaryFileName(dbname)).PermitUncheckedError();
 
     std::set<std::string> paths;
     for (const DbPath& db_path : options.db_paths) {
@@ -6868,11 +7375,6 @@ Status DBImpl::VerifyChecksum(const ReadOptions& _read_options) {
 
 Status DBImpl::VerifyChecksumInternal(const ReadOptions& read_options,
                                       bool use_file_checksum) {
-  // `bytes_read` stat is enabled based on compile-time support and cannot
-  // be dynamically toggled. So we do not need to worry about `PerfLevel`
-  // here, unlike many other `IOStatsContext` / `PerfContext` stats.
-  uint64_t prev_bytes_read = IOSTATS(bytes_read);
-
   Status s;
 
   if (use_file_checksum) {
@@ -6903,61 +7405,111 @@ Status DBImpl::VerifyChecksumInternal(const ReadOptions& read_options,
     sv_list.push_back(cfd->GetReferencedSuperVersion(this));
   }
 
-  for (auto& sv : sv_list) {
-    VersionStorageInfo* vstorage = sv->current->storage_info();
-    ColumnFamilyData* cfd = sv->current->cfd();
-    Options opts;
+  // The files to verify, in the order of their column families and levels
+  struct FileToVerify {
+    std::string fname;
+    size_t cf_index;
+    uint64_t file_size;
+    SequenceNumber largest_seqno;
+    std::string file_checksum;
+    std::string file_checksum_func_name;
+  };
+  std::vector<Options> cf_opts(sv_list.size());
+  std::vector<FileToVerify> files;
+  uint64_t total_bytes = 0;
+  for (size_t k = 0; k < sv_list.size(); k++) {
+    VersionStorageInfo* vstorage = sv_list[k]->current->storage_info();
+    ColumnFamilyData* cfd = sv_list[k]->current->cfd();
     if (!use_file_checksum) {
       InstrumentedMutexLock l(&mutex_);
-      opts = Options(BuildDBOptions(immutable_db_options_, mutable_db_options_),
-                     cfd->GetLatestCFOptions());
+      cf_opts[k] =
+          Options(BuildDBOptions(immutable_db_options_, mutable_db_options_),
+                  cfd->GetLatestCFOptions());
     }
-    for (int i = 0; i < vstorage->num_non_empty_levels() && s.ok(); i++) {
-      for (size_t j = 0; j < vstorage->LevelFilesBrief(i).num_files && s.ok();
-           j++) {
+    for (int i = 0; i < vstorage->num_non_empty_levels(); i++) {
+      for (size_t j = 0; j < vstorage->LevelFilesBrief(i).num_files; j++) {
         const auto& fd_with_krange = vstorage->LevelFilesBrief(i).files[j];
         const auto& fd = fd_with_krange.fd;
         const FileMetaData* fmeta = fd_with_krange.file_metadata;
         assert(fmeta);
-        std::string fname = TableFileName(cfd->ioptions()->cf_paths,
-                                          fd.GetNumber(), fd.GetPathId());
-        if (use_file_checksum) {
-          s = VerifyFullFileChecksum(fmeta->file_checksum,
-                                     fmeta->file_checksum_func_name, fname,
-                                     read_options);
-        } else {
-          s = ROCKSDB_NAMESPACE::VerifySstFileChecksumInternal(
-              opts, file_options_, read_options, fname, fd.largest_seqno);
-        }
-        RecordTick(stats_, VERIFY_CHECKSUM_READ_BYTES,
-                   IOSTATS(bytes_read) - prev_bytes_read);
-        prev_bytes_read = IOSTATS(bytes_read);
+        files.push_back({TableFileName(cfd->ioptions()->cf_paths,
+                                       fd.GetNumber(), fd.GetPathId()),
+                         k, fd.GetFileSize(), fd.largest_seqno,
+                         fmeta->file_checksum,
+                         fmeta->file_checksum_func_name});
+        total_bytes += fd.GetFileSize();
       }
     }
 
-    if (s.ok() && use_file_checksum) {
+    if (use_file_checksum) {
       const auto& blob_files = vstorage->GetBlobFiles();
       for (const auto& meta : blob_files) {
         assert(meta);
+        files.push_back({BlobFileName(cfd->ioptions()->cf_paths.front().path,
+                                      meta->GetBlobFileNumber()),
+                         k, meta->GetBlobFileSize(), kMaxSequenceNumber,
+                         meta->GetChecksumValue(), meta->GetChecksumMethod()});
+        total_bytes += meta->GetBlobFileSize();
+      }
+    }
+  }
 
-        const uint64_t blob_file_number = meta->GetBlobFileNumber();
-
-        const std::string blob_file_name = BlobFileName(
-            cfd->ioptions()->cf_paths.front().path, blob_file_number);
-        s = VerifyFullFileChecksum(meta->GetChecksumValue(),
-                                   meta->GetChecksumMethod(), blob_file_name,
-                                   read_options);
-        RecordTick(stats_, VERIFY_CHECKSUM_READ_BYTES,
-                   IOSTATS(bytes_read) - prev_bytes_read);
-        prev_bytes_read = IOSTATS(bytes_read);
-        if (!s.ok()) {
-          break;
-        }
+  // The files are verified by read_options.verify_checksum_threads threads,
+  // which stop taking files after the first failure.
+  std::vector<Status> statuses(files.size());
+  std::atomic<size_t> next_file{0};
+  std::atomic<bool> failed{false};
+  std::atomic<uint64_t> bytes_done{0};
+  const uint64_t progress_step = std::max<uint64_t>(total_bytes / 10, 1);
+  auto verify_files = [&]() {
+    // `bytes_read` stat is enabled based on compile-time support and cannot
+    // be dynamically toggled. So we do not need to worry about `PerfLevel`
+    // here, unlike many other `IOStatsContext` / `PerfContext` stats. It is
+    // per thread.
+    uint64_t prev_bytes_read = IOSTATS(bytes_read);
+    for (size_t i = next_file++; i < files.size() && !failed.load();
+         i = next_file++) {
+      const FileToVerify& f = files[i];
+      if (use_file_checksum) {
+        statuses[i] = VerifyFullFileChecksum(
+            f.file_checksum, f.file_checksum_func_name, f.fname, read_options);
+      } else {
+        statuses[i] = ROCKSDB_NAMESPACE::VerifySstFileChecksumInternal(
+            cf_opts[f.cf_index], file_options_, read_options, f.fname,
+            f.largest_seqno);
+      }
+      RecordTick(stats_, VERIFY_CHECKSUM_READ_BYTES,
+                 IOSTATS(bytes_read) - prev_bytes_read);
+      prev_bytes_read = IOSTATS(bytes_read);
+      if (!statuses[i].ok()) {
+        failed.store(true);
+        break;
+      }
+      const uint64_t done = bytes_done.fetch_add(f.file_size) + f.file_size;
+      if (done / progress_step != (done - f.file_size) / progress_step) {
+        ROCKS_LOG_INFO(immutable_db_options_.info_log,
+                       "Verified the checksums of %" PRIu64 " of %" PRIu64
+                       " bytes of %" ROCKSDB_PRIszt " files",
+                       done, total_bytes, files.size());
       }
     }
-    if (!s.ok()) {
-      break;
+  };
+  const size_t num_threads = std::min(
+      files.size(),
+      static_cast<size_t>(std::max(read_options.verify_checksum_threads, 1)));
+  std::vector<port::Thread> threads;
+  for (size_t i = 1; i < num_threads; i++) {
+    threads.emplace_back(verify_files);
+  }
+  verify_files();
+  for (auto& thread : threads) {
+    thread.join();
+  }
+  for (auto& file_status : statuses) {
+    if (s.ok() && !file_status.ok()) {
+      s = file_status;
     }
+    file_status.PermitUncheckedError();
   }
 
   bool defer_purge = immutable_db_options().avoid_unnecessary_blocking_io;
@@ -6980,8 +7532,6 @@ Status DBImpl::VerifyChecksumInternal(const ReadOptions& read_options,
       cfd->UnrefAndTryDelete();
     }
   }
-  RecordTick(stats_, VERIFY_CHECKSUM_READ_BYTES,
-             IOSTATS(bytes_read) - prev_bytes_read);
   return s;
 }
 
@@ -7248,6 +7798,7 @@ ColumnFamilyData* DBImpl::GetAnyCFWithAutoFlushDisabled() const {
 void DBImpl::UpdateReplicationEpoch(uint64_t next_replication_epoch) {
   InstrumentedMutexLock l(&mutex_);
   versions_->UpdateReplicationEpoch(next_replication_epoch);
+  RecordTick(stats_, REPLICATION_EPOCH_UPDATES);
 }
 
 void DBImpl::NewManifestOnNextUpdate() {
@@ -65,6 +65,7 @@
 #include "util/repeatable_thread.h"
 #include "util/stop_watch.h"
 #include "util/thread_local.h"
+#include "util/threadpool_imp.h"
 
 namespace ROCKSDB_NAMESPACE {
 
@@ -232,6 +233,18 @@ class DBImpl : public DB {
   using DB::Write;
   Status Write(const WriteOptions& options, WriteBatch* updates) override;
 
+  void WriteAsync(const WriteOptions& options, WriteBatch* updates,
+                  std::function<void(const Status&)> callback) override;
+
+  void GetAsync(const ReadOptions& options, ColumnFamilyHandle* column_family,
+                const Slice& key, PinnableSlice* value,
+                std::function<void(const Status&)> callback) override;
+  void MultiGetAsync(const ReadOptions& options,
+                     ColumnFamilyHandle* column_family, size_t num_keys,
+                     const Slice* keys, PinnableSlice* values,
+                     Status* statuses,
+                     std::function<void()> callback) override;
+
   using DB::Get;
   Status Get(const ReadOptions& _read_options,
              ColumnFamilyHandle* column_family, const Slice& key,
@@ -431,6 +444,11 @@ class DBImpl : public DB {
                                    ApplyReplicationLogRecordInfo* info,
                                    unsigned flags) override;
 
+  // Inserts a replicated write batch into the memtables, in parallel if
+  // concurrent is set and the batch is large enough.
+  Status InsertReplicatedWriteBatch(const WriteBatch& batch, bool concurrent,
+                                    SequenceNumber* next_seq);
+
   // Check that replicated epoch number of newly flushed files >= cfd's next
   // epoch number.
   Status CheckNextEpochNumberConsistency(const VersionEdit& e, ColumnFamilyData* cfd);
@@ -873,6 +891,11 @@ class DBImpl : public DB {
 
   const SnapshotList& snapshots() const { return snapshots_; }
 
+  // REQUIRES: mutex locked
+  uint64_t last_applied_replication_time() const {
+    return last_applied_replication_time_;
+  }
+
   // load list of snapshots to `snap_vector` that is no newer than `max_seq`
   // in ascending order.
   // `oldest_write_conflict_snapshot` is filled with the oldest snapshot
@@ -927,6 +950,22 @@ class DBImpl : public DB {
   std::unique_ptr<ColumnFamilyHandle> GetColumnFamilyHandleUnlocked(
       uint32_t column_family_id);
 
+  // Adds `bytes` of the arena of a live iterator to the iterator memory
+  // usage and, with DBOptions::iterator_memory_cache, reserves them in that
+  // cache until `*handle` is destroyed. The usage is added even when the
+  // reservation fails. Undone by ReleaseIteratorMemory().
+  Status ChargeIteratorMemory(
+      size_t bytes,
+      std::unique_ptr<CacheReservationManager::CacheReservationHandle>*
+          handle);
+  void ReleaseIteratorMemory(size_t bytes) {
+    iterators_mem_usage_.fetch_sub(bytes, std::memory_order_relaxed);
+  }
+  // See DB::Properties::kIteratorsMemUsage
+  uint64_t GetIteratorsMemUsage() const {
+    return iterators_mem_usage_.load(std::memory_order_relaxed);
+  }
+
   // Returns the number of currently running flushes.
   // REQUIREMENT: mutex_ must be held when calling this function.
   int num_running_flushes() {
@@ -1059,10 +1098,12 @@ class DBImpl : public DB {
   void SetSnapshotChecker(SnapshotChecker* snapshot_checker);
 
   // Fill JobContext with snapshot information needed by flush and compaction.
-  void GetSnapshotContext(JobContext* job_context,
-                          std::vector<SequenceNumber>* snapshot_seqs,
-                          SequenceNumber* earliest_write_conflict_snapshot,
-                          SnapshotChecker** snapshot_checker);
+  // The snapshot sequence numbers are shared by the jobs, not copied.
+  void GetSnapshotContext(
+      JobContext* job_context,
+      std::shared_ptr<const std::vector<SequenceNumber>>* snapshot_seqs,
+      SequenceNumber* earliest_write_conflict_snapshot,
+      SnapshotChecker** snapshot_checker);
 
   // Not thread-safe.
   void SetRecoverableStatePreReleaseCallback(PreReleaseCallback* callback);
@@ -1254,6 +1295,9 @@ class DBImpl : public DB {
   // flush LOG out of application buffer
   void FlushInfoLog();
 
+  // adjust the mutable options with DBOptions::auto_tuner
+  void AutoTune();
+
   // record current sequence number to time mapping. If
   // populate_historical_seconds > 0 then pre-populate all the
   // sequence numbers from [1, last] to map to [now minus
@@ -1376,6 +1420,17 @@ class DBImpl : public DB {
   // table_cache_ provides its own synchronization
   std::shared_ptr<Cache> table_cache_;
 
+  // Prefix of the keys of this DB in merge_result_cache, which may be shared
+  // by several DBs
+  std::string merge_result_cache_id_;
+
+  // Memory of the arenas of the live iterators, charged to
+  // iterator_memory_cache_res_mgr_ when DBOptions::iterator_memory_cache is
+  // set
+  std::atomic<uint64_t> iterators_mem_usage_{0};
+  std::shared_ptr<ConcurrentCacheReservationManager>
+      iterator_memory_cache_res_mgr_;
+
   ErrorHandler error_handler_;
 
   // Unified interface for logging events
@@ -1559,6 +1614,16 @@ class DBImpl : public DB {
       PreReleaseCallback* pre_release_callback, const AssignOrder assign_order,
       const PublishLastSeq publish_last_seq, const bool disable_memtable);
 
+  // The loop of async_write_thread_, see WriteAsync().
+  void AsyncWriteLoop();
+  // Performs the writes queued by WriteAsync() and stops the thread.
+  void StopAsyncWrites();
+  // Queues job on async_read_pool_, unless the DB is closing.
+  bool ScheduleAsyncRead(std::function<void()>&& job);
+  // Performs the lookups queued by GetAsync() and MultiGetAsync() and stops
+  // their threads.
+  void StopAsyncReads();
+
   // write cached_recoverable_state_ to memtable if it is not empty
   // The writer must be the leader in write_thread_ and holding mutex_
   Status WriteRecoverableState();
@@ -1939,7 +2004,7 @@ class DBImpl : public DB {
       ColumnFamilyData* cfd, const MutableCFOptions& mutable_cf_options,
       bool* madeProgress, JobContext* job_context, FlushReason flush_reason,
       SuperVersionContext* superversion_context,
-      std::vector<SequenceNumber>& snapshot_seqs,
+      const std::shared_ptr<const std::vector<SequenceNumber>>& snapshot_seqs,
       SequenceNumber earliest_write_conflict_snapshot,
       SnapshotChecker* snapshot_checker, LogBuffer* log_buffer,
       Env::Priority thread_pri);
@@ -1961,6 +2026,29 @@ class DBImpl : public DB {
                          bool* corrupted_log_found,
                          RecoveryContext* recovery_ctx);
 
+  // Loads the memtable snapshot of the last clean shutdown into the
+  // memtables, if it covers the WALs of `wal_numbers` from `min_wal_number`
+  // as they are, and then removes it unless read_only. Sets `*loaded` if the
+  // WALs don't need to be replayed.
+  // REQUIRES: mutex held, during recovery
+  void MaybeLoadMemTableSnapshot(const std::vector<uint64_t>& wal_numbers,
+                                 uint64_t min_wal_number, bool read_only,
+                                 SequenceNumber* next_sequence, bool* loaded);
+
+  // Writes the memtable snapshot, on a clean shutdown when the memtables
+  // are not flushed, see DBOptions::snapshot_memtables_on_shutdown.
+  // REQUIRES: mutex held, the WALs closed
+  void MaybeWriteMemTableSnapshot();
+
+  // Sets the table summary of the VersionSet from the summary file written
+  // at the last clean shutdown, see DBOptions::summarize_tables_on_shutdown.
+  // REQUIRES: before VersionSet::Recover()
+  void MaybeLoadTableSummary();
+
+  // Writes the table summary of the live SST files on a clean shutdown.
+  // REQUIRES: mutex held
+  void MaybeWriteTableSummary();
+
   // The following two methods are used to flush a memtable to
   // storage. The first one is used at database RecoveryTime (when the
   // database is opened) and is heavyweight because it holds the mutex
@@ -2131,11 +2219,18 @@ class DBImpl : public DB {
                     WriteBatch* tmp_batch, WriteBatch** merged_batch,
                     size_t* write_with_wal, WriteBatch** to_be_cached_state);
 
+  // Returns Corruption if the per key checksums of merged_batch do not match
+  // its contents. Called before merged_batch is written to the WAL.
+  IOStatus VerifyWALBatch(const WriteBatch& merged_batch);
+
+  // body_crc, if not null, is the crc32c of merged_batch without its header,
+  // see log::Writer::AddRecord.
   IOStatus WriteToWAL(const WriteBatch& merged_batch,
                       const WriteOptions& write_options,
                       log::Writer* log_writer, uint64_t* log_used,
                       uint64_t* log_size,
-                      LogFileNumberSize& log_file_number_size);
+                      LogFileNumberSize& log_file_number_size,
+                      const log::RecordBodyCrc* body_crc = nullptr);
 
   IOStatus WriteToWAL(const WriteThread::WriteGroup& write_group,
                       log::Writer* log_writer, uint64_t* log_used,
@@ -2147,6 +2242,14 @@ class DBImpl : public DB {
                                 uint64_t* log_used,
                                 SequenceNumber* last_sequence, size_t seq_inc);
 
+  // Replicates the batches of write_group that are written to the memtable,
+  // starting at sequence, as one kMemtableWrite record, see
+  // DBOptions::replication_log_listener. Called by the leader of the group
+  // once its sequence numbers are allocated, so that the records follow the
+  // order of the sequence numbers and of the memtable switches.
+  void ReplicateWriteGroup(const WriteThread::WriteGroup& write_group,
+                           SequenceNumber sequence, size_t total_byte_size);
+
   // Used by WriteImpl to update bg_error_ if paranoid check is enabled.
   // Caller must hold mutex_.
   void WriteStatusCheckOnLocked(const Status& status);
@@ -2322,6 +2425,7 @@ class DBImpl : public DB {
                               const DBPropertyInfo& property_info,
                               bool is_locked, uint64_t* value);
   bool GetPropertyHandleOptionsStatistics(std::string* value);
+  bool GetPropertyHandleLastAppliedReplicationSequence(std::string* value);
 
   bool HasPendingManualCompaction();
   bool HasExclusiveManualCompaction();
@@ -2467,6 +2571,10 @@ class DBImpl : public DB {
 
   bool ShouldReferenceSuperVersion(const MergeContext& merge_context);
 
+  // Returns the key of `user_key` of `cfd` in merge_result_cache
+  std::string MergeResultCacheKey(const ColumnFamilyData* cfd,
+                                  const Slice& user_key) const;
+
   // Lock over the persistent DB state.  Non-nullptr iff successfully acquired.
   FileLock* db_lock_;
 
@@ -2767,6 +2875,25 @@ class DBImpl : public DB {
   // Number of threads intending to write to memtable
   std::atomic<size_t> pending_memtable_writes_ = {};
 
+  // The writes queued by WriteAsync(), which async_write_thread_ performs.
+  struct AsyncWrite {
+    WriteOptions options;
+    WriteBatch* batch;
+    std::function<void(const Status&)> callback;
+  };
+  std::mutex async_write_mutex_;
+  std::condition_variable async_write_cv_;
+  std::deque<AsyncWrite> async_writes_;
+  bool async_write_stop_ = false;
+  // Started by the first WriteAsync(), and joined by StopAsyncWrites().
+  port::Thread async_write_thread_;
+
+  // Performs the lookups of GetAsync() and MultiGetAsync(). Created by the
+  // first of them, and joined by StopAsyncReads().
+  std::mutex async_read_mutex_;
+  std::unique_ptr<ThreadPoolImpl> async_read_pool_;
+  bool async_read_stop_ = false;
+
   // A flag indicating whether the current rocksdb database has any
   // data that is not yet persisted into either WAL or SST file.
   // Used when disableWAL is true.
@@ -2868,6 +2995,9 @@ class DBImpl : public DB {
 
   // Pointer to WriteBufferManager stalling interface.
   std::unique_ptr<StallInterface> wbm_stall_;
+  // The share of this DB in the WriteBufferManager, null unless
+  // DBOptions::write_buffer_manager_weight is set.
+  std::shared_ptr<WriteBufferManager::Tenant> wbm_tenant_;
 
   // seqno_to_time_mapping_ stores the sequence number to time mapping, it's not
   // thread safe, both read and write need db mutex hold.
@@ -2881,6 +3011,11 @@ class DBImpl : public DB {
   // The number of LockWAL called without matching UnlockWAL call.
   // See also lock_wal_write_token_
   uint32_t lock_wal_count_;
+
+  // Replication sequence and unix time of the last record applied by
+  // ApplyReplicationLogRecord(). Protected by mutex_.
+  std::string last_applied_replication_sequence_;
+  uint64_t last_applied_replication_time_{0};
 };
 
 class GetWithTimestampReadCallback : public ReadCallback {
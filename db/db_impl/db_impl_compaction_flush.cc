@@ -207,7 +207,7 @@ Status DBImpl::FlushMemTableToOutputFile(
     ColumnFamilyData* cfd, const MutableCFOptions& mutable_cf_options,
     bool* made_progress, JobContext* job_context, FlushReason flush_reason,
     SuperVersionContext* superversion_context,
-    std::vector<SequenceNumber>& snapshot_seqs,
+    const std::shared_ptr<const std::vector<SequenceNumber>>& snapshot_seqs,
     SequenceNumber earliest_write_conflict_snapshot,
     SnapshotChecker* snapshot_checker, LogBuffer* log_buffer,
     Env::Priority thread_pri) {
@@ -270,8 +270,9 @@ Status DBImpl::FlushMemTableToOutputFile(
       snapshot_seqs, earliest_write_conflict_snapshot, snapshot_checker,
       job_context, flush_reason, log_buffer, directories_.GetDbDir(),
       GetDataDir(cfd, 0U),
-      GetCompressionFlush(*cfd->ioptions(), mutable_cf_options), stats_,
-      &event_logger_, mutable_cf_options.report_bg_io_stats,
+      GetCompressionFlush(*cfd->ioptions(), mutable_cf_options),
+      cfd->ioptions()->stats, &event_logger_,
+      mutable_cf_options.report_bg_io_stats,
       true /* sync_output_directory */, true /* write_manifest */, thread_pri,
       io_tracer_, cfd->GetSuperVersion()->ShareSeqnoToTimeMapping(), db_id_,
       db_session_id_, cfd->GetFullHistoryTsLow(), &blob_callback_);
@@ -453,7 +454,7 @@ Status DBImpl::FlushMemTablesToOutputFiles(
         bg_flush_args, made_progress, job_context, log_buffer, thread_pri);
   }
   assert(bg_flush_args.size() == 1);
-  std::vector<SequenceNumber> snapshot_seqs;
+  std::shared_ptr<const std::vector<SequenceNumber>> snapshot_seqs;
   SequenceNumber earliest_write_conflict_snapshot;
   SnapshotChecker* snapshot_checker;
   GetSnapshotContext(job_context, &snapshot_seqs,
@@ -503,7 +504,7 @@ Status DBImpl::AtomicFlushMemTablesToOutputFiles(
   }
 #endif /* !NDEBUG */
 
-  std::vector<SequenceNumber> snapshot_seqs;
+  std::shared_ptr<const std::vector<SequenceNumber>> snapshot_seqs;
   SequenceNumber earliest_write_conflict_snapshot;
   SnapshotChecker* snapshot_checker;
   GetSnapshotContext(job_context, &snapshot_seqs,
@@ -545,8 +546,9 @@ Status DBImpl::AtomicFlushMemTablesToOutputFiles(
         &shutting_down_, snapshot_seqs, earliest_write_conflict_snapshot,
         snapshot_checker, job_context, flush_reason, log_buffer,
         directories_.GetDbDir(), data_dir,
-        GetCompressionFlush(*cfd->ioptions(), mutable_cf_options), stats_,
-        &event_logger_, mutable_cf_options.report_bg_io_stats,
+        GetCompressionFlush(*cfd->ioptions(), mutable_cf_options),
+        cfd->ioptions()->stats, &event_logger_,
+        mutable_cf_options.report_bg_io_stats,
         false /* sync_output_directory */, false /* write_manifest */,
         thread_pri, io_tracer_,
         cfd->GetSuperVersion()->ShareSeqnoToTimeMapping(), db_id_,
@@ -1559,7 +1561,7 @@ Status DBImpl::CompactFilesImpl(
   // deletion compaction currently not allowed in CompactFiles.
   assert(!c->deletion_compaction());
 
-  std::vector<SequenceNumber> snapshot_seqs;
+  std::shared_ptr<const std::vector<SequenceNumber>> snapshot_seqs;
   SequenceNumber earliest_write_conflict_snapshot;
   SnapshotChecker* snapshot_checker;
   GetSnapshotContext(job_context, &snapshot_seqs,
@@ -1576,7 +1578,8 @@ Status DBImpl::CompactFilesImpl(
       file_options_for_compaction_, versions_.get(), &shutting_down_,
       log_buffer, directories_.GetDbDir(),
       GetDataDir(c->column_family_data(), c->output_path_id()),
-      GetDataDir(c->column_family_data(), 0), stats_, &mutex_, &error_handler_,
+      GetDataDir(c->column_family_data(), 0),
+      c->column_family_data()->ioptions()->stats, &mutex_, &error_handler_,
       snapshot_seqs, earliest_write_conflict_snapshot, snapshot_checker,
       job_context, table_cache_, &event_logger_,
       c->mutable_cf_options()->paranoid_file_checks,
@@ -3790,32 +3793,39 @@ Status DBImpl::BackgroundCompaction(bool* made_progress,
     // Move files to next level
     int32_t moved_files = 0;
     int64_t moved_bytes = 0;
-    for (unsigned int l = 0; l < c->num_input_levels(); l++) {
-      if (c->level(l) == c->output_level()) {
-        continue;
-      }
-      for (size_t i = 0; i < c->num_input_files(l); i++) {
-        FileMetaData* f = c->input(l, i);
-        c->edit()->DeleteFile(c->level(l), f->fd.GetNumber());
-        c->edit()->AddFile(
-            c->output_level(), f->fd.GetNumber(), f->fd.GetPathId(),
-            f->fd.GetFileSize(), f->smallest, f->largest, f->fd.smallest_seqno,
-            f->fd.largest_seqno, f->marked_for_compaction, f->temperature,
-            f->oldest_blob_file_number, f->oldest_ancester_time,
-            f->file_creation_time, f->epoch_number, f->file_checksum,
-            f->file_checksum_func_name, f->unique_id,
-            f->compensated_range_deletion_size, f->tail_size,
-            f->user_defined_timestamps_persisted);
-
-        ROCKS_LOG_BUFFER(
-            log_buffer,
-            "[%s] Moving #%" PRIu64 " to level-%d %" PRIu64 " bytes\n",
-            c->column_family_data()->GetName().c_str(), f->fd.GetNumber(),
-            c->output_level(), f->fd.GetFileSize());
-        ++moved_files;
-        moved_bytes += f->fd.GetFileSize();
+    auto add_moved_files = [&](Compaction* move) {
+      int64_t bytes = 0;
+      for (unsigned int l = 0; l < move->num_input_levels(); l++) {
+        if (move->level(l) == move->output_level()) {
+          continue;
+        }
+        for (size_t i = 0; i < move->num_input_files(l); i++) {
+          FileMetaData* f = move->input(l, i);
+          move->edit()->DeleteFile(move->level(l), f->fd.GetNumber());
+          move->edit()->AddFile(
+              move->output_level(), f->fd.GetNumber(), f->fd.GetPathId(),
+              f->fd.GetFileSize(), f->smallest, f->largest,
+              f->fd.smallest_seqno, f->fd.largest_seqno,
+              f->marked_for_compaction, f->temperature,
+              f->oldest_blob_file_number, f->oldest_ancester_time,
+              f->file_creation_time, f->epoch_number, f->file_checksum,
+              f->file_checksum_func_name, f->unique_id,
+              f->compensated_range_deletion_size, f->tail_size,
+              f->user_defined_timestamps_persisted);
+
+          ROCKS_LOG_BUFFER(
+              log_buffer,
+              "[%s] Moving #%" PRIu64 " to level-%d %" PRIu64 " bytes\n",
+              move->column_family_data()->GetName().c_str(),
+              f->fd.GetNumber(), move->output_level(), f->fd.GetFileSize());
+          ++moved_files;
+          bytes += f->fd.GetFileSize();
+        }
       }
-    }
+      moved_bytes += bytes;
+      return bytes;
+    };
+    const int64_t first_moved_bytes = add_moved_files(c.get());
     if (c->compaction_reason() == CompactionReason::kLevelMaxLevelSize &&
         c->immutable_options()->compaction_pri == kRoundRobin) {
       int start_level = c->start_level();
@@ -3826,12 +3836,53 @@ Status DBImpl::BackgroundCompaction(bool* made_progress,
             vstorage->GetNextCompactCursor(start_level, c->num_input_files(0)));
       }
     }
+
+    // Batch the following trivial moves of the column family into the same
+    // MANIFEST write. The files of each move are being compacted, so the
+    // picker only returns moves independent of those already in the batch.
+    std::vector<std::unique_ptr<Compaction>> batched_moves;
+    autovector<VersionEdit*> move_edits{c->edit()};
+    ColumnFamilyData* move_cfd = c->column_family_data();
+    const uint32_t batch_size =
+        is_prepicked ? 0 : c->mutable_cf_options()->trivial_move_batch_size;
+    while (batched_moves.size() + 1 < batch_size &&
+           c->immutable_options()->compaction_pri != kRoundRobin &&
+           !move_cfd->IsDropped() && move_cfd->NeedsCompaction()) {
+      const MutableCFOptions* move_cf_options =
+          move_cfd->GetLatestMutableCFOptions();
+      std::unique_ptr<Compaction> move(move_cfd->PickCompaction(
+          *move_cf_options, mutable_db_options_, log_buffer));
+      if (move == nullptr) {
+        break;
+      }
+      if (move->deletion_compaction() || !move->IsTrivialMove()) {
+        // Left for a compaction of its own
+        move->ReleaseCompactionFiles(Status::OK());
+        move_cfd->current()->storage_info()->ComputeCompactionScore(
+            *move->immutable_options(), *move->mutable_cf_options());
+        break;
+      }
+      TEST_SYNC_POINT_CALLBACK(
+          "DBImpl::BackgroundCompaction:BatchedTrivialMove", move.get());
+      CompactionJobStats move_job_stats;
+      move_job_stats.num_input_files = move->num_input_files(0);
+      NotifyOnCompactionBegin(move_cfd, move.get(), status, move_job_stats,
+                              job_context->job_id);
+      move_cfd->internal_stats()->IncBytesMoved(move->output_level(),
+                                                add_moved_files(move.get()));
+      move_edits.push_back(move->edit());
+      batched_moves.push_back(std::move(move));
+    }
+
     status = versions_->LogAndApply(
         c->column_family_data(), *c->mutable_cf_options(), read_options,
-        write_options, c->edit(), &mutex_, directories_.GetDbDir(),
+        write_options, move_edits, &mutex_, directories_.GetDbDir(),
         /*new_descriptor_log=*/false, /*column_family_options=*/nullptr,
-        [&c, &compaction_released](const Status& s) {
+        [&c, &batched_moves, &compaction_released](const Status& s) {
           c->ReleaseCompactionFiles(s);
+          for (auto& move : batched_moves) {
+            move->ReleaseCompactionFiles(s);
+          }
           compaction_released = true;
         });
     io_s = versions_->io_status();
@@ -3842,13 +3893,14 @@ Status DBImpl::BackgroundCompaction(bool* made_progress,
 
     VersionStorageInfo::LevelSummaryStorage tmp;
     c->column_family_data()->internal_stats()->IncBytesMoved(c->output_level(),
-                                                             moved_bytes);
+                                                             first_moved_bytes);
     {
       event_logger_.LogToBuffer(log_buffer)
           << "job" << job_context->job_id << "event"
           << "trivial_move"
           << "destination_level" << c->output_level() << "files" << moved_files
-          << "total_files_size" << moved_bytes;
+          << "total_files_size" << moved_bytes << "batched_moves"
+          << batched_moves.size();
     }
     ROCKS_LOG_BUFFER(
         log_buffer,
@@ -3858,6 +3910,16 @@ Status DBImpl::BackgroundCompaction(bool* made_progress,
         c->column_family_data()->current()->storage_info()->LevelSummary(&tmp));
     *made_progress = true;
 
+    for (auto& move : batched_moves) {
+      if (!compaction_released) {
+        move->ReleaseCompactionFiles(status);
+      }
+      CompactionJobStats move_job_stats;
+      move_job_stats.num_input_files = move->num_input_files(0);
+      NotifyOnCompactionCompleted(move_cfd, move.get(), status, move_job_stats,
+                                  job_context->job_id);
+    }
+
     // Clear Instrument
     ThreadStatusUtil::ResetThreadStatus();
     TEST_SYNC_POINT_CALLBACK("DBImpl::BackgroundCompaction:AfterCompaction",
@@ -3893,7 +3955,7 @@ Status DBImpl::BackgroundCompaction(bool* made_progress,
     output_level = c->output_level();
     TEST_SYNC_POINT_CALLBACK("DBImpl::BackgroundCompaction:NonTrivial",
                              &output_level);
-    std::vector<SequenceNumber> snapshot_seqs;
+    std::shared_ptr<const std::vector<SequenceNumber>> snapshot_seqs;
     SequenceNumber earliest_write_conflict_snapshot;
     SnapshotChecker* snapshot_checker;
     GetSnapshotContext(job_context, &snapshot_seqs,
@@ -3905,9 +3967,10 @@ Status DBImpl::BackgroundCompaction(bool* made_progress,
         mutable_db_options_, file_options_for_compaction_, versions_.get(),
         &shutting_down_, log_buffer, directories_.GetDbDir(),
         GetDataDir(c->column_family_data(), c->output_path_id()),
-        GetDataDir(c->column_family_data(), 0), stats_, &mutex_,
-        &error_handler_, snapshot_seqs, earliest_write_conflict_snapshot,
-        snapshot_checker, job_context, table_cache_, &event_logger_,
+        GetDataDir(c->column_family_data(), 0),
+        c->column_family_data()->ioptions()->stats, &mutex_, &error_handler_,
+        snapshot_seqs, earliest_write_conflict_snapshot, snapshot_checker,
+        job_context, table_cache_, &event_logger_,
         c->mutable_cf_options()->paranoid_file_checks,
         c->mutable_cf_options()->report_bg_io_stats, dbname_,
         &compaction_job_stats, thread_pri, io_tracer_,
@@ -4321,7 +4384,8 @@ void DBImpl::SetSnapshotChecker(SnapshotChecker* snapshot_checker) {
 }
 
 void DBImpl::GetSnapshotContext(
-    JobContext* job_context, std::vector<SequenceNumber>* snapshot_seqs,
+    JobContext* job_context,
+    std::shared_ptr<const std::vector<SequenceNumber>>* snapshot_seqs,
     SequenceNumber* earliest_write_conflict_snapshot,
     SnapshotChecker** snapshot_checker_ptr) {
   mutex_.AssertHeld();
@@ -4344,7 +4408,7 @@ void DBImpl::GetSnapshotContext(
         GetSnapshotImpl(false /*write_conflict_boundary*/, false /*lock*/);
     job_context->job_snapshot.reset(new ManagedSnapshot(this, job_snapshot));
   }
-  *snapshot_seqs = snapshots_.GetAll(earliest_write_conflict_snapshot);
+  *snapshot_seqs = snapshots_.GetAllShared(earliest_write_conflict_snapshot);
 }
 
 Status DBImpl::WaitForCompact(
@@ -7,10 +7,14 @@
 // Use of this source code is governed by a BSD-style license that can be
 // found in the LICENSE file. See the AUTHORS file for names of contributors.
 #include <cinttypes>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
 
 #include "db/builder.h"
 #include "db/db_impl/db_impl.h"
 #include "db/error_handler.h"
+#include "db/memtable_snapshot.h"
 #include "db/periodic_task_scheduler.h"
 #include "env/composite_env_wrapper.h"
 #include "file/filename.h"
@@ -28,6 +32,7 @@
 #include "util/rate_limiter_impl.h"
 #include "util/string_util.h"
 #include "util/udt_util.h"
+#include "util/work_queue.h"
 
 namespace ROCKSDB_NAMESPACE {
 Options SanitizeOptions(const std::string& dbname, const Options& src,
@@ -416,6 +421,29 @@ IOStatus Directories::SetDirectories(FileSystem* fs, const std::string& dbname,
   return IOStatus::OK();
 }
 
+void DBImpl::MaybeLoadTableSummary() {
+  if (!immutable_db_options_.summarize_tables_on_shutdown) {
+    return;
+  }
+  const std::string fname = TableSummaryFileName(dbname_);
+  if (!fs_->FileExists(fname, IOOptions(), nullptr).ok()) {
+    return;
+  }
+  std::unique_ptr<TableSummary> table_summary(new TableSummary());
+  Status s = table_summary->ReadFromFile(fs_.get(), file_options_, fname,
+                                         immutable_db_options_.info_log);
+  if (s.ok()) {
+    ROCKS_LOG_INFO(immutable_db_options_.info_log,
+                   "Loaded table summary of %" ROCKSDB_PRIszt " files",
+                   table_summary->NumFiles());
+    versions_->SetTableSummary(std::move(table_summary));
+  } else {
+    // The files are opened upfront as usual
+    ROCKS_LOG_WARN(immutable_db_options_.info_log,
+                   "Unable to load table summary: %s", s.ToString().c_str());
+  }
+}
+
 Status DBImpl::Recover(
     const std::vector<ColumnFamilyDescriptor>& column_families, bool read_only,
     bool error_if_wal_file_exists, bool error_if_data_exists_in_wals,
@@ -535,6 +563,7 @@ Status DBImpl::Recover(
   Status s;
   bool missing_table_file = false;
   if (!immutable_db_options_.best_efforts_recovery) {
+    MaybeLoadTableSummary();
     s = versions_->Recover(column_families, read_only, &db_id_);
   } else {
     assert(!files_in_dbname.empty());
@@ -1099,6 +1128,170 @@ bool DBImpl::InvokeWalFilterIfNeededOnWalRecord(uint64_t wal_number,
 }
 
 // REQUIRES: wal_numbers are sorted in ascending order
+namespace {
+// Inserts the batches read from the WALs into the memtables on
+// DBOptions::wal_recovery_threads threads, concurrently and in any order
+class ParallelWalInserter {
+ public:
+  // Inserts the batch recovered from the WAL of the number
+  using InsertFunc = std::function<Status(const WriteBatch&, uint64_t)>;
+
+  ParallelWalInserter(int num_threads, InsertFunc insert)
+      : insert_(std::move(insert)),
+        queue_(kMaxPendingBatchesPerThread * num_threads) {
+    for (int i = 0; i < num_threads; i++) {
+      threads_.emplace_back([this]() { Run(); });
+    }
+  }
+
+  ~ParallelWalInserter() {
+    queue_.finish();
+    for (auto& thread : threads_) {
+      thread.join();
+    }
+    error_.PermitUncheckedError();
+  }
+
+  ParallelWalInserter(const ParallelWalInserter&) = delete;
+  ParallelWalInserter& operator=(const ParallelWalInserter&) = delete;
+
+  void Add(std::unique_ptr<WriteBatch> batch, uint64_t wal_number) {
+    auto task = std::make_shared<Task>();
+    task->batch = std::move(batch);
+    task->wal_number = wal_number;
+    {
+      std::lock_guard<std::mutex> lock(mutex_);
+      num_pending_++;
+    }
+    queue_.push(std::move(task));
+  }
+
+  // Waits for the batches added so far to be inserted. Returns the first
+  // error since the previous call.
+  Status Wait() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    cv_.wait(lock, [this]() { return num_pending_ == 0; });
+    Status s = std::move(error_);
+    error_ = Status::OK();
+    has_error_.store(false, std::memory_order_relaxed);
+    return s;
+  }
+
+  bool HasError() const { return has_error_.load(std::memory_order_relaxed); }
+
+ private:
+  // Bounds the memory of the batches read ahead of the inserts
+  static constexpr size_t kMaxPendingBatchesPerThread = 64;
+
+  struct Task {
+    std::unique_ptr<WriteBatch> batch;
+    uint64_t wal_number = 0;
+  };
+
+  void Run() {
+    std::shared_ptr<Task> task;
+    while (queue_.pop(task)) {
+      Status s = insert_(*task->batch, task->wal_number);
+      task.reset();
+      std::lock_guard<std::mutex> lock(mutex_);
+      if (!s.ok() && error_.ok()) {
+        error_ = s;
+        has_error_.store(true, std::memory_order_relaxed);
+      }
+      assert(num_pending_ > 0);
+      if (--num_pending_ == 0) {
+        cv_.notify_all();
+      }
+    }
+  }
+
+  const InsertFunc insert_;
+  WorkQueue<std::shared_ptr<Task>> queue_;
+  std::vector<port::Thread> threads_;
+  std::mutex mutex_;
+  std::condition_variable cv_;
+  size_t num_pending_ = 0;
+  Status error_;
+  std::atomic<bool> has_error_{false};
+};
+}  // anonymous namespace
+
+void DBImpl::MaybeLoadMemTableSnapshot(
+    const std::vector<uint64_t>& wal_numbers, uint64_t min_wal_number,
+    bool read_only, SequenceNumber* next_sequence, bool* loaded) {
+  mutex_.AssertHeld();
+  *loaded = false;
+  const std::string fname = MemTableSnapshotFileName(dbname_);
+  if (!fs_->FileExists(fname, IOOptions(), nullptr).ok()) {
+    return;
+  }
+
+  MemTableSnapshotReader reader;
+  Status s;
+  if (!immutable_db_options_.snapshot_memtables_on_shutdown || allow_2pc() ||
+      immutable_db_options_.wal_filter != nullptr) {
+    s = Status::NotSupported("disabled by the options");
+  } else {
+    s = reader.Open(fs_.get(), fs_->OptimizeForLogRead(file_options_), fname,
+                    immutable_db_options_.info_log);
+  }
+  if (s.ok() && reader.header().db_id != db_id_) {
+    s = Status::Corruption("memtable snapshot of another DB");
+  }
+  // Usable only if the WALs to replay are the ones it was written from
+  std::vector<std::pair<uint64_t, uint64_t>> wals;
+  const std::string& wal_dir = immutable_db_options_.GetWalDir();
+  for (uint64_t wal_number : wal_numbers) {
+    if (!s.ok()) {
+      break;
+    }
+    if (wal_number >= min_wal_number) {
+      uint64_t size = 0;
+      s = fs_->GetFileSize(LogFileName(wal_dir, wal_number), IOOptions(),
+                           &size, nullptr);
+      wals.emplace_back(wal_number, size);
+    }
+  }
+  if (s.ok() && wals != reader.header().wals) {
+    s = Status::Incomplete("WALs changed since the memtable snapshot");
+  }
+  uint64_t num_entries = 0;
+  if (s.ok()) {
+    s = reader.Load(versions_->GetColumnFamilySet(), &num_entries);
+    if (!s.ok()) {
+      // Drop what was loaded, for the WALs to be replayed from scratch
+      for (auto cfd : *versions_->GetColumnFamilySet()) {
+        cfd->CreateNewMemtable(*cfd->GetLatestMutableCFOptions(),
+                               kMaxSequenceNumber);
+      }
+    }
+  }
+
+  if (s.ok()) {
+    *loaded = true;
+    const SequenceNumber last_sequence = reader.header().last_sequence;
+    *next_sequence = std::max(*next_sequence, last_sequence + 1);
+    if (versions_->LastSequence() < last_sequence) {
+      versions_->SetLastAllocatedSequence(last_sequence);
+      versions_->SetLastPublishedSequence(last_sequence);
+      versions_->SetLastSequence(last_sequence);
+    }
+    ROCKS_LOG_INFO(immutable_db_options_.info_log,
+                   "Loaded memtable snapshot of %" PRIu64
+                   " entries up to seq #%" PRIu64,
+                   num_entries, last_sequence);
+  } else {
+    ROCKS_LOG_INFO(immutable_db_options_.info_log,
+                   "Ignoring memtable snapshot: %s", s.ToString().c_str());
+  }
+  TEST_SYNC_POINT_CALLBACK("DBImpl::MaybeLoadMemTableSnapshot:Loaded",
+                           loaded);
+  // Later writes and flushes make it stale
+  if (!read_only) {
+    fs_->DeleteFile(fname, IOOptions(), nullptr).PermitUncheckedError();
+  }
+}
+
 Status DBImpl::RecoverLogFiles(const std::vector<uint64_t>& wal_numbers,
                                SequenceNumber* next_sequence, bool read_only,
                                bool* corrupted_wal_found,
@@ -1161,6 +1354,54 @@ Status DBImpl::RecoverLogFiles(const std::vector<uint64_t>& wal_numbers,
   bool stop_replay_by_wal_filter = false;
   bool stop_replay_for_corruption = false;
   bool flushed = false;
+
+  // Flushes the memtables the inserts of the WAL `wal_number` scheduled for
+  // flush
+  auto flush_scheduled_memtables = [&](uint64_t wal_number) -> Status {
+    // we can do this because this is called before client has access to the
+    // DB and there is only a single thread operating on DB
+    ColumnFamilyData* cfd;
+
+    while ((cfd = flush_scheduler_.TakeNextColumnFamily()) != nullptr) {
+      cfd->UnrefAndTryDelete();
+      // If this asserts, it means that InsertInto failed in
+      // filtering updates to already-flushed column families
+      assert(cfd->GetLogNumber() <= wal_number);
+      auto iter = version_edits.find(cfd->GetID());
+      assert(iter != version_edits.end());
+      VersionEdit* edit = &iter->second;
+      Status s = WriteLevel0TableForRecovery(job_id, cfd, cfd->mem(), edit);
+      if (!s.ok()) {
+        return s;
+      }
+      flushed = true;
+
+      cfd->CreateNewMemtable(*cfd->GetLatestMutableCFOptions(),
+                             *next_sequence - 1);
+    }
+    return Status::OK();
+  };
+
+  // The batches are inserted concurrently only when their sequence numbers
+  // are known without inserting them, i.e. one per key, and out of the
+  // transaction markers needing the DB mutex. The memtables are only
+  // switched while no insert is in flight.
+  std::unique_ptr<ParallelWalInserter> parallel_inserter;
+  if (immutable_db_options_.wal_recovery_threads > 1 &&
+      immutable_db_options_.allow_concurrent_memtable_write && !allow_2pc() &&
+      !seq_per_batch_) {
+    parallel_inserter.reset(new ParallelWalInserter(
+        immutable_db_options_.wal_recovery_threads,
+        [this](const WriteBatch& batch, uint64_t wal_number) {
+          ColumnFamilyMemTablesImpl column_family_memtables(
+              versions_->GetColumnFamilySet());
+          return WriteBatchInternal::InsertInto(
+              &batch, &column_family_memtables, &flush_scheduler_,
+              &trim_history_scheduler_, true, wal_number, this,
+              true /* concurrent_memtable_writes */, nullptr /* next_seq */,
+              nullptr /* has_valid_writes */, seq_per_batch_, batch_per_txn_);
+        }));
+  }
   uint64_t corrupted_wal_number = kMaxSequenceNumber;
   uint64_t min_wal_number = MinLogNumberToKeep();
   if (!allow_2pc()) {
@@ -1168,6 +1409,9 @@ Status DBImpl::RecoverLogFiles(const std::vector<uint64_t>& wal_numbers,
     min_wal_number =
         std::max(min_wal_number, versions_->MinLogNumberWithUnflushedData());
   }
+  bool memtable_snapshot_loaded = false;
+  MaybeLoadMemTableSnapshot(wal_numbers, min_wal_number, read_only,
+                            next_sequence, &memtable_snapshot_loaded);
   for (auto wal_number : wal_numbers) {
     if (wal_number < min_wal_number) {
       ROCKS_LOG_INFO(immutable_db_options_.info_log,
@@ -1180,6 +1424,13 @@ Status DBImpl::RecoverLogFiles(const std::vector<uint64_t>& wal_numbers,
     // records after allocating this log number.  So we manually
     // update the file number allocation counter in VersionSet.
     versions_->MarkFileNumberUsed(wal_number);
+    if (memtable_snapshot_loaded) {
+      ROCKS_LOG_INFO(immutable_db_options_.info_log,
+                     "Skipping log #%" PRIu64
+                     " since the memtable snapshot holds its data",
+                     wal_number);
+      continue;
+    }
     // Open the log file
     std::string fname =
         LogFileName(immutable_db_options_.GetWalDir(), wal_number);
@@ -1333,11 +1584,33 @@ Status DBImpl::RecoverLogFiles(const std::vector<uint64_t>& wal_numbers,
       // we just ignore the update.
       // That's why we set ignore missing column families to true
       bool has_valid_writes = false;
-      status = WriteBatchInternal::InsertInto(
-          batch_to_use, column_family_memtables_.get(), &flush_scheduler_,
-          &trim_history_scheduler_, true, wal_number, this,
-          false /* concurrent_memtable_writes */, next_sequence,
-          &has_valid_writes, seq_per_batch_, batch_per_txn_);
+      if (parallel_inserter != nullptr && !batch_to_use->HasBeginPrepare() &&
+          !batch_to_use->HasEndPrepare() && !batch_to_use->HasCommit() &&
+          !batch_to_use->HasRollback()) {
+        *next_sequence = sequence + WriteBatchInternal::Count(batch_to_use);
+        parallel_inserter->Add(
+            batch_updated ? std::move(new_batch)
+                          : std::make_unique<WriteBatch>(std::move(batch)),
+            wal_number);
+        batch_to_use = nullptr;
+        // The errors and the flushes wait for the inserts in flight
+        if ((!read_only && !flush_scheduler_.Empty()) ||
+            parallel_inserter->HasError()) {
+          status = parallel_inserter->Wait();
+          has_valid_writes = true;
+        }
+      } else {
+        if (parallel_inserter != nullptr) {
+          status = parallel_inserter->Wait();
+        }
+        if (status.ok()) {
+          status = WriteBatchInternal::InsertInto(
+              batch_to_use, column_family_memtables_.get(), &flush_scheduler_,
+              &trim_history_scheduler_, true, wal_number, this,
+              false /* concurrent_memtable_writes */, next_sequence,
+              &has_valid_writes, seq_per_batch_, batch_per_txn_);
+        }
+      }
       MaybeIgnoreError(&status);
       if (!status.ok()) {
         // We are treating this as a failure while reading since we read valid
@@ -1347,28 +1620,24 @@ Status DBImpl::RecoverLogFiles(const std::vector<uint64_t>& wal_numbers,
       }
 
       if (has_valid_writes && !read_only) {
-        // we can do this because this is called before client has access to the
-        // DB and there is only a single thread operating on DB
-        ColumnFamilyData* cfd;
-
-        while ((cfd = flush_scheduler_.TakeNextColumnFamily()) != nullptr) {
-          cfd->UnrefAndTryDelete();
-          // If this asserts, it means that InsertInto failed in
-          // filtering updates to already-flushed column families
-          assert(cfd->GetLogNumber() <= wal_number);
-          auto iter = version_edits.find(cfd->GetID());
-          assert(iter != version_edits.end());
-          VersionEdit* edit = &iter->second;
-          status = WriteLevel0TableForRecovery(job_id, cfd, cfd->mem(), edit);
-          if (!status.ok()) {
-            // Reflect errors immediately so that conditions like full
-            // file-systems cause the DB::Open() to fail.
-            return status;
-          }
-          flushed = true;
+        status = flush_scheduled_memtables(wal_number);
+        if (!status.ok()) {
+          // Reflect errors immediately so that conditions like full
+          // file-systems cause the DB::Open() to fail.
+          return status;
+        }
+      }
+    }
 
-          cfd->CreateNewMemtable(*cfd->GetLatestMutableCFOptions(),
-                                 *next_sequence - 1);
+    if (parallel_inserter != nullptr) {
+      Status insert_status = parallel_inserter->Wait();
+      MaybeIgnoreError(&insert_status);
+      if (!insert_status.ok()) {
+        reporter.Corruption(0, insert_status);
+      } else if (!read_only) {
+        insert_status = flush_scheduled_memtables(wal_number);
+        if (!insert_status.ok()) {
+          return insert_status;
         }
       }
     }
@@ -13,6 +13,7 @@
 #include "logging/logging.h"
 #include "monitoring/perf_context_imp.h"
 #include "util/cast_util.h"
+#include "util/defer.h"
 
 namespace ROCKSDB_NAMESPACE {
 
@@ -57,6 +58,18 @@ Status DBImplReadOnly::GetImpl(const ReadOptions& read_options,
     get_impl_options.timestamp->clear();
   }
 
+  // Only locate the projected columns of an entity, the projection of a plain
+  // value is done once found
+  if (get_impl_options.columns && read_options.column_projection) {
+    get_impl_options.columns->SetColumnProjection(
+        read_options.column_projection);
+  }
+  Defer reset_column_projection([&get_impl_options]() {
+    if (get_impl_options.columns) {
+      get_impl_options.columns->SetColumnProjection(nullptr);
+    }
+  });
+
   PERF_CPU_TIMER_GUARD(get_cpu_nanos, immutable_db_options_.clock);
   StopWatch sw(immutable_db_options_.clock, stats_, DB_GET);
   PERF_TIMER_GUARD(get_snapshot_time);
@@ -121,6 +134,9 @@ Status DBImplReadOnly::GetImpl(const ReadOptions& read_options,
     if (get_impl_options.value) {
       size = get_impl_options.value->size();
     } else if (get_impl_options.columns) {
+      if (read_options.column_projection) {
+        get_impl_options.columns->Project(*read_options.column_projection);
+      }
       size = get_impl_options.columns->serialized_size();
     }
     RecordTick(stats_, BYTES_READ, size);
@@ -14,6 +14,7 @@
 #include "monitoring/perf_context_imp.h"
 #include "rocksdb/configurable.h"
 #include "util/cast_util.h"
+#include "util/defer.h"
 #include "util/write_batch_util.h"
 
 namespace ROCKSDB_NAMESPACE {
@@ -210,6 +211,19 @@ Status DBImplSecondary::RecoverLogFiles(
     // Manually update the file number allocation counter in VersionSet.
     versions_->MarkFileNumberUsed(log_number);
 
+    if (reader->IsEOF() && !reader->hasReadError()) {
+      // A WAL read up to its end before has no new records unless it grew,
+      // which a stat tells for less than a read at the tail.
+      uint64_t log_size = 0;
+      if (fs_->GetFileSize(reader->file()->file_name(), IOOptions(), &log_size,
+                           nullptr)
+              .ok() &&
+          log_size == reader->GetReadOffset()) {
+        TEST_SYNC_POINT("DBImplSecondary::RecoverLogFiles:NoNewRecords");
+        continue;
+      }
+    }
+
     // Determine if we should tolerate incomplete records at the tail end of the
     // Read all the records and add to a memtable
     std::string scratch;
@@ -368,6 +382,18 @@ Status DBImplSecondary::GetImpl(const ReadOptions& read_options,
     get_impl_options.timestamp->clear();
   }
 
+  // Only locate the projected columns of an entity, the projection of a plain
+  // value is done once found
+  if (get_impl_options.columns && read_options.column_projection) {
+    get_impl_options.columns->SetColumnProjection(
+        read_options.column_projection);
+  }
+  Defer reset_column_projection([&get_impl_options]() {
+    if (get_impl_options.columns) {
+      get_impl_options.columns->SetColumnProjection(nullptr);
+    }
+  });
+
   PERF_CPU_TIMER_GUARD(get_cpu_nanos, immutable_db_options_.clock);
   StopWatch sw(immutable_db_options_.clock, stats_, DB_GET);
   PERF_TIMER_GUARD(get_snapshot_time);
@@ -452,6 +478,9 @@ Status DBImplSecondary::GetImpl(const ReadOptions& read_options,
     if (get_impl_options.value) {
       size = get_impl_options.value->size();
     } else if (get_impl_options.columns) {
+      if (read_options.column_projection) {
+        get_impl_options.columns->Project(*read_options.column_projection);
+      }
       size = get_impl_options.columns->serialized_size();
     }
     RecordTick(stats_, BYTES_READ, size);
@@ -542,6 +571,7 @@ ArenaWrappedDBIter* DBImplSecondary::NewIteratorImpl(
       db_iter->GetReadOptions(), cfh->cfd(), super_version, db_iter->GetArena(),
       snapshot, /* allow_unprepared_value */ true, db_iter);
   db_iter->SetIterUnderDBIter(internal_iter);
+  db_iter->ChargeMemory(this);
   return db_iter;
 }
 
@@ -912,7 +942,8 @@ Status DBImplSecondary::CompactWithoutInstallation(
       job_id, c.get(), immutable_db_options_, mutable_db_options_,
       file_options_for_compaction_, versions_.get(), &shutting_down_,
       &log_buffer, output_dir.get(), stats_, &mutex_, &error_handler_,
-      input.snapshots, table_cache_, &event_logger_, dbname_, io_tracer_,
+      std::make_shared<const std::vector<SequenceNumber>>(input.snapshots),
+      table_cache_, &event_logger_, dbname_, io_tracer_,
       options.canceled ? *options.canceled : kManualCompactionCanceledFalse_,
       input.db_id, db_session_id_, secondary_path_, input, result);
 
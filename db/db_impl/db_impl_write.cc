@@ -13,10 +13,12 @@
 #include "db/event_helpers.h"
 #include "db/db_impl/replication_codec.h"
 #include "logging/logging.h"
+#include "monitoring/op_trace_impl.h"
 #include "monitoring/perf_context_imp.h"
 #include "options/options_helper.h"
 #include "test_util/sync_point.h"
 #include "util/cast_util.h"
+#include "util/crc32c.h"
 
 namespace ROCKSDB_NAMESPACE {
 // Convenience methods
@@ -175,6 +177,114 @@ Status DBImpl::WriteWithCallback(const WriteOptions& write_options,
   return s;
 }
 
+void DBImpl::WriteAsync(const WriteOptions& write_options, WriteBatch* my_batch,
+                        std::function<void(const Status&)> callback) {
+  {
+    std::lock_guard<std::mutex> lock(async_write_mutex_);
+    if (!async_write_stop_) {
+      if (!async_write_thread_.joinable()) {
+        async_write_thread_ = port::Thread([this] { AsyncWriteLoop(); });
+      }
+      async_writes_.push_back({write_options, my_batch, std::move(callback)});
+      async_write_cv_.notify_one();
+      return;
+    }
+  }
+  callback(Status::ShutdownInProgress());
+}
+
+namespace {
+// Whether the writes queued by WriteAsync() with a and b can be made as one
+// write of both batches. Batches with user-defined timestamps are written
+// alone, since appending them to another batch loses whether their
+// timestamps are still to be set.
+bool CanMergeAsyncWrites(const WriteOptions& a, const WriteBatch* a_batch,
+                         const WriteOptions& b, const WriteBatch* b_batch) {
+  return !WriteBatchInternal::HasKeyWithTimestamp(*a_batch) &&
+         !WriteBatchInternal::HasKeyWithTimestamp(*b_batch) &&
+         a.sync == b.sync && a.disableWAL == b.disableWAL &&
+         a.ignore_missing_column_families == b.ignore_missing_column_families &&
+         a.no_slowdown == b.no_slowdown && a.low_pri == b.low_pri &&
+         a.pre_release_callback == nullptr &&
+         b.pre_release_callback == nullptr &&
+         a.memtable_insert_hint_per_batch == b.memtable_insert_hint_per_batch &&
+         a.rate_limiter_priority == b.rate_limiter_priority &&
+         a.protection_bytes_per_key == b.protection_bytes_per_key &&
+         a.io_activity == b.io_activity &&
+         a_batch->GetProtectionBytesPerKey() ==
+             b_batch->GetProtectionBytesPerKey() &&
+         a_batch->GetWalTerminationPoint().is_cleared() &&
+         b_batch->GetWalTerminationPoint().is_cleared();
+}
+}  // namespace
+
+void DBImpl::AsyncWriteLoop() {
+  std::vector<AsyncWrite> writes;
+  while (true) {
+    size_t group_bytes = 0;
+    {
+      std::unique_lock<std::mutex> lock(async_write_mutex_);
+      async_write_cv_.wait(lock, [this] {
+        return async_write_stop_ || !async_writes_.empty();
+      });
+      if (async_writes_.empty()) {
+        return;
+      }
+      // The writes queued while the previous ones were written form the
+      // next write, like the followers of a write group.
+      while (!async_writes_.empty()) {
+        const AsyncWrite& next = async_writes_.front();
+        size_t next_bytes = next.batch->GetDataSize();
+        if (!writes.empty() &&
+            (!CanMergeAsyncWrites(writes[0].options, writes[0].batch,
+                                  next.options, next.batch) ||
+             group_bytes + next_bytes >
+                 immutable_db_options_.max_write_batch_group_size_bytes)) {
+          break;
+        }
+        group_bytes += next_bytes;
+        writes.push_back(std::move(async_writes_.front()));
+        async_writes_.pop_front();
+      }
+    }
+
+    Status s;
+    if (writes.size() == 1) {
+      s = Write(writes[0].options, writes[0].batch);
+    } else {
+      WriteBatch merged(group_bytes, 0 /* max_bytes */,
+                        writes[0].batch->GetProtectionBytesPerKey(),
+                        0 /* default_cf_ts_sz */);
+      for (const AsyncWrite& w : writes) {
+        s = WriteBatchInternal::Append(&merged, w.batch);
+        if (!s.ok()) {
+          break;
+        }
+      }
+      if (s.ok()) {
+        s = Write(writes[0].options, &merged);
+      }
+    }
+    size_t num_writes = writes.size();
+    TEST_SYNC_POINT_CALLBACK("DBImpl::AsyncWriteLoop:Written", &num_writes);
+    for (const AsyncWrite& w : writes) {
+      w.callback(s);
+    }
+    writes.clear();
+  }
+}
+
+void DBImpl::StopAsyncWrites() {
+  {
+    std::lock_guard<std::mutex> lock(async_write_mutex_);
+    async_write_stop_ = true;
+    async_write_cv_.notify_one();
+  }
+  if (async_write_thread_.joinable()) {
+    async_write_thread_.join();
+  }
+}
+
 // The main write queue. This is the only write queue that updates LastSequence.
 // When using one write queue, the same sequence also indicates the last
 // published sequence.
@@ -185,6 +295,8 @@ Status DBImpl::WriteImpl(const WriteOptions& write_options,
                          size_t batch_cnt,
                          PreReleaseCallback* pre_release_callback,
                          PostMemTableCallback* post_memtable_callback) {
+  OP_TRACE_OPERATION(immutable_db_options_, "Write");
+  PERF_SAMPLED_OPERATION_GUARD();
   if (!pre_release_callback) {
     pre_release_callback = write_options.pre_release_callback;
   }
@@ -235,14 +347,12 @@ Status DBImpl::WriteImpl(const WriteOptions& write_options,
       return Status::NotSupported(
           "replication_log_listener is not compatible with unordered_write");
     }
-    if (two_write_queues_) {
+    if (two_write_queues_ && seq_per_batch_) {
+      // The WAL-only writes of the second queue would leave gaps in the
+      // sequence numbers of the replication log.
       return Status::NotSupported(
-          "replication_log_listener is not compatible with two_write_queues");
-    }
-    if (immutable_db_options_.enable_pipelined_write) {
-      return Status::NotSupported(
-          "replication_log_listener is not compatible with "
-          "enable_pipelined_write");
+          "replication_log_listener is not compatible with two_write_queues "
+          "and seq_per_batch");
     }
     if (!write_options.disableWAL) {
       return Status::NotSupported(
@@ -348,13 +458,17 @@ Status DBImpl::WriteImpl(const WriteOptions& write_options,
                         post_memtable_callback);
   StopWatch write_sw(immutable_db_options_.clock, stats_, DB_WRITE);
 
-  write_thread_.JoinBatchGroup(&w);
+  {
+    OP_TRACE_SPAN("write_group_wait");
+    write_thread_.JoinBatchGroup(&w);
+  }
   if (w.state == WriteThread::STATE_PARALLEL_MEMTABLE_WRITER) {
     // we are a non-leader in a parallel group
 
     if (w.ShouldWriteToMemtable()) {
       PERF_TIMER_STOP(write_pre_and_post_process_time);
       PERF_TIMER_FOR_WAIT_GUARD(write_memtable_time);
+      OP_TRACE_SPAN("memtable_insert");
 
       ColumnFamilyMemTablesImpl column_family_memtables(
           versions_->GetColumnFamilySet());
@@ -445,15 +559,16 @@ Status DBImpl::WriteImpl(const WriteOptions& write_options,
   if (status.ok()) {
     // Rules for when we can update the memtable concurrently
     // 1. supported by memtable
-    // 2. Puts are not okay if inplace_update_support
+    // 2. Puts are not okay if inplace_update_support with an
+    //    inplace_callback
     // 3. Merges are not okay
     //
     // Rules 1..2 are enforced by checking the options
     // during startup (CheckConcurrentWritesSupported), so if
     // options.allow_concurrent_memtable_write is true then they can be
-    // assumed to be true.  Rule 3 is checked for each batch.  We could
-    // relax rules 2 if we could prevent write batches from referring
-    // more than once to a particular key.
+    // assumed to be true.  Rule 3 is checked for each batch.  In-place
+    // updates without a callback serialize the writes to a key in the
+    // memtable, see MemTable::Update().
     bool parallel = immutable_db_options_.allow_concurrent_memtable_write &&
                     write_group.size > 1;
     size_t total_count = 0;
@@ -532,6 +647,7 @@ Status DBImpl::WriteImpl(const WriteOptions& write_options,
         LogFileNumberSize& log_file_number_size =
             *(log_context.log_file_number_size);
         PERF_TIMER_GUARD(write_wal_time);
+        OP_TRACE_SPAN("wal_write");
         io_s =
             WriteToWAL(write_group, log_context.writer, log_used,
                        log_context.need_log_sync, log_context.need_log_dir_sync,
@@ -540,6 +656,7 @@ Status DBImpl::WriteImpl(const WriteOptions& write_options,
     } else {
       if (status.ok() && !write_options.disableWAL) {
         PERF_TIMER_GUARD(write_wal_time);
+        OP_TRACE_SPAN("wal_write");
         // LastAllocatedSequence is increased inside WriteToWAL under
         // wal_write_mutex_ to ensure ordered events in WAL
         io_s = ConcurrentWriteToWAL(write_group, log_used, &last_sequence,
@@ -554,26 +671,9 @@ Status DBImpl::WriteImpl(const WriteOptions& write_options,
     const SequenceNumber current_sequence = last_sequence + 1;
     last_sequence += seq_inc;
 
-    if (status.ok() && immutable_db_options_.replication_log_listener) {
-      WriteBatch wb;
-      bool first = true;
-      for (auto writer : write_group) {
-        Status s;
-        if (first) {
-          s = WriteBatchInternal::SetContents(&wb, writer->batch->Data());
-          first = false;
-        } else {
-          s = WriteBatchInternal::Append(&wb, writer->batch, true);
-        }
-        assert(s.ok());
-      }
-      WriteBatchInternal::SetSequence(&wb, current_sequence);
-
-      ReplicationLogRecord rlr;
-      rlr.contents = WriteBatchInternal::StealContents(&wb);
-      rlr.type = ReplicationLogRecord::kMemtableWrite;
-      immutable_db_options_.replication_log_listener->OnReplicationLogRecord(
-          std::move(rlr));
+    if (status.ok() && immutable_db_options_.replication_log_listener &&
+        total_count > 0) {
+      ReplicateWriteGroup(write_group, current_sequence, total_byte_size);
     }
 
     // PreReleaseCallback is called after WAL write and before memtable write
@@ -609,6 +709,7 @@ Status DBImpl::WriteImpl(const WriteOptions& write_options,
 
     if (status.ok()) {
       PERF_TIMER_FOR_WAIT_GUARD(write_memtable_time);
+      OP_TRACE_SPAN("memtable_insert");
 
       if (!parallel) {
         // w.sequence will be set inside InsertInto
@@ -731,7 +832,10 @@ Status DBImpl::PipelinedWriteImpl(const WriteOptions& write_options,
   WriteThread::Writer w(write_options, my_batch, callback, log_ref,
                         disable_memtable, /*_batch_cnt=*/0,
                         /*_pre_release_callback=*/nullptr);
-  write_thread_.JoinBatchGroup(&w);
+  {
+    OP_TRACE_SPAN("write_group_wait");
+    write_thread_.JoinBatchGroup(&w);
+  }
   TEST_SYNC_POINT("DBImplWrite::PipelinedWriteImpl:AfterJoinBatchGroup");
   if (w.state == WriteThread::STATE_GROUP_LEADER) {
     WriteThread::WriteGroup wal_write_group;
@@ -782,6 +886,13 @@ Status DBImpl::PipelinedWriteImpl(const WriteOptions& write_options,
         has_unpersisted_data_.store(true, std::memory_order_relaxed);
       }
       write_thread_.UpdateLastSequence(current_sequence + total_count - 1);
+      // Replicated before the memtable writers are launched, while this
+      // thread leads the WAL stage: the next memtable switch waits for the
+      // memtable writers of this group.
+      if (immutable_db_options_.replication_log_listener && total_count > 0) {
+        ReplicateWriteGroup(wal_write_group, current_sequence,
+                            total_byte_size);
+      }
     }
 
     auto stats = default_cf_internal_stats_;
@@ -798,6 +909,7 @@ Status DBImpl::PipelinedWriteImpl(const WriteOptions& write_options,
 
     if (w.status.ok() && !write_options.disableWAL) {
       PERF_TIMER_GUARD(write_wal_time);
+      OP_TRACE_SPAN("wal_write");
       stats->AddDBStats(InternalStats::kIntStatsWriteDoneBySelf, 1);
       RecordTick(stats_, WRITE_DONE_BY_SELF, 1);
       if (wal_write_group.size > 1) {
@@ -849,6 +961,7 @@ Status DBImpl::PipelinedWriteImpl(const WriteOptions& write_options,
 
   if (w.state == WriteThread::STATE_MEMTABLE_WRITER_LEADER) {
     PERF_TIMER_FOR_WAIT_GUARD(write_memtable_time);
+    OP_TRACE_SPAN("memtable_insert");
     assert(w.ShouldWriteToMemtable());
     write_thread_.EnterAsMemTableWriter(&w, &memtable_write_group);
     if (memtable_write_group.size > 1 &&
@@ -876,12 +989,16 @@ Status DBImpl::PipelinedWriteImpl(const WriteOptions& write_options,
     assert(w.ShouldWriteToMemtable());
     ColumnFamilyMemTablesImpl column_family_memtables(
         versions_->GetColumnFamilySet());
-    w.status = WriteBatchInternal::InsertInto(
-        &w, w.sequence, &column_family_memtables, &flush_scheduler_,
-        &trim_history_scheduler_, write_options.ignore_missing_column_families,
-        0 /*log_number*/, this, true /*concurrent_memtable_writes*/,
-        false /*seq_per_batch*/, 0 /*batch_cnt*/, true /*batch_per_txn*/,
-        write_options.memtable_insert_hint_per_batch);
+    {
+      OP_TRACE_SPAN("memtable_insert");
+      w.status = WriteBatchInternal::InsertInto(
+          &w, w.sequence, &column_family_memtables, &flush_scheduler_,
+          &trim_history_scheduler_,
+          write_options.ignore_missing_column_families, 0 /*log_number*/, this,
+          true /*concurrent_memtable_writes*/, false /*seq_per_batch*/,
+          0 /*batch_cnt*/, true /*batch_per_txn*/,
+          write_options.memtable_insert_hint_per_batch);
+    }
 
     PERF_TIMER_STOP(write_memtable_time);
     PERF_TIMER_START(write_pre_and_post_process_time);
@@ -900,6 +1017,42 @@ Status DBImpl::PipelinedWriteImpl(const WriteOptions& write_options,
   return w.FinalStatus();
 }
 
+void DBImpl::ReplicateWriteGroup(const WriteThread::WriteGroup& write_group,
+                                 SequenceNumber sequence,
+                                 size_t total_byte_size) {
+  // The whole write group is replicated as one record, merging the batches
+  // that are written to the memtable, in the order InsertInto applies them.
+  const auto& listener = immutable_db_options_.replication_log_listener;
+  ReplicationLogRecord rlr;
+  rlr.type = ReplicationLogRecord::kMemtableWrite;
+  WriteThread::Writer* only_writer = nullptr;
+  size_t memtable_writers = 0;
+  for (auto writer : write_group) {
+    if (writer->ShouldWriteToMemtable()) {
+      only_writer = writer;
+      memtable_writers++;
+    }
+  }
+  if (memtable_writers == 1 && listener->AcceptsPinnedContents()) {
+    // The writer's batch outlives the call to the listener, it is
+    // referenced rather than copied.
+    WriteBatchInternal::SetSequence(only_writer->batch, sequence);
+    rlr.pinned_contents = only_writer->batch->Data();
+  } else {
+    WriteBatch wb(total_byte_size);
+    for (auto writer : write_group) {
+      if (!writer->ShouldWriteToMemtable()) {
+        continue;
+      }
+      Status s = WriteBatchInternal::Append(&wb, writer->batch);
+      assert(s.ok());
+    }
+    WriteBatchInternal::SetSequence(&wb, sequence);
+    rlr.contents = WriteBatchInternal::StealContents(&wb);
+  }
+  listener->OnReplicationLogRecord(std::move(rlr));
+}
+
 Status DBImpl::UnorderedWriteMemtable(const WriteOptions& write_options,
                                       WriteBatch* my_batch,
                                       WriteCallback* callback, uint64_t log_ref,
@@ -1251,7 +1404,10 @@ Status DBImpl::PreprocessWrite(const WriteOptions& write_options,
     }
   }
 
-  if (UNLIKELY(status.ok() && write_buffer_manager_->ShouldFlush())) {
+  // With DBOptions::write_buffer_manager_weight, DBs within their share are
+  // left alone while another DB is over its share.
+  if (UNLIKELY(status.ok() &&
+               write_buffer_manager_->ShouldFlush(wbm_tenant_.get()))) {
     // Before a new memtable is added in SwitchMemtable(),
     // write_buffer_manager_->ShouldFlush() will keep returning true. If another
     // thread is writing to another DB with the same write buffer, they may also
@@ -1294,8 +1450,11 @@ Status DBImpl::PreprocessWrite(const WriteOptions& write_options,
   // all DBs and writers will be stalled.
   // It does soft checking because WriteBufferManager::buffer_limit_ has already
   // exceeded at this point so no new write (including current one) will go
-  // through until memory usage is decreased.
-  if (UNLIKELY(status.ok() && write_buffer_manager_->ShouldStall())) {
+  // through until memory usage is decreased. With
+  // DBOptions::write_buffer_manager_weight, only the DBs over their share are
+  // stalled.
+  if (UNLIKELY(status.ok() &&
+               write_buffer_manager_->ShouldStall(wbm_tenant_.get()))) {
     default_cf_internal_stats_->AddDBStats(
         InternalStats::kIntStatsWriteBufferManagerLimitStopsCounts, 1,
         true /* concurrent */);
@@ -1362,6 +1521,16 @@ Status DBImpl::MergeBatch(const WriteThread::WriteGroup& write_group,
     // We could avoid copying here with an iov-like AddRecord
     // interface
     *merged_batch = tmp_batch;
+    // Size the merged batch up front so that appending the batches does not
+    // reallocate it several times.
+    size_t merged_size = WriteBatchInternal::kHeader;
+    for (auto writer : write_group) {
+      if (!writer->CallbackFailed()) {
+        merged_size += WriteBatchInternal::ByteSize(writer->batch) -
+                       WriteBatchInternal::kHeader;
+      }
+    }
+    tmp_batch->Reserve(merged_size);
     for (auto writer : write_group) {
       if (!writer->CallbackFailed()) {
         Status s = WriteBatchInternal::Append(*merged_batch, writer->batch,
@@ -1382,21 +1551,23 @@ Status DBImpl::MergeBatch(const WriteThread::WriteGroup& write_group,
   return Status::OK();
 }
 
+IOStatus DBImpl::VerifyWALBatch(const WriteBatch& merged_batch) {
+  Slice log_entry = WriteBatchInternal::Contents(&merged_batch);
+  TEST_SYNC_POINT_CALLBACK("DBImpl::WriteToWAL:log_entry", &log_entry);
+  return status_to_io_status(merged_batch.VerifyChecksum());
+}
+
 // When two_write_queues_ is disabled, this function is called from the only
 // write thread. Otherwise this must be called holding log_write_mutex_.
 IOStatus DBImpl::WriteToWAL(const WriteBatch& merged_batch,
                             const WriteOptions& write_options,
                             log::Writer* log_writer, uint64_t* log_used,
                             uint64_t* log_size,
-                            LogFileNumberSize& log_file_number_size) {
+                            LogFileNumberSize& log_file_number_size,
+                            const log::RecordBodyCrc* body_crc) {
   assert(log_size != nullptr);
 
   Slice log_entry = WriteBatchInternal::Contents(&merged_batch);
-  TEST_SYNC_POINT_CALLBACK("DBImpl::WriteToWAL:log_entry", &log_entry);
-  auto s = merged_batch.VerifyChecksum();
-  if (!s.ok()) {
-    return status_to_io_status(std::move(s));
-  }
   *log_size = log_entry.size();
   // When two_write_queues_ WriteToWAL has to be protected from concurretn calls
   // from the two queues anyway and log_write_mutex_ is already held. Otherwise
@@ -1414,7 +1585,7 @@ IOStatus DBImpl::WriteToWAL(const WriteBatch& merged_batch,
   if (!io_s.ok()) {
     return io_s;
   }
-  io_s = log_writer->AddRecord(write_options, log_entry);
+  io_s = log_writer->AddRecord(write_options, log_entry, body_crc);
 
   if (UNLIKELY(needs_locking)) {
     log_write_mutex_.Unlock();
@@ -1456,6 +1627,14 @@ IOStatus DBImpl::WriteToWAL(const WriteThread::WriteGroup& write_group,
 
   WriteBatchInternal::SetSequence(merged_batch, sequence);
 
+  io_s = VerifyWALBatch(*merged_batch);
+  if (UNLIKELY(!io_s.ok())) {
+    if (merged_batch == &tmp_batch_) {
+      tmp_batch_.Clear();
+    }
+    return io_s;
+  }
+
   uint64_t log_size;
 
   // TODO: plumb Env::IOActivity, Env::IOPriority
@@ -1491,6 +1670,7 @@ IOStatus DBImpl::WriteToWAL(const WriteThread::WriteGroup& write_group,
     }
 
     if (io_s.ok()) {
+      OP_TRACE_SPAN("wal_sync");
       for (auto& log : logs_) {
         IOOptions opts;
         io_s = WritableFileWriter::PrepareIOOptions(write_options, opts);
@@ -1553,6 +1733,26 @@ IOStatus DBImpl::ConcurrentWriteToWAL(
     return io_s;
   }
 
+  // log_write_mutex_ serializes the WAL writes of all the write queues, so
+  // verify and checksum the batch before taking it. Only the sequence number
+  // in the header of the batch is set under the lock, and the log writer
+  // combines the crc of the header with the crc of the rest of the batch.
+  io_s = VerifyWALBatch(*merged_batch);
+  if (UNLIKELY(!io_s.ok())) {
+    return io_s;
+  }
+  const Slice log_entry = WriteBatchInternal::Contents(merged_batch);
+  log::RecordBodyCrc body_crc;
+  const log::RecordBodyCrc* precomputed_crc = nullptr;
+  // The crc is only of use if the record fits in a single physical record.
+  if (immutable_db_options_.wal_compression == kNoCompression &&
+      log_entry.size() + log::kRecyclableHeaderSize <= log::kBlockSize) {
+    body_crc.prefix_size = WriteBatchInternal::kHeader;
+    body_crc.crc = crc32c::Value(log_entry.data() + body_crc.prefix_size,
+                                 log_entry.size() - body_crc.prefix_size);
+    precomputed_crc = &body_crc;
+  }
+
   // We need to lock log_write_mutex_ since logs_ and alive_log_files might be
   // pushed back concurrently
   log_write_mutex_.Lock();
@@ -1579,7 +1779,7 @@ IOStatus DBImpl::ConcurrentWriteToWAL(
   write_options.rate_limiter_priority =
       write_group.leader->rate_limiter_priority;
   io_s = WriteToWAL(*merged_batch, write_options, log_writer, log_used,
-                    &log_size, log_file_number_size);
+                    &log_size, log_file_number_size, precomputed_crc);
   if (to_be_cached_state) {
     cached_recoverable_state_ = *to_be_cached_state;
     cached_recoverable_state_empty_ = false;
@@ -2725,4 +2925,9 @@ Status DB::Merge(const WriteOptions& opt, ColumnFamilyHandle* column_family,
   return Write(opt, &batch);
 }
 
+void DB::WriteAsync(const WriteOptions& options, WriteBatch* updates,
+                    std::function<void(const Status&)> callback) {
+  callback(Write(options, updates));
+}
+
 }  // namespace ROCKSDB_NAMESPACE
@@ -1,6 +1,7 @@
 #include "db/db_impl/replication_codec.h"
 #include "db/memtable.h"
 #include "util/coding.h"
+#include "util/compression.h"
 
 namespace ROCKSDB_NAMESPACE {
 
@@ -27,4 +28,53 @@ std::string RecordMemTableSwitch(
   SerializeMemTableSwitchRecord(&rlr.contents, record);
   return replication_log_listener->OnReplicationLogRecord(std::move(rlr));
 }
+
+namespace {
+// Same as blob files
+constexpr uint32_t kReplicationCompressionFormatVersion = 2;
+}  // namespace
+
+Status CompressReplicationLogRecord(CompressionType type,
+                                    ReplicationLogRecord* record) {
+  if (type == kNoCompression || record->compression != kNoCompression) {
+    return Status::OK();
+  }
+  if (!CompressionTypeSupported(type)) {
+    return Status::NotSupported("Compression type not supported",
+                                CompressionTypeToString(type));
+  }
+  CompressionOptions opts;
+  CompressionContext context(type, opts);
+  CompressionInfo info(opts, context, CompressionDict::GetEmptyDict(), type,
+                       0 /* sample_for_compression */);
+  std::string compressed;
+  if (!CompressData(record->GetContents(), info,
+                    kReplicationCompressionFormatVersion, &compressed)) {
+    return Status::Corruption("Error compressing replication log record");
+  }
+  record->contents = std::move(compressed);
+  record->pinned_contents.clear();
+  record->compression = type;
+  return Status::OK();
+}
+
+Status UncompressReplicationLogRecord(ReplicationLogRecord* record) {
+  record->Own();
+  if (record->compression == kNoCompression) {
+    return Status::OK();
+  }
+  UncompressionContext context(record->compression);
+  UncompressionInfo info(context, UncompressionDict::GetEmptyDict(),
+                         record->compression);
+  size_t uncompressed_size = 0;
+  CacheAllocationPtr output = UncompressData(
+      info, record->contents.data(), record->contents.size(),
+      &uncompressed_size, kReplicationCompressionFormatVersion);
+  if (!output) {
+    return Status::Corruption("Unable to uncompress replication log record");
+  }
+  record->contents.assign(output.get(), uncompressed_size);
+  record->compression = kNoCompression;
+  return Status::OK();
 }
+}  // namespace ROCKSDB_NAMESPACE
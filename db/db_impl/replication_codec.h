@@ -35,4 +35,8 @@ std::string RecordMemTableSwitch(
     const std::shared_ptr<rocksdb::ReplicationLogListener>&
         replication_log_listener,
     const MemTableSwitchRecord& mem_switch_record);
+
+// Makes the record own its contents, uncompressing them if needed, before it
+// is applied.
+Status UncompressReplicationLogRecord(ReplicationLogRecord* record);
 }  // namespace ROCKSDB_NAMESPACE
@@ -253,6 +253,62 @@ TEST_F(DBTestInPlaceUpdate, InPlaceUpdateAndSnapshot) {
   } while (ChangeCompactOptions());
 }
 
+TEST_F(DBTestInPlaceUpdate, ConcurrentInPlaceUpdate) {
+  Options options = CurrentOptions();
+  options.create_if_missing = true;
+  options.inplace_update_support = true;
+  options.env = env_;
+  options.write_buffer_size = 1 << 20;
+  options.allow_concurrent_memtable_write = true;
+  Reopen(options);
+  CreateAndReopenWithCF({"pikachu"}, options);
+
+  const int kNumWriters = 4;
+  const int kNumWrites = 1000;
+  std::atomic<int> num_writers{kNumWriters};
+  std::vector<port::Thread> threads;
+  for (int t = 0; t < kNumWriters; t++) {
+    threads.emplace_back([&, t]() {
+      std::string value = DummyString(8, static_cast<char>('a' + t));
+      for (int i = 0; i < kNumWrites; i++) {
+        ASSERT_OK(db_->Put(WriteOptions(), handles_[1], "key", value));
+      }
+      num_writers--;
+    });
+  }
+  // Values updated in-place are never read torn
+  threads.emplace_back([&]() {
+    while (num_writers > 0) {
+      std::string value;
+      Status s = db_->Get(ReadOptions(), handles_[1], "key", &value);
+      if (s.IsNotFound()) {
+        continue;
+      }
+      ASSERT_OK(s);
+      ASSERT_EQ(DummyString(8, value[0]), value);
+    }
+  });
+  for (auto& thread : threads) {
+    thread.join();
+  }
+
+  std::string value = Get(1, "key");
+  ASSERT_EQ(DummyString(8, value[0]), value);
+  // Only 1 instance for that key.
+  validateNumberOfEntries(1, 1);
+}
+
+TEST_F(DBTestInPlaceUpdate, ConcurrentInPlaceUpdateCallbackNotSupported) {
+  Options options = CurrentOptions();
+  options.create_if_missing = true;
+  options.inplace_update_support = true;
+  options.inplace_callback =
+      ROCKSDB_NAMESPACE::DBTestInPlaceUpdate::updateInPlaceNoAction;
+  options.env = env_;
+  options.allow_concurrent_memtable_write = true;
+  ASSERT_TRUE(TryReopen(options).IsInvalidArgument());
+}
+
 }  // namespace ROCKSDB_NAMESPACE
 
 int main(int argc, char** argv) {
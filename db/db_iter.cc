@@ -13,6 +13,7 @@
 #include <limits>
 #include <string>
 
+#include "db/blob/blob_index.h"
 #include "db/dbformat.h"
 #include "db/merge_context.h"
 #include "db/merge_helper.h"
@@ -22,6 +23,7 @@
 #include "file/filename.h"
 #include "logging/logging.h"
 #include "memory/arena.h"
+#include "monitoring/op_trace_impl.h"
 #include "monitoring/perf_context_imp.h"
 #include "rocksdb/env.h"
 #include "rocksdb/iterator.h"
@@ -56,6 +58,8 @@ DBIter::DBIter(Env* _env, const ReadOptions& read_options,
       read_callback_(read_callback),
       sequence_(s),
       statistics_(ioptions.stats),
+      op_trace_sink_(ioptions.op_trace_sink.get()),
+      op_trace_sample_one_in_(ioptions.op_trace_sample_one_in),
       max_skip_(max_sequential_skip_in_iterations),
       max_skippable_internal_keys_(read_options.max_skippable_internal_keys),
       num_internal_keys_skipped_(0),
@@ -82,7 +86,10 @@ DBIter::DBIter(Env* _env, const ReadOptions& read_options,
       cfh_(cfh),
       timestamp_ub_(read_options.timestamp),
       timestamp_lb_(read_options.iter_start_ts),
-      timestamp_size_(timestamp_ub_ ? timestamp_ub_->size() : 0) {
+      timestamp_size_(timestamp_ub_ ? timestamp_ub_->size() : 0),
+      column_projection_(read_options.column_projection),
+      blob_readahead_size_(
+          ioptions.allow_mmap_reads ? 0 : read_options.blob_readahead_size) {
   RecordTick(statistics_, NO_ITERATOR_CREATED);
   if (pin_thru_lifetime_) {
     pinned_iters_mgr_.StartPinning();
@@ -206,11 +213,25 @@ bool DBIter::SetBlobValueIfNeeded(const Slice& user_key,
   read_options.fill_cache = fill_cache_;
   read_options.verify_checksums = verify_checksums_;
   read_options.io_activity = io_activity_;
-  constexpr FilePrefetchBuffer* prefetch_buffer = nullptr;
   constexpr uint64_t* bytes_read = nullptr;
 
-  const Status s = version_->GetBlob(read_options, user_key, blob_index,
-                                     prefetch_buffer, &blob_value_, bytes_read);
+  BlobIndex decoded_blob_index;
+  Status s = decoded_blob_index.DecodeFrom(blob_index);
+
+  if (s.ok()) {
+    FilePrefetchBuffer* prefetch_buffer = nullptr;
+    if (blob_readahead_size_ > 0 && direction_ == kForward) {
+      if (!blob_prefetch_buffers_) {
+        blob_prefetch_buffers_.reset(
+            new PrefetchBufferCollection(blob_readahead_size_));
+      }
+      prefetch_buffer = blob_prefetch_buffers_->GetOrCreatePrefetchBuffer(
+          decoded_blob_index.file_number());
+    }
+
+    s = version_->GetBlob(read_options, user_key, decoded_blob_index,
+                          prefetch_buffer, &blob_value_, bytes_read);
+  }
 
   if (!s.ok()) {
     status_ = s;
@@ -226,7 +247,11 @@ bool DBIter::SetValueAndColumnsFromEntity(Slice slice) {
   assert(value_.empty());
   assert(wide_columns_.empty());
 
-  const Status s = WideColumnSerialization::Deserialize(slice, wide_columns_);
+  const Status s =
+      column_projection_
+          ? WideColumnSerialization::Deserialize(slice, *column_projection_,
+                                                 wide_columns_)
+          : WideColumnSerialization::Deserialize(slice, wide_columns_);
 
   if (!s.ok()) {
     status_ = s;
@@ -1493,6 +1518,9 @@ void DBIter::SetSavedKeyToSeekForPrevTarget(const Slice& target) {
 }
 
 void DBIter::Seek(const Slice& target) {
+  OpTraceScope op_trace_scope(op_trace_sink_, op_trace_sample_one_in_, clock_,
+                              "Seek");
+  PERF_SAMPLED_OPERATION_GUARD();
   PERF_COUNTER_ADD(iter_seek_count, 1);
   PERF_CPU_TIMER_GUARD(iter_seek_cpu_nanos, clock_);
   StopWatch sw(clock_, statistics_, DB_SEEK);
@@ -1568,7 +1596,15 @@ void DBIter::Seek(const Slice& target) {
   PERF_COUNTER_ADD(iter_read_bytes, key().size() + value().size());
 }
 
+void DBIter::StartSeek(const Slice& target) {
+  SetSavedKeyToSeekTarget(target);
+  iter_.iter()->StartSeek(saved_key_.GetInternalKey());
+}
+
 void DBIter::SeekForPrev(const Slice& target) {
+  OpTraceScope op_trace_scope(op_trace_sink_, op_trace_sample_one_in_, clock_,
+                              "Seek");
+  PERF_SAMPLED_OPERATION_GUARD();
   PERF_COUNTER_ADD(iter_seek_count, 1);
   PERF_CPU_TIMER_GUARD(iter_seek_cpu_nanos, clock_);
   StopWatch sw(clock_, statistics_, DB_SEEK);
@@ -8,9 +8,12 @@
 // found in the LICENSE file. See the AUTHORS file for names of contributors.
 
 #pragma once
+#include <algorithm>
 #include <cstdint>
 #include <string>
+#include <vector>
 
+#include "db/blob/prefetch_buffer_collection.h"
 #include "db/db_impl/db_impl.h"
 #include "db/range_del_aggregator.h"
 #include "memory/arena.h"
@@ -205,6 +208,7 @@ class DBIter final : public Iterator {
   // 'target' does not contain timestamp, even if user timestamp feature is
   // enabled.
   void Seek(const Slice& target) final override;
+  void StartSeek(const Slice& target) final override;
   void SeekForPrev(const Slice& target) final override;
   void SeekToFirst() final override;
   void SeekToLast() final override;
@@ -314,6 +318,12 @@ class DBIter final : public Iterator {
     assert(value_.empty());
     assert(wide_columns_.empty());
 
+    if (column_projection_ &&
+        std::find(column_projection_->begin(), column_projection_->end(),
+                  kDefaultWideColumnName) == column_projection_->end()) {
+      return;
+    }
+
     value_ = slice;
     wide_columns_.emplace_back(kDefaultWideColumnName, slice);
   }
@@ -384,6 +394,8 @@ class DBIter final : public Iterator {
   // All columns (i.e. name-value pairs)
   WideColumns wide_columns_;
   Statistics* statistics_;
+  OpTraceSink* op_trace_sink_;
+  uint32_t op_trace_sample_one_in_;
   uint64_t max_skip_;
   uint64_t max_skippable_internal_keys_;
   uint64_t num_internal_keys_skipped_;
@@ -430,6 +442,12 @@ class DBIter final : public Iterator {
   const Slice* const timestamp_lb_;
   const size_t timestamp_size_;
   std::string saved_timestamp_;
+  // See ReadOptions::column_projection.
+  const std::vector<Slice>* const column_projection_;
+  // See ReadOptions::blob_readahead_size. The prefetch buffers are created
+  // on the first blob value read ahead.
+  const uint64_t blob_readahead_size_;
+  std::unique_ptr<PrefetchBufferCollection> blob_prefetch_buffers_;
 };
 
 // Return a new iterator that converts internal keys (yielded by
@@ -9,6 +9,7 @@
 
 #include <functional>
 
+#include "cache/cache_reservation_manager.h"
 #include "db/arena_wrapped_db_iter.h"
 #include "db/db_iter.h"
 #include "db/db_test_util.h"
@@ -81,6 +82,118 @@ TEST_F(DBIteratorBaseTest, APICallsWithPerfContext) {
   delete iter;
 }
 
+TEST_F(DBIteratorBaseTest, IteratorMemoryCharge) {
+  const size_t kDummyEntrySize = CacheReservationManagerImpl<
+      CacheEntryRole::kIterator>::GetDummyEntrySize();
+  LRUCacheOptions co;
+  co.capacity = 2 * kDummyEntrySize;
+  co.num_shard_bits = 0;
+  co.strict_capacity_limit = true;
+  co.metadata_charge_policy = kDontChargeCacheMetadata;
+  std::shared_ptr<Cache> cache = NewLRUCache(co);
+  Options options = CurrentOptions();
+  options.iterator_memory_cache = cache;
+  DestroyAndReopen(options);
+  ASSERT_OK(Put("foo", "bar"));
+
+  uint64_t mem_usage = 0;
+  ASSERT_TRUE(
+      db_->GetIntProperty(DB::Properties::kIteratorsMemUsage, &mem_usage));
+  ASSERT_EQ(0, mem_usage);
+
+  std::unique_ptr<Iterator> iter(db_->NewIterator(ReadOptions()));
+  ASSERT_OK(iter->status());
+  ASSERT_TRUE(
+      db_->GetIntProperty(DB::Properties::kIteratorsMemUsage, &mem_usage));
+  ASSERT_GT(mem_usage, 0);
+  ASSERT_LT(mem_usage, kDummyEntrySize);
+  ASSERT_EQ(kDummyEntrySize, cache->GetUsage());
+
+  // A rebuilt iterator stays charged
+  ASSERT_OK(Flush());
+  ASSERT_OK(iter->Refresh());
+  iter->SeekToFirst();
+  ASSERT_TRUE(iter->Valid());
+  ASSERT_TRUE(
+      db_->GetIntProperty(DB::Properties::kIteratorsMemUsage, &mem_usage));
+  ASSERT_GT(mem_usage, 0);
+  ASSERT_EQ(kDummyEntrySize, cache->GetUsage());
+
+  iter.reset();
+  ASSERT_TRUE(
+      db_->GetIntProperty(DB::Properties::kIteratorsMemUsage, &mem_usage));
+  ASSERT_EQ(0, mem_usage);
+  ASSERT_EQ(0, cache->GetUsage());
+
+  // The iterators fail when the cache is full
+  CacheReservationManagerImpl<CacheEntryRole::kMisc> filler(cache);
+  ASSERT_OK(filler.UpdateCacheReservation(co.capacity));
+  iter.reset(db_->NewIterator(ReadOptions()));
+  ASSERT_TRUE(iter->status().IsMemoryLimit());
+  iter.reset();
+  std::vector<Iterator*> iters;
+  ASSERT_TRUE(db_->NewIterators(ReadOptions(), {db_->DefaultColumnFamily()},
+                                &iters)
+                  .IsMemoryLimit());
+  ASSERT_TRUE(iters.empty());
+  ASSERT_TRUE(
+      db_->GetIntProperty(DB::Properties::kIteratorsMemUsage, &mem_usage));
+  ASSERT_EQ(0, mem_usage);
+
+  ASSERT_OK(filler.UpdateCacheReservation(0));
+  iter.reset(db_->NewIterator(ReadOptions()));
+  ASSERT_OK(iter->status());
+}
+
+TEST_F(DBIteratorBaseTest, StartSeekOfSeveralIterators) {
+  Options options = CurrentOptions();
+  options.disable_auto_compactions = true;
+  BlockBasedTableOptions table_options;
+  table_options.block_size = 64;
+  options.table_factory.reset(NewBlockBasedTableFactory(table_options));
+  DestroyAndReopen(options);
+
+  // Keys over an L1 file, overlapping L0 files and the memtable
+  for (int i = 0; i < 100; i += 2) {
+    ASSERT_OK(Put(Key(i), "v1_" + std::to_string(i)));
+  }
+  ASSERT_OK(Flush());
+  MoveFilesToLevel(1);
+  for (int i = 1; i < 100; i += 4) {
+    ASSERT_OK(Put(Key(i), "v2_" + std::to_string(i)));
+    if (i % 20 == 17) {
+      ASSERT_OK(Flush());
+    }
+  }
+  ASSERT_OK(Flush());
+  ASSERT_OK(Put(Key(50), "v3"));
+
+  const std::vector<std::string> targets = {Key(0), Key(33), Key(50),
+                                            Key(77), Key(100)};
+  ReadOptions async_read_options;
+  async_read_options.async_io = true;
+  std::vector<std::unique_ptr<Iterator>> iters;
+  for (size_t i = 0; i < targets.size(); ++i) {
+    iters.emplace_back(db_->NewIterator(async_read_options));
+    iters.back()->StartSeek(targets[i]);
+  }
+  for (size_t i = 0; i < targets.size(); ++i) {
+    std::unique_ptr<Iterator> expected_iter(db_->NewIterator(ReadOptions()));
+    expected_iter->Seek(targets[i]);
+    iters[i]->Seek(targets[i]);
+    for (int n = 0; n < 10 && expected_iter->Valid(); ++n) {
+      ASSERT_TRUE(iters[i]->Valid());
+      ASSERT_EQ(expected_iter->key(), iters[i]->key());
+      ASSERT_EQ(expected_iter->value(), iters[i]->value());
+      expected_iter->Next();
+      iters[i]->Next();
+    }
+    ASSERT_EQ(expected_iter->Valid(), iters[i]->Valid());
+    ASSERT_OK(expected_iter->status());
+    ASSERT_OK(iters[i]->status());
+  }
+}
+
 // Test param:
 //   bool: whether to pass read_callback to NewIterator().
 class DBIteratorTest : public DBIteratorBaseTest,
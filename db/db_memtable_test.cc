@@ -335,6 +335,86 @@ TEST_F(DBMemTableTest, ColumnFamilyId) {
   }
 }
 
+TEST_F(DBMemTableTest, VectorRepParallelSort) {
+  Options options = CurrentOptions();
+  options.allow_concurrent_memtable_write = false;
+  options.write_buffer_size = 64 << 20;
+  options.memtable_factory.reset(
+      new VectorRepFactory(0 /* count */, 3 /* parallel_sort_threads */));
+  DestroyAndReopen(options);
+
+  // Enough keys for the flush to sort the memtable in parallel, written in
+  // random order.
+  const int kNumKeys = 200000;
+  std::vector<int> order(kNumKeys);
+  for (int i = 0; i < kNumKeys; i++) {
+    order[i] = i;
+  }
+  RandomShuffle(order.begin(), order.end(), 301);
+  for (int i : order) {
+    ASSERT_OK(Put(Key(i), std::to_string(i)));
+  }
+  ASSERT_OK(Flush());
+  ASSERT_EQ(1, NumTableFilesAtLevel(0));
+
+  std::unique_ptr<Iterator> iter(db_->NewIterator(ReadOptions()));
+  int i = 0;
+  for (iter->SeekToFirst(); iter->Valid(); iter->Next(), i++) {
+    ASSERT_EQ(Key(i), iter->key());
+    ASSERT_EQ(std::to_string(i), iter->value());
+  }
+  ASSERT_OK(iter->status());
+  ASSERT_EQ(kNumKeys, i);
+}
+
+TEST_F(DBMemTableTest, SkipListHashIndex) {
+  Options options = CurrentOptions();
+  options.write_buffer_size = 64 << 20;
+  // Few buckets, so that the chains hold several keys.
+  options.memtable_factory.reset(
+      new SkipListFactory(0 /* lookahead */, 4 /* hash_index_buckets */));
+  options.merge_operator = MergeOperators::CreateStringAppendOperator();
+  DestroyAndReopen(options);
+
+  const int kNumKeys = 100;
+  std::vector<const Snapshot*> snapshots;
+  for (int version = 0; version < 3; version++) {
+    for (int i = 0; i < kNumKeys; i++) {
+      ASSERT_OK(Put(Key(i), Key(i) + "_v" + std::to_string(version)));
+    }
+    snapshots.push_back(db_->GetSnapshot());
+  }
+  ASSERT_OK(Delete(Key(0)));
+  ASSERT_OK(Merge(Key(1), "m"));
+
+  ASSERT_EQ("NOT_FOUND", Get(Key(0)));
+  ASSERT_EQ(Key(1) + "_v2,m", Get(Key(1)));
+  ASSERT_EQ(Key(2) + "_v2", Get(Key(2)));
+  ASSERT_EQ("NOT_FOUND", Get(Key(kNumKeys)));
+  // Reads at a snapshot walk past the newer versions.
+  for (int version = 0; version < 3; version++) {
+    for (int i = 0; i < kNumKeys; i += 7) {
+      ASSERT_EQ(Key(i) + "_v" + std::to_string(version),
+                Get(Key(i), snapshots[version]));
+    }
+  }
+
+  std::vector<std::string> keys;
+  for (int i = 0; i <= kNumKeys; i++) {
+    keys.push_back(Key(i));
+  }
+  std::vector<std::string> values = MultiGet(keys, snapshots[1]);
+  ASSERT_EQ(keys.size(), values.size());
+  for (int i = 0; i < kNumKeys; i++) {
+    ASSERT_EQ(Key(i) + "_v1", values[i]);
+  }
+  ASSERT_EQ("NOT_FOUND", values[kNumKeys]);
+
+  for (const Snapshot* snapshot : snapshots) {
+    db_->ReleaseSnapshot(snapshot);
+  }
+}
+
 }  // namespace ROCKSDB_NAMESPACE
 
 int main(int argc, char** argv) {
@@ -951,6 +951,97 @@ TEST_P(PerConfigMergeOperatorPinningTest, Randomized) {
   VerifyDBFromMap(true_data);
 }
 
+TEST_F(DBMergeOperatorTest, MergeResultCache) {
+  class CountingStringAppendMergeOp : public StringAppendTESTOperator {
+   public:
+    CountingStringAppendMergeOp() : StringAppendTESTOperator(',') {}
+
+    bool FullMergeV2(const MergeOperationInput& merge_in,
+                     MergeOperationOutput* merge_out) const override {
+      num_operands += merge_in.operand_list.size();
+      return StringAppendTESTOperator::FullMergeV2(merge_in, merge_out);
+    }
+
+    mutable size_t num_operands = 0;
+  };
+
+  auto merge_op = std::make_shared<CountingStringAppendMergeOp>();
+  Options options = CurrentOptions();
+  options.create_if_missing = true;
+  options.merge_operator = merge_op;
+  options.merge_result_cache = NewLRUCache(1 << 20);
+  options.env = env_;
+  DestroyAndReopen(options);
+
+  int hits = 0;
+  SyncPoint::GetInstance()->SetCallBack(
+      "DBImpl::GetImpl:MergeResultCacheHit", [&](void* /*arg*/) { ++hits; });
+  SyncPoint::GetInstance()->EnableProcessing();
+
+  auto get_merged = [&](const Snapshot* snapshot = nullptr) {
+    ReadOptions read_opts;
+    read_opts.snapshot = snapshot;
+    merge_op->num_operands = 0;
+    std::string value;
+    EXPECT_OK(db_->Get(read_opts, "k", &value));
+    return value;
+  };
+
+  ASSERT_OK(Merge("k", "a"));
+  ASSERT_OK(Merge("k", "b"));
+  ASSERT_OK(Merge("k", "c"));
+  ASSERT_EQ(get_merged(), "a,b,c");
+  ASSERT_EQ(merge_op->num_operands, 3);
+  ASSERT_EQ(hits, 0);
+
+  // Nothing left to merge
+  ASSERT_EQ(get_merged(), "a,b,c");
+  ASSERT_EQ(merge_op->num_operands, 0);
+  ASSERT_EQ(hits, 1);
+
+  // Only the new operand is merged
+  ASSERT_OK(Merge("k", "d"));
+  ASSERT_EQ(get_merged(), "a,b,c,d");
+  ASSERT_EQ(merge_op->num_operands, 1);
+
+  const Snapshot* snapshot = db_->GetSnapshot();
+  ASSERT_OK(Merge("k", "e"));
+  ASSERT_EQ(get_merged(snapshot), "a,b,c,d");
+  ASSERT_EQ(merge_op->num_operands, 0);
+  ASSERT_EQ(get_merged(), "a,b,c,d,e");
+  ASSERT_EQ(merge_op->num_operands, 1);
+  // The cached result is newer than the snapshot and not used for it
+  ASSERT_EQ(get_merged(snapshot), "a,b,c,d");
+  ASSERT_EQ(merge_op->num_operands, 4);
+
+  // The cached result covers entries in SST files
+  ASSERT_EQ(get_merged(), "a,b,c,d,e");
+  ASSERT_OK(Flush());
+  ASSERT_OK(Merge("k", "f"));
+  ASSERT_EQ(get_merged(), "a,b,c,d,e,f");
+  ASSERT_EQ(merge_op->num_operands, 1);
+  db_->ReleaseSnapshot(snapshot);
+
+  ASSERT_OK(Flush());
+  ASSERT_OK(db_->CompactRange(CompactRangeOptions(), nullptr, nullptr));
+  ASSERT_OK(Merge("k", "g"));
+  ASSERT_EQ(get_merged(), "a,b,c,d,e,f,g");
+
+  // A newer deletion or value hides the cached result
+  ASSERT_OK(Delete("k"));
+  ASSERT_OK(Merge("k", "h"));
+  ASSERT_EQ(get_merged(), "h");
+  ASSERT_OK(Put("k", "i"));
+  ASSERT_OK(Merge("k", "j"));
+  ASSERT_EQ(get_merged(), "i,j");
+  ASSERT_OK(Merge("k", "k"));
+  ASSERT_EQ(get_merged(), "i,j,k");
+  ASSERT_EQ(merge_op->num_operands, 1);
+
+  SyncPoint::GetInstance()->DisableProcessing();
+  SyncPoint::GetInstance()->ClearAllCallBacks();
+}
+
 TEST_F(DBMergeOperatorTest, MaxSuccessiveMergesBaseValues) {
   Options options = CurrentOptions();
   options.create_if_missing = true;
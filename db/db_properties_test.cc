@@ -313,6 +313,71 @@ TEST_F(DBPropertiesTest, ValidateSampleNumber) {
   ASSERT_EQ("50", num);
 }
 
+TEST_F(DBPropertiesTest, ReadHeatMap) {
+  Options options = CurrentOptions();
+  options.disable_auto_compactions = true;
+  DestroyAndReopen(options);
+  ASSERT_OK(Put("a", "v"));
+  ASSERT_OK(Flush());
+  ASSERT_OK(Put("z", "v"));
+  ASSERT_OK(Flush());
+
+  // Reads are sampled, so do enough of them for some to be
+  for (int i = 0; i < 20000; i++) {
+    ASSERT_EQ("v", Get("a"));
+    std::unique_ptr<Iterator> iter(db_->NewIterator(ReadOptions()));
+    iter->Seek("z");
+    ASSERT_TRUE(iter->Valid());
+  }
+
+  auto get_files = [&]() {
+    std::vector<LiveFileMetaData> files;
+    db_->GetLiveFilesMetaData(&files);
+    EXPECT_EQ(2, files.size());
+    std::sort(files.begin(), files.end(),
+              [](const LiveFileMetaData& a, const LiveFileMetaData& b) {
+                return a.smallestkey < b.smallestkey;
+              });
+    return files;
+  };
+  std::vector<LiveFileMetaData> files = get_files();
+  ASSERT_EQ("a", files[0].smallestkey);
+  // Every iterator reads all the L0 files, and only "a" is looked up
+  ASSERT_GT(files[0].num_seeks_sampled, 0);
+  ASSERT_GT(files[0].num_reads_sampled, files[0].num_seeks_sampled);
+  ASSERT_GT(files[1].num_seeks_sampled, 0);
+  ASSERT_EQ(files[1].num_reads_sampled, files[1].num_seeks_sampled);
+  ASSERT_EQ(0, files[0].num_reads_sampled_last_window);
+  ASSERT_EQ(0, files[1].num_seeks_sampled_last_window);
+
+  // A periodic stats dump ends the window
+  std::string value;
+  ASSERT_TRUE(db_->GetProperty(InternalStats::kPeriodicCFStats, &value));
+  std::vector<LiveFileMetaData> files_after_window = get_files();
+  ASSERT_EQ(files[0].num_reads_sampled,
+            files_after_window[0].num_reads_sampled_last_window);
+  ASSERT_EQ(files[1].num_seeks_sampled,
+            files_after_window[1].num_seeks_sampled_last_window);
+
+  // Ordered by smallest key
+  ASSERT_TRUE(db_->GetProperty(DB::Properties::kReadHeatMap, &value));
+  size_t a_pos = value.find(" 61 61\n");
+  size_t z_pos = value.find(" 7A 7A\n");
+  ASSERT_NE(std::string::npos, a_pos);
+  ASSERT_NE(std::string::npos, z_pos);
+  ASSERT_LT(a_pos, z_pos);
+
+  std::map<std::string, std::string> heat_map;
+  ASSERT_TRUE(db_->GetMapProperty(DB::Properties::kReadHeatMap, &heat_map));
+  ASSERT_EQ(2, heat_map.size());
+  const std::string& a_heat = heat_map[std::to_string(files[0].file_number)];
+  ASSERT_NE(std::string::npos, a_heat.find("level=0;"));
+  ASSERT_NE(std::string::npos, a_heat.find("smallest_key=61;largest_key=61;"));
+  ASSERT_NE(std::string::npos,
+            a_heat.find(";reads=" +
+                        std::to_string(files[0].num_reads_sampled) + ";"));
+}
+
 TEST_F(DBPropertiesTest, AggregatedTableProperties) {
   for (int kTableCount = 40; kTableCount <= 100; kTableCount += 30) {
     const int kDeletionsPerTable = 0;
@@ -505,6 +570,35 @@ TEST_F(DBPropertiesTest, ReadLatencyHistogramByLevel) {
   ASSERT_EQ(std::string::npos, prop.find("** Level 2 read latency histogram"));
 }
 
+TEST_F(DBPropertiesTest, ReadLatencyHistogramAllocatedOnOpen) {
+  Options options = CurrentOptions();
+  options.num_levels = 4;
+  CreateAndReopenWithCF({"pikachu"}, options);
+  InternalStats* internal_stats =
+      static_cast_with_check<ColumnFamilyHandleImpl>(handles_[1])
+          ->cfd()
+          ->internal_stats();
+  for (int level = 0; level < options.num_levels; level++) {
+    ASSERT_FALSE(internal_stats->TEST_HasFileReadHist(level));
+  }
+
+  ASSERT_OK(Put(1, "foo", "bar"));
+  ASSERT_OK(Flush(1));
+  ASSERT_EQ("bar", Get(1, "foo"));
+  ASSERT_TRUE(internal_stats->TEST_HasFileReadHist(0));
+  for (int level = 1; level < options.num_levels; level++) {
+    ASSERT_FALSE(internal_stats->TEST_HasFileReadHist(level));
+  }
+  ASSERT_EQ(internal_stats->GetFileReadHist(0),
+            internal_stats->GetFileReadHist(0));
+
+  std::string prop;
+  ASSERT_TRUE(
+      dbfull()->GetProperty(handles_[1], "rocksdb.cf-file-histogram", &prop));
+  ASSERT_NE(std::string::npos, prop.find("** Level 0 read latency histogram"));
+  ASSERT_EQ(std::string::npos, prop.find("** Level 1 read latency histogram"));
+}
+
 TEST_F(DBPropertiesTest, AggregatedTablePropertiesAtLevel) {
   const int kTableCount = 100;
   const int kDeletionsPerTable = 0;
@@ -3149,6 +3149,41 @@ TEST_F(DBRangeDelTest, RangetombesoneCompensateFilesizePersistDuringReopen) {
   ASSERT_EQ(level_to_files[1][0].compensated_range_deletion_size, l2_size);
 }
 
+TEST_F(DBRangeDelTest, RangeDeletionCompactionRatio) {
+  Options opts = CurrentOptions();
+  opts.disable_auto_compactions = true;
+  opts.range_deletion_compaction_ratio = 1;
+  DestroyAndReopen(opts);
+
+  Random rnd(301);
+  for (int i = 0; i < 10; ++i) {
+    ASSERT_OK(Put(Key(i), rnd.RandomString(1 << 10)));
+  }
+  ASSERT_OK(Flush());
+  MoveFilesToLevel(2);
+
+  // Covers nothing below, so it is not marked
+  ASSERT_OK(
+      db_->DeleteRange(WriteOptions(), db_->DefaultColumnFamily(), "x", "z"));
+  ASSERT_OK(Flush());
+  // Covers the whole L2 file, which is larger than the tombstone's file
+  ASSERT_OK(db_->DeleteRange(WriteOptions(), db_->DefaultColumnFamily(),
+                             Key(0), Key(10)));
+  ASSERT_OK(Flush());
+  ASSERT_EQ("2,0,1", FilesPerLevel());
+
+  ASSERT_OK(dbfull()->SetOptions({{"disable_auto_compactions", "false"}}));
+  ASSERT_OK(dbfull()->TEST_WaitForCompact());
+  // The tombstone was compacted down to L2, dropping the covered keys with
+  // it, while the other file stayed in L0
+  ASSERT_EQ("1", FilesPerLevel());
+  std::vector<std::vector<FileMetaData>> level_to_files;
+  dbfull()->TEST_GetFilesMetaData(dbfull()->DefaultColumnFamily(),
+                                  &level_to_files);
+  ASSERT_EQ(level_to_files[0].size(), 1);
+  ASSERT_EQ(level_to_files[0][0].compensated_range_deletion_size, 0);
+}
+
 TEST_F(DBRangeDelTest, SingleKeyFile) {
   // Test for a bug fix where a range tombstone could be added
   // to an SST file while is not within the file's key range.
@@ -615,6 +615,54 @@ TEST_F(DBSecondaryTest, OpenAsSecondaryWALTailing) {
   verify_db_func("new_foo_value_1", "new_bar_value");
 }
 
+TEST_F(DBSecondaryTest, CatchUpWithNothingNew) {
+  Options options;
+  options.env = env_;
+  Reopen(options);
+  ASSERT_OK(Put("foo", "foo_value"));
+  Options options1;
+  options1.env = env_;
+  options1.max_open_files = -1;
+  OpenSecondary(options1);
+
+  std::atomic<int> manifest_skips{0};
+  std::atomic<int> wal_skips{0};
+  SyncPoint::GetInstance()->SetCallBack(
+      "ReactiveVersionSet::ReadAndApply:NoNewEdits",
+      [&](void* /*arg*/) { manifest_skips++; });
+  SyncPoint::GetInstance()->SetCallBack(
+      "DBImplSecondary::RecoverLogFiles:NoNewRecords",
+      [&](void* /*arg*/) { wal_skips++; });
+  SyncPoint::GetInstance()->EnableProcessing();
+
+  // Neither the MANIFEST nor the WAL grew since the open
+  ASSERT_OK(db_secondary_->TryCatchUpWithPrimary());
+  ASSERT_EQ(1, manifest_skips.load());
+  ASSERT_EQ(1, wal_skips.load());
+
+  // Only the WAL grew
+  ASSERT_OK(Put("foo", "new_foo_value"));
+  ASSERT_OK(db_secondary_->TryCatchUpWithPrimary());
+  ASSERT_EQ(2, manifest_skips.load());
+  ASSERT_EQ(1, wal_skips.load());
+  std::string value;
+  ASSERT_OK(db_secondary_->Get(ReadOptions(), "foo", &value));
+  ASSERT_EQ("new_foo_value", value);
+
+  // Both grew
+  ASSERT_OK(Flush());
+  ASSERT_OK(Put("bar", "bar_value"));
+  ASSERT_OK(db_secondary_->TryCatchUpWithPrimary());
+  ASSERT_EQ(2, manifest_skips.load());
+  ASSERT_OK(db_secondary_->Get(ReadOptions(), "bar", &value));
+  ASSERT_EQ("bar_value", value);
+  ASSERT_OK(db_secondary_->Get(ReadOptions(), "foo", &value));
+  ASSERT_EQ("new_foo_value", value);
+
+  SyncPoint::GetInstance()->DisableProcessing();
+  SyncPoint::GetInstance()->ClearAllCallBacks();
+}
+
 TEST_F(DBSecondaryTest, SecondaryTailingBug_ISSUE_8467) {
   Options options;
   options.env = env_;
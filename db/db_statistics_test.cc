@@ -285,6 +285,39 @@ TEST_F(DBStatisticsTest, BlockChecksumStats) {
             options.statistics->getTickerCount(BLOCK_CHECKSUM_MISMATCH_COUNT));
 }
 
+TEST_F(DBStatisticsTest, ColumnFamilyStatistics) {
+  Options options = CurrentOptions();
+  options.statistics = ROCKSDB_NAMESPACE::CreateDBStatistics();
+  DestroyAndReopen(options);
+  Options cf_options = options;
+  cf_options.column_family_statistics =
+      ROCKSDB_NAMESPACE::CreateDBStatistics();
+  CreateColumnFamilies({"pikachu"}, cf_options);
+
+  ASSERT_OK(Put(0, "a", "1"));
+  ASSERT_OK(Put(1, "b", "22"));
+  ASSERT_OK(Flush(0));
+  ASSERT_OK(Flush(1));
+  ASSERT_EQ("1", Get(0, "a"));
+  ASSERT_EQ("22", Get(1, "b"));
+
+  // The reads of the column family are in both statistics
+  const auto& cf_stats = cf_options.column_family_statistics;
+  ASSERT_EQ(1, cf_stats->getTickerCount(NUMBER_KEYS_READ));
+  ASSERT_EQ(2, cf_stats->getTickerCount(BYTES_READ));
+  ASSERT_EQ(2, options.statistics->getTickerCount(NUMBER_KEYS_READ));
+  ASSERT_EQ(3, options.statistics->getTickerCount(BYTES_READ));
+  HistogramData cf_get;
+  cf_stats->histogramData(DB_GET, &cf_get);
+  ASSERT_EQ(1, cf_get.count);
+  HistogramData db_get;
+  options.statistics->histogramData(DB_GET, &db_get);
+  ASSERT_EQ(2, db_get.count);
+  ASSERT_GT(cf_stats->getTickerCount(FLUSH_WRITE_BYTES), 0);
+  ASSERT_LT(cf_stats->getTickerCount(FLUSH_WRITE_BYTES),
+            options.statistics->getTickerCount(FLUSH_WRITE_BYTES));
+}
+
 TEST_F(DBStatisticsTest, BytesWrittenStats) {
   Options options = CurrentOptions();
   options.statistics = ROCKSDB_NAMESPACE::CreateDBStatistics();
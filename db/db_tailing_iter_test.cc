@@ -701,6 +701,65 @@ TEST_P(DBTestTailingIterator, SeekToFirstWithUpperBoundBug) {
   ASSERT_EQ(iter->key().ToString(), "aa");
 }
 
+TEST_P(DBTestTailingIterator, TailingIteratorNextAcrossFlush) {
+  Options options = CurrentOptions();
+  options.disable_auto_compactions = true;
+  DestroyAndReopen(options);
+  ReadOptions read_options;
+  read_options.tailing = true;
+  if (GetParam()) {
+    read_options.async_io = true;
+  }
+
+  // Even keys in L1, odd keys in L0 and two more keys in the memtable
+  std::set<std::string> expected_keys;
+  for (int i = 0; i < 100; i += 2) {
+    ASSERT_OK(Put(Key(i), "v"));
+    expected_keys.insert(Key(i));
+  }
+  ASSERT_OK(Flush());
+  MoveFilesToLevel(1);
+  for (int i = 1; i < 50; i += 2) {
+    ASSERT_OK(Put(Key(i), "v"));
+    expected_keys.insert(Key(i));
+  }
+  ASSERT_OK(Flush());
+  ASSERT_OK(Put(Key(30), "v"));
+  ASSERT_OK(Put(Key(150), "v"));
+  expected_keys.insert(Key(150));
+
+  int l0_iters_kept = 0;
+  int level_iters_kept = 0;
+  SyncPoint::GetInstance()->SetCallBack(
+      "ForwardIterator::RenewIterators:Copy",
+      [&](void* /*arg*/) { ++l0_iters_kept; });
+  SyncPoint::GetInstance()->SetCallBack(
+      "ForwardIterator::RenewIterators:KeepLevel",
+      [&](void* /*arg*/) { ++level_iters_kept; });
+  SyncPoint::GetInstance()->EnableProcessing();
+
+  std::unique_ptr<Iterator> iter(db_->NewIterator(read_options));
+  std::vector<std::string> keys;
+  for (iter->SeekToFirst(); iter->Valid(); iter->Next()) {
+    keys.push_back(iter->key().ToString());
+    if (keys.size() % 20 == 0) {
+      // Switches the memtable and adds an L0 file under the iterator
+      ASSERT_OK(Put(Key(200 + static_cast<int>(keys.size())), "v"));
+      expected_keys.insert(Key(200 + static_cast<int>(keys.size())));
+      ASSERT_OK(Flush());
+    }
+  }
+  ASSERT_OK(iter->status());
+  SyncPoint::GetInstance()->DisableProcessing();
+  SyncPoint::GetInstance()->ClearAllCallBacks();
+
+  ASSERT_EQ(std::vector<std::string>(expected_keys.begin(),
+                                     expected_keys.end()),
+            keys);
+  ASSERT_GT(l0_iters_kept, 0);
+  ASSERT_GT(level_iters_kept, 0);
+}
+
 }  // namespace ROCKSDB_NAMESPACE
 
 
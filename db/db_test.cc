@@ -1811,6 +1811,62 @@ TEST_F(DBTest, ApproximateSizesFilesWithErrorMargin) {
   }
 }
 
+TEST_F(DBTest, ApproximateSizesBatch) {
+  Options options = CurrentOptions();
+  options.write_buffer_size = 24 * 1024;
+  options.compression = kNoCompression;
+  options.create_if_missing = true;
+  options.target_file_size_base = 24 * 1024;
+  DestroyAndReopen(options);
+  const auto default_cf = db_->DefaultColumnFamily();
+
+  const int N = 16000;
+  Random rnd(301);
+  for (int i = 0; i < N; i++) {
+    ASSERT_OK(Put(Key(i), rnd.RandomString(24)));
+  }
+  ASSERT_OK(Flush());
+  ASSERT_OK(
+      db_->CompactRange(CompactRangeOptions(), default_cf, nullptr, nullptr));
+  ASSERT_GT(NumTableFilesAtLevel(1), 1);
+  for (int i = 0; i < N; i += 4) {
+    ASSERT_OK(Put(Key(i), rnd.RandomString(24)));
+  }
+  ASSERT_OK(Flush());
+
+  // Adjacent ranges sharing their endpoints, in shuffled order, and
+  // overlapping ones
+  std::vector<std::string> keys;
+  for (int i = 0; i <= N; i += 500) {
+    keys.push_back(Key(i));
+  }
+  std::vector<Range> ranges;
+  for (size_t i = 0; i + 1 < keys.size(); i++) {
+    ranges.emplace_back(keys[i], keys[i + 1]);
+  }
+  for (size_t i = 0; i + 4 < keys.size(); i += 3) {
+    ranges.emplace_back(keys[i], keys[i + 4]);
+  }
+  RandomShuffle(ranges.begin(), ranges.end(), 301);
+
+  SizeApproximationOptions size_approx_options;
+  size_approx_options.include_memtables = false;
+  size_approx_options.include_files = true;
+  std::vector<uint64_t> sizes(ranges.size());
+  ASSERT_OK(db_->GetApproximateSizes(size_approx_options, default_cf,
+                                     ranges.data(),
+                                     static_cast<int>(ranges.size()),
+                                     sizes.data()));
+  // Same as estimating each range separately
+  for (size_t i = 0; i < ranges.size(); i++) {
+    uint64_t size;
+    ASSERT_OK(db_->GetApproximateSizes(size_approx_options, default_cf,
+                                       &ranges[i], 1, &size));
+    ASSERT_EQ(size, sizes[i]);
+    ASSERT_GT(size, 0);
+  }
+}
+
 TEST_F(DBTest, GetApproximateMemTableStats) {
   Options options = CurrentOptions();
   options.write_buffer_size = 100000000;
@@ -7115,6 +7171,80 @@ TEST_F(DBTest, RowCache) {
   ASSERT_EQ(TestGetTickerCount(options, ROW_CACHE_MISS), 2);
 }
 
+TEST_F(DBTest, HyperClockRowCache) {
+  Options options = CurrentOptions();
+  options.statistics = ROCKSDB_NAMESPACE::CreateDBStatistics();
+  HyperClockCacheOptions cache_options(1 << 20,
+                                       /*estimated_entry_charge=*/0);
+  options.row_cache = cache_options.MakeSharedRowCache();
+  ASSERT_NE(options.row_cache, nullptr);
+  DestroyAndReopen(options);
+
+  ASSERT_OK(Put("foo", "bar"));
+  ASSERT_OK(Put("foo2", "bar2"));
+  WideColumns columns{{kDefaultWideColumnName, "baz"}, {"col", "val"}};
+  ASSERT_OK(db_->PutEntity(WriteOptions(), db_->DefaultColumnFamily(),
+                           "entity", columns));
+  ASSERT_OK(Flush());
+
+  ASSERT_EQ(Get("foo"), "bar");
+  ASSERT_EQ(TestGetTickerCount(options, ROW_CACHE_MISS), 1);
+  ASSERT_EQ(Get("foo"), "bar");
+  ASSERT_EQ(TestGetTickerCount(options, ROW_CACHE_HIT), 1);
+
+  // Batched lookups share the rows with Get
+  ASSERT_EQ(MultiGet({"foo", "foo2"}),
+            std::vector<std::string>({"bar", "bar2"}));
+  ASSERT_EQ(TestGetTickerCount(options, ROW_CACHE_HIT), 2);
+  ASSERT_EQ(TestGetTickerCount(options, ROW_CACHE_MISS), 2);
+  ASSERT_EQ(MultiGet({"foo", "foo2"}),
+            std::vector<std::string>({"bar", "bar2"}));
+  ASSERT_EQ(TestGetTickerCount(options, ROW_CACHE_HIT), 4);
+  ASSERT_EQ(Get("foo2"), "bar2");
+  ASSERT_EQ(TestGetTickerCount(options, ROW_CACHE_HIT), 5);
+
+  // And so do entities
+  for (int i = 0; i < 2; i++) {
+    PinnableWideColumns result;
+    ASSERT_OK(db_->GetEntity(ReadOptions(), db_->DefaultColumnFamily(),
+                             "entity", &result));
+    ASSERT_EQ(result.columns(), columns);
+  }
+  ASSERT_EQ(TestGetTickerCount(options, ROW_CACHE_HIT), 6);
+  ASSERT_EQ(TestGetTickerCount(options, ROW_CACHE_MISS), 3);
+  ASSERT_EQ(Get("entity"), "baz");
+  ASSERT_EQ(TestGetTickerCount(options, ROW_CACHE_HIT), 7);
+}
+
+TEST_F(DBTest, RowCacheWithRangeDeletion) {
+  Options options = CurrentOptions();
+  options.statistics = ROCKSDB_NAMESPACE::CreateDBStatistics();
+  options.row_cache = NewLRUCache(8192);
+  DestroyAndReopen(options);
+
+  ASSERT_OK(Put("a", "va"));
+  ASSERT_OK(Put("b", "vb"));
+  ASSERT_OK(Put("c", "vc"));
+  // Keeps the covered keys in the file
+  const Snapshot* snapshot = db_->GetSnapshot();
+  ASSERT_OK(db_->DeleteRange(WriteOptions(), db_->DefaultColumnFamily(), "a",
+                             "c"));
+  ASSERT_OK(Flush());
+
+  // Rows covered by a tombstone of the same file are not cached
+  for (int i = 0; i < 2; i++) {
+    ASSERT_EQ(Get("a"), "NOT_FOUND");
+    ASSERT_EQ(MultiGet({"b", "c"}),
+              std::vector<std::string>({"NOT_FOUND", "vc"}));
+  }
+  ASSERT_EQ(TestGetTickerCount(options, ROW_CACHE_HIT), 1);
+  ASSERT_EQ(TestGetTickerCount(options, ROW_CACHE_MISS), 5);
+  ASSERT_EQ(Get("a", snapshot), "va");
+  ASSERT_EQ(Get("a", snapshot), "va");
+  ASSERT_EQ(TestGetTickerCount(options, ROW_CACHE_HIT), 2);
+  db_->ReleaseSnapshot(snapshot);
+}
+
 TEST_F(DBTest, PinnableSliceAndRowCache) {
   Options options = CurrentOptions();
   options.statistics = ROCKSDB_NAMESPACE::CreateDBStatistics();
@@ -18,6 +18,7 @@
 #include "options/options_helper.h"
 #include "port/port.h"
 #include "port/stack_trace.h"
+#include "rocksdb/compression_accelerator.h"
 #include "rocksdb/experimental.h"
 #include "rocksdb/iostats_context.h"
 #include "rocksdb/persistent_cache.h"
@@ -1414,6 +1415,96 @@ TEST_F(DBTest2, PresetCompressionDictLocality) {
   }
 }
 
+TEST_F(DBTest2, TrainCompressionDictInBackground) {
+  // Verifies that with `train_dict_in_background`, the files after the first
+  // one use the latest dictionary instead of training their own, starting with
+  // the first file's one, and then the one trained in the background.
+  const auto dict_compressions = GetSupportedDictCompressions();
+  if (dict_compressions.empty()) {
+    ROCKSDB_GTEST_SKIP("Test requires a dictionary compression");
+    return;
+  }
+  const int kNumEntriesPerFile = 256;
+  const int kNumBytesPerEntry = 256;
+  Options options = CurrentOptions();
+  options.compression = dict_compressions[0];
+  options.compression_opts.max_dict_bytes = 4 << 10;
+  options.compression_opts.train_dict_in_background = true;
+  options.disable_auto_compactions = true;
+  Reopen(options);
+
+  std::vector<std::string> file_dicts;
+  int num_shared_dict_files = 0;
+  std::mutex trained_mutex;
+  std::vector<std::string> trained_dicts;
+  SyncPoint::GetInstance()->SetCallBack(
+      "BlockBasedTableBuilder::WriteCompressionDictBlock:RawDict",
+      [&](void* arg) {
+        file_dicts.emplace_back(static_cast<Slice*>(arg)->ToString());
+      });
+  SyncPoint::GetInstance()->SetCallBack(
+      "BlockBasedTableBuilder::Rep:SharedDict", [&](void* arg) {
+        if (*static_cast<std::shared_ptr<const std::string>*>(arg)) {
+          num_shared_dict_files++;
+        }
+      });
+  SyncPoint::GetInstance()->SetCallBack(
+      "CompressionDictManager::Train:Dict", [&](void* arg) {
+        std::lock_guard<std::mutex> lk(trained_mutex);
+        trained_dicts.push_back(*static_cast<std::string*>(arg));
+      });
+  SyncPoint::GetInstance()->EnableProcessing();
+
+  Random rnd(301);
+  int num_files = 0;
+  auto write_file = [&]() {
+    for (int j = 0; j < kNumEntriesPerFile; ++j) {
+      ASSERT_OK(Put(Key(num_files * kNumEntriesPerFile + j),
+                    rnd.RandomString(kNumBytesPerEntry)));
+    }
+    ASSERT_OK(Flush());
+    num_files++;
+  };
+
+  // The first file trains its dictionary, which the next one reuses.
+  write_file();
+  ASSERT_EQ(num_shared_dict_files, 0);
+  write_file();
+  ASSERT_EQ(num_shared_dict_files, 1);
+  ASSERT_EQ(file_dicts.size(), 2);
+  ASSERT_EQ(file_dicts[1], file_dicts[0]);
+
+  // Their blocks are sampled until a dictionary can be trained.
+  std::string trained_dict;
+  for (int i = 0; i < 1000 && trained_dict.empty(); ++i) {
+    {
+      std::lock_guard<std::mutex> lk(trained_mutex);
+      if (!trained_dicts.empty()) {
+        trained_dict = trained_dicts.back();
+      }
+    }
+    if (trained_dict.empty()) {
+      if (i % 100 == 0) {
+        write_file();
+      }
+      env_->SleepForMicroseconds(10000);
+    }
+  }
+  ASSERT_FALSE(trained_dict.empty());
+  ASSERT_NE(trained_dict, file_dicts[0]);
+  write_file();
+  ASSERT_EQ(num_shared_dict_files, num_files - 1);
+  ASSERT_EQ(file_dicts.back(), trained_dict);
+
+  SyncPoint::GetInstance()->DisableProcessing();
+  SyncPoint::GetInstance()->ClearAllCallBacks();
+  Reopen(options);
+  Random verify_rnd(301);
+  for (int i = 0; i < num_files * kNumEntriesPerFile; ++i) {
+    ASSERT_EQ(Get(Key(i)), verify_rnd.RandomString(kNumBytesPerEntry));
+  }
+}
+
 class PresetCompressionDictTest
     : public DBTestBase,
       public testing::WithParamInterface<std::tuple<CompressionType, bool>> {
@@ -1898,6 +1989,193 @@ TEST_F(DBTest2, CompressionOptions) {
   }
 }
 
+namespace {
+// Compresses the zlib blocks of the DB with the software zlib, taking one
+// request out of two and answering the others with Status::Busy()
+class AlternatingCompressionAccelerator : public CompressionAccelerator {
+ public:
+  const char* Name() const override {
+    return "AlternatingCompressionAccelerator";
+  }
+
+  bool Supports(CompressionType type) const override {
+    return type == kZlibCompression;
+  }
+
+  Status Compress(CompressionType type, const CompressionOptions& opts,
+                  const Slice& input, std::string* output) override {
+    if (compress_requests_.fetch_add(1) % 2 == 1) {
+      return Status::Busy();
+    }
+    CompressionContext context(type, opts);
+    CompressionInfo info(opts, context, CompressionDict::GetEmptyDict(), type,
+                         0 /* sample_for_compression */);
+    // Format version 1 is the stream without the header of the block
+    if (!Zlib_Compress(info, 1 /* compress_format_version */, input.data(),
+                       input.size(), output)) {
+      return Status::Corruption("Zlib_Compress failed");
+    }
+    compressed_.fetch_add(1);
+    return Status::OK();
+  }
+
+  Status Uncompress(CompressionType type, const Slice& input, char* output,
+                    size_t output_size) override {
+    if (uncompress_requests_.fetch_add(1) % 2 == 1) {
+      return Status::Busy();
+    }
+    UncompressionContext context(type);
+    UncompressionInfo info(context, UncompressionDict::GetEmptyDict(), type);
+    size_t uncompressed_size = 0;
+    CacheAllocationPtr uncompressed =
+        Zlib_Uncompress(info, input.data(), input.size(), &uncompressed_size,
+                        1 /* compress_format_version */);
+    if (!uncompressed || uncompressed_size != output_size) {
+      return Status::Corruption("Zlib_Uncompress failed");
+    }
+    memcpy(output, uncompressed.get(), output_size);
+    uncompressed_.fetch_add(1);
+    return Status::OK();
+  }
+
+  std::atomic<uint64_t> compress_requests_{0};
+  std::atomic<uint64_t> compressed_{0};
+  std::atomic<uint64_t> uncompress_requests_{0};
+  std::atomic<uint64_t> uncompressed_{0};
+};
+}  // anonymous namespace
+
+TEST_F(DBTest2, CompressionAccelerator) {
+  if (!Zlib_Supported()) {
+    ROCKSDB_GTEST_SKIP("Test requires zlib");
+    return;
+  }
+
+  const int kNumKeys = 2000;
+  for (uint32_t num_threads : {1, 4}) {
+    auto accelerator = std::make_shared<AlternatingCompressionAccelerator>();
+    Options options = CurrentOptions();
+    options.compression = kZlibCompression;
+    options.compression_opts.parallel_threads = num_threads;
+    options.compression_accelerator = accelerator;
+    options.statistics = CreateDBStatistics();
+    BlockBasedTableOptions table_options;
+    table_options.block_size = 256;
+    table_options.no_block_cache = true;
+    options.table_factory.reset(NewBlockBasedTableFactory(table_options));
+    DestroyAndReopen(options);
+
+    Random rnd(301);
+    std::vector<std::string> values;
+    for (int i = 0; i < kNumKeys; i++) {
+      values.push_back(rnd.RandomString(10) + std::string(100, 'v'));
+      ASSERT_OK(Put(Key(i), values[i]));
+    }
+    ASSERT_OK(Flush());
+    // Some blocks were compressed by the accelerator, the others in
+    // software, all of them being compressed
+    ASSERT_GT(accelerator->compressed_.load(), 0);
+    ASSERT_LT(accelerator->compressed_.load(),
+              accelerator->compress_requests_.load());
+    ASSERT_GT(options.statistics->getTickerCount(NUMBER_BLOCK_COMPRESSED),
+              accelerator->compressed_.load());
+
+    for (int i = 0; i < kNumKeys; i++) {
+      ASSERT_EQ(values[i], Get(Key(i)));
+    }
+    ASSERT_GT(accelerator->uncompressed_.load(), 0);
+    ASSERT_LT(accelerator->uncompressed_.load(),
+              accelerator->uncompress_requests_.load());
+
+    // The blocks of the accelerator are readable by the software codec
+    options.compression_accelerator.reset();
+    Reopen(options);
+    for (int i = 0; i < kNumKeys; i++) {
+      ASSERT_EQ(values[i], Get(Key(i)));
+    }
+  }
+}
+
+TEST_F(DBTest2, AdaptiveBlockCompression) {
+  if (!Zlib_Supported()) {
+    ROCKSDB_GTEST_SKIP("Test requires zlib");
+    return;
+  }
+
+  std::atomic<int> num_uncompressed{0};
+  std::atomic<int> num_zlib{0};
+  SyncPoint::GetInstance()->SetCallBack(
+      "BlockBasedTableBuilder::CompressAndVerifyBlock:AdaptiveType",
+      [&](void* arg) {
+        CompressionType type = *static_cast<CompressionType*>(arg);
+        if (type == kNoCompression) {
+          num_uncompressed.fetch_add(1);
+        } else if (type == kZlibCompression) {
+          num_zlib.fetch_add(1);
+        }
+      });
+  SyncPoint::GetInstance()->EnableProcessing();
+
+  const int kNumKeys = 1000;
+  Random rnd(301);
+  for (uint32_t num_threads : {1, 4}) {
+    Options options = CurrentOptions();
+    options.compression = kZlibCompression;
+    options.compression_opts.parallel_threads = num_threads;
+    options.compression_opts.adaptive_cpu_cost_per_kb = 1;
+    options.statistics = CreateDBStatistics();
+    BlockBasedTableOptions table_options;
+    table_options.block_size = 1024;
+    options.table_factory.reset(NewBlockBasedTableFactory(table_options));
+    DestroyAndReopen(options);
+
+    // Incompressible blocks are not even attempted
+    num_uncompressed = 0;
+    num_zlib = 0;
+    std::vector<std::string> values;
+    for (int i = 0; i < kNumKeys; i++) {
+      values.push_back(rnd.RandomBinaryString(200));
+      ASSERT_OK(Put(Key(i), values[i]));
+    }
+    ASSERT_OK(Flush());
+    ASSERT_GT(num_uncompressed.load(), 0);
+    ASSERT_EQ(0, num_zlib.load());
+    ASSERT_EQ(0, options.statistics->getTickerCount(
+                     NUMBER_BLOCK_COMPRESSION_REJECTED));
+
+    // Compressible blocks get the configured compression when CPU is cheap
+    num_uncompressed = 0;
+    num_zlib = 0;
+    for (int i = 0; i < kNumKeys; i++) {
+      values[i] = rnd.RandomString(10) + std::string(190, 'v');
+      ASSERT_OK(Put(Key(i), values[i]));
+    }
+    ASSERT_OK(Flush());
+    ASSERT_GT(num_zlib.load(), 0);
+    ASSERT_EQ(0, num_uncompressed.load());
+    for (int i = 0; i < kNumKeys; i++) {
+      ASSERT_EQ(values[i], Get(Key(i)));
+    }
+
+    // And are left uncompressed when CPU is expensive
+    options.compression_opts.adaptive_cpu_cost_per_kb = 1 << 20;
+    Reopen(options);
+    num_uncompressed = 0;
+    num_zlib = 0;
+    for (int i = 0; i < kNumKeys; i++) {
+      ASSERT_OK(Put(Key(i), values[i]));
+    }
+    ASSERT_OK(Flush());
+    ASSERT_GT(num_uncompressed.load(), 0);
+    ASSERT_EQ(0, num_zlib.load());
+    for (int i = 0; i < kNumKeys; i++) {
+      ASSERT_EQ(values[i], Get(Key(i)));
+    }
+  }
+  SyncPoint::GetInstance()->DisableProcessing();
+  SyncPoint::GetInstance()->ClearAllCallBacks();
+}
+
 class CompactionStallTestListener : public EventListener {
  public:
   CompactionStallTestListener()
@@ -2034,6 +2312,49 @@ TEST_F(DBTest2, DuplicateSnapshot) {
   }
 }
 
+TEST_F(DBTest2, SharedSnapshotSeqs) {
+  Options options;
+  options = CurrentOptions(options);
+  DBImpl* dbi = static_cast_with_check<DBImpl>(db_);
+  std::shared_ptr<const std::vector<SequenceNumber>> last;
+  // Returns whether the shared snapshot numbers were rebuilt since the last
+  // call, checking that they match GetAll()
+  auto rebuilt = [&]() {
+    InstrumentedMutexLock l(dbi->mutex());
+    SequenceNumber oldest_ww_snap, shared_oldest_ww_snap;
+    auto seqs = dbi->snapshots().GetAll(&oldest_ww_snap);
+    auto shared = dbi->snapshots().GetAllShared(&shared_oldest_ww_snap);
+    EXPECT_EQ(seqs, *shared);
+    EXPECT_EQ(oldest_ww_snap, shared_oldest_ww_snap);
+    bool ret = shared != last;
+    last = shared;
+    return ret;
+  };
+
+  ASSERT_TRUE(rebuilt());
+  ASSERT_FALSE(rebuilt());
+  ASSERT_OK(Put("k", "v"));  // inc seq
+  const Snapshot* s1 = db_->GetSnapshot();
+  ASSERT_TRUE(rebuilt());
+  const Snapshot* s2 = db_->GetSnapshot();
+  // Taking or releasing a duplicate snapshot keeps the shared numbers
+  ASSERT_FALSE(rebuilt());
+  const Snapshot* s3 = dbi->GetSnapshotForWriteConflictBoundary();
+  ASSERT_TRUE(rebuilt());
+  db_->ReleaseSnapshot(s1);
+  ASSERT_FALSE(rebuilt());
+  ASSERT_OK(Put("k", "v"));  // inc seq
+  const Snapshot* s4 = db_->GetSnapshot();
+  ASSERT_TRUE(rebuilt());
+  db_->ReleaseSnapshot(s3);
+  ASSERT_TRUE(rebuilt());
+  db_->ReleaseSnapshot(s2);
+  ASSERT_TRUE(rebuilt());
+  db_->ReleaseSnapshot(s4);
+  ASSERT_TRUE(rebuilt());
+  ASSERT_TRUE(last->empty());
+}
+
 class PinL0IndexAndFilterBlocksTest
     : public DBTestBase,
       public testing::WithParamInterface<std::tuple<bool, bool>> {
@@ -2368,6 +2368,90 @@ TEST_F(DBTestUniversalCompaction2, PeriodicCompactionOffpeak) {
   }
 }
 
+TEST_F(DBTestUniversalCompaction2, IncrementalRoundRobin) {
+  const int kNumKeys = 1000;
+  const uint64_t kFileSize = 8 << 10;
+
+  Options opts = CurrentOptions();
+  opts.compaction_style = kCompactionStyleUniversal;
+  opts.num_levels = 3;
+  opts.level0_file_num_compaction_trigger = 2;
+  opts.compression = kNoCompression;
+  opts.target_file_size_base = kFileSize;
+  opts.max_compaction_bytes = 8 * kFileSize;
+  opts.disable_auto_compactions = true;
+  opts.compaction_options_universal.incremental = true;
+  opts.compaction_options_universal.incremental_round_robin = true;
+  opts.compaction_options_universal.max_size_amplification_percent = 1;
+  Reopen(opts);
+
+  Random rnd(301);
+  for (int i = 0; i < kNumKeys; i++) {
+    ASSERT_OK(Put(Key(i), rnd.RandomString(100)));
+  }
+  ASSERT_OK(Flush());
+  ASSERT_OK(dbfull()->CompactRange(CompactRangeOptions(), nullptr, nullptr));
+  ASSERT_GT(NumTableFilesAtLevel(2), 1);
+
+  // Overwrite all the keys into many files of L1, the second last sorted run
+  for (int i = 0; i < kNumKeys; i++) {
+    ASSERT_OK(Put(Key(i), rnd.RandomString(100)));
+  }
+  ASSERT_OK(Flush());
+  ColumnFamilyMetaData cf_meta;
+  db_->GetColumnFamilyMetaData(&cf_meta);
+  ASSERT_EQ(1, cf_meta.levels[0].files.size());
+  CompactionOptions compact_options;
+  compact_options.output_file_size_limit = kFileSize;
+  ASSERT_OK(dbfull()->CompactFiles(compact_options,
+                                   {cf_meta.levels[0].files[0].name}, 1));
+  const int num_l1_files = NumTableFilesAtLevel(1);
+  ASSERT_GT(num_l1_files, 4);
+
+  // Each size amp compaction is an increment that starts at the compact
+  // cursor left by the previous one, until L1 is compacted
+  std::vector<std::string> start_keys;
+  std::vector<std::string> cursors;
+  SyncPoint::GetInstance()->SetCallBack(
+      "UniversalCompactionBuilder::PickCompaction:Return", [&](void* arg) {
+        Compaction* c = static_cast<Compaction*>(arg);
+        if (c == nullptr) {
+          return;
+        }
+        ASSERT_EQ(CompactionReason::kUniversalSizeAmplification,
+                  c->compaction_reason());
+        ASSERT_EQ(1, c->start_level());
+        ASSERT_EQ(2, c->output_level());
+        start_keys.push_back(c->input(0, 0)->smallest.user_key().ToString());
+        // Picked from the current version, under the DB mutex
+        const InternalKey& cursor = dbfull()
+                                        ->GetVersionSet()
+                                        ->GetColumnFamilySet()
+                                        ->GetDefault()
+                                        ->current()
+                                        ->storage_info()
+                                        ->GetCompactCursors()[1];
+        cursors.push_back(cursor.Valid() ? cursor.user_key().ToString() : "");
+      });
+  SyncPoint::GetInstance()->EnableProcessing();
+
+  ASSERT_OK(dbfull()->SetOptions({{"disable_auto_compactions", "false"}}));
+  ASSERT_OK(dbfull()->TEST_WaitForCompact());
+
+  SyncPoint::GetInstance()->DisableProcessing();
+  SyncPoint::GetInstance()->ClearAllCallBacks();
+
+  ASSERT_EQ(0, NumTableFilesAtLevel(1));
+  ASSERT_GT(start_keys.size(), 2U);
+  ASSERT_LE(start_keys.size(), static_cast<size_t>(num_l1_files));
+  ASSERT_EQ(Key(0), start_keys[0]);
+  ASSERT_EQ("", cursors[0]);
+  for (size_t i = 1; i < start_keys.size(); i++) {
+    ASSERT_LT(start_keys[i - 1], start_keys[i]);
+    ASSERT_EQ(start_keys[i], cursors[i]);
+  }
+}
+
 }  // namespace ROCKSDB_NAMESPACE
 
 
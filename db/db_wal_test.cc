@@ -1316,6 +1316,97 @@ TEST_F(DBWALTest, RecoverWithLargeLog) {
   } while (ChangeWalOptions());
 }
 
+TEST_F(DBWALTest, RecoverWithParallelInserts) {
+  Options options = CurrentOptions();
+  options.avoid_flush_during_shutdown = true;
+  CreateAndReopenWithCF({"pikachu"}, options);
+  constexpr int kNumKeys = 2000;
+  for (int i = 0; i < kNumKeys; i++) {
+    ASSERT_OK(Put(0, Key(i), "old" + std::to_string(i)));
+    ASSERT_OK(Put(1, Key(i), std::string(100, 'a' + i % 26)));
+  }
+  for (int i = 0; i < kNumKeys; i += 2) {
+    WriteBatch batch;
+    ASSERT_OK(batch.Put(handles_[0], Key(i), "new" + std::to_string(i)));
+    ASSERT_OK(batch.Delete(handles_[1], Key(i)));
+    ASSERT_OK(dbfull()->Write(WriteOptions(), &batch));
+  }
+  ASSERT_EQ(0, NumTableFilesAtLevel(0, 1));
+
+  // Flushes in the middle of the WAL, while inserts are in flight
+  options.write_buffer_size = 64 << 10;
+  options.wal_recovery_threads = 4;
+  ASSERT_TRUE(options.allow_concurrent_memtable_write);
+  ReopenWithColumnFamilies({"default", "pikachu"}, options);
+  ASSERT_GT(NumTableFilesAtLevel(0, 1), 1);
+  for (int i = 0; i < kNumKeys; i++) {
+    if (i % 2 == 0) {
+      ASSERT_EQ("new" + std::to_string(i), Get(0, Key(i)));
+      ASSERT_EQ("NOT_FOUND", Get(1, Key(i)));
+    } else {
+      ASSERT_EQ("old" + std::to_string(i), Get(0, Key(i)));
+      ASSERT_EQ(std::string(100, 'a' + i % 26), Get(1, Key(i)));
+    }
+  }
+  ASSERT_EQ(static_cast<SequenceNumber>(kNumKeys * 3),
+            dbfull()->GetLatestSequenceNumber());
+}
+
+TEST_F(DBWALTest, RecoverFromMemTableSnapshot) {
+  Options options = CurrentOptions();
+  options.avoid_flush_during_shutdown = true;
+  options.snapshot_memtables_on_shutdown = true;
+  CreateAndReopenWithCF({"pikachu"}, options);
+  for (int i = 0; i < 100; i++) {
+    ASSERT_OK(Put(0, Key(i), "v1_" + std::to_string(i)));
+    ASSERT_OK(Put(1, Key(i), "v1_" + std::to_string(i)));
+  }
+  for (int i = 0; i < 100; i += 3) {
+    ASSERT_OK(Put(0, Key(i), "v2_" + std::to_string(i)));
+  }
+  ASSERT_OK(db_->DeleteRange(WriteOptions(), handles_[1], Key(10), Key(20)));
+  ASSERT_OK(Delete(1, Key(50)));
+  const SequenceNumber last_sequence = dbfull()->GetLatestSequenceNumber();
+
+  bool loaded = false;
+  SyncPoint::GetInstance()->SetCallBack(
+      "DBImpl::MaybeLoadMemTableSnapshot:Loaded",
+      [&](void* arg) { loaded = *static_cast<bool*>(arg); });
+  SyncPoint::GetInstance()->EnableProcessing();
+  ReopenWithColumnFamilies({"default", "pikachu"}, options);
+  ASSERT_TRUE(loaded);
+  ASSERT_TRUE(env_->FileExists(MemTableSnapshotFileName(dbname_)).IsNotFound());
+  ASSERT_EQ(last_sequence, dbfull()->GetLatestSequenceNumber());
+  auto check = [&]() {
+    for (int i = 0; i < 100; i++) {
+      ASSERT_EQ((i % 3 == 0 ? "v2_" : "v1_") + std::to_string(i),
+                Get(0, Key(i)));
+      if ((i >= 10 && i < 20) || i == 50) {
+        ASSERT_EQ("NOT_FOUND", Get(1, Key(i)));
+      } else {
+        ASSERT_EQ("v1_" + std::to_string(i), Get(1, Key(i)));
+      }
+    }
+  };
+  check();
+
+  // A truncated snapshot is ignored, and the WALs replayed
+  ASSERT_OK(Put(0, Key(0), "v2_0"));
+  Close();
+  const std::string fname = MemTableSnapshotFileName(dbname_);
+  std::string contents;
+  ASSERT_OK(ReadFileToString(env_, fname, &contents));
+  ASSERT_OK(WriteStringToFile(env_, contents.substr(0, contents.size() / 2),
+                              fname));
+  loaded = true;
+  ReopenWithColumnFamilies({"default", "pikachu"}, options);
+  ASSERT_FALSE(loaded);
+  check();
+
+  SyncPoint::GetInstance()->DisableProcessing();
+  SyncPoint::GetInstance()->ClearAllCallBacks();
+}
+
 // In https://reviews.facebook.net/D20661 we change
 // recovery behavior: previously for each log file each column family
 // memtable was flushed, even it was empty. Now it's changed:
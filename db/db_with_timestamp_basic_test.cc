@@ -477,6 +477,73 @@ TEST_F(DBBasicTestWithTimestamp, GetApproximateSizes) {
   Close();
 }
 
+TEST_F(DBBasicTestWithTimestamp, WriteAsync) {
+  Options options = CurrentOptions();
+  options.env = env_;
+  options.create_if_missing = true;
+  const size_t kTimestampSize = Timestamp(0, 0).size();
+  TestComparator test_cmp(kTimestampSize);
+  options.comparator = &test_cmp;
+  DestroyAndReopen(options);
+
+  // The first callback holds the thread of the async writes, so that the
+  // others queue up behind it. The batch whose timestamps are not set must
+  // fail alone rather than be merged with the others.
+  const std::string write_ts = Timestamp(1, 0);
+  const int kWrites = 4;
+  const int kNoTsWrite = 2;
+  std::mutex mu;
+  std::condition_variable cv;
+  bool released = false;
+  int num_done = 0;
+  std::vector<WriteBatch> batches;
+  std::vector<Status> statuses(kWrites);
+  for (int i = 0; i < kWrites; i++) {
+    batches.emplace_back(0, 0, 0, kTimestampSize);
+    const std::string value = "value" + std::to_string(i);
+    if (i == kNoTsWrite) {
+      ASSERT_OK(batches[i].Put(db_->DefaultColumnFamily(), Key1(i), value));
+    } else {
+      ASSERT_OK(batches[i].Put(db_->DefaultColumnFamily(), Key1(i), write_ts,
+                               value));
+    }
+  }
+  for (int i = 0; i < kWrites; i++) {
+    db_->WriteAsync(WriteOptions(), &batches[i], [&, i](const Status& s) {
+      std::unique_lock<std::mutex> lock(mu);
+      if (i == 0) {
+        cv.wait(lock, [&] { return released; });
+      }
+      statuses[i] = s;
+      num_done++;
+      cv.notify_all();
+    });
+  }
+  {
+    std::unique_lock<std::mutex> lock(mu);
+    released = true;
+    cv.notify_all();
+    cv.wait(lock, [&] { return num_done == kWrites; });
+  }
+
+  ReadOptions read_opts;
+  Slice read_ts = write_ts;
+  read_opts.timestamp = &read_ts;
+  for (int i = 0; i < kWrites; i++) {
+    std::string value;
+    Status s = db_->Get(read_opts, Key1(i), &value);
+    if (i == kNoTsWrite) {
+      ASSERT_TRUE(statuses[i].IsInvalidArgument());
+      ASSERT_TRUE(s.IsNotFound());
+    } else {
+      ASSERT_OK(statuses[i]);
+      ASSERT_OK(s);
+      ASSERT_EQ("value" + std::to_string(i), value);
+    }
+  }
+  Close();
+}
+
 TEST_F(DBBasicTestWithTimestamp, SimpleIterate) {
   const int kNumKeysPerFile = 128;
   const uint64_t kMaxKey = 1024;
@@ -4518,6 +4585,52 @@ TEST_F(DBBasicTestWithTimestamp, MergeBasic) {
   Close();
 }
 
+TEST_F(DBBasicTestWithTimestamp, MergeResultCacheNotUsed) {
+  Options options = GetDefaultOptions();
+  options.create_if_missing = true;
+  const size_t kTimestampSize = Timestamp(0, 0).size();
+  TestComparator test_cmp(kTimestampSize);
+  options.comparator = &test_cmp;
+  options.merge_operator = std::make_shared<StringAppendTESTOperator>('.');
+  options.merge_result_cache = NewLRUCache(1 << 20);
+  DestroyAndReopen(options);
+
+  int hits = 0;
+  SyncPoint::GetInstance()->SetCallBack(
+      "DBImpl::GetImpl:MergeResultCacheHit", [&](void*) { ++hits; });
+  SyncPoint::GetInstance()->EnableProcessing();
+
+  ColumnFamilyHandle* default_cf = db_->DefaultColumnFamily();
+  ASSERT_OK(db_->Put(WriteOptions(), "key", Timestamp(100, 0), "v"));
+  ASSERT_OK(db_->Merge(WriteOptions(), default_cf, "key", Timestamp(200, 0),
+                       "1"));
+  ASSERT_OK(db_->Merge(WriteOptions(), default_cf, "key", Timestamp(300, 0),
+                       "2"));
+
+  // Reading the newest result first must not make older timestamps see it
+  for (int i = 0; i < 2; ++i) {
+    for (const auto& read_ts_and_value :
+         std::vector<std::pair<std::string, std::string>>{
+             {Timestamp(350, 0), "v.1.2"},
+             {Timestamp(250, 0), "v.1"},
+             {Timestamp(150, 0), "v"}}) {
+      ReadOptions read_opts;
+      Slice read_ts = read_ts_and_value.first;
+      read_opts.timestamp = &read_ts;
+      std::string value;
+      std::string ts;
+      ASSERT_OK(db_->Get(read_opts, "key", &value, &ts));
+      ASSERT_EQ(read_ts_and_value.second, value);
+    }
+    ASSERT_OK(Flush());
+  }
+  ASSERT_EQ(0, hits);
+
+  SyncPoint::GetInstance()->DisableProcessing();
+  SyncPoint::GetInstance()->ClearAllCallBacks();
+  Close();
+}
+
 TEST_F(DBBasicTestWithTimestamp, MergeAfterDeletion) {
   Options options = GetDefaultOptions();
   options.create_if_missing = true;
@@ -4730,6 +4843,96 @@ TEST_F(DBBasicTestWithTimestamp, TimestampFilterTableReadOnGet) {
   Close();
 }
 
+TEST_F(DBBasicTestWithTimestamp, TimestampFilterTableReadOnMultiGetAndIter) {
+  Options options = CurrentOptions();
+  options.env = env_;
+  options.create_if_missing = true;
+  options.statistics = ROCKSDB_NAMESPACE::CreateDBStatistics();
+  const size_t kTimestampSize = Timestamp(0, 0).size();
+  TestComparator test_cmp(kTimestampSize);
+  options.comparator = &test_cmp;
+  BlockBasedTableOptions bbto;
+  bbto.block_size = 100;
+  options.table_factory.reset(NewBlockBasedTableFactory(bbto));
+  DestroyAndReopen(options);
+
+  // Create two SST files
+  // file1: key => [1, 3], timestamp => [10, 20]
+  // file2, key => [2, 4], timestamp => [30, 40]
+  {
+    WriteOptions write_opts;
+    ASSERT_OK(db_->Put(write_opts, Key1(1), Timestamp(10, 0), "value1"));
+    ASSERT_OK(db_->Put(write_opts, Key1(3), Timestamp(20, 0), "value3"));
+    ASSERT_OK(Flush());
+    ASSERT_OK(db_->Put(write_opts, Key1(2), Timestamp(30, 0), "value2"));
+    ASSERT_OK(db_->Put(write_opts, Key1(4), Timestamp(40, 0), "value4"));
+    ASSERT_OK(Flush());
+  }
+
+  std::string read_ts_str = Timestamp(25, 0);
+  Slice read_ts_slice = Slice(read_ts_str);
+  ReadOptions read_opts;
+  read_opts.timestamp = &read_ts_slice;
+
+  // MultiGet with timestamp
+  {
+    auto prev_checked_events = options.statistics->getTickerCount(
+        Tickers::TIMESTAMP_FILTER_TABLE_CHECKED);
+    auto prev_filtered_events = options.statistics->getTickerCount(
+        Tickers::TIMESTAMP_FILTER_TABLE_FILTERED);
+
+    std::vector<std::string> key_strs = {Key1(1), Key1(3)};
+    std::vector<Slice> keys = {key_strs[0], key_strs[1]};
+    std::vector<PinnableSlice> values(keys.size());
+    std::vector<std::string> timestamps(keys.size());
+    std::vector<Status> statuses(keys.size());
+    db_->MultiGet(read_opts, db_->DefaultColumnFamily(), keys.size(),
+                  keys.data(), values.data(), timestamps.data(),
+                  statuses.data());
+    ASSERT_OK(statuses[0]);
+    ASSERT_EQ("value1", values[0]);
+    ASSERT_EQ(Timestamp(10, 0), timestamps[0]);
+    ASSERT_OK(statuses[1]);
+    ASSERT_EQ("value3", values[1]);
+    ASSERT_EQ(Timestamp(20, 0), timestamps[1]);
+
+    // Only key=3 is in the key range of file2, which was skipped because
+    // 25 < [30,40]
+    ASSERT_EQ(prev_checked_events + 2,
+              options.statistics->getTickerCount(
+                  Tickers::TIMESTAMP_FILTER_TABLE_CHECKED));
+    ASSERT_EQ(prev_filtered_events + 1,
+              options.statistics->getTickerCount(
+                  Tickers::TIMESTAMP_FILTER_TABLE_FILTERED));
+  }
+
+  // Iterator with timestamp
+  {
+    auto prev_filtered_events = options.statistics->getTickerCount(
+        Tickers::TIMESTAMP_FILTER_TABLE_FILTERED);
+
+    std::unique_ptr<Iterator> iter(db_->NewIterator(read_opts));
+    iter->SeekToFirst();
+    ASSERT_TRUE(iter->Valid());
+    ASSERT_EQ(Key1(1), iter->key());
+    ASSERT_EQ("value1", iter->value());
+    iter->Next();
+    ASSERT_TRUE(iter->Valid());
+    ASSERT_EQ(Key1(3), iter->key());
+    ASSERT_EQ("value3", iter->value());
+    iter->Next();
+    ASSERT_FALSE(iter->Valid());
+    ASSERT_OK(iter->status());
+
+    // file2 was skipped
+    ASSERT_EQ(prev_filtered_events + 1,
+              options.statistics->getTickerCount(
+                  Tickers::TIMESTAMP_FILTER_TABLE_FILTERED));
+  }
+
+  Close();
+}
+
 }  // namespace ROCKSDB_NAMESPACE
 
 int main(int argc, char** argv) {
@@ -4,9 +4,12 @@
 //  (found in the LICENSE.Apache file in the root directory).
 
 #include <atomic>
+#include <condition_variable>
 #include <cstdint>
 #include <fstream>
+#include <future>
 #include <memory>
+#include <mutex>
 #include <thread>
 #include <vector>
 
@@ -821,6 +824,112 @@ TEST_P(DBWriteTest, ConcurrentlyDisabledWAL) {
   ASSERT_LE(bytes_num, 1024 * 100);
 }
 
+TEST_P(DBWriteTest, ConcurrentSortedBatches) {
+  Options options = GetOptions();
+  options.allow_concurrent_memtable_write = true;
+  Reopen(options);
+  // The keys of the threads interleave, so that the sorted runs of their
+  // batches are inserted side by side. Every other batch ends with keys in
+  // descending order, which break the run.
+  const int kThreads = 8;
+  const int kBatches = 20;
+  const int kKeysPerBatch = 100;
+  std::vector<port::Thread> threads;
+  for (int t = 0; t < kThreads; t++) {
+    threads.emplace_back([&, t]() {
+      for (int b = 0; b < kBatches; b++) {
+        WriteBatch batch;
+        for (int i = 0; i < kKeysPerBatch; i++) {
+          int k = i;
+          if (b % 2 == 1 && i >= kKeysPerBatch / 2) {
+            k = kKeysPerBatch * 3 / 2 - 1 - i;
+          }
+          const int n = (b * kKeysPerBatch + k) * kThreads + t;
+          ASSERT_OK(batch.Put(Key(n), std::to_string(n)));
+        }
+        ASSERT_OK(dbfull()->Write(WriteOptions(), &batch));
+      }
+    });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+
+  std::unique_ptr<Iterator> iter(db_->NewIterator(ReadOptions()));
+  int n = 0;
+  for (iter->SeekToFirst(); iter->Valid(); iter->Next(), n++) {
+    ASSERT_EQ(Key(n), iter->key());
+    ASSERT_EQ(std::to_string(n), iter->value());
+  }
+  ASSERT_OK(iter->status());
+  ASSERT_EQ(kThreads * kBatches * kKeysPerBatch, n);
+}
+
+TEST_P(DBWriteTest, WriteAsync) {
+  Options options = GetOptions();
+  Reopen(options);
+  std::atomic<size_t> max_merged{0};
+  SyncPoint::GetInstance()->SetCallBack(
+      "DBImpl::AsyncWriteLoop:Written", [&](void* arg) {
+        size_t num_writes = *static_cast<size_t*>(arg);
+        if (num_writes > max_merged.load()) {
+          max_merged.store(num_writes);
+        }
+      });
+  SyncPoint::GetInstance()->EnableProcessing();
+
+  // The first callback holds the thread of the async writes, so that the
+  // others queue up behind it and are merged.
+  std::promise<void> release;
+  std::shared_future<void> released = release.get_future().share();
+  std::mutex mu;
+  std::condition_variable cv;
+  int num_done = 0;
+  const int kWrites = 200;
+  std::vector<WriteBatch> batches(kWrites + 2);
+  std::vector<Status> statuses(kWrites + 2);
+  auto write_async = [&](int i) {
+    WriteOptions write_options;
+    write_options.sync = true;
+    ASSERT_OK(batches[i].Put(Key(i), "v" + std::to_string(i)));
+    db_->WriteAsync(write_options, &batches[i], [&, i](const Status& s) {
+      if (i == 0) {
+        released.wait();
+      }
+      std::lock_guard<std::mutex> lock(mu);
+      statuses[i] = s;
+      num_done++;
+      cv.notify_all();
+    });
+  };
+  for (int i = 0; i < kWrites; i++) {
+    write_async(i);
+  }
+  release.set_value();
+  {
+    std::unique_lock<std::mutex> lock(mu);
+    cv.wait(lock, [&] { return num_done == kWrites; });
+  }
+  for (int i = 0; i < kWrites; i++) {
+    ASSERT_OK(statuses[i]);
+    ASSERT_EQ("v" + std::to_string(i), Get(Key(i)));
+  }
+  ASSERT_GT(max_merged.load(), 1);
+
+  // The writes still queued when the DB closes are made before it closes.
+  write_async(kWrites);
+  write_async(kWrites + 1);
+  Close();
+  ASSERT_EQ(kWrites + 2, num_done);
+  ASSERT_OK(statuses[kWrites]);
+  ASSERT_OK(statuses[kWrites + 1]);
+  SyncPoint::GetInstance()->DisableProcessing();
+  SyncPoint::GetInstance()->ClearAllCallBacks();
+
+  Reopen(options);
+  ASSERT_EQ("v" + std::to_string(kWrites + 1), Get(Key(kWrites + 1)));
+}
+
 void CorruptLogFile(Env* env, Options& options, std::string log_path,
                     uint64_t log_num, int record_num) {
   std::shared_ptr<FileSystem> fs = env->GetFileSystem();
@@ -413,6 +413,12 @@ class InternalKeyComparator
     return user_comparator_.user_comparator();
   }
 
+  // Compares user keys as user_comparator()->Compare() does, without the
+  // virtual call for the builtin bytewise comparators
+  int CompareUserKey(const Slice& a, const Slice& b) const {
+    return user_comparator_.Compare(a, b);
+  }
+
   int Compare(const InternalKey& a, const InternalKey& b) const;
   int Compare(const ParsedInternalKey& a, const ParsedInternalKey& b) const;
   int Compare(const Slice& a, const ParsedInternalKey& b) const;
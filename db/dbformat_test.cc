@@ -270,6 +270,41 @@ TEST_F(FormatTest, UpdateInternalKey) {
   ASSERT_EQ(new_val_type, decoded.type);
 }
 
+TEST_F(FormatTest, InternalKeyComparatorWithBuiltinComparators) {
+  std::vector<std::string> user_keys = {"",  std::string(1, '\0'), "a",
+                                        "a\xff", "ab", "b", "\xff"};
+  std::vector<std::string> keys;
+  for (const auto& user_key : user_keys) {
+    for (uint64_t seq : {1, 100}) {
+      for (ValueType vt : {kTypeValue, kTypeDeletion}) {
+        keys.push_back(IKey(user_key, seq, vt));
+      }
+    }
+  }
+  auto sign = [](int r) { return (r > 0) - (r < 0); };
+  for (const Comparator* ucmp :
+       {BytewiseComparator(), ReverseBytewiseComparator()}) {
+    InternalKeyComparator icmp(ucmp);
+    for (const auto& a : keys) {
+      for (const auto& b : keys) {
+        // The order of the virtual user comparator, then of the footers
+        int expected = ucmp->Compare(ExtractUserKey(a), ExtractUserKey(b));
+        ASSERT_EQ(sign(expected), sign(icmp.CompareUserKey(ExtractUserKey(a),
+                                                           ExtractUserKey(b))));
+        if (expected == 0) {
+          const uint64_t afooter = ExtractInternalKeyFooter(a);
+          const uint64_t bfooter = ExtractInternalKeyFooter(b);
+          expected = afooter > bfooter ? -1 : (afooter < bfooter ? 1 : 0);
+        }
+        ASSERT_EQ(sign(expected), sign(icmp.Compare(a, b)))
+            << ucmp->Name() << " " << Slice(a).ToString(true) << " "
+            << Slice(b).ToString(true);
+        ASSERT_EQ(expected == 0, icmp.Equal(a, b));
+      }
+    }
+  }
+}
+
 TEST_F(FormatTest, RangeTombstoneSerializeEndKey) {
   RangeTombstone t("a", "b", 2);
   InternalKey k("b", 3, kTypeValue);
@@ -2094,6 +2094,40 @@ TEST_F(ExternalSSTFileBasicTest, VerifyChecksum) {
   ASSERT_OK(db_->VerifyChecksum());
 }
 
+TEST_F(ExternalSSTFileBasicTest, ParallelFileAnalysis) {
+  Options options = CurrentOptions();
+  DestroyAndReopen(options);
+
+  constexpr int kNumFiles = 8;
+  constexpr int kKeysPerFile = 100;
+  std::vector<std::string> files;
+  for (int i = 0; i < kNumFiles; i++) {
+    SstFileWriter sst_file_writer(EnvOptions(), options);
+    files.push_back(sst_files_dir_ + "parallel_" + std::to_string(i) + ".sst");
+    ASSERT_OK(sst_file_writer.Open(files.back()));
+    for (int k = i * kKeysPerFile; k < (i + 1) * kKeysPerFile; k++) {
+      ASSERT_OK(sst_file_writer.Put(Key(k), Key(k) + "_val"));
+    }
+    ASSERT_OK(sst_file_writer.Finish());
+  }
+
+  IngestExternalFileOptions ingest_opt;
+  ingest_opt.verify_checksums_before_ingest = true;
+  ingest_opt.max_file_analysis_threads = 4;
+
+  // A missing file fails the whole ingestion
+  std::vector<std::string> files_with_missing = files;
+  files_with_missing.insert(files_with_missing.begin() + kNumFiles / 2,
+                            sst_files_dir_ + "missing.sst");
+  ASSERT_NOK(db_->IngestExternalFile(files_with_missing, ingest_opt));
+  ASSERT_EQ(Get(Key(0)), "NOT_FOUND");
+
+  ASSERT_OK(db_->IngestExternalFile(files, ingest_opt));
+  for (int k = 0; k < kNumFiles * kKeysPerFile; k++) {
+    ASSERT_EQ(Get(Key(k)), Key(k) + "_val");
+  }
+}
+
 TEST_F(ExternalSSTFileBasicTest, VerifySstUniqueId) {
   const std::string kPutVal = "put_val";
   const std::string kIngestedVal = "ingested_val";
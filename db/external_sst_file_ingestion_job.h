@@ -81,6 +81,9 @@ struct IngestedFileInfo {
   // the user key's format in the external file matches the column family's
   // setting.
   bool user_defined_timestamps_persisted = true;
+  // Time spent reading the file before ingestion: its properties, bounds and
+  // checksums
+  uint64_t analysis_micros = 0;
 };
 
 class ExternalSstFileIngestionJob {
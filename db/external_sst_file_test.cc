@@ -557,6 +557,56 @@ TEST_F(ExternalSSTFileTest, Basic) {
                          kRangeDelSkipConfigs));
 }
 
+TEST_F(ExternalSSTFileTest, ParallelSstFileWriter) {
+  Options options = CurrentOptions();
+  DestroyAndReopen(options);
+
+  ParallelSstFileWriterOptions parallel_options;
+  parallel_options.directory = dbname_ + "/sst_files";
+  parallel_options.target_file_size = 4 << 10;
+  parallel_options.max_background_writers = 3;
+
+  constexpr int kNumKeys = 1000;
+  std::vector<ExternalSstFileInfo> file_infos;
+  {
+    ParallelSstFileWriter writer(EnvOptions(), options, parallel_options);
+    for (int k = 0; k < kNumKeys; k++) {
+      if (k % 10 == 9) {
+        ASSERT_OK(writer.Delete(Key(k)));
+      } else {
+        ASSERT_OK(writer.Put(Key(k), Key(k) + "_val"));
+      }
+    }
+    ASSERT_TRUE(writer.Put(Key(0), "bad_val").IsInvalidArgument());
+    ASSERT_OK(writer.Finish(&file_infos));
+    ASSERT_NOK(writer.Put(Key(kNumKeys), "bad_val"));
+  }
+
+  // The files split the keys in order
+  ASSERT_GT(file_infos.size(), 3);
+  uint64_t num_entries = 0;
+  std::vector<std::string> files;
+  for (size_t i = 0; i < file_infos.size(); i++) {
+    if (i > 0) {
+      ASSERT_LT(file_infos[i - 1].largest_key, file_infos[i].smallest_key);
+    }
+    num_entries += file_infos[i].num_entries;
+    files.push_back(file_infos[i].file_path);
+  }
+  ASSERT_EQ(num_entries, kNumKeys);
+  ASSERT_EQ(file_infos.front().smallest_key, Key(0));
+  ASSERT_EQ(file_infos.back().largest_key, Key(kNumKeys - 1));
+
+  ASSERT_OK(db_->IngestExternalFile(files, IngestExternalFileOptions()));
+  for (int k = 0; k < kNumKeys; k++) {
+    if (k % 10 == 9) {
+      ASSERT_EQ(Get(Key(k)), "NOT_FOUND");
+    } else {
+      ASSERT_EQ(Get(Key(k)), Key(k) + "_val");
+    }
+  }
+}
+
 TEST_F(ExternalSSTFileTest, BasicWideColumn) {
   do {
     Options options = CurrentOptions();
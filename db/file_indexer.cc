@@ -12,6 +12,7 @@
 #include <algorithm>
 #include <functional>
 
+#include "db/dbformat.h"
 #include "db/version_edit.h"
 #include "rocksdb/comparator.h"
 
@@ -213,4 +214,83 @@ void FileIndexer::CalculateRB(
   }
 }
 
+void L0FileIndex::UpdateIndex(const LevelFilesBrief& level) {
+  bounds_.clear();
+  slot_offsets_.clear();
+  slot_files_.clear();
+  if (level.num_files < kMinFiles) {
+    return;
+  }
+
+  auto less = [this](const Slice& a, const Slice& b) {
+    return ucmp_->CompareWithoutTimestamp(a, b) < 0;
+  };
+  bounds_.reserve(2 * level.num_files);
+  for (size_t i = 0; i < level.num_files; i++) {
+    bounds_.push_back(ExtractUserKey(level.files[i].smallest_key));
+    bounds_.push_back(ExtractUserKey(level.files[i].largest_key));
+  }
+  std::sort(bounds_.begin(), bounds_.end(), less);
+  bounds_.erase(std::unique(bounds_.begin(), bounds_.end(),
+                            [this](const Slice& a, const Slice& b) {
+                              return ucmp_->CompareWithoutTimestamp(a, b) == 0;
+                            }),
+                bounds_.end());
+
+  // The slots of each file, from those of its smallest key to those of its
+  // largest key.
+  const size_t num_slots = 2 * bounds_.size() - 1;
+  std::vector<std::pair<uint32_t, uint32_t>> file_slots(level.num_files);
+  std::vector<uint32_t> slot_counts(num_slots, 0);
+  for (size_t i = 0; i < level.num_files; i++) {
+    auto first = std::lower_bound(bounds_.begin(), bounds_.end(),
+                                  ExtractUserKey(level.files[i].smallest_key),
+                                  less);
+    auto last = std::lower_bound(bounds_.begin(), bounds_.end(),
+                                 ExtractUserKey(level.files[i].largest_key),
+                                 less);
+    file_slots[i] = {static_cast<uint32_t>(2 * (first - bounds_.begin())),
+                     static_cast<uint32_t>(2 * (last - bounds_.begin()))};
+    for (uint32_t slot = file_slots[i].first; slot <= file_slots[i].second;
+         slot++) {
+      slot_counts[slot]++;
+    }
+  }
+  slot_offsets_.resize(num_slots + 1);
+  slot_offsets_[0] = 0;
+  for (size_t slot = 0; slot < num_slots; slot++) {
+    slot_offsets_[slot + 1] = slot_offsets_[slot] + slot_counts[slot];
+  }
+  // Files are added in order, so each slot lists them in order.
+  slot_files_.resize(slot_offsets_[num_slots]);
+  std::vector<uint32_t> next(slot_offsets_.begin(), slot_offsets_.end() - 1);
+  for (size_t i = 0; i < level.num_files; i++) {
+    for (uint32_t slot = file_slots[i].first; slot <= file_slots[i].second;
+         slot++) {
+      slot_files_[next[slot]++] = static_cast<uint32_t>(i);
+    }
+  }
+}
+
+const uint32_t* L0FileIndex::GetFiles(const Slice& user_key,
+                                      uint32_t* num) const {
+  assert(!empty());
+  auto it = std::lower_bound(bounds_.begin(), bounds_.end(), user_key,
+                             [this](const Slice& a, const Slice& b) {
+                               return ucmp_->CompareWithoutTimestamp(a, b) < 0;
+                             });
+  if (it == bounds_.end() ||
+      (it == bounds_.begin() &&
+       ucmp_->CompareWithoutTimestamp(user_key, *it) != 0)) {
+    *num = 0;
+    return nullptr;
+  }
+  const size_t i = it - bounds_.begin();
+  const size_t slot = ucmp_->CompareWithoutTimestamp(user_key, *it) == 0
+                          ? 2 * i
+                          : 2 * i - 1;
+  *num = slot_offsets_[slot + 1] - slot_offsets_[slot];
+  return slot_files_.data() + slot_offsets_[slot];
+}
+
 }  // namespace ROCKSDB_NAMESPACE
@@ -15,6 +15,7 @@
 
 #include "memory/arena.h"
 #include "port/port.h"
+#include "rocksdb/slice.h"
 #include "util/autovector.h"
 
 namespace ROCKSDB_NAMESPACE {
@@ -23,6 +24,7 @@ class Comparator;
 struct FileMetaData;
 struct FdWithKeyRange;
 struct FileLevel;
+struct LevelFilesBrief;
 
 // The file tree structure in Version is prebuilt and the range of each file
 // is known. On Version::Get(), it uses binary search to find a potential file
@@ -137,4 +139,45 @@ class FileIndexer {
   int32_t* level_rb_;
 };
 
+// The L0 files overlap each other, so Version::Get() would compare a key to
+// the range of every L0 file. L0FileIndex splits the user key space at the
+// smallest and largest keys of the L0 files, and lists the files covering
+// each piece, so that a lookup is a binary search over the boundaries
+// however many L0 files there are.
+//
+// Example:
+//    level 0:   [10 - 40], [20 - 30], [35 - 50]
+//    boundaries: 10, 20, 30, 35, 40, 50
+// A key 32, which falls in (30, 35), is only in the range of the 1st file.
+// A key 35 is in the range of the 1st and 3rd files.
+class L0FileIndex {
+ public:
+  explicit L0FileIndex(const Comparator* ucmp) : ucmp_(ucmp) {}
+
+  // Indexes the files of level, which must outlive the index, if there are
+  // more than kMinFiles of them. Otherwise clears the index.
+  void UpdateIndex(const LevelFilesBrief& level);
+
+  bool empty() const { return bounds_.empty(); }
+
+  // Returns the positions in the level of the files whose key range contains
+  // user_key, in increasing order, so newest first for L0, and sets *num to
+  // their number. Must not be called on an empty index.
+  const uint32_t* GetFiles(const Slice& user_key, uint32_t* num) const;
+
+  // Below this many files, comparing a key to each of them is about as cheap.
+  static constexpr size_t kMinFiles = 4;
+
+ private:
+  const Comparator* ucmp_;
+  // The distinct user keys of the file boundaries, sorted. Slot 2 * i is for
+  // the keys equal to bounds_[i], and slot 2 * i + 1 for those between
+  // bounds_[i] and bounds_[i + 1].
+  std::vector<Slice> bounds_;
+  // The files of slot i are slot_files_[slot_offsets_[i]] up to
+  // slot_files_[slot_offsets_[i + 1]].
+  std::vector<uint32_t> slot_offsets_;
+  std::vector<uint32_t> slot_files_;
+};
+
 }  // namespace ROCKSDB_NAMESPACE
@@ -343,6 +343,56 @@ TEST_F(FileIndexerTest, mixed) {
   ClearFiles();
 }
 
+TEST_F(FileIndexerTest, L0FileIndex) {
+  // Newest first
+  AddFile(0, 10, 40);
+  AddFile(0, 20, 30);
+  AddFile(0, 35, 50);
+  std::vector<FdWithKeyRange> briefs;
+  auto update_index = [&](L0FileIndex* index) {
+    briefs.clear();
+    for (auto* f : files[0]) {
+      briefs.emplace_back(f->fd, f->smallest.Encode(), f->largest.Encode(), f);
+    }
+    LevelFilesBrief level;
+    level.num_files = briefs.size();
+    level.files = briefs.data();
+    index->UpdateIndex(level);
+  };
+  auto get_files = [&](const L0FileIndex& index, int64_t key) {
+    uint32_t num = 0;
+    const uint32_t* positions =
+        index.GetFiles(Slice(reinterpret_cast<char*>(&key), 8), &num);
+    return std::vector<uint32_t>(positions, positions + num);
+  };
+
+  // Too few files to index
+  L0FileIndex index(&ucmp);
+  update_index(&index);
+  ASSERT_TRUE(index.empty());
+
+  AddFile(0, 30, 30);
+  update_index(&index);
+  ASSERT_FALSE(index.empty());
+  using Files = std::vector<uint32_t>;
+  ASSERT_EQ(Files(), get_files(index, 5));
+  ASSERT_EQ(Files({0}), get_files(index, 10));
+  ASSERT_EQ(Files({0}), get_files(index, 15));
+  ASSERT_EQ(Files({0, 1}), get_files(index, 20));
+  ASSERT_EQ(Files({0, 1}), get_files(index, 25));
+  ASSERT_EQ(Files({0, 1, 3}), get_files(index, 30));
+  ASSERT_EQ(Files({0}), get_files(index, 32));
+  ASSERT_EQ(Files({0, 2}), get_files(index, 35));
+  ASSERT_EQ(Files({0, 2}), get_files(index, 40));
+  ASSERT_EQ(Files({2}), get_files(index, 45));
+  ASSERT_EQ(Files({2}), get_files(index, 50));
+  ASSERT_EQ(Files(), get_files(index, 55));
+
+  ClearFiles();
+  update_index(&index);
+  ASSERT_TRUE(index.empty());
+}
+
 }  // namespace ROCKSDB_NAMESPACE
 
 int main(int argc, char** argv) {
@@ -11,9 +11,14 @@
 
 #include <algorithm>
 #include <cinttypes>
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <unordered_set>
 #include <vector>
 
 #include "db/builder.h"
+#include "db/compaction/clipping_iterator.h"
 #include "db/db_iter.h"
 #include "db/dbformat.h"
 #include "db/event_helpers.h"
@@ -27,6 +32,7 @@
 #include "db/version_set.h"
 #include "file/file_util.h"
 #include "file/filename.h"
+#include "file/sst_file_manager_impl.h"
 #include "logging/event_logger.h"
 #include "logging/log_buffer.h"
 #include "logging/logging.h"
@@ -86,13 +92,94 @@ const char* GetFlushReasonString(FlushReason flush_reason) {
   }
 }
 
+namespace {
+// A flush is only split into key ranges of at least this many bytes of the
+// memtables, see DBOptions::max_flush_subjobs.
+constexpr uint64_t kMinFlushSubjobBytes = 1 << 20;
+// The number of memtable entries sampled for each key range.
+constexpr uint64_t kFlushSubjobSamples = 64;
+
+// The L0 file of one key range of a split flush.
+struct FlushSubjob {
+  // Internal keys bounding the range, unset for the first and the last one.
+  std::string start;
+  std::string end;
+  FileMetaData meta;
+  std::vector<BlobFileAddition> blob_file_additions;
+  TableProperties table_properties;
+  uint64_t num_input_entries = 0;
+  uint64_t memtable_payload_bytes = 0;
+  uint64_t memtable_garbage_bytes = 0;
+  IOStatus io_s;
+  Status status;
+};
+
+// Runs the subjobs of a split flush on the flush thread and on the jobs it
+// schedules. The jobs that did not start by the time the flush thread ran
+// out of subjobs are unscheduled, so that a flush never waits for a thread
+// of the pool, which other flushes may occupy.
+class FlushSubjobRunner {
+ public:
+  FlushSubjobRunner(size_t num_subjobs, std::function<void(size_t)> run)
+      : num_subjobs_(num_subjobs), run_(std::move(run)) {}
+
+  void Schedule(Env* env, Env::Priority pri) {
+    {
+      std::lock_guard<std::mutex> lk(mu_);
+      num_scheduled_++;
+    }
+    env->Schedule(&FlushSubjobRunner::BGWork, this, pri, this,
+                  &FlushSubjobRunner::Unschedule);
+  }
+
+  // Runs subjobs until none is left, then waits for the scheduled jobs.
+  void RunAndWait(Env* env, Env::Priority pri) {
+    RunSubjobs();
+    env->UnSchedule(this, pri);
+    std::unique_lock<std::mutex> lk(mu_);
+    cv_.wait(lk, [this] { return num_scheduled_ == 0; });
+  }
+
+ private:
+  void RunSubjobs() {
+    for (size_t i = next_.fetch_add(1); i < num_subjobs_;
+         i = next_.fetch_add(1)) {
+      run_(i);
+    }
+  }
+
+  void Done() {
+    std::lock_guard<std::mutex> lk(mu_);
+    num_scheduled_--;
+    cv_.notify_all();
+  }
+
+  static void BGWork(void* arg) {
+    auto* runner = static_cast<FlushSubjobRunner*>(arg);
+    runner->RunSubjobs();
+    runner->Done();
+  }
+
+  static void Unschedule(void* arg) {
+    static_cast<FlushSubjobRunner*>(arg)->Done();
+  }
+
+  const size_t num_subjobs_;
+  const std::function<void(size_t)> run_;
+  std::atomic<size_t> next_{0};
+  std::mutex mu_;
+  std::condition_variable cv_;
+  int num_scheduled_ = 0;
+};
+}  // namespace
+
 FlushJob::FlushJob(
     const std::string& dbname, ColumnFamilyData* cfd,
     const ImmutableDBOptions& db_options,
     const MutableCFOptions& mutable_cf_options, uint64_t max_memtable_id,
     const FileOptions& file_options, VersionSet* versions,
     InstrumentedMutex* db_mutex, std::atomic<bool>* shutting_down,
-    std::vector<SequenceNumber> existing_snapshots,
+    std::shared_ptr<const std::vector<SequenceNumber>> existing_snapshots,
     SequenceNumber earliest_write_conflict_snapshot,
     SnapshotChecker* snapshot_checker, JobContext* job_context,
     FlushReason flush_reason, LogBuffer* log_buffer, FSDirectory* db_directory,
@@ -114,7 +201,10 @@ FlushJob::FlushJob(
       versions_(versions),
       db_mutex_(db_mutex),
       shutting_down_(shutting_down),
-      existing_snapshots_(std::move(existing_snapshots)),
+      existing_snapshots_(
+          existing_snapshots != nullptr
+              ? std::move(existing_snapshots)
+              : std::make_shared<const std::vector<SequenceNumber>>()),
       earliest_write_conflict_snapshot_(earliest_write_conflict_snapshot),
       snapshot_checker_(snapshot_checker),
       job_context_(job_context),
@@ -248,6 +338,7 @@ Status FlushJob::Run(LogsWithPrepTracker* prep_tracker, FileMetaData* file_meta,
   uint64_t prev_prepare_write_nanos = 0;
   uint64_t prev_cpu_write_nanos = 0;
   uint64_t prev_cpu_read_nanos = 0;
+  CompactionStageTimer stage_timer;
   if (measure_io_stats_) {
     prev_perf_level = GetPerfLevel();
     SetPerfLevel(PerfLevel::kEnableTime);
@@ -257,6 +348,7 @@ Status FlushJob::Run(LogsWithPrepTracker* prep_tracker, FileMetaData* file_meta,
     prev_prepare_write_nanos = IOSTATS(prepare_write_nanos);
     prev_cpu_write_nanos = IOSTATS(cpu_write_nanos);
     prev_cpu_read_nanos = IOSTATS(cpu_read_nanos);
+    stage_timer.Start();
   }
   Status mempurge_s = Status::NotFound("No MemPurge.");
   if ((mempurge_threshold > 0.0) &&
@@ -382,6 +474,18 @@ Status FlushJob::Run(LogsWithPrepTracker* prep_tracker, FileMetaData* file_meta,
            << (IOSTATS(cpu_write_nanos) - prev_cpu_write_nanos);
     stream << "file_cpu_read_nanos"
            << (IOSTATS(cpu_read_nanos) - prev_cpu_read_nanos);
+
+    CompactionJobStats stage_stats;
+    stage_stats.file_write_nanos = IOSTATS(write_nanos) - prev_write_nanos;
+    stage_timer.AddTo(&stage_stats);
+    stream << "file_read_nanos" << stage_stats.file_read_nanos;
+    stream << "block_decompress_nanos" << stage_stats.block_decompress_nanos;
+    stream << "block_checksum_nanos" << stage_stats.block_checksum_nanos;
+    stream << "block_compress_nanos" << stage_stats.block_compress_nanos;
+    stream << "compaction_filter_nanos" << stage_stats.compaction_filter_nanos;
+    stream << "merge_operator_nanos" << stage_stats.merge_operator_nanos;
+    stream << "cloud_request_nanos" << stage_stats.cloud_request_nanos;
+    cfd_->internal_stats()->AddCompactionStageStats(stage_stats);
   }
 
   TEST_SYNC_POINT("FlushJob::End");
@@ -460,7 +564,7 @@ Status FlushJob::MemPurge() {
   const std::string* const full_history_ts_low = &(cfd_->GetFullHistoryTsLow());
   std::unique_ptr<CompactionRangeDelAggregator> range_del_agg(
       new CompactionRangeDelAggregator(&(cfd_->internal_comparator()),
-                                       existing_snapshots_,
+                                       *existing_snapshots_,
                                        full_history_ts_low));
   for (auto& rd_iter : range_del_iters) {
     range_del_agg->AddTombstones(std::move(rd_iter));
@@ -496,6 +600,7 @@ Status FlushJob::MemPurge() {
                            mutable_cf_options_, cfd_->write_buffer_mgr(),
                            earliest_seqno, cfd_->GetID());
     assert(new_mem != nullptr);
+    new_mem->SetWriteBufferManagerTenant(cfd_->write_buffer_mgr_tenant());
 
     Env* env = db_options_.env;
     assert(env);
@@ -503,14 +608,14 @@ Status FlushJob::MemPurge() {
         env, (cfd_->internal_comparator()).user_comparator(),
         (ioptions->merge_operator).get(), compaction_filter.get(),
         ioptions->logger, true /* internal key corruption is not ok */,
-        existing_snapshots_.empty() ? 0 : existing_snapshots_.back(),
+        existing_snapshots_->empty() ? 0 : existing_snapshots_->back(),
         snapshot_checker_);
     assert(job_context_);
     SequenceNumber job_snapshot_seq = job_context_->GetJobSnapshotSequence();
     const std::atomic<bool> kManualCompactionCanceledFalse{false};
     CompactionIterator c_iter(
         iter.get(), (cfd_->internal_comparator()).user_comparator(), &merge,
-        kMaxSequenceNumber, &existing_snapshots_,
+        kMaxSequenceNumber, existing_snapshots_.get(),
         earliest_write_conflict_snapshot_, job_snapshot_seq, snapshot_checker_,
         env, ShouldReportDetailedTime(env, ioptions->stats),
         true /* internal key corruption is not ok */, range_del_agg.get(),
@@ -762,7 +867,7 @@ bool FlushJob::MemPurgeDecider(double threshold) {
       // Pick the oldest existing snapshot that is more recent
       // than the sequence number of the sampled entry.
       min_seqno_snapshot = kMaxSequenceNumber;
-      for (SequenceNumber seq_num : existing_snapshots_) {
+      for (SequenceNumber seq_num : *existing_snapshots_) {
         if (seq_num > res.sequence && seq_num < min_seqno_snapshot) {
           min_seqno_snapshot = seq_num;
         }
@@ -971,28 +1076,129 @@ Status FlushJob::WriteLevel0Table() {
       ReadOptions read_options(Env::IOActivity::kFlush);
       read_options.rate_limiter_priority = io_priority;
       const WriteOptions write_options(io_priority, Env::IOActivity::kFlush);
-      TableBuilderOptions tboptions(
-          *cfd_->ioptions(), mutable_cf_options_, read_options, write_options,
-          cfd_->internal_comparator(), cfd_->internal_tbl_prop_coll_factories(),
-          output_compression_, mutable_cf_options_.compression_opts,
-          cfd_->GetID(), cfd_->GetName(), 0 /* level */,
-          false /* is_bottommost */, TableFileCreationReason::kFlush,
-          oldest_key_time, current_time, db_id_, db_session_id_,
-          0 /* target_file_size */, meta_.fd.GetNumber());
+      auto new_tboptions = [&](uint64_t file_number) {
+        TableBuilderOptions tbo(
+            *cfd_->ioptions(), mutable_cf_options_, read_options,
+            write_options, cfd_->internal_comparator(),
+            cfd_->internal_tbl_prop_coll_factories(), output_compression_,
+            mutable_cf_options_.compression_opts, cfd_->GetID(),
+            cfd_->GetName(), 0 /* level */, false /* is_bottommost */,
+            TableFileCreationReason::kFlush, oldest_key_time, current_time,
+            db_id_, db_session_id_, 0 /* target_file_size */, file_number);
+        tbo.compression_dict_manager = cfd_->compression_dict_manager();
+        return tbo;
+      };
+      TableBuilderOptions tboptions = new_tboptions(meta_.fd.GetNumber());
       const SequenceNumber job_snapshot_seq =
           job_context_->GetJobSnapshotSequence();
 
-      s = BuildTable(
-          dbname_, versions_, db_options_, tboptions, file_options_,
-          cfd_->table_cache(), iter.get(), std::move(range_del_iters), &meta_,
-          &blob_file_additions, existing_snapshots_,
-          earliest_write_conflict_snapshot_, job_snapshot_seq,
-          snapshot_checker_, mutable_cf_options_.paranoid_file_checks,
-          cfd_->internal_stats(), &io_s, io_tracer_,
-          BlobFileCreationReason::kFlush, seqno_to_time_mapping_.get(),
-          event_logger_, job_context_->job_id, &table_properties_, write_hint,
-          full_history_ts_low, blob_callback_, base_, &num_input_entries,
-          &memtable_payload_bytes, &memtable_garbage_bytes);
+      std::vector<std::string> boundaries;
+      if (range_del_iters.empty()) {
+        PickSubjobBoundaries(total_data_size, &boundaries);
+      }
+      if (boundaries.empty()) {
+        s = BuildTable(
+            dbname_, versions_, db_options_, tboptions, file_options_,
+            cfd_->table_cache(), iter.get(), std::move(range_del_iters),
+            &meta_, &blob_file_additions, *existing_snapshots_,
+            earliest_write_conflict_snapshot_, job_snapshot_seq,
+            snapshot_checker_, mutable_cf_options_.paranoid_file_checks,
+            cfd_->internal_stats(), &io_s, io_tracer_,
+            BlobFileCreationReason::kFlush, seqno_to_time_mapping_.get(),
+            event_logger_, job_context_->job_id, &table_properties_,
+            write_hint, full_history_ts_low, blob_callback_, base_,
+            &num_input_entries, &memtable_payload_bytes,
+            &memtable_garbage_bytes);
+      } else {
+        // One L0 file for each key range, the first one into meta_. The
+        // ranges are bounded by user keys, so that all the versions of a key
+        // are in the same file.
+        const size_t num_subjobs = boundaries.size() + 1;
+        std::vector<FlushSubjob> subjobs(num_subjobs);
+        for (size_t i = 0; i < num_subjobs; i++) {
+          auto& subjob = subjobs[i];
+          subjob.meta = meta_;
+          if (i > 0) {
+            subjob.meta.fd = FileDescriptor(versions_->NewFileNumber(),
+                                            meta_.fd.GetPathId(), 0);
+            subjob.start = InternalKey(boundaries[i - 1], kMaxSequenceNumber,
+                                       kValueTypeForSeek)
+                               .Encode()
+                               .ToString();
+          }
+          if (i + 1 < num_subjobs) {
+            subjob.end = InternalKey(boundaries[i], kMaxSequenceNumber,
+                                     kValueTypeForSeek)
+                             .Encode()
+                             .ToString();
+          }
+        }
+        ROCKS_LOG_INFO(db_options_.info_log,
+                       "[%s] [JOB %d] Level-0 flush split into %" ROCKSDB_PRIszt
+                       " key ranges",
+                       cfd_->GetName().c_str(), job_context_->job_id,
+                       num_subjobs);
+
+        FlushSubjobRunner runner(num_subjobs, [&](size_t i) {
+          auto& subjob = subjobs[i];
+          Arena subjob_arena;
+          std::vector<InternalIterator*> subjob_memtables;
+          for (MemTable* m : mems_) {
+            subjob_memtables.push_back(m->NewIterator(
+                ro, /*seqno_to_time_mapping=*/nullptr, &subjob_arena));
+          }
+          ScopedArenaPtr<InternalIterator> subjob_iter(NewMergingIterator(
+              &cfd_->internal_comparator(), subjob_memtables.data(),
+              static_cast<int>(subjob_memtables.size()), &subjob_arena));
+          const Slice start(subjob.start);
+          const Slice end(subjob.end);
+          ClippingIterator clipped(subjob_iter.get(), i > 0 ? &start : nullptr,
+                                   i + 1 < num_subjobs ? &end : nullptr,
+                                   &cfd_->internal_comparator());
+          subjob.status = BuildTable(
+              dbname_, versions_, db_options_,
+              new_tboptions(subjob.meta.fd.GetNumber()), file_options_,
+              cfd_->table_cache(), &clipped, {} /* range_del_iters */,
+              &subjob.meta, &subjob.blob_file_additions, *existing_snapshots_,
+              earliest_write_conflict_snapshot_, job_snapshot_seq,
+              snapshot_checker_, mutable_cf_options_.paranoid_file_checks,
+              cfd_->internal_stats(), &subjob.io_s, io_tracer_,
+              BlobFileCreationReason::kFlush, seqno_to_time_mapping_.get(),
+              event_logger_, job_context_->job_id, &subjob.table_properties,
+              write_hint, full_history_ts_low, blob_callback_, base_,
+              &subjob.num_input_entries, &subjob.memtable_payload_bytes,
+              &subjob.memtable_garbage_bytes);
+        });
+        for (size_t i = 1; i < num_subjobs; i++) {
+          runner.Schedule(db_options_.env, thread_pri_);
+        }
+        runner.RunAndWait(db_options_.env, thread_pri_);
+
+        for (auto& subjob : subjobs) {
+          if (s.ok()) {
+            s = subjob.status;
+          } else {
+            subjob.status.PermitUncheckedError();
+          }
+          if (io_s.ok()) {
+            io_s = subjob.io_s;
+          } else {
+            subjob.io_s.PermitUncheckedError();
+          }
+          num_input_entries += subjob.num_input_entries;
+          memtable_payload_bytes += subjob.memtable_payload_bytes;
+          memtable_garbage_bytes += subjob.memtable_garbage_bytes;
+          blob_file_additions.insert(
+              blob_file_additions.end(),
+              std::make_move_iterator(subjob.blob_file_additions.begin()),
+              std::make_move_iterator(subjob.blob_file_additions.end()));
+        }
+        meta_ = std::move(subjobs[0].meta);
+        table_properties_ = std::move(subjobs[0].table_properties);
+        for (size_t i = 1; i < num_subjobs; i++) {
+          subjob_metas_.push_back(std::move(subjobs[i].meta));
+        }
+      }
       TEST_SYNC_POINT_CALLBACK("FlushJob::WriteLevel0Table:s", &s);
       // TODO: Cleanup io_status in BuildTable and table builders
       assert(!s.ok() || io_s.ok());
@@ -1025,6 +1231,14 @@ Status FlushJob::WriteLevel0Table() {
                      meta_.fd.GetNumber(), meta_.fd.GetFileSize(),
                      s.ToString().c_str(),
                      meta_.marked_for_compaction ? " (needs compaction)" : "");
+    for (const auto& m : subjob_metas_) {
+      ROCKS_LOG_BUFFER(log_buffer_,
+                       "[%s] [JOB %d] Level-0 flush table #%" PRIu64
+                       ": %" PRIu64 " bytes%s",
+                       cfd_->GetName().c_str(), job_context_->job_id,
+                       m.fd.GetNumber(), m.fd.GetFileSize(),
+                       m.marked_for_compaction ? " (needs compaction)" : "");
+    }
 
     if (s.ok() && output_file_directory_ != nullptr && sync_output_directory_) {
       s = output_file_directory_->FsyncWithDirOptions(
@@ -1038,7 +1252,16 @@ Status FlushJob::WriteLevel0Table() {
 
   // Note that if file_size is zero, the file has been deleted and
   // should not be added to the manifest.
-  const bool has_output = meta_.fd.GetFileSize() > 0;
+  bool has_output = meta_.fd.GetFileSize() > 0;
+  uint64_t bytes_written = meta_.fd.GetFileSize();
+  int num_output_files = has_output ? 1 : 0;
+  for (const auto& m : subjob_metas_) {
+    if (m.fd.GetFileSize() > 0) {
+      has_output = true;
+      bytes_written += m.fd.GetFileSize();
+      num_output_files++;
+    }
+  }
 
   if (s.ok() && has_output) {
     TEST_SYNC_POINT("DBImpl::FlushJob:SSTFileCreated");
@@ -1047,15 +1270,41 @@ Status FlushJob::WriteLevel0Table() {
     // threads could be concurrently producing compacted files for
     // that key range.
     // Add file to L0
-    edit_->AddFile(0 /* level */, meta_.fd.GetNumber(), meta_.fd.GetPathId(),
-                   meta_.fd.GetFileSize(), meta_.smallest, meta_.largest,
-                   meta_.fd.smallest_seqno, meta_.fd.largest_seqno,
-                   meta_.marked_for_compaction, meta_.temperature,
-                   meta_.oldest_blob_file_number, meta_.oldest_ancester_time,
-                   meta_.file_creation_time, meta_.epoch_number,
-                   meta_.file_checksum, meta_.file_checksum_func_name,
-                   meta_.unique_id, meta_.compensated_range_deletion_size,
-                   meta_.tail_size, meta_.user_defined_timestamps_persisted);
+    if (meta_.fd.GetFileSize() > 0) {
+      edit_->AddFile(
+          0 /* level */, meta_.fd.GetNumber(), meta_.fd.GetPathId(),
+          meta_.fd.GetFileSize(), meta_.smallest, meta_.largest,
+          meta_.fd.smallest_seqno, meta_.fd.largest_seqno,
+          meta_.marked_for_compaction, meta_.temperature,
+          meta_.oldest_blob_file_number, meta_.oldest_ancester_time,
+          meta_.file_creation_time, meta_.epoch_number, meta_.file_checksum,
+          meta_.file_checksum_func_name, meta_.unique_id,
+          meta_.compensated_range_deletion_size, meta_.tail_size,
+          meta_.user_defined_timestamps_persisted);
+    }
+    // The files of the other key ranges of a split flush. DBImpl reports
+    // only meta_ to the SstFileManager.
+    auto sfm =
+        static_cast<SstFileManagerImpl*>(db_options_.sst_file_manager.get());
+    for (const auto& m : subjob_metas_) {
+      if (m.fd.GetFileSize() == 0) {
+        continue;
+      }
+      edit_->AddFile(0 /* level */, m.fd.GetNumber(), m.fd.GetPathId(),
+                     m.fd.GetFileSize(), m.smallest, m.largest,
+                     m.fd.smallest_seqno, m.fd.largest_seqno,
+                     m.marked_for_compaction, m.temperature,
+                     m.oldest_blob_file_number, m.oldest_ancester_time,
+                     m.file_creation_time, m.epoch_number, m.file_checksum,
+                     m.file_checksum_func_name, m.unique_id,
+                     m.compensated_range_deletion_size, m.tail_size,
+                     m.user_defined_timestamps_persisted);
+      if (sfm) {
+        sfm->OnAddFile(TableFileName(cfd_->ioptions()->cf_paths,
+                                     m.fd.GetNumber(), m.fd.GetPathId()))
+            .PermitUncheckedError();
+      }
+    }
     edit_->SetBlobFileAdditions(std::move(blob_file_additions));
   }
   // Piggyback FlushJobInfo on the first first flushed memtable.
@@ -1075,8 +1324,8 @@ Status FlushJob::WriteLevel0Table() {
                  cpu_micros);
 
   if (has_output) {
-    stats.bytes_written = meta_.fd.GetFileSize();
-    stats.num_output_files = 1;
+    stats.bytes_written = bytes_written;
+    stats.num_output_files = num_output_files;
   }
 
   const auto& blobs = edit_->GetBlobFileAdditions();
@@ -1096,6 +1345,61 @@ Status FlushJob::WriteLevel0Table() {
   return s;
 }
 
+void FlushJob::PickSubjobBoundaries(uint64_t total_data_size,
+                                    std::vector<std::string>* boundaries) {
+  boundaries->clear();
+  const Comparator* ucmp = cfd_->user_comparator();
+  // Only skip lists can sample their entries, and the ranges of keys with
+  // user-defined timestamps would need bounds on the keys without them.
+  if (db_options_.max_flush_subjobs <= 1 || ucmp->timestamp_size() > 0 ||
+      !cfd_->ioptions()->memtable_factory->IsInstanceOf(
+          SkipListFactory::kClassName())) {
+    return;
+  }
+  const uint64_t num_subjobs =
+      std::min(static_cast<uint64_t>(db_options_.max_flush_subjobs),
+               total_data_size / kMinFlushSubjobBytes);
+  if (num_subjobs <= 1) {
+    return;
+  }
+
+  uint64_t total_num_entries = 0;
+  for (MemTable* m : mems_) {
+    total_num_entries += m->num_entries();
+  }
+  std::vector<std::string> keys;
+  for (MemTable* m : mems_) {
+    if (m->num_entries() == 0) {
+      continue;
+    }
+    const uint64_t sample_size = std::max<uint64_t>(
+        1, num_subjobs * kFlushSubjobSamples * m->num_entries() /
+               total_num_entries);
+    std::unordered_set<const char*> entries;
+    m->UniqueRandomSample(sample_size, &entries);
+    for (const char* entry : entries) {
+      keys.push_back(ExtractUserKey(GetLengthPrefixedSlice(entry)).ToString());
+    }
+  }
+  std::sort(keys.begin(), keys.end(),
+            [ucmp](const std::string& a, const std::string& b) {
+              return ucmp->Compare(a, b) < 0;
+            });
+  keys.erase(std::unique(keys.begin(), keys.end(),
+                         [ucmp](const std::string& a, const std::string& b) {
+                           return ucmp->Equal(a, b);
+                         }),
+             keys.end());
+  if (keys.size() < num_subjobs) {
+    return;
+  }
+  // The first boundary is not the smallest sampled key, so that no range is
+  // empty.
+  for (uint64_t i = 1; i < num_subjobs; i++) {
+    boundaries->push_back(std::move(keys[i * keys.size() / num_subjobs]));
+  }
+}
+
 Env::IOPriority FlushJob::GetRateLimiterPriority() {
   if (versions_ && versions_->GetColumnFamilySet() &&
       versions_->GetColumnFamilySet()->write_controller()) {
@@ -63,7 +63,8 @@ class FlushJob {
            const MutableCFOptions& mutable_cf_options, uint64_t max_memtable_id,
            const FileOptions& file_options, VersionSet* versions,
            InstrumentedMutex* db_mutex, std::atomic<bool>* shutting_down,
-           std::vector<SequenceNumber> existing_snapshots,
+           std::shared_ptr<const std::vector<SequenceNumber>>
+               existing_snapshots,
            SequenceNumber earliest_write_conflict_snapshot,
            SnapshotChecker* snapshot_checker, JobContext* job_context,
            FlushReason flush_reason, LogBuffer* log_buffer,
@@ -104,6 +105,11 @@ class FlushJob {
   void ReportFlushInputSize(const autovector<MemTable*>& mems);
   void RecordFlushIOStats();
   Status WriteLevel0Table();
+  // Picks the user keys that split the flush into the key ranges of up to
+  // DBOptions::max_flush_subjobs L0 files, from a sample of the entries of
+  // the memtables. Leaves boundaries empty if the flush is not split.
+  void PickSubjobBoundaries(uint64_t total_data_size,
+                            std::vector<std::string>* boundaries);
 
   // Memtable Garbage Collection algorithm: a MemPurge takes the list
   // of immutable memtables and filters out (or "purge") the outdated bytes
@@ -160,7 +166,8 @@ class FlushJob {
   VersionSet* versions_;
   InstrumentedMutex* db_mutex_;
   std::atomic<bool>* shutting_down_;
-  std::vector<SequenceNumber> existing_snapshots_;
+  // Shared with the other jobs started under the same snapshots
+  std::shared_ptr<const std::vector<SequenceNumber>> existing_snapshots_;
   SequenceNumber earliest_write_conflict_snapshot_;
   SnapshotChecker* snapshot_checker_;
   JobContext* job_context_;
@@ -197,6 +204,9 @@ class FlushJob {
 
   // Variables below are set by PickMemTable():
   FileMetaData meta_;
+  // The L0 files of the other key ranges of a split flush, see
+  // DBOptions::max_flush_subjobs.
+  std::vector<FileMetaData> subjob_metas_;
   autovector<MemTable*> mems_;
   VersionEdit* edit_;
   Version* base_;
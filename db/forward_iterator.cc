@@ -5,7 +5,9 @@
 
 #include "db/forward_iterator.h"
 
+#include <algorithm>
 #include <limits>
+#include <list>
 #include <string>
 #include <utility>
 
@@ -39,12 +41,12 @@ class ForwardLevelIterator : public InternalIterator {
       bool allow_unprepared_value, uint8_t block_protection_bytes_per_key)
       : cfd_(cfd),
         read_options_(read_options),
-        files_(files),
+        files_(&files),
         valid_(false),
         file_index_(std::numeric_limits<uint32_t>::max()),
         file_iter_(nullptr),
         pinned_iters_mgr_(nullptr),
-        prefix_extractor_(prefix_extractor),
+        prefix_extractor_(&prefix_extractor),
         allow_unprepared_value_(allow_unprepared_value),
         block_protection_bytes_per_key_(block_protection_bytes_per_key) {
     status_.PermitUncheckedError();  // Allow uninitialized status through
@@ -59,8 +61,19 @@ class ForwardLevelIterator : public InternalIterator {
     }
   }
 
+  // Points the iterator to the files of its level in a super version
+  // replacing the one it was built from, which has the same files, without
+  // moving it
+  void SetSuperVersion(
+      const std::vector<FileMetaData*>& files,
+      const std::shared_ptr<const SliceTransform>& prefix_extractor) {
+    assert(files == *files_);
+    files_ = &files;
+    prefix_extractor_ = &prefix_extractor;
+  }
+
   void SetFileIndex(uint32_t file_index) {
-    assert(file_index < files_.size());
+    assert(file_index < files_->size());
     status_ = Status::OK();
     if (file_index != file_index_) {
       file_index_ = file_index;
@@ -68,7 +81,7 @@ class ForwardLevelIterator : public InternalIterator {
     }
   }
   void Reset() {
-    assert(file_index_ < files_.size());
+    assert(file_index_ < files_->size());
 
     // Reset current pointer
     if (pinned_iters_mgr_ && pinned_iters_mgr_->PinningEnabled()) {
@@ -81,9 +94,9 @@ class ForwardLevelIterator : public InternalIterator {
                                          kMaxSequenceNumber /* upper_bound */);
     file_iter_ = cfd_->table_cache()->NewIterator(
         read_options_, *(cfd_->soptions()), cfd_->internal_comparator(),
-        *files_[file_index_],
+        *(*files_)[file_index_],
         read_options_.ignore_range_deletions ? nullptr : &range_del_agg,
-        prefix_extractor_, /*table_reader_ptr=*/nullptr,
+        *prefix_extractor_, /*table_reader_ptr=*/nullptr,
         /*file_read_hist=*/nullptr, TableReaderCaller::kUserIterator,
         /*arena=*/nullptr, /*skip_filters=*/false, /*level=*/-1,
         /*max_file_size_for_l0_meta_pin=*/0,
@@ -147,7 +160,7 @@ class ForwardLevelIterator : public InternalIterator {
       if (valid_) {
         return;
       }
-      if (file_index_ + 1 >= files_.size()) {
+      if (file_index_ + 1 >= files_->size()) {
         valid_ = false;
         return;
       }
@@ -203,7 +216,7 @@ class ForwardLevelIterator : public InternalIterator {
  private:
   const ColumnFamilyData* const cfd_;
   const ReadOptions& read_options_;
-  const std::vector<FileMetaData*>& files_;
+  const std::vector<FileMetaData*>* files_;
 
   bool valid_;
   uint32_t file_index_;
@@ -211,7 +224,7 @@ class ForwardLevelIterator : public InternalIterator {
   InternalIterator* file_iter_;
   PinnedIteratorsManager* pinned_iters_mgr_;
   // Kept alive by ForwardIterator::sv_->mutable_cf_options
-  const std::shared_ptr<const SliceTransform>& prefix_extractor_;
+  const std::shared_ptr<const SliceTransform>* prefix_extractor_;
   const bool allow_unprepared_value_;
   const uint8_t block_protection_bytes_per_key_;
 };
@@ -554,13 +567,20 @@ void ForwardIterator::Next() {
 
     if (sv_ == nullptr) {
       RebuildIterators(true);
+      SeekInternal(old_key, false, false);
+      if (read_options_.async_io) {
+        SeekInternal(old_key, false, true);
+      }
+    } else if (!read_options_.async_io && immutable_status_.ok()) {
+      std::vector<InternalIterator*> iters_to_seek;
+      RenewIterators(&iters_to_seek);
+      SeekRenewedIterators(old_key, iters_to_seek);
     } else {
       RenewIterators();
-    }
-
-    SeekInternal(old_key, false, false);
-    if (read_options_.async_io) {
-      SeekInternal(old_key, false, true);
+      SeekInternal(old_key, false, false);
+      if (read_options_.async_io) {
+        SeekInternal(old_key, false, true);
+      }
     }
 
     if (!valid_ || key().compare(old_key) != 0) {
@@ -765,25 +785,52 @@ void ForwardIterator::RebuildIterators(bool refresh_sv) {
   }
 }
 
-void ForwardIterator::RenewIterators() {
+void ForwardIterator::RenewIterators(
+    std::vector<InternalIterator*>* iters_to_seek) {
   SuperVersion* svnew;
   assert(sv_);
   svnew = cfd_->GetReferencedSuperVersion(db_);
 
-  if (mutable_iter_ != nullptr) {
-    DeleteIterator(mutable_iter_, true /* is_arena */);
-  }
-  for (auto* m : imm_iters_) {
-    DeleteIterator(m, true /* is_arena */);
+  // The iterators of the memtables still in svnew are kept, including the
+  // one of the mutable memtable when it was switched to immutable. The
+  // latter may have missed the keys inserted since it was positioned.
+  std::vector<std::pair<const MemTable*, InternalIterator*>> old_mem_iters;
+  old_mem_iters.emplace_back(sv_->mem, mutable_iter_);
+  const std::list<MemTable*>& old_imm = sv_->imm->GetMemlist();
+  assert(old_imm.size() == imm_iters_.size());
+  auto imm_iter = imm_iters_.begin();
+  for (const MemTable* m : old_imm) {
+    old_mem_iters.emplace_back(m, *imm_iter++);
   }
   imm_iters_.clear();
-
   UnownedPtr<const SeqnoToTimeMapping> seqno_to_time_mapping =
       svnew->GetSeqnoToTimeMapping();
-  mutable_iter_ =
-      svnew->mem->NewIterator(read_options_, seqno_to_time_mapping, &arena_);
-  svnew->imm->AddIterators(read_options_, seqno_to_time_mapping, &imm_iters_,
-                           &arena_);
+  auto renew_mem_iter = [&](MemTable* m) {
+    for (size_t i = 0; i < old_mem_iters.size(); ++i) {
+      InternalIterator* iter = old_mem_iters[i].second;
+      if (old_mem_iters[i].first == m && iter != nullptr) {
+        old_mem_iters[i].second = nullptr;
+        if (i == 0 && iters_to_seek != nullptr) {
+          iters_to_seek->push_back(iter);
+        }
+        return iter;
+      }
+    }
+    InternalIterator* iter =
+        m->NewIterator(read_options_, seqno_to_time_mapping, &arena_);
+    if (iters_to_seek != nullptr) {
+      iters_to_seek->push_back(iter);
+    }
+    return iter;
+  };
+  mutable_iter_ = renew_mem_iter(svnew->mem);
+  for (MemTable* m : svnew->imm->GetMemlist()) {
+    imm_iters_.push_back(renew_mem_iter(m));
+  }
+  for (const auto& mem_iter : old_mem_iters) {
+    DeleteIterator(mem_iter.second, true /* is_arena */);
+  }
+
   ReadRangeDelAggregator range_del_agg(&cfd_->internal_comparator(),
                                        kMaxSequenceNumber /* upper_bound */);
   if (!read_options_.ignore_range_deletions) {
@@ -838,6 +885,9 @@ void ForwardIterator::RenewIterators() {
         /*smallest_compaction_key=*/nullptr,
         /*largest_compaction_key=*/nullptr, allow_unprepared_value_,
         svnew->mutable_cf_options.block_protection_bytes_per_key));
+    if (iters_to_seek != nullptr) {
+      iters_to_seek->push_back(l0_iters_new.back());
+    }
   }
 
   for (auto* f : l0_iters_) {
@@ -846,11 +896,33 @@ void ForwardIterator::RenewIterators() {
   l0_iters_.clear();
   l0_iters_ = l0_iters_new;
 
+  // The iterators of the levels whose files did not change are kept
+  std::vector<ForwardLevelIterator*> level_iters_new;
+  level_iters_new.reserve(vstorage_new->num_levels() - 1);
+  for (int32_t level = 1; level < vstorage_new->num_levels(); ++level) {
+    const auto& level_files_new = vstorage_new->LevelFiles(level);
+    if (static_cast<size_t>(level) <= level_iters_.size() &&
+        vstorage->LevelFiles(level) == level_files_new) {
+      ForwardLevelIterator* level_iter = level_iters_[level - 1];
+      if (level_iter != nullptr) {
+        level_iter->SetSuperVersion(level_files_new,
+                                    svnew->mutable_cf_options.prefix_extractor);
+        TEST_SYNC_POINT_CALLBACK("ForwardIterator::RenewIterators:KeepLevel",
+                                 this);
+      }
+      level_iters_new.push_back(level_iter);
+      level_iters_[level - 1] = nullptr;
+      continue;
+    }
+    level_iters_new.push_back(NewLevelIterator(vstorage_new, svnew, level));
+    if (iters_to_seek != nullptr && level_iters_new.back() != nullptr) {
+      iters_to_seek->push_back(level_iters_new.back());
+    }
+  }
   for (auto* l : level_iters_) {
     DeleteIterator(l);
   }
-  level_iters_.clear();
-  BuildLevelIterators(vstorage_new, svnew);
+  level_iters_ = std::move(level_iters_new);
   current_ = nullptr;
   is_prev_set_ = false;
   SVCleanup();
@@ -868,23 +940,82 @@ void ForwardIterator::BuildLevelIterators(const VersionStorageInfo* vstorage,
                                           SuperVersion* sv) {
   level_iters_.reserve(vstorage->num_levels() - 1);
   for (int32_t level = 1; level < vstorage->num_levels(); ++level) {
-    const auto& level_files = vstorage->LevelFiles(level);
-    if ((level_files.empty()) ||
-        ((read_options_.iterate_upper_bound != nullptr) &&
-         (user_comparator_->Compare(*read_options_.iterate_upper_bound,
-                                    level_files[0]->smallest.user_key()) <
-          0))) {
-      level_iters_.push_back(nullptr);
-      if (!level_files.empty()) {
-        has_iter_trimmed_for_upper_bound_ = true;
+    level_iters_.push_back(NewLevelIterator(vstorage, sv, level));
+  }
+}
+
+ForwardLevelIterator* ForwardIterator::NewLevelIterator(
+    const VersionStorageInfo* vstorage, SuperVersion* sv, int level) {
+  const auto& level_files = vstorage->LevelFiles(level);
+  if ((level_files.empty()) ||
+      ((read_options_.iterate_upper_bound != nullptr) &&
+       (user_comparator_->Compare(*read_options_.iterate_upper_bound,
+                                  level_files[0]->smallest.user_key()) < 0))) {
+    if (!level_files.empty()) {
+      has_iter_trimmed_for_upper_bound_ = true;
+    }
+    return nullptr;
+  }
+  return new ForwardLevelIterator(
+      cfd_, read_options_, level_files, sv->mutable_cf_options.prefix_extractor,
+      allow_unprepared_value_,
+      sv->mutable_cf_options.block_protection_bytes_per_key);
+}
+
+void ForwardIterator::SeekRenewedIterators(
+    const Slice& internal_key,
+    const std::vector<InternalIterator*>& iters_to_seek) {
+  // The other children were at their first key at or after the current key,
+  // internal_key, or behind it when a seek went past all their keys. Being
+  // immutable, they need no seek.
+  auto needs_seek = [&iters_to_seek](InternalIterator* iter) {
+    return std::find(iters_to_seek.begin(), iters_to_seek.end(), iter) !=
+           iters_to_seek.end();
+  };
+  const InternalKeyComparator& icmp = cfd_->internal_comparator();
+  mutable_iter_->Seek(internal_key);
+  immutable_status_ = Status::OK();
+  {
+    auto tmp = MinIterHeap(MinIterComparator(&icmp));
+    immutable_min_heap_.swap(tmp);
+  }
+  auto add_immutable_iter = [&](InternalIterator* iter) {
+    if (iter == nullptr) {
+      return;
+    }
+    if (needs_seek(iter)) {
+      iter->Seek(internal_key);
+    }
+    if (!iter->status().ok()) {
+      immutable_status_ = iter->status();
+    } else if (iter->Valid() && !IsOverUpperBound(iter->key()) &&
+               icmp.Compare(iter->key(), internal_key) >= 0) {
+      immutable_min_heap_.push(iter);
+    }
+  };
+  for (auto* m : imm_iters_) {
+    add_immutable_iter(m);
+  }
+  for (auto* l0 : l0_iters_) {
+    add_immutable_iter(l0);
+  }
+  const VersionStorageInfo* vstorage = sv_->current->storage_info();
+  for (int32_t level = 1; level < vstorage->num_levels(); ++level) {
+    ForwardLevelIterator* level_iter = level_iters_[level - 1];
+    if (level_iter != nullptr && needs_seek(level_iter)) {
+      const std::vector<FileMetaData*>& level_files =
+          vstorage->LevelFiles(level);
+      uint32_t f_idx =
+          FindFileInRange(level_files, internal_key, 0,
+                          static_cast<uint32_t>(level_files.size()));
+      if (f_idx >= level_files.size()) {
+        continue;
       }
-    } else {
-      level_iters_.push_back(new ForwardLevelIterator(
-          cfd_, read_options_, level_files,
-          sv->mutable_cf_options.prefix_extractor, allow_unprepared_value_,
-          sv->mutable_cf_options.block_protection_bytes_per_key));
+      level_iter->SetFileIndex(f_idx);
     }
+    add_immutable_iter(level_iter);
   }
+  UpdateCurrent();
 }
 
 void ForwardIterator::ResetIncompleteIterators() {
@@ -97,9 +97,20 @@ class ForwardIterator : public InternalIterator {
   static void DeferredSVCleanup(void* arg);
 
   void RebuildIterators(bool refresh_sv);
-  void RenewIterators();
+  // Moves the children to the latest super version, keeping the iterators
+  // of the memtables and files still in it. If `iters_to_seek` is set, adds
+  // to it the children which SeekRenewedIterators() must seek.
+  void RenewIterators(std::vector<InternalIterator*>* iters_to_seek = nullptr);
   void BuildLevelIterators(const VersionStorageInfo* vstorage,
                            SuperVersion* sv);
+  ForwardLevelIterator* NewLevelIterator(const VersionStorageInfo* vstorage,
+                                         SuperVersion* sv, int level);
+  // Positions the children after RenewIterators() as
+  // SeekInternal(internal_key) would, where internal_key is the current key,
+  // seeking only the mutable memtable and `iters_to_seek`
+  void SeekRenewedIterators(
+      const Slice& internal_key,
+      const std::vector<InternalIterator*>& iters_to_seek);
   void ResetIncompleteIterators();
   void SeekInternal(const Slice& internal_key, bool seek_to_first,
                     bool seek_after_async_io);
@@ -24,6 +24,8 @@
 #include "db/column_family.h"
 #include "db/db_impl/db_impl.h"
 #include "db/write_stall_stats.h"
+#include "monitoring/iostats_context_imp.h"
+#include "monitoring/perf_context_imp.h"
 #include "port/port.h"
 #include "rocksdb/system_clock.h"
 #include "rocksdb/table.h"
@@ -281,6 +283,10 @@ static const std::string is_file_deletions_enabled =
 static const std::string num_snapshots = "num-snapshots";
 static const std::string oldest_snapshot_time = "oldest-snapshot-time";
 static const std::string oldest_snapshot_sequence = "oldest-snapshot-sequence";
+static const std::string last_applied_replication_sequence =
+    "last-applied-replication-sequence";
+static const std::string last_applied_replication_time =
+    "last-applied-replication-time";
 static const std::string num_live_versions = "num-live-versions";
 static const std::string current_version_number =
     "current-super-version-number";
@@ -321,6 +327,8 @@ static const std::string live_blob_file_garbage_size =
 static const std::string blob_cache_capacity = "blob-cache-capacity";
 static const std::string blob_cache_usage = "blob-cache-usage";
 static const std::string blob_cache_pinned_usage = "blob-cache-pinned-usage";
+static const std::string read_heat_map = "read-heat-map";
+static const std::string iterators_mem_usage = "iterators-mem-usage";
 
 const std::string DB::Properties::kNumFilesAtLevelPrefix =
     rocksdb_prefix + num_files_at_level_prefix;
@@ -383,6 +391,10 @@ const std::string DB::Properties::kOldestSnapshotTime =
     rocksdb_prefix + oldest_snapshot_time;
 const std::string DB::Properties::kOldestSnapshotSequence =
     rocksdb_prefix + oldest_snapshot_sequence;
+const std::string DB::Properties::kLastAppliedReplicationSequence =
+    rocksdb_prefix + last_applied_replication_sequence;
+const std::string DB::Properties::kLastAppliedReplicationTime =
+    rocksdb_prefix + last_applied_replication_time;
 const std::string DB::Properties::kNumLiveVersions =
     rocksdb_prefix + num_live_versions;
 const std::string DB::Properties::kCurrentSuperVersionNumber =
@@ -439,6 +451,9 @@ const std::string DB::Properties::kBlobCacheUsage =
     rocksdb_prefix + blob_cache_usage;
 const std::string DB::Properties::kBlobCachePinnedUsage =
     rocksdb_prefix + blob_cache_pinned_usage;
+const std::string DB::Properties::kReadHeatMap = rocksdb_prefix + read_heat_map;
+const std::string DB::Properties::kIteratorsMemUsage =
+    rocksdb_prefix + iterators_mem_usage;
 
 const std::string InternalStats::kPeriodicCFStats =
     DB::Properties::kCFStats + ".periodic";
@@ -546,6 +561,12 @@ const UnorderedMap<std::string, DBPropertyInfo>
         {DB::Properties::kOldestSnapshotSequence,
          {false, nullptr, &InternalStats::HandleOldestSnapshotSequence, nullptr,
           nullptr}},
+        {DB::Properties::kLastAppliedReplicationSequence,
+         {false, nullptr, nullptr, nullptr,
+          &DBImpl::GetPropertyHandleLastAppliedReplicationSequence}},
+        {DB::Properties::kLastAppliedReplicationTime,
+         {false, nullptr, &InternalStats::HandleLastAppliedReplicationTime,
+          nullptr, nullptr}},
         {DB::Properties::kNumLiveVersions,
          {false, nullptr, &InternalStats::HandleNumLiveVersions, nullptr,
           nullptr}},
@@ -631,6 +652,12 @@ const UnorderedMap<std::string, DBPropertyInfo>
         {DB::Properties::kBlobCachePinnedUsage,
          {false, nullptr, &InternalStats::HandleBlobCachePinnedUsage, nullptr,
           nullptr}},
+        {DB::Properties::kReadHeatMap,
+         {false, &InternalStats::HandleReadHeatMap, nullptr,
+          &InternalStats::HandleReadHeatMapMap, nullptr}},
+        {DB::Properties::kIteratorsMemUsage,
+         {true, nullptr, &InternalStats::HandleIteratorsMemUsage, nullptr,
+          nullptr}},
 };
 
 InternalStats::InternalStats(int num_levels, SystemClock* clock,
@@ -640,7 +667,7 @@ InternalStats::InternalStats(int num_levels, SystemClock* clock,
       cf_stats_count_{},
       comp_stats_(num_levels),
       comp_stats_by_pri_(Env::Priority::TOTAL),
-      file_read_latency_(num_levels),
+      file_read_latency_(new std::atomic<HistogramImpl*>[num_levels]()),
       has_cf_change_since_dump_(true),
       bg_error_count_(0),
       number_levels_(num_levels),
@@ -660,6 +687,62 @@ InternalStats::InternalStats(int num_levels, SystemClock* clock,
   }
 }
 
+InternalStats::~InternalStats() {
+  for (int level = 0; level < number_levels_; level++) {
+    delete file_read_latency_[level].load(std::memory_order_relaxed);
+  }
+}
+
+HistogramImpl* InternalStats::NewFileReadHist(int level) {
+  assert(level >= 0 && level < number_levels_);
+  HistogramImpl* expected = nullptr;
+  auto h = std::make_unique<HistogramImpl>();
+  if (file_read_latency_[level].compare_exchange_strong(
+          expected, h.get(), std::memory_order_acq_rel)) {
+    return h.release();
+  }
+  // Another thread allocated it first
+  return expected;
+}
+
+void CompactionStageTimer::Start() {
+  start_file_read_nanos_ = IOSTATS(read_nanos);
+  start_block_decompress_nanos_ = perf_context.block_decompress_time;
+  start_block_checksum_nanos_ = perf_context.block_checksum_time;
+  start_block_compress_nanos_ = perf_context.block_compress_time;
+  start_compaction_filter_nanos_ = perf_context.compaction_filter_time;
+  start_merge_operator_nanos_ = perf_context.merge_operator_time_nanos;
+  start_cloud_request_nanos_ = perf_context.cloud_request_nanos;
+}
+
+void CompactionStageTimer::AddTo(CompactionJobStats* stats) const {
+  assert(stats);
+  stats->file_read_nanos += IOSTATS(read_nanos) - start_file_read_nanos_;
+  stats->block_decompress_nanos +=
+      perf_context.block_decompress_time - start_block_decompress_nanos_;
+  stats->block_checksum_nanos +=
+      perf_context.block_checksum_time - start_block_checksum_nanos_;
+  stats->block_compress_nanos +=
+      perf_context.block_compress_time - start_block_compress_nanos_;
+  stats->compaction_filter_nanos +=
+      perf_context.compaction_filter_time - start_compaction_filter_nanos_;
+  stats->merge_operator_nanos +=
+      perf_context.merge_operator_time_nanos - start_merge_operator_nanos_;
+  stats->cloud_request_nanos +=
+      perf_context.cloud_request_nanos - start_cloud_request_nanos_;
+}
+
+void InternalStats::AddCompactionStageStats(const CompactionJobStats& stats) {
+  AddCFStats(COMPACTION_FILE_READ_NANOS, stats.file_read_nanos);
+  AddCFStats(COMPACTION_BLOCK_DECOMPRESS_NANOS, stats.block_decompress_nanos);
+  AddCFStats(COMPACTION_BLOCK_CHECKSUM_NANOS, stats.block_checksum_nanos);
+  AddCFStats(COMPACTION_FILTER_NANOS, stats.compaction_filter_nanos);
+  AddCFStats(COMPACTION_MERGE_OPERATOR_NANOS, stats.merge_operator_nanos);
+  AddCFStats(COMPACTION_BLOCK_COMPRESS_NANOS, stats.block_compress_nanos);
+  AddCFStats(COMPACTION_FILE_WRITE_NANOS, stats.file_write_nanos);
+  AddCFStats(COMPACTION_CLOUD_REQUEST_NANOS, stats.cloud_request_nanos);
+}
+
 void InternalStats::TEST_GetCacheEntryRoleStats(CacheEntryRoleStats* stats,
                                                 bool foreground) {
   CollectCacheEntryStats(foreground);
@@ -887,6 +970,73 @@ bool InternalStats::HandleBlobStats(std::string* value, Slice /*suffix*/) {
   return true;
 }
 
+namespace {
+struct FileReadHeat {
+  const FileMetaData* file;
+  int level;
+};
+
+// The live SST files of `vstorage`, by smallest user key
+std::vector<FileReadHeat> GetFileReadHeat(const VersionStorageInfo& vstorage,
+                                          const Comparator* ucmp) {
+  std::vector<FileReadHeat> heat;
+  for (int level = 0; level < vstorage.num_levels(); level++) {
+    for (const auto* f : vstorage.LevelFiles(level)) {
+      heat.push_back({f, level});
+    }
+  }
+  std::sort(heat.begin(), heat.end(),
+            [ucmp](const FileReadHeat& a, const FileReadHeat& b) {
+              int cmp = ucmp->CompareWithoutTimestamp(
+                  a.file->smallest.user_key(), b.file->smallest.user_key());
+              return cmp != 0 ? cmp < 0 : a.level < b.level;
+            });
+  return heat;
+}
+}  // anonymous namespace
+
+bool InternalStats::HandleReadHeatMap(std::string* value, Slice /*suffix*/) {
+  const auto* vstorage = cfd_->current()->storage_info();
+  std::ostringstream oss;
+  oss << "file level temperature reads seeks window_reads window_seeks "
+         "smallest_key largest_key\n";
+  for (const auto& h : GetFileReadHeat(*vstorage, cfd_->user_comparator())) {
+    const FileSampledStats& stats = h.file->stats;
+    oss << h.file->fd.GetNumber() << ' ' << h.level << ' '
+        << static_cast<int>(h.file->temperature) << ' '
+        << stats.num_reads_sampled.load(std::memory_order_relaxed) << ' '
+        << stats.num_seeks_sampled.load(std::memory_order_relaxed) << ' '
+        << stats.num_reads_sampled_last_window.load(std::memory_order_relaxed)
+        << ' '
+        << stats.num_seeks_sampled_last_window.load(std::memory_order_relaxed)
+        << ' ' << h.file->smallest.user_key().ToString(true) << ' '
+        << h.file->largest.user_key().ToString(true) << '\n';
+  }
+  value->append(oss.str());
+  return true;
+}
+
+bool InternalStats::HandleReadHeatMapMap(
+    std::map<std::string, std::string>* values, Slice /*suffix*/) {
+  const auto* vstorage = cfd_->current()->storage_info();
+  for (const auto& h : GetFileReadHeat(*vstorage, cfd_->user_comparator())) {
+    const FileSampledStats& stats = h.file->stats;
+    std::ostringstream oss;
+    oss << "level=" << h.level
+        << ";temperature=" << static_cast<int>(h.file->temperature)
+        << ";smallest_key=" << h.file->smallest.user_key().ToString(true)
+        << ";largest_key=" << h.file->largest.user_key().ToString(true)
+        << ";reads=" << stats.num_reads_sampled.load(std::memory_order_relaxed)
+        << ";seeks=" << stats.num_seeks_sampled.load(std::memory_order_relaxed)
+        << ";window_reads="
+        << stats.num_reads_sampled_last_window.load(std::memory_order_relaxed)
+        << ";window_seeks="
+        << stats.num_seeks_sampled_last_window.load(std::memory_order_relaxed);
+    (*values)[std::to_string(h.file->fd.GetNumber())] = oss.str();
+  }
+  return true;
+}
+
 bool InternalStats::HandleTotalBlobFileSize(uint64_t* value, DBImpl* /*db*/,
                                             Version* /*version*/) {
   assert(value);
@@ -1076,12 +1226,24 @@ bool InternalStats::HandleCFStats(std::string* value, Slice /*suffix*/) {
 
 bool InternalStats::HandleCFStatsPeriodic(std::string* value,
                                           Slice /*suffix*/) {
+  // Each periodic dump ends a window of the read heat map
+  const auto* vstorage = cfd_->current()->storage_info();
+  for (int level = 0; level < vstorage->num_levels(); level++) {
+    for (const auto* f : vstorage->LevelFiles(level)) {
+      f->stats.RollWindow();
+    }
+  }
+
   bool has_change = has_cf_change_since_dump_;
   if (!has_change) {
     // If file histogram changes, there is activity in this period too.
     uint64_t new_histogram_num = 0;
     for (int level = 0; level < number_levels_; level++) {
-      new_histogram_num += file_read_latency_[level].num();
+      HistogramImpl* h =
+          file_read_latency_[level].load(std::memory_order_acquire);
+      if (h != nullptr) {
+        new_histogram_num += h->num();
+      }
     }
     new_histogram_num += blob_file_read_latency_.num();
     if (new_histogram_num != last_histogram_num) {
@@ -1364,6 +1526,13 @@ bool InternalStats::HandleOldestSnapshotTime(uint64_t* value, DBImpl* db,
   return true;
 }
 
+bool InternalStats::HandleLastAppliedReplicationTime(uint64_t* value,
+                                                     DBImpl* db,
+                                                     Version* /*version*/) {
+  *value = db->last_applied_replication_time();
+  return true;
+}
+
 bool InternalStats::HandleOldestSnapshotSequence(uint64_t* value, DBImpl* db,
                                                  Version* /*version*/) {
   *value = static_cast<uint64_t>(db->snapshots().GetOldestSnapshotSequence());
@@ -1544,6 +1713,12 @@ bool InternalStats::HandleBlockCachePinnedUsage(uint64_t* value, DBImpl* /*db*/,
   return false;
 }
 
+bool InternalStats::HandleIteratorsMemUsage(uint64_t* value, DBImpl* db,
+                                            Version* /*version*/) {
+  *value = db->GetIteratorsMemUsage();
+  return true;
+}
+
 void InternalStats::DumpDBMapStats(
     std::map<std::string, std::string>* db_stats) {
   for (int i = 0; i < static_cast<int>(kIntStatsNumMax); ++i) {
@@ -2040,6 +2215,21 @@ void InternalStats::DumpCFStatsNoFileHistogram(bool is_periodic,
            ingest_keys_addfile, interval_ingest_keys_addfile);
   value->append(buf);
 
+  constexpr double kNanosInSec = 1e9;
+  snprintf(buf, sizeof(buf),
+           "Flush and compaction stages(secs): file read %.3f, "
+           "decompress %.3f, checksum %.3f, filter %.3f, merge %.3f, "
+           "compress %.3f, file write %.3f, cloud %.3f\n",
+           cf_stats_value_[COMPACTION_FILE_READ_NANOS] / kNanosInSec,
+           cf_stats_value_[COMPACTION_BLOCK_DECOMPRESS_NANOS] / kNanosInSec,
+           cf_stats_value_[COMPACTION_BLOCK_CHECKSUM_NANOS] / kNanosInSec,
+           cf_stats_value_[COMPACTION_FILTER_NANOS] / kNanosInSec,
+           cf_stats_value_[COMPACTION_MERGE_OPERATOR_NANOS] / kNanosInSec,
+           cf_stats_value_[COMPACTION_BLOCK_COMPRESS_NANOS] / kNanosInSec,
+           cf_stats_value_[COMPACTION_FILE_WRITE_NANOS] / kNanosInSec,
+           cf_stats_value_[COMPACTION_CLOUD_REQUEST_NANOS] / kNanosInSec);
+  value->append(buf);
+
   // Compact
   uint64_t compact_bytes_read = 0;
   uint64_t compact_bytes_write = 0;
@@ -2135,9 +2325,11 @@ void InternalStats::DumpCFFileHistogram(std::string* value) {
       << "] **\n";
 
   for (int level = 0; level < number_levels_; level++) {
-    if (!file_read_latency_[level].Empty()) {
+    HistogramImpl* h =
+        file_read_latency_[level].load(std::memory_order_acquire);
+    if (h != nullptr && !h->Empty()) {
       oss << "** Level " << level << " read latency histogram (micros):\n"
-          << file_read_latency_[level].ToString() << '\n';
+          << h->ToString() << '\n';
     }
   }
 
@@ -99,6 +99,26 @@ struct DBStatInfo {
   std::string property_name;
 };
 
+// Measures the time by stage of a flush or compaction on the current thread,
+// from the perf and IO stats contexts, so it needs a perf level of at least
+// kEnableTime.
+class CompactionStageTimer {
+ public:
+  // Starts measuring from the current counters of the thread
+  void Start();
+  // Adds the time by stage since Start() to `stats`
+  void AddTo(CompactionJobStats* stats) const;
+
+ private:
+  uint64_t start_file_read_nanos_ = 0;
+  uint64_t start_block_decompress_nanos_ = 0;
+  uint64_t start_block_checksum_nanos_ = 0;
+  uint64_t start_block_compress_nanos_ = 0;
+  uint64_t start_compaction_filter_nanos_ = 0;
+  uint64_t start_merge_operator_nanos_ = 0;
+  uint64_t start_cloud_request_nanos_ = 0;
+};
+
 class InternalStats {
  public:
   static const std::map<LevelStatType, LevelStat> compaction_level_stats;
@@ -123,6 +143,15 @@ class InternalStats {
     INGESTED_NUM_FILES_TOTAL,
     INGESTED_LEVEL0_NUM_FILES_TOTAL,
     INGESTED_NUM_KEYS_TOTAL,
+    // Time by stage of flushes and compactions, with report_bg_io_stats
+    COMPACTION_FILE_READ_NANOS,
+    COMPACTION_BLOCK_DECOMPRESS_NANOS,
+    COMPACTION_BLOCK_CHECKSUM_NANOS,
+    COMPACTION_FILTER_NANOS,
+    COMPACTION_MERGE_OPERATOR_NANOS,
+    COMPACTION_BLOCK_COMPRESS_NANOS,
+    COMPACTION_FILE_WRITE_NANOS,
+    COMPACTION_CLOUD_REQUEST_NANOS,
     INTERNAL_CF_STATS_ENUM_MAX,
   };
 
@@ -152,6 +181,7 @@ class InternalStats {
   static const std::map<InternalDBStatsType, DBStatInfo> db_stats_type_to_info;
 
   InternalStats(int num_levels, SystemClock* clock, ColumnFamilyData* cfd);
+  ~InternalStats();
 
   // Per level compaction stats
   struct CompactionOutputsStats {
@@ -514,8 +544,12 @@ class InternalStats {
       comp_stat.Clear();
     }
     per_key_placement_comp_stats_.Clear();
-    for (auto& h : file_read_latency_) {
-      h.Clear();
+    for (int level = 0; level < number_levels_; level++) {
+      HistogramImpl* h =
+          file_read_latency_[level].load(std::memory_order_acquire);
+      if (h != nullptr) {
+        h->Clear();
+      }
     }
     blob_file_read_latency_.Clear();
     cf_stats_snapshot_.Clear();
@@ -550,6 +584,9 @@ class InternalStats {
     ++cf_stats_count_[type];
   }
 
+  // Adds the time by stage of a flush or compaction
+  void AddCompactionStageStats(const CompactionJobStats& stats);
+
   void AddDBStats(InternalDBStatsType type, uint64_t value,
                   bool concurrent = false) {
     auto& v = db_stats_[type];
@@ -565,8 +602,12 @@ class InternalStats {
     return db_stats_[type].load(std::memory_order_relaxed);
   }
 
+  // The histogram of a level is allocated when its first table is opened, as
+  // a DB with thousands of column families reads few of their levels.
   HistogramImpl* GetFileReadHist(int level) {
-    return &file_read_latency_[level];
+    HistogramImpl* h =
+        file_read_latency_[level].load(std::memory_order_acquire);
+    return h != nullptr ? h : NewFileReadHist(level);
   }
 
   HistogramImpl* GetBlobFileReadHist() { return &blob_file_read_latency_; }
@@ -597,6 +638,11 @@ class InternalStats {
 
   const uint64_t* TEST_GetCFStatsValue() const { return cf_stats_value_; }
 
+  bool TEST_HasFileReadHist(int level) const {
+    return file_read_latency_[level].load(std::memory_order_acquire) !=
+           nullptr;
+  }
+
   const std::vector<CompactionStats>& TEST_GetCompactionStats() const {
     return comp_stats_;
   }
@@ -635,6 +681,8 @@ class InternalStats {
   // dump the status.
   void DumpCFFileHistogram(std::string* value);
 
+  HistogramImpl* NewFileReadHist(int level);
+
   void DumpCFMapStatsWriteStall(std::map<std::string, std::string>* value);
   void DumpCFStatsWriteStall(std::string* value,
                              uint64_t* total_stall_count = nullptr);
@@ -658,7 +706,8 @@ class InternalStats {
   std::vector<CompactionStats> comp_stats_;
   std::vector<CompactionStats> comp_stats_by_pri_;
   CompactionStats per_key_placement_comp_stats_;
-  std::vector<HistogramImpl> file_read_latency_;
+  // Per level, nullptr until GetFileReadHist() is first called for it
+  std::unique_ptr<std::atomic<HistogramImpl*>[]> file_read_latency_;
   HistogramImpl blob_file_read_latency_;
   bool has_cf_change_since_dump_;
   // How many periods of no change since the last time stats are dumped for
@@ -809,6 +858,8 @@ class InternalStats {
   bool HandleEstimateNumKeys(uint64_t* value, DBImpl* db, Version* version);
   bool HandleNumSnapshots(uint64_t* value, DBImpl* db, Version* version);
   bool HandleOldestSnapshotTime(uint64_t* value, DBImpl* db, Version* version);
+  bool HandleLastAppliedReplicationTime(uint64_t* value, DBImpl* db,
+                                        Version* version);
   bool HandleOldestSnapshotSequence(uint64_t* value, DBImpl* db,
                                     Version* version);
   bool HandleNumLiveVersions(uint64_t* value, DBImpl* db, Version* version);
@@ -853,6 +904,9 @@ class InternalStats {
   bool HandleLiveSstFilesSizeAtTemperature(std::string* value, Slice suffix);
   bool HandleNumBlobFiles(uint64_t* value, DBImpl* db, Version* version);
   bool HandleBlobStats(std::string* value, Slice suffix);
+  bool HandleReadHeatMap(std::string* value, Slice suffix);
+  bool HandleReadHeatMapMap(std::map<std::string, std::string>* values,
+                            Slice suffix);
   bool HandleTotalBlobFileSize(uint64_t* value, DBImpl* db, Version* version);
   bool HandleLiveBlobFileSize(uint64_t* value, DBImpl* db, Version* version);
   bool HandleLiveBlobFileGarbageSize(uint64_t* value, DBImpl* db,
@@ -861,6 +915,7 @@ class InternalStats {
   bool HandleBlobCacheUsage(uint64_t* value, DBImpl* db, Version* version);
   bool HandleBlobCachePinnedUsage(uint64_t* value, DBImpl* db,
                                   Version* version);
+  bool HandleIteratorsMemUsage(uint64_t* value, DBImpl* db, Version* version);
 
   // Total number of background errors encountered. Every time a flush task
   // or compaction task fails, this counter is incremented. The failure can
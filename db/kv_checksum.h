@@ -30,6 +30,7 @@
 
 #pragma once
 
+#include <array>
 #include <type_traits>
 
 #include "db/dbformat.h"
@@ -87,6 +88,21 @@ class ProtectionInfo {
   static const uint64_t kSeedS = 0x77A00858DDD37F21;
   static const uint64_t kSeedC = 0x4A2AB5CBD26F542C;
 
+  // The hash of op_type with kSeedO. There are few op types and each
+  // protected entry hashes one, so the hashes are computed once.
+  static T HashOpType(ValueType op_type) {
+    static const std::array<T, 256> kHashes = [] {
+      std::array<T, 256> hashes{};
+      for (size_t i = 0; i < hashes.size(); ++i) {
+        ValueType type = static_cast<ValueType>(i);
+        hashes[i] = static_cast<T>(
+            NPHash64(reinterpret_cast<char*>(&type), sizeof(type), kSeedO));
+      }
+      return hashes;
+    }();
+    return kHashes[static_cast<unsigned char>(op_type)];
+  }
+
   ProtectionInfo(T val) : val_(val) {
     static_assert(sizeof(ProtectionInfo<T>) == sizeof(T), "");
   }
@@ -300,9 +316,7 @@ ProtectionInfoKVO<T> ProtectionInfo<T>::ProtectKVO(const Slice& key,
   val = val ^ static_cast<T>(GetSliceNPHash64(key, ProtectionInfo<T>::kSeedK));
   val =
       val ^ static_cast<T>(GetSliceNPHash64(value, ProtectionInfo<T>::kSeedV));
-  val = val ^
-        static_cast<T>(NPHash64(reinterpret_cast<char*>(&op_type),
-                                sizeof(op_type), ProtectionInfo<T>::kSeedO));
+  val = val ^ ProtectionInfo<T>::HashOpType(op_type);
   return ProtectionInfoKVO<T>(val);
 }
 
@@ -315,9 +329,7 @@ ProtectionInfoKVO<T> ProtectionInfo<T>::ProtectKVO(const SliceParts& key,
         static_cast<T>(GetSlicePartsNPHash64(key, ProtectionInfo<T>::kSeedK));
   val = val ^
         static_cast<T>(GetSlicePartsNPHash64(value, ProtectionInfo<T>::kSeedV));
-  val = val ^
-        static_cast<T>(NPHash64(reinterpret_cast<char*>(&op_type),
-                                sizeof(op_type), ProtectionInfo<T>::kSeedO));
+  val = val ^ ProtectionInfo<T>::HashOpType(op_type);
   return ProtectionInfoKVO<T>(val);
 }
 
@@ -378,12 +390,8 @@ template <typename T>
 void ProtectionInfoKVO<T>::UpdateO(ValueType old_op_type,
                                    ValueType new_op_type) {
   T val = GetVal();
-  val = val ^ static_cast<T>(NPHash64(reinterpret_cast<char*>(&old_op_type),
-                                      sizeof(old_op_type),
-                                      ProtectionInfo<T>::kSeedO));
-  val = val ^ static_cast<T>(NPHash64(reinterpret_cast<char*>(&new_op_type),
-                                      sizeof(new_op_type),
-                                      ProtectionInfo<T>::kSeedO));
+  val = val ^ ProtectionInfo<T>::HashOpType(old_op_type);
+  val = val ^ ProtectionInfo<T>::HashOpType(new_op_type);
   SetVal(val);
 }
 
@@ -395,9 +403,7 @@ ProtectionInfo<T> ProtectionInfoKVO<T>::StripKVO(const Slice& key,
   val = val ^ static_cast<T>(GetSliceNPHash64(key, ProtectionInfo<T>::kSeedK));
   val =
       val ^ static_cast<T>(GetSliceNPHash64(value, ProtectionInfo<T>::kSeedV));
-  val = val ^
-        static_cast<T>(NPHash64(reinterpret_cast<char*>(&op_type),
-                                sizeof(op_type), ProtectionInfo<T>::kSeedO));
+  val = val ^ ProtectionInfo<T>::HashOpType(op_type);
   return ProtectionInfo<T>(val);
 }
 
@@ -410,9 +416,7 @@ ProtectionInfo<T> ProtectionInfoKVO<T>::StripKVO(const SliceParts& key,
         static_cast<T>(GetSlicePartsNPHash64(key, ProtectionInfo<T>::kSeedK));
   val = val ^
         static_cast<T>(GetSlicePartsNPHash64(value, ProtectionInfo<T>::kSeedV));
-  val = val ^
-        static_cast<T>(NPHash64(reinterpret_cast<char*>(&op_type),
-                                sizeof(op_type), ProtectionInfo<T>::kSeedO));
+  val = val ^ ProtectionInfo<T>::HashOpType(op_type);
   return ProtectionInfo<T>(val);
 }
 
@@ -329,6 +329,20 @@ TEST_P(LogTest, ReadWriteWithTimestampSizeZeroTimestampIgnored) {
   ASSERT_EQ("EOF", Read());  // Make sure reads at eof work
 }
 
+TEST_P(LogTest, ReadWriteWithBodyCrc) {
+  const std::string msg = "header" + BigString("body", 1000);
+  Write(msg);
+  const size_t record_size = WrittenBytes();
+  RecordBodyCrc body_crc;
+  body_crc.prefix_size = 6;
+  body_crc.crc = crc32c::Value(msg.data() + 6, msg.size() - 6);
+  ASSERT_OK(writer_->AddRecord(WriteOptions(), Slice(msg), &body_crc));
+  ASSERT_EQ(2 * record_size, WrittenBytes());
+  ASSERT_EQ(msg, Read());
+  ASSERT_EQ(msg, Read());
+  ASSERT_EQ("EOF", Read());
+}
+
 TEST_P(LogTest, ManyBlocks) {
   for (int i = 0; i < 100000; i++) {
     Write(NumberString(i));
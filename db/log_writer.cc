@@ -73,7 +73,7 @@ IOStatus Writer::Close(const WriteOptions& write_options) {
 }
 
 IOStatus Writer::AddRecord(const WriteOptions& write_options,
-                           const Slice& slice) {
+                           const Slice& slice, const RecordBodyCrc* body_crc) {
   if (dest_->seen_error()) {
     return IOStatus::IOError("Seen error. Skip writing buffer.");
   }
@@ -161,7 +161,16 @@ IOStatus Writer::AddRecord(const WriteOptions& write_options,
         type = recycle_log_files_ ? kRecyclableMiddleType : kMiddleType;
       }
 
-      s = EmitPhysicalRecord(write_options, type, ptr, fragment_length);
+      if (begin && end && !compress_ && body_crc != nullptr) {
+        assert(body_crc->prefix_size <= fragment_length);
+        const uint32_t payload_crc = crc32c::Crc32cCombine(
+            crc32c::Value(ptr, body_crc->prefix_size), body_crc->crc,
+            fragment_length - body_crc->prefix_size);
+        s = EmitPhysicalRecord(write_options, type, ptr, fragment_length,
+                               &payload_crc);
+      } else {
+        s = EmitPhysicalRecord(write_options, type, ptr, fragment_length);
+      }
       ptr += fragment_length;
       left -= fragment_length;
       begin = false;
@@ -251,7 +260,8 @@ IOStatus Writer::MaybeAddUserDefinedTimestampSizeRecord(
 bool Writer::BufferIsEmpty() { return dest_->BufferIsEmpty(); }
 
 IOStatus Writer::EmitPhysicalRecord(const WriteOptions& write_options,
-                                    RecordType t, const char* ptr, size_t n) {
+                                    RecordType t, const char* ptr, size_t n,
+                                    const uint32_t* precomputed_payload_crc) {
   assert(n <= 0xffff);  // Must fit in two bytes
 
   size_t header_size;
@@ -283,7 +293,9 @@ IOStatus Writer::EmitPhysicalRecord(const WriteOptions& write_options,
   }
 
   // Compute the crc of the record type and the payload.
-  uint32_t payload_crc = crc32c::Value(ptr, n);
+  uint32_t payload_crc = precomputed_payload_crc != nullptr
+                             ? *precomputed_payload_crc
+                             : crc32c::Value(ptr, n);
   crc = crc32c::Crc32cCombine(crc, payload_crc, n);
   crc = crc32c::Mask(crc);  // Adjust for storage
   TEST_SYNC_POINT_CALLBACK("LogWriter::EmitPhysicalRecord:BeforeEncodeChecksum",
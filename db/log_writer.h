@@ -28,6 +28,14 @@ class WritableFileWriter;
 
 namespace log {
 
+// The crc32c of a record without its first prefix_size bytes, computed by the
+// caller of Writer::AddRecord before the lock that serializes the writes to
+// the log, while the prefix may still change.
+struct RecordBodyCrc {
+  size_t prefix_size = 0;
+  uint32_t crc = 0;
+};
+
 /**
  * Writer is a general purpose log stream writer. It provides an append-only
  * abstraction for writing data. The details of the how the data is written is
@@ -86,7 +94,11 @@ class Writer {
 
   ~Writer();
 
-  IOStatus AddRecord(const WriteOptions& write_options, const Slice& slice);
+  // If body_crc is not null, it is used to checksum the payload of the record
+  // when the record is written uncompressed as a single physical record, so
+  // that only the prefix is checksummed here.
+  IOStatus AddRecord(const WriteOptions& write_options, const Slice& slice,
+                     const RecordBodyCrc* body_crc = nullptr);
   IOStatus AddCompressionTypeRecord(const WriteOptions& write_options);
 
   // If there are column families in `cf_to_ts_sz` not included in
@@ -120,8 +132,10 @@ class Writer {
   // record type stored in the header.
   uint32_t type_crc_[kMaxRecordType + 1];
 
+  // payload_crc is the crc32c of the payload if it is not null.
   IOStatus EmitPhysicalRecord(const WriteOptions& write_options,
-                              RecordType type, const char* ptr, size_t length);
+                              RecordType type, const char* ptr, size_t length,
+                              const uint32_t* payload_crc = nullptr);
 
   // If true, it does not flush after each write. Instead it relies on the upper
   // layer to manually does the flush by calling ::WriteBuffer()
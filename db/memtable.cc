@@ -58,6 +58,8 @@ ImmutableMemTableOptions::ImmutableMemTableOptions(
       memtable_whole_key_filtering(
           mutable_cf_options.memtable_whole_key_filtering),
       inplace_update_support(ioptions.inplace_update_support),
+      concurrent_inplace_update(ioptions.inplace_update_support &&
+                                ioptions.allow_concurrent_memtable_write),
       inplace_update_num_locks(mutable_cf_options.inplace_update_num_locks),
       inplace_callback(ioptions.inplace_callback),
       max_successive_merges(mutable_cf_options.max_successive_merges),
@@ -617,13 +619,51 @@ FragmentedRangeTombstoneIterator* MemTable::NewRangeTombstoneIteratorInternal(
   if (!cache->initialized.load(std::memory_order_acquire)) {
     cache->reader_mutex.lock();
     if (!cache->tombstones) {
-      auto* unfragmented_iter = new MemTableIterator(
-          *this, read_options, nullptr /* seqno_to_time_mapping= */,
-          nullptr /* arena */, true /* use_range_del_table */);
-      cache->tombstones.reset(new FragmentedRangeTombstoneList(
-          std::unique_ptr<InternalIterator>(unfragmented_iter),
-          comparator_.comparator));
+      // Look for the latest earlier cache built, collecting the tombstones
+      // written since then
+      struct AddedTombstone {
+        Slice start_key;
+        Slice end_key;
+        SequenceNumber seq;
+      };
+      autovector<AddedTombstone, kMaxRangeTombstoneCacheChain> added;
+      added.push_back(
+          {cache->added_start_key, cache->added_end_key, cache->added_seq});
+      std::shared_ptr<FragmentedRangeTombstoneListCache> base = cache->prev;
+      while (base != nullptr &&
+             !base->initialized.load(std::memory_order_acquire)) {
+        std::shared_ptr<FragmentedRangeTombstoneListCache> next;
+        {
+          std::lock_guard<std::mutex> base_lock(base->reader_mutex);
+          if (base->initialized.load(std::memory_order_acquire)) {
+            break;
+          }
+          added.push_back(
+              {base->added_start_key, base->added_end_key, base->added_seq});
+          next = base->prev;
+        }
+        base = std::move(next);
+      }
+      if (base != nullptr) {
+        const Comparator* ucmp = comparator_.comparator.user_comparator();
+        std::unique_ptr<FragmentedRangeTombstoneList> tombstones;
+        const FragmentedRangeTombstoneList* from = base->tombstones.get();
+        for (auto it = added.rbegin(); it != added.rend(); ++it) {
+          tombstones = FragmentedRangeTombstoneList::CopyAndAdd(
+              *from, it->start_key, it->end_key, it->seq, ucmp);
+          from = tombstones.get();
+        }
+        cache->tombstones = std::move(tombstones);
+      } else {
+        auto* unfragmented_iter = new MemTableIterator(
+            *this, read_options, nullptr /* seqno_to_time_mapping= */,
+            nullptr /* arena */, true /* use_range_del_table */);
+        cache->tombstones.reset(new FragmentedRangeTombstoneList(
+            std::unique_ptr<InternalIterator>(unfragmented_iter),
+            comparator_.comparator));
+      }
       cache->initialized.store(true, std::memory_order_release);
+      cache->prev.reset();
     }
     cache->reader_mutex.unlock();
   }
@@ -739,12 +779,34 @@ Status MemTable::Add(SequenceNumber s, ValueType type,
                      const ProtectionInfoKVOS64* kv_prot_info,
                      bool allow_concurrent,
                      MemTablePostProcessInfo* post_process_info, void** hint) {
+  if (allow_concurrent && moptions_.concurrent_inplace_update &&
+      type != kTypeRangeDeletion) {
+    // Serialized with the in-place updates of the key, see Update()
+    WriteLock wl(GetLock(key));
+    if (IsSuperseded(key, s)) {
+      return Status::OK();
+    }
+    return AddImpl(s, type, key, value, kv_prot_info, allow_concurrent,
+                   post_process_info, hint);
+  }
+  return AddImpl(s, type, key, value, kv_prot_info, allow_concurrent,
+                 post_process_info, hint);
+}
+
+Status MemTable::AddImpl(SequenceNumber s, ValueType type,
+                         const Slice& key, /* user key */
+                         const Slice& value,
+                         const ProtectionInfoKVOS64* kv_prot_info,
+                         bool allow_concurrent,
+                         MemTablePostProcessInfo* post_process_info,
+                         void** hint) {
   // Format of an entry is concatenation of:
   //  key_size     : varint32 of internal_key.size()
   //  key bytes    : char[internal_key.size()]
   //  value_size   : varint32 of value.size()
   //  value bytes  : char[value.size()]
   //  checksum     : char[moptions_.protection_bytes_per_key]
+  //  version      : aligned uint64_t, with concurrent in-place updates only
   uint32_t key_size = static_cast<uint32_t>(key.size());
   uint32_t val_size = static_cast<uint32_t>(value.size());
   uint32_t internal_key_size = key_size + 8;
@@ -754,7 +816,10 @@ Status MemTable::Add(SequenceNumber s, ValueType type,
   char* buf = nullptr;
   std::unique_ptr<MemTableRep>& table =
       type == kTypeRangeDeletion ? range_del_table_ : table_;
-  KeyHandle handle = table->Allocate(encoded_len, &buf);
+  KeyHandle handle = table->Allocate(
+      encoded_len +
+          (moptions_.concurrent_inplace_update ? kEntryVersionBytes : 0),
+      &buf);
 
   char* p = EncodeVarint32(buf, internal_key_size);
   memcpy(p, key.data(), key_size);
@@ -765,11 +830,15 @@ Status MemTable::Add(SequenceNumber s, ValueType type,
   p += 8;
   p = EncodeVarint32(p, val_size);
   memcpy(p, value.data(), val_size);
+  Slice value_slice(p, val_size);
   assert((unsigned)(p + val_size - buf + moptions_.protection_bytes_per_key) ==
          (unsigned)encoded_len);
 
   UpdateEntryChecksum(kv_prot_info, key, value, type, s,
                       buf + encoded_len - moptions_.protection_bytes_per_key);
+  if (moptions_.concurrent_inplace_update) {
+    new (GetEntryVersion(buf + encoded_len)) std::atomic<uint64_t>(s << 1);
+  }
   Slice encoded(buf, encoded_len - moptions_.protection_bytes_per_key);
   if (kv_prot_info != nullptr) {
     TEST_SYNC_POINT_CALLBACK("MemTable::Add:Encoded", &encoded);
@@ -820,9 +889,10 @@ Status MemTable::Add(SequenceNumber s, ValueType type,
       bloom_filter_->Add(key_without_ts);
     }
 
-    // The first sequence number inserted into the memtable
-    assert(first_seqno_ == 0 || s >= first_seqno_);
-    if (first_seqno_ == 0) {
+    // The first sequence number inserted into the memtable. The inserts come
+    // in sequence order, except for the load of a memtable snapshot in key
+    // order, so it's the smallest one.
+    if (first_seqno_ == 0 || s < first_seqno_) {
       first_seqno_.store(s, std::memory_order_relaxed);
 
       if (earliest_seqno_ == kMaxSequenceNumber) {
@@ -879,6 +949,24 @@ Status MemTable::Add(SequenceNumber s, ValueType type,
       post_process_info->num_range_deletes++;
       range_del_mutex_.lock();
     }
+    if (ts_sz_ == 0 && !moptions_.inplace_update_support) {
+      // Let the next reader add this tombstone to the fragments of an earlier
+      // cache, unless there are already too many to add
+      std::shared_ptr<FragmentedRangeTombstoneListCache> old_cache =
+          std::atomic_load_explicit(cached_range_tombstone_.AccessAtCore(0),
+                                    std::memory_order_relaxed);
+      const int num_prev =
+          old_cache->initialized.load(std::memory_order_acquire)
+              ? 1
+              : old_cache->num_prev + 1;
+      if (num_prev <= kMaxRangeTombstoneCacheChain) {
+        new_cache->prev = std::move(old_cache);
+        new_cache->num_prev = num_prev;
+        new_cache->added_start_key = key_slice;
+        new_cache->added_end_key = value_slice;
+        new_cache->added_seq = s;
+      }
+    }
     for (size_t i = 0; i < size; ++i) {
       std::shared_ptr<FragmentedRangeTombstoneListCache>* local_cache_ref_ptr =
           cached_range_tombstone_.AccessAtCore(i);
@@ -927,6 +1015,7 @@ struct Saver {
   Logger* logger;
   Statistics* statistics;
   bool inplace_update_support;
+  bool concurrent_inplace_update;
   bool do_merge;
   SystemClock* clock;
 
@@ -941,6 +1030,35 @@ struct Saver {
     return true;
   }
 };
+
+// Reads the value of an entry that may be updated in-place, holding the read
+// lock of the key until destroyed, or as a copy with concurrent in-place
+// updates.
+class InPlaceValueReader {
+ public:
+  explicit InPlaceValueReader(const Saver* s) : s_(s) {
+    if (s_->inplace_update_support && !s_->concurrent_inplace_update) {
+      s_->mem->GetLock(s_->key->user_key())->ReadLock();
+    }
+  }
+
+  ~InPlaceValueReader() {
+    if (s_->inplace_update_support && !s_->concurrent_inplace_update) {
+      s_->mem->GetLock(s_->key->user_key())->ReadUnlock();
+    }
+  }
+
+  Slice Read(const char* value_ptr) {
+    if (s_->concurrent_inplace_update) {
+      return s_->mem->ReadInPlaceValue(value_ptr, &buf_);
+    }
+    return GetLengthPrefixedSlice(value_ptr);
+  }
+
+ private:
+  const Saver* s_;
+  std::string buf_;
+};
 }  // anonymous namespace
 
 static bool SaveValue(void* arg, const char* entry) {
@@ -999,6 +1117,12 @@ static bool SaveValue(void* arg, const char* entry) {
       return true;  // to continue to the next seq
     }
 
+    const bool use_memo = merge_context->ObserveEntry(seq);
+    if (use_memo) {
+      assert(s->do_merge && !s->inplace_update_support);
+      type = kTypeValue;
+    }
+
     if (s->seq == kMaxSequenceNumber) {
       s->seq = seq;
       if (s->seq > max_covering_tombstone_seq) {
@@ -1060,11 +1184,8 @@ static bool SaveValue(void* arg, const char* entry) {
           return false;
         }
 
-        if (s->inplace_update_support) {
-          s->mem->GetLock(s->key->user_key())->ReadLock();
-        }
-
-        Slice v = GetLengthPrefixedSlice(key_ptr + key_length);
+        InPlaceValueReader reader(s);
+        Slice v = reader.Read(key_ptr + key_length);
 
         *(s->status) = Status::OK();
 
@@ -1074,10 +1195,6 @@ static bool SaveValue(void* arg, const char* entry) {
           s->columns->SetPlainValue(v);
         }
 
-        if (s->inplace_update_support) {
-          s->mem->GetLock(s->key->user_key())->ReadUnlock();
-        }
-
         *(s->found_final_value) = true;
         *(s->is_blob_index) = true;
 
@@ -1085,11 +1202,9 @@ static bool SaveValue(void* arg, const char* entry) {
       }
       case kTypeValue:
       case kTypeValuePreferredSeqno: {
-        if (s->inplace_update_support) {
-          s->mem->GetLock(s->key->user_key())->ReadLock();
-        }
-
-        Slice v = GetLengthPrefixedSlice(key_ptr + key_length);
+        InPlaceValueReader reader(s);
+        Slice v = use_memo ? merge_context->memo_value
+                           : reader.Read(key_ptr + key_length);
 
         if (type == kTypeValuePreferredSeqno) {
           v = ParsePackedValueForValue(v);
@@ -1125,10 +1240,6 @@ static bool SaveValue(void* arg, const char* entry) {
           s->columns->SetPlainValue(v);
         }
 
-        if (s->inplace_update_support) {
-          s->mem->GetLock(s->key->user_key())->ReadUnlock();
-        }
-
         *(s->found_final_value) = true;
 
         if (s->is_blob_index != nullptr) {
@@ -1138,11 +1249,8 @@ static bool SaveValue(void* arg, const char* entry) {
         return false;
       }
       case kTypeWideColumnEntity: {
-        if (s->inplace_update_support) {
-          s->mem->GetLock(s->key->user_key())->ReadLock();
-        }
-
-        Slice v = GetLengthPrefixedSlice(key_ptr + key_length);
+        InPlaceValueReader reader(s);
+        Slice v = reader.Read(key_ptr + key_length);
 
         *(s->status) = Status::OK();
 
@@ -1183,10 +1291,6 @@ static bool SaveValue(void* arg, const char* entry) {
           *(s->status) = s->columns->SetWideColumnValue(v);
         }
 
-        if (s->inplace_update_support) {
-          s->mem->GetLock(s->key->user_key())->ReadUnlock();
-        }
-
         *(s->found_final_value) = true;
 
         if (s->is_blob_index != nullptr) {
@@ -1359,6 +1463,39 @@ bool MemTable::Get(const LookupKey& key, std::string* value,
   return found_final_value;
 }
 
+static void InitSaver(MemTable* mem, SystemClock* clock, const LookupKey& key,
+                      SequenceNumber max_covering_tombstone_seq, bool do_merge,
+                      ReadCallback* callback, bool* is_blob_index,
+                      std::string* value, PinnableWideColumns* columns,
+                      std::string* timestamp, Status* s,
+                      MergeContext* merge_context, bool* found_final_value,
+                      bool* merge_in_progress, Saver* saver) {
+  const ImmutableMemTableOptions& moptions =
+      *mem->GetImmutableMemTableOptions();
+  saver->status = s;
+  saver->found_final_value = found_final_value;
+  saver->merge_in_progress = merge_in_progress;
+  saver->key = &key;
+  saver->value = value;
+  saver->columns = columns;
+  saver->timestamp = timestamp;
+  saver->seq = kMaxSequenceNumber;
+  saver->mem = mem;
+  saver->merge_context = merge_context;
+  saver->max_covering_tombstone_seq = max_covering_tombstone_seq;
+  saver->merge_operator = moptions.merge_operator;
+  saver->logger = moptions.info_log;
+  saver->inplace_update_support = moptions.inplace_update_support;
+  saver->concurrent_inplace_update = moptions.concurrent_inplace_update;
+  saver->statistics = moptions.statistics;
+  saver->clock = clock;
+  saver->callback_ = callback;
+  saver->is_blob_index = is_blob_index;
+  saver->do_merge = do_merge;
+  saver->allow_data_in_errors = moptions.allow_data_in_errors;
+  saver->protection_bytes_per_key = moptions.protection_bytes_per_key;
+}
+
 void MemTable::GetFromTable(const LookupKey& key,
                             SequenceNumber max_covering_tombstone_seq,
                             bool do_merge, ReadCallback* callback,
@@ -1368,27 +1505,9 @@ void MemTable::GetFromTable(const LookupKey& key,
                             MergeContext* merge_context, SequenceNumber* seq,
                             bool* found_final_value, bool* merge_in_progress) {
   Saver saver;
-  saver.status = s;
-  saver.found_final_value = found_final_value;
-  saver.merge_in_progress = merge_in_progress;
-  saver.key = &key;
-  saver.value = value;
-  saver.columns = columns;
-  saver.timestamp = timestamp;
-  saver.seq = kMaxSequenceNumber;
-  saver.mem = this;
-  saver.merge_context = merge_context;
-  saver.max_covering_tombstone_seq = max_covering_tombstone_seq;
-  saver.merge_operator = moptions_.merge_operator;
-  saver.logger = moptions_.info_log;
-  saver.inplace_update_support = moptions_.inplace_update_support;
-  saver.statistics = moptions_.statistics;
-  saver.clock = clock_;
-  saver.callback_ = callback;
-  saver.is_blob_index = is_blob_index;
-  saver.do_merge = do_merge;
-  saver.allow_data_in_errors = moptions_.allow_data_in_errors;
-  saver.protection_bytes_per_key = moptions_.protection_bytes_per_key;
+  InitSaver(this, clock_, key, max_covering_tombstone_seq, do_merge, callback,
+            is_blob_index, value, columns, timestamp, s, merge_context,
+            found_final_value, merge_in_progress, &saver);
   table_->Get(key, &saver, SaveValue);
   *seq = saver.seq;
 }
@@ -1435,9 +1554,17 @@ void MemTable::MultiGet(const ReadOptions& read_options, MultiGetRange* range,
       }
     }
   }
+  // The keys are looked up in batches, so that the rep can overlap their
+  // searches.
+  std::array<Saver, MultiGetContext::MAX_BATCH_SIZE> savers;
+  std::array<const LookupKey*, MultiGetContext::MAX_BATCH_SIZE> lookup_keys;
+  std::array<void*, MultiGetContext::MAX_BATCH_SIZE> saver_args;
+  std::array<bool, MultiGetContext::MAX_BATCH_SIZE> found_final_value;
+  std::array<bool, MultiGetContext::MAX_BATCH_SIZE> merge_in_progress;
+  size_t num_keys = 0;
   for (auto iter = temp_range.begin(); iter != temp_range.end(); ++iter) {
-    bool found_final_value{false};
-    bool merge_in_progress = iter->s->IsMergeInProgress();
+    found_final_value[num_keys] = false;
+    merge_in_progress[num_keys] = iter->s->IsMergeInProgress();
     if (!no_range_del) {
       std::unique_ptr<FragmentedRangeTombstoneIterator> range_del_iter(
           NewRangeTombstoneIteratorInternal(
@@ -1455,18 +1582,27 @@ void MemTable::MultiGet(const ReadOptions& read_options, MultiGetRange* range,
         }
       }
     }
-    SequenceNumber dummy_seq;
-    GetFromTable(*(iter->lkey), iter->max_covering_tombstone_seq, true,
-                 callback, &iter->is_blob_index,
-                 iter->value ? iter->value->GetSelf() : nullptr, iter->columns,
-                 iter->timestamp, iter->s, &(iter->merge_context), &dummy_seq,
-                 &found_final_value, &merge_in_progress);
-
-    if (!found_final_value && merge_in_progress) {
+    InitSaver(this, clock_, *(iter->lkey), iter->max_covering_tombstone_seq,
+              true, callback, &iter->is_blob_index,
+              iter->value ? iter->value->GetSelf() : nullptr, iter->columns,
+              iter->timestamp, iter->s, &(iter->merge_context),
+              &found_final_value[num_keys], &merge_in_progress[num_keys],
+              &savers[num_keys]);
+    lookup_keys[num_keys] = iter->lkey;
+    saver_args[num_keys] = &savers[num_keys];
+    num_keys++;
+  }
+  table_->MultiGet(num_keys, lookup_keys.data(), saver_args.data(), SaveValue);
+
+  // Only the keys already visited get marked done, so this visits the keys
+  // in the same order as above.
+  size_t i = 0;
+  for (auto iter = temp_range.begin(); iter != temp_range.end(); ++iter, ++i) {
+    if (!found_final_value[i] && merge_in_progress[i]) {
       *(iter->s) = Status::MergeInProgress();
     }
 
-    if (found_final_value) {
+    if (found_final_value[i]) {
       if (iter->value) {
         iter->value->PinSelf();
         range->AddValueSize(iter->value->size());
@@ -1493,7 +1629,14 @@ void MemTable::MultiGet(const ReadOptions& read_options, MultiGetRange* range,
 
 Status MemTable::Update(SequenceNumber seq, ValueType value_type,
                         const Slice& key, const Slice& value,
-                        const ProtectionInfoKVOS64* kv_prot_info) {
+                        const ProtectionInfoKVOS64* kv_prot_info,
+                        bool allow_concurrent,
+                        MemTablePostProcessInfo* post_process_info) {
+  if (moptions_.concurrent_inplace_update) {
+    return UpdateConcurrently(seq, value_type, key, value, kv_prot_info,
+                              allow_concurrent, post_process_info);
+  }
+  assert(!allow_concurrent);
   LookupKey lkey(key, seq);
   Slice mem_key = lkey.memtable_key();
 
@@ -1554,6 +1697,103 @@ Status MemTable::Update(SequenceNumber seq, ValueType value_type,
   return Add(seq, value_type, key, value, kv_prot_info);
 }
 
+bool MemTable::IsSuperseded(const Slice& user_key, SequenceNumber seq) {
+  LookupKey lkey(user_key, kMaxSequenceNumber);
+  std::unique_ptr<MemTableRep::Iterator> iter(
+      table_->GetDynamicPrefixIterator());
+  iter->Seek(lkey.internal_key(), lkey.memtable_key().data());
+  if (!iter->Valid()) {
+    return false;
+  }
+  const char* entry = iter->key();
+  uint32_t key_length = 0;
+  const char* key_ptr = GetVarint32Ptr(entry, entry + 5, &key_length);
+  if (!comparator_.comparator.user_comparator()->Equal(
+          Slice(key_ptr, key_length - 8), user_key)) {
+    return false;
+  }
+  Slice prev_value = GetLengthPrefixedSlice(key_ptr + key_length);
+  return (GetValueVersion(prev_value)->load(std::memory_order_relaxed) >> 1) >
+         seq;
+}
+
+Status MemTable::UpdateConcurrently(SequenceNumber seq, ValueType value_type,
+                                    const Slice& key, const Slice& value,
+                                    const ProtectionInfoKVOS64* kv_prot_info,
+                                    bool allow_concurrent,
+                                    MemTablePostProcessInfo* post_process_info) {
+  WriteLock wl(GetLock(key));
+  LookupKey lkey(key, kMaxSequenceNumber);
+  std::unique_ptr<MemTableRep::Iterator> iter(
+      table_->GetDynamicPrefixIterator());
+  iter->Seek(lkey.internal_key(), lkey.memtable_key().data());
+
+  if (iter->Valid()) {
+    const char* entry = iter->key();
+    uint32_t key_length = 0;
+    const char* key_ptr = GetVarint32Ptr(entry, entry + 5, &key_length);
+    if (comparator_.comparator.user_comparator()->Equal(
+            Slice(key_ptr, key_length - 8), lkey.user_key())) {
+      const uint64_t tag = DecodeFixed64(key_ptr + key_length - 8);
+      ValueType type;
+      SequenceNumber existing_seq;
+      UnPackSequenceAndType(tag, &existing_seq, &type);
+      Slice prev_value = GetLengthPrefixedSlice(key_ptr + key_length);
+      std::atomic<uint64_t>* version = GetValueVersion(prev_value);
+      const uint64_t applied = version->load(std::memory_order_relaxed);
+      if ((applied >> 1) > seq) {
+        // A newer write of the key was applied concurrently
+        return Status::OK();
+      }
+      if (type == value_type && prev_value.size() == value.size()) {
+        char* p = const_cast<char*>(prev_value.data());
+        // Readers retry while the low bit is set or the version changed,
+        // see ReadInPlaceValue()
+        version->store(applied | 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        memcpy(p, value.data(), value.size());
+        Status s;
+        if (kv_prot_info != nullptr) {
+          ProtectionInfoKVOS64 updated_kv_prot_info(*kv_prot_info);
+          // `seq` is swallowed and `existing_seq` prevails.
+          updated_kv_prot_info.UpdateS(seq, existing_seq);
+          UpdateEntryChecksum(&updated_kv_prot_info, key, value, type,
+                              existing_seq, p + value.size());
+          Slice encoded(entry, p + value.size() - entry);
+          s = VerifyEncodedEntry(encoded, updated_kv_prot_info);
+        } else {
+          UpdateEntryChecksum(nullptr, key, value, type, existing_seq,
+                              p + value.size());
+        }
+        version->store(seq << 1, std::memory_order_release);
+        RecordTick(moptions_.statistics, NUMBER_KEYS_UPDATED);
+        return s;
+      }
+    }
+  }
+
+  return AddImpl(seq, value_type, key, value, kv_prot_info, allow_concurrent,
+                 post_process_info, nullptr);
+}
+
+Slice MemTable::ReadInPlaceValue(const char* value_ptr,
+                                 std::string* buf) const {
+  assert(moptions_.concurrent_inplace_update);
+  Slice value = GetLengthPrefixedSlice(value_ptr);
+  const std::atomic<uint64_t>* version = GetValueVersion(value);
+  while (true) {
+    const uint64_t before = version->load(std::memory_order_acquire);
+    if ((before & 1) == 0) {
+      buf->assign(value.data(), value.size());
+      std::atomic_thread_fence(std::memory_order_acquire);
+      if (version->load(std::memory_order_relaxed) == before) {
+        return Slice(*buf);
+      }
+    }
+    port::AsmVolatilePause();
+  }
+}
+
 Status MemTable::UpdateCallback(SequenceNumber seq, const Slice& key,
                                 const Slice& delta,
                                 const ProtectionInfoKVOS64* kv_prot_info) {
@@ -1692,6 +1932,15 @@ void MemTableRep::Get(const LookupKey& k, void* callback_args,
   }
 }
 
+void MemTableRep::MultiGet(size_t num_keys, const LookupKey* const* keys,
+                           void* const* callback_args,
+                           bool (*callback_func)(void* arg,
+                                                 const char* entry)) {
+  for (size_t i = 0; i < num_keys; i++) {
+    Get(*keys[i], callback_args[i], callback_func);
+  }
+}
+
 void MemTable::RefLogContainingPrepSection(uint64_t log) {
   assert(log > 0);
   auto cur = min_prep_log_referenced_.load();
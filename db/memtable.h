@@ -50,6 +50,9 @@ struct ImmutableMemTableOptions {
   size_t memtable_huge_page_size;
   bool memtable_whole_key_filtering;
   bool inplace_update_support;
+  // inplace_update_support with concurrent memtable writes. Each entry is
+  // then followed by a version word, see MemTable::Update().
+  bool concurrent_inplace_update;
   size_t inplace_update_num_locks;
   UpdateStatus (*inplace_callback)(char* existing_value,
                                    uint32_t* existing_value_size,
@@ -298,14 +301,23 @@ class MemTable {
   // value is at least as large as the new value, updates it in-place. Otherwise
   // adds the new value to the memtable out-of-place.
   //
+  // With concurrent in-place updates (see
+  // ImmutableMemTableOptions::concurrent_inplace_update), only a value of the
+  // same size is updated in-place, and the writes to a key are serialized
+  // under its lock. A write older than the newest entry of the key, which was
+  // applied concurrently, is dropped.
+  //
   // Returns `Status::TryAgain` if the `seq`, `key` combination already exists
   // in the memtable and `MemTableRepFactory::CanHandleDuplicatedKey()` is true.
   // The next attempt should try a larger value for `seq`.
   //
-  // REQUIRES: external synchronization to prevent simultaneous
-  // operations on the same MemTable.
+  // REQUIRES: if allow_concurrent = false, external synchronization to prevent
+  // simultaneous operations on the same MemTable. allow_concurrent requires
+  // concurrent in-place updates.
   Status Update(SequenceNumber seq, ValueType value_type, const Slice& key,
-                const Slice& value, const ProtectionInfoKVOS64* kv_prot_info);
+                const Slice& value, const ProtectionInfoKVOS64* kv_prot_info,
+                bool allow_concurrent = false,
+                MemTablePostProcessInfo* post_process_info = nullptr);
 
   // If `key` exists in current memtable with type `kTypeValue` and the existing
   // value is at least as large as the new value, updates it in-place. Otherwise
@@ -465,6 +477,13 @@ class MemTable {
   void RefLogContainingPrepSection(uint64_t log);
   uint64_t GetMinLogContainingPrepSection();
 
+  // Charges the memory of this memtable to the tenant of its DB in the
+  // WriteBufferManager. Must be called before the memtable is shared.
+  void SetWriteBufferManagerTenant(
+      std::shared_ptr<WriteBufferManager::Tenant> tenant) {
+    mem_tracker_.SetWriteBufferManagerTenant(std::move(tenant));
+  }
+
   // Notify the underlying storage that no more items will be added.
   // REQUIRES: external synchronization to prevent simultaneous
   // operations on the same MemTable.
@@ -503,6 +522,11 @@ class MemTable {
   // Get the lock associated for the key
   port::RWMutex* GetLock(const Slice& key);
 
+  // Copies the length-prefixed value at value_ptr into *buf, retrying while
+  // it is updated in-place concurrently, and returns the copy.
+  // REQUIRES: concurrent in-place updates
+  Slice ReadInPlaceValue(const char* value_ptr, std::string* buf) const;
+
   const InternalKeyComparator& GetInternalKeyComparator() const {
     return comparator_.comparator;
   }
@@ -709,6 +733,11 @@ class MemTable {
   std::unique_ptr<FragmentedRangeTombstoneList>
       fragmented_range_tombstone_list_;
 
+  // Maximum number of range tombstones added to the fragments of an earlier
+  // cache when building cached_range_tombstone_, rather than fragmenting all
+  // the tombstones again
+  static constexpr int kMaxRangeTombstoneCacheChain = 8;
+
   // makes sure there is a single range tombstone writer to invalidate cache
   std::mutex range_del_mutex_;
   CoreLocalArray<std::shared_ptr<FragmentedRangeTombstoneListCache>>
@@ -718,6 +747,37 @@ class MemTable {
                            const Slice& key, const Slice& value, ValueType type,
                            SequenceNumber s, char* checksum_ptr);
 
+  Status AddImpl(SequenceNumber seq, ValueType type, const Slice& key,
+                 const Slice& value, const ProtectionInfoKVOS64* kv_prot_info,
+                 bool allow_concurrent,
+                 MemTablePostProcessInfo* post_process_info, void** hint);
+
+  Status UpdateConcurrently(SequenceNumber seq, ValueType value_type,
+                            const Slice& key, const Slice& value,
+                            const ProtectionInfoKVOS64* kv_prot_info,
+                            bool allow_concurrent,
+                            MemTablePostProcessInfo* post_process_info);
+
+  // Whether the newest entry of user_key was written after seq. Writers of the
+  // key hold its lock.
+  bool IsSuperseded(const Slice& user_key, SequenceNumber seq);
+
+  // With concurrent in-place updates, each entry is followed by the padding
+  // and an 8-byte aligned version word, holding the sequence number of the
+  // last write to the value shifted left by one. Its low bit is set while the
+  // value is updated in-place.
+  static constexpr uint32_t kEntryVersionBytes = 2 * sizeof(uint64_t) - 1;
+  static std::atomic<uint64_t>* GetEntryVersion(const char* entry_end) {
+    return reinterpret_cast<std::atomic<uint64_t>*>(
+        (reinterpret_cast<uintptr_t>(entry_end) + sizeof(uint64_t) - 1) &
+        ~uintptr_t{sizeof(uint64_t) - 1});
+  }
+  // Version word of the entry whose value is value.
+  std::atomic<uint64_t>* GetValueVersion(const Slice& value) const {
+    return GetEntryVersion(value.data() + value.size() +
+                           moptions_.protection_bytes_per_key);
+  }
+
   void MaybeUpdateNewestUDT(const Slice& user_key);
 };
 
@@ -139,6 +139,9 @@ class MemTableListVersion {
   // Return kMaxSequenceNumber if the list is empty.
   SequenceNumber GetFirstSequenceNumber() const;
 
+  // The immutable memtables, the most recent first
+  const std::list<MemTable*>& GetMemlist() const { return memlist_; }
+
  private:
   friend class MemTableList;
 
@@ -380,6 +383,15 @@ class MemTableList {
   uint64_t PrecomputeMinLogContainingPrepSection(
       const std::unordered_set<MemTable*>* memtables_to_flush = nullptr);
 
+  // DB mutex held.
+  // Appends the immutable memtables, from the oldest to the newest.
+  void GetMemTables(autovector<MemTable*>* mems) const {
+    const auto& memlist = current_->memlist_;
+    for (auto it = memlist.rbegin(); it != memlist.rend(); ++it) {
+      mems->push_back(*it);
+    }
+  }
+
   uint64_t GetEarliestMemTableID() const {
     auto& memlist = current_->memlist_;
     if (memlist.empty()) {
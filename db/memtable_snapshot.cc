@@ -0,0 +1,275 @@
+//  Copyright (c) Meta Platforms, Inc. and affiliates.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+
+#include "db/memtable_snapshot.h"
+
+#include <unordered_set>
+
+#include "db/column_family.h"
+#include "db/dbformat.h"
+#include "db/log_writer.h"
+#include "db/memtable.h"
+#include "db/memtable_list.h"
+#include "db/range_tombstone_fragmenter.h"
+#include "file/read_write_util.h"
+#include "file/sequence_file_reader.h"
+#include "file/writable_file_writer.h"
+#include "memory/arena.h"
+#include "table/internal_iterator.h"
+#include "util/coding.h"
+
+namespace ROCKSDB_NAMESPACE {
+
+namespace {
+constexpr uint32_t kFormatVersion = 1;
+
+enum Tag : char {
+  kMemTableTag = 1,
+  kEntriesTag = 2,
+  kFooterTag = 3,
+};
+
+// Entries are batched into records about this large
+constexpr size_t kTargetRecordSize = 1 << 20;
+
+IOStatus WriteEntries(InternalIterator* iter, log::Writer* writer,
+                      uint64_t* num_entries) {
+  std::string record;
+  IOStatus io_s;
+  for (iter->SeekToFirst(); iter->Valid() && io_s.ok(); iter->Next()) {
+    if (record.empty()) {
+      record.push_back(kEntriesTag);
+    }
+    PutLengthPrefixedSlice(&record, iter->key());
+    PutLengthPrefixedSlice(&record, iter->value());
+    (*num_entries)++;
+    if (record.size() >= kTargetRecordSize) {
+      io_s = writer->AddRecord(WriteOptions(), record);
+      record.clear();
+    }
+  }
+  if (io_s.ok()) {
+    io_s = status_to_io_status(iter->status());
+  }
+  if (io_s.ok() && !record.empty()) {
+    io_s = writer->AddRecord(WriteOptions(), record);
+  }
+  return io_s;
+}
+}  // anonymous namespace
+
+void MemTableSnapshotHeader::EncodeTo(std::string* dst) const {
+  PutVarint32(dst, kFormatVersion);
+  PutLengthPrefixedSlice(dst, db_id);
+  PutVarint64(dst, last_sequence);
+  PutVarint32(dst, static_cast<uint32_t>(wals.size()));
+  for (const auto& wal : wals) {
+    PutVarint64Varint64(dst, wal.first, wal.second);
+  }
+}
+
+Status MemTableSnapshotHeader::DecodeFrom(Slice* src) {
+  uint32_t format_version = 0;
+  if (!GetVarint32(src, &format_version)) {
+    return Status::Corruption("memtable snapshot", "bad format version");
+  }
+  if (format_version != kFormatVersion) {
+    return Status::NotSupported("memtable snapshot format version " +
+                                std::to_string(format_version));
+  }
+  Slice id;
+  uint32_t num_wals = 0;
+  if (!GetLengthPrefixedSlice(src, &id) || !GetVarint64(src, &last_sequence) ||
+      !GetVarint32(src, &num_wals)) {
+    return Status::Corruption("memtable snapshot", "bad header");
+  }
+  db_id = id.ToString();
+  wals.clear();
+  for (uint32_t i = 0; i < num_wals; i++) {
+    uint64_t number = 0;
+    uint64_t size = 0;
+    if (!GetVarint64(src, &number) || !GetVarint64(src, &size)) {
+      return Status::Corruption("memtable snapshot", "bad WAL");
+    }
+    wals.emplace_back(number, size);
+  }
+  return Status::OK();
+}
+
+Status WriteMemTableSnapshot(FileSystem* fs, SystemClock* clock,
+                             const FileOptions& file_options, bool use_fsync,
+                             const std::string& fname,
+                             const MemTableSnapshotHeader& header,
+                             ColumnFamilySet* column_families,
+                             uint64_t* num_entries) {
+  *num_entries = 0;
+  std::unique_ptr<FSWritableFile> file;
+  IOStatus io_s = NewWritableFile(fs, fname, &file, file_options);
+  if (!io_s.ok()) {
+    return io_s;
+  }
+  std::unique_ptr<WritableFileWriter> file_writer(
+      new WritableFileWriter(std::move(file), fname, file_options, clock));
+  log::Writer writer(std::move(file_writer), 0 /* log_number */,
+                     false /* recycle_log_files */);
+  const WriteOptions write_options;
+  std::string record;
+  header.EncodeTo(&record);
+  io_s = writer.AddRecord(write_options, record);
+
+  ReadOptions read_options;
+  read_options.total_order_seek = true;
+  for (auto cfd : *column_families) {
+    if (!io_s.ok()) {
+      break;
+    }
+    if (cfd->IsDropped()) {
+      continue;
+    }
+    autovector<MemTable*> mems;
+    cfd->imm()->GetMemTables(&mems);
+    mems.push_back(cfd->mem());
+    for (MemTable* mem : mems) {
+      if (!io_s.ok()) {
+        break;
+      }
+      if (mem->IsEmpty()) {
+        continue;
+      }
+      record.clear();
+      record.push_back(kMemTableTag);
+      PutVarint32(&record, cfd->GetID());
+      PutVarint64(&record, mem->GetEarliestSequenceNumber());
+      io_s = writer.AddRecord(write_options, record);
+      if (io_s.ok()) {
+        Arena arena;
+        ScopedArenaPtr<InternalIterator> iter(
+            mem->NewIterator(read_options, nullptr /* seqno_to_time */,
+                             &arena));
+        io_s = WriteEntries(iter.get(), &writer, num_entries);
+      }
+      if (io_s.ok()) {
+        std::unique_ptr<FragmentedRangeTombstoneIterator> range_del_iter(
+            mem->NewRangeTombstoneIterator(
+                read_options, kMaxSequenceNumber,
+                /*immutable_memtable=*/mem != cfd->mem()));
+        if (range_del_iter != nullptr) {
+          io_s = WriteEntries(range_del_iter.get(), &writer, num_entries);
+        }
+      }
+    }
+  }
+
+  if (io_s.ok()) {
+    record.clear();
+    record.push_back(kFooterTag);
+    PutVarint64(&record, *num_entries);
+    io_s = writer.AddRecord(write_options, record);
+  }
+  if (io_s.ok()) {
+    io_s = writer.file()->Sync(IOOptions(), use_fsync);
+  }
+  if (io_s.ok()) {
+    io_s = writer.Close(write_options);
+  }
+  return io_s;
+}
+
+Status MemTableSnapshotReader::Open(FileSystem* fs,
+                                    const FileOptions& file_options,
+                                    const std::string& fname,
+                                    const std::shared_ptr<Logger>& info_log) {
+  std::unique_ptr<FSSequentialFile> file;
+  Status s = fs->NewSequentialFile(fname, file_options, &file, nullptr);
+  if (!s.ok()) {
+    return s;
+  }
+  std::unique_ptr<SequentialFileReader> file_reader(
+      new SequentialFileReader(std::move(file), fname));
+  reporter_.status = &status_;
+  reader_.reset(new log::Reader(info_log, std::move(file_reader), &reporter_,
+                                true /* checksum */, 0 /* log_num */));
+  Slice record;
+  std::string scratch;
+  if (!reader_->ReadRecord(&record, &scratch)) {
+    return status_.ok() ? Status::Corruption("memtable snapshot", "no header")
+                        : status_;
+  }
+  if (!status_.ok()) {
+    return status_;
+  }
+  return header_.DecodeFrom(&record);
+}
+
+Status MemTableSnapshotReader::Load(ColumnFamilySet* column_families,
+                                    uint64_t* num_entries) {
+  assert(reader_ != nullptr);
+  *num_entries = 0;
+  std::unordered_set<uint32_t> loaded_cfs;
+  bool in_memtable = false;
+  MemTable* mem = nullptr;
+  Slice record;
+  std::string scratch;
+  while (reader_->ReadRecord(&record, &scratch) && status_.ok()) {
+    if (record.empty()) {
+      return Status::Corruption("memtable snapshot", "empty record");
+    }
+    const char tag = record[0];
+    record.remove_prefix(1);
+    if (tag == kMemTableTag) {
+      uint32_t cf_id = 0;
+      uint64_t earliest_seq = 0;
+      if (!GetVarint32(&record, &cf_id) ||
+          !GetVarint64(&record, &earliest_seq)) {
+        return Status::Corruption("memtable snapshot", "bad memtable");
+      }
+      ColumnFamilyData* cfd = column_families->GetColumnFamily(cf_id);
+      if (cfd != nullptr && loaded_cfs.insert(cf_id).second) {
+        // The first memtable of the column family is the oldest one
+        cfd->CreateNewMemtable(*cfd->GetLatestMutableCFOptions(),
+                               earliest_seq);
+      }
+      mem = cfd != nullptr ? cfd->mem() : nullptr;
+      in_memtable = true;
+    } else if (tag == kEntriesTag && in_memtable) {
+      while (!record.empty()) {
+        Slice key;
+        Slice value;
+        if (!GetLengthPrefixedSlice(&record, &key) ||
+            !GetLengthPrefixedSlice(&record, &value)) {
+          return Status::Corruption("memtable snapshot", "bad entry");
+        }
+        (*num_entries)++;
+        if (mem == nullptr) {
+          continue;
+        }
+        ParsedInternalKey parsed;
+        Status s = ParseInternalKey(key, &parsed, false /* log_err_key */);
+        if (s.ok()) {
+          // In key order, each insert into the skip list starts from where
+          // the previous one ended
+          s = mem->Add(parsed.sequence, parsed.type, parsed.user_key, value,
+                       nullptr /* kv_prot_info */);
+        }
+        if (!s.ok()) {
+          return s;
+        }
+      }
+    } else if (tag == kFooterTag) {
+      uint64_t expected_entries = 0;
+      if (!GetVarint64(&record, &expected_entries) ||
+          expected_entries != *num_entries) {
+        return Status::Corruption("memtable snapshot", "bad footer");
+      }
+      return Status::OK();
+    } else {
+      return Status::Corruption("memtable snapshot", "bad record");
+    }
+  }
+  return status_.ok() ? Status::Corruption("memtable snapshot", "no footer")
+                      : status_;
+}
+
+}  // namespace ROCKSDB_NAMESPACE
@@ -0,0 +1,91 @@
+//  Copyright (c) Meta Platforms, Inc. and affiliates.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+
+#pragma once
+
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "db/log_reader.h"
+#include "rocksdb/file_system.h"
+#include "rocksdb/status.h"
+#include "rocksdb/types.h"
+
+namespace ROCKSDB_NAMESPACE {
+
+class ColumnFamilySet;
+class SystemClock;
+
+// A memtable snapshot holds the entries of the memtables of a DB closed
+// without flushing them, so that the next DB::Open() loads them in key order
+// instead of replaying the WALs they came from. It's only valid as long as
+// the WALs are unchanged. See DBOptions::snapshot_memtables_on_shutdown.
+//
+// The file is a sequence of log records:
+//   header: format version (varint32), DB ID (length prefixed), last
+//   sequence (varint64), number of WALs (varint32), then the number and the
+//   size of each WAL (varint64 each)
+//   for each memtable, from the oldest to the newest of a column family:
+//     a memtable record: tag, column family ID (varint32), earliest
+//     sequence of the memtable (varint64)
+//     entry records: tag, then the internal key and the value of each
+//     entry (length prefixed), in internal key order, followed by the range
+//     tombstones in the same format
+//   footer: tag, number of entries (varint64)
+struct MemTableSnapshotHeader {
+  std::string db_id;
+  SequenceNumber last_sequence = 0;
+  // <number, size> of the WALs the memtables were recovered and written
+  // from, in increasing number
+  std::vector<std::pair<uint64_t, uint64_t>> wals;
+
+  void EncodeTo(std::string* dst) const;
+  Status DecodeFrom(Slice* src);
+};
+
+// Writes the snapshot `fname` of the memtables of `column_families`.
+// REQUIRES: DB mutex held, no write in progress
+Status WriteMemTableSnapshot(FileSystem* fs, SystemClock* clock,
+                             const FileOptions& file_options, bool use_fsync,
+                             const std::string& fname,
+                             const MemTableSnapshotHeader& header,
+                             ColumnFamilySet* column_families,
+                             uint64_t* num_entries);
+
+// Reads a memtable snapshot, the header first and then the entries.
+class MemTableSnapshotReader {
+ public:
+  Status Open(FileSystem* fs, const FileOptions& file_options,
+              const std::string& fname,
+              const std::shared_ptr<Logger>& info_log);
+
+  // REQUIRES: Open() succeeded
+  const MemTableSnapshotHeader& header() const { return header_; }
+
+  // Inserts the entries into a new memtable of each column family of the
+  // snapshot, skipping the column families no longer in `column_families`.
+  // On error, the memtables may hold part of the entries.
+  // REQUIRES: Open() succeeded, DB mutex held during recovery
+  Status Load(ColumnFamilySet* column_families, uint64_t* num_entries);
+
+ private:
+  struct Reporter : public log::Reader::Reporter {
+    Status* status = nullptr;
+    void Corruption(size_t /*bytes*/, const Status& s) override {
+      if (status->ok()) {
+        *status = s;
+      }
+    }
+  };
+
+  MemTableSnapshotHeader header_;
+  Status status_;
+  Reporter reporter_;
+  std::unique_ptr<log::Reader> reader_;
+};
+
+}  // namespace ROCKSDB_NAMESPACE
@@ -9,6 +9,7 @@
 #include <string>
 #include <vector>
 
+#include "db/dbformat.h"
 #include "rocksdb/db.h"
 #include "rocksdb/slice.h"
 
@@ -24,6 +25,25 @@ class MergeContext {
  public:
   GetMergeOperandsOptions* get_merge_operands_options = nullptr;
 
+  // Set by a Get() that found the key in DBOptions::merge_result_cache:
+  // memo_value is the result of merging all the entries of the key up to and
+  // including the one with sequence number memo_seq. The lookup reads that
+  // entry as a plain value of memo_value, so only the newer operands are
+  // merged.
+  SequenceNumber memo_seq = kMaxSequenceNumber;
+  Slice memo_value;
+  // The sequence number of the newest entry of the key seen by the lookup
+  SequenceNumber newest_seq = kMaxSequenceNumber;
+
+  // Called by the lookup for each visible entry of the key, newest first.
+  // Returns true if the entry is to be read as a value of memo_value.
+  bool ObserveEntry(SequenceNumber seq) {
+    if (newest_seq == kMaxSequenceNumber) {
+      newest_seq = seq;
+    }
+    return seq == memo_seq;
+  }
+
   // Clear all the operands
   void Clear() {
     if (operand_list_) {
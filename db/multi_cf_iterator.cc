@@ -6,6 +6,7 @@
 #include "db/multi_cf_iterator.h"
 
 #include <cassert>
+#include <string>
 
 namespace ROCKSDB_NAMESPACE {
 
@@ -68,8 +69,28 @@ void MultiCfIterator::SeekToFirst() {
 }
 void MultiCfIterator::Seek(const Slice& target) {
   auto& min_heap = GetHeap<MultiCfMinHeap>([this]() { InitMinHeap(); });
+  if (read_options_.async_io) {
+    // `target` may be the key of a child, which StartSeek() invalidates
+    const std::string target_copy = target.ToString();
+    if (!seek_started_) {
+      StartSeek(target_copy);
+    }
+    seek_started_ = false;
+    SeekCommon(min_heap,
+               [&target_copy](Iterator* iter) { iter->Seek(target_copy); });
+    return;
+  }
   SeekCommon(min_heap, [&target](Iterator* iter) { iter->Seek(target); });
 }
+void MultiCfIterator::StartSeek(const Slice& target) {
+  if (!read_options_.async_io) {
+    return;
+  }
+  for (auto& cfh_iter_pair : cfh_iter_pairs_) {
+    cfh_iter_pair.second->StartSeek(target);
+  }
+  seek_started_ = true;
+}
 void MultiCfIterator::SeekToLast() {
   auto& max_heap = GetHeap<MultiCfMaxHeap>([this]() { InitMaxHeap(); });
   SeekCommon(max_heap, [](Iterator* iter) { iter->SeekToLast(); });
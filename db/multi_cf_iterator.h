@@ -20,12 +20,18 @@ namespace ROCKSDB_NAMESPACE {
 // When the same key exists in more than one column families, the iterator
 // selects the value from the first column family containing the key, in the
 // order provided in the `column_families` parameter.
+//
+// With ReadOptions::async_io, Seek() submits the reads of all the child
+// iterators before waiting for any of them, so that the column families are
+// read in parallel.
 class MultiCfIterator : public Iterator {
  public:
-  MultiCfIterator(const Comparator* comparator,
+  MultiCfIterator(const ReadOptions& read_options,
+                  const Comparator* comparator,
                   const std::vector<ColumnFamilyHandle*>& column_families,
                   const std::vector<Iterator*>& child_iterators)
-      : comparator_(comparator),
+      : read_options_(read_options),
+        comparator_(comparator),
         heap_(MultiCfMinHeap(
             MultiCfHeapItemComparator<std::greater<int>>(comparator_))) {
     assert(column_families.size() > 0 &&
@@ -46,6 +52,8 @@ class MultiCfIterator : public Iterator {
   std::vector<std::pair<ColumnFamilyHandle*, std::unique_ptr<Iterator>>>
       cfh_iter_pairs_;
   ReadOptions read_options_;
+  // Set by StartSeek() until the Seek() which completes it
+  bool seek_started_ = false;
   Status status_;
 
   AttributeGroups attribute_groups_;
@@ -151,6 +159,7 @@ class MultiCfIterator : public Iterator {
   void SeekToFirst() override;
   void SeekToLast() override;
   void Seek(const Slice& /*target*/) override;
+  void StartSeek(const Slice& /*target*/) override;
   void SeekForPrev(const Slice& /*target*/) override;
   void Next() override;
   void Prev() override;
@@ -488,6 +488,53 @@ TEST_F(MultiCfIteratorTest, DISABLED_IterateAttributeGroups) {
       std::nullopt /* expected_wide_columns */, expected_attribute_groups);
 }
 
+TEST_F(MultiCfIteratorTest, AsyncIoSeek) {
+  Options options = GetDefaultOptions();
+  options.disable_auto_compactions = true;
+  BlockBasedTableOptions table_options;
+  table_options.block_size = 64;
+  options.table_factory.reset(NewBlockBasedTableFactory(table_options));
+  CreateAndReopenWithCF({"cf_1", "cf_2", "cf_3"}, options);
+
+  // Overlapping keys spread over SST files, some of them deleted with a range
+  // tombstone, and newer values in the memtables
+  for (int cf = 0; cf < 4; ++cf) {
+    for (int i = cf; i < 100; i += 2) {
+      ASSERT_OK(Put(cf, Key(i), "val_" + std::to_string(cf)));
+      if (i % 20 == 19) {
+        ASSERT_OK(Flush(cf));
+      }
+    }
+    ASSERT_OK(Flush(cf));
+  }
+  ASSERT_OK(db_->DeleteRange(WriteOptions(), handles_[2], Key(40), Key(60)));
+  ASSERT_OK(Flush(2));
+  ASSERT_OK(Put(3, Key(51), "new_val_3"));
+
+  std::vector<ColumnFamilyHandle*> cfhs = {handles_[0], handles_[1],
+                                           handles_[2], handles_[3]};
+  ReadOptions async_read_options;
+  async_read_options.async_io = true;
+  for (const std::string& target : {Key(0), Key(37), Key(45), Key(99)}) {
+    std::unique_ptr<Iterator> iter =
+        db_->NewMultiCfIterator(ReadOptions(), cfhs);
+    std::unique_ptr<Iterator> async_iter =
+        db_->NewMultiCfIterator(async_read_options, cfhs);
+    iter->Seek(target);
+    async_iter->Seek(target);
+    for (int i = 0; i < 10 && iter->Valid(); ++i) {
+      ASSERT_TRUE(async_iter->Valid());
+      ASSERT_EQ(iter->key(), async_iter->key());
+      ASSERT_EQ(iter->value(), async_iter->value());
+      iter->Next();
+      async_iter->Next();
+    }
+    ASSERT_EQ(iter->Valid(), async_iter->Valid());
+    ASSERT_OK(iter->status());
+    ASSERT_OK(async_iter->status());
+  }
+}
+
 }  // namespace ROCKSDB_NAMESPACE
 
 int main(int argc, char** argv) {
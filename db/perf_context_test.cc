@@ -1138,6 +1138,45 @@ TEST_F(PerfContextTest, WriteMemtableTimePerfLevel) {
   ASSERT_EQ(perf_context.write_memtable_time, 0);
 }
 
+TEST_F(PerfContextTest, SampledPerfLevel) {
+  if (kPerfLevelMax < PerfLevel::kEnableTime) {
+    ROCKSDB_GTEST_BYPASS("Time stats are compiled out");
+    return;
+  }
+  ASSERT_OK(DestroyDB(kDbName, Options()));
+  std::shared_ptr<DB> db = OpenDb();
+  ASSERT_OK(db->Put(WriteOptions(), "foo", "bar"));
+  std::string value;
+
+  SetPerfLevel(PerfLevel::kEnableCount);
+  SetPerfLevelSampling(PerfLevel::kEnableTime, 1);
+  get_perf_context()->Reset();
+  ASSERT_OK(db->Get(ReadOptions(), "foo", &value));
+  ASSERT_GT(get_perf_context()->get_from_memtable_time, 0);
+  ASSERT_OK(db->Put(WriteOptions(), "foo", "bar"));
+  ASSERT_GT(get_perf_context()->write_memtable_time, 0);
+  // Only raised during the operations
+  ASSERT_EQ(PerfLevel::kEnableCount, GetPerfLevel());
+
+  SetPerfLevelSampling(PerfLevel::kEnableTime, 4);
+  int num_sampled = 0;
+  for (int i = 0; i < 1000; i++) {
+    get_perf_context()->Reset();
+    ASSERT_OK(db->Get(ReadOptions(), "foo", &value));
+    ASSERT_EQ(1, get_perf_context()->get_from_memtable_count);
+    if (get_perf_context()->get_from_memtable_time > 0) {
+      num_sampled++;
+    }
+  }
+  ASSERT_GT(num_sampled, 100);
+  ASSERT_LT(num_sampled, 500);
+
+  SetPerfLevelSampling(PerfLevel::kEnableTime, 0);
+  get_perf_context()->Reset();
+  ASSERT_OK(db->Get(ReadOptions(), "foo", &value));
+  ASSERT_EQ(0, get_perf_context()->get_from_memtable_time);
+}
+
 }  // namespace ROCKSDB_NAMESPACE
 
 int main(int argc, char** argv) {
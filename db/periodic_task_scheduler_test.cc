@@ -8,6 +8,7 @@
 
 #include "db/db_test_util.h"
 #include "env/composite_env_wrapper.h"
+#include "rocksdb/auto_tuner.h"
 #include "test_util/mock_time_env.h"
 
 namespace ROCKSDB_NAMESPACE {
@@ -219,6 +220,67 @@ TEST_F(PeriodicTaskSchedulerTest, MultiEnv) {
   Close();
 }
 
+TEST_F(PeriodicTaskSchedulerTest, AutoTune) {
+  constexpr int kPeriodSec = 10;
+  Close();
+  Options options;
+  options.create_if_missing = true;
+  options.env = mock_env_.get();
+  options.max_background_jobs = 4;
+  options.level0_slowdown_writes_trigger = 20;
+  options.level0_stop_writes_trigger = 36;
+  AutoTunerOptions tuner_options;
+  tuner_options.period_sec = kPeriodSec;
+  tuner_options.min_background_jobs = 2;
+  tuner_options.max_background_jobs = 6;
+  tuner_options.min_level0_slowdown_writes_trigger = 19;
+  tuner_options.max_level0_slowdown_writes_trigger = 24;
+  options.auto_tuner = NewAutoTuner(tuner_options);
+
+  int auto_tune_counter = 0;
+  SyncPoint::GetInstance()->SetCallBack("DBImpl::AutoTune:StartRunning",
+                                        [&](void*) { auto_tune_counter++; });
+  SyncPoint::GetInstance()->EnableProcessing();
+
+  Reopen(options);
+  const PeriodicTaskScheduler& scheduler =
+      dbfull()->TEST_GetPeriodicTaskScheduler();
+  ASSERT_TRUE(scheduler.TEST_HasTask(PeriodicTaskType::kAutoTune));
+
+  // The idle rounds lower the options down to their min bounds
+  dbfull()->TEST_WaitForPeriodicTaskRun(
+      [&] { mock_clock_->MockSleepForSeconds(kPeriodSec - 1); });
+  ASSERT_EQ(1, auto_tune_counter);
+  ASSERT_EQ(3, dbfull()->GetDBOptions().max_background_jobs);
+  ASSERT_EQ(19, dbfull()->GetOptions().level0_slowdown_writes_trigger);
+  ASSERT_EQ(35, dbfull()->GetOptions().level0_stop_writes_trigger);
+
+  for (int i = 0; i < 2; i++) {
+    dbfull()->TEST_WaitForPeriodicTaskRun(
+        [&] { mock_clock_->MockSleepForSeconds(kPeriodSec); });
+  }
+  ASSERT_EQ(3, auto_tune_counter);
+  ASSERT_EQ(2, dbfull()->GetDBOptions().max_background_jobs);
+  ASSERT_EQ(19, dbfull()->GetOptions().level0_slowdown_writes_trigger);
+  ASSERT_EQ(35, dbfull()->GetOptions().level0_stop_writes_trigger);
+
+  // The rounds with stopped writes raise max_background_jobs up to its max
+  // bound, the L0 file count not being the cause
+  {
+    std::unique_ptr<WriteControllerToken> token =
+        dbfull()->TEST_write_controler().GetStopToken();
+    for (int i = 0; i < 5; i++) {
+      dbfull()->TEST_WaitForPeriodicTaskRun(
+          [&] { mock_clock_->MockSleepForSeconds(kPeriodSec); });
+    }
+  }
+  ASSERT_EQ(8, auto_tune_counter);
+  ASSERT_EQ(6, dbfull()->GetDBOptions().max_background_jobs);
+  ASSERT_EQ(19, dbfull()->GetOptions().level0_slowdown_writes_trigger);
+
+  Close();
+}
+
 }  // namespace ROCKSDB_NAMESPACE
 
 int main(int argc, char** argv) {
@@ -1250,6 +1250,70 @@ TEST_P(PlainTableDBTest, NonExistingKeyToNonEmptyBucket) {
   delete iter;
 }
 
+TEST_P(PlainTableDBTest, CacheAlignedIndex) {
+  for (int store_index_in_file = 0; store_index_in_file <= 1;
+       ++store_index_in_file) {
+    Options options = CurrentOptions();
+    options.create_if_missing = true;
+    PlainTableOptions plain_table_options;
+    plain_table_options.user_key_len = 16;
+    plain_table_options.bloom_bits_per_key = 10;
+    plain_table_options.hash_table_ratio = 0.75;
+    plain_table_options.index_sparseness = 2;
+    plain_table_options.store_index_in_file = store_index_in_file;
+    plain_table_options.cache_aligned_index = true;
+    options.table_factory.reset(NewPlainTableFactory(plain_table_options));
+    DestroyAndReopen(&options);
+
+    // Prefixes with one and with several index records
+    const int kNumPrefixes = 300;
+    auto key = [](int prefix, int suffix) {
+      char buf[32];
+      snprintf(buf, sizeof(buf), "%08dsuffix%02d", prefix, suffix);
+      return std::string(buf);
+    };
+    for (int i = 0; i < kNumPrefixes; i++) {
+      for (int j = 0; j <= i % 7; j++) {
+        ASSERT_OK(Put(key(i, j), "v" + std::to_string(i * 100 + j)));
+      }
+    }
+    ASSERT_OK(dbfull()->TEST_FlushMemTable());
+
+    if (!store_index_in_file) {
+      TablePropertiesCollection ptc;
+      ASSERT_OK(static_cast<DB*>(dbfull())->GetPropertiesOfAllTables(&ptc));
+      ASSERT_EQ(1U, ptc.size());
+      uint64_t hash_table_size = std::stoull(
+          ptc.begin()->second->user_collected_properties.at(
+              "plain_table_hash_table_size"));
+      ASSERT_GT(hash_table_size, 0U);
+      ASSERT_EQ(hash_table_size % PlainTableIndex::kBucketSize, 0U);
+    }
+
+    for (int i = 0; i < kNumPrefixes; i++) {
+      for (int j = 0; j <= i % 7; j++) {
+        ASSERT_EQ("v" + std::to_string(i * 100 + j), Get(key(i, j)));
+      }
+      ASSERT_EQ("NOT_FOUND", Get(key(i, 8)));
+    }
+    ASSERT_EQ("NOT_FOUND", Get(key(kNumPrefixes, 0)));
+
+    std::unique_ptr<Iterator> iter(dbfull()->NewIterator(ReadOptions()));
+    iter->Seek(key(6, 3));
+    ASSERT_TRUE(iter->Valid());
+    ASSERT_EQ(key(6, 3), iter->key().ToString());
+    iter->Next();
+    ASSERT_TRUE(iter->Valid());
+    ASSERT_EQ(key(6, 4), iter->key().ToString());
+    iter->Seek(key(13, 0));
+    ASSERT_TRUE(iter->Valid());
+    ASSERT_EQ(key(13, 0), iter->key().ToString());
+    iter->Seek(key(kNumPrefixes, 0));
+    ASSERT_TRUE(!iter->Valid());
+    ASSERT_OK(iter->status());
+  }
+}
+
 static std::string Key(int i) {
   char buf[100];
   snprintf(buf, sizeof(buf), "key_______%06d", i);
@@ -268,6 +268,86 @@ void FragmentedRangeTombstoneList::FragmentTombstones(
   }
 }
 
+std::unique_ptr<FragmentedRangeTombstoneList>
+FragmentedRangeTombstoneList::CopyAndAdd(
+    const FragmentedRangeTombstoneList& base, const Slice& start_key,
+    const Slice& end_key, SequenceNumber seq, const Comparator* ucmp) {
+  assert(ucmp->timestamp_size() == 0);
+  std::unique_ptr<FragmentedRangeTombstoneList> list(
+      new FragmentedRangeTombstoneList());
+  list->num_unfragmented_tombstones_ = base.num_unfragmented_tombstones_ + 1;
+  list->total_tombstone_payload_bytes_ = base.total_tombstone_payload_bytes_ +
+                                         start_key.size() + sizeof(uint64_t) +
+                                         end_key.size();
+  list->tombstones_.reserve(base.tombstones_.size() + 2);
+  list->tombstone_seqs_.reserve(base.tombstone_seqs_.size() +
+                                base.tombstones_.size() + 1);
+
+  // Appends the fragment [start, end) with the sequence numbers of `from`, if
+  // any, and `seq` if `with_new`, keeping them in descending order. `seq` is
+  // already in `from` if `base` was built after the tombstone was written.
+  auto add_fragment = [&](const Slice& start, const Slice& end,
+                          const RangeTombstoneStack* from, bool with_new) {
+    const size_t start_idx = list->tombstone_seqs_.size();
+    bool added = !with_new;
+    if (from != nullptr) {
+      for (auto it = base.seq_iter(from->seq_start_idx);
+           it != base.seq_iter(from->seq_end_idx); ++it) {
+        if (!added && seq >= *it) {
+          if (seq != *it) {
+            list->tombstone_seqs_.push_back(seq);
+          }
+          added = true;
+        }
+        list->tombstone_seqs_.push_back(*it);
+      }
+    }
+    if (!added) {
+      list->tombstone_seqs_.push_back(seq);
+    }
+    list->tombstones_.emplace_back(start, end, start_idx,
+                                   list->tombstone_seqs_.size());
+  };
+
+  // The start of the part of the new tombstone not added yet
+  Slice cur_start_key = start_key;
+  bool done = ucmp->Compare(start_key, end_key) >= 0;
+  for (const auto& fragment : base.tombstones_) {
+    if (done || ucmp->Compare(fragment.end_key, cur_start_key) <= 0) {
+      add_fragment(fragment.start_key, fragment.end_key, &fragment, false);
+      continue;
+    }
+    if (ucmp->Compare(cur_start_key, fragment.start_key) < 0) {
+      // The new tombstone starts in the gap before this fragment
+      if (ucmp->Compare(end_key, fragment.start_key) <= 0) {
+        add_fragment(cur_start_key, end_key, nullptr, true);
+        add_fragment(fragment.start_key, fragment.end_key, &fragment, false);
+        done = true;
+        continue;
+      }
+      add_fragment(cur_start_key, fragment.start_key, nullptr, true);
+      cur_start_key = fragment.start_key;
+    }
+    // The new tombstone overlaps [cur_start_key, fragment.end_key)
+    if (ucmp->Compare(fragment.start_key, cur_start_key) < 0) {
+      add_fragment(fragment.start_key, cur_start_key, &fragment, false);
+    }
+    if (ucmp->Compare(end_key, fragment.end_key) < 0) {
+      add_fragment(cur_start_key, end_key, &fragment, true);
+      add_fragment(end_key, fragment.end_key, &fragment, false);
+      done = true;
+    } else {
+      add_fragment(cur_start_key, fragment.end_key, &fragment, true);
+      cur_start_key = fragment.end_key;
+      done = ucmp->Compare(cur_start_key, end_key) == 0;
+    }
+  }
+  if (!done) {
+    add_fragment(cur_start_key, end_key, nullptr, true);
+  }
+  return list;
+}
+
 bool FragmentedRangeTombstoneList::ContainsRange(SequenceNumber lower,
                                                  SequenceNumber upper) {
   std::call_once(seq_set_init_once_flag_, [this]() {
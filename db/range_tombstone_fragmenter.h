@@ -25,6 +25,18 @@ struct FragmentedRangeTombstoneListCache {
   std::unique_ptr<FragmentedRangeTombstoneList> tombstones = nullptr;
   // readers will first check this bool to avoid
   std::atomic<bool> initialized = false;
+
+  // The cache replaced by this one when the range tombstone [added_start_key,
+  // added_end_key) at added_seq was written, so that `tombstones` can be built
+  // from the fragments of an earlier cache instead of from scratch, see
+  // FragmentedRangeTombstoneList::CopyAndAdd(). Guarded by reader_mutex, and
+  // reset once `tombstones` is built.
+  std::shared_ptr<FragmentedRangeTombstoneListCache> prev;
+  // Number of caches chained through `prev`
+  int num_prev = 0;
+  Slice added_start_key;
+  Slice added_end_key;
+  SequenceNumber added_seq = 0;
 };
 
 struct FragmentedRangeTombstoneList {
@@ -57,6 +69,16 @@ struct FragmentedRangeTombstoneList {
       const std::vector<SequenceNumber>& snapshots = {},
       const bool tombstone_end_include_ts = true);
 
+  // Returns the fragments of the tombstones of `base` and of the tombstone
+  // [start_key, end_key) at `seq`, in O(number of fragments of `base`). The
+  // new list points to the keys of `base` and to `start_key` and `end_key`, so
+  // they must outlive it.
+  // REQUIRES: `base` built for reads without user-defined timestamp, from
+  // pinned keys
+  static std::unique_ptr<FragmentedRangeTombstoneList> CopyAndAdd(
+      const FragmentedRangeTombstoneList& base, const Slice& start_key,
+      const Slice& end_key, SequenceNumber seq, const Comparator* ucmp);
+
   std::vector<RangeTombstoneStack>::const_iterator begin() const {
     return tombstones_.begin();
   }
@@ -98,6 +120,9 @@ struct FragmentedRangeTombstoneList {
   }
 
  private:
+  FragmentedRangeTombstoneList()
+      : num_unfragmented_tombstones_(0), total_tombstone_payload_bytes_(0) {}
+
   // Given an ordered range tombstone iterator unfragmented_tombstones,
   // "fragment" the tombstones into non-overlapping pieces. Each
   // "non-overlapping piece" is a RangeTombstoneStack in tombstones_, which
@@ -9,6 +9,7 @@
 #include "db/dbformat.h"
 #include "rocksdb/comparator.h"
 #include "test_util/testutil.h"
+#include "util/random.h"
 #include "util/vector_iterator.h"
 
 namespace ROCKSDB_NAMESPACE {
@@ -546,6 +547,66 @@ TEST_F(RangeTombstoneFragmenterTest, SeekOutOfBounds) {
                     {{"", {}, true /* out of range */}, {"z", {"l", "n", 4}}});
 }
 
+TEST_F(RangeTombstoneFragmenterTest, CopyAndAdd) {
+  // Adding tombstones one at a time to the fragments of the earlier ones
+  // gives the same fragments as fragmenting all of them.
+  Random rnd(301);
+  for (int iter = 0; iter < 100; iter++) {
+    const int num_range_dels = 1 + static_cast<int>(rnd.Uniform(10));
+    std::vector<SequenceNumber> seqs;
+    for (int i = 0; i < num_range_dels; i++) {
+      seqs.push_back(i + 1);
+    }
+    RandomShuffle(seqs.begin(), seqs.end(), rnd.Next());
+    std::vector<std::string> keys;
+    keys.reserve(2 * num_range_dels);
+    std::vector<RangeTombstone> range_dels;
+    for (int i = 0; i < num_range_dels; i++) {
+      const char start = static_cast<char>('a' + rnd.Uniform(10));
+      keys.emplace_back(1, start);
+      keys.emplace_back(1, static_cast<char>(start + 1 + rnd.Uniform(5)));
+      range_dels.emplace_back(keys[2 * i], keys[2 * i + 1], seqs[i]);
+    }
+    const size_t num_base = rnd.Uniform(num_range_dels);
+
+    std::vector<std::unique_ptr<FragmentedRangeTombstoneList>> lists;
+    lists.emplace_back(new FragmentedRangeTombstoneList(
+        MakeRangeDelIter(std::vector<RangeTombstone>(
+            range_dels.begin(), range_dels.begin() + num_base)),
+        bytewise_icmp));
+    for (size_t i = num_base; i < range_dels.size(); i++) {
+      lists.push_back(FragmentedRangeTombstoneList::CopyAndAdd(
+          *lists.back(), range_dels[i].start_key_, range_dels[i].end_key_,
+          range_dels[i].seq_, BytewiseComparator()));
+    }
+    // Adding a tombstone already in the list changes nothing
+    lists.push_back(FragmentedRangeTombstoneList::CopyAndAdd(
+        *lists.back(), range_dels.back().start_key_,
+        range_dels.back().end_key_, range_dels.back().seq_,
+        BytewiseComparator()));
+
+    FragmentedRangeTombstoneList expected(MakeRangeDelIter(range_dels),
+                                          bytewise_icmp);
+    for (size_t i = lists.size() - 2; i < lists.size(); i++) {
+      const FragmentedRangeTombstoneList& actual = *lists[i];
+      ASSERT_EQ(expected.num_unfragmented_tombstones() + i - lists.size() + 2,
+                actual.num_unfragmented_tombstones());
+      ASSERT_EQ(std::distance(expected.begin(), expected.end()),
+                std::distance(actual.begin(), actual.end()));
+      for (auto e = expected.begin(), a = actual.begin(); e != expected.end();
+           ++e, ++a) {
+        ASSERT_EQ(e->start_key.ToString(), a->start_key.ToString());
+        ASSERT_EQ(e->end_key.ToString(), a->end_key.ToString());
+        ASSERT_EQ(std::vector<SequenceNumber>(
+                      expected.seq_iter(e->seq_start_idx),
+                      expected.seq_iter(e->seq_end_idx)),
+                  std::vector<SequenceNumber>(actual.seq_iter(a->seq_start_idx),
+                                              actual.seq_iter(a->seq_end_idx)));
+      }
+    }
+  }
+}
+
 }  // namespace ROCKSDB_NAMESPACE
 
 int main(int argc, char** argv) {
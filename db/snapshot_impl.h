@@ -8,6 +8,7 @@
 // found in the LICENSE file. See the AUTHORS file for names of contributors.
 
 #pragma once
+#include <memory>
 #include <vector>
 
 #include "db/dbformat.h"
@@ -106,6 +107,13 @@ class SnapshotList {
     s->unix_time_ = unix_time;
     s->timestamp_ = ts;
     s->is_write_conflict_boundary_ = is_write_conflict_boundary;
+    // The sequence numbers don't change when the new snapshot shares the
+    // one of the newest snapshot, as it does when nothing was written since
+    if (empty() || newest()->number_ != seq ||
+        (is_write_conflict_boundary &&
+         all_oldest_write_conflict_snapshot_ == kMaxSequenceNumber)) {
+      all_.reset();
+    }
     s->list_ = this;
     s->next_ = &list_;
     s->prev_ = list_.prev_;
@@ -118,6 +126,13 @@ class SnapshotList {
   // Do not responsible to free the object.
   void Delete(const SnapshotImpl* s) {
     assert(s->list_ == this);
+    // Nor do they when another snapshot shares the number of `s`
+    const bool shared_number =
+        (s->prev_ != &list_ && s->prev_->number_ == s->number_) ||
+        (s->next_ != &list_ && s->next_->number_ == s->number_);
+    if (!shared_number || s->is_write_conflict_boundary_) {
+      all_.reset();
+    }
     s->prev_->next_ = s->next_;
     s->next_->prev_ = s->prev_;
     count_--;
@@ -170,6 +185,23 @@ class SnapshotList {
     return;
   }
 
+  // Like GetAll() without max_seq, but returns an immutable view which the
+  // callers share, rebuilt only after the snapshot numbers changed, so that
+  // the flush and compaction jobs don't each copy thousands of snapshots.
+  std::shared_ptr<const std::vector<SequenceNumber>> GetAllShared(
+      SequenceNumber* oldest_write_conflict_snapshot = nullptr) const {
+    if (all_ == nullptr) {
+      auto all = std::make_shared<std::vector<SequenceNumber>>();
+      all->reserve(count_);
+      GetAll(all.get(), &all_oldest_write_conflict_snapshot_);
+      all_ = std::move(all);
+    }
+    if (oldest_write_conflict_snapshot != nullptr) {
+      *oldest_write_conflict_snapshot = all_oldest_write_conflict_snapshot_;
+    }
+    return all_;
+  }
+
   // get the sequence number of the most recent snapshot
   SequenceNumber GetNewest() {
     if (empty()) {
@@ -200,6 +232,11 @@ class SnapshotList {
   // Dummy head of doubly-linked list of snapshots
   SnapshotImpl list_;
   uint64_t count_;
+  // The snapshot numbers of GetAllShared(), nullptr until it is called after
+  // they changed
+  mutable std::shared_ptr<const std::vector<SequenceNumber>> all_;
+  mutable SequenceNumber all_oldest_write_conflict_snapshot_ =
+      kMaxSequenceNumber;
 };
 
 // All operations on TimestampedSnapshotList must be protected by db mutex.
@@ -16,6 +16,7 @@
 #include "file/file_util.h"
 #include "file/filename.h"
 #include "file/random_access_file_reader.h"
+#include "monitoring/op_trace_impl.h"
 #include "monitoring/perf_context_imp.h"
 #include "rocksdb/advanced_options.h"
 #include "rocksdb/statistics.h"
@@ -433,6 +434,7 @@ Status TableCache::Get(
     HistogramImpl* file_read_hist, bool skip_filters, int level,
     size_t max_file_size_for_l0_meta_pin) {
   auto& fd = file_meta.fd;
+  OP_TRACE_FILE_SPAN("table_get", fd.GetNumber());
   std::string* row_cache_entry = nullptr;
   bool done = false;
   IterKey row_cache_key;
@@ -480,6 +482,9 @@ Status TableCache::Get(
             get_context->SetTimestampFromRangeTombstone(
                 range_del_iter->timestamp());
           }
+          // A replay of the row would not apply the tombstone of this file,
+          // so the row is not cached.
+          row_cache_entry = nullptr;
         }
       }
     }
@@ -641,6 +646,29 @@ Status TableCache::ApproximateKeyAnchors(
   return s;
 }
 
+Status TableCache::GetCachedKeyRanges(
+    const ReadOptions& ro, const InternalKeyComparator& internal_comparator,
+    const FileMetaData& file_meta, uint8_t block_protection_bytes_per_key,
+    std::vector<TableReader::KeyRange>* ranges) {
+  Status s;
+  TableReader* t = file_meta.fd.table_reader;
+  TypedHandle* handle = nullptr;
+  if (t == nullptr) {
+    s = FindTable(ro, file_options_, internal_comparator, file_meta, &handle,
+                  block_protection_bytes_per_key);
+    if (s.ok()) {
+      t = cache_.Value(handle);
+    }
+  }
+  if (s.ok() && t != nullptr) {
+    s = t->GetCachedKeyRanges(ro, ranges);
+  }
+  if (handle != nullptr) {
+    cache_.Release(handle);
+  }
+  return s;
+}
+
 size_t TableCache::GetMemoryUsageByTableReader(
     const FileOptions& file_options, const ReadOptions& read_options,
     const InternalKeyComparator& internal_comparator,
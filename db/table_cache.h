@@ -201,6 +201,13 @@ class TableCache {
                                uint8_t block_protection_bytes_per_key,
                                std::vector<TableReader::Anchor>& anchors);
 
+  // See TableReader::GetCachedKeyRanges().
+  Status GetCachedKeyRanges(const ReadOptions& ro,
+                            const InternalKeyComparator& internal_comparator,
+                            const FileMetaData& file_meta,
+                            uint8_t block_protection_bytes_per_key,
+                            std::vector<TableReader::KeyRange>* ranges);
+
   // Return total memory usage of the table reader of the file.
   // 0 if table reader of the file is not loaded.
   size_t GetMemoryUsageByTableReader(
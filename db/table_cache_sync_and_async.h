@@ -30,6 +30,10 @@ DEFINE_SYNC_AND_ASYNC(Status, TableCache::MultiGet)
     t = cache_.Value(handle);
   }
   autovector<std::string, MultiGetContext::MAX_BATCH_SIZE> row_cache_entries;
+  // Of the keys to look up in the table, before applying its range
+  // tombstones
+  autovector<SequenceNumber, MultiGetContext::MAX_BATCH_SIZE>
+      covering_tombstone_seqs;
   IterKey row_cache_key;
   size_t row_cache_key_prefix_size = 0;
   KeyContext& first_key = *table_range.begin();
@@ -38,10 +42,11 @@ DEFINE_SYNC_AND_ASYNC(Status, TableCache::MultiGet)
 
   // Check row cache if enabled. Since row cache does not currently store
   // sequence numbers, we cannot use it if we need to fetch the sequence.
+  SequenceNumber row_cache_seq_no = 0;
   if (lookup_row_cache) {
     GetContext* first_context = first_key.get_context;
-    CreateRowCacheKeyPrefix(options, fd, first_key.ikey, first_context,
-                            row_cache_key);
+    row_cache_seq_no = CreateRowCacheKeyPrefix(
+        options, fd, first_key.ikey, first_context, row_cache_key);
     row_cache_key_prefix_size = row_cache_key.Size();
 
     for (auto miter = table_range.begin(); miter != table_range.end();
@@ -53,7 +58,7 @@ DEFINE_SYNC_AND_ASYNC(Status, TableCache::MultiGet)
       Status read_status;
       bool ret =
           GetFromRowCache(user_key, row_cache_key, row_cache_key_prefix_size,
-                          get_context, &read_status);
+                          get_context, &read_status, row_cache_seq_no);
       if (!read_status.ok()) {
         CO_RETURN read_status;
       }
@@ -84,6 +89,13 @@ DEFINE_SYNC_AND_ASYNC(Status, TableCache::MultiGet)
       }
     }
     if (s.ok() && !options.ignore_range_deletions && !skip_range_deletions) {
+      if (lookup_row_cache) {
+        for (auto miter = table_range.begin(); miter != table_range.end();
+             ++miter) {
+          covering_tombstone_seqs.push_back(
+              *miter->get_context->max_covering_tombstone_seq());
+        }
+      }
       UpdateRangeTombstoneSeqnums(options, t, table_range);
     }
     if (s.ok()) {
@@ -107,16 +119,23 @@ DEFINE_SYNC_AND_ASYNC(Status, TableCache::MultiGet)
 
     for (auto miter = table_range.begin(); miter != table_range.end();
          ++miter) {
-      std::string& row_cache_entry = row_cache_entries[row_idx++];
+      std::string& row_cache_entry = row_cache_entries[row_idx];
       const Slice& user_key = miter->ukey_with_ts;
       GetContext* get_context = miter->get_context;
+      // A replay of the row would not apply the range tombstones of this
+      // file, so the rows they cover are not cached.
+      bool covered_by_table_tombstone =
+          !covering_tombstone_seqs.empty() &&
+          *get_context->max_covering_tombstone_seq() !=
+              covering_tombstone_seqs[row_idx];
+      row_idx++;
 
       get_context->SetReplayLog(nullptr);
       // Compute row cache key.
       row_cache_key.TrimAppend(row_cache_key_prefix_size, user_key.data(),
                                user_key.size());
       // Put the replay log in row cache only if something was found.
-      if (s.ok() && !row_cache_entry.empty()) {
+      if (s.ok() && !row_cache_entry.empty() && !covered_by_table_tombstone) {
         size_t charge = row_cache_entry.capacity() + sizeof(std::string);
         auto row_ptr = new std::string(std::move(row_cache_entry));
         // If row cache is full, it's OK.
@@ -0,0 +1,172 @@
+//  Copyright (c) Meta Platforms, Inc. and affiliates.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+
+#include "db/table_summary.h"
+
+#include "db/log_reader.h"
+#include "db/log_writer.h"
+#include "db/version_edit.h"
+#include "file/read_write_util.h"
+#include "file/sequence_file_reader.h"
+#include "file/writable_file_writer.h"
+#include "table/block_based/block.h"
+#include "table/format.h"
+#include "table/meta_blocks.h"
+#include "util/coding.h"
+
+namespace ROCKSDB_NAMESPACE {
+
+namespace {
+constexpr uint32_t kFormatVersion = 1;
+
+struct Reporter : public log::Reader::Reporter {
+  Status* status = nullptr;
+  void Corruption(size_t /*bytes*/, const Status& s) override {
+    if (status->ok()) {
+      *status = s;
+    }
+  }
+};
+}  // anonymous namespace
+
+void TableSummary::Add(const FileMetaData& file_meta,
+                       std::shared_ptr<const TableProperties> props) {
+  Entry& entry = files_[file_meta.fd.GetNumber()];
+  entry.file_size = file_meta.fd.GetFileSize();
+  entry.unique_id = file_meta.unique_id;
+  entry.props = std::move(props);
+}
+
+std::shared_ptr<const TableProperties> TableSummary::Get(
+    const FileMetaData& file_meta) const {
+  auto it = files_.find(file_meta.fd.GetNumber());
+  if (it == files_.end() ||
+      it->second.file_size != file_meta.fd.GetFileSize() ||
+      it->second.unique_id != file_meta.unique_id) {
+    return nullptr;
+  }
+  return it->second.props;
+}
+
+Status TableSummary::WriteToFile(FileSystem* fs, SystemClock* clock,
+                                 const FileOptions& file_options,
+                                 bool use_fsync,
+                                 const std::string& fname) const {
+  std::unique_ptr<FSWritableFile> file;
+  IOStatus io_s = NewWritableFile(fs, fname, &file, file_options);
+  if (!io_s.ok()) {
+    return io_s;
+  }
+  std::unique_ptr<WritableFileWriter> file_writer(
+      new WritableFileWriter(std::move(file), fname, file_options, clock));
+  log::Writer writer(std::move(file_writer), 0 /* log_number */,
+                     false /* recycle_log_files */);
+  const WriteOptions write_options;
+  std::string record;
+  PutVarint32(&record, kFormatVersion);
+  io_s = writer.AddRecord(write_options, record);
+
+  for (const auto& file_entry : files_) {
+    if (!io_s.ok()) {
+      break;
+    }
+    const Entry& entry = file_entry.second;
+    record.clear();
+    PutVarint64Varint64(&record, file_entry.first, entry.file_size);
+    PutVarint64Varint64(&record, entry.unique_id[0], entry.unique_id[1]);
+    PutVarint64(&record, entry.props->external_sst_file_global_seqno_offset);
+    PropertyBlockBuilder builder;
+    builder.AddTableProperty(*entry.props);
+    builder.Add(entry.props->user_collected_properties);
+    PutLengthPrefixedSlice(&record, builder.Finish());
+    io_s = writer.AddRecord(write_options, record);
+  }
+
+  if (io_s.ok()) {
+    record.clear();
+    PutVarint64(&record, files_.size());
+    io_s = writer.AddRecord(write_options, record);
+  }
+  if (io_s.ok()) {
+    io_s = writer.file()->Sync(IOOptions(), use_fsync);
+  }
+  if (io_s.ok()) {
+    io_s = writer.Close(write_options);
+  }
+  return io_s;
+}
+
+Status TableSummary::ReadFromFile(FileSystem* fs,
+                                  const FileOptions& file_options,
+                                  const std::string& fname,
+                                  const std::shared_ptr<Logger>& info_log) {
+  std::unique_ptr<FSSequentialFile> file;
+  Status s = fs->NewSequentialFile(fname, file_options, &file, nullptr);
+  if (!s.ok()) {
+    return s;
+  }
+  std::unique_ptr<SequentialFileReader> file_reader(
+      new SequentialFileReader(std::move(file), fname));
+  Status reader_status;
+  Reporter reporter;
+  reporter.status = &reader_status;
+  log::Reader reader(info_log, std::move(file_reader), &reporter,
+                     true /* checksum */, 0 /* log_num */);
+
+  Slice record;
+  std::string scratch;
+  uint32_t format_version = 0;
+  if (!reader.ReadRecord(&record, &scratch) || !reader_status.ok()) {
+    return reader_status.ok() ? Status::Corruption("table summary", "no header")
+                              : reader_status;
+  }
+  if (!GetVarint32(&record, &format_version)) {
+    return Status::Corruption("table summary", "bad format version");
+  }
+  if (format_version != kFormatVersion) {
+    return Status::NotSupported("table summary format version " +
+                                std::to_string(format_version));
+  }
+
+  std::unordered_map<uint64_t, Entry> files;
+  while (reader.ReadRecord(&record, &scratch) && reader_status.ok()) {
+    uint64_t file_number = 0;
+    Entry entry;
+    uint64_t global_seqno_offset = 0;
+    Slice block;
+    if (!GetVarint64(&record, &file_number)) {
+      return Status::Corruption("table summary", "bad record");
+    }
+    if (record.empty()) {
+      // The footer
+      if (file_number != files.size()) {
+        return Status::Corruption("table summary", "bad footer");
+      }
+      files_ = std::move(files);
+      return Status::OK();
+    }
+    if (!GetVarint64(&record, &entry.file_size) ||
+        !GetVarint64(&record, &entry.unique_id[0]) ||
+        !GetVarint64(&record, &entry.unique_id[1]) ||
+        !GetVarint64(&record, &global_seqno_offset) ||
+        !GetLengthPrefixedSlice(&record, &block)) {
+      return Status::Corruption("table summary", "bad file");
+    }
+    Block properties_block{BlockContents(block)};
+    std::unique_ptr<TableProperties> props;
+    s = ParsePropertiesBlock(&properties_block, 0 /* block_offset */,
+                             info_log.get(), &props);
+    if (!s.ok()) {
+      return s;
+    }
+    props->external_sst_file_global_seqno_offset = global_seqno_offset;
+    entry.props = std::move(props);
+    files.emplace(file_number, std::move(entry));
+  }
+  return reader_status.ok() ? Status::Corruption("table summary", "no footer")
+                            : reader_status;
+}
+
+}  // namespace ROCKSDB_NAMESPACE
@@ -0,0 +1,67 @@
+//  Copyright (c) Meta Platforms, Inc. and affiliates.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+
+#pragma once
+
+#include <memory>
+#include <string>
+#include <unordered_map>
+
+#include "rocksdb/file_system.h"
+#include "rocksdb/status.h"
+#include "rocksdb/table_properties.h"
+#include "table/unique_id_impl.h"
+
+namespace ROCKSDB_NAMESPACE {
+
+struct FileMetaData;
+class Logger;
+class SystemClock;
+
+// The table properties of the live SST files of a DB at its last clean
+// shutdown, so that the next DB::Open() with max_open_files=-1 doesn't have
+// to open the files to get them. See DBOptions::summarize_tables_on_shutdown.
+//
+// A file is only matched by its number, size and unique ID, so the summary
+// stays valid as the files it lists are deleted.
+//
+// The file is a sequence of log records:
+//   header: format version (varint32)
+//   for each SST file: file number, file size, the two halves of the unique
+//   ID, the offset of the global sequence number of an external file
+//   (varint64 each), then the properties block (length prefixed)
+//   footer: number of files (varint64), alone in its record
+class TableSummary {
+ public:
+  // Adds the properties of `file_meta`
+  void Add(const FileMetaData& file_meta,
+           std::shared_ptr<const TableProperties> props);
+
+  // Returns the properties of `file_meta`, or nullptr if not in the summary
+  std::shared_ptr<const TableProperties> Get(
+      const FileMetaData& file_meta) const;
+
+  size_t NumFiles() const { return files_.size(); }
+
+  Status WriteToFile(FileSystem* fs, SystemClock* clock,
+                     const FileOptions& file_options, bool use_fsync,
+                     const std::string& fname) const;
+  // On error, the summary is unchanged
+  Status ReadFromFile(FileSystem* fs, const FileOptions& file_options,
+                      const std::string& fname,
+                      const std::shared_ptr<Logger>& info_log);
+
+ private:
+  struct Entry {
+    uint64_t file_size = 0;
+    UniqueId64x2 unique_id{};
+    std::shared_ptr<const TableProperties> props;
+  };
+
+  // By file number
+  std::unordered_map<uint64_t, Entry> files_;
+};
+
+}  // namespace ROCKSDB_NAMESPACE
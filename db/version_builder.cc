@@ -1306,7 +1306,7 @@ class VersionBuilder::Rep {
       for (auto& file_meta_pair : levels_[level].added_files) {
         auto* file_meta = file_meta_pair.second;
         // If the file has been opened before, just skip it.
-        if (!file_meta->table_reader_handle) {
+        if (!file_meta->table_reader_handle && !DefersTableLoad(*file_meta)) {
           files_meta.emplace_back(file_meta, level);
           statuses.emplace_back(Status::OK());
         }
@@ -1327,21 +1327,11 @@ class VersionBuilder::Rep {
           break;
         }
 
-        auto* file_meta = files_meta[file_idx].first;
-        int level = files_meta[file_idx].second;
-        TableCache::TypedHandle* handle = nullptr;
-        statuses[file_idx] = table_cache_->FindTable(
-            read_options, file_options_,
-            *(base_vstorage_->InternalComparator()), *file_meta, &handle,
-            block_protection_bytes_per_key, prefix_extractor, false /*no_io */,
-            internal_stats->GetFileReadHist(level), false, level,
-            prefetch_index_and_filter_in_cache, max_file_size_for_l0_meta_pin,
-            file_meta->temperature);
-        if (handle != nullptr) {
-          file_meta->table_reader_handle = handle;
-          // Load table_reader
-          file_meta->fd.table_reader = table_cache_->get_cache().Value(handle);
-        }
+        statuses[file_idx] = LoadTableHandler(
+            files_meta[file_idx].first, files_meta[file_idx].second,
+            internal_stats, prefetch_index_and_filter_in_cache,
+            prefix_extractor, max_file_size_for_l0_meta_pin, read_options,
+            block_protection_bytes_per_key);
       }
     });
 
@@ -1363,6 +1353,58 @@ class VersionBuilder::Rep {
     }
     return ret;
   }
+
+  Status LoadTableHandler(
+      FileMetaData* file_meta, int level, InternalStats* internal_stats,
+      bool prefetch_index_and_filter_in_cache,
+      const std::shared_ptr<const SliceTransform>& prefix_extractor,
+      size_t max_file_size_for_l0_meta_pin, const ReadOptions& read_options,
+      uint8_t block_protection_bytes_per_key) const {
+    assert(file_meta);
+    TableCache::TypedHandle* handle = nullptr;
+    Status s = table_cache_->FindTable(
+        read_options, file_options_, *(base_vstorage_->InternalComparator()),
+        *file_meta, &handle, block_protection_bytes_per_key, prefix_extractor,
+        false /*no_io */, internal_stats->GetFileReadHist(level), false, level,
+        prefetch_index_and_filter_in_cache, max_file_size_for_l0_meta_pin,
+        file_meta->temperature);
+    if (handle != nullptr) {
+      file_meta->table_reader_handle = handle;
+      // Load table_reader
+      file_meta->fd.table_reader = table_cache_->get_cache().Value(handle);
+    }
+    return s;
+  }
+
+  bool LoadsAllTableHandlers() const {
+    return table_cache_->get_cache().get()->GetCapacity() ==
+           TableCache::kInfiniteCapacity;
+  }
+
+  bool DefersTableLoad(const FileMetaData& file_meta) const {
+    // FIFO compaction reads the creation time of a file from its table
+    // reader, so the files must be open to expire
+    return version_set_ != nullptr &&
+           ioptions_->compaction_style != kCompactionStyleFIFO &&
+           version_set_->GetSummarizedTableProperties(file_meta) != nullptr;
+  }
+
+  FileMetaData* GetAddedFile(int level, uint64_t file_number) const {
+    if (level < 0 || level >= num_levels_) {
+      return nullptr;
+    }
+    const auto& added_files = levels_[level].added_files;
+    auto it = added_files.find(file_number);
+    return it != added_files.end() ? it->second : nullptr;
+  }
+
+  void GetAddedFiles(std::vector<std::pair<FileMetaData*, int>>* files) const {
+    for (int level = 0; level < num_levels_; level++) {
+      for (const auto& file_meta_pair : levels_[level].added_files) {
+        files->emplace_back(file_meta_pair.second, level);
+      }
+    }
+  }
 };
 
 VersionBuilder::VersionBuilder(
@@ -1399,6 +1441,36 @@ Status VersionBuilder::LoadTableHandlers(
       read_options, block_protection_bytes_per_key);
 }
 
+Status VersionBuilder::LoadTableHandler(
+    FileMetaData* file_meta, int level, InternalStats* internal_stats,
+    bool prefetch_index_and_filter_in_cache,
+    const std::shared_ptr<const SliceTransform>& prefix_extractor,
+    size_t max_file_size_for_l0_meta_pin, const ReadOptions& read_options,
+    uint8_t block_protection_bytes_per_key) const {
+  return rep_->LoadTableHandler(
+      file_meta, level, internal_stats, prefetch_index_and_filter_in_cache,
+      prefix_extractor, max_file_size_for_l0_meta_pin, read_options,
+      block_protection_bytes_per_key);
+}
+
+bool VersionBuilder::LoadsAllTableHandlers() const {
+  return rep_->LoadsAllTableHandlers();
+}
+
+bool VersionBuilder::DefersTableLoad(const FileMetaData& file_meta) const {
+  return rep_->DefersTableLoad(file_meta);
+}
+
+FileMetaData* VersionBuilder::GetAddedFile(int level,
+                                           uint64_t file_number) const {
+  return rep_->GetAddedFile(level, file_number);
+}
+
+void VersionBuilder::GetAddedFiles(
+    std::vector<std::pair<FileMetaData*, int>>* files) const {
+  rep_->GetAddedFiles(files);
+}
+
 uint64_t VersionBuilder::GetMinOldestBlobFileNumber() const {
   return rep_->GetMinOldestBlobFileNumber();
 }
@@ -10,6 +10,8 @@
 #pragma once
 
 #include <memory>
+#include <utility>
+#include <vector>
 
 #include "db/version_edit.h"
 #include "rocksdb/file_system.h"
@@ -50,6 +52,25 @@ class VersionBuilder {
       const std::shared_ptr<const SliceTransform>& prefix_extractor,
       size_t max_file_size_for_l0_meta_pin, const ReadOptions& read_options,
       uint8_t block_protection_bytes_per_key);
+  // Opens the table of `file_meta`, one of the added files. Only touches
+  // `file_meta` and the table cache, so it can run on another thread while
+  // edits that don't delete the file are applied.
+  Status LoadTableHandler(
+      FileMetaData* file_meta, int level, InternalStats* internal_stats,
+      bool prefetch_index_and_filter_in_cache,
+      const std::shared_ptr<const SliceTransform>& prefix_extractor,
+      size_t max_file_size_for_l0_meta_pin, const ReadOptions& read_options,
+      uint8_t block_protection_bytes_per_key) const;
+  // Whether LoadTableHandlers() opens all the added files, rather than as
+  // many as the table cache fits
+  bool LoadsAllTableHandlers() const;
+  // Whether LoadTableHandlers() leaves `file_meta` to be opened on its first
+  // read, as its properties are in the table summary of the VersionSet
+  bool DefersTableLoad(const FileMetaData& file_meta) const;
+  // The added file `file_number` at `level`, nullptr if none
+  FileMetaData* GetAddedFile(int level, uint64_t file_number) const;
+  // Appends the added files, with their levels, to `files`
+  void GetAddedFiles(std::vector<std::pair<FileMetaData*, int>>* files) const;
   uint64_t GetMinOldestBlobFileNumber() const;
 
  private:
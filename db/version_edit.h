@@ -171,15 +171,50 @@ struct FileDescriptor {
 };
 
 struct FileSampledStats {
-  FileSampledStats() : num_reads_sampled(0) {}
+  FileSampledStats()
+      : num_reads_sampled(0),
+        num_seeks_sampled(0),
+        num_reads_sampled_last_window(0),
+        num_seeks_sampled_last_window(0),
+        num_reads_sampled_window_start(0),
+        num_seeks_sampled_window_start(0) {}
   FileSampledStats(const FileSampledStats& other) { *this = other; }
   FileSampledStats& operator=(const FileSampledStats& other) {
     num_reads_sampled = other.num_reads_sampled.load();
+    num_seeks_sampled = other.num_seeks_sampled.load();
+    num_reads_sampled_last_window = other.num_reads_sampled_last_window.load();
+    num_seeks_sampled_last_window = other.num_seeks_sampled_last_window.load();
+    num_reads_sampled_window_start =
+        other.num_reads_sampled_window_start.load();
+    num_seeks_sampled_window_start =
+        other.num_seeks_sampled_window_start.load();
     return *this;
   }
 
+  // Ends the current window of reads, so the reads since the previous call
+  // become the last window
+  void RollWindow() const {
+    uint64_t reads = num_reads_sampled.load(std::memory_order_relaxed);
+    uint64_t seeks = num_seeks_sampled.load(std::memory_order_relaxed);
+    num_reads_sampled_last_window.store(
+        reads - num_reads_sampled_window_start.load(std::memory_order_relaxed),
+        std::memory_order_relaxed);
+    num_seeks_sampled_last_window.store(
+        seeks - num_seeks_sampled_window_start.load(std::memory_order_relaxed),
+        std::memory_order_relaxed);
+    num_reads_sampled_window_start.store(reads, std::memory_order_relaxed);
+    num_seeks_sampled_window_start.store(seeks, std::memory_order_relaxed);
+  }
+
   // number of user reads to this file.
   mutable std::atomic<uint64_t> num_reads_sampled;
+  // number of the reads above done by iterators.
+  mutable std::atomic<uint64_t> num_seeks_sampled;
+  // same as above, in the last window of stats_dump_period_sec.
+  mutable std::atomic<uint64_t> num_reads_sampled_last_window;
+  mutable std::atomic<uint64_t> num_seeks_sampled_last_window;
+  mutable std::atomic<uint64_t> num_reads_sampled_window_start;
+  mutable std::atomic<uint64_t> num_seeks_sampled_window_start;
 };
 
 struct FileMetaData {
@@ -385,9 +420,17 @@ struct FdWithKeyRange {
 struct LevelFilesBrief {
   size_t num_files;
   FdWithKeyRange* files;
+  // With the bytewise comparator, the common prefix of the user keys of the
+  // largest keys of the files and, for each file, the 8 bytes which follow it
+  // in a big-endian integer (see DoGenerateLevelFilesBrief()).  FindFile()
+  // narrows down its search with the integers, which fit in a few cache
+  // lines, before comparing keys.  nullptr if not built.
+  Slice largest_key_common_prefix;
+  uint64_t* largest_key_prefixes;
   LevelFilesBrief() {
     num_files = 0;
     files = nullptr;
+    largest_key_prefixes = nullptr;
   }
 };
 
@@ -9,7 +9,9 @@
 
 #include "db/version_edit_handler.h"
 
+#include <atomic>
 #include <cinttypes>
+#include <memory>
 #include <sstream>
 
 #include "db/blob/blob_file_reader.h"
@@ -22,7 +24,7 @@
 namespace ROCKSDB_NAMESPACE {
 
 void VersionEditHandlerBase::Iterate(log::Reader& reader,
-                                     Status* log_read_status) {
+                                     Status* log_read_status, bool pipelined) {
   Slice record;
   std::string scratch;
   assert(log_read_status);
@@ -30,36 +32,17 @@ void VersionEditHandlerBase::Iterate(log::Reader& reader,
 
   [[maybe_unused]] size_t recovered_edits = 0;
   Status s = Initialize();
-  while (reader.LastRecordEnd() < max_manifest_read_size_ && s.ok() &&
-         reader.ReadRecord(&record, &scratch) && log_read_status->ok()) {
-    VersionEdit edit;
-    s = edit.DecodeFrom(record);
+  if (pipelined) {
     if (s.ok()) {
-      s = read_buffer_.AddEdit(&edit);
+      s = IteratePipelined(reader, log_read_status, &recovered_edits);
     }
-    if (s.ok()) {
-      ColumnFamilyData* cfd = nullptr;
-      if (edit.IsInAtomicGroup()) {
-        if (read_buffer_.IsFull()) {
-          s = OnAtomicGroupReplayBegin();
-          for (size_t i = 0; s.ok() && i < read_buffer_.replay_buffer().size();
-               i++) {
-            auto& e = read_buffer_.replay_buffer()[i];
-            s = ApplyVersionEdit(e, &cfd);
-            if (s.ok()) {
-              recovered_edits++;
-            }
-          }
-          if (s.ok()) {
-            read_buffer_.Clear();
-            s = OnAtomicGroupReplayEnd();
-          }
-        }
-      } else {
-        s = ApplyVersionEdit(edit, &cfd);
-        if (s.ok()) {
-          recovered_edits++;
-        }
+  } else {
+    while (reader.LastRecordEnd() < max_manifest_read_size_ && s.ok() &&
+           reader.ReadRecord(&record, &scratch) && log_read_status->ok()) {
+      VersionEdit edit;
+      s = edit.DecodeFrom(record);
+      if (s.ok()) {
+        s = ApplyDecodedEdit(edit, &recovered_edits);
       }
     }
   }
@@ -97,6 +80,121 @@ void VersionEditHandlerBase::Iterate(log::Reader& reader,
                            &recovered_edits);
 }
 
+Status VersionEditHandlerBase::ApplyDecodedEdit(VersionEdit& edit,
+                                                size_t* recovered_edits) {
+  Status s = read_buffer_.AddEdit(&edit);
+  if (s.ok()) {
+    ColumnFamilyData* cfd = nullptr;
+    if (edit.IsInAtomicGroup()) {
+      if (read_buffer_.IsFull()) {
+        s = OnAtomicGroupReplayBegin();
+        for (size_t i = 0; s.ok() && i < read_buffer_.replay_buffer().size();
+             i++) {
+          auto& e = read_buffer_.replay_buffer()[i];
+          s = ApplyVersionEdit(e, &cfd);
+          if (s.ok()) {
+            (*recovered_edits)++;
+          }
+        }
+        if (s.ok()) {
+          read_buffer_.Clear();
+          s = OnAtomicGroupReplayEnd();
+        }
+      }
+    } else {
+      s = ApplyVersionEdit(edit, &cfd);
+      if (s.ok()) {
+        (*recovered_edits)++;
+      }
+    }
+  }
+  return s;
+}
+
+namespace {
+struct DecodedEditBatch {
+  std::vector<VersionEdit> edits;
+  // Of the record following the edits, if it failed to decode
+  Status status;
+};
+}  // anonymous namespace
+
+Status VersionEditHandlerBase::IteratePipelined(log::Reader& reader,
+                                                Status* log_read_status,
+                                                size_t* recovered_edits) {
+  // Enough to keep both threads busy, with a bounded memory use
+  constexpr size_t kEditsPerBatch = 64;
+  constexpr size_t kMaxPendingBatches = 16;
+  WorkQueue<std::shared_ptr<DecodedEditBatch>> queue(kMaxPendingBatches);
+  std::atomic<bool> stop_decoding{false};
+  std::atomic<bool> decoded_all{false};
+
+  // Only the decoding thread uses the reader, and so log_read_status, until
+  // it is joined
+  port::Thread decoder([&]() {
+    Slice record;
+    std::string scratch;
+    bool more = true;
+    while (more && !stop_decoding.load(std::memory_order_relaxed)) {
+      auto batch = std::make_shared<DecodedEditBatch>();
+      batch->edits.reserve(kEditsPerBatch);
+      while (batch->edits.size() < kEditsPerBatch) {
+        if (reader.LastRecordEnd() >= max_manifest_read_size_ ||
+            !reader.ReadRecord(&record, &scratch) || !log_read_status->ok()) {
+          more = false;
+          break;
+        }
+        batch->edits.emplace_back();
+        VersionEdit& edit = batch->edits.back();
+        batch->status = edit.DecodeFrom(record);
+        if (!batch->status.ok()) {
+          batch->edits.pop_back();
+          more = false;
+          break;
+        }
+        for (const auto& deleted_file : edit.GetDeletedFiles()) {
+          manifest_deleted_files_.insert(deleted_file.second);
+        }
+        if (edit.IsColumnFamilyDrop()) {
+          manifest_dropped_cfs_.insert(edit.GetColumnFamily());
+        }
+      }
+      if (!more && batch->status.ok() && log_read_status->ok()) {
+        decoded_all.store(true, std::memory_order_release);
+      }
+      queue.push(std::move(batch));
+    }
+    queue.finish();
+  });
+
+  Status s;
+  bool notified_decoded = false;
+  std::shared_ptr<DecodedEditBatch> batch;
+  while (s.ok() && queue.pop(batch)) {
+    if (!notified_decoded && decoded_all.load(std::memory_order_acquire)) {
+      notified_decoded = true;
+      OnManifestDecoded(manifest_deleted_files_, manifest_dropped_cfs_);
+    }
+    for (auto& edit : batch->edits) {
+      s = ApplyDecodedEdit(edit, recovered_edits);
+      if (!s.ok()) {
+        break;
+      }
+    }
+    if (s.ok()) {
+      s = batch->status;
+    }
+  }
+  if (!s.ok()) {
+    // Unblock the decoding thread
+    stop_decoding.store(true, std::memory_order_relaxed);
+    while (queue.pop(batch)) {
+    }
+  }
+  decoder.join();
+  return s;
+}
+
 Status ListColumnFamiliesHandler::ApplyVersionEdit(
     VersionEdit& edit, ColumnFamilyData** /*unused*/) {
   Status s;
@@ -213,9 +311,115 @@ Status VersionEditHandler::ApplyVersionEdit(VersionEdit& edit,
     assert(cfd != nullptr);
     s = ExtractInfoFromVersionEdit(*cfd, edit);
   }
+  if (s.ok() && table_load_queue_ && *cfd != nullptr) {
+    auto builder_iter = builders_.find((*cfd)->GetID());
+    if (builder_iter != builders_.end()) {
+      VersionBuilder* builder = builder_iter->second->version_builder();
+      for (const auto& new_file : edit.GetNewFiles()) {
+        FileMetaData* file_meta = builder->GetAddedFile(
+            new_file.first, new_file.second.fd.GetNumber());
+        if (file_meta != nullptr) {
+          MaybeLoadTableEarly(*cfd, builder, file_meta, new_file.first);
+        }
+      }
+    }
+  }
   return s;
 }
 
+void VersionEditHandler::OnManifestDecoded(
+    const std::unordered_set<uint64_t>& deleted_files,
+    const std::unordered_set<uint32_t>& dropped_cfs) {
+  bool skip_load_table_files = skip_load_table_files_;
+  TEST_SYNC_POINT_CALLBACK(
+      "VersionEditHandler::LoadTables:skip_load_table_files",
+      &skip_load_table_files);
+  if (skip_load_table_files) {
+    return;
+  }
+  assert(!table_load_queue_);
+  early_load_deleted_files_ = &deleted_files;
+  early_load_dropped_cfs_ = &dropped_cfs;
+  table_load_queue_.reset(new WorkQueue<TableLoadTask>());
+  int num_threads =
+      std::max(1, version_set_->db_options_->max_file_opening_threads);
+  for (int i = 0; i < num_threads; i++) {
+    table_load_threads_.emplace_back([this]() {
+      TableLoadTask task;
+      while (table_load_queue_->pop(task)) {
+        const MutableCFOptions* moptions =
+            task.cfd->GetLatestMutableCFOptions();
+        // LoadTables() reports the errors, when it retries the file
+        task.builder
+            ->LoadTableHandler(task.file_meta, task.level,
+                               task.cfd->internal_stats(),
+                               /*prefetch_index_and_filter_in_cache=*/false,
+                               moptions->prefix_extractor,
+                               MaxFileSizeForL0MetaPin(*moptions),
+                               read_options_,
+                               moptions->block_protection_bytes_per_key)
+            .PermitUncheckedError();
+      }
+    });
+  }
+
+  // The files added by the edits already applied
+  std::vector<std::pair<FileMetaData*, int>> files;
+  for (const auto& builder_pair : builders_) {
+    ColumnFamilyData* cfd =
+        version_set_->GetColumnFamilySet()->GetColumnFamily(
+            builder_pair.first);
+    assert(cfd != nullptr);
+    VersionBuilder* builder = builder_pair.second->version_builder();
+    files.clear();
+    builder->GetAddedFiles(&files);
+    for (const auto& file : files) {
+      MaybeLoadTableEarly(cfd, builder, file.first, file.second);
+    }
+  }
+}
+
+void VersionEditHandler::MaybeLoadTableEarly(ColumnFamilyData* cfd,
+                                             VersionBuilder* builder,
+                                             FileMetaData* file_meta,
+                                             int level) {
+  assert(table_load_queue_);
+  // Only when LoadTables() would open all the files, and the file stays
+  // until the end of the MANIFEST, along with its builder
+  if (!builder->LoadsAllTableHandlers() ||
+      file_meta->table_reader_handle != nullptr ||
+      builder->DefersTableLoad(*file_meta) ||
+      early_load_deleted_files_->count(file_meta->fd.GetNumber()) > 0 ||
+      early_load_dropped_cfs_->count(cfd->GetID()) > 0) {
+    return;
+  }
+  if (read_only_) {
+    cfd->table_cache()->SetTablesAreImmortal();
+  }
+  TableLoadTask task;
+  task.cfd = cfd;
+  task.builder = builder;
+  task.file_meta = file_meta;
+  task.level = level;
+  TEST_SYNC_POINT_CALLBACK("VersionEditHandler::MaybeLoadTableEarly:Queue",
+                           file_meta);
+  table_load_queue_->push(task);
+}
+
+void VersionEditHandler::FinishEarlyTableLoading() {
+  if (!table_load_queue_) {
+    return;
+  }
+  table_load_queue_->finish();
+  for (auto& thread : table_load_threads_) {
+    thread.join();
+  }
+  table_load_threads_.clear();
+  table_load_queue_.reset();
+  early_load_deleted_files_ = nullptr;
+  early_load_dropped_cfs_ = nullptr;
+}
+
 Status VersionEditHandler::OnColumnFamilyAdd(VersionEdit& edit,
                                              ColumnFamilyData** cfd) {
   bool cf_in_not_found = false;
@@ -374,6 +578,7 @@ void VersionEditHandler::CheckColumnFamilyId(const VersionEdit& edit,
 void VersionEditHandler::CheckIterationResult(const log::Reader& reader,
                                               Status* s) {
   assert(s != nullptr);
+  FinishEarlyTableLoading();
   if (!s->ok()) {
     // Do nothing here.
   } else if (!version_edit_params_.HasLogNumber() ||
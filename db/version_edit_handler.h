@@ -9,9 +9,12 @@
 
 #pragma once
 
+#include <unordered_set>
+
 #include "db/version_builder.h"
 #include "db/version_edit.h"
 #include "db/version_set.h"
+#include "util/work_queue.h"
 
 namespace ROCKSDB_NAMESPACE {
 
@@ -25,7 +28,10 @@ class VersionEditHandlerBase {
 
   virtual ~VersionEditHandlerBase() {}
 
-  void Iterate(log::Reader& reader, Status* log_read_status);
+  // With `pipelined`, the records are read and decoded on another thread
+  // while the edits are applied
+  void Iterate(log::Reader& reader, Status* log_read_status,
+               bool pipelined = false);
 
   const Status& status() const { return status_; }
 
@@ -46,6 +52,14 @@ class VersionEditHandlerBase {
   virtual void CheckIterationResult(const log::Reader& /*reader*/,
                                     Status* /*s*/) {}
 
+  // In a pipelined Iterate(), called once the whole MANIFEST is decoded,
+  // possibly before all its edits are applied, with the numbers of the files
+  // it deletes and the IDs of the column families it drops. They stay valid
+  // for the lifetime of the handler.
+  virtual void OnManifestDecoded(
+      const std::unordered_set<uint64_t>& /*deleted_files*/,
+      const std::unordered_set<uint32_t>& /*dropped_cfs*/) {}
+
   void ClearReadBuffer() { read_buffer_.Clear(); }
 
   Status status_;
@@ -53,8 +67,15 @@ class VersionEditHandlerBase {
   const ReadOptions& read_options_;
 
  private:
+  Status ApplyDecodedEdit(VersionEdit& edit, size_t* recovered_edits);
+  Status IteratePipelined(log::Reader& reader, Status* log_read_status,
+                          size_t* recovered_edits);
+
   AtomicGroupReadBuffer read_buffer_;
   const uint64_t max_manifest_read_size_;
+  // Set by the decoding thread of a pipelined Iterate()
+  std::unordered_set<uint64_t> manifest_deleted_files_;
+  std::unordered_set<uint32_t> manifest_dropped_cfs_;
 };
 
 class ListColumnFamiliesHandler : public VersionEditHandlerBase {
@@ -127,7 +148,7 @@ class VersionEditHandler : public VersionEditHandlerBase {
             no_error_if_files_missing, io_tracer, read_options,
             /*skip_load_table_files=*/false, epoch_number_requirement) {}
 
-  ~VersionEditHandler() override {}
+  ~VersionEditHandler() override { FinishEarlyTableLoading(); }
 
   const VersionEditParams& GetVersionEditParams() const {
     return version_edit_params_;
@@ -185,6 +206,12 @@ class VersionEditHandler : public VersionEditHandlerBase {
 
   virtual bool MustOpenAllColumnFamilies() const { return !read_only_; }
 
+  // Starts opening the tables of the files the rest of the MANIFEST doesn't
+  // delete, instead of waiting for LoadTables()
+  void OnManifestDecoded(const std::unordered_set<uint64_t>& deleted_files,
+                         const std::unordered_set<uint32_t>& dropped_cfs)
+      override;
+
   const bool read_only_;
   std::vector<ColumnFamilyDescriptor> column_families_;
   VersionSet* version_set_;
@@ -221,6 +248,26 @@ class VersionEditHandler : public VersionEditHandlerBase {
   // user comparator.
   Status MaybeHandleFileBoundariesForNewFiles(VersionEdit& edit,
                                               const ColumnFamilyData* cfd);
+
+  struct TableLoadTask {
+    ColumnFamilyData* cfd = nullptr;
+    VersionBuilder* builder = nullptr;
+    FileMetaData* file_meta = nullptr;
+    int level = 0;
+  };
+
+  // Queues the early opening of the table of `file_meta`, if the MANIFEST
+  // deletes neither the file nor its column family
+  void MaybeLoadTableEarly(ColumnFamilyData* cfd, VersionBuilder* builder,
+                           FileMetaData* file_meta, int level);
+  // Waits for the tables being opened early
+  void FinishEarlyTableLoading();
+
+  // Set by OnManifestDecoded() while the tables are opened early
+  const std::unordered_set<uint64_t>* early_load_deleted_files_ = nullptr;
+  const std::unordered_set<uint32_t>* early_load_dropped_cfs_ = nullptr;
+  std::unique_ptr<WorkQueue<TableLoadTask>> table_load_queue_;
+  std::vector<port::Thread> table_load_threads_;
 };
 
 // A class similar to its base class, i.e. VersionEditHandler.
@@ -59,6 +59,7 @@
 #include "monitoring/perf_context_imp.h"
 #include "monitoring/persistent_stats_history.h"
 #include "options/options_helper.h"
+#include "rocksdb/compaction_cost_model.h"
 #include "rocksdb/env.h"
 #include "rocksdb/merge_operator.h"
 #include "rocksdb/write_buffer_manager.h"
@@ -76,6 +77,7 @@
 #include "util/cast_util.h"
 #include "util/coding.h"
 #include "util/coro_utils.h"
+#include "util/math.h"
 #include "util/stop_watch.h"
 #include "util/string_util.h"
 #include "util/user_comparator_wrapper.h"
@@ -114,11 +116,46 @@ Status SerializeReplicationLogManifestWrite(
   return Status::OK();
 }
 
+namespace {
+// The 8 bytes of `user_key` from `offset` on, zero-padded, in a big-endian
+// integer so that the integers compare as the bytes do
+uint64_t PackKeyPrefix(const Slice& user_key, size_t offset) {
+  char buf[sizeof(uint64_t)] = {};
+  if (offset < user_key.size()) {
+    memcpy(buf, user_key.data() + offset,
+           std::min(sizeof(buf), user_key.size() - offset));
+  }
+  uint64_t prefix;
+  memcpy(&prefix, buf, sizeof(prefix));
+  return port::kLittleEndian ? EndianSwapValue(prefix) : prefix;
+}
+}  // anonymous namespace
+
 // Find File in LevelFilesBrief data structure
 // Within an index range defined by left and right
 int FindFileInRange(const InternalKeyComparator& icmp,
                     const LevelFilesBrief& file_level, const Slice& key,
                     uint32_t left, uint32_t right) {
+  if (file_level.largest_key_prefixes != nullptr && left < right) {
+    // The order of the prefixes is that of the keys, so only the files whose
+    // prefix is that of `key` are left to compare
+    const Slice user_key = ExtractUserKey(key);
+    const Slice& common = file_level.largest_key_common_prefix;
+    const int r = memcmp(user_key.data(), common.data(),
+                         std::min(user_key.size(), common.size()));
+    if (r < 0 || (r == 0 && user_key.size() < common.size())) {
+      return static_cast<int>(left);
+    } else if (r > 0) {
+      return static_cast<int>(right);
+    }
+    const uint64_t prefix = PackKeyPrefix(user_key, common.size());
+    const uint64_t* prefixes = file_level.largest_key_prefixes;
+    const uint64_t* lo =
+        std::lower_bound(prefixes + left, prefixes + right, prefix);
+    const uint64_t* hi = std::upper_bound(lo, prefixes + right, prefix);
+    left = static_cast<uint32_t>(lo - prefixes);
+    right = static_cast<uint32_t>(hi - prefixes);
+  }
   auto cmp = [&](const FdWithKeyRange& f, const Slice& k) -> bool {
     return icmp.InternalKeyComparator::Compare(f.largest_key, k) < 0;
   };
@@ -165,7 +202,8 @@ class FilePicker {
  public:
   FilePicker(const Slice& user_key, const Slice& ikey,
              autovector<LevelFilesBrief>* file_levels, unsigned int num_levels,
-             FileIndexer* file_indexer, const Comparator* user_comparator,
+             FileIndexer* file_indexer, const L0FileIndex* l0_file_index,
+             const Comparator* user_comparator,
              const InternalKeyComparator* internal_comparator)
       : num_levels_(num_levels),
         curr_level_(static_cast<unsigned int>(-1)),
@@ -179,6 +217,7 @@ class FilePicker {
         user_key_(user_key),
         ikey_(ikey),
         file_indexer_(file_indexer),
+        l0_file_index_(l0_file_index),
         user_comparator_(user_comparator),
         internal_comparator_(internal_comparator) {
     // Setup member variables to search first level.
@@ -198,6 +237,19 @@ class FilePicker {
 
   FdWithKeyRange* GetNextFile() {
     while (!search_ended_) {  // Loops over different levels.
+      if (l0_files_ != nullptr) {
+        // The L0 files containing the key, from the L0 file index
+        if (l0_file_pos_ < l0_num_files_) {
+          const uint32_t index = l0_files_[l0_file_pos_++];
+          hit_file_level_ = curr_level_;
+          returned_file_level_ = curr_level_;
+          is_hit_file_last_in_level_ = index == curr_file_level_->num_files - 1;
+          return &curr_file_level_->files[index];
+        }
+        l0_files_ = nullptr;
+        search_ended_ = !PrepareNextLevel();
+        continue;
+      }
       while (curr_index_in_curr_level_ < curr_file_level_->num_files) {
         // Loops over all files in current level.
         FdWithKeyRange* f = &curr_file_level_->files[curr_index_in_curr_level_];
@@ -289,6 +341,11 @@ class FilePicker {
   Slice user_key_;
   Slice ikey_;
   FileIndexer* file_indexer_;
+  const L0FileIndex* l0_file_index_;
+  // With an L0 file index, the positions of the L0 files to search
+  const uint32_t* l0_files_ = nullptr;
+  uint32_t l0_num_files_ = 0;
+  uint32_t l0_file_pos_ = 0;
   const Comparator* user_comparator_;
   const InternalKeyComparator* internal_comparator_;
 
@@ -320,7 +377,17 @@ class FilePicker {
       // are always compacted into a single entry).
       int32_t start_index;
       if (curr_level_ == 0) {
-        // On Level-0, we read through all files to check for overlap.
+        if (l0_file_index_ != nullptr && !l0_file_index_->empty()) {
+          l0_files_ = l0_file_index_->GetFiles(user_key_, &l0_num_files_);
+          l0_file_pos_ = 0;
+          if (l0_num_files_ == 0) {
+            l0_files_ = nullptr;
+            curr_level_++;
+            continue;
+          }
+        }
+        // Otherwise on Level-0, we read through all files to check for
+        // overlap.
         start_index = 0;
       } else {
         // On Level-n (n>=1), files are sorted. Binary search to find the
@@ -895,7 +962,7 @@ int FindFile(const InternalKeyComparator& icmp,
 
 void DoGenerateLevelFilesBrief(LevelFilesBrief* file_level,
                                const std::vector<FileMetaData*>& files,
-                               Arena* arena) {
+                               Arena* arena, const Comparator* ucmp) {
   assert(file_level);
   assert(arena);
 
@@ -921,6 +988,25 @@ void DoGenerateLevelFilesBrief(LevelFilesBrief* file_level,
     f.smallest_key = Slice(mem, smallest_size);
     f.largest_key = Slice(mem + smallest_size, largest_size);
   }
+
+  file_level->largest_key_common_prefix = Slice();
+  file_level->largest_key_prefixes = nullptr;
+  if (ucmp != BytewiseComparator() || num == 0) {
+    return;
+  }
+  // The keys being sorted, the common prefix of all of them is that of the
+  // first and the last
+  const Slice first = ExtractUserKey(file_level->files[0].largest_key);
+  const Slice last = ExtractUserKey(file_level->files[num - 1].largest_key);
+  file_level->largest_key_common_prefix =
+      Slice(first.data(), first.difference_offset(last));
+  mem = arena->AllocateAligned(num * sizeof(uint64_t));
+  file_level->largest_key_prefixes = reinterpret_cast<uint64_t*>(mem);
+  for (size_t i = 0; i < num; i++) {
+    file_level->largest_key_prefixes[i] =
+        PackKeyPrefix(ExtractUserKey(file_level->files[i].largest_key),
+                      file_level->largest_key_common_prefix.size());
+  }
 }
 
 static bool AfterFile(const Comparator* ucmp, const Slice* user_key,
@@ -1032,6 +1118,12 @@ class LevelIterator final : public InternalIterator {
   // tombstones alive even when all point keys in an SST file are exhausted.
   // These sentinel keys will be skipped in merging iterator.
   void Seek(const Slice& target) override;
+  void StartSeek(const Slice& target) override {
+    if (read_options_.async_io) {
+      // Returns once the read of the data block is submitted
+      Seek(target);
+    }
+  }
   void SeekForPrev(const Slice& target) override;
   void SeekToFirst() override;
   void SeekToLast() override;
@@ -1091,6 +1183,14 @@ class LevelIterator final : public InternalIterator {
     }
   }
 
+  void SetPrefetchScheduler(
+      ScanPrefetchScheduler* prefetch_scheduler) override {
+    prefetch_scheduler_ = prefetch_scheduler;
+    if (file_iter_.iter()) {
+      file_iter_.iter()->SetPrefetchScheduler(prefetch_scheduler);
+    }
+  }
+
   bool IsKeyPinned() const override {
     return pinned_iters_mgr_ && pinned_iters_mgr_->PinningEnabled() &&
            file_iter_.iter() && file_iter_.IsKeyPinned();
@@ -1103,6 +1203,15 @@ class LevelIterator final : public InternalIterator {
 
   bool IsDeleteRangeSentinelKey() const override { return to_return_sentinel_; }
 
+  bool IsAtDataBlockStart(Slice* block_upper_bound) override {
+    return file_iter_.Valid() &&
+           file_iter_.iter()->IsAtDataBlockStart(block_upper_bound);
+  }
+
+  Status GetRawDataBlock(RawDataBlock* block) override {
+    return file_iter_.iter()->GetRawDataBlock(block);
+  }
+
   void SetRangeDelReadSeqno(SequenceNumber read_seq) override {
     read_seq_ = read_seq;
   }
@@ -1145,7 +1254,7 @@ class LevelIterator final : public InternalIterator {
     assert(file_index_ < flevel_->num_files);
     auto file_meta = flevel_->files[file_index_];
     if (should_sample_) {
-      sample_file_read_inc(file_meta.file_metadata);
+      sample_file_seek_inc(file_meta.file_metadata);
     }
 
     const InternalKey* smallest_compaction_key = nullptr;
@@ -1198,6 +1307,7 @@ class LevelIterator final : public InternalIterator {
   RangeDelAggregator* range_del_agg_;
   IteratorWrapper file_iter_;  // May be nullptr
   PinnedIteratorsManager* pinned_iters_mgr_;
+  ScanPrefetchScheduler* prefetch_scheduler_ = nullptr;
 
   // To be propagated to RangeDelAggregator in order to safely truncate range
   // tombstones.
@@ -1546,6 +1656,9 @@ void LevelIterator::SetFileIterator(InternalIterator* iter) {
   if (pinned_iters_mgr_ && iter) {
     iter->SetPinnedItersMgr(pinned_iters_mgr_);
   }
+  if (prefetch_scheduler_ && iter) {
+    iter->SetPrefetchScheduler(prefetch_scheduler_);
+  }
 
   InternalIterator* old_iter = file_iter_.Set(iter);
 
@@ -1555,6 +1668,11 @@ void LevelIterator::SetFileIterator(InternalIterator* iter) {
   }
 
   if (pinned_iters_mgr_ && pinned_iters_mgr_->PinningEnabled()) {
+    // A pinned iterator is not read again, and must not hold slots of the
+    // scan until the pinned data is released
+    if (prefetch_scheduler_ && old_iter) {
+      old_iter->SetPrefetchScheduler(nullptr);
+    }
     pinned_iters_mgr_->PinIterator(old_iter);
   } else {
     delete old_iter;
@@ -1605,7 +1723,15 @@ Status Version::GetTableProperties(const ReadOptions& read_options,
     return s;
   }
 
-  // 2. Table is not present in table cache, we'll read the table properties
+  // 2. A table not opened since recovery may be in the table summary.
+  if (vset_ != nullptr) {
+    *tp = vset_->GetSummarizedTableProperties(*file_meta);
+    if (*tp != nullptr) {
+      return Status::OK();
+    }
+  }
+
+  // 3. Table is not present in table cache, we'll read the table properties
   // directly from the properties block in the file.
   std::unique_ptr<FSRandomAccessFile> file;
   std::string file_name;
@@ -1846,6 +1972,14 @@ void Version::GetColumnFamilyMetaData(ColumnFamilyMetaData* cf_meta) {
           file->oldest_blob_file_number, file->TryGetOldestAncesterTime(),
           file->TryGetFileCreationTime(), file->epoch_number,
           file->file_checksum, file->file_checksum_func_name);
+      files.back().num_seeks_sampled =
+          file->stats.num_seeks_sampled.load(std::memory_order_relaxed);
+      files.back().num_reads_sampled_last_window =
+          file->stats.num_reads_sampled_last_window.load(
+              std::memory_order_relaxed);
+      files.back().num_seeks_sampled_last_window =
+          file->stats.num_seeks_sampled_last_window.load(
+              std::memory_order_relaxed);
       files.back().num_entries = file->num_entries;
       files.back().num_deletions = file->num_deletions;
       files.back().smallest = file->smallest.Encode().ToString();
@@ -1928,7 +2062,6 @@ void Version::GetCreationTimeOfOldestFile(uint64_t* creation_time) {
   uint64_t oldest_time = std::numeric_limits<uint64_t>::max();
   for (int level = 0; level < storage_info_.num_non_empty_levels_; level++) {
     for (FileMetaData* meta : storage_info_.LevelFiles(level)) {
-      assert(meta->fd.table_reader != nullptr);
       uint64_t file_creation_time = meta->TryGetFileCreationTime();
       if (file_creation_time == kUnknownFileCreationTime) {
         *creation_time = 0;
@@ -2075,7 +2208,7 @@ void Version::AddIteratorsForLevel(const ReadOptions& read_options,
       // If users execute one range query per iterator, there may be some
       // discrepancy here.
       for (FileMetaData* meta : storage_info_.LevelFiles(0)) {
-        sample_file_read_inc(meta);
+        sample_file_seek_inc(meta);
       }
     }
   } else if (storage_info_.LevelFilesBrief(level).num_files > 0) {
@@ -2181,6 +2314,7 @@ VersionStorageInfo::VersionStorageInfo(
       num_levels_(levels),
       num_non_empty_levels_(0),
       file_indexer_(user_comparator),
+      l0_file_index_(user_comparator),
       compaction_style_(compaction_style),
       files_(new std::vector<FileMetaData*>[num_levels_]),
       base_level_(num_levels_ == 1 ? -1 : 1),
@@ -2315,6 +2449,52 @@ Status Version::GetBlob(const ReadOptions& read_options, const Slice& user_key,
   return s;
 }
 
+void Version::MultiGetBlob(const ReadOptions& read_options,
+                           const std::vector<Slice>& user_keys,
+                           const std::vector<BlobIndex>& blob_indexes,
+                           std::vector<PinnableSlice>* values,
+                           std::vector<Status>* statuses,
+                           uint64_t* bytes_read) const {
+  assert(user_keys.size() == blob_indexes.size());
+  assert(values && values->size() == blob_indexes.size());
+  assert(statuses && statuses->size() == blob_indexes.size());
+
+  std::map<uint64_t, autovector<BlobReadRequest>> reqs_by_file;
+  for (size_t i = 0; i < blob_indexes.size(); ++i) {
+    const BlobIndex& blob_index = blob_indexes[i];
+    (*values)[i].Reset();
+
+    if (blob_index.HasTTL() || blob_index.IsInlined()) {
+      (*statuses)[i] = Status::Corruption("Unexpected TTL/inlined blob index");
+      continue;
+    }
+
+    reqs_by_file[blob_index.file_number()].emplace_back(
+        user_keys[i], blob_index.offset(), blob_index.size(),
+        blob_index.compression(), &(*values)[i], &(*statuses)[i]);
+  }
+
+  autovector<BlobFileReadRequests> blob_reqs;
+  for (auto& file_reqs : reqs_by_file) {
+    const uint64_t file_number = file_reqs.first;
+    const auto blob_file_meta = storage_info_.GetBlobFileMetaData(file_number);
+    if (!blob_file_meta) {
+      for (auto& req : file_reqs.second) {
+        *req.status = Status::Corruption("Invalid blob file number");
+      }
+      continue;
+    }
+    blob_reqs.emplace_back(file_number, blob_file_meta->GetBlobFileSize(),
+                           std::move(file_reqs.second));
+  }
+
+  *bytes_read = 0;
+  if (!blob_reqs.empty()) {
+    assert(blob_source_);
+    blob_source_->MultiGetBlob(read_options, blob_reqs, bytes_read);
+  }
+}
+
 void Version::MultiGetBlob(
     const ReadOptions& read_options, MultiGetRange& range,
     std::unordered_map<uint64_t, BlobReadContexts>& blob_ctxs) {
@@ -2448,8 +2628,8 @@ void Version::Get(const ReadOptions& read_options, const LookupKey& k,
 
   FilePicker fp(user_key, ikey, &storage_info_.level_files_brief_,
                 storage_info_.num_non_empty_levels_,
-                &storage_info_.file_indexer_, user_comparator(),
-                internal_comparator());
+                &storage_info_.file_indexer_, &storage_info_.l0_file_index_,
+                user_comparator(), internal_comparator());
   FdWithKeyRange* f = fp.GetNextFile();
 
   while (f != nullptr) {
@@ -2463,7 +2643,7 @@ void Version::Get(const ReadOptions& read_options, const LookupKey& k,
     }
 
     bool timer_enabled =
-        GetPerfLevel() >= PerfLevel::kEnableTimeExceptForMutex &&
+        PerfLevelEnabled(PerfLevel::kEnableTimeExceptForMutex) &&
         get_perf_context()->per_level_perf_context_enabled;
     StopWatchNano timer(clock_, timer_enabled /* auto_start */);
     *status = table_cache_->Get(
@@ -3136,7 +3316,21 @@ void VersionStorageInfo::GenerateLevelFilesBrief() {
   level_files_brief_.resize(num_non_empty_levels_);
   for (int level = 0; level < num_non_empty_levels_; level++) {
     DoGenerateLevelFilesBrief(&level_files_brief_[level], files_[level],
-                              &arena_);
+                              &arena_,
+                              level > 0 ? user_comparator_ : nullptr);
+  }
+  if (num_non_empty_levels_ > 0) {
+    l0_file_index_.UpdateIndex(level_files_brief_[0]);
+  }
+  level_files_size_sums_.resize(num_non_empty_levels_);
+  for (int level = 0; level < num_non_empty_levels_; level++) {
+    const ROCKSDB_NAMESPACE::LevelFilesBrief& brief = level_files_brief_[level];
+    std::vector<uint64_t>& sums = level_files_size_sums_[level];
+    sums.resize(brief.num_files + 1);
+    sums[0] = 0;
+    for (size_t i = 0; i < brief.num_files; i++) {
+      sums[i + 1] = sums[i] + brief.files[i].fd.GetFileSize();
+    }
   }
 }
 
@@ -3667,7 +3861,8 @@ void VersionStorageInfo::ComputeCompactionScore(
       }
     }
   }
-  ComputeFilesMarkedForCompaction(max_output_level);
+  ComputeFilesMarkedForCompaction(
+      max_output_level, mutable_cf_options.range_deletion_compaction_ratio);
   ComputeBottommostFilesMarkedForCompaction(
       immutable_options.allow_ingest_behind);
   ComputeExpiredTtlFiles(immutable_options, mutable_cf_options.ttl);
@@ -3682,7 +3877,8 @@ void VersionStorageInfo::ComputeCompactionScore(
   EstimateCompactionBytesNeeded(mutable_cf_options);
 }
 
-void VersionStorageInfo::ComputeFilesMarkedForCompaction(int last_level) {
+void VersionStorageInfo::ComputeFilesMarkedForCompaction(
+    int last_level, double range_deletion_compaction_ratio) {
   files_marked_for_compaction_.clear();
   int last_qualify_level = 0;
 
@@ -3698,7 +3894,17 @@ void VersionStorageInfo::ComputeFilesMarkedForCompaction(int last_level) {
 
   for (int level = 0; level <= last_qualify_level; level++) {
     for (auto* f : files_[level]) {
-      if (!f->being_compacted && f->marked_for_compaction) {
+      if (f->being_compacted) {
+        continue;
+      }
+      // compensated_range_deletion_size estimates the bytes the file's range
+      // tombstones cover in the levels below it
+      if (f->marked_for_compaction ||
+          (range_deletion_compaction_ratio > 0 &&
+           f->compensated_range_deletion_size > 0 &&
+           static_cast<double>(f->compensated_range_deletion_size) >
+               range_deletion_compaction_ratio *
+                   static_cast<double>(f->fd.GetFileSize()))) {
         files_marked_for_compaction_.emplace_back(level, f);
       }
     }
@@ -4002,13 +4208,17 @@ void VersionStorageInfo::UpdateNumNonEmptyLevels() {
 }
 
 namespace {
-// Sort `temp` based on ratio of overlapping size over file size
+// Sort `temp` based on ratio of overlapping size over file size. If
+// `by_reads`, the ratio is divided by the number of reads sampled from the
+// file, and files without sampled reads go last.
 void SortFileByOverlappingRatio(
     const InternalKeyComparator& icmp, const std::vector<FileMetaData*>& files,
     const std::vector<FileMetaData*>& next_level_files, SystemClock* clock,
-    int level, int num_non_empty_levels, uint64_t ttl,
+    int level, int num_non_empty_levels, uint64_t ttl, bool by_reads,
     std::vector<Fsize>* temp) {
   std::unordered_map<uint64_t, uint64_t> file_to_order;
+  // With `by_reads`, the ratio per read, or a negative value without reads
+  std::unordered_map<uint64_t, double> file_to_order_by_reads;
   auto next_level_it = next_level_files.begin();
 
   int64_t curr_time;
@@ -4046,7 +4256,40 @@ void SortFileByOverlappingRatio(
     file_to_order[file->fd.GetNumber()] = overlapping_bytes * 1024U /
                                           file->compensated_file_size /
                                           ttl_boost_score;
-  }
+    if (by_reads) {
+      uint64_t num_reads =
+          file->stats.num_reads_sampled.load(std::memory_order_relaxed);
+      file_to_order_by_reads[file->fd.GetNumber()] =
+          num_reads == 0
+              ? -1.0
+              : static_cast<double>(overlapping_bytes) /
+                    static_cast<double>(file->compensated_file_size) /
+                    static_cast<double>(ttl_boost_score) /
+                    static_cast<double>(num_reads);
+    }
+  }
+
+  // Returns a negative, zero or positive value as the file numbered `file1`
+  // is to be compacted before, along with or after the one numbered `file2`
+  auto compare_order = [&](uint64_t file1, uint64_t file2) -> int {
+    if (by_reads) {
+      double order1 = file_to_order_by_reads[file1];
+      double order2 = file_to_order_by_reads[file2];
+      if ((order1 < 0) != (order2 < 0)) {
+        return order1 < 0 ? 1 : -1;
+      }
+      if (order1 >= 0 && order1 != order2) {
+        return order1 < order2 ? -1 : 1;
+      }
+      // Files without reads are ordered by their overlapping ratio
+    }
+    uint64_t order1 = file_to_order[file1];
+    uint64_t order2 = file_to_order[file2];
+    if (order1 == order2) {
+      return 0;
+    }
+    return order1 < order2 ? -1 : 1;
+  };
 
   size_t num_to_sort = temp->size() > VersionStorageInfo::kNumberFilesToSort
                            ? VersionStorageInfo::kNumberFilesToSort
@@ -4060,13 +4303,13 @@ void SortFileByOverlappingRatio(
                       // extend.
                       if (f1.file->marked_for_compaction ==
                           f2.file->marked_for_compaction) {
-                        if (file_to_order[f1.file->fd.GetNumber()] ==
-                            file_to_order[f2.file->fd.GetNumber()]) {
+                        int cmp = compare_order(f1.file->fd.GetNumber(),
+                                                f2.file->fd.GetNumber());
+                        if (cmp == 0) {
                           return icmp.Compare(f1.file->smallest,
                                               f2.file->smallest) < 0;
                         }
-                        return file_to_order[f1.file->fd.GetNumber()] <
-                               file_to_order[f2.file->fd.GetNumber()];
+                        return cmp < 0;
                       } else {
                         return f1.file->marked_for_compaction >
                                f2.file->marked_for_compaction;
@@ -4074,6 +4317,60 @@ void SortFileByOverlappingRatio(
                     });
 }
 
+// Sort `temp` based on the cost of compacting each file into the next level
+// under `cost_model`
+void SortFileByCompactionCost(
+    const InternalKeyComparator& icmp, const CompactionCostModel& cost_model,
+    const std::vector<FileMetaData*>& files,
+    const std::vector<FileMetaData*>& next_level_files, int level,
+    uint64_t target_file_size, std::vector<Fsize>* temp) {
+  std::unordered_map<uint64_t, double> file_to_cost;
+  auto next_level_it = next_level_files.begin();
+
+  for (auto& file : files) {
+    CompactionCostModel::FileCandidate candidate;
+    candidate.level = level;
+    candidate.file_size = file->fd.file_size;
+    candidate.compensated_file_size = file->compensated_file_size;
+    candidate.target_file_size = target_file_size;
+    // Same walk over the overlapping files as SortFileByOverlappingRatio()
+    while (next_level_it != next_level_files.end() &&
+           icmp.Compare((*next_level_it)->largest, file->smallest) < 0) {
+      next_level_it++;
+    }
+    while (next_level_it != next_level_files.end() &&
+           icmp.Compare((*next_level_it)->smallest, file->largest) < 0) {
+      candidate.overlapping_bytes += (*next_level_it)->fd.file_size;
+      candidate.num_overlapping_files++;
+      if (icmp.Compare((*next_level_it)->largest, file->largest) > 0) {
+        break;
+      }
+      next_level_it++;
+    }
+    file_to_cost[file->fd.GetNumber()] = cost_model.FileCost(candidate);
+  }
+
+  size_t num_to_sort = temp->size() > VersionStorageInfo::kNumberFilesToSort
+                           ? VersionStorageInfo::kNumberFilesToSort
+                           : temp->size();
+
+  std::partial_sort(temp->begin(), temp->begin() + num_to_sort, temp->end(),
+                    [&](const Fsize& f1, const Fsize& f2) -> bool {
+                      if (f1.file->marked_for_compaction !=
+                          f2.file->marked_for_compaction) {
+                        return f1.file->marked_for_compaction >
+                               f2.file->marked_for_compaction;
+                      }
+                      double cost1 = file_to_cost[f1.file->fd.GetNumber()];
+                      double cost2 = file_to_cost[f2.file->fd.GetNumber()];
+                      if (cost1 == cost2) {
+                        return icmp.Compare(f1.file->smallest,
+                                            f2.file->smallest) < 0;
+                      }
+                      return cost1 < cost2;
+                    });
+}
+
 void SortFileByRoundRobin(const InternalKeyComparator& icmp,
                           std::vector<InternalKey>* compact_cursor,
                           bool level0_non_overlapping, int level,
@@ -4156,36 +4453,49 @@ void VersionStorageInfo::UpdateFilesByCompactionPri(
     if (num > temp.size()) {
       num = temp.size();
     }
-    switch (ioptions.compaction_pri) {
-      case kByCompensatedSize:
-        std::partial_sort(temp.begin(), temp.begin() + num, temp.end(),
-                          CompareCompensatedSizeDescending);
-        break;
-      case kOldestLargestSeqFirst:
-        std::sort(temp.begin(), temp.end(),
-                  [](const Fsize& f1, const Fsize& f2) -> bool {
-                    return f1.file->fd.largest_seqno <
-                           f2.file->fd.largest_seqno;
-                  });
-        break;
-      case kOldestSmallestSeqFirst:
-        std::sort(temp.begin(), temp.end(),
-                  [](const Fsize& f1, const Fsize& f2) -> bool {
-                    return f1.file->fd.smallest_seqno <
-                           f2.file->fd.smallest_seqno;
-                  });
-        break;
-      case kMinOverlappingRatio:
-        SortFileByOverlappingRatio(*internal_comparator_, files_[level],
-                                   files_[level + 1], ioptions.clock, level,
-                                   num_non_empty_levels_, options.ttl, &temp);
-        break;
-      case kRoundRobin:
-        SortFileByRoundRobin(*internal_comparator_, &compact_cursor_,
-                             level0_non_overlapping_, level, &temp);
-        break;
-      default:
-        assert(false);
+    if (ioptions.compaction_cost_model != nullptr &&
+        ioptions.compaction_pri != kRoundRobin) {
+      SortFileByCompactionCost(
+          *internal_comparator_, *ioptions.compaction_cost_model,
+          files_[level], files_[level + 1], level,
+          MaxFileSizeForLevel(options, level + 1, compaction_style_,
+                              base_level_,
+                              ioptions.level_compaction_dynamic_level_bytes),
+          &temp);
+    } else {
+      switch (ioptions.compaction_pri) {
+        case kByCompensatedSize:
+          std::partial_sort(temp.begin(), temp.begin() + num, temp.end(),
+                            CompareCompensatedSizeDescending);
+          break;
+        case kOldestLargestSeqFirst:
+          std::sort(temp.begin(), temp.end(),
+                    [](const Fsize& f1, const Fsize& f2) -> bool {
+                      return f1.file->fd.largest_seqno <
+                             f2.file->fd.largest_seqno;
+                    });
+          break;
+        case kOldestSmallestSeqFirst:
+          std::sort(temp.begin(), temp.end(),
+                    [](const Fsize& f1, const Fsize& f2) -> bool {
+                      return f1.file->fd.smallest_seqno <
+                             f2.file->fd.smallest_seqno;
+                    });
+          break;
+        case kMinOverlappingRatio:
+        case kMinOverlappingRatioByReads:
+          SortFileByOverlappingRatio(
+              *internal_comparator_, files_[level], files_[level + 1],
+              ioptions.clock, level, num_non_empty_levels_, options.ttl,
+              ioptions.compaction_pri == kMinOverlappingRatioByReads, &temp);
+          break;
+        case kRoundRobin:
+          SortFileByRoundRobin(*internal_comparator_, &compact_cursor_,
+                               level0_non_overlapping_, level, &temp);
+          break;
+        default:
+          assert(false);
+      }
     }
     assert(temp.size() == files.size());
 
@@ -6236,7 +6546,7 @@ Status VersionSet::Recover(
         read_only, column_families, const_cast<VersionSet*>(this),
         /*track_missing_files=*/false, no_error_if_files_missing, io_tracer_,
         read_options, EpochNumberRequirement::kMightMissing);
-    handler.Iterate(reader, &log_read_status);
+    handler.Iterate(reader, &log_read_status, /*pipelined=*/true);
     s = handler.status();
     if (s.ok()) {
       log_number = handler.GetVersionEditParams().GetLogNumber();
@@ -6932,6 +7242,39 @@ uint64_t VersionSet::ApproximateSize(const SizeApproximationOptions& options,
                                      Version* v, const Slice& start,
                                      const Slice& end, int start_level,
                                      int end_level, TableReaderCaller caller) {
+  return ApproximateSize(options, read_options, v, start, end, start_level,
+                         end_level, caller, /*ctx=*/nullptr);
+}
+
+void VersionSet::ApproximateSizes(const SizeApproximationOptions& options,
+                                  const ReadOptions& read_options, Version* v,
+                                  const Slice* starts, const Slice* ends,
+                                  size_t n, uint64_t* sizes,
+                                  TableReaderCaller caller) {
+  const auto& icmp = v->cfd_->internal_comparator();
+  std::vector<size_t> order(n);
+  for (size_t i = 0; i < n; i++) {
+    order[i] = i;
+  }
+  std::sort(order.begin(), order.end(), [&](size_t a, size_t b) {
+    return icmp.Compare(starts[a], starts[b]) < 0;
+  });
+
+  ApproximateSizeContext ctx;
+  ctx.start_files.resize(v->storage_info()->num_non_empty_levels(), 0);
+  for (size_t i : order) {
+    sizes[i] = ApproximateSize(options, read_options, v, starts[i], ends[i],
+                               /*start_level=*/0, /*end_level=*/-1, caller,
+                               &ctx);
+  }
+}
+
+uint64_t VersionSet::ApproximateSize(const SizeApproximationOptions& options,
+                                     const ReadOptions& read_options,
+                                     Version* v, const Slice& start,
+                                     const Slice& end, int start_level,
+                                     int end_level, TableReaderCaller caller,
+                                     ApproximateSizeContext* ctx) {
   const auto& icmp = v->cfd_->internal_comparator();
 
   // pre-condition
@@ -6985,11 +7328,15 @@ uint64_t VersionSet::ApproximateSize(const SizeApproximationOptions& options,
     assert(level > 0);
     assert(files_brief.num_files > 0);
 
-    // identify the file position for start key
-    const int idx_start =
-        FindFileInRange(icmp, files_brief, start, 0,
-                        static_cast<uint32_t>(files_brief.num_files - 1));
+    // identify the file position for start key, not before the one of the
+    // previous range of a batch, whose start key is not larger
+    const int idx_start = FindFileInRange(
+        icmp, files_brief, start, ctx ? ctx->start_files[level] : 0,
+        static_cast<uint32_t>(files_brief.num_files - 1));
     assert(static_cast<size_t>(idx_start) < files_brief.num_files);
+    if (ctx) {
+      ctx->start_files[level] = idx_start;
+    }
 
     // identify the file position for end key
     int idx_end = idx_start;
@@ -7004,13 +7351,11 @@ uint64_t VersionSet::ApproximateSize(const SizeApproximationOptions& options,
     // scan all files from the starting index to the ending index
     // (inferred from the sorted order)
 
-    // first scan all the intermediate full files (excluding first and last)
-    for (int i = idx_start + 1; i < idx_end; ++i) {
-      uint64_t file_size = files_brief.files[i].fd.GetFileSize();
-      // The entire file falls into the range, so we can just take its size.
-      assert(file_size == ApproximateSize(read_options, v, files_brief.files[i],
-                                          start, end, caller));
-      total_full_size += file_size;
+    // first add all the intermediate full files (excluding first and last),
+    // which entirely fall into the range
+    if (idx_start + 1 < idx_end) {
+      total_full_size +=
+          vstorage->LevelFilesSize(level, idx_start + 1, idx_end);
     }
 
     // save the first and the last files (which may be the same file), so we
@@ -7045,7 +7390,7 @@ uint64_t VersionSet::ApproximateSize(const SizeApproximationOptions& options,
     // level
     for (const auto file_ptr : first_files) {
       total_full_size +=
-          ApproximateSize(read_options, v, *file_ptr, start, end, caller);
+          ApproximateSize(read_options, v, *file_ptr, start, end, caller, ctx);
     }
 
     // Estimate for all the last files, at each level
@@ -7053,7 +7398,7 @@ uint64_t VersionSet::ApproximateSize(const SizeApproximationOptions& options,
       // We could use ApproximateSize here, but calling ApproximateOffsetOf
       // directly is just more efficient.
       total_full_size +=
-          ApproximateOffsetOf(read_options, v, *file_ptr, end, caller);
+          ApproximateOffsetOf(read_options, v, *file_ptr, end, caller, ctx);
     }
   }
 
@@ -7063,7 +7408,8 @@ uint64_t VersionSet::ApproximateSize(const SizeApproximationOptions& options,
 uint64_t VersionSet::ApproximateOffsetOf(const ReadOptions& read_options,
                                          Version* v, const FdWithKeyRange& f,
                                          const Slice& key,
-                                         TableReaderCaller caller) {
+                                         TableReaderCaller caller,
+                                         ApproximateSizeContext* ctx) {
   // pre-condition
   assert(v);
   const auto& icmp = v->cfd_->internal_comparator();
@@ -7078,6 +7424,15 @@ uint64_t VersionSet::ApproximateOffsetOf(const ReadOptions& read_options,
   } else {
     // "key" falls in the range for this table.  Add the
     // approximate offset of "key" within the table.
+    std::string offset_key;
+    if (ctx) {
+      PutFixed64(&offset_key, f.fd.GetNumber());
+      offset_key.append(key.data(), key.size());
+      auto it = ctx->offsets.find(offset_key);
+      if (it != ctx->offsets.end()) {
+        return it->second;
+      }
+    }
     TableCache* table_cache = v->cfd_->table_cache();
     const MutableCFOptions& cf_opts = v->GetMutableCFOptions();
     if (table_cache != nullptr) {
@@ -7085,6 +7440,9 @@ uint64_t VersionSet::ApproximateOffsetOf(const ReadOptions& read_options,
           read_options, key, *f.file_metadata, caller, icmp,
           cf_opts.block_protection_bytes_per_key, cf_opts.prefix_extractor);
     }
+    if (ctx) {
+      ctx->offsets.emplace(std::move(offset_key), result);
+    }
   }
   return result;
 }
@@ -7092,7 +7450,8 @@ uint64_t VersionSet::ApproximateOffsetOf(const ReadOptions& read_options,
 uint64_t VersionSet::ApproximateSize(const ReadOptions& read_options,
                                      Version* v, const FdWithKeyRange& f,
                                      const Slice& start, const Slice& end,
-                                     TableReaderCaller caller) {
+                                     TableReaderCaller caller,
+                                     ApproximateSizeContext* ctx) {
   // pre-condition
   assert(v);
   const auto& icmp = v->cfd_->internal_comparator();
@@ -7106,14 +7465,14 @@ uint64_t VersionSet::ApproximateSize(const ReadOptions& read_options,
 
   if (icmp.Compare(f.smallest_key, start) >= 0) {
     // Start of the range is before the file start - approximate by end offset
-    return ApproximateOffsetOf(read_options, v, f, end, caller);
+    return ApproximateOffsetOf(read_options, v, f, end, caller, ctx);
   }
 
   if (icmp.Compare(f.largest_key, end) < 0) {
     // End of the range is after the file end - approximate by subtracting
     // start offset from the file size
     uint64_t start_offset =
-        ApproximateOffsetOf(read_options, v, f, start, caller);
+        ApproximateOffsetOf(read_options, v, f, start, caller, ctx);
     assert(f.fd.GetFileSize() >= start_offset);
     return f.fd.GetFileSize() - start_offset;
   }
@@ -7310,7 +7669,8 @@ InternalIterator* VersionSet::MakeInputIterator(
   assert(num <= space);
   InternalIterator* result = NewCompactionMergingIterator(
       &c->column_family_data()->internal_comparator(), list,
-      static_cast<int>(num), range_tombstones);
+      static_cast<int>(num), range_tombstones, /*arena=*/nullptr,
+      db_options_->use_loser_tree_in_compaction);
   delete[] list;
   return result;
 }
@@ -7368,6 +7728,14 @@ void VersionSet::GetLiveFilesMetaData(std::vector<LiveFileMetaData>* metadata) {
         filemetadata.largest_seqno = file->fd.largest_seqno;
         filemetadata.num_reads_sampled =
             file->stats.num_reads_sampled.load(std::memory_order_relaxed);
+        filemetadata.num_seeks_sampled =
+            file->stats.num_seeks_sampled.load(std::memory_order_relaxed);
+        filemetadata.num_reads_sampled_last_window =
+            file->stats.num_reads_sampled_last_window.load(
+                std::memory_order_relaxed);
+        filemetadata.num_seeks_sampled_last_window =
+            file->stats.num_seeks_sampled_last_window.load(
+                std::memory_order_relaxed);
         filemetadata.being_compacted = file->being_compacted;
         filemetadata.num_entries = file->num_entries;
         filemetadata.num_deletions = file->num_deletions;
@@ -7623,6 +7991,21 @@ Status ReactiveVersionSet::ReadAndApply(
   if (!s.ok()) {
     return s;
   }
+  if (manifest_reader->get() == reader && reader->IsEOF() &&
+      !reader->hasReadError()) {
+    // The same MANIFEST as before, read up to its end. Unless it grew there
+    // is nothing new, which a stat tells for less than a read at the tail,
+    // e.g. when the MANIFEST is in cloud storage.
+    uint64_t manifest_size = 0;
+    if (fs_->GetFileSize(reader->file()->file_name(), IOOptions(),
+                         &manifest_size, nullptr)
+            .ok() &&
+        manifest_size == reader->GetReadOffset()) {
+      TEST_SYNC_POINT("ReactiveVersionSet::ReadAndApply:NoNewEdits");
+      cfds_changed->clear();
+      return s;
+    }
+  }
   manifest_tailer_->Iterate(*(manifest_reader->get()), manifest_read_status);
   s = manifest_tailer_->status();
   if (s.ok()) {
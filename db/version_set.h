@@ -45,6 +45,7 @@
 #include "db/read_callback.h"
 #include "db/replication_epoch_edit.h"
 #include "db/table_cache.h"
+#include "db/table_summary.h"
 #include "db/version_builder.h"
 #include "db/version_edit.h"
 #include "db/write_controller.h"
@@ -117,9 +118,12 @@ bool SomeFileOverlapsRange(const InternalKeyComparator& icmp,
 // Generate LevelFilesBrief from vector<FdWithKeyRange*>
 // Would copy smallest_key and largest_key data to sequential memory
 // arena: Arena used to allocate the memory
+// ucmp: the user comparator of sorted, non-overlapping files, for the key
+// prefixes of FindFile() if it is the bytewise comparator; nullptr otherwise
 void DoGenerateLevelFilesBrief(LevelFilesBrief* file_level,
                                const std::vector<FileMetaData*>& files,
-                               Arena* arena);
+                               Arena* arena,
+                               const Comparator* ucmp = nullptr);
 enum EpochNumberRequirement {
   kMightMissing,
   kMustPresent,
@@ -208,8 +212,11 @@ class VersionStorageInfo {
       const MutableCFOptions& mutable_cf_options);
 
   // This computes files_marked_for_compaction_ and is called by
-  // ComputeCompactionScore()
-  void ComputeFilesMarkedForCompaction(int last_level);
+  // ComputeCompactionScore(). Besides the files marked by table properties
+  // collectors, it includes those whose range tombstones cover more than
+  // `range_deletion_compaction_ratio` times their size in the levels below.
+  void ComputeFilesMarkedForCompaction(int last_level,
+                                       double range_deletion_compaction_ratio);
 
   // This computes ttl_expired_files_ and is called by
   // ComputeCompactionScore()
@@ -451,6 +458,14 @@ class VersionStorageInfo {
     return level_files_brief_[level];
   }
 
+  // Total size of the files [begin, end) of LevelFilesBrief(level).
+  uint64_t LevelFilesSize(int level, size_t begin, size_t end) const {
+    assert(level < static_cast<int>(level_files_size_sums_.size()));
+    assert(begin <= end && end < level_files_size_sums_[level].size());
+    return level_files_size_sums_[level][end] -
+           level_files_size_sums_[level][begin];
+  }
+
   // REQUIRES: PrepareForVersionAppend has been called
   const std::vector<int>& FilesByCompactionPri(int level) const {
     assert(finalized_);
@@ -646,7 +661,12 @@ class VersionStorageInfo {
 
   // A short brief metadata of files per level
   autovector<ROCKSDB_NAMESPACE::LevelFilesBrief> level_files_brief_;
+  // Prefix sums of the file sizes in level_files_brief_, the size of the
+  // first i files of a level at index i
+  std::vector<std::vector<uint64_t>> level_files_size_sums_;
   FileIndexer file_indexer_;
+  // Empty unless L0 has L0FileIndex::kMinFiles files or more
+  L0FileIndex l0_file_index_;
   Arena arena_;  // Used to allocate space for file_levels_
 
   CompactionStyle compaction_style_;
@@ -920,6 +940,17 @@ class Version {
                  FilePrefetchBuffer* prefetch_buffer, PinnableSlice* value,
                  uint64_t* bytes_read) const;
 
+  // Retrieves the blobs of the blob references blob_indexes[i] of the keys
+  // user_keys[i] with one multi-read per blob file, saving them in
+  // (*values)[i] and their statuses in (*statuses)[i]. *bytes_read is set to
+  // the total size of the blob records read.
+  // REQUIRES: at most 64 blob references per blob file
+  void MultiGetBlob(const ReadOptions& read_options,
+                    const std::vector<Slice>& user_keys,
+                    const std::vector<BlobIndex>& blob_indexes,
+                    std::vector<PinnableSlice>* values,
+                    std::vector<Status>* statuses, uint64_t* bytes_read) const;
+
   struct BlobReadContext {
     BlobReadContext(const BlobIndex& blob_idx, const KeyContext* key_ctx)
         : blob_index(blob_idx), key_context(key_ctx) {}
@@ -1499,6 +1530,15 @@ class VersionSet {
                            int start_level, int end_level,
                            TableReaderCaller caller);
 
+  // Same as ApproximateSize() over all non-empty levels, for each range
+  // [starts[i], ends[i]), into sizes[i]. The ranges are visited in the order
+  // of their start keys, so each level is only searched forward, and the
+  // offset of an endpoint shared by adjacent ranges is looked up once.
+  void ApproximateSizes(const SizeApproximationOptions& options,
+                        const ReadOptions& read_options, Version* v,
+                        const Slice* starts, const Slice* ends, size_t n,
+                        uint64_t* sizes, TableReaderCaller caller);
+
   // Return the size of the current manifest file
   uint64_t manifest_file_size() const { return manifest_file_size_; }
 
@@ -1526,6 +1566,20 @@ class VersionSet {
 
   ColumnFamilySet* GetColumnFamilySet() { return column_family_set_.get(); }
 
+  // Sets the table summary of the last clean shutdown, whose files recovery
+  // leaves to be opened on their first read.
+  // REQUIRES: before Recover()
+  void SetTableSummary(std::unique_ptr<TableSummary> table_summary) {
+    table_summary_ = std::move(table_summary);
+  }
+
+  // Returns the properties of `file_meta` in the table summary, or nullptr.
+  // The summary doesn't change after recovery, so no lock is needed.
+  std::shared_ptr<const TableProperties> GetSummarizedTableProperties(
+      const FileMetaData& file_meta) const {
+    return table_summary_ ? table_summary_->Get(file_meta) : nullptr;
+  }
+
   const UnorderedMap<uint32_t, size_t>& GetRunningColumnFamiliesTimestampSize()
       const {
     return column_family_set_->GetRunningColumnFamiliesTimestampSize();
@@ -1613,16 +1667,33 @@ class VersionSet {
 
   void Reset();
 
+  // State shared by the ranges of one ApproximateSizes() call.
+  struct ApproximateSizeContext {
+    // Per level, the position of the file containing the previous start key
+    std::vector<int> start_files;
+    // Offsets looked up in the table files, keyed by file number and key
+    UnorderedMap<std::string, uint64_t> offsets;
+  };
+
+  uint64_t ApproximateSize(const SizeApproximationOptions& options,
+                           const ReadOptions& read_options, Version* v,
+                           const Slice& start, const Slice& end,
+                           int start_level, int end_level,
+                           TableReaderCaller caller,
+                           ApproximateSizeContext* ctx);
+
   // Returns approximated offset of a key in a file for a given version.
   uint64_t ApproximateOffsetOf(const ReadOptions& read_options, Version* v,
                                const FdWithKeyRange& f, const Slice& key,
-                               TableReaderCaller caller);
+                               TableReaderCaller caller,
+                               ApproximateSizeContext* ctx = nullptr);
 
   // Returns approximated data size between start and end keys in a file
   // for a given version.
   uint64_t ApproximateSize(const ReadOptions& read_options, Version* v,
                            const FdWithKeyRange& f, const Slice& start,
-                           const Slice& end, TableReaderCaller caller);
+                           const Slice& end, TableReaderCaller caller,
+                           ApproximateSizeContext* ctx = nullptr);
 
   struct MutableCFState {
     uint64_t log_number;
@@ -1663,6 +1734,7 @@ class VersionSet {
   const std::string dbname_;
   std::string db_id_;
   const ImmutableDBOptions* const db_options_;
+  std::unique_ptr<TableSummary> table_summary_;
   std::atomic<uint64_t> next_file_number_;
   // Any WAL number smaller than this should be ignored during recovery,
   // and is qualified for being deleted.
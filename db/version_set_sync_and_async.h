@@ -18,8 +18,9 @@ DEFINE_SYNC_AND_ASYNC(Status, Version::MultiGetFromSST)
  std::unordered_map<uint64_t, BlobReadContexts>& blob_ctxs,
  TableCache::TypedHandle* table_handle, uint64_t& num_filter_read,
  uint64_t& num_index_read, uint64_t& num_sst_read) {
-  bool timer_enabled = GetPerfLevel() >= PerfLevel::kEnableTimeExceptForMutex &&
-                       get_perf_context()->per_level_perf_context_enabled;
+  bool timer_enabled =
+      PerfLevelEnabled(PerfLevel::kEnableTimeExceptForMutex) &&
+      get_perf_context()->per_level_perf_context_enabled;
 
   Status s;
   StopWatchNano timer(clock_, timer_enabled /* auto_start */);
@@ -91,6 +91,49 @@ TEST_F(GenerateLevelFilesBriefTest, Multiple) {
   ASSERT_EQ(0, Compare());
 }
 
+TEST_F(GenerateLevelFilesBriefTest, LargestKeyPrefixes) {
+  // The largest user keys share "common/", then the 8 next bytes by pairs of
+  // files, and the last two files share a boundary user key
+  std::vector<std::string> user_keys;
+  for (int i = 0; i < 40; i++) {
+    char buf[32];
+    snprintf(buf, sizeof(buf), "common/%08d/padding%d", i / 4, i % 4);
+    user_keys.emplace_back(buf);
+  }
+  for (size_t i = 0; i + 1 < user_keys.size(); i += 2) {
+    Add(user_keys[i].c_str(), user_keys[i + 1].c_str());
+  }
+  Add(user_keys.back().c_str(), "common/1", 50, 50);
+
+  DoGenerateLevelFilesBrief(&file_level_, files_, &arena_);
+  ASSERT_EQ(nullptr, file_level_.largest_key_prefixes);
+  LevelFilesBrief without_prefixes = file_level_;
+
+  DoGenerateLevelFilesBrief(&file_level_, files_, &arena_,
+                            BytewiseComparator());
+  ASSERT_EQ(21u, file_level_.num_files);
+  ASSERT_EQ(0, Compare());
+  ASSERT_NE(nullptr, file_level_.largest_key_prefixes);
+  ASSERT_EQ("common/", file_level_.largest_key_common_prefix.ToString());
+
+  std::vector<std::string> lookups = user_keys;
+  for (const char* k : {"", "a", "common", "common/", "common/0", "common/00",
+                        "common/00000004/", "common/1", "common/10", "z"}) {
+    lookups.emplace_back(k);
+  }
+  InternalKeyComparator icmp(BytewiseComparator());
+  for (const auto& user_key : lookups) {
+    for (SequenceNumber seq : {200, 100, 75, 50, 0}) {
+      InternalKey target(user_key, seq, kTypeValue);
+      ASSERT_EQ(FindFile(icmp, without_prefixes, target.Encode()),
+                FindFile(icmp, file_level_, target.Encode()))
+          << user_key << "@" << seq;
+    }
+  }
+  InternalKey target(user_keys.back(), 75, kTypeValue);
+  ASSERT_EQ(20, FindFile(icmp, file_level_, target.Encode()));
+}
+
 class CountingLogger : public Logger {
  public:
   CountingLogger() : log_count(0) {}
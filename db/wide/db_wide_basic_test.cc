@@ -1672,6 +1672,105 @@ TEST_F(DBWideBasicTest, CompactionFilter) {
   }
 }
 
+TEST_F(DBWideBasicTest, ColumnProjection) {
+  Options options = GetDefaultOptions();
+  Reopen(options);
+
+  constexpr char first_key[] = "first";
+  WideColumns first_columns{{kDefaultWideColumnName, "first_default"},
+                            {"attr_a", "first_a"},
+                            {"attr_b", "first_b"},
+                            {"attr_c", "first_c"}};
+
+  constexpr char second_key[] = "second";
+  constexpr char second_value[] = "second_value";
+
+  ASSERT_OK(db_->PutEntity(WriteOptions(), db_->DefaultColumnFamily(),
+                           first_key, first_columns));
+  ASSERT_OK(db_->Put(WriteOptions(), db_->DefaultColumnFamily(), second_key,
+                     second_value));
+
+  const std::vector<Slice> projection{"attr_c", "attr_a", "missing"};
+  const WideColumns expected_first{first_columns[1], first_columns[3]};
+  const std::vector<Slice> default_projection{kDefaultWideColumnName};
+
+  auto verify = [&]() {
+    ReadOptions read_options;
+    read_options.column_projection = &projection;
+
+    {
+      PinnableWideColumns result;
+      ASSERT_OK(db_->GetEntity(read_options, db_->DefaultColumnFamily(),
+                               first_key, &result));
+      ASSERT_EQ(result.columns(), expected_first);
+    }
+
+    {
+      PinnableWideColumns result;
+      ASSERT_OK(db_->GetEntity(read_options, db_->DefaultColumnFamily(),
+                               second_key, &result));
+      ASSERT_TRUE(result.columns().empty());
+    }
+
+    {
+      constexpr size_t num_keys = 2;
+      std::array<Slice, num_keys> keys{{first_key, second_key}};
+      std::array<PinnableWideColumns, num_keys> results;
+      std::array<Status, num_keys> statuses;
+
+      db_->MultiGetEntity(read_options, db_->DefaultColumnFamily(), num_keys,
+                          keys.data(), results.data(), statuses.data());
+      ASSERT_OK(statuses[0]);
+      ASSERT_EQ(results[0].columns(), expected_first);
+      ASSERT_OK(statuses[1]);
+      ASSERT_TRUE(results[1].columns().empty());
+    }
+
+    {
+      std::unique_ptr<Iterator> iter(db_->NewIterator(read_options));
+
+      iter->SeekToFirst();
+      ASSERT_TRUE(iter->Valid());
+      ASSERT_EQ(iter->key(), first_key);
+      ASSERT_EQ(iter->columns(), expected_first);
+      ASSERT_TRUE(iter->value().empty());
+
+      iter->Next();
+      ASSERT_TRUE(iter->Valid());
+      ASSERT_EQ(iter->key(), second_key);
+      ASSERT_TRUE(iter->columns().empty());
+      ASSERT_TRUE(iter->value().empty());
+
+      iter->Next();
+      ASSERT_FALSE(iter->Valid());
+      ASSERT_OK(iter->status());
+    }
+
+    {
+      read_options.column_projection = &default_projection;
+      std::unique_ptr<Iterator> iter(db_->NewIterator(read_options));
+
+      iter->SeekToFirst();
+      ASSERT_TRUE(iter->Valid());
+      ASSERT_EQ(iter->columns(), WideColumns{first_columns[0]});
+      ASSERT_EQ(iter->value(), first_columns[0].value());
+
+      iter->Next();
+      ASSERT_TRUE(iter->Valid());
+      ASSERT_EQ(iter->columns(),
+                (WideColumns{{kDefaultWideColumnName, second_value}}));
+      ASSERT_EQ(iter->value(), second_value);
+    }
+  };
+
+  // Memtable
+  verify();
+
+  // SST
+  ASSERT_OK(Flush());
+  verify();
+}
+
 TEST_F(DBWideBasicTest, PutEntityTimestampError) {
   // Note: timestamps are currently not supported
 
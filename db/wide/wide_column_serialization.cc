@@ -64,8 +64,12 @@ Status WideColumnSerialization::Serialize(const WideColumns& columns,
   return Status::OK();
 }
 
-Status WideColumnSerialization::Deserialize(Slice& input,
-                                            WideColumns& columns) {
+namespace {
+
+// Deserializes the columns whose names are in *column_names, or all columns
+// if column_names is nullptr.
+Status DeserializeColumns(Slice& input, const std::vector<Slice>* column_names,
+                          WideColumns& columns) {
   assert(columns.empty());
 
   uint32_t version = 0;
@@ -73,7 +77,7 @@ Status WideColumnSerialization::Deserialize(Slice& input,
     return Status::Corruption("Error decoding wide column version");
   }
 
-  if (version > kCurrentVersion) {
+  if (version > WideColumnSerialization::kCurrentVersion) {
     return Status::NotSupported("Unsupported wide column version");
   }
 
@@ -86,10 +90,16 @@ Status WideColumnSerialization::Deserialize(Slice& input,
     return Status::OK();
   }
 
-  columns.reserve(num_columns);
+  columns.reserve(column_names ? std::min<size_t>(column_names->size(),
+                                                  num_columns)
+                               : num_columns);
 
-  autovector<uint32_t, 16> column_value_sizes;
-  column_value_sizes.reserve(num_columns);
+  // The offset and size of the value of each returned column.
+  autovector<std::pair<size_t, uint32_t>, 16> column_values;
+  column_values.reserve(columns.capacity());
+
+  Slice last_name;
+  size_t values_size = 0;
 
   for (uint32_t i = 0; i < num_columns; ++i) {
     Slice name;
@@ -97,38 +107,52 @@ Status WideColumnSerialization::Deserialize(Slice& input,
       return Status::Corruption("Error decoding wide column name");
     }
 
-    if (!columns.empty() && columns.back().name().compare(name) >= 0) {
+    if (i > 0 && last_name.compare(name) >= 0) {
       return Status::Corruption("Wide columns out of order");
     }
-
-    columns.emplace_back(name, Slice());
+    last_name = name;
 
     uint32_t value_size = 0;
     if (!GetVarint32(&input, &value_size)) {
       return Status::Corruption("Error decoding wide column value size");
     }
 
-    column_value_sizes.emplace_back(value_size);
+    if (!column_names || std::find(column_names->begin(), column_names->end(),
+                                   name) != column_names->end()) {
+      columns.emplace_back(name, Slice());
+      column_values.emplace_back(values_size, value_size);
+    }
+
+    values_size += value_size;
   }
 
   const Slice data(input);
-  size_t pos = 0;
-
-  for (uint32_t i = 0; i < num_columns; ++i) {
-    const uint32_t value_size = column_value_sizes[i];
-
-    if (pos + value_size > data.size()) {
-      return Status::Corruption("Error decoding wide column value payload");
-    }
 
-    columns[i].value() = Slice(data.data() + pos, value_size);
+  if (values_size > data.size()) {
+    return Status::Corruption("Error decoding wide column value payload");
+  }
 
-    pos += value_size;
+  for (size_t i = 0; i < columns.size(); ++i) {
+    columns[i].value() =
+        Slice(data.data() + column_values[i].first, column_values[i].second);
   }
 
   return Status::OK();
 }
 
+}  // namespace
+
+Status WideColumnSerialization::Deserialize(Slice& input,
+                                            WideColumns& columns) {
+  return DeserializeColumns(input, nullptr, columns);
+}
+
+Status WideColumnSerialization::Deserialize(
+    Slice& input, const std::vector<Slice>& column_names,
+    WideColumns& columns) {
+  return DeserializeColumns(input, &column_names, columns);
+}
+
 WideColumns::const_iterator WideColumnSerialization::Find(
     const WideColumns& columns, const Slice& column_name) {
   const auto it =
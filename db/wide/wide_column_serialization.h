@@ -7,6 +7,7 @@
 
 #include <cstdint>
 #include <string>
+#include <vector>
 
 #include "rocksdb/rocksdb_namespace.h"
 #include "rocksdb/status.h"
@@ -47,6 +48,13 @@ class WideColumnSerialization {
 
   static Status Deserialize(Slice& input, WideColumns& columns);
 
+  // Like above, but only returns the columns whose names are in
+  // column_names, in the same order as above. The values of the other
+  // columns are not located.
+  static Status Deserialize(Slice& input,
+                            const std::vector<Slice>& column_names,
+                            WideColumns& columns);
+
   static WideColumns::const_iterator Find(const WideColumns& columns,
                                           const Slice& column_name);
   static Status GetValueOfDefaultColumn(Slice& input, Slice& value);
@@ -124,6 +124,85 @@ TEST(WideColumnSerializationTest, SerializeDeserialize) {
   }
 }
 
+TEST(WideColumnSerializationTest, DeserializeProjection) {
+  WideColumns columns{{kDefaultWideColumnName, "default"},
+                      {"bar", "baz"},
+                      {"foo", "bar"},
+                      {"hello", "world"}};
+  std::string output;
+
+  ASSERT_OK(WideColumnSerialization::Serialize(columns, output));
+
+  {
+    Slice input(output);
+    WideColumns deserialized_columns;
+
+    ASSERT_OK(WideColumnSerialization::Deserialize(
+        input, {"hello", "missing", "bar"}, deserialized_columns));
+    ASSERT_EQ(deserialized_columns, (WideColumns{columns[1], columns[3]}));
+  }
+
+  {
+    Slice input(output);
+    WideColumns deserialized_columns;
+
+    ASSERT_OK(WideColumnSerialization::Deserialize(
+        input, {kDefaultWideColumnName}, deserialized_columns));
+    ASSERT_EQ(deserialized_columns, (WideColumns{columns[0]}));
+  }
+
+  {
+    Slice input(output);
+    WideColumns deserialized_columns;
+
+    ASSERT_OK(WideColumnSerialization::Deserialize(input, {},
+                                                   deserialized_columns));
+    ASSERT_TRUE(deserialized_columns.empty());
+  }
+
+  {
+    // The payload is checked even if the truncated values are not returned
+    output.pop_back();
+    Slice input(output);
+    WideColumns deserialized_columns;
+
+    const Status s = WideColumnSerialization::Deserialize(
+        input, {"bar"}, deserialized_columns);
+    ASSERT_TRUE(s.IsCorruption());
+    ASSERT_TRUE(std::strstr(s.getState(), "payload"));
+  }
+}
+
+TEST(WideColumnSerializationTest, PinnableWideColumnsProjection) {
+  WideColumns columns{{kDefaultWideColumnName, "default"},
+                      {"bar", "baz"},
+                      {"foo", "bar"},
+                      {"hello", "world"}};
+  std::string output;
+
+  ASSERT_OK(WideColumnSerialization::Serialize(columns, output));
+
+  const std::vector<Slice> projection{"hello", "missing", "bar"};
+  PinnableWideColumns pinnable_columns;
+  pinnable_columns.SetColumnProjection(&projection);
+
+  ASSERT_OK(pinnable_columns.SetWideColumnValue(output));
+  ASSERT_EQ(pinnable_columns.columns(), (WideColumns{columns[1], columns[3]}));
+  ASSERT_EQ(pinnable_columns.serialized_size(), output.size());
+
+  // A plain value is kept for Project()
+  pinnable_columns.Reset();
+  pinnable_columns.SetPlainValue(Slice("plain"));
+  ASSERT_EQ(pinnable_columns.columns(),
+            (WideColumns{{kDefaultWideColumnName, "plain"}}));
+  pinnable_columns.Project(projection);
+  ASSERT_TRUE(pinnable_columns.columns().empty());
+
+  pinnable_columns.SetColumnProjection(nullptr);
+  ASSERT_OK(pinnable_columns.SetWideColumnValue(output));
+  ASSERT_EQ(pinnable_columns.columns(), columns);
+}
+
 TEST(WideColumnSerializationTest, SerializeDuplicateError) {
   WideColumns columns{{"foo", "bar"}, {"foo", "baz"}};
   std::string output;
@@ -5,6 +5,8 @@
 
 #include "rocksdb/wide_columns.h"
 
+#include <algorithm>
+
 #include "db/wide/wide_column_serialization.h"
 
 namespace ROCKSDB_NAMESPACE {
@@ -17,7 +19,22 @@ const AttributeGroups kNoAttributeGroups;
 Status PinnableWideColumns::CreateIndexForWideColumns() {
   Slice value_copy = value_;
 
+  if (column_projection_) {
+    return WideColumnSerialization::Deserialize(value_copy, *column_projection_,
+                                                columns_);
+  }
   return WideColumnSerialization::Deserialize(value_copy, columns_);
 }
 
+void PinnableWideColumns::Project(const std::vector<Slice>& column_names) {
+  columns_.erase(std::remove_if(columns_.begin(), columns_.end(),
+                                [&](const WideColumn& column) {
+                                  return std::find(column_names.begin(),
+                                                   column_names.end(),
+                                                   column.name()) ==
+                                         column_names.end();
+                                }),
+                 columns_.end());
+}
+
 }  // namespace ROCKSDB_NAMESPACE
@@ -301,6 +301,13 @@ size_t WriteBatch::GetProtectionBytesPerKey() const {
   return 0;
 }
 
+void WriteBatch::Reserve(size_t bytes) { rep_.reserve(bytes); }
+
+void WriteBatch::UseBuffer(std::string&& buffer) {
+  rep_ = std::move(buffer);
+  Clear();
+}
+
 std::string WriteBatch::Release() {
   std::string ret = std::move(rep_);
   Clear();
@@ -1917,9 +1924,18 @@ class MemTableInserter : public WriteBatch::Handler {
   using HintMap = std::unordered_map<MemTable*, void*>;
   using HintMapType = std::aligned_storage<sizeof(HintMap)>::type;
   HintMapType hint_;
+  // The memtable and the user key of the last insert, and the number of
+  // inserts into that memtable in a row whose keys were ascending.
+  MemTable* sorted_run_mem_;
+  std::string sorted_run_last_key_;
+  size_t sorted_run_length_;
+  // Sorted runs this long get hints even without hint_per_batch_, since
+  // random keys rarely come in such runs, for which a stale hint costs more
+  // than no hint.
+  static constexpr size_t kMinSortedRunForHint = 8;
 
   HintMap& GetHintMap() {
-    assert(hint_per_batch_);
+    assert(hint_per_batch_ || concurrent_memtable_writes_);
     if (!hint_created_) {
       new (&hint_) HintMap();
       hint_created_ = true;
@@ -1927,6 +1943,31 @@ class MemTableInserter : public WriteBatch::Handler {
     return *reinterpret_cast<HintMap*>(&hint_);
   }
 
+  // Returns the hint to insert key into mem with, or nullptr to insert it
+  // without one. Concurrent writes of a sorted run of keys get the hint of
+  // the memtable even if the writer did not ask for hints, so that each key
+  // of the run starts from the splice of the previous one instead of a
+  // search from the top of the skip list.
+  void** GetInsertHint(MemTable* mem, const Slice& key) {
+    if (hint_per_batch_) {
+      return &GetHintMap()[mem];
+    }
+    if (!concurrent_memtable_writes_) {
+      return nullptr;
+    }
+    if (mem == sorted_run_mem_ &&
+        mem->GetInternalKeyComparator().user_comparator()->Compare(
+            sorted_run_last_key_, key) < 0) {
+      sorted_run_length_++;
+    } else {
+      sorted_run_mem_ = mem;
+      sorted_run_length_ = 1;
+    }
+    sorted_run_last_key_.assign(key.data(), key.size());
+    return sorted_run_length_ >= kMinSortedRunForHint ? &GetHintMap()[mem]
+                                                      : nullptr;
+  }
+
   MemPostInfoMap& GetPostMap() {
     assert(concurrent_memtable_writes_);
     if (!post_info_created_) {
@@ -2016,7 +2057,9 @@ class MemTableInserter : public WriteBatch::Handler {
         duplicate_detector_(),
         dup_dectector_on_(false),
         hint_per_batch_(hint_per_batch),
-        hint_created_(false) {
+        hint_created_(false),
+        sorted_run_mem_(nullptr),
+        sorted_run_length_(0) {
     assert(cf_mems_);
   }
 
@@ -2153,11 +2196,14 @@ class MemTableInserter : public WriteBatch::Handler {
       ret_status =
           mem->Add(sequence_, value_type, key, value, kv_prot_info,
                    concurrent_memtable_writes_, get_post_process_info(mem),
-                   hint_per_batch_ ? &GetHintMap()[mem] : nullptr);
+                   GetInsertHint(mem, key));
     } else if (moptions->inplace_callback == nullptr ||
                value_type != kTypeValue) {
-      assert(!concurrent_memtable_writes_);
-      ret_status = mem->Update(sequence_, value_type, key, value, kv_prot_info);
+      assert(!concurrent_memtable_writes_ ||
+             moptions->concurrent_inplace_update);
+      ret_status = mem->Update(sequence_, value_type, key, value, kv_prot_info,
+                               concurrent_memtable_writes_,
+                               get_post_process_info(mem));
     } else {
       assert(!concurrent_memtable_writes_);
       assert(value_type == kTypeValue);
@@ -2346,7 +2392,7 @@ class MemTableInserter : public WriteBatch::Handler {
     ret_status =
         mem->Add(sequence_, delete_type, key, value, kv_prot_info,
                  concurrent_memtable_writes_, get_post_process_info(mem),
-                 hint_per_batch_ ? &GetHintMap()[mem] : nullptr);
+                 GetInsertHint(mem, key));
     if (UNLIKELY(ret_status.IsTryAgain())) {
       assert(seq_per_batch_);
       const bool kBatchBoundary = true;
@@ -3246,6 +3292,73 @@ Status WriteBatchInternal::SetContents(WriteBatch* b, std::string contents) {
   return Status::OK();
 }
 
+bool WriteBatchInternal::Partition(const WriteBatch& batch, size_t max_parts,
+                                   std::vector<WriteBatch>* parts) {
+  parts->clear();
+  const uint32_t count = Count(&batch);
+  if (max_parts <= 1 || count < max_parts || batch.prot_info_ != nullptr ||
+      batch.rep_.size() < kHeader) {
+    return false;
+  }
+  const uint32_t part_count =
+      static_cast<uint32_t>((count + max_parts - 1) / max_parts);
+
+  Slice input(batch.rep_);
+  input.remove_prefix(kHeader);
+  SequenceNumber sequence = Sequence(&batch);
+  const char* part_begin = input.data();
+  uint32_t entries = 0;
+  while (!input.empty()) {
+    char tag = 0;
+    uint32_t column_family = 0;
+    Slice key, value, blob, xid;
+    uint64_t unix_write_time = 0;
+    Status s = ReadRecordFromWriteBatch(&input, &tag, &column_family, &key,
+                                        &value, &blob, &xid, &unix_write_time);
+    if (!s.ok()) {
+      parts->clear();
+      return false;
+    }
+    switch (tag) {
+      case kTypeColumnFamilyValue:
+      case kTypeValue:
+      case kTypeColumnFamilyDeletion:
+      case kTypeDeletion:
+      case kTypeColumnFamilySingleDeletion:
+      case kTypeSingleDeletion:
+      case kTypeColumnFamilyRangeDeletion:
+      case kTypeRangeDeletion:
+      case kTypeColumnFamilyBlobIndex:
+      case kTypeBlobIndex:
+      case kTypeColumnFamilyWideColumnEntity:
+      case kTypeWideColumnEntity:
+      case kTypeColumnFamilyValuePreferredSeqno:
+      case kTypeValuePreferredSeqno:
+        break;
+      default:
+        parts->clear();
+        return false;
+    }
+    if (++entries == part_count || input.empty()) {
+      WriteBatch part(kHeader + (input.data() - part_begin));
+      part.rep_.append(part_begin, input.data() - part_begin);
+      SetCount(&part, entries);
+      SetSequence(&part, sequence);
+      part.content_flags_.store(ContentFlags::DEFERRED,
+                                std::memory_order_relaxed);
+      parts->push_back(std::move(part));
+      sequence += entries;
+      entries = 0;
+      part_begin = input.data();
+    }
+  }
+  if (sequence != Sequence(&batch) + count) {
+    parts->clear();
+    return false;
+  }
+  return true;
+}
+
 Status WriteBatchInternal::Append(WriteBatch* dst, const WriteBatch* src,
                                   const bool wal_only) {
   assert(dst->Count() == 0 ||
@@ -3319,6 +3432,7 @@ Status WriteBatchInternal::UpdateProtectionInfo(WriteBatch* wb,
   } else if (bytes_per_key == 8) {
     if (wb->prot_info_ == nullptr) {
       wb->prot_info_.reset(new WriteBatch::ProtectionInfo());
+      wb->prot_info_->entries_.reserve(WriteBatchInternal::Count(wb));
       ProtectionInfoUpdater prot_info_updater(wb->prot_info_.get());
       Status s = wb->Iterate(&prot_info_updater);
       if (s.ok() && checksum != nullptr) {
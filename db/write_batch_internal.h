@@ -220,6 +220,14 @@ class WriteBatchInternal {
   static Status Append(WriteBatch* dst, const WriteBatch* src,
                        const bool WAL_only = false);
 
+  // Splits the entries of batch into at most max_parts batches of consecutive
+  // entries, each one starting at the sequence number of its first entry, so
+  // that they can be inserted into the memtables concurrently. Returns false,
+  // leaving parts empty, if the batch holds anything but plain writes, e.g.
+  // merges or transaction markers, which need a single inserter.
+  static bool Partition(const WriteBatch& batch, size_t max_parts,
+                        std::vector<WriteBatch>* parts);
+
   // Returns the byte size of appending a WriteBatch with ByteSize
   // leftByteSize and a WriteBatch with ByteSize rightByteSize
   static size_t AppendedByteSize(size_t leftByteSize, size_t rightByteSize);
@@ -184,6 +184,31 @@ TEST_F(WriteBatchTest, Multiple) {
   ASSERT_EQ(4u, batch.Count());
 }
 
+TEST_F(WriteBatchTest, ReuseBuffer) {
+  WriteBatch batch;
+  batch.Reserve(1000);
+  const char* data = batch.Data().data();
+  for (int i = 0; i < 10; i++) {
+    ASSERT_OK(batch.Put("key" + std::to_string(i), std::string(50, 'v')));
+  }
+  ASSERT_EQ(data, batch.Data().data());
+  batch.Clear();
+  ASSERT_OK(batch.Put(Slice("foo"), Slice("bar")));
+  ASSERT_EQ(data, batch.Data().data());
+
+  // The memory of a released batch is used by the next one.
+  std::string buffer = batch.Release();
+  ASSERT_EQ(data, buffer.data());
+  WriteBatch next;
+  next.UseBuffer(std::move(buffer));
+  ASSERT_EQ(0u, next.Count());
+  ASSERT_EQ(data, next.Data().data());
+  ASSERT_OK(next.Delete(Slice("box")));
+  WriteBatchInternal::SetSequence(&next, 100);
+  ASSERT_EQ("Delete(box)@100", PrintContents(&next));
+  ASSERT_EQ(data, next.Data().data());
+}
+
 TEST_F(WriteBatchTest, Corruption) {
   WriteBatch batch;
   ASSERT_OK(batch.Put(Slice("foo"), Slice("bar")));
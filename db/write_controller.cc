@@ -33,6 +33,18 @@ std::unique_ptr<WriteControllerToken> WriteController::GetDelayToken(
   return std::unique_ptr<WriteControllerToken>(new DelayWriteToken(this));
 }
 
+std::unique_ptr<WriteControllerToken> WriteController::GetRateDelayToken(
+    uint64_t write_rate) {
+  if (0 == total_delayed_++) {
+    next_refill_time_ = 0;
+    credit_in_bytes_ = 0;
+  }
+  token_write_rates_.insert(write_rate);
+  set_delayed_write_rate(*token_write_rates_.begin());
+  return std::unique_ptr<WriteControllerToken>(
+      new RateDelayWriteToken(this, write_rate));
+}
+
 std::unique_ptr<WriteControllerToken>
 WriteController::GetCompactionPressureToken() {
   ++total_compaction_pressure_;
@@ -113,6 +125,16 @@ DelayWriteToken::~DelayWriteToken() {
   assert(controller_->total_delayed_.load() >= 0);
 }
 
+RateDelayWriteToken::~RateDelayWriteToken() {
+  auto& rates = controller_->token_write_rates_;
+  auto it = rates.find(write_rate_);
+  assert(it != rates.end());
+  rates.erase(it);
+  if (!rates.empty()) {
+    controller_->set_delayed_write_rate(*rates.begin());
+  }
+}
+
 CompactionPressureToken::~CompactionPressureToken() {
   controller_->total_compaction_pressure_--;
   assert(controller_->total_compaction_pressure_ >= 0);
@@ -9,6 +9,7 @@
 
 #include <atomic>
 #include <memory>
+#include <set>
 
 #include "rocksdb/rate_limiter.h"
 
@@ -45,6 +46,12 @@ class WriteController {
   // which returns number of microseconds to sleep.
   std::unique_ptr<WriteControllerToken> GetDelayToken(
       uint64_t delayed_write_rate);
+  // Like GetDelayToken(), for column families that compute their write rate
+  // from how close they are to a stop (see ColumnFamilyOptions::
+  // smooth_write_stall). The delayed write rate is the lowest rate of the
+  // live tokens from this method, so that the column family closest to a
+  // stop sets it, whatever the order in which the tokens were taken.
+  std::unique_ptr<WriteControllerToken> GetRateDelayToken(uint64_t write_rate);
   // When an actor (column family) requests a moderate token, compaction
   // threads will be increased
   std::unique_ptr<WriteControllerToken> GetCompactionPressureToken();
@@ -91,6 +98,7 @@ class WriteController {
   friend class WriteControllerToken;
   friend class StopWriteToken;
   friend class DelayWriteToken;
+  friend class RateDelayWriteToken;
   friend class CompactionPressureToken;
 
   std::atomic<int> total_stopped_;
@@ -105,6 +113,8 @@ class WriteController {
   uint64_t max_delayed_write_rate_;
   // Current write rate (bytes / second)
   uint64_t delayed_write_rate_;
+  // Write rates of the live tokens from GetRateDelayToken()
+  std::multiset<uint64_t> token_write_rates_;
 
   std::unique_ptr<RateLimiter> low_pri_rate_limiter_;
 };
@@ -138,6 +148,16 @@ class DelayWriteToken : public WriteControllerToken {
   virtual ~DelayWriteToken();
 };
 
+class RateDelayWriteToken : public DelayWriteToken {
+ public:
+  RateDelayWriteToken(WriteController* controller, uint64_t write_rate)
+      : DelayWriteToken(controller), write_rate_(write_rate) {}
+  virtual ~RateDelayWriteToken();
+
+ private:
+  uint64_t write_rate_;
+};
+
 class CompactionPressureToken : public WriteControllerToken {
  public:
   explicit CompactionPressureToken(WriteController* controller)
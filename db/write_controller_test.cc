@@ -106,6 +106,31 @@ TEST_F(WriteControllerTest, BasicAPI) {
   EXPECT_FALSE(controller.NeedsDelay());
 }
 
+TEST_F(WriteControllerTest, RateDelayTokens) {
+  WriteController controller(40 MBPS);
+  {
+    auto token_0 = controller.GetRateDelayToken(20 MBPS);
+    EXPECT_TRUE(controller.NeedsDelay());
+    EXPECT_EQ(controller.delayed_write_rate(), 20 MBPS);
+
+    // The lowest rate of the live tokens applies.
+    auto token_1 = controller.GetRateDelayToken(10 MBPS);
+    EXPECT_EQ(controller.delayed_write_rate(), 10 MBPS);
+    auto token_2 = controller.GetRateDelayToken(30 MBPS);
+    EXPECT_EQ(controller.delayed_write_rate(), 10 MBPS);
+    EXPECT_EQ(2 SECS, controller.GetDelay(clock_.get(), 20 MB));
+
+    // Replacing a token, as a column family does when it recalculates its
+    // stall conditions, takes the new rate.
+    token_1 = controller.GetRateDelayToken(25 MBPS);
+    EXPECT_EQ(controller.delayed_write_rate(), 20 MBPS);
+    token_0.reset();
+    EXPECT_EQ(controller.delayed_write_rate(), 25 MBPS);
+    EXPECT_TRUE(controller.NeedsDelay());
+  }
+  EXPECT_FALSE(controller.NeedsDelay());
+}
+
 TEST_F(WriteControllerTest, StartFilled) {
   WriteController controller(10 MBPS);
 
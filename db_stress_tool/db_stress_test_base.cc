@@ -2773,6 +2773,9 @@ void StressTest::PrintEnv() const {
     case kRoundRobin:
       compaction_pri = "kRoundRobin";
       break;
+    case kMinOverlappingRatioByReads:
+      compaction_pri = "kMinOverlappingRatioByReads";
+      break;
   }
   fprintf(stdout, "Compaction Pri            : %s\n", compaction_pri);
   fprintf(stdout, "Background Purge          : %d\n",
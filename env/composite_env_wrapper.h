@@ -358,6 +358,11 @@ class CompositeEnvWrapper : public CompositeEnv {
     return target_.env->LowerThreadPoolCPUPriority(pool, pri);
   }
 
+  Status SetThreadPoolCpuAffinity(
+      Priority pool, const ThreadPoolCpuAffinity& affinity) override {
+    return target_.env->SetThreadPoolCpuAffinity(pool, affinity);
+  }
+
   Status GetThreadList(std::vector<ThreadStatus>* thread_list) override {
     return target_.env->GetThreadList(thread_list);
   }
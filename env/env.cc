@@ -1077,6 +1077,7 @@ void AssignEnvOptions(EnvOptions* env_options, const DBOptions& options) {
   env_options->writable_file_max_buffer_size =
       options.writable_file_max_buffer_size;
   env_options->allow_fallocate = options.allow_fallocate;
+  env_options->use_io_uring_for_writes = options.use_io_uring_for_writes;
   env_options->strict_bytes_per_sync = options.strict_bytes_per_sync;
   options.env->SanitizeEnvOptions(env_options);
 }
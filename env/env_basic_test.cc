@@ -48,6 +48,14 @@ static Env* GetCtrEncryptedEnv() {
   return ctr_encrypt_env.get();
 }
 
+#ifdef ROCKSDB_OPENSSL
+static Env* GetAESCtrEncryptedEnv() {
+  static std::unique_ptr<Env> aes_ctr_encrypt_env(
+      NewTestEncryptedEnv(Env::Default(), "AES_CTR://test"));
+  return aes_ctr_encrypt_env.get();
+}
+#endif  // ROCKSDB_OPENSSL
+
 static Env* GetMemoryEnv() {
   static std::unique_ptr<Env> mem_env(NewMemEnv(Env::Default()));
   return mem_env.get();
@@ -114,6 +122,12 @@ INSTANTIATE_TEST_CASE_P(EncryptedEnv, EnvBasicTestWithParam,
                         ::testing::Values(&GetCtrEncryptedEnv));
 INSTANTIATE_TEST_CASE_P(EncryptedEnv, EnvMoreTestWithParam,
                         ::testing::Values(&GetCtrEncryptedEnv));
+#ifdef ROCKSDB_OPENSSL
+INSTANTIATE_TEST_CASE_P(AESCTREncryptedEnv, EnvBasicTestWithParam,
+                        ::testing::Values(&GetAESCtrEncryptedEnv));
+INSTANTIATE_TEST_CASE_P(AESCTREncryptedEnv, EnvMoreTestWithParam,
+                        ::testing::Values(&GetAESCtrEncryptedEnv));
+#endif  // ROCKSDB_OPENSSL
 
 INSTANTIATE_TEST_CASE_P(MemEnv, EnvBasicTestWithParam,
                         ::testing::Values(&GetMemoryEnv));
@@ -11,6 +11,11 @@
 #include <cctype>
 #include <iostream>
 
+#ifdef ROCKSDB_OPENSSL
+#include <openssl/evp.h>
+#include <openssl/rand.h>
+#endif
+
 #include "env/composite_env_wrapper.h"
 #include "env/env_encryption_ctr.h"
 #include "monitoring/perf_context_imp.h"
@@ -1123,6 +1128,150 @@ Status CTREncryptionProvider::CreateCipherStreamFromPrefix(
   return Status::OK();
 }
 
+Status AESCTRCipherStream::Encrypt(uint64_t fileOffset, char* data,
+                                   size_t dataSize) {
+  return Crypt(fileOffset, data, dataSize);
+}
+
+Status AESCTRCipherStream::Decrypt(uint64_t fileOffset, char* data,
+                                   size_t dataSize) {
+  return Crypt(fileOffset, data, dataSize);
+}
+
+Status AESCTRCipherStream::EncryptBlock(uint64_t blockIndex, char* data,
+                                        char* /*scratch*/) {
+  return Crypt(blockIndex * kBlockSize, data, kBlockSize);
+}
+
+Status AESCTRCipherStream::DecryptBlock(uint64_t blockIndex, char* data,
+                                        char* /*scratch*/) {
+  return Crypt(blockIndex * kBlockSize, data, kBlockSize);
+}
+
+Status AESCTRCipherStream::Crypt(uint64_t fileOffset, char* data,
+                                 size_t dataSize) {
+#ifdef ROCKSDB_OPENSSL
+  const EVP_CIPHER* cipher = nullptr;
+  switch (key_.size()) {
+    case 16:
+      cipher = EVP_aes_128_ctr();
+      break;
+    case 24:
+      cipher = EVP_aes_192_ctr();
+      break;
+    case 32:
+      cipher = EVP_aes_256_ctr();
+      break;
+    default:
+      return Status::InvalidArgument("Invalid AES key length");
+  }
+
+  // Initial counter + block index, as 128-bit big-endian integers
+  unsigned char counter[kBlockSize];
+  uint64_t blockIndex = fileOffset / kBlockSize;
+  unsigned int carry = 0;
+  for (size_t i = kBlockSize; i-- > 0;) {
+    carry += static_cast<unsigned char>(iv_[i]) + (blockIndex & 0xff);
+    counter[i] = static_cast<unsigned char>(carry);
+    carry >>= 8;
+    blockIndex >>= 8;
+  }
+
+  std::unique_ptr<EVP_CIPHER_CTX, decltype(&EVP_CIPHER_CTX_free)> ctx(
+      EVP_CIPHER_CTX_new(), &EVP_CIPHER_CTX_free);
+  if (ctx == nullptr ||
+      EVP_EncryptInit_ex(ctx.get(), cipher, nullptr,
+                         reinterpret_cast<const unsigned char*>(key_.data()),
+                         counter) != 1) {
+    return Status::IOError("Failed to initialize AES-CTR");
+  }
+  int len = 0;
+  // The EVP CTR mode is a stream cipher, discard the key stream up to the
+  // offset in the first block
+  const int skip = static_cast<int>(fileOffset % kBlockSize);
+  if (skip > 0) {
+    unsigned char discard[kBlockSize] = {};
+    if (EVP_EncryptUpdate(ctx.get(), discard, &len, discard, skip) != 1) {
+      return Status::IOError("Failed to encrypt with AES-CTR");
+    }
+  }
+  auto* p = reinterpret_cast<unsigned char*>(data);
+  while (dataSize > 0) {
+    const int n = static_cast<int>(std::min<size_t>(dataSize, 1 << 30));
+    if (EVP_EncryptUpdate(ctx.get(), p, &len, p, n) != 1) {
+      return Status::IOError("Failed to encrypt with AES-CTR");
+    }
+    p += n;
+    dataSize -= n;
+  }
+  return Status::OK();
+#else
+  (void)fileOffset;
+  (void)data;
+  (void)dataSize;
+  return Status::NotSupported("AES-CTR requires building with OpenSSL");
+#endif  // ROCKSDB_OPENSSL
+}
+
+size_t AESCTREncryptionProvider::GetPrefixLength() const {
+  return defaultPrefixLength;
+}
+
+Status AESCTREncryptionProvider::AddCipher(const std::string& /*descriptor*/,
+                                           const char* cipher, size_t len,
+                                           bool /*for_write*/) {
+#ifdef ROCKSDB_OPENSSL
+  if (!key_.empty()) {
+    return Status::NotSupported("Cannot add keys to AESCTREncryptionProvider");
+  } else if (len != 16 && len != 24 && len != 32) {
+    return Status::InvalidArgument("AES key must be of 16, 24 or 32 bytes");
+  }
+  key_.assign(cipher, len);
+  return Status::OK();
+#else
+  (void)cipher;
+  (void)len;
+  return Status::NotSupported("AES-CTR requires building with OpenSSL");
+#endif  // ROCKSDB_OPENSSL
+}
+
+Status AESCTREncryptionProvider::CreateNewPrefix(const std::string& /*fname*/,
+                                                 char* prefix,
+                                                 size_t prefixLength) const {
+  if (key_.empty()) {
+    return Status::InvalidArgument("Encryption key is missing");
+  }
+  if (prefixLength < AESCTRCipherStream::kBlockSize) {
+    return Status::InvalidArgument("Encryption prefix is too short");
+  }
+  memset(prefix, 0, prefixLength);
+#ifdef ROCKSDB_OPENSSL
+  // The initial counter must not be reused with the same key, so it comes
+  // from a cryptographically secure generator
+  if (RAND_bytes(reinterpret_cast<unsigned char*>(prefix),
+                 static_cast<int>(AESCTRCipherStream::kBlockSize)) != 1) {
+    return Status::IOError("Failed to generate the AES-CTR initial counter");
+  }
+  return Status::OK();
+#else
+  return Status::NotSupported("AES-CTR requires building with OpenSSL");
+#endif  // ROCKSDB_OPENSSL
+}
+
+Status AESCTREncryptionProvider::CreateCipherStream(
+    const std::string& fname, const EnvOptions& /*options*/, Slice& prefix,
+    std::unique_ptr<BlockAccessCipherStream>* result) {
+  if (key_.empty()) {
+    return Status::InvalidArgument("Encryption key is missing");
+  }
+  if (prefix.size() < AESCTRCipherStream::kBlockSize) {
+    return Status::Corruption("Unable to read from file " + fname +
+                              ": read attempt would read beyond file bounds");
+  }
+  result->reset(new AESCTRCipherStream(key_, prefix.data()));
+  return Status::OK();
+}
+
 namespace {
 static void RegisterEncryptionBuiltins() {
   static std::once_flag once;
@@ -1144,6 +1293,24 @@ static void RegisterEncryptionBuiltins() {
           return guard->get();
         });
 
+    // Match "AES_CTR" or "AES_CTR://test"
+    lib->AddFactory<EncryptionProvider>(
+        ObjectLibrary::PatternEntry(AESCTREncryptionProvider::kClassName(),
+                                    true)
+            .AddSuffix("://test"),
+        [](const std::string& uri, std::unique_ptr<EncryptionProvider>* guard,
+           std::string* /*errmsg*/) {
+          guard->reset(new AESCTREncryptionProvider());
+          if (EndsWith(uri, "://test")) {
+            // AES-256 with a fixed key, for tests only
+            guard->get()
+                ->AddCipher("test", "0123456789abcdef0123456789abcdef", 32,
+                            true)
+                .PermitUncheckedError();
+          }
+          return guard->get();
+        });
+
     lib->AddFactory<EncryptionProvider>(
         "1://test", [](const std::string& /*uri*/,
                        std::unique_ptr<EncryptionProvider>* guard,
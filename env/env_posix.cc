@@ -395,6 +395,12 @@ class PosixEnv : public CompositeEnv {
     return Status::OK();
   }
 
+  Status SetThreadPoolCpuAffinity(
+      Priority pool, const ThreadPoolCpuAffinity& affinity) override {
+    assert(pool >= Priority::BOTTOM && pool <= Priority::HIGH);
+    return thread_pools_[pool].SetCpuAffinity(affinity);
+  }
+
  private:
   friend Env* Env::Default();
   // Constructs the default Env, a singleton
@@ -41,6 +41,9 @@
 #include "env/env_chroot.h"
 #include "env/env_encryption_ctr.h"
 #include "env/fs_readonly.h"
+#if defined(ROCKSDB_IOURING_PRESENT)
+#include "env/io_posix.h"
+#endif
 #include "env/mock_env.h"
 #include "env/unique_id_gen.h"
 #include "logging/log_buffer.h"
@@ -312,6 +315,95 @@ TEST_F(EnvPosixTest, LowerThreadPoolCpuPriority) {
 }
 #endif
 
+#ifdef OS_LINUX
+TEST_F(EnvPosixTest, SetThreadPoolCpuAffinity) {
+  std::vector<int> process_cpus;
+  ASSERT_TRUE(port::GetProcessCpuAffinity(&process_cpus));
+  ASSERT_FALSE(process_cpus.empty());
+
+  env_->SetBackgroundThreads(1, Env::BOTTOM);
+
+  // Returns the CPUs a job of the pool runs on
+  auto RunTask = [&]() {
+    struct Task {
+      std::vector<int> cpus;
+      std::atomic<bool> called{false};
+    } task;
+    env_->Schedule(
+        [](void* arg) {
+          Task* t = static_cast<Task*>(arg);
+          cpu_set_t set;
+          CPU_ZERO(&set);
+          if (sched_getaffinity(0, sizeof(set), &set) == 0) {
+            for (int cpu = 0; cpu < CPU_SETSIZE; ++cpu) {
+              if (CPU_ISSET(cpu, &set)) {
+                t->cpus.push_back(cpu);
+              }
+            }
+          }
+          t->called.store(true);
+        },
+        &task, Env::Priority::BOTTOM);
+    for (int i = 0; i < kDelayMicros && !task.called.load(); i++) {
+      Env::Default()->SleepForMicroseconds(1);
+    }
+    EXPECT_TRUE(task.called.load());
+    return task.cpus;
+  };
+
+  {
+    // A single CPU
+    ThreadPoolCpuAffinity affinity;
+    affinity.cpus = {process_cpus.back()};
+    ASSERT_OK(env_->SetThreadPoolCpuAffinity(Env::BOTTOM, affinity));
+    ASSERT_EQ(RunTask(), std::vector<int>{process_cpus.back()});
+  }
+
+  if (process_cpus.size() > 1) {
+    // All the CPUs but the isolated one
+    ThreadPoolCpuAffinity affinity;
+    affinity.isolated_cpus = {process_cpus.front()};
+    ASSERT_OK(env_->SetThreadPoolCpuAffinity(Env::BOTTOM, affinity));
+    ASSERT_EQ(RunTask(), std::vector<int>(process_cpus.begin() + 1,
+                                          process_cpus.end()));
+  }
+
+  {
+    // No CPU left
+    ThreadPoolCpuAffinity affinity;
+    affinity.cpus = {process_cpus.front()};
+    affinity.isolated_cpus = {process_cpus.front()};
+    ASSERT_TRUE(env_->SetThreadPoolCpuAffinity(Env::BOTTOM, affinity)
+                    .IsInvalidArgument());
+    affinity = ThreadPoolCpuAffinity();
+    affinity.numa_node = 1 << 20;
+    ASSERT_TRUE(env_->SetThreadPoolCpuAffinity(Env::BOTTOM, affinity)
+                    .IsInvalidArgument());
+  }
+
+  std::vector<int> node_cpus;
+  if (port::GetNumaNodeCpus(0, &node_cpus)) {
+    ThreadPoolCpuAffinity affinity;
+    affinity.numa_node = 0;
+    Status s = env_->SetThreadPoolCpuAffinity(Env::BOTTOM, affinity);
+    if (s.ok()) {
+      for (int cpu : RunTask()) {
+        ASSERT_TRUE(std::find(node_cpus.begin(), node_cpus.end(), cpu) !=
+                    node_cpus.end());
+      }
+    } else {
+      // The process runs on no CPU of the node
+      ASSERT_TRUE(s.IsInvalidArgument());
+    }
+  }
+
+  // Back to all the CPUs of the process
+  ASSERT_OK(
+      env_->SetThreadPoolCpuAffinity(Env::BOTTOM, ThreadPoolCpuAffinity()));
+  ASSERT_EQ(RunTask(), process_cpus);
+}
+#endif  // OS_LINUX
+
 TEST_F(EnvPosixTest, MemoryMappedFileBuffer) {
   const int kFileBytes = 1 << 15;  // 32 KB
   std::string expected_data;
@@ -1732,6 +1824,183 @@ TEST_F(EnvPosixTest, MultiReadIOUringError2) {
   SyncPoint::GetInstance()->DisableProcessing();
   SyncPoint::GetInstance()->ClearAllCallBacks();
 }
+
+TEST_F(EnvPosixTest, MultiReadIOUringFixedFile) {
+  EnvOptions soptions;
+  soptions.use_direct_reads = soptions.use_direct_writes = false;
+  std::string fname = test::PerThreadDBPath(env_, "testfile");
+
+  const size_t kNumReads = 2 * kIoUringFixedFileMinReads;
+  const size_t kReadSize = 1000;
+  Random rnd(301);
+  std::string expected_data = rnd.RandomString(2 * kNumReads * kReadSize);
+  {
+    std::unique_ptr<WritableFile> wfile;
+    ASSERT_OK(env_->NewWritableFile(fname, &wfile, soptions));
+    ASSERT_OK(wfile->Append(expected_data));
+    ASSERT_OK(wfile->Close());
+  }
+  std::unique_ptr<RandomAccessFile> file;
+  ASSERT_OK(env_->NewRandomAccessFile(fname, &file, soptions));
+
+  std::vector<bool> fixed_files;
+  SyncPoint::GetInstance()->SetCallBack(
+      "PosixRandomAccessFile::MultiRead:FixedFile", [&](void* arg) {
+        fixed_files.push_back(*static_cast<bool*>(arg));
+      });
+  SyncPoint::GetInstance()->EnableProcessing();
+
+  // The second batch reuses the slot released by the first one, and the
+  // last one is too small to register the file
+  for (size_t num_reads :
+       {kNumReads, kNumReads, kIoUringFixedFileMinReads - 1}) {
+    std::vector<std::string> scratches(num_reads, std::string(kReadSize, ' '));
+    std::vector<ReadRequest> reqs(num_reads);
+    for (size_t i = 0; i < num_reads; ++i) {
+      reqs[i].offset = 2 * i * kReadSize;
+      reqs[i].len = kReadSize;
+      reqs[i].scratch = &scratches[i][0];
+    }
+    ASSERT_OK(file->MultiRead(reqs.data(), reqs.size()));
+    for (size_t i = 0; i < num_reads; ++i) {
+      ASSERT_OK(reqs[i].status);
+      ASSERT_EQ(expected_data.substr(reqs[i].offset, kReadSize),
+                reqs[i].result.ToString());
+    }
+  }
+
+  SyncPoint::GetInstance()->DisableProcessing();
+  SyncPoint::GetInstance()->ClearAllCallBacks();
+  if (!fixed_files.empty()) {
+    // Without io_uring support, MultiRead() reads the requests one by one
+    ASSERT_EQ(3, fixed_files.size());
+    ASSERT_EQ(fixed_files[0], fixed_files[1]);
+    ASSERT_FALSE(fixed_files[2]);
+  }
+}
+
+TEST_F(EnvPosixTest, IOUringWrites) {
+  EnvOptions soptions;
+  soptions.use_direct_reads = soptions.use_direct_writes = false;
+  soptions.use_io_uring_for_writes = true;
+  soptions.writable_file_max_buffer_size = kIoUringMinWriteBufferSize;
+  std::string fname = test::PerThreadDBPath(env_, "testfile");
+
+  int num_async_writes = 0;
+  SyncPoint::GetInstance()->SetCallBack(
+      "PosixWritableFile::SubmitWriteBuffer",
+      [&](void* /*arg*/) { ++num_async_writes; });
+  SyncPoint::GetInstance()->EnableProcessing();
+
+  Random rnd(301);
+  std::string expected_data;
+  {
+    std::unique_ptr<WritableFile> wfile;
+    ASSERT_OK(env_->NewWritableFile(fname, &wfile, soptions));
+    // Small appends stay buffered until the sync, large ones fill the
+    // buffers, and one is larger than both buffers together
+    for (size_t size : {size_t{100}, size_t{1000}, kIoUringMinWriteBufferSize,
+                        3 * kIoUringMinWriteBufferSize + 7, size_t{10}}) {
+      std::string data = rnd.RandomString(static_cast<int>(size));
+      ASSERT_OK(wfile->Append(data));
+      expected_data += data;
+      ASSERT_EQ(expected_data.size(), wfile->GetFileSize());
+      ASSERT_OK(wfile->Sync());
+
+      std::string contents;
+      ASSERT_OK(ReadFileToString(env_, fname, &contents));
+      ASSERT_EQ(expected_data, contents);
+    }
+    // Data that was not synced is written on close
+    std::string data = rnd.RandomString(2 * kIoUringMinWriteBufferSize);
+    ASSERT_OK(wfile->Append(data));
+    expected_data += data;
+    ASSERT_OK(wfile->Close());
+  }
+  std::string contents;
+  ASSERT_OK(ReadFileToString(env_, fname, &contents));
+  ASSERT_EQ(expected_data, contents);
+
+  SyncPoint::GetInstance()->DisableProcessing();
+  SyncPoint::GetInstance()->ClearAllCallBacks();
+  if (num_async_writes > 0) {
+    // Without io_uring support, the file is written with blocking syscalls
+    ASSERT_GE(num_async_writes, 4);
+  }
+}
+
+TEST_F(EnvPosixTest, IOUringWritesVisibleAfterFlush) {
+  EnvOptions soptions;
+  soptions.use_direct_reads = soptions.use_direct_writes = false;
+  soptions.use_io_uring_for_writes = true;
+  soptions.writable_file_max_buffer_size = kIoUringMinWriteBufferSize;
+  std::string fname = test::PerThreadDBPath(env_, "testfile");
+
+  Random rnd(301);
+  std::string expected_data;
+  std::unique_ptr<WritableFile> wfile;
+  ASSERT_OK(env_->NewWritableFile(fname, &wfile, soptions));
+  // Without a sync, as WAL writes with WriteOptions::sync false. The staged
+  // data must be written out, not only the full buffers.
+  for (size_t size : {size_t{100}, kIoUringMinWriteBufferSize + 3,
+                      3 * kIoUringMinWriteBufferSize, size_t{1}}) {
+    std::string data = rnd.RandomString(static_cast<int>(size));
+    ASSERT_OK(wfile->Append(data));
+    expected_data += data;
+    ASSERT_OK(wfile->Flush());
+
+    std::string contents;
+    ASSERT_OK(ReadFileToString(env_, fname, &contents));
+    ASSERT_EQ(expected_data, contents);
+  }
+  // Appends after a flush continue at the end of the flushed data
+  std::string data = rnd.RandomString(10);
+  ASSERT_OK(wfile->Append(data));
+  expected_data += data;
+  ASSERT_OK(wfile->Sync());
+  std::string contents;
+  ASSERT_OK(ReadFileToString(env_, fname, &contents));
+  ASSERT_EQ(expected_data, contents);
+  ASSERT_OK(wfile->Close());
+}
+
+TEST_F(EnvPosixTest, IOUringWritesSyncWhileAppending) {
+  EnvOptions soptions;
+  soptions.use_direct_reads = soptions.use_direct_writes = false;
+  soptions.use_io_uring_for_writes = true;
+  soptions.writable_file_max_buffer_size = kIoUringMinWriteBufferSize;
+  std::string fname = test::PerThreadDBPath(env_, "testfile");
+
+  std::unique_ptr<WritableFile> wfile;
+  ASSERT_OK(env_->NewWritableFile(fname, &wfile, soptions));
+  // As DB::SyncWAL() does while the WAL is written
+  ASSERT_TRUE(wfile->IsSyncThreadSafe());
+  std::atomic<bool> done{false};
+  port::Thread syncer([&]() {
+    while (!done.load()) {
+      ASSERT_OK(wfile->Sync());
+    }
+  });
+  Random rnd(301);
+  std::string expected_data;
+  for (int i = 0; i < 1000; ++i) {
+    const int size = static_cast<int>(
+        1 + rnd.Uniform(static_cast<int>(kIoUringMinWriteBufferSize)));
+    std::string data = rnd.RandomString(size);
+    ASSERT_OK(wfile->Append(data));
+    expected_data += data;
+    if (i % 10 == 0) {
+      ASSERT_OK(wfile->Flush());
+    }
+  }
+  done.store(true);
+  syncer.join();
+  ASSERT_OK(wfile->Close());
+
+  std::string contents;
+  ASSERT_OK(ReadFileToString(env_, fname, &contents));
+  ASSERT_EQ(expected_data, contents);
+}
 #endif  // ROCKSDB_IOURING_PRESENT
 
 // Only works in linux platforms
@@ -2697,6 +2966,91 @@ TEST_F(CreateEnvTest, LoadCTRProvider) {
   provider.reset();
 }
 
+#ifdef ROCKSDB_OPENSSL
+TEST_F(CreateEnvTest, LoadAESCTRProvider) {
+  std::shared_ptr<EncryptionProvider> provider;
+  ASSERT_OK(EncryptionProvider::CreateFromString(config_options_, "AES_CTR",
+                                                 &provider));
+  ASSERT_NE(provider, nullptr);
+  ASSERT_STREQ(provider->Name(), AESCTREncryptionProvider::kClassName());
+
+  std::string prefix(provider->GetPrefixLength(), '\0');
+  ASSERT_TRUE(provider->CreateNewPrefix("f", &prefix[0], prefix.size())
+                  .IsInvalidArgument());
+  ASSERT_TRUE(provider->AddCipher("", "0123456789", 10, true)
+                  .IsInvalidArgument());
+  const std::string key(32, 'k');
+  ASSERT_OK(provider->AddCipher("", key.data(), key.size(), true));
+  ASSERT_TRUE(provider->AddCipher("", key.data(), key.size(), true)
+                  .IsNotSupported());
+
+  // Each file gets its own initial counter
+  std::string other_prefix(prefix.size(), '\0');
+  ASSERT_OK(provider->CreateNewPrefix("f", &prefix[0], prefix.size()));
+  ASSERT_OK(provider->CreateNewPrefix("f", &other_prefix[0],
+                                      other_prefix.size()));
+  ASSERT_NE(prefix.substr(0, AESCTRCipherStream::kBlockSize),
+            other_prefix.substr(0, AESCTRCipherStream::kBlockSize));
+
+  Slice prefix_slice(prefix);
+  std::unique_ptr<BlockAccessCipherStream> stream;
+  ASSERT_OK(provider->CreateCipherStream("f", EnvOptions(), prefix_slice,
+                                         &stream));
+  const std::string plain = "some data to encrypt";
+  std::string data = plain;
+  ASSERT_OK(stream->Encrypt(100, &data[0], data.size()));
+  ASSERT_NE(data, plain);
+  ASSERT_OK(stream->Decrypt(100, &data[0], data.size()));
+  ASSERT_EQ(data, plain);
+  provider.reset();
+
+  ASSERT_OK(EncryptionProvider::CreateFromString(
+      config_options_, "AES_CTR://test", &provider));
+  ASSERT_OK(provider->CreateNewPrefix("f", &prefix[0], prefix.size()));
+}
+
+TEST_F(CreateEnvTest, AESCTRCipherStreamVectors) {
+  // CTR-AES256.Encrypt of F.5.5 of NIST SP 800-38A
+  std::string key, iv, plain, cipher;
+  ASSERT_TRUE(Slice("603DEB1015CA71BE2B73AEF0857D77811F352C073B6108D72D9810A3"
+                    "0914DFF4")
+                  .DecodeHex(&key));
+  ASSERT_TRUE(Slice("F0F1F2F3F4F5F6F7F8F9FAFBFCFDFEFF").DecodeHex(&iv));
+  ASSERT_TRUE(Slice("6BC1BEE22E409F96E93D7E117393172AAE2D8A571E03AC9C9EB76FAC"
+                    "45AF8E5130C81C46A35CE411E5FBC1191A0A52EFF69F2445DF4F9B17"
+                    "AD2B417BE66C3710")
+                  .DecodeHex(&plain));
+  ASSERT_TRUE(Slice("601EC313775789A5B7A7F504BBF3D228F443E3CA4D62B59ACA84E990"
+                    "CACAF5C52B0930DAA23DE94CE87017BA2D84988DDFC9C58DB67AADA6"
+                    "13C2DD08457941A6")
+                  .DecodeHex(&cipher));
+
+  AESCTRCipherStream stream(key, iv.data());
+  std::string data = plain;
+  ASSERT_OK(stream.Encrypt(0, &data[0], data.size()));
+  ASSERT_EQ(data, cipher);
+  ASSERT_OK(stream.Decrypt(0, &data[0], data.size()));
+  ASSERT_EQ(data, plain);
+
+  // Encrypting in pieces starting anywhere in a block gives the same result
+  for (size_t split = 1; split < plain.size(); split++) {
+    data = plain;
+    ASSERT_OK(stream.Encrypt(0, &data[0], split));
+    ASSERT_OK(stream.Encrypt(split, &data[split], data.size() - split));
+    ASSERT_EQ(data, cipher);
+  }
+
+  // The block counter carries over to all the bytes of the initial counter
+  const std::string carry_iv(AESCTRCipherStream::kBlockSize, '\xff');
+  AESCTRCipherStream carry_stream(key, carry_iv.data());
+  std::string whole(64, 'x');
+  std::string tail(32, 'x');
+  ASSERT_OK(carry_stream.Encrypt(0, &whole[0], whole.size()));
+  ASSERT_OK(carry_stream.Encrypt(32, &tail[0], tail.size()));
+  ASSERT_EQ(whole.substr(32), tail);
+}
+#endif  // ROCKSDB_OPENSSL
+
 TEST_F(CreateEnvTest, LoadROT13Cipher) {
   std::shared_ptr<BlockCipher> cipher;
   // Test a provider with no cipher
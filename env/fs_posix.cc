@@ -321,6 +321,13 @@ class PosixFileSystem : public FileSystem {
     if (options.use_mmap_writes) {
       MaybeForceDisableMmap(fd);
     }
+    FileOptions file_options = options;
+#if defined(ROCKSDB_IOURING_PRESENT)
+    // The writes submitted together to a file opened with O_APPEND could be
+    // reordered
+    file_options.use_io_uring_for_writes =
+        options.use_io_uring_for_writes && !reopen && IsIOUringEnabled();
+#endif
     if (options.use_mmap_writes && !forceMmapOff_) {
       result->reset(new PosixMmapFile(fname, fd, page_size_, options));
     } else if (options.use_direct_writes && !options.use_mmap_writes) {
@@ -342,10 +349,10 @@ class PosixFileSystem : public FileSystem {
 #endif
       result->reset(new PosixWritableFile(
           fname, fd, GetLogicalBlockSizeForWriteIfNeeded(options, fname, fd),
-          options));
+          file_options));
     } else {
       // disable mmap writes
-      EnvOptions no_mmap_writes_options = options;
+      EnvOptions no_mmap_writes_options = file_options;
       no_mmap_writes_options.use_mmap_writes = false;
       result->reset(
           new PosixWritableFile(fname, fd,
@@ -416,6 +423,11 @@ class PosixFileSystem : public FileSystem {
     if (options.use_mmap_writes) {
       MaybeForceDisableMmap(fd);
     }
+    FileOptions file_options = options;
+#if defined(ROCKSDB_IOURING_PRESENT)
+    file_options.use_io_uring_for_writes =
+        options.use_io_uring_for_writes && IsIOUringEnabled();
+#endif
     if (options.use_mmap_writes && !forceMmapOff_) {
       result->reset(new PosixMmapFile(fname, fd, page_size_, options));
     } else if (options.use_direct_writes && !options.use_mmap_writes) {
@@ -437,10 +449,10 @@ class PosixFileSystem : public FileSystem {
 #endif
       result->reset(new PosixWritableFile(
           fname, fd, GetLogicalBlockSizeForWriteIfNeeded(options, fname, fd),
-          options));
+          file_options));
     } else {
       // disable mmap writes
-      FileOptions no_mmap_writes_options = options;
+      FileOptions no_mmap_writes_options = file_options;
       no_mmap_writes_options.use_mmap_writes = false;
       result->reset(
           new PosixWritableFile(fname, fd,
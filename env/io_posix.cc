@@ -39,6 +39,7 @@
 #include "test_util/sync_point.h"
 #include "util/autovector.h"
 #include "util/coding.h"
+#include "util/defer.h"
 #include "util/string_util.h"
 
 #if defined(OS_LINUX) && !defined(F_SET_RW_HINT)
@@ -650,6 +651,19 @@ IOStatus PosixRandomAccessFile::MultiRead(FSReadRequest* reqs, size_t num_reqs,
     req_wraps.emplace_back(&reqs[i]);
   }
 
+  // The file is only registered for the duration of the call: a file left
+  // registered would not be closed with fd_, and the fd number could be
+  // reused by another file
+  bool fixed_file = num_reqs >= kIoUringFixedFileMinReads &&
+                    RegisterIOUringFile(iu, fd_);
+  TEST_SYNC_POINT_CALLBACK("PosixRandomAccessFile::MultiRead:FixedFile",
+                           &fixed_file);
+  Defer unregister_file([iu, &fixed_file]() {
+    if (fixed_file) {
+      UnregisterIOUringFile(iu);
+    }
+  });
+
   size_t reqs_off = 0;
   while (num_reqs > reqs_off || !incomplete_rq_list.empty()) {
     size_t this_reqs = (num_reqs - reqs_off) + incomplete_rq_list.size();
@@ -676,8 +690,11 @@ IOStatus PosixRandomAccessFile::MultiRead(FSReadRequest* reqs, size_t num_reqs,
       struct io_uring_sqe* sqe;
       sqe = io_uring_get_sqe(iu);
       io_uring_prep_readv(
-          sqe, fd_, &rep_to_submit->iov, 1,
+          sqe, fixed_file ? 0 : fd_, &rep_to_submit->iov, 1,
           rep_to_submit->req->offset + rep_to_submit->finished_len);
+      if (fixed_file) {
+        io_uring_sqe_set_flags(sqe, IOSQE_FIXED_FILE);
+      }
       io_uring_sqe_set_data(sqe, rep_to_submit);
       wrap_cache.emplace(rep_to_submit);
     }
@@ -1269,7 +1286,8 @@ IOStatus PosixMmapFile::Allocate(uint64_t offset, uint64_t len,
 /*
  * PosixWritableFile
  *
- * Use posix write to write data to a file.
+ * Use posix write to write data to a file, or an io_uring with
+ * EnvOptions::use_io_uring_for_writes.
  */
 PosixWritableFile::PosixWritableFile(const std::string& fname, int fd,
                                      size_t logical_block_size,
@@ -1288,6 +1306,30 @@ PosixWritableFile::PosixWritableFile(const std::string& fname, int fd,
   sync_file_range_supported_ = IsSyncFileRangeSupported(fd_);
 #endif  // ROCKSDB_RANGESYNC_PRESENT
   assert(!options.use_mmap_writes);
+#if defined(ROCKSDB_IOURING_PRESENT)
+  if (options.use_io_uring_for_writes) {
+    struct io_uring* iu = new struct io_uring;
+    if (io_uring_queue_init(kIoUringWriteDepth, iu, 0) == 0) {
+      write_uring_ = iu;
+      const size_t capacity = std::max(options.writable_file_max_buffer_size,
+                                       kIoUringMinWriteBufferSize);
+      struct iovec iovs[2];
+      for (size_t i = 0; i < 2; ++i) {
+        write_buffers_[i].buf.Alignment(logical_sector_size_);
+        write_buffers_[i].buf.AllocateNewBuffer(capacity);
+        iovs[i].iov_base = write_buffers_[i].buf.BufferStart();
+        iovs[i].iov_len = write_buffers_[i].buf.Capacity();
+      }
+      // Fails on old kernels or beyond RLIMIT_MEMLOCK, and the buffers are
+      // then written without IORING_OP_WRITE_FIXED
+      write_buffers_registered_ =
+          io_uring_register_buffers(write_uring_, iovs, 2) == 0;
+    } else {
+      // The platform doesn't support io_uring
+      delete iu;
+    }
+  }
+#endif  // ROCKSDB_IOURING_PRESENT
 }
 
 PosixWritableFile::~PosixWritableFile() {
@@ -1295,14 +1337,235 @@ PosixWritableFile::~PosixWritableFile() {
     IOStatus s = PosixWritableFile::Close(IOOptions(), nullptr);
     s.PermitUncheckedError();
   }
+#if defined(ROCKSDB_IOURING_PRESENT)
+  if (write_uring_ != nullptr) {
+    io_uring_queue_exit(write_uring_);
+    delete write_uring_;
+  }
+#endif  // ROCKSDB_IOURING_PRESENT
+}
+
+#if defined(ROCKSDB_IOURING_PRESENT)
+IOStatus PosixWritableFile::StageWrite(const Slice& data, uint64_t offset) {
+  if (!async_write_status_.ok()) {
+    return async_write_status_;
+  }
+  IOStatus s;
+  WriteBuffer* wb = &write_buffers_[cur_write_buffer_];
+  const size_t buffered = wb->buf.CurrentSize();
+  if (buffered > 0 && offset >= wb->offset &&
+      offset <= wb->offset + buffered) {
+    // Appends to the buffered data, or rewrites its tail as direct writes do
+    // with their last partial page
+    wb->buf.Size(static_cast<size_t>(offset - wb->offset));
+  } else {
+    if (buffered > 0) {
+      s = SubmitWriteBuffer(false /* link_next */);
+      if (!s.ok()) {
+        return s;
+      }
+      wb = &write_buffers_[cur_write_buffer_];
+    }
+    if (offset < submitted_end_) {
+      // Rewrites data whose write may be in flight. Let it complete first,
+      // so that the two writes cannot be reordered.
+      s = WaitForWrites(true /* all */);
+      if (!s.ok()) {
+        return s;
+      }
+    }
+    wb->offset = offset;
+  }
+
+  const char* src = data.data();
+  size_t left = data.size();
+  while (left > 0) {
+    const size_t appended = wb->buf.Append(src, left);
+    src += appended;
+    left -= appended;
+    if (left > 0) {
+      s = SubmitWriteBuffer(false /* link_next */);
+      if (!s.ok()) {
+        return s;
+      }
+      wb = &write_buffers_[cur_write_buffer_];
+      wb->offset = offset + (src - data.data());
+    }
+  }
+  filesize_ = offset + data.size();
+  return IOStatus::OK();
+}
+
+// Prepares the write of the buffer being filled. Unless `link_next`, submits
+// it and switches to the other buffer once its own write completed.
+IOStatus PosixWritableFile::SubmitWriteBuffer(bool link_next) {
+  WriteBuffer& wb = write_buffers_[cur_write_buffer_];
+  const size_t nbytes = wb.buf.CurrentSize();
+  if (nbytes > 0) {
+    // The ring is deep enough for both buffers and an fsync
+    struct io_uring_sqe* sqe = io_uring_get_sqe(write_uring_);
+    assert(sqe != nullptr);
+    if (write_buffers_registered_) {
+      io_uring_prep_write_fixed(sqe, fd_, wb.buf.BufferStart(),
+                                static_cast<unsigned>(nbytes), wb.offset,
+                                static_cast<int>(cur_write_buffer_));
+    } else {
+      io_uring_prep_write(sqe, fd_, wb.buf.BufferStart(),
+                          static_cast<unsigned>(nbytes), wb.offset);
+    }
+    io_uring_sqe_set_data(sqe, &wb);
+    if (link_next) {
+      // Cancels the next request, the fsync, if the write fails. The whole
+      // chain starts after the writes submitted before completed.
+      sqe->flags |= IOSQE_IO_LINK | IOSQE_IO_DRAIN;
+    }
+    wb.in_flight = true;
+    submitted_end_ = std::max(submitted_end_, wb.offset + nbytes);
+    if (link_next) {
+      return IOStatus::OK();
+    }
+    TEST_SYNC_POINT_CALLBACK("PosixWritableFile::SubmitWriteBuffer", &wb);
+    ssize_t ret = io_uring_submit(write_uring_);
+    if (ret < 0) {
+      return IOError("While io_uring_submit() writes", filename_,
+                     static_cast<int>(-ret));
+    }
+  }
+
+  cur_write_buffer_ ^= 1;
+  while (write_buffers_[cur_write_buffer_].in_flight) {
+    IOStatus s = WaitForWrites(false /* all */);
+    if (!s.ok()) {
+      return s;
+    }
+  }
+  write_buffers_[cur_write_buffer_].buf.Clear();
+  return async_write_status_;
 }
 
+// Reaps one completion, or all of them with `all`. A short write is
+// completed with a blocking write.
+IOStatus PosixWritableFile::WaitForWrites(bool all) {
+  bool reaped = false;
+  while (write_buffers_[0].in_flight || write_buffers_[1].in_flight ||
+         fsync_in_flight_) {
+    if (reaped && !all) {
+      break;
+    }
+    struct io_uring_cqe* cqe = nullptr;
+    ssize_t ret = io_uring_wait_cqe(write_uring_, &cqe);
+    if (ret == -EINTR || ret == -EAGAIN) {
+      continue;
+    }
+    if (ret < 0) {
+      return IOError("While io_uring_wait_cqe() for writes", filename_,
+                     static_cast<int>(-ret));
+    }
+    reaped = true;
+    WriteBuffer* wb = static_cast<WriteBuffer*>(io_uring_cqe_get_data(cqe));
+    const int res = cqe->res;
+    io_uring_cqe_seen(write_uring_, cqe);
+
+    if (wb == nullptr) {
+      fsync_in_flight_ = false;
+      fsync_result_ = res;
+      continue;
+    }
+    wb->in_flight = false;
+    if (!async_write_status_.ok()) {
+      continue;
+    }
+    const size_t nbytes = wb->buf.CurrentSize();
+    if (res < 0) {
+      async_write_status_ = IOError("While appending to file", filename_, -res);
+    } else if (static_cast<size_t>(res) < nbytes) {
+      if (!PosixPositionedWrite(fd_, wb->buf.BufferStart() + res, nbytes - res,
+                                static_cast<off_t>(wb->offset + res))) {
+        async_write_status_ =
+            IOError("While appending to file", filename_, errno);
+      }
+      // A linked fsync was cancelled, or may have missed this data
+      short_write_completed_ = true;
+    }
+  }
+  return async_write_status_;
+}
+
+IOStatus PosixWritableFile::DrainWrites() {
+  IOStatus s;
+  if (write_buffers_[cur_write_buffer_].buf.CurrentSize() > 0) {
+    s = SubmitWriteBuffer(false /* link_next */);
+  }
+  IOStatus wait_status = WaitForWrites(true /* all */);
+  return s.ok() ? wait_status : s;
+}
+
+// Submits the buffered data linked with the fsync in a single syscall. The
+// fsync also waits for the writes submitted before.
+IOStatus PosixWritableFile::SyncWithIOUring(bool datasync) {
+  if (!async_write_status_.ok()) {
+    return async_write_status_;
+  }
+  WriteBuffer& wb = write_buffers_[cur_write_buffer_];
+  const bool has_data = wb.buf.CurrentSize() > 0;
+  if (has_data) {
+    IOStatus s = SubmitWriteBuffer(true /* link_next */);
+    if (!s.ok()) {
+      return s;
+    }
+  }
+  struct io_uring_sqe* sqe = io_uring_get_sqe(write_uring_);
+  assert(sqe != nullptr);
+  io_uring_prep_fsync(sqe, fd_, datasync ? IORING_FSYNC_DATASYNC : 0);
+  io_uring_sqe_set_data(sqe, nullptr);
+  // Starts after the writes submitted before, once they completed
+  sqe->flags |= IOSQE_IO_DRAIN;
+  fsync_in_flight_ = true;
+  fsync_result_ = 0;
+  short_write_completed_ = false;
+  ssize_t ret = io_uring_submit_and_wait(write_uring_, has_data ? 2 : 1);
+  if (ret < 0) {
+    // The requests may not have been submitted, nothing would complete
+    wb.in_flight = false;
+    fsync_in_flight_ = false;
+    async_write_status_ = IOError("While io_uring_submit() fsync", filename_,
+                                  static_cast<int>(-ret));
+    return async_write_status_;
+  }
+  IOStatus s = WaitForWrites(true /* all */);
+  if (!s.ok()) {
+    return s;
+  }
+  if (has_data) {
+    wb.offset += wb.buf.CurrentSize();
+    wb.buf.Clear();
+  }
+  if (short_write_completed_ || fsync_result_ == -ECANCELED) {
+    // Some data was written after the fsync started, or it was cancelled
+    if ((datasync ? fdatasync(fd_) : fsync(fd_)) < 0) {
+      return IOError(datasync ? "While fdatasync" : "While fsync", filename_,
+                     errno);
+    }
+  } else if (fsync_result_ < 0) {
+    return IOError(datasync ? "While fdatasync" : "While fsync", filename_,
+                   -fsync_result_);
+  }
+  return IOStatus::OK();
+}
+#endif  // ROCKSDB_IOURING_PRESENT
+
 IOStatus PosixWritableFile::Append(const Slice& data, const IOOptions& /*opts*/,
                                    IODebugContext* /*dbg*/) {
   if (use_direct_io()) {
     assert(IsSectorAligned(data.size(), GetRequiredBufferAlignment()));
     assert(IsSectorAligned(data.data(), GetRequiredBufferAlignment()));
   }
+#if defined(ROCKSDB_IOURING_PRESENT)
+  if (write_uring_ != nullptr) {
+    MutexLock l(&write_mutex_);
+    return StageWrite(data, filesize_);
+  }
+#endif  // ROCKSDB_IOURING_PRESENT
   const char* src = data.data();
   size_t nbytes = data.size();
 
@@ -1323,6 +1586,12 @@ IOStatus PosixWritableFile::PositionedAppend(const Slice& data, uint64_t offset,
     assert(IsSectorAligned(data.data(), GetRequiredBufferAlignment()));
   }
   assert(offset <= static_cast<uint64_t>(std::numeric_limits<off_t>::max()));
+#if defined(ROCKSDB_IOURING_PRESENT)
+  if (write_uring_ != nullptr) {
+    MutexLock l(&write_mutex_);
+    return StageWrite(data, offset);
+  }
+#endif  // ROCKSDB_IOURING_PRESENT
   const char* src = data.data();
   size_t nbytes = data.size();
   if (!PosixPositionedWrite(fd_, src, nbytes, static_cast<off_t>(offset))) {
@@ -1336,6 +1605,18 @@ IOStatus PosixWritableFile::PositionedAppend(const Slice& data, uint64_t offset,
 IOStatus PosixWritableFile::Truncate(uint64_t size, const IOOptions& /*opts*/,
                                      IODebugContext* /*dbg*/) {
   IOStatus s;
+#if defined(ROCKSDB_IOURING_PRESENT)
+  if (write_uring_ != nullptr) {
+    MutexLock l(&write_mutex_);
+    s = DrainWrites();
+    if (!s.ok()) {
+      return s;
+    }
+    // The buffers start again at the new end of the file
+    write_buffers_[cur_write_buffer_].offset = size;
+    submitted_end_ = std::min(submitted_end_, size);
+  }
+#endif  // ROCKSDB_IOURING_PRESENT
   int r = ftruncate(fd_, size);
   if (r < 0) {
     s = IOError("While ftruncate file to size " + std::to_string(size),
@@ -1349,6 +1630,12 @@ IOStatus PosixWritableFile::Truncate(uint64_t size, const IOOptions& /*opts*/,
 IOStatus PosixWritableFile::Close(const IOOptions& /*opts*/,
                                   IODebugContext* /*dbg*/) {
   IOStatus s;
+#if defined(ROCKSDB_IOURING_PRESENT)
+  if (write_uring_ != nullptr) {
+    MutexLock l(&write_mutex_);
+    s = DrainWrites();
+  }
+#endif  // ROCKSDB_IOURING_PRESENT
 
   size_t block_size;
   size_t last_allocated_block;
@@ -1399,11 +1686,28 @@ IOStatus PosixWritableFile::Close(const IOOptions& /*opts*/,
 // write out the cached data to the OS cache
 IOStatus PosixWritableFile::Flush(const IOOptions& /*opts*/,
                                   IODebugContext* /*dbg*/) {
+#if defined(ROCKSDB_IOURING_PRESENT)
+  if (write_uring_ != nullptr) {
+    // Readers of the file, and a crash of the process, must not miss the
+    // staged data once flushed
+    MutexLock l(&write_mutex_);
+    if (!async_write_status_.ok()) {
+      return async_write_status_;
+    }
+    return DrainWrites();
+  }
+#endif  // ROCKSDB_IOURING_PRESENT
   return IOStatus::OK();
 }
 
 IOStatus PosixWritableFile::Sync(const IOOptions& /*opts*/,
                                  IODebugContext* /*dbg*/) {
+#if defined(ROCKSDB_IOURING_PRESENT)
+  if (write_uring_ != nullptr) {
+    MutexLock l(&write_mutex_);
+    return SyncWithIOUring(true /* datasync */);
+  }
+#endif  // ROCKSDB_IOURING_PRESENT
 #ifdef HAVE_FULLFSYNC
   if (::fcntl(fd_, F_FULLFSYNC) < 0) {
     return IOError("while fcntl(F_FULLFSYNC)", filename_, errno);
@@ -1418,6 +1722,12 @@ IOStatus PosixWritableFile::Sync(const IOOptions& /*opts*/,
 
 IOStatus PosixWritableFile::Fsync(const IOOptions& /*opts*/,
                                   IODebugContext* /*dbg*/) {
+#if defined(ROCKSDB_IOURING_PRESENT)
+  if (write_uring_ != nullptr) {
+    MutexLock l(&write_mutex_);
+    return SyncWithIOUring(false /* datasync */);
+  }
+#endif  // ROCKSDB_IOURING_PRESENT
 #ifdef HAVE_FULLFSYNC
   if (::fcntl(fd_, F_FULLFSYNC) < 0) {
     return IOError("while fcntl(F_FULLFSYNC)", filename_, errno);
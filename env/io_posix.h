@@ -24,6 +24,7 @@
 #include "rocksdb/file_system.h"
 #include "rocksdb/io_status.h"
 #include "test_util/sync_point.h"
+#include "util/aligned_buffer.h"
 #include "util/mutexlock.h"
 #include "util/thread_local.h"
 
@@ -263,6 +264,19 @@ class PosixSequentialFile : public FSSequentialFile {
 // io_uring instance queue depth
 const unsigned int kIoUringDepth = 256;
 
+// Queue depth of the io_uring of a PosixWritableFile, which has at most two
+// writes and an fsync in flight
+const unsigned int kIoUringWriteDepth = 4;
+
+// Minimum size of the staging buffers of a PosixWritableFile written through
+// an io_uring
+const size_t kIoUringMinWriteBufferSize = 64 << 10;
+
+// MultiRead() registers the file with the io_uring for the batches of at
+// least this many reads, which saves the kernel the lookup and the ref
+// counting of the fd in each read
+const size_t kIoUringFixedFileMinReads = 8;
+
 inline void DeleteIOUring(void* p) {
   struct io_uring* iu = static_cast<struct io_uring*>(p);
   delete iu;
@@ -274,9 +288,27 @@ inline struct io_uring* CreateIOUring() {
   if (ret) {
     delete new_io_uring;
     new_io_uring = nullptr;
+  } else {
+    // An empty slot for RegisterIOUringFile(). Kernels without
+    // registered files fail it, and the files are then read by fd.
+    int fds[1] = {-1};
+    io_uring_register_files(new_io_uring, fds, 1);
   }
   return new_io_uring;
 }
+
+// Puts `fd` in the registered file slot 0 of `iu`, so that reads submitted
+// with IOSQE_FIXED_FILE on index 0 use it. Returns false if the ring has no
+// registered files. The file stays registered, and cannot be released by
+// the kernel, until UnregisterIOUringFile().
+inline bool RegisterIOUringFile(struct io_uring* iu, int fd) {
+  return io_uring_register_files_update(iu, 0, &fd, 1) == 1;
+}
+
+inline void UnregisterIOUringFile(struct io_uring* iu) {
+  int fds[1] = {-1};
+  io_uring_register_files_update(iu, 0, fds, 1);
+}
 #endif  // defined(ROCKSDB_IOURING_PRESENT)
 
 class PosixRandomAccessFile : public FSRandomAccessFile {
@@ -341,6 +373,43 @@ class PosixWritableFile : public FSWritableFile {
   // support it, so we need to do a dynamic check too.
   bool sync_file_range_supported_;
 #endif  // ROCKSDB_RANGESYNC_PRESENT
+#if defined(ROCKSDB_IOURING_PRESENT)
+  // With EnvOptions::use_io_uring_for_writes, the appended data is copied to
+  // one of two staging buffers, registered with the io_uring of the file.
+  // A full buffer is written asynchronously while the other one fills.
+  // Flush() writes out the rest and waits for the writes in flight, and
+  // Sync()/Fsync() submit the rest linked with the fsync. nullptr when the
+  // file is written with blocking syscalls.
+  struct io_uring* write_uring_ = nullptr;
+  // Serializes the use of the buffers and of the io_uring, since Sync() may
+  // be called concurrently with Append() and Flush()
+  port::Mutex write_mutex_;
+  struct WriteBuffer {
+    AlignedBuffer buf;
+    // File offset of the start of the buffer
+    uint64_t offset = 0;
+    bool in_flight = false;
+  };
+  WriteBuffer write_buffers_[2];
+  // Index of the buffer being filled
+  size_t cur_write_buffer_ = 0;
+  bool write_buffers_registered_ = false;
+  // End offset of the data submitted so far
+  uint64_t submitted_end_ = 0;
+  // First error of the asynchronous writes, returned by the next call
+  IOStatus async_write_status_;
+  bool fsync_in_flight_ = false;
+  int fsync_result_ = 0;
+  // Whether a short write was completed with a blocking write since the last
+  // fsync was submitted
+  bool short_write_completed_ = false;
+
+  IOStatus StageWrite(const Slice& data, uint64_t offset);
+  IOStatus SubmitWriteBuffer(bool link_next);
+  IOStatus WaitForWrites(bool all);
+  IOStatus DrainWrites();
+  IOStatus SyncWithIOUring(bool datasync);
+#endif  // ROCKSDB_IOURING_PRESENT
 
  public:
   explicit PosixWritableFile(const std::string& fname, int fd,
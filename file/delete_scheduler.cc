@@ -30,11 +30,12 @@ DeleteScheduler::DeleteScheduler(SystemClock* clock, FileSystem* fs,
       fs_(fs),
       total_trash_size_(0),
       rate_bytes_per_sec_(rate_bytes_per_sec),
+      rate_limit_per_directory_(false),
       pending_files_(0),
       bytes_max_delete_chunk_(bytes_max_delete_chunk),
       closing_(false),
       cv_(&mu_),
-      bg_thread_(nullptr),
+      max_delete_threads_(1),
       info_log_(info_log),
       sst_file_manager_(sst_file_manager),
       max_trash_db_ratio_(max_trash_db_ratio) {
@@ -49,8 +50,8 @@ DeleteScheduler::~DeleteScheduler() {
     closing_ = true;
     cv_.SignalAll();
   }
-  if (bg_thread_) {
-    bg_thread_->join();
+  for (auto& bg_thread : bg_threads_) {
+    bg_thread->join();
   }
   for (const auto& it : bg_errors_) {
     it.second.PermitUncheckedError();
@@ -112,10 +113,15 @@ Status DeleteScheduler::DeleteFile(const std::string& file_path,
   // get the file size?
 
   // Add file to delete queue
+  std::string budget;
+  if (rate_limit_per_directory_.load()) {
+    budget = trash_file.substr(0, trash_file.rfind('/'));
+  }
   {
     InstrumentedMutexLock l(&mu_);
     RecordTick(stats_.get(), FILES_MARKED_TRASH);
-    queue_.emplace(trash_file, dir_to_sync);
+    budgets_[budget].num_files++;
+    queue_.emplace(trash_file, dir_to_sync, budget);
     pending_files_++;
     if (pending_files_ == 1) {
       cv_.SignalAll();
@@ -215,12 +221,13 @@ Status DeleteScheduler::MarkAsTrash(const std::string& file_path,
   return s;
 }
 
-void DeleteScheduler::BackgroundEmptyTrash() {
+void DeleteScheduler::BackgroundEmptyTrash(size_t thread_idx) {
   TEST_SYNC_POINT("DeleteScheduler::BackgroundEmptyTrash");
 
+  InstrumentedMutexLock l(&mu_);
   while (true) {
-    InstrumentedMutexLock l(&mu_);
-    while (queue_.empty() && !closing_) {
+    while ((queue_.empty() || thread_idx >= max_delete_threads_) &&
+           !closing_) {
       cv_.Wait();
     }
 
@@ -228,73 +235,86 @@ void DeleteScheduler::BackgroundEmptyTrash() {
       return;
     }
 
-    // Delete all files in queue_
-    uint64_t start_time = clock_->NowMicros();
-    uint64_t total_deleted_bytes = 0;
-    int64_t current_delete_rate = rate_bytes_per_sec_.load();
-    while (!queue_.empty() && !closing_) {
-      if (current_delete_rate != rate_bytes_per_sec_.load()) {
-        // User changed the delete rate
-        current_delete_rate = rate_bytes_per_sec_.load();
-        start_time = clock_->NowMicros();
-        total_deleted_bytes = 0;
-        ROCKS_LOG_INFO(info_log_, "rate_bytes_per_sec is changed to %" PRIi64,
-                       current_delete_rate);
+    // Take the next file to delete. Its chunks are deleted by this thread,
+    // while the other threads delete the next files.
+    FileAndDir fad = std::move(queue_.front());
+    queue_.pop();
+    // Not invalidated while the budget has files
+    DeleteBudget& budget = budgets_[fad.budget];
+    assert(budget.num_files > 0);
+
+    bool is_complete = true;
+    while (!closing_) {
+      int64_t current_delete_rate = rate_bytes_per_sec_.load();
+      if (!budget.started || current_delete_rate != budget.delete_rate) {
+        if (budget.started) {
+          // User changed the delete rate
+          ROCKS_LOG_INFO(info_log_,
+                         "rate_bytes_per_sec is changed to %" PRIi64,
+                         current_delete_rate);
+        }
+        budget.start_time = clock_->NowMicros();
+        budget.total_deleted_bytes = 0;
+        budget.delete_rate = current_delete_rate;
+        budget.started = true;
       }
 
-      // Get new file to delete
-      const FileAndDir& fad = queue_.front();
-      std::string path_in_trash = fad.fname;
-
       // We don't need to hold the lock while deleting the file
       mu_.Unlock();
       uint64_t deleted_bytes = 0;
-      bool is_complete = true;
+      is_complete = true;
       // Delete file from trash and update total_penlty value
       Status s =
-          DeleteTrashFile(path_in_trash, fad.dir, &deleted_bytes, &is_complete);
-      total_deleted_bytes += deleted_bytes;
+          DeleteTrashFile(fad.fname, fad.dir, &deleted_bytes, &is_complete);
       mu_.Lock();
+      budget.total_deleted_bytes += deleted_bytes;
       if (is_complete) {
         RecordTick(stats_.get(), FILES_DELETED_FROM_TRASH_QUEUE);
-        queue_.pop();
       }
 
       if (!s.ok()) {
-        bg_errors_[path_in_trash] = s;
+        bg_errors_[fad.fname] = s;
       }
 
       // Apply penalty if necessary
       uint64_t total_penalty;
       if (current_delete_rate > 0) {
         // rate limiting is enabled
-        total_penalty =
-            ((total_deleted_bytes * kMicrosInSecond) / current_delete_rate);
+        total_penalty = ((budget.total_deleted_bytes * kMicrosInSecond) /
+                         current_delete_rate);
         ROCKS_LOG_INFO(info_log_,
                        "Rate limiting is enabled with penalty %" PRIu64
                        " after deleting file %s",
-                       total_penalty, path_in_trash.c_str());
-        while (!closing_ && !cv_.TimedWait(start_time + total_penalty)) {
+                       total_penalty, fad.fname.c_str());
+        while (!closing_ &&
+               !cv_.TimedWait(budget.start_time + total_penalty)) {
         }
       } else {
         // rate limiting is disabled
         total_penalty = 0;
         ROCKS_LOG_INFO(info_log_,
                        "Rate limiting is disabled after deleting file %s",
-                       path_in_trash.c_str());
+                       fad.fname.c_str());
       }
       TEST_SYNC_POINT_CALLBACK("DeleteScheduler::BackgroundEmptyTrash:Wait",
                                &total_penalty);
 
       if (is_complete) {
-        pending_files_--;
-      }
-      if (pending_files_ == 0) {
-        // Unblock WaitForEmptyTrash since there are no more files waiting
-        // to be deleted
-        cv_.SignalAll();
+        break;
       }
     }
+
+    if (--budget.num_files == 0) {
+      budgets_.erase(fad.budget);
+    }
+    if (is_complete) {
+      pending_files_--;
+    }
+    if (pending_files_ == 0) {
+      // Unblock WaitForEmptyTrash since there are no more files waiting
+      // to be deleted
+      cv_.SignalAll();
+    }
   }
 }
 
@@ -395,14 +415,29 @@ void DeleteScheduler::WaitForEmptyTrash() {
   }
 }
 
+void DeleteScheduler::SetMaxDeleteThreads(size_t num_threads) {
+  assert(num_threads > 0);
+  {
+    InstrumentedMutexLock l(&mu_);
+    max_delete_threads_ = num_threads;
+    // Wake up the parked threads
+    cv_.SignalAll();
+  }
+  MaybeCreateBackgroundThread();
+}
+
 void DeleteScheduler::MaybeCreateBackgroundThread() {
-  if (bg_thread_ == nullptr && rate_bytes_per_sec_.load() > 0) {
-    bg_thread_.reset(
-        new port::Thread(&DeleteScheduler::BackgroundEmptyTrash, this));
+  if (rate_bytes_per_sec_.load() <= 0) {
+    return;
+  }
+  InstrumentedMutexLock l(&mu_);
+  while (bg_threads_.size() < max_delete_threads_) {
+    bg_threads_.emplace_back(new port::Thread(
+        &DeleteScheduler::BackgroundEmptyTrash, this, bg_threads_.size()));
     ROCKS_LOG_INFO(info_log_,
-                   "Created background thread for deletion scheduler with "
-                   "rate_bytes_per_sec: %" PRIi64,
-                   rate_bytes_per_sec_.load());
+                   "Created background thread %" ROCKSDB_PRIszt
+                   " for deletion scheduler with rate_bytes_per_sec: %" PRIi64,
+                   bg_threads_.size(), rate_bytes_per_sec_.load());
   }
 }
 
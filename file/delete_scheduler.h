@@ -10,6 +10,7 @@
 #include <queue>
 #include <string>
 #include <thread>
+#include <vector>
 
 #include "monitoring/instrumented_mutex.h"
 #include "port/port.h"
@@ -30,6 +31,11 @@ class SystemClock;
 //
 // Rate limiting can be turned off by setting rate_bytes_per_sec = 0, In this
 // case DeleteScheduler will delete files immediately.
+//
+// The trash files can be deleted by several background threads, which share
+// the rate budget. With SetRateLimitPerDirectory(true), each directory of
+// trash files, e.g. each db_path on its own device, gets its own budget of
+// rate_bytes_per_sec instead.
 class DeleteScheduler {
  public:
   DeleteScheduler(SystemClock* clock, FileSystem* fs,
@@ -48,6 +54,25 @@ class DeleteScheduler {
     MaybeCreateBackgroundThread();
   }
 
+  // Return the number of background threads deleting trash files
+  size_t GetMaxDeleteThreads() {
+    InstrumentedMutexLock l(&mu_);
+    return max_delete_threads_;
+  }
+
+  // Set the number of background threads deleting trash files. Lowering it
+  // parks the extra threads once they are done with their current file.
+  // REQUIRES: num_threads > 0
+  void SetMaxDeleteThreads(size_t num_threads);
+
+  bool IsRateLimitPerDirectory() { return rate_limit_per_directory_.load(); }
+
+  // Set whether each directory of trash files has its own rate budget. Only
+  // applies to the files scheduled afterwards.
+  void SetRateLimitPerDirectory(bool per_directory) {
+    rate_limit_per_directory_.store(per_directory);
+  }
+
   // Mark file as trash directory and schedule its deletion. If force_bg is
   // set, it forces the file to always be deleted in the background thread,
   // except when rate limiting is disabled
@@ -64,6 +89,12 @@ class DeleteScheduler {
 
   uint64_t GetTotalTrashSize() { return total_trash_size_.load(); }
 
+  // Return the number of trash files waiting to be deleted
+  int32_t GetNumPendingFiles() {
+    InstrumentedMutexLock l(&mu_);
+    return pending_files_;
+  }
+
   // Return trash/DB size ratio where new files will be deleted immediately
   double GetMaxTrashDBRatio() { return max_trash_db_ratio_.load(); }
 
@@ -93,7 +124,7 @@ class DeleteScheduler {
                          const std::string& dir_to_sync,
                          uint64_t* deleted_bytes, bool* is_complete);
 
-  void BackgroundEmptyTrash();
+  void BackgroundEmptyTrash(size_t thread_idx);
 
   void MaybeCreateBackgroundThread();
 
@@ -104,13 +135,30 @@ class DeleteScheduler {
   std::atomic<uint64_t> total_trash_size_;
   // Maximum number of bytes that should be deleted per second
   std::atomic<int64_t> rate_bytes_per_sec_;
-  // Mutex to protect queue_, pending_files_, bg_errors_, closing_, stats_
+  std::atomic<bool> rate_limit_per_directory_;
+  // Mutex to protect queue_, pending_files_, bg_errors_, closing_, stats_,
+  // budgets_, max_delete_threads_, bg_threads_
   InstrumentedMutex mu_;
 
   struct FileAndDir {
-    FileAndDir(const std::string& f, const std::string& d) : fname(f), dir(d) {}
+    FileAndDir(const std::string& f, const std::string& d,
+               const std::string& b)
+        : fname(f), dir(d), budget(b) {}
     std::string fname;
     std::string dir;  // empty will be skipped.
+    // Key of the rate budget in budgets_
+    std::string budget;
+  };
+
+  // The deletions charged to a rate budget since it became busy. A budget
+  // is dropped when none of its files is queued or being deleted.
+  struct DeleteBudget {
+    uint64_t start_time = 0;
+    uint64_t total_deleted_bytes = 0;
+    int64_t delete_rate = 0;
+    bool started = false;
+    // Files of the budget queued or being deleted
+    int32_t num_files = 0;
   };
 
   // Queue of trash files that need to be deleted
@@ -120,8 +168,11 @@ class DeleteScheduler {
   uint64_t bytes_max_delete_chunk_;
   // Errors that happened in BackgroundEmptyTrash (file_path => error)
   std::map<std::string, Status> bg_errors_;
+  // Rate budgets, by directory of trash files if rate_limit_per_directory_,
+  // else a single one keyed by ""
+  std::map<std::string, DeleteBudget> budgets_;
 
-  bool num_link_error_printed_ = false;
+  std::atomic<bool> num_link_error_printed_{false};
   // Set to true in ~DeleteScheduler() to force BackgroundEmptyTrash to stop
   bool closing_;
   // Condition variable signaled in these conditions
@@ -129,8 +180,10 @@ class DeleteScheduler {
   //    - pending_files_ value change from 1 => 0
   //    - closing_ value is set to true
   InstrumentedCondVar cv_;
-  // Background thread running BackgroundEmptyTrash
-  std::unique_ptr<port::Thread> bg_thread_;
+  // Background threads running BackgroundEmptyTrash. The ones from
+  // max_delete_threads_ on are parked.
+  size_t max_delete_threads_;
+  std::vector<std::unique_ptr<port::Thread>> bg_threads_;
   // Mutex to protect threads from file name conflicts
   InstrumentedMutex file_move_mu_;
   Logger* info_log_;
@@ -10,6 +10,7 @@
 #include <thread>
 #include <vector>
 
+#include "db/compaction/compaction.h"
 #include "file/file_util.h"
 #include "file/sst_file_manager_impl.h"
 #include "rocksdb/env.h"
@@ -697,6 +698,114 @@ TEST_F(DeleteSchedulerTest, ImmediateDeleteOn25PercDBSize) {
   ROCKSDB_NAMESPACE::SyncPoint::GetInstance()->DisableProcessing();
 }
 
+// Two background threads delete the trash files at the same time: the first
+// two deletions wait for each other
+TEST_F(DeleteSchedulerTest, ParallelDeletion) {
+  std::atomic<int> num_deleting(0);
+  ROCKSDB_NAMESPACE::SyncPoint::GetInstance()->SetCallBack(
+      "DeleteScheduler::DeleteTrashFile:DeleteFile", [&](void* /*arg*/) {
+        if (num_deleting.fetch_add(1) < 2) {
+          while (num_deleting.load() < 2) {
+            std::this_thread::yield();
+          }
+        }
+      });
+  ROCKSDB_NAMESPACE::SyncPoint::GetInstance()->EnableProcessing();
+
+  rate_bytes_per_sec_ = 1 << 20;  // 1MB / sec
+  NewDeleteScheduler();
+  sst_file_mgr_->SetMaxTrashDeleteThreads(2);
+  ASSERT_EQ(2, sst_file_mgr_->GetMaxTrashDeleteThreads());
+
+  const int kNumFiles = 10;
+  for (int i = 0; i < kNumFiles; i++) {
+    std::string file_name = "data_" + std::to_string(i) + ".data";
+    ASSERT_OK(delete_scheduler_->DeleteFile(NewDummyFile(file_name), ""));
+  }
+  delete_scheduler_->WaitForEmptyTrash();
+
+  ASSERT_EQ(kNumFiles, num_deleting.load());
+  ASSERT_EQ(CountTrashFiles(), 0);
+  ASSERT_EQ(0, delete_scheduler_->GetBackgroundErrors().size());
+  ASSERT_EQ(kNumFiles,
+            stats_->getAndResetTickerCount(FILES_DELETED_FROM_TRASH_QUEUE));
+
+  ROCKSDB_NAMESPACE::SyncPoint::GetInstance()->DisableProcessing();
+}
+
+// The trash files of each directory are rate limited separately, so the
+// penalties grow by file of each directory
+TEST_F(DeleteSchedulerTest, RateLimitingPerDirectory) {
+  ROCKSDB_NAMESPACE::SyncPoint::GetInstance()->LoadDependency({
+      {"DeleteSchedulerTest::RateLimitingPerDirectory:1",
+       "DeleteScheduler::BackgroundEmptyTrash"},
+  });
+  std::vector<uint64_t> penalties;
+  ROCKSDB_NAMESPACE::SyncPoint::GetInstance()->SetCallBack(
+      "DeleteScheduler::BackgroundEmptyTrash:Wait",
+      [&](void* arg) { penalties.push_back(*(static_cast<uint64_t*>(arg))); });
+  ROCKSDB_NAMESPACE::SyncPoint::GetInstance()->EnableProcessing();
+
+  rate_bytes_per_sec_ = 100 * 1024;  // 100KB / sec
+  NewDeleteScheduler();
+  ASSERT_FALSE(sst_file_mgr_->IsDeleteRateLimitPerDirectory());
+  sst_file_mgr_->SetDeleteRateLimitPerDirectory(true);
+  ASSERT_TRUE(sst_file_mgr_->IsDeleteRateLimitPerDirectory());
+
+  const int kNumFiles = 10;
+  const uint64_t kFileSize = 1024;
+  for (int i = 0; i < kNumFiles; i++) {
+    std::string file_name = "data_" + std::to_string(i) + ".data";
+    ASSERT_OK(delete_scheduler_->DeleteFile(
+        NewDummyFile(file_name, kFileSize, i % 2), ""));
+  }
+  TEST_SYNC_POINT("DeleteSchedulerTest::RateLimitingPerDirectory:1");
+  delete_scheduler_->WaitForEmptyTrash();
+
+  ASSERT_EQ(kNumFiles, penalties.size());
+  for (int i = 0; i < kNumFiles; i++) {
+    uint64_t expected_penalty =
+        (i / 2 + 1) * kFileSize * 1000000 / rate_bytes_per_sec_;
+    ASSERT_EQ(expected_penalty, penalties[i]);
+  }
+  ASSERT_EQ(CountTrashFiles(0), 0);
+  ASSERT_EQ(CountTrashFiles(1), 0);
+
+  ROCKSDB_NAMESPACE::SyncPoint::GetInstance()->DisableProcessing();
+}
+
+// Compactions are cancelled while the trash is larger than the max trash
+// backlog
+TEST_F(DeleteSchedulerTest, MaxTrashBacklog) {
+  ROCKSDB_NAMESPACE::SyncPoint::GetInstance()->LoadDependency({
+      {"DeleteSchedulerTest::MaxTrashBacklog:1",
+       "DeleteScheduler::BackgroundEmptyTrash"},
+  });
+  ROCKSDB_NAMESPACE::SyncPoint::GetInstance()->EnableProcessing();
+
+  rate_bytes_per_sec_ = 1 << 20;  // 1MB / sec
+  NewDeleteScheduler();
+  sst_file_mgr_->SetMaxTrashBacklog(1024);
+  ASSERT_EQ(1024, sst_file_mgr_->GetMaxTrashBacklog());
+  const std::vector<CompactionInputFiles> inputs;
+
+  ASSERT_OK(delete_scheduler_->DeleteFile(NewDummyFile("data_1", 1024), ""));
+  // At the limit
+  ASSERT_TRUE(
+      sst_file_mgr_->EnoughRoomForCompaction(nullptr, inputs, Status::OK()));
+  ASSERT_OK(delete_scheduler_->DeleteFile(NewDummyFile("data_2", 1024), ""));
+  ASSERT_EQ(2048, sst_file_mgr_->GetTotalTrashSize());
+  ASSERT_FALSE(
+      sst_file_mgr_->EnoughRoomForCompaction(nullptr, inputs, Status::OK()));
+
+  TEST_SYNC_POINT("DeleteSchedulerTest::MaxTrashBacklog:1");
+  delete_scheduler_->WaitForEmptyTrash();
+  ASSERT_TRUE(
+      sst_file_mgr_->EnoughRoomForCompaction(nullptr, inputs, Status::OK()));
+
+  ROCKSDB_NAMESPACE::SyncPoint::GetInstance()->DisableProcessing();
+}
+
 TEST_F(DeleteSchedulerTest, IsTrashCheck) {
   // Trash files
   ASSERT_TRUE(DeleteScheduler::IsTrashFile("x.trash"));
@@ -256,6 +256,7 @@ void FilePrefetchBuffer::AbortAllIOs() {
       DestroyAndClearIOHandle(buf);
     }
     buf->async_read_in_progress_ = false;
+    ReleasePrefetchSlot(buf);
   }
 }
 
@@ -499,7 +500,10 @@ Status FilePrefetchBuffer::HandleOverlappingData(
                           alignment,
                           /*length=*/0, readahead_size, start_offset,
                           end_offset, read_len, aligned_useful_len);
-      if (read_len > 0) {
+      if (read_len > 0 && !TryAcquirePrefetchSlot(new_buf)) {
+        // The buffer is filled by a later call, when a slot is free
+        FreeLastBuffer();
+      } else if (read_len > 0) {
         s = ReadAsync(new_buf, opts, reader, read_len, start_offset);
         if (!s.ok()) {
           DestroyAndClearIOHandle(new_buf);
@@ -976,6 +980,10 @@ Status FilePrefetchBuffer::PrefetchRemBuffers(const IOOptions& opts,
                         end_offset2, read_len2, aligned_useful_len2);
 
     if (read_len2 > 0) {
+      if (!TryAcquirePrefetchSlot(new_buf)) {
+        FreeLastBuffer();
+        break;
+      }
       TEST_SYNC_POINT("FilePrefetchBuffer::PrefetchAsync:ExtraPrefetching");
       s = ReadAsync(new_buf, opts, reader, read_len2, start_offset2);
       if (!s.ok()) {
@@ -16,11 +16,13 @@
 #include <string>
 
 #include "file/readahead_file_info.h"
+#include "file/scan_prefetch_scheduler.h"
 #include "monitoring/statistics_impl.h"
 #include "port/port.h"
 #include "rocksdb/env.h"
 #include "rocksdb/file_system.h"
 #include "rocksdb/options.h"
+#include "test_util/sync_point.h"
 #include "util/aligned_buffer.h"
 #include "util/autovector.h"
 #include "util/stop_watch.h"
@@ -56,9 +58,15 @@ struct ReadaheadParams {
   // Number of buffers to maintain that contains prefetched data. If num_buffers
   // > 1 then buffers will be filled asynchronously whenever they get emptied.
   size_t num_buffers = 1;
+
+  // If set, bounds the asynchronous readahead of the buffers along with the
+  // other files of the scan. Must outlive the FilePrefetchBuffer.
+  ScanPrefetchScheduler* prefetch_scheduler = nullptr;
 };
 
 struct BufferInfo {
+  BufferInfo() { buffer_.UsePool(); }
+
   void ClearBuffer() {
     buffer_.Clear();
     initial_end_offset_ = 0;
@@ -83,6 +91,10 @@ struct BufferInfo {
 
   IOHandleDeleter del_fn_ = nullptr;
 
+  // True if the async read in progress holds a slot of the
+  // ScanPrefetchScheduler.
+  bool holds_prefetch_slot_ = false;
+
   // initial_end_offset is used to keep track of the end offset of the buffer
   // that was originally called. It's helpful in case of autotuning of readahead
   // size when callback is made to BlockBasedTableIterator.
@@ -202,7 +214,8 @@ class FilePrefetchBuffer {
         stats_(stats),
         usage_(usage),
         readaheadsize_cb_(cb),
-        num_buffers_(readahead_params.num_buffers) {
+        num_buffers_(readahead_params.num_buffers),
+        prefetch_scheduler_(readahead_params.prefetch_scheduler) {
     assert((num_file_reads_ >= num_file_reads_for_auto_readahead_ + 1) ||
            (num_file_reads_ == 0));
 
@@ -242,6 +255,9 @@ class FilePrefetchBuffer {
         buf->async_read_in_progress_ = false;
       }
     }
+    for (auto& buf : bufs_) {
+      ReleasePrefetchSlot(buf);
+    }
 
     // Prefetch buffer bytes discarded.
     uint64_t bytes_discarded = 0;
@@ -282,6 +298,23 @@ class FilePrefetchBuffer {
 
   bool Enabled() const { return enable_; }
 
+  // Makes the asynchronous readahead of the buffer count against the budget
+  // of `prefetch_scheduler`, or unbounded if nullptr. The slots held in the
+  // previous scheduler are given back.
+  void SetPrefetchScheduler(ScanPrefetchScheduler* prefetch_scheduler) {
+    for (auto& buf : bufs_) {
+      ReleasePrefetchSlot(buf);
+    }
+    prefetch_scheduler_ = prefetch_scheduler;
+  }
+
+  // Aborts the asynchronous reads in progress, e.g. when the iterator
+  // reseeks. The data already read stays in the buffers.
+  void AbortAsyncReads() {
+    AbortAllIOs();
+    FreeEmptyBuffers();
+  }
+
   // Called externally by user to only load data into the buffer from a file
   // with num_buffers_ should be set to default(1).
   //
@@ -472,6 +505,30 @@ class FilePrefetchBuffer {
       buf->del_fn_ = nullptr;
     }
     buf->async_read_in_progress_ = false;
+    ReleasePrefetchSlot(buf);
+  }
+
+  // Takes a slot of prefetch_scheduler_, if any, for an asynchronous
+  // readahead into `buf`. Returns false if there is none left.
+  bool TryAcquirePrefetchSlot(BufferInfo* buf) {
+    assert(!buf->holds_prefetch_slot_);
+    if (prefetch_scheduler_ == nullptr) {
+      return true;
+    }
+    if (!prefetch_scheduler_->TryAcquire()) {
+      TEST_SYNC_POINT("FilePrefetchBuffer::TryAcquirePrefetchSlot:Denied");
+      return false;
+    }
+    buf->holds_prefetch_slot_ = true;
+    return true;
+  }
+
+  void ReleasePrefetchSlot(BufferInfo* buf) {
+    if (buf->holds_prefetch_slot_) {
+      assert(prefetch_scheduler_ != nullptr);
+      prefetch_scheduler_->Release();
+      buf->holds_prefetch_slot_ = false;
+    }
   }
 
   Status HandleOverlappingData(const IOOptions& opts,
@@ -625,5 +682,7 @@ class FilePrefetchBuffer {
   // num_buffers_ is the number of buffers maintained by FilePrefetchBuffer to
   // prefetch the data at a time.
   size_t num_buffers_;
+
+  ScanPrefetchScheduler* prefetch_scheduler_;
 };
 }  // namespace ROCKSDB_NAMESPACE
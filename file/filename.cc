@@ -253,6 +253,14 @@ std::string IdentityFileName(const std::string& dbname) {
   return dbname + "/IDENTITY";
 }
 
+std::string MemTableSnapshotFileName(const std::string& dbname) {
+  return dbname + "/MEMTABLE_SNAPSHOT";
+}
+
+std::string TableSummaryFileName(const std::string& dbname) {
+  return dbname + "/TABLE_SUMMARY";
+}
+
 // Owned filenames have the form:
 //    dbname/IDENTITY
 //    dbname/CURRENT
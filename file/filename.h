@@ -144,6 +144,15 @@ std::string MetaDatabaseName(const std::string& dbname, uint64_t number);
 // either from a backup-image or empty
 std::string IdentityFileName(const std::string& dbname);
 
+// Return the name of the file holding the memtables of the db at its last
+// clean shutdown, see DBOptions::snapshot_memtables_on_shutdown
+std::string MemTableSnapshotFileName(const std::string& dbname);
+
+// Return the name of the file holding the properties of the table files of
+// the db at its last clean shutdown, see
+// DBOptions::summarize_tables_on_shutdown
+std::string TableSummaryFileName(const std::string& dbname);
+
 // If filename is a rocksdb file, store the type of the file in *type.
 // The number encoded in the filename is stored in *number.  If the
 // filename was successfully parsed, returns true.  Else return false.
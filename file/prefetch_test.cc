@@ -3080,6 +3080,83 @@ TEST_F(FilePrefetchBufferTest, NoSyncWithAsyncIO) {
   ASSERT_EQ(result, async_result);
 }
 
+TEST_F(FilePrefetchBufferTest, ScanPrefetchScheduler) {
+  std::string fname = "scan-prefetch-scheduler";
+  Random rand(0);
+  std::string content = rand.RandomString(32768);
+  Write(fname, content);
+
+  FileOptions opts;
+  std::unique_ptr<RandomAccessFileReader> r;
+  Read(fname, opts, &r);
+
+  int read_async_called = 0;
+  int denied = 0;
+  SyncPoint::GetInstance()->SetCallBack(
+      "FilePrefetchBuffer::ReadAsync",
+      [&](void* /*arg*/) { read_async_called++; });
+  SyncPoint::GetInstance()->SetCallBack(
+      "FilePrefetchBuffer::TryAcquirePrefetchSlot:Denied",
+      [&](void* /*arg*/) { denied++; });
+  SyncPoint::GetInstance()->EnableProcessing();
+
+  // Two files of a scan share the budget of a single readahead
+  ScanPrefetchScheduler scheduler(/*max_async_reads=*/1);
+  ReadaheadParams readahead_params;
+  readahead_params.initial_readahead_size = 8192;
+  readahead_params.max_readahead_size = 16384;
+  readahead_params.num_buffers = 2;
+  readahead_params.prefetch_scheduler = &scheduler;
+  {
+    FilePrefetchBuffer fpb1(readahead_params, /*enable=*/true,
+                            /*track_min_offset=*/false, fs());
+    FilePrefetchBuffer fpb2(readahead_params, /*enable=*/true,
+                            /*track_min_offset=*/false, fs());
+
+    // The seek of the first file reads the block and reads ahead into its
+    // second buffer
+    Slice result1;
+    Status s = fpb1.PrefetchAsync(IOOptions(), r.get(), 3000, 4000, &result1);
+    // Platforms that don't have IO uring may not support async IO
+    if (s.IsNotSupported()) {
+      SyncPoint::GetInstance()->DisableProcessing();
+      SyncPoint::GetInstance()->ClearAllCallBacks();
+      return;
+    }
+    ASSERT_TRUE(s.IsTryAgain());
+    ASSERT_EQ(read_async_called, 2);
+    ASSERT_EQ(scheduler.GetNumInFlight(), 1);
+
+    // The second file only reads the block it needs
+    Slice result2;
+    s = fpb2.PrefetchAsync(IOOptions(), r.get(), 3000, 4000, &result2);
+    ASSERT_TRUE(s.IsTryAgain());
+    ASSERT_EQ(read_async_called, 3);
+    ASSERT_EQ(denied, 1);
+    ASSERT_EQ(scheduler.GetNumDenied(), 1);
+    ASSERT_EQ(scheduler.GetNumInFlight(), 1);
+
+    IOOptions io_opts;
+    ASSERT_TRUE(fpb2.TryReadFromCache(io_opts, r.get(), /*offset=*/3000,
+                                      /*length=*/4000, &result2, &s));
+    ASSERT_OK(s);
+    ASSERT_EQ(Slice(&content[3000], 4000), result2);
+
+    // A reseek gives the slot back
+    fpb1.AbortAsyncReads();
+    ASSERT_EQ(scheduler.GetNumInFlight(), 0);
+
+    s = fpb2.PrefetchAsync(IOOptions(), r.get(), 16384, 4000, &result2);
+    ASSERT_TRUE(s.IsTryAgain());
+    ASSERT_EQ(scheduler.GetNumInFlight(), 1);
+  }
+  // So does the destruction of the buffers
+  ASSERT_EQ(scheduler.GetNumInFlight(), 0);
+
+  SyncPoint::GetInstance()->DisableProcessing();
+  SyncPoint::GetInstance()->ClearAllCallBacks();
+}
+
 TEST_F(FilePrefetchBufferTest, SyncReadaheadStats) {
   std::string fname = "seek-with-block-cache-hit";
   Random rand(0);
@@ -148,6 +148,7 @@ IOStatus RandomAccessFileReader::Read(const IOOptions& opts, uint64_t offset,
           Roundup(static_cast<size_t>(offset + n), alignment) - aligned_offset;
       AlignedBuffer buf;
       buf.Alignment(alignment);
+      buf.UsePool();
       buf.AllocateNewBuffer(read_size);
       while (buf.CurrentSize() < read_size) {
         size_t allowed;
@@ -155,7 +156,8 @@ IOStatus RandomAccessFileReader::Read(const IOOptions& opts, uint64_t offset,
             rate_limiter_ != nullptr) {
           allowed = rate_limiter_->RequestToken(
               buf.Capacity() - buf.CurrentSize(), buf.Alignment(),
-              rate_limiter_priority, stats_, RateLimiter::OpType::kRead);
+              rate_limiter_priority, stats_, RateLimiter::OpType::kRead,
+              opts.io_activity);
         } else {
           assert(buf.CurrentSize() == 0);
           allowed = read_size;
@@ -217,7 +219,7 @@ IOStatus RandomAccessFileReader::Read(const IOOptions& opts, uint64_t offset,
           }
           allowed = rate_limiter_->RequestToken(
               n - pos, (use_direct_io() ? alignment : 0), rate_limiter_priority,
-              stats_, RateLimiter::OpType::kRead);
+              stats_, RateLimiter::OpType::kRead, opts.io_activity);
           if (rate_limiter_->IsRateLimited(RateLimiter::OpType::kRead)) {
             sw.DelayStop();
           }
@@ -418,7 +420,7 @@ IOStatus RandomAccessFileReader::MultiRead(const IOOptions& opts,
               remaining_bytes);
           rate_limiter_->Request(request_bytes, rate_limiter_priority,
                                  nullptr /* stats */,
-                                 RateLimiter::OpType::kRead);
+                                 RateLimiter::OpType::kRead, opts.io_activity);
           remaining_bytes -= request_bytes;
         }
       }
@@ -515,6 +517,7 @@ IOStatus RandomAccessFileReader::ReadAsync(
 
     // Allocate aligned buffer.
     read_async_info->buf_.Alignment(alignment);
+    read_async_info->buf_.UsePool();
     read_async_info->buf_.AllocateNewBuffer(aligned_req.len);
 
     // Set rem fields in aligned FSReadRequest.
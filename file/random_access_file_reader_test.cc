@@ -14,6 +14,7 @@
 #include "test_util/sync_point.h"
 #include "test_util/testharness.h"
 #include "test_util/testutil.h"
+#include "util/aligned_buffer.h"
 #include "util/random.h"
 
 namespace ROCKSDB_NAMESPACE {
@@ -295,6 +296,58 @@ TEST_F(RandomAccessFileReaderTest, MultiReadDirectIO) {
   ROCKSDB_NAMESPACE::SyncPoint::GetInstance()->ClearAllCallBacks();
 }
 
+TEST(AlignedBufferPool, SizeClasses) {
+  AlignedBufferPool* pool = AlignedBufferPool::Instance();
+  size_t allocated_size = 0;
+  char* buf = pool->Allocate(1, &allocated_size);
+  ASSERT_EQ(AlignedBufferPool::kMinSizeClass, allocated_size);
+  pool->Free(buf, allocated_size);
+
+  buf = pool->Allocate(AlignedBufferPool::kMinSizeClass + 1, &allocated_size);
+  ASSERT_EQ(2 * AlignedBufferPool::kMinSizeClass, allocated_size);
+  const int core = port::PhysicalCoreID();
+  pool->Free(buf, allocated_size);
+  char* again =
+      pool->Allocate(AlignedBufferPool::kMinSizeClass + 1, &allocated_size);
+  if (core >= 0 && core == port::PhysicalCoreID()) {
+    // The buffer cached for the core is handed out again
+    ASSERT_EQ(buf, again);
+  }
+  pool->Free(again, allocated_size);
+
+  // Larger buffers aren't cached
+  const size_t large = AlignedBufferPool::kMaxSizeClass + 1;
+  buf = pool->Allocate(large, &allocated_size);
+  ASSERT_EQ(large, allocated_size);
+  pool->Free(buf, allocated_size);
+}
+
+TEST(AlignedBufferPool, PooledAlignedBuffer) {
+  const size_t alignment = 4096;
+  AlignedBuffer buf;
+  buf.Alignment(alignment);
+  buf.UsePool();
+  buf.AllocateNewBuffer(100);
+  ASSERT_TRUE(AlignedBuffer::isAligned(buf.BufferStart(), alignment));
+  ASSERT_EQ(alignment, buf.Capacity());
+  ASSERT_EQ(3, buf.Append("abc", 3));
+
+  // Growing the buffer gives the previous one back to the pool
+  buf.AllocateNewBuffer(3 * alignment, /*copy_data=*/true);
+  ASSERT_TRUE(AlignedBuffer::isAligned(buf.BufferStart(), alignment));
+  ASSERT_EQ(3 * alignment, buf.Capacity());
+  ASSERT_EQ("abc", std::string(buf.BufferStart(), buf.CurrentSize()));
+
+  AlignedBuffer moved(std::move(buf));
+  ASSERT_EQ("abc", std::string(moved.BufferStart(), moved.CurrentSize()));
+
+  // A released buffer is freed as any other
+  const char* start = moved.BufferStart();
+  AlignedBuf released(moved.Release());
+  ASSERT_LE(released.get(), start);
+  ASSERT_EQ(nullptr, moved.BufferStart());
+}
+
 TEST(FSReadRequest, Align) {
   FSReadRequest r;
   r.offset = 2000;
@@ -0,0 +1,59 @@
+//  Copyright (c) Meta Platforms, Inc. and affiliates.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+
+#pragma once
+
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+
+#include "rocksdb/rocksdb_namespace.h"
+
+namespace ROCKSDB_NAMESPACE {
+
+// ScanPrefetchScheduler bounds the asynchronous readahead of all the table
+// files of a scan, see ReadOptions::max_async_readahead_reads. The
+// FilePrefetchBuffer of each file takes a slot for every readahead it
+// submits ahead of the block being read, and gives it back once the read
+// is polled or aborted. A readahead without a free slot is not submitted,
+// and its data is read when the iterator gets there. The reads an iterator
+// waits for are never limited, so a child of a MergingIterator that the
+// heap is about to consume is never starved by the others.
+//
+// Not thread-safe: the iterators of a scan are used by a single thread.
+class ScanPrefetchScheduler {
+ public:
+  explicit ScanPrefetchScheduler(size_t max_async_reads)
+      : max_async_reads_(max_async_reads) {
+    assert(max_async_reads_ > 0);
+  }
+
+  // Returns true if a slot was taken for a readahead
+  bool TryAcquire() {
+    if (num_in_flight_ >= max_async_reads_) {
+      num_denied_++;
+      return false;
+    }
+    num_in_flight_++;
+    return true;
+  }
+
+  void Release() {
+    assert(num_in_flight_ > 0);
+    num_in_flight_--;
+  }
+
+  size_t GetNumInFlight() const { return num_in_flight_; }
+
+  // The readaheads not submitted for lack of a slot
+  uint64_t GetNumDenied() const { return num_denied_; }
+
+ private:
+  const size_t max_async_reads_;
+  size_t num_in_flight_ = 0;
+  uint64_t num_denied_ = 0;
+};
+
+}  // namespace ROCKSDB_NAMESPACE
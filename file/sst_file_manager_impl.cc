@@ -30,6 +30,7 @@ SstFileManagerImpl::SstFileManagerImpl(
       compaction_buffer_size_(0),
       cur_compactions_reserved_size_(0),
       max_allowed_space_(0),
+      max_trash_backlog_(0),
       delete_scheduler_(clock_.get(), fs_.get(), rate_bytes_per_sec,
                         logger.get(), this, max_trash_db_ratio,
                         bytes_max_delete_chunk),
@@ -167,6 +168,20 @@ bool SstFileManagerImpl::EnoughRoomForCompaction(
     return false;
   }
 
+  // The input files go to the trash once the compaction is done, so wait for
+  // the trash to be deleted before adding to it
+  if (max_trash_backlog_ != 0) {
+    uint64_t trash_size = delete_scheduler_.GetTotalTrashSize();
+    if (trash_size > max_trash_backlog_) {
+      ROCKS_LOG_WARN(logger_,
+                     "trash size [%" PRIu64
+                     " bytes] is more than max trash backlog [%" PRIu64
+                     " bytes]\n",
+                     trash_size, max_trash_backlog_);
+      return false;
+    }
+  }
+
   // Implement more aggressive checks only if this DB instance has already
   // seen a NoSpace() error. This is tin order to contain a single potentially
   // misbehaving DB instance and prevent it from slowing down compactions of
@@ -240,6 +255,33 @@ uint64_t SstFileManagerImpl::GetTotalTrashSize() {
   return delete_scheduler_.GetTotalTrashSize();
 }
 
+int SstFileManagerImpl::GetMaxTrashDeleteThreads() {
+  return static_cast<int>(delete_scheduler_.GetMaxDeleteThreads());
+}
+
+void SstFileManagerImpl::SetMaxTrashDeleteThreads(int num_threads) {
+  assert(num_threads > 0);
+  delete_scheduler_.SetMaxDeleteThreads(static_cast<size_t>(num_threads));
+}
+
+bool SstFileManagerImpl::IsDeleteRateLimitPerDirectory() {
+  return delete_scheduler_.IsRateLimitPerDirectory();
+}
+
+void SstFileManagerImpl::SetDeleteRateLimitPerDirectory(bool per_directory) {
+  delete_scheduler_.SetRateLimitPerDirectory(per_directory);
+}
+
+uint64_t SstFileManagerImpl::GetMaxTrashBacklog() {
+  MutexLock l(&mu_);
+  return max_trash_backlog_;
+}
+
+void SstFileManagerImpl::SetMaxTrashBacklog(uint64_t max_trash_backlog) {
+  MutexLock l(&mu_);
+  max_trash_backlog_ = max_trash_backlog;
+}
+
 void SstFileManagerImpl::ReserveDiskBuffer(uint64_t size,
                                            const std::string& path) {
   MutexLock l(&mu_);
@@ -102,6 +102,18 @@ class SstFileManagerImpl : public SstFileManager {
   // Return the total size of trash files
   uint64_t GetTotalTrashSize() override;
 
+  int GetMaxTrashDeleteThreads() override;
+
+  void SetMaxTrashDeleteThreads(int num_threads) override;
+
+  bool IsDeleteRateLimitPerDirectory() override;
+
+  void SetDeleteRateLimitPerDirectory(bool per_directory) override;
+
+  uint64_t GetMaxTrashBacklog() override;
+
+  void SetMaxTrashBacklog(uint64_t max_trash_backlog) override;
+
   // Called by each DB instance using this sst file manager to reserve
   // disk buffer space for recovery from out of space errors
   void ReserveDiskBuffer(uint64_t buffer, const std::string& path);
@@ -164,6 +176,8 @@ class SstFileManagerImpl : public SstFileManager {
   std::unordered_map<std::string, uint64_t> tracked_files_;
   // The maximum allowed space (in bytes) for sst and blob files.
   uint64_t max_allowed_space_;
+  // The trash size (in bytes) where compactions are cancelled.
+  uint64_t max_trash_backlog_;
   // DeleteScheduler used to throttle file deletion.
   DeleteScheduler delete_scheduler_;
   port::CondVar cv_;
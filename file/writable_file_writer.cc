@@ -582,9 +582,9 @@ IOStatus WritableFileWriter::WriteBuffered(const IOOptions& opts,
     size_t allowed = left;
     if (rate_limiter_ != nullptr &&
         rate_limiter_priority_used != Env::IO_TOTAL) {
-      allowed = rate_limiter_->RequestToken(left, 0 /* alignment */,
-                                            rate_limiter_priority_used, stats_,
-                                            RateLimiter::OpType::kWrite);
+      allowed = rate_limiter_->RequestToken(
+          left, 0 /* alignment */, rate_limiter_priority_used, stats_,
+          RateLimiter::OpType::kWrite, opts.io_activity);
     }
 
     {
@@ -677,9 +677,9 @@ IOStatus WritableFileWriter::WriteBufferedWithChecksum(const IOOptions& opts,
   if (rate_limiter_ != nullptr && rate_limiter_priority_used != Env::IO_TOTAL) {
     while (data_size > 0) {
       size_t tmp_size;
-      tmp_size = rate_limiter_->RequestToken(data_size, buf_.Alignment(),
-                                             rate_limiter_priority_used, stats_,
-                                             RateLimiter::OpType::kWrite);
+      tmp_size = rate_limiter_->RequestToken(
+          data_size, buf_.Alignment(), rate_limiter_priority_used, stats_,
+          RateLimiter::OpType::kWrite, opts.io_activity);
       data_size -= tmp_size;
     }
   }
@@ -807,9 +807,9 @@ IOStatus WritableFileWriter::WriteDirect(const IOOptions& opts) {
     size_t size = left;
     if (rate_limiter_ != nullptr &&
         rate_limiter_priority_used != Env::IO_TOTAL) {
-      size = rate_limiter_->RequestToken(left, buf_.Alignment(),
-                                         rate_limiter_priority_used, stats_,
-                                         RateLimiter::OpType::kWrite);
+      size = rate_limiter_->RequestToken(
+          left, buf_.Alignment(), rate_limiter_priority_used, stats_,
+          RateLimiter::OpType::kWrite, opts.io_activity);
     }
 
     {
@@ -914,9 +914,9 @@ IOStatus WritableFileWriter::WriteDirectWithChecksum(const IOOptions& opts) {
   if (rate_limiter_ != nullptr && rate_limiter_priority_used != Env::IO_TOTAL) {
     while (data_size > 0) {
       size_t size;
-      size = rate_limiter_->RequestToken(data_size, buf_.Alignment(),
-                                         rate_limiter_priority_used, stats_,
-                                         RateLimiter::OpType::kWrite);
+      size = rate_limiter_->RequestToken(
+          data_size, buf_.Alignment(), rate_limiter_priority_used, stats_,
+          RateLimiter::OpType::kWrite, opts.io_activity);
       data_size -= size;
     }
   }
@@ -59,6 +59,11 @@ enum CompactionPri : char {
   // level. The file picking process will cycle through all the files in a
   // round-robin manner.
   kRoundRobin = 0x4,
+  // Like kMinOverlappingRatio, but divides the overlapping ratio of each
+  // file by the number of reads sampled from it (see FileSampledStats), so
+  // that the files queries hit most are compacted first. Files without
+  // sampled reads are compacted after all the others.
+  kMinOverlappingRatioByReads = 0x5,
 };
 
 // Temperature of a file. Used to pass to FileSystem for a different
@@ -240,6 +245,12 @@ struct AdvancedColumnFamilyOptions {
   //   * new sizeof(new_value) <= sizeof(existing_value)
   //   * existing_value for that key is a put i.e. kTypeValue
   // If inplace_callback function is set, check doc for inplace_callback.
+  //
+  // With allow_concurrent_memtable_write, writes to different keys are
+  // applied to the memtable concurrently, and a Put updates the existing
+  // value in place only if the new value has the same size. Reads copy
+  // such values under a per-entry version instead of taking the update lock.
+  // inplace_callback and unordered_write are not supported in this mode.
   // Default: false.
   bool inplace_update_support = false;
 
@@ -954,6 +965,17 @@ struct AdvancedColumnFamilyOptions {
   // Dynamically changeable through the SetOptions() API
   uint64_t blob_compaction_readahead_size = 0;
 
+  // If non-zero, compactions with blob garbage collection read ahead up to
+  // this many input entries, and fetch the blobs they will relocate with one
+  // multi-read of the blob files, up to 64 blobs at a time, instead of one
+  // read per blob. Useful when each read has a high latency, e.g. on object
+  // stores. Blobs are only read ahead for the newest version of each key.
+  //
+  // Default: 0
+  //
+  // Dynamically changeable through the SetOptions() API
+  uint32_t blob_compaction_read_batch_size = 0;
+
   // Enable blob files starting from a certain LSM tree level.
   //
   // For certain use cases that have a mix of short-lived and long-lived values,
@@ -990,6 +1012,16 @@ struct AdvancedColumnFamilyOptions {
   // Dynamically changeable through the SetOptions() API
   PrepopulateBlobCache prepopulate_blob_cache = PrepopulateBlobCache::kDisable;
 
+  // The number of blob files whose blobs a MultiGet() reads concurrently,
+  // each on a thread of a pool shared by the column families of the
+  // process, so that the latency of a MultiGet() of blobs spread over many
+  // files is that of the slowest file rather than the sum. The blobs of each
+  // file are read with one MultiRead(). 1 reads the files one after the
+  // other on the calling thread.
+  //
+  // Default: 1
+  int blob_multiget_threads = 1;
+
   // Enable memtable per key-value checksum protection.
   //
   // Each entry in memtable will be suffixed by a per key-value checksum.
@@ -0,0 +1,79 @@
+//  Copyright (c) Meta Platforms, Inc. and affiliates.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "rocksdb/rocksdb_namespace.h"
+
+namespace ROCKSDB_NAMESPACE {
+
+class ColumnFamilyHandle;
+class DB;
+
+// Adjusts the mutable options of a DB while it runs, from the DB properties
+// and statistics it reads on each round. Set it as DBOptions::auto_tuner for
+// the DB to call Tune() every PeriodSec() seconds on a background thread.
+//
+// An AutoTuner keeps state across the rounds of tuning of a DB, so it should
+// not be shared between DBs.
+class AutoTuner {
+ public:
+  virtual ~AutoTuner() {}
+
+  // Called every PeriodSec() seconds with the live column families of `db`,
+  // never concurrently for the same DB. The handles are only valid for the
+  // duration of the call.
+  virtual void Tune(DB* db, const std::vector<ColumnFamilyHandle*>& cfs) = 0;
+
+  // The period of the rounds of tuning, read once when the DB is opened. 0
+  // disables the tuning.
+  virtual uint64_t PeriodSec() const = 0;
+};
+
+// The bounds within which the AutoTuner of NewAutoTuner() keeps the options
+// it tunes. The tuning of an option is disabled while its max bound is 0.
+// An option the DB was opened with outside of its bounds is brought within
+// them on the first round.
+struct AutoTunerOptions {
+  uint64_t period_sec = 60;
+
+  // DBOptions::max_background_jobs, one more job on each round with write
+  // stalls or a compaction backlog which is not shrinking, one less on each
+  // idle round
+  int min_background_jobs = 0;
+  int max_background_jobs = 0;
+
+  // The bytes per second of DBOptions::rate_limiter, if set, 25% more on
+  // each round with write stalls or a compaction backlog which is not
+  // shrinking, 10% less on each idle round
+  int64_t min_rate_limiter_bytes_per_sec = 0;
+  int64_t max_rate_limiter_bytes_per_sec = 0;
+
+  // ColumnFamilyOptions::level0_slowdown_writes_trigger of each column
+  // family, 25% more (at least 1) on each round its writes were stalled by
+  // its L0 file count, 1 less on each idle round.
+  // level0_stop_writes_trigger is moved accordingly, keeping its distance to
+  // level0_slowdown_writes_trigger.
+  int min_level0_slowdown_writes_trigger = 0;
+  int max_level0_slowdown_writes_trigger = 0;
+
+  // DBOptions::compaction_readahead_size, doubled on each round with a
+  // compaction backlog which is not shrinking, halved on each idle round
+  size_t min_compaction_readahead_size = 0;
+  size_t max_compaction_readahead_size = 0;
+};
+
+// Returns a rule based AutoTuner, which reads on each round whether writes
+// were stalled or delayed since the last round, the estimated pending
+// compaction bytes and the number of running compactions. A round is idle
+// without any of those.
+std::shared_ptr<AutoTuner> NewAutoTuner(const AutoTunerOptions& options);
+
+}  // namespace ROCKSDB_NAMESPACE
@@ -124,6 +124,7 @@ typedef struct rocksdb_sstfilewriter_t rocksdb_sstfilewriter_t;
 typedef struct rocksdb_ratelimiter_t rocksdb_ratelimiter_t;
 typedef struct rocksdb_perfcontext_t rocksdb_perfcontext_t;
 typedef struct rocksdb_pinnableslice_t rocksdb_pinnableslice_t;
+typedef struct rocksdb_pinnableslices_t rocksdb_pinnableslices_t;
 typedef struct rocksdb_transactiondb_options_t rocksdb_transactiondb_options_t;
 typedef struct rocksdb_transactiondb_t rocksdb_transactiondb_t;
 typedef struct rocksdb_transaction_options_t rocksdb_transaction_options_t;
@@ -2924,6 +2925,53 @@ extern ROCKSDB_LIBRARY_API void rocksdb_pinnableslice_destroy(
 extern ROCKSDB_LIBRARY_API const char* rocksdb_pinnableslice_value(
     const rocksdb_pinnableslice_t* t, size_t* vlen);
 
+// Creates an empty rocksdb_pinnableslice_t to be filled by
+// rocksdb_get_pinned_into(), so that a caller doing many reads does not
+// allocate one per read.
+extern ROCKSDB_LIBRARY_API rocksdb_pinnableslice_t*
+rocksdb_pinnableslice_create(void);
+// Releases the block cache handle or buffer the value pins, if any.
+extern ROCKSDB_LIBRARY_API void rocksdb_pinnableslice_reset(
+    rocksdb_pinnableslice_t* v);
+
+// Like rocksdb_get_pinned() but reads into `value`, releasing whatever it
+// pinned before. Returns 1 if the key was found, and 0 if the key was not
+// found or *errptr was set. The value stays valid until `value` is reset,
+// read into again or destroyed.
+extern ROCKSDB_LIBRARY_API unsigned char rocksdb_get_pinned_into(
+    rocksdb_t* db, const rocksdb_readoptions_t* options, const char* key,
+    size_t keylen, rocksdb_pinnableslice_t* value, char** errptr);
+extern ROCKSDB_LIBRARY_API unsigned char rocksdb_get_pinned_into_cf(
+    rocksdb_t* db, const rocksdb_readoptions_t* options,
+    rocksdb_column_family_handle_t* column_family, const char* key,
+    size_t keylen, rocksdb_pinnableslice_t* value, char** errptr);
+
+// Batched MultiGet that returns the values pinned in one
+// rocksdb_pinnableslices_t, without copying them. The result owns the block
+// cache handles of the values, which are released by
+// rocksdb_pinnableslices_reset() of a single value or by
+// rocksdb_pinnableslices_destroy(). errs follows the convention of
+// rocksdb_multi_get(). See rocksdb_batched_multi_get_cf() for sorted_input.
+extern ROCKSDB_LIBRARY_API rocksdb_pinnableslices_t* rocksdb_multi_get_pinned(
+    rocksdb_t* db, const rocksdb_readoptions_t* options, size_t num_keys,
+    const char* const* keys_list, const size_t* keys_list_sizes, char** errs,
+    unsigned char sorted_input);
+extern ROCKSDB_LIBRARY_API rocksdb_pinnableslices_t*
+rocksdb_multi_get_pinned_cf(
+    rocksdb_t* db, const rocksdb_readoptions_t* options,
+    const rocksdb_column_family_handle_t* const* column_families,
+    size_t num_keys, const char* const* keys_list,
+    const size_t* keys_list_sizes, char** errs, unsigned char sorted_input);
+extern ROCKSDB_LIBRARY_API size_t
+rocksdb_pinnableslices_count(const rocksdb_pinnableslices_t* v);
+// Returns NULL if the key at `index` was not found, failed or was reset
+extern ROCKSDB_LIBRARY_API const char* rocksdb_pinnableslices_value(
+    const rocksdb_pinnableslices_t* v, size_t index, size_t* vlen);
+extern ROCKSDB_LIBRARY_API void rocksdb_pinnableslices_reset(
+    rocksdb_pinnableslices_t* v, size_t index);
+extern ROCKSDB_LIBRARY_API void rocksdb_pinnableslices_destroy(
+    rocksdb_pinnableslices_t* v);
+
 extern ROCKSDB_LIBRARY_API rocksdb_memory_consumers_t*
 rocksdb_memory_consumers_create(void);
 extern ROCKSDB_LIBRARY_API void rocksdb_memory_consumers_add_db(
@@ -11,10 +11,13 @@
 
 #pragma once
 
+#include <array>
 #include <cstdint>
 #include <limits>
+#include <map>
 #include <memory>
 #include <string>
+#include <vector>
 
 #include "rocksdb/compression_type.h"
 #include "rocksdb/data_structure.h"
@@ -24,6 +27,7 @@ namespace ROCKSDB_NAMESPACE {
 
 class Cache;  // defined in advanced_cache.h
 struct ConfigOptions;
+class FileSystem;
 class SecondaryCache;
 
 // These definitions begin source compatibility for a future change in which
@@ -82,6 +86,9 @@ enum class CacheEntryRole {
   // Blob cache's charge to account for its memory usage (when using a
   // separate block cache and blob cache)
   kBlobCache,
+  // Iterators' charge to account for the memory of their arenas, see
+  // DBOptions::iterator_memory_cache
+  kIterator,
   // Default bucket, for miscellaneous cache entries. Do not use for
   // entries that could potentially add up to large usage.
   kMisc,
@@ -243,6 +250,16 @@ struct LRUCacheOptions : public ShardedCacheOptions {
   // -DROCKSDB_DEFAULT_TO_ADAPTIVE_MUTEX, false otherwise.
   bool use_adaptive_mutex = kDefaultToAdaptiveMutex;
 
+  // If true, each shard keeps a sketch of how often keys were looked up
+  // recently, and a new entry that needs another one evicted is only admitted
+  // if its key was looked up more often than that of the next entry to evict
+  // (the TinyLFU admission policy). A rejected entry is treated as if it was
+  // inserted and evicted right away, unless the caller asks for a handle to
+  // it. This keeps scans and other one-off reads from flushing frequently
+  // used blocks, at the cost of a few bytes of memory per 4KB of capacity
+  // and slower adoption of a new working set.
+  bool use_frequency_admission = false;
+
   LRUCacheOptions() {}
   LRUCacheOptions(size_t _capacity, int _num_shard_bits,
                   bool _strict_capacity_limit, double _high_pri_pool_ratio,
@@ -296,8 +313,27 @@ struct CompressedSecondaryCacheOptions : LRUCacheOptions {
   CompressionType compression_type = CompressionType::kLZ4Compression;
 
   // Options specific to the compression algorithm
+  //
+  // With compression_opts.max_dict_bytes > 0, values are compressed with a
+  // dictionary built from a sample of the values inserted into the cache, as
+  // for the dictionaries of SST files (see CompressionOptions). It is rebuilt
+  // whenever about the capacity has been inserted since the last one, and
+  // values compressed with one of the last few dictionaries can still be
+  // read. Dictionaries are only used by ZSTD, LZ4, LZ4HC and Zlib, and not
+  // with enable_custom_split_merge.
   CompressionOptions compression_opts;
 
+  // Compression levels that override compression_opts.level for some kinds
+  // of entries, for example a fast (negative) level of LZ4 or ZSTD for the
+  // entries that are read most often.
+  std::map<CacheEntryRole, int> compression_level_by_role;
+
+  // If > 0, values are compressed on a background thread of the cache rather
+  // than on the eviction path of the primary cache. Up to this many bytes of
+  // values can wait to be compressed, and further values are compressed in
+  // the foreground. Lookups do not find the waiting values.
+  size_t max_pending_compression_bytes = 0;
+
   // compress_format_version can have two values:
   // compress_format_version == 1 -- decompressed size is not included in the
   // block header.
@@ -371,6 +407,44 @@ inline std::shared_ptr<SecondaryCache> NewCompressedSecondaryCache(
   return opts.MakeSharedSecondaryCache();
 }
 
+// EXPERIMENTAL
+// Options structure for configuring a SecondaryCache instance on local flash
+// (such as NVMe), for example as the nvm_sec_cache of TieredCacheOptions.
+// Values are appended to a single file that is divided into segments, and
+// whole segments are reclaimed in FIFO order when the file wraps around.
+// Only a hash of each key and the location of its value are kept in memory,
+// and the file does not outlive the cache. Lookups with wait=false read
+// asynchronously when the FileSystem supports ReadAsync (e.g. io_uring with
+// the default FileSystem), and are completed by WaitAll.
+struct LogStructuredSecondaryCacheOptions {
+  // Directory of the cache file, which is created if missing. Any cache
+  // file already there is overwritten.
+  std::string path;
+
+  // The FileSystem of the path. If nullptr, FileSystem::Default() is used.
+  std::shared_ptr<FileSystem> fs;
+
+  // Size of the cache file in bytes.
+  size_t capacity = 0;
+
+  // Unit of space reclamation. The capacity is rounded down to a multiple
+  // of segment_size, with at least two segments. At most 16MB.
+  size_t segment_size = 4 << 20;
+
+  // Values are buffered in memory and written in batches of about this many
+  // bytes. Lookups of buffered values are served from memory.
+  size_t write_buffer_size = 256 << 10;
+
+  // Size-aware admission: values larger than this are not inserted, as they
+  // take more flash space and write bandwidth for each hit than small
+  // values. 0 means limited only by segment_size.
+  size_t max_value_size = 0;
+
+  // Construct an instance of the cache using these options
+  Status MakeSharedSecondaryCache(
+      std::shared_ptr<SecondaryCache>* result) const;
+};
+
 // HyperClockCache - A lock-free Cache alternative for RocksDB block cache
 // that offers much improved CPU efficiency vs. LRUCache under high parallel
 // load or high contention, with some caveats:
@@ -478,6 +552,37 @@ struct HyperClockCacheOptions : public ShardedCacheOptions {
   // keep operations very fast.
   int eviction_effort_cap = 30;
 
+  // EXPERIMENTAL If true, the shards are split into a group per NUMA node
+  // (up to the largest power of two not exceeding the number of nodes or of
+  // shards). The table memory of each group is allocated on its node, an
+  // entry is inserted into the group of the inserting thread's node, and a
+  // lookup probes that group before the others, so a miss costs a probe per
+  // group. The same key may then have an entry in several groups. Has no
+  // effect without NUMA support in the build (see WITH_NUMA), on single-node
+  // machines, or with estimated_entry_charge = 0.
+  bool numa_local_shards = false;
+
+  // EXPERIMENTAL With numa_local_shards, a sample of the lookups that find
+  // an entry on another node copy it to the local node, for at most this
+  // fraction of the charge inserted into the shards of the node. Only
+  // entries whose helper can save and recreate them (see
+  // CacheItemHelper::IsSecondaryCacheCompatible()) are copied, and only for
+  // lookups that provide that helper and a create_context. 0 disables the
+  // copies.
+  double numa_duplicate_ratio = 0.0;
+
+  // EXPERIMENTAL If not kNoCompression, the cache keeps compressed copies of
+  // cold entries within its own capacity, instead of a separate
+  // CompressedSecondaryCache. An entry whose helper can save and recreate it
+  // (see CacheItemHelper::IsSecondaryCacheCompatible()), such as a data
+  // block, and which the clock algorithm evicts after it was hit, is demoted
+  // to a copy compressed with this type and charged for its compressed size.
+  // A lookup that provides the helper and a create_context decompresses the
+  // copy and promotes the entry back, so hot entries stay uncompressed.
+  // Copies are not demoted again. MakeSharedCache() returns nullptr if the
+  // compression type is not supported, or with a secondary_cache.
+  CompressionType demotion_compression_type = kNoCompression;
+
   HyperClockCacheOptions(
       size_t _capacity, size_t _estimated_entry_charge,
       int _num_shard_bits = -1, bool _strict_capacity_limit = false,
@@ -491,6 +596,14 @@ struct HyperClockCacheOptions : public ShardedCacheOptions {
 
   // Construct an instance of HyperClockCache using these options
   std::shared_ptr<Cache> MakeSharedCache() const;
+
+  // Construct an instance of HyperClockCache for use as a row cache,
+  // typically for `DBOptions::row_cache`. Row cache keys are not of the fixed
+  // size that HyperClockCache requires, so entries are keyed by a hash of
+  // the row key and also keep the key. Since row sizes vary widely,
+  // estimated_entry_charge = 0 (AutoHyperClockCache) is recommended. Some
+  // options are not relevant to row caches.
+  std::shared_ptr<RowCache> MakeSharedRowCache() const;
 };
 
 // DEPRECATED - The old Clock Cache implementation had an unresolved bug and
@@ -571,4 +684,45 @@ Status UpdateTieredCache(
     const std::shared_ptr<Cache>& cache, int64_t total_capacity = -1,
     double compressed_secondary_ratio = std::numeric_limits<double>::max(),
     TieredAdmissionPolicy adm_policy = TieredAdmissionPolicy::kAdmPolicyMax);
+
+// EXPERIMENTAL
+// The following feature is experimental, and the API is subject to change
+//
+// Block caches for tenants, such as column families or DBs, that would
+// otherwise share one cache, so that a tenant reading much more data than
+// the others cannot evict their blocks. Each tenant gets its own cache of the
+// given type, and the total capacity is divided among them by their shares.
+// A tenant that misses in its full cache may borrow the capacity that the
+// other tenants leave unused, until they need it again. Capacities are
+// rebalanced after every rebalance_period insertions into any of the caches.
+struct TenantCacheOptions {
+  // This should point to an instance of either LRUCacheOptions or
+  // HyperClockCacheOptions, depending on the cache_type, as in
+  // TieredCacheOptions. The capacity and secondary_cache fields are ignored.
+  ShardedCacheOptions* cache_opts = nullptr;
+  PrimaryCacheType cache_type = PrimaryCacheType::kCacheTypeLRU;
+  // The memory budget of all tenant caches together.
+  size_t total_capacity = 0;
+  // The positive relative share of each tenant in the total capacity.
+  std::vector<double> shares;
+  uint32_t rebalance_period = 1024;
+};
+
+// Returns a cache for each share, in the same order, or an empty vector if
+// the options are invalid. Calling SetCapacity() on any of them sets the
+// total capacity.
+std::vector<std::shared_ptr<Cache>> NewTenantCaches(
+    const TenantCacheOptions& opts);
+
+struct TenantCacheStats {
+  size_t capacity = 0;
+  size_t usage = 0;
+  // Lookups by the role of the looked up entries.
+  std::array<uint64_t, kNumCacheEntryRoles> hits{};
+  std::array<uint64_t, kNumCacheEntryRoles> misses{};
+};
+
+// Gets the statistics of a cache returned by NewTenantCaches.
+Status GetTenantCacheStats(const std::shared_ptr<Cache>& cache,
+                           TenantCacheStats* stats);
 }  // namespace ROCKSDB_NAMESPACE
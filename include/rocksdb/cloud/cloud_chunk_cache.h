@@ -0,0 +1,121 @@
+//  Copyright (c) 2016-present, Rockset, Inc.  All rights reserved.
+
+#pragma once
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "rocksdb/file_system.h"
+#include "rocksdb/io_status.h"
+
+namespace ROCKSDB_NAMESPACE {
+
+struct CloudChunkCacheOptions {
+  // Directory holding the cache. It is created if it does not exist. The
+  // directory is locked, so a single process can use it at a time.
+  std::string path;
+
+  // Upper bound on the bytes of chunk data kept on disk.
+  uint64_t capacity = 0;
+
+  // Cloud files are cached in aligned chunks of this size.
+  // Default: 1MB
+  size_t chunk_size = 1024 * 1024;
+
+  // File system used to store the cache. If null, FileSystem::Default().
+  std::shared_ptr<FileSystem> fs;
+};
+
+// An on-disk cache of fixed-size chunks of cloud files, meant to sit between
+// the block cache and the cloud storage when SST files are not kept locally.
+//
+// The chunks live in a single data file divided into capacity / chunk_size
+// slots, which are recycled with CLOCK eviction. Every slot has a fixed-size
+// record in an index file that holds the chunk key, its length and the
+// checksum of the chunk data. A record is only written once its chunk data is
+// in place, and every lookup verifies the checksum, so a crash at any point
+// leaves at most some stale slots that read as misses.
+//
+// Caches opened on the same path share a single instance, so all the DBs of
+// a process can point at the same cache.
+class CloudChunkCache {
+ public:
+  static IOStatus Open(const CloudChunkCacheOptions& options,
+                       std::shared_ptr<CloudChunkCache>* cache);
+
+  ~CloudChunkCache();
+
+  // Copies the chunk chunk_index of the file identified by file_id into
+  // data. Returns false on a miss.
+  bool Lookup(const Slice& file_id, uint64_t chunk_index, std::string* data);
+
+  // Adds the chunk chunk_index of the file identified by file_id. data holds
+  // at most chunk_size() bytes; it is shorter only for the last chunk of a
+  // file. Errors are ignored, an insert is only a hint.
+  void Insert(const Slice& file_id, uint64_t chunk_index, const Slice& data);
+
+  size_t chunk_size() const { return options_.chunk_size; }
+  uint64_t GetCapacity() const { return num_slots_ * options_.chunk_size; }
+  // Bytes of chunk data currently cached.
+  uint64_t GetUsage() const;
+
+  uint64_t GetHits() const { return hits_.load(std::memory_order_relaxed); }
+  uint64_t GetMisses() const {
+    return misses_.load(std::memory_order_relaxed);
+  }
+
+ private:
+  struct ChunkKey {
+    uint64_t hi;
+    uint64_t lo;
+    bool operator==(const ChunkKey& other) const {
+      return hi == other.hi && lo == other.lo;
+    }
+  };
+  struct ChunkKeyHash {
+    size_t operator()(const ChunkKey& key) const {
+      return static_cast<size_t>(key.lo);
+    }
+  };
+  struct Slot {
+    ChunkKey key{0, 0};
+    uint32_t length = 0;
+    uint32_t checksum = 0;
+    // Has a chunk that may be served.
+    bool valid = false;
+    // CLOCK reference bit.
+    bool referenced = false;
+    // Number of readers and writers using the slot; pinned slots are never
+    // evicted.
+    uint32_t pins = 0;
+  };
+
+  CloudChunkCache(const CloudChunkCacheOptions& options, uint64_t num_slots);
+
+  static ChunkKey MakeKey(const Slice& file_id, uint64_t chunk_index);
+  IOStatus Init();
+  IOStatus WriteIndexRecord(uint64_t slot_idx, const Slot& slot);
+  // Returns the slot to fill with a new chunk, or num_slots_ if all of them
+  // are pinned. REQUIRES: mutex_ held.
+  uint64_t FindVictim();
+
+  const CloudChunkCacheOptions options_;
+  const uint64_t num_slots_;
+  std::unique_ptr<FSRandomRWFile> data_file_;
+  std::unique_ptr<FSRandomRWFile> index_file_;
+  FileLock* lock_ = nullptr;
+
+  mutable std::mutex mutex_;
+  std::vector<Slot> slots_;
+  std::unordered_map<ChunkKey, uint64_t, ChunkKeyHash> slot_of_key_;
+  uint64_t clock_hand_ = 0;
+  uint64_t usage_ = 0;
+
+  std::atomic<uint64_t> hits_{0};
+  std::atomic<uint64_t> misses_{0};
+};
+
+}  // namespace ROCKSDB_NAMESPACE
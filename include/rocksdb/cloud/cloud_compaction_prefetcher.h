@@ -0,0 +1,125 @@
+//  Copyright (c) 2016-present, Rockset, Inc.  All rights reserved.
+
+#pragma once
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "rocksdb/io_status.h"
+#include "rocksdb/rocksdb_namespace.h"
+
+namespace ROCKSDB_NAMESPACE {
+
+class CloudStorageReadableFileImpl;
+class ThreadPoolImpl;
+
+struct CloudCompactionPrefetcherOptions {
+  // Bytes of the input files of the running compactions that may be
+  // downloaded ahead of the compactions, shared by all the files.
+  //
+  // Default: 256MB
+  uint64_t buffer_bytes = 256 * 1024 * 1024;
+
+  // Size of the ranged reads that download the input files.
+  //
+  // Default: 4MB
+  uint64_t chunk_size = 4 * 1024 * 1024;
+
+  // Number of chunks of each input file downloaded ahead of the point the
+  // compaction reads it at, as far as buffer_bytes allows.
+  //
+  // Default: 4
+  int chunks_per_file = 4;
+
+  // Number of threads downloading the chunks.
+  //
+  // Default: 16
+  int threads = 16;
+};
+
+// Downloads the input files of the compactions of cloud-only DBs
+// (keep_local_sst_files is false) ahead of the compactions, with parallel
+// ranged reads of large chunks kept in a bounded memory buffer, so that the
+// compactions wait on the cloud as little as possible, see
+// CloudFileSystemOptions::compaction_prefetcher. The downloads of all the
+// inputs of a compaction start with its first read, so that compactions
+// that do not read their inputs, like trivial moves, download nothing. The
+// chunks of each file are downloaded in order from the start of the file,
+// and from any point a compaction starts reading at, like a subcompaction
+// does. A chunk is dropped once a compaction read past its end. A
+// prefetcher can be shared by all the DBs of a process.
+class CloudCompactionPrefetcher {
+ public:
+  explicit CloudCompactionPrefetcher(
+      const CloudCompactionPrefetcherOptions& options);
+  ~CloudCompactionPrefetcher();
+
+  const CloudCompactionPrefetcherOptions& GetOptions() const {
+    return options_;
+  }
+
+  // Adds the input files of a compaction that is about to run. A file may
+  // be added by several compactions, it is then prefetched once until all
+  // of them removed it.
+  void AddFiles(
+      std::vector<std::unique_ptr<CloudStorageReadableFileImpl>> files);
+  // Called for each file a compaction added once it completed.
+  void RemoveFile(const std::string& bucket, const std::string& object_path);
+
+  // Copies the downloaded bytes of the object starting at offset, up to n,
+  // into scratch, waiting for the chunks being downloaded. Returns the
+  // number of bytes copied, which the caller reads from the cloud if it is
+  // less than n.
+  uint64_t Read(const std::string& bucket, const std::string& object_path,
+                uint64_t offset, size_t n, char* scratch);
+
+  // Totals since the prefetcher was created.
+  uint64_t GetPrefetchedBytes() const {
+    return prefetched_bytes_.load(std::memory_order_relaxed);
+  }
+  uint64_t GetServedBytes() const {
+    return served_bytes_.load(std::memory_order_relaxed);
+  }
+
+ private:
+  struct Chunk;
+  struct File;
+  using FileGroup = std::vector<std::weak_ptr<File>>;
+
+  // Queues the download of the files of group that are not downloaded yet,
+  // from their start. REQUIRES: mutex_ held.
+  void StartGroup(const FileGroup& group);
+  // Queues the download of the chunks of file from index on, within the
+  // window of the file. REQUIRES: mutex_ held.
+  void WantChunks(const std::shared_ptr<File>& file, uint64_t index);
+  // Releases the buffer space of chunk and forgets it. REQUIRES: mutex_
+  // held.
+  void DropChunk(File* file, uint64_t index);
+  // Starts the queued downloads that fit in the buffer. REQUIRES: mutex_
+  // held.
+  void StartDownloads();
+
+  const CloudCompactionPrefetcherOptions options_;
+
+  std::mutex mutex_;
+  std::condition_variable cv_;
+  // Keyed by bucket and object path.
+  std::unordered_map<std::string, std::shared_ptr<File>> files_;
+  std::deque<std::pair<std::shared_ptr<File>, std::shared_ptr<Chunk>>>
+      queue_;
+  // Bytes of the chunks downloaded or being downloaded.
+  uint64_t buffered_bytes_ = 0;
+
+  std::atomic<uint64_t> prefetched_bytes_{0};
+  std::atomic<uint64_t> served_bytes_{0};
+
+  std::unique_ptr<ThreadPoolImpl> pool_;
+};
+
+}  // namespace ROCKSDB_NAMESPACE
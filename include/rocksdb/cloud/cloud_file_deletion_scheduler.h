@@ -5,6 +5,8 @@
 #include <functional>
 #include <memory>
 #include <mutex>
+#include <string>
+#include <unordered_map>
 #include <vector>
 #include "rocksdb/io_status.h"
 
@@ -17,23 +19,40 @@ class CloudFileDeletionScheduler
   struct PrivateTag {};
 
  public:
+  using FileDeletionRunnable = std::function<void()>;
+  // Deletes a batch of cloud objects in as few requests as the storage
+  // provider allows
+  using BatchDeletionRunnable =
+      std::function<void(const std::vector<std::string>& object_paths)>;
+
   static std::shared_ptr<CloudFileDeletionScheduler> Create(
       const std::shared_ptr<CloudScheduler>& scheduler,
-      std::chrono::seconds file_deletion_delay);
+      std::chrono::seconds file_deletion_delay,
+      BatchDeletionRunnable batch_runnable = nullptr);
 
   explicit CloudFileDeletionScheduler(
       PrivateTag, const std::shared_ptr<CloudScheduler>& scheduler,
-      std::chrono::seconds file_deletion_delay)
-      : scheduler_(scheduler), file_deletion_delay_(file_deletion_delay) {}
+      std::chrono::seconds file_deletion_delay,
+      BatchDeletionRunnable batch_runnable)
+      : scheduler_(scheduler),
+        file_deletion_delay_(file_deletion_delay),
+        batch_runnable_(std::move(batch_runnable)) {}
 
   ~CloudFileDeletionScheduler();
 
   void UnscheduleFileDeletion(const std::string& filename);
-  using FileDeletionRunnable = std::function<void()>;
   // Schedule the file deletion runnable(which actually delets the file from
   // cloud) to be executed in the future (specified by `file_deletion_delay_`).
   rocksdb::IOStatus ScheduleFileDeletion(const std::string& filename,
                                          FileDeletionRunnable runnable);
+  // Schedule the deletion of the cloud object `object_path` backing
+  // `filename`. When the deletion is due, it is coalesced with all the other
+  // object deletions whose delay has expired and they are handed to the batch
+  // runnable together. Requires a scheduler created with a batch runnable.
+  rocksdb::IOStatus ScheduleObjectDeletion(const std::string& filename,
+                                           std::string object_path);
+  // Whether the deletion of `filename` is scheduled and not started yet
+  bool IsFileDeletionScheduled(const std::string& filename) const;
 
 #ifndef NDEBUG
   size_t TEST_NumScheduledJobs() const;
@@ -42,22 +61,34 @@ class CloudFileDeletionScheduler
   std::vector<std::string> TEST_FilesToDelete() const {
     std::lock_guard<std::mutex> lk(files_to_delete_mutex_);
     std::vector<std::string> files;
-    for (auto& [file, handle] : files_to_delete_) {
+    for (auto& [file, deletion] : files_to_delete_) {
       files.push_back(file);
-      (void)handle;
+      (void)deletion;
     }
     return files;
   }
 #endif
 
  private:
-  // execute the `FileDeletionRunnable`
-  void DoDeleteFile(const std::string& fname, FileDeletionRunnable cb);
+  struct FileDeletion {
+    long handle;
+    std::chrono::steady_clock::time_point deadline;
+    // Exactly one of the two is set
+    FileDeletionRunnable runnable;
+    std::string object_path;
+  };
+
+  rocksdb::IOStatus DoScheduleFileDeletion(const std::string& fname,
+                                           FileDeletion deletion);
+  // execute the `FileDeletionRunnable`, or the batch runnable for all the
+  // object deletions that are due
+  void DoDeleteFile(const std::string& fname);
   std::shared_ptr<CloudScheduler> scheduler_;
 
   mutable std::mutex files_to_delete_mutex_;
-  std::unordered_map<std::string, int> files_to_delete_;
+  std::unordered_map<std::string, FileDeletion> files_to_delete_;
   std::chrono::seconds file_deletion_delay_;
+  BatchDeletionRunnable batch_runnable_;
 };
 
 }  // namespace ROCKSDB_NAMESPACE
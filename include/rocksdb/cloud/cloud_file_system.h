@@ -6,11 +6,14 @@
 #include <memory>
 #include <optional>
 #include <unordered_map>
+#include <vector>
 
 #include "rocksdb/cache.h"
+#include "rocksdb/compression_type.h"
 #include "rocksdb/configurable.h"
 #include "rocksdb/file_system.h"
 #include "rocksdb/io_status.h"
+#include "rocksdb/metadata.h"
 #include "rocksdb/status.h"
 
 namespace Aws {
@@ -27,10 +30,16 @@ class S3Client;
 
 namespace ROCKSDB_NAMESPACE {
 
+class CloudChunkCache;
+class CloudCompactionPrefetcher;
 class CloudFileSystem;
 class CloudLogController;
+class CloudRateLimiter;
+class CloudReadHedger;
 class CloudManifest;
 class CloudStorageProvider;
+class SecondaryCache;
+class Statistics;
 
 enum CloudType : unsigned char {
   kCloudNone = 0x0,       // Not really a cloud env
@@ -107,6 +116,24 @@ class KafkaLogOptions {
   //  ("metadata.broker.list", "kafka1.rockset.com,kafka2.rockset.com"
   //
   std::unordered_map<std::string, std::string> client_config_params;
+
+  // If true, log records are handed to the producer without being copied,
+  // and Sync() only waits for the delivery reports of the records that the
+  // file produced before it, instead of draining the whole producer queue.
+  // Concurrent Sync() calls share the polling for delivery reports.
+  // Default: false
+  bool async_produce = false;
+};
+
+// Defines how the Kinesis log controller reads its stream
+class KinesisLogOptions {
+ public:
+  // If not empty, the shards of the stream are read with enhanced fan-out:
+  // a stream consumer of this name is registered and the tailer subscribes
+  // to each shard, which pushes records as they arrive and gives the
+  // consumer its own read throughput. Otherwise the shards are polled with
+  // GetRecords, which Kinesis limits to five calls per second per shard.
+  std::string fan_out_consumer_name;
 };
 
 enum class CloudRequestOpType {
@@ -121,6 +148,20 @@ enum class CloudRequestOpType {
 using CloudRequestCallback =
     std::function<void(CloudRequestOpType, uint64_t, uint64_t, bool)>;
 
+// What an upload to the cloud storage was written by, in decreasing order of
+// urgency, see CloudFileSystemOptions::max_concurrent_uploads.
+enum class CloudUploadClass {
+  // Flush outputs, and the outputs of compactions running while the writes
+  // are stalled.
+  kFlush,
+  // Outputs of compactions into L0 or the base level.
+  kL0Compaction,
+  // Outputs of compactions into deeper levels.
+  kCompaction,
+  // Files copied by checkpoints and savepoints.
+  kCheckpoint,
+};
+
 class BucketOptions {
  private:
   std::string bucket_;  // The suffix for the bucket name
@@ -218,6 +259,9 @@ class CloudFileSystemOptions {
   // Only used if keep_local_log_files is true and log_type is kKafka.
   KafkaLogOptions kafka_log_options;
 
+  // Only used if keep_local_log_files is false and log_type is kKinesis.
+  KinesisLogOptions kinesis_log_options;
+
   // If true,  then sst files are stored locally and uploaded to the cloud in
   // the background. On restart, all files from the cloud that are not present
   // locally are downloaded.
@@ -234,6 +278,31 @@ class CloudFileSystemOptions {
   // Default:  true
   bool keep_local_log_files;
 
+  // If true, the log controller keeps the records it tails from its stream
+  // in memory instead of applying them to files in its cache directory, and
+  // the log files are read from those records. This saves writing the logs
+  // to the local disk, and the recovery reads the records of a log as they
+  // are tailed. The records of a log are released when its deletion is
+  // tailed. Only used if keep_local_log_files is false.
+  // Default: false
+  bool replay_log_from_stream = false;
+
+  // If not kNoCompression, the appends to the log files are compressed
+  // with this algorithm before they are written to the stream of the log
+  // controller, and the tailer decompresses them. Appends that do not
+  // compress are written as they are. Of little use with
+  // DBOptions::wal_compression, which compresses the records already.
+  // Only used if keep_local_log_files is false.
+  // Default: kNoCompression
+  CompressionType log_compression = kNoCompression;
+
+  // If non-zero and log_compression is kZSTD, each log file trains a
+  // dictionary of up to this many bytes on its first appends, up to a hundred
+  // times that, and compresses the appends after them with it. The
+  // dictionary is written to the stream ahead of those appends.
+  // Default: 0
+  uint32_t log_compression_max_dict_bytes = 0;
+
   // This feature is obsolete. We upload MANIFEST to the cloud on every write.
   // uint64_t manifest_durable_periodicity_millis;
 
@@ -243,6 +312,19 @@ class CloudFileSystemOptions {
   // Default: 10 minutes
   uint64_t purger_periodicity_millis;
 
+  // If non-zero, the purger lists the objects of the bucket and reads the
+  // MANIFEST of every DB in it only once per this period. The runs in
+  // between only check the SST objects that this DB deleted since the
+  // previous run, once their deletion is no longer pending: an object that
+  // still exists is obsolete unless it was live in a DB of the bucket at the
+  // last full listing. A DB registered in the bucket since then makes the
+  // next run a full listing. The requests of the purger then grow with the
+  // churn of the DB rather than with the size of the bucket, while the full
+  // listings still find the objects leaked by other processes.
+  //
+  // Default: 0, every run of the purger is a full listing
+  uint64_t purger_full_listing_periodicity_millis = 0;
+
   // Validate that locally cached files have the same size as those
   // stored in the cloud.
   // Default: true
@@ -387,6 +469,348 @@ class CloudFileSystemOptions {
   // Default: 1 hour
   std::optional<std::chrono::seconds> cloud_file_deletion_delay;
 
+  // When reading SST files directly from the cloud (keep_local_sst_files is
+  // false), MultiRead() merges requested ranges that are separated by at most
+  // this many bytes into a single ranged GET. Reading the gap is usually much
+  // cheaper than paying for another round trip.
+  //
+  // Default: 64KB
+  uint64_t multi_read_coalesce_gap_bytes = 64 * 1024;
+
+  // Maximum number of ranged GETs a single MultiRead() on a cloud file issues
+  // concurrently. A value of 1 issues the (coalesced) reads serially.
+  //
+  // Default: 16
+  size_t multi_read_max_parallelism = 16;
+
+  // Number of threads in the process-wide executor that serves ReadAsync() on
+  // cloud files, which lets iterator readahead and async MultiGet overlap
+  // cloud latency with other work. The executor is shared by all cloud file
+  // systems in the process and only grows. Zero makes ReadAsync() block.
+  //
+  // Default: 16
+  int async_read_threads = 16;
+
+  // Concurrent cloud reads of the same data share one request: a ranged read
+  // of a cloud file that an outstanding read of the file covers waits for
+  // that read and copies its data, and a download of an object to a local
+  // file that is already being downloaded to it waits for that download.
+  // This spares the identical GETs of threads that miss the block cache on
+  // the same block, or that open the same table, at the same time.
+  //
+  // Default: true
+  bool share_inflight_reads = true;
+
+  // If non-zero, SST files are uploaded with a multipart upload whose parts
+  // are sent in the background as Append() fills them, so that Close() only
+  // has to send the tail part and finish the upload. Files smaller than a
+  // part, and files whose multipart upload fails, are uploaded as a whole on
+  // Close(). S3 requires parts of at least 5MB.
+  //
+  // Default: 0, SST files are uploaded as a whole on Close()
+  uint64_t multipart_upload_part_size = 0;
+
+  // Number of threads in the process-wide executor that uploads the parts of
+  // streamed SST files, see multipart_upload_part_size. The executor is
+  // shared by all cloud file systems in the process and only grows.
+  //
+  // Default: 8
+  int multipart_upload_threads = 8;
+
+  // If non-zero, an SST object larger than this is downloaded with ranged
+  // GETs of this size issued concurrently, each written at its offset into
+  // a local file allocated up front, rather than with a single GET streamed
+  // into the file. The parts are checked against the crc32c of the object
+  // if it has one, see sst_upload_checksums. use_direct_io_for_cloud_download
+  // and use_aws_transfer_manager do not apply to these downloads.
+  //
+  // Default: 0, objects are downloaded with a single GET
+  uint64_t parallel_download_part_size = 0;
+
+  // Number of threads in the process-wide executor that downloads the parts
+  // of SST objects, see parallel_download_part_size. The executor is shared
+  // by all cloud file systems in the process and only grows.
+  //
+  // Default: 8
+  int parallel_download_threads = 8;
+
+  // If true, Close() on an SST file queues its upload on a background pool
+  // and returns, so that flushes and compactions do not wait for the cloud.
+  // A MANIFEST Sync() waits for the uploads queued before it, so that no
+  // MANIFEST referencing a file missing from the cloud is ever uploaded.
+  //
+  // Default: false
+  bool defer_sst_uploads = false;
+
+  // Number of threads of the pool running deferred SST uploads, see
+  // defer_sst_uploads. Each cloud file system has its own pool.
+  //
+  // Default: 4
+  int sst_upload_threads = 4;
+
+  // If positive, at most that many uploads of SST files to the cloud run at
+  // once, and the free slots go to the waiting uploads by their
+  // CloudUploadClass: flush outputs get the largest share, then the outputs
+  // of compactions into the base level, of deeper compactions, and the
+  // copies of checkpoints and savepoints. This keeps a large compaction
+  // upload from delaying the flushes into a write stall. Deferred uploads
+  // then run on a pool of that many threads instead of sst_upload_threads.
+  // The CLOUD_UPLOAD_QUEUE_DEPTH histogram samples the queue.
+  //
+  // Default: 0, uploads run as soon as they are issued
+  int max_concurrent_uploads = 0;
+
+  // If true, the whole-file upload of an SST file carries the crc32c of the
+  // file, which the cloud verifies on receipt and keeps with the object, see
+  // CloudObjectInformation::crc32c. It is the checksum that
+  // FileChecksumGenCrc32cFactory records in the MANIFEST. The file is not
+  // read again for it: it is computed as the file is written, from the
+  // handoff checksums when Options::checksum_handoff_file_types has
+  // kTableFile. Streamed files, see multipart_upload_part_size, are
+  // uploaded without it.
+  //
+  // Default: false
+  bool sst_upload_checksums = false;
+
+  // If true, a MANIFEST Sync() only uploads the data appended since the
+  // previous Sync(), as a small delta object next to the MANIFEST object,
+  // rather than the whole MANIFEST. The deltas are appended back to the
+  // MANIFEST when it is fetched from the cloud.
+  //
+  // Default: false
+  bool manifest_delta_uploads = false;
+
+  // With manifest_delta_uploads, number of deltas after which the whole
+  // MANIFEST is uploaded again and its deltas deleted. This bounds the
+  // number of objects read when the MANIFEST is fetched.
+  //
+  // Default: 64
+  int manifest_max_deltas = 64;
+
+  // If not empty, the name of a low-latency bucket, such as an S3 Express One
+  // Zone directory bucket, that the small objects on the commit path of the
+  // DB are written to instead of the destination bucket: the MANIFEST, the
+  // CLOUDMANIFEST and the IDENTITY objects. Each is then copied to the same
+  // object path of the destination bucket in the background, for the
+  // durability of the regional bucket; WaitForAllUploadsToDest() and the
+  // destruction of the file system wait for these copies. These objects are
+  // read from this bucket first. Every DB that writes to the destination
+  // must use the same express bucket, which is not created if missing. The
+  // MANIFEST deltas of manifest_delta_uploads are written to the
+  // destination bucket.
+  //
+  // Default: empty
+  std::string express_bucket;
+
+  // If true and keep_local_sst_files is set, opening a DB downloads its live
+  // SST files missing from the local directory on a background pool, lowest
+  // levels first, instead of one at a time as the files are opened. The DB
+  // open itself does not wait for the downloads: a file that is opened before
+  // it is downloaded is fetched right away, or waited for if its download is
+  // running. With max_open_files != -1 the DB serves reads as soon as its
+  // metadata is loaded.
+  //
+  // Default: false
+  bool prefetch_sst_files_on_open = false;
+
+  // Number of threads downloading SST files, see prefetch_sst_files_on_open.
+  //
+  // Default: 32
+  int prefetch_sst_threads = 32;
+
+  // If true, DBCloud::Open() issues the cloud requests that do not depend on
+  // each other at the same time rather than one after the other: the
+  // CLOUDMANIFEST is fetched while the IDENTITY file is, an object looked up
+  // in the destination bucket is looked up in the source bucket too, and the
+  // invisible files of the destination bucket are deleted while the MANIFEST
+  // is fetched. Opening a clone then costs a few more requests to the source
+  // bucket, but not their latency. The time spent in each phase of the open
+  // is logged and recorded in the CLOUD_OPEN_* histograms either way.
+  //
+  // Default: false
+  bool parallel_open = false;
+
+  // If true and keep_local_sst_files is set, an SST file missing from the
+  // local directory is opened from the cloud rather than downloaded first, so
+  // that opening it only fetches the blocks the table reader loads up front
+  // (footer, metaindex, index and filter) with ranged GETs. The whole file is
+  // downloaded in the background on the prefetch_sst_threads pool, and the
+  // local copy is used by the opens that follow. A table reader opened from
+  // the cloud keeps reading from it until it leaves the table cache. Async
+  // IO is not supported with this option, async_io reads are synchronous.
+  //
+  // Default: false
+  bool lazy_open_sst_files = false;
+
+  // If non-zero and keep_local_sst_files is set, the local copies of the SST
+  // files are kept under about this many bytes. When a copy is written,
+  // downloaded or opened beyond the budget, the copies opened least recently
+  // are deleted from the local directory; the next open of such a file
+  // downloads it again, or reads it from the cloud while it is downloaded
+  // with lazy_open_sst_files. prefetch_sst_files_on_open stops at the budget.
+  // A table reader keeps reading the deleted copy of a file it has open, so
+  // the space of the copy is only freed once the table cache drops the
+  // reader: max_open_files should be set for the budget to hold. Requires a
+  // dest bucket.
+  //
+  // Default: 0
+  uint64_t local_sst_budget_bytes = 0;
+
+  // If true, a clone (a DB whose src bucket differs from its dest bucket)
+  // never copies the SST files of its source: they stay in the src bucket and
+  // are read from it through the cloud read path, chunk cache included, even
+  // if keep_local_sst_files is set. Clones reading the same source object
+  // share its chunk cache entries with the source and with each other. Only
+  // the files the clone writes land in the local directory and the dest
+  // bucket. The source must keep the shared objects alive, which its purger
+  // does for the clones registered in its bucket.
+  //
+  // Default: false
+  bool zero_copy_clone = false;
+
+  // With the "s3-crt" storage provider, the throughput in gigabits per
+  // second that the AWS CRT S3 client aims for when it splits GETs and PUTs
+  // of whole objects into parallel ranged requests.
+  //
+  // Default: 10
+  double s3_crt_throughput_target_gbps = 10;
+
+  // With the "s3-crt" storage provider, the size of the ranged requests and
+  // multipart upload parts that the AWS CRT S3 client splits whole objects
+  // into.
+  //
+  // Default: 8MB
+  uint64_t s3_crt_part_size = 8 * 1024 * 1024;
+
+  // If non-zero, the SST objects of a new DB are spread over this many
+  // sub-prefixes of its object path, named after a hash of the file name,
+  // so that compactions and parallel opens are not throttled by the request
+  // rate that the cloud storage allows per key prefix. The layout is chosen
+  // when the DB is created and recorded in its CLOUDMANIFEST, which clones
+  // and checkpoints inherit; this option does not change the layout of an
+  // existing DB.
+  //
+  // Default: 0
+  uint32_t sst_object_shards = 0;
+
+  // If greater than 1, listings of the object path of a DB (GetChildren, the
+  // purger and the deletion of invisible files) split the key space into this
+  // many partitions that are listed concurrently. Partitions follow the
+  // hashed sub-prefixes of a sharded DB, see sst_object_shards, or else the
+  // file numbers known from the CLOUDMANIFEST.
+  //
+  // Default: 1
+  uint32_t list_objects_parallelism = 1;
+
+  // If non-zero, the storage provider caches the size, modification time
+  // and content hash of up to this many SST objects, so that opening,
+  // sizing and checking the existence of SST files do not each issue a HEAD
+  // request. The cache is filled by the HEAD requests, the listings and the
+  // uploads of the provider, and objects are dropped from it when the
+  // provider deletes, copies over or rewrites them. SST objects are never
+  // modified in place, but an object deleted by another process, such as
+  // the purger of another DB sharing the bucket, stays in the cache until
+  // it is evicted.
+  //
+  // Default: 0
+  uint64_t object_metadata_cache_entries = 0;
+
+  // If set, SST files read directly from the cloud (keep_local_sst_files is
+  // false) go through this on-disk chunk cache, so that hot data is served
+  // from local disk rather than by ranged GETs. A cache can be shared by all
+  // the DBs of a process, see CloudChunkCache::Open().
+  //
+  // Default: null
+  std::shared_ptr<CloudChunkCache> chunk_cache;
+
+  // If set, every request to the cloud storage is counted in these
+  // statistics: the CLOUD_* tickers and histograms break requests, bytes,
+  // failures, retries and throttles down by type of request. This is
+  // typically the same object as Options::statistics. The cloud requests of
+  // a thread are counted in its PerfContext whether or not this is set.
+  //
+  // Default: null
+  std::shared_ptr<Statistics> statistics;
+
+  // If set, paces the transfers between the DB and the cloud storage: the
+  // ranged reads and downloads of SST files, and the uploads of SST and
+  // MANIFEST files. Transfers use the I/O priority of the file or read that
+  // triggers them, so foreground reads and flush uploads go before
+  // prefetching and compaction uploads. A limiter can be shared by all the
+  // DBs of a process, and backs off when the cloud storage throttles.
+  //
+  // Default: null
+  std::shared_ptr<CloudRateLimiter> cloud_rate_limiter;
+
+  // If set, a ranged read of a cloud file that is slower than most recent
+  // reads gets a duplicate request, and whichever completes first serves
+  // the read. This cuts the tail latency of cloud reads at the cost of a
+  // bounded share of extra requests, see CloudReadHedgerOptions.
+  //
+  // Default: null
+  std::shared_ptr<CloudReadHedger> read_hedger;
+
+  // If set, and keep_local_sst_files is false, the input files of each
+  // compaction are downloaded ahead of it by parallel ranged reads of large
+  // chunks, kept in a bounded memory buffer that serves the reads of the
+  // compaction, see CloudCompactionPrefetcherOptions. A prefetcher can be
+  // shared by all the DBs of a process.
+  //
+  // Default: null
+  std::shared_ptr<CloudCompactionPrefetcher> compaction_prefetcher;
+
+  // If non-negative and keep_local_sst_files is false, the SST files of the
+  // levels up to this one keep a local copy that serves their reads, while
+  // the files of the lower levels are read from the cloud. A DB opened with
+  // DBCloud::Open() downloads or drops the local copies of its files when
+  // it opens and as flushes and compactions move files between levels; the
+  // downloads run on prefetch_sst_threads threads. Files written by a
+  // flush or a compaction keep their local copy until then. Hot upper
+  // levels get the latency of local storage without a local copy of the
+  // much larger bottom level.
+  //
+  // Default: -1
+  int local_sst_max_level = -1;
+
+  // If not kUnknown and keep_local_sst_files is false, the SST files of
+  // this temperature keep a local copy whatever their level, see
+  // local_sst_max_level.
+  //
+  // Default: kUnknown
+  Temperature local_sst_temperature = Temperature::kUnknown;
+
+  // If true, a DB opened with DBCloud::Open() dumps the entries of its block
+  // cache to the BLOCKCACHE object of the destination bucket when it is
+  // closed, and every block_cache_dump_period_secs seconds if that is
+  // non-zero, see DBCloud::DumpBlockCacheToCloud().
+  //
+  // Default: false
+  bool dump_block_cache = false;
+
+  // Default: 0
+  uint64_t block_cache_dump_period_secs = 0;
+
+  // If set, DBCloud::Open() loads the BLOCKCACHE object of the source
+  // bucket, if any, into this secondary cache before it returns, so that a
+  // restarted DB or a replica does not start with a cold cache and fetch all
+  // of its hot blocks from the cloud again. It should be the secondary cache
+  // of the block cache of the DB, which serves the misses of the block
+  // cache from it.
+  //
+  // Default: null
+  std::shared_ptr<SecondaryCache> block_cache_load_target;
+
+  // If non-zero, a DB opened with DBCloud::Open() uploads a snapshot of its
+  // tickers and histograms to a new object under STATS_HISTORY/ in the
+  // destination bucket every this many seconds, and once more when it is
+  // closed, so that its performance can be analyzed after the instance is
+  // gone. The stats come from Options::statistics and the cloud ones from
+  // statistics above if it is set. tools/cloud_stats_history merges the
+  // snapshots into time series.
+  //
+  // Default: 0
+  uint64_t stats_history_period_secs = 0;
+
   // Type info map for this class.
   static const std::unordered_map<std::string, OptionTypeInfo>
       cloud_fs_option_type_info;
@@ -443,6 +867,14 @@ class CloudFileSystemOptions {
   // print out all options to the log
   void Dump(Logger* log) const;
 
+  // Whether some SST files keep a local copy while the others are read from
+  // the cloud, see local_sst_max_level.
+  bool TiersLocalSstFiles() const {
+    return !keep_local_sst_files &&
+           (local_sst_max_level >= 0 ||
+            local_sst_temperature != Temperature::kUnknown);
+  }
+
   // Sets result based on the value of name or alt in the environment
   // Returns true if the name/alt exists in the environment, false otherwise
   static bool GetNameFromEnvironment(const char* name, const char* alt,
@@ -460,6 +892,27 @@ class CloudFileSystemOptions {
 struct CheckpointToCloudOptions {
   int thread_count = 8;
   bool flush_memtable = false;
+
+  // Reuse the SST files that an earlier checkpoint left in the destination.
+  // A file is skipped if the destination holds it and the MANIFEST of the
+  // destination records it with the same size and checksum (only the size
+  // is compared when file checksums are disabled). The other files are
+  // copied server-side when the cloud storage of the DB already holds them,
+  // and uploaded from the local disk otherwise.
+  bool incremental = false;
+};
+
+struct CloudBackupOptions {
+  int thread_count = 8;
+
+  // Flush the memtables before the backup, so that it does not need the WAL
+  // files. Otherwise the live WAL files are part of the backup. WAL files are
+  // only backed up when they are kept locally, see keep_local_log_files.
+  bool flush_memtable = false;
+};
+
+struct ExportColumnFamilyToCloudOptions {
+  int thread_count = 8;
 };
 
 // A map of dbid to the pathname where the db is stored
@@ -481,6 +934,17 @@ class CloudFileSystem : public FileSystem {
   static const char* kCloud() { return "cloud"; }
   static const char* kAws() { return "aws"; }
 
+  // Prefix of the paths that name an object of the storage provider outside
+  // of the buckets of the DB: cloud://<bucket>/<object path>. Such objects,
+  // e.g. SST files produced by an offline pipeline, can be ingested with
+  // DB::IngestExternalFile() and IngestExternalFileOptions::move_files. The
+  // ingestion reads only the footer and the metadata blocks of each object,
+  // copies it into the destination bucket under the remapped name of its new
+  // file with a server-side CopyCloudObject(), without downloading it, and
+  // deletes it once the files are added, as for moved local files. Requires
+  // a destination bucket and write_global_seqno = false.
+  static const char* kCloudObjectUriPrefix() { return "cloud://"; }
+
   // Returns the underlying file system
   virtual const std::shared_ptr<FileSystem>& GetBaseFileSystem() const = 0;
 
@@ -509,9 +973,34 @@ class CloudFileSystem : public FileSystem {
 
   // Deletes file from a destination bucket.
   virtual IOStatus DeleteCloudFileFromDest(const std::string& fname) = 0;
-  // Copies a local file to a destination bucket.
+  // Copies a local file to a destination bucket. pri is the I/O priority of
+  // the upload, see CloudFileSystemOptions::cloud_rate_limiter. crc32c, if
+  // not empty, is the checksum of the file the upload carries, see
+  // CloudStorageProvider::PutCloudObjectWithChecksum().
   virtual IOStatus CopyLocalFileToDest(const std::string& local_name,
-                                       const std::string& cloud_name) = 0;
+                                       const std::string& cloud_name,
+                                       Env::IOPriority pri = Env::IO_TOTAL,
+                                       const std::string& crc32c = "") = 0;
+  // Runs the upload of a local file to a destination bucket in the
+  // background, see CloudFileSystemOptions::defer_sst_uploads.
+  virtual void ScheduleUploadToDest(const std::string& local_name,
+                                    CloudUploadClass cls,
+                                    std::function<IOStatus()>&& upload) = 0;
+  // Runs an upload on the calling thread once the upload scheduler lets it,
+  // see CloudFileSystemOptions::max_concurrent_uploads.
+  virtual IOStatus RunUpload(CloudUploadClass cls,
+                             const std::function<IOStatus()>& upload) = 0;
+  // Waits for the background upload of a local file, if there is one.
+  virtual IOStatus WaitForUploadToDest(const std::string& local_name) = 0;
+  // Waits for every background upload scheduled so far. Returns the error of
+  // the first upload that failed, if any did.
+  virtual IOStatus WaitForAllUploadsToDest() = 0;
+  // Completes the multipart upload of a local file to a destination bucket,
+  // the counterpart of CopyLocalFileToDest() for streamed files.
+  virtual IOStatus CompleteMultipartUploadToDest(
+      const std::string& local_name, const std::string& cloud_name,
+      const std::string& upload_id,
+      const std::vector<std::string>& part_ids) = 0;
 
   // Returns CloudManifest file name for a given db.
   virtual std::string CloudManifestFile(const std::string& dbname) = 0;
@@ -541,6 +1030,15 @@ class CloudFileSystem : public FileSystem {
   // Files both in S3 and in the local directory have this [epoch] suffix.
   virtual std::string RemapFilename(const std::string& logical_name) const = 0;
 
+  // Returns the key of the object that stores fname, a file name as stored in
+  // the cloud (see RemapFilename()), under object_path. SST objects go to
+  // the hashed sub-prefix that the CLOUDMANIFEST layout assigns them, see
+  // CloudFileSystemOptions::sst_object_shards. Listings of an object path
+  // return the keys relative to it; CloudFileSystem strips the sub-prefixes
+  // from the listings it serves.
+  virtual std::string CloudObjectName(const std::string& object_path,
+                                      const std::string& fname) const = 0;
+
   // Find the list of live files based on CloudManifest and Manifest in local db
   //
   // For the returned filepath in `live_sst_files` and `manifest_file`, we only
@@ -560,6 +1058,31 @@ class CloudFileSystem : public FileSystem {
       const std::string& manifest_file,
       std::vector<std::string>* live_sst_files) = 0;
 
+  // Starts downloading the live SST files of the local MANIFEST that are
+  // missing from local_dbname, see
+  // CloudFileSystemOptions::prefetch_sst_files_on_open. Returns once the
+  // downloads are queued.
+  //
+  // REQUIRES: cloud manifest is loaded
+  virtual IOStatus PrefetchSstFiles(const std::string& local_dbname) = 0;
+
+  // Hands the input files of the compaction job_id to the compaction
+  // prefetcher, if any, see CloudFileSystemOptions::compaction_prefetcher.
+  // ReleaseCompactionInputs() is called once the compaction completed.
+  virtual void PrefetchCompactionInputs(
+      int job_id, const std::vector<std::string>& input_files) = 0;
+  virtual void ReleaseCompactionInputs(int job_id) = 0;
+
+  // Downloads or drops the local copies of the live SST files of
+  // local_dbname, according to their level and temperature, see
+  // CloudFileSystemOptions::local_sst_max_level. Only the files whose
+  // placement changed since the previous call are looked at. Downloads are
+  // queued, and errors are logged: a file without a local copy is read from
+  // the cloud.
+  virtual void UpdateLocalSstFiles(
+      const std::string& local_dbname,
+      const std::vector<LiveFileMetaData>& live_files) = 0;
+
   // Apply cloud manifest delta to in-memory cloud manifest. Does not change the
   // on-disk state.
   //
@@ -3,9 +3,16 @@
 #pragma once
 #include <atomic>
 #include <condition_variable>
+#include <deque>
+#include <functional>
+#include <future>
+#include <list>
+#include <map>
 #include <mutex>
 #include <set>
 #include <thread>
+#include <unordered_map>
+#include <unordered_set>
 
 #include "rocksdb/cloud/cloud_file_system.h"
 #include "rocksdb/file_system.h"
@@ -18,10 +25,13 @@ class CloudScheduler;
 class CloudStorageReadableFile;
 class ObjectLibrary;
 class CloudFileDeletionScheduler;
+class CloudUploadScheduler;
 
 //
 // The Cloud file system
 //
+class ThreadPoolImpl;
+
 class CloudFileSystemImpl : public CloudFileSystem {
   friend class CloudFileSystemEnv;
 
@@ -54,6 +64,13 @@ class CloudFileSystemImpl : public CloudFileSystem {
                                   std::unique_ptr<FSSequentialFile>* result,
                                   IODebugContext* dbg) override;
 
+  // Appends to local_fname, a copy of the MANIFEST object object_path, the
+  // deltas uploaded after that object, see
+  // CloudFileSystemOptions::manifest_delta_uploads.
+  IOStatus FetchManifestDeltas(const std::string& bucket,
+                               const std::string& object_path,
+                               const std::string& local_fname);
+
   IOStatus NewRandomAccessFile(const std::string& fname,
                                const FileOptions& file_opts,
                                std::unique_ptr<FSRandomAccessFile>* result,
@@ -152,8 +169,23 @@ class CloudFileSystemImpl : public CloudFileSystem {
   // A map from a dbid to the list of all its parent dbids.
   typedef std::map<std::string, std::vector<std::string>> DbidParents;
 
+  // If dbids and live_files are set, they get the dbids registered in the
+  // bucket and the object names (without shard) of the SST files live in
+  // them, as of the listing.
   IOStatus FindObsoleteFiles(const std::string& bucket_name_prefix,
-                             std::vector<std::string>* pathnames);
+                             std::vector<std::string>* pathnames,
+                             std::set<std::string>* dbids = nullptr,
+                             std::set<std::string>* live_files = nullptr);
+  // The runs of the purger between full listings, see
+  // CloudFileSystemOptions::purger_full_listing_periodicity_millis. Finds
+  // which of the SST objects deleted by this DB are obsolete, given the
+  // dbids and live_files of the last full listing, and forgets them. Sets
+  // *needs_full_listing instead if a dbid was registered since.
+  IOStatus FindObsoleteCandidates(const std::string& bucket_name_prefix,
+                                  const std::set<std::string>& dbids,
+                                  const std::set<std::string>& live_files,
+                                  std::vector<std::string>* pathnames,
+                                  bool* needs_full_listing);
   IOStatus FindObsoleteDbid(const std::string& bucket_name_prefix,
                             std::vector<std::string>* dbids);
 
@@ -170,6 +202,15 @@ class CloudFileSystemImpl : public CloudFileSystem {
       const std::string& manifest_file,
       std::vector<std::string>* live_sst_files) override;
 
+  IOStatus PrefetchSstFiles(const std::string& local_dbname) override;
+
+  void PrefetchCompactionInputs(
+      int job_id, const std::vector<std::string>& input_files) override;
+  void ReleaseCompactionInputs(int job_id) override;
+  void UpdateLocalSstFiles(
+      const std::string& local_dbname,
+      const std::vector<LiveFileMetaData>& live_files) override;
+
   IOStatus extractParents(const std::string& bucket_name_prefix,
                           const DbidList& dbid_list, DbidParents* parents);
   IOStatus PreloadCloudManifest(const std::string& local_dbname) override;
@@ -193,6 +234,17 @@ class CloudFileSystemImpl : public CloudFileSystem {
   // an epoch during which that file was created.
   // Files both in S3 and in the local directory have this [epoch] suffix.
   std::string RemapFilename(const std::string& logical_path) const override;
+  // As above, into result, whose buffer is reused. The lookup of the epoch
+  // does not lock or allocate.
+  void RemapFilename(const std::string& logical_path,
+                     std::string* result) const;
+  std::string CloudObjectName(const std::string& object_path,
+                              const std::string& fname) const override;
+
+  // Returns the boundaries that split the listing of a DB object path into
+  // list_objects_parallelism partitions, see
+  // CloudStorageProvider::VisitCloudObjects. Empty if listings are sequential.
+  std::vector<std::string> GetListBoundaries() const;
 
   FileOptions OptimizeForLogRead(
       const FileOptions& file_options) const override {
@@ -231,6 +283,13 @@ class CloudFileSystemImpl : public CloudFileSystem {
                         uint64_t* diskfree, IODebugContext* dbg) override {
     return base_fs_->GetFreeSpace(path, options, diskfree, dbg);
   }
+  // Async reads of SST files are served by the base file system when files
+  // are kept locally, and by the cloud readable files otherwise.
+  IOStatus Poll(std::vector<void*>& io_handles,
+                size_t min_completions) override;
+  IOStatus AbortIO(std::vector<void*>& io_handles) override;
+  void SupportedOps(int64_t& supported_ops) override;
+
   IOStatus IsDirectory(const std::string& /*path*/,
                        const IOOptions& /*options*/, bool* /*is_dir*/,
                        IODebugContext* /*dbg*/) override {
@@ -242,7 +301,20 @@ class CloudFileSystemImpl : public CloudFileSystem {
 
   IOStatus DeleteCloudFileFromDest(const std::string& fname) override;
   IOStatus CopyLocalFileToDest(const std::string& local_name,
-                               const std::string& cloud_name) override;
+                               const std::string& cloud_name,
+                               Env::IOPriority pri = Env::IO_TOTAL,
+                               const std::string& crc32c = "") override;
+  void ScheduleUploadToDest(const std::string& local_name,
+                            CloudUploadClass cls,
+                            std::function<IOStatus()>&& upload) override;
+  IOStatus RunUpload(CloudUploadClass cls,
+                     const std::function<IOStatus()>& upload) override;
+  IOStatus WaitForUploadToDest(const std::string& local_name) override;
+  IOStatus WaitForAllUploadsToDest() override;
+  IOStatus CompleteMultipartUploadToDest(
+      const std::string& local_name, const std::string& cloud_name,
+      const std::string& upload_id,
+      const std::vector<std::string>& part_ids) override;
 
   Status PrepareOptions(const ConfigOptions& config_options) override;
   Status ValidateOptions(const DBOptions& /*db_opts*/,
@@ -302,8 +374,10 @@ class CloudFileSystemImpl : public CloudFileSystem {
   // Checks to see if the input fname exists in the dest or src bucket
   IOStatus ExistsCloudObject(const std::string& fname);
 
-  // Gets the cloud object fname from the dest or src bucket
-  IOStatus GetCloudObject(const std::string& fname);
+  // Gets the cloud object fname from the dest or src bucket. pri is the I/O
+  // priority of the download, see CloudFileSystemOptions::cloud_rate_limiter.
+  IOStatus GetCloudObject(const std::string& fname,
+                          Env::IOPriority pri = Env::IO_HIGH);
 
   // Gets the size of the named cloud object from the dest or src bucket
   IOStatus GetCloudObjectSize(const std::string& fname, uint64_t* remote_size);
@@ -322,6 +396,13 @@ class CloudFileSystemImpl : public CloudFileSystem {
       const std::string& fname, const FileOptions& options,
       std::unique_ptr<CloudStorageReadableFile>* result, IODebugContext* dbg);
 
+  // Installs the output file of a remote compaction as the SST file target.
+  // The output is the local file src, or else the object logical_src of the
+  // dest bucket.
+  IOStatus RenameCompactionOutput(const std::string& logical_src,
+                                  const std::string& src,
+                                  const std::string& target);
+
   // Copy IDENTITY file to cloud storage. Update dbid registry.
   IOStatus SaveIdentityToCloud(const std::string& localfile,
                                const std::string& idfile);
@@ -347,6 +428,24 @@ class CloudFileSystemImpl : public CloudFileSystem {
                                  const std::string& local_name);
 
   IOStatus FetchCloudManifest(const std::string& local_dbname);
+  // With CloudFileSystemOptions::parallel_open, the CLOUDMANIFEST is fetched
+  // while SanitizeLocalDirectory() fetches the IDENTITY file, and
+  // LoadCloudManifest() picks up the result.
+  std::future<IOStatus> cloud_manifest_fetch_;
+
+  // Fetches into local_file an object of the db that fetch names from a
+  // bucket and an object path: from the destination bucket, or from the
+  // source bucket when the destination does not have it, or fails to fetch
+  // it and dest_error_is_final is false. With parallel_open, the source
+  // bucket is asked at the same time as the destination. Returns NotFound
+  // if neither has it. *from_src tells whether the object, or the error,
+  // came from the source bucket.
+  IOStatus FetchFromDestOrSrc(
+      const std::function<IOStatus(const std::string& bucket,
+                                   const std::string& object_path,
+                                   const std::string& local_file)>& fetch,
+      const std::string& local_file, bool dest_error_is_final,
+      bool* from_src);
 
   IOStatus RollNewEpoch(const std::string& local_dbname);
 
@@ -364,6 +463,77 @@ class CloudFileSystemImpl : public CloudFileSystem {
   bool purger_is_running_;
   std::thread purge_thread_;
 
+  // Deferred SST uploads, see CloudFileSystemOptions::defer_sst_uploads.
+  // pending_uploads_ maps the sequence number of each pending upload to its
+  // local file name, and deferred_upload_status_ keeps the first failure.
+  std::mutex uploads_mutex_;
+  std::condition_variable uploads_cv_;
+  std::map<uint64_t, std::string> pending_uploads_;
+  uint64_t next_upload_seq_ = 0;
+  IOStatus deferred_upload_status_;
+  // Created with the first deferred upload.
+  std::unique_ptr<ThreadPoolImpl> upload_pool_;
+  // Created with the first upload when uploads are scheduled, see
+  // CloudFileSystemOptions::max_concurrent_uploads. Runs the deferred
+  // uploads instead of upload_pool_.
+  std::unique_ptr<CloudUploadScheduler> upload_scheduler_;
+  // Returns nullptr if uploads are not scheduled.
+  CloudUploadScheduler* GetUploadScheduler();
+
+  // SST files downloaded in the background, see
+  // CloudFileSystemOptions::prefetch_sst_files_on_open and
+  // lazy_open_sst_files. prefetches_ maps the
+  // local name of each queued file to whether its download is running.
+  std::mutex prefetch_mutex_;
+  std::condition_variable prefetch_cv_;
+  std::unordered_map<std::string, bool> prefetches_;
+  std::unique_ptr<ThreadPoolImpl> prefetch_pool_;
+  // Queues the download of fname. REQUIRES: prefetch_mutex_ held, fname not
+  // queued.
+  void QueueSstDownload(const std::string& fname);
+  // Takes over the queued download of fname, so that the caller fetches it
+  // right away, or waits for it if it is running.
+  void WaitForPrefetch(const std::string& fname);
+
+  // The local copies of the SST files that count against the budget, most
+  // recently used first, with their sizes, see
+  // CloudFileSystemOptions::local_sst_budget_bytes.
+  std::mutex local_sst_lru_mutex_;
+  std::list<std::pair<std::string, uint64_t>> local_sst_lru_;
+  std::unordered_map<std::string,
+                     std::list<std::pair<std::string, uint64_t>>::iterator>
+      local_sst_lru_index_;
+  uint64_t local_sst_lru_bytes_ = 0;
+  // Marks the local copy of fname as the most recently used one, and
+  // deletes the least recently used copies beyond the budget. A copy that is
+  // not counted yet is added if added is set, which the caller sets once the
+  // file is uploaded or downloaded, or else if the file exists in the cloud.
+  void TouchLocalSstFile(const std::string& fname, bool added);
+  // Stops counting the local copy of fname, which is being deleted.
+  void ForgetLocalSstFile(const std::string& fname);
+  bool HasPendingUpload(const std::string& local_name);
+
+  // The bucket and object path of the input files each running compaction
+  // handed to the compaction prefetcher, by job id.
+  std::mutex compaction_inputs_mutex_;
+  std::unordered_map<int, std::vector<std::pair<std::string, std::string>>>
+      compaction_inputs_;
+
+  // Whether each live SST file keeps a local copy, as of the last call to
+  // UpdateLocalSstFiles(), by local name, see
+  // CloudFileSystemOptions::local_sst_max_level.
+  std::mutex local_sst_mutex_;
+  std::unordered_map<std::string, bool> local_sst_files_;
+
+  // The SST files deleted from the destination bucket since the purger last
+  // checked them, by name, if the purger does not list the bucket on every
+  // run.
+  std::mutex purge_candidates_mutex_;
+  std::unordered_set<std::string> purge_candidates_;
+  void AddPurgeCandidate(const std::string& fname);
+  // Called when fname is uploaded again.
+  void ForgetPurgeCandidate(const std::string& fname);
+
   // A background thread that deletes orphaned objects in cloud storage
   void Purger();
   void StopPurger();
@@ -406,6 +576,12 @@ class CloudFileSystemImpl : public CloudFileSystem {
       return false;
     }
   }
+  // Whether the SST files of the src bucket are read in place, see
+  // CloudFileSystemOptions::zero_copy_clone.
+  bool IsZeroCopyClone() const {
+    return cloud_fs_options.zero_copy_clone && HasSrcBucket() &&
+           !SrcMatchesDest();
+  }
 
   const std::shared_ptr<CloudStorageProvider>& GetStorageProvider()
       const override {
@@ -444,7 +620,47 @@ class CloudFileSystemImpl : public CloudFileSystem {
                          const std::string& epoch);
   std::string GenerateNewEpochId();
 
+  // Whether the object of the destination goes to the express bucket, see
+  // CloudFileSystemOptions::express_bucket.
+  bool IsExpressObject(const std::string& object_path) const;
+  // Uploads local_file to object_path of the destination, through the
+  // express bucket for the express objects.
+  IOStatus PutDestCloudObject(const std::string& local_file,
+                              const std::string& object_path,
+                              const std::string& crc32c = "") const;
+  // Downloads object_path of bucket into local_file, from the express bucket
+  // first if bucket is the destination and the object an express object.
+  IOStatus FetchCloudObject(const std::string& bucket,
+                            const std::string& object_path,
+                            const std::string& local_file) const;
+  // Queues the copy of an object of the express bucket to the destination
+  // bucket. The copies run in order on express_thread_, an object queued
+  // again before its copy started being copied once.
+  void ScheduleExpressCopy(const std::string& object_path) const;
+  void ExpressCopyLoop() const;
+  // Waits until no copy is queued or running. Returns the error of the first
+  // copy that failed, if any did.
+  IOStatus WaitForExpressCopies() const;
+
+  mutable std::mutex express_mutex_;
+  mutable std::condition_variable express_cv_;
+  mutable std::deque<std::string> express_copies_;
+  mutable bool express_copying_ = false;
+  mutable bool express_stop_ = false;
+  mutable IOStatus express_copy_status_;
+  mutable std::thread express_thread_;
+
+  // Whether the SST files of the epoch of fname are looked up in the src
+  // bucket first. The files of an epoch are written by a single database, so
+  // they are all in the bucket that the first one looked up was found in.
+  bool IsEpochInSrc(const std::string& fname);
+  void SetEpochInSrc(const std::string& fname, bool in_src);
+
   std::unique_ptr<CloudManifest> cloud_manifest_;
+  // The bucket that the SST files of each epoch were found in, true for the
+  // src bucket. Only kept if the src and dest buckets differ.
+  std::mutex epoch_in_src_mutex_;
+  std::unordered_map<std::string, bool> epoch_in_src_;
   // This runs only in tests when we want to disable cloud manifest
   // functionality
   bool test_disable_cloud_manifest_{false};
@@ -0,0 +1,113 @@
+//  Copyright (c) 2016-present, Rockset, Inc.  All rights reserved.
+
+#pragma once
+#include <atomic>
+#include <memory>
+#include <mutex>
+
+#include "rocksdb/env.h"
+
+namespace ROCKSDB_NAMESPACE {
+
+class RateLimiter;
+
+struct CloudRateLimiterOptions {
+  // Byte budgets of the transfers from and to the cloud storage. 0 means
+  // unlimited.
+  int64_t download_bytes_per_sec = 0;
+  int64_t upload_bytes_per_sec = 0;
+
+  // Request budgets of the transfers from and to the cloud storage. 0 means
+  // unlimited.
+  int64_t download_requests_per_sec = 0;
+  int64_t upload_requests_per_sec = 0;
+
+  // When the cloud storage throttles a request (e.g. S3 SlowDown), the
+  // request budgets are multiplied by this factor, down to one request per
+  // second. They grow back by the same factor every throttle_recovery_micros
+  // without throttling, up to the configured budgets. Only applies to the
+  // request budgets that are set.
+  //
+  // Default: 0.5
+  double throttle_backoff = 0.5;
+  // Default: 1 second
+  uint64_t throttle_recovery_micros = 1000 * 1000;
+
+  // See NewGenericRateLimiter().
+  int64_t refill_period_us = 100 * 1000;
+  int32_t fairness = 10;
+};
+
+// Paces the requests to the cloud storage with separate byte and request
+// budgets for downloads and uploads, so that background uploads do not
+// starve foreground reads of bandwidth or of the storage's request rate.
+//
+// Each budget is a GenericRateLimiter, hence honors Env::IOPriority: with
+// the default priorities, user reads (IO_USER) go before flush uploads and
+// on-demand downloads (IO_HIGH), which go before compaction uploads and
+// prefetching (IO_LOW). A limiter can be shared by all the DBs of a process.
+class CloudRateLimiter {
+ public:
+  enum class Direction { kDownload, kUpload };
+
+  explicit CloudRateLimiter(const CloudRateLimiterOptions& options);
+  ~CloudRateLimiter();
+
+  // Blocks until a request transferring bytes bytes in direction may be
+  // sent. bytes may be 0 when the size is not known yet, in which case the
+  // transfer is charged with ChargeBytes() once it completes. IO_TOTAL
+  // stands for the highest priority, IO_USER.
+  void Request(Direction direction, uint64_t bytes, Env::IOPriority pri);
+
+  // Charges bytes to the byte budget of direction, without counting a
+  // request.
+  void ChargeBytes(Direction direction, uint64_t bytes, Env::IOPriority pri);
+
+  // Backs the request budgets off, called when the cloud storage throttled
+  // a request.
+  void OnThrottled();
+
+  // The current request budget of direction, 0 if unlimited.
+  int64_t GetRequestsPerSecond(Direction direction) const;
+
+  // Totals of what went through the limiter since it was created.
+  uint64_t GetTotalBytes(Direction direction) const;
+  uint64_t GetTotalRequests(Direction direction) const;
+  uint64_t GetThrottles() const {
+    return throttles_.load(std::memory_order_relaxed);
+  }
+
+ private:
+  struct Budget {
+    std::unique_ptr<RateLimiter> bytes;
+    std::unique_ptr<RateLimiter> requests;
+    int64_t max_requests_per_sec = 0;
+    int64_t requests_per_sec = 0;
+    std::atomic<uint64_t> total_bytes{0};
+    std::atomic<uint64_t> total_requests{0};
+  };
+
+  Budget& GetBudget(Direction direction) {
+    return direction == Direction::kDownload ? download_ : upload_;
+  }
+  const Budget& GetBudget(Direction direction) const {
+    return direction == Direction::kDownload ? download_ : upload_;
+  }
+  // Grows the request budgets back if they were not throttled for a while.
+  void MaybeRecover();
+  // REQUIRES: mutex_ held.
+  void SetRequestsPerSecond(Budget* budget, int64_t requests_per_sec);
+
+  const CloudRateLimiterOptions options_;
+  const std::shared_ptr<SystemClock> clock_;
+  Budget download_;
+  Budget upload_;
+
+  mutable std::mutex mutex_;
+  // Time of the last throttle or recovery step. 0 when the request budgets
+  // are at their configured values.
+  std::atomic<uint64_t> backoff_micros_{0};
+  std::atomic<uint64_t> throttles_{0};
+};
+
+}  // namespace ROCKSDB_NAMESPACE
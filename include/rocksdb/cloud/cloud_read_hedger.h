@@ -0,0 +1,94 @@
+//  Copyright (c) 2016-present, Rockset, Inc.  All rights reserved.
+
+#pragma once
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <vector>
+
+#include "rocksdb/rocksdb_namespace.h"
+
+namespace ROCKSDB_NAMESPACE {
+
+class SystemClock;
+
+struct CloudReadHedgerOptions {
+  // A ranged read still outstanding after this percentile of the recent
+  // read latencies gets a duplicate request, and the first of the two to
+  // complete serves the read.
+  //
+  // Default: 95
+  double percentile = 95.0;
+
+  // Reads are never hedged before this delay, so that fast reads are not
+  // duplicated when the latencies are tightly packed.
+  //
+  // Default: 2ms
+  uint64_t min_delay_micros = 2000;
+
+  // Budget of the duplicate requests: every read earns max_hedge_ratio
+  // hedges, up to max_hedge_burst, and every hedge spends one. With the
+  // defaults, hedging adds at most 5% requests once the burst is spent.
+  //
+  // Default: 0.05
+  double max_hedge_ratio = 0.05;
+  // Default: 10
+  double max_hedge_burst = 10;
+
+  // Number of threads, shared by the process, that issue the hedged reads.
+  // A hedged read holds up to two of them.
+  //
+  // Default: 16
+  int threads = 16;
+};
+
+// Hedges the ranged reads of cloud files to cut their tail latency, see
+// CloudFileSystemOptions::read_hedger. It tracks the latencies of the
+// recent reads to derive the hedging delay, and the budget that caps the
+// extra requests. Reads are not hedged until enough latencies were sampled.
+// A hedger can be shared by all the DBs of a process.
+class CloudReadHedger {
+ public:
+  explicit CloudReadHedger(const CloudReadHedgerOptions& options);
+  ~CloudReadHedger();
+
+  const CloudReadHedgerOptions& GetOptions() const { return options_; }
+  const std::shared_ptr<SystemClock>& GetClock() const { return clock_; }
+
+  // How long a read may be outstanding before it is hedged, 0 if reads are
+  // not hedged yet.
+  uint64_t GetDelayMicros() const {
+    return delay_micros_.load(std::memory_order_relaxed);
+  }
+
+  // Records the latency of a read, and earns its share of the budget.
+  void RecordRead(uint64_t micros);
+  // Spends one hedge of the budget. Returns false if it is exhausted.
+  bool TryAcquireHedge();
+  // Called when the duplicate request completed first.
+  void RecordHedgeWin() { hedge_wins_.fetch_add(1, std::memory_order_relaxed); }
+
+  // Totals since the hedger was created.
+  uint64_t GetReads() const { return reads_.load(std::memory_order_relaxed); }
+  uint64_t GetHedges() const { return hedges_.load(std::memory_order_relaxed); }
+  uint64_t GetHedgeWins() const {
+    return hedge_wins_.load(std::memory_order_relaxed);
+  }
+
+ private:
+  const CloudReadHedgerOptions options_;
+  const std::shared_ptr<SystemClock> clock_;
+
+  std::mutex mutex_;
+  // Ring of the most recent read latencies.
+  std::vector<uint64_t> latencies_;
+  size_t next_latency_ = 0;
+  double budget_;
+  std::atomic<uint64_t> delay_micros_{0};
+
+  std::atomic<uint64_t> reads_{0};
+  std::atomic<uint64_t> hedges_{0};
+  std::atomic<uint64_t> hedge_wins_{0};
+};
+
+}  // namespace ROCKSDB_NAMESPACE
@@ -2,7 +2,9 @@
 //
 #pragma once
 
+#include <functional>
 #include <unordered_map>
+#include <vector>
 
 #include "rocksdb/configurable.h"
 #include "rocksdb/file_system.h"
@@ -39,6 +41,11 @@ struct CloudObjectInformation {
 
   // Cloud-vendor dependent. In S3, we will provide ETag of the object.
   std::string content_hash;
+  // The crc32c of the object, if it was uploaded with one, in the format of
+  // the file checksums of FileChecksumGenCrc32cFactory: four big-endian
+  // bytes. An object can then be checked against the file checksum of the
+  // DB without being downloaded. Empty otherwise.
+  std::string crc32c;
   std::unordered_map<std::string, std::string> metadata;
 };
 
@@ -51,7 +58,8 @@ class CloudStorageProvider : public Configurable {
   virtual ~CloudStorageProvider();
   static const char* Type() { return "CloudStorageProvider"; }
   // Creates and configures a new CloudStorageProvider from the input options
-  // and id.
+  // and id. The id may be followed by options of the provider, as in
+  // "id=simulated;read_latency_micros=20000".
   static Status CreateFromString(
       const ConfigOptions& config_options, const std::string& id,
       std::shared_ptr<CloudStorageProvider>* provider);
@@ -68,6 +76,12 @@ class CloudStorageProvider : public Configurable {
   // Delete the specified object from the specified cloud bucket
   virtual IOStatus DeleteCloudObject(const std::string& bucket_name,
                                      const std::string& object_path) = 0;
+  // Delete the specified objects from the specified cloud bucket. Objects that
+  // do not exist are not an error. The default implementation deletes one
+  // object at a time; providers with a bulk delete call should override it.
+  virtual IOStatus DeleteCloudObjects(
+      const std::string& bucket_name,
+      const std::vector<std::string>& object_paths);
 
   // Does the specified object exist in the cloud storage
   // returns all the objects that have the specified path prefix and
@@ -76,6 +90,22 @@ class CloudStorageProvider : public Configurable {
                                     const std::string& object_path,
                                     std::vector<std::string>* path_names) = 0;
 
+  // Called by VisitCloudObjects with the name of each object, relative to the
+  // listed object path. Returning false stops the listing.
+  using CloudObjectVisitor = std::function<bool(const std::string& name)>;
+
+  // Like ListCloudObjects, but hands the objects to the visitor as they are
+  // listed instead of returning them all at once. The sorted boundaries split
+  // the names into the partitions (-inf, b0], (b0, b1], ..., (bn, +inf),
+  // which may be listed concurrently, in which case objects are not visited
+  // in order. The visitor is never called concurrently. The default
+  // implementation ignores the boundaries and visits the result of
+  // ListCloudObjects.
+  virtual IOStatus VisitCloudObjects(const std::string& bucket_name,
+                                     const std::string& object_path,
+                                     const std::vector<std::string>& boundaries,
+                                     const CloudObjectVisitor& visitor);
+
   // Does the specified object exist in the cloud storage
   virtual IOStatus ExistsCloudObject(const std::string& bucket_name,
                                      const std::string& object_path) = 0;
@@ -112,6 +142,45 @@ class CloudStorageProvider : public Configurable {
                                   const std::string& bucket_name,
                                   const std::string& object_path) = 0;
 
+  // Uploads object to the cloud along with crc32c, the checksum of the local
+  // file in the format of CloudObjectInformation::crc32c. The cloud
+  // verifies it on receipt and keeps it with the object. Providers that do
+  // not support checksums upload the object without it.
+  virtual IOStatus PutCloudObjectWithChecksum(const std::string& local_path,
+                                              const std::string& bucket_name,
+                                              const std::string& object_path,
+                                              const std::string& /*crc32c*/) {
+    return PutCloudObject(local_path, bucket_name, object_path);
+  }
+
+  // Multipart uploads, used to stream SST files to the cloud while they are
+  // being written. Parts are numbered from 1 and UploadPart() returns an id
+  // for each part, which CompleteMultipartUpload() takes in part order.
+  // Providers that do not support them return NotSupported.
+  virtual IOStatus CreateMultipartUpload(const std::string& /*bucket_name*/,
+                                         const std::string& /*object_path*/,
+                                         std::string* /*upload_id*/) {
+    return IOStatus::NotSupported("CreateMultipartUpload");
+  }
+  virtual IOStatus UploadPart(const std::string& /*bucket_name*/,
+                              const std::string& /*object_path*/,
+                              const std::string& /*upload_id*/,
+                              int /*part_number*/, const Slice& /*data*/,
+                              std::string* /*part_id*/) {
+    return IOStatus::NotSupported("UploadPart");
+  }
+  virtual IOStatus CompleteMultipartUpload(
+      const std::string& /*bucket_name*/, const std::string& /*object_path*/,
+      const std::string& /*upload_id*/,
+      const std::vector<std::string>& /*part_ids*/) {
+    return IOStatus::NotSupported("CompleteMultipartUpload");
+  }
+  virtual IOStatus AbortMultipartUpload(const std::string& /*bucket_name*/,
+                                        const std::string& /*object_path*/,
+                                        const std::string& /*upload_id*/) {
+    return IOStatus::NotSupported("AbortMultipartUpload");
+  }
+
   // Updates/Sets the metadata of the object in cloud storage
   virtual IOStatus PutCloudObjectMetadata(
       const std::string& bucket_name, const std::string& object_path,
@@ -3,13 +3,29 @@
 #pragma once
 
 #include "rocksdb/cloud/cloud_storage_provider.h"
+#include "rocksdb/cloud/cloud_file_system.h"
+#include <atomic>
+#include <condition_variable>
+#include <list>
+#include <mutex>
 #include <optional>
+#include <unordered_map>
 
 namespace ROCKSDB_NAMESPACE {
+class CloudChunkCache;
+class CloudCompactionPrefetcher;
+class CloudFileSystemOptions;
+class CloudRateLimiter;
+class CloudReadHedger;
+
 class CloudStorageReadableFileImpl : public CloudStorageReadableFile {
  public:
-  CloudStorageReadableFileImpl(Logger* info_log, const std::string& bucket,
-                               const std::string& fname, uint64_t size);
+  // If cloud_fs_options is nullptr, MultiRead() only coalesces adjacent
+  // ranges and issues the cloud reads serially.
+  CloudStorageReadableFileImpl(
+      Logger* info_log, const std::string& bucket, const std::string& fname,
+      uint64_t size, const CloudFileSystemOptions* cloud_fs_options = nullptr);
+  ~CloudStorageReadableFileImpl() override;
   // sequential access, read data at current offset in file
   IOStatus Read(size_t n, const IOOptions& options, Slice* result,
                 char* scratch, IODebugContext* dbg) override;
@@ -19,19 +35,113 @@ class CloudStorageReadableFileImpl : public CloudStorageReadableFile {
                 Slice* result, char* scratch,
                 IODebugContext* dbg) const override;
 
+  // Batched random access. Requests whose ranges are at most
+  // multi_read_coalesce_gap_bytes apart are merged into a single cloud read,
+  // and the merged reads are issued concurrently.
+  IOStatus MultiRead(FSReadRequest* reqs, size_t num_reqs,
+                     const IOOptions& options, IODebugContext* dbg) override;
+
+  // Submits the read to a process-wide cloud I/O executor and returns
+  // immediately. The callback is invoked from PollAsyncReads(), i.e. from
+  // CloudFileSystem::Poll(), on the polling thread. Falls back to a
+  // synchronous read if async_read_threads is zero.
+  IOStatus ReadAsync(FSReadRequest& req, const IOOptions& opts,
+                     std::function<void(FSReadRequest&, void*)> cb,
+                     void* cb_arg, void** io_handle, IOHandleDeleter* del_fn,
+                     IODebugContext* dbg) override;
+
+  // Waits for the reads behind io_handles, all of which must have been
+  // returned by ReadAsync(), and invokes their callbacks.
+  static IOStatus PollAsyncReads(std::vector<void*>& io_handles,
+                                 size_t min_completions);
+
+  // Cancels the reads behind io_handles without invoking their callbacks.
+  // Reads that are already in flight are waited for, so that their scratch
+  // buffers can be released once this returns.
+  static IOStatus AbortAsyncReads(std::vector<void*>& io_handles);
+
   IOStatus Skip(uint64_t n) override;
 
+  // The object the file reads.
+  const std::string& bucket() const { return bucket_; }
+  const std::string& object_path() const { return fname_; }
+
  protected:
+  friend class CloudCompactionPrefetcher;
+  friend class CloudStorageProviderImpl;
+
   virtual IOStatus DoCloudRead(uint64_t offset, size_t n,
                                const IOOptions& options, char* scratch,
                                uint64_t* bytes_read,
                                IODebugContext* dbg) const = 0;
+  // Like DoCloudRead(), but the read may give up once *cancelled is set, its
+  // result is then ignored. Used for hedged reads, see
+  // CloudFileSystemOptions::read_hedger.
+  virtual IOStatus DoCancellableCloudRead(
+      uint64_t offset, size_t n, const IOOptions& options, char* scratch,
+      uint64_t* bytes_read, IODebugContext* dbg,
+      const std::atomic<bool>* /*cancelled*/) const {
+    return DoCloudRead(offset, n, options, scratch, bytes_read, dbg);
+  }
+
+  // DoCloudRead() paced by the cloud rate limiter, if any, at the priority
+  // of the read, and hedged if a read hedger is set. Shares the outstanding
+  // read that covers the range, if any, see
+  // CloudFileSystemOptions::share_inflight_reads.
+  IOStatus CloudRead(uint64_t offset, size_t n, const IOOptions& options,
+                     char* scratch, uint64_t* bytes_read,
+                     IODebugContext* dbg) const;
+  IOStatus IssueCloudRead(uint64_t offset, size_t n, const IOOptions& options,
+                          char* scratch, uint64_t* bytes_read,
+                          IODebugContext* dbg) const;
+  IOStatus HedgedCloudRead(uint64_t offset, size_t n, const IOOptions& options,
+                           char* scratch, uint64_t* bytes_read) const;
+  // Waits for the requests that lost a hedged read to finish. Subclasses
+  // whose DoCloudRead() uses their own members must call it in their
+  // destructor.
+  void WaitForHedgedReads() const;
+
+  // Serves [offset, offset + n) from the chunk cache, fetching and caching
+  // the missing chunks with CloudRead().
+  IOStatus ReadThroughChunkCache(uint64_t offset, size_t n,
+                                 const IOOptions& options, char* scratch,
+                                 uint64_t* bytes_read,
+                                 IODebugContext* dbg) const;
 
   Logger* info_log_;
   std::string bucket_;
   std::string fname_;
   uint64_t offset_;
   uint64_t file_size_;
+  uint64_t multi_read_coalesce_gap_bytes_;
+  size_t multi_read_max_parallelism_;
+  int async_read_threads_;
+  bool share_inflight_reads_;
+  // Only set for SST files, which are never modified once uploaded.
+  std::shared_ptr<CloudChunkCache> chunk_cache_;
+  std::shared_ptr<CloudRateLimiter> rate_limiter_;
+  std::shared_ptr<CloudReadHedger> read_hedger_;
+  // Only set for SST files. Serves the reads of compactions.
+  std::shared_ptr<CloudCompactionPrefetcher> compaction_prefetcher_;
+  // Requests of hedged reads still running in the background.
+  mutable std::mutex hedged_reads_mu_;
+  mutable std::condition_variable hedged_reads_cv_;
+  mutable int hedged_reads_inflight_ = 0;
+
+  // A cloud read that the reads of the ranges it covers wait for. The reader
+  // that issued it keeps its scratch until they all copied from it.
+  struct InflightRead {
+    uint64_t offset;
+    size_t n;
+    const char* scratch;
+    bool done = false;
+    IOStatus status;
+    uint64_t bytes_read = 0;
+    int waiters = 0;
+  };
+  mutable std::mutex inflight_reads_mu_;
+  mutable std::condition_variable inflight_reads_cv_;
+  mutable std::list<InflightRead*> inflight_reads_;
 };
 
 // Appends to a file in S3.
@@ -47,6 +157,60 @@ class CloudStorageWritableFileImpl : public CloudStorageWritableFile {
   std::string cloud_fname_;
   bool is_manifest_;
 
+  // State of the multipart upload streaming an SST file to the cloud while
+  // it is written, see CloudFileSystemOptions::multipart_upload_part_size.
+  struct MultipartUpload;
+  std::shared_ptr<MultipartUpload> multipart_;
+  // Queues the buffered data as the next part of the upload.
+  void UploadBufferedPart();
+  // Uploads a closed SST file to the cloud: completes its multipart upload,
+  // or uploads it as a whole if it was not streamed, then deletes the local
+  // copy unless SST files are kept locally. Runs in the background when
+  // uploads are deferred, hence it only uses its arguments. pri is the I/O
+  // priority of the file, set by the flush or compaction that wrote it.
+  // crc32c, if not empty, is the checksum the whole-file upload carries.
+  static IOStatus UploadClosedFile(CloudFileSystem* cfs, const char* name,
+                                   const std::string& fname,
+                                   const std::string& bucket,
+                                   const std::string& cloud_fname,
+                                   MultipartUpload* multipart,
+                                   Env::IOPriority pri,
+                                   const std::string& crc32c);
+  // Stops streaming, the file is uploaded as a whole on Close().
+  void DisableMultipartUpload();
+  // Classifies the upload of the file by the flush or compaction that wrote
+  // it, see CloudFileSystemOptions::max_concurrent_uploads.
+  CloudUploadClass GetUploadClass();
+
+  // crc32c of the data appended so far, see
+  // CloudFileSystemOptions::sst_upload_checksums. Dropped once the file is
+  // not written sequentially.
+  bool upload_checksum_ = false;
+  uint32_t upload_crc32c_ = 0;
+  uint64_t upload_crc32c_size_ = 0;
+  // Extends the checksum with data, reusing the handoff checksum of data
+  // when RocksDB passed one.
+  void ExtendUploadChecksum(const Slice& data, const Slice& handoff);
+  // Returns the checksum in the format of CloudObjectInformation::crc32c,
+  // or an empty string if the upload carries none.
+  std::string GetUploadChecksum() const;
+
+  // MANIFEST delta uploads, see CloudFileSystemOptions::manifest_delta_uploads.
+  bool manifest_deltas_enabled_ = false;
+  // Data appended since the last upload.
+  std::string manifest_pending_;
+  // Size and crc32c of the MANIFEST data in the cloud, valid once the whole
+  // MANIFEST was uploaded.
+  bool manifest_uploaded_ = false;
+  uint64_t manifest_uploaded_size_ = 0;
+  uint32_t manifest_uploaded_crc_ = 0;
+  // Deltas uploaded since the last full upload.
+  std::vector<std::string> manifest_deltas_;
+  // Uploads the data synced so far, as a delta when possible.
+  IOStatus UploadManifest();
+  // Deletes the deltas that a full upload of the MANIFEST made obsolete.
+  void DeleteManifestDeltas();
+
  public:
   CloudStorageWritableFileImpl(CloudFileSystem* fs,
                                const std::string& local_fname,
@@ -57,22 +221,26 @@ class CloudStorageWritableFileImpl : public CloudStorageWritableFile {
   virtual ~CloudStorageWritableFileImpl();
   using CloudStorageWritableFile::Append;
   IOStatus Append(const Slice& data, const IOOptions& opts,
-                  IODebugContext* dbg) override {
-    assert(status_.ok());
-    // write to temporary file
-    return local_file_->Append(data, opts, dbg);
-  }
+                  IODebugContext* dbg) override;
+  // The checksum of data, if any, feeds the upload checksum.
+  IOStatus Append(const Slice& data, const IOOptions& opts,
+                  const DataVerificationInfo& verification_info,
+                  IODebugContext* dbg) override;
 
   using CloudStorageWritableFile::PositionedAppend;
   IOStatus PositionedAppend(const Slice& data, uint64_t offset,
                             const IOOptions& opts,
                             IODebugContext* dbg) override {
+    if (multipart_) {
+      DisableMultipartUpload();
+    }
+    upload_checksum_ = false;
+    // Deltas only carry appended data.
+    manifest_deltas_enabled_ = false;
     return local_file_->PositionedAppend(data, offset, opts, dbg);
   }
   IOStatus Truncate(uint64_t size, const IOOptions& opts,
-                    IODebugContext* dbg) override {
-    return local_file_->Truncate(size, opts, dbg);
-  }
+                    IODebugContext* dbg) override;
   IOStatus Fsync(const IOOptions& opts, IODebugContext* dbg) override {
     return local_file_->Fsync(opts, dbg);
   }
@@ -118,6 +286,17 @@ class CloudStorageProviderImpl : public CloudStorageProvider {
  public:
   static Status CreateS3Provider(std::unique_ptr<CloudStorageProvider>* result);
   static const char* kS3() { return "s3"; }
+  // An S3 provider that downloads and uploads whole objects with the AWS CRT
+  // S3 client. Requires a build with USE_AWS_CRT.
+  static Status CreateS3CrtProvider(
+      std::unique_ptr<CloudStorageProvider>* result);
+  static const char* kS3Crt() { return "s3-crt"; }
+  // A provider backed by a local directory or by memory that simulates the
+  // latency, bandwidth, throttling and cost of a cloud object store, see
+  // SimulatedStorageProvider.
+  static Status CreateSimulatedProvider(
+      std::unique_ptr<CloudStorageProvider>* result);
+  static const char* kSimulated() { return "simulated"; }
 
   CloudStorageProviderImpl();
   virtual ~CloudStorageProviderImpl();
@@ -127,15 +306,64 @@ class CloudStorageProviderImpl : public CloudStorageProvider {
   IOStatus PutCloudObject(const std::string& local_file,
                           const std::string& bucket_name,
                           const std::string& object_path) override;
+  IOStatus PutCloudObjectWithChecksum(const std::string& local_file,
+                                      const std::string& bucket_name,
+                                      const std::string& object_path,
+                                      const std::string& crc32c) override;
   IOStatus NewCloudReadableFile(
       const std::string& bucket, const std::string& fname,
       const FileOptions& options,
       std::unique_ptr<CloudStorageReadableFile>* result,
       IODebugContext* dbg) override;
+  // The metadata requests are served from the cache of the metadata of SST
+  // objects when they can, see
+  // CloudFileSystemOptions::object_metadata_cache_entries.
+  IOStatus ExistsCloudObject(const std::string& bucket_name,
+                             const std::string& object_path) override;
+  IOStatus GetCloudObjectSize(const std::string& bucket_name,
+                              const std::string& object_path,
+                              uint64_t* filesize) override;
+  IOStatus GetCloudObjectModificationTime(const std::string& bucket_name,
+                                          const std::string& object_path,
+                                          uint64_t* time) override;
+  IOStatus GetCloudObjectMetadata(const std::string& bucket_name,
+                                  const std::string& object_path,
+                                  CloudObjectInformation* info) override;
+  // The mutations drop the objects they change from the metadata cache.
+  IOStatus DeleteCloudObject(const std::string& bucket_name,
+                             const std::string& object_path) override;
+  IOStatus DeleteCloudObjects(
+      const std::string& bucket_name,
+      const std::vector<std::string>& object_paths) override;
+  IOStatus CopyCloudObject(const std::string& bucket_name_src,
+                           const std::string& object_path_src,
+                           const std::string& bucket_name_dest,
+                           const std::string& object_path_dest) override;
+  IOStatus PutCloudObjectMetadata(
+      const std::string& bucket_name, const std::string& object_path,
+      const std::unordered_map<std::string, std::string>& metadata) override;
+  IOStatus CompleteMultipartUpload(
+      const std::string& bucket_name, const std::string& object_path,
+      const std::string& upload_id,
+      const std::vector<std::string>& part_ids) override;
+  // Lists the partitions concurrently on a shared executor.
+  IOStatus VisitCloudObjects(const std::string& bucket_name,
+                             const std::string& object_path,
+                             const std::vector<std::string>& boundaries,
+                             const CloudObjectVisitor& visitor) override;
   Status PrepareOptions(const ConfigOptions& options) override;
 
  protected:
   std::unique_ptr<Random64> rng_;
+  // Visits the objects under object_path whose names are in the range
+  // (start_after, last], where an empty bound is unbounded. The default
+  // implementation filters the result of ListCloudObjects; providers that
+  // can start a listing at a given key should override it.
+  virtual IOStatus DoVisitCloudObjects(const std::string& bucket_name,
+                                       const std::string& object_path,
+                                       const std::string& start_after,
+                                       const std::string& last,
+                                       const CloudObjectVisitor& visitor);
   virtual IOStatus DoNewCloudReadableFile(
       const std::string& bucket, const std::string& fname, uint64_t fsize,
       const std::string& content_hash, const FileOptions& options,
@@ -147,12 +375,97 @@ class CloudStorageProviderImpl : public CloudStorageProvider {
                                     const std::string& object_path,
                                     const std::string& local_path,
                                     uint64_t* remote_size) = 0;
+  // crc32c is empty when the upload carries no checksum.
   virtual IOStatus DoPutCloudObject(const std::string& local_file,
-                                    const std::string& object_path,
                                     const std::string& bucket_name,
-                                    uint64_t file_size) = 0;
+                                    const std::string& object_path,
+                                    uint64_t file_size,
+                                    const std::string& crc32c) = 0;
+
+  // Retrieves the size, modification time, content hash and metadata of an
+  // object with a HEAD request.
+  virtual IOStatus DoGetCloudObjectMetadata(const std::string& bucket_name,
+                                            const std::string& object_path,
+                                            CloudObjectInformation* info) = 0;
+  virtual IOStatus DoDeleteCloudObject(const std::string& bucket_name,
+                                       const std::string& object_path) = 0;
+  // The default implementation deletes the objects one at a time.
+  virtual IOStatus DoDeleteCloudObjects(
+      const std::string& bucket_name,
+      const std::vector<std::string>& object_paths);
+  virtual IOStatus DoCopyCloudObject(const std::string& bucket_name_src,
+                                     const std::string& object_path_src,
+                                     const std::string& bucket_name_dest,
+                                     const std::string& object_path_dest) = 0;
+  virtual IOStatus DoPutCloudObjectMetadata(
+      const std::string& bucket_name, const std::string& object_path,
+      const std::unordered_map<std::string, std::string>& metadata) = 0;
+  virtual IOStatus DoCompleteMultipartUpload(
+      const std::string& bucket_name, const std::string& object_path,
+      const std::string& upload_id,
+      const std::vector<std::string>& part_ids) = 0;
+
+  // The fields of CloudObjectInformation known for a cached object.
+  enum CachedFields : uint32_t {
+    kCachedSize = 0x1,
+    kCachedModificationTime = 0x2,
+    kCachedContentHash = 0x4,
+    kCachedMetadata = 0x8,
+    kCachedAll = 0xf,
+  };
+  // Records the fields of info of the object in the metadata cache, if it is
+  // an SST object and the cache is enabled. Providers call it for the
+  // objects they list.
+  void CacheObjectMetadata(const std::string& bucket_name,
+                           const std::string& object_path, uint32_t fields,
+                           const CloudObjectInformation& info);
 
   CloudFileSystem* cfs_;
   Status status_;
+
+ private:
+  // GetCloudObject() without sharing the downloads in flight.
+  IOStatus DownloadCloudObject(const std::string& bucket_name,
+                               const std::string& object_path,
+                               const std::string& local_destination);
+  // Downloads the object described by info into local_path with concurrent
+  // ranged reads, see CloudFileSystemOptions::parallel_download_part_size.
+  IOStatus ParallelGetCloudObject(const std::string& bucket_name,
+                                  const std::string& object_path,
+                                  const std::string& local_path,
+                                  const CloudObjectInformation& info);
+
+  struct CachedObject {
+    uint32_t fields = 0;
+    CloudObjectInformation info;
+    // Position in metadata_lru_.
+    std::list<std::string>::iterator lru;
+  };
+
+  // Returns true and sets info if the cache knows all of fields of the
+  // object.
+  bool LookupObjectMetadata(const std::string& bucket_name,
+                            const std::string& object_path, uint32_t fields,
+                            CloudObjectInformation* info);
+  void EraseObjectMetadata(const std::string& bucket_name,
+                           const std::string& object_path);
+  uint64_t MetadataCacheCapacity() const;
+
+  std::mutex metadata_mutex_;
+  // Keyed by bucket and object path, the most recently used objects first
+  // in metadata_lru_.
+  std::unordered_map<std::string, CachedObject> metadata_cache_;
+  std::list<std::string> metadata_lru_;
+
+  // The downloads in flight, keyed by object and local destination, see
+  // CloudFileSystemOptions::share_inflight_reads.
+  struct InflightDownload {
+    bool done = false;
+    IOStatus status;
+  };
+  std::mutex inflight_downloads_mutex_;
+  std::condition_variable inflight_downloads_cv_;
+  std::unordered_map<std::string, std::shared_ptr<InflightDownload>>
+      inflight_downloads_;
 };
 }  // namespace ROCKSDB_NAMESPACE
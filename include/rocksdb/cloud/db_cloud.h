@@ -55,6 +55,73 @@ class DBCloud : public StackableDB {
   virtual Status CheckpointToCloud(const BucketOptions& destination,
                                    const CheckpointToCloudOptions& options) = 0;
 
+  // Dumps the entries of the block cache of the default column family that
+  // belong to the DB to the BLOCKCACHE object of the destination bucket,
+  // replacing the previous dump, see utilities/cache_dump_load.h. A DB opened
+  // with CloudFileSystemOptions::block_cache_load_target set loads it.
+  virtual Status DumpBlockCacheToCloud() = 0;
+
+  // Makes a new backup of the DB under the object path of destination and
+  // returns its id, which increases with every backup, in backup_id. The
+  // backups share their SST files: those that an earlier backup holds are
+  // not transferred again, and the others are copied server-side from the
+  // cloud storage of the DB when it holds them. Only the MANIFEST, the
+  // CLOUDMANIFEST and the live WAL files are uploaded with every backup.
+  // Backups are not deleted automatically.
+  virtual Status BackupToCloud(const BucketOptions& destination,
+                               const CloudBackupOptions& options,
+                               uint64_t* backup_id) = 0;
+
+  // Exports the SST files of the column family, like
+  // Checkpoint::ExportColumnFamily(), to objects under the object path of
+  // destination instead of a local directory, so that another cloud DB can
+  // take the column family over without the data passing through either
+  // node. The files are copied server-side from the cloud storage of the DB,
+  // and only uploaded if it does not hold them. The db_path of the files in
+  // metadata is the cloud://<bucket>/<object path> URI of destination, see
+  // CloudFileSystem::kCloudObjectUriPrefix(). CreateColumnFamilyWithImport()
+  // of a DB whose CloudFileSystem has a destination bucket and the same
+  // storage provider then copies each object server-side into that bucket,
+  // and deletes it once imported. ImportColumnFamilyOptions::move_files must
+  // be set: the objects are not downloaded. The caller owns *metadata.
+  virtual Status ExportColumnFamilyToCloud(
+      ColumnFamilyHandle* handle, const BucketOptions& destination,
+      const ExportColumnFamilyToCloudOptions& options,
+      ExportImportFilesMetaData** metadata) = 0;
+
+  // Restores the backup backup_id under the object path of source, see
+  // BackupToCloud(), as a new DB with a new dbid, like a clone. Its files
+  // are copied server-side to the destination bucket of the CloudFileSystem
+  // of env, and the files that the DB reads locally on open, the WAL files
+  // among them, are downloaded to local_dbname. DBCloud::Open() of
+  // local_dbname with env then opens the restored DB.
+  static Status RestoreFromCloudBackup(Env* env, const BucketOptions& source,
+                                       uint64_t backup_id,
+                                       const std::string& local_dbname);
+
+  // Opens a new replication follower of a leader from the cloud storage of
+  // the leader, the src bucket of the CloudFileSystem of options.env, instead
+  // of replaying the whole replication log. The src bucket is usually the
+  // dest bucket of the leader, which holds all its live files once
+  // Savepoint() ran on a leader cloned from another bucket. It needs to hold
+  // the SST files that the leader writes later too, which a destination of
+  // CheckpointToCloud() only does if it is the one the leader writes to.
+  //
+  // All the column families of the source are opened with the options,
+  // without auto compactions and flushes and without a replication log
+  // listener, and handles holds them in the order of ListColumnFamilies().
+  // replication_sequence is the replication sequence that the opened
+  // MANIFEST persisted, see DB::GetPersistedReplicationSequence(): the
+  // follower tails the replication log with ApplyReplicationLogRecord() from
+  // the record after it. It is empty if the leader never persisted one, in
+  // which case the whole log needs to be applied.
+  static Status OpenFollowerFromCloud(
+      const Options& options, const std::string& local_dbname,
+      const std::string& persistent_cache_path,
+      const uint64_t persistent_cache_size_gb,
+      std::vector<ColumnFamilyHandle*>* handles, DBCloud** dbptr,
+      std::string* replication_sequence);
+
   // ListColumnFamilies will open the DB specified by argument name
   // and return the list of all column families in that DB
   // through column_families argument. The ordering of
@@ -63,6 +130,22 @@ class DBCloud : public StackableDB {
                                    const std::string& name,
                                    std::vector<std::string>* column_families);
 
+  // Runs, on a remote compaction worker, a compaction that the
+  // CompactionService of a cloud DB scheduled, like DB::OpenAndCompact().
+  // override_options.env is a cloud env whose src bucket is the dest bucket
+  // of the DB, with no dest bucket and with resync_on_open set, so that the
+  // compaction reads the latest MANIFEST. The input files are read from the
+  // cloud and the output files are uploaded to output_object_path in the
+  // same bucket, which output points the DB to: it installs them with a copy
+  // in the cloud, without transferring them. local_dbname is a local
+  // directory of the worker, which compactions running concurrently must
+  // not share, nor their envs.
+  static Status OpenAndCompact(
+      const OpenAndCompactOptions& options, const std::string& local_dbname,
+      const std::string& output_object_path, const std::string& input,
+      std::string* output,
+      const CompactionServiceOptionsOverride& override_options);
+
   virtual ~DBCloud() {}
 
  protected:
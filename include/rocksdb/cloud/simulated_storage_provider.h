@@ -0,0 +1,257 @@
+//  Copyright (c) 2016-present, Rockset, Inc.  All rights reserved.
+
+#pragma once
+#include <atomic>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <random>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "rocksdb/cloud/cloud_file_system.h"
+#include "rocksdb/cloud/cloud_storage_provider_impl.h"
+
+namespace ROCKSDB_NAMESPACE {
+
+struct SimulatedStorageOptions {
+  // Directory holding the objects, one subdirectory per bucket, on the local
+  // file system. The objects are kept in memory if empty. The metadata of
+  // the objects is only kept in memory.
+  //
+  // Default: ""
+  std::string root_dir;
+
+  // Latency of each request, by kind of request: a fixed part plus an
+  // exponentially distributed part of the given mean. Metadata requests are
+  // all the requests that neither read nor write objects: listings,
+  // deletions, copies, bucket and object information requests.
+  //
+  // Default: 0
+  uint64_t read_latency_micros = 0;
+  uint64_t read_latency_jitter_micros = 0;
+  uint64_t write_latency_micros = 0;
+  uint64_t write_latency_jitter_micros = 0;
+  uint64_t metadata_latency_micros = 0;
+  uint64_t metadata_latency_jitter_micros = 0;
+
+  // The latency of a request is multiplied by tail_latency_multiplier with
+  // this probability.
+  //
+  // Default: 0
+  double tail_latency_probability = 0;
+  // Default: 10
+  double tail_latency_multiplier = 10;
+
+  // Bandwidth shared by all the downloads, respectively uploads, of the
+  // provider. 0 means unlimited.
+  //
+  // Default: 0
+  uint64_t download_bytes_per_sec = 0;
+  uint64_t upload_bytes_per_sec = 0;
+
+  // Probability that the storage throttles a request. Like the AWS SDK does,
+  // a throttled request is retried after an exponential backoff starting at
+  // throttle_backoff_micros, and fails with IOStatus::Busy() once it was
+  // retried throttle_max_retries times.
+  //
+  // Default: 0
+  double throttle_probability = 0;
+  // Default: 25ms
+  uint64_t throttle_backoff_micros = 25 * 1000;
+  // Default: 10
+  int throttle_max_retries = 10;
+
+  // Prices of the requests in dollars per 1000 requests, and of the
+  // transfers in dollars per GB, used to account for the cost of the
+  // requests. Writes, copies, listings and bucket creations are charged
+  // write_request_price, reads and information requests read_request_price,
+  // and deletions are free. The defaults are the prices of S3 Standard, with
+  // free transfers within a region.
+  //
+  // Default: 0.005
+  double write_request_price = 0.005;
+  // Default: 0.0004
+  double read_request_price = 0.0004;
+  // Default: 0
+  double transfer_price_per_gb = 0;
+
+  // Seed of the latencies and of the throttling, so that runs can be
+  // reproduced.
+  //
+  // Default: 0
+  uint32_t seed = 0;
+};
+
+// Requests served by a SimulatedStorageProvider. Throttled attempts are
+// only counted in throttled_requests.
+struct SimulatedStorageStats {
+  uint64_t read_requests = 0;
+  uint64_t write_requests = 0;
+  uint64_t list_requests = 0;
+  uint64_t create_requests = 0;
+  uint64_t delete_requests = 0;
+  uint64_t copy_requests = 0;
+  uint64_t info_requests = 0;
+  uint64_t throttled_requests = 0;
+  uint64_t bytes_read = 0;
+  uint64_t bytes_written = 0;
+  // Dollars, see SimulatedStorageOptions::write_request_price.
+  double cost = 0;
+
+  std::string ToString() const;
+};
+
+// A CloudStorageProvider backed by a local directory or by memory, that
+// simulates the latency, bandwidth, throttling and cost of a cloud object
+// store, so that the cloud paths can be benchmarked and tested without a
+// bucket or credentials. It is registered as "simulated" and its options can
+// be set from a string, e.g.
+// "provider={id=simulated;read_latency_micros=20000;throttle_probability=0.01}"
+// in the options of a cloud file system.
+class SimulatedStorageProvider : public CloudStorageProviderImpl {
+ public:
+  explicit SimulatedStorageProvider(
+      const SimulatedStorageOptions& options = SimulatedStorageOptions());
+  ~SimulatedStorageProvider() override;
+
+  static const char* kClassName() { return kSimulated(); }
+  const char* Name() const override { return kClassName(); }
+
+  IOStatus CreateBucket(const std::string& bucket_name) override;
+  IOStatus ExistsBucket(const std::string& bucket_name) override;
+  IOStatus EmptyBucket(const std::string& bucket_name,
+                       const std::string& object_path) override;
+  IOStatus ListCloudObjects(const std::string& bucket_name,
+                            const std::string& object_path,
+                            std::vector<std::string>* result) override;
+  IOStatus CreateMultipartUpload(const std::string& bucket_name,
+                                 const std::string& object_path,
+                                 std::string* upload_id) override;
+  IOStatus UploadPart(const std::string& bucket_name,
+                      const std::string& object_path,
+                      const std::string& upload_id, int part_number,
+                      const Slice& data, std::string* part_id) override;
+  IOStatus AbortMultipartUpload(const std::string& bucket_name,
+                                const std::string& object_path,
+                                const std::string& upload_id) override;
+  IOStatus NewCloudWritableFile(
+      const std::string& local_path, const std::string& bucket_name,
+      const std::string& object_path, const FileOptions& options,
+      std::unique_ptr<CloudStorageWritableFile>* result,
+      IODebugContext* dbg) override;
+  Status PrepareOptions(const ConfigOptions& options) override;
+
+  // The requests served since the provider was created or ResetStats() was
+  // last called.
+  SimulatedStorageStats GetStats() const;
+  void ResetStats();
+
+  // Serves a request of type transferring bytes bytes with op, after the
+  // simulated latency, throttling and bandwidth, and accounts for it.
+  IOStatus Request(CloudRequestOpType type, uint64_t bytes,
+                   const std::function<IOStatus()>& op) const;
+
+ protected:
+  IOStatus DoGetCloudObjectMetadata(const std::string& bucket_name,
+                                    const std::string& object_path,
+                                    CloudObjectInformation* info) override;
+  IOStatus DoDeleteCloudObject(const std::string& bucket_name,
+                               const std::string& object_path) override;
+  // Deletes up to 1000 objects per request, like S3 does.
+  IOStatus DoDeleteCloudObjects(
+      const std::string& bucket_name,
+      const std::vector<std::string>& object_paths) override;
+  IOStatus DoCopyCloudObject(const std::string& src_bucket_name,
+                             const std::string& src_object_path,
+                             const std::string& dest_bucket_name,
+                             const std::string& dest_object_path) override;
+  IOStatus DoPutCloudObjectMetadata(
+      const std::string& bucket_name, const std::string& object_path,
+      const std::unordered_map<std::string, std::string>& metadata) override;
+  IOStatus DoCompleteMultipartUpload(
+      const std::string& bucket_name, const std::string& object_path,
+      const std::string& upload_id,
+      const std::vector<std::string>& part_ids) override;
+  IOStatus DoNewCloudReadableFile(
+      const std::string& bucket, const std::string& fname, uint64_t fsize,
+      const std::string& content_hash, const FileOptions& options,
+      std::unique_ptr<CloudStorageReadableFile>* result,
+      IODebugContext* dbg) override;
+  IOStatus DoGetCloudObject(const std::string& bucket_name,
+                            const std::string& object_path,
+                            const std::string& local_path,
+                            uint64_t* remote_size) override;
+  // Like S3, rejects an upload whose crc32c does not match its data.
+  IOStatus DoPutCloudObject(const std::string& local_file,
+                            const std::string& bucket_name,
+                            const std::string& object_path, uint64_t file_size,
+                            const std::string& crc32c) override;
+  IOStatus DoVisitCloudObjects(const std::string& bucket_name,
+                               const std::string& object_path,
+                               const std::string& start_after,
+                               const std::string& last,
+                               const CloudObjectVisitor& visitor) override;
+
+ private:
+  struct Object {
+    uint64_t size = 0;
+    uint64_t modification_time = 0;
+    std::string content_hash;
+    std::string crc32c;
+    std::unordered_map<std::string, std::string> metadata;
+  };
+  using Bucket = std::map<std::string, Object>;
+
+  // Waits for the latency of a request of type, retrying it while it is
+  // throttled. Returns Busy if it was throttled more than the retries allow.
+  IOStatus SimulateLatency(CloudRequestOpType type) const;
+  // Blocks until bytes more bytes fit in the bandwidth of the downloads, or
+  // of the uploads.
+  void WaitForBandwidth(bool upload, uint64_t bytes) const;
+  uint64_t SampleLatency(CloudRequestOpType type, bool* throttled) const;
+
+  // Path of the file holding an object.
+  std::string ObjectFile(const std::string& bucket_name,
+                         const std::string& object_path) const;
+  // Writes data as the object, replacing the previous version if any.
+  IOStatus StoreObject(const std::string& bucket_name,
+                       const std::string& object_path, const Slice& data);
+  IOStatus RemoveObject(const std::string& bucket_name,
+                        const std::string& object_path);
+  // Rebuilds the objects of the buckets found under root_dir.
+  IOStatus LoadBuckets();
+  IOStatus LoadObjects(const std::string& bucket_name, const std::string& dir,
+                       const std::string& prefix);
+
+  SimulatedStorageOptions options_;
+  std::shared_ptr<FileSystem> store_;
+  std::string store_root_;
+
+  // Protects buckets_, uploads_ and next_id_.
+  mutable std::mutex mutex_;
+  std::map<std::string, Bucket> buckets_;
+  std::unordered_map<std::string, std::vector<std::string>> uploads_;
+  // Source of the content hashes, upload ids and temporary file names.
+  uint64_t next_id_ = 0;
+
+  mutable std::mutex latency_rng_mutex_;
+  mutable std::mt19937_64 latency_rng_;
+
+  // Times at which the bandwidth of the downloads and of the uploads is
+  // free again.
+  mutable std::mutex bandwidth_mutex_;
+  mutable uint64_t download_free_micros_ = 0;
+  mutable uint64_t upload_free_micros_ = 0;
+
+  static constexpr size_t kNumRequestTypes =
+      static_cast<size_t>(CloudRequestOpType::kInfoOp) + 1;
+  mutable std::atomic<uint64_t> requests_[kNumRequestTypes];
+  mutable std::atomic<uint64_t> throttled_requests_{0};
+  mutable std::atomic<uint64_t> bytes_read_{0};
+  mutable std::atomic<uint64_t> bytes_written_{0};
+};
+
+}  // namespace ROCKSDB_NAMESPACE
@@ -0,0 +1,92 @@
+//  Copyright (c) Meta Platforms, Inc. and affiliates.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+#include "rocksdb/rocksdb_namespace.h"
+
+namespace ROCKSDB_NAMESPACE {
+
+// A CompactionCostModel decides which file of a level leveled compaction
+// picks next, instead of ColumnFamilyOptions::compaction_pri. It is meant for
+// storage where the cost of a compaction is dominated by something else than
+// the bytes it writes, e.g. the requests and the delayed deletions of files
+// in an object store.
+//
+// Exceptions MUST NOT propagate out of overridden functions into RocksDB,
+// because RocksDB is not exception-safe. This could cause undefined behavior
+// including data loss, unreported corruption, deadlocks, and more.
+class CompactionCostModel {
+ public:
+  // A file of `level` that would be compacted into level + 1
+  struct FileCandidate {
+    int level = 0;
+    uint64_t file_size = 0;
+    // The size of the file compensated by its deletions, which stands for
+    // the read amplification compacting it removes
+    uint64_t compensated_file_size = 0;
+    // The files of level + 1 that overlap the file, which the compaction
+    // rewrites and deletes along with it
+    uint64_t overlapping_bytes = 0;
+    size_t num_overlapping_files = 0;
+    // The target size of the output files of the compaction
+    uint64_t target_file_size = 0;
+  };
+
+  virtual ~CompactionCostModel() {}
+
+  virtual const char* Name() const = 0;
+
+  // Returns the cost of compacting `file` per unit of read amplification it
+  // removes. The files of a level are compacted in increasing order of cost,
+  // after the files marked for compaction. Called with the DB mutex held,
+  // so it should be cheap.
+  virtual double FileCost(const FileCandidate& file) const = 0;
+};
+
+// The prices of an object store for NewCloudCompactionCostModel(), in any
+// currency unit. The defaults are those of S3 Standard in dollars.
+struct CloudCompactionCostModelOptions {
+  // Cost of a PUT request, paid once for each output file
+  double put_request_cost = 0.005 / 1000;
+
+  // Cost of a GET request. Compactions of DBs without local copies of their
+  // files read each input file with requests of `get_request_size` bytes.
+  double get_request_cost = 0.0004 / 1000;
+  uint64_t get_request_size = 0;
+
+  // Cost of deleting an input file
+  double delete_request_cost = 0;
+
+  // Cost of uploading a byte
+  double upload_cost_per_byte = 0;
+
+  // Cost of storing a byte for a second, e.g. $0.023 per GB and month
+  double storage_cost_per_byte_second = 0.023 / (1 << 30) / (30 * 86400);
+
+  // How long the input files of a compaction stay billed after it, see
+  // CloudFileSystemOptions::cloud_file_deletion_delay
+  uint64_t file_deletion_delay_seconds = 3600;
+};
+
+// Returns a cost model that adds up the request, upload and delayed
+// deletion costs of a compaction of each file:
+//   PUTs of ceil((file_size + overlapping_bytes) / target_file_size) outputs
+//   GETs of the inputs, if get_request_size > 0
+//   deletes of the 1 + num_overlapping_files inputs
+//   uploads of the file_size + overlapping_bytes output bytes
+//   storage of the input bytes for file_deletion_delay_seconds
+// and divides it by compensated_file_size. Next to kMinOverlappingRatio, it
+// favors large files and files overlapping few files of the next level, as
+// each file costs requests of its own.
+std::shared_ptr<CompactionCostModel> NewCloudCompactionCostModel(
+    const CloudCompactionCostModelOptions& options =
+        CloudCompactionCostModelOptions());
+
+}  // namespace ROCKSDB_NAMESPACE
@@ -16,6 +16,7 @@
 
 #include "rocksdb/customizable.h"
 #include "rocksdb/rocksdb_namespace.h"
+#include "rocksdb/slice.h"
 #include "rocksdb/table_properties.h"
 #include "rocksdb/types.h"
 #include "rocksdb/wide_columns.h"
@@ -300,6 +301,40 @@ class CompactionFilter : public Customizable {
                     skip_until);
   }
 
+  // A plain key-value passed to FilterBatch()
+  struct BatchEntry {
+    Slice key;
+    ValueType value_type = ValueType::kValue;
+    Slice existing_value;
+  };
+
+  // Returns the maximum number of entries passed to FilterBatch() at once.
+  // The default of 0 disables FilterBatch().
+  virtual size_t GetFilterBatchSize() const { return 0; }
+
+  // Batch API for plain values, for filters whose per-key overhead matters,
+  // e.g. because they look up the current time or a schema for each key.
+  // When GetFilterBatchSize() returns a positive size, the table file
+  // creation reads ahead up to that many input entries and passes the ones
+  // FilterV3() would be called for as plain values, i.e. the newest Put() of
+  // each user key, to this method in key order. `decisions` and `new_values`
+  // have the size of `entries`, initialized to kUndetermined and empty
+  // strings; (*decisions)[i] receives the decision for entries[i], and
+  // (*new_values)[i] its new value for kChangeValue. The supported decisions
+  // are kKeep, kRemove, kPurge and kChangeValue. kUndetermined causes
+  // FilterV3() to be called for the entry as usual, e.g. to return
+  // kRemoveAndSkipUntil. The decisions of entries that the table file
+  // creation skips afterwards, e.g. after a kRemoveAndSkipUntil, are
+  // discarded, so an entry may be passed more than once.
+  //
+  // Blob values, wide-column entities and merge operands always go through
+  // FilterV3(), as do all keys when user-defined timestamps are enabled or
+  // when a snapshot checker is used, e.g. by WritePrepared transactions.
+  virtual void FilterBatch(int /*level*/,
+                           const std::vector<BatchEntry>& /*entries*/,
+                           std::vector<Decision>* /*decisions*/,
+                           std::vector<std::string>* /*new_values*/) const {}
+
   // Internal (BlobDB) use only. Do not override in application code.
   virtual BlobDecision PrepareBlobOutput(const Slice& /* key */,
                                          const Slice& /* existing_value */,
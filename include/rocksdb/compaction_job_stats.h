@@ -94,6 +94,33 @@ struct CompactionJobStats {
   // Time spent on preparing file write (fallocate, etc)
   uint64_t file_prepare_write_nanos;
 
+  // Time spent on reading the input files.
+  uint64_t file_read_nanos;
+
+  // Time spent on decompressing the input blocks.
+  uint64_t block_decompress_nanos;
+
+  // Time spent on verifying the checksums of the input blocks and on
+  // computing the ones of the output blocks.
+  uint64_t block_checksum_nanos;
+
+  // Time spent on compressing the output blocks, when not done by
+  // CompressionOptions::parallel_threads.
+  uint64_t block_compress_nanos;
+
+  // Time spent in the CompactionFilter.
+  uint64_t compaction_filter_nanos;
+
+  // Time spent in the MergeOperator.
+  uint64_t merge_operator_nanos;
+
+  // Time spent waiting on cloud storage requests, like uploading the output
+  // files.
+  uint64_t cloud_request_nanos;
+
+  // The rest of the time goes mostly to iterating, comparing and
+  // deduplicating the keys in CompactionIterator.
+
   // 0-terminated strings storing the first 8 bytes of the smallest and
   // largest key in the output.
   static const size_t kMaxPrefixLength = 8;
@@ -0,0 +1,70 @@
+//  Copyright (c) Meta Platforms, Inc. and affiliates.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+
+#pragma once
+
+#include <cstddef>
+#include <string>
+
+#include "rocksdb/compression_type.h"
+#include "rocksdb/slice.h"
+#include "rocksdb/status.h"
+
+namespace ROCKSDB_NAMESPACE {
+
+// A hardware implementation of some of the compression formats of the
+// blocks of block-based tables, like Intel QAT or IAA for deflate
+// (kZlibCompression) or zstd, set as DBOptions::compression_accelerator.
+//
+// The software codecs stay the fallback of the accelerator: a block it does
+// not take, for instance because its queue is full, is compressed or
+// uncompressed in software. So the blocks an accelerator compresses must be
+// readable by the software codec of their CompressionType, and the other
+// way around. RocksDB handles the header of the blocks, the uncompressed
+// size, so that the accelerator only sees the stream of the codec:
+//   kZlibCompression        a raw deflate stream with a window of at most
+//                           16KB, the one the software codec reads
+//   kLZ4Compression,        an LZ4 block
+//   kLZ4HCCompression
+//   kZSTD                   a zstd frame
+// Accelerators are not offered the blocks of the other compression types,
+// the blocks compressed with a dictionary, nor those of tables of
+// format_version < 2.
+//
+// The methods are called concurrently from the threads building and reading
+// tables, including the workers of CompressionOptions::parallel_threads, so
+// an accelerator should keep a request of each of them in flight rather
+// than serializing them.
+//
+// Exceptions MUST NOT propagate out of overridden functions into RocksDB,
+// because RocksDB is not exception-safe.
+class CompressionAccelerator {
+ public:
+  virtual ~CompressionAccelerator() {}
+
+  virtual const char* Name() const = 0;
+
+  // Whether the blocks of `type` may be offered to Compress() and
+  // Uncompress()
+  virtual bool Supports(CompressionType type) const = 0;
+
+  // Appends to `*output` the compressed stream of `input`, with the level
+  // and window of `opts`. Returns Status::Busy() if the accelerator has no
+  // room for the request, and any non-OK status if it does not compress it,
+  // in which case the block is compressed in software and `*output` is
+  // restored to its size before the call.
+  virtual Status Compress(CompressionType type, const CompressionOptions& opts,
+                          const Slice& input, std::string* output) = 0;
+
+  // Uncompresses the compressed stream `input` into the `output_size` bytes
+  // at `output`, `output_size` being the uncompressed size recorded in the
+  // block. Returns Status::Busy() if the accelerator has no room for the
+  // request, and any non-OK status if it does not uncompress it, in which
+  // case the block is uncompressed in software.
+  virtual Status Uncompress(CompressionType type, const Slice& input,
+                            char* output, size_t output_size) = 0;
+};
+
+}  // namespace ROCKSDB_NAMESPACE
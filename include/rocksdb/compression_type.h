@@ -175,6 +175,45 @@ struct CompressionOptions {
   // decompression.
   bool checksum = false;
 
+  // EXPERIMENTAL
+  // Block-based tables only. When nonzero, the compression of each data block
+  // is chosen among no compression, a fast compression (LZ4, or Snappy when
+  // LZ4 is not available) and the configured compression type and level,
+  // instead of using the configured compression type for every block.
+  //
+  // The choice is made before compressing the block, from an estimate of its
+  // compressibility computed on a sample of its bytes (their entropy and how
+  // many 4-byte sequences repeat). Each candidate is given an estimated cost
+  // of its stored bytes plus its CPU time, and the cheapest one is used. This
+  // option is the CPU cost of compressing 1KB with LZ4, in stored bytes: a
+  // higher value favors cheaper compressions and leaving blocks uncompressed,
+  // a lower value favors smaller blocks, e.g. when storage or network bytes
+  // are expensive as in cloud storage. Candidates that are not expected to
+  // reach `max_compressed_bytes_per_kb` are never attempted, so that
+  // incompressible blocks cost no compression CPU.
+  //
+  // The compression type of each block is recorded in its trailer, so the
+  // files remain readable by any reader. This option is ignored for the
+  // blocks compressed with a dictionary (see `max_dict_bytes`).
+  uint32_t adaptive_cpu_cost_per_kb = 0;
+
+  // EXPERIMENTAL
+  // Block-based tables only. When true and `max_dict_bytes` is nonzero, the
+  // dictionary is trained in the background, from samples of the data blocks
+  // of all the flushes and compactions of the column family, and the latest
+  // dictionary is used by the new files. The files then compress and write
+  // their data blocks as they are built, with no buffering (see
+  // `max_dict_buffer_bytes`) and no training on the flush or compaction
+  // thread.
+  //
+  // Until the first dictionary is trained, files are built as when this
+  // option is false, and the first such dictionary is used by the next files.
+  // A new dictionary is trained each time the samples reach
+  // `zstd_max_train_bytes` (or `max_dict_bytes` when it is zero), using the
+  // LOW priority thread pool. Each file still stores the dictionary it was
+  // compressed with, so the files remain readable by any reader.
+  bool train_dict_in_background = false;
+
   // A convenience function for setting max_compressed_bytes_per_kb based on a
   // minimum acceptable compression ratio (uncompressed size over compressed
   // size).
@@ -11,6 +11,7 @@
 #include <stdint.h>
 #include <stdio.h>
 
+#include <functional>
 #include <map>
 #include <memory>
 #include <string>
@@ -557,6 +558,23 @@ class DB {
   // Note: consider setting options.sync = true.
   virtual Status Write(const WriteOptions& options, WriteBatch* updates) = 0;
 
+  // Asynchronous version of Write(). Queues updates and returns at once;
+  // callback is later called with the status that Write() would return,
+  // once the write is durable as options requires and visible to reads.
+  // `updates` must stay alive and unmodified until then.
+  //
+  // This lets a single thread keep many writes in flight. A background
+  // thread of the DB writes them in the order they were queued, and merges
+  // consecutive writes with the same options into one write, so that they
+  // share a WAL record and a sync, and succeed or fail together. Callbacks
+  // run one at a time on that thread, so they should return quickly. The
+  // writes still queued when the DB is closed are written before it closes.
+  //
+  // The default implementation writes synchronously with Write() and then
+  // calls callback.
+  virtual void WriteAsync(const WriteOptions& options, WriteBatch* updates,
+                          std::function<void(const Status&)> callback);
+
   // If the column family specified by "column_family" contains an entry for
   // "key", return the corresponding value in "*value". If the entry is a plain
   // key-value, return the value as-is; if it is a wide-column entity, return
@@ -825,6 +843,27 @@ class DB {
              statuses, sorted_input);
   }
 
+  // Asynchronous versions of Get() and of the batched MultiGet() of a single
+  // column family. They queue the lookup and return at once; callback is
+  // later called, once value or values and statuses are filled in, from one
+  // of the DBOptions::async_read_threads threads of the DB. So a thread can
+  // keep many lookups in flight, and with ReadOptions::async_io the blocks
+  // of each lookup are also read concurrently. The arguments, and the
+  // snapshot of options if any, must stay valid until callback is called.
+  // The lookups still queued when the DB is closed are made before it closes.
+  //
+  // The default implementations look up synchronously and then call
+  // callback.
+  virtual void GetAsync(const ReadOptions& options,
+                        ColumnFamilyHandle* column_family, const Slice& key,
+                        PinnableSlice* value,
+                        std::function<void(const Status&)> callback);
+  virtual void MultiGetAsync(const ReadOptions& options,
+                             ColumnFamilyHandle* column_family,
+                             size_t num_keys, const Slice* keys,
+                             PinnableSlice* values, Status* statuses,
+                             std::function<void()> callback);
+
   // Batched MultiGet-like API that returns wide-column entities from a single
   // column family. For any given "key[i]" in "keys" (where 0 <= "i" <
   // "num_keys"), if the column family specified by "column_family" contains an
@@ -1171,6 +1210,16 @@ class DB {
     //      sequence number of oldest unreleased snapshot.
     static const std::string kOldestSnapshotSequence;
 
+    //  "rocksdb.last-applied-replication-sequence" - returns the replication
+    //      sequence of the last record applied by ApplyReplicationLogRecord(),
+    //      hex encoded, or an empty string if none was applied since open.
+    static const std::string kLastAppliedReplicationSequence;
+
+    //  "rocksdb.last-applied-replication-time" - returns number representing
+    //      unix timestamp of the last ApplyReplicationLogRecord() call that
+    //      succeeded, 0 if none did since open.
+    static const std::string kLastAppliedReplicationTime;
+
     //  "rocksdb.num-live-versions" - returns number of live versions. `Version`
     //      is an internal data structure. See version_set.h for details. More
     //      live versions often mean more SST files are held from being deleted,
@@ -1304,6 +1353,22 @@ class DB {
     // "rocksdb.blob-cache-pinned-usage" - returns the memory size for the
     //      entries being pinned in blob cache.
     static const std::string kBlobCachePinnedUsage;
+
+    //  "rocksdb.read-heat-map" - returns the sampled reads of each live SST
+    //      file, ordered by smallest key, with its level, temperature and key
+    //      range. Reads are split into all reads and reads by iterators
+    //      ("seeks"), both cumulative and over the last window of
+    //      stats_dump_period_sec. Also available as a "map" property, keyed
+    //      by file number, with values like "level=1;temperature=0;
+    //      smallest_key=<hex>;largest_key=<hex>;reads=N;seeks=N;
+    //      window_reads=N;window_seeks=N". See also
+    //      SstFileMetaData::num_reads_sampled.
+    static const std::string kReadHeatMap;
+
+    //  "rocksdb.iterators-mem-usage" - returns the approximate memory used
+    //      by the arenas of the live iterators of the DB, also charged to
+    //      DBOptions::iterator_memory_cache when set.
+    static const std::string kIteratorsMemUsage;
   };
 
   // DB implementations export properties about their state via this method.
@@ -1346,6 +1411,7 @@ class DB {
   //  "rocksdb.is-file-deletions-enabled"
   //  "rocksdb.num-snapshots"
   //  "rocksdb.oldest-snapshot-time"
+  //  "rocksdb.last-applied-replication-time"
   //  "rocksdb.num-live-versions"
   //  "rocksdb.current-super-version-number"
   //  "rocksdb.estimate-live-data-size"
@@ -1501,9 +1567,16 @@ class DB {
   // options need to be returned. The function is invoked done outside of the DB
   // mutex.
   //
+  // With AR_CONCURRENT_MEMTABLE_WRITES, large memtable writes are split in
+  // runs of consecutive entries that are inserted in parallel, as the leader
+  // does with allow_concurrent_memtable_write. Memtable switches and manifest
+  // writes are still applied one at a time, in order. It has no effect unless
+  // allow_concurrent_memtable_write is set.
+  //
   // REQUIRES: info needs to be provided, can't be nullptr.
   enum ApplyReplicationLogRecordFlags : unsigned {
     AR_EVICT_OBSOLETE_FILES = 1U << 0,
+    AR_CONCURRENT_MEMTABLE_WRITES = 1U << 1,
   };
   using CFOptionsFactory = std::function<ColumnFamilyOptions(Slice)>;
   virtual Status ApplyReplicationLogRecord(ReplicationLogRecord record,
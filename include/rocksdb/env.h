@@ -95,6 +95,10 @@ struct EnvOptions {
   // If false, fallocate() calls are bypassed
   bool allow_fallocate = true;
 
+  // If true, write through an io_uring when supported. See
+  // DBOptions::use_io_uring_for_writes
+  bool use_io_uring_for_writes = false;
+
   // If true, set the FD_CLOEXEC on open fd.
   bool set_fd_cloexec = true;
 
@@ -142,6 +146,21 @@ struct EnvOptions {
   RateLimiter* rate_limiter = nullptr;
 };
 
+// The CPUs the threads of a thread pool may run on, see
+// Env::SetThreadPoolCpuAffinity()
+struct ThreadPoolCpuAffinity {
+  // The CPUs allowed, among the ones of the process. If empty, all the CPUs
+  // of the process are allowed.
+  std::vector<int> cpus;
+
+  // If not negative, only the CPUs of this NUMA node are allowed
+  int numa_node = -1;
+
+  // The CPUs never allowed, such as the ones reserved for the foreground
+  // threads. Takes precedence over `cpus` and `numa_node`.
+  std::vector<int> isolated_cpus;
+};
+
 // Exceptions MUST NOT propagate out of overridden functions into RocksDB,
 // because RocksDB is not exception-safe. This could cause undefined behavior
 // including data loss, unreported corruption, deadlocks, and more.
@@ -583,6 +602,17 @@ class Env : public Customizable {
   // Lower CPU priority for threads from the specified pool.
   virtual void LowerThreadPoolCPUPriority(Priority /*pool*/ = LOW) {}
 
+  // Restricts the threads from the specified pool to the CPUs of `affinity`,
+  // which each thread applies before running its next job. Returns
+  // InvalidArgument if no CPU is left, such as for an unknown NUMA node.
+  // Currently only supported on Linux.
+  virtual Status SetThreadPoolCpuAffinity(
+      Priority /*pool*/, const ThreadPoolCpuAffinity& /*affinity*/) {
+    return Status::NotSupported(
+        "Env::SetThreadPoolCpuAffinity(Priority, ThreadPoolCpuAffinity) not "
+        "supported");
+  }
+
   // Converts seconds-since-Jan-01-1970 to a printable string
   virtual std::string TimeToString(uint64_t time) = 0;
 
@@ -1624,6 +1654,11 @@ class EnvWrapper : public Env {
     return target_.env->LowerThreadPoolCPUPriority(pool, pri);
   }
 
+  Status SetThreadPoolCpuAffinity(
+      Priority pool, const ThreadPoolCpuAffinity& affinity) override {
+    return target_.env->SetThreadPoolCpuAffinity(pool, affinity);
+  }
+
   std::string TimeToString(uint64_t time) override {
     return target_.env->TimeToString(time);
   }
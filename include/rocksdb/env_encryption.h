@@ -128,6 +128,9 @@ class EncryptionProvider : public Customizable {
   // @param value  The value might be:
   //   - CTR         Create a CTR provider
   //   - CTR://test Create a CTR provider and initialize it for tests.
+  //   - AES_CTR     Create an AES-CTR provider, which requires building
+  //                 with OpenSSL, its key to be added with AddCipher()
+  //   - AES_CTR://test Create an AES-CTR provider with a fixed test key.
   // @param result The new provider object
   // @return OK if the provider was successfully created
   // @return NotFound if an invalid name was specified in the value
@@ -58,6 +58,15 @@ class Iterator : public Cleanable {
   // Target does not contain timestamp.
   virtual void Seek(const Slice& target) = 0;
 
+  // With ReadOptions::async_io, submits the reads of a Seek(target) without
+  // waiting for them. A thread driving several iterators can start the
+  // seeks of all of them before completing any, so that their reads are in
+  // flight at the same time. Leaves the iterator in an unspecified state:
+  // the next call must be Seek(target), which waits for the reads.
+  // `target` must not be the key() of this iterator.
+  // Does nothing by default or without async_io.
+  virtual void StartSeek(const Slice& /*target*/) {}
+
   // Position at the last key in the source that at or before target.
   // The iterator is Valid() after this call iff the source contains
   // an entry that comes at or before target.
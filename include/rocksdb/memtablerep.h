@@ -194,6 +194,15 @@ class MemTableRep {
   virtual void Get(const LookupKey& k, void* callback_args,
                    bool (*callback_func)(void* arg, const char* entry));
 
+  // Like Get() for each of the num_keys keys, with callback_args[i] as the
+  // first parameter of the callbacks for keys[i]. Reps may look the keys up
+  // together, e.g. to overlap their cache misses.
+  //
+  // Default: calls Get() for each key in turn.
+  virtual void MultiGet(size_t num_keys, const LookupKey* const* keys,
+                        void* const* callback_args,
+                        bool (*callback_func)(void* arg, const char* entry));
+
   virtual uint64_t ApproximateNumEntries(const Slice& /*start_ikey*/,
                                          const Slice& /*end_key*/) {
     return 0;
@@ -334,9 +343,18 @@ class MemTableRepFactory : public Customizable {
 //     search from the previously visited record (doing at most 'lookahead'
 //     steps). This is an optimization for the access pattern including many
 //     seeks with consecutive keys.
+//   hash_index_buckets: If non-zero, each memtable also keeps a hash index
+//     of this many buckets from each user key to its newest entry, maintained
+//     on insert. Get() and MultiGet() start from that entry instead of
+//     searching the skip list, taking a cache miss or two instead of
+//     O(log n). Each distinct user key takes 16 more bytes of the memtable,
+//     and each bucket 8 bytes. Lookups of keys that are absent still search
+//     the list, see memtable_whole_key_filtering to skip those. Ignored with
+//     a comparator under which different bytes may compare equal.
 class SkipListFactory : public MemTableRepFactory {
  public:
-  explicit SkipListFactory(size_t lookahead = 0);
+  explicit SkipListFactory(size_t lookahead = 0,
+                           size_t hash_index_buckets = 0);
 
   // Methods for Configurable/Customizable class overrides
   static const char* kClassName() { return "SkipListFactory"; }
@@ -357,6 +375,7 @@ class SkipListFactory : public MemTableRepFactory {
 
  private:
   size_t lookahead_;
+  size_t hash_index_buckets_;
 };
 
 // This creates MemTableReps that are backed by an std::vector. On iteration,
@@ -369,9 +388,18 @@ class SkipListFactory : public MemTableRepFactory {
 //     bytes reserved for usage.
 class VectorRepFactory : public MemTableRepFactory {
   size_t count_;
+  size_t parallel_sort_threads_;
 
  public:
-  explicit VectorRepFactory(size_t count = 0);
+  // count: the number of entries to reserve room for in each memtable.
+  // parallel_sort_threads: how many threads of the low-priority pool of
+  // Env::Default() help the thread that first iterates an immutable
+  // memtable, usually the flush, sort a large one. The chunks that the pool
+  // does not get to in time are sorted by the iterating thread itself, so a
+  // pool busy with compactions does not hold the flush up. 0 sorts with
+  // the iterating thread only.
+  explicit VectorRepFactory(size_t count = 0,
+                            size_t parallel_sort_threads = 0);
 
   // Methods for Configurable/Customizable class overrides
   static const char* kClassName() { return "VectorRepFactory"; }
@@ -386,6 +414,33 @@ class VectorRepFactory : public MemTableRepFactory {
                                  Logger* logger) override;
 };
 
+// This creates MemTableReps backed by an adaptive radix tree. A point lookup
+// or an insert visits a few nodes, indexed by the bytes of the key, instead
+// of making O(log n) comparisons through a skip list, and inserts may run
+// concurrently. Each step of an iterator is a lookup from the root, so
+// iteration costs more than with a skip list, and an entry takes more memory,
+// so fewer fit in write_buffer_size. The tree orders keys bytewise:
+// with any other user comparator, or with user-defined timestamps, the
+// memtables fall back to a skip list.
+class ARTRepFactory : public MemTableRepFactory {
+ public:
+  // Methods for Configurable/Customizable class overrides
+  static const char* kClassName() { return "ARTRepFactory"; }
+  static const char* kNickName() { return "art"; }
+  const char* Name() const override { return kClassName(); }
+  const char* NickName() const override { return kNickName(); }
+
+  // Methods for MemTableRepFactory class overrides
+  using MemTableRepFactory::CreateMemTableRep;
+  MemTableRep* CreateMemTableRep(const MemTableRep::KeyComparator&, Allocator*,
+                                 const SliceTransform*,
+                                 Logger* logger) override;
+
+  bool IsInsertConcurrentlySupported() const override { return true; }
+
+  bool CanHandleDuplicatedKey() const override { return true; }
+};
+
 // This class contains a fixed array of buckets, each
 // pointing to a skiplist (null if the bucket is empty).
 // bucket_count: number of fixed array buckets
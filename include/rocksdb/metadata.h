@@ -123,6 +123,13 @@ struct SstFileMetaData : public FileStorageInfo {
   std::string smallestkey;            // Smallest user defined key in the file.
   std::string largestkey;             // Largest user defined key in the file.
   uint64_t num_reads_sampled = 0;     // How many times the file is read.
+  // How many of the reads above are by iterators, as opposed to point
+  // lookups. Every iterator counts as a read of the L0 files it scans.
+  uint64_t num_seeks_sampled = 0;
+  // The reads and seeks in the last complete window of
+  // DBOptions::stats_dump_period_sec, 0 if stats are not dumped.
+  uint64_t num_reads_sampled_last_window = 0;
+  uint64_t num_seeks_sampled_last_window = 0;
   bool being_compacted =
       false;  // true if the file is currently being compacted.
 
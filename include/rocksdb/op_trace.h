@@ -0,0 +1,72 @@
+//  Copyright (c) Meta Platforms, Inc. and affiliates.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "rocksdb/rocksdb_namespace.h"
+
+namespace ROCKSDB_NAMESPACE {
+
+// A step of a traced operation, like a memtable lookup or the read of a
+// block, timed on the thread running the operation.
+struct OpTraceSpan {
+  // A static string naming the step, see OpTrace
+  const char* name = nullptr;
+  // The index in OpTrace::spans of the enclosing span, -1 for the root
+  int parent = -1;
+  // Relative to the start of the operation
+  uint64_t start_nanos = 0;
+  uint64_t duration_nanos = 0;
+  // The number of the file the step works on, 0 if none
+  uint64_t file_number = 0;
+};
+
+// The span tree of a sampled Get(), MultiGet(), Write() or iterator Seek(),
+// exported to DBOptions::op_trace_sink when the operation completes.
+//
+// The root span is named after the operation: "Get", "MultiGet", "Write" or
+// "Seek". Its descendants may be:
+//   "memtable_get"          the lookup in the memtables
+//   "sst_get"               the lookup in the SST files
+//   "table_get"             the lookup in the SST file `file_number`
+//   "filter"                a filter query
+//   "block_cache_lookup"    a block cache lookup, including a secondary
+//                           cache
+//   "block_read"            the read of a block from the file, with its
+//                           decompression
+//   "cloud_get"             the download of an object from cloud storage
+//   "write_group_wait"      the wait of a writer to be done or to lead a
+//                           write group, including the WAL and memtable
+//                           writes a leader does on its behalf
+//   "wal_write"             the write of a write group to the WAL
+//   "wal_sync"              the sync of the WAL
+//   "memtable_insert"       the insert of the batches into the memtables
+// The set of spans may grow. The work done on other threads, like parallel
+// memtable writes or async reads, is not traced.
+struct OpTrace {
+  // In the order they started, so spans[0] is the root
+  std::vector<OpTraceSpan> spans;
+  // The spans beyond the limit on the number of spans of an operation
+  uint64_t num_dropped_spans = 0;
+
+  // One line per span, indented by depth
+  std::string ToString() const;
+};
+
+// Receives the traces of the sampled operations of a DB.
+class OpTraceSink {
+ public:
+  virtual ~OpTraceSink() {}
+
+  // Called on the thread of the operation, right after it completes, so it
+  // should be quick and thread-safe. `trace` is only valid during the call.
+  virtual void Export(const OpTrace& trace) = 0;
+};
+
+}  // namespace ROCKSDB_NAMESPACE
@@ -40,9 +40,12 @@
 
 namespace ROCKSDB_NAMESPACE {
 
+class AutoTuner;
 class Cache;
 class CompactionFilter;
 class CompactionFilterFactory;
+class CompressionAccelerator;
+class CompactionCostModel;
 class Comparator;
 class ConcurrentTaskLimiter;
 class Env;
@@ -51,6 +54,7 @@ class SstFileManager;
 class FilterPolicy;
 class Logger;
 class MergeOperator;
+class OpTraceSink;
 class Snapshot;
 class MemTableRepFactory;
 class RateLimiter;
@@ -335,6 +339,28 @@ struct ColumnFamilyOptions : public AdvancedColumnFamilyOptions {
   // Default: nullptr
   std::shared_ptr<SstPartitionerFactory> sst_partitioner_factory = nullptr;
 
+  // If non-nullptr, leveled compaction picks the files of a level in the
+  // order of their cost under this model, instead of by compaction_pri,
+  // unless compaction_pri is kRoundRobin. See
+  // NewCloudCompactionCostModel() in rocksdb/compaction_cost_model.h for a
+  // model of the request and storage costs of an object store.
+  //
+  // Default: nullptr
+  std::shared_ptr<CompactionCostModel> compaction_cost_model = nullptr;
+
+  // If non-nullptr, the tickers and histograms of the reads, flushes and
+  // compactions of this column family are also recorded here, so that they
+  // can be told apart from those of the other column families, for example
+  // with an object from CreateDBStatistics(). They are still recorded in
+  // DBOptions::statistics. The tickers of writes, which may span column
+  // families, and of MultiGet() are only recorded there.
+  //
+  // Timers are recorded if the stats level of this object or of
+  // DBOptions::statistics, when the column family is opened, allows them.
+  //
+  // Default: nullptr
+  std::shared_ptr<Statistics> column_family_statistics = nullptr;
+
   // Disable automatic flush(exceed `write_buffer_size` limit). Manual flush
   // (including exceeding `db_write_buffer_size` limit) can still be issued
   //
@@ -348,6 +374,20 @@ struct ColumnFamilyOptions : public AdvancedColumnFamilyOptions {
   // Default: false, write stall will be enabled
   bool disable_write_stall = false;
 
+  // If true, writes are slowed down gradually as the column family gets
+  // closer to a write stop, instead of at the fixed slowdown triggers. The
+  // write rate goes down linearly from `delayed_write_rate` as the number of
+  // unflushed memtables, the number of L0 files and the estimated pending
+  // compaction bytes, extrapolated from their last change, approach
+  // `max_write_buffer_number`, `level0_stop_writes_trigger` and
+  // `hard_pending_compaction_bytes_limit`, starting where compactions are
+  // sped up. Writes still stop at the stop triggers. Has no effect when
+  // automatic compactions are disabled.
+  //
+  // Dynamically changeable through SetOptions() API
+  // Default: false
+  bool smooth_write_stall = false;
+
   // RocksDB will try to flush the current memtable after the number of range
   // deletions is >= this limit. For workloads with many range
   // deletions, limiting the number of range deletions in memtable can help
@@ -359,6 +399,31 @@ struct ColumnFamilyOptions : public AdvancedColumnFamilyOptions {
   // Dynamically changeable through SetOptions() API
   uint32_t memtable_max_range_deletions = 0;
 
+  // Marks a file for compaction when the bytes its range tombstones cover in
+  // the levels below, as estimated with ApproximateSize() over the fragmented
+  // tombstones when the file is written, exceed this ratio of its own size.
+  // Compacting the file pushes its tombstones down over the ranges they
+  // cover, reclaiming the covered bytes and the work iterators spend skipping
+  // them. Files of the last non-empty level are never marked.
+  //
+  // Default: 0 (disabled)
+  //
+  // Dynamically changeable through SetOptions() API
+  double range_deletion_compaction_ratio = 0;
+
+  // The maximum number of trivial moves of automatic compactions that are
+  // applied with one MANIFEST write. After picking a trivial move, the
+  // compaction that runs it keeps picking compactions of the column family
+  // while they are trivial moves too, and applies all of them as a single
+  // VersionEdit. This cuts the MANIFEST writes, and the MANIFEST uploads of
+  // cloud DBs, of bulk loads that move many files down levels. Not used with
+  // kRoundRobin compaction priority.
+  //
+  // Default: 0 (each trivial move is applied on its own)
+  //
+  // Dynamically changeable through SetOptions() API
+  uint32_t trivial_move_batch_size = 0;
+
   // Create ColumnFamilyOptions with default values for all fields
   ColumnFamilyOptions();
   // Create ColumnFamilyOptions from Options
@@ -505,8 +570,35 @@ struct ReplicationLogRecord {
   enum Type { kMemtableWrite, kMemtableSwitch, kManifestWrite };
   Type type;
   std::string contents;
+  // Set instead of contents for kMemtableWrite records of a single write
+  // batch, when ReplicationLogListener::AcceptsPinnedContents() returns true.
+  // It points into the writer's WriteBatch and is only valid until
+  // OnReplicationLogRecord() returns. A listener that keeps the record longer
+  // needs to call Own() first.
+  Slice pinned_contents;
+  // Compression of contents, see CompressReplicationLogRecord().
+  CompressionType compression{kNoCompression};
+
+  // The payload of the record, pinned or owned.
+  Slice GetContents() const {
+    return pinned_contents.empty() ? Slice(contents) : pinned_contents;
+  }
+  // Copies the pinned payload, if any, into contents.
+  void Own() {
+    if (!pinned_contents.empty()) {
+      contents.assign(pinned_contents.data(), pinned_contents.size());
+      pinned_contents.clear();
+    }
+  }
 };
 
+// Compresses the payload of the record with the given compression type, for
+// listeners that ship records over the network. Pinned contents are
+// compressed into contents. DB::ApplyReplicationLogRecord() uncompresses the
+// record. Returns NotSupported if the compression type is not available.
+Status CompressReplicationLogRecord(CompressionType type,
+                                    ReplicationLogRecord* record);
+
 // ReplicationLogListener provides a mechanism to implement physical replication
 // in RocksDB. A leader registers the ReplicationLogListener through which it
 // captures the replication events, which are then applied on the follower
@@ -523,9 +615,11 @@ struct ReplicationLogRecord {
 // The support for physical replication is experimental and currently does not
 // support any of the following options:
 // * unordered_write
-// * enable_pipelined_write
-// * two_write_queues
+// * two_write_queues together with seq_per_batch, as WritePrepared and
+//   WriteUnprepared transactions use it
 // * write-ahead logging, i.e. WriteOptions::disableWAL needs to be set to true.
+// With enable_pipelined_write, a write group is replicated by its leader
+// before its memtable writes start.
 // Replication log provides write durability.
 //
 // In addition, atomic_flush needs to be true and any manual Flush() call will
@@ -538,6 +632,9 @@ class ReplicationLogListener {
  public:
   virtual ~ReplicationLogListener() = default;
 
+  // A kMemtableWrite record holds all the writes of a write group, merged
+  // into a single WriteBatch that the follower applies at once.
+  //
   // Important: OnReplicationLogRecord needs to be thread safe. More concretely,
   // kMemtableWrite and kMemtableSwitch will all be issued from the same thread,
   // but might be issued concurrently with kManifestWrite.
@@ -546,6 +643,10 @@ class ReplicationLogListener {
   // the database needs to re-apply all replication log records since
   // DB::GetPersistedReplicationSequence() (non-inclusive).
   virtual std::string OnReplicationLogRecord(ReplicationLogRecord record) = 0;
+
+  // If true, kMemtableWrite records of a single write batch reference the
+  // batch through ReplicationLogRecord::pinned_contents instead of copying it.
+  virtual bool AcceptsPinnedContents() const { return false; }
 };
 
 // TODO(wei): a temporary hack so that we can get epoch from replication_sequence.
@@ -993,6 +1094,21 @@ struct DBOptions {
   // https://github.com/btrfs/btrfs-dev-docs/blob/471c5699336e043114d4bca02adcd57d9dab9c44/data-extent-reference-counts.md
   bool allow_fallocate = true;
 
+  // EXPERIMENTAL
+  // If true, the Posix file system writes WAL, SST and other files through an
+  // io_uring when the platform supports it. The appended data is copied to
+  // staging buffers of the size of `writable_file_max_buffer_size`, which are
+  // written asynchronously once full, so that the writer fills one while the
+  // other is written. A Flush() writes out the staged data and waits for the
+  // writes in flight, so that flushed data is visible to other readers of the
+  // file and survives a process crash, as with blocking writes. A Sync()
+  // submits the data appended since the last Flush() linked with the
+  // fdatasync, in a single syscall. Files reopened for appending are written
+  // with blocking syscalls.
+  //
+  // Default: false
+  bool use_io_uring_for_writes = false;
+
   // Disable child process inherit open files. Default: true
   bool is_fd_close_on_exec = true;
 
@@ -1058,6 +1174,15 @@ struct DBOptions {
   // Default: null
   std::shared_ptr<WriteBufferManager> write_buffer_manager = nullptr;
 
+  // If non-zero, this DB gets a share of write_buffer_manager proportional to
+  // this weight among the DBs sharing it with a non-zero weight. When the
+  // buffer fills up, only the DBs that use more than their share flush first
+  // and are stalled, so that a DB that writes a lot can not starve the
+  // others. A DB may use more than its share while the buffer is not full.
+  //
+  // Default: 0 (all DBs share the buffer first come, first served)
+  uint32_t write_buffer_manager_weight = 0;
+
   // If non-zero, we perform bigger reads when doing compaction. If you're
   // running RocksDB on spinning disks, you should set this to at least 2MB.
   // That way RocksDB's compaction is doing sequential instead of random reads.
@@ -1298,6 +1423,65 @@ struct DBOptions {
   // Default: nullptr (disabled)
   std::shared_ptr<RowCache> row_cache = nullptr;
 
+  // A cache of the results of merging the entries of keys written with
+  // Merge(). A Get() that has to merge operands caches its result together
+  // with the sequence number of the newest entry it merged, and later Get()s
+  // of the key only merge the operands written after it with the cached
+  // result. This helps reads of hot keys which accumulate operands until
+  // compaction folds them.
+  //
+  // Only used by Get() of a plain value without user-defined timestamps,
+  // outside of transactions, into column families without
+  // inplace_update_support.
+  //
+  // Default: nullptr (disabled)
+  std::shared_ptr<RowCache> merge_result_cache = nullptr;
+
+  // If set, one in `op_trace_sample_one_in` Get(), MultiGet(), Write() and
+  // iterator Seek() calls, chosen at random, records the time spent in each
+  // of its steps as a tree of spans, exported to the sink when the call
+  // completes. See rocksdb/op_trace.h. Unlike PerfContext, the operations
+  // which are not sampled only pay for a random number.
+  //
+  // Default: nullptr (disabled)
+  std::shared_ptr<OpTraceSink> op_trace_sink = nullptr;
+
+  // The sampling rate of `op_trace_sink`, 1 to trace all operations. 0
+  // disables the tracing.
+  //
+  // Default: 1000
+  uint32_t op_trace_sample_one_in = 1000;
+
+  // If set, the memory of the live iterators of the DB, the arena holding
+  // the tree of iterators of each of them, is charged to this cache, so
+  // that the iterators share a memory budget with the block cache or the
+  // WriteBufferManager using it. With strict_capacity_limit, NewIterator()
+  // and NewIterators() fail with Status::MemoryLimit() when the charge does
+  // not fit. The cache entries have CacheEntryRole::kIterator. Whether or
+  // not set, the usage is reported by DB::Properties::kIteratorsMemUsage.
+  //
+  // Note that the data blocks the iterators pin are charged to the block
+  // cache they came from, see DB::Properties::kBlockCachePinnedUsage.
+  //
+  // Default: nullptr (not charged)
+  std::shared_ptr<Cache> iterator_memory_cache = nullptr;
+
+  // If set, the DB calls it periodically to adjust its mutable options from
+  // the live write stall and compaction statistics, see
+  // rocksdb/auto_tuner.h. Note that the options it changes are persisted to
+  // the OPTIONS file as with any SetOptions() or SetDBOptions().
+  //
+  // Default: nullptr (disabled)
+  std::shared_ptr<AutoTuner> auto_tuner = nullptr;
+
+  // If set, the blocks of the block-based tables of compression types it
+  // supports are compressed and uncompressed by it, the software codecs
+  // taking the blocks it does not take, see rocksdb/compression_accelerator.h.
+  // The tables written with it remain readable without it.
+  //
+  // Default: nullptr (software compression only)
+  std::shared_ptr<CompressionAccelerator> compression_accelerator = nullptr;
+
   // A filter object supplied to be invoked while processing write-ahead-logs
   // (WALs) during recovery. The filter provides a way to inspect log
   // records, ignoring a particular record or skipping replay.
@@ -1331,6 +1515,57 @@ struct DBOptions {
   // DEFAULT: false
   bool avoid_flush_during_recovery = false;
 
+  // The number of threads inserting the WAL records into the memtables on DB
+  // open, while the opening thread reads the WAL files. The records are
+  // inserted concurrently, so it only applies with
+  // allow_concurrent_memtable_write, and not with allow_2pc or the write
+  // policies of unprepared or prepared transactions. 1 inserts them on the
+  // opening thread.
+  //
+  // DEFAULT: 1
+  int wal_recovery_threads = 1;
+
+  // The number of threads of the DB performing the lookups of GetAsync() and
+  // MultiGetAsync(), started on the first of them. With ReadOptions::async_io,
+  // each lookup also reads its blocks concurrently, so a few threads keep
+  // many reads in flight.
+  //
+  // DEFAULT: 4
+  int async_read_threads = 4;
+
+  // The maximum number of L0 files a flush writes concurrently. A flush
+  // splits the key space of its memtables into ranges of at least about 1MB
+  // of their entries, picked from a sample of their keys, builds a
+  // range-disjoint L0 file for each range and installs all of them in the
+  // same VersionEdit. The first file is built on the flush thread and the
+  // others on the other threads of its pool (HIGH, see
+  // max_background_flushes), when they are idle. Only skip list memtables
+  // without range deletions or user-defined timestamps are split.
+  //
+  // DEFAULT: 1
+  int max_flush_subjobs = 1;
+
+  // If true, closing the DB without flushing the memtables (see
+  // avoid_flush_during_shutdown) writes their entries to a snapshot file in
+  // the DB directory, which the next DB::Open() loads in key order instead of
+  // replaying the WALs, as long as the WALs did not change in between. The
+  // WALs are kept either way. It's not used with allow_2pc, a wal_filter, or
+  // data written with WriteOptions::disableWAL, which the WALs don't hold.
+  //
+  // DEFAULT: false
+  bool snapshot_memtables_on_shutdown = false;
+
+  // If true, closing the DB writes the table properties of its live SST
+  // files to a summary file in the DB directory. The next DB::Open() then
+  // doesn't open the files it lists upfront, even with max_open_files=-1:
+  // each one is opened on its first read, and until then its properties are
+  // served from the summary, to GetPropertiesOfAllTables() and the
+  // compaction picker among others. The files of a FIFO compaction column
+  // family are still opened on DB::Open().
+  //
+  // DEFAULT: false
+  bool summarize_tables_on_shutdown = false;
+
   // By default RocksDB will flush all memtables on DB close if there are
   // unpersisted data (i.e. with WAL disabled) The flush can be skip to speedup
   // DB close. Unpersisted data WILL BE LOST.
@@ -1568,6 +1803,16 @@ struct DBOptions {
   // Default: false
   bool disable_delete_obsolete_files_on_open = false;
 
+  // If true, compactions merge their input sorted runs with a tournament tree
+  // of losers instead of a binary heap. Stepping to the next key then always
+  // takes log2(N) key comparisons for N sorted runs, against up to 2*log2(N)
+  // with the heap, which pays off for compactions of many sorted runs with
+  // keys interleaved between them, e.g. universal compactions. The heap is
+  // faster when consecutive keys tend to come from the same sorted run.
+  //
+  // Default: false
+  bool use_loser_tree_in_compaction = false;
+
   // EXPERIMENTAL
   // Implementing off-peak duration awareness in RocksDB. In this context,
   // "off-peak time" signifies periods characterized by significantly less read
@@ -1732,6 +1977,15 @@ struct ReadOptions {
   // to point lookups and is disabled by default.
   std::optional<size_t> merge_operand_count_threshold;
 
+  // If non-nullptr, GetEntity(), MultiGetEntity() and iterators only return
+  // the wide columns with these names, for example for scans that only read
+  // a few of the columns of each entity. Iterators then do not locate the
+  // values of the other columns, and their value() is the default column
+  // only if kDefaultWideColumnName is one of the names. Plain key-values are
+  // treated like entities with only the default column. The vector must
+  // outlive the read, or the iterator.
+  const std::vector<Slice>* column_projection = nullptr;
+
   // If true, all data read from underlying storage will be
   // verified against corresponding checksums.
   bool verify_checksums = true;
@@ -1753,6 +2007,10 @@ struct ReadOptions {
   // If async_io is enabled, RocksDB will prefetch some of data asynchronously.
   // RocksDB apply it if reads are sequential and its internal automatic
   // prefetching.
+  // With partitioned filters and indexes, it also makes a Seek() needing the
+  // filter partition and the index partition of a table read both in
+  // parallel. The index partition read is wasted if the filter then rules
+  // the table out.
   bool async_io = false;
 
   // Experimental
@@ -1777,6 +2035,16 @@ struct ReadOptions {
   // of forward iteration on spinning disks.
   size_t readahead_size = 0;
 
+  // If non-zero, forward iteration reads this many bytes ahead in a blob file
+  // when a blob value of the file is not read ahead yet. A blob file written
+  // by a flush or compaction holds the values of consecutive keys in order,
+  // so a scan over them costs one read per `blob_readahead_size` bytes
+  // instead of one read per value. Ignored by backward iteration and with
+  // allow_mmap_reads.
+  //
+  // Default: 0 (one read per blob value)
+  uint64_t blob_readahead_size = 0;
+
   // A threshold for the number of keys that can be skipped before failing an
   // iterator seek as incomplete. The default value of 0 should be used to
   // never fail a request as incomplete, even on skipping too many keys.
@@ -1909,8 +2177,36 @@ struct ReadOptions {
   // Default: true
   bool auto_readahead_size = true;
 
+  // If async_io is set and this is > 0, bounds the asynchronous readahead
+  // reads in flight across all the table files of an iterator, instead of
+  // letting each file read ahead on its own. A file that has no read left
+  // in the budget reads its next blocks when the iterator needs them. Reads
+  // the iterator waits for are never delayed, and the readahead of a file
+  // is dropped when the iterator reseeks.
+  //
+  // Useful for scans merging many files, e.g. many L0 files, where the
+  // readahead of the files not consumed yet would fill the IO queue.
+  //
+  // Default: 0 (unbounded)
+  size_t max_async_readahead_reads = 0;
+
   // *** END options only relevant to iterators or scans ***
 
+  // *** BEGIN options only relevant to DB::VerifyChecksum() and
+  // DB::VerifyFileChecksums() ***
+
+  // The number of threads verifying the live files of the DB, each taking
+  // the next file to verify, the calling thread among them. Values <= 1
+  // verify the files one after the other on the calling thread. The reads
+  // go through the rate limiter of the DB, see rate_limiter_priority, and
+  // the progress is logged to the info log for every tenth of the bytes.
+  //
+  // Default: 1
+  int verify_checksum_threads = 1;
+
+  // *** END options only relevant to DB::VerifyChecksum() and
+  // DB::VerifyFileChecksums() ***
+
   // *** BEGIN options for RocksDB internal use only ***
 
   // EXPERIMENTAL
@@ -2223,6 +2519,14 @@ struct IngestExternalFileOptions {
   //
   // XXX: "bottommost" is obsolete/confusing terminology to refer to last level
   bool fail_if_not_bottommost_level = false;
+
+  // The number of threads reading the files to ingest before ingesting them:
+  // their properties, their smallest and largest keys, and their checksums
+  // with verify_checksums_before_ingest. Ingestions of many files on storage
+  // with a high latency per read, e.g. object stores, are dominated by these
+  // reads. Values <= 1 read the files one after the other on the calling
+  // thread.
+  int max_file_analysis_threads = 1;
 };
 
 enum TraceFilterType : uint64_t {
@@ -284,6 +284,22 @@ struct PerfContextBase {
   uint64_t decrypt_data_nanos;
 
   uint64_t number_async_seek;
+
+  // Populated by the cloud file system.
+  // Number of requests sent to the cloud storage.
+  uint64_t cloud_request_count;
+  // Bytes downloaded from the cloud storage.
+  uint64_t cloud_read_byte;
+  // Bytes uploaded to the cloud storage.
+  uint64_t cloud_write_byte;
+  // Total time spent waiting on cloud storage requests.
+  uint64_t cloud_request_nanos;
+
+  // Total nanos spent on compressing blocks, including the verification of
+  // the compressed blocks, when building a table file.
+  uint64_t block_compress_time;
+  // Total nanos spent in CompactionFilter during flush and compaction.
+  uint64_t compaction_filter_time;
 };
 
 struct PerfContext : public PerfContextBase {
@@ -36,4 +36,11 @@ void SetPerfLevel(PerfLevel level);
 // get current perf stats level for current thread
 PerfLevel GetPerfLevel();
 
+// Raise the perf stats level of current thread to `level` for one in
+// `one_in` of its Get(), MultiGet(), Write() and iterator Seek() calls, so
+// the time stats can be sampled at a fraction of their cost. The stats add
+// up in the same perf_context and iostats_context as the other calls, which
+// stay at the level of SetPerfLevel(). 0 disables the sampling.
+void SetPerfLevelSampling(PerfLevel level, uint32_t one_in);
+
 }  // namespace ROCKSDB_NAMESPACE
@@ -9,6 +9,10 @@
 
 #pragma once
 
+#include <map>
+#include <memory>
+#include <string>
+
 #include "rocksdb/env.h"
 #include "rocksdb/statistics.h"
 #include "rocksdb/status.h"
@@ -86,13 +90,27 @@ class RateLimiter {
     }
   }
 
+  // Requests token to read or write bytes on behalf of `io_activity`, e.g.
+  // Env::IOActivity::kCompaction, and potentially updates statistics. The
+  // default implementation ignores the activity.
+  //
+  // If this request can not be satisfied, the call is blocked. Caller is
+  // responsible to make sure bytes <= GetSingleBurstBytes()
+  // and bytes >= 0.
+  virtual void Request(const int64_t bytes, const Env::IOPriority pri,
+                       Statistics* stats, OpType op_type,
+                       Env::IOActivity /* io_activity */) {
+    Request(bytes, pri, stats, op_type);
+  }
+
   // Requests token to read or write bytes and potentially updates statistics.
   // Takes into account GetSingleBurstBytes() and alignment (e.g., in case of
   // direct I/O) to allocate an appropriate number of bytes, which may be less
   // than the number of bytes requested.
-  virtual size_t RequestToken(size_t bytes, size_t alignment,
-                              Env::IOPriority io_priority, Statistics* stats,
-                              RateLimiter::OpType op_type);
+  virtual size_t RequestToken(
+      size_t bytes, size_t alignment, Env::IOPriority io_priority,
+      Statistics* stats, RateLimiter::OpType op_type,
+      Env::IOActivity io_activity = Env::IOActivity::kUnknown);
 
   // Max bytes can be granted in a single call to `Request()`.
   virtual int64_t GetSingleBurstBytes() const = 0;
@@ -169,4 +187,72 @@ RateLimiter* NewGenericRateLimiter(
     RateLimiter::Mode mode = RateLimiter::Mode::kWritesOnly,
     bool auto_tuned = false, int64_t single_burst_bytes = 0);
 
+struct HierarchicalRateLimiterOptions {
+  // The rate shared by all the tenants, e.g. the bandwidth of a device.
+  // See NewGenericRateLimiter() for the other options.
+  int64_t rate_bytes_per_sec = 0;
+  int64_t refill_period_us = 100 * 1000;
+  RateLimiter::Mode mode = RateLimiter::Mode::kWritesOnly;
+};
+
+struct RateLimiterTenantOptions {
+  // Identifies the tenant in the statistics. Must be unique in the limiter.
+  std::string name;
+
+  // Share of the rate of the tenant, relative to the other tenants with
+  // pending requests.
+  // REQUIRED: weight > 0
+  uint32_t weight = 1;
+
+  // Shares of the rate of the tenant of its Env::IOActivity buckets. The
+  // requests without an activity, e.g. the WAL writes, go to the kUnknown
+  // bucket. The activities not listed weigh default_activity_weight.
+  // REQUIRED: the weights are > 0
+  std::map<Env::IOActivity, uint32_t> activity_weights;
+  uint32_t default_activity_weight = 1;
+};
+
+// A rate limiter shared by several DBs -- the tenants -- that splits its
+// rate in a tree: among the tenants, then among the Env::IOActivity buckets
+// of each tenant, then by Env::IOPriority in each bucket, which goes from
+// IO_USER down to IO_LOW.
+//
+// The tenants and buckets are served by weighted fair queuing: when their
+// requests exceed the rate, each gets the share of the rate of its weight.
+// The share of the tenants and buckets without pending requests is lent to
+// the others, and a tenant that was idle does not get it back later as a
+// burst.
+class HierarchicalRateLimiter {
+ public:
+  struct NodeStats {
+    int64_t bytes_through = 0;
+    int64_t requests = 0;
+    int64_t pending_requests = 0;
+  };
+
+  virtual ~HierarchicalRateLimiter() {}
+
+  // Returns in `*tenant` the RateLimiter to set as DBOptions::rate_limiter
+  // of a tenant. The tenant leaves the limiter when `*tenant` is destroyed.
+  virtual Status NewTenant(const RateLimiterTenantOptions& options,
+                           std::shared_ptr<RateLimiter>* tenant) = 0;
+
+  // REQUIRED: bytes_per_second > 0
+  virtual void SetBytesPerSecond(int64_t bytes_per_second) = 0;
+  virtual int64_t GetBytesPerSecond() const = 0;
+
+  // Returns the counters of the tenant `name`, or NotFound.
+  virtual Status GetTenantStats(const std::string& name,
+                                NodeStats* stats) const = 0;
+
+  // Returns the counters of the `io_activity` bucket of the tenant `name`,
+  // or NotFound.
+  virtual Status GetActivityStats(const std::string& name,
+                                  Env::IOActivity io_activity,
+                                  NodeStats* stats) const = 0;
+};
+
+std::shared_ptr<HierarchicalRateLimiter> NewHierarchicalRateLimiter(
+    const HierarchicalRateLimiterOptions& options);
+
 }  // namespace ROCKSDB_NAMESPACE
@@ -82,6 +82,39 @@ class SstFileManager {
   // thread-safe
   virtual uint64_t GetTotalTrashSize() = 0;
 
+  // Return the number of background threads deleting trash files
+  // thread-safe
+  virtual int GetMaxTrashDeleteThreads() = 0;
+
+  // Update the number of background threads deleting trash files, 1 by
+  // default. The threads share the delete rate limit, so more threads help
+  // when a single one cannot delete files at that rate.
+  // REQUIRED: num_threads > 0
+  // thread-safe
+  virtual void SetMaxTrashDeleteThreads(int num_threads) = 0;
+
+  // Return true if each directory has its own delete rate limit
+  // thread-safe
+  virtual bool IsDeleteRateLimitPerDirectory() = 0;
+
+  // If true, the trash files of each directory, e.g. each of the db_paths on
+  // its own device, are deleted at the delete rate limit, instead of all the
+  // trash files together. Applies to the files scheduled for deletion
+  // afterwards.
+  // thread-safe
+  virtual void SetDeleteRateLimitPerDirectory(bool per_directory) = 0;
+
+  // Return the trash size where compactions are cancelled
+  // thread-safe
+  virtual uint64_t GetMaxTrashBacklog() = 0;
+
+  // Update the trash size where compactions are cancelled, until the trash
+  // is deleted below it. The input files of a compaction go to the trash, so
+  // this keeps the compactions from filling the disk faster than the trash
+  // is deleted. Zero disables it (default).
+  // thread-safe
+  virtual void SetMaxTrashBacklog(uint64_t max_trash_backlog) = 0;
+
   // Set the statistics ptr to dump the stat information
   virtual void SetStatisticsPtr(const std::shared_ptr<Statistics>& stats) = 0;
 };
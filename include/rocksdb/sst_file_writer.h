@@ -8,6 +8,7 @@
 
 #include <memory>
 #include <string>
+#include <vector>
 
 #include "advanced_options.h"
 #include "rocksdb/env.h"
@@ -207,4 +208,58 @@ class SstFileWriter {
   struct Rep;
   std::unique_ptr<Rep> rep_;
 };
+
+struct ParallelSstFileWriterOptions {
+  // The directory the files are written into, named
+  // <file_prefix><6-digit index>.sst. It must exist.
+  std::string directory;
+  std::string file_prefix = "bulk_load_";
+
+  // A new file is started once the keys and values added to the current one
+  // reach this size
+  uint64_t target_file_size = 64 << 20;
+
+  // The number of files built concurrently. The keys and values of up to
+  // max_background_writers + 1 files are buffered in memory.
+  int max_background_writers = 4;
+};
+
+// ParallelSstFileWriter builds the sst files of a bulk load concurrently.
+// Keys are added in ascending order from one thread and split into files of
+// about target_file_size bytes, which background threads build with
+// SstFileWriter. The files have non-overlapping key ranges, so they can be
+// ingested together with one DB::IngestExternalFile() call.
+//
+// This class is NOT thread-safe.
+class ParallelSstFileWriter {
+ public:
+  // `column_family` is passed to the SstFileWriter of each file
+  ParallelSstFileWriter(const EnvOptions& env_options, const Options& options,
+                        const ParallelSstFileWriterOptions& parallel_options,
+                        ColumnFamilyHandle* column_family = nullptr);
+
+  // Waits for the files being built. The files of an unfinished bulk load
+  // are left in the directory.
+  ~ParallelSstFileWriter();
+
+  // REQUIRES: user_key is after any previously added key according to the
+  //           comparator.
+  // REQUIRES: comparator is *not* timestamp-aware.
+  Status Put(const Slice& user_key, const Slice& value);
+
+  // REQUIRES: same as Put()
+  Status Merge(const Slice& user_key, const Slice& value);
+
+  // REQUIRES: same as Put()
+  Status Delete(const Slice& user_key);
+
+  // Waits for all the files to be built, and returns their information in
+  // key order. Once a file fails, the keys added later are rejected and its
+  // error is returned.
+  Status Finish(std::vector<ExternalSstFileInfo>* file_infos);
+
+ private:
+  struct Rep;
+  std::unique_ptr<Rep> rep_;
+};
 }  // namespace ROCKSDB_NAMESPACE
@@ -7,8 +7,11 @@
 #pragma once
 
 #include <memory>
+#include <mutex>
 #include <string>
+#include <vector>
 
+#include "rocksdb/comparator.h"
 #include "rocksdb/customizable.h"
 #include "rocksdb/rocksdb_namespace.h"
 #include "rocksdb/slice.h"
@@ -139,4 +142,71 @@ class SstPartitionerFixedPrefixFactory : public SstPartitionerFactory {
 std::shared_ptr<SstPartitionerFactory> NewSstPartitionerFixedPrefixFactory(
     size_t prefix_len);
 
+/*
+ * Shard boundary partitioner. It splits the output SST files at the shard
+ * boundaries it was created with: a key equal to a boundary starts a new
+ * file, and a file is not trivially moved if it spans a boundary.
+ */
+class SstPartitionerShardBoundaries : public SstPartitioner {
+ public:
+  // boundaries must be sorted by comparator
+  SstPartitionerShardBoundaries(
+      const Comparator* comparator,
+      std::shared_ptr<const std::vector<std::string>> boundaries)
+      : comparator_(comparator), boundaries_(std::move(boundaries)) {}
+
+  ~SstPartitionerShardBoundaries() override {}
+
+  const char* Name() const override { return "SstPartitionerShardBoundaries"; }
+
+  PartitionerResult ShouldPartition(const PartitionerRequest& request) override;
+
+  bool CanDoTrivialMove(const Slice& smallest_user_key,
+                        const Slice& largest_user_key) override;
+
+ private:
+  const Comparator* comparator_;
+  std::shared_ptr<const std::vector<std::string>> boundaries_;
+};
+
+/*
+ * Factory for shard boundary partitioners, which keeps the output files of
+ * compactions within the shards of a sharded key space, so that a shard can
+ * be moved by exporting and importing its files without rewriting any. The
+ * boundaries, the first keys of the shards, can be changed at any time with
+ * SetBoundaries() and apply to the compactions that start afterwards. Files
+ * written before may still span a new boundary until they are compacted, and
+ * the files of flushes to L0 are not partitioned.
+ */
+class SstPartitionerShardBoundariesFactory : public SstPartitionerFactory {
+ public:
+  // comparator must be the comparator of the column family
+  explicit SstPartitionerShardBoundariesFactory(
+      const Comparator* comparator, std::vector<std::string> boundaries = {});
+
+  ~SstPartitionerShardBoundariesFactory() override {}
+
+  static const char* kClassName() {
+    return "SstPartitionerShardBoundariesFactory";
+  }
+  const char* Name() const override { return kClassName(); }
+
+  std::unique_ptr<SstPartitioner> CreatePartitioner(
+      const SstPartitioner::Context& /* context */) const override;
+
+  // Replaces the shard boundaries, in any order. Thread-safe.
+  void SetBoundaries(std::vector<std::string> boundaries);
+
+  std::shared_ptr<const std::vector<std::string>> GetBoundaries() const;
+
+ private:
+  const Comparator* comparator_;
+  mutable std::mutex mutex_;
+  std::shared_ptr<const std::vector<std::string>> boundaries_;
+};
+
+std::shared_ptr<SstPartitionerShardBoundariesFactory>
+NewSstPartitionerShardBoundariesFactory(const Comparator* comparator,
+                                        std::vector<std::string> boundaries);
+
 }  // namespace ROCKSDB_NAMESPACE
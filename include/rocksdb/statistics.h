@@ -529,6 +529,51 @@ enum Tickers : uint32_t {
   // Footer corruption detected when opening an SST file for reading
   SST_FOOTER_CORRUPTION_COUNT,
 
+  // GET requests to the cloud storage
+  CLOUD_READ_REQUESTS,
+
+  // PUT requests to the cloud storage, including multipart upload requests
+  CLOUD_WRITE_REQUESTS,
+
+  // HEAD requests to the cloud storage
+  CLOUD_INFO_REQUESTS,
+
+  // LIST requests to the cloud storage
+  CLOUD_LIST_REQUESTS,
+
+  // Server-side COPY requests to the cloud storage
+  CLOUD_COPY_REQUESTS,
+
+  // DELETE requests to the cloud storage
+  CLOUD_DELETE_REQUESTS,
+
+  // Bucket creation requests to the cloud storage
+  CLOUD_CREATE_REQUESTS,
+
+  // Cloud storage requests that failed, after all their retries
+  CLOUD_REQUEST_FAILURES,
+
+  // Bytes downloaded from the cloud storage
+  CLOUD_BYTES_READ,
+
+  // Bytes uploaded to the cloud storage
+  CLOUD_BYTES_WRITTEN,
+
+  // Retries of cloud storage requests
+  CLOUD_REQUEST_RETRIES,
+
+  // Cloud storage requests rejected because of throttling (e.g. S3 SlowDown)
+  CLOUD_REQUEST_THROTTLES,
+
+  // Replication log records applied by DB::ApplyReplicationLogRecord()
+  REPLICATION_RECORDS_APPLIED,
+
+  // Bytes of replication log records applied, after decompression
+  REPLICATION_BYTES_APPLIED,
+
+  // Calls to DB::UpdateReplicationEpoch()
+  REPLICATION_EPOCH_UPDATES,
+
   TICKER_ENUM_MAX
 };
 
@@ -662,6 +707,38 @@ enum Histograms : uint32_t {
   // system's prefetch) from the end of SST table during block based table open
   TABLE_OPEN_PREFETCH_TAIL_READ_BYTES,
 
+  // Latency of cloud storage requests, by type of request. A request is
+  // measured from its start to its completion, retries included.
+  CLOUD_READ_MICROS,
+  CLOUD_WRITE_MICROS,
+  CLOUD_INFO_MICROS,
+  CLOUD_LIST_MICROS,
+  CLOUD_COPY_MICROS,
+  CLOUD_DELETE_MICROS,
+  CLOUD_CREATE_MICROS,
+
+  // Number of uploads to the cloud storage waiting for a slot, sampled when
+  // an upload is queued, see CloudFileSystemOptions::max_concurrent_uploads.
+  CLOUD_UPLOAD_QUEUE_DEPTH,
+
+  // Time spent in the phases of DBCloud::Open(): preparing the local
+  // directory, loading the CLOUDMANIFEST and the MANIFEST from the cloud,
+  // opening the DB over them, and the whole open.
+  CLOUD_OPEN_SANITIZE_MICROS,
+  CLOUD_OPEN_LOAD_CLOUD_MANIFEST_MICROS,
+  CLOUD_OPEN_DB_MICROS,
+  CLOUD_OPEN_MICROS,
+
+  // Time between when a job of the CloudScheduler is due and when it
+  // starts, see CloudScheduler::SetConcurrencyLimit().
+  CLOUD_SCHEDULER_LAG_MICROS,
+
+  // Time spent in DB::ApplyReplicationLogRecord(), by type of record,
+  // including the wait for the write thread.
+  REPLICATION_MEMTABLE_WRITE_APPLY_MICROS,
+  REPLICATION_MEMTABLE_SWITCH_APPLY_MICROS,
+  REPLICATION_MANIFEST_WRITE_APPLY_MICROS,
+
   HISTOGRAM_ENUM_MAX
 };
 
@@ -679,6 +756,7 @@ struct HistogramData {
   uint64_t count = 0;
   uint64_t sum = 0;
   double min = 0.0;
+  double percentile999 = 0.0;
 };
 
 // StatsLevel can be used to reduce statistics overhead by skipping certain
@@ -761,6 +839,15 @@ class Statistics : public Customizable {
   // Resets all ticker and histogram stats
   virtual Status Reset() { return Status::NotSupported("Not implemented"); }
 
+  // Sets `*snapshot` to the serialized histogram of `type`, which can be
+  // merged with the snapshots of other Statistics objects, see
+  // MergeHistogramSnapshots(). Only supported by the Statistics of
+  // CreateDBStatistics() with HDR histograms.
+  virtual Status getHistogramSnapshot(uint32_t /*type*/,
+                                      std::string* /*snapshot*/) const {
+    return Status::NotSupported("Not implemented");
+  }
+
   using Customizable::ToString;
   // String representation of the statistic object. Must be thread-safe.
   virtual std::string ToString() const {
@@ -791,4 +878,34 @@ class Statistics : public Customizable {
 // Create a concrete DBStatistics object
 std::shared_ptr<Statistics> CreateDBStatistics();
 
+struct StatisticsOptions {
+  // If positive, the histograms are HDR histograms recording the values with
+  // this many significant decimal digits, from 1 to 4, such that
+  // percentiles like P99.9 are within 10^-digits of the recorded values.
+  // The memory of a histogram grows with 2^digits for each power of two of
+  // the values it records, on each core: about 1KB at 2 digits, 8KB at 3.
+  // Otherwise, the histograms share fixed buckets, which are wider for
+  // larger values, and interpolate percentiles within a bucket.
+  int hdr_histogram_significant_digits = 0;
+};
+
+// Same as CreateDBStatistics(), with `options`
+std::shared_ptr<Statistics> CreateDBStatistics(
+    const StatisticsOptions& options);
+
+// Merges the histogram snapshot `other`, of Statistics::getHistogramSnapshot(),
+// into `*snapshot`, which may be empty. The snapshots may have different
+// significant digits, in which case the merged one takes the digits of
+// `*snapshot`, or of `other` if empty.
+Status MergeHistogramSnapshots(const std::string& other,
+                               std::string* snapshot);
+
+// Gets the data of the histogram snapshot, including P99.9
+Status GetHistogramSnapshotData(const std::string& snapshot,
+                                HistogramData* data);
+
+// Gets the value at percentile `p`, from 0 to 100, of the histogram snapshot
+Status GetHistogramSnapshotPercentile(const std::string& snapshot, double p,
+                                      double* value);
+
 }  // namespace ROCKSDB_NAMESPACE
@@ -232,6 +232,16 @@ struct BlockBasedTableOptions {
     // Makes the index significantly bigger (2x or more), especially when keys
     // are long.
     kBinarySearchWithFirstKey = 0x03,
+
+    // Like kBinarySearch, but the index predicts the position of the key
+    // among the separators with a piecewise linear model of their user keys,
+    // and only searches a few entries around the prediction. The separators
+    // are stored without their common prefix, and always with
+    // index_block_restart_interval 1. Works best with a bytewise comparator
+    // and keys that are well distributed after their common prefix, e.g.
+    // integers. Uses less memory than kBinarySearch when the keys share long
+    // prefixes, and touches fewer cache lines of the index on lookups.
+    kLearnedSearch = 0x04,
   };
 
   IndexType index_type = kBinarySearch;
@@ -240,14 +250,30 @@ struct BlockBasedTableOptions {
   enum DataBlockIndexType : char {
     kDataBlockBinarySearch = 0,   // traditional block type
     kDataBlockBinaryAndHash = 1,  // additional hash index
+    // EXPERIMENTAL: additional hash index with 64-byte buckets of multiple
+    // fingerprint/restart pairs, probed with SIMD instructions where
+    // available, and looked up for all the keys of a MultiGet() batch in a
+    // data block at once. Has fewer collisions than kDataBlockBinaryAndHash
+    // for twice the space per key. Blocks written with it cannot be read by
+    // versions that do not support it.
+    kDataBlockBinaryAndBlockedHash = 2,
   };
 
   DataBlockIndexType data_block_index_type = kDataBlockBinarySearch;
 
   // #entries/#buckets. It is valid only when data_block_hash_index_type is
-  // kDataBlockBinaryAndHash.
+  // kDataBlockBinaryAndHash or kDataBlockBinaryAndBlockedHash, for which
+  // it is the ratio of used to total fingerprint slots.
   double data_block_hash_table_util_ratio = 0.75;
 
+  // If true, data blocks of up to 64KiB also store the first 4 bytes of the
+  // user key at each restart point in a compact array, which seeks search,
+  // with SIMD instructions where available, before comparing full keys. This
+  // avoids decoding most restart keys when the keys differ in their first
+  // bytes. Only effective with BytewiseComparator(). Blocks written with
+  // this option cannot be read by versions that do not support it.
+  bool data_block_restart_key_prefixes = false;
+
   // Option hash_index_allow_collision is now deleted.
   // It will behave as if hash_index_allow_collision=true.
 
@@ -261,6 +287,17 @@ struct BlockBasedTableOptions {
   // point to a nullptr object.
   bool no_block_cache = false;
 
+  // The blocks of a table file are cached under keys derived from the DB
+  // session id and file number recorded in its properties, so that all the
+  // DBs reading a file, like clones and copies of a DB, share them. If true,
+  // the files whose properties do not record them, written by older
+  // versions, are cached under keys derived from
+  // FSRandomAccessFile::GetUniqueId() instead of the current DB session.
+  // Only set it if the unique ids of the file system identify the contents
+  // of the files, like the content hashes of cloud objects, and are never
+  // reused for other contents, unlike inode numbers.
+  bool cache_keys_from_file_unique_id = false;
+
   // If non-NULL use the specified cache for blocks.
   // If NULL, rocksdb will automatically create and use a 32MB internal cache.
   std::shared_ptr<Cache> block_cache = nullptr;
@@ -448,6 +485,18 @@ struct BlockBasedTableOptions {
   // This must generally be true for gets to be efficient.
   bool whole_key_filtering = true;
 
+  // If non-zero, each SST file stores a range filter that iterators with an
+  // iterate_upper_bound consult on Seek() and SeekToFirst(), before reading
+  // any index or data block, to skip files that have no key in the range of
+  // the scan. The filter keeps this many bytes of each user key after the
+  // prefix that all keys of the file share, so larger values filter out more
+  // short ranges at the cost of a larger filter. Unlike the prefix filter of
+  // filter_policy, it does not depend on the prefix_extractor. Only built
+  // for BytewiseComparator() without user-defined timestamps.
+  //
+  // Default: 0 (disabled)
+  uint32_t range_filter_key_width = 0;
+
   // If true, detect corruption during Bloom Filter (format_version >= 5)
   // and Ribbon Filter construction.
   //
@@ -616,11 +665,27 @@ struct BlockBasedTableOptions {
     kDisable,
     // Prepopulate blocks during flush only.
     kFlushOnly,
+    // Prepopulate blocks during flush, and the data blocks of compaction
+    // outputs whose keys were in the block cache when the compaction started,
+    // so that a compaction does not turn a hot key range cold. The index and
+    // filter blocks of an output file are also inserted if any of its data
+    // blocks was. The data blocks inserted by a compaction are limited to
+    // prepopulate_block_cache_compaction_budget bytes. Data blocks
+    // compressed in parallel or buffered to train a compression dictionary
+    // are not inserted.
+    kFlushAndHotCompaction,
   };
 
   PrepopulateBlockCache prepopulate_block_cache =
       PrepopulateBlockCache::kDisable;
 
+  // With PrepopulateBlockCache::kFlushAndHotCompaction, the maximum bytes of
+  // uncompressed data blocks a compaction inserts into the block cache. 0
+  // inserts none.
+  //
+  // Default: 64 MB
+  uint64_t prepopulate_block_cache_compaction_budget = 64 << 20;
+
   // RocksDB does auto-readahead for iterators on noticing more than two reads
   // for a table file if user doesn't provide readahead_size. The readahead size
   // starts at initial_auto_readahead_size and doubles on every additional read
@@ -669,6 +734,53 @@ struct BlockBasedTableOptions {
   //
   // Default: 2
   uint64_t num_file_reads_for_auto_readahead = 2;
+
+  // If true, each table file keeps a moving average of the data bytes read
+  // by a sample of the scans over it, and the auto-readahead of new iterators
+  // on the file starts at that size, between block_size and
+  // max_auto_readahead_size, instead of initial_auto_readahead_size. Short
+  // scans then prefetch fewer bytes that are never read, and long scans reach
+  // a large readahead sooner. The PREFETCH_BYTES and PREFETCH_BYTES_USEFUL
+  // statistics show how many prefetched bytes were wasted.
+  //
+  // Default: false
+  bool learn_auto_readahead_size = false;
+
+  // If positive, compaction reads the input data blocks of each table file
+  // ahead of the compaction iterator and decompresses them on this many
+  // worker threads per file, so that a subcompaction does not spend most of
+  // its time decompressing its inputs. It is the read-side counterpart of
+  // CompressionOptions::parallel_threads, and only helps with compressed
+  // files.
+  //
+  // Changing the value dynamically will only affect files opened after the
+  // change.
+  //
+  // Default: 0 (decompress on the compaction thread)
+  uint32_t compaction_decompression_threads = 0;
+
+  // If true, compaction copies an input data block verbatim, without
+  // compressing it again, when the output data block built from its entries
+  // is identical to it. That is the case for blocks whose key range no other
+  // input overlaps, and whose entries the compaction keeps unchanged, e.g.
+  // in bottom-level compactions of append-mostly data once the sequence
+  // numbers are zeroed out. Only blocks of files in the block-based format
+  // without a compression dictionary are copied, to outputs using the same
+  // compression type and without a dictionary or parallel compression.
+  //
+  // Default: false
+  bool compaction_block_passthrough = false;
+
+  // If true, the table records up to 256 keys splitting its data blocks
+  // into ranges of about the same size, and the size of each range, in a
+  // meta block of its own. They are read when a compaction splits its inputs
+  // into subcompactions, instead of scanning the index of each input file,
+  // and balance the subcompactions of L0 inputs with few, wide and
+  // overlapping files better. Files without the block are still sampled
+  // from their index.
+  //
+  // Default: false
+  bool store_key_anchors = false;
 };
 
 // Table Properties that are specific to block-based table properties.
@@ -762,6 +874,18 @@ struct PlainTableOptions {
   //                       file building and store it in file. When reading
   //                       file, index will be mapped instead of recomputation.
   bool store_index_in_file = false;
+
+  // @cache_aligned_index: build the prefix hash index out of cache-line-sized
+  //                       buckets of prefix hashes and offsets, with two
+  //                       choices of bucket per prefix, so that finding the
+  //                       first row of a prefix takes about one cache miss,
+  //                       and prefixes no longer share a sub-index when their
+  //                       buckets collide. Used for the indexes built when
+  //                       writing the file with store_index_in_file, which
+  //                       older versions cannot read, and when opening it.
+  //                       Only used with a prefix extractor and
+  //                       hash_table_ratio > 0.
+  bool cache_aligned_index = false;
 };
 
 // -- Plain Table with prefix-only seek
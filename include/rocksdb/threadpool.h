@@ -64,4 +64,11 @@ class ThreadPool {
 // with `num_threads` background threads.
 ThreadPool* NewThreadPool(int num_threads);
 
+// Same as NewThreadPool(), but each thread has its own job queues and steals
+// from the others when out of jobs. The jobs submitted from a job of the
+// pool are queued without locking to the thread running it, which suits the
+// parallel jobs fanning out into many small ones. ReserveThreads() is not
+// supported.
+ThreadPool* NewWorkStealingThreadPool(int num_threads);
+
 }  // namespace ROCKSDB_NAMESPACE
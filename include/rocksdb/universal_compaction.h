@@ -81,6 +81,19 @@ class CompactionOptionsUniversal {
   // Default: false
   bool incremental;
 
+  // EXPERIMENTAL
+  // If true along with incremental, the compactions to reduce space
+  // amplification go over the key space in order instead of picking the
+  // range with the lowest fanout. Each one compacts the files of the second
+  // last sorted run from where the previous one stopped, recorded as a
+  // compact cursor like with kRoundRobin in level compaction, with their
+  // overlapping files, up to about max_compaction_bytes / 2. They never fall
+  // back to compacting the whole sorted runs, unless the second last sorted
+  // run is in L0, so that the extra space, the output written at once and
+  // the work lost by a failed compaction stay bounded.
+  // Default: false
+  bool incremental_round_robin;
+
   // Default set of parameters
   CompactionOptionsUniversal()
       : size_ratio(1),
@@ -90,7 +103,8 @@ class CompactionOptionsUniversal {
         compression_size_percent(-1),
         stop_style(kCompactionStopStyleTotalSize),
         allow_trivial_move(false),
-        incremental(false) {}
+        incremental(false),
+        incremental_round_robin(false) {}
 };
 
 }  // namespace ROCKSDB_NAMESPACE
@@ -247,6 +247,13 @@ class StackableDB : public DB {
     return db_->Write(opts, updates);
   }
 
+  // A StackableDB that overrides Write() must also override WriteAsync(),
+  // for example with DB::WriteAsync(), or its writes would bypass it
+  void WriteAsync(const WriteOptions& opts, WriteBatch* updates,
+                  std::function<void(const Status&)> callback) override {
+    db_->WriteAsync(opts, updates, std::move(callback));
+  }
+
   using DB::NewIterator;
   Iterator* NewIterator(const ReadOptions& opts,
                         ColumnFamilyHandle* column_family) override {
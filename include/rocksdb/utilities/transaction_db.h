@@ -162,6 +162,16 @@ struct TransactionDBOptions {
   // separate mutex.
   size_t num_stripes = 16;
 
+  // If true, the default lock manager keeps the locks of a column family in
+  // a table of per-key entries, guarded by num_stripes short-held spin locks,
+  // instead of num_stripes mutex-guarded maps. A transaction waiting on a key
+  // is then only woken up when that key is released, rather than by any
+  // release in its stripe, and locking an uncontended key usually doesn't
+  // allocate. Unlike the default, a lock request over max_num_locks fails
+  // right away instead of waiting for locks to be released.
+  // Ignored if lock_mgr_handle is set.
+  bool use_per_key_point_lock_mgr = false;
+
   // If positive, specifies the default wait timeout in milliseconds when
   // a transaction attempts to lock a key if not specified by
   // TransactionOptions::lock_timeout.
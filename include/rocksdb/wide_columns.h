@@ -118,6 +118,19 @@ class PinnableWideColumns {
   Status SetWideColumnValue(PinnableSlice&& value);
   Status SetWideColumnValue(std::string&& value);
 
+  // Removes the columns whose names are not in column_names, see
+  // ReadOptions::column_projection.
+  void Project(const std::vector<Slice>& column_names);
+
+  // Makes the Set*Value() calls taking an entity only locate the values of
+  // the columns whose names are in *column_names, instead of deserializing
+  // all the columns and dropping them with Project(). nullptr (the default)
+  // to locate all the columns. *column_names must outlive these calls. Not
+  // changed by Reset().
+  void SetColumnProjection(const std::vector<Slice>* column_names) {
+    column_projection_ = column_names;
+  }
+
   void Reset();
 
  private:
@@ -131,6 +144,7 @@ class PinnableWideColumns {
 
   PinnableSlice value_;
   WideColumns columns_;
+  const std::vector<Slice>* column_projection_ = nullptr;
 };
 
 inline void PinnableWideColumns::CopyValue(const Slice& value) {
@@ -208,9 +208,21 @@ class WriteBatch : public WriteBatchBase {
   Status PutLogData(const Slice& blob) override;
 
   using WriteBatchBase::Clear;
-  // Clear all updates buffered in this batch.
+  // Clear all updates buffered in this batch. The memory of the batch is kept
+  // for the updates added next, so a batch can be reused for many writes
+  // without allocating.
   void Clear() override;
 
+  // Makes room for at least `bytes` of serialized data, see GetDataSize(), so
+  // that adding updates up to that size does not reallocate.
+  void Reserve(size_t bytes);
+
+  // Clears this batch and makes it keep its serialized data in the memory of
+  // `buffer`, whose contents are discarded, and frees the memory it had. This
+  // lets callers that create a batch per write recycle the memory returned by
+  // Release() of a batch they are done with, e.g. from a thread-local pool.
+  void UseBuffer(std::string&& buffer);
+
   // Records the state of the batch for future calls to RollbackToSavePoint().
   // May be called multiple times to set multiple save points.
   void SetSavePoint() override;
@@ -12,11 +12,14 @@
 
 #pragma once
 
+#include <array>
 #include <atomic>
 #include <condition_variable>
 #include <cstddef>
 #include <list>
+#include <memory>
 #include <mutex>
+#include <vector>
 
 #include "rocksdb/cache.h"
 
@@ -36,6 +39,16 @@ class StallInterface {
 
 class WriteBufferManager final {
  public:
+  // The memory of the memtables of one DB that shares the buffer with other
+  // DBs by weight, see DBOptions::write_buffer_manager_weight. Intended for
+  // RocksDB internal use only.
+  struct Tenant {
+    explicit Tenant(uint32_t _weight) : weight(_weight) {}
+
+    const uint32_t weight;
+    std::atomic<size_t> memory_used{0};
+  };
+
   // Parameters:
   // _buffer_size: _buffer_size = 0 indicates no limit. Memory won't be capped.
   // memory_usage() won't be valid and ShouldFlush() will always return true.
@@ -74,6 +87,19 @@ class WriteBufferManager final {
     return memory_active_.load(std::memory_order_relaxed);
   }
 
+  // The most NUMA nodes whose memtable memory is counted apart.
+  static constexpr int kMaxNumaNodes = 8;
+
+  // Returns the part of memory_usage() that memtables allocated on NUMA
+  // node `node`. Only builds with NUMA support place memtable memory on a
+  // node, for writers on several nodes, so this is 0 otherwise.
+  // Only valid if enabled()
+  size_t numa_node_memory_usage(int node) const {
+    return node >= 0 && node < kMaxNumaNodes
+               ? numa_memory_used_[node].load(std::memory_order_relaxed)
+               : 0;
+  }
+
   size_t dummy_entries_in_cache_usage() const;
 
   // Returns the buffer_size.
@@ -116,6 +142,16 @@ class WriteBufferManager final {
     return false;
   }
 
+  // Like ShouldFlush(), but if tenant is not null and within its share, only
+  // returns true if no tenant is over its share. A tenant may borrow the
+  // share of the others, but gives it back first when the buffer fills up.
+  bool ShouldFlush(const Tenant* tenant) const {
+    if (!ShouldFlush()) {
+      return false;
+    }
+    return tenant == nullptr || IsOverShare(*tenant) || !AnyTenantOverShare();
+  }
+
   // Returns true if total memory usage exceeded buffer_size.
   // We stall the writes untill memory_usage drops below buffer_size. When the
   // function returns true, all writer threads (including one checking this
@@ -131,6 +167,15 @@ class WriteBufferManager final {
     return IsStallActive() || IsStallThresholdExceeded();
   }
 
+  // Like ShouldStall(), but never stalls a tenant within its share, so that
+  // a DB that writes a lot does not stall the others.
+  bool ShouldStall(const Tenant* tenant) const {
+    if (tenant != nullptr && !IsOverShare(*tenant)) {
+      return false;
+    }
+    return ShouldStall();
+  }
+
   // Returns true if stall is active.
   bool IsStallActive() const {
     return stall_active_.load(std::memory_order_relaxed);
@@ -149,6 +194,11 @@ class WriteBufferManager final {
 
   void FreeMem(size_t mem);
 
+  // Count `mem` bytes of what ReserveMem() and FreeMem() were called with as
+  // allocated on, or freed from, NUMA node `node`.
+  void ReserveNumaNodeMem(size_t mem, int node);
+  void FreeNumaNodeMem(size_t mem, int node);
+
   // Add the DB instance to the queue and block the DB.
   // Should only be called by RocksDB internally.
   void BeginWriteStall(StallInterface* wbm_stall);
@@ -159,12 +209,31 @@ class WriteBufferManager final {
 
   void RemoveDBFromQueue(StallInterface* wbm_stall);
 
+  // Returns a new tenant that gets buffer_size() * weight / (sum of the
+  // weights of the registered tenants) of the buffer.
+  // REQUIRED: `weight` > 0
+  std::shared_ptr<Tenant> RegisterTenant(uint32_t weight);
+
+  // The share of the tenant is given back to the others. Memory still
+  // charged to the tenant remains in memory_usage() until freed.
+  void UnregisterTenant(const Tenant* tenant);
+
+  // Returns the part of the buffer that the tenant may use when the buffer
+  // is full.
+  size_t GetTenantShare(const Tenant& tenant) const;
+
+  bool IsOverShare(const Tenant& tenant) const {
+    return tenant.memory_used.load(std::memory_order_relaxed) >
+           GetTenantShare(tenant);
+  }
+
  private:
   std::atomic<size_t> buffer_size_;
   std::atomic<size_t> mutable_limit_;
   std::atomic<size_t> memory_used_;
   // Memory that hasn't been scheduled to free.
   std::atomic<size_t> memory_active_;
+  std::array<std::atomic<size_t>, kMaxNumaNodes> numa_memory_used_;
   std::shared_ptr<CacheReservationManager> cache_res_mgr_;
   // Protects cache_res_mgr_
   std::mutex cache_res_mgr_mu_;
@@ -177,6 +246,13 @@ class WriteBufferManager final {
   // while holding mu_, but it can be read without a lock.
   std::atomic<bool> stall_active_;
 
+  std::vector<std::shared_ptr<Tenant>> tenants_;
+  std::atomic<uint64_t> total_tenant_weight_;
+  // Protects tenants_.
+  mutable std::mutex tenants_mu_;
+
+  bool AnyTenantOverShare() const;
+
   void ReserveMemWithCache(size_t mem);
   void FreeMemWithCache(size_t mem);
 };
@@ -2415,6 +2415,45 @@ class JniUtil {
     return jpointers;
   }
 
+  /*
+   * Helper for the batches of keys or values packed in direct ByteBuffers,
+   * for example RocksDB->multiGetPacked: `jdata` holds `count` entries back
+   * to back, entry i spanning the bytes [offsets[i], offsets[i + 1]) of it,
+   * where `joffsets` holds the count + 1 offsets as ints in native byte order.
+   *
+   * @return false if the buffers are not direct or the offsets are out of
+   *     bounds, in which case a RocksDBException is thrown
+   */
+  static bool packed_direct(JNIEnv* env, jobject jdata, jobject joffsets,
+                            jint count, const char** data,
+                            const jint** offsets) {
+    *data = reinterpret_cast<const char*>(env->GetDirectBufferAddress(jdata));
+    *offsets =
+        reinterpret_cast<const jint*>(env->GetDirectBufferAddress(joffsets));
+    const jlong offsets_size =
+        (static_cast<jlong>(count) + 1) * static_cast<jlong>(sizeof(jint));
+    if (count < 0 || *data == nullptr || *offsets == nullptr ||
+        env->GetDirectBufferCapacity(joffsets) < offsets_size) {
+      ROCKSDB_NAMESPACE::RocksDBExceptionJni::ThrowNew(
+          env, "Invalid packed argument (not direct ByteBuffers)");
+      return false;
+    }
+    const jlong capacity = env->GetDirectBufferCapacity(jdata);
+    if ((*offsets)[0] < 0) {
+      ROCKSDB_NAMESPACE::RocksDBExceptionJni::ThrowNew(
+          env, "Invalid packed argument (negative offset)");
+      return false;
+    }
+    for (jint i = 0; i < count; i++) {
+      if ((*offsets)[i + 1] < (*offsets)[i] || (*offsets)[i + 1] > capacity) {
+        ROCKSDB_NAMESPACE::RocksDBExceptionJni::ThrowNew(
+            env, "Invalid packed argument (offsets out of bounds)");
+        return false;
+      }
+    }
+    return true;
+  }
+
   /*
    * Helper for operations on a key and value
    * for example WriteBatch->Put
@@ -4761,6 +4800,8 @@ class CompactionPriorityJni {
         return 0x3;
       case ROCKSDB_NAMESPACE::CompactionPri::kRoundRobin:
         return 0x4;
+      case ROCKSDB_NAMESPACE::CompactionPri::kMinOverlappingRatioByReads:
+        return 0x5;
       default:
         return 0x0;  // undefined
     }
@@ -4781,6 +4822,8 @@ class CompactionPriorityJni {
         return ROCKSDB_NAMESPACE::CompactionPri::kMinOverlappingRatio;
       case 0x4:
         return ROCKSDB_NAMESPACE::CompactionPri::kRoundRobin;
+      case 0x5:
+        return ROCKSDB_NAMESPACE::CompactionPri::kMinOverlappingRatioByReads;
       default:
         // undefined/default
         return ROCKSDB_NAMESPACE::CompactionPri::kByCompensatedSize;
@@ -5269,6 +5312,36 @@ class TickerTypeJni {
         return -0x53;
       case ROCKSDB_NAMESPACE::Tickers::SST_FOOTER_CORRUPTION_COUNT:
         return -0x55;
+      case ROCKSDB_NAMESPACE::Tickers::CLOUD_READ_REQUESTS:
+        return -0x56;
+      case ROCKSDB_NAMESPACE::Tickers::CLOUD_WRITE_REQUESTS:
+        return -0x57;
+      case ROCKSDB_NAMESPACE::Tickers::CLOUD_INFO_REQUESTS:
+        return -0x58;
+      case ROCKSDB_NAMESPACE::Tickers::CLOUD_LIST_REQUESTS:
+        return -0x59;
+      case ROCKSDB_NAMESPACE::Tickers::CLOUD_COPY_REQUESTS:
+        return -0x5A;
+      case ROCKSDB_NAMESPACE::Tickers::CLOUD_DELETE_REQUESTS:
+        return -0x5B;
+      case ROCKSDB_NAMESPACE::Tickers::CLOUD_CREATE_REQUESTS:
+        return -0x5C;
+      case ROCKSDB_NAMESPACE::Tickers::CLOUD_REQUEST_FAILURES:
+        return -0x5D;
+      case ROCKSDB_NAMESPACE::Tickers::CLOUD_BYTES_READ:
+        return -0x5E;
+      case ROCKSDB_NAMESPACE::Tickers::CLOUD_BYTES_WRITTEN:
+        return -0x5F;
+      case ROCKSDB_NAMESPACE::Tickers::CLOUD_REQUEST_RETRIES:
+        return -0x60;
+      case ROCKSDB_NAMESPACE::Tickers::CLOUD_REQUEST_THROTTLES:
+        return -0x61;
+      case ROCKSDB_NAMESPACE::Tickers::REPLICATION_RECORDS_APPLIED:
+        return -0x62;
+      case ROCKSDB_NAMESPACE::Tickers::REPLICATION_BYTES_APPLIED:
+        return -0x63;
+      case ROCKSDB_NAMESPACE::Tickers::REPLICATION_EPOCH_UPDATES:
+        return -0x64;
       case ROCKSDB_NAMESPACE::Tickers::TICKER_ENUM_MAX:
         // -0x54 is the max value at this time. Since these values are exposed
         // directly to Java clients, we'll keep the value the same till the next
@@ -5726,6 +5799,36 @@ class TickerTypeJni {
         return ROCKSDB_NAMESPACE::Tickers::PREFETCH_HITS;
       case -0x55:
         return ROCKSDB_NAMESPACE::Tickers::SST_FOOTER_CORRUPTION_COUNT;
+      case -0x56:
+        return ROCKSDB_NAMESPACE::Tickers::CLOUD_READ_REQUESTS;
+      case -0x57:
+        return ROCKSDB_NAMESPACE::Tickers::CLOUD_WRITE_REQUESTS;
+      case -0x58:
+        return ROCKSDB_NAMESPACE::Tickers::CLOUD_INFO_REQUESTS;
+      case -0x59:
+        return ROCKSDB_NAMESPACE::Tickers::CLOUD_LIST_REQUESTS;
+      case -0x5A:
+        return ROCKSDB_NAMESPACE::Tickers::CLOUD_COPY_REQUESTS;
+      case -0x5B:
+        return ROCKSDB_NAMESPACE::Tickers::CLOUD_DELETE_REQUESTS;
+      case -0x5C:
+        return ROCKSDB_NAMESPACE::Tickers::CLOUD_CREATE_REQUESTS;
+      case -0x5D:
+        return ROCKSDB_NAMESPACE::Tickers::CLOUD_REQUEST_FAILURES;
+      case -0x5E:
+        return ROCKSDB_NAMESPACE::Tickers::CLOUD_BYTES_READ;
+      case -0x5F:
+        return ROCKSDB_NAMESPACE::Tickers::CLOUD_BYTES_WRITTEN;
+      case -0x60:
+        return ROCKSDB_NAMESPACE::Tickers::CLOUD_REQUEST_RETRIES;
+      case -0x61:
+        return ROCKSDB_NAMESPACE::Tickers::CLOUD_REQUEST_THROTTLES;
+      case -0x62:
+        return ROCKSDB_NAMESPACE::Tickers::REPLICATION_RECORDS_APPLIED;
+      case -0x63:
+        return ROCKSDB_NAMESPACE::Tickers::REPLICATION_BYTES_APPLIED;
+      case -0x64:
+        return ROCKSDB_NAMESPACE::Tickers::REPLICATION_EPOCH_UPDATES;
       case -0x54:
         // -0x54 is the max value at this time. Since these values are exposed
         // directly to Java clients, we'll keep the value the same till the next
@@ -5880,6 +5983,42 @@ class HistogramTypeJni {
         return 0x3C;
       case ROCKSDB_NAMESPACE::Histograms::TABLE_OPEN_PREFETCH_TAIL_READ_BYTES:
         return 0x3D;
+      case ROCKSDB_NAMESPACE::Histograms::CLOUD_READ_MICROS:
+        return 0x3F;
+      case ROCKSDB_NAMESPACE::Histograms::CLOUD_WRITE_MICROS:
+        return 0x40;
+      case ROCKSDB_NAMESPACE::Histograms::CLOUD_INFO_MICROS:
+        return 0x41;
+      case ROCKSDB_NAMESPACE::Histograms::CLOUD_LIST_MICROS:
+        return 0x42;
+      case ROCKSDB_NAMESPACE::Histograms::CLOUD_COPY_MICROS:
+        return 0x43;
+      case ROCKSDB_NAMESPACE::Histograms::CLOUD_DELETE_MICROS:
+        return 0x44;
+      case ROCKSDB_NAMESPACE::Histograms::CLOUD_CREATE_MICROS:
+        return 0x45;
+      case ROCKSDB_NAMESPACE::Histograms::
+          REPLICATION_MEMTABLE_WRITE_APPLY_MICROS:
+        return 0x46;
+      case ROCKSDB_NAMESPACE::Histograms::
+          REPLICATION_MEMTABLE_SWITCH_APPLY_MICROS:
+        return 0x47;
+      case ROCKSDB_NAMESPACE::Histograms::
+          REPLICATION_MANIFEST_WRITE_APPLY_MICROS:
+        return 0x48;
+      case ROCKSDB_NAMESPACE::Histograms::CLOUD_UPLOAD_QUEUE_DEPTH:
+        return 0x49;
+      case ROCKSDB_NAMESPACE::Histograms::CLOUD_OPEN_SANITIZE_MICROS:
+        return 0x4A;
+      case ROCKSDB_NAMESPACE::Histograms::
+          CLOUD_OPEN_LOAD_CLOUD_MANIFEST_MICROS:
+        return 0x4B;
+      case ROCKSDB_NAMESPACE::Histograms::CLOUD_OPEN_DB_MICROS:
+        return 0x4C;
+      case ROCKSDB_NAMESPACE::Histograms::CLOUD_OPEN_MICROS:
+        return 0x4D;
+      case ROCKSDB_NAMESPACE::Histograms::CLOUD_SCHEDULER_LAG_MICROS:
+        return 0x4E;
       case ROCKSDB_NAMESPACE::Histograms::HISTOGRAM_ENUM_MAX:
         // 0x3D for backwards compatibility on current minor version.
         return 0x3E;
@@ -6024,6 +6163,42 @@ class HistogramTypeJni {
       case 0x3D:
         return ROCKSDB_NAMESPACE::Histograms::
             TABLE_OPEN_PREFETCH_TAIL_READ_BYTES;
+      case 0x3F:
+        return ROCKSDB_NAMESPACE::Histograms::CLOUD_READ_MICROS;
+      case 0x40:
+        return ROCKSDB_NAMESPACE::Histograms::CLOUD_WRITE_MICROS;
+      case 0x41:
+        return ROCKSDB_NAMESPACE::Histograms::CLOUD_INFO_MICROS;
+      case 0x42:
+        return ROCKSDB_NAMESPACE::Histograms::CLOUD_LIST_MICROS;
+      case 0x43:
+        return ROCKSDB_NAMESPACE::Histograms::CLOUD_COPY_MICROS;
+      case 0x44:
+        return ROCKSDB_NAMESPACE::Histograms::CLOUD_DELETE_MICROS;
+      case 0x45:
+        return ROCKSDB_NAMESPACE::Histograms::CLOUD_CREATE_MICROS;
+      case 0x46:
+        return ROCKSDB_NAMESPACE::Histograms::
+            REPLICATION_MEMTABLE_WRITE_APPLY_MICROS;
+      case 0x47:
+        return ROCKSDB_NAMESPACE::Histograms::
+            REPLICATION_MEMTABLE_SWITCH_APPLY_MICROS;
+      case 0x48:
+        return ROCKSDB_NAMESPACE::Histograms::
+            REPLICATION_MANIFEST_WRITE_APPLY_MICROS;
+      case 0x49:
+        return ROCKSDB_NAMESPACE::Histograms::CLOUD_UPLOAD_QUEUE_DEPTH;
+      case 0x4A:
+        return ROCKSDB_NAMESPACE::Histograms::CLOUD_OPEN_SANITIZE_MICROS;
+      case 0x4B:
+        return ROCKSDB_NAMESPACE::Histograms::
+            CLOUD_OPEN_LOAD_CLOUD_MANIFEST_MICROS;
+      case 0x4C:
+        return ROCKSDB_NAMESPACE::Histograms::CLOUD_OPEN_DB_MICROS;
+      case 0x4D:
+        return ROCKSDB_NAMESPACE::Histograms::CLOUD_OPEN_MICROS;
+      case 0x4E:
+        return ROCKSDB_NAMESPACE::Histograms::CLOUD_SCHEDULER_LAG_MICROS;
       case 0x3E:
         // 0x1F for backwards compatibility on current minor version.
         return ROCKSDB_NAMESPACE::Histograms::HISTOGRAM_ENUM_MAX;
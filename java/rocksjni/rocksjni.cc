@@ -11,7 +11,9 @@
 #include <stdlib.h>
 
 #include <algorithm>
+#include <cstring>
 #include <functional>
+#include <limits>
 #include <memory>
 #include <string>
 #include <tuple>
@@ -1817,6 +1819,90 @@ void Java_org_rocksdb_RocksDB_multiGet__JJ_3J_3Ljava_nio_ByteBuffer_2_3I_3I_3Lja
       env, values, statuses, jvalues, jvalues_sizes, jstatus_objects);
 }
 
+/**
+ * @brief MultiGet() of keys packed in a direct ByteBuffer, the values and
+ * status codes being written to direct ByteBuffers too, with no JNI call nor
+ * Java object per key
+ *
+ * Class:     org_rocksdb_RocksDB
+ * Method:    multiGetPacked
+ * Signature:
+ * (JJJILjava/nio/ByteBuffer;Ljava/nio/ByteBuffer;Ljava/nio/ByteBuffer;Ljava/nio/ByteBuffer;Ljava/nio/ByteBuffer;)J
+ */
+jlong Java_org_rocksdb_RocksDB_multiGetPacked(
+    JNIEnv* env, jclass, jlong jdb_handle, jlong jropt_handle,
+    jlong jcf_handle, jint jnum_keys, jobject jkeys, jobject jkey_offsets,
+    jobject jvalues, jobject jvalue_offsets, jobject jstatuses) {
+  const char* keys_data;
+  const jint* key_offsets;
+  if (!ROCKSDB_NAMESPACE::JniUtil::packed_direct(
+          env, jkeys, jkey_offsets, jnum_keys, &keys_data, &key_offsets)) {
+    // exception thrown
+    return 0;
+  }
+  char* values_data =
+      reinterpret_cast<char*>(env->GetDirectBufferAddress(jvalues));
+  auto* value_offsets =
+      reinterpret_cast<jint*>(env->GetDirectBufferAddress(jvalue_offsets));
+  auto* status_codes =
+      reinterpret_cast<jbyte*>(env->GetDirectBufferAddress(jstatuses));
+  if (values_data == nullptr || value_offsets == nullptr ||
+      status_codes == nullptr ||
+      env->GetDirectBufferCapacity(jvalue_offsets) <
+          (static_cast<jlong>(jnum_keys) + 1) *
+              static_cast<jlong>(sizeof(jint)) ||
+      env->GetDirectBufferCapacity(jstatuses) < jnum_keys) {
+    ROCKSDB_NAMESPACE::RocksDBExceptionJni::ThrowNew(
+        env,
+        "Invalid values argument (not direct ByteBuffers or smaller than the "
+        "number of keys)");
+    return 0;
+  }
+  const size_t values_capacity =
+      static_cast<size_t>(std::min<jlong>(env->GetDirectBufferCapacity(jvalues),
+                                          std::numeric_limits<jint>::max()));
+
+  const size_t num_keys = static_cast<size_t>(jnum_keys);
+  std::vector<ROCKSDB_NAMESPACE::Slice> keys(num_keys);
+  for (size_t i = 0; i < num_keys; i++) {
+    keys[i] = ROCKSDB_NAMESPACE::Slice(keys_data + key_offsets[i],
+                                       key_offsets[i + 1] - key_offsets[i]);
+  }
+  std::vector<ROCKSDB_NAMESPACE::PinnableSlice> values(num_keys);
+  std::vector<ROCKSDB_NAMESPACE::Status> statuses(num_keys);
+  auto* db = reinterpret_cast<ROCKSDB_NAMESPACE::DB*>(jdb_handle);
+  auto* cf_handle =
+      jcf_handle == 0
+          ? db->DefaultColumnFamily()
+          : reinterpret_cast<ROCKSDB_NAMESPACE::ColumnFamilyHandle*>(
+                jcf_handle);
+  db->MultiGet(*reinterpret_cast<ROCKSDB_NAMESPACE::ReadOptions*>(jropt_handle),
+               cf_handle, num_keys, keys.data(), values.data(),
+               statuses.data(), false /* sorted_input */);
+
+  // Values which don't fit in what is left get Incomplete, so that the caller
+  // can retry them with a larger buffer
+  size_t pos = 0;
+  jlong needed = 0;
+  value_offsets[0] = 0;
+  for (size_t i = 0; i < num_keys; i++) {
+    auto code = statuses[i].code();
+    if (statuses[i].ok()) {
+      const size_t size = values[i].size();
+      needed += static_cast<jlong>(size);
+      if (size <= values_capacity - pos) {
+        memcpy(values_data + pos, values[i].data(), size);
+        pos += size;
+      } else {
+        code = ROCKSDB_NAMESPACE::Status::Code::kIncomplete;
+      }
+    }
+    status_codes[i] = ROCKSDB_NAMESPACE::StatusJni::toJavaStatusCode(code);
+    value_offsets[i + 1] = static_cast<jint>(pos);
+  }
+  return needed;
+}
+
 //////////////////////////////////////////////////////////////////////////////
 // ROCKSDB_NAMESPACE::DB::KeyMayExist
 bool key_may_exist_helper(JNIEnv* env, jlong jdb_handle, jlong jcf_handle,
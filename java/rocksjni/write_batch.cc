@@ -224,6 +224,46 @@ void Java_org_rocksdb_WriteBatch_putDirectJni(JNIEnv* env, jclass /*jobj*/,
       put, env, jkey, jkey_offset, jkey_len, jval, jval_offset, jval_len);
 }
 
+/*
+ * Class:     org_rocksdb_WriteBatch
+ * Method:    putPackedJni
+ * Signature:
+ * (JILjava/nio/ByteBuffer;Ljava/nio/ByteBuffer;Ljava/nio/ByteBuffer;Ljava/nio/ByteBuffer;J)V
+ */
+void Java_org_rocksdb_WriteBatch_putPackedJni(
+    JNIEnv* env, jclass /*jobj*/, jlong jwb_handle, jint jcount, jobject jkeys,
+    jobject jkey_offsets, jobject jvalues, jobject jvalue_offsets,
+    jlong jcf_handle) {
+  auto* wb = reinterpret_cast<ROCKSDB_NAMESPACE::WriteBatch*>(jwb_handle);
+  assert(wb != nullptr);
+  auto* cf_handle =
+      reinterpret_cast<ROCKSDB_NAMESPACE::ColumnFamilyHandle*>(jcf_handle);
+  const char* keys;
+  const jint* key_offsets;
+  const char* values;
+  const jint* value_offsets;
+  if (!ROCKSDB_NAMESPACE::JniUtil::packed_direct(env, jkeys, jkey_offsets,
+                                                 jcount, &keys, &key_offsets) ||
+      !ROCKSDB_NAMESPACE::JniUtil::packed_direct(
+          env, jvalues, jvalue_offsets, jcount, &values, &value_offsets)) {
+    // exception thrown
+    return;
+  }
+  for (jint i = 0; i < jcount; i++) {
+    ROCKSDB_NAMESPACE::Slice key(keys + key_offsets[i],
+                                 key_offsets[i + 1] - key_offsets[i]);
+    ROCKSDB_NAMESPACE::Slice value(values + value_offsets[i],
+                                   value_offsets[i + 1] - value_offsets[i]);
+    ROCKSDB_NAMESPACE::Status s = cf_handle == nullptr
+                                      ? wb->Put(key, value)
+                                      : wb->Put(cf_handle, key, value);
+    if (!s.ok()) {
+      ROCKSDB_NAMESPACE::RocksDBExceptionJni::ThrowNew(env, s);
+      return;
+    }
+  }
+}
+
 /*
  * Class:     org_rocksdb_WriteBatch
  * Method:    merge
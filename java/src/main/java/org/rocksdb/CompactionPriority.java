@@ -41,7 +41,15 @@ public enum CompactionPriority {
    * level. The file picking process will cycle through all the files in a
    * round-robin manner.
    */
-  RoundRobin((byte)0x4);
+  RoundRobin((byte)0x4),
+
+  /**
+   * Like MinOverlappingRatio, but divides the overlapping ratio of each file
+   * by the number of reads sampled from it, so that the files queries hit
+   * most are compacted first. Files without sampled reads are compacted
+   * after all the others.
+   */
+  MinOverlappingRatioByReads((byte)0x5);
 
 
   private final byte value;
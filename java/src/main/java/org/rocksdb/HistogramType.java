@@ -210,6 +210,88 @@ public enum HistogramType {
    */
   TABLE_OPEN_PREFETCH_TAIL_READ_BYTES((byte) 0x3D),
 
+  /**
+   * Latency of cloud storage read requests.
+   */
+  CLOUD_READ_MICROS((byte) 0x3F),
+
+  /**
+   * Latency of cloud storage write requests.
+   */
+  CLOUD_WRITE_MICROS((byte) 0x40),
+
+  /**
+   * Latency of cloud storage info requests.
+   */
+  CLOUD_INFO_MICROS((byte) 0x41),
+
+  /**
+   * Latency of cloud storage list requests.
+   */
+  CLOUD_LIST_MICROS((byte) 0x42),
+
+  /**
+   * Latency of cloud storage copy requests.
+   */
+  CLOUD_COPY_MICROS((byte) 0x43),
+
+  /**
+   * Latency of cloud storage delete requests.
+   */
+  CLOUD_DELETE_MICROS((byte) 0x44),
+
+  /**
+   * Latency of cloud storage create requests.
+   */
+  CLOUD_CREATE_MICROS((byte) 0x45),
+
+  /**
+   * Time to apply a replicated memtable write.
+   */
+  REPLICATION_MEMTABLE_WRITE_APPLY_MICROS((byte) 0x46),
+
+  /**
+   * Time to apply a replicated memtable switch.
+   */
+  REPLICATION_MEMTABLE_SWITCH_APPLY_MICROS((byte) 0x47),
+
+  /**
+   * Time to apply a replicated manifest write.
+   */
+  REPLICATION_MANIFEST_WRITE_APPLY_MICROS((byte) 0x48),
+
+  /**
+   * Number of uploads to the cloud storage waiting for a slot.
+   */
+  CLOUD_UPLOAD_QUEUE_DEPTH((byte) 0x49),
+
+  /**
+   * Time spent preparing the local directory when opening a cloud DB.
+   */
+  CLOUD_OPEN_SANITIZE_MICROS((byte) 0x4A),
+
+  /**
+   * Time spent loading the CLOUDMANIFEST and the MANIFEST when opening a
+   * cloud DB.
+   */
+  CLOUD_OPEN_LOAD_CLOUD_MANIFEST_MICROS((byte) 0x4B),
+
+  /**
+   * Time spent opening the DB over the loaded manifests when opening a
+   * cloud DB.
+   */
+  CLOUD_OPEN_DB_MICROS((byte) 0x4C),
+
+  /**
+   * Time spent opening a cloud DB.
+   */
+  CLOUD_OPEN_MICROS((byte) 0x4D),
+
+  /**
+   * Time between when a job of the cloud scheduler is due and when it starts.
+   */
+  CLOUD_SCHEDULER_LAG_MICROS((byte) 0x4E),
+
   // 0x3E for backwards compatibility on current minor version.
   HISTOGRAM_ENUM_MAX((byte) 0x3E);
 
@@ -2570,6 +2570,42 @@ public class RocksDB extends RocksObject {
     return results;
   }
 
+  /**
+   * Fetches the values of a batch of keys in a single JNI call and without allocating any Java
+   * object, the keys being read from and the values written to caller-provided direct buffers.
+   * <p>
+   * The keys are packed back to back in {@code keys}, key {@code i} spanning the bytes from
+   * offset {@code keyOffsets[i]} to {@code keyOffsets[i + 1]} of it, where {@code keyOffsets}
+   * holds {@code numKeys + 1} ints in native byte order. The values found are packed the same
+   * way into {@code values} and {@code valueOffsets}, and the {@link Status.Code} of each key is
+   * written as a byte to {@code statuses}. Missing keys get an empty value and
+   * {@code NotFound}, and values which don't fit in what is left of {@code values} get an empty
+   * value and {@code Incomplete}. The offsets are absolute, the positions and limits of the
+   * buffers being ignored.
+   * </p>
+   *
+   * @param readOptions Read options
+   * @param columnFamilyHandle the column family of the keys, or null for the default one
+   * @param numKeys the number of keys
+   * @param keys direct buffer of the packed keys
+   * @param keyOffsets direct buffer of the {@code numKeys + 1} offsets of the keys
+   * @param values direct buffer to write the packed values to
+   * @param valueOffsets direct buffer to write the {@code numKeys + 1} offsets of the values to
+   * @param statuses direct buffer to write the {@code numKeys} status codes to
+   * @return the number of bytes needed to hold all the values found, more than the capacity of
+   *     {@code values} if some of them are {@code Incomplete}
+   * @throws RocksDBException if the buffers are not direct or too small, or the offsets are out
+   *     of bounds
+   */
+  public long multiGetPacked(final ReadOptions readOptions,
+      final ColumnFamilyHandle columnFamilyHandle, final int numKeys, final ByteBuffer keys,
+      final ByteBuffer keyOffsets, final ByteBuffer values, final ByteBuffer valueOffsets,
+      final ByteBuffer statuses) throws RocksDBException {
+    return multiGetPacked(nativeHandle_, readOptions.nativeHandle_,
+        columnFamilyHandle == null ? 0 : columnFamilyHandle.nativeHandle_, numKeys, keys,
+        keyOffsets, values, valueOffsets, statuses);
+  }
+
   /**
    *  Check if a key exists in the database.
    *  This method is not as lightweight as {@code keyMayExist} but it gives a 100% guarantee
@@ -4968,6 +5004,11 @@ public class RocksDB extends RocksObject {
       final int[] keyLengths, final ByteBuffer[] valuesArray, final int[] valuesSizeArray,
       final Status[] statusArray);
 
+  private static native long multiGetPacked(final long dbHandle, final long rOptHandle,
+      final long cfHandle, final int numKeys, final ByteBuffer keys, final ByteBuffer keyOffsets,
+      final ByteBuffer values, final ByteBuffer valueOffsets, final ByteBuffer statuses)
+      throws RocksDBException;
+
   private static native boolean keyExists(final long handle, final long cfHandle,
       final long readOptHandle, final byte[] key, final int keyOffset, final int keyLength);
 
@@ -878,6 +878,81 @@ public enum TickerType {
 
     SST_FOOTER_CORRUPTION_COUNT((byte) -0x55),
 
+    /**
+     * GET requests to the cloud storage.
+     */
+    CLOUD_READ_REQUESTS((byte) -0x56),
+
+    /**
+     * PUT requests to the cloud storage, including multipart upload requests.
+     */
+    CLOUD_WRITE_REQUESTS((byte) -0x57),
+
+    /**
+     * HEAD requests to the cloud storage.
+     */
+    CLOUD_INFO_REQUESTS((byte) -0x58),
+
+    /**
+     * LIST requests to the cloud storage.
+     */
+    CLOUD_LIST_REQUESTS((byte) -0x59),
+
+    /**
+     * Server-side COPY requests to the cloud storage.
+     */
+    CLOUD_COPY_REQUESTS((byte) -0x5A),
+
+    /**
+     * DELETE requests to the cloud storage.
+     */
+    CLOUD_DELETE_REQUESTS((byte) -0x5B),
+
+    /**
+     * Bucket creation requests to the cloud storage.
+     */
+    CLOUD_CREATE_REQUESTS((byte) -0x5C),
+
+    /**
+     * Cloud storage requests that failed, after all their retries.
+     */
+    CLOUD_REQUEST_FAILURES((byte) -0x5D),
+
+    /**
+     * Bytes downloaded from the cloud storage.
+     */
+    CLOUD_BYTES_READ((byte) -0x5E),
+
+    /**
+     * Bytes uploaded to the cloud storage.
+     */
+    CLOUD_BYTES_WRITTEN((byte) -0x5F),
+
+    /**
+     * Retries of cloud storage requests.
+     */
+    CLOUD_REQUEST_RETRIES((byte) -0x60),
+
+    /**
+     * Cloud storage requests rejected because of throttling (e.g. S3 SlowDown).
+     */
+    CLOUD_REQUEST_THROTTLES((byte) -0x61),
+
+    /**
+     * Replication log records applied by the follower.
+     */
+    REPLICATION_RECORDS_APPLIED((byte) -0x62),
+
+    /**
+     * Bytes of replication log records applied by the follower.
+     */
+    REPLICATION_BYTES_APPLIED((byte) -0x63),
+
+    /**
+     * Replication epoch updates.
+     */
+    REPLICATION_EPOCH_UPDATES((byte) -0x64),
+
     TICKER_ENUM_MAX((byte) -0x54);
 
     private final byte value;
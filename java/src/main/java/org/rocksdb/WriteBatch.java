@@ -259,6 +259,34 @@ public class WriteBatch extends AbstractWriteBatch {
       final int keyOffset, final int keyLength, final ByteBuffer value, final int valueOffset,
       final int valueLength, final long cfHandle);
 
+  /**
+   * Stores a batch of key-value pairs in a single JNI call, the keys and values being packed
+   * back to back in direct buffers: key {@code i} spans the bytes from offset
+   * {@code keyOffsets[i]} to {@code keyOffsets[i + 1]} of {@code keys}, where
+   * {@code keyOffsets} holds {@code numEntries + 1} ints in native byte order, and the values
+   * are laid out the same way in {@code values} and {@code valueOffsets}. The offsets are
+   * absolute, the positions and limits of the buffers being ignored.
+   *
+   * @param columnFamilyHandle the column family of the entries, or null for the default one
+   * @param numEntries the number of key-value pairs
+   * @param keys direct buffer of the packed keys
+   * @param keyOffsets direct buffer of the {@code numEntries + 1} offsets of the keys
+   * @param values direct buffer of the packed values
+   * @param valueOffsets direct buffer of the {@code numEntries + 1} offsets of the values
+   * @throws RocksDBException if the buffers are not direct or too small, or the offsets are out
+   *     of bounds
+   */
+  public void putPacked(final ColumnFamilyHandle columnFamilyHandle, final int numEntries,
+      final ByteBuffer keys, final ByteBuffer keyOffsets, final ByteBuffer values,
+      final ByteBuffer valueOffsets) throws RocksDBException {
+    putPackedJni(nativeHandle_, numEntries, keys, keyOffsets, values, valueOffsets,
+        columnFamilyHandle == null ? 0 : columnFamilyHandle.nativeHandle_);
+  }
+
+  private static native void putPackedJni(final long handle, final int numEntries,
+      final ByteBuffer keys, final ByteBuffer keyOffsets, final ByteBuffer values,
+      final ByteBuffer valueOffsets, final long cfHandle) throws RocksDBException;
+
   @Override
   final void merge(final long handle, final byte[] key, final int keyLen, final byte[] value,
       final int valueLen) {
@@ -7,6 +7,7 @@ package org.rocksdb;
 import static org.assertj.core.api.Assertions.*;
 
 import java.nio.ByteBuffer;
+import java.nio.ByteOrder;
 import java.util.ArrayList;
 import java.util.Arrays;
 import java.util.List;
@@ -991,6 +992,58 @@ public class MultiGetTest {
     }
   }
 
+  @Test
+  public void putPackedThenMultiGetPacked() throws RocksDBException {
+    try (final Options opt = new Options().setCreateIfMissing(true);
+         final RocksDB db = RocksDB.open(opt, dbFolder.getRoot().getAbsolutePath());
+         final WriteBatch batch = new WriteBatch();
+         final WriteOptions writeOptions = new WriteOptions();
+         final ReadOptions readOptions = new ReadOptions()) {
+      final ByteBuffer keys = ByteBuffer.allocateDirect(64);
+      final ByteBuffer keyOffsets = ByteBuffer.allocateDirect(64).order(ByteOrder.nativeOrder());
+      final ByteBuffer values = ByteBuffer.allocateDirect(64);
+      final ByteBuffer valueOffsets =
+          ByteBuffer.allocateDirect(64).order(ByteOrder.nativeOrder());
+      keys.put("key1key3".getBytes());
+      keyOffsets.putInt(0, 0).putInt(4, 4).putInt(8, 8);
+      values.put("value1ForKey1value3ForKey3".getBytes());
+      valueOffsets.putInt(0, 0).putInt(4, 13).putInt(8, 26);
+      batch.putPacked(db.getDefaultColumnFamily(), 2, keys, keyOffsets, values, valueOffsets);
+      db.write(writeOptions, batch);
+
+      // key2 is missing, and value3ForKey3 doesn't fit in the values buffer
+      keys.clear();
+      keys.put("key1key2key3".getBytes());
+      keyOffsets.putInt(0, 0).putInt(4, 4).putInt(8, 8).putInt(12, 12);
+      final ByteBuffer smallValues = ByteBuffer.allocateDirect(20);
+      final ByteBuffer statuses = ByteBuffer.allocateDirect(3);
+      final long needed = db.multiGetPacked(
+          readOptions, null, 3, keys, keyOffsets, smallValues, valueOffsets, statuses);
+      assertThat(needed).isEqualTo(26);
+      assertThat(Status.Code.getCode(statuses.get(0))).isEqualTo(Status.Code.Ok);
+      assertThat(Status.Code.getCode(statuses.get(1))).isEqualTo(Status.Code.NotFound);
+      assertThat(Status.Code.getCode(statuses.get(2))).isEqualTo(Status.Code.Incomplete);
+      assertThat(valueOffsets.getInt(0)).isEqualTo(0);
+      assertThat(valueOffsets.getInt(4)).isEqualTo(13);
+      assertThat(valueOffsets.getInt(8)).isEqualTo(13);
+      assertThat(valueOffsets.getInt(12)).isEqualTo(13);
+      final byte[] value1 = new byte[13];
+      smallValues.get(value1);
+      assertThat(value1).isEqualTo("value1ForKey1".getBytes());
+
+      // A large enough buffer gets them all
+      assertThat(db.multiGetPacked(readOptions, db.getDefaultColumnFamily(), 3, keys,
+                     keyOffsets, values, valueOffsets, statuses))
+          .isEqualTo(26);
+      assertThat(Status.Code.getCode(statuses.get(2))).isEqualTo(Status.Code.Ok);
+      assertThat(valueOffsets.getInt(12)).isEqualTo(26);
+      final byte[] value3 = new byte[13];
+      values.position(13);
+      values.get(value3);
+      assertThat(value3).isEqualTo("value3ForKey3".getBytes());
+    }
+  }
+
   /**
    * This eventually doesn't throw as expected
    * At about 3rd loop of asking (on a 64GB M1 Max Mac)
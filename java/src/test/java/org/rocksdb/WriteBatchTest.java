@@ -19,6 +19,7 @@ import static org.rocksdb.util.CapturingWriteBatchHandler.Action.SINGLE_DELETE;
 
 import java.io.UnsupportedEncodingException;
 import java.nio.ByteBuffer;
+import java.nio.ByteOrder;
 import org.junit.ClassRule;
 import org.junit.Rule;
 import org.junit.Test;
@@ -116,6 +117,38 @@ public class WriteBatchTest {
     }
   }
 
+  @Test
+  public void putPacked() throws UnsupportedEncodingException, RocksDBException {
+    try (WriteBatch batch = new WriteBatch()) {
+      final ByteBuffer keys = ByteBuffer.allocateDirect(16);
+      final ByteBuffer keyOffsets = ByteBuffer.allocateDirect(12).order(ByteOrder.nativeOrder());
+      final ByteBuffer values = ByteBuffer.allocateDirect(16);
+      final ByteBuffer valueOffsets =
+          ByteBuffer.allocateDirect(12).order(ByteOrder.nativeOrder());
+      keys.put("foobaz".getBytes("US-ASCII"));
+      keyOffsets.putInt(0, 0).putInt(4, 3).putInt(8, 6);
+      values.put("barbooo".getBytes("US-ASCII"));
+      valueOffsets.putInt(0, 0).putInt(4, 3).putInt(8, 7);
+      batch.putPacked(null, 2, keys, keyOffsets, values, valueOffsets);
+
+      WriteBatchTestInternalHelper.setSequence(batch, 100);
+      assertThat(batch.count()).isEqualTo(2);
+      assertThat(new String(getContents(batch), "US-ASCII"))
+          .isEqualTo("Put(baz, booo)@101"
+              + "Put(foo, bar)@100");
+    }
+  }
+
+  @Test(expected = RocksDBException.class)
+  public void putPackedOutOfBounds() throws RocksDBException {
+    try (WriteBatch batch = new WriteBatch()) {
+      final ByteBuffer keys = ByteBuffer.allocateDirect(4);
+      final ByteBuffer offsets = ByteBuffer.allocateDirect(8).order(ByteOrder.nativeOrder());
+      offsets.putInt(0, 0).putInt(4, 5);
+      batch.putPacked(null, 1, keys, offsets, keys, offsets);
+    }
+  }
+
   @Test
   public void testAppendOperation()
       throws RocksDBException {
@@ -11,8 +11,11 @@
 // when the allocator object is destroyed. See the Arena class for more info.
 
 #pragma once
+#include <array>
+#include <atomic>
 #include <cerrno>
 #include <cstddef>
+#include <memory>
 
 #include "rocksdb/write_buffer_manager.h"
 
@@ -39,18 +42,35 @@ class AllocTracker {
   void operator=(const AllocTracker&) = delete;
 
   ~AllocTracker();
-  void Allocate(size_t bytes);
+  // numa_node: the NUMA node the bytes were allocated on, or -1 if unknown.
+  void Allocate(size_t bytes, int numa_node = -1);
   // Call when we're finished allocating memory so we can free it from
   // the write buffer's limit.
   void DoneAllocating();
 
   void FreeMem();
 
+  // Also charges the memory to tenant, including what was allocated so far.
+  // Must be called before the memory is allocated concurrently.
+  void SetWriteBufferManagerTenant(
+      std::shared_ptr<WriteBufferManager::Tenant> tenant);
+
   bool is_freed() const { return write_buffer_manager_ == nullptr || freed_; }
 
+  // Returns the bytes allocated on NUMA node `node` so far.
+  size_t numa_node_bytes_allocated(int node) const {
+    return node >= 0 && node < WriteBufferManager::kMaxNumaNodes
+               ? numa_bytes_allocated_[node].load(std::memory_order_relaxed)
+               : 0;
+  }
+
  private:
   WriteBufferManager* write_buffer_manager_;
+  std::shared_ptr<WriteBufferManager::Tenant> tenant_;
   std::atomic<size_t> bytes_allocated_;
+  // The part of bytes_allocated_ on each NUMA node.
+  std::array<std::atomic<size_t>, WriteBufferManager::kMaxNumaNodes>
+      numa_bytes_allocated_;
   bool done_allocating_;
   bool freed_;
 };
@@ -10,6 +10,9 @@
 #include "memory/arena.h"
 
 #include <algorithm>
+#ifdef NUMA
+#include <numa.h>
+#endif
 
 #include "logging/logging.h"
 #include "port/malloc.h"
@@ -33,8 +36,11 @@ size_t Arena::OptimizeBlockSize(size_t block_size) {
   return block_size;
 }
 
-Arena::Arena(size_t block_size, AllocTracker* tracker, size_t huge_page_size)
-    : kBlockSize(OptimizeBlockSize(block_size)), tracker_(tracker) {
+Arena::Arena(size_t block_size, AllocTracker* tracker, size_t huge_page_size,
+             int numa_node)
+    : kBlockSize(OptimizeBlockSize(block_size)),
+      numa_node_(numa_node),
+      tracker_(tracker) {
   assert(kBlockSize >= kMinBlockSize && kBlockSize <= kMaxBlockSize &&
          kBlockSize % kAlignUnit == 0);
   TEST_SYNC_POINT_CALLBACK("Arena::Arena:0", const_cast<size_t*>(&kBlockSize));
@@ -58,6 +64,11 @@ Arena::~Arena() {
     assert(tracker_->is_freed());
     tracker_->FreeMem();
   }
+#ifdef NUMA
+  for (const auto& block : numa_blocks_) {
+    numa_free(block.first, block.second);
+  }
+#endif
 }
 
 char* Arena::AllocateFallback(size_t bytes, bool aligned) {
@@ -96,10 +107,19 @@ char* Arena::AllocateFromHugePage(size_t bytes) {
   MemMapping mm = MemMapping::AllocateHuge(bytes);
   auto addr = static_cast<char*>(mm.Get());
   if (addr) {
+    int node = -1;
+#ifdef NUMA
+    // The pages are only placed when first touched, so the policy still
+    // applies to all of them.
+    if (numa_node_ >= 0) {
+      numa_tonode_memory(addr, bytes, numa_node_);
+      node = numa_node_;
+    }
+#endif
     huge_blocks_.push_back(std::move(mm));
     blocks_memory_ += bytes;
     if (tracker_ != nullptr) {
-      tracker_->Allocate(bytes);
+      tracker_->Allocate(bytes, node);
     }
   }
   return addr;
@@ -143,6 +163,20 @@ char* Arena::AllocateAligned(size_t bytes, size_t huge_page_size,
 }
 
 char* Arena::AllocateNewBlock(size_t block_bytes) {
+#ifdef NUMA
+  if (numa_node_ >= 0) {
+    char* block =
+        static_cast<char*>(numa_alloc_onnode(block_bytes, numa_node_));
+    if (block != nullptr) {
+      numa_blocks_.emplace_back(block, block_bytes);
+      blocks_memory_ += block_bytes;
+      if (tracker_ != nullptr) {
+        tracker_->Allocate(block_bytes, numa_node_);
+      }
+      return block;
+    }
+  }
+#endif
   // NOTE: std::make_unique zero-initializes the block so is not appropriate
   // here
   char* block = new char[block_bytes];
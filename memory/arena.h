@@ -15,6 +15,8 @@
 
 #include <cstddef>
 #include <deque>
+#include <utility>
+#include <vector>
 
 #include "memory/allocator.h"
 #include "port/mmap.h"
@@ -39,8 +41,12 @@ class Arena : public Allocator {
   // huge_page_size: if 0, don't use huge page TLB. If > 0 (should set to the
   // supported hugepage size of the system), block allocation will try huge
   // page TLB first. If allocation fails, will fall back to normal case.
+  // numa_node: if >= 0, in builds with NUMA support (-DNUMA), blocks are
+  // allocated on that NUMA node, falling back to the memory policy of the
+  // calling thread if that fails.
   explicit Arena(size_t block_size = kMinBlockSize,
-                 AllocTracker* tracker = nullptr, size_t huge_page_size = 0);
+                 AllocTracker* tracker = nullptr, size_t huge_page_size = 0,
+                 int numa_node = -1);
   ~Arena();
 
   char* Allocate(size_t bytes) override;
@@ -78,8 +84,10 @@ class Arena : public Allocator {
 
   size_t BlockSize() const override { return kBlockSize; }
 
+  int numa_node() const { return numa_node_; }
+
   bool IsInInlineBlock() const {
-    return blocks_.empty() && huge_blocks_.empty();
+    return blocks_.empty() && huge_blocks_.empty() && numa_blocks_.empty();
   }
 
   // check and adjust the block_size so that the return value is
@@ -95,6 +103,8 @@ class Arena : public Allocator {
   std::deque<std::unique_ptr<char[]>> blocks_;
   // Huge page allocations
   std::deque<MemMapping> huge_blocks_;
+  // Blocks allocated on numa_node_, and their sizes
+  std::vector<std::pair<char*, size_t>> numa_blocks_;
   size_t irregular_block_num = 0;
 
   // Stats for current active block.
@@ -109,6 +119,8 @@ class Arena : public Allocator {
 
   size_t hugetlb_size_ = 0;
 
+  const int numa_node_;
+
   char* AllocateFromHugePage(size_t bytes);
   char* AllocateFallback(size_t bytes, bool aligned);
   char* AllocateNewBlock(size_t block_bytes);
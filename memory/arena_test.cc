@@ -218,6 +218,25 @@ size_t PopMinorPageFaultCount() {
 #endif  // RUSAGE_SELF
 }
 
+TEST_F(ArenaTest, NumaNode) {
+  // Without NUMA support, or if the node has no memory, the blocks come from
+  // the usual allocator, so an arena of any node works.
+  for (int node : {0, 1}) {
+    Arena arena(Arena::kMinBlockSize, nullptr, 0, node);
+    ASSERT_EQ(node, arena.numa_node());
+    std::vector<char*> allocations;
+    for (int i = 0; i < 100; i++) {
+      char* p = arena.AllocateAligned(1000);
+      memset(p, i, 1000);
+      allocations.push_back(p);
+    }
+    for (int i = 0; i < 100; i++) {
+      ASSERT_EQ(static_cast<char>(i), allocations[i][999]);
+    }
+    ASSERT_GE(arena.MemoryAllocatedBytes(), 100 * 1000);
+  }
+}
+
 TEST(MmapTest, AllocateLazyZeroed) {
   // Doesn't have to be page aligned
   constexpr size_t len = 1234567;    // in bytes
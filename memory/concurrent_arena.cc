@@ -10,6 +10,9 @@
 #include "memory/concurrent_arena.h"
 
 #include <thread>
+#ifdef NUMA
+#include <numa.h>
+#endif
 
 #include "port/port.h"
 #include "util/random.h"
@@ -30,7 +33,11 @@ ConcurrentArena::ConcurrentArena(size_t block_size, AllocTracker* tracker,
                                  size_t huge_page_size)
     : shard_block_size_(std::min(kMaxShardBlockSize, block_size / 8)),
       shards_(),
-      arena_(block_size, tracker, huge_page_size) {
+      arena_(block_size, tracker, huge_page_size),
+      numa_allocated_and_unused_(0),
+      block_size_(block_size),
+      tracker_(tracker),
+      huge_page_size_(huge_page_size) {
   Fixup();
 }
 
@@ -42,4 +49,26 @@ ConcurrentArena::Shard* ConcurrentArena::Repick() {
   return shard_and_index.first;
 }
 
+Arena* ConcurrentArena::ShardArena() {
+#ifdef NUMA
+  static const bool multiple_nodes =
+      numa_available() >= 0 && numa_max_node() > 0;
+  if (multiple_nodes) {
+    int cpu = port::PhysicalCoreID();
+    int node = cpu >= 0 ? numa_node_of_cpu(cpu) : -1;
+    if (node >= 0) {
+      if (numa_arenas_.size() <= static_cast<size_t>(node)) {
+        numa_arenas_.resize(node + 1);
+      }
+      auto& arena = numa_arenas_[node];
+      if (arena == nullptr) {
+        arena.reset(new Arena(block_size_, tracker_, huge_page_size_, node));
+      }
+      return arena.get();
+    }
+  }
+#endif
+  return &arena_;
+}
+
 }  // namespace ROCKSDB_NAMESPACE
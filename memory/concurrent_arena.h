@@ -11,6 +11,7 @@
 #include <atomic>
 #include <memory>
 #include <utility>
+#include <vector>
 
 #include "memory/allocator.h"
 #include "memory/arena.h"
@@ -38,7 +39,10 @@ class Logger;
 // per-core shards, they are kept small, they are lazily instantiated
 // only if ConcurrentArena actually notices concurrent use, and they
 // adjust their size so that there is no fragmentation waste when the
-// shard blocks are allocated from the underlying main arena.
+// shard blocks are allocated from the underlying main arena.  In builds
+// with NUMA support (-DNUMA) on hosts with several NUMA nodes, the shard
+// blocks of the cores of each node come from an arena of that node instead,
+// so that concurrent writers fill memory local to them.
 class ConcurrentArena : public Allocator {
  public:
   // block_size and huge_page_size are the same as for Arena (and are
@@ -70,7 +74,13 @@ class ConcurrentArena : public Allocator {
   size_t ApproximateMemoryUsage() const {
     std::unique_lock<SpinMutex> lock(arena_mutex_, std::defer_lock);
     lock.lock();
-    return arena_.ApproximateMemoryUsage() - ShardAllocatedAndUnused();
+    size_t usage = arena_.ApproximateMemoryUsage();
+    for (const auto& arena : numa_arenas_) {
+      if (arena != nullptr) {
+        usage += arena->ApproximateMemoryUsage();
+      }
+    }
+    return usage - ShardAllocatedAndUnused();
   }
 
   size_t MemoryAllocatedBytes() const {
@@ -79,6 +89,7 @@ class ConcurrentArena : public Allocator {
 
   size_t AllocatedAndUnused() const {
     return arena_allocated_and_unused_.load(std::memory_order_relaxed) +
+           numa_allocated_and_unused_.load(std::memory_order_relaxed) +
            ShardAllocatedAndUnused();
   }
 
@@ -111,11 +122,25 @@ class ConcurrentArena : public Allocator {
   std::atomic<size_t> arena_allocated_and_unused_;
   std::atomic<size_t> memory_allocated_bytes_;
   std::atomic<size_t> irregular_block_num_;
+  // The arenas of the shard blocks of the cores of each NUMA node, by node,
+  // created when a shard of the node first needs a block. Protected by
+  // arena_mutex_.
+  std::vector<std::unique_ptr<Arena>> numa_arenas_;
+  std::atomic<size_t> numa_allocated_and_unused_;
+  // For creating numa_arenas_
+  const size_t block_size_;
+  AllocTracker* const tracker_;
+  const size_t huge_page_size_;
 
   char padding1[56] ROCKSDB_FIELD_UNUSED;
 
   Shard* Repick();
 
+  // Returns the arena of the NUMA node of the calling thread, or arena_ if
+  // memory is not placed by node.
+  // REQUIRES: arena_mutex_ is held
+  Arena* ShardArena();
+
   size_t ShardAllocatedAndUnused() const {
     size_t total = 0;
     for (size_t i = 0; i < shards_.Size(); ++i) {
@@ -159,13 +184,17 @@ class ConcurrentArena : public Allocator {
     if (avail < bytes) {
       // reload
       std::lock_guard<SpinMutex> reload_lock(arena_mutex_);
+      Arena* arena = ShardArena();
 
       // If the arena's current block is within a factor of 2 of the right
       // size, we adjust our request to avoid arena waste.
-      auto exact = arena_allocated_and_unused_.load(std::memory_order_relaxed);
-      assert(exact == arena_.AllocatedAndUnused());
+      auto exact = arena == &arena_
+                       ? arena_allocated_and_unused_.load(
+                             std::memory_order_relaxed)
+                       : arena->AllocatedAndUnused();
+      assert(exact == arena->AllocatedAndUnused());
 
-      if (exact >= bytes && arena_.IsInInlineBlock()) {
+      if (exact >= bytes && arena == &arena_ && arena_.IsInInlineBlock()) {
         // If we haven't exhausted arena's inline block yet, allocate from arena
         // directly. This ensures that we'll do the first few small allocations
         // without allocating any blocks.
@@ -182,7 +211,7 @@ class ConcurrentArena : public Allocator {
       avail = exact >= shard_block_size_ / 2 && exact < shard_block_size_ * 2
                   ? exact
                   : shard_block_size_;
-      s->free_begin_ = arena_.AllocateAligned(avail);
+      s->free_begin_ = arena->AllocateAligned(avail);
       Fixup();
     }
     s->allocated_and_unused_.store(avail - bytes, std::memory_order_relaxed);
@@ -200,10 +229,19 @@ class ConcurrentArena : public Allocator {
   }
 
   void Fixup() {
+    size_t allocated_bytes = arena_.MemoryAllocatedBytes();
+    size_t numa_allocated_and_unused = 0;
+    for (const auto& arena : numa_arenas_) {
+      if (arena != nullptr) {
+        allocated_bytes += arena->MemoryAllocatedBytes();
+        numa_allocated_and_unused += arena->AllocatedAndUnused();
+      }
+    }
     arena_allocated_and_unused_.store(arena_.AllocatedAndUnused(),
                                       std::memory_order_relaxed);
-    memory_allocated_bytes_.store(arena_.MemoryAllocatedBytes(),
-                                  std::memory_order_relaxed);
+    numa_allocated_and_unused_.store(numa_allocated_and_unused,
+                                     std::memory_order_relaxed);
+    memory_allocated_bytes_.store(allocated_bytes, std::memory_order_relaxed);
     irregular_block_num_.store(arena_.IrregularBlockNum(),
                                std::memory_order_relaxed);
   }
@@ -19,16 +19,39 @@ AllocTracker::AllocTracker(WriteBufferManager* write_buffer_manager)
     : write_buffer_manager_(write_buffer_manager),
       bytes_allocated_(0),
       done_allocating_(false),
-      freed_(false) {}
+      freed_(false) {
+  for (auto& bytes : numa_bytes_allocated_) {
+    bytes.store(0, std::memory_order_relaxed);
+  }
+}
 
 AllocTracker::~AllocTracker() { FreeMem(); }
 
-void AllocTracker::Allocate(size_t bytes) {
+void AllocTracker::Allocate(size_t bytes, int numa_node) {
   assert(write_buffer_manager_ != nullptr);
   if (write_buffer_manager_->enabled() ||
       write_buffer_manager_->cost_to_cache()) {
     bytes_allocated_.fetch_add(bytes, std::memory_order_relaxed);
+    if (tenant_ != nullptr) {
+      tenant_->memory_used.fetch_add(bytes, std::memory_order_relaxed);
+    }
     write_buffer_manager_->ReserveMem(bytes);
+    if (numa_node >= 0 && numa_node < WriteBufferManager::kMaxNumaNodes) {
+      numa_bytes_allocated_[numa_node].fetch_add(bytes,
+                                                 std::memory_order_relaxed);
+      write_buffer_manager_->ReserveNumaNodeMem(bytes, numa_node);
+    }
+  }
+}
+
+void AllocTracker::SetWriteBufferManagerTenant(
+    std::shared_ptr<WriteBufferManager::Tenant> tenant) {
+  assert(tenant_ == nullptr && !freed_);
+  tenant_ = std::move(tenant);
+  if (tenant_ != nullptr) {
+    tenant_->memory_used.fetch_add(
+        bytes_allocated_.load(std::memory_order_relaxed),
+        std::memory_order_relaxed);
   }
 }
 
@@ -52,8 +75,20 @@ void AllocTracker::FreeMem() {
   if (write_buffer_manager_ != nullptr && !freed_) {
     if (write_buffer_manager_->enabled() ||
         write_buffer_manager_->cost_to_cache()) {
+      if (tenant_ != nullptr) {
+        tenant_->memory_used.fetch_sub(
+            bytes_allocated_.load(std::memory_order_relaxed),
+            std::memory_order_relaxed);
+      }
       write_buffer_manager_->FreeMem(
           bytes_allocated_.load(std::memory_order_relaxed));
+      for (int node = 0; node < WriteBufferManager::kMaxNumaNodes; node++) {
+        const size_t bytes =
+            numa_bytes_allocated_[node].load(std::memory_order_relaxed);
+        if (bytes > 0) {
+          write_buffer_manager_->FreeNumaNodeMem(bytes, node);
+        }
+      }
     } else {
       assert(bytes_allocated_.load(std::memory_order_relaxed) == 0);
     }
@@ -0,0 +1,880 @@
+//  Copyright (c) 2011-present, Facebook, Inc.  All rights reserved.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+//
+// An adaptive radix tree (ART) over the memtable keys, after "The Adaptive
+// Radix Tree: ARTful Indexing for Main-Memory Databases" (Leis et al.) and
+// "The ART of Practical Synchronization" (Leis et al.) for the optimistic
+// lock coupling.
+//
+// The tree is indexed by a byte-comparable encoding of the internal key: the
+// user key with each 0x00 escaped as 0x00 0xFF, the terminator 0x00 0x00,
+// then the inverted packed sequence number and type in big-endian. Bytewise
+// order of the encodings is the order of the internal keys under the bytewise
+// comparator, and no encoding is a prefix of another, so every key ends in a
+// leaf. A leaf holds the encoding and the entry of the memtable.
+//
+// Nodes are allocated from the memtable's allocator and never freed, so a
+// reader may look at a node that a writer has replaced. Writers lock the
+// nodes they change; readers take no locks but check the version of each
+// node they read from and start over if it changed.
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstring>
+
+#include "db/dbformat.h"
+#include "db/memtable.h"
+#include "memory/arena.h"
+#include "port/port.h"
+#include "rocksdb/comparator.h"
+#include "rocksdb/memtablerep.h"
+#include "util/cast_util.h"
+
+namespace ROCKSDB_NAMESPACE {
+namespace {
+
+// Returns the size of the tree key of the internal key.
+size_t ArtKeySize(const Slice& internal_key) {
+  const Slice user_key = ExtractUserKey(internal_key);
+  size_t size = user_key.size() + 2 + sizeof(uint64_t);
+  for (size_t i = 0; i < user_key.size(); i++) {
+    if (user_key[i] == 0) {
+      size++;
+    }
+  }
+  return size;
+}
+
+// Writes the tree key of the internal key to dst, which must have room for
+// ArtKeySize(internal_key) bytes.
+void EncodeArtKey(const Slice& internal_key, char* dst) {
+  const Slice user_key = ExtractUserKey(internal_key);
+  for (size_t i = 0; i < user_key.size(); i++) {
+    *dst++ = user_key[i];
+    if (user_key[i] == 0) {
+      *dst++ = static_cast<char>(0xFF);
+    }
+  }
+  *dst++ = 0;
+  *dst++ = 0;
+  // Larger sequence numbers sort first.
+  const uint64_t footer = ~ExtractInternalKeyFooter(internal_key);
+  for (int shift = 56; shift >= 0; shift -= 8) {
+    *dst++ = static_cast<char>(footer >> shift);
+  }
+}
+
+void EncodeArtKey(const Slice& internal_key, std::string* dst) {
+  dst->resize(ArtKeySize(internal_key));
+  EncodeArtKey(internal_key, &(*dst)[0]);
+}
+
+struct Leaf {
+  const char* entry;
+  uint32_t key_size;
+  char key[1];
+
+  Slice Key() const { return Slice(key, key_size); }
+};
+
+enum NodeType : uint8_t {
+  kNode4,
+  kNode16,
+  kNode48,
+  kNode256,
+};
+
+// A version word as in optimistic lock coupling: bit 0 marks a node that
+// has been replaced, bit 1 is the write lock, and the rest counts changes.
+constexpr uint64_t kObsoleteBit = 1;
+constexpr uint64_t kLockedBit = 2;
+
+struct Node {
+  Node(NodeType _type, const char* _prefix_base, uint32_t prefix_len)
+      : version(0), type(_type), count(0), prefix_base(_prefix_base) {
+    SetPrefix(0, prefix_len);
+  }
+
+  // The prefix compressed into this node is prefix_base[offset, offset + len)
+  // with offset and len packed in prefix, so that readers see a consistent
+  // pair.
+  void SetPrefix(uint32_t offset, uint32_t len) {
+    prefix.store((static_cast<uint64_t>(offset) << 32) | len,
+                 std::memory_order_relaxed);
+  }
+  Slice Prefix() const {
+    const uint64_t packed = prefix.load(std::memory_order_relaxed);
+    return Slice(prefix_base + (packed >> 32),
+                 static_cast<uint32_t>(packed));
+  }
+
+  std::atomic<uint64_t> version;
+  const NodeType type;
+  std::atomic<uint16_t> count;
+  const char* const prefix_base;
+  std::atomic<uint64_t> prefix;
+};
+
+// Node4 and Node16 keep their keys sorted.
+template <size_t kCapacity>
+struct SortedNode : public Node {
+  SortedNode(NodeType _type, const char* _prefix_base, uint32_t prefix_len)
+      : Node(_type, _prefix_base, prefix_len) {
+    for (size_t i = 0; i < kCapacity; i++) {
+      keys[i].store(0, std::memory_order_relaxed);
+      children[i].store(0, std::memory_order_relaxed);
+    }
+  }
+
+  std::atomic<uint8_t> keys[kCapacity];
+  std::atomic<uintptr_t> children[kCapacity];
+};
+
+using Node4 = SortedNode<4>;
+using Node16 = SortedNode<16>;
+
+struct Node48 : public Node {
+  Node48(const char* _prefix_base, uint32_t prefix_len)
+      : Node(kNode48, _prefix_base, prefix_len) {
+    for (auto& i : index) {
+      i.store(0, std::memory_order_relaxed);
+    }
+    for (auto& c : children) {
+      c.store(0, std::memory_order_relaxed);
+    }
+  }
+
+  // One more than the slot of the child of each key byte, 0 if none.
+  std::atomic<uint8_t> index[256];
+  std::atomic<uintptr_t> children[48];
+};
+
+struct Node256 : public Node {
+  Node256(const char* _prefix_base, uint32_t prefix_len)
+      : Node(kNode256, _prefix_base, prefix_len) {
+    for (auto& c : children) {
+      c.store(0, std::memory_order_relaxed);
+    }
+  }
+
+  std::atomic<uintptr_t> children[256];
+};
+
+// Children are tagged pointers: leaves have the low bit set.
+bool IsLeaf(uintptr_t child) { return (child & 1) != 0; }
+const Leaf* AsLeaf(uintptr_t child) {
+  return reinterpret_cast<const Leaf*>(child & ~static_cast<uintptr_t>(1));
+}
+Node* AsNode(uintptr_t child) { return reinterpret_cast<Node*>(child); }
+uintptr_t Tag(const Leaf* leaf) {
+  return reinterpret_cast<uintptr_t>(leaf) | 1;
+}
+uintptr_t Tag(const Node* node) { return reinterpret_cast<uintptr_t>(node); }
+
+// Returns false if the node is obsolete, spinning while it is locked.
+bool ReadLock(const Node* node, uint64_t* version) {
+  uint64_t v = node->version.load(std::memory_order_acquire);
+  while ((v & kLockedBit) != 0) {
+    port::AsmVolatilePause();
+    v = node->version.load(std::memory_order_acquire);
+  }
+  *version = v;
+  return (v & kObsoleteBit) == 0;
+}
+
+// Returns true if the node did not change since ReadLock() returned version.
+bool Validate(const Node* node, uint64_t version) {
+  std::atomic_thread_fence(std::memory_order_acquire);
+  return node->version.load(std::memory_order_relaxed) == version;
+}
+
+bool UpgradeToWriteLock(Node* node, uint64_t version) {
+  if (!node->version.compare_exchange_strong(version, version + kLockedBit,
+                                             std::memory_order_acquire)) {
+    return false;
+  }
+  // A reader that sees any of the changes that follow also sees the lock.
+  std::atomic_thread_fence(std::memory_order_release);
+  return true;
+}
+
+void WriteUnlock(Node* node) {
+  node->version.fetch_add(kLockedBit, std::memory_order_release);
+}
+
+void WriteUnlockObsolete(Node* node) {
+  node->version.fetch_add(kLockedBit + kObsoleteBit,
+                          std::memory_order_release);
+}
+
+size_t Capacity(const Node* node) {
+  switch (node->type) {
+    case kNode4:
+      return 4;
+    case kNode16:
+      return 16;
+    case kNode48:
+      return 48;
+    default:
+      return 256;
+  }
+}
+
+size_t Count(const Node* node) {
+  return std::min<size_t>(node->count.load(std::memory_order_relaxed),
+                          Capacity(node));
+}
+
+template <size_t kCapacity>
+const SortedNode<kCapacity>* AsSorted(const Node* node) {
+  return static_cast<const SortedNode<kCapacity>*>(node);
+}
+
+template <size_t kCapacity>
+uintptr_t FindSorted(const Node* node, uint8_t b) {
+  const auto* n = AsSorted<kCapacity>(node);
+  const size_t count = Count(node);
+  for (size_t i = 0; i < count; i++) {
+    if (n->keys[i].load(std::memory_order_relaxed) == b) {
+      return n->children[i].load(std::memory_order_relaxed);
+    }
+  }
+  return 0;
+}
+
+// Returns the child of key byte b, 0 if none.
+uintptr_t FindChild(const Node* node, uint8_t b) {
+  switch (node->type) {
+    case kNode4:
+      return FindSorted<4>(node, b);
+    case kNode16:
+      return FindSorted<16>(node, b);
+    case kNode48: {
+      const auto* n = static_cast<const Node48*>(node);
+      const uint8_t slot = n->index[b].load(std::memory_order_relaxed);
+      return slot == 0 ? 0
+                       : n->children[std::min(slot - 1, 47)].load(
+                             std::memory_order_relaxed);
+    }
+    default:
+      return static_cast<const Node256*>(node)->children[b].load(
+          std::memory_order_relaxed);
+  }
+}
+
+// Returns the child with the smallest key byte >= b, 0 if none.
+uintptr_t NextChild(const Node* node, int b) {
+  switch (node->type) {
+    case kNode4:
+    case kNode16: {
+      const size_t count = Count(node);
+      const auto* keys = node->type == kNode4 ? AsSorted<4>(node)->keys
+                                              : AsSorted<16>(node)->keys;
+      const auto* children = node->type == kNode4
+                                 ? AsSorted<4>(node)->children
+                                 : AsSorted<16>(node)->children;
+      for (size_t i = 0; i < count; i++) {
+        if (keys[i].load(std::memory_order_relaxed) >= b) {
+          return children[i].load(std::memory_order_relaxed);
+        }
+      }
+      return 0;
+    }
+    case kNode48: {
+      const auto* n = static_cast<const Node48*>(node);
+      for (int k = b; k < 256; k++) {
+        const uint8_t slot = n->index[k].load(std::memory_order_relaxed);
+        if (slot != 0) {
+          return n->children[std::min(slot - 1, 47)].load(
+              std::memory_order_relaxed);
+        }
+      }
+      return 0;
+    }
+    default: {
+      const auto* n = static_cast<const Node256*>(node);
+      for (int k = b; k < 256; k++) {
+        const uintptr_t child = n->children[k].load(std::memory_order_relaxed);
+        if (child != 0) {
+          return child;
+        }
+      }
+      return 0;
+    }
+  }
+}
+
+// Returns the child with the largest key byte <= b, 0 if none.
+uintptr_t PrevChild(const Node* node, int b) {
+  switch (node->type) {
+    case kNode4:
+    case kNode16: {
+      const size_t count = Count(node);
+      const auto* keys = node->type == kNode4 ? AsSorted<4>(node)->keys
+                                              : AsSorted<16>(node)->keys;
+      const auto* children = node->type == kNode4
+                                 ? AsSorted<4>(node)->children
+                                 : AsSorted<16>(node)->children;
+      for (size_t i = count; i > 0; i--) {
+        if (keys[i - 1].load(std::memory_order_relaxed) <= b) {
+          return children[i - 1].load(std::memory_order_relaxed);
+        }
+      }
+      return 0;
+    }
+    case kNode48: {
+      const auto* n = static_cast<const Node48*>(node);
+      for (int k = b; k >= 0; k--) {
+        const uint8_t slot = n->index[k].load(std::memory_order_relaxed);
+        if (slot != 0) {
+          return n->children[std::min(slot - 1, 47)].load(
+              std::memory_order_relaxed);
+        }
+      }
+      return 0;
+    }
+    default: {
+      const auto* n = static_cast<const Node256*>(node);
+      for (int k = b; k >= 0; k--) {
+        const uintptr_t child = n->children[k].load(std::memory_order_relaxed);
+        if (child != 0) {
+          return child;
+        }
+      }
+      return 0;
+    }
+  }
+}
+
+// The functions below change a node and require its write lock.
+
+template <size_t kCapacity>
+void AddSorted(Node* node, uint8_t b, uintptr_t child) {
+  auto* n = static_cast<SortedNode<kCapacity>*>(node);
+  size_t count = Count(node);
+  assert(count < kCapacity);
+  size_t pos = count;
+  while (pos > 0 && n->keys[pos - 1].load(std::memory_order_relaxed) > b) {
+    n->keys[pos].store(n->keys[pos - 1].load(std::memory_order_relaxed),
+                       std::memory_order_relaxed);
+    n->children[pos].store(
+        n->children[pos - 1].load(std::memory_order_relaxed),
+        std::memory_order_relaxed);
+    pos--;
+  }
+  n->keys[pos].store(b, std::memory_order_relaxed);
+  n->children[pos].store(child, std::memory_order_relaxed);
+  node->count.store(static_cast<uint16_t>(count + 1),
+                    std::memory_order_relaxed);
+}
+
+// REQUIRES: the node is not full and has no child for b.
+void AddChild(Node* node, uint8_t b, uintptr_t child) {
+  switch (node->type) {
+    case kNode4:
+      AddSorted<4>(node, b, child);
+      break;
+    case kNode16:
+      AddSorted<16>(node, b, child);
+      break;
+    case kNode48: {
+      auto* n = static_cast<Node48*>(node);
+      const size_t slot = Count(node);
+      assert(slot < 48);
+      n->children[slot].store(child, std::memory_order_relaxed);
+      n->index[b].store(static_cast<uint8_t>(slot + 1),
+                        std::memory_order_relaxed);
+      node->count.store(static_cast<uint16_t>(slot + 1),
+                        std::memory_order_relaxed);
+      break;
+    }
+    default:
+      static_cast<Node256*>(node)->children[b].store(
+          child, std::memory_order_relaxed);
+      node->count.store(static_cast<uint16_t>(Count(node) + 1),
+                        std::memory_order_relaxed);
+      break;
+  }
+}
+
+template <size_t kCapacity>
+void ReplaceSorted(Node* node, uint8_t b, uintptr_t child) {
+  auto* n = static_cast<SortedNode<kCapacity>*>(node);
+  const size_t count = Count(node);
+  for (size_t i = 0; i < count; i++) {
+    if (n->keys[i].load(std::memory_order_relaxed) == b) {
+      n->children[i].store(child, std::memory_order_relaxed);
+      return;
+    }
+  }
+  assert(false);
+}
+
+// REQUIRES: the node has a child for b.
+void ReplaceChild(Node* node, uint8_t b, uintptr_t child) {
+  switch (node->type) {
+    case kNode4:
+      ReplaceSorted<4>(node, b, child);
+      break;
+    case kNode16:
+      ReplaceSorted<16>(node, b, child);
+      break;
+    case kNode48: {
+      auto* n = static_cast<Node48*>(node);
+      const uint8_t slot = n->index[b].load(std::memory_order_relaxed);
+      assert(slot != 0);
+      n->children[slot - 1].store(child, std::memory_order_relaxed);
+      break;
+    }
+    default:
+      static_cast<Node256*>(node)->children[b].store(
+          child, std::memory_order_relaxed);
+      break;
+  }
+}
+
+class ARTRep : public MemTableRep {
+ public:
+  explicit ARTRep(Allocator* allocator)
+      : MemTableRep(allocator),
+        root_(new (allocator->AllocateAligned(sizeof(Node256)))
+                  Node256(nullptr, 0)) {}
+
+  void Insert(KeyHandle handle) override {
+    bool inserted = InsertKey(handle);
+    assert(inserted);
+    (void)inserted;
+  }
+
+  bool InsertKey(KeyHandle handle) override {
+    const char* entry = static_cast<const char*>(handle);
+    const Leaf* leaf = NewLeaf(GetLengthPrefixedSlice(entry), entry);
+    for (;;) {
+      const InsertResult result = TryInsert(leaf);
+      if (result != kRestart) {
+        return result == kInserted;
+      }
+    }
+  }
+
+  void InsertConcurrently(KeyHandle handle) override {
+    bool inserted = InsertKey(handle);
+    assert(inserted);
+    (void)inserted;
+  }
+
+  bool InsertKeyConcurrently(KeyHandle handle) override {
+    return InsertKey(handle);
+  }
+
+  bool Contains(const char* key) const override {
+    std::string art_key;
+    EncodeArtKey(GetLengthPrefixedSlice(key), &art_key);
+    const Leaf* leaf = LowerBound(art_key, false /* strict */);
+    return leaf != nullptr && leaf->Key() == art_key;
+  }
+
+  size_t ApproximateMemoryUsage() override {
+    // All memory is allocated through allocator; nothing to report here
+    return 0;
+  }
+
+  void Get(const LookupKey& k, void* callback_args,
+           bool (*callback_func)(void* arg, const char* entry)) override {
+    std::string art_key;
+    EncodeArtKey(k.internal_key(), &art_key);
+    for (const Leaf* leaf = LowerBound(art_key, false /* strict */);
+         leaf != nullptr && callback_func(callback_args, leaf->entry);
+         leaf = LowerBound(leaf->Key(), true /* strict */)) {
+    }
+  }
+
+  ~ARTRep() override = default;
+
+  // Each step of the iterator looks the current key up from the root, so
+  // that it never holds a position in a node that writers may change.
+  class Iterator : public MemTableRep::Iterator {
+   public:
+    explicit Iterator(const ARTRep* rep) : rep_(rep), leaf_(nullptr) {}
+
+    bool Valid() const override { return leaf_ != nullptr; }
+
+    const char* key() const override {
+      assert(Valid());
+      return leaf_->entry;
+    }
+
+    void Next() override {
+      assert(Valid());
+      leaf_ = rep_->LowerBound(leaf_->Key(), true /* strict */);
+    }
+
+    void Prev() override {
+      assert(Valid());
+      leaf_ = rep_->UpperBound(leaf_->Key(), true /* strict */);
+    }
+
+    void Seek(const Slice& internal_key,
+              const char* memtable_key) override {
+      EncodeArtKey(memtable_key != nullptr
+                       ? GetLengthPrefixedSlice(memtable_key)
+                       : internal_key,
+                   &tmp_);
+      leaf_ = rep_->LowerBound(tmp_, false /* strict */);
+    }
+
+    void SeekForPrev(const Slice& internal_key,
+                     const char* memtable_key) override {
+      EncodeArtKey(memtable_key != nullptr
+                       ? GetLengthPrefixedSlice(memtable_key)
+                       : internal_key,
+                   &tmp_);
+      leaf_ = rep_->UpperBound(tmp_, false /* strict */);
+    }
+
+    void SeekToFirst() override { leaf_ = rep_->First(); }
+
+    void SeekToLast() override { leaf_ = rep_->Last(); }
+
+   private:
+    const ARTRep* const rep_;
+    const Leaf* leaf_;
+    std::string tmp_;
+  };
+
+  MemTableRep::Iterator* GetIterator(Arena* arena = nullptr) override {
+    void* mem = arena ? arena->AllocateAligned(sizeof(ARTRep::Iterator))
+                      : operator new(sizeof(ARTRep::Iterator));
+    return new (mem) ARTRep::Iterator(this);
+  }
+
+ private:
+  enum InsertResult { kInserted, kDuplicate, kRestart };
+
+  const Leaf* NewLeaf(const Slice& internal_key, const char* entry) {
+    const size_t key_size = ArtKeySize(internal_key);
+    char* mem =
+        allocator_->AllocateAligned(offsetof(Leaf, key) + key_size);
+    Leaf* leaf = reinterpret_cast<Leaf*>(mem);
+    leaf->entry = entry;
+    leaf->key_size = static_cast<uint32_t>(key_size);
+    EncodeArtKey(internal_key, leaf->key);
+    return leaf;
+  }
+
+  Node* NewNode4(const char* prefix_base, uint32_t prefix_len) {
+    return new (allocator_->AllocateAligned(sizeof(Node4)))
+        Node4(kNode4, prefix_base, prefix_len);
+  }
+
+  // Returns a copy of the full node with room for more children.
+  Node* Grow(const Node* node) {
+    const Slice prefix = node->Prefix();
+    const char* base = prefix.data();
+    const uint32_t len = static_cast<uint32_t>(prefix.size());
+    Node* bigger;
+    switch (node->type) {
+      case kNode4:
+        bigger = new (allocator_->AllocateAligned(sizeof(Node16)))
+            Node16(kNode16, base, len);
+        break;
+      case kNode16:
+        bigger = new (allocator_->AllocateAligned(sizeof(Node48)))
+            Node48(base, len);
+        break;
+      default:
+        assert(node->type == kNode48);
+        bigger = new (allocator_->AllocateAligned(sizeof(Node256)))
+            Node256(base, len);
+        break;
+    }
+    for (int b = NextKeyByte(node, 0); b >= 0; b = NextKeyByte(node, b + 1)) {
+      AddChild(bigger, static_cast<uint8_t>(b), FindChild(node, b));
+    }
+    return bigger;
+  }
+
+  // Returns the smallest key byte >= b with a child, -1 if none.
+  static int NextKeyByte(const Node* node, int b) {
+    for (; b < 256; b++) {
+      if (FindChild(node, static_cast<uint8_t>(b)) != 0) {
+        return b;
+      }
+    }
+    return -1;
+  }
+
+  InsertResult TryInsert(const Leaf* leaf) {
+    const Slice key = leaf->Key();
+    Node* parent = nullptr;
+    uint64_t parent_version = 0;
+    uint8_t parent_byte = 0;
+    Node* node = root_;
+    size_t depth = 0;
+    for (;;) {
+      uint64_t version;
+      if (!ReadLock(node, &version)) {
+        return kRestart;
+      }
+      const Slice prefix = node->Prefix();
+      size_t i = 0;
+      while (i < prefix.size() && depth + i < key.size() &&
+             prefix[i] == key[depth + i]) {
+        i++;
+      }
+      if (i < prefix.size()) {
+        if (!Validate(node, version)) {
+          return kRestart;
+        }
+        // No key is a prefix of another, so the key differs from the prefix
+        // before it ends.
+        assert(depth + i < key.size());
+        // The root has no prefix, so the node has a parent.
+        assert(parent != nullptr);
+        if (!UpgradeToWriteLock(parent, parent_version)) {
+          return kRestart;
+        }
+        if (!UpgradeToWriteLock(node, version)) {
+          WriteUnlock(parent);
+          return kRestart;
+        }
+        Node* split = NewNode4(prefix.data(), static_cast<uint32_t>(i));
+        AddChild(split, static_cast<uint8_t>(prefix[i]), Tag(node));
+        AddChild(split, static_cast<uint8_t>(key[depth + i]), Tag(leaf));
+        const uint64_t offset = static_cast<uint64_t>(
+            prefix.data() - node->prefix_base);
+        node->SetPrefix(static_cast<uint32_t>(offset + i + 1),
+                        static_cast<uint32_t>(prefix.size() - i - 1));
+        ReplaceChild(parent, parent_byte, Tag(split));
+        WriteUnlock(node);
+        WriteUnlock(parent);
+        return kInserted;
+      }
+      depth += prefix.size();
+      assert(depth < key.size());
+      const uint8_t b = static_cast<uint8_t>(key[depth]);
+      const uintptr_t child = FindChild(node, b);
+      const bool full = Count(node) == Capacity(node);
+      if (!Validate(node, version)) {
+        return kRestart;
+      }
+
+      if (child == 0) {
+        if (!full) {
+          if (!UpgradeToWriteLock(node, version)) {
+            return kRestart;
+          }
+          AddChild(node, b, Tag(leaf));
+          WriteUnlock(node);
+          return kInserted;
+        }
+        // The root is a Node256, so a full node has a parent.
+        assert(parent != nullptr);
+        if (!UpgradeToWriteLock(parent, parent_version)) {
+          return kRestart;
+        }
+        if (!UpgradeToWriteLock(node, version)) {
+          WriteUnlock(parent);
+          return kRestart;
+        }
+        Node* bigger = Grow(node);
+        AddChild(bigger, b, Tag(leaf));
+        ReplaceChild(parent, parent_byte, Tag(bigger));
+        WriteUnlockObsolete(node);
+        WriteUnlock(parent);
+        return kInserted;
+      }
+
+      if (IsLeaf(child)) {
+        const Slice other = AsLeaf(child)->Key();
+        size_t m = depth + 1;
+        while (m < key.size() && m < other.size() && key[m] == other[m]) {
+          m++;
+        }
+        if (m == key.size() && m == other.size()) {
+          return kDuplicate;
+        }
+        assert(m < key.size() && m < other.size());
+        if (!UpgradeToWriteLock(node, version)) {
+          return kRestart;
+        }
+        Node* split = NewNode4(key.data() + depth + 1,
+                               static_cast<uint32_t>(m - depth - 1));
+        AddChild(split, static_cast<uint8_t>(other[m]), child);
+        AddChild(split, static_cast<uint8_t>(key[m]), Tag(leaf));
+        ReplaceChild(node, b, Tag(split));
+        WriteUnlock(node);
+        return kInserted;
+      }
+
+      parent = node;
+      parent_version = version;
+      parent_byte = b;
+      node = AsNode(child);
+      depth++;
+    }
+  }
+
+  // Compares the part of key from depth with the prefix. Returns 0 if the
+  // prefix matches, a negative value if all the keys under the node are
+  // smaller than key and a positive value if they are all larger.
+  static int ComparePrefix(const Slice& prefix, const Slice& key,
+                           size_t depth) {
+    for (size_t i = 0; i < prefix.size(); i++) {
+      if (depth + i >= key.size()) {
+        return 1;
+      }
+      const uint8_t p = static_cast<uint8_t>(prefix[i]);
+      const uint8_t k = static_cast<uint8_t>(key[depth + i]);
+      if (p != k) {
+        return p < k ? -1 : 1;
+      }
+    }
+    return 0;
+  }
+
+  // Returns the smallest (or largest if !min) leaf under child.
+  static const Leaf* Edge(uintptr_t child, bool min, bool* restart) {
+    while (!IsLeaf(child)) {
+      const Node* node = AsNode(child);
+      uint64_t version;
+      if (!ReadLock(node, &version)) {
+        *restart = true;
+        return nullptr;
+      }
+      child = min ? NextChild(node, 0) : PrevChild(node, 255);
+      if (!Validate(node, version)) {
+        *restart = true;
+        return nullptr;
+      }
+      if (child == 0) {
+        // Only the root may be empty.
+        return nullptr;
+      }
+    }
+    return AsLeaf(child);
+  }
+
+  // Returns the leaf of the smallest key under node that is >= key, or > key
+  // if strict. With upper set, the largest key <= key, or < key if strict.
+  static const Leaf* Bound(const Node* node, size_t depth, const Slice& key,
+                           bool strict, bool upper, bool* restart) {
+    uint64_t version;
+    if (!ReadLock(node, &version)) {
+      *restart = true;
+      return nullptr;
+    }
+    const Slice prefix = node->Prefix();
+    const int cmp = ComparePrefix(prefix, key, depth);
+    if (!Validate(node, version)) {
+      *restart = true;
+      return nullptr;
+    }
+    if (cmp != 0 || depth + prefix.size() >= key.size()) {
+      // The keys under the node are all on one side of key.
+      const bool larger = cmp >= 0;
+      if (larger == upper) {
+        return nullptr;
+      }
+      return Edge(Tag(node), !upper, restart);
+    }
+    depth += prefix.size();
+    const uint8_t b = static_cast<uint8_t>(key[depth]);
+    const uintptr_t child = FindChild(node, b);
+    if (!Validate(node, version)) {
+      *restart = true;
+      return nullptr;
+    }
+    if (child != 0) {
+      const Leaf* leaf;
+      if (IsLeaf(child)) {
+        leaf = AsLeaf(child);
+        const int c = leaf->Key().compare(key);
+        const bool in_range = upper ? (c < 0 || (c == 0 && !strict))
+                                    : (c > 0 || (c == 0 && !strict));
+        if (!in_range) {
+          leaf = nullptr;
+        }
+      } else {
+        leaf = Bound(AsNode(child), depth + 1, key, strict, upper, restart);
+        if (*restart) {
+          return nullptr;
+        }
+      }
+      if (leaf != nullptr) {
+        return leaf;
+      }
+    }
+    if ((upper && b == 0) || (!upper && b == 255)) {
+      return nullptr;
+    }
+    const uintptr_t sibling =
+        upper ? PrevChild(node, b - 1) : NextChild(node, b + 1);
+    if (!Validate(node, version)) {
+      *restart = true;
+      return nullptr;
+    }
+    if (sibling == 0) {
+      return nullptr;
+    }
+    return Edge(sibling, !upper, restart);
+  }
+
+  const Leaf* LowerBound(const Slice& key, bool strict) const {
+    for (;;) {
+      bool restart = false;
+      const Leaf* leaf = Bound(root_, 0, key, strict, false, &restart);
+      if (!restart) {
+        return leaf;
+      }
+    }
+  }
+
+  const Leaf* UpperBound(const Slice& key, bool strict) const {
+    for (;;) {
+      bool restart = false;
+      const Leaf* leaf = Bound(root_, 0, key, strict, true, &restart);
+      if (!restart) {
+        return leaf;
+      }
+    }
+  }
+
+  const Leaf* First() const { return EdgeFromRoot(true); }
+  const Leaf* Last() const { return EdgeFromRoot(false); }
+
+  const Leaf* EdgeFromRoot(bool min) const {
+    for (;;) {
+      bool restart = false;
+      const Leaf* leaf = Edge(Tag(root_), min, &restart);
+      if (!restart) {
+        return leaf;
+      }
+    }
+  }
+
+  // Never replaced, so that every other node has a parent.
+  Node256* const root_;
+};
+
+}  // namespace
+
+MemTableRep* ARTRepFactory::CreateMemTableRep(
+    const MemTableRep::KeyComparator& compare, Allocator* allocator,
+    const SliceTransform* transform, Logger* logger) {
+  const Comparator* ucmp =
+      static_cast_with_check<const MemTable::KeyComparator>(&compare)
+          ->comparator.user_comparator();
+  if (ucmp->timestamp_size() > 0 ||
+      strcmp(ucmp->Name(), BytewiseComparator()->Name()) != 0) {
+    // The tree relies on the order of the keys being bytewise.
+    return SkipListFactory().CreateMemTableRep(compare, allocator, transform,
+                                               logger);
+  }
+  return new ARTRep(allocator);
+}
+
+}  // namespace ROCKSDB_NAMESPACE
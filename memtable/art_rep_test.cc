@@ -0,0 +1,237 @@
+//  Copyright (c) 2011-present, Facebook, Inc.  All rights reserved.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+
+#include <memory>
+#include <set>
+#include <thread>
+#include <vector>
+
+#include "db/dbformat.h"
+#include "db/memtable.h"
+#include "memory/concurrent_arena.h"
+#include "port/port.h"
+#include "rocksdb/memtablerep.h"
+#include "test_util/testharness.h"
+#include "util/coding.h"
+#include "util/random.h"
+
+namespace ROCKSDB_NAMESPACE {
+
+class ARTRepTest : public testing::Test {
+ public:
+  ARTRepTest()
+      : icmp_(BytewiseComparator()),
+        key_cmp_(icmp_),
+        keys_(KeyLess(icmp_)) {}
+
+ protected:
+  MemTableRep* NewRep() {
+    return factory_.CreateMemTableRep(key_cmp_, &arena_, nullptr, nullptr);
+  }
+
+  // Keys with zero bytes, 0xFF bytes and common prefixes, to exercise the
+  // escaping and the prefix compression of the tree.
+  static std::string RandomInternalKey(Random* rnd) {
+    std::string user_key;
+    if (rnd->OneIn(3)) {
+      user_key = "key" + std::to_string(rnd->Uniform(10000));
+    } else {
+      const int len = rnd->Uniform(6);
+      for (int i = 0; i < len; i++) {
+        const uint32_t r = rnd->Uniform(4);
+        user_key.push_back(r == 0   ? '\0'
+                           : r == 1 ? '\xff'
+                                    : static_cast<char>('a' + r));
+      }
+    }
+    InternalKey ikey(user_key, rnd->Uniform(50), kTypeValue);
+    return ikey.Encode().ToString();
+  }
+
+  // Returns false if the rep already has the key.
+  bool Insert(MemTableRep* rep, const std::string& ikey, bool concurrently) {
+    char* buf;
+    KeyHandle handle =
+        rep->Allocate(VarintLength(ikey.size()) + ikey.size(), &buf);
+    char* p = EncodeVarint32(buf, static_cast<uint32_t>(ikey.size()));
+    memcpy(p, ikey.data(), ikey.size());
+    return concurrently ? rep->InsertKeyConcurrently(handle)
+                        : rep->InsertKey(handle);
+  }
+
+  static std::string KeyOf(const MemTableRep::Iterator* iter) {
+    return GetLengthPrefixedSlice(iter->key()).ToString();
+  }
+
+  void VerifyIteration(MemTableRep* rep) {
+    std::unique_ptr<MemTableRep::Iterator> iter(rep->GetIterator());
+    auto expected = keys_.begin();
+    for (iter->SeekToFirst(); iter->Valid(); iter->Next(), ++expected) {
+      ASSERT_TRUE(expected != keys_.end());
+      ASSERT_EQ(*expected, KeyOf(iter.get()));
+    }
+    ASSERT_TRUE(expected == keys_.end());
+
+    auto reverse = keys_.rbegin();
+    for (iter->SeekToLast(); iter->Valid(); iter->Prev(), ++reverse) {
+      ASSERT_TRUE(reverse != keys_.rend());
+      ASSERT_EQ(*reverse, KeyOf(iter.get()));
+    }
+    ASSERT_TRUE(reverse == keys_.rend());
+  }
+
+  void VerifySeeks(MemTableRep* rep, Random* rnd) {
+    std::unique_ptr<MemTableRep::Iterator> iter(rep->GetIterator());
+    for (int i = 0; i < 2000; i++) {
+      const std::string target = RandomInternalKey(rnd);
+      iter->Seek(target, nullptr);
+      auto lower = keys_.lower_bound(target);
+      ASSERT_EQ(lower != keys_.end(), iter->Valid());
+      if (iter->Valid()) {
+        ASSERT_EQ(*lower, KeyOf(iter.get()));
+      }
+
+      iter->SeekForPrev(target, nullptr);
+      auto upper = keys_.upper_bound(target);
+      ASSERT_EQ(upper != keys_.begin(), iter->Valid());
+      if (iter->Valid()) {
+        ASSERT_EQ(*std::prev(upper), KeyOf(iter.get()));
+      }
+
+      std::string entry;
+      PutLengthPrefixedSlice(&entry, target);
+      ASSERT_EQ(keys_.count(target) > 0, rep->Contains(entry.data()));
+    }
+  }
+
+  struct KeyLess {
+    explicit KeyLess(const InternalKeyComparator& c) : cmp(c) {}
+    bool operator()(const std::string& a, const std::string& b) const {
+      return cmp.Compare(a, b) < 0;
+    }
+    InternalKeyComparator cmp;
+  };
+
+  InternalKeyComparator icmp_;
+  MemTable::KeyComparator key_cmp_;
+  ConcurrentArena arena_;
+  ARTRepFactory factory_;
+  std::set<std::string, KeyLess> keys_;
+};
+
+TEST_F(ARTRepTest, InsertAndIterate) {
+  std::unique_ptr<MemTableRep> rep(NewRep());
+  Random rnd(301);
+  std::unique_ptr<MemTableRep::Iterator> iter(rep->GetIterator());
+  iter->SeekToFirst();
+  ASSERT_FALSE(iter->Valid());
+
+  for (int i = 0; i < 20000; i++) {
+    const std::string ikey = RandomInternalKey(&rnd);
+    const bool is_new = keys_.insert(ikey).second;
+    ASSERT_EQ(is_new, Insert(rep.get(), ikey, false /* concurrently */));
+  }
+  VerifyIteration(rep.get());
+  VerifySeeks(rep.get(), &rnd);
+}
+
+TEST_F(ARTRepTest, Get) {
+  std::unique_ptr<MemTableRep> rep(NewRep());
+  for (SequenceNumber seq = 1; seq <= 3; seq++) {
+    for (const char* user_key : {"a", "ab", "b"}) {
+      const std::string ikey =
+          InternalKey(user_key, seq, kTypeValue).Encode().ToString();
+      ASSERT_TRUE(Insert(rep.get(), ikey, false /* concurrently */));
+    }
+  }
+
+  // Get() goes from the newest entry of the user key at the sequence of the
+  // lookup until the callback stops.
+  LookupKey lookup("ab", 2);
+  std::vector<std::string> seen;
+  auto callback = [](void* arg, const char* entry) {
+    auto* keys = static_cast<std::vector<std::string>*>(arg);
+    keys->push_back(GetLengthPrefixedSlice(entry).ToString());
+    return keys->size() < 3;
+  };
+  rep->Get(lookup, &seen, callback);
+  ASSERT_EQ(3, seen.size());
+  ASSERT_EQ(InternalKey("ab", 2, kTypeValue).Encode().ToString(), seen[0]);
+  ASSERT_EQ(InternalKey("ab", 1, kTypeValue).Encode().ToString(), seen[1]);
+  ASSERT_EQ(InternalKey("b", 3, kTypeValue).Encode().ToString(), seen[2]);
+}
+
+TEST_F(ARTRepTest, ConcurrentInsert) {
+  std::unique_ptr<MemTableRep> rep(NewRep());
+  const int kThreads = 8;
+  const int kKeysPerThread = 10000;
+  std::vector<std::vector<std::string>> thread_keys(kThreads);
+  for (int t = 0; t < kThreads; t++) {
+    Random rnd(t + 1);
+    for (int i = 0; i < kKeysPerThread; i++) {
+      // Distinct sequence numbers across threads, so that no two threads
+      // insert the same key.
+      InternalKey ikey("key" + std::to_string(rnd.Uniform(5000)),
+                       static_cast<SequenceNumber>(i * kThreads + t),
+                       kTypeValue);
+      thread_keys[t].push_back(ikey.Encode().ToString());
+    }
+  }
+
+  std::vector<port::Thread> threads;
+  for (int t = 0; t < kThreads; t++) {
+    threads.emplace_back([&, t]() {
+      for (const auto& ikey : thread_keys[t]) {
+        ASSERT_TRUE(Insert(rep.get(), ikey, true /* concurrently */));
+      }
+    });
+  }
+  // Read while the writers are running.
+  std::unique_ptr<MemTableRep::Iterator> iter(rep->GetIterator());
+  for (int i = 0; i < 100; i++) {
+    std::string prev;
+    for (iter->SeekToFirst(); iter->Valid(); iter->Next()) {
+      const std::string key = KeyOf(iter.get());
+      if (!prev.empty()) {
+        EXPECT_LT(icmp_.Compare(prev, key), 0);
+      }
+      prev = key;
+    }
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+
+  for (const auto& keys : thread_keys) {
+    keys_.insert(keys.begin(), keys.end());
+  }
+  ASSERT_EQ(static_cast<size_t>(kThreads * kKeysPerThread), keys_.size());
+  VerifyIteration(rep.get());
+}
+
+TEST_F(ARTRepTest, OtherComparator) {
+  // The tree can only order keys bytewise, so it falls back to a skip list.
+  InternalKeyComparator icmp(ReverseBytewiseComparator());
+  MemTable::KeyComparator key_cmp(icmp);
+  std::unique_ptr<MemTableRep> rep(
+      factory_.CreateMemTableRep(key_cmp, &arena_, nullptr, nullptr));
+  for (const char* user_key : {"a", "c", "b"}) {
+    const std::string ikey =
+        InternalKey(user_key, 1, kTypeValue).Encode().ToString();
+    ASSERT_TRUE(Insert(rep.get(), ikey, false /* concurrently */));
+  }
+  std::unique_ptr<MemTableRep::Iterator> iter(rep->GetIterator());
+  iter->SeekToFirst();
+  ASSERT_TRUE(iter->Valid());
+  ASSERT_EQ("c", ExtractUserKey(GetLengthPrefixedSlice(iter->key())));
+}
+
+}  // namespace ROCKSDB_NAMESPACE
+
+int main(int argc, char** argv) {
+  ROCKSDB_NAMESPACE::port::InstallStackTraceHandler();
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
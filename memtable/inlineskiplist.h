@@ -69,6 +69,9 @@ class InlineSkipList {
 
   static const uint16_t kMaxPossibleHeight = 32;
 
+  // Most keys that FindGreaterOrEqualBatch() looks up at once.
+  static constexpr size_t kMaxBatchSize = 32;
+
   // Create a new InlineSkipList object that will use "cmp" for comparing
   // keys, and will allocate memory using "*allocator".  Objects allocated
   // in the allocator must remain allocated for the lifetime of the
@@ -140,6 +143,14 @@ class InlineSkipList {
   // Returns true iff an entry that compares equal to key is in the list.
   bool Contains(const char* key) const;
 
+  // Sets results[i] to the first entry >= keys[i] for each of the num_keys
+  // keys, or to nullptr if there is none, as Iterator::Seek() would. The
+  // searches advance in lockstep, each prefetching the next node it reads,
+  // so that their cache misses overlap instead of following one another.
+  // REQUIRES: num_keys <= kMaxBatchSize
+  void FindGreaterOrEqualBatch(size_t num_keys, const char* const* keys,
+                               const char** results) const;
+
   // Return estimated number of entries smaller than `key`.
   uint64_t EstimateCount(const char* key) const;
 
@@ -176,6 +187,10 @@ class InlineSkipList {
     // Advance to the first entry with a key >= target
     void Seek(const char* target);
 
+    // Position at the entry of key, as returned by FindGreaterOrEqualBatch(),
+    // or make the iterator invalid if key is null.
+    void SeekToEntry(const char* key);
+
     // Retreat to the last entry with a key <= target
     void SeekForPrev(const char* target);
 
@@ -408,6 +423,14 @@ inline void InlineSkipList<Comparator>::Iterator::Seek(const char* target) {
   node_ = list_->FindGreaterOrEqual(target);
 }
 
+template <class Comparator>
+inline void InlineSkipList<Comparator>::Iterator::SeekToEntry(
+    const char* key) {
+  node_ = key == nullptr
+              ? nullptr
+              : reinterpret_cast<Node*>(const_cast<char*>(key)) - 1;
+}
+
 template <class Comparator>
 inline void InlineSkipList<Comparator>::Iterator::SeekForPrev(
     const char* target) {
@@ -507,6 +530,64 @@ InlineSkipList<Comparator>::FindGreaterOrEqual(const char* key) const {
   }
 }
 
+template <class Comparator>
+void InlineSkipList<Comparator>::FindGreaterOrEqualBatch(
+    size_t num_keys, const char* const* keys, const char** results) const {
+  assert(num_keys <= kMaxBatchSize);
+  // The state of each search is that of FindGreaterOrEqual(), with next the
+  // node that it compares its key with in its next step.
+  Node* x[kMaxBatchSize];
+  Node* next[kMaxBatchSize];
+  Node* last_bigger[kMaxBatchSize];
+  int level[kMaxBatchSize];
+  DecodedKey keys_decoded[kMaxBatchSize];
+  // The searches that are not done yet.
+  size_t active[kMaxBatchSize];
+  const int top_level = GetMaxHeight() - 1;
+  Node* const first = head_->Next(top_level);
+  for (size_t i = 0; i < num_keys; i++) {
+    x[i] = head_;
+    next[i] = first;
+    last_bigger[i] = nullptr;
+    level[i] = top_level;
+    keys_decoded[i] = compare_.decode_key(keys[i]);
+    active[i] = i;
+  }
+  if (first != nullptr) {
+    PREFETCH(first->Key(), 0, 1);
+  }
+  size_t num_active = num_keys;
+  while (num_active > 0) {
+    size_t still_active = 0;
+    for (size_t a = 0; a < num_active; a++) {
+      const size_t i = active[a];
+      Node* n = next[i];
+      int cmp = (n == nullptr || n == last_bigger[i])
+                    ? 1
+                    : compare_(n->Key(), keys_decoded[i]);
+      if (cmp == 0 || (cmp > 0 && level[i] == 0)) {
+        results[i] = n == nullptr ? nullptr : n->Key();
+        continue;
+      } else if (cmp < 0) {
+        // Keep searching in this list
+        x[i] = n;
+      } else {
+        // Switch to next list, reuse compare_() result
+        last_bigger[i] = n;
+        level[i]--;
+      }
+      // The other searches run before this one reads the node.
+      n = x[i]->Next(level[i]);
+      if (n != nullptr && n != last_bigger[i]) {
+        PREFETCH(n->Key(), 0, 1);
+      }
+      next[i] = n;
+      active[still_active++] = i;
+    }
+    num_active = still_active;
+  }
+}
+
 template <class Comparator>
 typename InlineSkipList<Comparator>::Node*
 InlineSkipList<Comparator>::FindLessThan(const char* key, Node** prev) const {
@@ -212,6 +212,61 @@ TEST_F(InlineSkipTest, InsertAndLookup) {
   }
 }
 
+TEST_F(InlineSkipTest, FindGreaterOrEqualBatch) {
+  const int N = 2000;
+  const int R = 5000;
+  Random rnd(301);
+  std::set<Key> keys;
+  ConcurrentArena arena;
+  TestComparator cmp;
+  InlineSkipList<TestComparator> list(cmp, &arena);
+  for (int i = 0; i < N; i++) {
+    Key key = rnd.Next() % R;
+    if (keys.insert(key).second) {
+      char* buf = list.AllocateKey(sizeof(Key));
+      memcpy(buf, &key, sizeof(Key));
+      list.Insert(buf);
+    }
+  }
+
+  const size_t kBatch = InlineSkipList<TestComparator>::kMaxBatchSize;
+  Key targets[kBatch];
+  const char* encoded[kBatch];
+  const char* results[kBatch];
+  for (int round = 0; round < 200; round++) {
+    // Batches of all sizes, with targets past the last key and duplicates.
+    const size_t n = round % (kBatch + 1);
+    for (size_t i = 0; i < n; i++) {
+      targets[i] = rnd.Next() % (R + 10);
+      if (i > 0 && rnd.OneIn(4)) {
+        targets[i] = targets[i - 1];
+      }
+      encoded[i] = Encode(&targets[i]);
+    }
+    list.FindGreaterOrEqualBatch(n, encoded, results);
+    for (size_t i = 0; i < n; i++) {
+      auto model_iter = keys.lower_bound(targets[i]);
+      if (model_iter == keys.end()) {
+        ASSERT_EQ(nullptr, results[i]);
+        continue;
+      }
+      ASSERT_NE(nullptr, results[i]);
+      ASSERT_EQ(*model_iter, Decode(results[i]));
+
+      // The iterator continues from the entry.
+      InlineSkipList<TestComparator>::Iterator iter(&list);
+      iter.SeekToEntry(results[i]);
+      ASSERT_TRUE(iter.Valid());
+      iter.Next();
+      ++model_iter;
+      ASSERT_EQ(model_iter != keys.end(), iter.Valid());
+      if (iter.Valid()) {
+        ASSERT_EQ(*model_iter, Decode(iter.key()));
+      }
+    }
+  }
+}
+
 TEST_F(InlineSkipTest, InsertWithHint_Sequential) {
   const int N = 100000;
   Arena arena;
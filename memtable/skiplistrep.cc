@@ -3,6 +3,7 @@
 //  COPYING file in the root directory) and Apache 2.0 License
 //  (found in the LICENSE.Apache file in the root directory).
 //
+#include <algorithm>
 #include <random>
 
 #include "db/memtable.h"
@@ -10,6 +11,9 @@
 #include "memtable/inlineskiplist.h"
 #include "rocksdb/memtablerep.h"
 #include "rocksdb/utilities/options_type.h"
+#include "util/cast_util.h"
+#include "util/fastrange.h"
+#include "util/hash.h"
 #include "util/string_util.h"
 
 namespace ROCKSDB_NAMESPACE {
@@ -20,17 +24,38 @@ class SkipListRep : public MemTableRep {
   const SliceTransform* transform_;
   const size_t lookahead_;
 
+  // The hash index maps each user key to its newest entry, so that a point
+  // lookup starts from there instead of searching the list. The chains only
+  // grow at their heads, and an entry only moves to newer entries, so
+  // readers need no locks.
+  struct IndexEntry {
+    std::atomic<const char*> newest;
+    IndexEntry* next;
+  };
+  std::atomic<IndexEntry*>* index_buckets_ = nullptr;
+  size_t num_index_buckets_ = 0;
+
   friend class LookaheadIterator;
 
  public:
   explicit SkipListRep(const MemTableRep::KeyComparator& compare,
                        Allocator* allocator, const SliceTransform* transform,
-                       const size_t lookahead)
+                       const size_t lookahead, const size_t hash_index_buckets)
       : MemTableRep(allocator),
         skip_list_(compare, allocator),
         cmp_(compare),
         transform_(transform),
-        lookahead_(lookahead) {}
+        lookahead_(lookahead) {
+    if (hash_index_buckets > 0) {
+      char* mem = allocator->AllocateAligned(sizeof(std::atomic<IndexEntry*>) *
+                                             hash_index_buckets);
+      index_buckets_ = reinterpret_cast<std::atomic<IndexEntry*>*>(mem);
+      for (size_t i = 0; i < hash_index_buckets; i++) {
+        new (&index_buckets_[i]) std::atomic<IndexEntry*>(nullptr);
+      }
+      num_index_buckets_ = hash_index_buckets;
+    }
+  }
 
   KeyHandle Allocate(const size_t len, char** buf) override {
     *buf = skip_list_.AllocateKey(len);
@@ -41,35 +66,118 @@ class SkipListRep : public MemTableRep {
   // REQUIRES: nothing that compares equal to key is currently in the list.
   void Insert(KeyHandle handle) override {
     skip_list_.Insert(static_cast<char*>(handle));
+    UpdateIndex(static_cast<char*>(handle));
   }
 
   bool InsertKey(KeyHandle handle) override {
-    return skip_list_.Insert(static_cast<char*>(handle));
+    return skip_list_.Insert(static_cast<char*>(handle)) &&
+           UpdateIndex(static_cast<char*>(handle));
   }
 
   void InsertWithHint(KeyHandle handle, void** hint) override {
     skip_list_.InsertWithHint(static_cast<char*>(handle), hint);
+    UpdateIndex(static_cast<char*>(handle));
   }
 
   bool InsertKeyWithHint(KeyHandle handle, void** hint) override {
-    return skip_list_.InsertWithHint(static_cast<char*>(handle), hint);
+    return skip_list_.InsertWithHint(static_cast<char*>(handle), hint) &&
+           UpdateIndex(static_cast<char*>(handle));
   }
 
   void InsertWithHintConcurrently(KeyHandle handle, void** hint) override {
     skip_list_.InsertWithHintConcurrently(static_cast<char*>(handle), hint);
+    UpdateIndex(static_cast<char*>(handle));
   }
 
   bool InsertKeyWithHintConcurrently(KeyHandle handle, void** hint) override {
     return skip_list_.InsertWithHintConcurrently(static_cast<char*>(handle),
-                                                 hint);
+                                                 hint) &&
+           UpdateIndex(static_cast<char*>(handle));
   }
 
   void InsertConcurrently(KeyHandle handle) override {
     skip_list_.InsertConcurrently(static_cast<char*>(handle));
+    UpdateIndex(static_cast<char*>(handle));
   }
 
   bool InsertKeyConcurrently(KeyHandle handle) override {
-    return skip_list_.InsertConcurrently(static_cast<char*>(handle));
+    return skip_list_.InsertConcurrently(static_cast<char*>(handle)) &&
+           UpdateIndex(static_cast<char*>(handle));
+  }
+
+  // Makes key the newest entry of its user key in the hash index, unless a
+  // newer one is there already. Always returns true.
+  bool UpdateIndex(const char* key) {
+    if (index_buckets_ == nullptr) {
+      return true;
+    }
+    Slice user_key = UserKey(key);
+    std::atomic<IndexEntry*>& bucket = IndexBucket(user_key);
+    IndexEntry* new_entry = nullptr;
+    IndexEntry* head = bucket.load(std::memory_order_acquire);
+    while (true) {
+      IndexEntry* entry = FindIndexEntry(head, user_key);
+      if (entry != nullptr) {
+        const char* newest = entry->newest.load(std::memory_order_acquire);
+        while (cmp_(key, newest) < 0 &&
+               !entry->newest.compare_exchange_weak(newest, key,
+                                                    std::memory_order_release,
+                                                    std::memory_order_acquire)) {
+        }
+        // A new_entry lost to a concurrent insert stays in the arena unused.
+        return true;
+      }
+      if (new_entry == nullptr) {
+        char* mem = allocator_->AllocateAligned(sizeof(IndexEntry));
+        new_entry = new (mem) IndexEntry;
+        new_entry->newest.store(key, std::memory_order_relaxed);
+      }
+      new_entry->next = head;
+      if (bucket.compare_exchange_weak(head, new_entry,
+                                       std::memory_order_release,
+                                       std::memory_order_acquire)) {
+        return true;
+      }
+      // head now holds the entries added concurrently, which may include
+      // one for this user key.
+    }
+  }
+
+  std::atomic<IndexEntry*>& IndexBucket(const Slice& user_key) const {
+    return index_buckets_[FastRange64(GetSliceNPHash64(user_key),
+                                      num_index_buckets_)];
+  }
+
+  IndexEntry* FindIndexEntry(IndexEntry* head, const Slice& user_key) const {
+    for (IndexEntry* entry = head; entry != nullptr; entry = entry->next) {
+      if (UserKey(entry->newest.load(std::memory_order_acquire)) == user_key) {
+        return entry;
+      }
+    }
+    return nullptr;
+  }
+
+  // Positions iter at the first entry at or after target, as Seek() would,
+  // by walking from the newest entry of the user key of target. Returns false
+  // if the user key is not in the hash index, and the caller should seek.
+  bool SeekWithIndex(const LookupKey& k,
+                     InlineSkipList<const MemTableRep::KeyComparator&>::Iterator*
+                         iter) const {
+    if (index_buckets_ == nullptr) {
+      return false;
+    }
+    Slice user_key = k.user_key();
+    IndexEntry* entry = FindIndexEntry(
+        IndexBucket(user_key).load(std::memory_order_acquire), user_key);
+    if (entry == nullptr) {
+      return false;
+    }
+    const char* target = k.memtable_key().data();
+    // Entries newer than the sequence number of the lookup come first.
+    for (iter->SeekToEntry(entry->newest.load(std::memory_order_acquire));
+         iter->Valid() && cmp_(iter->key(), target) < 0; iter->Next()) {
+    }
+    return true;
   }
 
   // Returns true iff an entry that compares equal to key is in the list.
@@ -84,14 +192,52 @@ class SkipListRep : public MemTableRep {
 
   void Get(const LookupKey& k, void* callback_args,
            bool (*callback_func)(void* arg, const char* entry)) override {
-    SkipListRep::Iterator iter(&skip_list_);
-    Slice dummy_slice;
-    for (iter.Seek(dummy_slice, k.memtable_key().data());
-         iter.Valid() && callback_func(callback_args, iter.key());
+    InlineSkipList<const MemTableRep::KeyComparator&>::Iterator iter(
+        &skip_list_);
+    if (!SeekWithIndex(k, &iter)) {
+      iter.Seek(k.memtable_key().data());
+    }
+    for (; iter.Valid() && callback_func(callback_args, iter.key());
          iter.Next()) {
     }
   }
 
+  void MultiGet(size_t num_keys, const LookupKey* const* keys,
+                void* const* callback_args,
+                bool (*callback_func)(void* arg, const char* entry)) override {
+    using List = InlineSkipList<const MemTableRep::KeyComparator&>;
+    const char* targets[List::kMaxBatchSize];
+    const char* entries[List::kMaxBatchSize];
+    size_t indices[List::kMaxBatchSize];
+    List::Iterator iter(&skip_list_);
+    for (size_t start = 0; start < num_keys; start += List::kMaxBatchSize) {
+      const size_t n = std::min(num_keys - start, List::kMaxBatchSize);
+      // Only the keys missing from the hash index are searched for.
+      size_t num_searched = 0;
+      for (size_t i = 0; i < n; i++) {
+        if (SeekWithIndex(*keys[start + i], &iter)) {
+          for (; iter.Valid() && callback_func(callback_args[start + i],
+                                               iter.key());
+               iter.Next()) {
+          }
+        } else {
+          targets[num_searched] = keys[start + i]->memtable_key().data();
+          indices[num_searched++] = start + i;
+        }
+      }
+      if (num_searched == 0) {
+        continue;
+      }
+      skip_list_.FindGreaterOrEqualBatch(num_searched, targets, entries);
+      for (size_t i = 0; i < num_searched; i++) {
+        void* arg = callback_args[indices[i]];
+        for (iter.SeekToEntry(entries[i]);
+             iter.Valid() && callback_func(arg, iter.key()); iter.Next()) {
+        }
+      }
+    }
+  }
+
   uint64_t ApproximateNumEntries(const Slice& start_ikey,
                                  const Slice& end_ikey) override {
     std::string tmp;
@@ -346,9 +492,19 @@ static std::unordered_map<std::string, OptionTypeInfo> skiplist_factory_info = {
       OptionTypeFlags::kDontSerialize /*Since it is part of the ID*/}},
 };
 
-SkipListFactory::SkipListFactory(size_t lookahead) : lookahead_(lookahead) {
+static std::unordered_map<std::string, OptionTypeInfo>
+    skiplist_factory_hash_index_info = {
+        {"hash_index_buckets",
+         {0, OptionType::kSizeT, OptionVerificationType::kNormal,
+          OptionTypeFlags::kNone}},
+};
+
+SkipListFactory::SkipListFactory(size_t lookahead, size_t hash_index_buckets)
+    : lookahead_(lookahead), hash_index_buckets_(hash_index_buckets) {
   RegisterOptions("SkipListFactoryOptions", &lookahead_,
                   &skiplist_factory_info);
+  RegisterOptions("SkipListFactoryHashIndexOptions", &hash_index_buckets_,
+                  &skiplist_factory_hash_index_info);
 }
 
 std::string SkipListFactory::GetId() const {
@@ -362,7 +518,16 @@ std::string SkipListFactory::GetId() const {
 MemTableRep* SkipListFactory::CreateMemTableRep(
     const MemTableRep::KeyComparator& compare, Allocator* allocator,
     const SliceTransform* transform, Logger* /*logger*/) {
-  return new SkipListRep(compare, allocator, transform, lookahead_);
+  size_t hash_index_buckets = hash_index_buckets_;
+  if (hash_index_buckets > 0 &&
+      static_cast_with_check<const MemTable::KeyComparator>(&compare)
+          ->comparator.user_comparator()
+          ->CanKeysWithDifferentByteContentsBeEqual()) {
+    // The hash index finds user keys by their bytes.
+    hash_index_buckets = 0;
+  }
+  return new SkipListRep(compare, allocator, transform, lookahead_,
+                         hash_index_buckets);
 }
 
 }  // namespace ROCKSDB_NAMESPACE
@@ -4,6 +4,8 @@
 //  (found in the LICENSE.Apache file in the root directory).
 //
 #include <algorithm>
+#include <atomic>
+#include <functional>
 #include <memory>
 #include <set>
 #include <type_traits>
@@ -13,6 +15,7 @@
 #include "memory/arena.h"
 #include "memtable/stl_wrappers.h"
 #include "port/port.h"
+#include "rocksdb/env.h"
 #include "rocksdb/memtablerep.h"
 #include "rocksdb/utilities/options_type.h"
 #include "util/mutexlock.h"
@@ -20,9 +23,106 @@
 namespace ROCKSDB_NAMESPACE {
 namespace {
 
+// Buckets smaller than this are sorted by one thread, as handing out the
+// chunks would cost more than it saves.
+const size_t kMinParallelSortSize = 64 << 10;
+
+// Runs fn(0), ..., fn(num_tasks - 1) on the calling thread and on up to
+// num_helpers threads of the low-priority pool of env, and returns when all
+// have run. The calling thread claims tasks as well, so that they all run
+// even if the pool is busy with compactions and never gets to the helpers.
+void RunInParallel(Env* env, size_t num_helpers, size_t num_tasks,
+                   const std::function<void(size_t)>& fn) {
+  struct State {
+    explicit State(const std::function<void(size_t)>& _fn, size_t _num_tasks)
+        : fn(_fn), num_tasks(_num_tasks), cv(&mu) {}
+
+    void Run() {
+      size_t ran = 0;
+      for (size_t task = next_task.fetch_add(1); task < num_tasks;
+           task = next_task.fetch_add(1)) {
+        fn(task);
+        ran++;
+      }
+      if (ran > 0) {
+        MutexLock l(&mu);
+        done += ran;
+        if (done == num_tasks) {
+          cv.SignalAll();
+        }
+      }
+    }
+
+    static void Helper(void* arg) {
+      auto* state = static_cast<std::shared_ptr<State>*>(arg);
+      (*state)->Run();
+      delete state;
+    }
+
+    static void Unschedule(void* arg) {
+      delete static_cast<std::shared_ptr<State>*>(arg);
+    }
+
+    // Only called for the tasks claimed before the last one is done, and so
+    // before RunInParallel() returns.
+    const std::function<void(size_t)> fn;
+    const size_t num_tasks;
+    std::atomic<size_t> next_task{0};
+    port::Mutex mu;
+    port::CondVar cv;
+    size_t done = 0;  // Protected by mu
+  };
+
+  auto state = std::make_shared<State>(fn, num_tasks);
+  for (size_t i = 0; i < std::min(num_helpers, num_tasks - 1); i++) {
+    env->Schedule(&State::Helper, new std::shared_ptr<State>(state),
+                  Env::Priority::LOW, nullptr, &State::Unschedule);
+  }
+  state->Run();
+  MutexLock l(&state->mu);
+  while (state->done < num_tasks) {
+    state->cv.Wait();
+  }
+}
+
+// Sorts the bucket with the calling thread and up to num_helpers threads of
+// the low-priority pool of Env::Default(): each thread sorts a chunk, then
+// adjacent runs are merged in pairs until one is left.
+void SortBucket(std::vector<const char*>* bucket,
+                const MemTableRep::KeyComparator& compare,
+                size_t num_helpers) {
+  stl_wrappers::Compare cmp(compare);
+  if (num_helpers == 0 || bucket->size() < kMinParallelSortSize) {
+    std::sort(bucket->begin(), bucket->end(), cmp);
+    return;
+  }
+  const size_t num_chunks = num_helpers + 1;
+  std::vector<size_t> bounds(num_chunks + 1);
+  for (size_t i = 0; i <= num_chunks; i++) {
+    bounds[i] = bucket->size() * i / num_chunks;
+  }
+  const auto begin = bucket->begin();
+  Env* env = Env::Default();
+  RunInParallel(env, num_helpers, num_chunks, [&](size_t chunk) {
+    std::sort(begin + bounds[chunk], begin + bounds[chunk + 1], cmp);
+  });
+  // Before the round of width w, each run is w chunks long.
+  for (size_t width = 1; width < num_chunks; width *= 2) {
+    const size_t num_merges = (num_chunks + 2 * width - 1) / (2 * width);
+    RunInParallel(env, num_helpers, num_merges, [&](size_t merge) {
+      const size_t lo = merge * 2 * width;
+      const size_t mid = std::min(lo + width, num_chunks);
+      const size_t hi = std::min(lo + 2 * width, num_chunks);
+      std::inplace_merge(begin + bounds[lo], begin + bounds[mid],
+                         begin + bounds[hi], cmp);
+    });
+  }
+}
+
 class VectorRep : public MemTableRep {
  public:
-  VectorRep(const KeyComparator& compare, Allocator* allocator, size_t count);
+  VectorRep(const KeyComparator& compare, Allocator* allocator, size_t count,
+            size_t parallel_sort_threads);
 
   // Insert key into the collection. (The caller will pack key and value into a
   // single buffer and pass that in as the parameter to Insert)
@@ -47,6 +147,7 @@ class VectorRep : public MemTableRep {
     std::shared_ptr<std::vector<const char*>> bucket_;
     std::vector<const char*>::const_iterator mutable cit_;
     const KeyComparator& compare_;
+    const size_t parallel_sort_threads_;
     std::string tmp_;  // For passing to EncodeKey
     bool mutable sorted_;
     void DoSort() const;
@@ -54,7 +155,8 @@ class VectorRep : public MemTableRep {
    public:
     explicit Iterator(class VectorRep* vrep,
                       std::shared_ptr<std::vector<const char*>> bucket,
-                      const KeyComparator& compare);
+                      const KeyComparator& compare,
+                      size_t parallel_sort_threads);
 
     // Initialize an iterator over the specified collection.
     // The returned iterator is not valid.
@@ -102,6 +204,8 @@ class VectorRep : public MemTableRep {
   bool immutable_;
   bool sorted_;
   const KeyComparator& compare_;
+  // Helper threads of the sorts of the bucket, see VectorRepFactory.
+  const size_t parallel_sort_threads_;
 };
 
 void VectorRep::Insert(KeyHandle handle) {
@@ -130,22 +234,25 @@ size_t VectorRep::ApproximateMemoryUsage() {
 }
 
 VectorRep::VectorRep(const KeyComparator& compare, Allocator* allocator,
-                     size_t count)
+                     size_t count, size_t parallel_sort_threads)
     : MemTableRep(allocator),
       bucket_(new Bucket()),
       immutable_(false),
       sorted_(false),
-      compare_(compare) {
+      compare_(compare),
+      parallel_sort_threads_(parallel_sort_threads) {
   bucket_.get()->reserve(count);
 }
 
 VectorRep::Iterator::Iterator(class VectorRep* vrep,
                               std::shared_ptr<std::vector<const char*>> bucket,
-                              const KeyComparator& compare)
+                              const KeyComparator& compare,
+                              size_t parallel_sort_threads)
     : vrep_(vrep),
       bucket_(bucket),
       cit_(bucket_->end()),
       compare_(compare),
+      parallel_sort_threads_(parallel_sort_threads),
       sorted_(false) {}
 
 void VectorRep::Iterator::DoSort() const {
@@ -153,16 +260,14 @@ void VectorRep::Iterator::DoSort() const {
   if (!sorted_ && vrep_ != nullptr) {
     WriteLock l(&vrep_->rwlock_);
     if (!vrep_->sorted_) {
-      std::sort(bucket_->begin(), bucket_->end(),
-                stl_wrappers::Compare(compare_));
+      SortBucket(bucket_.get(), compare_, parallel_sort_threads_);
       cit_ = bucket_->begin();
       vrep_->sorted_ = true;
     }
     sorted_ = true;
   }
   if (!sorted_) {
-    std::sort(bucket_->begin(), bucket_->end(),
-              stl_wrappers::Compare(compare_));
+    SortBucket(bucket_.get(), compare_, parallel_sort_threads_);
     cit_ = bucket_->begin();
     sorted_ = true;
   }
@@ -255,7 +360,8 @@ void VectorRep::Get(const LookupKey& k, void* callback_args,
     vector_rep = nullptr;
     bucket.reset(new Bucket(*bucket_));  // make a copy
   }
-  VectorRep::Iterator iter(vector_rep, immutable_ ? bucket_ : bucket, compare_);
+  VectorRep::Iterator iter(vector_rep, immutable_ ? bucket_ : bucket, compare_,
+                           parallel_sort_threads_);
   rwlock_.ReadUnlock();
 
   for (iter.Seek(k.user_key(), k.memtable_key().data());
@@ -273,17 +379,18 @@ MemTableRep::Iterator* VectorRep::GetIterator(Arena* arena) {
   // a Seek is performed on the iterator.
   if (immutable_) {
     if (arena == nullptr) {
-      return new Iterator(this, bucket_, compare_);
+      return new Iterator(this, bucket_, compare_, parallel_sort_threads_);
     } else {
-      return new (mem) Iterator(this, bucket_, compare_);
+      return new (mem)
+          Iterator(this, bucket_, compare_, parallel_sort_threads_);
     }
   } else {
     std::shared_ptr<Bucket> tmp;
     tmp.reset(new Bucket(*bucket_));  // make a copy
     if (arena == nullptr) {
-      return new Iterator(nullptr, tmp, compare_);
+      return new Iterator(nullptr, tmp, compare_, parallel_sort_threads_);
     } else {
-      return new (mem) Iterator(nullptr, tmp, compare_);
+      return new (mem) Iterator(nullptr, tmp, compare_, parallel_sort_threads_);
     }
   }
 }
@@ -295,13 +402,23 @@ static std::unordered_map<std::string, OptionTypeInfo> vector_rep_table_info = {
       OptionTypeFlags::kNone}},
 };
 
-VectorRepFactory::VectorRepFactory(size_t count) : count_(count) {
+static std::unordered_map<std::string, OptionTypeInfo>
+    vector_rep_sort_table_info = {
+        {"parallel_sort_threads",
+         {0, OptionType::kSizeT, OptionVerificationType::kNormal,
+          OptionTypeFlags::kNone}},
+};
+
+VectorRepFactory::VectorRepFactory(size_t count, size_t parallel_sort_threads)
+    : count_(count), parallel_sort_threads_(parallel_sort_threads) {
   RegisterOptions("VectorRepFactoryOptions", &count_, &vector_rep_table_info);
+  RegisterOptions("VectorRepFactorySortOptions", &parallel_sort_threads_,
+                  &vector_rep_sort_table_info);
 }
 
 MemTableRep* VectorRepFactory::CreateMemTableRep(
     const MemTableRep::KeyComparator& compare, Allocator* allocator,
     const SliceTransform*, Logger* /*logger*/) {
-  return new VectorRep(compare, allocator, count_);
+  return new VectorRep(compare, allocator, count_, parallel_sort_threads_);
 }
 }  // namespace ROCKSDB_NAMESPACE
@@ -9,6 +9,7 @@
 
 #include "rocksdb/write_buffer_manager.h"
 
+#include <algorithm>
 #include <memory>
 
 #include "cache/cache_entry_roles.h"
@@ -27,7 +28,11 @@ WriteBufferManager::WriteBufferManager(size_t _buffer_size,
       memory_active_(0),
       cache_res_mgr_(nullptr),
       allow_stall_(allow_stall),
-      stall_active_(false) {
+      stall_active_(false),
+      total_tenant_weight_(0) {
+  for (auto& used : numa_memory_used_) {
+    used.store(0, std::memory_order_relaxed);
+  }
   if (cache) {
     // Memtable's memory usage tends to fluctuate frequently
     // therefore we set delayed_decrease = true to save some dummy entry
@@ -99,6 +104,18 @@ void WriteBufferManager::FreeMem(size_t mem) {
   MaybeEndWriteStall();
 }
 
+void WriteBufferManager::ReserveNumaNodeMem(size_t mem, int node) {
+  if (node >= 0 && node < kMaxNumaNodes) {
+    numa_memory_used_[node].fetch_add(mem, std::memory_order_relaxed);
+  }
+}
+
+void WriteBufferManager::FreeNumaNodeMem(size_t mem, int node) {
+  if (node >= 0 && node < kMaxNumaNodes) {
+    numa_memory_used_[node].fetch_sub(mem, std::memory_order_relaxed);
+  }
+}
+
 void WriteBufferManager::FreeMemWithCache(size_t mem) {
   assert(cache_res_mgr_ != nullptr);
   // Use a mutex to protect various data structures. Can be optimized to a
@@ -182,4 +199,46 @@ void WriteBufferManager::RemoveDBFromQueue(StallInterface* wbm_stall) {
   wbm_stall->Signal();
 }
 
+std::shared_ptr<WriteBufferManager::Tenant> WriteBufferManager::RegisterTenant(
+    uint32_t weight) {
+  assert(weight > 0);
+  auto tenant = std::make_shared<Tenant>(weight);
+  std::lock_guard<std::mutex> lock(tenants_mu_);
+  tenants_.push_back(tenant);
+  total_tenant_weight_.fetch_add(weight, std::memory_order_relaxed);
+  return tenant;
+}
+
+void WriteBufferManager::UnregisterTenant(const Tenant* tenant) {
+  assert(tenant != nullptr);
+  std::lock_guard<std::mutex> lock(tenants_mu_);
+  auto it = std::find_if(
+      tenants_.begin(), tenants_.end(),
+      [tenant](const std::shared_ptr<Tenant>& t) { return t.get() == tenant; });
+  if (it != tenants_.end()) {
+    total_tenant_weight_.fetch_sub(tenant->weight, std::memory_order_relaxed);
+    tenants_.erase(it);
+  }
+}
+
+size_t WriteBufferManager::GetTenantShare(const Tenant& tenant) const {
+  const uint64_t total = total_tenant_weight_.load(std::memory_order_relaxed);
+  if (total <= tenant.weight) {
+    return buffer_size();
+  }
+  return static_cast<size_t>(static_cast<double>(buffer_size()) *
+                             tenant.weight / total);
+}
+
+// Only called when the buffer needs a flush, so taking the lock is fine.
+bool WriteBufferManager::AnyTenantOverShare() const {
+  std::lock_guard<std::mutex> lock(tenants_mu_);
+  for (const auto& tenant : tenants_) {
+    if (IsOverShare(*tenant)) {
+      return true;
+    }
+  }
+  return false;
+}
+
 }  // namespace ROCKSDB_NAMESPACE
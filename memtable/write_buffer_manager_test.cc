@@ -9,6 +9,7 @@
 
 #include "rocksdb/write_buffer_manager.h"
 
+#include "memory/allocator.h"
 #include "rocksdb/advanced_cache.h"
 #include "test_util/testharness.h"
 
@@ -78,6 +79,74 @@ TEST_F(WriteBufferManagerTest, ShouldFlush) {
   ASSERT_FALSE(wbf->ShouldFlush());
 }
 
+TEST_F(WriteBufferManagerTest, TenantShares) {
+  const size_t kMB = 1024 * 1024;
+  WriteBufferManager wbf(12 * kMB, {}, true /* allow_stall */);
+  auto heavy = wbf.RegisterTenant(1);
+  ASSERT_EQ(12 * kMB, wbf.GetTenantShare(*heavy));
+  auto light = wbf.RegisterTenant(2);
+  ASSERT_EQ(4 * kMB, wbf.GetTenantShare(*heavy));
+  ASSERT_EQ(8 * kMB, wbf.GetTenantShare(*light));
+
+  {
+    AllocTracker heavy_mem(&wbf);
+    heavy_mem.SetWriteBufferManagerTenant(heavy);
+    AllocTracker light_mem(&wbf);
+    light_mem.SetWriteBufferManagerTenant(light);
+
+    // The heavy tenant borrows from the light one while the buffer is not
+    // full.
+    heavy_mem.Allocate(9 * kMB);
+    ASSERT_EQ(9 * kMB, heavy->memory_used.load());
+    ASSERT_TRUE(wbf.IsOverShare(*heavy));
+    ASSERT_FALSE(wbf.ShouldFlush(light.get()));
+    ASSERT_FALSE(wbf.ShouldStall(heavy.get()));
+
+    // Once the buffer fills up, only the heavy tenant flushes and stalls.
+    light_mem.Allocate(3 * kMB);
+    ASSERT_TRUE(wbf.ShouldFlush());
+    ASSERT_TRUE(wbf.ShouldFlush(heavy.get()));
+    ASSERT_FALSE(wbf.ShouldFlush(light.get()));
+    ASSERT_TRUE(wbf.ShouldStall());
+    ASSERT_TRUE(wbf.ShouldStall(heavy.get()));
+    ASSERT_FALSE(wbf.ShouldStall(light.get()));
+    // Memory without a tenant is not subject to shares.
+    ASSERT_TRUE(wbf.ShouldFlush(nullptr));
+
+    heavy_mem.FreeMem();
+    ASSERT_EQ(0, heavy->memory_used.load());
+    ASSERT_EQ(3 * kMB, wbf.memory_usage());
+    ASSERT_FALSE(wbf.ShouldStall(heavy.get()));
+  }
+  ASSERT_EQ(0, light->memory_used.load());
+
+  wbf.UnregisterTenant(heavy.get());
+  ASSERT_EQ(12 * kMB, wbf.GetTenantShare(*light));
+  wbf.UnregisterTenant(light.get());
+}
+
+TEST_F(WriteBufferManagerTest, NumaNodeMemory) {
+  const size_t kMB = 1024 * 1024;
+  WriteBufferManager wbf(12 * kMB);
+  {
+    AllocTracker tracker(&wbf);
+    tracker.Allocate(1 * kMB);
+    tracker.Allocate(2 * kMB, 0 /* numa_node */);
+    tracker.Allocate(3 * kMB, 1 /* numa_node */);
+    // Nodes beyond kMaxNumaNodes only count in the total.
+    tracker.Allocate(4 * kMB, WriteBufferManager::kMaxNumaNodes);
+    ASSERT_EQ(10 * kMB, wbf.memory_usage());
+    ASSERT_EQ(2 * kMB, wbf.numa_node_memory_usage(0));
+    ASSERT_EQ(3 * kMB, wbf.numa_node_memory_usage(1));
+    ASSERT_EQ(0, wbf.numa_node_memory_usage(2));
+    ASSERT_EQ(3 * kMB, tracker.numa_node_bytes_allocated(1));
+    tracker.FreeMem();
+  }
+  ASSERT_EQ(0, wbf.memory_usage());
+  ASSERT_EQ(0, wbf.numa_node_memory_usage(0));
+  ASSERT_EQ(0, wbf.numa_node_memory_usage(1));
+}
+
 class ChargeWriteBufferTest : public testing::Test {};
 
 TEST_F(ChargeWriteBufferTest, Basic) {
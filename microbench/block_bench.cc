@@ -0,0 +1,214 @@
+//  Copyright (c) Meta Platforms, Inc. and affiliates.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+
+// Micro-benchmarks of building and seeking the data and index blocks of the
+// block based table, without any cache or file access in the way.
+#include <cinttypes>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "benchmark/benchmark.h"
+#include "db/dbformat.h"
+#include "table/block_based/block.h"
+#include "table/block_based/block_builder.h"
+#include "table/format.h"
+#include "util/random.h"
+
+namespace ROCKSDB_NAMESPACE {
+
+namespace {
+constexpr size_t kNumLookups = 1024;
+
+// Returns the internal key of the i-th user key of `key_len` bytes, keys
+// sharing a prefix like the keys of a data block usually do
+std::string MakeInternalKey(uint64_t i, size_t key_len) {
+  char buf[17];
+  snprintf(buf, sizeof(buf), "%016" PRIu64, i);
+  std::string user_key(key_len > 16 ? key_len - 16 : 0, 'k');
+  user_key.append(buf);
+  InternalKey ikey(user_key, i, kTypeValue);
+  return ikey.Encode().ToString();
+}
+
+// Adds the even keys to `builder` until the block reaches `block_size`,
+// returning the number of keys added
+size_t FillDataBlock(BlockBuilder* builder, size_t block_size,
+                     size_t key_len, size_t value_len, Random* rnd,
+                     std::vector<std::string>* keys) {
+  std::string value = rnd->RandomString(static_cast<int>(value_len));
+  size_t num_keys = 0;
+  while (builder->CurrentSizeEstimate() < block_size) {
+    std::string key = MakeInternalKey(2 * num_keys, key_len);
+    builder->Add(key, value);
+    if (keys != nullptr) {
+      keys->push_back(std::move(key));
+    }
+    num_keys++;
+  }
+  return num_keys;
+}
+
+// Lookup targets, half of which aren't in the block
+std::vector<std::string> MakeLookups(size_t num_keys, size_t key_len,
+                                     Random* rnd) {
+  std::vector<std::string> lookups;
+  lookups.reserve(kNumLookups);
+  for (size_t i = 0; i < kNumLookups; i++) {
+    lookups.push_back(MakeInternalKey(
+        rnd->Uniform(static_cast<int>(2 * num_keys)), key_len));
+  }
+  return lookups;
+}
+
+BlockBasedTableOptions::DataBlockIndexType IndexType(int64_t hash_index) {
+  return hash_index ? BlockBasedTableOptions::kDataBlockBinaryAndHash
+                    : BlockBasedTableOptions::kDataBlockBinarySearch;
+}
+}  // anonymous namespace
+
+// benchmark arguments:
+// 0. block restart interval
+// 1. data block hash index, 0 for binary search only
+// 2. user key length
+// 3. value length
+static void DataBlockArguments(benchmark::internal::Benchmark* b) {
+  for (int restart_interval : {1, 16}) {
+    for (int hash_index : {0, 1}) {
+      for (int key_len : {16, 64}) {
+        for (int value_len : {16, 256}) {
+          b->Args({restart_interval, hash_index, key_len, value_len});
+        }
+      }
+    }
+  }
+  b->ArgNames({"restart_interval", "hash_index", "key_len", "value_len"});
+}
+
+static void BlockBuilderAdd(benchmark::State& state) {
+  BlockBuilder builder(static_cast<int>(state.range(0)),
+                       true /* use_delta_encoding */,
+                       false /* use_value_delta_encoding */,
+                       IndexType(state.range(1)));
+  const auto key_len = static_cast<size_t>(state.range(2));
+  const auto value_len = static_cast<size_t>(state.range(3));
+  Random rnd(301);
+  // The keys are encoded beforehand so that only Add() is measured
+  std::vector<std::string> keys;
+  size_t num_keys =
+      FillDataBlock(&builder, 4096, key_len, value_len, &rnd, &keys);
+  std::string value = rnd.RandomString(static_cast<int>(value_len));
+  builder.Reset();
+
+  int64_t num_added = 0;
+  for (auto _ : state) {
+    for (const auto& key : keys) {
+      builder.Add(key, value);
+    }
+    benchmark::DoNotOptimize(builder.Finish());
+    builder.Reset();
+    num_added += static_cast<int64_t>(num_keys);
+  }
+  state.SetItemsProcessed(num_added);
+}
+BENCHMARK(BlockBuilderAdd)->Apply(DataBlockArguments);
+
+// Seek() of a 4KB data block, or SeekForGet() with the hash index
+static void DataBlockIterSeek(benchmark::State& state) {
+  const bool hash_index = state.range(1) != 0;
+  BlockBuilder builder(static_cast<int>(state.range(0)),
+                       true /* use_delta_encoding */,
+                       false /* use_value_delta_encoding */,
+                       IndexType(state.range(1)));
+  const auto key_len = static_cast<size_t>(state.range(2));
+  Random rnd(301);
+  size_t num_keys = FillDataBlock(&builder, 4096, key_len,
+                                  static_cast<size_t>(state.range(3)), &rnd,
+                                  nullptr /* keys */);
+  BlockContents contents;
+  contents.data = builder.Finish();
+  Block block(std::move(contents));
+  std::vector<std::string> lookups = MakeLookups(num_keys, key_len, &rnd);
+
+  DataBlockIter iter;
+  block.NewDataIterator(BytewiseComparator(), kDisableGlobalSequenceNumber,
+                        &iter);
+  size_t i = 0;
+  for (auto _ : state) {
+    const std::string& target = lookups[i++ % kNumLookups];
+    if (hash_index) {
+      benchmark::DoNotOptimize(iter.SeekForGet(target));
+    } else {
+      iter.Seek(target);
+    }
+    benchmark::DoNotOptimize(iter.Valid());
+  }
+  state.SetItemsProcessed(static_cast<int64_t>(state.iterations()));
+}
+BENCHMARK(DataBlockIterSeek)->Apply(DataBlockArguments);
+
+// benchmark arguments:
+// 0. index block restart interval
+// 1. number of data blocks indexed
+// 2. block handle delta encoding, 0 for full handles
+static void IndexBlockArguments(benchmark::internal::Benchmark* b) {
+  for (int restart_interval : {1, 16}) {
+    for (int num_entries : {128, 4096}) {
+      for (int value_delta : {0, 1}) {
+        b->Args({restart_interval, num_entries, value_delta});
+      }
+    }
+  }
+  b->ArgNames({"restart_interval", "num_entries", "value_delta"});
+}
+
+static void IndexBlockIterSeek(benchmark::State& state) {
+  const bool value_delta = state.range(2) != 0;
+  BlockBuilder builder(static_cast<int>(state.range(0)),
+                       true /* use_delta_encoding */, value_delta);
+  const auto num_entries = static_cast<size_t>(state.range(1));
+  constexpr size_t kKeyLen = 24;
+  BlockHandle last_handle;
+  for (size_t i = 0; i < num_entries; i++) {
+    // Index keys are separators between the even keys of data blocks
+    IndexValue entry(BlockHandle(i * 4096, 4096), Slice());
+    std::string encoded_entry;
+    std::string delta_encoded_entry;
+    entry.EncodeTo(&encoded_entry, false /* have_first_key */, nullptr);
+    if (value_delta && i > 0) {
+      entry.EncodeTo(&delta_encoded_entry, false /* have_first_key */,
+                     &last_handle);
+    }
+    last_handle = entry.handle;
+    const Slice delta_encoded_entry_slice(delta_encoded_entry);
+    builder.Add(MakeInternalKey(2 * i, kKeyLen), encoded_entry,
+                &delta_encoded_entry_slice);
+  }
+  BlockContents contents;
+  contents.data = builder.Finish();
+  Block block(std::move(contents));
+  Random rnd(301);
+  std::vector<std::string> lookups = MakeLookups(num_entries, kKeyLen, &rnd);
+
+  IndexBlockIter iter;
+  block.NewIndexIterator(BytewiseComparator(), kDisableGlobalSequenceNumber,
+                         &iter, nullptr /* stats */,
+                         true /* total_order_seek */,
+                         false /* have_first_key */,
+                         true /* key_includes_seq */, !value_delta);
+  size_t i = 0;
+  for (auto _ : state) {
+    iter.Seek(lookups[i++ % kNumLookups]);
+    if (iter.Valid()) {
+      benchmark::DoNotOptimize(iter.value());
+    }
+  }
+  state.SetItemsProcessed(static_cast<int64_t>(state.iterations()));
+}
+BENCHMARK(IndexBlockIterSeek)->Apply(IndexBlockArguments);
+
+}  // namespace ROCKSDB_NAMESPACE
+
+BENCHMARK_MAIN();
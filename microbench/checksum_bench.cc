@@ -0,0 +1,147 @@
+//  Copyright (c) Meta Platforms, Inc. and affiliates.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+
+// Micro-benchmarks of the checksum and hash kernels of the read and write
+// paths: block checksums, crc32c::Extend() and the probes of the
+// FastLocalBloom filter. For the filters as a whole, see ribbon_bench.
+#include <algorithm>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "benchmark/benchmark.h"
+#include "table/format.h"
+#include "util/bloom_impl.h"
+#include "util/crc32c.h"
+#include "util/hash.h"
+#include "util/random.h"
+#include "util/xxhash.h"
+
+namespace ROCKSDB_NAMESPACE {
+
+// benchmark arguments:
+// 0. ChecksumType
+// 1. data size
+static void ChecksumArguments(benchmark::internal::Benchmark* b) {
+  for (int checksum_type : {kCRC32c, kxxHash, kxxHash64, kXXH3}) {
+    for (int data_size : {64, 4096, 65536}) {
+      b->Args({checksum_type, data_size});
+    }
+  }
+  b->ArgNames({"checksum_type", "data_size"});
+}
+
+// The checksum of a block with its trailer byte, as BlockBasedTableBuilder
+// and the block reads compute it
+static void BlockChecksum(benchmark::State& state) {
+  const auto type = static_cast<ChecksumType>(state.range(0));
+  const auto data_size = static_cast<size_t>(state.range(1));
+  Random rnd(301);
+  const std::string data = rnd.RandomBinaryString(static_cast<int>(data_size));
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(ComputeBuiltinChecksumWithLastByte(
+        type, data.data(), data_size, static_cast<char>(kNoCompression)));
+  }
+  state.SetBytesProcessed(static_cast<int64_t>(state.iterations()) *
+                          static_cast<int64_t>(data_size));
+}
+BENCHMARK(BlockChecksum)->Apply(ChecksumArguments);
+
+// crc32c::Extend() over a record in pieces, as the WAL writer does
+static void Crc32cExtend(benchmark::State& state) {
+  const auto data_size = static_cast<size_t>(state.range(0));
+  const auto piece_size = static_cast<size_t>(state.range(1));
+  Random rnd(301);
+  const std::string data = rnd.RandomBinaryString(static_cast<int>(data_size));
+  for (auto _ : state) {
+    uint32_t crc = 0;
+    for (size_t offset = 0; offset < data_size; offset += piece_size) {
+      crc = crc32c::Extend(crc, data.data() + offset,
+                           std::min(piece_size, data_size - offset));
+    }
+    benchmark::DoNotOptimize(crc);
+  }
+  state.SetBytesProcessed(static_cast<int64_t>(state.iterations()) *
+                          static_cast<int64_t>(data_size));
+}
+BENCHMARK(Crc32cExtend)
+    ->ArgsProduct({{4096, 65536}, {64, 4096}})
+    ->ArgNames({"data_size", "piece_size"});
+
+// XXH3 of keys, as the filters and the per key-value checksums hash them
+static void XXH3Key(benchmark::State& state) {
+  const auto key_len = static_cast<size_t>(state.range(0));
+  Random rnd(301);
+  const std::string data = rnd.RandomBinaryString(
+      static_cast<int>(key_len + 1024));
+  size_t offset = 0;
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(
+        XXH3_64bits(data.data() + (offset++ & 1023), key_len));
+  }
+  state.SetItemsProcessed(static_cast<int64_t>(state.iterations()));
+}
+BENCHMARK(XXH3Key)->Arg(8)->Arg(16)->Arg(64)->Arg(256)->ArgNames({"key_len"});
+
+namespace {
+// A FastLocalBloom filter of kNumKeys keys at `bits_per_key`, with the
+// hashes of the keys in it and of as many keys not in it
+struct BloomFixture {
+  static constexpr size_t kNumKeys = 1 << 16;
+
+  explicit BloomFixture(int bits_per_key)
+      : num_probes(FastLocalBloomImpl::ChooseNumProbes(bits_per_key * 1000)),
+        len_bytes(static_cast<uint32_t>(kNumKeys * bits_per_key / 8 + 63) /
+                  64 * 64),
+        data(new char[len_bytes]()) {
+    for (size_t i = 0; i < 2 * kNumKeys; i++) {
+      hashes.push_back(GetSliceHash64(std::to_string(i)));
+    }
+  }
+
+  void AddKeys() {
+    for (size_t i = 0; i < kNumKeys; i++) {
+      FastLocalBloomImpl::AddHash(Lower32of64(hashes[i]),
+                                  Upper32of64(hashes[i]), len_bytes,
+                                  num_probes, data.get());
+    }
+  }
+
+  const int num_probes;
+  const uint32_t len_bytes;
+  std::unique_ptr<char[]> data;
+  std::vector<uint64_t> hashes;
+};
+}  // anonymous namespace
+
+static void FastLocalBloomAdd(benchmark::State& state) {
+  BloomFixture bloom(static_cast<int>(state.range(0)));
+  for (auto _ : state) {
+    bloom.AddKeys();
+    benchmark::ClobberMemory();
+  }
+  state.SetItemsProcessed(static_cast<int64_t>(state.iterations()) *
+                          static_cast<int64_t>(BloomFixture::kNumKeys));
+}
+BENCHMARK(FastLocalBloomAdd)->Arg(10)->Arg(20)->ArgNames({"bits_per_key"});
+
+// Half of the queried keys are in the filter
+static void FastLocalBloomQuery(benchmark::State& state) {
+  BloomFixture bloom(static_cast<int>(state.range(0)));
+  bloom.AddKeys();
+  size_t i = 0;
+  for (auto _ : state) {
+    const uint64_t h = bloom.hashes[i++ % bloom.hashes.size()];
+    benchmark::DoNotOptimize(FastLocalBloomImpl::HashMayMatch(
+        Lower32of64(h), Upper32of64(h), bloom.len_bytes, bloom.num_probes,
+        bloom.data.get()));
+  }
+  state.SetItemsProcessed(static_cast<int64_t>(state.iterations()));
+}
+BENCHMARK(FastLocalBloomQuery)->Arg(10)->Arg(20)->ArgNames({"bits_per_key"});
+
+}  // namespace ROCKSDB_NAMESPACE
+
+BENCHMARK_MAIN();
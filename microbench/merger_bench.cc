@@ -0,0 +1,118 @@
+//  Copyright (c) Meta Platforms, Inc. and affiliates.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+
+// Micro-benchmarks of the multi-way merge of sorted runs, as the merging
+// iterators do it, with BinaryHeap and with LoserTree for increasing fan-in.
+#include <cstdint>
+#include <vector>
+
+#include "benchmark/benchmark.h"
+#include "util/heap.h"
+#include "util/loser_tree.h"
+#include "util/random.h"
+
+namespace ROCKSDB_NAMESPACE {
+
+namespace {
+constexpr size_t kNumKeys = 1 << 16;
+
+struct Run {
+  const uint64_t* pos;
+  const uint64_t* end;
+};
+
+// The greater-than relation, so that the top is the smallest key, counting
+// the comparisons
+class RunComparator {
+ public:
+  explicit RunComparator(uint64_t* num_comparisons)
+      : num_comparisons_(num_comparisons) {}
+
+  bool operator()(const Run* a, const Run* b) const {
+    ++*num_comparisons_;
+    return *a->pos > *b->pos;
+  }
+
+ private:
+  uint64_t* num_comparisons_;
+};
+
+// kNumKeys keys spread over `num_runs` sorted runs, in chunks of
+// `chunk_len` consecutive keys: 1 to interleave the runs evenly, more as the
+// runs of neighbouring L0 files would be
+std::vector<std::vector<uint64_t>> MakeRuns(size_t num_runs,
+                                            size_t chunk_len) {
+  std::vector<std::vector<uint64_t>> runs(num_runs);
+  Random rnd(301);
+  for (uint64_t key = 0; key < kNumKeys; key += chunk_len) {
+    auto& run = runs[rnd.Uniform(static_cast<int>(num_runs))];
+    for (uint64_t i = key; i < key + chunk_len && i < kNumKeys; i++) {
+      run.push_back(i);
+    }
+  }
+  return runs;
+}
+}  // anonymous namespace
+
+// benchmark arguments:
+// 0. number of sorted runs
+// 1. length of the chunks of consecutive keys of a run
+static void CustomArguments(benchmark::internal::Benchmark* b) {
+  for (int num_runs : {4, 16, 64, 256}) {
+    for (int chunk_len : {1, 64}) {
+      b->Args({num_runs, chunk_len});
+    }
+  }
+  b->ArgNames({"num_runs", "chunk_len"});
+}
+
+template <typename Heap>
+static void Merge(benchmark::State& state) {
+  const auto runs = MakeRuns(static_cast<size_t>(state.range(0)),
+                             static_cast<size_t>(state.range(1)));
+  std::vector<Run> cursors(runs.size());
+  uint64_t num_comparisons = 0;
+  Heap heap{RunComparator(&num_comparisons)};
+
+  for (auto _ : state) {
+    heap.clear();
+    for (size_t i = 0; i < runs.size(); i++) {
+      cursors[i] = {runs[i].data(), runs[i].data() + runs[i].size()};
+      if (cursors[i].pos != cursors[i].end) {
+        heap.push(&cursors[i]);
+      }
+    }
+    uint64_t sum = 0;
+    while (!heap.empty()) {
+      Run* top = heap.top();
+      sum += *top->pos;
+      if (++top->pos != top->end) {
+        heap.replace_top(top);
+      } else {
+        heap.pop();
+      }
+    }
+    benchmark::DoNotOptimize(sum);
+  }
+  const auto num_keys = static_cast<double>(state.iterations() * kNumKeys);
+  state.counters["cmp_per_key"] =
+      benchmark::Counter(static_cast<double>(num_comparisons) / num_keys);
+  state.SetItemsProcessed(static_cast<int64_t>(state.iterations()) *
+                          static_cast<int64_t>(kNumKeys));
+}
+
+static void BinaryHeapMerge(benchmark::State& state) {
+  Merge<BinaryHeap<Run*, RunComparator>>(state);
+}
+BENCHMARK(BinaryHeapMerge)->Apply(CustomArguments);
+
+static void LoserTreeMerge(benchmark::State& state) {
+  Merge<LoserTree<Run*, RunComparator>>(state);
+}
+BENCHMARK(LoserTreeMerge)->Apply(CustomArguments);
+
+}  // namespace ROCKSDB_NAMESPACE
+
+BENCHMARK_MAIN();
@@ -0,0 +1,154 @@
+//  Copyright (c) Meta Platforms, Inc. and affiliates.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+
+// Micro-benchmarks of the InlineSkipList of the default memtable, with the
+// entry encoding and the comparator of MemTable.
+#include <algorithm>
+#include <cinttypes>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "benchmark/benchmark.h"
+#include "db/dbformat.h"
+#include "db/memtable.h"
+#include "memory/arena.h"
+#include "memtable/inlineskiplist.h"
+#include "util/coding.h"
+#include "util/random.h"
+
+namespace ROCKSDB_NAMESPACE {
+
+namespace {
+using MemTableSkipList = InlineSkipList<const MemTableRep::KeyComparator&>;
+
+constexpr size_t kNumLookups = 1024;
+
+std::string MakeUserKey(uint64_t i, size_t key_len) {
+  char buf[17];
+  snprintf(buf, sizeof(buf), "%016" PRIu64, i);
+  std::string user_key(key_len > 16 ? key_len - 16 : 0, 'k');
+  user_key.append(buf);
+  return user_key;
+}
+
+// Inserts the entry of `user_key` encoded as MemTable::Add() does
+void InsertEntry(MemTableSkipList* list, const std::string& user_key,
+                 SequenceNumber seq, const Slice& value) {
+  const uint32_t internal_key_size =
+      static_cast<uint32_t>(user_key.size() + 8);
+  const size_t encoded_len = VarintLength(internal_key_size) +
+                             internal_key_size + VarintLength(value.size()) +
+                             value.size();
+  char* buf = list->AllocateKey(encoded_len);
+  char* p = EncodeVarint32(buf, internal_key_size);
+  memcpy(p, user_key.data(), user_key.size());
+  p += user_key.size();
+  EncodeFixed64(p, PackSequenceAndType(seq, kTypeValue));
+  p += 8;
+  p = EncodeVarint32(p, static_cast<uint32_t>(value.size()));
+  memcpy(p, value.data(), value.size());
+  list->Insert(buf);
+}
+
+// The key order of the inserts, sequential or uniformly random
+std::vector<uint64_t> MakeKeyOrder(size_t num_keys, bool random) {
+  std::vector<uint64_t> order(num_keys);
+  for (size_t i = 0; i < num_keys; i++) {
+    order[i] = 2 * i;
+  }
+  if (random) {
+    RandomShuffle(order.begin(), order.end(), 301);
+  }
+  return order;
+}
+}  // anonymous namespace
+
+// benchmark arguments:
+// 0. number of entries
+// 1. random insertion order, 0 for sequential
+// 2. user key length
+static void CustomArguments(benchmark::internal::Benchmark* b) {
+  for (int64_t num_entries : {1 << 10, 1 << 18}) {
+    for (int random : {0, 1}) {
+      for (int key_len : {16, 64}) {
+        b->Args({num_entries, random, key_len});
+      }
+    }
+  }
+  b->ArgNames({"num_entries", "random", "key_len"});
+}
+
+static void SkipListInsert(benchmark::State& state) {
+  const auto num_entries = static_cast<size_t>(state.range(0));
+  const auto key_len = static_cast<size_t>(state.range(2));
+  InternalKeyComparator icmp(BytewiseComparator());
+  MemTable::KeyComparator cmp(icmp);
+  std::vector<uint64_t> order = MakeKeyOrder(num_entries, state.range(1));
+  std::vector<std::string> user_keys;
+  user_keys.reserve(num_entries);
+  for (uint64_t i : order) {
+    user_keys.push_back(MakeUserKey(i, key_len));
+  }
+  Random rnd(301);
+  const std::string value = rnd.RandomString(64);
+
+  int64_t num_inserted = 0;
+  for (auto _ : state) {
+    state.PauseTiming();
+    auto arena = std::make_unique<Arena>();
+    auto list = std::make_unique<MemTableSkipList>(cmp, arena.get());
+    state.ResumeTiming();
+    SequenceNumber seq = 0;
+    for (const auto& user_key : user_keys) {
+      InsertEntry(list.get(), user_key, ++seq, value);
+    }
+    num_inserted += static_cast<int64_t>(num_entries);
+    state.PauseTiming();
+    list.reset();
+    arena.reset();
+    state.ResumeTiming();
+  }
+  state.SetItemsProcessed(num_inserted);
+}
+BENCHMARK(SkipListInsert)->Apply(CustomArguments);
+
+// Seek() to lookup keys of a full skip list, half of which aren't in it,
+// as MemTable::Get() does
+static void SkipListSeek(benchmark::State& state) {
+  const auto num_entries = static_cast<size_t>(state.range(0));
+  const auto key_len = static_cast<size_t>(state.range(2));
+  InternalKeyComparator icmp(BytewiseComparator());
+  MemTable::KeyComparator cmp(icmp);
+  Arena arena;
+  MemTableSkipList list(cmp, &arena);
+  Random rnd(301);
+  const std::string value = rnd.RandomString(64);
+  SequenceNumber seq = 0;
+  for (uint64_t i : MakeKeyOrder(num_entries, state.range(1))) {
+    InsertEntry(&list, MakeUserKey(i, key_len), ++seq, value);
+  }
+  std::vector<std::string> lookups;
+  lookups.reserve(kNumLookups);
+  for (size_t i = 0; i < kNumLookups; i++) {
+    LookupKey lkey(
+        MakeUserKey(rnd.Uniform(static_cast<int>(2 * num_entries)), key_len),
+        kMaxSequenceNumber);
+    lookups.push_back(lkey.memtable_key().ToString());
+  }
+
+  MemTableSkipList::Iterator iter(&list);
+  size_t i = 0;
+  for (auto _ : state) {
+    iter.Seek(lookups[i++ % kNumLookups].data());
+    benchmark::DoNotOptimize(iter.Valid());
+  }
+  state.SetItemsProcessed(static_cast<int64_t>(state.iterations()));
+}
+BENCHMARK(SkipListSeek)->Apply(CustomArguments);
+
+}  // namespace ROCKSDB_NAMESPACE
+
+BENCHMARK_MAIN();
@@ -0,0 +1,105 @@
+//  Copyright (c) Meta Platforms, Inc. and affiliates.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+
+// A micro-benchmark comparing the ThreadPool of NewThreadPool() with the one
+// of NewWorkStealingThreadPool(), for many small jobs.
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <thread>
+
+#include "benchmark/benchmark.h"
+#include "rocksdb/threadpool.h"
+
+namespace ROCKSDB_NAMESPACE {
+
+namespace {
+constexpr int kJobsPerIteration = 1000;
+
+std::unique_ptr<ThreadPool> NewPool(int64_t impl, int num_threads) {
+  if (impl == 0) {
+    return std::unique_ptr<ThreadPool>(NewThreadPool(num_threads));
+  }
+  return std::unique_ptr<ThreadPool>(NewWorkStealingThreadPool(num_threads));
+}
+
+uint64_t NowNanos() {
+  return static_cast<uint64_t>(
+      std::chrono::duration_cast<std::chrono::nanoseconds>(
+          std::chrono::steady_clock::now().time_since_epoch())
+          .count());
+}
+
+void WaitFor(const std::atomic<int>& done, int expected) {
+  while (done.load(std::memory_order_acquire) < expected) {
+    std::this_thread::yield();
+  }
+}
+}  // anonymous namespace
+
+// benchmark arguments:
+// 0. thread pool impl, 0 for NewThreadPool(), 1 for
+//    NewWorkStealingThreadPool()
+// 1. number of threads of the pool
+static void CustomArguments(benchmark::internal::Benchmark *b) {
+  for (int impl : {0, 1}) {
+    for (int num_threads : {4, 32}) {
+      b->Args({impl, num_threads});
+    }
+  }
+  b->ArgNames({"impl", "threads"});
+}
+
+// Jobs submitted from outside of the pool, with the latency from their
+// submission to their start
+static void ThreadPoolSubmit(benchmark::State &state) {
+  auto pool = NewPool(state.range(0), static_cast<int>(state.range(1)));
+  std::atomic<int> done{0};
+  std::atomic<uint64_t> total_latency_nanos{0};
+  int expected = 0;
+  for (auto _ : state) {
+    for (int i = 0; i < kJobsPerIteration; ++i) {
+      uint64_t submit_nanos = NowNanos();
+      pool->SubmitJob([&, submit_nanos] {
+        total_latency_nanos.fetch_add(NowNanos() - submit_nanos,
+                                      std::memory_order_relaxed);
+        done.fetch_add(1, std::memory_order_release);
+      });
+    }
+    expected += kJobsPerIteration;
+    WaitFor(done, expected);
+  }
+  state.SetItemsProcessed(expected);
+  state.counters["latency_ns"] =
+      benchmark::Counter(static_cast<double>(total_latency_nanos.load()) /
+                         std::max(expected, 1));
+  pool->JoinAllThreads();
+}
+BENCHMARK(ThreadPoolSubmit)->Apply(CustomArguments)->UseRealTime();
+
+// Jobs submitted by a job of the pool, which the work stealing pool queues to
+// the thread running it
+static void ThreadPoolFanOut(benchmark::State &state) {
+  auto pool = NewPool(state.range(0), static_cast<int>(state.range(1)));
+  std::atomic<int> done{0};
+  int expected = 0;
+  for (auto _ : state) {
+    pool->SubmitJob([&] {
+      for (int i = 0; i < kJobsPerIteration; ++i) {
+        pool->SubmitJob([&] { done.fetch_add(1, std::memory_order_release); });
+      }
+    });
+    expected += kJobsPerIteration;
+    WaitFor(done, expected);
+  }
+  state.SetItemsProcessed(expected);
+  pool->JoinAllThreads();
+}
+BENCHMARK(ThreadPoolFanOut)->Apply(CustomArguments)->UseRealTime();
+
+}  // namespace ROCKSDB_NAMESPACE
+
+BENCHMARK_MAIN();
@@ -0,0 +1,117 @@
+//  Copyright (c) Meta Platforms, Inc. and affiliates.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+
+// Micro-benchmarks of encoding a WriteBatch and of decoding it with a
+// WriteBatch::Handler, as the memtable inserts and the WAL recovery do.
+#include <cinttypes>
+#include <string>
+#include <vector>
+
+#include "benchmark/benchmark.h"
+#include "rocksdb/write_batch.h"
+#include "util/random.h"
+
+namespace ROCKSDB_NAMESPACE {
+
+namespace {
+std::vector<std::string> MakeKeys(size_t num_keys, size_t key_len) {
+  std::vector<std::string> keys;
+  keys.reserve(num_keys);
+  for (size_t i = 0; i < num_keys; i++) {
+    char buf[17];
+    snprintf(buf, sizeof(buf), "%016" PRIu64, static_cast<uint64_t>(i));
+    std::string key(key_len > 16 ? key_len - 16 : 0, 'k');
+    key.append(buf);
+    keys.push_back(std::move(key));
+  }
+  return keys;
+}
+
+class CountingHandler : public WriteBatch::Handler {
+ public:
+  Status PutCF(uint32_t /*column_family_id*/, const Slice& key,
+               const Slice& value) override {
+    bytes_ += key.size() + value.size();
+    return Status::OK();
+  }
+  Status DeleteCF(uint32_t /*column_family_id*/, const Slice& key) override {
+    bytes_ += key.size();
+    return Status::OK();
+  }
+
+  size_t bytes_ = 0;
+};
+}  // anonymous namespace
+
+// benchmark arguments:
+// 0. number of entries of the batch
+// 1. key length
+// 2. value length
+static void CustomArguments(benchmark::internal::Benchmark* b) {
+  for (int num_entries : {1, 16, 256}) {
+    for (int key_len : {16, 64}) {
+      for (int value_len : {16, 1024}) {
+        b->Args({num_entries, key_len, value_len});
+      }
+    }
+  }
+  b->ArgNames({"num_entries", "key_len", "value_len"});
+}
+
+static void WriteBatchEncode(benchmark::State& state) {
+  const auto num_entries = static_cast<size_t>(state.range(0));
+  std::vector<std::string> keys =
+      MakeKeys(num_entries, static_cast<size_t>(state.range(1)));
+  Random rnd(301);
+  const std::string value =
+      rnd.RandomString(static_cast<int>(state.range(2)));
+  WriteBatch batch;
+  for (auto _ : state) {
+    batch.Clear();
+    for (const auto& key : keys) {
+      Status s = batch.Put(key, value);
+      benchmark::DoNotOptimize(s);
+    }
+    benchmark::DoNotOptimize(batch.Data().data());
+  }
+  state.SetItemsProcessed(static_cast<int64_t>(state.iterations()) *
+                          static_cast<int64_t>(num_entries));
+  state.SetBytesProcessed(static_cast<int64_t>(state.iterations()) *
+                          static_cast<int64_t>(batch.GetDataSize()));
+}
+BENCHMARK(WriteBatchEncode)->Apply(CustomArguments);
+
+// Iterate() over a batch rebuilt from its rep, as a WAL record is
+static void WriteBatchDecode(benchmark::State& state) {
+  const auto num_entries = static_cast<size_t>(state.range(0));
+  std::vector<std::string> keys =
+      MakeKeys(num_entries, static_cast<size_t>(state.range(1)));
+  Random rnd(301);
+  const std::string value =
+      rnd.RandomString(static_cast<int>(state.range(2)));
+  WriteBatch source;
+  for (const auto& key : keys) {
+    Status s = source.Put(key, value);
+    s.PermitUncheckedError();
+  }
+  const std::string rep = source.Data();
+
+  CountingHandler handler;
+  for (auto _ : state) {
+    WriteBatch batch(rep);
+    Status s = batch.Iterate(&handler);
+    benchmark::DoNotOptimize(s);
+  }
+  benchmark::DoNotOptimize(handler.bytes_);
+  state.SetItemsProcessed(static_cast<int64_t>(state.iterations()) *
+                          static_cast<int64_t>(num_entries));
+  state.SetBytesProcessed(static_cast<int64_t>(state.iterations()) *
+                          static_cast<int64_t>(rep.size()));
+}
+BENCHMARK(WriteBatchDecode)->Apply(CustomArguments);
+
+}  // namespace ROCKSDB_NAMESPACE
+
+BENCHMARK_MAIN();
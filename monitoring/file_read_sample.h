@@ -11,6 +11,7 @@ namespace ROCKSDB_NAMESPACE {
 static const uint32_t kFileReadSampleRate = 1024;
 bool should_sample_file_read();
 void sample_file_read_inc(FileMetaData*);
+void sample_file_seek_inc(FileMetaData*);
 
 inline bool should_sample_file_read() {
   return (Random::GetTLSInstance()->Next() % kFileReadSampleRate == 307);
@@ -20,4 +21,11 @@ inline void sample_file_read_inc(FileMetaData* meta) {
   meta->stats.num_reads_sampled.fetch_add(kFileReadSampleRate,
                                           std::memory_order_relaxed);
 }
+
+// A read of the file by an iterator
+inline void sample_file_seek_inc(FileMetaData* meta) {
+  sample_file_read_inc(meta);
+  meta->stats.num_seeks_sampled.fetch_add(kFileReadSampleRate,
+                                          std::memory_order_relaxed);
+}
 }  // namespace ROCKSDB_NAMESPACE
@@ -0,0 +1,413 @@
+//  Copyright (c) Meta Platforms, Inc. and affiliates.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+
+#include "monitoring/histogram_hdr.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cinttypes>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <limits>
+
+#include "util/cast_util.h"
+#include "util/coding.h"
+#include "util/math.h"
+
+namespace ROCKSDB_NAMESPACE {
+
+HdrHistogramImpl::HdrHistogramImpl(int significant_digits)
+    : min_(std::numeric_limits<uint64_t>::max()),
+      max_(0),
+      num_(0),
+      sum_(0),
+      sum_squares_(0) {
+  for (auto& chunk : chunks_) {
+    chunk.store(nullptr, std::memory_order_relaxed);
+  }
+  SetSignificantDigits(significant_digits);
+}
+
+HdrHistogramImpl::~HdrHistogramImpl() { FreeChunks(); }
+
+void HdrHistogramImpl::FreeChunks() {
+  for (auto& chunk : chunks_) {
+    delete[] chunk.exchange(nullptr, std::memory_order_relaxed);
+  }
+}
+
+void HdrHistogramImpl::SetSignificantDigits(int significant_digits) {
+  significant_digits_ = std::min(
+      std::max(significant_digits, kMinSignificantDigits),
+      kMaxSignificantDigits);
+  // The buckets of a power of two are 2^chunk_magnitude_ apart by at most
+  // 1 / 10^significant_digits of their value
+  uint64_t largest_value_with_single_unit_resolution = 2;
+  for (int i = 0; i < significant_digits_; ++i) {
+    largest_value_with_single_unit_resolution *= 10;
+  }
+  int sub_bucket_count_magnitude =
+      FloorLog2(largest_value_with_single_unit_resolution - 1) + 1;
+  chunk_magnitude_ = sub_bucket_count_magnitude - 1;
+  sub_bucket_mask_ = (uint64_t{1} << sub_bucket_count_magnitude) - 1;
+  // One chunk per power of two from 2^sub_bucket_count_magnitude to 2^64,
+  // and the two chunks of the values below
+  num_chunks_ = static_cast<size_t>(64 - sub_bucket_count_magnitude) + 2;
+  assert(num_chunks_ <= kMaxChunks);
+  FreeChunks();
+  Clear();
+}
+
+size_t HdrHistogramImpl::IndexForValue(uint64_t value) const {
+  int bucket = FloorLog2(value | sub_bucket_mask_) - chunk_magnitude_;
+  uint64_t sub_bucket = value >> bucket;
+  return (static_cast<size_t>(bucket) << chunk_magnitude_) +
+         static_cast<size_t>(sub_bucket);
+}
+
+uint64_t HdrHistogramImpl::LowestValueAt(size_t index) const {
+  size_t chunk = index >> chunk_magnitude_;
+  uint64_t offset = BottomNBits(index, chunk_magnitude_);
+  if (chunk == 0) {
+    return offset;
+  }
+  uint64_t sub_bucket = offset + (uint64_t{1} << chunk_magnitude_);
+  return sub_bucket << (chunk - 1);
+}
+
+uint64_t HdrHistogramImpl::HighestValueAt(size_t index) const {
+  size_t chunk = index >> chunk_magnitude_;
+  int bucket = chunk == 0 ? 0 : static_cast<int>(chunk) - 1;
+  return LowestValueAt(index) + ((uint64_t{1} << bucket) - 1);
+}
+
+uint64_t HdrHistogramImpl::CountAt(size_t index) const {
+  const std::atomic<uint64_t>* chunk =
+      chunks_[index >> chunk_magnitude_].load(std::memory_order_acquire);
+  if (chunk == nullptr) {
+    return 0;
+  }
+  return chunk[BottomNBits(index, chunk_magnitude_)].load(
+      std::memory_order_relaxed);
+}
+
+void HdrHistogramImpl::AddToBucket(uint64_t value, uint64_t count) {
+  size_t index = IndexForValue(value);
+  assert(index < num_buckets());
+  auto& slot = chunks_[index >> chunk_magnitude_];
+  std::atomic<uint64_t>* chunk = slot.load(std::memory_order_acquire);
+  if (chunk == nullptr) {
+    const size_t chunk_size = size_t{1} << chunk_magnitude_;
+    std::atomic<uint64_t>* allocated = new std::atomic<uint64_t>[chunk_size];
+    for (size_t i = 0; i < chunk_size; ++i) {
+      allocated[i].store(0, std::memory_order_relaxed);
+    }
+    if (slot.compare_exchange_strong(chunk, allocated,
+                                     std::memory_order_acq_rel)) {
+      chunk = allocated;
+    } else {
+      // Lost to a concurrent Add()
+      delete[] allocated;
+    }
+  }
+  auto& bucket = chunk[BottomNBits(index, chunk_magnitude_)];
+  bucket.store(bucket.load(std::memory_order_relaxed) + count,
+               std::memory_order_relaxed);
+}
+
+void HdrHistogramImpl::Clear() {
+  std::lock_guard<std::mutex> lock(mutex_);
+  min_.store(std::numeric_limits<uint64_t>::max(), std::memory_order_relaxed);
+  max_.store(0, std::memory_order_relaxed);
+  num_.store(0, std::memory_order_relaxed);
+  sum_.store(0, std::memory_order_relaxed);
+  sum_squares_.store(0, std::memory_order_relaxed);
+  // Keeps the chunks allocated, as the values are likely to come back
+  const size_t chunk_size = size_t{1} << chunk_magnitude_;
+  for (size_t c = 0; c < num_chunks_; ++c) {
+    std::atomic<uint64_t>* chunk = chunks_[c].load(std::memory_order_acquire);
+    for (size_t i = 0; chunk != nullptr && i < chunk_size; ++i) {
+      chunk[i].store(0, std::memory_order_relaxed);
+    }
+  }
+}
+
+bool HdrHistogramImpl::Empty() const { return num() == 0; }
+
+void HdrHistogramImpl::Add(uint64_t value) {
+  // This function is designed to be lock free, as it's in the critical path
+  // of any operation. Each individual value is atomic and the order of updates
+  // by concurrent threads is tolerable.
+  AddToBucket(value, 1);
+
+  if (value < min()) {
+    min_.store(value, std::memory_order_relaxed);
+  }
+  if (value > max()) {
+    max_.store(value, std::memory_order_relaxed);
+  }
+  num_.store(num() + 1, std::memory_order_relaxed);
+  sum_.store(sum() + value, std::memory_order_relaxed);
+  sum_squares_.store(
+      sum_squares_.load(std::memory_order_relaxed) + value * value,
+      std::memory_order_relaxed);
+}
+
+void HdrHistogramImpl::MergeStats(uint64_t other_min, uint64_t other_max,
+                                  uint64_t other_num, uint64_t other_sum,
+                                  uint64_t other_sum_squares) {
+  uint64_t old_min = min();
+  while (other_min < old_min &&
+         !min_.compare_exchange_weak(old_min, other_min)) {
+  }
+  uint64_t old_max = max();
+  while (other_max > old_max &&
+         !max_.compare_exchange_weak(old_max, other_max)) {
+  }
+  num_.fetch_add(other_num, std::memory_order_relaxed);
+  sum_.fetch_add(other_sum, std::memory_order_relaxed);
+  sum_squares_.fetch_add(other_sum_squares, std::memory_order_relaxed);
+}
+
+void HdrHistogramImpl::Merge(const Histogram& other) {
+  if (strcmp(Name(), other.Name()) == 0) {
+    Merge(*static_cast_with_check<const HdrHistogramImpl>(&other));
+  }
+}
+
+void HdrHistogramImpl::Merge(const HdrHistogramImpl& other) {
+  std::lock_guard<std::mutex> lock(mutex_);
+  MergeStats(other.min(), other.max(), other.num(), other.sum(),
+             other.sum_squares_.load(std::memory_order_relaxed));
+  for (size_t i = 0; i < other.num_buckets(); ++i) {
+    uint64_t count = other.CountAt(i);
+    if (count > 0) {
+      // The middle of the bucket, in case of a different precision
+      uint64_t low = other.LowestValueAt(i);
+      AddToBucket(low + (other.HighestValueAt(i) - low) / 2, count);
+    }
+  }
+}
+
+double HdrHistogramImpl::Median() const { return Percentile(50.0); }
+
+double HdrHistogramImpl::Percentile(double p) const {
+  uint64_t cur_num = num();
+  if (cur_num == 0) {
+    return 0;
+  }
+  uint64_t cur_min = min();
+  uint64_t cur_max = max();
+  // The smallest value with at least p% of the values at or below it
+  double threshold = std::ceil(static_cast<double>(cur_num) * (p / 100.0));
+  threshold = std::max(threshold, 1.0);
+  uint64_t cumulative_sum = 0;
+  for (size_t i = 0; i < num_buckets(); ++i) {
+    uint64_t count = CountAt(i);
+    if (count == 0) {
+      continue;
+    }
+    cumulative_sum += count;
+    if (static_cast<double>(cumulative_sum) >= threshold) {
+      uint64_t r = std::max(std::min(HighestValueAt(i), cur_max), cur_min);
+      return static_cast<double>(r);
+    }
+  }
+  return static_cast<double>(cur_max);
+}
+
+double HdrHistogramImpl::Average() const {
+  uint64_t cur_num = num();
+  if (cur_num == 0) {
+    return 0;
+  }
+  return static_cast<double>(sum()) / static_cast<double>(cur_num);
+}
+
+double HdrHistogramImpl::StandardDeviation() const {
+  double cur_num = static_cast<double>(num());
+  double cur_sum = static_cast<double>(sum());
+  double cur_sum_squares =
+      static_cast<double>(sum_squares_.load(std::memory_order_relaxed));
+  if (cur_num == 0.0) {
+    return 0.0;
+  }
+  double variance =
+      (cur_sum_squares * cur_num - cur_sum * cur_sum) / (cur_num * cur_num);
+  return std::sqrt(std::max(variance, 0.0));
+}
+
+void HdrHistogramImpl::Data(HistogramData* const data) const {
+  assert(data);
+  bool empty = Empty();
+  data->median = Median();
+  data->percentile95 = Percentile(95);
+  data->percentile99 = Percentile(99);
+  data->percentile999 = Percentile(99.9);
+  data->max = empty ? 0.0 : static_cast<double>(max());
+  data->average = Average();
+  data->standard_deviation = StandardDeviation();
+  data->count = num();
+  data->sum = sum();
+  data->min = empty ? 0.0 : static_cast<double>(min());
+}
+
+std::string HdrHistogramImpl::ToString() const {
+  uint64_t cur_num = num();
+  std::string r;
+  char buf[256];
+  snprintf(buf, sizeof(buf), "Count: %" PRIu64 " Average: %.4f  StdDev: %.2f\n",
+           cur_num, Average(), StandardDeviation());
+  r.append(buf);
+  snprintf(buf, sizeof(buf),
+           "Min: %" PRIu64 "  Median: %.4f  Max: %" PRIu64 "\n",
+           (cur_num == 0 ? 0 : min()), Median(), (cur_num == 0 ? 0 : max()));
+  r.append(buf);
+  snprintf(buf, sizeof(buf),
+           "Percentiles: "
+           "P50: %.2f P75: %.2f P99: %.2f P99.9: %.2f P99.99: %.2f\n",
+           Percentile(50), Percentile(75), Percentile(99), Percentile(99.9),
+           Percentile(99.99));
+  r.append(buf);
+  snprintf(buf, sizeof(buf), "Significant digits: %d\n", significant_digits_);
+  r.append(buf);
+  return r;
+}
+
+void HdrHistogramImpl::EncodeTo(std::string* dst) const {
+  PutVarint32(dst, kFormatVersion);
+  PutVarint32(dst, static_cast<uint32_t>(significant_digits_));
+  PutVarint64(dst, min());
+  PutVarint64(dst, max());
+  PutVarint64(dst, num());
+  PutVarint64(dst, sum());
+  PutVarint64(dst, sum_squares_.load(std::memory_order_relaxed));
+
+  std::string buckets;
+  uint32_t num_non_empty = 0;
+  size_t last_index = 0;
+  for (size_t i = 0; i < num_buckets(); ++i) {
+    uint64_t count = CountAt(i);
+    if (count > 0) {
+      PutVarint32(&buckets, static_cast<uint32_t>(i - last_index));
+      PutVarint64(&buckets, count);
+      last_index = i;
+      ++num_non_empty;
+    }
+  }
+  PutVarint32(dst, num_non_empty);
+  dst->append(buckets);
+}
+
+Status HdrHistogramImpl::MergeFrom(const Slice& src) {
+  Slice input = src;
+  uint32_t format_version = 0;
+  uint32_t significant_digits = 0;
+  if (!GetVarint32(&input, &format_version) ||
+      !GetVarint32(&input, &significant_digits)) {
+    return Status::Corruption("Truncated histogram snapshot header");
+  }
+  if (format_version != kFormatVersion) {
+    return Status::NotSupported("Unknown histogram snapshot format version",
+                                std::to_string(format_version));
+  }
+  if (significant_digits < static_cast<uint32_t>(kMinSignificantDigits) ||
+      significant_digits > static_cast<uint32_t>(kMaxSignificantDigits)) {
+    return Status::Corruption("Invalid histogram snapshot precision");
+  }
+  uint64_t other_min = 0;
+  uint64_t other_max = 0;
+  uint64_t other_num = 0;
+  uint64_t other_sum = 0;
+  uint64_t other_sum_squares = 0;
+  uint32_t num_non_empty = 0;
+  if (!GetVarint64(&input, &other_min) || !GetVarint64(&input, &other_max) ||
+      !GetVarint64(&input, &other_num) || !GetVarint64(&input, &other_sum) ||
+      !GetVarint64(&input, &other_sum_squares) ||
+      !GetVarint32(&input, &num_non_empty)) {
+    return Status::Corruption("Truncated histogram snapshot header");
+  }
+
+  // Decodes everything before merging, so that a corrupted snapshot leaves
+  // the histogram unchanged
+  HdrHistogramImpl other(static_cast<int>(significant_digits));
+  size_t index = 0;
+  for (uint32_t i = 0; i < num_non_empty; ++i) {
+    uint32_t delta = 0;
+    uint64_t count = 0;
+    if (!GetVarint32(&input, &delta) || !GetVarint64(&input, &count)) {
+      return Status::Corruption("Truncated histogram snapshot buckets");
+    }
+    index += delta;
+    if (index >= other.num_buckets() || (i > 0 && delta == 0)) {
+      return Status::Corruption("Invalid histogram snapshot bucket");
+    }
+    other.AddToBucket(other.LowestValueAt(index), count);
+  }
+  if (!input.empty()) {
+    return Status::Corruption("Trailing bytes in histogram snapshot");
+  }
+  other.MergeStats(other_min, other_max, other_num, other_sum,
+                   other_sum_squares);
+  Merge(other);
+  return Status::OK();
+}
+
+namespace {
+// Decodes `snapshot` into `histogram`, at the precision of the snapshot
+Status DecodeHistogramSnapshot(const std::string& snapshot,
+                               HdrHistogramImpl* histogram) {
+  Slice input(snapshot);
+  uint32_t format_version = 0;
+  uint32_t significant_digits = 0;
+  if (!GetVarint32(&input, &format_version) ||
+      !GetVarint32(&input, &significant_digits)) {
+    return Status::Corruption("Truncated histogram snapshot header");
+  }
+  histogram->SetSignificantDigits(static_cast<int>(significant_digits));
+  return histogram->MergeFrom(snapshot);
+}
+}  // anonymous namespace
+
+Status MergeHistogramSnapshots(const std::string& other,
+                               std::string* snapshot) {
+  assert(snapshot);
+  HdrHistogramImpl histogram;
+  Status s = DecodeHistogramSnapshot(snapshot->empty() ? other : *snapshot,
+                                     &histogram);
+  if (s.ok() && !snapshot->empty()) {
+    s = histogram.MergeFrom(other);
+  }
+  if (s.ok()) {
+    snapshot->clear();
+    histogram.EncodeTo(snapshot);
+  }
+  return s;
+}
+
+Status GetHistogramSnapshotData(const std::string& snapshot,
+                                HistogramData* data) {
+  assert(data);
+  HdrHistogramImpl histogram;
+  Status s = DecodeHistogramSnapshot(snapshot, &histogram);
+  if (s.ok()) {
+    histogram.Data(data);
+  }
+  return s;
+}
+
+Status GetHistogramSnapshotPercentile(const std::string& snapshot, double p,
+                                      double* value) {
+  assert(value);
+  HdrHistogramImpl histogram;
+  Status s = DecodeHistogramSnapshot(snapshot, &histogram);
+  if (s.ok()) {
+    *value = histogram.Percentile(p);
+  }
+  return s;
+}
+
+}  // namespace ROCKSDB_NAMESPACE
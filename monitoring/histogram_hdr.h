@@ -0,0 +1,111 @@
+//  Copyright (c) Meta Platforms, Inc. and affiliates.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+
+#pragma once
+
+#include <atomic>
+#include <mutex>
+#include <string>
+
+#include "monitoring/histogram.h"
+#include "rocksdb/slice.h"
+#include "rocksdb/status.h"
+
+namespace ROCKSDB_NAMESPACE {
+
+// A histogram in the layout of HdrHistogram. The values of each power of two
+// share the same number of buckets, enough to tell them apart with
+// `significant_digits` decimal digits, so the percentiles are the values of
+// their bucket within that precision rather than interpolated across a
+// coarse bucket. The buckets of a power of two are allocated on first use.
+//
+// Like HistogramStat, Add() is lock free and tolerates losing updates to
+// concurrent Add() on the same histogram, which StatisticsImpl avoids by
+// keeping one histogram per core.
+//
+// A histogram can be encoded to a snapshot, which merges into histograms of
+// any precision:
+//   format version: varint32
+//   significant digits: varint32
+//   min, max, count, sum, sum of squares: varint64 each
+//   number of non-empty buckets: varint32
+//   for each non-empty bucket, in order: varint32 index delta from the
+//   previous one, varint64 count
+class HdrHistogramImpl : public Histogram {
+ public:
+  static constexpr int kMinSignificantDigits = 1;
+  static constexpr int kMaxSignificantDigits = 4;
+  static constexpr int kDefaultSignificantDigits = 2;
+
+  explicit HdrHistogramImpl(
+      int significant_digits = kDefaultSignificantDigits);
+  ~HdrHistogramImpl() override;
+
+  HdrHistogramImpl(const HdrHistogramImpl&) = delete;
+  HdrHistogramImpl& operator=(const HdrHistogramImpl&) = delete;
+
+  // Clamped to [kMinSignificantDigits, kMaxSignificantDigits]
+  // REQUIRES: no concurrent access. Clears the histogram.
+  void SetSignificantDigits(int significant_digits);
+  int significant_digits() const { return significant_digits_; }
+
+  void Clear() override;
+  bool Empty() const override;
+  void Add(uint64_t value) override;
+  void Merge(const Histogram& other) override;
+  void Merge(const HdrHistogramImpl& other);
+
+  std::string ToString() const override;
+  const char* Name() const override { return "HdrHistogramImpl"; }
+  uint64_t min() const override { return min_.load(std::memory_order_relaxed); }
+  uint64_t max() const override { return max_.load(std::memory_order_relaxed); }
+  uint64_t num() const override { return num_.load(std::memory_order_relaxed); }
+  uint64_t sum() const { return sum_.load(std::memory_order_relaxed); }
+  double Median() const override;
+  double Percentile(double p) const override;
+  double Average() const override;
+  double StandardDeviation() const override;
+  void Data(HistogramData* const data) const override;
+
+  // Appends the snapshot of the histogram to `dst`
+  void EncodeTo(std::string* dst) const;
+  // Merges the snapshot `src` into the histogram
+  Status MergeFrom(const Slice& src);
+
+ private:
+  static constexpr uint32_t kFormatVersion = 1;
+  // Enough for the 64-bit values at the least precision
+  static constexpr size_t kMaxChunks = 64;
+
+  size_t IndexForValue(uint64_t value) const;
+  // The range of values of the bucket at `index`
+  uint64_t LowestValueAt(size_t index) const;
+  uint64_t HighestValueAt(size_t index) const;
+  uint64_t CountAt(size_t index) const;
+  // Adds `count` to the bucket of `value`, without the other stats
+  void AddToBucket(uint64_t value, uint64_t count);
+  void MergeStats(uint64_t other_min, uint64_t other_max, uint64_t other_num,
+                  uint64_t other_sum, uint64_t other_sum_squares);
+  void FreeChunks();
+
+  size_t num_buckets() const { return num_chunks_ << chunk_magnitude_; }
+
+  int significant_digits_;
+  // Each chunk holds the buckets of a power of two, 2^chunk_magnitude_ of
+  // them, except for chunk 0 which holds the smallest values one by one
+  int chunk_magnitude_;
+  uint64_t sub_bucket_mask_;
+  size_t num_chunks_;
+
+  std::atomic<uint64_t> min_;
+  std::atomic<uint64_t> max_;
+  std::atomic<uint64_t> num_;
+  std::atomic<uint64_t> sum_;
+  std::atomic<uint64_t> sum_squares_;
+  std::atomic<std::atomic<uint64_t>*> chunks_[kMaxChunks];
+  std::mutex mutex_;
+};
+
+}  // namespace ROCKSDB_NAMESPACE
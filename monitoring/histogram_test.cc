@@ -7,6 +7,7 @@
 
 #include <cmath>
 
+#include "monitoring/histogram_hdr.h"
 #include "monitoring/histogram_windowing.h"
 #include "rocksdb/system_clock.h"
 #include "test_util/mock_time_env.h"
@@ -245,6 +246,91 @@ TEST_F(HistogramTest, LostUpdateStandardDeviation) {
   ASSERT_GE(histogram.StandardDeviation(), 0.0);
 }
 
+TEST_F(HistogramTest, HdrPercentiles) {
+  HdrHistogramImpl histogram(2);
+  ASSERT_TRUE(histogram.Empty());
+  ASSERT_EQ(histogram.Percentile(99.9), 0.0);
+  for (uint64_t i = 1; i <= 100000; i++) {
+    histogram.Add(i);
+  }
+  HistogramData data;
+  histogram.Data(&data);
+  // Within 1% of the values, where HistogramImpl has buckets ~5% wide
+  ASSERT_LE(fabs(data.median - 50000.0), 500.0);
+  ASSERT_LE(fabs(data.percentile99 - 99000.0), 990.0);
+  ASSERT_LE(fabs(data.percentile999 - 99900.0), 999.0);
+  ASSERT_EQ(data.max, 100000.0);
+  ASSERT_EQ(data.min, 1.0);
+  ASSERT_EQ(data.count, 100000U);
+  ASSERT_EQ(data.average, 50000.5);
+  // The small values are exact
+  HdrHistogramImpl small;
+  for (uint64_t i = 1; i <= 100; i++) {
+    small.Add(i);
+  }
+  ASSERT_EQ(small.Percentile(99.0), 99.0);
+  ASSERT_EQ(small.Percentile(50.0), 50.0);
+
+  ClearHistogram(histogram);
+}
+
+TEST_F(HistogramTest, HdrMergeDifferentPrecision) {
+  HdrHistogramImpl histogram(3);
+  HdrHistogramImpl other(1);
+  for (uint64_t i = 1; i <= 1000; i++) {
+    histogram.Add(i * 10);
+    other.Add(10000 + i * 10);
+  }
+  histogram.Merge(other);
+  ASSERT_EQ(histogram.num(), 2000U);
+  ASSERT_EQ(histogram.min(), 10U);
+  ASSERT_EQ(histogram.max(), 20000U);
+  // Within 0.1% of the power of two for `histogram`, 10% for `other`
+  ASSERT_LE(fabs(histogram.Median() - 10000.0), 20.0);
+  ASSERT_LE(fabs(histogram.Percentile(99.9) - 19980.0), 1998.0);
+}
+
+TEST_F(HistogramTest, HdrSnapshot) {
+  HdrHistogramImpl histogram(3);
+  HdrHistogramImpl other(2);
+  for (uint64_t i = 1; i <= 1000; i++) {
+    histogram.Add(i);
+    other.Add(i * 1000);
+  }
+  std::string snapshot;
+  histogram.EncodeTo(&snapshot);
+  std::string other_snapshot;
+  other.EncodeTo(&other_snapshot);
+
+  HistogramData data;
+  ASSERT_OK(GetHistogramSnapshotData(snapshot, &data));
+  HistogramData expected;
+  histogram.Data(&expected);
+  ASSERT_EQ(data.median, expected.median);
+  ASSERT_EQ(data.percentile999, expected.percentile999);
+  ASSERT_EQ(data.count, expected.count);
+  ASSERT_EQ(data.sum, expected.sum);
+
+  std::string merged;
+  ASSERT_OK(MergeHistogramSnapshots(snapshot, &merged));
+  ASSERT_EQ(merged, snapshot);
+  ASSERT_OK(MergeHistogramSnapshots(other_snapshot, &merged));
+  histogram.Merge(other);
+  double value = 0;
+  ASSERT_OK(GetHistogramSnapshotPercentile(merged, 99.9, &value));
+  ASSERT_EQ(value, histogram.Percentile(99.9));
+  ASSERT_OK(GetHistogramSnapshotData(merged, &data));
+  ASSERT_EQ(data.count, 2000U);
+  ASSERT_EQ(data.max, 1000000.0);
+
+  // Truncated or garbage snapshots don't decode
+  ASSERT_TRUE(GetHistogramSnapshotData(snapshot.substr(0, snapshot.size() - 1),
+                                       &data)
+                  .IsCorruption());
+  ASSERT_TRUE(GetHistogramSnapshotData("", &data).IsCorruption());
+  ASSERT_NOK(MergeHistogramSnapshots("garbage", &merged));
+}
+
 }  // namespace ROCKSDB_NAMESPACE
 
 int main(int argc, char** argv) {
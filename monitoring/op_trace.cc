@@ -0,0 +1,108 @@
+//  Copyright (c) Meta Platforms, Inc. and affiliates.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+
+#include <cassert>
+#include <cinttypes>
+#include <cstdio>
+
+#include "monitoring/op_trace_impl.h"
+#include "util/random.h"
+
+namespace ROCKSDB_NAMESPACE {
+
+thread_local OpTraceContext op_trace_context;
+
+std::string OpTrace::ToString() const {
+  std::string result;
+  std::vector<int> depths(spans.size(), 0);
+  for (size_t i = 0; i < spans.size(); ++i) {
+    const OpTraceSpan& span = spans[i];
+    if (span.parent >= 0) {
+      assert(static_cast<size_t>(span.parent) < i);
+      depths[i] = depths[span.parent] + 1;
+    }
+    result.append(2 * depths[i], ' ');
+    char buf[128];
+    snprintf(buf, sizeof(buf), "%s +%" PRIu64 "ns %" PRIu64 "ns",
+             span.name ? span.name : "?", span.start_nanos,
+             span.duration_nanos);
+    result.append(buf);
+    if (span.file_number != 0) {
+      snprintf(buf, sizeof(buf), " file %" PRIu64, span.file_number);
+      result.append(buf);
+    }
+    result.push_back('\n');
+  }
+  if (num_dropped_spans > 0) {
+    char buf[64];
+    snprintf(buf, sizeof(buf), "(%" PRIu64 " spans dropped)\n",
+             num_dropped_spans);
+    result.append(buf);
+  }
+  return result;
+}
+
+void OpTraceContext::Start(OpTraceSink* sink, SystemClock* clock,
+                           const char* op_name) {
+  assert(!IsTracing());
+  assert(sink != nullptr && clock != nullptr);
+  sink_ = sink;
+  clock_ = clock;
+  start_nanos_ = clock_->NowNanos();
+  trace_.spans.clear();
+  trace_.num_dropped_spans = 0;
+  OpTraceSpan root;
+  root.name = op_name;
+  trace_.spans.push_back(root);
+  current_span_ = 0;
+}
+
+void OpTraceContext::Finish() {
+  assert(IsTracing());
+  EndSpan(0);
+  OpTraceSink* sink = sink_;
+  // Not tracing anymore, in case the sink calls into the DB
+  sink_ = nullptr;
+  sink->Export(trace_);
+}
+
+int OpTraceContext::StartSpan(const char* name, uint64_t file_number) {
+  assert(IsTracing());
+  if (trace_.spans.size() >= kMaxSpans) {
+    ++trace_.num_dropped_spans;
+    return -1;
+  }
+  OpTraceSpan span;
+  span.name = name;
+  span.parent = current_span_;
+  span.start_nanos = ElapsedNanos();
+  span.file_number = file_number;
+  trace_.spans.push_back(span);
+  current_span_ = static_cast<int>(trace_.spans.size() - 1);
+  return current_span_;
+}
+
+void OpTraceContext::EndSpan(int span) {
+  assert(IsTracing());
+  if (span < 0) {
+    return;
+  }
+  assert(span == current_span_);
+  OpTraceSpan& s = trace_.spans[span];
+  s.duration_nanos = ElapsedNanos() - s.start_nanos;
+  current_span_ = s.parent;
+}
+
+void OpTraceScope::MaybeStart(OpTraceSink* sink, uint32_t sample_one_in,
+                              SystemClock* clock, const char* op_name) {
+  if (sample_one_in > 1 &&
+      !Random::GetTLSInstance()->OneIn(static_cast<int>(sample_one_in))) {
+    return;
+  }
+  op_trace_context.Start(sink, clock, op_name);
+  started_ = true;
+}
+
+}  // namespace ROCKSDB_NAMESPACE
@@ -0,0 +1,123 @@
+//  Copyright (c) Meta Platforms, Inc. and affiliates.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+
+#pragma once
+
+#include "rocksdb/op_trace.h"
+#include "rocksdb/system_clock.h"
+
+namespace ROCKSDB_NAMESPACE {
+
+// The trace of the operation the thread is running, if sampled
+class OpTraceContext {
+ public:
+  // Bounds the memory of an operation touching many files or blocks
+  static constexpr size_t kMaxSpans = 1024;
+
+  bool IsTracing() const { return sink_ != nullptr; }
+
+  // Starts the trace with the root span `op_name`
+  // REQUIRES: !IsTracing()
+  void Start(OpTraceSink* sink, SystemClock* clock, const char* op_name);
+  // Exports the trace to the sink and stops tracing
+  // REQUIRES: IsTracing()
+  void Finish();
+
+  // Returns the index of the new span, a child of the current one, or -1 if
+  // over kMaxSpans
+  // REQUIRES: IsTracing()
+  int StartSpan(const char* name, uint64_t file_number);
+  // REQUIRES: IsTracing(), `span` is the current span or -1
+  void EndSpan(int span);
+
+ private:
+  uint64_t ElapsedNanos() const { return clock_->NowNanos() - start_nanos_; }
+
+  OpTraceSink* sink_ = nullptr;
+  SystemClock* clock_ = nullptr;
+  uint64_t start_nanos_ = 0;
+  int current_span_ = -1;
+  // Reused by the operations of the thread
+  OpTrace trace_;
+};
+
+extern thread_local OpTraceContext op_trace_context;
+
+// Traces the operation `op_name` for its lifetime, if sampled. Within the
+// operation of another OpTraceScope, it's a span of that operation instead.
+class OpTraceScope {
+ public:
+  OpTraceScope(OpTraceSink* sink, uint32_t sample_one_in, SystemClock* clock,
+               const char* op_name) {
+    if (op_trace_context.IsTracing()) {
+      span_ = op_trace_context.StartSpan(op_name, /*file_number=*/0);
+      nested_ = true;
+    } else if (sink != nullptr && sample_one_in > 0) {
+      MaybeStart(sink, sample_one_in, clock, op_name);
+    }
+  }
+  ~OpTraceScope() {
+    if (nested_) {
+      op_trace_context.EndSpan(span_);
+    } else if (started_) {
+      op_trace_context.Finish();
+    }
+  }
+
+  OpTraceScope(const OpTraceScope&) = delete;
+  OpTraceScope& operator=(const OpTraceScope&) = delete;
+
+ private:
+  void MaybeStart(OpTraceSink* sink, uint32_t sample_one_in,
+                  SystemClock* clock, const char* op_name);
+
+  int span_ = -1;
+  bool nested_ = false;
+  bool started_ = false;
+};
+
+// Records a span of the traced operation for its lifetime, if any
+class OpTraceSpanGuard {
+ public:
+  explicit OpTraceSpanGuard(const char* name, uint64_t file_number = 0) {
+    if (op_trace_context.IsTracing()) {
+      span_ = op_trace_context.StartSpan(name, file_number);
+      active_ = true;
+    }
+  }
+  ~OpTraceSpanGuard() {
+    if (active_) {
+      op_trace_context.EndSpan(span_);
+    }
+  }
+
+  OpTraceSpanGuard(const OpTraceSpanGuard&) = delete;
+  OpTraceSpanGuard& operator=(const OpTraceSpanGuard&) = delete;
+
+ private:
+  int span_ = -1;
+  bool active_ = false;
+};
+
+// Traces the DB operation `op_name` until the end of the scope, as configured
+// by the ImmutableDBOptions `db_options`
+#define OP_TRACE_OPERATION(db_options, op_name)                        \
+  OpTraceScope op_trace_scope((db_options).op_trace_sink.get(),        \
+                              (db_options).op_trace_sample_one_in,     \
+                              (db_options).clock, op_name)
+
+#define OP_TRACE_CONCAT_IMPL(a, b) a##b
+#define OP_TRACE_CONCAT(a, b) OP_TRACE_CONCAT_IMPL(a, b)
+
+// Records a span `name` until the end of the scope
+#define OP_TRACE_SPAN(name) \
+  OpTraceSpanGuard OP_TRACE_CONCAT(op_trace_span_, __LINE__)(name)
+
+// Same as OP_TRACE_SPAN, for a step on the file `file_number`
+#define OP_TRACE_FILE_SPAN(name, file_number)                   \
+  OpTraceSpanGuard OP_TRACE_CONCAT(op_trace_span_, __LINE__)(name, \
+                                                             file_number)
+
+}  // namespace ROCKSDB_NAMESPACE
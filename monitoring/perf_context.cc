@@ -155,7 +155,13 @@ struct PerfContextByLevelInt {
   defCmd(iter_seek_count)                          \
   defCmd(encrypt_data_nanos)                       \
   defCmd(decrypt_data_nanos)                       \
-  defCmd(number_async_seek)
+  defCmd(number_async_seek)                        \
+  defCmd(cloud_request_count)                      \
+  defCmd(cloud_read_byte)                          \
+  defCmd(cloud_write_byte)                         \
+  defCmd(cloud_request_nanos)                      \
+  defCmd(block_compress_time)                      \
+  defCmd(compaction_filter_time)
 // clang-format on
 
 struct PerfContextInt {
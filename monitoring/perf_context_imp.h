@@ -33,6 +33,7 @@ extern thread_local PerfContext perf_context;
 #define PERF_TIMER_MEASURE(metric)
 #define PERF_COUNTER_ADD(metric, value)
 #define PERF_COUNTER_BY_LEVEL_ADD(metric, value, level)
+#define PERF_SAMPLED_OPERATION_GUARD()
 
 #else
 
@@ -77,15 +78,15 @@ extern thread_local PerfContext perf_context;
 #define PERF_TIMER_MEASURE(metric) perf_step_timer_##metric.Measure();
 
 // Increase metric value
-#define PERF_COUNTER_ADD(metric, value)        \
-  if (perf_level >= PerfLevel::kEnableCount) { \
-    perf_context.metric += value;              \
-  }                                            \
+#define PERF_COUNTER_ADD(metric, value)              \
+  if (PerfLevelEnabled(PerfLevel::kEnableCount)) { \
+    perf_context.metric += value;                  \
+  }                                                \
   static_assert(true, "semicolon required")
 
 // Increase metric value
 #define PERF_COUNTER_BY_LEVEL_ADD(metric, value, level)               \
-  if (perf_level >= PerfLevel::kEnableCount &&                        \
+  if (PerfLevelEnabled(PerfLevel::kEnableCount) &&                    \
       perf_context.per_level_perf_context_enabled &&                  \
       perf_context.level_to_perf_context) {                           \
     if ((*(perf_context.level_to_perf_context)).find(level) !=        \
@@ -98,6 +99,10 @@ extern thread_local PerfContext perf_context;
     }                                                                 \
   }
 
+// Applies SetPerfLevelSampling() to the operation until the end of the scope
+#define PERF_SAMPLED_OPERATION_GUARD() \
+  SampledPerfLevelGuard sampled_perf_level_guard
+
 #endif
 
 }  // namespace ROCKSDB_NAMESPACE
@@ -7,10 +7,13 @@
 #include <cassert>
 
 #include "monitoring/perf_level_imp.h"
+#include "util/random.h"
 
 namespace ROCKSDB_NAMESPACE {
 
 thread_local PerfLevel perf_level = kEnableCount;
+thread_local PerfLevel perf_sampled_level = kDisable;
+thread_local uint32_t perf_sample_one_in = 0;
 
 void SetPerfLevel(PerfLevel level) {
   assert(level > kUninitialized);
@@ -20,4 +23,21 @@ void SetPerfLevel(PerfLevel level) {
 
 PerfLevel GetPerfLevel() { return perf_level; }
 
+void SetPerfLevelSampling(PerfLevel level, uint32_t one_in) {
+  assert(level > kUninitialized);
+  assert(level < kOutOfBounds);
+  perf_sampled_level = level;
+  perf_sample_one_in = one_in;
+}
+
+void SampledPerfLevelGuard::MaybeRaise() {
+  if (perf_sample_one_in > 1 &&
+      !Random::GetTLSInstance()->OneIn(static_cast<int>(perf_sample_one_in))) {
+    return;
+  }
+  prev_level_ = perf_level;
+  perf_level = perf_sampled_level;
+  raised_ = true;
+}
+
 }  // namespace ROCKSDB_NAMESPACE
@@ -11,4 +11,52 @@ namespace ROCKSDB_NAMESPACE {
 
 extern thread_local PerfLevel perf_level;
 
+// The highest perf level the build collects stats for, set with
+// -DROCKSDB_PERF_LEVEL_MAX=<PerfLevel value>. For example 2 (kEnableCount)
+// keeps the counters but compiles out the timers. Above it, the perf level
+// of the thread is not even read.
+#ifdef ROCKSDB_PERF_LEVEL_MAX
+constexpr PerfLevel kPerfLevelMax =
+    static_cast<PerfLevel>(ROCKSDB_PERF_LEVEL_MAX);
+#else
+constexpr PerfLevel kPerfLevelMax = PerfLevel::kEnableTime;
+#endif
+static_assert(kPerfLevelMax > PerfLevel::kUninitialized &&
+                  kPerfLevelMax < PerfLevel::kOutOfBounds,
+              "ROCKSDB_PERF_LEVEL_MAX must be a valid PerfLevel");
+
+// Whether the current thread collects the perf stats of `level`
+inline bool PerfLevelEnabled(PerfLevel level) {
+  return kPerfLevelMax >= level && perf_level >= level;
+}
+
+// Set by SetPerfLevelSampling()
+extern thread_local PerfLevel perf_sampled_level;
+extern thread_local uint32_t perf_sample_one_in;
+
+// Raises the perf level of the thread to its sampled level for the lifetime
+// of the guard, for one in perf_sample_one_in operations
+class SampledPerfLevelGuard {
+ public:
+  SampledPerfLevelGuard() {
+    if (perf_sample_one_in > 0 && perf_level < perf_sampled_level) {
+      MaybeRaise();
+    }
+  }
+  ~SampledPerfLevelGuard() {
+    if (raised_) {
+      perf_level = prev_level_;
+    }
+  }
+
+  SampledPerfLevelGuard(const SampledPerfLevelGuard&) = delete;
+  SampledPerfLevelGuard& operator=(const SampledPerfLevelGuard&) = delete;
+
+ private:
+  void MaybeRaise();
+
+  PerfLevel prev_level_ = PerfLevel::kUninitialized;
+  bool raised_ = false;
+};
+
 }  // namespace ROCKSDB_NAMESPACE
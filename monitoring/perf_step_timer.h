@@ -16,7 +16,7 @@ class PerfStepTimer {
       uint64_t* metric, SystemClock* clock = nullptr, bool use_cpu_time = false,
       PerfLevel enable_level = PerfLevel::kEnableTimeExceptForMutex,
       Statistics* statistics = nullptr, uint32_t ticker_type = 0)
-      : perf_counter_enabled_(perf_level >= enable_level),
+      : perf_counter_enabled_(PerfLevelEnabled(enable_level)),
         use_cpu_time_(use_cpu_time),
         ticker_type_(ticker_type),
         clock_((perf_counter_enabled_ || statistics != nullptr)
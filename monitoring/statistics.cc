@@ -266,6 +266,21 @@ const std::vector<std::pair<Tickers, std::string>> TickersNameMap = {
     {PREFETCH_BYTES_USEFUL, "rocksdb.prefetch.bytes.useful"},
     {PREFETCH_HITS, "rocksdb.prefetch.hits"},
     {SST_FOOTER_CORRUPTION_COUNT, "rocksdb.footer.corruption.count"},
+    {CLOUD_READ_REQUESTS, "rocksdb.cloud.read.requests"},
+    {CLOUD_WRITE_REQUESTS, "rocksdb.cloud.write.requests"},
+    {CLOUD_INFO_REQUESTS, "rocksdb.cloud.info.requests"},
+    {CLOUD_LIST_REQUESTS, "rocksdb.cloud.list.requests"},
+    {CLOUD_COPY_REQUESTS, "rocksdb.cloud.copy.requests"},
+    {CLOUD_DELETE_REQUESTS, "rocksdb.cloud.delete.requests"},
+    {CLOUD_CREATE_REQUESTS, "rocksdb.cloud.create.requests"},
+    {CLOUD_REQUEST_FAILURES, "rocksdb.cloud.request.failures"},
+    {CLOUD_BYTES_READ, "rocksdb.cloud.bytes.read"},
+    {CLOUD_BYTES_WRITTEN, "rocksdb.cloud.bytes.written"},
+    {CLOUD_REQUEST_RETRIES, "rocksdb.cloud.request.retries"},
+    {CLOUD_REQUEST_THROTTLES, "rocksdb.cloud.request.throttles"},
+    {REPLICATION_RECORDS_APPLIED, "rocksdb.replication.records.applied"},
+    {REPLICATION_BYTES_APPLIED, "rocksdb.replication.bytes.applied"},
+    {REPLICATION_EPOCH_UPDATES, "rocksdb.replication.epoch.updates"},
 };
 
 const std::vector<std::pair<Histograms, std::string>> HistogramsNameMap = {
@@ -336,12 +351,37 @@ const std::vector<std::pair<Histograms, std::string>> HistogramsNameMap = {
     {ASYNC_PREFETCH_ABORT_MICROS, "rocksdb.async.prefetch.abort.micros"},
     {TABLE_OPEN_PREFETCH_TAIL_READ_BYTES,
      "rocksdb.table.open.prefetch.tail.read.bytes"},
+    {CLOUD_READ_MICROS, "rocksdb.cloud.read.micros"},
+    {CLOUD_WRITE_MICROS, "rocksdb.cloud.write.micros"},
+    {CLOUD_INFO_MICROS, "rocksdb.cloud.info.micros"},
+    {CLOUD_LIST_MICROS, "rocksdb.cloud.list.micros"},
+    {CLOUD_COPY_MICROS, "rocksdb.cloud.copy.micros"},
+    {CLOUD_DELETE_MICROS, "rocksdb.cloud.delete.micros"},
+    {CLOUD_CREATE_MICROS, "rocksdb.cloud.create.micros"},
+    {CLOUD_UPLOAD_QUEUE_DEPTH, "rocksdb.cloud.upload.queue.depth"},
+    {CLOUD_OPEN_SANITIZE_MICROS, "rocksdb.cloud.open.sanitize.micros"},
+    {CLOUD_OPEN_LOAD_CLOUD_MANIFEST_MICROS,
+     "rocksdb.cloud.open.load.cloud.manifest.micros"},
+    {CLOUD_OPEN_DB_MICROS, "rocksdb.cloud.open.db.micros"},
+    {CLOUD_OPEN_MICROS, "rocksdb.cloud.open.micros"},
+    {CLOUD_SCHEDULER_LAG_MICROS, "rocksdb.cloud.scheduler.lag.micros"},
+    {REPLICATION_MEMTABLE_WRITE_APPLY_MICROS,
+     "rocksdb.replication.memtable.write.apply.micros"},
+    {REPLICATION_MEMTABLE_SWITCH_APPLY_MICROS,
+     "rocksdb.replication.memtable.switch.apply.micros"},
+    {REPLICATION_MANIFEST_WRITE_APPLY_MICROS,
+     "rocksdb.replication.manifest.write.apply.micros"},
 };
 
 std::shared_ptr<Statistics> CreateDBStatistics() {
   return std::make_shared<StatisticsImpl>(nullptr);
 }
 
+std::shared_ptr<Statistics> CreateDBStatistics(
+    const StatisticsOptions& options) {
+  return std::make_shared<StatisticsImpl>(nullptr, options);
+}
+
 static int RegisterBuiltinStatistics(ObjectLibrary& library,
                                      const std::string& /*arg*/) {
   library.AddFactory<Statistics>(
@@ -378,9 +418,21 @@ static std::unordered_map<std::string, OptionTypeInfo> stats_type_info = {
                   OptionTypeFlags::kCompareNever)},
 };
 
-StatisticsImpl::StatisticsImpl(std::shared_ptr<Statistics> stats)
+StatisticsImpl::StatisticsImpl(std::shared_ptr<Statistics> stats,
+                               const StatisticsOptions& options)
     : stats_(std::move(stats)) {
   RegisterOptions("StatisticsOptions", &stats_, &stats_type_info);
+  if (options.hdr_histogram_significant_digits > 0) {
+    per_core_hdr_histograms_.reset(new CoreLocalArray<HdrHistogramData>());
+    for (size_t core_idx = 0; core_idx < per_core_hdr_histograms_->Size();
+         ++core_idx) {
+      for (auto& histogram :
+           per_core_hdr_histograms_->AccessAtCore(core_idx)->histograms_) {
+        histogram.SetSignificantDigits(
+            options.hdr_histogram_significant_digits);
+      }
+    }
+  }
 }
 
 StatisticsImpl::~StatisticsImpl() = default;
@@ -405,9 +457,20 @@ void StatisticsImpl::histogramData(uint32_t histogramType,
   getHistogramImplLocked(histogramType)->Data(data);
 }
 
-std::unique_ptr<HistogramImpl> StatisticsImpl::getHistogramImplLocked(
+std::unique_ptr<Histogram> StatisticsImpl::getHistogramImplLocked(
     uint32_t histogramType) const {
   assert(histogramType < HISTOGRAM_ENUM_MAX);
+  if (per_core_hdr_histograms_) {
+    const HdrHistogramData* core0 = per_core_hdr_histograms_->AccessAtCore(0);
+    std::unique_ptr<HdrHistogramImpl> res_hist(new HdrHistogramImpl(
+        core0->histograms_[histogramType].significant_digits()));
+    for (size_t core_idx = 0; core_idx < per_core_hdr_histograms_->Size();
+         ++core_idx) {
+      res_hist->Merge(per_core_hdr_histograms_->AccessAtCore(core_idx)
+                          ->histograms_[histogramType]);
+    }
+    return res_hist;
+  }
   std::unique_ptr<HistogramImpl> res_hist(new HistogramImpl());
   for (size_t core_idx = 0; core_idx < per_core_stats_.Size(); ++core_idx) {
     res_hist->Merge(
@@ -421,6 +484,27 @@ std::string StatisticsImpl::getHistogramString(uint32_t histogramType) const {
   return getHistogramImplLocked(histogramType)->ToString();
 }
 
+Status StatisticsImpl::getHistogramSnapshot(uint32_t histogramType,
+                                            std::string* snapshot) const {
+  assert(snapshot);
+  if (!per_core_hdr_histograms_) {
+    return Status::NotSupported(
+        "Histogram snapshots require "
+        "StatisticsOptions::hdr_histogram_significant_digits");
+  }
+  if (histogramType >= HISTOGRAM_ENUM_MAX) {
+    return Status::InvalidArgument("Unknown histogram type");
+  }
+  std::unique_ptr<Histogram> histogram;
+  {
+    MutexLock lock(&aggregate_lock_);
+    histogram = getHistogramImplLocked(histogramType);
+  }
+  snapshot->clear();
+  static_cast<HdrHistogramImpl*>(histogram.get())->EncodeTo(snapshot);
+  return Status::OK();
+}
+
 void StatisticsImpl::setTickerCount(uint32_t tickerType, uint64_t count) {
   {
     MutexLock lock(&aggregate_lock_);
@@ -479,7 +563,11 @@ void StatisticsImpl::recordInHistogram(uint32_t histogramType, uint64_t value) {
   if (get_stats_level() <= StatsLevel::kExceptHistogramOrTimers) {
     return;
   }
-  per_core_stats_.Access()->histograms_[histogramType].Add(value);
+  if (per_core_hdr_histograms_) {
+    per_core_hdr_histograms_->Access()->histograms_[histogramType].Add(value);
+  } else {
+    per_core_stats_.Access()->histograms_[histogramType].Add(value);
+  }
   if (stats_ && histogramType < HISTOGRAM_ENUM_MAX) {
     stats_->recordInHistogram(histogramType, value);
   }
@@ -494,6 +582,14 @@ Status StatisticsImpl::Reset() {
     for (size_t core_idx = 0; core_idx < per_core_stats_.Size(); ++core_idx) {
       per_core_stats_.AccessAtCore(core_idx)->histograms_[i].Clear();
     }
+    if (per_core_hdr_histograms_) {
+      for (size_t core_idx = 0; core_idx < per_core_hdr_histograms_->Size();
+           ++core_idx) {
+        per_core_hdr_histograms_->AccessAtCore(core_idx)
+            ->histograms_[i]
+            .Clear();
+      }
+    }
   }
   return Status::OK();
 }
@@ -558,4 +654,43 @@ bool StatisticsImpl::HistEnabledForType(uint32_t type) const {
   return type < HISTOGRAM_ENUM_MAX;
 }
 
+ColumnFamilyStatistics::ColumnFamilyStatistics(
+    std::shared_ptr<Statistics> cf_stats, std::shared_ptr<Statistics> db_stats)
+    : cf_stats_(std::move(cf_stats)), db_stats_(std::move(db_stats)) {
+  // Timers are recorded if either statistics want them
+  StatsLevel level = cf_stats_->get_stats_level();
+  if (db_stats_ != nullptr) {
+    level = std::max(level, db_stats_->get_stats_level());
+  }
+  set_stats_level(level);
+}
+
+void ColumnFamilyStatistics::setTickerCount(uint32_t ticker_type,
+                                            uint64_t count) {
+  cf_stats_->setTickerCount(ticker_type, count);
+  if (db_stats_ != nullptr) {
+    db_stats_->setTickerCount(ticker_type, count);
+  }
+}
+
+void ColumnFamilyStatistics::recordTick(uint32_t ticker_type, uint64_t count) {
+  cf_stats_->recordTick(ticker_type, count);
+  if (db_stats_ != nullptr) {
+    db_stats_->recordTick(ticker_type, count);
+  }
+}
+
+void ColumnFamilyStatistics::recordInHistogram(uint32_t histogram_type,
+                                               uint64_t value) {
+  cf_stats_->recordInHistogram(histogram_type, value);
+  if (db_stats_ != nullptr) {
+    db_stats_->recordInHistogram(histogram_type, value);
+  }
+}
+
+bool ColumnFamilyStatistics::HistEnabledForType(uint32_t type) const {
+  return cf_stats_->HistEnabledForType(type) ||
+         (db_stats_ != nullptr && db_stats_->HistEnabledForType(type));
+}
+
 }  // namespace ROCKSDB_NAMESPACE
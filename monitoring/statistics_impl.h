@@ -10,6 +10,7 @@
 #include <vector>
 
 #include "monitoring/histogram.h"
+#include "monitoring/histogram_hdr.h"
 #include "port/likely.h"
 #include "port/port.h"
 #include "rocksdb/statistics.h"
@@ -41,7 +42,9 @@ enum HistogramsInternal : uint32_t {
 
 class StatisticsImpl : public Statistics {
  public:
-  StatisticsImpl(std::shared_ptr<Statistics> stats);
+  explicit StatisticsImpl(
+      std::shared_ptr<Statistics> stats,
+      const StatisticsOptions& options = StatisticsOptions());
   virtual ~StatisticsImpl();
   const char* Name() const override { return kClassName(); }
   static const char* kClassName() { return "BasicStatistics"; }
@@ -50,6 +53,8 @@ class StatisticsImpl : public Statistics {
   void histogramData(uint32_t histogram_type,
                      HistogramData* const data) const override;
   std::string getHistogramString(uint32_t histogram_type) const override;
+  Status getHistogramSnapshot(uint32_t histogram_type,
+                              std::string* snapshot) const override;
 
   void setTickerCount(uint32_t ticker_type, uint64_t count) override;
   uint64_t getAndResetTickerCount(uint32_t ticker_type) override;
@@ -105,13 +110,76 @@ class StatisticsImpl : public Statistics {
 
   CoreLocalArray<StatisticsData> per_core_stats_;
 
+  // With StatisticsOptions::hdr_histogram_significant_digits, the histograms
+  // are recorded here instead of in StatisticsData::histograms_
+  struct ALIGN_AS(CACHE_LINE_SIZE) HdrHistogramData {
+    HdrHistogramImpl histograms_[INTERNAL_HISTOGRAM_ENUM_MAX];
+    void* operator new(size_t s) { return port::cacheline_aligned_alloc(s); }
+    void* operator new[](size_t s) { return port::cacheline_aligned_alloc(s); }
+    void operator delete(void* p) { port::cacheline_aligned_free(p); }
+    void operator delete[](void* p) { port::cacheline_aligned_free(p); }
+  };
+
+  std::unique_ptr<CoreLocalArray<HdrHistogramData>> per_core_hdr_histograms_;
+
   uint64_t getTickerCountLocked(uint32_t ticker_type) const;
-  std::unique_ptr<HistogramImpl> getHistogramImplLocked(
+  std::unique_ptr<Histogram> getHistogramImplLocked(
       uint32_t histogram_type) const;
   void setTickerCountLocked(uint32_t ticker_type, uint64_t count);
 };
 
 // Utility functions
+// The statistics of a column family, see
+// ColumnFamilyOptions::column_family_statistics. Updates are recorded in both
+// those and the statistics of the DB, if any, while reads are from the
+// former.
+class ColumnFamilyStatistics : public Statistics {
+ public:
+  ColumnFamilyStatistics(std::shared_ptr<Statistics> cf_stats,
+                         std::shared_ptr<Statistics> db_stats);
+  const char* Name() const override { return kClassName(); }
+  static const char* kClassName() { return "ColumnFamilyStatistics"; }
+
+  uint64_t getTickerCount(uint32_t ticker_type) const override {
+    return cf_stats_->getTickerCount(ticker_type);
+  }
+  void histogramData(uint32_t histogram_type,
+                     HistogramData* const data) const override {
+    cf_stats_->histogramData(histogram_type, data);
+  }
+  std::string getHistogramString(uint32_t histogram_type) const override {
+    return cf_stats_->getHistogramString(histogram_type);
+  }
+  Status getHistogramSnapshot(uint32_t histogram_type,
+                              std::string* snapshot) const override {
+    return cf_stats_->getHistogramSnapshot(histogram_type, snapshot);
+  }
+
+  void setTickerCount(uint32_t ticker_type, uint64_t count) override;
+  uint64_t getAndResetTickerCount(uint32_t ticker_type) override {
+    return cf_stats_->getAndResetTickerCount(ticker_type);
+  }
+  void recordTick(uint32_t ticker_type, uint64_t count) override;
+  void measureTime(uint32_t histogram_type, uint64_t time) override {
+    recordInHistogram(histogram_type, time);
+  }
+  void recordInHistogram(uint32_t histogram_type, uint64_t value) override;
+
+  Status Reset() override { return cf_stats_->Reset(); }
+  std::string ToString() const override { return cf_stats_->ToString(); }
+  bool getTickerMap(std::map<std::string, uint64_t>* stats_map) const override {
+    return cf_stats_->getTickerMap(stats_map);
+  }
+  bool HistEnabledForType(uint32_t type) const override;
+
+  const Customizable* Inner() const override { return cf_stats_.get(); }
+
+ private:
+  std::shared_ptr<Statistics> cf_stats_;
+  // Can be nullptr
+  std::shared_ptr<Statistics> db_stats_;
+};
+
 inline void RecordInHistogram(Statistics* statistics, uint32_t histogram_type,
                               uint64_t value) {
   if (statistics) {
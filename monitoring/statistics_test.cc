@@ -6,6 +6,8 @@
 
 #include "rocksdb/statistics.h"
 
+#include <cmath>
+
 #include "port/stack_trace.h"
 #include "rocksdb/convenience.h"
 #include "rocksdb/utilities/options_type.h"
@@ -40,6 +42,38 @@ TEST_F(StatisticsTest, SanityHistograms) {
   }
 }
 
+TEST_F(StatisticsTest, HdrHistograms) {
+  std::shared_ptr<Statistics> basic = CreateDBStatistics();
+  std::string snapshot;
+  ASSERT_TRUE(basic->getHistogramSnapshot(DB_GET, &snapshot).IsNotSupported());
+
+  StatisticsOptions options;
+  options.hdr_histogram_significant_digits = 3;
+  std::shared_ptr<Statistics> stats = CreateDBStatistics(options);
+  std::shared_ptr<Statistics> other = CreateDBStatistics(options);
+  for (uint64_t i = 1; i <= 10000; i++) {
+    stats->recordInHistogram(DB_GET, i);
+    other->recordInHistogram(DB_GET, 10000 + i);
+  }
+  HistogramData data;
+  stats->histogramData(DB_GET, &data);
+  ASSERT_EQ(data.count, 10000U);
+  ASSERT_LE(std::abs(data.percentile999 - 9990.0), 10.0);
+
+  ASSERT_OK(stats->getHistogramSnapshot(DB_GET, &snapshot));
+  std::string other_snapshot;
+  ASSERT_OK(other->getHistogramSnapshot(DB_GET, &other_snapshot));
+  ASSERT_OK(MergeHistogramSnapshots(other_snapshot, &snapshot));
+  ASSERT_OK(GetHistogramSnapshotData(snapshot, &data));
+  ASSERT_EQ(data.count, 20000U);
+  ASSERT_EQ(data.max, 20000.0);
+  ASSERT_LE(std::abs(data.median - 10000.0), 10.0);
+
+  ASSERT_OK(stats->Reset());
+  stats->histogramData(DB_GET, &data);
+  ASSERT_EQ(data.count, 0U);
+}
+
 TEST_F(StatisticsTest, NoNameStats) {
   static std::unordered_map<std::string, OptionTypeInfo> no_name_opt_info = {
       {"inner",
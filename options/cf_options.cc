@@ -11,6 +11,7 @@
 #include <string>
 
 #include "logging/logging.h"
+#include "monitoring/statistics_impl.h"
 #include "options/configurable_helper.h"
 #include "options/db_options.h"
 #include "options/options_helper.h"
@@ -176,6 +177,14 @@ static std::unordered_map<std::string, OptionTypeInfo>
         {"checksum",
          {offsetof(struct CompressionOptions, checksum), OptionType::kBoolean,
           OptionVerificationType::kNormal, OptionTypeFlags::kMutable}},
+        {"adaptive_cpu_cost_per_kb",
+         {offsetof(struct CompressionOptions, adaptive_cpu_cost_per_kb),
+          OptionType::kUInt32T, OptionVerificationType::kNormal,
+          OptionTypeFlags::kMutable}},
+        {"train_dict_in_background",
+         {offsetof(struct CompressionOptions, train_dict_in_background),
+          OptionType::kBoolean, OptionVerificationType::kNormal,
+          OptionTypeFlags::kMutable}},
 };
 
 static std::unordered_map<std::string, OptionTypeInfo>
@@ -247,6 +256,10 @@ static std::unordered_map<std::string, OptionTypeInfo>
          {offsetof(class CompactionOptionsUniversal, incremental),
           OptionType::kBoolean, OptionVerificationType::kNormal,
           OptionTypeFlags::kMutable}},
+        {"incremental_round_robin",
+         {offsetof(class CompactionOptionsUniversal, incremental_round_robin),
+          OptionType::kBoolean, OptionVerificationType::kNormal,
+          OptionTypeFlags::kMutable}},
         {"allow_trivial_move",
          {offsetof(class CompactionOptionsUniversal, allow_trivial_move),
           OptionType::kBoolean, OptionVerificationType::kNormal,
@@ -486,6 +499,10 @@ static std::unordered_map<std::string, OptionTypeInfo>
          {offsetof(struct MutableCFOptions, blob_compaction_readahead_size),
           OptionType::kUInt64T, OptionVerificationType::kNormal,
           OptionTypeFlags::kMutable}},
+        {"blob_compaction_read_batch_size",
+         {offsetof(struct MutableCFOptions, blob_compaction_read_batch_size),
+          OptionType::kUInt32T, OptionVerificationType::kNormal,
+          OptionTypeFlags::kMutable}},
         {"blob_file_starting_level",
          {offsetof(struct MutableCFOptions, blob_file_starting_level),
           OptionType::kInt, OptionVerificationType::kNormal,
@@ -571,11 +588,23 @@ static std::unordered_map<std::string, OptionTypeInfo>
          {offsetof(struct MutableCFOptions, disable_write_stall),
           OptionType::kBoolean, OptionVerificationType::kNormal,
           OptionTypeFlags::kMutable}},
+        {"smooth_write_stall",
+         {offsetof(struct MutableCFOptions, smooth_write_stall),
+          OptionType::kBoolean, OptionVerificationType::kNormal,
+          OptionTypeFlags::kMutable}},
         // End special case properties
         {"memtable_max_range_deletions",
          {offsetof(struct MutableCFOptions, memtable_max_range_deletions),
           OptionType::kUInt32T, OptionVerificationType::kNormal,
           OptionTypeFlags::kMutable}},
+        {"range_deletion_compaction_ratio",
+         {offsetof(struct MutableCFOptions, range_deletion_compaction_ratio),
+          OptionType::kDouble, OptionVerificationType::kNormal,
+          OptionTypeFlags::kMutable}},
+        {"trivial_move_batch_size",
+         {offsetof(struct MutableCFOptions, trivial_move_batch_size),
+          OptionType::kUInt32T, OptionVerificationType::kNormal,
+          OptionTypeFlags::kMutable}},
 
 };
 
@@ -822,6 +851,10 @@ static std::unordered_map<std::string, OptionTypeInfo>
             auto* cache = static_cast<std::shared_ptr<Cache>*>(addr);
             return Cache::CreateFromString(opts, value, cache);
           }}},
+        {"blob_multiget_threads",
+         {offsetof(struct ImmutableCFOptions, blob_multiget_threads),
+          OptionType::kInt, OptionVerificationType::kNormal,
+          OptionTypeFlags::kNone}},
         {"persist_user_defined_timestamps",
          {offsetof(struct ImmutableCFOptions, persist_user_defined_timestamps),
           OptionType::kBoolean, OptionVerificationType::kNormal,
@@ -968,7 +1001,10 @@ ImmutableCFOptions::ImmutableCFOptions(const ColumnFamilyOptions& cf_options)
       cf_paths(cf_options.cf_paths),
       compaction_thread_limiter(cf_options.compaction_thread_limiter),
       sst_partitioner_factory(cf_options.sst_partitioner_factory),
+      compaction_cost_model(cf_options.compaction_cost_model),
+      column_family_statistics(cf_options.column_family_statistics),
       blob_cache(cf_options.blob_cache),
+      blob_multiget_threads(cf_options.blob_multiget_threads),
       persist_user_defined_timestamps(
           cf_options.persist_user_defined_timestamps) {}
 
@@ -979,19 +1015,36 @@ ImmutableOptions::ImmutableOptions(const Options& options)
 
 ImmutableOptions::ImmutableOptions(const DBOptions& db_options,
                                    const ColumnFamilyOptions& cf_options)
-    : ImmutableDBOptions(db_options), ImmutableCFOptions(cf_options) {}
+    : ImmutableDBOptions(db_options), ImmutableCFOptions(cf_options) {
+  SetColumnFamilyStats();
+}
 
 ImmutableOptions::ImmutableOptions(const DBOptions& db_options,
                                    const ImmutableCFOptions& cf_options)
-    : ImmutableDBOptions(db_options), ImmutableCFOptions(cf_options) {}
+    : ImmutableDBOptions(db_options), ImmutableCFOptions(cf_options) {
+  SetColumnFamilyStats();
+}
 
 ImmutableOptions::ImmutableOptions(const ImmutableDBOptions& db_options,
                                    const ColumnFamilyOptions& cf_options)
-    : ImmutableDBOptions(db_options), ImmutableCFOptions(cf_options) {}
+    : ImmutableDBOptions(db_options), ImmutableCFOptions(cf_options) {
+  SetColumnFamilyStats();
+}
 
 ImmutableOptions::ImmutableOptions(const ImmutableDBOptions& db_options,
                                    const ImmutableCFOptions& cf_options)
-    : ImmutableDBOptions(db_options), ImmutableCFOptions(cf_options) {}
+    : ImmutableDBOptions(db_options), ImmutableCFOptions(cf_options) {
+  SetColumnFamilyStats();
+}
+
+void ImmutableOptions::SetColumnFamilyStats() {
+  if (column_family_statistics != nullptr &&
+      column_family_statistics != statistics) {
+    column_family_stats_ = std::make_shared<ColumnFamilyStatistics>(
+        column_family_statistics, statistics);
+    stats = column_family_stats_.get();
+  }
+}
 
 // Multiple two operands. If they overflow, return op1.
 uint64_t MultiplyCheckOverflow(uint64_t op1, double op2) {
@@ -1152,6 +1205,10 @@ void MutableCFOptions::Dump(Logger* log) const {
       static_cast<int>(compaction_options_universal.allow_trivial_move));
   ROCKS_LOG_INFO(log, "compaction_options_universal.incremental        : %d",
                  static_cast<int>(compaction_options_universal.incremental));
+  ROCKS_LOG_INFO(log,
+                 "compaction_options_universal.incremental_round_robin : %d",
+                 static_cast<int>(
+                     compaction_options_universal.incremental_round_robin));
 
   // FIFO Compaction Options
   ROCKS_LOG_INFO(log, "compaction_options_fifo.max_table_files_size : %" PRIu64,
@@ -1176,8 +1233,16 @@ void MutableCFOptions::Dump(Logger* log) const {
                  blob_garbage_collection_force_threshold);
   ROCKS_LOG_INFO(log, "           blob_compaction_readahead_size: %" PRIu64,
                  blob_compaction_readahead_size);
+  ROCKS_LOG_INFO(log, "          blob_compaction_read_batch_size: %" PRIu32,
+                 blob_compaction_read_batch_size);
   ROCKS_LOG_INFO(log, "                       disable_auto_flush: %d",
                  static_cast<int>(disable_auto_flush));
+  ROCKS_LOG_INFO(log, "                       smooth_write_stall: %d",
+                 static_cast<int>(smooth_write_stall));
+  ROCKS_LOG_INFO(log, "          range_deletion_compaction_ratio: %f",
+                 range_deletion_compaction_ratio);
+  ROCKS_LOG_INFO(log, "                  trivial_move_batch_size: %" PRIu32,
+                 trivial_move_batch_size);
   ROCKS_LOG_INFO(log, "                 blob_file_starting_level: %d",
                  blob_file_starting_level);
   ROCKS_LOG_INFO(log, "                   prepopulate_blob_cache: %s",
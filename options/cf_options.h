@@ -85,8 +85,14 @@ struct ImmutableCFOptions {
 
   std::shared_ptr<SstPartitionerFactory> sst_partitioner_factory;
 
+  std::shared_ptr<CompactionCostModel> compaction_cost_model;
+
+  std::shared_ptr<Statistics> column_family_statistics;
+
   std::shared_ptr<Cache> blob_cache;
 
+  int blob_multiget_threads;
+
   bool persist_user_defined_timestamps;
 };
 
@@ -105,6 +111,13 @@ struct ImmutableOptions : public ImmutableDBOptions, public ImmutableCFOptions {
 
   ImmutableOptions(const ImmutableDBOptions& db_options,
                    const ColumnFamilyOptions& cf_options);
+
+ private:
+  // With column_family_statistics, points stats to a Statistics which
+  // records into both it and statistics.
+  void SetColumnFamilyStats();
+
+  std::shared_ptr<Statistics> column_family_stats_;
 };
 
 struct MutableCFOptions {
@@ -153,6 +166,8 @@ struct MutableCFOptions {
         blob_garbage_collection_force_threshold(
             options.blob_garbage_collection_force_threshold),
         blob_compaction_readahead_size(options.blob_compaction_readahead_size),
+        blob_compaction_read_batch_size(
+            options.blob_compaction_read_batch_size),
         blob_file_starting_level(options.blob_file_starting_level),
         prepopulate_blob_cache(options.prepopulate_blob_cache),
         max_sequential_skip_in_iterations(
@@ -172,10 +187,14 @@ struct MutableCFOptions {
             options.sample_for_compression),  // TODO: is 0 fine here?
         compression_per_level(options.compression_per_level),
         memtable_max_range_deletions(options.memtable_max_range_deletions),
+        range_deletion_compaction_ratio(
+            options.range_deletion_compaction_ratio),
+        trivial_move_batch_size(options.trivial_move_batch_size),
         bottommost_file_compaction_delay(
             options.bottommost_file_compaction_delay),
         disable_auto_flush(options.disable_auto_flush),
-        disable_write_stall(options.disable_write_stall) {
+        disable_write_stall(options.disable_write_stall),
+        smooth_write_stall(options.smooth_write_stall) {
     RefreshDerivedOptions(options.num_levels, options.compaction_style);
   }
 
@@ -213,6 +232,7 @@ struct MutableCFOptions {
         blob_garbage_collection_age_cutoff(0.0),
         blob_garbage_collection_force_threshold(0.0),
         blob_compaction_readahead_size(0),
+        blob_compaction_read_batch_size(0),
         blob_file_starting_level(0),
         prepopulate_blob_cache(PrepopulateBlobCache::kDisable),
         max_sequential_skip_in_iterations(0),
@@ -226,8 +246,11 @@ struct MutableCFOptions {
         block_protection_bytes_per_key(0),
         sample_for_compression(0),
         memtable_max_range_deletions(0),
+        range_deletion_compaction_ratio(0),
+        trivial_move_batch_size(0),
         disable_auto_flush(false),
-        disable_write_stall(false) {}
+        disable_write_stall(false),
+        smooth_write_stall(false) {}
 
   explicit MutableCFOptions(const Options& options);
 
@@ -303,6 +326,7 @@ struct MutableCFOptions {
   double blob_garbage_collection_age_cutoff;
   double blob_garbage_collection_force_threshold;
   uint64_t blob_compaction_readahead_size;
+  uint32_t blob_compaction_read_batch_size;
   int blob_file_starting_level;
   PrepopulateBlobCache prepopulate_blob_cache;
 
@@ -322,6 +346,8 @@ struct MutableCFOptions {
   uint64_t sample_for_compression;
   std::vector<CompressionType> compression_per_level;
   uint32_t memtable_max_range_deletions;
+  double range_deletion_compaction_ratio;
+  uint32_t trivial_move_batch_size;
   uint32_t bottommost_file_compaction_delay;
 
   // Derived options
@@ -330,6 +356,7 @@ struct MutableCFOptions {
 
   bool disable_auto_flush;
   bool disable_write_stall;
+  bool smooth_write_stall;
 };
 
 uint64_t MultiplyCheckOverflow(uint64_t op1, double op2);
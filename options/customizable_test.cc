@@ -1866,6 +1866,8 @@ TEST_F(LoadCustomizableTest, LoadMemTableRepFactoryTest) {
   std::unordered_set<std::string> expected = {
       SkipListFactory::kClassName(),
       SkipListFactory::kNickName(),
+      ARTRepFactory::kClassName(),
+      ARTRepFactory::kNickName(),
   };
 
   std::vector<std::string> failures;
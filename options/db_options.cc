@@ -13,6 +13,7 @@
 #include "options/options_parser.h"
 #include "port/port.h"
 #include "rocksdb/advanced_cache.h"
+#include "rocksdb/compression_accelerator.h"
 #include "rocksdb/configurable.h"
 #include "rocksdb/env.h"
 #include "rocksdb/file_system.h"
@@ -134,6 +135,11 @@ static std::unordered_map<std::string, OptionTypeInfo>
         /*
          // not yet supported
           std::shared_ptr<Cache> row_cache;
+          std::shared_ptr<Cache> merge_result_cache;
+          std::shared_ptr<OpTraceSink> op_trace_sink;
+          std::shared_ptr<Cache> iterator_memory_cache;
+          std::shared_ptr<AutoTuner> auto_tuner;
+          std::shared_ptr<CompressionAccelerator> compression_accelerator;
           std::shared_ptr<DeleteScheduler> delete_scheduler;
           std::shared_ptr<Logger> info_log;
           std::shared_ptr<RateLimiter> rate_limiter;
@@ -153,6 +159,10 @@ static std::unordered_map<std::string, OptionTypeInfo>
          {offsetof(struct ImmutableDBOptions, allow_fallocate),
           OptionType::kBoolean, OptionVerificationType::kNormal,
           OptionTypeFlags::kNone}},
+        {"use_io_uring_for_writes",
+         {offsetof(struct ImmutableDBOptions, use_io_uring_for_writes),
+          OptionType::kBoolean, OptionVerificationType::kNormal,
+          OptionTypeFlags::kNone}},
         {"allow_mmap_writes",
          {offsetof(struct ImmutableDBOptions, allow_mmap_writes),
           OptionType::kBoolean, OptionVerificationType::kNormal,
@@ -271,6 +281,10 @@ static std::unordered_map<std::string, OptionTypeInfo>
          {offsetof(struct ImmutableDBOptions, db_write_buffer_size),
           OptionType::kSizeT, OptionVerificationType::kNormal,
           OptionTypeFlags::kNone}},
+        {"write_buffer_manager_weight",
+         {offsetof(struct ImmutableDBOptions, write_buffer_manager_weight),
+          OptionType::kUInt32T, OptionVerificationType::kNormal,
+          OptionTypeFlags::kNone}},
         {"keep_log_file_num",
          {offsetof(struct ImmutableDBOptions, keep_log_file_num),
           OptionType::kSizeT, OptionVerificationType::kNormal,
@@ -350,6 +364,10 @@ static std::unordered_map<std::string, OptionTypeInfo>
          {offsetof(struct ImmutableDBOptions, max_write_batch_group_size_bytes),
           OptionType::kUInt64T, OptionVerificationType::kNormal,
           OptionTypeFlags::kNone}},
+        {"op_trace_sample_one_in",
+         {offsetof(struct ImmutableDBOptions, op_trace_sample_one_in),
+          OptionType::kUInt32T, OptionVerificationType::kNormal,
+          OptionTypeFlags::kNone}},
         {"write_thread_max_yield_usec",
          {offsetof(struct ImmutableDBOptions, write_thread_max_yield_usec),
           OptionType::kUInt64T, OptionVerificationType::kNormal,
@@ -369,6 +387,26 @@ static std::unordered_map<std::string, OptionTypeInfo>
          {offsetof(struct ImmutableDBOptions, avoid_flush_during_recovery),
           OptionType::kBoolean, OptionVerificationType::kNormal,
           OptionTypeFlags::kNone}},
+        {"wal_recovery_threads",
+         {offsetof(struct ImmutableDBOptions, wal_recovery_threads),
+          OptionType::kInt, OptionVerificationType::kNormal,
+          OptionTypeFlags::kNone}},
+        {"async_read_threads",
+         {offsetof(struct ImmutableDBOptions, async_read_threads),
+          OptionType::kInt, OptionVerificationType::kNormal,
+          OptionTypeFlags::kNone}},
+        {"max_flush_subjobs",
+         {offsetof(struct ImmutableDBOptions, max_flush_subjobs),
+          OptionType::kInt, OptionVerificationType::kNormal,
+          OptionTypeFlags::kNone}},
+        {"snapshot_memtables_on_shutdown",
+         {offsetof(struct ImmutableDBOptions, snapshot_memtables_on_shutdown),
+          OptionType::kBoolean, OptionVerificationType::kNormal,
+          OptionTypeFlags::kNone}},
+        {"summarize_tables_on_shutdown",
+         {offsetof(struct ImmutableDBOptions, summarize_tables_on_shutdown),
+          OptionType::kBoolean, OptionVerificationType::kNormal,
+          OptionTypeFlags::kNone}},
         {"allow_ingest_behind",
          {offsetof(struct ImmutableDBOptions, allow_ingest_behind),
           OptionType::kBoolean, OptionVerificationType::kNormal,
@@ -571,6 +609,10 @@ static std::unordered_map<std::string, OptionTypeInfo>
                    disable_delete_obsolete_files_on_open),
           OptionType::kBoolean, OptionVerificationType::kNormal,
           OptionTypeFlags::kNone}},
+        {"use_loser_tree_in_compaction",
+         {offsetof(struct ImmutableDBOptions, use_loser_tree_in_compaction),
+          OptionType::kBoolean, OptionVerificationType::kNormal,
+          OptionTypeFlags::kNone}},
 };
 
 const std::string OptionsHelper::kDBOptionsName = "DBOptions";
@@ -727,10 +769,12 @@ ImmutableDBOptions::ImmutableDBOptions(const DBOptions& options)
       use_direct_io_for_flush_and_compaction(
           options.use_direct_io_for_flush_and_compaction),
       allow_fallocate(options.allow_fallocate),
+      use_io_uring_for_writes(options.use_io_uring_for_writes),
       is_fd_close_on_exec(options.is_fd_close_on_exec),
       advise_random_on_open(options.advise_random_on_open),
       db_write_buffer_size(options.db_write_buffer_size),
       write_buffer_manager(options.write_buffer_manager),
+      write_buffer_manager_weight(options.write_buffer_manager_weight),
       random_access_max_buffer_size(options.random_access_max_buffer_size),
       use_adaptive_mutex(options.use_adaptive_mutex),
       listeners(options.listeners),
@@ -748,11 +792,22 @@ ImmutableDBOptions::ImmutableDBOptions(const DBOptions& options)
       wal_recovery_mode(options.wal_recovery_mode),
       allow_2pc(options.allow_2pc),
       row_cache(options.row_cache),
+      merge_result_cache(options.merge_result_cache),
+      op_trace_sink(options.op_trace_sink),
+      op_trace_sample_one_in(options.op_trace_sample_one_in),
+      iterator_memory_cache(options.iterator_memory_cache),
+      auto_tuner(options.auto_tuner),
+      compression_accelerator(options.compression_accelerator),
       wal_filter(options.wal_filter),
       fail_if_options_file_error(options.fail_if_options_file_error),
       use_options_file(options.use_options_file),
       dump_malloc_stats(options.dump_malloc_stats),
       avoid_flush_during_recovery(options.avoid_flush_during_recovery),
+      wal_recovery_threads(options.wal_recovery_threads),
+      async_read_threads(options.async_read_threads),
+      max_flush_subjobs(options.max_flush_subjobs),
+      snapshot_memtables_on_shutdown(options.snapshot_memtables_on_shutdown),
+      summarize_tables_on_shutdown(options.summarize_tables_on_shutdown),
       allow_ingest_behind(options.allow_ingest_behind),
       two_write_queues(options.two_write_queues),
       manual_wal_flush(options.manual_wal_flush),
@@ -774,6 +829,7 @@ ImmutableDBOptions::ImmutableDBOptions(const DBOptions& options)
       compaction_service(options.compaction_service),
       enforce_single_del_contracts(options.enforce_single_del_contracts),
       disable_delete_obsolete_files_on_open(options.disable_delete_obsolete_files_on_open),
+      use_loser_tree_in_compaction(options.use_loser_tree_in_compaction),
       max_num_replication_epochs(options.max_num_replication_epochs) {
   fs = env->GetFileSystem();
   clock = env->GetSystemClock().get();
@@ -832,6 +888,8 @@ void ImmutableDBOptions::Dump(Logger* log) const {
       recycle_log_file_num);
   ROCKS_LOG_HEADER(log, "                        Options.allow_fallocate: %d",
                    allow_fallocate);
+  ROCKS_LOG_HEADER(log, "                Options.use_io_uring_for_writes: %d",
+                   use_io_uring_for_writes);
   ROCKS_LOG_HEADER(log, "                       Options.allow_mmap_reads: %d",
                    allow_mmap_reads);
   ROCKS_LOG_HEADER(log, "                      Options.allow_mmap_writes: %d",
@@ -872,6 +930,8 @@ void ImmutableDBOptions::Dump(Logger* log) const {
       db_write_buffer_size);
   ROCKS_LOG_HEADER(log, "                   Options.write_buffer_manager: %p",
                    write_buffer_manager.get());
+  ROCKS_LOG_HEADER(log, "            Options.write_buffer_manager_weight: %u",
+                   write_buffer_manager_weight);
   ROCKS_LOG_HEADER(
       log, "          Options.random_access_max_buffer_size: %" ROCKSDB_PRIszt,
       random_access_max_buffer_size);
@@ -909,11 +969,48 @@ void ImmutableDBOptions::Dump(Logger* log) const {
     ROCKS_LOG_HEADER(log,
                      "                              Options.row_cache: None");
   }
+  if (merge_result_cache) {
+    ROCKS_LOG_HEADER(
+        log,
+        "                     Options.merge_result_cache: %" ROCKSDB_PRIszt,
+        merge_result_cache->GetCapacity());
+  } else {
+    ROCKS_LOG_HEADER(log,
+                     "                     Options.merge_result_cache: None");
+  }
+  ROCKS_LOG_HEADER(log, "                          Options.op_trace_sink: %p",
+                   op_trace_sink.get());
+  ROCKS_LOG_HEADER(log, "                 Options.op_trace_sample_one_in: %u",
+                   op_trace_sample_one_in);
+  if (iterator_memory_cache) {
+    ROCKS_LOG_HEADER(
+        log,
+        "                  Options.iterator_memory_cache: %" ROCKSDB_PRIszt,
+        iterator_memory_cache->GetCapacity());
+  } else {
+    ROCKS_LOG_HEADER(log,
+                     "                  Options.iterator_memory_cache: None");
+  }
+  ROCKS_LOG_HEADER(log, "                             Options.auto_tuner: %p",
+                   auto_tuner.get());
+  ROCKS_LOG_HEADER(log, "                Options.compression_accelerator: %s",
+                   compression_accelerator ? compression_accelerator->Name()
+                                           : "None");
   ROCKS_LOG_HEADER(log, "                             Options.wal_filter: %s",
                    wal_filter ? wal_filter->Name() : "None");
 
   ROCKS_LOG_HEADER(log, "            Options.avoid_flush_during_recovery: %d",
                    avoid_flush_during_recovery);
+  ROCKS_LOG_HEADER(log, "                   Options.wal_recovery_threads: %d",
+                   wal_recovery_threads);
+  ROCKS_LOG_HEADER(log, "                     Options.async_read_threads: %d",
+                   async_read_threads);
+  ROCKS_LOG_HEADER(log, "                      Options.max_flush_subjobs: %d",
+                   max_flush_subjobs);
+  ROCKS_LOG_HEADER(log, "         Options.snapshot_memtables_on_shutdown: %d",
+                   snapshot_memtables_on_shutdown);
+  ROCKS_LOG_HEADER(log, "           Options.summarize_tables_on_shutdown: %d",
+                   summarize_tables_on_shutdown);
   ROCKS_LOG_HEADER(log, "            Options.allow_ingest_behind: %d",
                    allow_ingest_behind);
   ROCKS_LOG_HEADER(log, "            Options.two_write_queues: %d",
@@ -953,6 +1050,8 @@ void ImmutableDBOptions::Dump(Logger* log) const {
                    enforce_single_del_contracts ? "true" : "false");
   ROCKS_LOG_HEADER(log, "   Options.disable_delete_obsolete_files_on_open: %s",
                    disable_delete_obsolete_files_on_open ? "true" : "false");
+  ROCKS_LOG_HEADER(log, "            Options.use_loser_tree_in_compaction: %s",
+                   use_loser_tree_in_compaction ? "true" : "false");
   ROCKS_LOG_HEADER(log, "              Options.max_num_replication_epochs: %d",
                    max_num_replication_epochs);
 }
@@ -59,10 +59,12 @@ struct ImmutableDBOptions {
   bool use_direct_reads;
   bool use_direct_io_for_flush_and_compaction;
   bool allow_fallocate;
+  bool use_io_uring_for_writes;
   bool is_fd_close_on_exec;
   bool advise_random_on_open;
   size_t db_write_buffer_size;
   std::shared_ptr<WriteBufferManager> write_buffer_manager;
+  uint32_t write_buffer_manager_weight;
   size_t random_access_max_buffer_size;
   bool use_adaptive_mutex;
   std::vector<std::shared_ptr<EventListener>> listeners;
@@ -78,11 +80,22 @@ struct ImmutableDBOptions {
   WALRecoveryMode wal_recovery_mode;
   bool allow_2pc;
   std::shared_ptr<Cache> row_cache;
+  std::shared_ptr<Cache> merge_result_cache;
+  std::shared_ptr<OpTraceSink> op_trace_sink;
+  uint32_t op_trace_sample_one_in;
+  std::shared_ptr<Cache> iterator_memory_cache;
+  std::shared_ptr<AutoTuner> auto_tuner;
+  std::shared_ptr<CompressionAccelerator> compression_accelerator;
   WalFilter* wal_filter;
   bool fail_if_options_file_error;
   bool use_options_file;
   bool dump_malloc_stats;
   bool avoid_flush_during_recovery;
+  int wal_recovery_threads;
+  int async_read_threads;
+  int max_flush_subjobs;
+  bool snapshot_memtables_on_shutdown;
+  bool summarize_tables_on_shutdown;
   bool allow_ingest_behind;
   bool two_write_queues;
   bool manual_wal_flush;
@@ -109,6 +122,7 @@ struct ImmutableDBOptions {
   std::shared_ptr<CompactionService> compaction_service;
   bool enforce_single_del_contracts;
   bool disable_delete_obsolete_files_on_open;
+  bool use_loser_tree_in_compaction;
   uint32_t max_num_replication_epochs;
 
   bool IsWalDirSameAsDBPath() const;
@@ -17,6 +17,7 @@
 #include "options/db_options.h"
 #include "options/options_helper.h"
 #include "rocksdb/cache.h"
+#include "rocksdb/compaction_cost_model.h"
 #include "rocksdb/compaction_filter.h"
 #include "rocksdb/comparator.h"
 #include "rocksdb/env.h"
@@ -109,9 +110,11 @@ AdvancedColumnFamilyOptions::AdvancedColumnFamilyOptions(const Options& options)
       blob_garbage_collection_force_threshold(
           options.blob_garbage_collection_force_threshold),
       blob_compaction_readahead_size(options.blob_compaction_readahead_size),
+      blob_compaction_read_batch_size(options.blob_compaction_read_batch_size),
       blob_file_starting_level(options.blob_file_starting_level),
       blob_cache(options.blob_cache),
       prepopulate_blob_cache(options.prepopulate_blob_cache),
+      blob_multiget_threads(options.blob_multiget_threads),
       persist_user_defined_timestamps(options.persist_user_defined_timestamps) {
   assert(memtable_factory.get() != nullptr);
   if (max_bytes_for_level_multiplier_additional.size() <
@@ -155,6 +158,11 @@ void ColumnFamilyOptions::Dump(Logger* log) const {
   ROCKS_LOG_HEADER(
       log, " Options.sst_partitioner_factory: %s",
       sst_partitioner_factory ? sst_partitioner_factory->Name() : "None");
+  ROCKS_LOG_HEADER(
+      log, "   Options.compaction_cost_model: %s",
+      compaction_cost_model ? compaction_cost_model->Name() : "None");
+  ROCKS_LOG_HEADER(log, "  Options.column_family_statistics: %p",
+                   column_family_statistics.get());
   ROCKS_LOG_HEADER(log, "        Options.memtable_factory: %s",
                    memtable_factory->Name());
   ROCKS_LOG_HEADER(log, "           Options.table_factory: %s",
@@ -260,6 +268,9 @@ void ColumnFamilyOptions::Dump(Logger* log) const {
                      "        Options.compression_opts.max_dict_buffer_bytes: "
                      "%" PRIu64,
                      compression_opts.max_dict_buffer_bytes);
+    ROCKS_LOG_HEADER(
+        log, "     Options.compression_opts.train_dict_in_background: %s",
+        compression_opts.train_dict_in_background ? "true" : "false");
     ROCKS_LOG_HEADER(log, "     Options.level0_file_num_compaction_trigger: %d",
                      level0_file_num_compaction_trigger);
     ROCKS_LOG_HEADER(log, "         Options.level0_slowdown_writes_trigger: %d",
@@ -449,12 +460,18 @@ void ColumnFamilyOptions::Dump(Logger* log) const {
     ROCKS_LOG_HEADER(
         log, "         Options.blob_compaction_readahead_size: %" PRIu64,
         blob_compaction_readahead_size);
+    ROCKS_LOG_HEADER(log, "        Options.blob_compaction_read_batch_size: %u",
+                     blob_compaction_read_batch_size);
     ROCKS_LOG_HEADER(log, "                     Options.disable_auto_flush: %d",
                      disable_auto_flush);
     ROCKS_LOG_HEADER(log, "                    Options.disable_write_stall: %d",
                      disable_write_stall);
+    ROCKS_LOG_HEADER(log, "                     Options.smooth_write_stall: %d",
+                     smooth_write_stall);
     ROCKS_LOG_HEADER(log, "               Options.blob_file_starting_level: %d",
                      blob_file_starting_level);
+    ROCKS_LOG_HEADER(log, "                  Options.blob_multiget_threads: %d",
+                     blob_multiget_threads);
     if (blob_cache) {
       ROCKS_LOG_HEADER(log, "                          Options.blob_cache: %s",
                        blob_cache->Name());
@@ -470,6 +487,10 @@ void ColumnFamilyOptions::Dump(Logger* log) const {
                      experimental_mempurge_threshold);
     ROCKS_LOG_HEADER(log, "           Options.memtable_max_range_deletions: %d",
                      memtable_max_range_deletions);
+    ROCKS_LOG_HEADER(log, "        Options.range_deletion_compaction_ratio: %f",
+                     range_deletion_compaction_ratio);
+    ROCKS_LOG_HEADER(log, "                Options.trivial_move_batch_size: %u",
+                     trivial_move_batch_size);
 }  // ColumnFamilyOptions::Dump
 
 void Options::Dump(Logger* log) const {
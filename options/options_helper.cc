@@ -110,6 +110,8 @@ DBOptions BuildDBOptions(const ImmutableDBOptions& immutable_db_options,
   options.use_direct_io_for_flush_and_compaction =
       immutable_db_options.use_direct_io_for_flush_and_compaction;
   options.allow_fallocate = immutable_db_options.allow_fallocate;
+  options.use_io_uring_for_writes =
+      immutable_db_options.use_io_uring_for_writes;
   options.is_fd_close_on_exec = immutable_db_options.is_fd_close_on_exec;
   options.stats_dump_period_sec = mutable_db_options.stats_dump_period_sec;
   options.stats_persist_period_sec =
@@ -120,6 +122,8 @@ DBOptions BuildDBOptions(const ImmutableDBOptions& immutable_db_options,
   options.advise_random_on_open = immutable_db_options.advise_random_on_open;
   options.db_write_buffer_size = immutable_db_options.db_write_buffer_size;
   options.write_buffer_manager = immutable_db_options.write_buffer_manager;
+  options.write_buffer_manager_weight =
+      immutable_db_options.write_buffer_manager_weight;
   options.compaction_readahead_size =
       mutable_db_options.compaction_readahead_size;
   options.random_access_max_buffer_size =
@@ -149,6 +153,13 @@ DBOptions BuildDBOptions(const ImmutableDBOptions& immutable_db_options,
   options.wal_recovery_mode = immutable_db_options.wal_recovery_mode;
   options.allow_2pc = immutable_db_options.allow_2pc;
   options.row_cache = immutable_db_options.row_cache;
+  options.merge_result_cache = immutable_db_options.merge_result_cache;
+  options.op_trace_sink = immutable_db_options.op_trace_sink;
+  options.op_trace_sample_one_in = immutable_db_options.op_trace_sample_one_in;
+  options.iterator_memory_cache = immutable_db_options.iterator_memory_cache;
+  options.auto_tuner = immutable_db_options.auto_tuner;
+  options.compression_accelerator =
+      immutable_db_options.compression_accelerator;
   options.wal_filter = immutable_db_options.wal_filter;
   options.fail_if_options_file_error =
       immutable_db_options.fail_if_options_file_error;
@@ -156,6 +167,13 @@ DBOptions BuildDBOptions(const ImmutableDBOptions& immutable_db_options,
   options.dump_malloc_stats = immutable_db_options.dump_malloc_stats;
   options.avoid_flush_during_recovery =
       immutable_db_options.avoid_flush_during_recovery;
+  options.wal_recovery_threads = immutable_db_options.wal_recovery_threads;
+  options.async_read_threads = immutable_db_options.async_read_threads;
+  options.max_flush_subjobs = immutable_db_options.max_flush_subjobs;
+  options.snapshot_memtables_on_shutdown =
+      immutable_db_options.snapshot_memtables_on_shutdown;
+  options.summarize_tables_on_shutdown =
+      immutable_db_options.summarize_tables_on_shutdown;
   options.avoid_flush_during_shutdown =
       mutable_db_options.avoid_flush_during_shutdown;
   options.allow_ingest_behind = immutable_db_options.allow_ingest_behind;
@@ -183,6 +201,8 @@ DBOptions BuildDBOptions(const ImmutableDBOptions& immutable_db_options,
       immutable_db_options.enforce_single_del_contracts;
   options.disable_delete_obsolete_files_on_open =
       immutable_db_options.disable_delete_obsolete_files_on_open;
+  options.use_loser_tree_in_compaction =
+      immutable_db_options.use_loser_tree_in_compaction;
   options.daily_offpeak_time_utc = mutable_db_options.daily_offpeak_time_utc;
   return options;
 }
@@ -213,6 +233,7 @@ void UpdateColumnFamilyOptions(const MutableCFOptions& moptions,
   cf_opts->prefix_extractor = moptions.prefix_extractor;
   cf_opts->disable_auto_flush = moptions.disable_auto_flush;
   cf_opts->disable_write_stall = moptions.disable_write_stall;
+  cf_opts->smooth_write_stall = moptions.smooth_write_stall;
   cf_opts->experimental_mempurge_threshold =
       moptions.experimental_mempurge_threshold;
   cf_opts->memtable_protection_bytes_per_key =
@@ -263,6 +284,8 @@ void UpdateColumnFamilyOptions(const MutableCFOptions& moptions,
       moptions.blob_garbage_collection_force_threshold;
   cf_opts->blob_compaction_readahead_size =
       moptions.blob_compaction_readahead_size;
+  cf_opts->blob_compaction_read_batch_size =
+      moptions.blob_compaction_read_batch_size;
   cf_opts->blob_file_starting_level = moptions.blob_file_starting_level;
   cf_opts->prepopulate_blob_cache = moptions.prepopulate_blob_cache;
 
@@ -280,6 +303,9 @@ void UpdateColumnFamilyOptions(const MutableCFOptions& moptions,
   cf_opts->last_level_temperature = moptions.last_level_temperature;
   cf_opts->default_write_temperature = moptions.default_write_temperature;
   cf_opts->memtable_max_range_deletions = moptions.memtable_max_range_deletions;
+  cf_opts->range_deletion_compaction_ratio =
+      moptions.range_deletion_compaction_ratio;
+  cf_opts->trivial_move_batch_size = moptions.trivial_move_batch_size;
 }
 
 void UpdateColumnFamilyOptions(const ImmutableCFOptions& ioptions,
@@ -313,7 +339,10 @@ void UpdateColumnFamilyOptions(const ImmutableCFOptions& ioptions,
   cf_opts->cf_paths = ioptions.cf_paths;
   cf_opts->compaction_thread_limiter = ioptions.compaction_thread_limiter;
   cf_opts->sst_partitioner_factory = ioptions.sst_partitioner_factory;
+  cf_opts->compaction_cost_model = ioptions.compaction_cost_model;
+  cf_opts->column_family_statistics = ioptions.column_family_statistics;
   cf_opts->blob_cache = ioptions.blob_cache;
+  cf_opts->blob_multiget_threads = ioptions.blob_multiget_threads;
   cf_opts->preclude_last_level_data_seconds =
       ioptions.preclude_last_level_data_seconds;
   cf_opts->preserve_internal_time_seconds =
@@ -338,7 +367,8 @@ std::map<CompactionPri, std::string> OptionsHelper::compaction_pri_to_string = {
     {kOldestLargestSeqFirst, "kOldestLargestSeqFirst"},
     {kOldestSmallestSeqFirst, "kOldestSmallestSeqFirst"},
     {kMinOverlappingRatio, "kMinOverlappingRatio"},
-    {kRoundRobin, "kRoundRobin"}};
+    {kRoundRobin, "kRoundRobin"},
+    {kMinOverlappingRatioByReads, "kMinOverlappingRatioByReads"}};
 
 std::map<CompactionStopStyle, std::string>
     OptionsHelper::compaction_stop_style_to_string = {
@@ -810,7 +840,8 @@ std::unordered_map<std::string, CompactionPri>
         {"kOldestLargestSeqFirst", kOldestLargestSeqFirst},
         {"kOldestSmallestSeqFirst", kOldestSmallestSeqFirst},
         {"kMinOverlappingRatio", kMinOverlappingRatio},
-        {"kRoundRobin", kRoundRobin}};
+        {"kRoundRobin", kRoundRobin},
+        {"kMinOverlappingRatioByReads", kMinOverlappingRatioByReads}};
 
 std::unordered_map<std::string, CompactionStopStyle>
     OptionsHelper::compaction_stop_style_string_map = {
@@ -183,7 +183,8 @@ TEST_F(OptionsSettableTest, BlockBasedTableOptionsAllFieldsSettable) {
       "data_block_index_type=kDataBlockBinaryAndHash;"
       "index_shortening=kNoShortening;"
       "data_block_hash_table_util_ratio=0.75;"
-      "checksum=kxxHash;no_block_cache=1;"
+      "data_block_restart_key_prefixes=true;"
+      "checksum=kxxHash;no_block_cache=1;cache_keys_from_file_unique_id=1;"
       "block_cache=1M;block_cache_compressed=1k;block_size=1024;"
       "block_size_deviation=8;block_restart_interval=4; "
       "metadata_block_size=1024;"
@@ -192,15 +193,20 @@ TEST_F(OptionsSettableTest, BlockBasedTableOptionsAllFieldsSettable) {
       "use_delta_encoding=true;"
       "index_block_restart_interval=4;"
       "filter_policy=bloomfilter:4:true;whole_key_filtering=1;detect_filter_"
-      "construct_corruption=false;"
+      "construct_corruption=false;range_filter_key_width=8;"
       "format_version=1;"
       "verify_compression=true;read_amp_bytes_per_bit=0;"
       "enable_index_compression=false;"
       "block_align=true;"
       "max_auto_readahead_size=0;"
       "prepopulate_block_cache=kDisable;"
+      "prepopulate_block_cache_compaction_budget=0;"
       "initial_auto_readahead_size=0;"
-      "num_file_reads_for_auto_readahead=0",
+      "num_file_reads_for_auto_readahead=0;"
+      "learn_auto_readahead_size=true;"
+      "compaction_decompression_threads=0;"
+      "compaction_block_passthrough=false;"
+      "store_key_anchors=false",
       new_bbto));
 
   ASSERT_EQ(unset_bytes_base,
@@ -243,6 +249,16 @@ TEST_F(OptionsSettableTest, DBOptionsAllFieldsSettable) {
       {offsetof(struct DBOptions, listeners),
        sizeof(std::vector<std::shared_ptr<EventListener>>)},
       {offsetof(struct DBOptions, row_cache), sizeof(std::shared_ptr<Cache>)},
+      {offsetof(struct DBOptions, merge_result_cache),
+       sizeof(std::shared_ptr<Cache>)},
+      {offsetof(struct DBOptions, op_trace_sink),
+       sizeof(std::shared_ptr<OpTraceSink>)},
+      {offsetof(struct DBOptions, iterator_memory_cache),
+       sizeof(std::shared_ptr<Cache>)},
+      {offsetof(struct DBOptions, auto_tuner),
+       sizeof(std::shared_ptr<AutoTuner>)},
+      {offsetof(struct DBOptions, compression_accelerator),
+       sizeof(std::shared_ptr<CompressionAccelerator>)},
       {offsetof(struct DBOptions, wal_filter), sizeof(const WalFilter*)},
       {offsetof(struct DBOptions, file_checksum_gen_factory),
        sizeof(std::shared_ptr<FileChecksumGenFactory>)},
@@ -288,8 +304,10 @@ TEST_F(OptionsSettableTest, DBOptionsAllFieldsSettable) {
                              "WAL_ttl_seconds=4295008036;"
                              "WAL_size_limit_MB=4295036161;"
                              "max_write_batch_group_size_bytes=1048576;"
+                             "op_trace_sample_one_in=100;"
                              "wal_dir=path/to/wal_dir;"
                              "db_write_buffer_size=2587;"
+                             "write_buffer_manager_weight=3;"
                              "max_subcompactions=64330;"
                              "table_cache_numshardbits=28;"
                              "max_open_files=72;"
@@ -329,6 +347,7 @@ TEST_F(OptionsSettableTest, DBOptionsAllFieldsSettable) {
                              "persist_stats_to_disk=true;"
                              "stats_history_buffer_size=14159;"
                              "allow_fallocate=true;"
+                             "use_io_uring_for_writes=false;"
                              "allow_mmap_reads=false;"
                              "use_direct_reads=false;"
                              "use_direct_io_for_flush_and_compaction=false;"
@@ -348,6 +367,11 @@ TEST_F(OptionsSettableTest, DBOptionsAllFieldsSettable) {
                              "dump_malloc_stats=false;"
                              "allow_2pc=false;"
                              "avoid_flush_during_recovery=false;"
+                             "wal_recovery_threads=4;"
+                             "async_read_threads=2;"
+                             "max_flush_subjobs=2;"
+                             "snapshot_memtables_on_shutdown=false;"
+                             "summarize_tables_on_shutdown=false;"
                              "avoid_flush_during_shutdown=false;"
                              "allow_ingest_behind=false;"
                              "concurrent_prepare=false;"
@@ -367,6 +391,7 @@ TEST_F(OptionsSettableTest, DBOptionsAllFieldsSettable) {
                              "lowest_used_cache_tier=kNonVolatileBlockTier;"
                              "allow_data_in_errors=false;"
                              "enforce_single_del_contracts=false;"
+                             "use_loser_tree_in_compaction=true;"
                              "daily_offpeak_time_utc=08:30-19:00;",
                              new_options));
 
@@ -437,6 +462,10 @@ TEST_F(OptionsSettableTest, ColumnFamilyOptionsAllFieldsSettable) {
        sizeof(std::shared_ptr<ConcurrentTaskLimiter>)},
       {offsetof(struct ColumnFamilyOptions, sst_partitioner_factory),
        sizeof(std::shared_ptr<SstPartitionerFactory>)},
+      {offsetof(struct ColumnFamilyOptions, compaction_cost_model),
+       sizeof(std::shared_ptr<CompactionCostModel>)},
+      {offsetof(struct ColumnFamilyOptions, column_family_statistics),
+       sizeof(std::shared_ptr<Statistics>)},
   };
 
   char* options_ptr = new char[sizeof(ColumnFamilyOptions)];
@@ -508,11 +537,13 @@ TEST_F(OptionsSettableTest, ColumnFamilyOptionsAllFieldsSettable) {
       "compression_opts={max_dict_buffer_bytes=5;use_zstd_dict_trainer=true;"
       "enabled=false;parallel_threads=6;zstd_max_train_bytes=7;strategy=8;max_"
       "dict_bytes=9;level=10;window_bits=11;max_compressed_bytes_per_kb=987;"
-      "checksum=true};"
+      "checksum=true;adaptive_cpu_cost_per_kb=16;train_dict_in_background="
+      "true};"
       "bottommost_compression_opts={max_dict_buffer_bytes=4;use_zstd_dict_"
       "trainer=true;enabled=true;parallel_threads=5;zstd_max_train_bytes=6;"
       "strategy=7;max_dict_bytes=8;level=9;window_bits=10;max_compressed_bytes_"
-      "per_kb=876;checksum=true};"
+      "per_kb=876;checksum=true;adaptive_cpu_cost_per_kb=0;train_dict_in_"
+      "background=false};"
       "bottommost_compression=kDisableCompressionOption;"
       "level0_stop_writes_trigger=33;"
       "num_levels=99;"
@@ -551,6 +582,7 @@ TEST_F(OptionsSettableTest, ColumnFamilyOptionsAllFieldsSettable) {
       "blob_garbage_collection_age_cutoff=0.5;"
       "blob_garbage_collection_force_threshold=0.75;"
       "blob_compaction_readahead_size=262144;"
+      "blob_compaction_read_batch_size=32;"
       "blob_file_starting_level=1;"
       "prepopulate_blob_cache=kDisable;"
       "bottommost_temperature=kWarm;"
@@ -563,10 +595,13 @@ TEST_F(OptionsSettableTest, ColumnFamilyOptionsAllFieldsSettable) {
       "compaction=true;age_for_warm=0;file_temperature_age_thresholds={{"
       "temperature=kCold;age=12345}};};"
       "blob_cache=1M;"
+      "blob_multiget_threads=4;"
       "memtable_protection_bytes_per_key=2;"
       "persist_user_defined_timestamps=true;"
       "block_protection_bytes_per_key=1;"
       "memtable_max_range_deletions=999999;"
+      "range_deletion_compaction_ratio=2.5;"
+      "trivial_move_batch_size=16;"
       "bottommost_file_compaction_delay=7200;",
       new_options));
 
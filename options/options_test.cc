@@ -128,6 +128,7 @@ TEST_F(OptionsTest, GetOptionsFromMapTest) {
       {"blob_garbage_collection_age_cutoff", "0.5"},
       {"blob_garbage_collection_force_threshold", "0.75"},
       {"blob_compaction_readahead_size", "256K"},
+      {"blob_compaction_read_batch_size", "32"},
       {"disable_flush", "false"},
       {"blob_file_starting_level", "1"},
       {"prepopulate_blob_cache", "kDisable"},
@@ -136,6 +137,8 @@ TEST_F(OptionsTest, GetOptionsFromMapTest) {
       {"default_temperature", "kHot"},
       {"persist_user_defined_timestamps", "true"},
       {"memtable_max_range_deletions", "0"},
+      {"range_deletion_compaction_ratio", "2.5"},
+      {"trivial_move_batch_size", "16"},
   };
 
   std::unordered_map<std::string, std::string> db_options_map = {
@@ -286,15 +289,19 @@ TEST_F(OptionsTest, GetOptionsFromMapTest) {
   ASSERT_EQ(new_cf_opt.blob_garbage_collection_age_cutoff, 0.5);
   ASSERT_EQ(new_cf_opt.blob_garbage_collection_force_threshold, 0.75);
   ASSERT_EQ(new_cf_opt.blob_compaction_readahead_size, 262144);
+  ASSERT_EQ(new_cf_opt.blob_compaction_read_batch_size, 32);
   ASSERT_EQ(new_cf_opt.blob_file_starting_level, 1);
   ASSERT_EQ(new_cf_opt.prepopulate_blob_cache, PrepopulateBlobCache::kDisable);
   ASSERT_EQ(new_cf_opt.last_level_temperature, Temperature::kWarm);
   ASSERT_EQ(new_cf_opt.disable_auto_flush, false);
   ASSERT_EQ(new_cf_opt.disable_write_stall, false);
+  ASSERT_EQ(new_cf_opt.smooth_write_stall, false);
   ASSERT_EQ(new_cf_opt.default_write_temperature, Temperature::kCold);
   ASSERT_EQ(new_cf_opt.default_temperature, Temperature::kHot);
   ASSERT_EQ(new_cf_opt.persist_user_defined_timestamps, true);
   ASSERT_EQ(new_cf_opt.memtable_max_range_deletions, 0);
+  ASSERT_EQ(new_cf_opt.range_deletion_compaction_ratio, 2.5);
+  ASSERT_EQ(new_cf_opt.trivial_move_batch_size, 16);
 
   cf_options_map["write_buffer_size"] = "hello";
   ASSERT_NOK(GetColumnFamilyOptionsFromMap(exact, base_cf_opt, cf_options_map,
@@ -1285,6 +1292,13 @@ TEST_F(OptionsTest, MemTableRepFactoryCreateFromString) {
 
   ASSERT_OK(MemTableRepFactory::CreateFromString(
       config_options, "id=skip_list; lookahead=32", &new_mem_factory));
+  ASSERT_OK(MemTableRepFactory::CreateFromString(
+      config_options, "id=skip_list; hash_index_buckets=1024",
+      &new_mem_factory));
+  const size_t* hash_index_buckets =
+      new_mem_factory->GetOptions<size_t>("SkipListFactoryHashIndexOptions");
+  ASSERT_NE(hash_index_buckets, nullptr);
+  ASSERT_EQ(1024U, *hash_index_buckets);
   ASSERT_OK(MemTableRepFactory::CreateFromString(config_options, "prefix_hash",
                                                  &new_mem_factory));
   ASSERT_OK(MemTableRepFactory::CreateFromString(
@@ -1336,6 +1350,13 @@ TEST_F(OptionsTest, MemTableRepFactoryCreateFromString) {
       config_options, "vector:1024:invalid_opt", &new_mem_factory));
   ASSERT_OK(MemTableRepFactory::CreateFromString(
       config_options, "id=vector; count=42", &new_mem_factory));
+  ASSERT_OK(MemTableRepFactory::CreateFromString(
+      config_options, "id=vector; count=42; parallel_sort_threads=4",
+      &new_mem_factory));
+  const size_t* parallel_sort_threads =
+      new_mem_factory->GetOptions<size_t>("VectorRepFactorySortOptions");
+  ASSERT_NE(parallel_sort_threads, nullptr);
+  ASSERT_EQ(4U, *parallel_sort_threads);
   ASSERT_NOK(MemTableRepFactory::CreateFromString(
       config_options, "id=vector; invalid=unknown", &new_mem_factory));
   ASSERT_NOK(MemTableRepFactory::CreateFromString(config_options, "cuckoo",
@@ -2352,6 +2373,7 @@ TEST_F(OptionsOldApiTest, GetOptionsFromMapTest) {
       {"blob_garbage_collection_age_cutoff", "0.5"},
       {"blob_garbage_collection_force_threshold", "0.75"},
       {"blob_compaction_readahead_size", "256K"},
+      {"blob_compaction_read_batch_size", "32"},
       {"blob_file_starting_level", "1"},
       {"prepopulate_blob_cache", "kDisable"},
       {"last_level_temperature", "kWarm"},
@@ -2359,6 +2381,8 @@ TEST_F(OptionsOldApiTest, GetOptionsFromMapTest) {
       {"default_temperature", "kHot"},
       {"persist_user_defined_timestamps", "true"},
       {"memtable_max_range_deletions", "0"},
+      {"range_deletion_compaction_ratio", "2.5"},
+      {"trivial_move_batch_size", "16"},
   };
 
   std::unordered_map<std::string, std::string> db_options_map = {
@@ -2505,6 +2529,7 @@ TEST_F(OptionsOldApiTest, GetOptionsFromMapTest) {
   ASSERT_EQ(new_cf_opt.blob_garbage_collection_age_cutoff, 0.5);
   ASSERT_EQ(new_cf_opt.blob_garbage_collection_force_threshold, 0.75);
   ASSERT_EQ(new_cf_opt.blob_compaction_readahead_size, 262144);
+  ASSERT_EQ(new_cf_opt.blob_compaction_read_batch_size, 32);
   ASSERT_EQ(new_cf_opt.blob_file_starting_level, 1);
   ASSERT_EQ(new_cf_opt.prepopulate_blob_cache, PrepopulateBlobCache::kDisable);
   ASSERT_EQ(new_cf_opt.last_level_temperature, Temperature::kWarm);
@@ -2512,6 +2537,8 @@ TEST_F(OptionsOldApiTest, GetOptionsFromMapTest) {
   ASSERT_EQ(new_cf_opt.default_temperature, Temperature::kHot);
   ASSERT_EQ(new_cf_opt.persist_user_defined_timestamps, true);
   ASSERT_EQ(new_cf_opt.memtable_max_range_deletions, 0);
+  ASSERT_EQ(new_cf_opt.range_deletion_compaction_ratio, 2.5);
+  ASSERT_EQ(new_cf_opt.trivial_move_batch_size, 16);
 
   cf_options_map["write_buffer_size"] = "hello";
   ASSERT_NOK(GetColumnFamilyOptionsFromMap(cf_config_options, base_cf_opt,
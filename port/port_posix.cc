@@ -280,6 +280,78 @@ void SetCpuPriority(ThreadId id, CpuPriority priority) {
 #endif
 }
 
+bool SetCpuAffinity(ThreadId id, const std::vector<int>& cpus) {
+#ifdef OS_LINUX
+  cpu_set_t set;
+  CPU_ZERO(&set);
+  for (int cpu : cpus) {
+    if (cpu < 0 || cpu >= CPU_SETSIZE) {
+      return false;
+    }
+    CPU_SET(cpu, &set);
+  }
+  return sched_setaffinity(id, sizeof(set), &set) == 0;
+#else
+  (void)id;
+  (void)cpus;
+  return false;
+#endif
+}
+
+bool GetProcessCpuAffinity(std::vector<int>* cpus) {
+#ifdef OS_LINUX
+  cpu_set_t set;
+  CPU_ZERO(&set);
+  if (sched_getaffinity(getpid(), sizeof(set), &set) != 0) {
+    return false;
+  }
+  cpus->clear();
+  for (int cpu = 0; cpu < CPU_SETSIZE; ++cpu) {
+    if (CPU_ISSET(cpu, &set)) {
+      cpus->push_back(cpu);
+    }
+  }
+  return true;
+#else
+  (void)cpus;
+  return false;
+#endif
+}
+
+bool GetNumaNodeCpus(int numa_node, std::vector<int>* cpus) {
+#ifdef OS_LINUX
+  if (numa_node < 0) {
+    return false;
+  }
+  // A list of ranges, like "0-3,8-11"
+  std::ifstream f("/sys/devices/system/node/node" +
+                  std::to_string(numa_node) + "/cpulist");
+  std::string list;
+  if (!std::getline(f, list)) {
+    return false;
+  }
+  cpus->clear();
+  for (const std::string& range : StringSplit(list, ',')) {
+    if (range.empty()) {
+      continue;
+    }
+    size_t dash = range.find('-');
+    int first = std::atoi(range.c_str());
+    int last = dash == std::string::npos
+                   ? first
+                   : std::atoi(range.c_str() + dash + 1);
+    for (int cpu = first; cpu <= last; ++cpu) {
+      cpus->push_back(cpu);
+    }
+  }
+  return true;
+#else
+  (void)numa_node;
+  (void)cpus;
+  return false;
+#endif
+}
+
 int64_t GetProcessID() { return getpid(); }
 
 bool GenerateRfcUuid(std::string* output) {
@@ -57,6 +57,7 @@
 
 #include <limits>
 #include <string>
+#include <vector>
 
 #ifndef PLATFORM_IS_LITTLE_ENDIAN
 #define PLATFORM_IS_LITTLE_ENDIAN (__BYTE_ORDER == __LITTLE_ENDIAN)
@@ -236,6 +237,18 @@ using ThreadId = pid_t;
 
 void SetCpuPriority(ThreadId id, CpuPriority priority);
 
+// Restricts thread `id`, 0 for the calling thread, to run on `cpus`. Returns
+// false if not supported or on failure.
+bool SetCpuAffinity(ThreadId id, const std::vector<int>& cpus);
+
+// Gets the CPUs the process may run on, that is the ones of its main thread.
+// Returns false if not supported or on failure.
+bool GetProcessCpuAffinity(std::vector<int>* cpus);
+
+// Gets the CPUs of NUMA node `numa_node`. Returns false if not supported or
+// if there is no such node.
+bool GetNumaNodeCpus(int numa_node, std::vector<int>* cpus);
+
 int64_t GetProcessID();
 
 // Uses platform APIs to generate a 36-character RFC-4122 UUID. Returns
@@ -276,6 +276,26 @@ void SetCpuPriority(ThreadId id, CpuPriority priority) {
   (void)priority;
 }
 
+bool SetCpuAffinity(ThreadId id, const std::vector<int>& cpus) {
+  // Not supported
+  (void)id;
+  (void)cpus;
+  return false;
+}
+
+bool GetProcessCpuAffinity(std::vector<int>* cpus) {
+  // Not supported
+  (void)cpus;
+  return false;
+}
+
+bool GetNumaNodeCpus(int numa_node, std::vector<int>* cpus) {
+  // Not supported
+  (void)numa_node;
+  (void)cpus;
+  return false;
+}
+
 int64_t GetProcessID() { return GetCurrentProcessId(); }
 
 bool GenerateRfcUuid(std::string* output) {
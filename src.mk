@@ -7,11 +7,15 @@ LIB_SOURCES =                                                   \
   cache/cache_reservation_manager.cc                            \
   cache/charged_cache.cc                                        \
   cache/clock_cache.cc                                          \
+  cache/log_structured_secondary_cache.cc                       \
   cache/lru_cache.cc                                            \
   cache/compressed_secondary_cache.cc                           \
+  cache/compressed_tier_cache.cc                                \
+  cache/frequency_sketch.cc                                     \
   cache/secondary_cache.cc                                      \
   cache/secondary_cache_adapter.cc                              \
   cache/sharded_cache.cc                                        \
+  cache/tenant_cache.cc                                         \
   cache/tiered_secondary_cache.cc				                \
   cloud/aws/aws_file_system.cc                                  \
   cloud/aws/aws_kafka.cc                                        \
@@ -19,16 +23,25 @@ LIB_SOURCES =                                                   \
   cloud/aws/aws_retry.cc                                        \
   cloud/aws/aws_s3.cc                                           \
   cloud/db_cloud_impl.cc                                        \
+  cloud/cloud_chunk_cache.cc                                    \
+  cloud/cloud_compaction_prefetcher.cc                          \
   cloud/cloud_file_system.cc                                    \
   cloud/cloud_file_system_impl.cc                               \
   cloud/cloud_log_controller.cc                                 \
   cloud/manifest_reader.cc                                      \
   cloud/purge.cc                                                \
   cloud/cloud_manifest.cc                                       \
+  cloud/cloud_rate_limiter.cc                                   \
+  cloud/cloud_read_hedger.cc                                    \
+  cloud/cloud_request_stats.cc                                  \
   cloud/cloud_scheduler.cc                                      \
+  cloud/cloud_stats_history.cc                                  \
   cloud/cloud_storage_provider.cc                               \
+  cloud/cloud_upload_scheduler.cc                               \
   cloud/cloud_file_deletion_scheduler.cc                        \
+  cloud/simulated_storage_provider.cc                           \
   db/arena_wrapped_db_iter.cc                                   \
+  db/auto_tuner.cc                                              \
   db/blob/blob_contents.cc                                      \
   db/blob/blob_fetcher.cc                                       \
   db/blob/blob_file_addition.cc                                 \
@@ -46,7 +59,9 @@ LIB_SOURCES =                                                   \
   db/builder.cc                                                 \
   db/c.cc                                                       \
   db/column_family.cc                                           \
+  db/compaction/blob_prefetch_iterator.cc                       \
   db/compaction/compaction.cc                                   \
+  db/compaction/compaction_cost_model.cc                        \
   db/compaction/compaction_iterator.cc                          \
   db/compaction/compaction_job.cc                               \
   db/compaction/compaction_picker.cc                            \
@@ -56,6 +71,7 @@ LIB_SOURCES =                                                   \
   db/compaction/compaction_service_job.cc                       \
   db/compaction/compaction_state.cc                             \
   db/compaction/compaction_outputs.cc                           \
+  db/compaction/filter_batch_iterator.cc                        \
   db/compaction/sst_partitioner.cc                              \
   db/compaction/subcompaction_state.cc                          \
   db/convenience.cc                                             \
@@ -90,6 +106,7 @@ LIB_SOURCES =                                                   \
   db/malloc_stats.cc                                            \
   db/memtable.cc                                                \
   db/memtable_list.cc                                           \
+  db/memtable_snapshot.cc                                       \
   db/merge_helper.cc                                            \
   db/merge_operator.cc                                          \
   db/multi_cf_iterator.cc                                       \
@@ -102,6 +119,7 @@ LIB_SOURCES =                                                   \
   db/snapshot_impl.cc                                           \
   db/table_cache.cc                                             \
   db/table_properties_collector.cc                              \
+  db/table_summary.cc                                           \
   db/transaction_log_impl.cc                                    \
   db/trim_history_scheduler.cc                                  \
   db/version_builder.cc                                         \
@@ -151,16 +169,19 @@ LIB_SOURCES =                                                   \
   memory/memkind_kmem_allocator.cc                              \
   memory/memory_allocator.cc                                    \
   memtable/alloc_tracker.cc                                     \
+  memtable/art_rep.cc                                           \
   memtable/hash_linklist_rep.cc                                 \
   memtable/hash_skiplist_rep.cc                                 \
   memtable/skiplistrep.cc                                       \
   memtable/vectorrep.cc                                         \
   memtable/write_buffer_manager.cc                              \
   monitoring/histogram.cc                                       \
+  monitoring/histogram_hdr.cc                                   \
   monitoring/histogram_windowing.cc                             \
   monitoring/in_memory_stats_history.cc                         \
   monitoring/instrumented_mutex.cc                              \
   monitoring/iostats_context.cc                                 \
+  monitoring/op_trace.cc                                        \
   monitoring/perf_context.cc                                    \
   monitoring/perf_level.cc                                      \
   monitoring/persistent_stats_history.cc                        \
@@ -196,6 +217,7 @@ LIB_SOURCES =                                                   \
   table/block_based/block_based_table_reader.cc                 \
   table/block_based/block_builder.cc                            \
   table/block_based/block_cache.cc                              \
+  table/block_based/block_decompression_pipeline.cc             \
   table/block_based/block_prefetcher.cc                         \
   table/block_based/block_prefix_index.cc                       \
   table/block_based/data_block_hash_index.cc                    \
@@ -207,10 +229,14 @@ LIB_SOURCES =                                                   \
   table/block_based/hash_index_reader.cc                        \
   table/block_based/index_builder.cc                            \
   table/block_based/index_reader_common.cc                      \
+  table/block_based/key_anchors.cc                              \
+  table/block_based/learned_index.cc                            \
+  table/block_based/learned_index_reader.cc                     \
   table/block_based/parsed_full_filter_block.cc                 \
   table/block_based/partitioned_filter_block.cc                 \
   table/block_based/partitioned_index_iterator.cc               \
   table/block_based/partitioned_index_reader.cc                 \
+  table/block_based/range_filter.cc                             \
   table/block_based/reader_common.cc                            \
   table/block_based/uncompression_dict_reader.cc                \
   table/block_fetcher.cc                                        \
@@ -222,6 +248,8 @@ LIB_SOURCES =                                                   \
   table/iterator.cc                                             \
   table/merging_iterator.cc                                     \
   table/compaction_merging_iterator.cc                          \
+  table/compression_dict_manager.cc                             \
+  table/hot_key_ranges.cc                                       \
   table/meta_blocks.cc                                          \
   table/persistent_cache_helper.cc                              \
   table/plain/plain_table_bloom.cc                              \
@@ -247,6 +275,7 @@ LIB_SOURCES =                                                   \
   trace_replay/trace_replay.cc                                  \
   trace_replay/block_cache_tracer.cc                            \
   trace_replay/io_tracer.cc                                     \
+  util/aligned_buffer_pool.cc                                   \
   util/async_file_reader.cc					\
   util/build_version.cc                                         \
   util/cleanable.cc                                             \
@@ -261,6 +290,7 @@ LIB_SOURCES =                                                   \
   util/data_structure.cc                                        \
   util/dynamic_bloom.cc                                         \
   util/hash.cc                                                  \
+  util/hierarchical_rate_limiter.cc                             \
   util/murmurhash.cc                                            \
   util/random.cc                                                \
   util/rate_limiter.cc                                          \
@@ -273,6 +303,7 @@ LIB_SOURCES =                                                   \
   util/thread_local.cc                                          \
   util/threadpool_imp.cc                                        \
   util/udt_util.cc                                              \
+  util/work_stealing_thread_pool.cc                             \
   util/write_batch_util.cc                                      \
   util/xxhash.cc                                                \
   utilities/agg_merge/agg_merge.cc                              \
@@ -323,6 +354,7 @@ LIB_SOURCES =                                                   \
   utilities/trace/replayer_impl.cc                              \
   utilities/transactions/lock/lock_manager.cc                   \
   utilities/transactions/lock/point/point_lock_tracker.cc       \
+  utilities/transactions/lock/point/per_key_point_lock_manager.cc \
   utilities/transactions/lock/point/point_lock_manager.cc       \
   utilities/transactions/optimistic_transaction.cc              \
   utilities/transactions/optimistic_transaction_db_impl.cc      \
@@ -428,7 +460,9 @@ FOLLY_SOURCES =                                                 \
 TOOLS_MAIN_SOURCES =                                                    \
   db_stress_tool/db_stress.cc                                           \
   tools/blob_dump.cc                                                    \
+  tools/cloud_stats_history.cc                                          \
   tools/block_cache_analyzer/block_cache_trace_analyzer_tool.cc         \
+  tools/db_repl_bench.cc                                                \
   tools/db_repl_stress.cc                                               \
   tools/db_sanity_test.cc                                               \
   tools/ldb.cc                                                          \
@@ -454,12 +488,15 @@ TEST_MAIN_SOURCES =                                                     \
   cache/cache_test.cc                                                   \
   cache/cache_reservation_manager_test.cc                               \
   cloud/db_cloud_test.cc                                                \
+  cloud/cloud_chunk_cache_test.cc                                       \
   cloud/cloud_file_system_test.cc                                       \
   cloud/cloud_manifest_test.cc                                          \
   cloud/cloud_scheduler_test.cc                                         \
   cloud/replication_test.cc                                             \
   cache/compressed_secondary_cache_test.cc                              \
+  cache/log_structured_secondary_cache_test.cc                          \
   cache/lru_cache_test.cc                                               \
+  cache/tenant_cache_test.cc                                            \
   cache/tiered_secondary_cache_test.cc					\
   db/blob/blob_counting_iterator_test.cc                                \
   db/blob/blob_file_addition_test.cc                                    \
@@ -573,6 +610,7 @@ TEST_MAIN_SOURCES =                                                     \
   logging/event_logger_test.cc                                          \
   memory/arena_test.cc                                                  \
   memory/memory_allocator_test.cc                                       \
+  memtable/art_rep_test.cc                                              \
   memtable/inlineskiplist_test.cc                                       \
   memtable/skiplist_test.cc                                             \
   memtable/write_buffer_manager_test.cc                                 \
@@ -588,7 +626,9 @@ TEST_MAIN_SOURCES =                                                     \
   table/block_based/block_test.cc                                       \
   table/block_based/data_block_hash_index_test.cc                       \
   table/block_based/full_filter_block_test.cc                           \
+  table/block_based/learned_index_test.cc                               \
   table/block_based/partitioned_filter_block_test.cc                    \
+  table/block_based/range_filter_test.cc                                \
   table/cleanable_test.cc                                               \
   table/cuckoo/cuckoo_table_builder_test.cc                             \
   table/cuckoo/cuckoo_table_reader_test.cc                              \
@@ -627,6 +667,7 @@ TEST_MAIN_SOURCES =                                                     \
   util/thread_local_test.cc                                             \
   util/udt_util_test.cc                                                 \
   util/work_queue_test.cc                                               \
+  util/work_stealing_thread_pool_test.cc                                \
   utilities/agg_merge/agg_merge_test.cc                                 \
   utilities/backup/backup_engine_test.cc                                \
   utilities/blob_db/blob_db_test.cc                                     \
@@ -664,6 +705,12 @@ TEST_MAIN_SOURCES_C = \
 MICROBENCH_SOURCES =                                          \
   microbench/ribbon_bench.cc                                  \
   microbench/db_basic_bench.cc                                  \
+  microbench/threadpool_bench.cc                                \
+  microbench/block_bench.cc                                   \
+  microbench/checksum_bench.cc                                \
+  microbench/skiplist_bench.cc                                \
+  microbench/write_batch_bench.cc                             \
+  microbench/merger_bench.cc                                  \
 
 JNI_NATIVE_SOURCES =                                          \
   java/rocksjni/backupenginejni.cc                            \
@@ -24,6 +24,11 @@
 #include "table/block_based/data_block_footer.h"
 #include "table/format.h"
 #include "util/coding.h"
+#include "util/math.h"
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
 
 namespace ROCKSDB_NAMESPACE {
 
@@ -299,6 +304,81 @@ void DataBlockIter::PrevImpl() {
   prev_entries_idx_ = static_cast<int32_t>(prev_entries_.size()) - 1;
 }
 
+namespace {
+// Above this many restart points, the restart key prefixes are binary
+// searched instead of scanned.
+const uint32_t kMaxRestartKeyPrefixesToScan = 64;
+}  // namespace
+
+void DataBlockIter::SearchRestartKeyPrefixes(const Slice& target,
+                                             int64_t* left,
+                                             int64_t* right) const {
+  assert(restart_key_prefixes_ != nullptr);
+  const uint32_t target_prefix = RestartKeyPrefix(ExtractUserKey(target));
+  // The restart keys before `lo` have smaller prefixes, and are therefore
+  // smaller than target, and the ones from `hi` on have greater prefixes.
+  uint32_t lo = 0;
+  uint32_t hi = 0;
+  if (num_restarts_ > kMaxRestartKeyPrefixesToScan) {
+    // Find the range of restart points with equal prefixes, which are sorted,
+    // with two binary searches that do not decode any key.
+    uint32_t count = num_restarts_;
+    while (count > 0) {
+      uint32_t step = count / 2;
+      if (DecodeFixed32(restart_key_prefixes_ + (lo + step) * 4) <
+          target_prefix) {
+        lo += step + 1;
+        count -= step + 1;
+      } else {
+        count = step;
+      }
+    }
+    hi = lo;
+    count = num_restarts_ - lo;
+    while (count > 0) {
+      uint32_t step = count / 2;
+      if (DecodeFixed32(restart_key_prefixes_ + (hi + step) * 4) <=
+          target_prefix) {
+        hi += step + 1;
+        count -= step + 1;
+      } else {
+        count = step;
+      }
+    }
+  } else {
+    uint32_t i = 0;
+#ifdef __SSE2__
+    if (port::kLittleEndian) {
+      // Count the smaller and the greater prefixes four at a time. SSE2 only
+      // compares signed integers, so flip the sign bits first.
+      const __m128i sign = _mm_set1_epi32(INT32_MIN);
+      const __m128i target_v = _mm_xor_si128(
+          _mm_set1_epi32(static_cast<int32_t>(target_prefix)), sign);
+      uint32_t greater = 0;
+      for (; i + 4 <= num_restarts_; i += 4) {
+        __m128i v = _mm_xor_si128(
+            _mm_loadu_si128(reinterpret_cast<const __m128i*>(
+                restart_key_prefixes_ + i * 4)),
+            sign);
+        lo += BitsSetToOne(_mm_movemask_ps(
+            _mm_castsi128_ps(_mm_cmplt_epi32(v, target_v))));
+        greater += BitsSetToOne(_mm_movemask_ps(
+            _mm_castsi128_ps(_mm_cmpgt_epi32(v, target_v))));
+      }
+      hi = i - greater;
+    }
+#endif  // __SSE2__
+    for (; i < num_restarts_; i++) {
+      uint32_t prefix = DecodeFixed32(restart_key_prefixes_ + i * 4);
+      lo += prefix < target_prefix;
+      hi += prefix <= target_prefix;
+    }
+  }
+  assert(lo <= hi);
+  *left = static_cast<int64_t>(lo) - 1;
+  *right = static_cast<int64_t>(hi) - 1;
+}
+
 void DataBlockIter::SeekImpl(const Slice& target) {
   Slice seek_key = target;
   PERF_TIMER_GUARD(block_seek_nanos);
@@ -307,7 +387,12 @@ void DataBlockIter::SeekImpl(const Slice& target) {
   }
   uint32_t index = 0;
   bool skip_linear_scan = false;
-  bool ok = BinarySeek<DecodeKey>(seek_key, &index, &skip_linear_scan);
+  int64_t left = -1, right = num_restarts_ - 1;
+  if (restart_key_prefixes_ != nullptr) {
+    SearchRestartKeyPrefixes(seek_key, &left, &right);
+  }
+  bool ok = BinarySeek<DecodeKey>(seek_key, left, right, &index,
+                                  &skip_linear_scan);
 
   if (!ok) {
     return;
@@ -356,11 +441,10 @@ void MetaBlockIter::SeekImpl(const Slice& target) {
 //    than the seek_user_key, or the block ends with a matching user_key but
 //    with a smaller [ type | seqno ] (i.e. a larger seqno, or the same seqno
 //    but larger type).
-bool DataBlockIter::SeekForGetImpl(const Slice& target) {
+bool DataBlockIter::SeekForGetImpl(const Slice& target,
+                                   uint8_t hash_index_entry) {
   Slice target_user_key = ExtractUserKey(target);
-  uint32_t map_offset = restarts_ + num_restarts_ * sizeof(uint32_t);
-  uint8_t entry =
-      data_block_hash_index_->Lookup(data_, map_offset, target_user_key);
+  uint8_t entry = hash_index_entry;
 
   if (entry == kCollision) {
     // HashSeek not effective, falling back
@@ -462,6 +546,25 @@ bool DataBlockIter::SeekForGetImpl(const Slice& target) {
   return true;
 }
 
+bool DataBlockIter::LookupHashIndexBatch(const Slice* targets,
+                                         size_t num_keys,
+                                         uint8_t* hash_index_entries) const {
+  if (!data_block_hash_index_) {
+    return false;
+  }
+  constexpr size_t kMaxUserKeys = 32;
+  Slice user_keys[kMaxUserKeys];
+  for (size_t start = 0; start < num_keys; start += kMaxUserKeys) {
+    size_t n = std::min(kMaxUserKeys, num_keys - start);
+    for (size_t i = 0; i < n; i++) {
+      user_keys[i] = ExtractUserKey(targets[start + i]);
+    }
+    data_block_hash_index_->LookupBatch(data_, hash_index_offset_, user_keys,
+                                        n, hash_index_entries + start);
+  }
+  return true;
+}
+
 void IndexBlockIter::SeekImpl(const Slice& target) {
 #ifndef NDEBUG
   if (TEST_Corrupt_Callback("IndexBlockIter::SeekImpl")) {
@@ -514,7 +617,12 @@ void DataBlockIter::SeekForPrevImpl(const Slice& target) {
   }
   uint32_t index = 0;
   bool skip_linear_scan = false;
-  bool ok = BinarySeek<DecodeKey>(seek_key, &index, &skip_linear_scan);
+  int64_t left = -1, right = num_restarts_ - 1;
+  if (restart_key_prefixes_ != nullptr) {
+    SearchRestartKeyPrefixes(seek_key, &left, &right);
+  }
+  bool ok = BinarySeek<DecodeKey>(seek_key, left, right, &index,
+                                  &skip_linear_scan);
 
   if (!ok) {
     return;
@@ -826,7 +934,8 @@ void BlockIter<TValue>::FindKeyAfterBinarySeek(const Slice& target,
 // compared again later.
 template <class TValue>
 template <typename DecodeKeyFunc>
-bool BlockIter<TValue>::BinarySeek(const Slice& target, uint32_t* index,
+bool BlockIter<TValue>::BinarySeek(const Slice& target, int64_t left,
+                                   int64_t right, uint32_t* index,
                                    bool* skip_linear_scan) {
   if (restarts_ == 0) {
     // SST files dedicated to range tombstones are written with index blocks
@@ -845,7 +954,7 @@ bool BlockIter<TValue>::BinarySeek(const Slice& target, uint32_t* index,
   //   keys.
   // - Any restart keys after index `right` are strictly greater than the target
   //   key.
-  int64_t left = -1, right = num_restarts_ - 1;
+  assert(left >= -1 && left <= right && right < num_restarts_);
   while (left != right) {
     // The `mid` is computed by rounding up so it lands in (`left`, `right`].
     int64_t mid = left + (right - left + 1) / 2;
@@ -1081,6 +1190,7 @@ Block::Block(BlockContents&& contents, size_t read_amp_bytes_per_bit,
         }
         break;
       case BlockBasedTableOptions::kDataBlockBinaryAndHash:
+      case BlockBasedTableOptions::kDataBlockBinaryAndBlockedHash:
         if (size_ < sizeof(uint32_t) /* block footer */ +
                         sizeof(uint16_t) /* NUM_BUCK */) {
           size_ = 0;
@@ -1091,7 +1201,9 @@ Block::Block(BlockContents&& contents, size_t read_amp_bytes_per_bit,
         data_block_hash_index_.Initialize(
             data_, static_cast<uint16_t>(size_ - sizeof(uint32_t)), /*chop off
                                                                 NUM_RESTARTS*/
-            &map_offset);
+            &map_offset,
+            IndexType() ==
+                BlockBasedTableOptions::kDataBlockBinaryAndBlockedHash);
 
         restart_offset_ = map_offset - num_restarts_ * sizeof(uint32_t);
 
@@ -1105,6 +1217,22 @@ Block::Block(BlockContents&& contents, size_t read_amp_bytes_per_bit,
       default:
         size_ = 0;  // Error marker
     }
+    bool has_restart_key_prefixes = false;
+    if (size_ != 0 && size_ <= kMaxBlockSizeSupportedByHashIndex) {
+      // The check is for the same reason as that in NumRestarts()
+      UnPackIndexTypeAndNumRestarts(
+          DecodeFixed32(data_ + size_ - sizeof(uint32_t)), nullptr, nullptr,
+          &has_restart_key_prefixes);
+    }
+    if (has_restart_key_prefixes) {
+      // The key prefixes are stored between the restart array and the hash
+      // index, if any.
+      restart_key_prefixes_offset_ = restart_offset_;
+      restart_offset_ -= num_restarts_ * sizeof(uint32_t);
+      if (restart_offset_ > restart_key_prefixes_offset_) {
+        size_ = 0;
+      }
+    }
   }
   if (read_amp_bytes_per_bit != 0 && statistics && size_ != 0) {
     read_amp_bitmap_.reset(new BlockReadAmpBitmap(
@@ -1279,7 +1407,10 @@ DataBlockIter* Block::NewDataIterator(const Comparator* raw_ucmp,
         read_amp_bitmap_.get(), block_contents_pinned,
         user_defined_timestamps_persisted,
         data_block_hash_index_.Valid() ? &data_block_hash_index_ : nullptr,
-        protection_bytes_per_key_, kv_checksum_, block_restart_interval_);
+        protection_bytes_per_key_, kv_checksum_, block_restart_interval_,
+        restart_key_prefixes_offset_ != 0 ? data_ + restart_key_prefixes_offset_
+                                          : nullptr);
+    ret_iter->block_data_ = Slice(data_, size_);
     if (read_amp_bitmap_) {
       if (read_amp_bitmap_->GetStatistics() != stats) {
         // DB changed the Statistics pointer, we need to notify read_amp_bitmap_
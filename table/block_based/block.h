@@ -18,6 +18,7 @@
 #include "db/pinned_iterators_manager.h"
 #include "port/malloc.h"
 #include "rocksdb/advanced_cache.h"
+#include "rocksdb/comparator.h"
 #include "rocksdb/iterator.h"
 #include "rocksdb/options.h"
 #include "rocksdb/statistics.h"
@@ -281,6 +282,8 @@ class Block {
   size_t size_;              // contents_.data.size()
   uint32_t restart_offset_;  // Offset in data_ of restart array
   uint32_t num_restarts_;
+  // Offset in data_ of the restart key prefixes, or 0 if there are none
+  uint32_t restart_key_prefixes_offset_{0};
   std::unique_ptr<BlockReadAmpBitmap> read_amp_bitmap_;
   char* kv_checksum_{nullptr};
   uint32_t checksum_size_{0};
@@ -632,7 +635,7 @@ class BlockIter : public InternalIteratorBase<TValue> {
   int CompareCurrentKey(const Slice& other) {
     if (raw_key_.IsUserKey()) {
       assert(global_seqno_ == kDisableGlobalSequenceNumber);
-      return icmp_->user_comparator()->Compare(raw_key_.GetUserKey(), other);
+      return icmp_->CompareUserKey(raw_key_.GetUserKey(), other);
     } else if (global_seqno_ == kDisableGlobalSequenceNumber) {
       return icmp_->Compare(raw_key_.GetInternalKey(), other);
     }
@@ -673,7 +676,18 @@ class BlockIter : public InternalIteratorBase<TValue> {
  protected:
   template <typename DecodeKeyFunc>
   inline bool BinarySeek(const Slice& target, uint32_t* index,
-                         bool* is_index_key_result);
+                         bool* is_index_key_result) {
+    return BinarySeek<DecodeKeyFunc>(target, -1, num_restarts_ - 1, index,
+                                     is_index_key_result);
+  }
+
+  // Like above, but only compares target with the restart keys in
+  // (left, right]. The key at restart point `left` must be less than target,
+  // unless left is -1, and the keys after restart point `right` must be
+  // greater than it.
+  template <typename DecodeKeyFunc>
+  inline bool BinarySeek(const Slice& target, int64_t left, int64_t right,
+                         uint32_t* index, bool* is_index_key_result);
 
   // Find the first key in restart interval `index` that is >= `target`.
   // If there is no such key, iterator is positioned at the first key in
@@ -700,7 +714,8 @@ class DataBlockIter final : public BlockIter<Slice> {
                   bool user_defined_timestamps_persisted,
                   DataBlockHashIndex* data_block_hash_index,
                   uint8_t protection_bytes_per_key, const char* kv_checksum,
-                  uint32_t block_restart_interval) {
+                  uint32_t block_restart_interval,
+                  const char* restart_key_prefixes = nullptr) {
     InitializeBase(raw_ucmp, data, restarts, num_restarts, global_seqno,
                    block_contents_pinned, user_defined_timestamps_persisted,
                    protection_bytes_per_key, kv_checksum,
@@ -709,6 +724,12 @@ class DataBlockIter final : public BlockIter<Slice> {
     read_amp_bitmap_ = read_amp_bitmap;
     last_bitmap_offset_ = current_ + 1;
     data_block_hash_index_ = data_block_hash_index;
+    // The prefixes order keys like the bytewise comparator only.
+    restart_key_prefixes_ =
+        raw_ucmp == BytewiseComparator() ? restart_key_prefixes : nullptr;
+    hash_index_offset_ =
+        restarts + num_restarts * sizeof(uint32_t) *
+                       (restart_key_prefixes == nullptr ? 1 : 2);
   }
 
   Slice value() const override {
@@ -732,11 +753,36 @@ class DataBlockIter final : public BlockIter<Slice> {
       UpdateKey();
       return true;
     }
-    bool res = SeekForGetImpl(target);
+    bool res = SeekForGetImpl(
+        target, data_block_hash_index_->Lookup(data_, hash_index_offset_,
+                                               ExtractUserKey(target)));
     UpdateKey();
     return res;
   }
 
+  // Looks up the hash index of the block for the `num_keys` internal keys
+  // in `targets` at once, see DataBlockHashIndex::LookupBatch(). Returns
+  // false if the block has no hash index.
+  bool LookupHashIndexBatch(const Slice* targets, size_t num_keys,
+                            uint8_t* hash_index_entries) const;
+
+  // Same as SeekForGet(target), with the entry of target from
+  // LookupHashIndexBatch()
+  inline bool SeekForGet(const Slice& target, uint8_t hash_index_entry) {
+#ifndef NDEBUG
+    if (TEST_Corrupt_Callback("DataBlockIter::SeekForGet")) return true;
+#endif
+    assert(data_block_hash_index_);
+    bool res = SeekForGetImpl(target, hash_index_entry);
+    UpdateKey();
+    return res;
+  }
+
+  bool IsAtFirstEntry() const { return Valid() && current_ == 0; }
+
+  // The uncompressed block the iterator reads
+  Slice block_data() const { return block_data_; }
+
   void Invalidate(const Status& s) override {
     BlockIter::Invalidate(s);
     // Clear prev entries cache.
@@ -756,6 +802,7 @@ class DataBlockIter final : public BlockIter<Slice> {
   void PrevImpl() override;
 
  private:
+  Slice block_data_;
   // read-amp bitmap
   BlockReadAmpBitmap* read_amp_bitmap_;
   // last `current_` value we report to read-amp bitmp
@@ -785,8 +832,18 @@ class DataBlockIter final : public BlockIter<Slice> {
   int32_t prev_entries_idx_ = -1;
 
   DataBlockHashIndex* data_block_hash_index_;
-
-  bool SeekForGetImpl(const Slice& target);
+  // Offset in data_ of the hash index.
+  uint32_t hash_index_offset_ = 0;
+  // First 4 bytes of the user key at each restart point, see
+  // RestartKeyPrefix(), or nullptr if the block does not store them or they
+  // cannot be used with the comparator.
+  const char* restart_key_prefixes_ = nullptr;
+
+  bool SeekForGetImpl(const Slice& target, uint8_t hash_index_entry);
+  // Narrows the restart points that BinarySeek() need to compare target with
+  // to (*left, *right] with the restart key prefixes.
+  void SearchRestartKeyPrefixes(const Slice& target, int64_t* left,
+                                int64_t* right) const;
 };
 
 // Iterator over MetaBlocks.  MetaBlocks are similar to Data Blocks and
@@ -11,6 +11,7 @@
 
 #include <atomic>
 #include <cassert>
+#include <cmath>
 #include <cstdio>
 #include <list>
 #include <map>
@@ -29,6 +30,7 @@
 #include "index_builder.h"
 #include "logging/logging.h"
 #include "memory/memory_allocator_impl.h"
+#include "monitoring/perf_context_imp.h"
 #include "rocksdb/cache.h"
 #include "rocksdb/comparator.h"
 #include "rocksdb/env.h"
@@ -45,7 +47,11 @@
 #include "table/block_based/filter_policy_internal.h"
 #include "table/block_based/full_filter_block.h"
 #include "table/block_based/partitioned_filter_block.h"
+#include "table/block_based/key_anchors.h"
+#include "table/block_based/range_filter.h"
+#include "table/compression_dict_manager.h"
 #include "table/format.h"
+#include "table/hot_key_ranges.h"
 #include "table/meta_blocks.h"
 #include "table/table_builder.h"
 #include "util/coding.h"
@@ -113,6 +119,155 @@ bool GoodCompressionRatio(size_t compressed_size, size_t uncomp_size,
          10;
 }
 
+// CPU cost of compressing with `type` at `level`, relative to LZ4 at its
+// default level. These are rough ratios of the typical throughputs.
+uint32_t RelativeCompressionCpuCost(CompressionType type, int level) {
+  switch (type) {
+    case kNoCompression:
+      return 0;
+    case kSnappyCompression:
+    case kLZ4Compression:
+      return 1;
+    case kXpressCompression:
+      return 4;
+    case kZlibCompression:
+      return 6;
+    case kLZ4HCCompression:
+      return 8;
+    case kBZip2Compression:
+      return 20;
+    case kZSTD:
+    case kZSTDNotFinalCompression:
+      if (level == CompressionOptions::kDefaultCompressionLevel) {
+        return 3;
+      } else if (level <= 0) {
+        return 2;
+      } else if (level <= 3) {
+        return 3;
+      } else if (level <= 9) {
+        return 6;
+      } else if (level <= 15) {
+        return 12;
+      }
+      return 30;
+    default:
+      return 1;
+  }
+}
+
+// Compressibility of a data block estimated from a sample of it. The byte
+// entropy of the sample approximates the literals of the compressions with an
+// entropy coder, and the fraction of its 4-byte sequences seen before
+// approximates the part of the block covered by matches.
+struct CompressibilityEstimate {
+  double entropy_bits = 8.0;
+  double match_fraction = 0.0;
+
+  // Estimated compressed size over uncompressed size with `type`
+  double CompressedFraction(CompressionType type) const {
+    switch (type) {
+      case kNoCompression:
+        return 1.0;
+      case kSnappyCompression:
+      case kLZ4Compression:
+      case kLZ4HCCompression:
+        // Literals are stored as is
+        return (1.0 - match_fraction) + match_fraction / 8;
+      default:
+        return (1.0 - match_fraction) * entropy_bits / 8 + match_fraction / 16;
+    }
+  }
+};
+
+CompressibilityEstimate EstimateCompressibility(const Slice& data) {
+  constexpr size_t kSampleBytes = 4096;
+  constexpr size_t kNumChunks = 16;
+  constexpr size_t kTableBits = 11;
+
+  CompressibilityEstimate estimate;
+  if (data.empty()) {
+    return estimate;
+  }
+  // Large blocks are sampled in evenly spaced chunks
+  size_t num_chunks = 1;
+  size_t chunk_bytes = data.size();
+  if (data.size() > kSampleBytes) {
+    num_chunks = kNumChunks;
+    chunk_bytes = kSampleBytes / kNumChunks;
+  }
+  uint32_t counts[256] = {};
+  uint32_t seen[size_t{1} << kTableBits] = {};
+  size_t sampled = 0;
+  size_t matches = 0;
+  for (size_t chunk = 0; chunk < num_chunks; ++chunk) {
+    const char* begin = data.data() + chunk * (data.size() / num_chunks);
+    for (size_t i = 0; i < chunk_bytes; ++i) {
+      ++counts[static_cast<unsigned char>(begin[i])];
+      if (i + 4 <= chunk_bytes) {
+        const uint32_t seq = DecodeFixed32(begin + i);
+        const uint32_t slot = (seq * 2654435761u) >> (32 - kTableBits);
+        // Zero marks an empty slot, so a zero sequence never matches
+        if (seq != 0 && seen[slot] == seq) {
+          ++matches;
+        }
+        seen[slot] = seq;
+      }
+    }
+    sampled += chunk_bytes;
+  }
+
+  estimate.entropy_bits = 0.0;
+  for (uint32_t count : counts) {
+    if (count > 0) {
+      const double p = static_cast<double>(count) / sampled;
+      estimate.entropy_bits -= p * std::log2(p);
+    }
+  }
+  estimate.match_fraction = static_cast<double>(matches) / sampled;
+  return estimate;
+}
+
+// Chooses the compression of a data block for
+// CompressionOptions::adaptive_cpu_cost_per_kb, among no compression, a fast
+// compression and `configured`
+CompressionType ChooseAdaptiveCompressionType(const Slice& data,
+                                              CompressionType configured,
+                                              const CompressionOptions& opts) {
+  CompressionType fast = kNoCompression;
+  if (LZ4_Supported()) {
+    fast = kLZ4Compression;
+  } else if (Snappy_Supported()) {
+    fast = kSnappyCompression;
+  }
+
+  const CompressibilityEstimate estimate = EstimateCompressibility(data);
+  const double max_fraction = opts.max_compressed_bytes_per_kb / 1024.0;
+  const double cpu_cost_per_byte = opts.adaptive_cpu_cost_per_kb / 1024.0;
+  CompressionType best = kNoCompression;
+  // Cost per uncompressed byte, in stored bytes
+  double best_cost = 1.0;
+  for (CompressionType candidate : {fast, configured}) {
+    if (candidate == kNoCompression) {
+      continue;
+    }
+    const double fraction = estimate.CompressedFraction(candidate);
+    if (fraction > max_fraction) {
+      continue;
+    }
+    const int level = candidate == configured
+                          ? opts.level
+                          : CompressionOptions::kDefaultCompressionLevel;
+    const double cost =
+        fraction +
+        RelativeCompressionCpuCost(candidate, level) * cpu_cost_per_byte;
+    if (cost < best_cost) {
+      best = candidate;
+      best_cost = cost;
+    }
+  }
+  return best;
+}
+
 }  // namespace
 
 // format_version is the block format as defined in include/rocksdb/table.h
@@ -120,7 +275,8 @@ Slice CompressBlock(const Slice& uncompressed_data, const CompressionInfo& info,
                     CompressionType* type, uint32_t format_version,
                     bool allow_sample, std::string* compressed_output,
                     std::string* sampled_output_fast,
-                    std::string* sampled_output_slow) {
+                    std::string* sampled_output_slow,
+                    CompressionAccelerator* accelerator) {
   assert(type);
   assert(compressed_output);
   assert(compressed_output->empty());
@@ -173,7 +329,7 @@ Slice CompressBlock(const Slice& uncompressed_data, const CompressionInfo& info,
   // or the compression fails etc., just fall back to uncompressed
   if (!CompressData(uncompressed_data, info,
                     GetCompressFormatForVersion(format_version),
-                    compressed_output)) {
+                    compressed_output, accelerator)) {
     *type = kNoCompression;
     return uncompressed_data;
   }
@@ -309,6 +465,12 @@ struct BlockBasedTableBuilder::Rep {
   std::vector<std::unique_ptr<CompressionContext>> compression_ctxs;
   std::vector<std::unique_ptr<UncompressionContext>> verify_ctxs;
   std::unique_ptr<UncompressionDict> verify_dict;
+  // Set with CompressionOptions::train_dict_in_background. Provides the
+  // dictionary and receives samples of the data blocks.
+  CompressionDictManager* compression_dict_manager;
+  // Set with PrepopulateBlockCache::kFlushAndHotCompaction for the output
+  // files of a compaction.
+  HotKeyRanges* hot_key_ranges;
 
   size_t data_begin_offset = 0;
 
@@ -345,11 +507,34 @@ struct BlockBasedTableBuilder::Rep {
       compression_dict_buffer_cache_res_mgr;
   const bool use_delta_encoding_for_index_values;
   std::unique_ptr<FilterBlockBuilder> filter_builder;
+  std::unique_ptr<RangeFilterBuilder> range_filter_builder;
+  std::unique_ptr<KeyAnchorsBuilder> key_anchors_builder;
   OffsetableCacheKey base_cache_key;
   const TableFileCreationReason reason;
 
   BlockHandle pending_handle;  // Handle to add to index block
 
+  // A data block of another table file whose entries are added, see
+  // BeginRawDataBlock()
+  struct PassthroughBlock {
+    std::string maybe_compressed;
+    CompressionType compression_type = kNoCompression;
+    std::string uncompressed;
+  };
+  // next_passthrough_block starts with the next key added. data_block has
+  // the entries added since passthrough_block started.
+  bool has_next_passthrough_block = false;
+  PassthroughBlock next_passthrough_block;
+  bool has_passthrough_block = false;
+  PassthroughBlock passthrough_block;
+
+  // With hot_key_ranges, the user key of the first entry of data_block, and
+  // whether the data block being written and any data block of the file
+  // were inserted into the block cache.
+  std::string data_block_first_key;
+  bool warm_data_block = false;
+  bool warmed_data_block_in_file = false;
+
   std::string compressed_output;
   std::unique_ptr<FlushBlockPolicy> flush_block_policy;
 
@@ -372,6 +557,14 @@ struct BlockBasedTableBuilder::Rep {
     return compression_opts.parallel_threads > 1;
   }
 
+  // Called with the index entry of each data block at pending_handle
+  void AddKeyAnchor(const Slice& last_key_in_block) {
+    if (key_anchors_builder != nullptr) {
+      key_anchors_builder->AddBlock(ExtractUserKey(last_key_in_block),
+                                    pending_handle);
+    }
+  }
+
   Status GetStatus() {
     // We need to make modifications of status visible when status_ok is set
     // to false, and this is ensured by status_mutex, so no special memory
@@ -460,7 +653,10 @@ struct BlockBasedTableBuilder::Rep {
                        ? BlockBasedTableOptions::kDataBlockBinarySearch
                        : table_options.data_block_index_type,
                    table_options.data_block_hash_table_util_ratio, ts_sz,
-                   persist_user_defined_timestamps),
+                   persist_user_defined_timestamps, false /* is_user_key */,
+                   table_options.data_block_restart_key_prefixes &&
+                       tbo.internal_comparator.user_comparator() ==
+                           BytewiseComparator()),
         range_del_block(
             1 /* block_restart_interval */, true /* use_delta_encoding */,
             false /* use_value_delta_encoding */,
@@ -480,12 +676,20 @@ struct BlockBasedTableBuilder::Rep {
         compression_ctxs(tbo.compression_opts.parallel_threads),
         verify_ctxs(tbo.compression_opts.parallel_threads),
         verify_dict(),
+        compression_dict_manager(
+            tbo.compression_opts.train_dict_in_background &&
+                    tbo.compression_opts.max_dict_bytes > 0 &&
+                    tbo.compression_type != kNoCompression
+                ? tbo.compression_dict_manager
+                : nullptr),
+        hot_key_ranges(tbo.hot_key_ranges),
         state((tbo.compression_opts.max_dict_bytes > 0 &&
                tbo.compression_type != kNoCompression)
                   ? State::kBuffered
                   : State::kUnbuffered),
-        use_delta_encoding_for_index_values(table_opt.format_version >= 4 &&
-                                            !table_opt.block_align),
+        use_delta_encoding_for_index_values(
+            table_opt.format_version >= 4 && !table_opt.block_align &&
+            table_opt.index_type != BlockBasedTableOptions::kLearnedSearch),
         reason(tbo.reason),
         flush_block_policy(
             table_options.flush_block_policy_factory->NewFlushBlockPolicy(
@@ -527,6 +731,22 @@ struct BlockBasedTableBuilder::Rep {
       compression_dict_buffer_cache_res_mgr = nullptr;
     }
 
+    if (compression_dict_manager != nullptr) {
+      auto dict =
+          compression_dict_manager->GetDict(compression_type, compression_opts);
+      TEST_SYNC_POINT_CALLBACK("BlockBasedTableBuilder::Rep:SharedDict",
+                               &dict);
+      if (dict != nullptr) {
+        // The dictionary trained in the background replaces the buffering.
+        state = State::kUnbuffered;
+        compression_dict.reset(new CompressionDict(*dict, compression_type,
+                                                   compression_opts.level));
+        verify_dict.reset(new UncompressionDict(
+            *dict, compression_type == kZSTD ||
+                       compression_type == kZSTDNotFinalCompression));
+      }
+    }
+
     assert(compression_ctxs.size() >= compression_opts.parallel_threads);
     for (uint32_t i = 0; i < compression_opts.parallel_threads; i++) {
       compression_ctxs[i].reset(
@@ -576,6 +796,15 @@ struct BlockBasedTableBuilder::Rep {
           use_delta_encoding_for_index_values, p_index_builder_, ts_sz,
           persist_user_defined_timestamps));
     }
+    if (table_options.range_filter_key_width > 0 && !tbo.skip_filters &&
+        ts_sz == 0 &&
+        tbo.internal_comparator.user_comparator() == BytewiseComparator()) {
+      range_filter_builder.reset(
+          new RangeFilterBuilder(table_options.range_filter_key_width));
+    }
+    if (table_options.store_key_anchors) {
+      key_anchors_builder.reset(new KeyAnchorsBuilder());
+    }
 
     assert(tbo.internal_tbl_prop_coll_factories);
     for (auto& factory : *tbo.internal_tbl_prop_coll_factories) {
@@ -1001,7 +1230,22 @@ void BlockBasedTableBuilder::Add(const Slice& key, const Slice& value) {
     }
 #endif  // !NDEBUG
 
-    auto should_flush = r->flush_block_policy->Update(key, value);
+    // Keys reach the range filter in order whether or not data blocks are
+    // buffered or compressed in parallel.
+    if (r->range_filter_builder != nullptr) {
+      r->range_filter_builder->Add(ExtractUserKey(key));
+    }
+
+    bool should_flush;
+    if (r->has_next_passthrough_block) {
+      should_flush = !r->data_block.empty();
+    } else if (r->has_passthrough_block) {
+      // Flush where the block copied ends, even if the entries differ
+      should_flush = r->data_block.CurrentSizeEstimate() >=
+                     r->passthrough_block.uncompressed.size();
+    } else {
+      should_flush = r->flush_block_policy->Update(key, value);
+    }
     if (should_flush) {
       assert(!r->data_block.empty());
       r->first_key_in_next_block = &key;
@@ -1039,12 +1283,19 @@ void BlockBasedTableBuilder::Add(const Slice& key, const Slice& value) {
         if (r->IsParallelCompressionEnabled()) {
           r->pc_rep->curr_block_keys->Clear();
         } else {
+          r->AddKeyAnchor(r->last_key);
           r->index_builder->AddIndexEntry(&r->last_key, &key,
                                           r->pending_handle);
         }
       }
     }
 
+    if (r->has_next_passthrough_block) {
+      std::swap(r->passthrough_block, r->next_passthrough_block);
+      r->has_passthrough_block = true;
+      r->has_next_passthrough_block = false;
+    }
+
     // Note: PartitionedFilterBlockBuilder requires key being added to filter
     // builder after being added to index builder.
     if (r->state == Rep::State::kUnbuffered) {
@@ -1058,6 +1309,10 @@ void BlockBasedTableBuilder::Add(const Slice& key, const Slice& value) {
       }
     }
 
+    if (r->hot_key_ranges != nullptr && r->data_block.empty()) {
+      Slice user_key = ExtractUserKey(key);
+      r->data_block_first_key.assign(user_key.data(), user_key.size());
+    }
     r->data_block.AddWithLastKey(key, value, r->last_key);
     r->last_key.assign(key.data(), key.size());
     if (r->state == Rep::State::kBuffered) {
@@ -1122,20 +1377,76 @@ void BlockBasedTableBuilder::Flush() {
   if (r->data_block.empty()) {
     return;
   }
+  // Blocks compressed in parallel or buffered for the dictionary are not
+  // warmed, nor counted against the budget.
+  if (r->hot_key_ranges != nullptr && !r->IsParallelCompressionEnabled() &&
+      r->state == Rep::State::kUnbuffered) {
+    r->warm_data_block =
+        r->hot_key_ranges->Overlaps(r->data_block_first_key,
+                                    ExtractUserKey(r->last_key)) &&
+        r->hot_key_ranges->TryConsume(r->data_block.CurrentSizeEstimate());
+  }
   if (r->IsParallelCompressionEnabled() &&
       r->state == Rep::State::kUnbuffered) {
-    r->data_block.Finish();
+    Slice raw_block = r->data_block.Finish();
+    if (r->compression_dict_manager != nullptr) {
+      r->compression_dict_manager->AddSample(r->compression_type,
+                                             r->compression_opts, raw_block);
+    }
     ParallelCompressionRep::BlockRep* block_rep = r->pc_rep->PrepareBlock(
         r->compression_type, r->first_key_in_next_block, &(r->data_block));
     assert(block_rep != nullptr);
     r->pc_rep->file_size_estimator.EmitBlock(block_rep->data->size(),
                                              r->get_offset());
     r->pc_rep->EmitBlock(block_rep);
+  } else if (r->has_passthrough_block) {
+    r->has_passthrough_block = false;
+    r->data_block.Finish();
+    std::string uncompressed_block_data;
+    r->data_block.SwapAndReset(uncompressed_block_data);
+    if (uncompressed_block_data != r->passthrough_block.uncompressed) {
+      WriteBlock(uncompressed_block_data, &r->pending_handle, BlockType::kData);
+      return;
+    }
+    // The block copied is a valid compression of this one
+    TEST_SYNC_POINT("BlockBasedTableBuilder::Flush:PassthroughBlock");
+    NotifyCollectTableCollectorsOnBlockAdd(r->table_properties_collectors,
+                                           uncompressed_block_data.size(),
+                                           /*block_compressed_bytes_fast=*/0,
+                                           /*block_compressed_bytes_slow=*/0);
+    Slice uncompressed_block(uncompressed_block_data);
+    WriteMaybeCompressedBlock(r->passthrough_block.maybe_compressed,
+                              r->passthrough_block.compression_type,
+                              &r->pending_handle, BlockType::kData,
+                              &uncompressed_block);
+    r->props.data_size = r->get_offset();
+    ++r->props.num_data_blocks;
   } else {
     WriteBlock(&r->data_block, &r->pending_handle, BlockType::kData);
   }
 }
 
+bool BlockBasedTableBuilder::BeginRawDataBlock(const RawDataBlock& block) {
+  Rep* r = rep_;
+  assert(rep_->state != Rep::State::kClosed);
+  if (!ok() || !r->table_options.compaction_block_passthrough ||
+      r->state != Rep::State::kUnbuffered ||
+      r->IsParallelCompressionEnabled() || r->compression_dict != nullptr ||
+      block.compression_type != r->compression_type ||
+      GetCompressFormatForVersion(block.format_version) !=
+          GetCompressFormatForVersion(r->table_options.format_version)) {
+    return false;
+  }
+  Rep::PassthroughBlock& next = r->next_passthrough_block;
+  next.maybe_compressed.assign(block.maybe_compressed.data(),
+                               block.maybe_compressed.size());
+  next.compression_type = block.compression_type;
+  next.uncompressed.assign(block.uncompressed.data(),
+                           block.uncompressed.size());
+  r->has_next_passthrough_block = true;
+  return true;
+}
+
 void BlockBasedTableBuilder::WriteBlock(BlockBuilder* block,
                                         BlockHandle* handle,
                                         BlockType block_type) {
@@ -1161,6 +1472,10 @@ void BlockBasedTableBuilder::WriteBlock(const Slice& uncompressed_block_data,
   CompressionType type;
   Status compress_status;
   bool is_data_block = block_type == BlockType::kData;
+  if (is_data_block && r->compression_dict_manager != nullptr) {
+    r->compression_dict_manager->AddSample(
+        r->compression_type, r->compression_opts, uncompressed_block_data);
+  }
   CompressAndVerifyBlock(uncompressed_block_data, is_data_block,
                          *(r->compression_ctxs[0]), r->verify_ctxs[0].get(),
                          &(r->compressed_output), &(block_contents), &type,
@@ -1212,6 +1527,7 @@ void BlockBasedTableBuilder::CompressAndVerifyBlock(
     StopWatchNano timer(
         r->ioptions.clock,
         ShouldReportDetailedTime(r->ioptions.env, r->ioptions.stats));
+    PERF_TIMER_GUARD(block_compress_time);
 
     if (is_data_block) {
       r->compressible_input_data_bytes.fetch_add(uncompressed_block_data.size(),
@@ -1224,8 +1540,18 @@ void BlockBasedTableBuilder::CompressAndVerifyBlock(
       compression_dict = r->compression_dict.get();
     }
     assert(compression_dict != nullptr);
+    CompressionType compression_type = r->compression_type;
+    if (is_data_block && r->compression_dict == nullptr &&
+        r->compression_opts.adaptive_cpu_cost_per_kb > 0 &&
+        compression_type != kNoCompression) {
+      compression_type = ChooseAdaptiveCompressionType(
+          uncompressed_block_data, compression_type, r->compression_opts);
+      TEST_SYNC_POINT_CALLBACK(
+          "BlockBasedTableBuilder::CompressAndVerifyBlock:AdaptiveType",
+          &compression_type);
+    }
     CompressionInfo compression_info(r->compression_opts, compression_ctx,
-                                     *compression_dict, r->compression_type,
+                                     *compression_dict, compression_type,
                                      r->sample_for_compression);
 
     std::string sampled_output_fast;
@@ -1233,7 +1559,8 @@ void BlockBasedTableBuilder::CompressAndVerifyBlock(
     *block_contents = CompressBlock(
         uncompressed_block_data, compression_info, type,
         r->table_options.format_version, is_data_block /* allow_sample */,
-        compressed_output, &sampled_output_fast, &sampled_output_slow);
+        compressed_output, &sampled_output_fast, &sampled_output_slow,
+        r->ioptions.compression_accelerator.get());
 
     if (sampled_output_slow.size() > 0 || sampled_output_fast.size() > 0) {
       // Currently compression sampling is only enabled for data block.
@@ -1263,8 +1590,7 @@ void BlockBasedTableBuilder::CompressAndVerifyBlock(
       }
       assert(verify_dict != nullptr);
       BlockContents contents;
-      UncompressionInfo uncompression_info(*verify_ctx, *verify_dict,
-                                           r->compression_type);
+      UncompressionInfo uncompression_info(*verify_ctx, *verify_dict, *type);
       Status uncompress_status = UncompressBlockData(
           uncompression_info, block_contents->data(), block_contents->size(),
           &contents, r->table_options.format_version, r->ioptions);
@@ -1362,9 +1688,14 @@ void BlockBasedTableBuilder::WriteMaybeCompressedBlock(
 
   std::array<char, kBlockTrailerSize> trailer;
   trailer[0] = comp_type;
-  uint32_t checksum = ComputeBuiltinChecksumWithLastByte(
-      r->table_options.checksum, block_contents.data(), block_contents.size(),
-      /*last_byte*/ comp_type);
+  uint32_t checksum;
+  {
+    PERF_TIMER_GUARD(block_checksum_time);
+    checksum = ComputeBuiltinChecksumWithLastByte(
+        r->table_options.checksum, block_contents.data(),
+        block_contents.size(),
+        /*last_byte*/ comp_type);
+  }
   checksum += ChecksumModifierForContext(r->base_context_checksum, offset);
 
   if (block_type == BlockType::kFilter) {
@@ -1393,6 +1724,15 @@ void BlockBasedTableBuilder::WriteMaybeCompressedBlock(
       case BlockBasedTableOptions::PrepopulateBlockCache::kFlushOnly:
         warm_cache = (r->reason == TableFileCreationReason::kFlush);
         break;
+      case BlockBasedTableOptions::PrepopulateBlockCache::
+          kFlushAndHotCompaction:
+        // The other blocks of a compaction output are warmed if any of its
+        // data blocks was
+        warm_cache = r->reason == TableFileCreationReason::kFlush ||
+                     (r->reason == TableFileCreationReason::kCompaction &&
+                      (is_data_block ? r->warm_data_block
+                                     : r->warmed_data_block_in_file));
+        break;
       case BlockBasedTableOptions::PrepopulateBlockCache::kDisable:
         warm_cache = false;
         break;
@@ -1408,6 +1748,12 @@ void BlockBasedTableBuilder::WriteMaybeCompressedBlock(
         r->SetStatus(s);
         return;
       }
+      if (is_data_block) {
+        r->warmed_data_block_in_file = true;
+      }
+    }
+    if (is_data_block && r->warm_data_block) {
+      r->warm_data_block = false;
     }
   }
 
@@ -1474,6 +1820,7 @@ void BlockBasedTableBuilder::BGWorkWriteMaybeCompressedBlock() {
     r->props.data_size = r->get_offset();
     ++r->props.num_data_blocks;
 
+    r->AddKeyAnchor(block_rep->keys->Back());
     if (block_rep->first_key_in_next_block == nullptr) {
       r->index_builder->AddIndexEntry(&(block_rep->keys->Back()), nullptr,
                                       r->pending_handle);
@@ -1808,6 +2155,30 @@ void BlockBasedTableBuilder::WriteRangeDelBlock(
   }
 }
 
+void BlockBasedTableBuilder::WriteRangeFilterBlock(
+    MetaIndexBuilder* meta_index_builder) {
+  if (ok() && rep_->range_filter_builder != nullptr &&
+      !rep_->range_filter_builder->IsEmpty()) {
+    BlockHandle range_filter_block_handle;
+    WriteMaybeCompressedBlock(rep_->range_filter_builder->Finish(),
+                              kNoCompression, &range_filter_block_handle,
+                              BlockType::kRangeFilter);
+    meta_index_builder->Add(kRangeFilterBlockName, range_filter_block_handle);
+  }
+}
+
+void BlockBasedTableBuilder::WriteKeyAnchorsBlock(
+    MetaIndexBuilder* meta_index_builder) {
+  if (ok() && rep_->key_anchors_builder != nullptr &&
+      !rep_->key_anchors_builder->IsEmpty()) {
+    BlockHandle key_anchors_block_handle;
+    WriteMaybeCompressedBlock(rep_->key_anchors_builder->Finish(),
+                              kNoCompression, &key_anchors_block_handle,
+                              BlockType::kKeyAnchors);
+    meta_index_builder->Add(kKeyAnchorsBlockName, key_anchors_block_handle);
+  }
+}
+
 void BlockBasedTableBuilder::WriteFooter(BlockHandle& metaindex_block_handle,
                                          BlockHandle& index_block_handle) {
   assert(ok());
@@ -1904,6 +2275,11 @@ void BlockBasedTableBuilder::EnterUnbuffered() {
   } else {
     dict = std::move(compression_dict_samples);
   }
+  if (r->compression_dict_manager != nullptr) {
+    // The next files use this dictionary until one is trained.
+    r->compression_dict_manager->SetDictIfMissing(r->compression_type,
+                                                  r->compression_opts, dict);
+  }
   r->compression_dict.reset(new CompressionDict(dict, r->compression_type,
                                                 r->compression_opts.level));
   r->verify_dict.reset(new UncompressionDict(
@@ -1978,6 +2354,7 @@ void BlockBasedTableBuilder::EnterUnbuffered() {
 
         iter->SeekToLast();
         std::string last_key = iter->key().ToString();
+        r->AddKeyAnchor(last_key);
         r->index_builder->AddIndexEntry(&last_key, first_key_in_next_block_ptr,
                                         r->pending_handle);
       }
@@ -2014,6 +2391,7 @@ Status BlockBasedTableBuilder::Finish() {
     // To make sure properties block is able to keep the accurate size of index
     // block, we will finish writing all index entries first.
     if (ok() && !empty_data_block) {
+      r->AddKeyAnchor(r->last_key);
       r->index_builder->AddIndexEntry(
           &r->last_key, nullptr /* no next data block */, r->pending_handle);
     }
@@ -2026,15 +2404,19 @@ Status BlockBasedTableBuilder::Finish() {
   //    2. [meta block: index]
   //    3. [meta block: compression dictionary]
   //    4. [meta block: range deletion tombstone]
-  //    5. [meta block: properties]
-  //    6. [metaindex block]
-  //    7. Footer
+  //    5. [meta block: range filter]
+  //    6. [meta block: key anchors]
+  //    7. [meta block: properties]
+  //    8. [metaindex block]
+  //    9. Footer
   BlockHandle metaindex_block_handle, index_block_handle;
   MetaIndexBuilder meta_index_builder;
   WriteFilterBlock(&meta_index_builder);
   WriteIndexBlock(&meta_index_builder, &index_block_handle);
   WriteCompressionDictBlock(&meta_index_builder);
   WriteRangeDelBlock(&meta_index_builder);
+  WriteRangeFilterBlock(&meta_index_builder);
+  WriteKeyAnchorsBlock(&meta_index_builder);
   WritePropertiesBlock(&meta_index_builder);
   if (ok()) {
     // flush the meta index block
@@ -59,6 +59,8 @@ class BlockBasedTableBuilder : public TableBuilder {
   // REQUIRES: Finish(), Abandon() have not been called
   void Add(const Slice& key, const Slice& value) override;
 
+  bool BeginRawDataBlock(const RawDataBlock& block) override;
+
   // Return non-ok iff some error has been detected.
   Status status() const override;
 
@@ -151,6 +153,8 @@ class BlockBasedTableBuilder : public TableBuilder {
   void WritePropertiesBlock(MetaIndexBuilder* meta_index_builder);
   void WriteCompressionDictBlock(MetaIndexBuilder* meta_index_builder);
   void WriteRangeDelBlock(MetaIndexBuilder* meta_index_builder);
+  void WriteRangeFilterBlock(MetaIndexBuilder* meta_index_builder);
+  void WriteKeyAnchorsBlock(MetaIndexBuilder* meta_index_builder);
   void WriteFooter(BlockHandle& metaindex_block_handle,
                    BlockHandle& index_block_handle);
 
@@ -203,6 +207,7 @@ Slice CompressBlock(const Slice& uncompressed_data, const CompressionInfo& info,
                     CompressionType* type, uint32_t format_version,
                     bool do_sample, std::string* compressed_output,
                     std::string* sampled_output_fast,
-                    std::string* sampled_output_slow);
+                    std::string* sampled_output_slow,
+                    CompressionAccelerator* accelerator = nullptr);
 
 }  // namespace ROCKSDB_NAMESPACE
@@ -181,7 +181,8 @@ static std::unordered_map<std::string, BlockBasedTableOptions::IndexType>
         {"kTwoLevelIndexSearch",
          BlockBasedTableOptions::IndexType::kTwoLevelIndexSearch},
         {"kBinarySearchWithFirstKey",
-         BlockBasedTableOptions::IndexType::kBinarySearchWithFirstKey}};
+         BlockBasedTableOptions::IndexType::kBinarySearchWithFirstKey},
+        {"kLearnedSearch", BlockBasedTableOptions::IndexType::kLearnedSearch}};
 
 static std::unordered_map<std::string,
                           BlockBasedTableOptions::DataBlockIndexType>
@@ -189,7 +190,10 @@ static std::unordered_map<std::string,
         {"kDataBlockBinarySearch",
          BlockBasedTableOptions::DataBlockIndexType::kDataBlockBinarySearch},
         {"kDataBlockBinaryAndHash",
-         BlockBasedTableOptions::DataBlockIndexType::kDataBlockBinaryAndHash}};
+         BlockBasedTableOptions::DataBlockIndexType::kDataBlockBinaryAndHash},
+        {"kDataBlockBinaryAndBlockedHash",
+         BlockBasedTableOptions::DataBlockIndexType::
+             kDataBlockBinaryAndBlockedHash}};
 
 static std::unordered_map<std::string,
                           BlockBasedTableOptions::IndexShorteningMode>
@@ -222,7 +226,10 @@ static std::unordered_map<std::string,
     block_base_table_prepopulate_block_cache_string_map = {
         {"kDisable", BlockBasedTableOptions::PrepopulateBlockCache::kDisable},
         {"kFlushOnly",
-         BlockBasedTableOptions::PrepopulateBlockCache::kFlushOnly}};
+         BlockBasedTableOptions::PrepopulateBlockCache::kFlushOnly},
+        {"kFlushAndHotCompaction",
+         BlockBasedTableOptions::PrepopulateBlockCache::
+             kFlushAndHotCompaction}};
 
 static std::unordered_map<std::string, OptionTypeInfo>
     block_based_table_type_info = {
@@ -269,6 +276,11 @@ static std::unordered_map<std::string, OptionTypeInfo>
                    data_block_hash_table_util_ratio),
           OptionType::kDouble, OptionVerificationType::kNormal,
           OptionTypeFlags::kNone}},
+        {"data_block_restart_key_prefixes",
+         {offsetof(struct BlockBasedTableOptions,
+                   data_block_restart_key_prefixes),
+          OptionType::kBoolean, OptionVerificationType::kNormal,
+          OptionTypeFlags::kNone}},
         {"checksum",
          {offsetof(struct BlockBasedTableOptions, checksum),
           OptionType::kChecksumType, OptionVerificationType::kNormal,
@@ -277,6 +289,11 @@ static std::unordered_map<std::string, OptionTypeInfo>
          {offsetof(struct BlockBasedTableOptions, no_block_cache),
           OptionType::kBoolean, OptionVerificationType::kNormal,
           OptionTypeFlags::kNone}},
+        {"cache_keys_from_file_unique_id",
+         {offsetof(struct BlockBasedTableOptions,
+                   cache_keys_from_file_unique_id),
+          OptionType::kBoolean, OptionVerificationType::kNormal,
+          OptionTypeFlags::kNone}},
         {"block_size",
          {offsetof(struct BlockBasedTableOptions, block_size),
           OptionType::kSizeT, OptionVerificationType::kNormal,
@@ -321,6 +338,10 @@ static std::unordered_map<std::string, OptionTypeInfo>
          {offsetof(struct BlockBasedTableOptions, whole_key_filtering),
           OptionType::kBoolean, OptionVerificationType::kNormal,
           OptionTypeFlags::kNone}},
+        {"range_filter_key_width",
+         {offsetof(struct BlockBasedTableOptions, range_filter_key_width),
+          OptionType::kUInt32T, OptionVerificationType::kNormal,
+          OptionTypeFlags::kNone}},
         {"detect_filter_construct_corruption",
          {offsetof(struct BlockBasedTableOptions,
                    detect_filter_construct_corruption),
@@ -403,6 +424,11 @@ static std::unordered_map<std::string, OptionTypeInfo>
              offsetof(struct BlockBasedTableOptions, prepopulate_block_cache),
              &block_base_table_prepopulate_block_cache_string_map,
              OptionTypeFlags::kMutable)},
+        {"prepopulate_block_cache_compaction_budget",
+         {offsetof(struct BlockBasedTableOptions,
+                   prepopulate_block_cache_compaction_budget),
+          OptionType::kUInt64T, OptionVerificationType::kNormal,
+          OptionTypeFlags::kMutable}},
         {"initial_auto_readahead_size",
          {offsetof(struct BlockBasedTableOptions, initial_auto_readahead_size),
           OptionType::kSizeT, OptionVerificationType::kNormal,
@@ -412,6 +438,24 @@ static std::unordered_map<std::string, OptionTypeInfo>
                    num_file_reads_for_auto_readahead),
           OptionType::kUInt64T, OptionVerificationType::kNormal,
           OptionTypeFlags::kMutable}},
+        {"learn_auto_readahead_size",
+         {offsetof(struct BlockBasedTableOptions, learn_auto_readahead_size),
+          OptionType::kBoolean, OptionVerificationType::kNormal,
+          OptionTypeFlags::kMutable}},
+        {"compaction_decompression_threads",
+         {offsetof(struct BlockBasedTableOptions,
+                   compaction_decompression_threads),
+          OptionType::kUInt32T, OptionVerificationType::kNormal,
+          OptionTypeFlags::kMutable}},
+        {"compaction_block_passthrough",
+         {offsetof(struct BlockBasedTableOptions,
+                   compaction_block_passthrough),
+          OptionType::kBoolean, OptionVerificationType::kNormal,
+          OptionTypeFlags::kMutable}},
+        {"store_key_anchors",
+         {offsetof(struct BlockBasedTableOptions, store_key_anchors),
+          OptionType::kBoolean, OptionVerificationType::kNormal,
+          OptionTypeFlags::kMutable}},
 
 };
 
@@ -628,12 +672,12 @@ Status BlockBasedTableFactory::ValidateOptions(
     return Status::InvalidArgument(
         "block size exceeds maximum number (4GiB) allowed");
   }
-  if (table_options_.data_block_index_type ==
-          BlockBasedTableOptions::kDataBlockBinaryAndHash &&
+  if (table_options_.data_block_index_type !=
+          BlockBasedTableOptions::kDataBlockBinarySearch &&
       table_options_.data_block_hash_table_util_ratio <= 0) {
     return Status::InvalidArgument(
         "data_block_hash_table_util_ratio should be greater than 0 when "
-        "data_block_index_type is set to kDataBlockBinaryAndHash");
+        "data_block_index_type has a hash index");
   }
   if (db_opts.unordered_write && cf_opts.max_successive_merges > 0) {
     // TODO(myabandeh): support it
@@ -754,11 +798,17 @@ std::string BlockBasedTableFactory::GetPrintableOptions() const {
   snprintf(buffer, kBufferSize, "  data_block_hash_table_util_ratio: %lf\n",
            table_options_.data_block_hash_table_util_ratio);
   ret.append(buffer);
+  snprintf(buffer, kBufferSize, "  data_block_restart_key_prefixes: %d\n",
+           table_options_.data_block_restart_key_prefixes);
+  ret.append(buffer);
   snprintf(buffer, kBufferSize, "  checksum: %d\n", table_options_.checksum);
   ret.append(buffer);
   snprintf(buffer, kBufferSize, "  no_block_cache: %d\n",
            table_options_.no_block_cache);
   ret.append(buffer);
+  snprintf(buffer, kBufferSize, "  cache_keys_from_file_unique_id: %d\n",
+           table_options_.cache_keys_from_file_unique_id);
+  ret.append(buffer);
   snprintf(buffer, kBufferSize, "  block_cache: %p\n",
            static_cast<void*>(table_options_.block_cache.get()));
   ret.append(buffer);
@@ -809,6 +859,9 @@ std::string BlockBasedTableFactory::GetPrintableOptions() const {
   snprintf(buffer, kBufferSize, "  whole_key_filtering: %d\n",
            table_options_.whole_key_filtering);
   ret.append(buffer);
+  snprintf(buffer, kBufferSize, "  range_filter_key_width: %u\n",
+           table_options_.range_filter_key_width);
+  ret.append(buffer);
   snprintf(buffer, kBufferSize, "  verify_compression: %d\n",
            table_options_.verify_compression);
   ret.append(buffer);
@@ -831,6 +884,10 @@ std::string BlockBasedTableFactory::GetPrintableOptions() const {
   snprintf(buffer, kBufferSize, "  prepopulate_block_cache: %d\n",
            static_cast<int>(table_options_.prepopulate_block_cache));
   ret.append(buffer);
+  snprintf(buffer, kBufferSize,
+           "  prepopulate_block_cache_compaction_budget: %" PRIu64 "\n",
+           table_options_.prepopulate_block_cache_compaction_budget);
+  ret.append(buffer);
   snprintf(buffer, kBufferSize,
            "  initial_auto_readahead_size: %" ROCKSDB_PRIszt "\n",
            table_options_.initial_auto_readahead_size);
@@ -839,6 +896,18 @@ std::string BlockBasedTableFactory::GetPrintableOptions() const {
            "  num_file_reads_for_auto_readahead: %" PRIu64 "\n",
            table_options_.num_file_reads_for_auto_readahead);
   ret.append(buffer);
+  snprintf(buffer, kBufferSize, "  learn_auto_readahead_size: %d\n",
+           table_options_.learn_auto_readahead_size);
+  ret.append(buffer);
+  snprintf(buffer, kBufferSize, "  compaction_decompression_threads: %u\n",
+           table_options_.compaction_decompression_threads);
+  ret.append(buffer);
+  snprintf(buffer, kBufferSize, "  compaction_block_passthrough: %d\n",
+           table_options_.compaction_block_passthrough);
+  ret.append(buffer);
+  snprintf(buffer, kBufferSize, "  store_key_anchors: %d\n",
+           table_options_.store_key_anchors);
+  ret.append(buffer);
   return ret;
 }
 
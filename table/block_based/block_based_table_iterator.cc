@@ -8,6 +8,8 @@
 // found in the LICENSE file. See the AUTHORS file for names of contributors.
 #include "table/block_based/block_based_table_iterator.h"
 
+#include "table/block_fetcher.h"
+
 namespace ROCKSDB_NAMESPACE {
 
 void BlockBasedTableIterator::SeekToFirst() { SeekImpl(nullptr, false); }
@@ -43,6 +45,8 @@ void BlockBasedTableIterator::SeekImpl(const Slice* target,
   }
 
   ResetBlockCacheLookupVar();
+  RecordScanBytes();
+  block_prefetcher_.AbortAsyncReadahead();
 
   bool autotune_readaheadsize = is_first_pass &&
                                 read_options_.auto_readahead_size &&
@@ -72,6 +76,19 @@ void BlockBasedTableIterator::SeekImpl(const Slice* target,
                                             ? LAST_LEVEL_SEEK_FILTER_MATCH
                                             : NON_LAST_LEVEL_SEEK_FILTER_MATCH);
   }
+  bool beyond_upper = false;
+  if (!table_->RangeFilterMayMatch(target, read_options_, &beyond_upper)) {
+    // No key of the table is in the range of the scan, so the index and data
+    // blocks are not read. If the table has keys after the upper bound,
+    // report it as out of bound so that LevelIterator does not move on to
+    // the next file.
+    ResetDataIter();
+    is_out_of_bound_ = beyond_upper;
+    RecordTick(table_->GetStatistics(), is_last_level_
+                                            ? LAST_LEVEL_SEEK_FILTERED
+                                            : NON_LAST_LEVEL_SEEK_FILTERED);
+    return;
+  }
 
   bool need_seek_index = true;
 
@@ -107,6 +124,9 @@ void BlockBasedTableIterator::SeekImpl(const Slice* target,
     } else {
       index_iter_->SeekToFirst();
     }
+    if (decompression_pipeline_) {
+      decompression_pipeline_->Seek(target);
+    }
     is_index_at_curr_block_ = true;
     if (!index_iter_->Valid()) {
       ResetDataIter();
@@ -172,6 +192,7 @@ void BlockBasedTableIterator::SeekImpl(const Slice* target,
 void BlockBasedTableIterator::SeekForPrev(const Slice& target) {
   direction_ = IterDirection::kBackward;
   ResetBlockCacheLookupVar();
+  RecordScanBytes();
   is_out_of_bound_ = false;
   is_at_first_key_from_index_ = false;
   seek_stat_state_ = kNone;
@@ -246,6 +267,7 @@ void BlockBasedTableIterator::SeekForPrev(const Slice& target) {
 void BlockBasedTableIterator::SeekToLast() {
   direction_ = IterDirection::kBackward;
   ResetBlockCacheLookupVar();
+  RecordScanBytes();
   is_out_of_bound_ = false;
   is_at_first_key_from_index_ = false;
   seek_stat_state_ = kNone;
@@ -332,6 +354,41 @@ void BlockBasedTableIterator::Prev() {
   FindKeyBackward();
 }
 
+bool BlockBasedTableIterator::IsAtDataBlockStart(Slice* block_upper_bound) {
+  const BlockBasedTable::Rep* rep = table_->get_rep();
+  // Blocks compressed with a dictionary or read with a global seqno cannot
+  // be copied as is
+  if (lookup_context_.caller != TableReaderCaller::kCompaction || !Valid() ||
+      !block_iter_points_to_real_block_ || DoesContainBlockHandles() ||
+      !block_iter_.IsAtFirstEntry() || rep->uncompression_dict_reader ||
+      rep->global_seqno != kDisableGlobalSequenceNumber) {
+    return false;
+  }
+  *block_upper_bound = index_iter_->user_key();
+  return true;
+}
+
+Status BlockBasedTableIterator::GetRawDataBlock(RawDataBlock* block) {
+  assert(block_iter_.IsAtFirstEntry());
+  const BlockBasedTable::Rep* rep = table_->get_rep();
+  // The block was most likely just read through the prefetch buffer
+  BlockFetcher block_fetcher(
+      rep->file.get(), block_prefetcher_.prefetch_buffer(), rep->footer,
+      read_options_, index_iter_->value().handle, &raw_block_, rep->ioptions,
+      /*do_uncompress=*/false, /*maybe_compressed=*/true, BlockType::kData,
+      UncompressionDict::GetEmptyDict(), rep->persistent_cache_options,
+      GetMemoryAllocator(rep->table_options), nullptr,
+      /*for_compaction=*/true);
+  Status s = block_fetcher.ReadBlockContents();
+  if (s.ok()) {
+    block->maybe_compressed = raw_block_.data;
+    block->compression_type = block_fetcher.get_compression_type();
+    block->format_version = rep->footer.format_version();
+    block->uncompressed = block_iter_.block_data();
+  }
+  return s;
+}
+
 void BlockBasedTableIterator::InitDataBlock() {
   BlockHandle data_block_handle;
   bool is_in_cache = false;
@@ -355,14 +412,24 @@ void BlockBasedTableIterator::InitDataBlock() {
 
     bool is_for_compaction =
         lookup_context_.caller == TableReaderCaller::kCompaction;
+    if (!is_for_compaction) {
+      scan_bytes_ += BlockBasedTable::BlockSizeWithTrailer(data_block_handle);
+    }
 
     // Initialize Data Block From CacheableEntry.
+    CachableEntry<Block> block;
+    Status s;
     if (is_in_cache) {
-      Status s;
       block_iter_.Invalidate(Status::OK());
       table_->NewDataBlockIterator<DataBlockIter>(
           read_options_, (block_handles_.front().cachable_entry_).As<Block>(),
           &block_iter_, s);
+    } else if (decompression_pipeline_ && !DoesContainBlockHandles() &&
+               decompression_pipeline_->GetBlock(data_block_handle, &block,
+                                                 &s)) {
+      block_iter_.Invalidate(Status::OK());
+      table_->NewDataBlockIterator<DataBlockIter>(read_options_, block,
+                                                  &block_iter_, s);
     } else {
       auto* rep = table_->get_rep();
 
@@ -387,7 +454,6 @@ void BlockBasedTableIterator::InitDataBlock() {
           /*no_sequential_checking=*/false, read_options_, readaheadsize_cb,
           read_options_.async_io);
 
-      Status s;
       table_->NewDataBlockIterator<DataBlockIter>(
           read_options_, data_block_handle, &block_iter_, BlockType::kData,
           /*get_context=*/nullptr, &lookup_context_,
@@ -422,6 +488,10 @@ void BlockBasedTableIterator::AsyncInitDataBlock(bool is_first_pass) {
       if (block_iter_points_to_real_block_) {
         ResetDataIter();
       }
+      if (!is_for_compaction) {
+        scan_bytes_ +=
+            BlockBasedTable::BlockSizeWithTrailer(data_block_handle);
+      }
       auto* rep = table_->get_rep();
 
       std::function<void(bool, uint64_t&, uint64_t&)> readaheadsize_cb =
@@ -12,6 +12,7 @@
 #include "db/seqno_to_time_mapping.h"
 #include "table/block_based/block_based_table_reader.h"
 #include "table/block_based/block_based_table_reader_impl.h"
+#include "table/block_based/block_decompression_pipeline.h"
 #include "table/block_based/block_prefetcher.h"
 #include "table/block_based/reader_common.h"
 
@@ -37,9 +38,8 @@ class BlockBasedTableIterator : public InternalIteratorBase<Slice> {
         pinned_iters_mgr_(nullptr),
         prefix_extractor_(prefix_extractor),
         lookup_context_(caller),
-        block_prefetcher_(
-            compaction_readahead_size,
-            table_->get_rep()->table_options.initial_auto_readahead_size),
+        block_prefetcher_(compaction_readahead_size,
+                          table_->get_rep()->GetInitialAutoReadaheadSize()),
         allow_unprepared_value_(allow_unprepared_value),
         block_iter_points_to_real_block_(false),
         check_filter_(check_filter),
@@ -47,9 +47,18 @@ class BlockBasedTableIterator : public InternalIteratorBase<Slice> {
         async_read_in_progress_(false),
         is_last_level_(table->IsLastLevel()) {}
 
-  ~BlockBasedTableIterator() override { ClearBlockHandles(); }
+  ~BlockBasedTableIterator() override {
+    RecordScanBytes();
+    ClearBlockHandles();
+  }
 
   void Seek(const Slice& target) override;
+  void StartSeek(const Slice& target) override {
+    if (read_options_.async_io && !async_read_in_progress_) {
+      // Returns once the read of the data block is submitted
+      Seek(target);
+    }
+  }
   void SeekForPrev(const Slice& target) override;
   void SeekToFirst() override;
   void SeekToLast() override;
@@ -222,10 +231,24 @@ class BlockBasedTableIterator : public InternalIteratorBase<Slice> {
     }
   }
 
+  void SetPrefetchScheduler(
+      ScanPrefetchScheduler* prefetch_scheduler) override {
+    block_prefetcher_.SetPrefetchScheduler(prefetch_scheduler);
+  }
+
   FilePrefetchBuffer* prefetch_buffer() {
     return block_prefetcher_.prefetch_buffer();
   }
 
+  bool IsAtDataBlockStart(Slice* block_upper_bound) override;
+  Status GetRawDataBlock(RawDataBlock* block) override;
+
+  // Makes the iterator take the data blocks read ahead by `pipeline`
+  void SetDecompressionPipeline(
+      std::unique_ptr<BlockDecompressionPipeline>&& pipeline) {
+    decompression_pipeline_ = std::move(pipeline);
+  }
+
   std::unique_ptr<InternalIteratorBase<IndexValue>> index_iter_;
 
  private:
@@ -296,6 +319,15 @@ class BlockBasedTableIterator : public InternalIteratorBase<Slice> {
 
   bool IsIndexAtCurr() const { return is_index_at_curr_block_; }
 
+  // Reports the data bytes read since the last seek to the table, which
+  // learns the auto-readahead size from them.
+  void RecordScanBytes() {
+    if (scan_bytes_ > 0) {
+      table_->get_rep()->RecordScanBytes(scan_bytes_);
+      scan_bytes_ = 0;
+    }
+  }
+
   const BlockBasedTable* table_;
   const ReadOptions& read_options_;
   const InternalKeyComparator& icomp_;
@@ -307,6 +339,11 @@ class BlockBasedTableIterator : public InternalIteratorBase<Slice> {
   BlockCacheLookupContext lookup_context_;
 
   BlockPrefetcher block_prefetcher_;
+  // Set for compactions with
+  // BlockBasedTableOptions::compaction_decompression_threads > 0
+  std::unique_ptr<BlockDecompressionPipeline> decompression_pipeline_;
+  // The block read by GetRawDataBlock()
+  BlockContents raw_block_;
 
   const bool allow_unprepared_value_;
   // True if block_iter_ is initialized and points to the same block
@@ -325,6 +362,8 @@ class BlockBasedTableIterator : public InternalIteratorBase<Slice> {
   bool need_upper_bound_check_;
 
   bool async_read_in_progress_;
+  // Data bytes read since the last seek, excluding compaction reads.
+  uint64_t scan_bytes_ = 0;
 
   mutable SeekStatState seek_stat_state_ = SeekStatState::kNone;
   bool is_last_level_;
@@ -29,6 +29,7 @@
 #include "file/file_util.h"
 #include "file/random_access_file_reader.h"
 #include "logging/logging.h"
+#include "monitoring/op_trace_impl.h"
 #include "monitoring/perf_context_imp.h"
 #include "parsed_full_filter_block.h"
 #include "port/lang.h"
@@ -50,12 +51,15 @@
 #include "table/block_based/block.h"
 #include "table/block_based/block_based_table_factory.h"
 #include "table/block_based/block_based_table_iterator.h"
+#include "table/block_based/block_decompression_pipeline.h"
 #include "table/block_based/block_prefix_index.h"
 #include "table/block_based/block_type.h"
 #include "table/block_based/filter_block.h"
 #include "table/block_based/filter_policy_internal.h"
 #include "table/block_based/full_filter_block.h"
 #include "table/block_based/hash_index_reader.h"
+#include "table/block_based/key_anchors.h"
+#include "table/block_based/learned_index_reader.h"
 #include "table/block_based/partitioned_filter_block.h"
 #include "table/block_based/partitioned_index_reader.h"
 #include "table/block_fetcher.h"
@@ -783,8 +787,20 @@ Status BlockBasedTable::Open(
   }
 
   // With properties loaded, we can set up portable/stable cache keys
+  bool stable_cache_key = false;
   SetupBaseCacheKey(rep->table_properties.get(), cur_db_session_id,
-                    cur_file_num, &rep->base_cache_key);
+                    cur_file_num, &rep->base_cache_key, &stable_cache_key);
+  if (!stable_cache_key && table_options.cache_keys_from_file_unique_id) {
+    char unique_id[64];
+    size_t unique_id_len =
+        rep->file->file()->GetUniqueId(unique_id, sizeof(unique_id));
+    if (unique_id_len > 0) {
+      // The id is not a session id, so it is hashed into the key.
+      rep->base_cache_key = OffsetableCacheKey(
+          "" /* db_id */, std::string(unique_id, unique_id_len),
+          0 /* file_number */);
+    }
+  }
 
   rep->persistent_cache_options =
       PersistentCacheOptions(rep->table_options.persistent_cache,
@@ -796,6 +812,21 @@ Status BlockBasedTable::Open(
   if (!s.ok()) {
     return s;
   }
+  s = new_table->ReadRangeFilterBlock(ro, prefetch_buffer.get(),
+                                      metaindex_iter.get());
+  if (!s.ok()) {
+    return s;
+  }
+  // The anchors are only read by compactions, see ApproximateKeyAnchors()
+  s = FindOptionalMetaBlock(metaindex_iter.get(), kKeyAnchorsBlockName,
+                            &rep->key_anchors_handle);
+  if (!s.ok()) {
+    ROCKS_LOG_WARN(rep->ioptions.logger,
+                   "Error when seeking to key anchors block from file: %s",
+                   s.ToString().c_str());
+    rep->key_anchors_handle = BlockHandle::NullBlockHandle();
+    s = Status::OK();
+  }
   rep->verify_checksum_set_on_open = ro.verify_checksums;
   s = new_table->PrefetchIndexAndFilterBlocks(
       ro, prefetch_buffer.get(), metaindex_iter.get(), new_table.get(),
@@ -1048,6 +1079,43 @@ Status BlockBasedTable::ReadRangeDelBlock(
   return s;
 }
 
+Status BlockBasedTable::ReadRangeFilterBlock(
+    const ReadOptions& ro, FilePrefetchBuffer* prefetch_buffer,
+    InternalIterator* meta_iter) {
+  const Comparator* ucmp = rep_->internal_comparator.user_comparator();
+  if (ucmp != BytewiseComparator() || ucmp->timestamp_size() > 0) {
+    // The filter is only built for bytewise ordered keys.
+    return Status::OK();
+  }
+  BlockHandle range_filter_handle;
+  Status s = FindOptionalMetaBlock(meta_iter, kRangeFilterBlockName,
+                                   &range_filter_handle);
+  if (!s.ok()) {
+    ROCKS_LOG_WARN(rep_->ioptions.logger,
+                   "Error when seeking to range filter block from file: %s",
+                   s.ToString().c_str());
+  } else if (!range_filter_handle.IsNull()) {
+    BlockContents contents;
+    s = BlockFetcher(rep_->file.get(), prefetch_buffer, rep_->footer, ro,
+                     range_filter_handle, &contents, rep_->ioptions,
+                     false /* decompress */, false /*maybe_compressed*/,
+                     BlockType::kRangeFilter, UncompressionDict::GetEmptyDict(),
+                     rep_->persistent_cache_options)
+            .ReadBlockContents();
+    if (s.ok()) {
+      s = RangeFilterReader::Create(std::move(contents), &rep_->range_filter);
+    }
+    if (!s.ok()) {
+      ROCKS_LOG_WARN(rep_->ioptions.logger,
+                     "Encountered error while reading data from range filter "
+                     "block %s",
+                     s.ToString().c_str());
+      IGNORE_STATUS_IF_ERROR(s);
+    }
+  }
+  return s;
+}
+
 Status BlockBasedTable::PrefetchIndexAndFilterBlocks(
     const ReadOptions& ro, FilePrefetchBuffer* prefetch_buffer,
     InternalIterator* meta_iter, BlockBasedTable* new_table, bool prefetch_all,
@@ -1281,6 +1349,9 @@ size_t BlockBasedTable::ApproximateMemoryUsage() const {
   if (rep_->uncompression_dict_reader) {
     usage += rep_->uncompression_dict_reader->ApproximateMemoryUsage();
   }
+  if (rep_->range_filter) {
+    usage += rep_->range_filter->ApproximateMemoryUsage();
+  }
   if (rep_->table_properties) {
     usage += rep_->table_properties->ApproximateMemoryUsage();
   }
@@ -1596,6 +1667,7 @@ BlockBasedTable::MaybeReadBlockAndLoadToCache(
 
     if (!contents) {
       if (use_block_cache_for_lookup) {
+        OP_TRACE_SPAN("block_cache_lookup");
         s = GetDataBlockFromCache(key, block_cache, out_parsed_block,
                                   get_context, &uncompression_dict);
         // Value could still be null at this point, so check the cache handle
@@ -1980,6 +2052,10 @@ bool BlockBasedTable::PrefixRangeMayMatch(
   if (filter != nullptr) {
     const bool no_io = read_options.read_tier == kBlockCacheTier;
 
+    if (read_options.async_io && !no_io) {
+      PrefetchPartitions(read_options, internal_key, lookup_context);
+    }
+
     const Slice* const const_ikey_ptr = &internal_key;
     may_match = filter->RangeMayExist(
         read_options.iterate_upper_bound, user_key_without_ts, prefix_extractor,
@@ -1991,6 +2067,138 @@ bool BlockBasedTable::PrefixRangeMayMatch(
   return may_match;
 }
 
+void BlockBasedTable::PrefetchPartitions(
+    const ReadOptions& read_options, const Slice& internal_key,
+    BlockCacheLookupContext* lookup_context) const {
+  Cache* const block_cache = rep_->table_options.block_cache.get();
+  if (block_cache == nullptr || !read_options.fill_cache ||
+      rep_->ioptions.allow_mmap_reads || rep_->index_reader == nullptr ||
+      rep_->filter == nullptr) {
+    return;
+  }
+
+  // The filter partition lookup is resolved first since the top-level filter
+  // block may have to be read. The top-level index block is only used if it
+  // is already in memory.
+  const BlockHandle filter_handle = rep_->filter->GetPartitionHandle(
+      read_options, internal_key, lookup_context);
+  if (filter_handle.IsNull()) {
+    return;
+  }
+  const BlockHandle index_handle = rep_->index_reader->GetPartitionHandle(
+      read_options, internal_key, lookup_context);
+  if (index_handle.IsNull()) {
+    return;
+  }
+
+  // Nothing is gained over the dependent reads if one of the partitions is
+  // already cached
+  for (const BlockHandle* handle : {&filter_handle, &index_handle}) {
+    CacheKey key_data = GetCacheKey(rep_->base_cache_key, *handle);
+    Cache::Handle* cache_handle = block_cache->Lookup(key_data.AsSlice());
+    if (cache_handle != nullptr) {
+      block_cache->Release(cache_handle);
+      return;
+    }
+  }
+  TEST_SYNC_POINT("BlockBasedTable::PrefetchPartitions:Read");
+
+  RandomAccessFileReader* file = rep_->file.get();
+  const BlockHandle handles[2] = {filter_handle, index_handle};
+  FSReadRequest read_reqs[2];
+  std::unique_ptr<char[]> bufs[2];
+  for (size_t i = 0; i < 2; ++i) {
+    read_reqs[i].offset = handles[i].offset();
+    read_reqs[i].len = BlockSizeWithTrailer(handles[i]);
+    if (!file->use_direct_io()) {
+      bufs[i].reset(new char[read_reqs[i].len]);
+      read_reqs[i].scratch = bufs[i].get();
+    }
+    PERF_COUNTER_ADD(block_read_count, 1);
+    PERF_COUNTER_ADD(block_read_byte, read_reqs[i].len);
+  }
+
+  AlignedBuf direct_io_buf;
+  IOOptions opts;
+  IOStatus io_s = file->PrepareIOOptions(read_options, opts);
+  if (io_s.ok()) {
+    io_s = file->MultiRead(opts, read_reqs, 2, &direct_io_buf);
+  }
+  if (!io_s.ok()) {
+    // The partitions are read again when they are needed
+    return;
+  }
+
+  for (size_t i = 0; i < 2; ++i) {
+    FSReadRequest& req = read_reqs[i];
+    const BlockHandle& handle = handles[i];
+    if (!req.status.ok() || req.result.size() != req.len) {
+      continue;
+    }
+    if (read_options.verify_checksums) {
+      PERF_TIMER_GUARD(block_checksum_time);
+      Status s = VerifyBlockChecksum(rep_->footer, req.result.data(),
+                                     handle.size(), file->file_name(),
+                                     handle.offset());
+      RecordTick(rep_->ioptions.stats, BLOCK_CHECKSUM_COMPUTE_COUNT);
+      if (!s.ok()) {
+        continue;
+      }
+    }
+
+    BlockContents serialized_block;
+    if (req.result.data() == bufs[i].get()) {
+      serialized_block = BlockContents(std::move(bufs[i]), handle.size());
+    } else {
+      Slice serialized = req.result;
+      serialized_block = BlockContents(
+          CopyBufferToHeap(GetMemoryAllocator(rep_->table_options),
+                           serialized),
+          handle.size());
+    }
+#ifndef NDEBUG
+    serialized_block.has_trailer = true;
+#endif
+
+    // Passing the serialized contents makes MaybeReadBlockAndLoadToCache
+    // insert the block without looking up the block cache again
+    Status s;
+    if (i == 0) {
+      CachableEntry<ParsedFullFilterBlock> block_entry;
+      s = MaybeReadBlockAndLoadToCache(
+          nullptr, read_options, handle, UncompressionDict::GetEmptyDict(),
+          /*for_compaction=*/false, &block_entry, /*get_context=*/nullptr,
+          lookup_context, &serialized_block, /*async_read=*/false,
+          /*use_block_cache_for_lookup=*/true);
+    } else {
+      CachableEntry<Block_kIndex> block_entry;
+      s = MaybeReadBlockAndLoadToCache(
+          nullptr, read_options, handle, UncompressionDict::GetEmptyDict(),
+          /*for_compaction=*/false, &block_entry, /*get_context=*/nullptr,
+          lookup_context, &serialized_block, /*async_read=*/false,
+          /*use_block_cache_for_lookup=*/true);
+    }
+    s.PermitUncheckedError();
+  }
+}
+
+bool BlockBasedTable::RangeFilterMayMatch(const Slice* target,
+                                          const ReadOptions& read_options,
+                                          bool* beyond_upper) const {
+  *beyond_upper = false;
+  if (rep_->range_filter == nullptr ||
+      read_options.iterate_upper_bound == nullptr) {
+    return true;
+  }
+  Slice lower;
+  if (target != nullptr) {
+    lower = ExtractUserKey(*target);
+  }
+  return rep_->range_filter->RangeMayMatch(
+      target != nullptr ? &lower : nullptr, *read_options.iterate_upper_bound,
+      beyond_upper);
+}
+
 bool BlockBasedTable::PrefixExtractorChanged(
     const SliceTransform* prefix_extractor) const {
   if (prefix_extractor == nullptr) {
@@ -2014,6 +2222,10 @@ InternalIterator* BlockBasedTable::NewIterator(
     const ReadOptions& read_options, const SliceTransform* prefix_extractor,
     Arena* arena, bool skip_filters, TableReaderCaller caller,
     size_t compaction_readahead_size, bool allow_unprepared_value) {
+  // No version in the table is visible at the read timestamp
+  if (!TimestampMayMatch(read_options)) {
+    return NewEmptyInternalIterator<Slice>(arena);
+  }
   BlockCacheLookupContext lookup_context{caller};
   bool need_upper_bound_check =
       read_options.auto_prefix_mode || PrefixExtractorChanged(prefix_extractor);
@@ -2022,8 +2234,9 @@ InternalIterator* BlockBasedTable::NewIterator(
       /*disable_prefix_seek=*/need_upper_bound_check &&
           rep_->index_type == BlockBasedTableOptions::kHashSearch,
       /*input_iter=*/nullptr, /*get_context=*/nullptr, &lookup_context));
+  BlockBasedTableIterator* iter;
   if (arena == nullptr) {
-    return new BlockBasedTableIterator(
+    iter = new BlockBasedTableIterator(
         this, read_options, rep_->internal_comparator, std::move(index_iter),
         !skip_filters && !read_options.total_order_seek &&
             prefix_extractor != nullptr,
@@ -2031,13 +2244,27 @@ InternalIterator* BlockBasedTable::NewIterator(
         compaction_readahead_size, allow_unprepared_value);
   } else {
     auto* mem = arena->AllocateAligned(sizeof(BlockBasedTableIterator));
-    return new (mem) BlockBasedTableIterator(
+    iter = new (mem) BlockBasedTableIterator(
         this, read_options, rep_->internal_comparator, std::move(index_iter),
         !skip_filters && !read_options.total_order_seek &&
             prefix_extractor != nullptr,
         need_upper_bound_check, prefix_extractor, caller,
         compaction_readahead_size, allow_unprepared_value);
   }
+  const uint32_t decompression_threads =
+      rep_->table_options.compaction_decompression_threads;
+  if (caller == TableReaderCaller::kCompaction && decompression_threads > 0 &&
+      rep_->blocks_maybe_compressed) {
+    // The pipeline walks the index on its own, ahead of the iterator
+    std::unique_ptr<InternalIteratorBase<IndexValue>> pipeline_index_iter(
+        NewIndexIterator(read_options, /*disable_prefix_seek=*/true,
+                         /*input_iter=*/nullptr, /*get_context=*/nullptr,
+                         &lookup_context));
+    iter->SetDecompressionPipeline(std::make_unique<BlockDecompressionPipeline>(
+        this, read_options, std::move(pipeline_index_iter),
+        decompression_threads, compaction_readahead_size));
+  }
+  return iter;
 }
 
 FragmentedRangeTombstoneIterator* BlockBasedTable::NewRangeTombstoneIterator(
@@ -2072,6 +2299,7 @@ bool BlockBasedTable::FullFilterKeyMayMatch(
   if (filter == nullptr) {
     return true;
   }
+  OP_TRACE_SPAN("filter");
   Slice user_key = ExtractUserKey(internal_key);
   const Slice* const const_ikey_ptr = &internal_key;
   bool may_match = true;
@@ -2115,6 +2343,7 @@ void BlockBasedTable::FullFilterKeysMayMatch(
   if (filter == nullptr) {
     return;
   }
+  OP_TRACE_SPAN("filter");
   uint64_t before_keys = range->KeysLeft();
   assert(before_keys > 0);  // Caller should ensure
   if (rep_->whole_key_filtering) {
@@ -2156,6 +2385,30 @@ void BlockBasedTable::FullFilterKeysMayMatch(
 
 Status BlockBasedTable::ApproximateKeyAnchors(const ReadOptions& read_options,
                                               std::vector<Anchor>& anchors) {
+  if (!rep_->key_anchors_handle.IsNull()) {
+    // The anchors the builder recorded split the file by the sizes of its
+    // data blocks without reading its index
+    BlockContents contents;
+    Status s = BlockFetcher(rep_->file.get(), /*prefetch_buffer=*/nullptr,
+                            rep_->footer, read_options,
+                            rep_->key_anchors_handle, &contents,
+                            rep_->ioptions, false /* decompress */,
+                            false /*maybe_compressed*/, BlockType::kKeyAnchors,
+                            UncompressionDict::GetEmptyDict(),
+                            rep_->persistent_cache_options)
+                   .ReadBlockContents();
+    if (s.ok()) {
+      s = DecodeKeyAnchors(contents.data, &anchors);
+    }
+    if (s.ok()) {
+      return s;
+    }
+    ROCKS_LOG_WARN(rep_->ioptions.logger,
+                   "Encountered error while reading key anchors block %s",
+                   s.ToString().c_str());
+    anchors.clear();
+  }
+
   // We iterator the whole index block here. More efficient implementation
   // is possible if we push this operation into IndexReader. For example, we
   // can directly sample from restart block entries in the index block and
@@ -2215,6 +2468,49 @@ Status BlockBasedTable::ApproximateKeyAnchors(const ReadOptions& read_options,
   return Status::OK();
 }
 
+Status BlockBasedTable::GetCachedKeyRanges(const ReadOptions& read_options,
+                                           std::vector<KeyRange>* ranges) {
+  Cache* const cache = rep_->table_options.block_cache.get();
+  if (cache == nullptr) {
+    return Status::OK();
+  }
+  IndexBlockIter iiter_on_stack;
+  auto iiter = NewIndexIterator(
+      read_options, /*disable_prefix_seek=*/true, &iiter_on_stack,
+      /*get_context=*/nullptr, /*lookup_context=*/nullptr);
+  std::unique_ptr<InternalIteratorBase<IndexValue>> iiter_unique_ptr;
+  if (iiter != &iiter_on_stack) {
+    iiter_unique_ptr.reset(iiter);
+  }
+
+  // A data block holds the user keys after the index key of the previous
+  // block, up to its own index key.
+  bool has_prev = false;
+  std::string prev_key;
+  bool prev_cached = false;
+  for (iiter->SeekToFirst(); iiter->Valid(); iiter->Next()) {
+    const CacheKey key =
+        GetCacheKey(rep_->base_cache_key, iiter->value().handle);
+    Cache::Handle* const cache_handle = cache->Lookup(key.AsSlice());
+    const bool cached = cache_handle != nullptr;
+    if (cached) {
+      cache->Release(cache_handle);
+      if (prev_cached) {
+        ranges->back().end = iiter->user_key().ToString();
+      } else {
+        ranges->emplace_back();
+        ranges->back().has_start = has_prev;
+        ranges->back().start = std::move(prev_key);
+        ranges->back().end = iiter->user_key().ToString();
+      }
+    }
+    prev_cached = cached;
+    has_prev = true;
+    prev_key = iiter->user_key().ToString();
+  }
+  return iiter->status();
+}
+
 bool BlockBasedTable::TimestampMayMatch(const ReadOptions& read_options) const {
   if (read_options.timestamp != nullptr && !rep_->min_timestamp.empty()) {
     RecordTick(rep_->ioptions.stats, TIMESTAMP_FILTER_TABLE_CHECKED);
@@ -2605,6 +2901,14 @@ BlockType BlockBasedTable::GetBlockTypeForMetaBlockByName(
     return BlockType::kRangeDeletion;
   }
 
+  if (meta_block_name == kRangeFilterBlockName) {
+    return BlockType::kRangeFilter;
+  }
+
+  if (meta_block_name == kKeyAnchorsBlockName) {
+    return BlockType::kKeyAnchors;
+  }
+
   if (meta_block_name == kHashIndexPrefixesBlock) {
     return BlockType::kHashIndexPrefixes;
   }
@@ -2748,6 +3052,11 @@ Status BlockBasedTable::CreateIndexReader(
                                              use_cache, prefetch, pin,
                                              lookup_context, index_reader);
     }
+    case BlockBasedTableOptions::kLearnedSearch: {
+      return LearnedIndexReader::Create(this, ro, prefetch_buffer, use_cache,
+                                        prefetch, pin, lookup_context,
+                                        index_reader);
+    }
     case BlockBasedTableOptions::kHashSearch: {
       if (!rep_->table_prefix_extractor) {
         ROCKS_LOG_WARN(rep_->ioptions.logger,
@@ -2999,6 +3308,12 @@ Status BlockBasedTable::DumpTable(WritableFile* out_file) {
       } else if (metaindex_iter->key() == kRangeDelBlockName) {
         out_stream << "  Range deletion block handle: "
                    << metaindex_iter->value().ToString(true) << "\n";
+      } else if (metaindex_iter->key() == kRangeFilterBlockName) {
+        out_stream << "  Range filter block handle: "
+                   << metaindex_iter->value().ToString(true) << "\n";
+      } else if (metaindex_iter->key() == kKeyAnchorsBlockName) {
+        out_stream << "  Key anchors block handle: "
+                   << metaindex_iter->value().ToString(true) << "\n";
       }
     }
     out_stream << "\n";
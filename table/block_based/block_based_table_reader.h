@@ -26,6 +26,7 @@
 #include "table/block_based/block_type.h"
 #include "table/block_based/cachable_entry.h"
 #include "table/block_based/filter_block.h"
+#include "table/block_based/range_filter.h"
 #include "table/block_based/uncompression_dict_reader.h"
 #include "table/format.h"
 #include "table/persistent_cache_options.h"
@@ -35,6 +36,7 @@
 #include "trace_replay/block_cache_tracer.h"
 #include "util/coro_utils.h"
 #include "util/hash_containers.h"
+#include "util/random.h"
 
 namespace ROCKSDB_NAMESPACE {
 
@@ -122,6 +124,23 @@ class BlockBasedTable : public TableReader {
                            BlockCacheLookupContext* lookup_context,
                            bool* filter_checked) const;
 
+  // When the filter and the index are both partitioned, reads the filter
+  // partition and the index partition for a seek to `internal_key` with one
+  // MultiRead and inserts them into the block cache, instead of reading them
+  // one after the other. Does nothing if either of them is already cached or
+  // the top-level index block is not in memory. Errors are ignored.
+  void PrefetchPartitions(const ReadOptions& read_options,
+                          const Slice& internal_key,
+                          BlockCacheLookupContext* lookup_context) const;
+
+  // Returns false if the range filter of the table shows that it has no user
+  // key from the one of `target`, or from the start if it is null, up to
+  // read_options.iterate_upper_bound. In that case *beyond_upper tells
+  // whether the table has keys at or after the upper bound.
+  bool RangeFilterMayMatch(const Slice* target,
+                           const ReadOptions& read_options,
+                           bool* beyond_upper) const;
+
   // Returns a new iterator over the table contents.
   // The result of NewIterator() is initially invalid (caller must
   // call one of the Seek methods on the iterator before using it).
@@ -183,6 +202,9 @@ class BlockBasedTable : public TableReader {
   Status ApproximateKeyAnchors(const ReadOptions& read_options,
                                std::vector<Anchor>& anchors) override;
 
+  Status GetCachedKeyRanges(const ReadOptions& read_options,
+                            std::vector<KeyRange>* ranges) override;
+
   bool TEST_BlockInCache(const BlockHandle& handle) const;
 
   // Returns true if the block for the specified key is in cache.
@@ -241,6 +263,14 @@ class BlockBasedTable : public TableReader {
         FilePrefetchBuffer* /* tail_prefetch_buffer */) {
       return Status::OK();
     }
+    // Returns the handle of the index partition that a seek to the internal
+    // key would read, or a null handle if the index is not partitioned, the
+    // partitions are pinned or the top-level index is not in memory.
+    virtual BlockHandle GetPartitionHandle(
+        const ReadOptions& /*ro*/, const Slice& /*ikey*/,
+        BlockCacheLookupContext* /*lookup_context*/) {
+      return BlockHandle::NullBlockHandle();
+    }
   };
 
   class IndexReaderCommon;
@@ -495,6 +525,9 @@ class BlockBasedTable : public TableReader {
                            InternalIterator* meta_iter,
                            const InternalKeyComparator& internal_comparator,
                            BlockCacheLookupContext* lookup_context);
+  Status ReadRangeFilterBlock(const ReadOptions& ro,
+                              FilePrefetchBuffer* prefetch_buffer,
+                              InternalIterator* meta_iter);
   Status PrefetchIndexAndFilterBlocks(
       const ReadOptions& ro, FilePrefetchBuffer* prefetch_buffer,
       InternalIterator* meta_iter, BlockBasedTable* new_table,
@@ -533,6 +566,9 @@ class BlockBasedTable : public TableReader {
   // in building the table file, otherwise true.
   bool PrefixExtractorChanged(const SliceTransform* prefix_extractor) const;
 
+  // Returns false if the table has no version visible at
+  // `read_options.timestamp`, i.e. all its keys and range tombstones have a
+  // newer timestamp, see TimestampTablePropertiesCollector
   bool TimestampMayMatch(const ReadOptions& read_options) const;
 
   // A cumulative data block file read in MultiGet lower than this size will
@@ -618,6 +654,9 @@ struct BlockBasedTable::Rep {
   std::shared_ptr<const SliceTransform> table_prefix_extractor;
 
   std::shared_ptr<FragmentedRangeTombstoneList> fragmented_range_dels;
+  std::unique_ptr<RangeFilterReader> range_filter;
+  // Null if the file has no key anchors block
+  BlockHandle key_anchors_handle = BlockHandle::NullBlockHandle();
 
   // FIXME
   // If true, data blocks in this file are definitely ZSTD compressed. If false
@@ -675,6 +714,13 @@ struct BlockBasedTable::Rep {
   std::unique_ptr<CacheReservationManager::CacheReservationHandle>
       table_reader_cache_res_handle = nullptr;
 
+  // One in this many scans over the table is sampled for
+  // BlockBasedTableOptions::learn_auto_readahead_size.
+  static constexpr uint32_t kScanSampleRate = 16;
+  // Moving average of the data bytes read by the sampled scans, 0 if none
+  // was sampled yet.
+  mutable std::atomic<uint64_t> scan_bytes_estimate{0};
+
   SequenceNumber get_global_seqno(BlockType block_type) const {
     return (block_type == BlockType::kFilterPartitionIndex ||
             block_type == BlockType::kCompressionDictionary)
@@ -720,6 +766,35 @@ struct BlockBasedTable::Rep {
     }
   }
 
+  // Returns the readahead size that the implicit auto-readahead of a new
+  // iterator starts with.
+  size_t GetInitialAutoReadaheadSize() const {
+    const size_t initial_size = table_options.initial_auto_readahead_size;
+    if (!table_options.learn_auto_readahead_size || initial_size == 0) {
+      return initial_size;
+    }
+    const uint64_t estimate =
+        scan_bytes_estimate.load(std::memory_order_relaxed);
+    if (estimate == 0) {
+      return initial_size;
+    }
+    return static_cast<size_t>(std::max<uint64_t>(
+        table_options.block_size,
+        std::min<uint64_t>(estimate, table_options.max_auto_readahead_size)));
+  }
+
+  // Reports the data bytes that a scan over the table has read.
+  void RecordScanBytes(uint64_t bytes) const {
+    if (!table_options.learn_auto_readahead_size || bytes == 0 ||
+        !Random::GetTLSInstance()->OneIn(kScanSampleRate)) {
+      return;
+    }
+    uint64_t estimate = scan_bytes_estimate.load(std::memory_order_relaxed);
+    // Racing updates may drop a sample, which is fine for an estimate.
+    estimate = estimate == 0 ? bytes : estimate - estimate / 4 + bytes / 4;
+    scan_bytes_estimate.store(estimate, std::memory_order_relaxed);
+  }
+
   std::size_t ApproximateMemoryUsage() const {
     std::size_t usage = 0;
 #ifdef ROCKSDB_MALLOC_USABLE_SIZE
@@ -354,6 +354,11 @@ DEFINE_SYNC_AND_ASYNC(void, BlockBasedTable::MultiGet)
     assert(false);
     CO_RETURN;  // Nothing to do
   }
+  // Similar to Bloom filter !may_match
+  // If timestamp is beyond the range of the table, skip
+  if (!TimestampMayMatch(read_options)) {
+    CO_RETURN;
+  }
 
   FilterBlockReader* const filter =
       !skip_filters ? rep_->filter.get() : nullptr;
@@ -601,11 +606,17 @@ DEFINE_SYNC_AND_ASYNC(void, BlockBasedTable::MultiGet)
     DataBlockIter next_biter;
     size_t idx_in_batch = 0;
     SharedCleanablePtr shared_cleanable;
+    // Hash index entries of the keys, looked up together for all the keys
+    // in the same data block
+    std::array<uint8_t, MultiGetContext::MAX_BATCH_SIZE> hash_index_entries;
+    MultiGetContext::Mask hash_index_entries_mask;
+    std::vector<Slice> block_keys;
     for (auto miter = sst_file_range.begin(); miter != sst_file_range.end();
          ++miter) {
       Status s;
       GetContext* get_context = miter->get_context;
       const Slice& key = miter->ikey;
+      const size_t key_idx = idx_in_batch;
       bool matched = false;  // if such user key matched a key in SST
       bool done = false;
       bool first_block = true;
@@ -629,6 +640,24 @@ DEFINE_SYNC_AND_ASYNC(void, BlockBasedTable::MultiGet)
                 read_options, results[idx_in_batch].As<Block>(), &first_biter,
                 statuses[idx_in_batch]);
             reusing_prev_block = false;
+            size_t num_keys_in_block = 1;
+            while (reused_mask[idx_in_batch + num_keys_in_block - 1]) {
+              num_keys_in_block++;
+            }
+            if (num_keys_in_block > 1 && first_biter.status().ok()) {
+              block_keys.clear();
+              auto kiter = miter;
+              for (size_t i = 0; i < num_keys_in_block; ++i, ++kiter) {
+                block_keys.push_back(kiter->ikey);
+              }
+              if (first_biter.LookupHashIndexBatch(
+                      block_keys.data(), num_keys_in_block,
+                      &hash_index_entries[idx_in_batch])) {
+                for (size_t i = 0; i < num_keys_in_block; ++i) {
+                  hash_index_entries_mask.set(idx_in_batch + i);
+                }
+              }
+            }
           } else {
             // If handle is null and result is empty, then the status is never
             // set, which should be the initial value: ok().
@@ -719,7 +748,10 @@ DEFINE_SYNC_AND_ASYNC(void, BlockBasedTable::MultiGet)
           value_pinner = nullptr;
         }
 
-        bool may_exist = biter->SeekForGet(key);
+        bool may_exist =
+            first_block && hash_index_entries_mask[key_idx]
+                ? biter->SeekForGet(key, hash_index_entries[key_idx])
+                : biter->SeekForGet(key);
         if (!may_exist) {
           // HashSeek cannot find the key this block and the the iter is not
           // the end of the block, i.e. cannot be in the following blocks
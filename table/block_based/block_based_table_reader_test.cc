@@ -22,6 +22,7 @@
 #include "rocksdb/options.h"
 #include "table/block_based/block_based_table_builder.h"
 #include "table/block_based/block_based_table_factory.h"
+#include "table/block_based/key_anchors.h"
 #include "table/block_based/partitioned_index_iterator.h"
 #include "table/format.h"
 #include "test_util/testharness.h"
@@ -722,6 +723,124 @@ TEST_P(ChargeTableReaderTest, Basic) {
   }
 }
 
+class LearnedReadaheadTest : public BlockBasedTableReaderBaseTest {
+ protected:
+  void ConfigureTableFactory() override {
+    BlockBasedTableOptions opts;
+    opts.learn_auto_readahead_size = true;
+    options_.table_factory.reset(NewBlockBasedTableFactory(opts));
+  }
+};
+
+TEST_F(LearnedReadaheadTest, ScanLengths) {
+  Options options;
+  std::vector<std::pair<std::string, std::string>> kv =
+      BlockBasedTableReaderBaseTest::GenerateKVMap(100 /* num_block */);
+  std::string table_name = "LearnedReadaheadTest_ScanLengths";
+  ImmutableOptions ioptions(options);
+  CreateTable(table_name, ioptions, kNoCompression, kv);
+
+  std::unique_ptr<BlockBasedTable> table;
+  InternalKeyComparator comparator(options.comparator);
+  NewBlockBasedTableReader(FileOptions(), ioptions, comparator, table_name,
+                           &table);
+  const BlockBasedTableOptions& table_options =
+      table->get_rep()->table_options;
+  ASSERT_EQ(table_options.initial_auto_readahead_size,
+            table->get_rep()->GetInitialAutoReadaheadSize());
+
+  ReadOptions read_opts;
+  Random rnd(301);
+  // Scans of a single block make readahead start smaller, as it would mostly
+  // be wasted.
+  {
+    std::unique_ptr<InternalIterator> iter(table->NewIterator(
+        read_opts, /*prefix_extractor=*/nullptr, /*arena=*/nullptr,
+        /*skip_filters=*/false, TableReaderCaller::kUncategorized));
+    for (int i = 0; i < 2000; i++) {
+      iter->Seek(kv[rnd.Uniform(static_cast<int>(kv.size()))].first);
+      ASSERT_TRUE(iter->Valid());
+    }
+    ASSERT_OK(iter->status());
+  }
+  ASSERT_LT(table->get_rep()->GetInitialAutoReadaheadSize(),
+            table_options.initial_auto_readahead_size);
+  ASSERT_GE(table->get_rep()->GetInitialAutoReadaheadSize(),
+            table_options.block_size);
+
+  // Scans of the whole table make it start at the maximum.
+  for (int i = 0; i < 500; i++) {
+    std::unique_ptr<InternalIterator> iter(table->NewIterator(
+        read_opts, /*prefix_extractor=*/nullptr, /*arena=*/nullptr,
+        /*skip_filters=*/false, TableReaderCaller::kUncategorized));
+    size_t count = 0;
+    for (iter->SeekToFirst(); iter->Valid(); iter->Next()) {
+      count++;
+    }
+    ASSERT_OK(iter->status());
+    ASSERT_EQ(kv.size(), count);
+  }
+  ASSERT_EQ(table_options.max_auto_readahead_size,
+            table->get_rep()->GetInitialAutoReadaheadSize());
+}
+
+class KeyAnchorsTest : public BlockBasedTableReaderBaseTest {
+ protected:
+  void ConfigureTableFactory() override {}
+
+  void ReadAnchors(bool store_key_anchors, const std::string& table_name,
+                   std::vector<TableReader::Anchor>* anchors) {
+    BlockBasedTableOptions opts;
+    opts.store_key_anchors = store_key_anchors;
+    options_.table_factory.reset(NewBlockBasedTableFactory(opts));
+    ImmutableOptions ioptions(options_);
+    CreateTable(table_name, ioptions, kNoCompression, kv_);
+
+    std::unique_ptr<BlockBasedTable> table;
+    InternalKeyComparator comparator(options_.comparator);
+    NewBlockBasedTableReader(FileOptions(), ioptions, comparator, table_name,
+                             &table);
+    ASSERT_EQ(store_key_anchors,
+              !table->get_rep()->key_anchors_handle.IsNull());
+    ASSERT_OK(table->ApproximateKeyAnchors(ReadOptions(), *anchors));
+  }
+
+  std::vector<std::pair<std::string, std::string>> kv_ =
+      GenerateKVMap(1000 /* num_block */);
+};
+
+TEST_F(KeyAnchorsTest, StoredAnchors) {
+  std::vector<TableReader::Anchor> stored;
+  ReadAnchors(true /* store_key_anchors */, "KeyAnchorsTest_Stored", &stored);
+  std::vector<TableReader::Anchor> sampled;
+  ReadAnchors(false /* store_key_anchors */, "KeyAnchorsTest_Sampled",
+              &sampled);
+
+  ASSERT_GE(stored.size(), KeyAnchorsBuilder::kMaxAnchors / 2);
+  ASSERT_LT(stored.size(), KeyAnchorsBuilder::kMaxAnchors);
+  size_t stored_size = 0;
+  for (size_t i = 0; i < stored.size(); i++) {
+    if (i > 0) {
+      ASSERT_LT(stored[i - 1].user_key, stored[i].user_key);
+    }
+    stored_size += stored[i].range_size;
+  }
+  // The ranges cover the same data blocks as those sampled from the index
+  size_t sampled_size = 0;
+  for (const auto& anchor : sampled) {
+    sampled_size += anchor.range_size;
+  }
+  ASSERT_EQ(sampled_size, stored_size);
+  // The last anchor is the last key rather than an index separator
+  ASSERT_EQ(ExtractUserKey(kv_.back().first).ToString(),
+            stored.back().user_key);
+  // Every range but the last has the same number of blocks
+  for (size_t i = 1; i + 1 < stored.size(); i++) {
+    ASSERT_LT(stored[i].range_size, stored[0].range_size * 2);
+    ASSERT_GT(stored[i].range_size * 2, stored[0].range_size);
+  }
+}
+
 class BlockBasedTableReaderTestVerifyChecksum
     : public BlockBasedTableReaderTest {
  public:
@@ -812,7 +931,8 @@ INSTANTIATE_TEST_CASE_P(
             BlockBasedTableOptions::IndexType::kBinarySearch,
             BlockBasedTableOptions::IndexType::kHashSearch,
             BlockBasedTableOptions::IndexType::kTwoLevelIndexSearch,
-            BlockBasedTableOptions::IndexType::kBinarySearchWithFirstKey),
+            BlockBasedTableOptions::IndexType::kBinarySearchWithFirstKey,
+            BlockBasedTableOptions::IndexType::kLearnedSearch),
         ::testing::Values(false), ::testing::ValuesIn(test::GetUDTTestModes()),
         ::testing::Values(1, 2), ::testing::Values(0, 4096),
         ::testing::Values(false)));
@@ -824,7 +944,8 @@ INSTANTIATE_TEST_CASE_P(
             BlockBasedTableOptions::IndexType::kBinarySearch,
             BlockBasedTableOptions::IndexType::kHashSearch,
             BlockBasedTableOptions::IndexType::kTwoLevelIndexSearch,
-            BlockBasedTableOptions::IndexType::kBinarySearchWithFirstKey),
+            BlockBasedTableOptions::IndexType::kBinarySearchWithFirstKey,
+            BlockBasedTableOptions::IndexType::kLearnedSearch),
         ::testing::Values(false), ::testing::ValuesIn(test::GetUDTTestModes()),
         ::testing::Values(1, 2), ::testing::Values(0, 4096),
         ::testing::Values(false, true)));
@@ -28,8 +28,12 @@
 //
 // The trailer of the block has the form:
 //     restarts: uint32[num_restarts]
+//     restart_key_prefixes: uint32[num_restarts] (optional)
+//     hash_index (optional)
 //     num_restarts: uint32
 // restarts[i] contains the offset within the block of the ith restart point.
+// restart_key_prefixes[i] contains the first 4 bytes of the user key of the
+// ith restart point as a big-endian integer, padded with zeros.
 
 #include "table/block_based/block_builder.h"
 
@@ -48,12 +52,14 @@ BlockBuilder::BlockBuilder(
     bool use_value_delta_encoding,
     BlockBasedTableOptions::DataBlockIndexType index_type,
     double data_block_hash_table_util_ratio, size_t ts_sz,
-    bool persist_user_defined_timestamps, bool is_user_key)
+    bool persist_user_defined_timestamps, bool is_user_key,
+    bool restart_key_prefixes)
     : block_restart_interval_(block_restart_interval),
       use_delta_encoding_(use_delta_encoding),
       use_value_delta_encoding_(use_value_delta_encoding),
       strip_ts_sz_(persist_user_defined_timestamps ? 0 : ts_sz),
       is_user_key_(is_user_key),
+      restart_key_prefixes_(restart_key_prefixes),
       restarts_(1, 0),  // First restart point is at offset 0
       counter_(0),
       finished_(false) {
@@ -64,6 +70,10 @@ BlockBuilder::BlockBuilder(
       data_block_hash_index_builder_.Initialize(
           data_block_hash_table_util_ratio);
       break;
+    case BlockBasedTableOptions::kDataBlockBinaryAndBlockedHash:
+      data_block_hash_index_builder_.Initialize(
+          data_block_hash_table_util_ratio, true /* blocked */);
+      break;
     default:
       assert(0);
   }
@@ -75,6 +85,7 @@ void BlockBuilder::Reset() {
   buffer_.clear();
   restarts_.resize(1);  // First restart point is at offset 0
   assert(restarts_[0] == 0);
+  restart_key_prefixes_buf_.clear();
   estimate_ = sizeof(uint32_t) + sizeof(uint32_t);
   counter_ = 0;
   finished_ = false;
@@ -110,6 +121,9 @@ size_t BlockBuilder::EstimateSizeAfterKV(const Slice& key,
 
   if (counter_ >= block_restart_interval_) {
     estimate += sizeof(uint32_t);  // a new restart entry.
+    if (restart_key_prefixes_) {
+      estimate += sizeof(uint32_t);  // and its key prefix.
+    }
   }
 
   estimate += sizeof(int32_t);  // varint for shared prefix length.
@@ -130,16 +144,30 @@ Slice BlockBuilder::Finish() {
   }
 
   uint32_t num_restarts = static_cast<uint32_t>(restarts_.size());
+  // Readers ignore the prefixes of blocks above the size that the hash index
+  // supports, as the footer bits are then part of num_restarts.
+  bool has_restart_key_prefixes =
+      restart_key_prefixes_ &&
+      restart_key_prefixes_buf_.size() == restarts_.size() &&
+      CurrentSizeEstimate() <= kMaxBlockSizeSupportedByHashIndex;
+  if (has_restart_key_prefixes) {
+    for (uint32_t prefix : restart_key_prefixes_buf_) {
+      PutFixed32(&buffer_, prefix);
+    }
+  }
   BlockBasedTableOptions::DataBlockIndexType index_type =
       BlockBasedTableOptions::kDataBlockBinarySearch;
   if (data_block_hash_index_builder_.Valid() &&
       CurrentSizeEstimate() <= kMaxBlockSizeSupportedByHashIndex) {
     data_block_hash_index_builder_.Finish(buffer_);
-    index_type = BlockBasedTableOptions::kDataBlockBinaryAndHash;
+    index_type = data_block_hash_index_builder_.Blocked()
+                     ? BlockBasedTableOptions::kDataBlockBinaryAndBlockedHash
+                     : BlockBasedTableOptions::kDataBlockBinaryAndHash;
   }
 
   // footer is a packed format of data_block_index_type and num_restarts
-  uint32_t block_footer = PackIndexTypeAndNumRestarts(index_type, num_restarts);
+  uint32_t block_footer = PackIndexTypeAndNumRestarts(
+      index_type, num_restarts, has_restart_key_prefixes);
 
   PutFixed32(&buffer_, block_footer);
   finished_ = true;
@@ -211,6 +239,11 @@ inline void BlockBuilder::AddWithLastKeyImpl(const Slice& key,
     // See how much sharing to do with previous string
     shared = key_to_persist.difference_offset(last_key_persisted);
   }
+  if (restart_key_prefixes_ && counter_ == 0) {
+    restart_key_prefixes_buf_.push_back(RestartKeyPrefix(
+        is_user_key_ ? key_to_persist : ExtractUserKey(key_to_persist)));
+    estimate_ += sizeof(uint32_t);
+  }
 
   const size_t non_shared = key_to_persist.size() - shared;
 
@@ -238,7 +271,7 @@ inline void BlockBuilder::AddWithLastKeyImpl(const Slice& key,
 
   // TODO(yuzhangyu): make user defined timestamp work with block hash index.
   if (data_block_hash_index_builder_.Valid()) {
-    // Only data blocks should be using `kDataBlockBinaryAndHash` index type.
+    // Only data blocks should be using a hash index.
     // And data blocks should always be built with internal keys instead of
     // user keys.
     assert(!is_user_key_);
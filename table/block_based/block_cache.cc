@@ -75,6 +75,8 @@ const std::array<const Cache::CacheItemHelper*,
         nullptr,  // kHashIndexMetadata
         nullptr,  // kMetaIndex (not yet stored in block cache)
         BlockCacheInterface<Block_kIndex>::GetFullHelper(),
+        nullptr,  // kRangeFilter
+        nullptr,  // kKeyAnchors
         nullptr,  // kInvalid
     }};
 
@@ -92,6 +94,8 @@ const std::array<const Cache::CacheItemHelper*,
         nullptr,  // kHashIndexMetadata
         nullptr,  // kMetaIndex (not yet stored in block cache)
         BlockCacheInterface<Block_kIndex>::GetBasicHelper(),
+        nullptr,  // kRangeFilter
+        nullptr,  // kKeyAnchors
         nullptr,  // kInvalid
     }};
 }  // namespace
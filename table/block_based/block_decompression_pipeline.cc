@@ -0,0 +1,186 @@
+//  Copyright (c) Meta Platforms, Inc. and affiliates.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+
+#include "table/block_based/block_decompression_pipeline.h"
+
+#include <cstring>
+
+#include "memory/memory_allocator_impl.h"
+#include "table/block_based/reader_common.h"
+#include "table/block_fetcher.h"
+#include "table/format.h"
+#include "test_util/sync_point.h"
+#include "util/compression.h"
+
+namespace ROCKSDB_NAMESPACE {
+
+BlockDecompressionPipeline::BlockDecompressionPipeline(
+    const BlockBasedTable* table, const ReadOptions& read_options,
+    std::unique_ptr<InternalIteratorBase<IndexValue>>&& index_iter,
+    uint32_t num_threads, size_t compaction_readahead_size)
+    : table_(table),
+      read_options_(read_options),
+      index_iter_(std::move(index_iter)),
+      prefetcher_(compaction_readahead_size,
+                  table->get_rep()->GetInitialAutoReadaheadSize()),
+      max_pending_(2 * size_t{num_threads}) {
+  assert(num_threads > 0);
+  const BlockBasedTable::Rep* rep = table_->get_rep();
+  if (rep->uncompression_dict_reader) {
+    Status s =
+        rep->uncompression_dict_reader->GetOrReadUncompressionDictionary(
+            /*prefetch_buffer=*/nullptr, read_options_, /*no_io=*/false,
+            read_options_.verify_checksums, /*get_context=*/nullptr,
+            /*lookup_context=*/nullptr, &uncompression_dict_);
+    if (!s.ok()) {
+      // The iterator reads and decompresses the blocks itself
+      stopped_ = true;
+    }
+  }
+  threads_.reserve(num_threads);
+  for (uint32_t i = 0; i < num_threads; i++) {
+    threads_.emplace_back([this] { BGWorkDecompression(); });
+  }
+}
+
+BlockDecompressionPipeline::~BlockDecompressionPipeline() {
+  DropPending();
+  decompress_queue_.finish();
+  for (auto& thread : threads_) {
+    thread.join();
+  }
+}
+
+void BlockDecompressionPipeline::Seek(const Slice* target) {
+  DropPending();
+  if (stopped_) {
+    return;
+  }
+  if (target) {
+    index_iter_->Seek(*target);
+  } else {
+    index_iter_->SeekToFirst();
+  }
+  FillPipeline();
+}
+
+bool BlockDecompressionPipeline::GetBlock(const BlockHandle& handle,
+                                          CachableEntry<Block>* block,
+                                          Status* s) {
+  // Skip the blocks the iterator did not need
+  while (!pending_.empty() &&
+         pending_.front()->handle.offset() < handle.offset()) {
+    bool done;
+    pending_.front()->done.pop(done);
+    pending_.pop_front();
+  }
+  if (pending_.empty() ||
+      pending_.front()->handle.offset() != handle.offset()) {
+    // The iterator moved away from the blocks read ahead. Reading ahead
+    // resumes on the next Seek().
+    DropPending();
+    return false;
+  }
+
+  std::unique_ptr<PendingBlock> pending = std::move(pending_.front());
+  pending_.pop_front();
+  bool done;
+  pending->done.pop(done);
+  FillPipeline();
+
+  *s = pending->status;
+  if (s->ok()) {
+    block->SetOwnedValue(std::move(pending->block));
+  }
+  TEST_SYNC_POINT("BlockDecompressionPipeline::GetBlock:Hit");
+  return true;
+}
+
+void BlockDecompressionPipeline::BGWorkDecompression() {
+  PendingBlock* pending = nullptr;
+  while (decompress_queue_.pop(pending)) {
+    Decompress(pending);
+    pending->done.push(true);
+  }
+}
+
+void BlockDecompressionPipeline::Decompress(PendingBlock* pending) {
+  const BlockBasedTable::Rep* rep = table_->get_rep();
+  BlockContents contents;
+  if (pending->compression_type == kNoCompression) {
+    contents = std::move(pending->contents);
+  } else {
+    UncompressionContext context(pending->compression_type);
+    UncompressionInfo info(context,
+                           uncompression_dict_.GetValue()
+                               ? *uncompression_dict_.GetValue()
+                               : UncompressionDict::GetEmptyDict(),
+                           pending->compression_type);
+    pending->status = UncompressBlockData(
+        info, pending->contents.data.data(), pending->contents.data.size(),
+        &contents, rep->table_options.format_version, rep->ioptions,
+        GetMemoryAllocator(rep->table_options));
+    pending->contents = BlockContents();
+    if (!pending->status.ok()) {
+      return;
+    }
+  }
+  BlockCreateContext create_context = rep->create_context;
+  create_context.Create(&pending->block, std::move(contents));
+}
+
+void BlockDecompressionPipeline::FillPipeline() {
+  const BlockBasedTable::Rep* rep = table_->get_rep();
+  while (!stopped_ && pending_.size() < max_pending_ && index_iter_->Valid()) {
+    std::unique_ptr<PendingBlock> pending(new PendingBlock());
+    pending->handle = index_iter_->value().handle;
+
+    prefetcher_.PrefetchIfNeeded(
+        rep, pending->handle, /*readahead_size=*/0,
+        /*is_for_compaction=*/true, /*no_sequential_checking=*/false,
+        read_options_, /*readaheadsize_cb=*/nullptr,
+        /*is_async_io_prefetch=*/false);
+    BlockFetcher block_fetcher(
+        rep->file.get(), prefetcher_.prefetch_buffer(), rep->footer,
+        read_options_, pending->handle, &pending->contents, rep->ioptions,
+        /*do_uncompress=*/false, /*maybe_compressed=*/true, BlockType::kData,
+        UncompressionDict::GetEmptyDict(), rep->persistent_cache_options,
+        GetMemoryAllocator(rep->table_options), nullptr,
+        /*for_compaction=*/true);
+    Status s = block_fetcher.ReadBlockContents();
+    if (!s.ok()) {
+      // The iterator reads the block itself and sees the error
+      stopped_ = true;
+      break;
+    }
+    pending->compression_type = block_fetcher.get_compression_type();
+    if (!pending->contents.own_bytes()) {
+      // The contents may point into the prefetch buffer, which is reused
+      const Slice& data = pending->contents.data;
+      CacheAllocationPtr buf =
+          AllocateBlock(data.size(), GetMemoryAllocator(rep->table_options));
+      memcpy(buf.get(), data.data(), data.size());
+      pending->contents = BlockContents(std::move(buf), data.size());
+    }
+
+    PendingBlock* ptr = pending.get();
+    pending_.push_back(std::move(pending));
+    decompress_queue_.push(ptr);
+    index_iter_->Next();
+  }
+  if (!index_iter_->status().ok()) {
+    stopped_ = true;
+  }
+}
+
+void BlockDecompressionPipeline::DropPending() {
+  for (auto& pending : pending_) {
+    bool done;
+    pending->done.pop(done);
+  }
+  pending_.clear();
+}
+
+}  // namespace ROCKSDB_NAMESPACE
@@ -0,0 +1,86 @@
+//  Copyright (c) Meta Platforms, Inc. and affiliates.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+
+#pragma once
+
+#include <deque>
+#include <memory>
+#include <vector>
+
+#include "port/port.h"
+#include "table/block_based/block_based_table_reader.h"
+#include "table/block_based/block_prefetcher.h"
+#include "table/block_based/cachable_entry.h"
+#include "util/work_queue.h"
+
+namespace ROCKSDB_NAMESPACE {
+
+// Reads the data blocks of a table ahead of a compaction iterator and
+// decompresses them on worker threads, see
+// BlockBasedTableOptions::compaction_decompression_threads.
+//
+// The blocks are read in index order on the iterator's thread, through an
+// index iterator and a prefetch buffer of their own, and queued for the
+// workers. At most 2 * num_threads blocks are pending at a time. When the
+// iterator asks for a block before the next pending one, e.g. after Prev(),
+// the pending blocks are dropped and reading ahead stops until the next
+// Seek().
+class BlockDecompressionPipeline {
+ public:
+  BlockDecompressionPipeline(
+      const BlockBasedTable* table, const ReadOptions& read_options,
+      std::unique_ptr<InternalIteratorBase<IndexValue>>&& index_iter,
+      uint32_t num_threads, size_t compaction_readahead_size);
+
+  // No copying allowed
+  BlockDecompressionPipeline(const BlockDecompressionPipeline&) = delete;
+  BlockDecompressionPipeline& operator=(const BlockDecompressionPipeline&) =
+      delete;
+
+  ~BlockDecompressionPipeline();
+
+  // Restarts reading ahead from the index entry of `target`, or from the
+  // first one if `target` is nullptr
+  void Seek(const Slice* target);
+
+  // If the data block at `handle` was read ahead, moves it into `block`,
+  // sets `*s` to the status of decompressing it and returns true. Otherwise
+  // returns false, and the caller reads the block itself.
+  bool GetBlock(const BlockHandle& handle, CachableEntry<Block>* block,
+                Status* s);
+
+ private:
+  struct PendingBlock {
+    BlockHandle handle;
+    CompressionType compression_type = kNoCompression;
+    BlockContents contents;
+    std::unique_ptr<Block_kData> block;
+    Status status;
+    // Holds one item once the block is ready
+    WorkQueue<bool> done{1};
+  };
+
+  void BGWorkDecompression();
+  void Decompress(PendingBlock* pending);
+  // Reads ahead the blocks from the position of index_iter_
+  void FillPipeline();
+  // Waits for and drops the pending blocks
+  void DropPending();
+
+  const BlockBasedTable* const table_;
+  const ReadOptions& read_options_;
+  std::unique_ptr<InternalIteratorBase<IndexValue>> index_iter_;
+  BlockPrefetcher prefetcher_;
+  CachableEntry<UncompressionDict> uncompression_dict_;
+  const size_t max_pending_;
+  // Set when reading ahead failed, after which no block is read ahead
+  bool stopped_ = false;
+
+  std::deque<std::unique_ptr<PendingBlock>> pending_;
+  WorkQueue<PendingBlock*> decompress_queue_;
+  std::vector<port::Thread> threads_;
+};
+
+}  // namespace ROCKSDB_NAMESPACE
@@ -22,6 +22,7 @@ void BlockPrefetcher::PrefetchIfNeeded(
   readahead_params.initial_readahead_size = readahead_size;
   readahead_params.max_readahead_size = readahead_size;
   readahead_params.num_buffers = is_async_io_prefetch ? 2 : 1;
+  readahead_params.prefetch_scheduler = prefetch_scheduler_;
 
   const size_t len = BlockBasedTable::BlockSizeWithTrailer(handle);
   const size_t offset = handle.offset();
@@ -103,7 +104,7 @@ void BlockPrefetcher::PrefetchIfNeeded(
 
   if (!IsBlockSequential(offset)) {
     UpdateReadPattern(offset, len);
-    ResetValues(rep->table_options.initial_auto_readahead_size);
+    ResetValues(rep->GetInitialAutoReadaheadSize());
     return;
   }
   UpdateReadPattern(offset, len);
@@ -54,6 +54,21 @@ class BlockPrefetcher {
                              &initial_auto_readahead_size_);
   }
 
+  void SetPrefetchScheduler(ScanPrefetchScheduler* prefetch_scheduler) {
+    prefetch_scheduler_ = prefetch_scheduler;
+    if (prefetch_buffer_) {
+      prefetch_buffer_->SetPrefetchScheduler(prefetch_scheduler);
+    }
+  }
+
+  // Aborts the readahead in progress of an iterator sharing a
+  // ScanPrefetchScheduler, so that it does not hold slots past a reseek
+  void AbortAsyncReadahead() {
+    if (prefetch_scheduler_ != nullptr && prefetch_buffer_) {
+      prefetch_buffer_->AbortAsyncReads();
+    }
+  }
+
  private:
   // Readahead size used in compaction, its value is used only if
   // lookup_context_.caller = kCompaction.
@@ -69,6 +84,7 @@ class BlockPrefetcher {
   uint64_t num_file_reads_ = 0;
   uint64_t prev_offset_ = 0;
   size_t prev_len_ = 0;
+  ScanPrefetchScheduler* prefetch_scheduler_ = nullptr;
   std::unique_ptr<FilePrefetchBuffer> prefetch_buffer_;
 };
 }  // namespace ROCKSDB_NAMESPACE
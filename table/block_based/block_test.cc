@@ -576,6 +576,98 @@ TEST_F(BlockTest, ReadAmpBitmapPow2) {
   ASSERT_EQ(BlockReadAmpBitmap(100, 35, stats.get()).GetBytesPerBit(), 32u);
 }
 
+TEST_F(BlockTest, RestartKeyPrefixes) {
+  Random rnd(301);
+  InternalKeyComparator icmp(BytewiseComparator());
+  auto less = [&](const std::string &a, const std::string &b) {
+    return icmp.Compare(a, b) < 0;
+  };
+  const BlockBasedTableOptions::DataBlockIndexType index_types[] = {
+      BlockBasedTableOptions::kDataBlockBinarySearch,
+      BlockBasedTableOptions::kDataBlockBinaryAndHash};
+  for (int restart_interval : {1, 4, 16}) {
+    for (int num_keys : {1, 50, 2000, 20000}) {
+      for (auto index_type : index_types) {
+        // Short keys from a small alphabet, so that many restart keys share
+        // their prefixes, or are shorter than them.
+        std::set<std::string, decltype(less)> sorted(less);
+        while (sorted.size() < static_cast<size_t>(num_keys)) {
+          std::string user_key;
+          for (uint32_t i = rnd.Uniform(7); i > 0; i--) {
+            user_key.push_back("\0ab\x7f\xff"[rnd.Uniform(5)]);
+          }
+          sorted.insert(InternalKey(user_key, rnd.Uniform(3), kTypeValue)
+                            .Encode()
+                            .ToString());
+        }
+        std::vector<std::string> keys(sorted.begin(), sorted.end());
+
+        std::string blocks[2];
+        for (bool restart_key_prefixes : {false, true}) {
+          BlockBuilder builder(restart_interval, true /* use_delta_encoding */,
+                               false /* use_value_delta_encoding */,
+                               index_type,
+                               0.75 /* data_block_hash_table_util_ratio */,
+                               0 /* ts_sz */,
+                               true /* persist_user_defined_timestamps */,
+                               false /* is_user_key */, restart_key_prefixes);
+          for (const auto &key : keys) {
+            builder.Add(key, "value");
+          }
+          blocks[restart_key_prefixes] = builder.Finish().ToString();
+        }
+        const size_t num_restarts =
+            (keys.size() + restart_interval - 1) / restart_interval;
+        if (blocks[0].size() + num_restarts * sizeof(uint32_t) <=
+            kMaxBlockSizeSupportedByHashIndex) {
+          ASSERT_EQ(blocks[0].size() + num_restarts * sizeof(uint32_t),
+                    blocks[1].size());
+        } else {
+          ASSERT_EQ(blocks[0], blocks[1]);
+        }
+
+        BlockContents contents;
+        contents.data = blocks[1];
+        Block reader(std::move(contents));
+        ASSERT_EQ(num_restarts, reader.NumRestarts());
+        std::unique_ptr<DataBlockIter> iter(reader.NewDataIterator(
+            BytewiseComparator(), kDisableGlobalSequenceNumber));
+        size_t count = 0;
+        for (iter->SeekToFirst(); iter->Valid(); iter->Next(), count++) {
+          ASSERT_EQ(keys[count], iter->key().ToString());
+        }
+        ASSERT_EQ(keys.size(), count);
+
+        for (int i = 0; i < 1000; i++) {
+          std::string user_key;
+          for (uint32_t j = rnd.Uniform(7); j > 0; j--) {
+            user_key.push_back("\0ab\x7f\xff"[rnd.Uniform(5)]);
+          }
+          std::string target =
+              InternalKey(user_key, rnd.Uniform(3), kValueTypeForSeek)
+                  .Encode()
+                  .ToString();
+          auto lower = std::lower_bound(keys.begin(), keys.end(), target, less);
+          iter->Seek(target);
+          ASSERT_OK(iter->status());
+          ASSERT_EQ(lower != keys.end(), iter->Valid());
+          if (iter->Valid()) {
+            ASSERT_EQ(*lower, iter->key().ToString());
+          }
+
+          auto upper = std::upper_bound(keys.begin(), keys.end(), target, less);
+          iter->SeekForPrev(target);
+          ASSERT_OK(iter->status());
+          ASSERT_EQ(upper != keys.begin(), iter->Valid());
+          if (iter->Valid()) {
+            ASSERT_EQ(*std::prev(upper), iter->key().ToString());
+          }
+        }
+      }
+    }
+  }
+}
+
 class IndexBlockTest
     : public testing::Test,
       public testing::WithParamInterface<
@@ -15,15 +15,21 @@ namespace ROCKSDB_NAMESPACE {
 
 const int kDataBlockIndexTypeBitShift = 31;
 
-// 0x7FFFFFFF
-const uint32_t kMaxNumRestarts = (1u << kDataBlockIndexTypeBitShift) - 1u;
+const int kRestartKeyPrefixesBitShift = 30;
 
-// 0x7FFFFFFF
-const uint32_t kNumRestartsMask = (1u << kDataBlockIndexTypeBitShift) - 1u;
+// Set along with the index type bit when the hash index has the blocked
+// layout
+const int kBlockedHashIndexBitShift = 29;
+
+// 0x1FFFFFFF
+const uint32_t kMaxNumRestarts = (1u << kBlockedHashIndexBitShift) - 1u;
+
+// 0x1FFFFFFF
+const uint32_t kNumRestartsMask = (1u << kBlockedHashIndexBitShift) - 1u;
 
 uint32_t PackIndexTypeAndNumRestarts(
     BlockBasedTableOptions::DataBlockIndexType index_type,
-    uint32_t num_restarts) {
+    uint32_t num_restarts, bool has_restart_key_prefixes) {
   if (num_restarts > kMaxNumRestarts) {
     assert(0);  // mute travis "unused" warning
   }
@@ -31,9 +37,16 @@ uint32_t PackIndexTypeAndNumRestarts(
   uint32_t block_footer = num_restarts;
   if (index_type == BlockBasedTableOptions::kDataBlockBinaryAndHash) {
     block_footer |= 1u << kDataBlockIndexTypeBitShift;
+  } else if (index_type ==
+             BlockBasedTableOptions::kDataBlockBinaryAndBlockedHash) {
+    block_footer |= 1u << kDataBlockIndexTypeBitShift;
+    block_footer |= 1u << kBlockedHashIndexBitShift;
   } else if (index_type != BlockBasedTableOptions::kDataBlockBinarySearch) {
     assert(0);
   }
+  if (has_restart_key_prefixes) {
+    block_footer |= 1u << kRestartKeyPrefixesBitShift;
+  }
 
   return block_footer;
 }
@@ -41,15 +54,22 @@ uint32_t PackIndexTypeAndNumRestarts(
 void UnPackIndexTypeAndNumRestarts(
     uint32_t block_footer,
     BlockBasedTableOptions::DataBlockIndexType* index_type,
-    uint32_t* num_restarts) {
+    uint32_t* num_restarts, bool* has_restart_key_prefixes) {
   if (index_type) {
-    if (block_footer & 1u << kDataBlockIndexTypeBitShift) {
-      *index_type = BlockBasedTableOptions::kDataBlockBinaryAndHash;
-    } else {
+    if (!(block_footer & 1u << kDataBlockIndexTypeBitShift)) {
       *index_type = BlockBasedTableOptions::kDataBlockBinarySearch;
+    } else if (block_footer & 1u << kBlockedHashIndexBitShift) {
+      *index_type = BlockBasedTableOptions::kDataBlockBinaryAndBlockedHash;
+    } else {
+      *index_type = BlockBasedTableOptions::kDataBlockBinaryAndHash;
     }
   }
 
+  if (has_restart_key_prefixes) {
+    *has_restart_key_prefixes =
+        (block_footer & 1u << kRestartKeyPrefixesBitShift) != 0;
+  }
+
   if (num_restarts) {
     *num_restarts = block_footer & kNumRestartsMask;
     assert(*num_restarts <= kMaxNumRestarts);
@@ -9,17 +9,36 @@
 
 #pragma once
 
+#include "rocksdb/slice.h"
 #include "rocksdb/table.h"
 
 namespace ROCKSDB_NAMESPACE {
 
+// If has_restart_key_prefixes is true, the block stores the first 4 bytes of
+// the user key at each restart point in an array that follows the restart
+// array. Like the hash index, the flag is only honored for blocks of at most
+// kMaxBlockSizeSupportedByHashIndex bytes.
 uint32_t PackIndexTypeAndNumRestarts(
     BlockBasedTableOptions::DataBlockIndexType index_type,
-    uint32_t num_restarts);
+    uint32_t num_restarts, bool has_restart_key_prefixes = false);
 
 void UnPackIndexTypeAndNumRestarts(
     uint32_t block_footer,
     BlockBasedTableOptions::DataBlockIndexType* index_type,
-    uint32_t* num_restarts);
+    uint32_t* num_restarts, bool* has_restart_key_prefixes = nullptr);
+
+// Returns the first 4 bytes of user_key as a big-endian integer, padded with
+// zeros. If the prefixes of two keys differ, they are ordered like the keys
+// by BytewiseComparator().
+inline uint32_t RestartKeyPrefix(const Slice& user_key) {
+  uint32_t prefix = 0;
+  for (size_t i = 0; i < sizeof(prefix); i++) {
+    prefix <<= 8;
+    if (i < user_key.size()) {
+      prefix |= static_cast<unsigned char>(user_key[i]);
+    }
+  }
+  return prefix;
+}
 
 }  // namespace ROCKSDB_NAMESPACE
@@ -4,15 +4,33 @@
 //  (found in the LICENSE.Apache file in the root directory).
 #include "table/block_based/data_block_hash_index.h"
 
+#include <algorithm>
+#include <cstring>
 #include <string>
 #include <vector>
 
+#include "port/port.h"
 #include "rocksdb/slice.h"
 #include "util/coding.h"
+#include "util/fastrange.h"
 #include "util/hash.h"
+#include "util/math.h"
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
 
 namespace ROCKSDB_NAMESPACE {
 
+namespace {
+// Fingerprint of a key in a bucket of the blocked hash index, never 0. The
+// bucket is picked with the high bits of the hash, see FastRange32().
+inline uint8_t BlockedFingerprint(uint32_t hash_value) {
+  uint8_t fingerprint = static_cast<uint8_t>(hash_value);
+  return fingerprint == 0 ? 1 : fingerprint;
+}
+}  // namespace
+
 void DataBlockHashIndexBuilder::Add(const Slice& key,
                                     const size_t restart_index) {
   assert(Valid());
@@ -29,6 +47,10 @@ void DataBlockHashIndexBuilder::Add(const Slice& key,
 
 void DataBlockHashIndexBuilder::Finish(std::string& buffer) {
   assert(Valid());
+  if (blocked_) {
+    FinishBlocked(buffer);
+    return;
+  }
   uint16_t num_buckets = static_cast<uint16_t>(estimated_num_buckets_);
 
   if (num_buckets == 0) {
@@ -67,6 +89,60 @@ void DataBlockHashIndexBuilder::Finish(std::string& buffer) {
   assert(buffer.size() <= kMaxBlockSizeSupportedByHashIndex);
 }
 
+void DataBlockHashIndexBuilder::FinishBlocked(std::string& buffer) {
+  const size_t kSlots = kBlockedHashIndexSlotsPerBucket;
+  uint16_t num_buckets = static_cast<uint16_t>(NumBlockedBuckets());
+
+  size_t bucket_table_offset = buffer.size();
+  buffer.resize(bucket_table_offset +
+                num_buckets * kBlockedHashIndexBucketSize);
+  char* bucket_table = &buffer[bucket_table_offset];
+  for (uint16_t i = 0; i < num_buckets; i++) {
+    char* bucket = bucket_table + i * kBlockedHashIndexBucketSize;
+    std::memset(bucket, 0, kSlots);
+    std::memset(bucket + kSlots, kNoEntry, kSlots);
+  }
+
+  // Number of used slots per bucket, kSlots + 1 once the bucket overflowed
+  std::vector<uint8_t> num_used(num_buckets, 0);
+  for (auto& entry : hash_and_restart_pairs_) {
+    uint32_t hash_value = entry.first;
+    uint8_t restart_index = entry.second;
+    uint32_t buck_idx = FastRange32(hash_value, num_buckets);
+    char* bucket = bucket_table + buck_idx * kBlockedHashIndexBucketSize;
+    uint8_t& used = num_used[buck_idx];
+    if (used > kSlots) {
+      continue;
+    }
+    uint8_t fingerprint = BlockedFingerprint(hash_value);
+    bool found = false;
+    for (size_t i = 0; i < used && !found; i++) {
+      found = static_cast<uint8_t>(bucket[i]) == fingerprint &&
+              static_cast<uint8_t>(bucket[kSlots + i]) == restart_index;
+    }
+    if (found) {
+      // e.g. another version of the same user key
+      continue;
+    }
+    if (used == kSlots) {
+      // No fingerprint matches any more, and the last restart index sends
+      // all the lookups of the bucket to binary search
+      std::memset(bucket, 0, kSlots);
+      bucket[kBlockedHashIndexBucketSize - 1] = static_cast<char>(kCollision);
+      used = kSlots + 1;
+      continue;
+    }
+    bucket[used] = static_cast<char>(fingerprint);
+    bucket[kSlots + used] = static_cast<char>(restart_index);
+    used++;
+  }
+
+  // write NUM_BUCK
+  PutFixed16(&buffer, num_buckets);
+
+  assert(buffer.size() <= kMaxBlockSizeSupportedByHashIndex);
+}
+
 void DataBlockHashIndexBuilder::Reset() {
   estimated_num_buckets_ = 0;
   valid_ = true;
@@ -74,21 +150,103 @@ void DataBlockHashIndexBuilder::Reset() {
 }
 
 void DataBlockHashIndex::Initialize(const char* data, uint16_t size,
-                                    uint16_t* map_offset) {
+                                    uint16_t* map_offset, bool blocked) {
   assert(size >= sizeof(uint16_t));  // NUM_BUCKETS
   num_buckets_ = DecodeFixed16(data + size - sizeof(uint16_t));
+  blocked_ = blocked;
+  size_t bucket_size = blocked_ ? kBlockedHashIndexBucketSize : sizeof(uint8_t);
   assert(num_buckets_ > 0);
-  assert(size > num_buckets_ * sizeof(uint8_t));
+  if (blocked_ && size < sizeof(uint16_t) + num_buckets_ * bucket_size) {
+    // Corrupted, let the caller find the restart array out of the block
+    num_buckets_ = 0;
+    *map_offset = 0;
+    return;
+  }
+  assert(size > num_buckets_ * bucket_size);
   *map_offset = static_cast<uint16_t>(size - sizeof(uint16_t) -
-                                      num_buckets_ * sizeof(uint8_t));
+                                      num_buckets_ * bucket_size);
 }
 
 uint8_t DataBlockHashIndex::Lookup(const char* data, uint32_t map_offset,
                                    const Slice& key) const {
   uint32_t hash_value = GetSliceHash(key);
-  uint16_t idx = static_cast<uint16_t>(hash_value % num_buckets_);
   const char* bucket_table = data + map_offset;
+  if (blocked_) {
+    uint32_t idx = FastRange32(hash_value, num_buckets_);
+    return LookupBucket(bucket_table + idx * kBlockedHashIndexBucketSize,
+                        hash_value);
+  }
+  uint16_t idx = static_cast<uint16_t>(hash_value % num_buckets_);
   return static_cast<uint8_t>(*(bucket_table + idx * sizeof(uint8_t)));
 }
 
+void DataBlockHashIndex::LookupBatch(const char* data, uint32_t map_offset,
+                                     const Slice* keys, size_t num_keys,
+                                     uint8_t* entries) const {
+  const char* bucket_table = data + map_offset;
+  constexpr size_t kMaxKeysInFlight = 16;
+  uint32_t hash_values[kMaxKeysInFlight];
+  const char* buckets[kMaxKeysInFlight];
+  for (size_t start = 0; start < num_keys; start += kMaxKeysInFlight) {
+    size_t n = std::min(kMaxKeysInFlight, num_keys - start);
+    for (size_t i = 0; i < n; i++) {
+      hash_values[i] = GetSliceHash(keys[start + i]);
+      if (blocked_) {
+        buckets[i] =
+            bucket_table + FastRange32(hash_values[i], num_buckets_) *
+                               kBlockedHashIndexBucketSize;
+        // The bucket may straddle two cache lines
+        PREFETCH(buckets[i], 0 /* rw */, 3 /* locality */);
+        PREFETCH(buckets[i] + kBlockedHashIndexBucketSize - 1, 0 /* rw */,
+                 3 /* locality */);
+      } else {
+        buckets[i] = bucket_table + hash_values[i] % num_buckets_;
+        PREFETCH(buckets[i], 0 /* rw */, 3 /* locality */);
+      }
+    }
+    for (size_t i = 0; i < n; i++) {
+      entries[start + i] = blocked_
+                               ? LookupBucket(buckets[i], hash_values[i])
+                               : static_cast<uint8_t>(*buckets[i]);
+    }
+  }
+}
+
+uint8_t DataBlockHashIndex::LookupBucket(const char* bucket,
+                                         uint32_t hash_value) const {
+  const size_t kSlots = kBlockedHashIndexSlotsPerBucket;
+  static_assert(kBlockedHashIndexSlotsPerBucket == 32, "one bit per slot");
+  uint8_t fingerprint = BlockedFingerprint(hash_value);
+  uint32_t matches = 0;
+#ifdef __SSE2__
+  const __m128i needle = _mm_set1_epi8(static_cast<char>(fingerprint));
+  __m128i lo = _mm_loadu_si128(reinterpret_cast<const __m128i*>(bucket));
+  __m128i hi = _mm_loadu_si128(reinterpret_cast<const __m128i*>(bucket + 16));
+  matches = static_cast<uint32_t>(
+                _mm_movemask_epi8(_mm_cmpeq_epi8(lo, needle))) |
+            static_cast<uint32_t>(
+                _mm_movemask_epi8(_mm_cmpeq_epi8(hi, needle)))
+                << 16;
+#else
+  for (size_t i = 0; i < kSlots; i++) {
+    matches |= uint32_t{static_cast<uint8_t>(bucket[i]) == fingerprint} << i;
+  }
+#endif  // __SSE2__
+
+  const uint8_t* restart_indexes =
+      reinterpret_cast<const uint8_t*>(bucket + kSlots);
+  if (matches == 0) {
+    // The last restart index is only kCollision if the bucket overflowed
+    return restart_indexes[kSlots - 1] == kCollision ? kCollision : kNoEntry;
+  }
+  uint8_t entry = restart_indexes[CountTrailingZeroBits(matches)];
+  for (matches &= matches - 1; matches != 0; matches &= matches - 1) {
+    if (restart_indexes[CountTrailingZeroBits(matches)] != entry) {
+      // Keys of different restart intervals share the fingerprint
+      return kCollision;
+    }
+  }
+  return entry;
+}
+
 }  // namespace ROCKSDB_NAMESPACE
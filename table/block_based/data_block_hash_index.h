@@ -62,6 +62,24 @@ namespace ROCKSDB_NAMESPACE {
 //
 // Note that we only support blocks with #restart_interval < 254. If a block
 // has more restart interval than that, hash index will not be create for it.
+//
+// With kDataBlockBinaryAndBlockedHash, the hash index has a blocked layout
+// instead, flagged by another bit of the block footer:
+//
+// HASH_IDX: [BB BB BB ... BB NUM_BUCK]
+//
+// BB:        a 64-byte bucket, [FP x 32][RI x 32], i.e. the fingerprints and
+//            the restart indexes of up to 32 keys.
+// NUM_BUCK:  Number of buckets.
+//
+// A key is hashed to a bucket with FastRange32(), and its fingerprint is the
+// low byte of the same hash, with 0 reserved for empty slots. A lookup
+// compares the fingerprint with all the fingerprints of the bucket at once
+// (with SSE2 where available) and returns the restart index of the matches,
+// kNoEntry if none matches, or kCollision if the matches disagree. If more
+// than 32 distinct fingerprint/restart pairs fall in a bucket, the bucket is
+// cleared and its last restart index is set to kCollision, so that all its
+// lookups fall back to binary search.
 
 const uint8_t kNoEntry = 255;
 const uint8_t kCollision = 254;
@@ -71,6 +89,10 @@ const uint8_t kMaxRestartSupportedByHashIndex = 253;
 const size_t kMaxBlockSizeSupportedByHashIndex = 1u << 16;
 const double kDefaultUtilRatio = 0.75;
 
+// The layout of the buckets of the blocked hash index
+const size_t kBlockedHashIndexSlotsPerBucket = 32;
+const size_t kBlockedHashIndexBucketSize = 2 * kBlockedHashIndexSlotsPerBucket;
+
 class DataBlockHashIndexBuilder {
  public:
   DataBlockHashIndexBuilder()
@@ -78,11 +100,12 @@ class DataBlockHashIndexBuilder {
         estimated_num_buckets_(0),
         valid_(false) {}
 
-  void Initialize(double util_ratio) {
+  void Initialize(double util_ratio, bool blocked = false) {
     if (util_ratio <= 0) {
       util_ratio = kDefaultUtilRatio;  // sanity check
     }
     bucket_per_key_ = 1 / util_ratio;
+    blocked_ = blocked;
     valid_ = true;
   }
 
@@ -90,7 +113,12 @@ class DataBlockHashIndexBuilder {
   void Add(const Slice& key, const size_t restart_index);
   void Finish(std::string& buffer);
   void Reset();
+  inline bool Blocked() const { return blocked_; }
   inline size_t EstimateSize() const {
+    if (blocked_) {
+      return sizeof(uint16_t) +
+             NumBlockedBuckets() * kBlockedHashIndexBucketSize;
+    }
     uint16_t estimated_num_buckets =
         static_cast<uint16_t>(estimated_num_buckets_);
 
@@ -102,8 +130,19 @@ class DataBlockHashIndexBuilder {
   }
 
  private:
+  // With the blocked layout, estimated_num_buckets_ is the number of slots
+  inline size_t NumBlockedBuckets() const {
+    size_t num_buckets =
+        (static_cast<size_t>(estimated_num_buckets_) +
+         kBlockedHashIndexSlotsPerBucket - 1) /
+        kBlockedHashIndexSlotsPerBucket;
+    return num_buckets == 0 ? 1 : num_buckets;  // sanity check
+  }
+  void FinishBlocked(std::string& buffer);
+
   double bucket_per_key_;  // is the multiplicative inverse of util_ratio_
   double estimated_num_buckets_;
+  bool blocked_ = false;
 
   // Now the only usage for `valid_` is to mark false when the inserted
   // restart_index is larger than supported. In this case HashIndex is not
@@ -116,15 +155,24 @@ class DataBlockHashIndexBuilder {
 
 class DataBlockHashIndex {
  public:
-  DataBlockHashIndex() : num_buckets_(0) {}
+  DataBlockHashIndex() : num_buckets_(0), blocked_(false) {}
 
-  void Initialize(const char* data, uint16_t size, uint16_t* map_offset);
+  void Initialize(const char* data, uint16_t size, uint16_t* map_offset,
+                  bool blocked = false);
 
   uint8_t Lookup(const char* data, uint32_t map_offset, const Slice& key) const;
 
+  // Looks up the restart indexes of the `num_keys` user keys in `keys` into
+  // `entries`. All the keys are hashed and their buckets prefetched before
+  // any of them is probed, so that the cache misses overlap.
+  void LookupBatch(const char* data, uint32_t map_offset, const Slice* keys,
+                   size_t num_keys, uint8_t* entries) const;
+
   inline bool Valid() { return num_buckets_ != 0; }
 
  private:
+  uint8_t LookupBucket(const char* bucket, uint32_t hash_value) const;
+
   // To make the serialized hash index compact and to save the space overhead,
   // here all the data fields persisted in the block are in uint16 format.
   // We find that a uint16 is large enough to index every offset of a 64KiB
@@ -132,6 +180,7 @@ class DataBlockHashIndex {
   // So in other words, DataBlockHashIndex does not support block size equal
   // or greater then 64KiB.
   uint16_t num_buckets_;
+  bool blocked_;
 };
 
 }  // namespace ROCKSDB_NAMESPACE
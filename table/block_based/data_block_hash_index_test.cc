@@ -232,6 +232,101 @@ TEST(DataBlockHashIndex, DataBlockHashTestLarge) {
   }
 }
 
+TEST(DataBlockHashIndex, BlockedHashTest) {
+  DataBlockHashIndexBuilder builder;
+  builder.Initialize(0.75 /*util_ratio*/, true /* blocked */);
+
+  for (uint8_t i = 0; i < 200; i++) {
+    std::string key("key" + std::to_string(i));
+    uint8_t restart_point = i;
+    builder.Add(key, restart_point);
+  }
+
+  size_t estimated_size = builder.EstimateSize();
+
+  std::string buffer("fake content"), buffer2;
+  size_t original_size = buffer.size();
+  estimated_size += original_size;
+  builder.Finish(buffer);
+
+  ASSERT_EQ(buffer.size(), estimated_size);
+  // 200 keys take 266 slots at 0.75 utilization, i.e. 9 buckets
+  ASSERT_EQ(original_size + 9 * kBlockedHashIndexBucketSize + sizeof(uint16_t),
+            buffer.size());
+
+  buffer2 = buffer;  // test for the correctness of relative offset
+
+  Slice s(buffer2);
+  DataBlockHashIndex index;
+  uint16_t map_offset;
+  index.Initialize(s.data(), static_cast<uint16_t>(s.size()), &map_offset,
+                   true /* blocked */);
+
+  // the additional hash map should start at the end of the buffer
+  ASSERT_EQ(original_size, map_offset);
+  std::vector<std::string> keys;
+  for (uint8_t i = 0; i < 200; i++) {
+    std::string key("key" + std::to_string(i));
+    uint8_t restart_point = i;
+    ASSERT_TRUE(
+        SearchForOffset(index, s.data(), map_offset, key, restart_point));
+    keys.push_back(key);
+  }
+
+  // The batched lookup agrees with the lookups of the keys one by one
+  std::vector<Slice> key_slices(keys.begin(), keys.end());
+  std::vector<uint8_t> entries(keys.size());
+  index.LookupBatch(s.data(), map_offset, key_slices.data(), keys.size(),
+                    entries.data());
+  for (size_t i = 0; i < keys.size(); i++) {
+    ASSERT_EQ(index.Lookup(s.data(), map_offset, keys[i]), entries[i]);
+  }
+}
+
+TEST(DataBlockHashIndex, BlockedHashTestOverflow) {
+  // A single bucket for 100 keys, which overflows
+  DataBlockHashIndexBuilder builder;
+  builder.Initialize(100 /*util_ratio*/, true /* blocked */);
+
+  for (uint8_t i = 0; i < 100; i++) {
+    std::string key("key" + std::to_string(i));
+    builder.Add(key, i);
+  }
+
+  std::string buffer;
+  builder.Finish(buffer);
+  ASSERT_EQ(kBlockedHashIndexBucketSize + sizeof(uint16_t), buffer.size());
+
+  Slice s(buffer);
+  DataBlockHashIndex index;
+  uint16_t map_offset;
+  index.Initialize(s.data(), static_cast<uint16_t>(s.size()), &map_offset,
+                   true /* blocked */);
+  ASSERT_EQ(0, map_offset);
+  for (uint8_t i = 0; i < 200; i++) {
+    std::string key("key" + std::to_string(i));
+    ASSERT_EQ(kCollision, index.Lookup(s.data(), map_offset, key));
+  }
+
+  // Versions of the same keys in the same restart intervals fit
+  builder.Reset();
+  for (uint8_t i = 0; i < 100; i++) {
+    std::string key("key" + std::to_string(i % 20));
+    builder.Add(key, i % 20);
+  }
+  buffer.clear();
+  builder.Finish(buffer);
+  s = Slice(buffer);
+  index.Initialize(s.data(), static_cast<uint16_t>(s.size()), &map_offset,
+                   true /* blocked */);
+  for (uint8_t i = 0; i < 20; i++) {
+    std::string key("key" + std::to_string(i));
+    uint8_t restart_point = i;
+    ASSERT_TRUE(
+        SearchForOffset(index, s.data(), map_offset, key, restart_point));
+  }
+}
+
 TEST(DataBlockHashIndex, RestartIndexExceedMax) {
   DataBlockHashIndexBuilder builder;
   builder.Initialize(0.75 /*util_ratio*/);
@@ -529,6 +624,78 @@ TEST(DataBlockHashIndex, BlockTestLarge) {
   }
 }
 
+TEST(DataBlockHashIndex, BlockTestBlockedHash) {
+  Random rnd(1019);
+  std::vector<std::string> keys;
+  std::vector<std::string> values;
+
+  BlockBuilder builder(
+      16 /* block_restart_interval */, true /* use_delta_encoding */,
+      false /* use_value_delta_encoding */,
+      BlockBasedTableOptions::kDataBlockBinaryAndBlockedHash);
+  int num_records = 500;
+
+  GenerateRandomKVs(&keys, &values, 0, num_records);
+
+  // Existing keys end with "1", non-existing ones with "0"
+  std::vector<std::string> ikeys;
+  for (int i = 0; i < num_records; i++) {
+    std::string ukey(keys[i] + "1" /* existing key marker */);
+    InternalKey ikey(ukey, 0, kTypeValue);
+    builder.Add(ikey.Encode().ToString(), values[i]);
+    ikeys.push_back(ikey.Encode().ToString());
+  }
+
+  // read serialized contents of the block
+  Slice rawblock = builder.Finish();
+
+  // create block reader
+  BlockContents contents;
+  contents.data = rawblock;
+  Block reader(std::move(contents));
+  ASSERT_EQ(BlockBasedTableOptions::kDataBlockBinaryAndBlockedHash,
+            reader.IndexType());
+  const InternalKeyComparator icmp(BytewiseComparator());
+
+  for (int i = 0; i < num_records; i++) {
+    std::unique_ptr<DataBlockIter> iter(reader.NewDataIterator(
+        icmp.user_comparator(), kDisableGlobalSequenceNumber));
+    bool may_exist = iter->SeekForGet(ikeys[i]);
+    ASSERT_TRUE(may_exist);
+    ASSERT_TRUE(iter->Valid());
+    ASSERT_EQ(values[i], iter->value());
+  }
+
+  // Look up all the keys at once, like MultiGet()
+  std::vector<Slice> targets(ikeys.begin(), ikeys.end());
+  std::vector<uint8_t> entries(targets.size());
+  std::unique_ptr<DataBlockIter> iter(reader.NewDataIterator(
+      icmp.user_comparator(), kDisableGlobalSequenceNumber));
+  ASSERT_TRUE(iter->LookupHashIndexBatch(targets.data(), targets.size(),
+                                         entries.data()));
+  for (int i = 0; i < num_records; i++) {
+    bool may_exist = iter->SeekForGet(targets[i], entries[i]);
+    ASSERT_TRUE(may_exist);
+    ASSERT_TRUE(iter->Valid());
+    ASSERT_EQ(values[i], iter->value());
+  }
+
+  // Non-existing keys, see BlockTestLarge
+  for (int i = 0; i < num_records; i++) {
+    std::unique_ptr<DataBlockIter> iter2(reader.NewDataIterator(
+        icmp.user_comparator(), kDisableGlobalSequenceNumber));
+    std::string ukey(keys[i] + "0" /* non-existing key marker */);
+    InternalKey ikey(ukey, 0, kTypeValue);
+    bool may_exist = iter2->SeekForGet(ikey.Encode().ToString());
+    if (!may_exist) {
+      ASSERT_TRUE(iter2->Valid());
+    }
+    if (!iter2->Valid()) {
+      ASSERT_TRUE(may_exist);
+    }
+  }
+}
+
 // helper routine for DataBlockHashIndex.BlockBoundary
 void TestBoundary(InternalKey& ik1, std::string& v1, InternalKey& ik2,
                   std::string& v2, InternalKey& seek_ikey,
@@ -169,6 +169,15 @@ class FilterBlockReader {
     return Status::OK();
   }
 
+  // Returns the handle of the filter partition that a query with the
+  // internal key would read, or a null handle if the filter is not
+  // partitioned or the partition is pinned.
+  virtual BlockHandle GetPartitionHandle(
+      const ReadOptions& /*ro*/, const Slice& /*ikey*/,
+      BlockCacheLookupContext* /*lookup_context*/) {
+    return BlockHandle::NullBlockHandle();
+  }
+
   virtual bool RangeMayExist(const Slice* /*iterate_upper_bound*/,
                              const Slice& user_key_without_ts,
                              const SliceTransform* prefix_extractor,
@@ -13,10 +13,12 @@
 #include <cinttypes>
 #include <list>
 #include <string>
+#include <vector>
 
 #include "db/dbformat.h"
 #include "rocksdb/comparator.h"
 #include "rocksdb/flush_block_policy.h"
+#include "table/block_based/learned_index.h"
 #include "table/block_based/partitioned_filter_block.h"
 #include "table/format.h"
 
@@ -65,6 +67,12 @@ IndexBuilder* IndexBuilder::CreateIndexBuilder(
           persist_user_defined_timestamps);
       break;
     }
+    case BlockBasedTableOptions::kLearnedSearch: {
+      result = new LearnedIndexBuilder(comparator, table_opt.format_version,
+                                       table_opt.index_shortening, ts_sz,
+                                       persist_user_defined_timestamps);
+      break;
+    }
     default: {
       assert(!"Do not recognize the index type ");
       break;
@@ -107,6 +115,60 @@ void ShortenedIndexBuilder::FindShortInternalKeySuccessor(
   }
 }
 
+void LearnedIndexBuilder::AddIndexEntry(std::string* last_key_in_current_block,
+                                        const Slice* first_key_in_next_block,
+                                        const BlockHandle& block_handle) {
+  if (first_key_in_next_block != nullptr) {
+    if (shortening_mode_ !=
+        BlockBasedTableOptions::IndexShorteningMode::kNoShortening) {
+      ShortenedIndexBuilder::FindShortestInternalKeySeparator(
+          *comparator_->user_comparator(), last_key_in_current_block,
+          *first_key_in_next_block);
+    }
+    if (!seperator_is_key_plus_seq_ &&
+        ShouldUseKeyPlusSeqAsSeparator(*last_key_in_current_block,
+                                       *first_key_in_next_block)) {
+      seperator_is_key_plus_seq_ = true;
+    }
+  } else {
+    if (shortening_mode_ == BlockBasedTableOptions::IndexShorteningMode::
+                                kShortenSeparatorsAndSuccessor) {
+      ShortenedIndexBuilder::FindShortInternalKeySuccessor(
+          *comparator_->user_comparator(), last_key_in_current_block);
+    }
+  }
+  separators_.push_back(*last_key_in_current_block);
+  handles_.push_back(block_handle);
+}
+
+Status LearnedIndexBuilder::Finish(
+    IndexBlocks* index_blocks,
+    const BlockHandle& /*last_partition_block_handle*/) {
+  const bool strip_ts = ts_sz_ > 0 && !persist_user_defined_timestamps_;
+  std::vector<Slice> keys;
+  keys.reserve(separators_.size());
+  for (auto& separator : separators_) {
+    if (seperator_is_key_plus_seq_) {
+      if (strip_ts) {
+        std::string stripped;
+        StripTimestampFromInternalKey(&stripped, separator, ts_sz_);
+        separator.swap(stripped);
+      }
+      keys.emplace_back(separator);
+    } else {
+      Slice user_key = ExtractUserKey(separator);
+      keys.push_back(strip_ts ? StripTimestampFromUserKey(user_key, ts_sz_)
+                              : user_key);
+    }
+  }
+  EncodeLearnedIndex(keys, handles_, seperator_is_key_plus_seq_, kMaxError,
+                     &learned_index_);
+  index_block_builder_.Add(Slice(), learned_index_);
+  index_blocks->index_block_contents = index_block_builder_.Finish();
+  index_size_ = index_blocks->index_block_contents.size();
+  return Status::OK();
+}
+
 PartitionedIndexBuilder* PartitionedIndexBuilder::CreateIndexBuilder(
     const InternalKeyComparator* comparator,
     const bool use_value_delta_encoding,
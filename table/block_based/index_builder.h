@@ -13,6 +13,7 @@
 #include <list>
 #include <string>
 #include <unordered_map>
+#include <vector>
 
 #include "db/dbformat.h"
 #include "rocksdb/comparator.h"
@@ -291,6 +292,56 @@ class ShortenedIndexBuilder : public IndexBuilder {
   std::string current_block_first_internal_key_;
 };
 
+// This index builder buffers the separators of the data blocks, shortened as
+// by ShortenedIndexBuilder, and serializes them at Finish() as a learned
+// index, see learned_index.h: the separators without their common prefix,
+// fixed-width block handles and a piecewise linear model of the position of
+// a key among the separators. The learned index is the only entry of the
+// index block.
+class LearnedIndexBuilder : public IndexBuilder {
+ public:
+  // The maximum distance between the predicted and the actual position of a
+  // separator in the index.
+  static constexpr uint32_t kMaxError = 8;
+
+  LearnedIndexBuilder(
+      const InternalKeyComparator* comparator, const uint32_t format_version,
+      BlockBasedTableOptions::IndexShorteningMode shortening_mode,
+      size_t ts_sz, const bool persist_user_defined_timestamps)
+      : IndexBuilder(comparator, ts_sz, persist_user_defined_timestamps),
+        index_block_builder_(
+            1 /* block_restart_interval */, true /*use_delta_encoding*/,
+            false /* use_value_delta_encoding */,
+            BlockBasedTableOptions::kDataBlockBinarySearch /* index_type */,
+            0.75 /* data_block_hash_table_util_ratio */, 0 /* ts_sz */,
+            true /* persist_user_defined_timestamps */,
+            true /* is_user_key */),
+        seperator_is_key_plus_seq_(format_version <= 2),
+        shortening_mode_(shortening_mode) {}
+
+  void AddIndexEntry(std::string* last_key_in_current_block,
+                     const Slice* first_key_in_next_block,
+                     const BlockHandle& block_handle) override;
+
+  using IndexBuilder::Finish;
+  Status Finish(IndexBlocks* index_blocks,
+                const BlockHandle& /*last_partition_block_handle*/) override;
+
+  size_t IndexSize() const override { return index_size_; }
+
+  bool seperator_is_key_plus_seq() override {
+    return seperator_is_key_plus_seq_;
+  }
+
+ private:
+  BlockBuilder index_block_builder_;
+  std::vector<std::string> separators_;
+  std::vector<BlockHandle> handles_;
+  std::string learned_index_;
+  bool seperator_is_key_plus_seq_;
+  BlockBasedTableOptions::IndexShorteningMode shortening_mode_;
+};
+
 // HashIndexBuilder contains a binary-searchable primary index and the
 // metadata for secondary hash index construction.
 // The metadata for hash index consists two parts:
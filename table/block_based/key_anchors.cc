@@ -0,0 +1,77 @@
+//  Copyright (c) 2011-present, Facebook, Inc.  All rights reserved.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+
+#include "table/block_based/key_anchors.h"
+
+#include <cassert>
+
+#include "util/coding.h"
+
+namespace ROCKSDB_NAMESPACE {
+
+void KeyAnchorsBuilder::AddBlock(const Slice& last_user_key,
+                                 const BlockHandle& handle) {
+  const uint64_t block_end = handle.offset() + handle.size();
+  assert(block_end >= prev_block_end_);
+  range_size_ += block_end - prev_block_end_;
+  prev_block_end_ = block_end;
+  if (++blocks_in_range_ < blocks_per_range_) {
+    last_user_key_.assign(last_user_key.data(), last_user_key.size());
+    return;
+  }
+
+  anchors_.emplace_back(last_user_key, static_cast<size_t>(range_size_));
+  blocks_in_range_ = 0;
+  range_size_ = 0;
+  if (anchors_.size() == kMaxAnchors) {
+    for (size_t i = 0; i < kMaxAnchors / 2; i++) {
+      size_t range_size =
+          anchors_[2 * i].range_size + anchors_[2 * i + 1].range_size;
+      anchors_[i].user_key = std::move(anchors_[2 * i + 1].user_key);
+      anchors_[i].range_size = range_size;
+    }
+    anchors_.resize(kMaxAnchors / 2, TableReader::Anchor(Slice(), 0));
+    blocks_per_range_ *= 2;
+  }
+}
+
+Slice KeyAnchorsBuilder::Finish() {
+  if (blocks_in_range_ > 0) {
+    anchors_.emplace_back(last_user_key_, static_cast<size_t>(range_size_));
+    blocks_in_range_ = 0;
+  }
+  buf_.clear();
+  PutVarint32(&buf_, static_cast<uint32_t>(anchors_.size()));
+  for (const auto& anchor : anchors_) {
+    PutLengthPrefixedSlice(&buf_, anchor.user_key);
+    PutVarint64(&buf_, anchor.range_size);
+  }
+  return buf_;
+}
+
+Status DecodeKeyAnchors(const Slice& data,
+                        std::vector<TableReader::Anchor>* anchors) {
+  Slice input = data;
+  uint32_t num_anchors = 0;
+  if (!GetVarint32(&input, &num_anchors)) {
+    return Status::Corruption("Bad key anchors block");
+  }
+  anchors->reserve(anchors->size() + num_anchors);
+  for (uint32_t i = 0; i < num_anchors; i++) {
+    Slice user_key;
+    uint64_t range_size = 0;
+    if (!GetLengthPrefixedSlice(&input, &user_key) ||
+        !GetVarint64(&input, &range_size)) {
+      return Status::Corruption("Bad key anchors block");
+    }
+    anchors->emplace_back(user_key, static_cast<size_t>(range_size));
+  }
+  if (!input.empty()) {
+    return Status::Corruption("Bad key anchors block");
+  }
+  return Status::OK();
+}
+
+}  // namespace ROCKSDB_NAMESPACE
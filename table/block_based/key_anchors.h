@@ -0,0 +1,59 @@
+//  Copyright (c) 2011-present, Facebook, Inc.  All rights reserved.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "rocksdb/slice.h"
+#include "rocksdb/status.h"
+#include "table/format.h"
+#include "table/table_reader.h"
+
+namespace ROCKSDB_NAMESPACE {
+
+// Key anchors split the data blocks of a table into ranges of about the same
+// size, see BlockBasedTableOptions::store_key_anchors. Each anchor is the
+// last user key of a range and the size of the blocks in the range. The
+// builder starts with one block per range and, whenever kMaxAnchors ranges
+// are full, merges them pairwise and doubles the number of blocks per range,
+// so that a table has between kMaxAnchors / 2 and kMaxAnchors anchors unless
+// it has fewer blocks than that. Encoding:
+//
+//   num_anchors: varint32
+//   anchors: num_anchors * (user_key: length prefixed slice,
+//                           range_size: varint64)
+
+class KeyAnchorsBuilder {
+ public:
+  static constexpr size_t kMaxAnchors = 256;
+
+  // Adds the next data block of the table, with the user key of its last
+  // entry.
+  void AddBlock(const Slice& last_user_key, const BlockHandle& handle);
+
+  bool IsEmpty() const { return anchors_.empty() && blocks_in_range_ == 0; }
+
+  // Returns the encoded anchors, which are valid until the builder is
+  // destroyed. No blocks may be added afterwards.
+  Slice Finish();
+
+ private:
+  std::vector<TableReader::Anchor> anchors_;
+  uint64_t blocks_per_range_ = 1;
+  // The blocks added since the last full range
+  uint64_t blocks_in_range_ = 0;
+  uint64_t range_size_ = 0;
+  std::string last_user_key_;
+  uint64_t prev_block_end_ = 0;
+  std::string buf_;
+};
+
+// Parses encoded key anchors, appending them to `anchors`
+Status DecodeKeyAnchors(const Slice& data,
+                        std::vector<TableReader::Anchor>* anchors);
+
+}  // namespace ROCKSDB_NAMESPACE
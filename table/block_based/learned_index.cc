@@ -0,0 +1,404 @@
+//  Copyright (c) 2011-present, Facebook, Inc.  All rights reserved.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+
+#include "table/block_based/learned_index.h"
+
+#include <algorithm>
+#include <cstring>
+#include <limits>
+
+#include "monitoring/perf_context_imp.h"
+#include "util/coding.h"
+
+namespace ROCKSDB_NAMESPACE {
+
+namespace {
+constexpr size_t kSegmentSize = 2 * sizeof(uint64_t) + sizeof(uint32_t);
+
+int BytesNeeded(uint64_t value) {
+  int width = 1;
+  while (width < 8 && (value >> (8 * width)) != 0) {
+    width++;
+  }
+  return width;
+}
+
+void PutFixedWidth(std::string* dst, uint64_t value, int width) {
+  for (int i = 0; i < width; i++) {
+    dst->push_back(static_cast<char>((value >> (8 * i)) & 0xff));
+  }
+}
+
+uint64_t DecodeFixedWidth(const char* ptr, int width) {
+  uint64_t value = 0;
+  for (int i = width - 1; i >= 0; i--) {
+    value = (value << 8) | static_cast<unsigned char>(ptr[i]);
+  }
+  return value;
+}
+
+// The input of the model: the 8 bytes of the user key that follow the prefix,
+// big-endian, so that it preserves the bytewise order of the keys.
+uint64_t MapKey(const Slice& user_key, const Slice& prefix) {
+  if (!user_key.starts_with(prefix)) {
+    return user_key.compare(prefix) < 0 ? 0
+                                        : std::numeric_limits<uint64_t>::max();
+  }
+  uint64_t x = 0;
+  for (size_t i = prefix.size(); i < prefix.size() + sizeof(x); i++) {
+    x <<= 8;
+    if (i < user_key.size()) {
+      x |= static_cast<unsigned char>(user_key[i]);
+    }
+  }
+  return x;
+}
+}  // namespace
+
+void EncodeLearnedIndex(const std::vector<Slice>& keys,
+                        const std::vector<BlockHandle>& handles,
+                        bool keys_include_seq, uint32_t max_error,
+                        std::string* dst) {
+  assert(keys.size() == handles.size());
+  const uint32_t num_entries = static_cast<uint32_t>(keys.size());
+  auto user_key_of = [&](uint32_t i) {
+    return keys_include_seq ? ExtractUserKey(keys[i]) : keys[i];
+  };
+
+  size_t prefix_size = num_entries > 0 ? user_key_of(0).size() : 0;
+  for (uint32_t i = 1; i < num_entries; i++) {
+    prefix_size = std::min(
+        prefix_size, user_key_of(0).difference_offset(user_key_of(i)));
+  }
+  const Slice prefix =
+      num_entries > 0 ? Slice(keys[0].data(), prefix_size) : Slice();
+
+  bool fixed_key_size = true;
+  size_t keys_size = 0;
+  uint64_t max_offset = 0;
+  uint64_t max_size = 0;
+  for (uint32_t i = 0; i < num_entries; i++) {
+    const size_t suffix_size = keys[i].size() - prefix_size;
+    fixed_key_size &= suffix_size == keys[0].size() - prefix_size;
+    keys_size += suffix_size;
+    max_offset = std::max(max_offset, handles[i].offset());
+    max_size = std::max(max_size, handles[i].size());
+  }
+  const int key_end_width = fixed_key_size ? 0 : BytesNeeded(keys_size);
+  const int offset_width = BytesNeeded(max_offset);
+  const int size_width = BytesNeeded(max_size);
+
+  // Fit the segments with the shrinking cone algorithm: a segment starts at
+  // a key, and is extended for as long as some slope predicts all of its
+  // keys within max_error. Keys that map to the same input are predicted at
+  // the first of them.
+  std::string segments;
+  uint32_t num_segments = 0;
+  uint64_t first_x = 0;
+  uint32_t first_pos = 0;
+  double min_slope = 0;
+  double max_slope = std::numeric_limits<double>::infinity();
+  auto add_segment = [&]() {
+    const double slope = max_slope == std::numeric_limits<double>::infinity()
+                             ? 0
+                             : (min_slope + max_slope) / 2;
+    uint64_t slope_bits;
+    memcpy(&slope_bits, &slope, sizeof(slope_bits));
+    PutFixed64(&segments, first_x);
+    PutFixed64(&segments, slope_bits);
+    PutFixed32(&segments, first_pos);
+    num_segments++;
+  };
+  uint64_t prev_x = 0;
+  for (uint32_t i = 0; i < num_entries; i++) {
+    const uint64_t x = MapKey(user_key_of(i), prefix);
+    if (i > 0 && x == prev_x) {
+      continue;
+    }
+    prev_x = x;
+    if (i > 0) {
+      const double dx = static_cast<double>(x - first_x);
+      const double dy = static_cast<double>(i) - first_pos;
+      const double lower = (dy - max_error) / dx;
+      const double upper = (dy + max_error) / dx;
+      if (lower <= max_slope && upper >= min_slope) {
+        min_slope = std::max(min_slope, lower);
+        max_slope = std::min(max_slope, upper);
+        continue;
+      }
+      add_segment();
+    }
+    first_x = x;
+    first_pos = i;
+    min_slope = 0;
+    max_slope = std::numeric_limits<double>::infinity();
+  }
+  if (num_entries > 0) {
+    add_segment();
+  }
+
+  PutVarint32(dst, num_entries);
+  PutVarint32(dst, max_error);
+  PutLengthPrefixedSlice(dst, prefix);
+  dst->push_back(static_cast<char>(key_end_width));
+  if (key_end_width == 0) {
+    PutVarint32(dst, static_cast<uint32_t>(
+                         num_entries > 0 ? keys[0].size() - prefix_size : 0));
+  }
+  dst->push_back(static_cast<char>(offset_width));
+  dst->push_back(static_cast<char>(size_width));
+  PutVarint32(dst, num_segments);
+  if (key_end_width > 0) {
+    size_t key_end = 0;
+    for (uint32_t i = 0; i < num_entries; i++) {
+      key_end += keys[i].size() - prefix_size;
+      PutFixedWidth(dst, key_end, key_end_width);
+    }
+  }
+  for (uint32_t i = 0; i < num_entries; i++) {
+    dst->append(keys[i].data() + prefix_size, keys[i].size() - prefix_size);
+  }
+  for (uint32_t i = 0; i < num_entries; i++) {
+    PutFixedWidth(dst, handles[i].offset(), offset_width);
+  }
+  for (uint32_t i = 0; i < num_entries; i++) {
+    PutFixedWidth(dst, handles[i].size(), size_width);
+  }
+  dst->append(segments);
+}
+
+LearnedIndexIterator::LearnedIndexIterator(const InternalKeyComparator* icmp,
+                                           const Slice& contents,
+                                           bool key_includes_seq,
+                                           size_t pad_ts_sz)
+    : icmp_(icmp),
+      key_includes_seq_(key_includes_seq),
+      pad_ts_sz_(pad_ts_sz) {
+  Slice input = contents;
+  uint32_t num_entries = 0;
+  bool ok = GetVarint32(&input, &num_entries) &&
+            GetVarint32(&input, &max_error_) &&
+            GetLengthPrefixedSlice(&input, &prefix_) && !input.empty();
+  if (ok) {
+    key_end_width_ = input[0];
+    input.remove_prefix(1);
+    ok = key_end_width_ != 0 || GetVarint32(&input, &fixed_key_size_);
+  }
+  if (ok && input.size() >= 2) {
+    offset_width_ = input[0];
+    size_width_ = input[1];
+    input.remove_prefix(2);
+    ok = GetVarint32(&input, &num_segments_);
+  } else {
+    ok = false;
+  }
+  ok = ok && key_end_width_ >= 0 && key_end_width_ <= 8 &&
+       offset_width_ > 0 && offset_width_ <= 8 && size_width_ > 0 &&
+       size_width_ <= 8 && (num_entries == 0) == (num_segments_ == 0);
+  if (ok) {
+    const uint64_t key_ends_size = uint64_t{num_entries} * key_end_width_;
+    ok = input.size() >= key_ends_size;
+    if (ok) {
+      key_ends_ = input.data();
+      input.remove_prefix(key_ends_size);
+    }
+  }
+  if (ok) {
+    uint64_t keys_size = uint64_t{num_entries} * fixed_key_size_;
+    if (key_end_width_ > 0 && num_entries > 0) {
+      keys_size = DecodeFixedWidth(
+          key_ends_ + (num_entries - 1) * key_end_width_, key_end_width_);
+    }
+    const uint64_t rest_size =
+        uint64_t{num_entries} * (offset_width_ + size_width_) +
+        uint64_t{num_segments_} * kSegmentSize;
+    ok = input.size() == keys_size + rest_size;
+    if (ok) {
+      keys_ = input.data();
+      offsets_ = keys_ + keys_size;
+      sizes_ = offsets_ + uint64_t{num_entries} * offset_width_;
+      segments_ = sizes_ + uint64_t{num_entries} * size_width_;
+    }
+  }
+  if (ok) {
+    num_entries_ = num_entries;
+    current_ = num_entries_;
+  } else {
+    status_ = Status::Corruption("Bad learned index block");
+  }
+}
+
+Slice LearnedIndexIterator::SuffixAt(uint32_t index) const {
+  if (key_end_width_ == 0) {
+    return Slice(keys_ + uint64_t{index} * fixed_key_size_, fixed_key_size_);
+  }
+  const uint64_t begin =
+      index == 0 ? 0
+                 : DecodeFixedWidth(key_ends_ + (index - 1) * key_end_width_,
+                                    key_end_width_);
+  const uint64_t end =
+      DecodeFixedWidth(key_ends_ + index * key_end_width_, key_end_width_);
+  return Slice(keys_ + begin, end - begin);
+}
+
+void LearnedIndexIterator::KeyAt(uint32_t index, std::string* buf) {
+  const Slice suffix = SuffixAt(index);
+  std::string* stored = pad_ts_sz_ == 0 ? buf : &stored_key_;
+  stored->assign(prefix_.data(), prefix_.size());
+  stored->append(suffix.data(), suffix.size());
+  if (pad_ts_sz_ > 0) {
+    buf->clear();
+    if (key_includes_seq_) {
+      PadInternalKeyWithMinTimestamp(buf, *stored, pad_ts_sz_);
+    } else {
+      AppendKeyWithMinTimestamp(buf, *stored, pad_ts_sz_);
+    }
+  }
+}
+
+int LearnedIndexIterator::CompareKeyAt(uint32_t index, const Slice& target) {
+  KeyAt(index, &scratch_);
+  return key_includes_seq_
+             ? icmp_->Compare(scratch_, target)
+             : icmp_->user_comparator()->Compare(scratch_, target);
+}
+
+LearnedIndexIterator::Segment LearnedIndexIterator::SegmentAt(
+    uint32_t index) const {
+  const char* ptr = segments_ + uint64_t{index} * kSegmentSize;
+  Segment segment;
+  segment.first_x = DecodeFixed64(ptr);
+  const uint64_t slope_bits = DecodeFixed64(ptr + sizeof(uint64_t));
+  memcpy(&segment.slope, &slope_bits, sizeof(segment.slope));
+  segment.first_pos = DecodeFixed32(ptr + 2 * sizeof(uint64_t));
+  return segment;
+}
+
+uint32_t LearnedIndexIterator::Predict(const Slice& target) const {
+  Slice user_key = key_includes_seq_ ? ExtractUserKey(target) : target;
+  if (pad_ts_sz_ > 0) {
+    user_key = StripTimestampFromUserKey(user_key, pad_ts_sz_);
+  }
+  const uint64_t x = MapKey(user_key, prefix_);
+  // The last segment that starts at or before x.
+  uint32_t left = 0;
+  uint32_t right = num_segments_;
+  while (right - left > 1) {
+    const uint32_t mid = left + (right - left) / 2;
+    if (DecodeFixed64(segments_ + uint64_t{mid} * kSegmentSize) <= x) {
+      left = mid;
+    } else {
+      right = mid;
+    }
+  }
+  const Segment segment = SegmentAt(left);
+  if (x <= segment.first_x) {
+    return std::min(segment.first_pos, num_entries_ - 1);
+  }
+  const double pos = segment.first_pos +
+                     segment.slope * static_cast<double>(x - segment.first_x);
+  if (!(pos < num_entries_ - 1)) {
+    return num_entries_ - 1;
+  }
+  return pos > 0 ? static_cast<uint32_t>(pos + 0.5) : 0;
+}
+
+uint32_t LearnedIndexIterator::LowerBound(const Slice& target) {
+  if (num_entries_ == 0) {
+    return 0;
+  }
+  // The answer is in [left, right]: the keys before left are < target and
+  // those at right and after are >= target. Starting from the prediction,
+  // gallop until both ends are known, then binary search.
+  const uint32_t pos = Predict(target);
+  uint32_t left = 0;
+  uint32_t right = num_entries_;
+  uint64_t step = uint64_t{max_error_} + 1;
+  if (CompareKeyAt(pos, target) >= 0) {
+    right = pos;
+    while (right > 0) {
+      const uint32_t probe =
+          right > step ? static_cast<uint32_t>(right - step) : 0;
+      if (CompareKeyAt(probe, target) < 0) {
+        left = probe + 1;
+        break;
+      }
+      right = probe;
+      step *= 2;
+    }
+  } else {
+    left = pos + 1;
+    while (left < num_entries_) {
+      const uint32_t probe = static_cast<uint32_t>(
+          std::min<uint64_t>(left + step - 1, num_entries_ - 1));
+      if (CompareKeyAt(probe, target) >= 0) {
+        right = probe;
+        break;
+      }
+      left = probe + 1;
+      step *= 2;
+    }
+  }
+  while (left < right) {
+    const uint32_t mid = left + (right - left) / 2;
+    if (CompareKeyAt(mid, target) < 0) {
+      left = mid + 1;
+    } else {
+      right = mid;
+    }
+  }
+  return left;
+}
+
+void LearnedIndexIterator::SetCurrent(uint32_t index) {
+  current_ = index;
+  if (Valid()) {
+    KeyAt(current_, &key_);
+  }
+}
+
+void LearnedIndexIterator::SeekToFirst() { SetCurrent(0); }
+
+void LearnedIndexIterator::SeekToLast() {
+  SetCurrent(num_entries_ > 0 ? num_entries_ - 1 : 0);
+}
+
+void LearnedIndexIterator::Seek(const Slice& target) {
+  PERF_TIMER_GUARD(block_seek_nanos);
+  SetCurrent(LowerBound(key_includes_seq_ ? target : ExtractUserKey(target)));
+}
+
+void LearnedIndexIterator::SeekForPrev(const Slice& target) {
+  PERF_TIMER_GUARD(block_seek_nanos);
+  const Slice seek_key = key_includes_seq_ ? target : ExtractUserKey(target);
+  uint32_t index = LowerBound(seek_key);
+  if (index == num_entries_ || CompareKeyAt(index, seek_key) > 0) {
+    // Past the first entry > target, which is invalid if it is the first.
+    index = index == 0 ? num_entries_ : index - 1;
+  }
+  SetCurrent(index);
+}
+
+void LearnedIndexIterator::Next() {
+  assert(Valid());
+  SetCurrent(current_ + 1);
+}
+
+void LearnedIndexIterator::Prev() {
+  assert(Valid());
+  SetCurrent(current_ == 0 ? num_entries_ : current_ - 1);
+}
+
+IndexValue LearnedIndexIterator::value() const {
+  assert(Valid());
+  const BlockHandle handle(
+      DecodeFixedWidth(offsets_ + uint64_t{current_} * offset_width_,
+                       offset_width_),
+      DecodeFixedWidth(sizes_ + uint64_t{current_} * size_width_,
+                       size_width_));
+  return IndexValue(handle, Slice());
+}
+
+}  // namespace ROCKSDB_NAMESPACE
@@ -0,0 +1,128 @@
+//  Copyright (c) 2011-present, Facebook, Inc.  All rights reserved.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "db/dbformat.h"
+#include "table/format.h"
+#include "table/internal_iterator.h"
+
+namespace ROCKSDB_NAMESPACE {
+
+// A learned index maps the separator of each data block to the block's
+// handle, like the binary search index, but predicts the position of a key
+// among the separators with a piecewise linear model instead of binary
+// searching the whole index. The model is trained on the first 8 bytes that
+// follow the common prefix of the separators' user keys, and its prediction
+// is within `max_error` positions of the actual one for every separator.
+// Lookups search that window, and widen it exponentially if the prediction
+// is off, e.g. for a comparator that does not order keys bytewise, so
+// results never depend on the model.
+//
+// The separators are stored without their common prefix and the block
+// handles in fixed-width little-endian fields, so that any entry can be read
+// without decoding the others:
+//
+//   num_entries: varint32
+//   max_error: varint32
+//   prefix: length prefixed slice
+//   key_end_width: 1 byte, 0 if all suffixes have the same length
+//   [fixed_key_size: varint32, if key_end_width is 0]
+//   offset_width: 1 byte
+//   size_width: 1 byte
+//   num_segments: varint32
+//   key_ends: num_entries * key_end_width bytes, the end of each suffix
+//   keys: the suffixes of the separators
+//   offsets: num_entries * offset_width bytes
+//   sizes: num_entries * size_width bytes
+//   segments: num_segments * (fixed64 first_x, fixed64 slope as a double,
+//             fixed32 first position)
+
+// Appends the learned index of the sorted separators `keys`, which are
+// internal keys if keys_include_seq and user keys otherwise, and of the
+// handles of their blocks to *dst.
+void EncodeLearnedIndex(const std::vector<Slice>& keys,
+                        const std::vector<BlockHandle>& handles,
+                        bool keys_include_seq, uint32_t max_error,
+                        std::string* dst);
+
+// Iterates over the entries of an encoded learned index. `contents` must
+// outlive the iterator. If the separators were stored without user-defined
+// timestamps, pad_ts_sz is the size of the timestamps that the keys are
+// padded with, see BlockBasedTableOptions::persist_user_defined_timestamps.
+class LearnedIndexIterator : public InternalIteratorBase<IndexValue> {
+ public:
+  LearnedIndexIterator(const InternalKeyComparator* icmp,
+                       const Slice& contents, bool key_includes_seq,
+                       size_t pad_ts_sz);
+
+  bool Valid() const override { return current_ < num_entries_; }
+  void SeekToFirst() override;
+  void SeekToLast() override;
+  void Seek(const Slice& target) override;
+  void SeekForPrev(const Slice& target) override;
+  void Next() override;
+  void Prev() override;
+
+  Slice key() const override {
+    assert(Valid());
+    return key_;
+  }
+  Slice user_key() const override {
+    assert(Valid());
+    return key_includes_seq_ ? ExtractUserKey(key_) : Slice(key_);
+  }
+  IndexValue value() const override;
+  Status status() const override { return status_; }
+
+ private:
+  struct Segment {
+    uint64_t first_x;
+    double slope;
+    uint32_t first_pos;
+  };
+
+  Slice SuffixAt(uint32_t index) const;
+  // Sets *buf to the key of the entry at index.
+  void KeyAt(uint32_t index, std::string* buf);
+  // Compares the key of the entry at index to target, which is a user key if
+  // the separators are.
+  int CompareKeyAt(uint32_t index, const Slice& target);
+  Segment SegmentAt(uint32_t index) const;
+  // Returns an estimate of the position of the first entry >= target.
+  uint32_t Predict(const Slice& target) const;
+  // Returns the position of the first entry >= target, or num_entries_.
+  uint32_t LowerBound(const Slice& target);
+  void SetCurrent(uint32_t index);
+
+  const InternalKeyComparator* icmp_;
+  const bool key_includes_seq_;
+  const size_t pad_ts_sz_;
+  Status status_;
+
+  uint32_t num_entries_ = 0;
+  uint32_t max_error_ = 0;
+  Slice prefix_;
+  int key_end_width_ = 0;
+  uint32_t fixed_key_size_ = 0;
+  int offset_width_ = 0;
+  int size_width_ = 0;
+  uint32_t num_segments_ = 0;
+  const char* key_ends_ = nullptr;
+  const char* keys_ = nullptr;
+  const char* offsets_ = nullptr;
+  const char* sizes_ = nullptr;
+  const char* segments_ = nullptr;
+
+  uint32_t current_ = 0;
+  std::string key_;
+  std::string scratch_;
+  std::string stored_key_;
+};
+
+}  // namespace ROCKSDB_NAMESPACE
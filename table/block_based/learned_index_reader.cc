@@ -0,0 +1,92 @@
+//  Copyright (c) 2011-present, Facebook, Inc.  All rights reserved.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+#include "table/block_based/learned_index_reader.h"
+
+#include "table/block_based/learned_index.h"
+#include "util/coding.h"
+
+namespace ROCKSDB_NAMESPACE {
+namespace {
+// Returns the value of the only entry of the index block, which has an empty
+// key.
+Status GetLearnedIndex(const Block* index_block, Slice* contents) {
+  const char* p = index_block->data();
+  const char* limit = p + index_block->size();
+  uint32_t shared = 0;
+  uint32_t non_shared = 0;
+  uint32_t value_length = 0;
+  if ((p = GetVarint32Ptr(p, limit, &shared)) == nullptr ||
+      (p = GetVarint32Ptr(p, limit, &non_shared)) == nullptr ||
+      (p = GetVarint32Ptr(p, limit, &value_length)) == nullptr ||
+      shared != 0 || non_shared != 0 ||
+      static_cast<size_t>(limit - p) < value_length) {
+    return Status::Corruption("Bad learned index block");
+  }
+  *contents = Slice(p, value_length);
+  return Status::OK();
+}
+}  // namespace
+
+Status LearnedIndexReader::Create(
+    const BlockBasedTable* table, const ReadOptions& ro,
+    FilePrefetchBuffer* prefetch_buffer, bool use_cache, bool prefetch,
+    bool pin, BlockCacheLookupContext* lookup_context,
+    std::unique_ptr<IndexReader>* index_reader) {
+  assert(table != nullptr);
+  assert(table->get_rep());
+  assert(!pin || prefetch);
+  assert(index_reader != nullptr);
+
+  CachableEntry<Block> index_block;
+  if (prefetch || !use_cache) {
+    const Status s =
+        ReadIndexBlock(table, prefetch_buffer, ro, use_cache,
+                       /*get_context=*/nullptr, lookup_context, &index_block);
+    if (!s.ok()) {
+      return s;
+    }
+
+    if (use_cache && !pin) {
+      index_block.Reset();
+    }
+  }
+
+  index_reader->reset(new LearnedIndexReader(table, std::move(index_block)));
+
+  return Status::OK();
+}
+
+InternalIteratorBase<IndexValue>* LearnedIndexReader::NewIterator(
+    const ReadOptions& read_options, bool /* disable_prefix_seek */,
+    IndexBlockIter* iter, GetContext* get_context,
+    BlockCacheLookupContext* lookup_context) {
+  const bool no_io = (read_options.read_tier == kBlockCacheTier);
+  CachableEntry<Block> index_block;
+  Status s = GetOrReadIndexBlock(no_io, get_context, lookup_context,
+                                 &index_block, read_options);
+  Slice contents;
+  if (s.ok()) {
+    s = GetLearnedIndex(index_block.GetValue(), &contents);
+  }
+  if (!s.ok()) {
+    if (iter != nullptr) {
+      iter->Invalidate(s);
+      return iter;
+    }
+
+    return NewErrorInternalIterator<IndexValue>(s);
+  }
+
+  const size_t pad_ts_sz =
+      user_defined_timestamps_persisted()
+          ? 0
+          : internal_comparator()->user_comparator()->timestamp_size();
+  auto it = new LearnedIndexIterator(internal_comparator(), contents,
+                                     index_key_includes_seq(), pad_ts_sz);
+  index_block.TransferTo(it);
+
+  return it;
+}
+}  // namespace ROCKSDB_NAMESPACE
@@ -0,0 +1,197 @@
+//  Copyright (c) 2011-present, Facebook, Inc.  All rights reserved.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+
+#include "table/block_based/learned_index.h"
+
+#include <algorithm>
+#include <set>
+#include <string>
+#include <vector>
+
+#include "db/dbformat.h"
+#include "test_util/testharness.h"
+#include "util/coding.h"
+#include "util/math.h"
+#include "util/random.h"
+
+namespace ROCKSDB_NAMESPACE {
+
+class LearnedIndexTest : public testing::Test {
+ protected:
+  // Encodes the sorted keys with a handle per key and checks that seeks to
+  // random targets find the same entries as a binary search.
+  void Verify(const Comparator* ucmp, const std::vector<std::string>& keys,
+              bool keys_include_seq,
+              const std::vector<std::string>& targets) {
+    InternalKeyComparator icmp(ucmp);
+    std::vector<Slice> key_slices(keys.begin(), keys.end());
+    std::vector<BlockHandle> handles;
+    for (size_t i = 0; i < keys.size(); i++) {
+      handles.emplace_back(i * 4096, 4000 + i % 7);
+    }
+    std::string contents;
+    EncodeLearnedIndex(key_slices, handles, keys_include_seq,
+                       8 /* max_error */, &contents);
+
+    LearnedIndexIterator iter(&icmp, contents, keys_include_seq,
+                              0 /* pad_ts_sz */);
+    ASSERT_OK(iter.status());
+    size_t count = 0;
+    for (iter.SeekToFirst(); iter.Valid(); iter.Next(), count++) {
+      ASSERT_EQ(keys[count], iter.key().ToString());
+      ASSERT_EQ(handles[count].offset(), iter.value().handle.offset());
+      ASSERT_EQ(handles[count].size(), iter.value().handle.size());
+    }
+    ASSERT_EQ(keys.size(), count);
+    for (iter.SeekToLast(); iter.Valid(); iter.Prev()) {
+      ASSERT_EQ(keys[--count], iter.key().ToString());
+    }
+    ASSERT_EQ(0, count);
+
+    auto less = [&](const std::string& a, const std::string& b) {
+      return keys_include_seq ? icmp.Compare(a, b) < 0
+                              : ucmp->Compare(a, b) < 0;
+    };
+    for (const auto& target : targets) {
+      // Seek targets are internal keys, even if the separators are not.
+      std::string seek_key = target;
+      if (!keys_include_seq) {
+        seek_key = InternalKey(target, kMaxSequenceNumber, kValueTypeForSeek)
+                       .Encode()
+                       .ToString();
+      }
+      auto lower = std::lower_bound(keys.begin(), keys.end(), target, less);
+      iter.Seek(seek_key);
+      ASSERT_EQ(lower != keys.end(), iter.Valid());
+      if (iter.Valid()) {
+        ASSERT_EQ(*lower, iter.key().ToString());
+        ASSERT_EQ(handles[lower - keys.begin()].offset(),
+                  iter.value().handle.offset());
+      }
+
+      auto upper = std::upper_bound(keys.begin(), keys.end(), target, less);
+      iter.SeekForPrev(seek_key);
+      ASSERT_EQ(upper != keys.begin(), iter.Valid());
+      if (iter.Valid()) {
+        ASSERT_EQ(*std::prev(upper), iter.key().ToString());
+      }
+    }
+  }
+};
+
+TEST_F(LearnedIndexTest, UserKeys) {
+  Random rnd(301);
+  std::set<std::string> sorted;
+  std::vector<std::string> targets;
+  while (sorted.size() < 5000) {
+    // Long common prefix, variable lengths and skewed distribution.
+    std::string key = "prefix/" + std::to_string(rnd.Skewed(20));
+    key += rnd.RandomString(rnd.Uniform(6));
+    sorted.insert(key);
+  }
+  for (int i = 0; i < 5000; i++) {
+    targets.push_back("prefix/" + std::to_string(rnd.Skewed(20)) +
+                      rnd.RandomString(rnd.Uniform(6)));
+  }
+  targets.push_back("");
+  targets.push_back("a");
+  targets.push_back("prefix");
+  targets.push_back("z");
+  std::vector<std::string> keys(sorted.begin(), sorted.end());
+  Verify(BytewiseComparator(), keys, false /* keys_include_seq */, targets);
+  targets.insert(targets.end(), keys.begin(), keys.end());
+  Verify(BytewiseComparator(), keys, false /* keys_include_seq */, targets);
+}
+
+TEST_F(LearnedIndexTest, FixedSizeKeys) {
+  std::vector<std::string> keys;
+  std::vector<std::string> targets;
+  for (uint64_t i = 0; i < 10000; i++) {
+    std::string key;
+    PutFixed64(&key, EndianSwapValue(i * i));
+    keys.push_back(key);
+    std::string target;
+    PutFixed64(&target, EndianSwapValue(i * i + i % 3));
+    targets.push_back(target);
+  }
+  Verify(BytewiseComparator(), keys, false /* keys_include_seq */, targets);
+}
+
+TEST_F(LearnedIndexTest, InternalKeys) {
+  Random rnd(301);
+  std::vector<std::string> keys;
+  std::vector<std::string> targets;
+  for (int i = 0; i < 1000; i++) {
+    // Several separators per user key.
+    const std::string user_key = "key" + std::to_string(1000 + i);
+    for (int seq = 100; seq > 0; seq -= 30) {
+      keys.push_back(
+          InternalKey(user_key, seq, kTypeValue).Encode().ToString());
+    }
+    targets.push_back(InternalKey("key" + std::to_string(1000 + i), 50,
+                                  kValueTypeForSeek)
+                          .Encode()
+                          .ToString());
+    targets.push_back(InternalKey("key" + std::to_string(rnd.Uniform(3000)),
+                                  rnd.Uniform(110), kValueTypeForSeek)
+                          .Encode()
+                          .ToString());
+  }
+  Verify(BytewiseComparator(), keys, true /* keys_include_seq */, targets);
+}
+
+TEST_F(LearnedIndexTest, OtherComparator) {
+  // The model assumes bytewise order, so its predictions are off, but seeks
+  // still find the right entries.
+  Random rnd(301);
+  std::vector<std::string> keys;
+  std::vector<std::string> targets;
+  for (int i = 0; i < 3000; i++) {
+    keys.push_back("key" + std::to_string(10000 + i));
+    targets.push_back("key" + std::to_string(9000 + rnd.Uniform(5000)));
+  }
+  std::reverse(keys.begin(), keys.end());
+  Verify(ReverseBytewiseComparator(), keys, false /* keys_include_seq */,
+         targets);
+}
+
+TEST_F(LearnedIndexTest, Empty) {
+  std::string contents;
+  EncodeLearnedIndex({}, {}, false /* keys_include_seq */, 8 /* max_error */,
+                     &contents);
+  InternalKeyComparator icmp(BytewiseComparator());
+  LearnedIndexIterator iter(&icmp, contents, false /* key_includes_seq */,
+                            0 /* pad_ts_sz */);
+  ASSERT_OK(iter.status());
+  iter.SeekToFirst();
+  ASSERT_FALSE(iter.Valid());
+  iter.Seek(InternalKey("a", 1, kTypeValue).Encode());
+  ASSERT_FALSE(iter.Valid());
+}
+
+TEST_F(LearnedIndexTest, Corruption) {
+  std::vector<std::string> keys = {"a", "b", "c"};
+  std::vector<Slice> key_slices(keys.begin(), keys.end());
+  std::vector<BlockHandle> handles = {BlockHandle(0, 10), BlockHandle(15, 10),
+                                      BlockHandle(30, 10)};
+  std::string contents;
+  EncodeLearnedIndex(key_slices, handles, false /* keys_include_seq */,
+                     8 /* max_error */, &contents);
+  InternalKeyComparator icmp(BytewiseComparator());
+  contents.pop_back();
+  LearnedIndexIterator iter(&icmp, contents, false /* key_includes_seq */,
+                            0 /* pad_ts_sz */);
+  ASSERT_TRUE(iter.status().IsCorruption());
+  iter.SeekToFirst();
+  ASSERT_FALSE(iter.Valid());
+}
+
+}  // namespace ROCKSDB_NAMESPACE
+
+int main(int argc, char** argv) {
+  ROCKSDB_NAMESPACE::port::InstallStackTraceHandler();
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
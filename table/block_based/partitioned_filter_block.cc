@@ -270,29 +270,51 @@ BlockHandle PartitionedFilterBlockReader::GetFilterPartitionHandle(
     const CachableEntry<Block_kFilterPartitionIndex>& filter_block,
     const Slice& entry) const {
   IndexBlockIter iter;
+  NewFilterPartitionIndexIterator(filter_block, &iter);
+  return SeekFilterPartitionHandle(&iter, entry);
+}
+
+void PartitionedFilterBlockReader::NewFilterPartitionIndexIterator(
+    const CachableEntry<Block_kFilterPartitionIndex>& filter_block,
+    IndexBlockIter* iter) const {
   const InternalKeyComparator* const comparator = internal_comparator();
   Statistics* kNullStats = nullptr;
   filter_block.GetValue()->NewIndexIterator(
       comparator->user_comparator(),
       table()->get_rep()->get_global_seqno(BlockType::kFilterPartitionIndex),
-      &iter, kNullStats, true /* total_order_seek */,
+      iter, kNullStats, true /* total_order_seek */,
       false /* have_first_key */, index_key_includes_seq(),
       index_value_is_full(), false /* block_contents_pinned */,
       user_defined_timestamps_persisted());
-  iter.Seek(entry);
-  if (UNLIKELY(!iter.Valid())) {
+}
+
+BlockHandle PartitionedFilterBlockReader::SeekFilterPartitionHandle(
+    IndexBlockIter* iter, const Slice& entry) const {
+  iter->Seek(entry);
+  if (UNLIKELY(!iter->Valid())) {
     // entry is larger than all the keys. However its prefix might still be
     // present in the last partition. If this is called by PrefixMayMatch this
     // is necessary for correct behavior. Otherwise it is unnecessary but safe.
     // Assuming this is an unlikely case for full key search, the performance
     // overhead should be negligible.
-    iter.SeekToLast();
+    iter->SeekToLast();
   }
-  assert(iter.Valid());
-  BlockHandle fltr_blk_handle = iter.value().handle;
+  assert(iter->Valid());
+  BlockHandle fltr_blk_handle = iter->value().handle;
   return fltr_blk_handle;
 }
 
+bool PartitionedFilterBlockReader::InFilterPartition(
+    const IndexBlockIter& iter, const Slice& entry) const {
+  assert(iter.Valid());
+  // The partition contains the entries up to its separator.
+  if (index_key_includes_seq()) {
+    return internal_comparator()->Compare(entry, iter.key()) <= 0;
+  }
+  return internal_comparator()->user_comparator()->Compare(
+             ExtractUserKey(entry), iter.key()) <= 0;
+}
+
 Status PartitionedFilterBlockReader::GetFilterPartitionBlock(
     FilePrefetchBuffer* prefetch_buffer, const BlockHandle& fltr_blk_handle,
     bool no_io, GetContext* get_context,
@@ -382,13 +404,21 @@ void PartitionedFilterBlockReader::MayMatch(
   auto start_iter_same_handle = range->begin();
   BlockHandle prev_filter_handle = BlockHandle::NullBlockHandle();
 
+  // The keys are sorted, so one top-level index iterator serves the whole
+  // batch, and it only needs to seek once the keys pass the separator of the
+  // current partition.
+  IndexBlockIter index_iter;
+  NewFilterPartitionIndexIterator(filter_block, &index_iter);
+
   // For all keys mapping to same partition (must be adjacent in sorted order)
   // share block cache lookup and use full filter multiget on the partition
   // filter.
   for (auto iter = start_iter_same_handle; iter != range->end(); ++iter) {
-    // TODO: re-use one top-level index iterator
     BlockHandle this_filter_handle =
-        GetFilterPartitionHandle(filter_block, iter->ikey);
+        !prev_filter_handle.IsNull() &&
+                InFilterPartition(index_iter, iter->ikey)
+            ? prev_filter_handle
+            : SeekFilterPartitionHandle(&index_iter, iter->ikey);
     if (!prev_filter_handle.IsNull() &&
         this_filter_handle != prev_filter_handle) {
       MultiGetRange subrange(*range, start_iter_same_handle, iter);
@@ -435,6 +465,23 @@ void PartitionedFilterBlockReader::MayMatchPartition(
                                       lookup_context, read_options);
 }
 
+BlockHandle PartitionedFilterBlockReader::GetPartitionHandle(
+    const ReadOptions& ro, const Slice& ikey,
+    BlockCacheLookupContext* lookup_context) {
+  CachableEntry<Block_kFilterPartitionIndex> filter_block;
+  Status s = GetOrReadFilterBlock(/*no_io=*/false, /*get_context=*/nullptr,
+                                  lookup_context, &filter_block, ro);
+  if (!s.ok() || filter_block.GetValue()->size() == 0) {
+    return BlockHandle::NullBlockHandle();
+  }
+  BlockHandle handle = GetFilterPartitionHandle(filter_block, ikey);
+  if (handle.size() == 0 ||
+      filter_map_.find(handle.offset()) != filter_map_.end()) {
+    return BlockHandle::NullBlockHandle();
+  }
+  return handle;
+}
+
 size_t PartitionedFilterBlockReader::ApproximateMemoryUsage() const {
   size_t usage = ApproximateFilterBlockMemoryUsage();
 #ifdef ROCKSDB_MALLOC_USABLE_SIZE
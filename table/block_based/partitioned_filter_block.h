@@ -130,12 +130,27 @@ class PartitionedFilterBlockReader
                         BlockCacheLookupContext* lookup_context,
                         const ReadOptions& read_options) override;
 
+  BlockHandle GetPartitionHandle(
+      const ReadOptions& ro, const Slice& ikey,
+      BlockCacheLookupContext* lookup_context) override;
+
   size_t ApproximateMemoryUsage() const override;
 
  private:
   BlockHandle GetFilterPartitionHandle(
       const CachableEntry<Block_kFilterPartitionIndex>& filter_block,
       const Slice& entry) const;
+  // Initializes *iter to iterate over the top-level index in filter_block.
+  void NewFilterPartitionIndexIterator(
+      const CachableEntry<Block_kFilterPartitionIndex>& filter_block,
+      IndexBlockIter* iter) const;
+  // Positions iter at the partition that may contain entry and returns its
+  // handle.
+  BlockHandle SeekFilterPartitionHandle(IndexBlockIter* iter,
+                                        const Slice& entry) const;
+  // Returns true if entry belongs to the partition that iter is at, given
+  // that it is not smaller than the entries the iterator was positioned with.
+  bool InFilterPartition(const IndexBlockIter& iter, const Slice& entry) const;
   Status GetFilterPartitionBlock(
       FilePrefetchBuffer* prefetch_buffer, const BlockHandle& handle,
       bool no_io, GetContext* get_context,
@@ -114,6 +114,33 @@ InternalIteratorBase<IndexValue>* PartitionIndexReader::NewIterator(
   // the first level iter is always on heap and will attempt to delete it
   // in its destructor.
 }
+BlockHandle PartitionIndexReader::GetPartitionHandle(
+    const ReadOptions& ro, const Slice& ikey,
+    BlockCacheLookupContext* lookup_context) {
+  if (!partition_map_.empty()) {
+    return BlockHandle::NullBlockHandle();
+  }
+  CachableEntry<Block> index_block;
+  Status s = GetOrReadIndexBlock(/*no_io=*/true, /*get_context=*/nullptr,
+                                 lookup_context, &index_block, ro);
+  if (!s.ok()) {
+    return BlockHandle::NullBlockHandle();
+  }
+  const BlockBasedTable::Rep* rep = table()->rep_;
+  IndexBlockIter biter;
+  Statistics* kNullStats = nullptr;
+  index_block.GetValue()->NewIndexIterator(
+      internal_comparator()->user_comparator(),
+      rep->get_global_seqno(BlockType::kIndex), &biter, kNullStats, true,
+      index_has_first_key(), index_key_includes_seq(), index_value_is_full(),
+      false /* block_contents_pinned */, user_defined_timestamps_persisted());
+  biter.Seek(ikey);
+  if (!biter.Valid()) {
+    return BlockHandle::NullBlockHandle();
+  }
+  return biter.value().handle;
+}
+
 Status PartitionIndexReader::CacheDependencies(
     const ReadOptions& ro, bool pin, FilePrefetchBuffer* tail_prefetch_buffer) {
   if (!partition_map_.empty()) {
@@ -32,6 +32,9 @@ class PartitionIndexReader : public BlockBasedTable::IndexReaderCommon {
 
   Status CacheDependencies(const ReadOptions& ro, bool pin,
                            FilePrefetchBuffer* tail_prefetch_buffer) override;
+  BlockHandle GetPartitionHandle(
+      const ReadOptions& ro, const Slice& ikey,
+      BlockCacheLookupContext* lookup_context) override;
   size_t ApproximateMemoryUsage() const override {
     size_t usage = ApproximateIndexBlockMemoryUsage();
 #ifdef ROCKSDB_MALLOC_USABLE_SIZE
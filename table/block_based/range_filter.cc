@@ -0,0 +1,157 @@
+//  Copyright (c) 2011-present, Facebook, Inc.  All rights reserved.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+
+#include "table/block_based/range_filter.h"
+
+#include <algorithm>
+#include <cstring>
+
+#include "util/coding.h"
+
+namespace ROCKSDB_NAMESPACE {
+
+namespace {
+// Where a key lies relative to the keys that start with the prefix.
+enum class KeyPosition { kBefore, kWithin, kAfter };
+
+KeyPosition PositionOf(const Slice& key, const Slice& prefix) {
+  if (key.starts_with(prefix)) {
+    return KeyPosition::kWithin;
+  }
+  return key.compare(prefix) < 0 ? KeyPosition::kBefore : KeyPosition::kAfter;
+}
+}  // namespace
+
+void RangeFilterBuilder::Add(const Slice& user_key) {
+  if (truncated_keys_.empty()) {
+    first_key_.assign(user_key.data(), user_key.size());
+  }
+  last_key_.assign(user_key.data(), user_key.size());
+  const size_t size =
+      std::min(user_key.size(),
+               Slice(first_key_).difference_offset(user_key) + key_width_);
+  const Slice truncated(user_key.data(), size);
+  if (truncated_keys_.empty() || truncated != truncated_keys_.back()) {
+    truncated_keys_.emplace_back(truncated.data(), truncated.size());
+  }
+}
+
+Slice RangeFilterBuilder::Finish() {
+  const Slice prefix(first_key_.data(),
+                     Slice(first_key_).difference_offset(last_key_));
+  buf_.clear();
+  PutLengthPrefixedSlice(&buf_, prefix);
+  PutVarint32(&buf_, static_cast<uint32_t>(key_width_));
+  std::string entries;
+  std::string entry;
+  uint32_t num_entries = 0;
+  for (const auto& key : truncated_keys_) {
+    assert(key.size() >= prefix.size());
+    entry.assign(key, prefix.size(), key_width_);
+    entry.resize(key_width_, '\0');
+    if (num_entries == 0 ||
+        entries.compare(entries.size() - key_width_, key_width_, entry) != 0) {
+      entries.append(entry);
+      num_entries++;
+    }
+  }
+  PutVarint32(&buf_, num_entries);
+  buf_.append(entries);
+  truncated_keys_.clear();
+  return buf_;
+}
+
+Status RangeFilterReader::Create(BlockContents&& contents,
+                                 std::unique_ptr<RangeFilterReader>* reader) {
+  std::unique_ptr<RangeFilterReader> filter(
+      new RangeFilterReader(std::move(contents)));
+  Slice input = filter->contents_.data;
+  if (!GetLengthPrefixedSlice(&input, &filter->prefix_) ||
+      !GetVarint32(&input, &filter->key_width_) ||
+      !GetVarint32(&input, &filter->num_entries_) ||
+      input.size() != uint64_t{filter->key_width_} * filter->num_entries_) {
+    return Status::Corruption("bad range filter block");
+  }
+  filter->entries_ = input.data();
+  *reader = std::move(filter);
+  return Status::OK();
+}
+
+int RangeFilterReader::CompareEntry(uint32_t index, const Slice& suffix) const {
+  const char* entry = entries_ + size_t{index} * key_width_;
+  const size_t n = std::min(suffix.size(), size_t{key_width_});
+  int r = memcmp(entry, suffix.data(), n);
+  if (r != 0) {
+    return r;
+  }
+  for (size_t i = n; i < key_width_; i++) {
+    if (entry[i] != '\0') {
+      return 1;
+    }
+  }
+  return 0;
+}
+
+bool RangeFilterReader::RangeMayMatch(const Slice* lower, const Slice& upper,
+                                      bool* beyond_upper) const {
+  *beyond_upper = false;
+  if (num_entries_ == 0) {
+    return false;
+  }
+  // The first entry that may hold a key at or after lower.
+  uint32_t first = 0;
+  if (lower != nullptr) {
+    switch (PositionOf(*lower, prefix_)) {
+      case KeyPosition::kBefore:
+        break;
+      case KeyPosition::kWithin: {
+        Slice suffix = *lower;
+        suffix.remove_prefix(prefix_.size());
+        uint32_t left = 0;
+        uint32_t right = num_entries_;
+        while (left < right) {
+          uint32_t mid = left + (right - left) / 2;
+          if (CompareEntry(mid, suffix) < 0) {
+            left = mid + 1;
+          } else {
+            right = mid;
+          }
+        }
+        first = left;
+        break;
+      }
+      case KeyPosition::kAfter:
+        return false;
+    }
+    if (first == num_entries_) {
+      return false;
+    }
+  }
+  switch (PositionOf(upper, prefix_)) {
+    case KeyPosition::kBefore:
+      *beyond_upper = true;
+      return false;
+    case KeyPosition::kWithin: {
+      Slice suffix = upper;
+      suffix.remove_prefix(prefix_.size());
+      if (CompareEntry(first, suffix) > 0) {
+        // Every key of that entry and the ones after it is after upper.
+        *beyond_upper = true;
+        return false;
+      }
+      return true;
+    }
+    case KeyPosition::kAfter:
+      return true;
+  }
+  return true;
+}
+
+size_t RangeFilterReader::ApproximateMemoryUsage() const {
+  return sizeof(*this) - sizeof(contents_) +
+         contents_.ApproximateMemoryUsage();
+}
+
+}  // namespace ROCKSDB_NAMESPACE
@@ -0,0 +1,89 @@
+//  Copyright (c) 2011-present, Facebook, Inc.  All rights reserved.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "rocksdb/slice.h"
+#include "rocksdb/status.h"
+#include "table/format.h"
+
+namespace ROCKSDB_NAMESPACE {
+
+// A range filter answers whether a table may contain a user key in a range,
+// for bounded scans that a prefix Bloom filter cannot help with. Like the
+// truncated tries of SuRF, it stores each key only up to a fixed number of
+// bytes. The bytes that all keys of the table share are stored once, and the
+// next `key_width` bytes of each key, zero-padded, form its entry. Entries
+// are sorted and distinct, and since truncating and padding preserves the
+// bytewise order, a range may only contain a key if some entry lies between
+// the truncated bounds. There are no false negatives, and false positives
+// only come from keys that share their first bytes with a bound.
+//
+// Only tables of a bytewise ordered column family without user-defined
+// timestamps have a range filter. Encoding:
+//
+//   prefix: length prefixed slice
+//   key_width: varint32
+//   num_entries: varint32
+//   entries: num_entries * key_width bytes
+
+class RangeFilterBuilder {
+ public:
+  explicit RangeFilterBuilder(size_t key_width) : key_width_(key_width) {}
+
+  // Adds the user key of the next entry of the table, in bytewise order.
+  void Add(const Slice& user_key);
+
+  bool IsEmpty() const { return truncated_keys_.empty(); }
+
+  // Returns the encoded filter, which is valid until the builder is
+  // destroyed. No keys may be added afterwards.
+  Slice Finish();
+
+ private:
+  const size_t key_width_;
+  std::string first_key_;
+  std::string last_key_;
+  // Each key truncated after its common prefix with the first key and
+  // key_width_ more bytes, which covers its entry since the common prefix of
+  // all keys is not longer than that.
+  std::vector<std::string> truncated_keys_;
+  std::string buf_;
+};
+
+class RangeFilterReader {
+ public:
+  // Parses an encoded filter, which takes ownership of the contents.
+  static Status Create(BlockContents&& contents,
+                       std::unique_ptr<RangeFilterReader>* reader);
+
+  // Returns false if the table provably has no user key in [lower, upper),
+  // where a null lower means that the range is not bounded below. In that
+  // case *beyond_upper tells whether the table has keys at or after upper.
+  bool RangeMayMatch(const Slice* lower, const Slice& upper,
+                     bool* beyond_upper) const;
+
+  size_t ApproximateMemoryUsage() const;
+
+ private:
+  explicit RangeFilterReader(BlockContents&& contents)
+      : contents_(std::move(contents)) {}
+
+  // Compares the entry at index to the bytes of a key of the range that
+  // follow the prefix, zero-padded to the width of the entries.
+  int CompareEntry(uint32_t index, const Slice& suffix) const;
+
+  BlockContents contents_;
+  Slice prefix_;
+  uint32_t key_width_ = 0;
+  uint32_t num_entries_ = 0;
+  const char* entries_ = nullptr;
+};
+
+}  // namespace ROCKSDB_NAMESPACE
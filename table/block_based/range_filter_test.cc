@@ -0,0 +1,174 @@
+//  Copyright (c) 2011-present, Facebook, Inc.  All rights reserved.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+
+#include "table/block_based/range_filter.h"
+
+#include <algorithm>
+#include <set>
+#include <string>
+#include <vector>
+
+#include "test_util/testharness.h"
+#include "util/random.h"
+
+namespace ROCKSDB_NAMESPACE {
+
+class RangeFilterTest : public testing::Test {
+ protected:
+  std::unique_ptr<RangeFilterReader> Build(
+      const std::vector<std::string>& keys, size_t key_width) {
+    RangeFilterBuilder builder(key_width);
+    for (const auto& key : keys) {
+      builder.Add(key);
+    }
+    EXPECT_EQ(keys.empty(), builder.IsEmpty());
+    encoded_ = builder.Finish().ToString();
+    std::unique_ptr<RangeFilterReader> reader;
+    EXPECT_OK(RangeFilterReader::Create(BlockContents(encoded_), &reader));
+    return reader;
+  }
+
+  // Checks that the filter never rejects a range with keys, and that it
+  // tells correctly whether there are keys after a rejected range. Returns
+  // the number of rejected ranges.
+  int Verify(const RangeFilterReader& reader,
+             const std::vector<std::string>& keys,
+             const std::vector<std::pair<std::string, std::string>>& ranges) {
+    int rejected = 0;
+    for (const auto& range : ranges) {
+      const Slice lower = range.first;
+      const Slice upper = range.second;
+      auto first = std::lower_bound(keys.begin(), keys.end(), range.first);
+      auto end = std::lower_bound(keys.begin(), keys.end(), range.second);
+      bool beyond_upper = false;
+      if (!reader.RangeMayMatch(&lower, upper, &beyond_upper)) {
+        EXPECT_TRUE(first >= end) << lower.ToString(true) << " "
+                                  << upper.ToString(true);
+        EXPECT_EQ(end != keys.end(), beyond_upper);
+        rejected++;
+      }
+      if (!reader.RangeMayMatch(nullptr, upper, &beyond_upper)) {
+        EXPECT_TRUE(end == keys.begin());
+        EXPECT_EQ(!keys.empty(), beyond_upper);
+      }
+    }
+    return rejected;
+  }
+
+  std::string encoded_;
+};
+
+TEST_F(RangeFilterTest, RandomKeys) {
+  Random rnd(301);
+  for (size_t key_width : {1, 2, 4, 8}) {
+    std::set<std::string> sorted;
+    while (sorted.size() < 2000) {
+      // Shared prefix, variable lengths and bytes that pad the entries.
+      std::string key = "prefix/";
+      size_t len = rnd.Uniform(10);
+      for (size_t i = 0; i < len; i++) {
+        key.push_back("\0ab\x7f\xff"[rnd.Uniform(5)]);
+      }
+      sorted.insert(key);
+    }
+    std::vector<std::string> keys(sorted.begin(), sorted.end());
+    auto reader = Build(keys, key_width);
+
+    std::vector<std::pair<std::string, std::string>> ranges;
+    for (int i = 0; i < 5000; i++) {
+      std::string lower = "prefix/" + rnd.RandomBinaryString(rnd.Uniform(6));
+      std::string upper = lower;
+      if (rnd.OneIn(2)) {
+        // A short range.
+        upper.push_back(static_cast<char>(rnd.Uniform(256)));
+      } else {
+        upper = "prefix/" + rnd.RandomBinaryString(rnd.Uniform(6));
+        if (upper < lower) {
+          std::swap(lower, upper);
+        }
+      }
+      ranges.emplace_back(lower, upper);
+    }
+    ranges.emplace_back("", "a");
+    ranges.emplace_back("", "prefix/");
+    ranges.emplace_back("prefix", "prefix/");
+    ranges.emplace_back("prefix0", "z");
+    ranges.emplace_back("a", "prefiy");
+    for (const auto& key : keys) {
+      ranges.emplace_back(key, key + std::string(1, '\0'));
+    }
+    int rejected = Verify(*reader, keys, ranges);
+    if (key_width >= 4) {
+      EXPECT_GT(rejected, 1000);
+    }
+  }
+}
+
+TEST_F(RangeFilterTest, Gaps) {
+  // Keys in clusters, with the scans in between rejected.
+  std::vector<std::string> keys;
+  for (int cluster = 0; cluster < 100; cluster++) {
+    for (int i = 0; i < 10; i++) {
+      keys.push_back("key" + std::to_string(10000 + cluster * 100 + i));
+    }
+  }
+  auto reader = Build(keys, 8);
+  std::vector<std::pair<std::string, std::string>> ranges;
+  for (int cluster = 0; cluster < 100; cluster++) {
+    ranges.emplace_back("key" + std::to_string(10000 + cluster * 100 + 50),
+                        "key" + std::to_string(10000 + cluster * 100 + 90));
+  }
+  ASSERT_EQ(100, Verify(*reader, keys, ranges));
+
+  Slice lower("key10005");
+  bool beyond_upper = true;
+  ASSERT_TRUE(reader->RangeMayMatch(&lower, "key10006", &beyond_upper));
+  lower = "key19950";
+  ASSERT_FALSE(reader->RangeMayMatch(&lower, "key2", &beyond_upper));
+  ASSERT_FALSE(beyond_upper);
+  ASSERT_FALSE(reader->RangeMayMatch(nullptr, "key1", &beyond_upper));
+  ASSERT_TRUE(beyond_upper);
+}
+
+TEST_F(RangeFilterTest, SingleKey) {
+  // All bytes of the key are in the prefix.
+  std::vector<std::string> keys = {"key"};
+  auto reader = Build(keys, 4);
+  std::vector<std::pair<std::string, std::string>> ranges = {
+      {"key", std::string("key\0", 4)},
+      {"a", "kez"},
+      {"a", "kex"},
+      {"kez", "z"},
+      {"key0", "key1"},
+      {"", "key"}};
+  ASSERT_EQ(3, Verify(*reader, keys, ranges));
+}
+
+TEST_F(RangeFilterTest, Empty) {
+  auto reader = Build({}, 4);
+  Slice lower("a");
+  bool beyond_upper = true;
+  ASSERT_FALSE(reader->RangeMayMatch(&lower, "b", &beyond_upper));
+  ASSERT_FALSE(beyond_upper);
+}
+
+TEST_F(RangeFilterTest, Corruption) {
+  RangeFilterBuilder builder(4);
+  builder.Add("a");
+  builder.Add("b");
+  std::string encoded = builder.Finish().ToString();
+  encoded.pop_back();
+  std::unique_ptr<RangeFilterReader> reader;
+  ASSERT_TRUE(RangeFilterReader::Create(BlockContents(encoded), &reader)
+                  .IsCorruption());
+}
+
+}  // namespace ROCKSDB_NAMESPACE
+
+int main(int argc, char** argv) {
+  ROCKSDB_NAMESPACE::port::InstallStackTraceHandler();
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
@@ -5,7 +5,11 @@
 //  (found in the LICENSE.Apache file in the root directory).
 #include "table/compaction_merging_iterator.h"
 
+#include "util/loser_tree.h"
+
 namespace ROCKSDB_NAMESPACE {
+// `Heap` orders the children, BinaryHeap or LoserTree
+template <template <typename, typename> class Heap>
 class CompactionMergingIterator : public InternalIterator {
  public:
   CompactionMergingIterator(
@@ -110,6 +114,36 @@ class CompactionMergingIterator : public InternalIterator {
     return current_->type == HeapItem::DELETE_RANGE_START;
   }
 
+  bool IsAtDataBlockStart(Slice* block_upper_bound) override {
+    assert(Valid());
+    if (current_->type != HeapItem::ITERATOR ||
+        !current_->iter.iter()->IsAtDataBlockStart(block_upper_bound)) {
+      return false;
+    }
+    // No key or range tombstone of the other sorted runs may come before
+    // the end of the block
+    const Comparator* ucmp = comparator_->user_comparator();
+    for (auto& child : children_) {
+      if (&child != current_ && child.iter.Valid() &&
+          ucmp->Compare(child.iter.user_key(), *block_upper_bound) <= 0) {
+        return false;
+      }
+    }
+    for (auto* range_tombstone_iter : range_tombstone_iters_) {
+      if (range_tombstone_iter && range_tombstone_iter->Valid() &&
+          ucmp->Compare(range_tombstone_iter->start_key().user_key,
+                        *block_upper_bound) <= 0) {
+        return false;
+      }
+    }
+    return true;
+  }
+
+  Status GetRawDataBlock(RawDataBlock* block) override {
+    assert(current_->type == HeapItem::ITERATOR);
+    return current_->iter.iter()->GetRawDataBlock(block);
+  }
+
   // Compaction uses the above subset of InternalIterator interface.
   void SeekToLast() override { assert(false); }
 
@@ -184,7 +218,7 @@ class CompactionMergingIterator : public InternalIterator {
     const InternalKeyComparator* comparator_;
   };
 
-  using CompactionMinHeap = BinaryHeap<HeapItem*, CompactionHeapItemComparator>;
+  using CompactionMinHeap = Heap<HeapItem*, CompactionHeapItemComparator>;
   bool is_arena_mode_;
   const InternalKeyComparator* comparator_;
   // HeapItem for all child point iterators.
@@ -214,7 +248,7 @@ class CompactionMergingIterator : public InternalIterator {
   // If valid, add to the min heap. Otherwise, check status.
   void AddToMinHeapOrCheckStatus(HeapItem*);
 
-  HeapItem* CurrentForward() const {
+  HeapItem* CurrentForward() {
     return !minHeap_.empty() ? minHeap_.top() : nullptr;
   }
 
@@ -227,7 +261,8 @@ class CompactionMergingIterator : public InternalIterator {
   }
 };
 
-void CompactionMergingIterator::SeekToFirst() {
+template <template <typename, typename> class Heap>
+void CompactionMergingIterator<Heap>::SeekToFirst() {
   minHeap_.clear();
   status_ = Status::OK();
   for (auto& child : children_) {
@@ -246,7 +281,8 @@ void CompactionMergingIterator::SeekToFirst() {
   current_ = CurrentForward();
 }
 
-void CompactionMergingIterator::Seek(const Slice& target) {
+template <template <typename, typename> class Heap>
+void CompactionMergingIterator<Heap>::Seek(const Slice& target) {
   minHeap_.clear();
   status_ = Status::OK();
   for (auto& child : children_) {
@@ -274,7 +310,8 @@ void CompactionMergingIterator::Seek(const Slice& target) {
   current_ = CurrentForward();
 }
 
-void CompactionMergingIterator::Next() {
+template <template <typename, typename> class Heap>
+void CompactionMergingIterator<Heap>::Next() {
   assert(Valid());
   // For the heap modifications below to be correct, current_ must be the
   // current top of the heap.
@@ -310,7 +347,8 @@ void CompactionMergingIterator::Next() {
   current_ = CurrentForward();
 }
 
-void CompactionMergingIterator::FindNextVisibleKey() {
+template <template <typename, typename> class Heap>
+void CompactionMergingIterator<Heap>::FindNextVisibleKey() {
   while (!minHeap_.empty()) {
     HeapItem* current = minHeap_.top();
     // IsDeleteRangeSentinelKey() here means file boundary sentinel keys.
@@ -338,7 +376,9 @@ void CompactionMergingIterator::FindNextVisibleKey() {
   }
 }
 
-void CompactionMergingIterator::AddToMinHeapOrCheckStatus(HeapItem* child) {
+template <template <typename, typename> class Heap>
+void CompactionMergingIterator<Heap>::AddToMinHeapOrCheckStatus(
+    HeapItem* child) {
   if (child->iter.Valid()) {
     assert(child->iter.status().ok());
     minHeap_.push(child);
@@ -347,25 +387,39 @@ void CompactionMergingIterator::AddToMinHeapOrCheckStatus(HeapItem* child) {
   }
 }
 
-InternalIterator* NewCompactionMergingIterator(
+namespace {
+template <template <typename, typename> class Heap>
+InternalIterator* NewCompactionMergingIteratorImpl(
     const InternalKeyComparator* comparator, InternalIterator** children, int n,
     std::vector<std::pair<TruncatedRangeDelIterator*,
                           TruncatedRangeDelIterator***>>& range_tombstone_iters,
     Arena* arena) {
+  using Iter = CompactionMergingIterator<Heap>;
+  if (arena == nullptr) {
+    return new Iter(comparator, children, n, false /* is_arena_mode */,
+                    range_tombstone_iters);
+  } else {
+    auto mem = arena->AllocateAligned(sizeof(Iter));
+    return new (mem) Iter(comparator, children, n, true /* is_arena_mode */,
+                          range_tombstone_iters);
+  }
+}
+}  // anonymous namespace
+
+InternalIterator* NewCompactionMergingIterator(
+    const InternalKeyComparator* comparator, InternalIterator** children, int n,
+    std::vector<std::pair<TruncatedRangeDelIterator*,
+                          TruncatedRangeDelIterator***>>& range_tombstone_iters,
+    Arena* arena, bool use_loser_tree) {
   assert(n >= 0);
   if (n == 0) {
     return NewEmptyInternalIterator<Slice>(arena);
+  } else if (use_loser_tree) {
+    return NewCompactionMergingIteratorImpl<LoserTree>(
+        comparator, children, n, range_tombstone_iters, arena);
   } else {
-    if (arena == nullptr) {
-      return new CompactionMergingIterator(comparator, children, n,
-                                           false /* is_arena_mode */,
-                                           range_tombstone_iters);
-    } else {
-      auto mem = arena->AllocateAligned(sizeof(CompactionMergingIterator));
-      return new (mem) CompactionMergingIterator(comparator, children, n,
-                                                 true /* is_arena_mode */,
-                                                 range_tombstone_iters);
-    }
+    return NewCompactionMergingIteratorImpl<BinaryHeap>(
+        comparator, children, n, range_tombstone_iters, arena);
   }
 }
 }  // namespace ROCKSDB_NAMESPACE
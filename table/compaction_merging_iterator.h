@@ -34,11 +34,14 @@ namespace ROCKSDB_NAMESPACE {
  * different layers: file boundary and range tombstone keys. Separate them into
  * two APIs for clarity.
  */
+template <template <typename, typename> class Heap>
 class CompactionMergingIterator;
 
+// use_loser_tree: merge the children with LoserTree instead of BinaryHeap,
+// see DBOptions::use_loser_tree_in_compaction.
 InternalIterator* NewCompactionMergingIterator(
     const InternalKeyComparator* comparator, InternalIterator** children, int n,
     std::vector<std::pair<TruncatedRangeDelIterator*,
                           TruncatedRangeDelIterator***>>& range_tombstone_iters,
-    Arena* arena = nullptr);
+    Arena* arena = nullptr, bool use_loser_tree = false);
 }  // namespace ROCKSDB_NAMESPACE
@@ -0,0 +1,143 @@
+//  Copyright (c) Meta Platforms, Inc. and affiliates.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+
+#include "table/compression_dict_manager.h"
+
+#include <algorithm>
+
+#include "test_util/sync_point.h"
+#include "util/coding.h"
+#include "util/compression.h"
+
+namespace ROCKSDB_NAMESPACE {
+
+CompressionDictManager::CompressionDictManager(Env* env) : env_(env) {}
+
+CompressionDictManager::~CompressionDictManager() {
+  env_->UnSchedule(this, Env::Priority::LOW);
+  std::unique_lock<std::mutex> lk(mu_);
+  cv_.wait(lk, [this] { return num_scheduled_ == 0; });
+}
+
+std::string CompressionDictManager::SlotKey(CompressionType type,
+                                            const CompressionOptions& opts) {
+  std::string key;
+  key.push_back(static_cast<char>(type));
+  key.push_back(opts.use_zstd_dict_trainer ? 1 : 0);
+  PutFixed32(&key, static_cast<uint32_t>(opts.level));
+  PutFixed32(&key, opts.max_dict_bytes);
+  PutFixed32(&key, opts.zstd_max_train_bytes);
+  return key;
+}
+
+size_t CompressionDictManager::TrainingBytes(const CompressionOptions& opts) {
+  return opts.zstd_max_train_bytes > 0 ? opts.zstd_max_train_bytes
+                                       : opts.max_dict_bytes;
+}
+
+std::shared_ptr<const std::string> CompressionDictManager::GetDict(
+    CompressionType type, const CompressionOptions& opts) {
+  std::lock_guard<std::mutex> lk(mu_);
+  auto it = slots_.find(SlotKey(type, opts));
+  return it == slots_.end() ? nullptr : it->second.dict;
+}
+
+void CompressionDictManager::SetDictIfMissing(CompressionType type,
+                                              const CompressionOptions& opts,
+                                              const Slice& dict) {
+  if (dict.empty()) {
+    return;
+  }
+  std::lock_guard<std::mutex> lk(mu_);
+  Slot& slot = slots_[SlotKey(type, opts)];
+  if (slot.dict == nullptr) {
+    slot.type = type;
+    slot.opts = opts;
+    slot.dict = std::make_shared<const std::string>(dict.ToString());
+  }
+}
+
+void CompressionDictManager::AddSample(CompressionType type,
+                                       const CompressionOptions& opts,
+                                       const Slice& block) {
+  const size_t training_bytes = TrainingBytes(opts);
+  if (training_bytes == 0 || block.empty()) {
+    return;
+  }
+  std::string key = SlotKey(type, opts);
+  {
+    std::lock_guard<std::mutex> lk(mu_);
+    Slot& slot = slots_[key];
+    // Samples are not collected during a training, so that the next
+    // dictionary is trained from blocks written with the current one.
+    if (slot.training || slot.num_blocks++ % kSampleInterval != 0) {
+      return;
+    }
+    slot.type = type;
+    slot.opts = opts;
+    size_t len = std::min(training_bytes - slot.samples.size(), block.size());
+    slot.samples.append(block.data(), len);
+    slot.sample_lens.push_back(len);
+    if (slot.samples.size() < training_bytes) {
+      return;
+    }
+    slot.training = true;
+    num_scheduled_++;
+  }
+  env_->Schedule(&CompressionDictManager::BGWorkTrain,
+                 new TrainJob{this, std::move(key)}, Env::Priority::LOW, this,
+                 &CompressionDictManager::UnscheduleTrain);
+}
+
+void CompressionDictManager::BGWorkTrain(void* arg) {
+  std::unique_ptr<TrainJob> job(static_cast<TrainJob*>(arg));
+  job->manager->Train(job->key);
+}
+
+void CompressionDictManager::UnscheduleTrain(void* arg) {
+  std::unique_ptr<TrainJob> job(static_cast<TrainJob*>(arg));
+  CompressionDictManager* manager = job->manager;
+  std::lock_guard<std::mutex> lk(manager->mu_);
+  manager->num_scheduled_--;
+  manager->cv_.notify_all();
+}
+
+void CompressionDictManager::Train(const std::string& key) {
+  CompressionOptions opts;
+  std::string samples;
+  std::vector<size_t> sample_lens;
+  {
+    std::lock_guard<std::mutex> lk(mu_);
+    Slot& slot = slots_[key];
+    opts = slot.opts;
+    samples.swap(slot.samples);
+    sample_lens.swap(slot.sample_lens);
+  }
+
+  std::string dict;
+  if (opts.zstd_max_train_bytes > 0) {
+    if (opts.use_zstd_dict_trainer) {
+      dict = ZSTD_TrainDictionary(samples, sample_lens, opts.max_dict_bytes);
+    } else {
+      dict = ZSTD_FinalizeDictionary(samples, sample_lens, opts.max_dict_bytes,
+                                     opts.level);
+    }
+  } else {
+    dict = std::move(samples);
+  }
+  TEST_SYNC_POINT_CALLBACK("CompressionDictManager::Train:Dict", &dict);
+
+  std::lock_guard<std::mutex> lk(mu_);
+  Slot& slot = slots_[key];
+  // A failed training keeps the previous dictionary.
+  if (!dict.empty()) {
+    slot.dict = std::make_shared<const std::string>(std::move(dict));
+  }
+  slot.training = false;
+  num_scheduled_--;
+  cv_.notify_all();
+}
+
+}  // namespace ROCKSDB_NAMESPACE
@@ -0,0 +1,89 @@
+//  Copyright (c) Meta Platforms, Inc. and affiliates.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+
+#pragma once
+
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "rocksdb/compression_type.h"
+#include "rocksdb/env.h"
+#include "rocksdb/slice.h"
+
+namespace ROCKSDB_NAMESPACE {
+
+// Trains the compression dictionaries of a column family in the background,
+// from samples of the data blocks of its table files, see
+// CompressionOptions::train_dict_in_background. Table builders use the latest
+// dictionary instead of buffering their data blocks to train one, and still
+// store it in each file, so readers are unaffected.
+//
+// A dictionary is kept for each combination of the compression type and the
+// dictionary options, which may differ between levels or change with
+// SetOptions(). Thread-safe.
+class CompressionDictManager {
+ public:
+  explicit CompressionDictManager(Env* env);
+  // Waits for the training in progress, if any.
+  ~CompressionDictManager();
+
+  CompressionDictManager(const CompressionDictManager&) = delete;
+  CompressionDictManager& operator=(const CompressionDictManager&) = delete;
+
+  // The latest dictionary for compressing with type and opts, or nullptr if
+  // none is available yet.
+  std::shared_ptr<const std::string> GetDict(CompressionType type,
+                                             const CompressionOptions& opts);
+
+  // Makes dict the dictionary for type and opts, unless one is already set.
+  // Table builders call it with the dictionary they trained themselves
+  // while no dictionary was available.
+  void SetDictIfMissing(CompressionType type, const CompressionOptions& opts,
+                        const Slice& dict);
+
+  // Offers an uncompressed data block compressed with type and opts. One
+  // block in kSampleInterval is kept as a sample, and once the samples reach
+  // the training size (zstd_max_train_bytes, or max_dict_bytes if zero), a
+  // new dictionary is trained from them in the LOW priority thread pool.
+  void AddSample(CompressionType type, const CompressionOptions& opts,
+                 const Slice& block);
+
+  static constexpr uint64_t kSampleInterval = 16;
+
+ private:
+  struct Slot {
+    CompressionType type = kNoCompression;
+    CompressionOptions opts;
+    std::shared_ptr<const std::string> dict;
+    std::string samples;
+    std::vector<size_t> sample_lens;
+    uint64_t num_blocks = 0;
+    bool training = false;
+  };
+  struct TrainJob {
+    CompressionDictManager* manager;
+    std::string key;
+  };
+
+  static std::string SlotKey(CompressionType type,
+                             const CompressionOptions& opts);
+  static size_t TrainingBytes(const CompressionOptions& opts);
+  static void BGWorkTrain(void* arg);
+  static void UnscheduleTrain(void* arg);
+  void Train(const std::string& key);
+
+  Env* const env_;
+  std::mutex mu_;
+  std::condition_variable cv_;
+  std::unordered_map<std::string, Slot> slots_;
+  // Training jobs scheduled and not finished yet.
+  int num_scheduled_ = 0;
+};
+
+}  // namespace ROCKSDB_NAMESPACE
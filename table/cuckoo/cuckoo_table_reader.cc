@@ -17,6 +17,7 @@
 
 #include "memory/arena.h"
 #include "options/cf_options.h"
+#include "rocksdb/comparator.h"
 #include "rocksdb/iterator.h"
 #include "rocksdb/table.h"
 #include "table/cuckoo/cuckoo_table_factory.h"
@@ -52,6 +53,7 @@ CuckooTableReader::CuckooTableReader(
       cuckoo_block_bytes_minus_one_(0),
       table_size_(0),
       ucomp_(comparator),
+      is_bytewise_(comparator == BytewiseComparator()),
       get_slice_hash_(get_slice_hash) {
   if (!ioptions.allow_mmap_reads) {
     status_ = Status::InvalidArgument("File is not mmaped");
@@ -154,21 +156,64 @@ Status CuckooTableReader::Get(const ReadOptions& /*readOptions*/,
                               bool /*skip_filters*/) {
   assert(key.size() == key_length_ + (is_last_level_ ? 8 : 0));
   Slice user_key = ExtractUserKey(key);
+  BucketOffsets offsets;
+  PrefetchBuckets(user_key, &offsets);
+  return ProbeBuckets(user_key, offsets, 0, get_context);
+}
+
+void CuckooTableReader::MultiGet(const ReadOptions& /*readOptions*/,
+                                 const MultiGetContext::Range* mget_range,
+                                 const SliceTransform* /* prefix_extractor */,
+                                 bool /*skip_filters*/) {
+  BucketOffsets offsets;
+  auto iter = mget_range->begin();
+  while (iter != mget_range->end()) {
+    offsets.clear();
+    auto group_end = iter;
+    for (size_t n = 0; n < kMultiGetGroupSize && group_end != mget_range->end();
+         ++n, ++group_end) {
+      assert(group_end->ikey.size() ==
+             key_length_ + (is_last_level_ ? 8 : 0));
+      PrefetchBuckets(ExtractUserKey(group_end->ikey), &offsets);
+    }
+    for (size_t first = 0; iter != group_end;
+         ++iter, first += num_hash_func_) {
+      *iter->s = ProbeBuckets(ExtractUserKey(iter->ikey), offsets, first,
+                              iter->get_context);
+    }
+  }
+}
+
+void CuckooTableReader::PrefetchBuckets(const Slice& user_key,
+                                        BucketOffsets* offsets) const {
   for (uint32_t hash_cnt = 0; hash_cnt < num_hash_func_; ++hash_cnt) {
     uint64_t offset =
         bucket_length_ * CuckooHash(user_key, hash_cnt, use_module_hash_,
                                     table_size_, identity_as_first_hash_,
                                     get_slice_hash_);
-    const char* bucket = &file_data_.data()[offset];
+    offsets->push_back(offset);
+    uint64_t addr = reinterpret_cast<uint64_t>(file_data_.data()) + offset;
+    uint64_t end_addr = addr + cuckoo_block_bytes_minus_one_;
+    for (addr &= CACHE_LINE_MASK; addr <= end_addr; addr += CACHE_LINE_SIZE) {
+      PREFETCH(reinterpret_cast<const char*>(addr), 0, 3);
+    }
+  }
+}
+
+Status CuckooTableReader::ProbeBuckets(const Slice& user_key,
+                                       const BucketOffsets& offsets,
+                                       size_t first,
+                                       GetContext* get_context) const {
+  for (uint32_t hash_cnt = 0; hash_cnt < num_hash_func_; ++hash_cnt) {
+    const char* bucket = &file_data_.data()[offsets[first + hash_cnt]];
     for (uint32_t block_idx = 0; block_idx < cuckoo_block_size_;
          ++block_idx, bucket += bucket_length_) {
-      if (ucomp_->Equal(Slice(unused_key_.data(), user_key.size()),
-                        Slice(bucket, user_key.size()))) {
+      if (KeyEquals(unused_key_.data(), bucket, user_key.size())) {
         return Status::OK();
       }
       // Here, we compare only the user key part as we support only one entry
       // per user key and we don't support snapshot.
-      if (ucomp_->Equal(user_key, Slice(bucket, user_key.size()))) {
+      if (KeyEquals(user_key.data(), bucket, user_key.size())) {
         Slice value(bucket + key_length_, value_length_);
         if (is_last_level_) {
           // Sequence number is not stored at the last level, so we will use
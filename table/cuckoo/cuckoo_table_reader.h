@@ -8,6 +8,7 @@
 // found in the LICENSE file. See the AUTHORS file for names of contributors.
 
 #pragma once
+#include <cstring>
 #include <memory>
 #include <string>
 #include <utility>
@@ -17,6 +18,7 @@
 #include "rocksdb/env.h"
 #include "rocksdb/options.h"
 #include "table/table_reader.h"
+#include "util/autovector.h"
 
 namespace ROCKSDB_NAMESPACE {
 
@@ -43,6 +45,13 @@ class CuckooTableReader : public TableReader {
              GetContext* get_context, const SliceTransform* prefix_extractor,
              bool skip_filters = false) override;
 
+  // Looks up the keys in groups, prefetching the buckets of all the keys of a
+  // group before probing them, so that their cache misses overlap.
+  void MultiGet(const ReadOptions& readOptions,
+                const MultiGetContext::Range* mget_range,
+                const SliceTransform* prefix_extractor,
+                bool skip_filters = false) override;
+
   // Returns a new iterator over table contents
   // compaction_readahead_size: its value will only be used if for_compaction =
   // true
@@ -75,7 +84,24 @@ class CuckooTableReader : public TableReader {
 
  private:
   friend class CuckooTableIterator;
+  // The offsets of the cuckoo blocks of one or more keys, num_hash_func_ per
+  // key
+  using BucketOffsets = autovector<uint64_t, 64>;
+  // The number of keys whose buckets MultiGet() prefetches at once
+  static constexpr size_t kMultiGetGroupSize = 16;
+
   void LoadAllKeys(std::vector<std::pair<Slice, uint32_t>>* key_to_bucket_id);
+  // Appends the offsets of the cuckoo blocks of user_key to `offsets`, and
+  // prefetches them
+  void PrefetchBuckets(const Slice& user_key, BucketOffsets* offsets) const;
+  // Looks up user_key in the cuckoo blocks at offsets[first] onwards
+  Status ProbeBuckets(const Slice& user_key, const BucketOffsets& offsets,
+                      size_t first, GetContext* get_context) const;
+  bool KeyEquals(const char* a, const char* b, size_t size) const {
+    return is_bytewise_ ? memcmp(a, b, size) == 0
+                        : ucomp_->Equal(Slice(a, size), Slice(b, size));
+  }
+
   std::unique_ptr<RandomAccessFileReader> file_;
   Slice file_data_;
   bool is_last_level_;
@@ -93,6 +119,8 @@ class CuckooTableReader : public TableReader {
   uint32_t cuckoo_block_bytes_minus_one_;
   uint64_t table_size_;
   const Comparator* ucomp_;
+  // Whether keys can be compared with memcmp() instead of ucomp_
+  const bool is_bytewise_;
   uint64_t (*get_slice_hash_)(const Slice& s, uint32_t index,
                               uint64_t max_num_buckets);
 };
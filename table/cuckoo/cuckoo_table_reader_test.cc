@@ -24,6 +24,7 @@ int main() {
 #include "table/cuckoo/cuckoo_table_reader.h"
 #include "table/get_context.h"
 #include "table/meta_blocks.h"
+#include "table/multiget_context.h"
 #include "test_util/testharness.h"
 #include "test_util/testutil.h"
 #include "util/gflags_compat.h"
@@ -125,6 +126,51 @@ class CuckooReaderTest : public testing::Test {
           reader.Get(ReadOptions(), Slice(keys[i]), &get_context, nullptr));
       ASSERT_STREQ(values[i].c_str(), value.data());
     }
+    CheckMultiGet(&reader, ucomp);
+  }
+
+  void CheckMultiGet(CuckooTableReader* reader, const Comparator* ucomp) {
+    // The keys and a key that is not found, in more than one group of
+    // prefetched keys
+    std::vector<std::string> lookup_keys;
+    for (int round = 0; round < 3; round++) {
+      lookup_keys.insert(lookup_keys.end(), user_keys.begin(),
+                         user_keys.end());
+    }
+    const std::string not_found_key(user_keys[0].size(), '\xff');
+    AddHashLookups(not_found_key, 0, kNumHashFunc);
+    lookup_keys.push_back(not_found_key);
+    const size_t n = lookup_keys.size();
+    std::vector<PinnableSlice> mget_values(n);
+    std::vector<Status> statuses(n);
+    std::vector<Slice> key_slices(lookup_keys.begin(), lookup_keys.end());
+    autovector<GetContext, MultiGetContext::MAX_BATCH_SIZE> get_contexts;
+    autovector<KeyContext, MultiGetContext::MAX_BATCH_SIZE> key_contexts;
+    autovector<KeyContext*, MultiGetContext::MAX_BATCH_SIZE> sorted_keys;
+    for (size_t i = 0; i < n; ++i) {
+      get_contexts.emplace_back(ucomp, nullptr, nullptr, nullptr,
+                                GetContext::kNotFound, key_slices[i],
+                                &mget_values[i], nullptr, nullptr, nullptr,
+                                nullptr, true, nullptr, nullptr);
+      key_contexts.emplace_back(nullptr, key_slices[i], &mget_values[i],
+                                nullptr, nullptr, &statuses[i]);
+      key_contexts.back().get_context = &get_contexts.back();
+    }
+    for (auto& key_context : key_contexts) {
+      sorted_keys.emplace_back(&key_context);
+    }
+    ReadOptions read_options;
+    MultiGetContext ctx(&sorted_keys, 0, n, kMaxSequenceNumber, read_options,
+                        env->GetFileSystem().get(), nullptr);
+    MultiGetContext::Range range = ctx.GetMultiGetRange();
+    reader->MultiGet(read_options, &range, nullptr);
+    for (size_t i = 0; i + 1 < n; ++i) {
+      ASSERT_OK(statuses[i]);
+      ASSERT_EQ(get_contexts[i].State(), GetContext::kFound);
+      ASSERT_EQ(values[i % num_items], mget_values[i].ToString());
+    }
+    ASSERT_OK(statuses[n - 1]);
+    ASSERT_EQ(get_contexts[n - 1].State(), GetContext::kNotFound);
   }
   void UpdateKeys(bool with_zero_seqno) {
     for (uint32_t i = 0; i < num_items; i++) {
@@ -642,7 +642,8 @@ Status UncompressBlockData(const UncompressionInfo& uncompression_info,
   const char* error_msg = nullptr;
   CacheAllocationPtr ubuf = UncompressData(
       uncompression_info, data, size, &uncompressed_size,
-      GetCompressFormatForVersion(format_version), allocator, &error_msg);
+      GetCompressFormatForVersion(format_version), allocator, &error_msg,
+      ioptions.compression_accelerator.get());
   if (!ubuf) {
     if (!CompressionTypeSupported(uncompression_info.type())) {
       ret = Status::NotSupported(
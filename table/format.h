@@ -402,6 +402,19 @@ struct BlockContents {
   }
 };
 
+// A data block of a table file, read for copying it verbatim to another
+// table file. See InternalIteratorBase::GetRawDataBlock().
+struct RawDataBlock {
+  // The maybe compressed block, and its compression type
+  Slice maybe_compressed;
+  CompressionType compression_type = kNoCompression;
+  // format_version of the table file, which the compression format version
+  // follows
+  uint32_t format_version = 0;
+  // The uncompressed block
+  Slice uncompressed;
+};
+
 // The `data` points to serialized block contents read in from file, which
 // must be compressed and include a trailer beyond `size`. A new buffer is
 // allocated with the given allocator (or default) and the uncompressed
@@ -277,6 +277,14 @@ bool GetContext::SaveValue(const ParsedInternalKey& parsed_key,
 
     auto type = parsed_key.type;
     Slice unpacked_value = value;
+    if (merge_context_ != nullptr &&
+        merge_context_->ObserveEntry(parsed_key.sequence)) {
+      assert(do_merge_);
+      type = kTypeValue;
+      unpacked_value = merge_context_->memo_value;
+      // The memoized value does not live in the block
+      value_pinner = nullptr;
+    }
     // Key matches. Process it
     if ((type == kTypeValue || type == kTypeValuePreferredSeqno ||
          type == kTypeMerge || type == kTypeBlobIndex ||
@@ -0,0 +1,59 @@
+//  Copyright (c) Meta Platforms, Inc. and affiliates.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+
+#include "table/hot_key_ranges.h"
+
+#include <algorithm>
+
+namespace ROCKSDB_NAMESPACE {
+
+void HotKeyRanges::Add(std::vector<TableReader::KeyRange>&& ranges) {
+  ranges_.insert(ranges_.end(), std::make_move_iterator(ranges.begin()),
+                 std::make_move_iterator(ranges.end()));
+}
+
+void HotKeyRanges::Finalize() {
+  std::sort(ranges_.begin(), ranges_.end(),
+            [this](const TableReader::KeyRange& a,
+                   const TableReader::KeyRange& b) {
+              if (!a.has_start || !b.has_start) {
+                return !a.has_start && b.has_start;
+              }
+              return ucmp_->Compare(a.start, b.start) < 0;
+            });
+  // Ranges of overlapping input files overlap, merge them so that the ends
+  // of the ranges are sorted too.
+  size_t num_merged = 0;
+  for (size_t i = 0; i < ranges_.size(); i++) {
+    if (num_merged > 0) {
+      auto& prev = ranges_[num_merged - 1];
+      if (!ranges_[i].has_start ||
+          ucmp_->Compare(ranges_[i].start, prev.end) <= 0) {
+        if (ucmp_->Compare(ranges_[i].end, prev.end) > 0) {
+          prev.end = std::move(ranges_[i].end);
+        }
+        continue;
+      }
+    }
+    if (num_merged != i) {
+      ranges_[num_merged] = std::move(ranges_[i]);
+    }
+    num_merged++;
+  }
+  ranges_.resize(num_merged);
+}
+
+bool HotKeyRanges::Overlaps(const Slice& first, const Slice& last) const {
+  // The first range that does not end before first.
+  auto it = std::lower_bound(
+      ranges_.begin(), ranges_.end(), first,
+      [this](const TableReader::KeyRange& range, const Slice& key) {
+        return ucmp_->Compare(range.end, key) < 0;
+      });
+  return it != ranges_.end() &&
+         (!it->has_start || ucmp_->Compare(it->start, last) < 0);
+}
+
+}  // namespace ROCKSDB_NAMESPACE
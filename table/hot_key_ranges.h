@@ -0,0 +1,54 @@
+//  Copyright (c) Meta Platforms, Inc. and affiliates.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "rocksdb/comparator.h"
+#include "rocksdb/slice.h"
+#include "table/table_reader.h"
+
+namespace ROCKSDB_NAMESPACE {
+
+// The user key ranges of the data blocks of the input files of a compaction
+// that were in the block cache when it started. The table builders of its
+// output files insert the data blocks overlapping them into the block cache,
+// up to a budget of bytes shared by all of them, see
+// BlockBasedTableOptions::PrepopulateBlockCache::kFlushAndHotCompaction.
+//
+// The ranges are added by a single thread, then Finalize() is called, after
+// which the class is thread-safe.
+class HotKeyRanges {
+ public:
+  HotKeyRanges(const Comparator* ucmp, uint64_t budget_bytes)
+      : ucmp_(ucmp), budget_(static_cast<int64_t>(budget_bytes)) {}
+
+  void Add(std::vector<TableReader::KeyRange>&& ranges);
+
+  // Sorts and merges the ranges added.
+  void Finalize();
+
+  bool empty() const { return ranges_.empty(); }
+
+  // Whether the user keys [first, last] overlap a hot range.
+  bool Overlaps(const Slice& first, const Slice& last) const;
+
+  // Takes bytes from the budget. Returns false once it is exhausted.
+  bool TryConsume(uint64_t bytes) {
+    const auto n = static_cast<int64_t>(bytes);
+    return budget_.fetch_sub(n, std::memory_order_relaxed) >= n;
+  }
+
+ private:
+  const Comparator* const ucmp_;
+  std::atomic<int64_t> budget_;
+  std::vector<TableReader::KeyRange> ranges_;
+};
+
+}  // namespace ROCKSDB_NAMESPACE
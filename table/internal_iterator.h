@@ -18,6 +18,7 @@
 namespace ROCKSDB_NAMESPACE {
 
 class PinnedIteratorsManager;
+class ScanPrefetchScheduler;
 
 enum class IterBoundCheck : char {
   kUnknown = 0,
@@ -76,6 +77,12 @@ class InternalIteratorBase : public Cleanable {
   // 'target' contains user timestamp if timestamp is enabled.
   virtual void Seek(const Slice& target) = 0;
 
+  // With ReadOptions::async_io, submits the reads of a Seek(target) without
+  // waiting for them, so that the reads of several iterators overlap. Leaves
+  // the iterator in an unspecified state: the next call must be
+  // Seek(target), which completes the reads.
+  virtual void StartSeek(const Slice& /*target*/) {}
+
   // Position at the first key in the source that at or before target
   // The iterator is Valid() after this call iff the source contains
   // an entry that comes at or before target.
@@ -205,6 +212,15 @@ class InternalIteratorBase : public Cleanable {
   // Default implementation is no-op and its implemented by iterators.
   virtual void SetReadaheadState(ReadaheadFileInfo* /*readahead_file_info*/) {}
 
+  // Makes the asynchronous readahead of the iterator, and of the iterators
+  // it creates, share the budget of `prefetch_scheduler` with the other
+  // iterators of a scan. nullptr gives the slots held back. Set by
+  // MergingIterator, which owns the scheduler.
+  //
+  // Default implementation is no-op and its implemented by iterators.
+  virtual void SetPrefetchScheduler(
+      ScanPrefetchScheduler* /*prefetch_scheduler*/) {}
+
   // When used under merging iterator, LevelIterator treats file boundaries
   // as sentinel keys to prevent it from moving to next SST file before range
   // tombstones in the current SST file are no longer needed. This method makes
@@ -212,6 +228,22 @@ class InternalIteratorBase : public Cleanable {
   // used by MergingIterator and LevelIterator for now.
   virtual bool IsDeleteRangeSentinelKey() const { return false; }
 
+  // Returns true if the iterator is positioned at the first entry of a data
+  // block of a table file, and no key yielded before the end of the block
+  // comes from elsewhere. Sets `*block_upper_bound` to a user key no smaller
+  // than the user keys of the block. Compaction uses it to copy data blocks
+  // verbatim, see BlockBasedTableOptions::compaction_block_passthrough.
+  virtual bool IsAtDataBlockStart(Slice* /*block_upper_bound*/) {
+    return false;
+  }
+
+  // Reads the data block the iterator is positioned at the start of. The
+  // contents of `block` are valid until the iterator moves.
+  // REQUIRES: IsAtDataBlockStart()
+  virtual Status GetRawDataBlock(RawDataBlock* /*block*/) {
+    return Status::NotSupported("GetRawDataBlock");
+  }
+
  protected:
   void SeekForPrevImpl(const Slice& target, const CompareInterface* cmp) {
     Seek(target);
@@ -10,6 +10,7 @@
 #include "table/merging_iterator.h"
 
 #include "db/arena_wrapped_db_iter.h"
+#include "file/scan_prefetch_scheduler.h"
 
 namespace ROCKSDB_NAMESPACE {
 // MergingIterator uses a min/max heap to combine data from point iterators.
@@ -331,6 +332,18 @@ class MergingIterator : public InternalIterator {
     }
   }
 
+  void StartSeek(const Slice& target) override {
+    for (size_t level = 0; level < children_.size(); ++level) {
+      children_[level].iter.iter()->StartSeek(target);
+      if (!range_tombstone_iters_.empty() &&
+          range_tombstone_iters_[level] != nullptr) {
+        // Seek() may seek the older levels to the end of a range tombstone of
+        // this level rather than to `target`
+        break;
+      }
+    }
+  }
+
   void SeekForPrev(const Slice& target) override {
     assert(range_tombstone_iters_.empty() ||
            range_tombstone_iters_.size() == children_.size());
@@ -471,6 +484,17 @@ class MergingIterator : public InternalIterator {
     }
   }
 
+  // Makes the children share a budget of `max_async_readahead_reads`
+  // asynchronous readahead reads. Called once all children are added.
+  void SetMaxAsyncReadaheadReads(size_t max_async_readahead_reads) {
+    assert(max_async_readahead_reads > 0);
+    prefetch_scheduler_.reset(
+        new ScanPrefetchScheduler(max_async_readahead_reads));
+    for (auto& child : children_) {
+      child.iter.iter()->SetPrefetchScheduler(prefetch_scheduler_.get());
+    }
+  }
+
   bool IsKeyPinned() const override {
     assert(Valid());
     return pinned_iters_mgr_ && pinned_iters_mgr_->PinningEnabled() &&
@@ -655,6 +679,8 @@ class MergingIterator : public InternalIterator {
   // forward. Lazily initialize it to save memory.
   std::unique_ptr<MergerMaxIterHeap> maxHeap_;
   PinnedIteratorsManager* pinned_iters_mgr_;
+  // Destroyed after the children, which give their slots back
+  std::unique_ptr<ScanPrefetchScheduler> prefetch_scheduler_;
 
   // Used to bound range tombstones. For point keys, DBIter and SSTable iterator
   // take care of boundary checking.
@@ -1741,6 +1767,9 @@ InternalIterator* MergeIteratorBuilder::Finish(ArenaWrappedDBIter* db_iter) {
           &merge_iter->range_tombstone_iters_.front());
     }
     merge_iter->Finish();
+    if (max_async_readahead_reads_ > 0) {
+      merge_iter->SetMaxAsyncReadaheadReads(max_async_readahead_reads_);
+    }
     ret = merge_iter;
     merge_iter = nullptr;
   }
@@ -77,6 +77,13 @@ class MergeIteratorBuilder {
   // iterator needs to be allocated.
   Arena* GetArena() { return arena; }
 
+  // Bounds the asynchronous readahead of all the children of the merging
+  // iterator, see ReadOptions::max_async_readahead_reads. 0 leaves each
+  // child unbounded.
+  void SetMaxAsyncReadaheadReads(size_t max_async_readahead_reads) {
+    max_async_readahead_reads_ = max_async_readahead_reads;
+  }
+
   // Return the result merging iterator.
   // If db_iter is not nullptr, then db_iter->SetMemtableRangetombstoneIter()
   // will be called with pointer to where the merging iterator
@@ -93,6 +100,7 @@ class MergeIteratorBuilder {
   // See AddRangeTombstoneIterator() implementation for more detail.
   std::vector<std::pair<size_t, TruncatedRangeDelIterator***>>
       range_del_iter_ptrs_;
+  size_t max_async_readahead_reads_ = 0;
 };
 
 }  // namespace ROCKSDB_NAMESPACE
@@ -33,6 +33,8 @@ const std::string kIndexBlockName = "rocksdb.index";
 const std::string kPropertiesBlockOldName = "rocksdb.stats";
 const std::string kCompressionDictBlockName = "rocksdb.compression_dict";
 const std::string kRangeDelBlockName = "rocksdb.range_del";
+const std::string kRangeFilterBlockName = "rocksdb.range_filter";
+const std::string kKeyAnchorsBlockName = "rocksdb.key_anchors";
 
 MetaIndexBuilder::MetaIndexBuilder()
     : meta_index_block_(new BlockBuilder(1 /* restart interval */)) {}
@@ -235,43 +237,10 @@ bool NotifyCollectTableCollectorsOnFinish(
   return all_succeeded;
 }
 
-// FIXME: should be a parameter for reading table properties to use persistent
-// cache?
-Status ReadTablePropertiesHelper(
-    const ReadOptions& ro, const BlockHandle& handle,
-    RandomAccessFileReader* file, FilePrefetchBuffer* prefetch_buffer,
-    const Footer& footer, const ImmutableOptions& ioptions,
-    std::unique_ptr<TableProperties>* table_properties,
-    MemoryAllocator* memory_allocator) {
-  assert(table_properties);
-
-  // If this is an external SST file ingested with write_global_seqno set to
-  // true, then we expect the checksum mismatch because checksum was written
-  // by SstFileWriter, but its global seqno in the properties block may have
-  // been changed during ingestion. For this reason, we initially read
-  // and process without checksum verification, then later try checksum
-  // verification so that if it fails, we can copy to a temporary buffer with
-  // global seqno set to its original value, i.e. 0, and attempt checksum
-  // verification again.
-  ReadOptions modified_ro = ro;
-  modified_ro.verify_checksums = false;
-  BlockContents block_contents;
-  BlockFetcher block_fetcher(file, prefetch_buffer, footer, modified_ro, handle,
-                             &block_contents, ioptions, false /* decompress */,
-                             false /*maybe_compressed*/, BlockType::kProperties,
-                             UncompressionDict::GetEmptyDict(),
-                             PersistentCacheOptions::kEmpty, memory_allocator);
-  Status s = block_fetcher.ReadBlockContents();
-  if (!s.ok()) {
-    return s;
-  }
-
-  // Unfortunately, Block::size() might not equal block_contents.data.size(),
-  // and Block hides block_contents
-  uint64_t block_size = block_contents.data.size();
-  Block properties_block(std::move(block_contents));
-  std::unique_ptr<MetaBlockIter> iter(properties_block.NewMetaIterator());
-
+Status ParsePropertiesBlock(
+    Block* properties_block, uint64_t block_offset, Logger* info_log,
+    std::unique_ptr<TableProperties>* table_properties) {
+  std::unique_ptr<MetaBlockIter> iter(properties_block->NewMetaIterator());
   std::unique_ptr<TableProperties> new_table_properties{new TableProperties};
   // All pre-defined properties of type uint64_t
   std::unordered_map<std::string, uint64_t*> predefined_uint64_properties = {
@@ -324,6 +293,7 @@ Status ReadTablePropertiesHelper(
        &new_table_properties->user_defined_timestamps_persisted},
   };
 
+  Status s;
   std::string last_key;
   for (iter->SeekToFirst(); iter->Valid(); iter->Next()) {
     s = iter->status();
@@ -345,7 +315,7 @@ Status ReadTablePropertiesHelper(
 
     if (key == ExternalSstFilePropertyNames::kGlobalSeqno) {
       new_table_properties->external_sst_file_global_seqno_offset =
-          handle.offset() + iter->ValueOffset();
+          block_offset + iter->ValueOffset();
     }
 
     if (pos != predefined_uint64_properties.end()) {
@@ -363,7 +333,7 @@ Status ReadTablePropertiesHelper(
             "Detect malformed value in properties meta-block:"
             "\tkey: " +
             key + "\tval: " + raw_val.ToString();
-        ROCKS_LOG_ERROR(ioptions.logger, "%s", error_msg.c_str());
+        ROCKS_LOG_ERROR(info_log, "%s", error_msg.c_str());
         continue;
       }
       *(pos->second) = val;
@@ -398,6 +368,51 @@ Status ReadTablePropertiesHelper(
     }
   }
 
+  if (s.ok()) {
+    *table_properties = std::move(new_table_properties);
+  }
+  return s;
+}
+
+// FIXME: should be a parameter for reading table properties to use persistent
+// cache?
+Status ReadTablePropertiesHelper(
+    const ReadOptions& ro, const BlockHandle& handle,
+    RandomAccessFileReader* file, FilePrefetchBuffer* prefetch_buffer,
+    const Footer& footer, const ImmutableOptions& ioptions,
+    std::unique_ptr<TableProperties>* table_properties,
+    MemoryAllocator* memory_allocator) {
+  assert(table_properties);
+
+  // If this is an external SST file ingested with write_global_seqno set to
+  // true, then we expect the checksum mismatch because checksum was written
+  // by SstFileWriter, but its global seqno in the properties block may have
+  // been changed during ingestion. For this reason, we initially read
+  // and process without checksum verification, then later try checksum
+  // verification so that if it fails, we can copy to a temporary buffer with
+  // global seqno set to its original value, i.e. 0, and attempt checksum
+  // verification again.
+  ReadOptions modified_ro = ro;
+  modified_ro.verify_checksums = false;
+  BlockContents block_contents;
+  BlockFetcher block_fetcher(file, prefetch_buffer, footer, modified_ro, handle,
+                             &block_contents, ioptions, false /* decompress */,
+                             false /*maybe_compressed*/, BlockType::kProperties,
+                             UncompressionDict::GetEmptyDict(),
+                             PersistentCacheOptions::kEmpty, memory_allocator);
+  Status s = block_fetcher.ReadBlockContents();
+  if (!s.ok()) {
+    return s;
+  }
+
+  // Unfortunately, Block::size() might not equal block_contents.data.size(),
+  // and Block hides block_contents
+  uint64_t block_size = block_contents.data.size();
+  Block properties_block(std::move(block_contents));
+  std::unique_ptr<TableProperties> new_table_properties;
+  s = ParsePropertiesBlock(&properties_block, handle.offset(), ioptions.logger,
+                           &new_table_properties);
+
   // Modified version of BlockFetcher checksum verification
   // (See write_global_seqno comment above)
   if (s.ok() && footer.GetBlockTrailerSize() > 0) {
@@ -22,6 +22,7 @@
 
 namespace ROCKSDB_NAMESPACE {
 
+class Block;
 class BlockBuilder;
 class BlockHandle;
 class Env;
@@ -36,6 +37,8 @@ extern const std::string kIndexBlockName;
 extern const std::string kPropertiesBlockOldName;
 extern const std::string kCompressionDictBlockName;
 extern const std::string kRangeDelBlockName;
+extern const std::string kRangeFilterBlockName;
+extern const std::string kKeyAnchorsBlockName;
 
 class MetaIndexBuilder {
  public:
@@ -106,6 +109,15 @@ bool NotifyCollectTableCollectorsOnFinish(
     UserCollectedProperties& user_collected_properties,
     UserCollectedProperties& readable_properties);
 
+// Parses the properties block `properties_block`, at `block_offset` in its
+// file, without verifying its checksum.
+// @returns a status to indicate if the operation succeeded. On success,
+//          *table_properties will point to a heap-allocated TableProperties
+//          object, otherwise value of `table_properties` will not be modified.
+Status ParsePropertiesBlock(
+    Block* properties_block, uint64_t block_offset, Logger* info_log,
+    std::unique_ptr<TableProperties>* table_properties);
+
 // Read table properties from a file using known BlockHandle.
 // @returns a status to indicate if the operation succeeded. On success,
 //          *table_properties will point to a heap-allocated TableProperties
@@ -63,7 +63,8 @@ PlainTableBuilder::PlainTableBuilder(
     uint32_t bloom_bits_per_key, const std::string& column_family_name,
     uint32_t num_probes, size_t huge_page_tlb_size, double hash_table_ratio,
     bool store_index_in_file, const std::string& db_id,
-    const std::string& db_session_id, uint64_t file_number)
+    const std::string& db_session_id, uint64_t file_number,
+    bool cache_aligned_index)
     : ioptions_(ioptions),
       moptions_(moptions),
       bloom_block_(num_probes),
@@ -79,7 +80,7 @@ PlainTableBuilder::PlainTableBuilder(
     assert(hash_table_ratio > 0 || IsTotalOrderMode());
     index_builder_.reset(new PlainTableIndexBuilder(
         &arena_, ioptions, moptions.prefix_extractor.get(), index_sparseness,
-        hash_table_ratio, huge_page_tlb_size_));
+        hash_table_ratio, huge_page_tlb_size_, cache_aligned_index));
     properties_
         .user_collected_properties[PlainTablePropertyNames::kBloomVersion] =
         "1";  // For future use
@@ -47,6 +47,10 @@ static std::unordered_map<std::string, OptionTypeInfo> plain_table_type_info = {
      {offsetof(struct PlainTableOptions, store_index_in_file),
       OptionType::kBoolean, OptionVerificationType::kNormal,
       OptionTypeFlags::kNone}},
+    {"cache_aligned_index",
+     {offsetof(struct PlainTableOptions, cache_aligned_index),
+      OptionType::kBoolean, OptionVerificationType::kNormal,
+      OptionTypeFlags::kNone}},
 };
 
 PlainTableFactory::PlainTableFactory(const PlainTableOptions& options)
@@ -65,7 +69,8 @@ Status PlainTableFactory::NewTableReader(
       table, table_options_.bloom_bits_per_key, table_options_.hash_table_ratio,
       table_options_.index_sparseness, table_options_.huge_page_tlb_size,
       table_options_.full_scan_mode, table_reader_options.immortal,
-      table_reader_options.prefix_extractor.get());
+      table_reader_options.prefix_extractor.get(),
+      table_options_.cache_aligned_index);
 }
 
 TableBuilder* PlainTableFactory::NewTableBuilder(
@@ -85,7 +90,8 @@ TableBuilder* PlainTableFactory::NewTableBuilder(
       table_builder_options.column_family_name, 6,
       table_options_.huge_page_tlb_size, table_options_.hash_table_ratio,
       table_options_.store_index_in_file, table_builder_options.db_id,
-      table_builder_options.db_session_id, table_builder_options.cur_file_num);
+      table_builder_options.db_session_id, table_builder_options.cur_file_num,
+      table_options_.cache_aligned_index);
 }
 
 std::string PlainTableFactory::GetPrintableOptions() const {
@@ -118,6 +124,9 @@ std::string PlainTableFactory::GetPrintableOptions() const {
   snprintf(buffer, kBufferSize, "  store_index_in_file: %d\n",
            table_options_.store_index_in_file);
   ret.append(buffer);
+  snprintf(buffer, kBufferSize, "  cache_aligned_index: %d\n",
+           table_options_.cache_aligned_index);
+  ret.append(buffer);
   return ret;
 }
 
@@ -178,6 +187,15 @@ static int RegisterBuiltinMemTableRepFactory(ObjectLibrary& library,
         }
         return guard->get();
       });
+  library.AddFactory<MemTableRepFactory>(
+      ObjectLibrary::PatternEntry(ARTRepFactory::kClassName(), true)
+          .AnotherName(ARTRepFactory::kNickName()),
+      [](const std::string& /*uri*/,
+         std::unique_ptr<MemTableRepFactory>* guard,
+         std::string* /*errmsg*/) {
+        guard->reset(new ARTRepFactory());
+        return guard->get();
+      });
   library.AddFactory<MemTableRepFactory>(
       AsPattern("HashLinkListRepFactory", "hash_linkedlist"),
       [](const std::string& uri, std::unique_ptr<MemTableRepFactory>* guard,
@@ -6,6 +6,8 @@
 #include "table/plain/plain_table_index.h"
 
 #include <cinttypes>
+#include <cstring>
+#include <unordered_map>
 
 #include "logging/logging.h"
 #include "util/coding.h"
@@ -20,25 +22,54 @@ inline uint32_t GetBucketIdFromHash(uint32_t hash, uint32_t num_buckets) {
 }
 }  // namespace
 
-Status PlainTableIndex::InitFromRawData(Slice data) {
+Status PlainTableIndex::InitFromRawData(Slice data, Arena* arena,
+                                        size_t huge_page_tlb_size,
+                                        Logger* logger) {
   if (!GetVarint32(&data, &index_size_)) {
     return Status::Corruption("Couldn't read the index size!");
   }
+  cache_aligned_ = index_size_ == 0;
+  uint32_t padding = 0;
+  if (cache_aligned_ && (!GetVarint32(&data, &index_size_) ||
+                         index_size_ == 0)) {
+    return Status::Corruption("Couldn't read the number of buckets!");
+  }
   assert(index_size_ > 0);
   if (!GetVarint32(&data, &num_prefixes_)) {
     return Status::Corruption("Couldn't read the index size!");
   }
-  sub_index_size_ =
-      static_cast<uint32_t>(data.size()) - index_size_ * kOffsetLen;
+  if (cache_aligned_) {
+    if (!GetVarint32(&data, &padding) || data.size() < padding) {
+      return Status::Corruption("Couldn't read the index padding!");
+    }
+    data.remove_prefix(padding);
+  }
+  const uint64_t index_bytes = GetIndexBytes();
+  if (cache_aligned_ && data.size() < index_bytes) {
+    return Status::Corruption("Index buckets are truncated!");
+  }
+  sub_index_size_ = static_cast<uint32_t>(data.size() - index_bytes);
 
   char* index_data_begin = const_cast<char*>(data.data());
+  if (cache_aligned_ && arena != nullptr &&
+      reinterpret_cast<uintptr_t>(index_data_begin) % kBucketSize != 0) {
+    char* copy = arena->AllocateAligned(data.size() + kBucketSize - 1,
+                                        huge_page_tlb_size, logger);
+    copy += (kBucketSize - reinterpret_cast<uintptr_t>(copy) % kBucketSize) %
+            kBucketSize;
+    memcpy(copy, index_data_begin, data.size());
+    index_data_begin = copy;
+  }
   index_ = reinterpret_cast<uint32_t*>(index_data_begin);
-  sub_index_ = reinterpret_cast<char*>(index_ + index_size_);
+  sub_index_ = index_data_begin + index_bytes;
   return Status::OK();
 }
 
 PlainTableIndex::IndexSearchResult PlainTableIndex::GetOffset(
     uint32_t prefix_hash, uint32_t* bucket_value) const {
+  if (cache_aligned_) {
+    return GetOffsetFromBuckets(prefix_hash, bucket_value);
+  }
   int bucket = GetBucketIdFromHash(prefix_hash, index_size_);
   GetUnaligned(index_ + bucket, bucket_value);
   if ((*bucket_value & kSubIndexMask) == kSubIndexMask) {
@@ -53,6 +84,33 @@ PlainTableIndex::IndexSearchResult PlainTableIndex::GetOffset(
   }
 }
 
+PlainTableIndex::IndexSearchResult PlainTableIndex::GetOffsetFromBuckets(
+    uint32_t prefix_hash, uint32_t* bucket_value) const {
+  const uint32_t buckets[2] = {GetFirstBucket(prefix_hash, index_size_),
+                               GetSecondBucket(prefix_hash, index_size_)};
+  for (uint32_t bucket : buckets) {
+    const uint32_t* hashes = index_ + bucket * 2 * kSlotsPerBucket;
+    for (uint32_t i = 0; i < kSlotsPerBucket; i++) {
+      uint32_t hash;
+      GetUnaligned(hashes + i, &hash);
+      if (hash != prefix_hash) {
+        continue;
+      }
+      GetUnaligned(hashes + kSlotsPerBucket + i, bucket_value);
+      if (*bucket_value == kMaxFileSize) {
+        // An empty slot, which has no hash
+        continue;
+      }
+      if ((*bucket_value & kSubIndexMask) == kSubIndexMask) {
+        *bucket_value ^= kSubIndexMask;
+        return kSubindex;
+      }
+      return kDirectToFile;
+    }
+  }
+  return kNoPrefixForBucket;
+}
+
 void PlainTableIndexBuilder::IndexRecordList::AddRecord(uint32_t hash,
                                                         uint32_t offset) {
   if (num_records_in_current_group_ == kNumRecordsPerGroup) {
@@ -92,15 +150,26 @@ void PlainTableIndexBuilder::AddKeyPrefix(Slice key_prefix_slice,
 }
 
 Slice PlainTableIndexBuilder::Finish() {
+  keys_per_prefix_hist_.Add(num_keys_per_prefix_);
+  ROCKS_LOG_INFO(ioptions_.logger, "Number of Keys per prefix Histogram: %s",
+                 keys_per_prefix_hist_.ToString().c_str());
+
+  if (cache_aligned_ && prefix_extractor_ != nullptr &&
+      hash_table_ratio_ > 0) {
+    Slice result;
+    if (FillCacheAlignedIndex(&result)) {
+      return result;
+    }
+    ROCKS_LOG_WARN(ioptions_.logger,
+                   "Plain table index buckets overflow, using the default "
+                   "index format");
+  }
+
   AllocateIndex();
   std::vector<IndexRecord*> hash_to_offsets(index_size_, nullptr);
   std::vector<uint32_t> entries_per_bucket(index_size_, 0);
   BucketizeIndexes(&hash_to_offsets, &entries_per_bucket);
 
-  keys_per_prefix_hist_.Add(num_keys_per_prefix_);
-  ROCKS_LOG_INFO(ioptions_.logger, "Number of Keys per prefix Histogram: %s",
-                 keys_per_prefix_hist_.ToString().c_str());
-
   // From the temp data structure, populate indexes.
   return FillIndexes(hash_to_offsets, entries_per_bucket);
 }
@@ -181,19 +250,8 @@ Slice PlainTableIndexBuilder::FillIndexes(
         // point to second level indexes.
         PutUnaligned(index + i,
                      sub_index_offset | PlainTableIndex::kSubIndexMask);
-        char* prev_ptr = &sub_index[sub_index_offset];
-        char* cur_ptr = EncodeVarint32(prev_ptr, num_keys_for_bucket);
-        sub_index_offset += static_cast<uint32_t>(cur_ptr - prev_ptr);
-        char* sub_index_pos = &sub_index[sub_index_offset];
-        IndexRecord* record = hash_to_offsets[i];
-        int j;
-        for (j = num_keys_for_bucket - 1; j >= 0 && record;
-             j--, record = record->next) {
-          EncodeFixed32(sub_index_pos + j * sizeof(uint32_t), record->offset);
-        }
-        assert(j == -1 && record == nullptr);
-        sub_index_offset += PlainTableIndex::kOffsetLen * num_keys_for_bucket;
-        assert(sub_index_offset <= sub_index_size_);
+        FillSubIndex(hash_to_offsets[i], num_keys_for_bucket, sub_index,
+                     &sub_index_offset);
         break;
     }
   }
@@ -205,6 +263,149 @@ Slice PlainTableIndexBuilder::FillIndexes(
   return Slice(allocated, GetTotalSize());
 }
 
+void PlainTableIndexBuilder::FillSubIndex(const IndexRecord* head,
+                                          uint32_t num_records,
+                                          char* sub_index,
+                                          uint32_t* sub_index_offset) const {
+  char* prev_ptr = &sub_index[*sub_index_offset];
+  char* cur_ptr = EncodeVarint32(prev_ptr, num_records);
+  *sub_index_offset += static_cast<uint32_t>(cur_ptr - prev_ptr);
+  char* sub_index_pos = &sub_index[*sub_index_offset];
+  const IndexRecord* record = head;
+  int j;
+  for (j = num_records - 1; j >= 0 && record; j--, record = record->next) {
+    EncodeFixed32(sub_index_pos + j * sizeof(uint32_t), record->offset);
+  }
+  assert(j == -1 && record == nullptr);
+  *sub_index_offset += PlainTableIndex::kOffsetLen * num_records;
+  assert(*sub_index_offset <= sub_index_size_);
+}
+
+bool PlainTableIndexBuilder::FillCacheAlignedIndex(Slice* result) {
+  const uint32_t kSlotsPerBucket = PlainTableIndex::kSlotsPerBucket;
+  const uint32_t kBucketSize = PlainTableIndex::kBucketSize;
+
+  // Each distinct prefix hash gets a slot, with the list of its records
+  std::unordered_map<uint32_t, uint32_t> hash_to_slot;
+  std::vector<uint32_t> slot_hashes;
+  std::vector<IndexRecord*> slot_records;
+  std::vector<uint32_t> records_per_slot;
+  size_t num_records = record_list_.GetNumRecords();
+  for (size_t i = 0; i < num_records; i++) {
+    IndexRecord* index_record = record_list_.At(i);
+    auto it = hash_to_slot.emplace(index_record->hash,
+                                   static_cast<uint32_t>(slot_hashes.size()));
+    if (it.second) {
+      slot_hashes.push_back(index_record->hash);
+      slot_records.push_back(nullptr);
+      records_per_slot.push_back(0);
+    }
+    uint32_t slot = it.first->second;
+    index_record->next = slot_records[slot];
+    slot_records[slot] = index_record;
+    records_per_slot[slot]++;
+  }
+  const uint32_t num_slots = static_cast<uint32_t>(slot_hashes.size());
+
+  // Put each slot in the less loaded of its two buckets, growing the hash
+  // table while a bucket overflows
+  uint32_t num_buckets = std::max(
+      static_cast<uint32_t>(num_slots / (kSlotsPerBucket * hash_table_ratio_)),
+      1u);
+  std::vector<uint32_t> slot_buckets(num_slots);
+  std::vector<uint32_t> bucket_loads;
+  bool fits = false;
+  for (int attempt = 0; attempt < kMaxBucketizeAttempts && !fits; attempt++) {
+    if (attempt > 0) {
+      num_buckets += num_buckets / 4 + 1;
+    }
+    bucket_loads.assign(num_buckets, 0);
+    fits = true;
+    for (uint32_t slot = 0; slot < num_slots && fits; slot++) {
+      uint32_t first =
+          PlainTableIndex::GetFirstBucket(slot_hashes[slot], num_buckets);
+      uint32_t second =
+          PlainTableIndex::GetSecondBucket(slot_hashes[slot], num_buckets);
+      uint32_t bucket =
+          bucket_loads[first] <= bucket_loads[second] ? first : second;
+      if (bucket_loads[bucket] == kSlotsPerBucket) {
+        fits = false;
+      } else {
+        slot_buckets[slot] = bucket;
+        bucket_loads[bucket]++;
+      }
+    }
+  }
+  if (!fits) {
+    return false;
+  }
+
+  sub_index_size_ = 0;
+  for (auto count : records_per_slot) {
+    if (count > 1) {
+      sub_index_size_ += VarintLength(count);
+      sub_index_size_ += count * PlainTableIndex::kOffsetLen;
+    }
+  }
+  index_size_ = num_buckets;
+
+  // The varints and up to kBucketSize - 1 bytes of padding in front of the
+  // buckets
+  const size_t header_size =
+      VarintLength(0) + VarintLength(num_buckets) +
+      VarintLength(num_prefixes_) + VarintLength(kBucketSize - 1);
+  const size_t body_size = size_t{num_buckets} * kBucketSize + sub_index_size_;
+  char* allocated =
+      arena_->AllocateAligned(header_size + kBucketSize - 1 + body_size,
+                              huge_page_tlb_size_, ioptions_.logger);
+  char* ptr = EncodeVarint32(allocated, 0);
+  ptr = EncodeVarint32(ptr, num_buckets);
+  ptr = EncodeVarint32(ptr, num_prefixes_);
+  // A padding of less than 128 bytes is a one-byte varint
+  const uintptr_t buckets_addr = reinterpret_cast<uintptr_t>(ptr) + 1;
+  const uint32_t padding = static_cast<uint32_t>(
+      (kBucketSize - buckets_addr % kBucketSize) % kBucketSize);
+  ptr = EncodeVarint32(ptr, padding);
+  memset(ptr, 0, padding);
+  ptr += padding;
+
+  uint32_t* buckets = reinterpret_cast<uint32_t*>(ptr);
+  char* sub_index = ptr + size_t{num_buckets} * kBucketSize;
+  for (uint32_t bucket = 0; bucket < num_buckets; bucket++) {
+    uint32_t* hashes = buckets + bucket * 2 * kSlotsPerBucket;
+    for (uint32_t i = 0; i < kSlotsPerBucket; i++) {
+      PutUnaligned(hashes + i, uint32_t{0});
+      PutUnaligned(hashes + kSlotsPerBucket + i,
+                   static_cast<uint32_t>(PlainTableIndex::kMaxFileSize));
+    }
+  }
+  bucket_loads.assign(num_buckets, 0);
+  uint32_t sub_index_offset = 0;
+  for (uint32_t slot = 0; slot < num_slots; slot++) {
+    uint32_t bucket = slot_buckets[slot];
+    uint32_t* hashes = buckets + bucket * 2 * kSlotsPerBucket;
+    uint32_t i = bucket_loads[bucket]++;
+    PutUnaligned(hashes + i, slot_hashes[slot]);
+    if (records_per_slot[slot] == 1) {
+      // point directly to the file offset
+      PutUnaligned(hashes + kSlotsPerBucket + i, slot_records[slot]->offset);
+    } else {
+      PutUnaligned(hashes + kSlotsPerBucket + i,
+                   sub_index_offset | PlainTableIndex::kSubIndexMask);
+      FillSubIndex(slot_records[slot], records_per_slot[slot], sub_index,
+                   &sub_index_offset);
+    }
+  }
+  assert(sub_index_offset == sub_index_size_);
+
+  ROCKS_LOG_DEBUG(ioptions_.logger,
+                  "cache-aligned hash table buckets: %" PRIu32
+                  ", suffix_map length %" PRIu32,
+                  num_buckets, sub_index_size_);
+  *result = Slice(allocated, static_cast<size_t>(ptr - allocated) + body_size);
+  return true;
+}
+
 const std::string PlainTableIndexBuilder::kPlainTableIndexBlock =
     "PlainTableIndexBlock";
 }  // namespace ROCKSDB_NAMESPACE
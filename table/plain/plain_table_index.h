@@ -13,6 +13,8 @@
 #include "monitoring/histogram.h"
 #include "options/cf_options.h"
 #include "rocksdb/options.h"
+#include "util/fastrange.h"
+#include "util/hash.h"
 
 namespace ROCKSDB_NAMESPACE {
 
@@ -57,6 +59,34 @@ namespace ROCKSDB_NAMESPACE {
 //    ....
 //   record N file offset:  fixedint32
 // <end>
+//
+// With PlainTableOptions::cache_aligned_index, the hash table is made of
+// cache-line-sized buckets instead, each holding kSlotsPerBucket slots:
+//
+// +-------------------------------+-------------------------------+
+// | Prefix hash of slots 0 to 7   | Value of slots 0 to 7         |
+// | (8 x 32 bits)                 | (8 x 32 bits)                 |
+// +-------------------------------+-------------------------------+
+//
+// Each prefix hash has a slot of its own, in the less loaded of two buckets
+// picked by two hash functions, so a lookup reads at most two cache lines
+// and only prefixes with equal hashes share a sub-index. The value of a slot
+// is encoded like a bucket of the hash table above, and empty slots hold
+// kMaxFileSize. The index starts with a zero varint32, which is never the
+// size of a hash table above:
+//
+// <begin>
+//   0:  varint32
+//   number of buckets:  varint32
+//   number of prefixes:  varint32
+//   padding size:  varint32
+//   padding, to align the buckets in memory
+//   buckets
+//   sub-index
+// <end>
+//
+// Buckets the reader finds unaligned, e.g. in a file that is not mmaped,
+// are copied to aligned memory.
 
 // The class loads the index block from a PlainTable SST file, and executes
 // the index lookup.
@@ -75,6 +105,7 @@ class PlainTableIndex {
       : index_size_(0),
         sub_index_size_(0),
         num_prefixes_(0),
+        cache_aligned_(false),
         index_(nullptr),
         sub_index_(nullptr) {}
 
@@ -85,8 +116,11 @@ class PlainTableIndex {
                               uint32_t* bucket_value) const;
 
   // Initialize data from `index_data`, which points to raw data for
-  // index stored in the SST file.
-  Status InitFromRawData(Slice index_data);
+  // index stored in the SST file. If `arena` is not null, it holds the copy
+  // of unaligned cache-line-sized buckets.
+  Status InitFromRawData(Slice index_data, Arena* arena = nullptr,
+                         size_t huge_page_tlb_size = 0,
+                         Logger* logger = nullptr);
 
   // Decode the sub index for specific hash bucket.
   // The `offset` is the value returned as `bucket_value` by GetOffset()
@@ -102,6 +136,13 @@ class PlainTableIndex {
 
   uint32_t GetIndexSize() const { return index_size_; }
 
+  // The size of the hash table in bytes
+  uint32_t GetIndexBytes() const {
+    return index_size_ * (cache_aligned_ ? kBucketSize : kOffsetLen);
+  }
+
+  bool IsCacheAligned() const { return cache_aligned_; }
+
   uint32_t GetSubIndexSize() const { return sub_index_size_; }
 
   uint32_t GetNumPrefixes() const { return num_prefixes_; }
@@ -109,11 +150,30 @@ class PlainTableIndex {
   static const uint64_t kMaxFileSize = (1u << 31) - 1;
   static const uint32_t kSubIndexMask = 0x80000000;
   static const size_t kOffsetLen = sizeof(uint32_t);
+  static const uint32_t kSlotsPerBucket = 8;
+  static const uint32_t kBucketSize = 2 * kSlotsPerBucket * kOffsetLen;
+
+  // The two buckets of a cache-line-sized index that a prefix hash can be
+  // stored in
+  static uint32_t GetFirstBucket(uint32_t prefix_hash, uint32_t num_buckets) {
+    return FastRange32(prefix_hash, num_buckets);
+  }
+  static uint32_t GetSecondBucket(uint32_t prefix_hash, uint32_t num_buckets) {
+    return FastRange32(Upper32of64(uint64_t{prefix_hash} * kSecondHashMult),
+                       num_buckets);
+  }
 
  private:
+  static const uint64_t kSecondHashMult = 0x9E3779B97F4A7C15;
+
+  // GetOffset() for a cache-line-sized index
+  IndexSearchResult GetOffsetFromBuckets(uint32_t prefix_hash,
+                                         uint32_t* bucket_value) const;
+
   uint32_t index_size_;
   uint32_t sub_index_size_;
   uint32_t num_prefixes_;
+  bool cache_aligned_;
 
   uint32_t* index_;
   char* sub_index_;
@@ -132,7 +192,7 @@ class PlainTableIndexBuilder {
   PlainTableIndexBuilder(Arena* arena, const ImmutableOptions& ioptions,
                          const SliceTransform* prefix_extractor,
                          size_t index_sparseness, double hash_table_ratio,
-                         size_t huge_page_tlb_size)
+                         size_t huge_page_tlb_size, bool cache_aligned)
       : arena_(arena),
         ioptions_(ioptions),
         record_list_(kRecordsPerGroup),
@@ -146,7 +206,8 @@ class PlainTableIndexBuilder {
         sub_index_size_(0),
         prefix_extractor_(prefix_extractor),
         hash_table_ratio_(hash_table_ratio),
-        huge_page_tlb_size_(huge_page_tlb_size) {}
+        huge_page_tlb_size_(huge_page_tlb_size),
+        cache_aligned_(cache_aligned) {}
 
   void AddKeyPrefix(Slice key_prefix_slice, uint32_t key_offset);
 
@@ -219,6 +280,15 @@ class PlainTableIndexBuilder {
   Slice FillIndexes(const std::vector<IndexRecord*>& hash_to_offsets,
                     const std::vector<uint32_t>& entries_per_bucket);
 
+  // Writes the sub-index of the `num_records` records linked from `head`,
+  // in reverse order, at `*sub_index_offset` of `sub_index` and advances it
+  void FillSubIndex(const IndexRecord* head, uint32_t num_records,
+                    char* sub_index, uint32_t* sub_index_offset) const;
+
+  // Builds a cache-line-sized index, or returns false if some bucket
+  // overflows even after growing the hash table a few times
+  bool FillCacheAlignedIndex(Slice* result);
+
   Arena* arena_;
   const ImmutableOptions ioptions_;
   HistogramImpl keys_per_prefix_hist_;
@@ -236,10 +306,13 @@ class PlainTableIndexBuilder {
   const SliceTransform* prefix_extractor_;
   double hash_table_ratio_;
   size_t huge_page_tlb_size_;
+  bool cache_aligned_;
 
   std::string prev_key_prefix_;
 
   static const size_t kRecordsPerGroup = 256;
+  // The number of times FillCacheAlignedIndex() grows the hash table
+  static const int kMaxBucketizeAttempts = 8;
 };
 
 }  // namespace ROCKSDB_NAMESPACE
@@ -119,7 +119,7 @@ Status PlainTableReader::Open(
     std::unique_ptr<TableReader>* table_reader, const int bloom_bits_per_key,
     double hash_table_ratio, size_t index_sparseness, size_t huge_page_tlb_size,
     bool full_scan_mode, const bool immortal_table,
-    const SliceTransform* prefix_extractor) {
+    const SliceTransform* prefix_extractor, bool cache_aligned_index) {
   if (file_size > PlainTableIndex::kMaxFileSize) {
     return Status::NotSupported("File is too large for PlainTableReader!");
   }
@@ -171,7 +171,7 @@ Status PlainTableReader::Open(
   if (!full_scan_mode) {
     s = new_reader->PopulateIndex(props.get(), bloom_bits_per_key,
                                   hash_table_ratio, index_sparseness,
-                                  huge_page_tlb_size);
+                                  huge_page_tlb_size, cache_aligned_index);
     if (!s.ok()) {
       return s;
     }
@@ -294,7 +294,8 @@ Status PlainTableReader::PopulateIndex(TableProperties* props,
                                        int bloom_bits_per_key,
                                        double hash_table_ratio,
                                        size_t index_sparseness,
-                                       size_t huge_page_tlb_size) {
+                                       size_t huge_page_tlb_size,
+                                       bool cache_aligned_index) {
   assert(props != nullptr);
 
   BlockContents index_block_contents;
@@ -384,7 +385,7 @@ Status PlainTableReader::PopulateIndex(TableProperties* props,
 
   PlainTableIndexBuilder index_builder(&arena_, ioptions_, prefix_extractor_,
                                        index_sparseness, hash_table_ratio,
-                                       huge_page_tlb_size);
+                                       huge_page_tlb_size, cache_aligned_index);
 
   std::vector<uint32_t> prefix_hashes;
   if (!index_in_file) {
@@ -394,7 +395,8 @@ Status PlainTableReader::PopulateIndex(TableProperties* props,
       return s;
     }
   } else {
-    s = index_.InitFromRawData(*index_block);
+    s = index_.InitFromRawData(*index_block, &arena_, huge_page_tlb_size,
+                               ioptions_.logger);
     if (!s.ok()) {
       return s;
     }
@@ -415,7 +417,7 @@ Status PlainTableReader::PopulateIndex(TableProperties* props,
   // Fill two table properties.
   if (!index_in_file) {
     props->user_collected_properties["plain_table_hash_table_size"] =
-        std::to_string(index_.GetIndexSize() * PlainTableIndex::kOffsetLen);
+        std::to_string(index_.GetIndexBytes());
     props->user_collected_properties["plain_table_sub_index_size"] =
         std::to_string(index_.GetSubIndexSize());
   } else {
@@ -74,7 +74,8 @@ class PlainTableReader : public TableReader {
                      const int bloom_bits_per_key, double hash_table_ratio,
                      size_t index_sparseness, size_t huge_page_tlb_size,
                      bool full_scan_mode, const bool immortal_table = false,
-                     const SliceTransform* prefix_extractor = nullptr);
+                     const SliceTransform* prefix_extractor = nullptr,
+                     bool cache_aligned_index = false);
 
   // Returns new iterator over table contents
   // compaction_readahead_size: its value will only be used if for_compaction =
@@ -134,7 +135,8 @@ class PlainTableReader : public TableReader {
 
   Status PopulateIndex(TableProperties* props, int bloom_bits_per_key,
                        double hash_table_ratio, size_t index_sparseness,
-                       size_t huge_page_tlb_size);
+                       size_t huge_page_tlb_size,
+                       bool cache_aligned_index = false);
 
   Status MmapDataIfNeeded();
 
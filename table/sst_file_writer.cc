@@ -5,6 +5,9 @@
 
 #include "rocksdb/sst_file_writer.h"
 
+#include <algorithm>
+#include <cinttypes>
+#include <deque>
 #include <vector>
 
 #include "db/db_impl/db_impl.h"
@@ -17,6 +20,7 @@
 #include "table/block_based/block_based_table_builder.h"
 #include "table/sst_file_writer_collectors.h"
 #include "test_util/sync_point.h"
+#include "util/work_queue.h"
 
 namespace ROCKSDB_NAMESPACE {
 
@@ -541,4 +545,213 @@ Status SstFileWriter::Finish(ExternalSstFileInfo* file_info) {
 
 uint64_t SstFileWriter::FileSize() { return rep_->file_info.file_size; }
 
+struct ParallelSstFileWriter::Rep {
+  // The keys and values of one file, built by a background thread
+  struct Shard {
+    struct Record {
+      ValueType type;
+      size_t key_size;
+      size_t value_size;
+    };
+
+    std::string file_path;
+    // The keys and values of the records, one after the other
+    std::string data;
+    std::vector<Record> records;
+
+    Status status;
+    ExternalSstFileInfo file_info;
+    WorkQueue<bool> done{1};
+  };
+
+  Rep(const EnvOptions& _env_options, const Options& _options,
+      const ParallelSstFileWriterOptions& _parallel_options,
+      ColumnFamilyHandle* _column_family)
+      : env_options(_env_options),
+        options(_options),
+        parallel_options(_parallel_options),
+        column_family(_column_family),
+        max_pending(static_cast<size_t>(
+            std::max(parallel_options.max_background_writers, 1))) {
+    threads.reserve(max_pending);
+    for (size_t i = 0; i < max_pending; i++) {
+      threads.emplace_back([this] { BGWorkBuildFiles(); });
+    }
+  }
+
+  ~Rep() {
+    WaitForPending(/*max_size=*/0);
+    build_queue.finish();
+    for (auto& thread : threads) {
+      thread.join();
+    }
+  }
+
+  Status Add(ValueType type, const Slice& user_key, const Slice& value) {
+    if (finished) {
+      return Status::InvalidArgument("Bulk load is finished");
+    }
+    if (!status.ok()) {
+      return status;
+    }
+    if (options.comparator->timestamp_size() > 0) {
+      return Status::InvalidArgument("Timestamp-aware comparator");
+    }
+    if (has_last_key &&
+        options.comparator->Compare(user_key, last_key) <= 0) {
+      return Status::InvalidArgument(
+          "Keys must be added in strict ascending order.");
+    }
+    last_key.assign(user_key.data(), user_key.size());
+    has_last_key = true;
+
+    if (!current) {
+      current.reset(new Shard());
+      char name[32];
+      snprintf(name, sizeof(name), "%06" PRIu64 ".sst", next_file_index++);
+      current->file_path = parallel_options.directory + "/" +
+                           parallel_options.file_prefix + name;
+    }
+    current->data.append(user_key.data(), user_key.size());
+    current->data.append(value.data(), value.size());
+    current->records.push_back({type, user_key.size(), value.size()});
+    if (current->data.size() >= parallel_options.target_file_size) {
+      SubmitCurrent();
+    }
+    return status;
+  }
+
+  Status Finish(std::vector<ExternalSstFileInfo>* file_infos) {
+    if (finished) {
+      return Status::InvalidArgument("Bulk load is finished");
+    }
+    finished = true;
+    if (current) {
+      SubmitCurrent();
+    }
+    WaitForPending(/*max_size=*/0);
+    if (status.ok() && file_infos) {
+      *file_infos = std::move(built_files);
+    }
+    return status;
+  }
+
+  void SubmitCurrent() {
+    // Bounds the memory of the pending shards
+    WaitForPending(max_pending - 1);
+    Shard* const shard = current.get();
+    pending.push_back(std::move(current));
+    build_queue.push(shard);
+  }
+
+  // Waits until at most `max_size` files are being built, collecting the
+  // results of the others in key order
+  void WaitForPending(size_t max_size) {
+    while (pending.size() > max_size) {
+      std::unique_ptr<Shard> shard = std::move(pending.front());
+      pending.pop_front();
+      bool done;
+      shard->done.pop(done);
+      if (!shard->status.ok()) {
+        if (status.ok()) {
+          status = shard->status;
+        }
+      } else {
+        built_files.push_back(std::move(shard->file_info));
+      }
+    }
+  }
+
+  void BGWorkBuildFiles() {
+    Shard* shard = nullptr;
+    while (build_queue.pop(shard)) {
+      shard->status = BuildFile(shard);
+      shard->data.clear();
+      shard->data.shrink_to_fit();
+      shard->records.clear();
+      shard->records.shrink_to_fit();
+      shard->done.push(true);
+    }
+  }
+
+  Status BuildFile(Shard* shard) {
+    SstFileWriter writer(env_options, options, column_family);
+    Status s = writer.Open(shard->file_path);
+    size_t offset = 0;
+    for (size_t i = 0; s.ok() && i < shard->records.size(); i++) {
+      const Shard::Record& record = shard->records[i];
+      const Slice key(shard->data.data() + offset, record.key_size);
+      offset += record.key_size;
+      const Slice value(shard->data.data() + offset, record.value_size);
+      offset += record.value_size;
+      switch (record.type) {
+        case kTypeValue:
+          s = writer.Put(key, value);
+          break;
+        case kTypeMerge:
+          s = writer.Merge(key, value);
+          break;
+        case kTypeDeletion:
+          s = writer.Delete(key);
+          break;
+        default:
+          assert(false);
+          s = Status::InvalidArgument("Unsupported record type");
+          break;
+      }
+    }
+    if (s.ok()) {
+      s = writer.Finish(&shard->file_info);
+    }
+    return s;
+  }
+
+  const EnvOptions env_options;
+  const Options options;
+  const ParallelSstFileWriterOptions parallel_options;
+  ColumnFamilyHandle* const column_family;
+  const size_t max_pending;
+
+  // The first error of a file
+  Status status;
+  bool finished = false;
+  std::string last_key;
+  bool has_last_key = false;
+  uint64_t next_file_index = 1;
+
+  std::unique_ptr<Shard> current;
+  // The files being built, in key order
+  std::deque<std::unique_ptr<Shard>> pending;
+  std::vector<ExternalSstFileInfo> built_files;
+
+  WorkQueue<Shard*> build_queue;
+  std::vector<port::Thread> threads;
+};
+
+ParallelSstFileWriter::ParallelSstFileWriter(
+    const EnvOptions& env_options, const Options& options,
+    const ParallelSstFileWriterOptions& parallel_options,
+    ColumnFamilyHandle* column_family)
+    : rep_(new Rep(env_options, options, parallel_options, column_family)) {}
+
+ParallelSstFileWriter::~ParallelSstFileWriter() {}
+
+Status ParallelSstFileWriter::Put(const Slice& user_key, const Slice& value) {
+  return rep_->Add(kTypeValue, user_key, value);
+}
+
+Status ParallelSstFileWriter::Merge(const Slice& user_key,
+                                    const Slice& value) {
+  return rep_->Add(kTypeMerge, user_key, value);
+}
+
+Status ParallelSstFileWriter::Delete(const Slice& user_key) {
+  return rep_->Add(kTypeDeletion, user_key, Slice());
+}
+
+Status ParallelSstFileWriter::Finish(
+    std::vector<ExternalSstFileInfo>* file_infos) {
+  return rep_->Finish(file_infos);
+}
+
 }  // namespace ROCKSDB_NAMESPACE
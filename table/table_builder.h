@@ -22,11 +22,14 @@
 #include "options/cf_options.h"
 #include "rocksdb/options.h"
 #include "rocksdb/table_properties.h"
+#include "table/format.h"
 #include "table/unique_id_impl.h"
 #include "trace_replay/block_cache_tracer.h"
 
 namespace ROCKSDB_NAMESPACE {
 
+class CompressionDictManager;
+class HotKeyRanges;
 class Slice;
 class Status;
 
@@ -160,6 +163,12 @@ struct TableBuilderOptions {
   // in the table options of the ioptions.table_factory
   bool skip_filters = false;
   const uint64_t cur_file_num;
+  // The dictionaries trained for the column family, used with
+  // CompressionOptions::train_dict_in_background. Can be nullptr.
+  CompressionDictManager* compression_dict_manager = nullptr;
+  // The key ranges of a compaction input in the block cache, used with
+  // PrepopulateBlockCache::kFlushAndHotCompaction. Can be nullptr.
+  HotKeyRanges* hot_key_ranges = nullptr;
 };
 
 // TableBuilder provides the interface used to build a Table
@@ -179,6 +188,15 @@ class TableBuilder {
   // REQUIRES: Finish(), Abandon() have not been called
   virtual void Add(const Slice& key, const Slice& value) = 0;
 
+  // Tells the builder that the next keys added are the entries of `block`,
+  // a data block of another table file. If the data block built from them
+  // turns out identical, the builder writes the maybe compressed block
+  // instead of compressing the block again. Returns false if the builder
+  // does not support it, e.g. because it compresses with other settings.
+  virtual bool BeginRawDataBlock(const RawDataBlock& /*block*/) {
+    return false;
+  }
+
   // Return non-ok iff some error has been detected.
   virtual Status status() const = 0;
 
@@ -109,6 +109,21 @@ class TableReader {
     return Status::NotSupported("ApproximateKeyAnchors() not supported.");
   }
 
+  // A range of user keys (start, end], unbounded below if !has_start.
+  struct KeyRange {
+    bool has_start = false;
+    std::string start;
+    std::string end;
+  };
+
+  // Appends the user key ranges of the data blocks of the table that are in
+  // the block cache to ranges, merging those of consecutive blocks. Only
+  // looks the blocks up in the block cache, without reading them.
+  virtual Status GetCachedKeyRanges(const ReadOptions& /*read_options*/,
+                                    std::vector<KeyRange>* /*ranges*/) {
+    return Status::NotSupported("GetCachedKeyRanges() not supported.");
+  }
+
   // Set up the table for Compaction. Might change some parameters with
   // posix_fadvise
   virtual void SetupForCompaction() = 0;
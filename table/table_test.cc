@@ -2071,7 +2071,7 @@ TEST_P(BlockBasedTableTest, PrefetchTest) {
 
 TEST_P(BlockBasedTableTest, TotalOrderSeekOnHashIndex) {
   BlockBasedTableOptions table_options = GetBlockBasedTableOptions();
-  for (int i = 0; i <= 4; ++i) {
+  for (int i = 0; i <= 5; ++i) {
     Options options;
     // Make each key/value an individual block
     table_options.block_size = 64;
@@ -2105,6 +2105,11 @@ TEST_P(BlockBasedTableTest, TotalOrderSeekOnHashIndex) {
             BlockBasedTableOptions::kBinarySearchWithFirstKey;
         options.table_factory.reset(new BlockBasedTableFactory(table_options));
         break;
+      case 5:
+        // Learned index
+        table_options.index_type = BlockBasedTableOptions::kLearnedSearch;
+        options.table_factory.reset(new BlockBasedTableFactory(table_options));
+        break;
     }
 
     TableConstructor c(BytewiseComparator(),
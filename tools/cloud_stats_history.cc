@@ -0,0 +1,173 @@
+//  Copyright (c) 2011-present, Facebook, Inc.  All rights reserved.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+
+#ifndef GFLAGS
+#include <cstdio>
+int main() {
+  fprintf(stderr, "Please install gflags to run rocksdb tools\n");
+  return 1;
+}
+#else
+
+#include <cinttypes>
+#include <cstdio>
+#include <map>
+#include <string>
+#include <unordered_set>
+#include <vector>
+
+#include "cloud/cloud_stats_history.h"
+#include "rocksdb/env.h"
+#include "rocksdb/statistics.h"
+#include "util/gflags_compat.h"
+#include "util/string_util.h"
+
+// Merges the stats snapshots that DBs upload with
+// CloudFileSystemOptions::stats_history_period_secs into time series, and
+// prints them as CSV lines of instance, stat, time in seconds since the
+// epoch and value. The snapshots are read from a local copy of the
+// STATS_HISTORY directory of the bucket, e.g. made with
+// "aws s3 sync s3://<bucket>/<path>/STATS_HISTORY <dir>".
+
+DEFINE_string(dir, "", "Local copy of the STATS_HISTORY directory");
+DEFINE_string(stats, "",
+              "Comma-separated prefixes of the stats to print, all if empty");
+DEFINE_string(instance, "",
+              "Prefix of the instances to print, all if empty");
+DEFINE_bool(rates, false,
+            "Print the tickers and the counts and sums of the histograms as "
+            "per-second rates between consecutive snapshots");
+
+using ROCKSDB_NAMESPACE::CloudStatsSeries;
+using ROCKSDB_NAMESPACE::CloudStatsSnapshot;
+using ROCKSDB_NAMESPACE::DecodeCloudStatsSnapshot;
+using ROCKSDB_NAMESPACE::Env;
+using ROCKSDB_NAMESPACE::HistogramsNameMap;
+using ROCKSDB_NAMESPACE::MergeCloudStatsSnapshots;
+using ROCKSDB_NAMESPACE::Status;
+using ROCKSDB_NAMESPACE::TickersNameMap;
+
+using GFLAGS_NAMESPACE::ParseCommandLineFlags;
+using GFLAGS_NAMESPACE::SetUsageMessage;
+
+namespace {
+
+// Reads the snapshots of the files under dir, recursively. Files that are not
+// snapshots are skipped with a warning.
+Status ReadSnapshots(Env* env, const std::string& dir,
+                     std::vector<CloudStatsSnapshot>* snapshots) {
+  std::vector<std::string> children;
+  Status s = env->GetChildren(dir, &children);
+  if (!s.ok()) {
+    return s;
+  }
+  for (const auto& child : children) {
+    if (child == "." || child == "..") {
+      continue;
+    }
+    const std::string path = dir + "/" + child;
+    bool is_dir = false;
+    if (env->IsDirectory(path, &is_dir).ok() && is_dir) {
+      s = ReadSnapshots(env, path, snapshots);
+      if (!s.ok()) {
+        return s;
+      }
+      continue;
+    }
+    std::string data;
+    s = ReadFileToString(env, path, &data);
+    if (!s.ok()) {
+      return s;
+    }
+    CloudStatsSnapshot snapshot;
+    s = DecodeCloudStatsSnapshot(data, &snapshot);
+    if (!s.ok()) {
+      fprintf(stderr, "Skipping %s: %s\n", path.c_str(), s.ToString().c_str());
+      continue;
+    }
+    snapshots->push_back(std::move(snapshot));
+  }
+  return Status::OK();
+}
+
+bool HasPrefix(const std::string& name,
+               const std::vector<std::string>& prefixes) {
+  if (prefixes.empty()) {
+    return true;
+  }
+  for (const auto& prefix : prefixes) {
+    if (name.rfind(prefix, 0) == 0) {
+      return true;
+    }
+  }
+  return false;
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  SetUsageMessage(std::string("\nUSAGE:\n") + std::string(argv[0]) +
+                  " --dir=<dir> [--stats=<prefix,...>]"
+                  " [--instance=<prefix>] [--rates]");
+  ParseCommandLineFlags(&argc, &argv, true);
+  if (FLAGS_dir.empty()) {
+    fprintf(stderr, "--dir is required\n");
+    return 1;
+  }
+
+  std::vector<CloudStatsSnapshot> snapshots;
+  Status s = ReadSnapshots(Env::Default(), FLAGS_dir, &snapshots);
+  if (!s.ok()) {
+    fprintf(stderr, "Failed to read %s: %s\n", FLAGS_dir.c_str(),
+            s.ToString().c_str());
+    return 1;
+  }
+  std::map<std::string, std::map<std::string, CloudStatsSeries>> series;
+  MergeCloudStatsSnapshots(snapshots, &series);
+
+  // The stats that only go up, whose rates are meaningful.
+  std::unordered_set<std::string> counters;
+  for (const auto& ticker : TickersNameMap) {
+    counters.insert(ticker.second);
+  }
+  for (const auto& histogram : HistogramsNameMap) {
+    counters.insert(histogram.second + ".count");
+    counters.insert(histogram.second + ".sum");
+  }
+
+  std::vector<std::string> prefixes;
+  if (!FLAGS_stats.empty()) {
+    prefixes = ROCKSDB_NAMESPACE::StringSplit(FLAGS_stats, ',');
+  }
+  for (const auto& instance : series) {
+    if (instance.first.rfind(FLAGS_instance, 0) != 0) {
+      continue;
+    }
+    for (const auto& stat : instance.second) {
+      if (!HasPrefix(stat.first, prefixes)) {
+        continue;
+      }
+      const bool rate = FLAGS_rates && counters.count(stat.first) > 0;
+      const CloudStatsSeries& values = stat.second;
+      for (size_t i = rate ? 1 : 0; i < values.size(); i++) {
+        const double secs = values[i].first / 1e6;
+        if (!rate) {
+          printf("%s,%s,%.3f,%" PRIu64 "\n", instance.first.c_str(),
+                 stat.first.c_str(), secs, values[i].second);
+          continue;
+        }
+        const uint64_t interval = values[i].first - values[i - 1].first;
+        const uint64_t delta = values[i].second >= values[i - 1].second
+                                   ? values[i].second - values[i - 1].second
+                                   : 0;
+        printf("%s,%s,%.3f,%.3f\n", instance.first.c_str(), stat.first.c_str(),
+               secs, interval > 0 ? delta * 1e6 / interval : 0.0);
+      }
+    }
+  }
+  return 0;
+}
+
+#endif  // GFLAGS
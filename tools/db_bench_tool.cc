@@ -42,12 +42,17 @@
 #include "db/db_impl/db_impl.h"
 #include "db/malloc_stats.h"
 #include "db/version_set.h"
+#include "db/write_batch_internal.h"
+#include "file/file_util.h"
 #include "monitoring/histogram.h"
 #include "monitoring/statistics_impl.h"
 #include "options/cf_options.h"
 #include "port/port.h"
 #include "port/stack_trace.h"
 #include "rocksdb/cache.h"
+#include "rocksdb/cloud/cloud_file_system_impl.h"
+#include "rocksdb/cloud/cloud_storage_provider.h"
+#include "rocksdb/cloud/db_cloud.h"
 #include "rocksdb/convenience.h"
 #include "rocksdb/db.h"
 #include "rocksdb/env.h"
@@ -62,6 +67,8 @@
 #include "rocksdb/slice_transform.h"
 #include "rocksdb/stats_history.h"
 #include "rocksdb/table.h"
+#include "rocksdb/trace_record.h"
+#include "rocksdb/trace_record_result.h"
 #include "rocksdb/utilities/backup_engine.h"
 #include "rocksdb/utilities/object_registry.h"
 #include "rocksdb/utilities/optimistic_transaction_db.h"
@@ -80,6 +87,7 @@
 #include "util/crc32c.h"
 #include "util/file_checksum_helper.h"
 #include "util/gflags_compat.h"
+#include "util/hash.h"
 #include "util/mutexlock.h"
 #include "util/random.h"
 #include "util/stderr_logger.h"
@@ -234,6 +242,21 @@ DEFINE_string(
     "\tsstables    -- Print sstable info\n"
     "\theapprofile -- Dump a heap profile (if supported by this port)\n"
     "\treplay      -- replay the trace file specified with trace_file\n"
+    "\treplayscaled -- replay the comma-separated trace files specified with "
+    "trace_file from --threads virtual clients, see trace_replay_scale\n"
+    "\tcloudopenwarm -- DBCloud::Open() of the cloud DB of cloud_fs_options "
+    "with its local directory in place\n"
+    "\tcloudopencold -- DBCloud::Open() of the cloud DB from an empty local "
+    "directory\n"
+    "\tcloudclone -- open a clone of the cloud DB to an empty local directory "
+    "and destination\n"
+    "\tcloudsavepoint -- Savepoint() of a fresh clone of the cloud DB\n"
+    "\tcloudcheckpoint -- CheckpointToCloud() of the cloud DB to an empty "
+    "destination\n"
+    "\tcloudepochroll -- roll the cloud DB to a new epoch, as a new leader "
+    "does\n"
+    "\tcloudpurgerlist -- list the obsolete files and dbids of the bucket of "
+    "the cloud DB, as the purger does\n"
     "\tgetmergeoperands -- Insert lots of merge records which are a list of "
     "sorted ints for a key and then compare performance of lookup for another "
     "key by doing a Get followed by binary searching in the large sorted list "
@@ -493,6 +516,11 @@ DEFINE_int32(num_high_pri_threads, 0,
              "The maximum number of concurrent background compactions"
              " that can occur in parallel.");
 
+DEFINE_int32(max_flush_subjobs,
+             ROCKSDB_NAMESPACE::Options().max_flush_subjobs,
+             "The maximum number of L0 files a flush writes concurrently, "
+             "each for a key range of the memtables.");
+
 DEFINE_int32(num_low_pri_threads, 0,
              "The maximum number of concurrent background compactions"
              " that can occur in parallel.");
@@ -550,6 +578,10 @@ DEFINE_bool(universal_allow_trivial_move, false,
 DEFINE_bool(universal_incremental, false,
             "Enable incremental compactions in universal compaction.");
 
+DEFINE_bool(universal_incremental_round_robin, false,
+            "Pick the incremental compactions of universal compaction in "
+            "key order.");
+
 DEFINE_int64(cache_size, 32 << 20,  // 32MB
              "Number of bytes to use as a cache of uncompressed data");
 
@@ -566,6 +598,18 @@ DEFINE_double(cache_high_pri_pool_ratio, 0.0,
 DEFINE_double(cache_low_pri_pool_ratio, 0.0,
               "Ratio of block cache reserve for low pri blocks.");
 
+DEFINE_bool(cache_frequency_admission, false,
+            "Only admit blocks into the LRU block cache that were looked up "
+            "more often than the next block to evict.");
+
+DEFINE_bool(cache_numa_local_shards, false,
+            "Split the shards of a fixed_hyper_clock_cache between the NUMA "
+            "nodes and prefer those of the calling thread's node.");
+
+DEFINE_double(cache_numa_duplicate_ratio, 0.0,
+              "With cache_numa_local_shards, the fraction of the charge "
+              "inserted on a node that may copy blocks of other nodes.");
+
 DEFINE_string(cache_type, "lru_cache", "Type of block cache.");
 
 DEFINE_bool(use_compressed_secondary_cache, false,
@@ -640,6 +684,9 @@ DEFINE_bool(partition_index, false, "Partition index blocks");
 
 DEFINE_bool(index_with_first_key, false, "Include first key in the index");
 
+DEFINE_bool(learned_index, false,
+            "Use a learned index, see BlockBasedTableOptions::kLearnedSearch");
+
 DEFINE_bool(
     optimize_filters_for_memory,
     ROCKSDB_NAMESPACE::BlockBasedTableOptions().optimize_filters_for_memory,
@@ -709,11 +756,21 @@ DEFINE_bool(use_data_block_hash_index, false,
             "instead of kDataBlockBinarySearch. "
             "This is valid if only we use BlockTable");
 
+DEFINE_bool(data_block_blocked_hash_index, false,
+            "With --use_data_block_hash_index, use "
+            "kDataBlockBinaryAndBlockedHash instead of "
+            "kDataBlockBinaryAndHash");
+
 DEFINE_double(data_block_hash_table_util_ratio, 0.75,
               "util ratio for data block hash index table. "
               "This is only valid if use_data_block_hash_index is "
               "set to true");
 
+DEFINE_bool(data_block_restart_key_prefixes,
+            ROCKSDB_NAMESPACE::BlockBasedTableOptions()
+                .data_block_restart_key_prefixes,
+            "Store the key prefixes of restart points in data blocks");
+
 DEFINE_int64(compressed_cache_size, -1,
              "Number of bytes to use as a cache of compressed data.");
 
@@ -760,6 +817,12 @@ DEFINE_bool(whole_key_filtering,
             ROCKSDB_NAMESPACE::BlockBasedTableOptions().whole_key_filtering,
             "Use whole keys (in addition to prefixes) in SST bloom filter.");
 
+DEFINE_uint32(range_filter_key_width,
+              ROCKSDB_NAMESPACE::BlockBasedTableOptions()
+                  .range_filter_key_width,
+              "If non-zero, the number of bytes of each key that the SST "
+              "range filter keeps");
+
 DEFINE_bool(use_existing_db, false,
             "If true, do not destroy the existing database.  If you set this "
             "flag and also specify a benchmark that wants a fresh database, "
@@ -1097,6 +1160,12 @@ DEFINE_int32(
     ROCKSDB_NAMESPACE::AdvancedColumnFamilyOptions().blob_file_starting_level,
     "[Integrated BlobDB] The starting level for blob files.");
 
+DEFINE_int32(
+    blob_multiget_threads,
+    ROCKSDB_NAMESPACE::AdvancedColumnFamilyOptions().blob_multiget_threads,
+    "[Integrated BlobDB] The number of blob files a MultiGet reads "
+    "concurrently.");
+
 DEFINE_bool(use_blob_cache, false, "[Integrated BlobDB] Enable blob cache.");
 
 DEFINE_bool(
@@ -1159,6 +1228,26 @@ DEFINE_int64(
 DEFINE_string(block_cache_trace_file, "", "Block cache trace file path.");
 DEFINE_int32(trace_replay_threads, 1,
              "The number of threads to replay, must >=1.");
+DEFINE_int32(trace_replay_scale, 1,
+             "For replayscaled, the number of virtual clients replaying each "
+             "trace record. The records of a trace are spread round-robin "
+             "over the clients (threads) assigned to it, so a scale of 3 "
+             "triples the load of the trace. Capped at the number of clients "
+             "of the trace.");
+DEFINE_bool(trace_replay_perturb_keys, false,
+            "For replayscaled, prefix the keys of all but the first copy of "
+            "a trace record with the copy number, so that the copies read "
+            "and write their own key space instead of hitting the cache "
+            "entries of the original.");
+
+DEFINE_string(cloud_fs_options, "",
+              "The cloud file system of the cloud lifecycle benchmarks "
+              "(cloudopenwarm, cloudclone, ...), as given to "
+              "CloudFileSystemEnv::CreateFromString(), e.g. \"id=cloud; "
+              "dest.bucket=b; dest.object=/db; provider={id=simulated}\". The "
+              "local directory of the cloud DB is --db with a _cloud suffix.");
+DEFINE_int32(cloud_lifecycle_ops, 10,
+             "The number of times a cloud lifecycle benchmark runs its step.");
 
 DEFINE_bool(io_uring_enabled, true,
             "If true, enable the use of IO uring if the platform supports it");
@@ -1252,10 +1341,21 @@ DEFINE_uint64(
     "num_file_reads_for_auto_readahead indicates after how many sequential "
     "reads into that file internal auto prefetching should be start.");
 
+DEFINE_bool(learn_auto_readahead_size,
+            ROCKSDB_NAMESPACE::BlockBasedTableOptions()
+                .learn_auto_readahead_size,
+            "Start the auto-readahead of iterators at the average length of "
+            "the sampled scans over each table file");
+
 DEFINE_bool(
     auto_readahead_size, false,
     "When set true, RocksDB does auto tuning of readahead size during Scans");
 
+DEFINE_uint64(max_async_readahead_reads,
+              ROCKSDB_NAMESPACE::ReadOptions().max_async_readahead_reads,
+              "With async_io, bounds the asynchronous readahead reads in "
+              "flight across the table files of an iterator. 0 is unbounded");
+
 static enum ROCKSDB_NAMESPACE::CompressionType StringToCompressionType(
     const char* ctype) {
   assert(ctype);
@@ -1350,6 +1450,11 @@ DEFINE_bool(compression_use_zstd_dict_trainer,
             "If true, use ZSTD_TrainDictionary() to create dictionary, else"
             "use ZSTD_FinalizeDictionary() to create dictionary");
 
+DEFINE_bool(compression_train_dict_in_background,
+            ROCKSDB_NAMESPACE::CompressionOptions().train_dict_in_background,
+            "If true, train the dictionary in the background from samples of "
+            "all the files, and use it for the new files.");
+
 static bool ValidateTableCacheNumshardbits(const char* flagname,
                                            int32_t value) {
   if (0 >= value || value >= 20) {
@@ -1715,6 +1820,10 @@ DEFINE_string(merge_operator, "",
 DEFINE_int32(skip_list_lookahead, 0,
              "Used with skip_list memtablerep; try linear search first for "
              "this many steps from the previous position");
+DEFINE_uint64(skip_list_hash_index_buckets, 0,
+              "Used with skip_list memtablerep; if non-zero, the buckets of a "
+              "hash index from each key to its newest entry, used by point "
+              "lookups");
 DEFINE_bool(report_file_operations, false,
             "if report number of file operations");
 DEFINE_bool(report_open_timing, false, "if report open timing");
@@ -1782,7 +1891,8 @@ static Status CreateMemTableRepFactory(
     std::shared_ptr<MemTableRepFactory>* factory) {
   Status s;
   if (!strcasecmp(FLAGS_memtablerep.c_str(), SkipListFactory::kNickName())) {
-    factory->reset(new SkipListFactory(FLAGS_skip_list_lookahead));
+    factory->reset(new SkipListFactory(FLAGS_skip_list_lookahead,
+                                       FLAGS_skip_list_hash_index_buckets));
   } else if (!strcasecmp(FLAGS_memtablerep.c_str(), "prefix_hash")) {
     factory->reset(NewHashSkipListRepFactory(FLAGS_hash_bucket_count));
   } else if (!strcasecmp(FLAGS_memtablerep.c_str(),
@@ -2150,6 +2260,32 @@ static std::unordered_map<OperationType, std::string, std::hash<unsigned char>>
                            {kCrc, "crc"},           {kHash, "hash"},
                            {kOthers, "op"}};
 
+// The step of the life of a cloud DB that a cloud lifecycle benchmark times
+enum class CloudLifecycleStep : unsigned char {
+  kOpenWarm,
+  kOpenCold,
+  kClone,
+  kSavepoint,
+  kCheckpoint,
+  kEpochRoll,
+  kPurgerList,
+};
+
+// The tickers the cloud lifecycle benchmarks report per step
+static const std::vector<std::pair<Tickers, const char*>>
+    kCloudLifecycleTickers = {{CLOUD_READ_REQUESTS, "read"},
+                              {CLOUD_WRITE_REQUESTS, "write"},
+                              {CLOUD_INFO_REQUESTS, "info"},
+                              {CLOUD_LIST_REQUESTS, "list"},
+                              {CLOUD_COPY_REQUESTS, "copy"},
+                              {CLOUD_DELETE_REQUESTS, "delete"},
+                              {CLOUD_CREATE_REQUESTS, "create"},
+                              {CLOUD_REQUEST_FAILURES, "failures"},
+                              {CLOUD_REQUEST_RETRIES, "retries"},
+                              {CLOUD_REQUEST_THROTTLES, "throttles"},
+                              {CLOUD_BYTES_READ, "bytes_read"},
+                              {CLOUD_BYTES_WRITTEN, "bytes_written"}};
+
 class CombinedStats;
 class Stats {
  private:
@@ -2279,6 +2415,11 @@ class Stats {
     last_op_finish_ = clock_->NowMicros();
   }
 
+  // Measures the latency of the next op from `micros`, e.g. its intended
+  // start time when ops are paced open-loop, so that an op delayed by the
+  // previous ones is accounted its wait
+  void SetLastOpTime(uint64_t micros) { last_op_finish_ = micros; }
+
   void FinishedOps(DBWithColumnFamilies* db_with_cfh, DB* db, int64_t num_ops,
                    enum OperationType op_type = kOthers) {
     if (reporter_agent_) {
@@ -2736,6 +2877,11 @@ class Benchmark {
   bool report_file_operations_;
   bool use_blob_db_;    // Stacked BlobDB
   bool read_operands_;  // read via GetMergeOperands()
+  CloudLifecycleStep cloud_lifecycle_step_;
+  // The cloud DB of the cloud lifecycle benchmarks, see PrepareCloudDB()
+  std::shared_ptr<Statistics> cloud_stats_;
+  std::shared_ptr<CloudFileSystem> cloud_fs_;
+  std::unique_ptr<Env> cloud_env_;
   std::vector<std::string> keys_;
 
   class ErrorHandlerListener : public EventListener {
@@ -3126,6 +3272,8 @@ class Benchmark {
       HyperClockCacheOptions opts(FLAGS_cache_size, estimated_entry_charge,
                                   FLAGS_cache_numshardbits);
       opts.hash_seed = GetCacheHashSeed();
+      opts.numa_local_shards = FLAGS_cache_numa_local_shards;
+      opts.numa_duplicate_ratio = FLAGS_cache_numa_duplicate_ratio;
       if (use_tiered_cache) {
         TieredCacheOptions tiered_opts;
         tiered_opts.cache_type = PrimaryCacheType::kCacheTypeHCC;
@@ -3154,6 +3302,7 @@ class Benchmark {
           GetCacheAllocator(), kDefaultToAdaptiveMutex,
           kDefaultCacheMetadataChargePolicy, FLAGS_cache_low_pri_pool_ratio);
       opts.hash_seed = GetCacheHashSeed();
+      opts.use_frequency_admission = FLAGS_cache_frequency_admission;
       if (use_tiered_cache) {
         TieredCacheOptions tiered_opts;
         tiered_opts.cache_type = PrimaryCacheType::kCacheTypeLRU;
@@ -3211,7 +3360,8 @@ class Benchmark {
         merge_keys_(FLAGS_merge_keys < 0 ? FLAGS_num : FLAGS_merge_keys),
         report_file_operations_(FLAGS_report_file_operations),
         use_blob_db_(FLAGS_use_blob_db),  // Stacked BlobDB
-        read_operands_(false) {
+        read_operands_(false),
+        cloud_lifecycle_step_(CloudLifecycleStep::kOpenWarm) {
     // use simcache instead of cache
     if (FLAGS_simcache_size >= 0) {
       if (FLAGS_cache_numshardbits >= 1) {
@@ -3454,6 +3604,8 @@ class Benchmark {
       read_options_.async_io = FLAGS_async_io;
       read_options_.optimize_multiget_for_io = FLAGS_optimize_multiget_for_io;
       read_options_.auto_readahead_size = FLAGS_auto_readahead_size;
+      read_options_.max_async_readahead_reads =
+          static_cast<size_t>(FLAGS_max_async_readahead_reads);
 
       void (Benchmark::*method)(ThreadState*) = nullptr;
       void (Benchmark::*post_process_method)() = nullptr;
@@ -3719,6 +3871,32 @@ class Benchmark {
           ErrorExit();
         }
         method = &Benchmark::Replay;
+      } else if (name == "replayscaled") {
+        if (FLAGS_trace_file == "") {
+          fprintf(stderr, "Please set --trace_file to be replayed from\n");
+          ErrorExit();
+        }
+        if (FLAGS_trace_replay_scale < 1) {
+          fprintf(stderr, "--trace_replay_scale must be >= 1\n");
+          ErrorExit();
+        }
+        method = &Benchmark::ReplayScaled;
+      } else if (CloudLifecycleStepFromName(name, &cloud_lifecycle_step_)) {
+        if (num_threads > 1) {
+          fprintf(stderr,
+                  "The cloud lifecycle benchmarks are single-threaded\n");
+          ErrorExit();
+        }
+        if (FLAGS_cloud_fs_options.empty()) {
+          fprintf(stderr, "Please set --cloud_fs_options for %s\n",
+                  name.c_str());
+          ErrorExit();
+        }
+        if (FLAGS_cloud_lifecycle_ops < 1) {
+          fprintf(stderr, "--cloud_lifecycle_ops must be >= 1\n");
+          ErrorExit();
+        }
+        method = &Benchmark::CloudLifecycle;
       } else if (name == "getmergeoperands") {
         method = &Benchmark::GetMergeOperands;
       } else if (name == "verifychecksum") {
@@ -3774,7 +3952,8 @@ class Benchmark {
         // operations. But db_bench does not support tracing and replaying at
         // the same time, for now. So, start tracing only when it is not a
         // replay.
-        if (FLAGS_trace_file != "" && name != "replay") {
+        if (FLAGS_trace_file != "" && name != "replay" &&
+            name != "replayscaled") {
           std::unique_ptr<TraceWriter> trace_writer;
           Status s = NewFileTraceWriter(FLAGS_env, EnvOptions(),
                                         FLAGS_trace_file, &trace_writer);
@@ -3871,7 +4050,7 @@ class Benchmark {
       secondary_update_thread_.reset();
     }
 
-    if (name != "replay" && FLAGS_trace_file != "") {
+    if (name != "replay" && name != "replayscaled" && FLAGS_trace_file != "") {
       Status s = db_.db->EndTrace();
       if (!s.ok()) {
         fprintf(stderr, "Encountered an error ending the trace, %s\n",
@@ -4211,6 +4390,8 @@ class Benchmark {
         FLAGS_compression_max_dict_buffer_bytes;
     options.compression_opts.use_zstd_dict_trainer =
         FLAGS_compression_use_zstd_dict_trainer;
+    options.compression_opts.train_dict_in_background =
+        FLAGS_compression_train_dict_in_background;
 
     options.max_open_files = FLAGS_open_files;
     if (FLAGS_cost_write_buffer_to_cache || FLAGS_db_write_buffer_size != 0) {
@@ -4230,6 +4411,7 @@ class Benchmark {
     options.max_background_compactions = FLAGS_max_background_compactions;
     options.max_subcompactions = static_cast<uint32_t>(FLAGS_subcompactions);
     options.max_background_flushes = FLAGS_max_background_flushes;
+    options.max_flush_subjobs = FLAGS_max_flush_subjobs;
     options.compaction_style = FLAGS_compaction_style_e;
     options.compaction_pri = FLAGS_compaction_pri_e;
     options.allow_mmap_reads = FLAGS_mmap_read;
@@ -4360,6 +4542,8 @@ class Benchmark {
       } else if (FLAGS_index_with_first_key) {
         block_based_options.index_type =
             BlockBasedTableOptions::kBinarySearchWithFirstKey;
+      } else if (FLAGS_learned_index) {
+        block_based_options.index_type = BlockBasedTableOptions::kLearnedSearch;
       }
       BlockBasedTableOptions::IndexShorteningMode index_shortening =
           block_based_options.index_shortening;
@@ -4438,12 +4622,16 @@ class Benchmark {
           FLAGS_enable_index_compression;
       block_based_options.block_align = FLAGS_block_align;
       block_based_options.whole_key_filtering = FLAGS_whole_key_filtering;
+      block_based_options.range_filter_key_width =
+          FLAGS_range_filter_key_width;
       block_based_options.max_auto_readahead_size =
           FLAGS_max_auto_readahead_size;
       block_based_options.initial_auto_readahead_size =
           FLAGS_initial_auto_readahead_size;
       block_based_options.num_file_reads_for_auto_readahead =
           FLAGS_num_file_reads_for_auto_readahead;
+      block_based_options.learn_auto_readahead_size =
+          FLAGS_learn_auto_readahead_size;
       BlockBasedTableOptions::PrepopulateBlockCache prepopulate_block_cache =
           block_based_options.prepopulate_block_cache;
       switch (FLAGS_prepopulate_block_cache) {
@@ -4459,7 +4647,11 @@ class Benchmark {
           fprintf(stderr, "Unknown prepopulate block cache mode\n");
       }
       block_based_options.prepopulate_block_cache = prepopulate_block_cache;
-      if (FLAGS_use_data_block_hash_index) {
+      if (FLAGS_use_data_block_hash_index &&
+          FLAGS_data_block_blocked_hash_index) {
+        block_based_options.data_block_index_type = ROCKSDB_NAMESPACE::
+            BlockBasedTableOptions::kDataBlockBinaryAndBlockedHash;
+      } else if (FLAGS_use_data_block_hash_index) {
         block_based_options.data_block_index_type =
             ROCKSDB_NAMESPACE::BlockBasedTableOptions::kDataBlockBinaryAndHash;
       } else {
@@ -4468,6 +4660,8 @@ class Benchmark {
       }
       block_based_options.data_block_hash_table_util_ratio =
           FLAGS_data_block_hash_table_util_ratio;
+      block_based_options.data_block_restart_key_prefixes =
+          FLAGS_data_block_restart_key_prefixes;
       if (FLAGS_read_cache_path != "") {
         Status rc_status;
 
@@ -4661,6 +4855,8 @@ class Benchmark {
         FLAGS_universal_allow_trivial_move;
     options.compaction_options_universal.incremental =
         FLAGS_universal_incremental;
+    options.compaction_options_universal.incremental_round_robin =
+        FLAGS_universal_incremental_round_robin;
     if (FLAGS_thread_status_per_interval > 0) {
       options.enable_thread_tracking = true;
     }
@@ -4692,6 +4888,7 @@ class Benchmark {
     options.blob_compaction_readahead_size =
         FLAGS_blob_compaction_readahead_size;
     options.blob_file_starting_level = FLAGS_blob_file_starting_level;
+    options.blob_multiget_threads = FLAGS_blob_multiget_threads;
 
     if (FLAGS_readonly && FLAGS_transaction_db) {
       fprintf(stderr, "Cannot use readonly flag with transaction_db\n");
@@ -8502,6 +8699,507 @@ class Benchmark {
     }
   }
 
+  // Rewrites the keys of a write batch with PerturbKey()
+  class PerturbKeysHandler : public WriteBatch::Handler {
+   public:
+    PerturbKeysHandler(const std::string& prefix, WriteBatch* batch)
+        : prefix_(prefix), batch_(batch) {}
+
+    Status PutCF(uint32_t column_family_id, const Slice& key,
+                 const Slice& value) override {
+      return WriteBatchInternal::Put(batch_, column_family_id, Perturb(key),
+                                     value);
+    }
+    Status DeleteCF(uint32_t column_family_id, const Slice& key) override {
+      return WriteBatchInternal::Delete(batch_, column_family_id,
+                                        Perturb(key));
+    }
+    Status SingleDeleteCF(uint32_t column_family_id,
+                          const Slice& key) override {
+      return WriteBatchInternal::SingleDelete(batch_, column_family_id,
+                                              Perturb(key));
+    }
+    Status DeleteRangeCF(uint32_t column_family_id, const Slice& begin_key,
+                         const Slice& end_key) override {
+      return WriteBatchInternal::DeleteRange(batch_, column_family_id,
+                                             Perturb(begin_key),
+                                             Perturb(end_key));
+    }
+    Status MergeCF(uint32_t column_family_id, const Slice& key,
+                   const Slice& value) override {
+      return WriteBatchInternal::Merge(batch_, column_family_id, Perturb(key),
+                                       value);
+    }
+
+   private:
+    std::string Perturb(const Slice& key) const {
+      return prefix_ + key.ToString();
+    }
+
+    const std::string& prefix_;
+    WriteBatch* batch_;
+  };
+
+  // Returns a copy of `record` with its keys and iterator bounds prefixed
+  // with `prefix`, or nullptr if the record can't be perturbed
+  static std::unique_ptr<TraceRecord> PerturbKeys(const TraceRecord& record,
+                                                  const std::string& prefix) {
+    auto perturb = [&](const Slice& key) -> std::string {
+      return key.empty() ? std::string() : prefix + key.ToString();
+    };
+    switch (record.GetTraceType()) {
+      case kTraceWrite: {
+        const auto& write_record =
+            static_cast<const WriteQueryTraceRecord&>(record);
+        WriteBatch original(write_record.GetWriteBatchRep().ToString());
+        WriteBatch batch;
+        PerturbKeysHandler handler(prefix, &batch);
+        if (!original.Iterate(&handler).ok()) {
+          return nullptr;
+        }
+        return std::make_unique<WriteQueryTraceRecord>(batch.Data(),
+                                                       record.GetTimestamp());
+      }
+      case kTraceGet: {
+        const auto& get_record =
+            static_cast<const GetQueryTraceRecord&>(record);
+        return std::make_unique<GetQueryTraceRecord>(
+            get_record.GetColumnFamilyID(), perturb(get_record.GetKey()),
+            record.GetTimestamp());
+      }
+      case kTraceIteratorSeek:
+      case kTraceIteratorSeekForPrev: {
+        const auto& seek_record =
+            static_cast<const IteratorSeekQueryTraceRecord&>(record);
+        return std::make_unique<IteratorSeekQueryTraceRecord>(
+            seek_record.GetSeekType(), seek_record.GetColumnFamilyID(),
+            perturb(seek_record.GetKey()),
+            perturb(seek_record.GetLowerBound()),
+            perturb(seek_record.GetUpperBound()), record.GetTimestamp());
+      }
+      case kTraceMultiGet: {
+        const auto& multi_get_record =
+            static_cast<const MultiGetQueryTraceRecord&>(record);
+        std::vector<std::string> keys;
+        for (const Slice& key : multi_get_record.GetKeys()) {
+          keys.push_back(perturb(key));
+        }
+        return std::make_unique<MultiGetQueryTraceRecord>(
+            multi_get_record.GetColumnFamilyIDs(), keys,
+            record.GetTimestamp());
+      }
+      default:
+        return nullptr;
+    }
+  }
+
+  // Each thread is a virtual client replaying the trace file
+  // (tid % number of trace files) of the comma-separated --trace_file. The
+  // k-th record of a trace is replayed by --trace_replay_scale of the M
+  // clients of the trace, from the client (k % M) on, the copy replayed by
+  // the i-th of them getting its keys perturbed if
+  // --trace_replay_perturb_keys.
+  //
+  // The records are paced open-loop: a record is started at the time of the
+  // trace (scaled by --trace_replay_fast_forward) whether the previous ones
+  // completed or not, and its latency is measured from that intended start,
+  // so that a slow DB isn't hidden by clients backing off (coordinated
+  // omission).
+  void ReplayScaled(ThreadState* thread) {
+    if (db_.db == nullptr) {
+      return;
+    }
+    std::vector<std::string> trace_files = StringSplit(FLAGS_trace_file, ',');
+    const int num_clients = thread->shared->total;
+    const int num_traces = static_cast<int>(trace_files.size());
+    const int trace_index = thread->tid % num_traces;
+    // Clients of the trace, and the index of this one among them
+    const int trace_clients = num_clients / num_traces +
+                              (trace_index < num_clients % num_traces ? 1 : 0);
+    const int client_index = thread->tid / num_traces;
+    const int scale = std::min(FLAGS_trace_replay_scale, trace_clients);
+
+    std::unique_ptr<TraceReader> trace_reader;
+    Status s = NewFileTraceReader(FLAGS_env, EnvOptions(),
+                                  trace_files[trace_index], &trace_reader);
+    if (!s.ok()) {
+      fprintf(stderr,
+              "Encountered an error creating a TraceReader from the trace "
+              "file %s. Error: %s\n",
+              trace_files[trace_index].c_str(), s.ToString().c_str());
+      exit(1);
+    }
+    std::unique_ptr<Replayer> replayer;
+    s = db_.db->NewDefaultReplayer(db_.cfh, std::move(trace_reader),
+                                   &replayer);
+    if (s.ok()) {
+      s = replayer->Prepare();
+    }
+    if (!s.ok()) {
+      fprintf(stderr, "Prepare for replay failed. Error: %s\n",
+              s.ToString().c_str());
+      exit(1);
+    }
+
+    const uint64_t header_ts = replayer->GetHeaderTimestamp();
+    const uint64_t start = FLAGS_env->NowMicros();
+    uint64_t num_failed = 0;
+    std::unique_ptr<TraceRecord> record;
+    for (uint64_t k = 0;; k++) {
+      s = replayer->Next(&record);
+      if (s.IsNotSupported()) {
+        continue;
+      } else if (!s.ok()) {
+        // Incomplete at the end of the trace
+        break;
+      }
+      const int copy =
+          (client_index - static_cast<int>(k % trace_clients) +
+           trace_clients) %
+          trace_clients;
+      if (copy >= scale) {
+        continue;
+      }
+      std::unique_ptr<TraceRecord> perturbed;
+      if (FLAGS_trace_replay_perturb_keys && copy > 0) {
+        perturbed = PerturbKeys(*record, std::to_string(copy) + ":");
+      }
+
+      const uint64_t trace_ts = record->GetTimestamp();
+      const uint64_t intended_start =
+          start + (trace_ts > header_ts
+                       ? static_cast<uint64_t>(
+                             (trace_ts - header_ts) /
+                             FLAGS_trace_replay_fast_forward)
+                       : 0);
+      const uint64_t now = FLAGS_env->NowMicros();
+      if (now < intended_start) {
+        FLAGS_env->SleepForMicroseconds(
+            static_cast<int>(intended_start - now));
+      }
+      thread->stats.SetLastOpTime(intended_start);
+
+      std::unique_ptr<TraceRecordResult> result;
+      s = replayer->Execute(perturbed ? perturbed : record, &result);
+      if (!s.ok() && !s.IsNotSupported()) {
+        num_failed++;
+      }
+      OperationType op_type = kOthers;
+      switch (record->GetTraceType()) {
+        case kTraceWrite:
+          op_type = kWrite;
+          break;
+        case kTraceGet:
+        case kTraceMultiGet:
+          op_type = kRead;
+          break;
+        case kTraceIteratorSeek:
+        case kTraceIteratorSeekForPrev:
+          op_type = kSeek;
+          break;
+        default:
+          break;
+      }
+      thread->stats.FinishedOps(&db_, db_.db, 1, op_type);
+    }
+    if (num_failed > 0) {
+      fprintf(stderr, "Client %d failed to replay %" PRIu64 " records\n",
+              thread->tid, num_failed);
+    }
+  }
+
+  static bool CloudLifecycleStepFromName(const std::string& name,
+                                         CloudLifecycleStep* step) {
+    static const std::pair<const char*, CloudLifecycleStep> kSteps[] = {
+        {"cloudopenwarm", CloudLifecycleStep::kOpenWarm},
+        {"cloudopencold", CloudLifecycleStep::kOpenCold},
+        {"cloudclone", CloudLifecycleStep::kClone},
+        {"cloudsavepoint", CloudLifecycleStep::kSavepoint},
+        {"cloudcheckpoint", CloudLifecycleStep::kCheckpoint},
+        {"cloudepochroll", CloudLifecycleStep::kEpochRoll},
+        {"cloudpurgerlist", CloudLifecycleStep::kPurgerList},
+    };
+    for (const auto& entry : kSteps) {
+      if (name == entry.first) {
+        *step = entry.second;
+        return true;
+      }
+    }
+    return false;
+  }
+
+  // The local directories of the cloud DB and of its clones
+  static std::string CloudLocalDir(const std::string& suffix) {
+    return FLAGS_db + "_cloud" + suffix;
+  }
+
+  static Status NewCloudFileSystem(const std::string& value,
+                                   const CloudFileSystemOptions& cloud_options,
+                                   std::shared_ptr<CloudFileSystem>* cfs) {
+    ConfigOptions config_options;
+    config_options.env = FLAGS_env;
+    std::unique_ptr<CloudFileSystem> fs;
+    Status s = CloudFileSystemEnv::CreateFromString(config_options, value,
+                                                    cloud_options, &fs);
+    if (s.ok()) {
+      cfs->reset(fs.release());
+    }
+    return s;
+  }
+
+  static Status OpenCloudDB(Env* env, const std::string& local_dir,
+                            std::unique_ptr<DBCloud>* db) {
+    Options options;
+    options.env = env;
+    options.create_if_missing = true;
+    DBCloud* dbcloud = nullptr;
+    Status s = DBCloud::Open(options, local_dir, "" /* persistent_cache_path */,
+                             0 /* persistent_cache_size_gb */, &dbcloud);
+    if (s.ok()) {
+      db->reset(dbcloud);
+    }
+    return s;
+  }
+
+  // Creates the cloud file system of --cloud_fs_options, whose requests are
+  // counted by cloud_stats_, and writes --num keys to its DB if the DB is
+  // empty. The DB is left flushed and closed.
+  void PrepareCloudDB() {
+    if (cloud_fs_ != nullptr) {
+      return;
+    }
+    cloud_stats_ = CreateDBStatistics();
+    CloudFileSystemOptions cloud_options;
+    cloud_options.statistics = cloud_stats_;
+    Status s =
+        NewCloudFileSystem(FLAGS_cloud_fs_options, cloud_options, &cloud_fs_);
+    std::unique_ptr<DBCloud> db;
+    if (s.ok()) {
+      cloud_env_ = CloudFileSystemEnv::NewCompositeEnv(FLAGS_env, cloud_fs_);
+      s = OpenCloudDB(cloud_env_.get(), CloudLocalDir(""), &db);
+    }
+    if (s.ok() && db->GetLatestSequenceNumber() == 0) {
+      RandomGenerator gen;
+      std::unique_ptr<const char[]> key_guard;
+      Slice key = AllocateKey(&key_guard);
+      WriteBatch batch;
+      for (int64_t i = 0; s.ok() && i < num_; i++) {
+        GenerateKeyFromInt(i, num_, &key);
+        s = batch.Put(key, gen.Generate(FLAGS_value_size));
+        if (s.ok() && (batch.Count() == 1000 || i == num_ - 1)) {
+          s = db->Write(WriteOptions(), &batch);
+          batch.Clear();
+        }
+      }
+      if (s.ok()) {
+        s = db->Flush(FlushOptions());
+      }
+    }
+    if (!s.ok()) {
+      fprintf(stderr, "Cannot prepare the cloud DB: %s\n",
+              s.ToString().c_str());
+      ErrorExit();
+    }
+  }
+
+  // Opens a clone of the cloud DB in `local_dir`, writing to `object_path`
+  // of the bucket of the cloud DB. The clone shares the storage provider of
+  // the cloud DB, see RebindCloudStorageProvider().
+  Status OpenCloudClone(const std::string& local_dir,
+                        const std::string& object_path,
+                        std::shared_ptr<CloudFileSystem>* cfs,
+                        std::unique_ptr<Env>* env,
+                        std::unique_ptr<DBCloud>* db) {
+    CloudFileSystemOptions cloud_options =
+        cloud_fs_->GetCloudFileSystemOptions();
+    cloud_options.src_bucket = cloud_options.dest_bucket;
+    cloud_options.dest_bucket.SetObjectPath(object_path);
+    Status s = NewCloudFileSystem(cloud_fs_->Name(), cloud_options, cfs);
+    if (s.ok()) {
+      *env = CloudFileSystemEnv::NewCompositeEnv(FLAGS_env, *cfs);
+      s = OpenCloudDB(env->get(), local_dir, db);
+    }
+    return s;
+  }
+
+  // Preparing the file system of a clone bound the shared storage provider
+  // to it. Binds the provider back to the cloud DB once the clone is gone.
+  void RebindCloudStorageProvider() {
+    ConfigOptions config_options;
+    config_options.env = cloud_env_.get();
+    Status s = cloud_fs_->GetStorageProvider()->PrepareOptions(config_options);
+    if (!s.ok()) {
+      fprintf(stderr, "Cannot rebind the cloud storage provider: %s\n",
+              s.ToString().c_str());
+      ErrorExit();
+    }
+  }
+
+  // Rolls the cloud DB to a new epoch under its current cookie, as a new
+  // leader does before it writes
+  Status RollCloudEpoch(DBCloud* db) {
+    char epoch[17];
+    snprintf(epoch, sizeof(epoch), "%016" PRIx64,
+             GetSliceHash64(FLAGS_env->GenerateUniqueId()));
+    const CloudManifestDelta delta{db->GetNextFileNumber(), epoch};
+    IOStatus s = cloud_fs_->RollNewCookie(
+        CloudLocalDir(""),
+        cloud_fs_->GetCloudFileSystemOptions().new_cookie_on_open, delta);
+    bool applied = false;
+    if (s.ok()) {
+      s = cloud_fs_->ApplyCloudManifestDelta(delta, &applied);
+    }
+    if (s.ok()) {
+      db->NewManifestOnNextUpdate();
+    }
+    return s;
+  }
+
+  // The listings of a purger run, which finds the obsolete files and the
+  // obsolete dbids of the bucket before deleting any
+  Status ListCloudObsoleteFiles() {
+    auto* cfs = static_cast_with_check<CloudFileSystemImpl>(cloud_fs_.get());
+    std::vector<std::string> pathnames;
+    std::vector<std::string> dbids;
+    IOStatus s = cfs->FindObsoleteFiles(cfs->GetDestBucketName(), &pathnames);
+    if (s.ok()) {
+      s = cfs->FindObsoleteDbid(cfs->GetDestBucketName(), &dbids);
+    }
+    return s;
+  }
+
+  std::vector<uint64_t> CloudTickerCounts() const {
+    std::vector<uint64_t> counts;
+    for (const auto& ticker : kCloudLifecycleTickers) {
+      counts.push_back(cloud_stats_->getTickerCount(ticker.first));
+    }
+    return counts;
+  }
+
+  // Runs a step of the life of the cloud DB of --cloud_fs_options
+  // --cloud_lifecycle_ops times. Only the step itself is timed: its set up
+  // (e.g. emptying the local directory of a cold open) and its tear down
+  // (e.g. closing the DB) are not. Besides the latency of a step, the
+  // message of the report has its cloud requests by type and its bytes
+  // transferred, from the CLOUD_* tickers.
+  void CloudLifecycle(ThreadState* thread) {
+    PrepareCloudDB();
+    const CloudLifecycleStep step = cloud_lifecycle_step_;
+    const auto& provider = cloud_fs_->GetStorageProvider();
+    const std::string& bucket = cloud_fs_->GetDestBucketName();
+    const std::string local_dir = CloudLocalDir("");
+    const std::string clone_dir = CloudLocalDir("_clone");
+    const std::string clone_path = cloud_fs_->GetDestObjectPath() + "_clone";
+    BucketOptions checkpoint =
+        cloud_fs_->GetCloudFileSystemOptions().dest_bucket;
+    checkpoint.SetObjectPath(cloud_fs_->GetDestObjectPath() + "_checkpoint");
+
+    // The steps on an open DB share one
+    std::unique_ptr<DBCloud> db;
+    Status s;
+    if (step == CloudLifecycleStep::kCheckpoint ||
+        step == CloudLifecycleStep::kEpochRoll ||
+        step == CloudLifecycleStep::kPurgerList) {
+      s = OpenCloudDB(cloud_env_.get(), local_dir, &db);
+    }
+    std::vector<uint64_t> totals(kCloudLifecycleTickers.size(), 0);
+    uint64_t total_micros = 0;
+    for (int i = 0; s.ok() && i < FLAGS_cloud_lifecycle_ops; i++) {
+      std::shared_ptr<CloudFileSystem> clone_fs;
+      std::unique_ptr<Env> clone_env;
+      std::unique_ptr<DBCloud> clone_db;
+      switch (step) {
+        case CloudLifecycleStep::kOpenCold:
+          s = DestroyDir(FLAGS_env, local_dir);
+          break;
+        case CloudLifecycleStep::kClone:
+        case CloudLifecycleStep::kSavepoint:
+          s = DestroyDir(FLAGS_env, clone_dir);
+          if (s.ok()) {
+            s = provider->EmptyBucket(bucket, clone_path);
+          }
+          if (s.ok() && step == CloudLifecycleStep::kSavepoint) {
+            s = OpenCloudClone(clone_dir, clone_path, &clone_fs, &clone_env,
+                               &clone_db);
+          }
+          break;
+        case CloudLifecycleStep::kCheckpoint:
+          s = provider->EmptyBucket(bucket, checkpoint.GetObjectPath());
+          break;
+        default:
+          break;
+      }
+      if (s.IsNotFound()) {
+        // Nothing to empty
+        s = Status::OK();
+      }
+      if (!s.ok()) {
+        break;
+      }
+
+      const std::vector<uint64_t> before = CloudTickerCounts();
+      thread->stats.ResetLastOpTime();
+      const uint64_t start = FLAGS_env->NowMicros();
+      switch (step) {
+        case CloudLifecycleStep::kOpenWarm:
+        case CloudLifecycleStep::kOpenCold:
+          s = OpenCloudDB(cloud_env_.get(), local_dir, &db);
+          break;
+        case CloudLifecycleStep::kClone:
+          s = OpenCloudClone(clone_dir, clone_path, &clone_fs, &clone_env,
+                             &clone_db);
+          break;
+        case CloudLifecycleStep::kSavepoint:
+          s = clone_db->Savepoint();
+          break;
+        case CloudLifecycleStep::kCheckpoint:
+          s = db->CheckpointToCloud(checkpoint, CheckpointToCloudOptions());
+          break;
+        case CloudLifecycleStep::kEpochRoll:
+          s = RollCloudEpoch(db.get());
+          break;
+        case CloudLifecycleStep::kPurgerList:
+          s = ListCloudObsoleteFiles();
+          break;
+      }
+      total_micros += FLAGS_env->NowMicros() - start;
+      thread->stats.FinishedOps(nullptr, nullptr, 1, kOthers);
+      const std::vector<uint64_t> after = CloudTickerCounts();
+      for (size_t j = 0; j < totals.size(); j++) {
+        totals[j] += after[j] - before[j];
+      }
+
+      if (step == CloudLifecycleStep::kOpenWarm ||
+          step == CloudLifecycleStep::kOpenCold) {
+        db.reset();
+      }
+      if (clone_fs != nullptr) {
+        clone_db.reset();
+        clone_env.reset();
+        clone_fs.reset();
+        RebindCloudStorageProvider();
+      }
+    }
+    db.reset();
+    if (!s.ok()) {
+      fprintf(stderr, "Cloud lifecycle step failed: %s\n",
+              s.ToString().c_str());
+      ErrorExit();
+    }
+
+    const double ops = FLAGS_cloud_lifecycle_ops;
+    char buf[64];
+    snprintf(buf, sizeof(buf), "(per step: %.1f micros", total_micros / ops);
+    std::string message = buf;
+    for (size_t j = 0; j < totals.size(); j++) {
+      snprintf(buf, sizeof(buf), ", %s %.1f", kCloudLifecycleTickers[j].second,
+               totals[j] / ops);
+      message += buf;
+    }
+    message += ")";
+    thread->stats.AddMessage(message);
+  }
+
   void Backup(ThreadState* thread) {
     DB* db = SelectDB(thread);
     std::unique_ptr<BackupEngineOptions> engine_options(
@@ -0,0 +1,424 @@
+//  Copyright (c) 2011-present, Facebook, Inc.  All rights reserved.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+
+#ifndef GFLAGS
+#include <cstdio>
+int main() {
+  fprintf(stderr, "Please install gflags to run rocksdb tools\n");
+  return 1;
+}
+#else
+
+#include <atomic>
+#include <cinttypes>
+#include <condition_variable>
+#include <cstdio>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "file/filename.h"
+#include "monitoring/histogram.h"
+#include "port/port.h"
+#include "rocksdb/db.h"
+#include "rocksdb/env.h"
+#include "rocksdb/options.h"
+#include "util/coding.h"
+#include "util/gflags_compat.h"
+#include "util/random.h"
+
+// Benchmark of physical replication. A leader DB publishes its replication
+// log records through ReplicationLogListener into an in-memory transport,
+// from which in-process followers apply them with
+// DB::ApplyReplicationLogRecord(). Reports the write throughput of the
+// leader, the apply throughput of the followers and the distribution of the
+// replication lag, i.e. the time from a record being published to it being
+// applied.
+
+DEFINE_string(db, "", "Directory of the leader and follower DBs");
+DEFINE_uint64(num, 1000000, "Number of writes per writer thread");
+DEFINE_int32(threads, 4, "Number of writer threads on the leader");
+DEFINE_int32(batch_size, 1, "Number of keys per write batch");
+DEFINE_int32(key_size, 16, "Size of the keys");
+DEFINE_int32(value_size, 100, "Size of the values");
+DEFINE_int32(followers, 1, "Number of followers");
+DEFINE_uint64(transport_latency_us, 0,
+              "Simulated latency of the transport, a record can only be "
+              "applied this long after it was published");
+DEFINE_bool(concurrent_apply, false,
+            "Apply large memtable writes with AR_CONCURRENT_MEMTABLE_WRITES");
+DEFINE_uint64(write_buffer_size, 64 << 20, "Write buffer size of the leader");
+DEFINE_uint64(report_interval_seconds, 10,
+              "Interval at which progress is reported, 0 to disable");
+
+using ROCKSDB_NAMESPACE::ColumnFamilyOptions;
+using ROCKSDB_NAMESPACE::DB;
+using ROCKSDB_NAMESPACE::DestroyDB;
+using ROCKSDB_NAMESPACE::Env;
+using ROCKSDB_NAMESPACE::EnvOptions;
+using ROCKSDB_NAMESPACE::EnvWrapper;
+using ROCKSDB_NAMESPACE::FileType;
+using ROCKSDB_NAMESPACE::HistogramImpl;
+using ROCKSDB_NAMESPACE::Options;
+using ROCKSDB_NAMESPACE::ParseFileName;
+using ROCKSDB_NAMESPACE::RandomAccessFile;
+using ROCKSDB_NAMESPACE::Random64;
+using ROCKSDB_NAMESPACE::ReplicationEpochExtractor;
+using ROCKSDB_NAMESPACE::ReplicationLogListener;
+using ROCKSDB_NAMESPACE::ReplicationLogRecord;
+using ROCKSDB_NAMESPACE::Slice;
+using ROCKSDB_NAMESPACE::Status;
+using ROCKSDB_NAMESPACE::WriteBatch;
+using ROCKSDB_NAMESPACE::WriteOptions;
+
+using GFLAGS_NAMESPACE::ParseCommandLineFlags;
+using GFLAGS_NAMESPACE::SetUsageMessage;
+
+namespace {
+
+// Replication sequences are the epoch followed by the index of the record in
+// the log, both fixed64.
+class BenchEpochExtractor : public ReplicationEpochExtractor {
+ public:
+  uint64_t EpochOfReplicationSequence(Slice replication_seq) override {
+    uint64_t epoch = 0;
+    ROCKSDB_NAMESPACE::GetFixed64(&replication_seq, &epoch);
+    return epoch;
+  }
+};
+
+struct LogEntry {
+  ReplicationLogRecord record;
+  std::string replication_sequence;
+  uint64_t publish_micros;
+};
+
+// In-memory transport between the leader and its followers. Records are
+// dropped once every follower has read them.
+class Transport : public ReplicationLogListener {
+ public:
+  Transport(Env* env, int followers) : env_(env), positions_(followers, 0) {}
+
+  std::string OnReplicationLogRecord(ReplicationLogRecord record) override {
+    record.Own();
+    std::string replication_sequence;
+    std::lock_guard<std::mutex> lock(mutex_);
+    ROCKSDB_NAMESPACE::PutFixed64(&replication_sequence, 1 /* epoch */);
+    ROCKSDB_NAMESPACE::PutFixed64(&replication_sequence,
+                                  base_ + log_.size());
+    log_.push_back(
+        LogEntry{std::move(record), replication_sequence, env_->NowMicros()});
+    cv_.notify_all();
+    return replication_sequence;
+  }
+
+  bool AcceptsPinnedContents() const override { return true; }
+
+  // Returns false once the leader is done and the follower read everything.
+  bool Read(int follower, LogEntry* entry) {
+    std::unique_lock<std::mutex> lock(mutex_);
+    uint64_t& position = positions_[follower];
+    cv_.wait(lock, [&]() { return position < base_ + log_.size() || done_; });
+    if (position == base_ + log_.size()) {
+      return false;
+    }
+    *entry = log_[position - base_];
+    position++;
+    Trim();
+    return true;
+  }
+
+  void Finish() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    done_ = true;
+    cv_.notify_all();
+  }
+
+  uint64_t Published() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return base_ + log_.size();
+  }
+
+ private:
+  // REQUIRES: mutex_ held
+  void Trim() {
+    uint64_t min_position = base_ + log_.size();
+    for (auto p : positions_) {
+      min_position = std::min(min_position, p);
+    }
+    while (base_ < min_position) {
+      log_.pop_front();
+      base_++;
+    }
+  }
+
+  Env* env_;
+  std::mutex mutex_;
+  std::condition_variable cv_;
+  std::deque<LogEntry> log_;
+  // Index of the first record in log_
+  uint64_t base_{0};
+  std::vector<uint64_t> positions_;
+  bool done_{false};
+};
+
+// Followers read the SST files of the leader
+class FollowerEnv : public EnvWrapper {
+ public:
+  FollowerEnv(Env* base, std::string leader_path)
+      : EnvWrapper(base), leader_path_(std::move(leader_path)) {}
+
+  const char* Name() const override { return "FollowerEnv"; }
+
+  Status NewRandomAccessFile(const std::string& fname,
+                             std::unique_ptr<RandomAccessFile>* result,
+                             const EnvOptions& options) override {
+    return EnvWrapper::NewRandomAccessFile(MapFilename(fname), result,
+                                           options);
+  }
+
+  Status GetFileSize(const std::string& fname, uint64_t* file_size) override {
+    return EnvWrapper::GetFileSize(MapFilename(fname), file_size);
+  }
+
+ private:
+  std::string MapFilename(const std::string& fname) {
+    auto pos = fname.rfind('/');
+    std::string base = pos == std::string::npos ? fname : fname.substr(pos + 1);
+    uint64_t number = 0;
+    FileType type;
+    if (ParseFileName(base, &number, &type) &&
+        type == ROCKSDB_NAMESPACE::kTableFile) {
+      return leader_path_ + "/" + base;
+    }
+    return fname;
+  }
+
+  std::string leader_path_;
+};
+
+struct FollowerStats {
+  HistogramImpl lag_micros;
+  uint64_t records{0};
+  uint64_t bytes{0};
+  uint64_t apply_micros{0};
+};
+
+void RunFollower(DB* db, Transport* transport, int index,
+                 FollowerStats* stats) {
+  Env* env = Env::Default();
+  unsigned flags = DB::AR_EVICT_OBSOLETE_FILES;
+  if (FLAGS_concurrent_apply) {
+    flags |= DB::AR_CONCURRENT_MEMTABLE_WRITES;
+  }
+  LogEntry entry;
+  while (transport->Read(index, &entry)) {
+    uint64_t ready = entry.publish_micros + FLAGS_transport_latency_us;
+    uint64_t now = env->NowMicros();
+    if (now < ready) {
+      env->SleepForMicroseconds(static_cast<int>(ready - now));
+    }
+    size_t bytes = entry.record.contents.size();
+    uint64_t start = env->NowMicros();
+    DB::ApplyReplicationLogRecordInfo info;
+    Status s = db->ApplyReplicationLogRecord(
+        std::move(entry.record), entry.replication_sequence,
+        [db](Slice) { return ColumnFamilyOptions(db->GetOptions()); },
+        1 /* snapshot_replication_epoch */, &info, flags);
+    if (!s.ok()) {
+      fprintf(stderr, "Follower %d failed to apply record: %s\n", index,
+              s.ToString().c_str());
+      exit(1);
+    }
+    for (auto& cf : info.added_column_families) {
+      cf.reset();
+    }
+    uint64_t end = env->NowMicros();
+    stats->apply_micros += end - start;
+    stats->lag_micros.Add(end - entry.publish_micros);
+    stats->records++;
+    stats->bytes += bytes;
+  }
+}
+
+void RunWriter(DB* db, int index, std::atomic<uint64_t>* written) {
+  Random64 rnd(301 + index);
+  WriteOptions wo;
+  wo.disableWAL = true;
+  std::string key(FLAGS_key_size, '\0');
+  std::string value(FLAGS_value_size, 'v');
+  for (uint64_t i = 0; i < FLAGS_num; i += FLAGS_batch_size) {
+    WriteBatch batch;
+    for (int j = 0; j < FLAGS_batch_size; j++) {
+      uint64_t k = rnd.Next();
+      for (int b = 0; b < FLAGS_key_size; b++) {
+        key[b] = static_cast<char>(k >> ((b % 8) * 8));
+      }
+      Status s = batch.Put(key, value);
+      if (!s.ok()) {
+        fprintf(stderr, "Error in put: %s\n", s.ToString().c_str());
+        exit(1);
+      }
+    }
+    Status s = db->Write(wo, &batch);
+    if (!s.ok()) {
+      fprintf(stderr, "Leader write failed: %s\n", s.ToString().c_str());
+      exit(1);
+    }
+    written->fetch_add(FLAGS_batch_size, std::memory_order_relaxed);
+  }
+}
+
+}  // namespace
+
+int main(int argc, const char** argv) {
+  SetUsageMessage(std::string("\nUSAGE:\n") + std::string(argv[0]) +
+                  " [--db=<dir>] [--num=<writes per thread>]"
+                  " [--threads=<writers>] [--followers=<n>]"
+                  " [--transport_latency_us=<us>]");
+  ParseCommandLineFlags(&argc, const_cast<char***>(&argv), true);
+
+  Env* env = Env::Default();
+  std::string path = FLAGS_db;
+  if (path.empty()) {
+    env->GetTestDirectory(&path);
+    path += "/db_repl_bench";
+  }
+  std::string leader_path = path + "/leader";
+  env->CreateDirIfMissing(path);
+
+  auto transport = std::make_shared<Transport>(env, FLAGS_followers);
+
+  Options leader_options;
+  leader_options.create_if_missing = true;
+  leader_options.atomic_flush = true;
+  leader_options.write_buffer_size = FLAGS_write_buffer_size;
+  leader_options.max_background_jobs = 4;
+  leader_options.replication_epoch_extractor =
+      std::make_shared<BenchEpochExtractor>();
+  DestroyDB(leader_path, leader_options);
+  leader_options.replication_log_listener = transport;
+
+  DB* leader = nullptr;
+  Status s = DB::Open(leader_options, leader_path, &leader);
+  if (!s.ok()) {
+    fprintf(stderr, "Could not open leader: %s\n", s.ToString().c_str());
+    exit(1);
+  }
+  // Followers keep reading the SST files that the leader compacted away
+  s = leader->DisableFileDeletions();
+  if (!s.ok()) {
+    fprintf(stderr, "Could not disable file deletions: %s\n",
+            s.ToString().c_str());
+    exit(1);
+  }
+
+  FollowerEnv follower_env(env, leader_path);
+  std::vector<std::unique_ptr<DB>> followers;
+  for (int i = 0; i < FLAGS_followers; i++) {
+    Options options;
+    options.create_if_missing = true;
+    options.atomic_flush = true;
+    options.env = &follower_env;
+    options.disable_auto_compactions = true;
+    options.disable_auto_flush = true;
+    options.replication_epoch_extractor =
+        leader_options.replication_epoch_extractor;
+    auto follower_path = path + "/follower-" + std::to_string(i);
+    DestroyDB(follower_path, options);
+    DB* db = nullptr;
+    s = DB::Open(options, follower_path, &db);
+    if (!s.ok()) {
+      fprintf(stderr, "Could not open follower %d: %s\n", i,
+              s.ToString().c_str());
+      exit(1);
+    }
+    followers.emplace_back(db);
+  }
+
+  std::vector<FollowerStats> follower_stats(FLAGS_followers);
+  std::vector<std::thread> follower_threads;
+  for (int i = 0; i < FLAGS_followers; i++) {
+    follower_threads.emplace_back(RunFollower, followers[i].get(),
+                                  transport.get(), i, &follower_stats[i]);
+  }
+
+  std::atomic<uint64_t> written{0};
+  uint64_t start = env->NowMicros();
+  std::vector<std::thread> writers;
+  for (int i = 0; i < FLAGS_threads; i++) {
+    writers.emplace_back(RunWriter, leader, i, &written);
+  }
+
+  std::atomic<bool> writing{true};
+  std::thread reporter([&]() {
+    if (FLAGS_report_interval_seconds == 0) {
+      return;
+    }
+    uint64_t last = 0;
+    while (writing.load()) {
+      for (uint64_t t = 0; t < FLAGS_report_interval_seconds * 10 && writing;
+           t++) {
+        env->SleepForMicroseconds(100000);
+      }
+      uint64_t now = written.load();
+      fprintf(stdout, "... %" PRIu64 " writes, %.1f writes/sec, %" PRIu64
+              " records published\n",
+              now, (now - last) / double(FLAGS_report_interval_seconds),
+              transport->Published());
+      fflush(stdout);
+      last = now;
+    }
+  });
+
+  for (auto& t : writers) {
+    t.join();
+  }
+  uint64_t write_micros = env->NowMicros() - start;
+  writing = false;
+  reporter.join();
+
+  transport->Finish();
+  for (auto& t : follower_threads) {
+    t.join();
+  }
+  uint64_t catch_up_micros = env->NowMicros() - start;
+
+  double write_seconds = write_micros / 1e6;
+  uint64_t total_writes = written.load();
+  uint64_t write_bytes = total_writes * (FLAGS_key_size + FLAGS_value_size);
+  fprintf(stdout,
+          "leader:      %" PRIu64 " writes in %.3f s, %.1f writes/sec, "
+          "%.1f MB/sec, %" PRIu64 " records\n",
+          total_writes, write_seconds, total_writes / write_seconds,
+          write_bytes / 1048576.0 / write_seconds, transport->Published());
+  for (int i = 0; i < FLAGS_followers; i++) {
+    auto& fs = follower_stats[i];
+    double apply_seconds = fs.apply_micros / 1e6;
+    fprintf(stdout,
+            "follower %d:  %" PRIu64 " records, %.1f records/sec, "
+            "%.1f MB/sec applying, caught up after %.3f s\n",
+            i, fs.records, fs.records / std::max(apply_seconds, 1e-6),
+            fs.bytes / 1048576.0 / std::max(apply_seconds, 1e-6),
+            catch_up_micros / 1e6);
+    fprintf(stdout,
+            "  lag (us):  P50 %.1f P99 %.1f P99.9 %.1f max %.1f\n",
+            fs.lag_micros.Percentile(50), fs.lag_micros.Percentile(99),
+            fs.lag_micros.Percentile(99.9),
+            static_cast<double>(fs.lag_micros.max()));
+  }
+
+  followers.clear();
+  s = leader->Close();
+  delete leader;
+  if (!s.ok()) {
+    fprintf(stderr, "Could not close leader: %s\n", s.ToString().c_str());
+    return 1;
+  }
+  return 0;
+}
+
+#endif  // GFLAGS
@@ -454,6 +454,53 @@ TEST_F(SSTDumpToolTest, ValidSSTPath) {
   }
 }
 
+TEST_F(SSTDumpToolTest, NumThreads) {
+  Options opts;
+  opts.env = env();
+  std::vector<std::string> sst_files;
+  for (int i = 0; i < 3; i++) {
+    sst_files.push_back(MakeFilePath("rocksdb_sst_test" + std::to_string(i) +
+                                     ".sst"));
+    createSST(opts, sst_files.back());
+  }
+  std::string fake_sst = MakeFilePath("fake_sst.sst");
+  ASSERT_OK(WriteStringToFile(opts.env, "Not an SST file!", fake_sst, false));
+
+  char* usage[4];
+  PopulateCommandArgs(MakeFilePath(""), "", usage);
+  snprintf(usage[3], kOptLength, "--num_threads=4");
+
+  std::atomic<int> num_reads{0};
+  SyncPoint::GetInstance()->SetCallBack(
+      "RandomAccessFileReader::Read",
+      [&](void*) { num_reads.fetch_add(1, std::memory_order_relaxed); });
+  SyncPoint::GetInstance()->EnableProcessing();
+
+  SSTDumpTool tool;
+  for (const auto& command_arg : {"--command=verify", "--command=check"}) {
+    snprintf(usage[1], kOptLength, "%s", command_arg);
+    num_reads = 0;
+    ASSERT_TRUE(!tool.Run(4, usage, opts));
+    // The data blocks of all the files were read
+    ASSERT_GE(num_reads.load(), 3 * 3);
+  }
+
+  SyncPoint::GetInstance()->ClearAllCallBacks();
+  SyncPoint::GetInstance()->DisableProcessing();
+
+  // No valid SST file
+  snprintf(usage[2], kOptLength, "--file=%s", fake_sst.c_str());
+  ASSERT_TRUE(tool.Run(4, usage, opts));
+
+  for (const auto& sst_file : sst_files) {
+    cleanup(opts, sst_file);
+  }
+  ASSERT_OK(opts.env->DeleteFile(fake_sst));
+  for (int i = 0; i < 4; i++) {
+    delete[] usage[i];
+  }
+}
+
 TEST_F(SSTDumpToolTest, RawOutput) {
   Options opts;
   opts.env = env();
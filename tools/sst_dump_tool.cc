@@ -6,6 +6,7 @@
 
 #include "rocksdb/sst_dump_tool.h"
 
+#include <atomic>
 #include <cinttypes>
 #include <iostream>
 
@@ -126,6 +127,10 @@ void print_help(bool to_stderr) {
 
     --compression_use_zstd_finalize_dict
       Use zstd's finalizeDictionary() API instead of zstd's dictionary trainer to generate dictionary.
+
+    --num_threads=<num>
+      Number of files to process in parallel when executing verify, or check
+      without --read_num, --show_properties or --show_summary (default 1)
 )",
       supported_compressions.c_str());
 }
@@ -148,6 +153,88 @@ bool ParseIntArg(const char* arg, const std::string arg_name,
   }
   return false;
 }
+
+struct ParallelFileResult {
+  // Status of opening the file
+  Status open_status;
+  // Status of verifying or checking the file
+  Status status;
+};
+
+// Verifies (verify == true) or checks the SST files `sst_files` with
+// `num_threads` threads, each opening its own SstFileDumper, then prints the
+// results in file order as the sequential code does, only without the file
+// format lines.
+void VerifyOrCheckInParallel(const Options& options,
+                             const std::vector<std::string>& sst_files,
+                             bool verify, size_t readahead_size,
+                             bool verify_checksum, bool output_hex,
+                             bool decode_blob_index, bool has_from,
+                             const std::string& from_key, bool has_to,
+                             const std::string& to_key,
+                             bool use_from_as_prefix, int num_threads,
+                             std::vector<std::string>* valid_sst_files) {
+  std::vector<ParallelFileResult> results(sst_files.size());
+  std::atomic<size_t> next_file{0};
+  auto worker = [&]() {
+    for (size_t i = next_file.fetch_add(1); i < sst_files.size();
+         i = next_file.fetch_add(1)) {
+      SstFileDumper dumper(options, sst_files[i], Temperature::kUnknown,
+                           readahead_size, verify_checksum, output_hex,
+                           decode_blob_index, EnvOptions(), true /* silent */);
+      results[i].open_status = dumper.getStatus();
+      if (!results[i].open_status.ok()) {
+        continue;
+      }
+      if (verify) {
+        results[i].status = dumper.VerifyChecksum();
+      } else {
+        results[i].status = dumper.ReadSequential(
+            false /* print_kv */, std::numeric_limits<uint64_t>::max(),
+            has_from, from_key, has_to, to_key, use_from_as_prefix);
+      }
+    }
+  };
+  std::vector<port::Thread> threads;
+  for (int i = 1; i < num_threads && static_cast<size_t>(i) < sst_files.size();
+       i++) {
+    threads.emplace_back(worker);
+  }
+  worker();
+  for (auto& thread : threads) {
+    thread.join();
+  }
+
+  for (size_t i = 0; i < sst_files.size(); i++) {
+    const std::string& filename = sst_files[i];
+    const ParallelFileResult& result = results[i];
+    fprintf(stdout, "Process %s\n", filename.c_str());
+    if (!result.open_status.ok()) {
+      fprintf(stderr, "%s: %s\n", filename.c_str(),
+              result.open_status.ToString().c_str());
+      continue;
+    }
+    valid_sst_files->push_back(filename);
+    if (verify) {
+      if (!result.status.ok()) {
+        fprintf(stderr, "%s is corrupted: %s\n", filename.c_str(),
+                result.status.ToString().c_str());
+      } else {
+        fprintf(stdout, "The file is ok\n");
+      }
+    } else {
+      if (valid_sst_files->size() == 1) {
+        fprintf(stdout, "from [%s] to [%s]\n",
+                Slice(from_key).ToString(true).c_str(),
+                Slice(to_key).ToString(true).c_str());
+      }
+      if (!result.status.ok()) {
+        fprintf(stderr, "%s: %s\n", filename.c_str(),
+                result.status.ToString().c_str());
+      }
+    }
+  }
+}
 }  // namespace
 
 int SSTDumpTool::Run(int argc, char const* const* argv, Options options) {
@@ -178,6 +265,7 @@ int SSTDumpTool::Run(int argc, char const* const* argv, Options options) {
   std::string compression_level_to_str;
   size_t block_size = 0;
   size_t readahead_size = 2 * 1024 * 1024;
+  int num_threads = 1;
   std::vector<std::pair<CompressionType, const char*>> compression_types;
   uint64_t total_num_files = 0;
   uint64_t total_num_data_blocks = 0;
@@ -237,6 +325,13 @@ int SSTDumpTool::Run(int argc, char const* const* argv, Options options) {
     } else if (ParseIntArg(argv[i], "--readahead_size=",
                            "readahead_size must be numeric", &tmp_val)) {
       readahead_size = static_cast<size_t>(tmp_val);
+    } else if (ParseIntArg(argv[i], "--num_threads=",
+                           "num_threads must be numeric", &tmp_val)) {
+      if (tmp_val < 1) {
+        fprintf(stderr, "num_threads must be positive\n");
+        exit(1);
+      }
+      num_threads = static_cast<int>(tmp_val);
     } else if (strncmp(argv[i], "--compression_types=", 20) == 0) {
       std::string compression_types_csv = argv[i] + 20;
       std::istringstream iss(compression_types_csv);
@@ -409,7 +504,33 @@ int SSTDumpTool::Run(int argc, char const* const* argv, Options options) {
   uint64_t total_read = 0;
   // List of RocksDB SST file without corruption
   std::vector<std::string> valid_sst_files;
-  for (size_t i = 0; i < filenames.size(); i++) {
+
+  // verify, and check when it reads the files entirely and prints nothing
+  // but errors, are independent across files and can run in parallel
+  const bool parallel =
+      num_threads > 1 &&
+      (command == "verify" ||
+       ((command == "" || command == "check") &&
+        read_num == std::numeric_limits<uint64_t>::max() &&
+        !show_properties && !show_summary));
+  if (parallel) {
+    std::vector<std::string> sst_files;
+    for (const auto& filename : filenames) {
+      if (filename.length() <= 4 ||
+          filename.rfind(".sst") != filename.length() - 4) {
+        continue;
+      }
+      sst_files.push_back(dir ? std::string(dir_or_file) + "/" + filename
+                              : filename);
+    }
+    VerifyOrCheckInParallel(
+        options, sst_files, command == "verify", readahead_size,
+        verify_checksum || command == "verify", output_hex, decode_blob_index,
+        has_from || use_from_as_prefix, from_key, has_to, to_key,
+        use_from_as_prefix, num_threads, &valid_sst_files);
+  }
+
+  for (size_t i = 0; !parallel && i < filenames.size(); i++) {
     std::string filename = filenames.at(i);
     if (filename.length() <= 4 ||
         filename.rfind(".sst") != filename.length() - 4) {
@@ -12,6 +12,7 @@
 #include <cassert>
 
 #include "port/port.h"
+#include "util/aligned_buffer_pool.h"
 
 namespace ROCKSDB_NAMESPACE {
 
@@ -60,6 +61,18 @@ class AlignedBuffer {
   size_t capacity_;
   size_t cursize_;
   char* bufstart_;
+  // Size of the allocation of buf_, alignment padding included
+  size_t allocated_size_ = 0;
+  // Whether the buffers come from and go back to AlignedBufferPool
+  bool use_pool_ = false;
+
+  void FreeBuffer() {
+    if (use_pool_ && buf_ != nullptr) {
+      AlignedBufferPool::Instance()->Free(buf_.release(), allocated_size_);
+    }
+    buf_.reset();
+    allocated_size_ = 0;
+  }
 
  public:
   AlignedBuffer()
@@ -68,14 +81,20 @@ class AlignedBuffer {
   AlignedBuffer(AlignedBuffer&& o) noexcept { *this = std::move(o); }
 
   AlignedBuffer& operator=(AlignedBuffer&& o) noexcept {
+    FreeBuffer();
     alignment_ = std::move(o.alignment_);
     buf_ = std::move(o.buf_);
     capacity_ = std::move(o.capacity_);
     cursize_ = std::move(o.cursize_);
     bufstart_ = std::move(o.bufstart_);
+    allocated_size_ = o.allocated_size_;
+    use_pool_ = o.use_pool_;
+    o.allocated_size_ = 0;
     return *this;
   }
 
+  ~AlignedBuffer() { FreeBuffer(); }
+
   AlignedBuffer(const AlignedBuffer&) = delete;
 
   AlignedBuffer& operator=(const AlignedBuffer&) = delete;
@@ -100,10 +119,13 @@ class AlignedBuffer {
 
   void Clear() { cursize_ = 0; }
 
+  // Hands the buffer over to the caller, to be freed with delete[] even
+  // when it comes from AlignedBufferPool
   char* Release() {
     cursize_ = 0;
     capacity_ = 0;
     bufstart_ = nullptr;
+    allocated_size_ = 0;
     return buf_.release();
   }
 
@@ -113,6 +135,10 @@ class AlignedBuffer {
     alignment_ = alignment;
   }
 
+  // Takes the next buffers from AlignedBufferPool and gives them back to it
+  // when replaced or destroyed, for the short-lived buffers of reads
+  void UsePool() { use_pool_ = true; }
+
   // Allocates a new buffer and sets the start position to the first aligned
   // byte.
   //
@@ -141,7 +167,10 @@ class AlignedBuffer {
     }
 
     size_t new_capacity = Roundup(requested_capacity, alignment_);
-    char* new_buf = new char[new_capacity + alignment_];
+    size_t new_allocated_size = new_capacity + alignment_;
+    char* new_buf = use_pool_ ? AlignedBufferPool::Instance()->Allocate(
+                                    new_allocated_size, &new_allocated_size)
+                              : new char[new_allocated_size];
     char* new_bufstart = reinterpret_cast<char*>(
         (reinterpret_cast<uintptr_t>(new_buf) + (alignment_ - 1)) &
         ~static_cast<uintptr_t>(alignment_ - 1));
@@ -154,9 +183,11 @@ class AlignedBuffer {
       cursize_ = 0;
     }
 
+    FreeBuffer();
     bufstart_ = new_bufstart;
     capacity_ = new_capacity;
     buf_.reset(new_buf);
+    allocated_size_ = new_allocated_size;
   }
 
   // Append to the buffer.
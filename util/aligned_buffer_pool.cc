@@ -0,0 +1,108 @@
+//  Copyright (c) Meta Platforms, Inc. and affiliates.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+
+#include "util/aligned_buffer_pool.h"
+
+#include <atomic>
+
+#include "port/port.h"
+#include "util/core_local.h"
+
+namespace ROCKSDB_NAMESPACE {
+namespace aligned_buffer_pool {
+
+constexpr size_t kNumSizeClasses = 7;
+static_assert(AlignedBufferPool::kMinSizeClass << (kNumSizeClasses - 1) ==
+                  AlignedBufferPool::kMaxSizeClass,
+              "Expected a size class per power of two");
+
+// Index of the smallest size class of at least `size` bytes,
+// kNumSizeClasses if there is none
+size_t SizeClassOf(size_t size) {
+  size_t size_class = 0;
+  while (size_class < kNumSizeClasses &&
+         (AlignedBufferPool::kMinSizeClass << size_class) < size) {
+    ++size_class;
+  }
+  return size_class;
+}
+
+// The buffers cached for a core, nullptr in the free slots
+struct alignas(CACHE_LINE_SIZE) CoreBuffers {
+  std::atomic<char*> buffers[kNumSizeClasses];
+
+  CoreBuffers() {
+    for (auto& buf : buffers) {
+      buf.store(nullptr, std::memory_order_relaxed);
+    }
+  }
+  CoreBuffers(const CoreBuffers&) = delete;
+  CoreBuffers& operator=(const CoreBuffers&) = delete;
+
+  ~CoreBuffers() {
+    for (auto& buf : buffers) {
+      delete[] buf.load(std::memory_order_relaxed);
+    }
+  }
+};
+}  // namespace aligned_buffer_pool
+
+class AlignedBufferPool::Rep {
+ public:
+  char* Allocate(size_t size, size_t* allocated_size) {
+    const size_t size_class = aligned_buffer_pool::SizeClassOf(size);
+    if (size_class == aligned_buffer_pool::kNumSizeClasses) {
+      *allocated_size = size;
+      return new char[size];
+    }
+    *allocated_size = kMinSizeClass << size_class;
+    char* buf = per_core_.Access()->buffers[size_class].exchange(
+        nullptr, std::memory_order_acquire);
+    if (buf == nullptr) {
+      buf = new char[*allocated_size];
+    }
+    return buf;
+  }
+
+  void Free(char* buf, size_t allocated_size) {
+    const size_t size_class = aligned_buffer_pool::SizeClassOf(allocated_size);
+    if (size_class == aligned_buffer_pool::kNumSizeClasses ||
+        (kMinSizeClass << size_class) != allocated_size) {
+      delete[] buf;
+      return;
+    }
+    char* expected = nullptr;
+    if (!per_core_.Access()->buffers[size_class].compare_exchange_strong(
+            expected, buf, std::memory_order_release,
+            std::memory_order_relaxed)) {
+      // The core already caches a buffer of that size
+      delete[] buf;
+    }
+  }
+
+ private:
+  CoreLocalArray<aligned_buffer_pool::CoreBuffers> per_core_;
+};
+
+AlignedBufferPool::AlignedBufferPool() : rep_(new Rep()) {}
+
+AlignedBufferPool* AlignedBufferPool::Instance() {
+  static AlignedBufferPool* const instance = new AlignedBufferPool();
+  return instance;
+}
+
+char* AlignedBufferPool::Allocate(size_t size, size_t* allocated_size) {
+  return rep_->Allocate(size, allocated_size);
+}
+
+void AlignedBufferPool::Free(char* buf, size_t allocated_size) {
+  if (buf != nullptr) {
+    rep_->Free(buf, allocated_size);
+  }
+}
+
+AlignedBufferPool::~AlignedBufferPool() { delete rep_; }
+
+}  // namespace ROCKSDB_NAMESPACE
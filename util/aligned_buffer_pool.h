@@ -0,0 +1,53 @@
+//  Copyright (c) Meta Platforms, Inc. and affiliates.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+
+// Aligned buffer pool keeps the memory of the AlignedBuffers of direct I/O
+// reads around, so that each unaligned read doesn't allocate and free (and
+// page fault) a fresh buffer.  Buffers are cached on a per core basis using
+// CoreLocalArray, one per power-of-two size class from kMinSizeClass to
+// kMaxSizeClass, which bounds the pooled memory to about 2 * kMaxSizeClass
+// per core.  Larger buffers are allocated and freed as before.
+//
+// Buffers are allocated with new char[], so that a buffer handed out of an
+// AlignedBuffer with AlignedBuffer::Release() can be freed with delete[] as
+// any other, the pool just not getting it back.
+
+#pragma once
+
+#include <cstddef>
+
+#include "rocksdb/rocksdb_namespace.h"
+
+namespace ROCKSDB_NAMESPACE {
+
+class AlignedBufferPool {
+ public:
+  static constexpr size_t kMinSizeClass = 4096;
+  static constexpr size_t kMaxSizeClass = 256 << 10;
+
+  // Singleton, never destroyed so that buffers can be given back to it as
+  // late as static destruction
+  static AlignedBufferPool* Instance();
+  AlignedBufferPool(const AlignedBufferPool&) = delete;
+  AlignedBufferPool& operator=(const AlignedBufferPool&) = delete;
+
+  // Returns a buffer of at least `size` bytes, the one of its size class
+  // cached for the current core if any, and its actual size in
+  // `*allocated_size`
+  char* Allocate(size_t size, size_t* allocated_size);
+
+  // Gives back a buffer of `allocated_size` bytes from Allocate(), which is
+  // freed unless the current core has room for it
+  void Free(char* buf, size_t allocated_size);
+
+ private:
+  AlignedBufferPool();
+  ~AlignedBufferPool();
+
+  class Rep;
+  Rep* rep_;
+};
+
+}  // namespace ROCKSDB_NAMESPACE
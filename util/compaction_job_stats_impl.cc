@@ -44,6 +44,13 @@ void CompactionJobStats::Reset() {
   file_range_sync_nanos = 0;
   file_fsync_nanos = 0;
   file_prepare_write_nanos = 0;
+  file_read_nanos = 0;
+  block_decompress_nanos = 0;
+  block_checksum_nanos = 0;
+  block_compress_nanos = 0;
+  compaction_filter_nanos = 0;
+  merge_operator_nanos = 0;
+  cloud_request_nanos = 0;
 
   smallest_output_key_prefix.clear();
   largest_output_key_prefix.clear();
@@ -85,6 +92,13 @@ void CompactionJobStats::Add(const CompactionJobStats& stats) {
   file_range_sync_nanos += stats.file_range_sync_nanos;
   file_fsync_nanos += stats.file_fsync_nanos;
   file_prepare_write_nanos += stats.file_prepare_write_nanos;
+  file_read_nanos += stats.file_read_nanos;
+  block_decompress_nanos += stats.block_decompress_nanos;
+  block_checksum_nanos += stats.block_checksum_nanos;
+  block_compress_nanos += stats.block_compress_nanos;
+  compaction_filter_nanos += stats.compaction_filter_nanos;
+  merge_operator_nanos += stats.merge_operator_nanos;
+  cloud_request_nanos += stats.cloud_request_nanos;
 
   num_single_del_fallthru += stats.num_single_del_fallthru;
   num_single_del_mismatch += stats.num_single_del_mismatch;
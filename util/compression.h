@@ -21,6 +21,7 @@
 #include <string>
 
 #include "memory/memory_allocator_impl.h"
+#include "rocksdb/compression_accelerator.h"
 #include "rocksdb/options.h"
 #include "rocksdb/table.h"
 #include "table/block_based/block_type.h"
@@ -1620,46 +1621,89 @@ inline std::string ZSTD_FinalizeDictionary(
 #endif  // ZSTD_VERSION_NUMBER >= 10405
 }
 
+// Whether the blocks of `type` of `length` bytes may be offloaded to
+// `accelerator`: those of compress_format_version 2 without a dictionary, of
+// the compression types documented in rocksdb/compression_accelerator.h
+inline bool AcceleratorSupports(CompressionAccelerator* accelerator,
+                                CompressionType type,
+                                uint32_t compress_format_version,
+                                const Slice& dict, size_t length) {
+  if (accelerator == nullptr || compress_format_version != 2 ||
+      !dict.empty() || length > std::numeric_limits<uint32_t>::max()) {
+    return false;
+  }
+  switch (type) {
+    case kZlibCompression:
+    case kLZ4Compression:
+    case kLZ4HCCompression:
+    case kZSTD:
+    case kZSTDNotFinalCompression:
+      return accelerator->Supports(type);
+    default:
+      return false;
+  }
+}
+
+// @param accelerator If not null, compresses the blocks it supports, the
+//    block being compressed in software when it does not take them.
 inline bool CompressData(const Slice& raw,
                          const CompressionInfo& compression_info,
                          uint32_t compress_format_version,
-                         std::string* compressed_output) {
+                         std::string* compressed_output,
+                         CompressionAccelerator* accelerator = nullptr) {
   bool ret = false;
 
+  if (AcceleratorSupports(accelerator, compression_info.type(),
+                          compress_format_version,
+                          compression_info.dict().GetRawDict(), raw.size())) {
+    const size_t original_size = compressed_output->size();
+    compression::PutDecompressedSizeInfo(compressed_output,
+                                         static_cast<uint32_t>(raw.size()));
+    ret = accelerator
+              ->Compress(compression_info.type(), compression_info.options(),
+                         raw, compressed_output)
+              .ok();
+    if (!ret) {
+      compressed_output->resize(original_size);
+    }
+  }
+
   // Will return compressed block contents if (1) the compression method is
   // supported in this platform and (2) the compression rate is "good enough".
-  switch (compression_info.type()) {
-    case kSnappyCompression:
-      ret = Snappy_Compress(compression_info, raw.data(), raw.size(),
-                            compressed_output);
-      break;
-    case kZlibCompression:
-      ret = Zlib_Compress(compression_info, compress_format_version, raw.data(),
-                          raw.size(), compressed_output);
-      break;
-    case kBZip2Compression:
-      ret = BZip2_Compress(compression_info, compress_format_version,
-                           raw.data(), raw.size(), compressed_output);
-      break;
-    case kLZ4Compression:
-      ret = LZ4_Compress(compression_info, compress_format_version, raw.data(),
-                         raw.size(), compressed_output);
-      break;
-    case kLZ4HCCompression:
-      ret = LZ4HC_Compress(compression_info, compress_format_version,
+  if (!ret) {
+    switch (compression_info.type()) {
+      case kSnappyCompression:
+        ret = Snappy_Compress(compression_info, raw.data(), raw.size(),
+                              compressed_output);
+        break;
+      case kZlibCompression:
+        ret = Zlib_Compress(compression_info, compress_format_version,
+                            raw.data(), raw.size(), compressed_output);
+        break;
+      case kBZip2Compression:
+        ret = BZip2_Compress(compression_info, compress_format_version,
+                             raw.data(), raw.size(), compressed_output);
+        break;
+      case kLZ4Compression:
+        ret = LZ4_Compress(compression_info, compress_format_version,
                            raw.data(), raw.size(), compressed_output);
-      break;
-    case kXpressCompression:
-      ret = XPRESS_Compress(raw.data(), raw.size(), compressed_output);
-      break;
-    case kZSTD:
-    case kZSTDNotFinalCompression:
-      ret = ZSTD_Compress(compression_info, raw.data(), raw.size(),
-                          compressed_output);
-      break;
-    default:
-      // Do not recognize this compression type
-      break;
+        break;
+      case kLZ4HCCompression:
+        ret = LZ4HC_Compress(compression_info, compress_format_version,
+                             raw.data(), raw.size(), compressed_output);
+        break;
+      case kXpressCompression:
+        ret = XPRESS_Compress(raw.data(), raw.size(), compressed_output);
+        break;
+      case kZSTD:
+      case kZSTDNotFinalCompression:
+        ret = ZSTD_Compress(compression_info, raw.data(), raw.size(),
+                            compressed_output);
+        break;
+      default:
+        // Do not recognize this compression type
+        break;
+    }
   }
 
   TEST_SYNC_POINT_CALLBACK("CompressData:TamperWithReturnValue",
@@ -1671,8 +1715,27 @@ inline bool CompressData(const Slice& raw,
 inline CacheAllocationPtr UncompressData(
     const UncompressionInfo& uncompression_info, const char* data, size_t n,
     size_t* uncompressed_size, uint32_t compress_format_version,
-    MemoryAllocator* allocator = nullptr,
-    const char** error_message = nullptr) {
+    MemoryAllocator* allocator = nullptr, const char** error_message = nullptr,
+    CompressionAccelerator* accelerator = nullptr) {
+  if (AcceleratorSupports(accelerator, uncompression_info.type(),
+                          compress_format_version,
+                          uncompression_info.dict().GetRawDict(), n)) {
+    const char* input_data = data;
+    size_t input_length = n;
+    uint32_t output_len = 0;
+    if (compression::GetDecompressedSizeInfo(&input_data, &input_length,
+                                             &output_len)) {
+      CacheAllocationPtr output = AllocateBlock(output_len, allocator);
+      if (accelerator
+              ->Uncompress(uncompression_info.type(),
+                           Slice(input_data, input_length), output.get(),
+                           output_len)
+              .ok()) {
+        *uncompressed_size = output_len;
+        return output;
+      }
+    }
+  }
   switch (uncompression_info.type()) {
     case kSnappyCompression:
       return Snappy_Uncompress(data, n, uncompressed_size, allocator);
@@ -52,6 +52,10 @@ ASSERT_FEATURE_COMPAT_HEADER();
 #include <wmmintrin.h>
 #endif
 
+#if defined(__AVX512F__) && defined(__AVX512VL__) && defined(__VPCLMULQDQ__)
+#include <immintrin.h>
+#endif
+
 #if defined(HAVE_ARM64_CRC)
 bool pmull_runtime_flag = false;
 #endif
@@ -1101,6 +1105,66 @@ uint32_t crc32c_3way(uint32_t crc, const char* buf, size_t len) {
   }
 }
 
+#if defined(__AVX512F__) && defined(__AVX512VL__) && defined(__VPCLMULQDQ__)
+// Folds four 512-bit registers at a time with VPCLMULQDQ, then reduces them
+// to 128 bits and finishes with the CRC32 instruction. The folding constants
+// are x^(D+32) mod P and x^(D-32) mod P, bit-reflected and shifted left by
+// one, for a folding distance of D bits.
+static inline __m512i crc32c_fold512(__m512i x, __m512i k, __m512i data) {
+  // Three-way XOR of the two carry-less products and the data.
+  return _mm512_ternarylogic_epi64(_mm512_clmulepi64_epi128(x, k, 0x00),
+                                   _mm512_clmulepi64_epi128(x, k, 0x11), data,
+                                   0x96);
+}
+
+uint32_t crc32c_avx512(uint32_t crc, const char* buf, size_t len) {
+  if (len < 256) {
+    return crc32c_3way(crc, buf, len);
+  }
+  // D = 2048 bits, between the same register in consecutive iterations.
+  const __m512i k2048 =
+      _mm512_broadcast_i32x4(_mm_set_epi64x(0xb9e02b86, 0xdcb17aa4));
+  // D = 512 bits, between consecutive registers.
+  const __m512i k512 =
+      _mm512_broadcast_i32x4(_mm_set_epi64x(0x9e4addf8, 0x740eef02));
+  // D = 384, 256 and 128 bits, from the first three 128-bit lanes to the
+  // last one.
+  const __m512i k_lanes =
+      _mm512_set_epi64(0, 0, 0x14cd00bd6, 0xf20c0dfe, 0xba4fc28e, 0x1384aa63a,
+                       0x1d82c63da, 0x1c291d04);
+
+  __m512i x0 = _mm512_loadu_si512(buf);
+  __m512i x1 = _mm512_loadu_si512(buf + 64);
+  __m512i x2 = _mm512_loadu_si512(buf + 128);
+  __m512i x3 = _mm512_loadu_si512(buf + 192);
+  x0 = _mm512_xor_si512(x0, _mm512_maskz_set1_epi32(1, ~crc));
+  buf += 256;
+  len -= 256;
+  while (len >= 256) {
+    x0 = crc32c_fold512(x0, k2048, _mm512_loadu_si512(buf));
+    x1 = crc32c_fold512(x1, k2048, _mm512_loadu_si512(buf + 64));
+    x2 = crc32c_fold512(x2, k2048, _mm512_loadu_si512(buf + 128));
+    x3 = crc32c_fold512(x3, k2048, _mm512_loadu_si512(buf + 192));
+    buf += 256;
+    len -= 256;
+  }
+  x1 = crc32c_fold512(x0, k512, x1);
+  x2 = crc32c_fold512(x1, k512, x2);
+  x3 = crc32c_fold512(x2, k512, x3);
+
+  __m512i t = _mm512_xor_si512(_mm512_clmulepi64_epi128(x3, k_lanes, 0x00),
+                               _mm512_clmulepi64_epi128(x3, k_lanes, 0x11));
+  __m128i r = _mm_xor_si128(_mm512_extracti32x4_epi32(x3, 3),
+                            _mm512_castsi512_si128(t));
+  r = _mm_ternarylogic_epi64(r, _mm512_extracti32x4_epi32(t, 1),
+                             _mm512_extracti32x4_epi32(t, 2), 0x96);
+  // The CRC of the message so far is the CRC of these 16 bytes.
+  uint64_t crc0 = _mm_crc32_u64(0, static_cast<uint64_t>(_mm_cvtsi128_si64(r)));
+  crc0 = _mm_crc32_u64(crc0, static_cast<uint64_t>(_mm_extract_epi64(r, 1)));
+  return crc32c_3way(static_cast<uint32_t>(crc0) ^ 0xffffffffu, buf, len);
+}
+#endif  // __AVX512F__ && __AVX512VL__ && __VPCLMULQDQ__
+
 #endif //__SSE4_2__ && __PCLMUL__
 
 static inline Function Choose_Extend() {
@@ -1122,7 +1186,11 @@ static inline Function Choose_Extend() {
 #ifdef _MSC_VER
 #pragma warning(default: 4551)
 #endif
+#if defined(__AVX512F__) && defined(__AVX512VL__) && defined(__VPCLMULQDQ__)
+  return crc32c_avx512;
+#else
   return crc32c_3way;
+#endif
 #else
   return ExtendImpl<DefaultCRC32>;
 #endif
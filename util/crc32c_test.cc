@@ -110,6 +110,33 @@ TEST(CRC, StandardResults) {
   }
 }
 
+TEST(CRC, MatchesBitwise) {
+  // Covers the sizes around the 256-byte blocks of the folding
+  // implementations, at unaligned offsets and with a nonzero initial crc.
+  auto bitwise = [](uint32_t crc, const char* data, size_t n) {
+    crc = ~crc;
+    for (size_t i = 0; i < n; i++) {
+      crc ^= static_cast<uint8_t>(data[i]);
+      for (int j = 0; j < 8; j++) {
+        crc = (crc >> 1) ^ (0x82f63b78u & (0u - (crc & 1)));
+      }
+    }
+    return ~crc;
+  };
+  Random rnd(301);
+  std::string data = rnd.RandomString(4096 + 64);
+  for (size_t len : {0, 1, 255, 256, 257, 511, 512, 513, 767, 1024, 1031,
+                     4096}) {
+    for (size_t offset : {0, 1, 7, 63}) {
+      for (uint32_t init : {0u, 0x12345678u}) {
+        ASSERT_EQ(bitwise(init, data.data() + offset, len),
+                  Extend(init, data.data() + offset, len))
+            << "len " << len << " offset " << offset;
+      }
+    }
+  }
+}
+
 TEST(CRC, Values) { ASSERT_NE(Value("a", 1), Value("foo", 3)); }
 
 TEST(CRC, Extend) {
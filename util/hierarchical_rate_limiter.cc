@@ -0,0 +1,403 @@
+//  Copyright (c) Meta Platforms, Inc. and affiliates.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+
+#include "util/hierarchical_rate_limiter.h"
+
+#include <algorithm>
+#include <limits>
+
+#include "monitoring/statistics_impl.h"
+#include "test_util/sync_point.h"
+#include "util/mutexlock.h"
+
+namespace ROCKSDB_NAMESPACE {
+
+struct HierarchicalRateLimiterImpl::Req {
+  explicit Req(int64_t _bytes, port::Mutex* _mu)
+      : request_bytes(_bytes), cv(_mu) {}
+  int64_t request_bytes;
+  port::CondVar cv;
+};
+
+// The RateLimiter of a tenant. Holds a reference on the limiter, so that the
+// limiter outlives the requests of its tenants.
+class HierarchicalRateLimiterImpl::TenantRateLimiter : public RateLimiter {
+ public:
+  TenantRateLimiter(std::shared_ptr<HierarchicalRateLimiterImpl> limiter,
+                    TenantNode* node)
+      : RateLimiter(limiter->mode_),
+        limiter_(std::move(limiter)),
+        node_(node) {}
+
+  ~TenantRateLimiter() override { limiter_->RemoveTenant(node_); }
+
+  // Changes the rate shared by all the tenants
+  void SetBytesPerSecond(int64_t bytes_per_second) override {
+    limiter_->SetBytesPerSecond(bytes_per_second);
+  }
+
+  using RateLimiter::Request;
+  void Request(const int64_t bytes, const Env::IOPriority pri,
+               Statistics* stats) override {
+    limiter_->Request(node_, Env::IOActivity::kUnknown, bytes, pri, stats);
+  }
+
+  void Request(const int64_t bytes, const Env::IOPriority pri,
+               Statistics* stats, OpType op_type,
+               Env::IOActivity io_activity) override {
+    if (IsRateLimited(op_type)) {
+      limiter_->Request(node_, io_activity, bytes, pri, stats);
+    }
+  }
+
+  int64_t GetSingleBurstBytes() const override {
+    return limiter_->GetRefillBytesPerPeriod();
+  }
+
+  int64_t GetTotalBytesThrough(
+      const Env::IOPriority pri = Env::IO_TOTAL) const override {
+    MutexLock g(&limiter_->request_mutex_);
+    if (pri == Env::IO_TOTAL) {
+      return node_->stats.bytes_through;
+    }
+    return node_->bytes_through[pri];
+  }
+
+  int64_t GetTotalRequests(
+      const Env::IOPriority pri = Env::IO_TOTAL) const override {
+    MutexLock g(&limiter_->request_mutex_);
+    if (pri == Env::IO_TOTAL) {
+      return node_->stats.requests;
+    }
+    return node_->requests[pri];
+  }
+
+  Status GetTotalPendingRequests(
+      int64_t* total_pending_requests,
+      const Env::IOPriority pri = Env::IO_TOTAL) const override {
+    assert(total_pending_requests != nullptr);
+    MutexLock g(&limiter_->request_mutex_);
+    if (pri == Env::IO_TOTAL) {
+      *total_pending_requests = node_->stats.pending_requests;
+    } else {
+      int64_t pending_requests = 0;
+      for (const ActivityNode& activity : node_->activities) {
+        pending_requests += static_cast<int64_t>(activity.queue[pri].size());
+      }
+      *total_pending_requests = pending_requests;
+    }
+    return Status::OK();
+  }
+
+  int64_t GetBytesPerSecond() const override {
+    return limiter_->GetBytesPerSecond();
+  }
+
+ private:
+  const std::shared_ptr<HierarchicalRateLimiterImpl> limiter_;
+  TenantNode* const node_;
+};
+
+HierarchicalRateLimiterImpl::HierarchicalRateLimiterImpl(
+    const HierarchicalRateLimiterOptions& options,
+    const std::shared_ptr<SystemClock>& clock)
+    : refill_period_us_(options.refill_period_us),
+      mode_(options.mode),
+      clock_(clock),
+      rate_bytes_per_sec_(options.rate_bytes_per_sec),
+      refill_bytes_per_period_(
+          CalculateRefillBytesPerPeriodLocked(options.rate_bytes_per_sec)),
+      next_refill_us_(NowMicrosMonotonicLocked()) {}
+
+HierarchicalRateLimiterImpl::~HierarchicalRateLimiterImpl() {
+  // The tenants hold a reference on the limiter
+  assert(tenants_.empty());
+  assert(num_pending_ == 0);
+}
+
+Status HierarchicalRateLimiterImpl::NewTenant(
+    const RateLimiterTenantOptions& options,
+    std::shared_ptr<RateLimiter>* tenant) {
+  assert(tenant != nullptr);
+  if (options.name.empty()) {
+    return Status::InvalidArgument("The tenant must have a name");
+  }
+  if (options.weight == 0 || options.default_activity_weight == 0) {
+    return Status::InvalidArgument("The weights must be greater than 0");
+  }
+  for (const auto& activity_weight : options.activity_weights) {
+    if (activity_weight.first > Env::IOActivity::kUnknown ||
+        activity_weight.second == 0) {
+      return Status::InvalidArgument("Invalid weight of activity");
+    }
+  }
+
+  auto node = std::make_unique<TenantNode>();
+  node->name = options.name;
+  node->weight = options.weight;
+  for (ActivityNode& activity : node->activities) {
+    activity.weight = options.default_activity_weight;
+  }
+  for (const auto& activity_weight : options.activity_weights) {
+    node->activities[static_cast<size_t>(activity_weight.first)].weight =
+        activity_weight.second;
+  }
+
+  TenantNode* node_ptr = node.get();
+  {
+    MutexLock g(&request_mutex_);
+    if (!tenants_.emplace(options.name, std::move(node)).second) {
+      return Status::InvalidArgument("Duplicate tenant", options.name);
+    }
+    // The tenant does not get credit for the time before it joined
+    node_ptr->vtime = tenants_vtime_;
+  }
+  tenant->reset(new TenantRateLimiter(shared_from_this(), node_ptr));
+  return Status::OK();
+}
+
+void HierarchicalRateLimiterImpl::RemoveTenant(TenantNode* tenant) {
+  MutexLock g(&request_mutex_);
+  assert(tenant->stats.pending_requests == 0);
+  auto it = tenants_.find(tenant->name);
+  assert(it != tenants_.end() && it->second.get() == tenant);
+  tenants_.erase(it);
+}
+
+void HierarchicalRateLimiterImpl::SetBytesPerSecond(int64_t bytes_per_second) {
+  assert(bytes_per_second > 0);
+  MutexLock g(&request_mutex_);
+  rate_bytes_per_sec_.store(bytes_per_second, std::memory_order_relaxed);
+  refill_bytes_per_period_.store(
+      CalculateRefillBytesPerPeriodLocked(bytes_per_second),
+      std::memory_order_relaxed);
+}
+
+int64_t HierarchicalRateLimiterImpl::GetBytesPerSecond() const {
+  return rate_bytes_per_sec_.load(std::memory_order_relaxed);
+}
+
+const HierarchicalRateLimiterImpl::TenantNode*
+HierarchicalRateLimiterImpl::FindTenantLocked(const std::string& name) const {
+  auto it = tenants_.find(name);
+  return it == tenants_.end() ? nullptr : it->second.get();
+}
+
+Status HierarchicalRateLimiterImpl::GetTenantStats(const std::string& name,
+                                                   NodeStats* stats) const {
+  assert(stats != nullptr);
+  MutexLock g(&request_mutex_);
+  const TenantNode* tenant = FindTenantLocked(name);
+  if (tenant == nullptr) {
+    return Status::NotFound("Tenant", name);
+  }
+  *stats = tenant->stats;
+  return Status::OK();
+}
+
+Status HierarchicalRateLimiterImpl::GetActivityStats(
+    const std::string& name, Env::IOActivity io_activity,
+    NodeStats* stats) const {
+  assert(stats != nullptr);
+  if (io_activity > Env::IOActivity::kUnknown) {
+    return Status::InvalidArgument("Invalid activity");
+  }
+  MutexLock g(&request_mutex_);
+  const TenantNode* tenant = FindTenantLocked(name);
+  if (tenant == nullptr) {
+    return Status::NotFound("Tenant", name);
+  }
+  *stats = tenant->activities[static_cast<size_t>(io_activity)].stats;
+  return Status::OK();
+}
+
+void HierarchicalRateLimiterImpl::Request(TenantNode* tenant,
+                                          Env::IOActivity io_activity,
+                                          int64_t bytes, Env::IOPriority pri,
+                                          Statistics* stats) {
+  assert(bytes <= GetRefillBytesPerPeriod());
+  assert(pri < Env::IO_TOTAL);
+  bytes = std::max(static_cast<int64_t>(0), bytes);
+  if (io_activity > Env::IOActivity::kUnknown) {
+    io_activity = Env::IOActivity::kUnknown;
+  }
+  TEST_SYNC_POINT("HierarchicalRateLimiterImpl::Request");
+  MutexLock g(&request_mutex_);
+
+  ActivityNode* activity =
+      &tenant->activities[static_cast<size_t>(io_activity)];
+  ++tenant->requests[pri];
+  ++tenant->stats.requests;
+  ++activity->stats.requests;
+
+  // The available bytes are left over by a refill that granted all the
+  // pending requests
+  assert(available_bytes_ == 0 || num_pending_ == 0);
+  if (available_bytes_ > 0) {
+    int64_t bytes_through = std::min(available_bytes_, bytes);
+    available_bytes_ -= bytes_through;
+    bytes -= bytes_through;
+    ChargeLocked(tenant, activity, pri, bytes_through);
+  }
+
+  if (bytes == 0) {
+    return;
+  }
+
+  // Request cannot be satisfied at this moment, enqueue. The protocol of the
+  // waiting requests is the one of GenericRateLimiter::Request(): one of them
+  // waits for the next refill time, then refills the bytes and grants the
+  // requests.
+  Req r(bytes, &request_mutex_);
+  EnqueueLocked(tenant, activity, pri, &r);
+  TEST_SYNC_POINT_CALLBACK(
+      "HierarchicalRateLimiterImpl::Request:PostEnqueueRequest",
+      &request_mutex_);
+  do {
+    int64_t time_until_refill_us = next_refill_us_ - NowMicrosMonotonicLocked();
+    if (time_until_refill_us > 0) {
+      if (wait_until_refill_pending_) {
+        r.cv.Wait();
+      } else {
+        int64_t wait_until = clock_->NowMicros() + time_until_refill_us;
+        RecordTick(stats, NUMBER_RATE_LIMITER_DRAINS);
+        wait_until_refill_pending_ = true;
+        clock_->TimedWait(&r.cv, std::chrono::microseconds(wait_until));
+        wait_until_refill_pending_ = false;
+      }
+    } else {
+      RefillBytesAndGrantRequestsLocked();
+    }
+    if (r.request_bytes == 0) {
+      // Keep a pending request awake for the next refill
+      SignalPendingRequestLocked();
+    }
+  } while (r.request_bytes > 0);
+}
+
+void HierarchicalRateLimiterImpl::ChargeLocked(TenantNode* tenant,
+                                               ActivityNode* activity,
+                                               Env::IOPriority pri,
+                                               int64_t bytes) {
+  tenant->vtime += static_cast<double>(bytes) / tenant->weight;
+  activity->vtime += static_cast<double>(bytes) / activity->weight;
+  tenant->bytes_through[pri] += bytes;
+  tenant->stats.bytes_through += bytes;
+  activity->stats.bytes_through += bytes;
+}
+
+void HierarchicalRateLimiterImpl::EnqueueLocked(TenantNode* tenant,
+                                                ActivityNode* activity,
+                                                Env::IOPriority pri,
+                                                Req* req) {
+  if (tenant->stats.pending_requests == 0) {
+    tenant->vtime = std::max(tenant->vtime, tenants_vtime_);
+  }
+  if (activity->stats.pending_requests == 0) {
+    activity->vtime = std::max(activity->vtime, tenant->activities_vtime);
+  }
+  activity->queue[pri].push_back(req);
+  ++activity->stats.pending_requests;
+  ++tenant->stats.pending_requests;
+  ++num_pending_;
+}
+
+void HierarchicalRateLimiterImpl::SignalPendingRequestLocked() {
+  if (num_pending_ == 0) {
+    return;
+  }
+  for (const auto& entry : tenants_) {
+    const TenantNode& tenant = *entry.second;
+    if (tenant.stats.pending_requests == 0) {
+      continue;
+    }
+    for (const ActivityNode& activity : tenant.activities) {
+      for (int i = Env::IO_TOTAL - 1; i >= Env::IO_LOW; --i) {
+        if (!activity.queue[i].empty()) {
+          activity.queue[i].front()->cv.Signal();
+          return;
+        }
+      }
+    }
+  }
+  assert(false);
+}
+
+void HierarchicalRateLimiterImpl::RefillBytesAndGrantRequestsLocked() {
+  TEST_SYNC_POINT_CALLBACK(
+      "HierarchicalRateLimiterImpl::RefillBytesAndGrantRequestsLocked",
+      &request_mutex_);
+  next_refill_us_ = NowMicrosMonotonicLocked() + refill_period_us_;
+  assert(available_bytes_ == 0);
+  available_bytes_ = refill_bytes_per_period_.load(std::memory_order_relaxed);
+
+  while (available_bytes_ > 0 && num_pending_ > 0) {
+    // The pending tenant with the least bytes per weight, then its pending
+    // activity with the least bytes per weight
+    TenantNode* tenant = nullptr;
+    for (const auto& entry : tenants_) {
+      TenantNode* candidate = entry.second.get();
+      if (candidate->stats.pending_requests > 0 &&
+          (tenant == nullptr || candidate->vtime < tenant->vtime)) {
+        tenant = candidate;
+      }
+    }
+    assert(tenant != nullptr);
+    ActivityNode* activity = nullptr;
+    for (ActivityNode& candidate : tenant->activities) {
+      if (candidate.stats.pending_requests > 0 &&
+          (activity == nullptr || candidate.vtime < activity->vtime)) {
+        activity = &candidate;
+      }
+    }
+    assert(activity != nullptr);
+    int pri = Env::IO_TOTAL - 1;
+    while (activity->queue[pri].empty()) {
+      assert(pri > Env::IO_LOW);
+      --pri;
+    }
+    tenants_vtime_ = tenant->vtime;
+    tenant->activities_vtime = activity->vtime;
+
+    // Grant partial request_bytes as GenericRateLimiter does, the rest of the
+    // request competing again with the others
+    Req* next_req = activity->queue[pri].front();
+    int64_t bytes_through = std::min(available_bytes_, next_req->request_bytes);
+    available_bytes_ -= bytes_through;
+    next_req->request_bytes -= bytes_through;
+    ChargeLocked(tenant, activity, static_cast<Env::IOPriority>(pri),
+                 bytes_through);
+    if (next_req->request_bytes == 0) {
+      activity->queue[pri].pop_front();
+      --activity->stats.pending_requests;
+      --tenant->stats.pending_requests;
+      --num_pending_;
+      // Quota granted, signal the thread to exit
+      next_req->cv.Signal();
+    }
+  }
+}
+
+int64_t HierarchicalRateLimiterImpl::CalculateRefillBytesPerPeriodLocked(
+    int64_t rate_bytes_per_sec) {
+  if (std::numeric_limits<int64_t>::max() / rate_bytes_per_sec <
+      refill_period_us_) {
+    // Avoid unexpected result in the overflow case. The result now is still
+    // inaccurate but is a number that is large enough.
+    return std::numeric_limits<int64_t>::max() / kMicrosecondsPerSecond;
+  } else {
+    return rate_bytes_per_sec * refill_period_us_ / kMicrosecondsPerSecond;
+  }
+}
+
+std::shared_ptr<HierarchicalRateLimiter> NewHierarchicalRateLimiter(
+    const HierarchicalRateLimiterOptions& options) {
+  assert(options.rate_bytes_per_sec > 0);
+  assert(options.refill_period_us > 0);
+  return std::make_shared<HierarchicalRateLimiterImpl>(
+      options, SystemClock::Default());
+}
+
+}  // namespace ROCKSDB_NAMESPACE
@@ -0,0 +1,128 @@
+//  Copyright (c) Meta Platforms, Inc. and affiliates.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <deque>
+#include <map>
+#include <memory>
+#include <string>
+
+#include "port/port.h"
+#include "rocksdb/env.h"
+#include "rocksdb/rate_limiter.h"
+#include "rocksdb/status.h"
+#include "rocksdb/system_clock.h"
+
+namespace ROCKSDB_NAMESPACE {
+
+// See HierarchicalRateLimiter. Each tenant is a RateLimiter keeping the
+// limiter alive, whose requests are queued in the limiter by activity and
+// priority. Like GenericRateLimiter, the bytes are refilled every
+// refill_period_us by one of the waiting requests, which grants the
+// pending requests in the order of the weighted fair queuing: at each
+// level of the tree, the node with pending requests and the least bytes
+// granted per unit of weight goes first.
+class HierarchicalRateLimiterImpl
+    : public HierarchicalRateLimiter,
+      public std::enable_shared_from_this<HierarchicalRateLimiterImpl> {
+ public:
+  HierarchicalRateLimiterImpl(const HierarchicalRateLimiterOptions& options,
+                              const std::shared_ptr<SystemClock>& clock);
+  ~HierarchicalRateLimiterImpl() override;
+
+  Status NewTenant(const RateLimiterTenantOptions& options,
+                   std::shared_ptr<RateLimiter>* tenant) override;
+
+  void SetBytesPerSecond(int64_t bytes_per_second) override;
+  int64_t GetBytesPerSecond() const override;
+
+  Status GetTenantStats(const std::string& name,
+                        NodeStats* stats) const override;
+  Status GetActivityStats(const std::string& name,
+                          Env::IOActivity io_activity,
+                          NodeStats* stats) const override;
+
+  int64_t GetRefillBytesPerPeriod() const {
+    return refill_bytes_per_period_.load(std::memory_order_relaxed);
+  }
+
+ private:
+  class TenantRateLimiter;
+  struct Req;
+
+  // The requests without an activity go to the kUnknown bucket
+  static constexpr size_t kNumActivities =
+      static_cast<size_t>(Env::IOActivity::kUnknown) + 1;
+
+  // A node of the tree. `vtime` is the bytes granted to the node divided by
+  // its weight, in the time of its parent.
+  struct Node {
+    uint32_t weight = 1;
+    double vtime = 0;
+    NodeStats stats;
+  };
+
+  struct ActivityNode : public Node {
+    std::deque<Req*> queue[Env::IO_TOTAL];
+  };
+
+  struct TenantNode : public Node {
+    std::string name;
+    ActivityNode activities[kNumActivities];
+    // The vtime of the activity served last, which an activity getting
+    // requests again starts from
+    double activities_vtime = 0;
+    int64_t bytes_through[Env::IO_TOTAL] = {};
+    int64_t requests[Env::IO_TOTAL] = {};
+  };
+
+  // Blocks until `bytes` are granted to the `io_activity` bucket of `tenant`
+  void Request(TenantNode* tenant, Env::IOActivity io_activity, int64_t bytes,
+               Env::IOPriority pri, Statistics* stats);
+  void RemoveTenant(TenantNode* tenant);
+
+  // The methods below require request_mutex_ held
+  void RefillBytesAndGrantRequestsLocked();
+  // Accounts for `bytes` granted to a request of `activity` of `tenant`
+  void ChargeLocked(TenantNode* tenant, ActivityNode* activity,
+                    Env::IOPriority pri, int64_t bytes);
+  // Queues `req`. The vtime of a node getting pending requests again catches
+  // up with the vtime served last among its siblings, so that an idle node
+  // does not build up credit.
+  void EnqueueLocked(TenantNode* tenant, ActivityNode* activity,
+                     Env::IOPriority pri, Req* req);
+  // Wakes up a pending request to refill the bytes, if any
+  void SignalPendingRequestLocked();
+  const TenantNode* FindTenantLocked(const std::string& name) const;
+  int64_t CalculateRefillBytesPerPeriodLocked(int64_t rate_bytes_per_sec);
+
+  uint64_t NowMicrosMonotonicLocked() {
+    return clock_->NowNanos() / std::milli::den;
+  }
+
+  static constexpr int kMicrosecondsPerSecond = 1000000;
+
+  const int64_t refill_period_us_;
+  const RateLimiter::Mode mode_;
+  const std::shared_ptr<SystemClock> clock_;
+
+  // Guards all the state below, and the state of the tenants
+  mutable port::Mutex request_mutex_;
+  std::atomic<int64_t> rate_bytes_per_sec_;
+  std::atomic<int64_t> refill_bytes_per_period_;
+  int64_t available_bytes_ = 0;
+  int64_t next_refill_us_;
+  bool wait_until_refill_pending_ = false;
+  int64_t num_pending_ = 0;
+
+  std::map<std::string, std::unique_ptr<TenantNode>> tenants_;
+  // The vtime of the tenant served last
+  double tenants_vtime_ = 0;
+};
+
+}  // namespace ROCKSDB_NAMESPACE
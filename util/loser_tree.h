@@ -0,0 +1,181 @@
+//  Copyright (c) Meta Platforms, Inc. and affiliates.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+
+#pragma once
+
+#include <cassert>
+#include <cstdint>
+#include <functional>
+#include <utility>
+#include <vector>
+
+#include "rocksdb/rocksdb_namespace.h"
+
+namespace ROCKSDB_NAMESPACE {
+
+// Tournament tree of losers, a drop-in alternative to BinaryHeap (see
+// util/heap.h) for multi-way merges of many sorted runs.  Each internal node
+// keeps the loser of the match played there and the winner moves up, so that
+// replacing or popping the top replays the matches on its path to the root
+// only:
+// - replace_top() and pop() take exactly ceil(log2 N) comparisons, against
+//   [1, 2logN] for BinaryHeap.  With keys evenly interleaved across the runs
+//   this halves the comparisons, but BinaryHeap does better when the same run
+//   yields many keys in a row, as its replace_top() then takes just 1 or 2.
+// - push() only adds the value, the tree being rebuilt with N-1 comparisons
+//   on the next access.  A merge pushing all its runs at once pays for a
+//   single build, though pushes interleaved with pops each pay for one.
+//
+// As with BinaryHeap, the comparison operator is expected to provide the
+// less-than relation, and top() returns the maximum.
+
+template <typename T, typename Compare = std::less<T>>
+class LoserTree {
+ public:
+  LoserTree() {}
+  explicit LoserTree(Compare cmp) : cmp_(std::move(cmp)) {}
+
+  void push(const T& value) {
+    leaves_.push_back(value);
+    occupied_.push_back(1);
+    ++size_;
+    needs_build_ = true;
+  }
+
+  void push(T&& value) {
+    leaves_.push_back(std::move(value));
+    occupied_.push_back(1);
+    ++size_;
+    needs_build_ = true;
+  }
+
+  const T& top() {
+    assert(!empty());
+    MaybeBuild();
+    return leaves_[tree_[0]];
+  }
+
+  void replace_top(const T& value) {
+    assert(!empty());
+    MaybeBuild();
+    leaves_[tree_[0]] = value;
+    Replay(tree_[0]);
+  }
+
+  void replace_top(T&& value) {
+    assert(!empty());
+    MaybeBuild();
+    leaves_[tree_[0]] = std::move(value);
+    Replay(tree_[0]);
+  }
+
+  void pop() {
+    assert(!empty());
+    MaybeBuild();
+    occupied_[tree_[0]] = 0;
+    --size_;
+    Replay(tree_[0]);
+  }
+
+  void clear() {
+    leaves_.clear();
+    occupied_.clear();
+    tree_.clear();
+    size_ = 0;
+    needs_build_ = false;
+  }
+
+  bool empty() const { return size_ == 0; }
+
+  size_t size() const { return size_; }
+
+  // For compatibility with BinaryHeap, nothing to reset here
+  void reset_root_cmp_cache() {}
+
+ private:
+  // Whether leaf `a` wins its match against leaf `b`.  Empty leaves, popped
+  // or past the end, lose against all others.
+  bool Beats(size_t a, size_t b) const {
+    if (b >= leaves_.size() || !occupied_[b]) {
+      return true;
+    }
+    if (a >= leaves_.size() || !occupied_[a]) {
+      return false;
+    }
+    return !cmp_(leaves_[a], leaves_[b]);
+  }
+
+  // Replays the matches on the path of `leaf`, the winner, to the root
+  void Replay(size_t leaf) {
+    size_t winner = leaf;
+    for (size_t node = (num_leaves_ + leaf) / 2; node > 0; node /= 2) {
+      if (Beats(tree_[node], winner)) {
+        std::swap(tree_[node], winner);
+      }
+    }
+    tree_[0] = winner;
+  }
+
+  void MaybeBuild() {
+    if (!needs_build_) {
+      return;
+    }
+    needs_build_ = false;
+    // Drop the popped leaves, so that the tree only grows with the values
+    size_t num_occupied = 0;
+    for (size_t i = 0; i < leaves_.size(); ++i) {
+      if (occupied_[i]) {
+        if (i != num_occupied) {
+          leaves_[num_occupied] = std::move(leaves_[i]);
+        }
+        ++num_occupied;
+      }
+    }
+    assert(num_occupied == size_);
+    leaves_.erase(leaves_.begin() + num_occupied, leaves_.end());
+    occupied_.assign(num_occupied, 1);
+
+    num_leaves_ = 1;
+    while (num_leaves_ < num_occupied) {
+      num_leaves_ *= 2;
+    }
+    // winners_[node] is the winner of the subtree of `node`, the leaves being
+    // the nodes from num_leaves_ on
+    winners_.resize(2 * num_leaves_);
+    tree_.resize(num_leaves_);
+    for (size_t i = 0; i < num_leaves_; ++i) {
+      winners_[num_leaves_ + i] = i;
+    }
+    for (size_t node = num_leaves_ - 1; node > 0; --node) {
+      const size_t left = winners_[2 * node];
+      const size_t right = winners_[2 * node + 1];
+      if (Beats(left, right)) {
+        winners_[node] = left;
+        tree_[node] = right;
+      } else {
+        winners_[node] = right;
+        tree_[node] = left;
+      }
+    }
+    tree_[0] = winners_[1];
+  }
+
+  Compare cmp_;
+  std::vector<T> leaves_;
+  // Whether leaves_[i] holds a value, 0 once it was popped
+  std::vector<uint8_t> occupied_;
+  // tree_[0] is the leaf of the top, tree_[node] for node > 0 the leaf which
+  // lost the match played at `node`
+  std::vector<size_t> tree_;
+  // Scratch space of MaybeBuild()
+  std::vector<size_t> winners_;
+  // Number of leaves of the built tree, a power of two
+  size_t num_leaves_ = 1;
+  size_t size_ = 0;
+  // Whether values were pushed since the tree was last built
+  bool needs_build_ = false;
+};
+
+}  // namespace ROCKSDB_NAMESPACE
@@ -19,7 +19,8 @@
 namespace ROCKSDB_NAMESPACE {
 size_t RateLimiter::RequestToken(size_t bytes, size_t alignment,
                                  Env::IOPriority io_priority, Statistics* stats,
-                                 RateLimiter::OpType op_type) {
+                                 RateLimiter::OpType op_type,
+                                 Env::IOActivity io_activity) {
   if (io_priority < Env::IO_TOTAL && IsRateLimited(op_type)) {
     bytes = std::min(bytes, static_cast<size_t>(GetSingleBurstBytes()));
 
@@ -29,7 +30,7 @@ size_t RateLimiter::RequestToken(size_t bytes, size_t alignment,
       // thus we do not want to be strictly constrained by burst
       bytes = std::max(alignment, TruncateToPageBoundary(alignment, bytes));
     }
-    Request(bytes, io_priority, stats, op_type);
+    Request(bytes, io_priority, stats, op_type, io_activity);
   }
   return bytes;
 }
@@ -23,6 +23,7 @@
 #include <condition_variable>
 #include <cstdlib>
 #include <deque>
+#include <iterator>
 #include <mutex>
 #include <sstream>
 #include <thread>
@@ -59,6 +60,8 @@ struct ThreadPoolImpl::Impl {
 
   void LowerCPUPriority(CpuPriority pri);
 
+  void SetCpuAffinity(std::vector<int>&& cpus);
+
   void WakeUpAllThreads() { bgsignal_.notify_all(); }
 
   void BGThread(size_t thread_id);
@@ -125,6 +128,9 @@ struct ThreadPoolImpl::Impl {
 
   bool low_io_priority_;
   CpuPriority cpu_priority_;
+  // The CPUs the threads run on, changed cpu_affinity_version_ times
+  std::vector<int> cpu_affinity_;
+  uint64_t cpu_affinity_version_;
   Env::Priority priority_;
   Env* env_;
 
@@ -161,6 +167,7 @@ struct ThreadPoolImpl::Impl {
 inline ThreadPoolImpl::Impl::Impl()
     : low_io_priority_(false),
       cpu_priority_(CpuPriority::kNormal),
+      cpu_affinity_version_(0),
       priority_(Env::LOW),
       env_(nullptr),
       total_threads_limit_(0),
@@ -212,9 +219,16 @@ inline void ThreadPoolImpl::Impl::LowerCPUPriority(CpuPriority pri) {
   cpu_priority_ = pri;
 }
 
+inline void ThreadPoolImpl::Impl::SetCpuAffinity(std::vector<int>&& cpus) {
+  std::lock_guard<std::mutex> lock(mu_);
+  cpu_affinity_ = std::move(cpus);
+  ++cpu_affinity_version_;
+}
+
 void ThreadPoolImpl::Impl::BGThread(size_t thread_id) {
   bool low_io_priority = false;
   CpuPriority current_cpu_priority = CpuPriority::kNormal;
+  uint64_t current_cpu_affinity_version = 0;
 
   while (true) {
     // Wait until there is an item that is ready to run
@@ -270,8 +284,22 @@ void ThreadPoolImpl::Impl::BGThread(size_t thread_id) {
 
     bool decrease_io_priority = (low_io_priority != low_io_priority_);
     CpuPriority cpu_priority = cpu_priority_;
+    std::vector<int> cpu_affinity;
+    bool change_cpu_affinity =
+        current_cpu_affinity_version != cpu_affinity_version_;
+    if (change_cpu_affinity) {
+      cpu_affinity = cpu_affinity_;
+      current_cpu_affinity_version = cpu_affinity_version_;
+    }
     lock.unlock();
 
+    if (change_cpu_affinity) {
+      // 0 means current thread.
+      port::SetCpuAffinity(0, cpu_affinity);
+      TEST_SYNC_POINT_CALLBACK(
+          "ThreadPoolImpl::BGThread::AfterSetCpuAffinity", &cpu_affinity);
+    }
+
     if (cpu_priority < current_cpu_priority) {
       TEST_SYNC_POINT_CALLBACK("ThreadPoolImpl::BGThread::BeforeSetCpuPriority",
                                &current_cpu_priority);
@@ -490,6 +518,43 @@ void ThreadPoolImpl::LowerCPUPriority(CpuPriority pri) {
   impl_->LowerCPUPriority(pri);
 }
 
+Status ThreadPoolImpl::SetCpuAffinity(const ThreadPoolCpuAffinity& affinity) {
+  // Narrows down the CPUs of the process, which are sorted
+  std::vector<int> cpus;
+  if (!port::GetProcessCpuAffinity(&cpus)) {
+    return Status::NotSupported("Failed to get the CPUs of the process");
+  }
+  auto intersect = [&cpus](std::vector<int> other) {
+    std::sort(other.begin(), other.end());
+    std::vector<int> intersection;
+    std::set_intersection(cpus.begin(), cpus.end(), other.begin(),
+                          other.end(), std::back_inserter(intersection));
+    cpus.swap(intersection);
+  };
+  if (!affinity.cpus.empty()) {
+    intersect(affinity.cpus);
+  }
+  if (affinity.numa_node >= 0) {
+    std::vector<int> node_cpus;
+    if (!port::GetNumaNodeCpus(affinity.numa_node, &node_cpus)) {
+      return Status::InvalidArgument("Unknown NUMA node",
+                                     std::to_string(affinity.numa_node));
+    }
+    intersect(std::move(node_cpus));
+  }
+
+  std::vector<int> isolated = affinity.isolated_cpus;
+  std::sort(isolated.begin(), isolated.end());
+  std::vector<int> allowed;
+  std::set_difference(cpus.begin(), cpus.end(), isolated.begin(),
+                      isolated.end(), std::back_inserter(allowed));
+  if (allowed.empty()) {
+    return Status::InvalidArgument("No CPU allowed for the thread pool");
+  }
+  impl_->SetCpuAffinity(std::move(allowed));
+  return Status::OK();
+}
+
 void ThreadPoolImpl::IncBackgroundThreadsIfNeeded(int num) {
   impl_->SetBackgroundThreadsInternal(num, false);
 }
@@ -53,6 +53,11 @@ class ThreadPoolImpl : public ThreadPool {
   // Currently only has effect on Linux
   void LowerCPUPriority(CpuPriority pri);
 
+  // Restrict threads to the CPUs of `affinity`, see
+  // Env::SetThreadPoolCpuAffinity()
+  // Currently only has effect on Linux
+  Status SetCpuAffinity(const ThreadPoolCpuAffinity& affinity);
+
   // Ensure there is at aleast num threads in the pool
   // but do not kill threads if there are more
   void IncBackgroundThreadsIfNeeded(int num);
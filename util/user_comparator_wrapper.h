@@ -15,14 +15,18 @@ namespace ROCKSDB_NAMESPACE {
 
 // Wrapper of user comparator, with auto increment to
 // perf_context.user_key_comparison_count.
+//
+// The builtin BytewiseComparator() and ReverseBytewiseComparator() are told
+// apart once at construction, so that comparing with them inlines the
+// memcmp instead of calling Comparator::Compare() through the vtable.
 class UserComparatorWrapper {
  public:
   // `UserComparatorWrapper`s constructed with the default constructor are not
   // usable and will segfault on any attempt to use them for comparisons.
-  UserComparatorWrapper() : user_comparator_(nullptr) {}
+  UserComparatorWrapper() : user_comparator_(nullptr), kind_(kOther) {}
 
   explicit UserComparatorWrapper(const Comparator* const user_cmp)
-      : user_comparator_(user_cmp) {}
+      : user_comparator_(user_cmp), kind_(KindOf(user_cmp)) {}
 
   ~UserComparatorWrapper() = default;
 
@@ -30,11 +34,19 @@ class UserComparatorWrapper {
 
   int Compare(const Slice& a, const Slice& b) const {
     // PERF_COUNTER_ADD(user_key_comparison_count, 1); // RocksDB-Cloud disabled
+    if (kind_ == kBytewise) {
+      return a.compare(b);
+    } else if (kind_ == kReverseBytewise) {
+      return -a.compare(b);
+    }
     return user_comparator_->Compare(a, b);
   }
 
   bool Equal(const Slice& a, const Slice& b) const {
     // PERF_COUNTER_ADD(user_key_comparison_count, 1); // RocksDB-Cloud disabled
+    if (kind_ != kOther) {
+      return a == b;
+    }
     return user_comparator_->Equal(a, b);
   }
 
@@ -44,12 +56,19 @@ class UserComparatorWrapper {
 
   int CompareWithoutTimestamp(const Slice& a, const Slice& b) const {
     // PERF_COUNTER_ADD(user_key_comparison_count, 1); // RocksDB-Cloud disabled
+    if (kind_ != kOther) {
+      // No timestamps with the builtin comparators
+      return Compare(a, b);
+    }
     return user_comparator_->CompareWithoutTimestamp(a, b);
   }
 
   int CompareWithoutTimestamp(const Slice& a, bool a_has_ts, const Slice& b,
                               bool b_has_ts) const {
     // PERF_COUNTER_ADD(user_key_comparison_count, 1); // RocksDB-Cloud disabled
+    if (kind_ != kOther) {
+      return Compare(a, b);
+    }
     return user_comparator_->CompareWithoutTimestamp(a, a_has_ts, b, b_has_ts);
   }
 
@@ -58,7 +77,23 @@ class UserComparatorWrapper {
   }
 
  private:
+  enum Kind : uint8_t {
+    kOther,
+    kBytewise,
+    kReverseBytewise,
+  };
+
+  static Kind KindOf(const Comparator* user_cmp) {
+    if (user_cmp == BytewiseComparator()) {
+      return kBytewise;
+    } else if (user_cmp == ReverseBytewiseComparator()) {
+      return kReverseBytewise;
+    }
+    return kOther;
+  }
+
   const Comparator* user_comparator_;
+  Kind kind_;
 };
 
 }  // namespace ROCKSDB_NAMESPACE
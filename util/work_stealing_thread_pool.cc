@@ -0,0 +1,469 @@
+//  Copyright (c) Meta Platforms, Inc. and affiliates.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+
+#include "util/work_stealing_thread_pool.h"
+
+#include <algorithm>
+#include <cassert>
+#include <deque>
+#include <thread>
+
+#include "test_util/sync_point.h"
+
+namespace ROCKSDB_NAMESPACE {
+
+struct WorkStealingThreadPool::Job {
+  enum State : uint8_t {
+    kPending,
+    kRunning,
+    kUnscheduling,
+    kUnscheduled,
+  };
+
+  std::function<void()> function;
+  std::function<void()> unschedule;
+  void* tag = nullptr;
+  std::atomic<State> state{kPending};
+};
+
+// The deque of Chase and Lev, as written for the C11 memory model by Le et
+// al. in "Correct and Efficient Work-Stealing for Weak Memory Models". Only
+// the owner pushes and takes at the bottom, the others steal at the top.
+class WorkStealingThreadPool::JobDeque {
+ public:
+  JobDeque() : array_(new Array(kInitialCapacity)) {}
+
+  ~JobDeque() { delete array_.load(std::memory_order_relaxed); }
+
+  // REQUIRES: called by the owner
+  void Push(Job* job) {
+    int64_t b = bottom_.load(std::memory_order_relaxed);
+    int64_t t = top_.load(std::memory_order_acquire);
+    Array* a = array_.load(std::memory_order_relaxed);
+    if (b - t > static_cast<int64_t>(a->capacity) - 1) {
+      a = Grow(a, t, b);
+    }
+    a->Put(b, job);
+    std::atomic_thread_fence(std::memory_order_release);
+    bottom_.store(b + 1, std::memory_order_relaxed);
+  }
+
+  // Returns the last job pushed, or nullptr if empty.
+  // REQUIRES: called by the owner
+  Job* Take() {
+    int64_t b = bottom_.load(std::memory_order_relaxed) - 1;
+    Array* a = array_.load(std::memory_order_relaxed);
+    bottom_.store(b, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    int64_t t = top_.load(std::memory_order_relaxed);
+    Job* job = nullptr;
+    if (t <= b) {
+      job = a->Get(b);
+      if (t == b) {
+        // The last job, which a thief may be taking
+        if (!top_.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst,
+                                          std::memory_order_relaxed)) {
+          job = nullptr;
+        }
+        bottom_.store(b + 1, std::memory_order_relaxed);
+      }
+    } else {
+      bottom_.store(b + 1, std::memory_order_relaxed);
+    }
+    return job;
+  }
+
+  // Returns the first job pushed, or nullptr if empty or lost to another
+  // thread
+  Job* Steal() {
+    int64_t t = top_.load(std::memory_order_acquire);
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    int64_t b = bottom_.load(std::memory_order_acquire);
+    if (t >= b) {
+      return nullptr;
+    }
+    Array* a = array_.load(std::memory_order_acquire);
+    Job* job = a->Get(t);
+    if (!top_.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst,
+                                      std::memory_order_relaxed)) {
+      return nullptr;
+    }
+    return job;
+  }
+
+ private:
+  static constexpr size_t kInitialCapacity = 64;
+
+  struct Array {
+    explicit Array(size_t _capacity)
+        : capacity(_capacity), slots(new std::atomic<Job*>[_capacity]) {
+      assert((capacity & (capacity - 1)) == 0);
+    }
+    Job* Get(int64_t i) const {
+      return slots[static_cast<size_t>(i) & (capacity - 1)].load(
+          std::memory_order_relaxed);
+    }
+    void Put(int64_t i, Job* job) {
+      slots[static_cast<size_t>(i) & (capacity - 1)].store(
+          job, std::memory_order_relaxed);
+    }
+    const size_t capacity;
+    std::unique_ptr<std::atomic<Job*>[]> slots;
+  };
+
+  Array* Grow(Array* a, int64_t t, int64_t b) {
+    Array* grown = new Array(a->capacity * 2);
+    for (int64_t i = t; i < b; ++i) {
+      grown->Put(i, a->Get(i));
+    }
+    array_.store(grown, std::memory_order_release);
+    // A thief may still read the old array
+    retired_.emplace_back(a);
+    return grown;
+  }
+
+  ALIGN_AS(CACHE_LINE_SIZE) std::atomic<int64_t> top_{0};
+  ALIGN_AS(CACHE_LINE_SIZE) std::atomic<int64_t> bottom_{0};
+  std::atomic<Array*> array_;
+  std::vector<std::unique_ptr<Array>> retired_;
+};
+
+struct WorkStealingThreadPool::Worker {
+  explicit Worker(WorkStealingThreadPool* _pool) : pool(_pool) {}
+
+  // Pops the first job of the inbox, without waiting for its mutex if
+  // `try_lock`
+  Job* PopInbox(bool try_lock) {
+    if (inbox_size.load(std::memory_order_acquire) == 0) {
+      return nullptr;
+    }
+    std::unique_lock<std::mutex> lock(inbox_mu, std::defer_lock);
+    if (try_lock) {
+      if (!lock.try_lock()) {
+        return nullptr;
+      }
+    } else {
+      lock.lock();
+    }
+    if (inbox.empty()) {
+      return nullptr;
+    }
+    Job* job = inbox.front();
+    inbox.pop_front();
+    inbox_size.fetch_sub(1, std::memory_order_relaxed);
+    return job;
+  }
+
+  void PushInbox(Job* job) {
+    std::lock_guard<std::mutex> lock(inbox_mu);
+    inbox.push_back(job);
+    inbox_size.fetch_add(1, std::memory_order_release);
+  }
+
+  WorkStealingThreadPool* const pool;
+  JobDeque deque;
+  ALIGN_AS(CACHE_LINE_SIZE) std::mutex inbox_mu;
+  std::deque<Job*> inbox;
+  std::atomic<size_t> inbox_size{0};
+};
+
+namespace {
+// The worker of the current thread, if a worker thread
+thread_local void* tls_worker = nullptr;
+}  // anonymous namespace
+
+WorkStealingThreadPool::WorkStealingThreadPool()
+    : threads_limit_(0),
+      exit_all_threads_(false),
+      wait_for_jobs_to_complete_(false),
+      num_workers_(1),
+      next_inbox_(0),
+      queue_len_(0),
+      num_sleeping_(0) {
+  // The jobs submitted before the first thread starts go to its inbox
+  workers_[0].reset(new Worker(this));
+}
+
+WorkStealingThreadPool::~WorkStealingThreadPool() { Join(false); }
+
+void WorkStealingThreadPool::JoinAllThreads() { Join(false); }
+
+void WorkStealingThreadPool::WaitForJobsAndJoinAllThreads() { Join(true); }
+
+void WorkStealingThreadPool::SetBackgroundThreads(int num) {
+  std::lock_guard<std::mutex> lock(mu_);
+  if (exit_all_threads_.load(std::memory_order_relaxed)) {
+    return;
+  }
+  threads_limit_.store(std::min(std::max(0, num), kMaxThreads),
+                       std::memory_order_release);
+  StartThreadsLocked();
+  // Wakes up the parked threads under the new limit, or parks the ones over
+  // it once they are done with their job
+  std::lock_guard<std::mutex> sleep_lock(sleep_mu_);
+  sleep_cv_.notify_all();
+}
+
+int WorkStealingThreadPool::GetBackgroundThreads() {
+  return threads_limit_.load(std::memory_order_acquire);
+}
+
+unsigned int WorkStealingThreadPool::GetQueueLen() const {
+  return queue_len_.load(std::memory_order_relaxed);
+}
+
+void WorkStealingThreadPool::SubmitJob(const std::function<void()>& job) {
+  auto copy(job);
+  Submit(std::move(copy), std::function<void()>(), nullptr);
+}
+
+void WorkStealingThreadPool::SubmitJob(std::function<void()>&& job) {
+  Submit(std::move(job), std::function<void()>(), nullptr);
+}
+
+void WorkStealingThreadPool::Schedule(void (*function)(void* arg1), void* arg,
+                                      void* tag,
+                                      void (*unschedFunction)(void* arg)) {
+  if (unschedFunction == nullptr) {
+    Submit(std::bind(function, arg), std::function<void()>(), tag);
+  } else {
+    Submit(std::bind(function, arg), std::bind(unschedFunction, arg), tag);
+  }
+}
+
+void WorkStealingThreadPool::StartThreadsLocked() {
+  const size_t limit =
+      static_cast<size_t>(threads_limit_.load(std::memory_order_relaxed));
+  while (threads_.size() < limit) {
+    size_t idx = threads_.size();
+    if (idx >= num_workers_.load(std::memory_order_relaxed)) {
+      assert(idx == num_workers_.load(std::memory_order_relaxed));
+      workers_[idx].reset(new Worker(this));
+      num_workers_.store(idx + 1, std::memory_order_release);
+    }
+    threads_.emplace_back(&WorkStealingThreadPool::WorkerLoop, this, idx);
+  }
+}
+
+void WorkStealingThreadPool::Submit(std::function<void()>&& function,
+                                    std::function<void()>&& unschedule,
+                                    void* tag) {
+  if (exit_all_threads_.load(std::memory_order_acquire)) {
+    return;
+  }
+  Worker* self = static_cast<Worker*>(tls_worker);
+  if (self != nullptr && self->pool != this) {
+    self = nullptr;
+  }
+
+  Job* job = new Job();
+  job->function = std::move(function);
+  job->unschedule = std::move(unschedule);
+  job->tag = tag;
+  if (tag != nullptr) {
+    std::lock_guard<std::mutex> lock(tags_mu_);
+    tagged_jobs_[tag].insert(job);
+  }
+  // Before the job is visible, so that a worker taking it never finds the
+  // queue empty
+  queue_len_.fetch_add(1, std::memory_order_seq_cst);
+  TEST_SYNC_POINT("WorkStealingThreadPool::Submit::Enqueue");
+  if (self != nullptr) {
+    self->deque.Push(job);
+  } else {
+    size_t num_workers = num_workers_.load(std::memory_order_acquire);
+    size_t limit = std::max(
+        static_cast<size_t>(threads_limit_.load(std::memory_order_relaxed)),
+        size_t{1});
+    size_t i = next_inbox_.fetch_add(1, std::memory_order_relaxed) %
+               std::min(num_workers, limit);
+    workers_[i]->PushInbox(job);
+  }
+  WakeUpWorker();
+}
+
+void WorkStealingThreadPool::WakeUpWorker() {
+  // Pairs with the check of queue_len_ by a parking worker, see WorkerLoop()
+  if (num_sleeping_.load(std::memory_order_seq_cst) == 0) {
+    return;
+  }
+  std::lock_guard<std::mutex> lock(sleep_mu_);
+  // A thread over the limit would take the notification and park again
+  if (num_workers_.load(std::memory_order_acquire) >
+      static_cast<size_t>(threads_limit_.load(std::memory_order_acquire))) {
+    sleep_cv_.notify_all();
+  } else {
+    sleep_cv_.notify_one();
+  }
+}
+
+WorkStealingThreadPool::Job* WorkStealingThreadPool::FindJob(size_t idx) {
+  Worker* self = workers_[idx].get();
+  Job* job = self->deque.Take();
+  if (job == nullptr) {
+    job = self->PopInbox(/*try_lock=*/false);
+  }
+  const size_t num_workers = num_workers_.load(std::memory_order_acquire);
+  for (size_t i = 1; job == nullptr && i < num_workers; ++i) {
+    Worker* victim = workers_[(idx + i) % num_workers].get();
+    job = victim->deque.Steal();
+    if (job == nullptr) {
+      job = victim->PopInbox(/*try_lock=*/true);
+    }
+  }
+  return job;
+}
+
+bool WorkStealingThreadPool::ClaimJob(Job* job) {
+  Job::State expected = Job::kPending;
+  if (job->state.compare_exchange_strong(expected, Job::kRunning,
+                                         std::memory_order_acq_rel)) {
+    queue_len_.fetch_sub(1, std::memory_order_relaxed);
+    if (job->tag != nullptr) {
+      std::lock_guard<std::mutex> lock(tags_mu_);
+      auto it = tagged_jobs_.find(job->tag);
+      if (it != tagged_jobs_.end()) {
+        it->second.erase(job);
+        if (it->second.empty()) {
+          tagged_jobs_.erase(it);
+        }
+      }
+    }
+    return true;
+  }
+  // Unscheduled, wait for UnSchedule() to be done with the job
+  while (job->state.load(std::memory_order_acquire) != Job::kUnscheduled) {
+    std::this_thread::yield();
+  }
+  delete job;
+  return false;
+}
+
+void WorkStealingThreadPool::WorkerLoop(size_t idx) {
+  tls_worker = workers_[idx].get();
+  while (true) {
+    const bool exiting = exit_all_threads_.load(std::memory_order_acquire);
+    const bool wait_for_jobs =
+        wait_for_jobs_to_complete_.load(std::memory_order_acquire);
+    if (exiting && !wait_for_jobs) {
+      break;
+    }
+    // While joining, all the threads run the jobs left
+    const size_t limit =
+        static_cast<size_t>(threads_limit_.load(std::memory_order_acquire));
+    const bool active = exiting || idx < limit;
+    if (active) {
+      Job* job = FindJob(idx);
+      if (job != nullptr) {
+        if (ClaimJob(job)) {
+          job->function();
+          delete job;
+        }
+        continue;
+      }
+      if (queue_len_.load(std::memory_order_acquire) > 0) {
+        // A job is being pushed, or lost to a thief
+        std::this_thread::yield();
+        continue;
+      }
+      if (exiting) {
+        break;
+      }
+    }
+
+    // Park until there is a job for this thread. The increment of
+    // num_sleeping_ and the check of queue_len_ pair with the ones of
+    // Submit() in the reverse order, so that either the submitter wakes up
+    // this thread or this thread finds the job.
+    std::unique_lock<std::mutex> lock(sleep_mu_);
+    num_sleeping_.fetch_add(1, std::memory_order_seq_cst);
+    while (!exit_all_threads_.load(std::memory_order_seq_cst) &&
+           (idx >= static_cast<size_t>(
+                       threads_limit_.load(std::memory_order_seq_cst)) ||
+            queue_len_.load(std::memory_order_seq_cst) == 0)) {
+      sleep_cv_.wait(lock);
+    }
+    num_sleeping_.fetch_sub(1, std::memory_order_relaxed);
+  }
+  tls_worker = nullptr;
+}
+
+int WorkStealingThreadPool::UnSchedule(void* tag) {
+  std::vector<std::function<void()>> candidates;
+  int count = 0;
+  {
+    std::lock_guard<std::mutex> lock(tags_mu_);
+    auto it = tagged_jobs_.find(tag);
+    if (it == tagged_jobs_.end()) {
+      return 0;
+    }
+    for (Job* job : it->second) {
+      Job::State expected = Job::kPending;
+      if (job->state.compare_exchange_strong(expected, Job::kUnscheduling,
+                                             std::memory_order_acq_rel)) {
+        queue_len_.fetch_sub(1, std::memory_order_relaxed);
+        if (job->unschedule) {
+          candidates.push_back(std::move(job->unschedule));
+        }
+        ++count;
+        // The job is deleted by the thread popping it
+        job->state.store(Job::kUnscheduled, std::memory_order_release);
+      }
+    }
+    tagged_jobs_.erase(it);
+  }
+
+  // Run unschedule functions outside the mutex
+  for (auto& f : candidates) {
+    f();
+  }
+  return count;
+}
+
+void WorkStealingThreadPool::Join(bool wait_for_jobs) {
+  std::vector<port::Thread> threads;
+  {
+    std::lock_guard<std::mutex> lock(mu_);
+    assert(!exit_all_threads_.load(std::memory_order_relaxed));
+    wait_for_jobs_to_complete_.store(wait_for_jobs, std::memory_order_release);
+    exit_all_threads_.store(true, std::memory_order_seq_cst);
+    // prevent threads from being recreated right after they're joined, in
+    // case the user is concurrently submitting jobs.
+    threads_limit_.store(0, std::memory_order_release);
+    threads.swap(threads_);
+  }
+  {
+    std::lock_guard<std::mutex> lock(sleep_mu_);
+    sleep_cv_.notify_all();
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+
+  // Discard the jobs that did not start
+  const size_t num_workers = num_workers_.load(std::memory_order_acquire);
+  for (size_t i = 0; i < num_workers; ++i) {
+    Worker* worker = workers_[i].get();
+    Job* job;
+    while ((job = worker->deque.Take()) != nullptr ||
+           (job = worker->PopInbox(/*try_lock=*/false)) != nullptr) {
+      if (ClaimJob(job)) {
+        delete job;
+      }
+    }
+  }
+
+  std::lock_guard<std::mutex> lock(mu_);
+  wait_for_jobs_to_complete_.store(false, std::memory_order_release);
+  exit_all_threads_.store(false, std::memory_order_release);
+}
+
+ThreadPool* NewWorkStealingThreadPool(int num_threads) {
+  WorkStealingThreadPool* thread_pool = new WorkStealingThreadPool();
+  thread_pool->SetBackgroundThreads(num_threads);
+  return thread_pool;
+}
+
+}  // namespace ROCKSDB_NAMESPACE
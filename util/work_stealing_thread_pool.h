@@ -0,0 +1,105 @@
+//  Copyright (c) Meta Platforms, Inc. and affiliates.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include "port/port.h"
+#include "rocksdb/threadpool.h"
+
+namespace ROCKSDB_NAMESPACE {
+
+// A ThreadPool where each worker thread has its own queues, see
+// NewWorkStealingThreadPool(). The jobs submitted by a worker go to its
+// deque, which it pushes to and pops from without locking. The jobs
+// submitted by other threads go round-robin to the inboxes of the workers,
+// each with its own mutex. A worker out of jobs steals from the deques and
+// inboxes of the others, and only then parks.
+//
+// Like ThreadPoolImpl, a pool serves a single Env::Priority, and the jobs
+// scheduled with a tag can be unscheduled. Threads are parked rather than
+// terminated when SetBackgroundThreads() lowers their number, and the thread
+// reservation of ReserveThreads() is not supported.
+class WorkStealingThreadPool : public ThreadPool {
+ public:
+  static constexpr int kMaxThreads = 256;
+
+  WorkStealingThreadPool();
+  ~WorkStealingThreadPool() override;
+
+  WorkStealingThreadPool(const WorkStealingThreadPool&) = delete;
+  WorkStealingThreadPool& operator=(const WorkStealingThreadPool&) = delete;
+
+  void JoinAllThreads() override;
+
+  // At most kMaxThreads
+  void SetBackgroundThreads(int num) override;
+  int GetBackgroundThreads() override;
+
+  unsigned int GetQueueLen() const override;
+
+  void WaitForJobsAndJoinAllThreads() override;
+
+  void SubmitJob(const std::function<void()>&) override;
+  void SubmitJob(std::function<void()>&&) override;
+
+  // Same as ThreadPoolImpl::Schedule()
+  void Schedule(void (*function)(void* arg1), void* arg, void* tag,
+                void (*unschedFunction)(void* arg));
+
+  // Same as ThreadPoolImpl::UnSchedule()
+  int UnSchedule(void* tag);
+
+ private:
+  struct Job;
+  class JobDeque;
+  struct Worker;
+
+  void Submit(std::function<void()>&& function,
+              std::function<void()>&& unschedule, void* tag);
+  void WakeUpWorker();
+  void WorkerLoop(size_t idx);
+  Job* FindJob(size_t idx);
+  // Returns true if `job` was claimed to run, else deletes the unscheduled
+  // job
+  bool ClaimJob(Job* job);
+  void Join(bool wait_for_jobs);
+  // REQUIRES: mu_ held
+  void StartThreadsLocked();
+
+  // Guards threads_ and the thread limit changes
+  std::mutex mu_;
+  std::vector<port::Thread> threads_;
+  std::atomic<int> threads_limit_;
+  std::atomic<bool> exit_all_threads_;
+  std::atomic<bool> wait_for_jobs_to_complete_;
+
+  // The queues of the worker threads, from index 0 to num_workers_. A
+  // worker outlives its thread, and is reused by the next one of its index.
+  std::unique_ptr<Worker> workers_[kMaxThreads];
+  std::atomic<size_t> num_workers_;
+  std::atomic<size_t> next_inbox_;
+
+  // The jobs not yet claimed by a worker or unscheduled
+  std::atomic<unsigned int> queue_len_;
+
+  std::mutex sleep_mu_;
+  std::condition_variable sleep_cv_;
+  std::atomic<int> num_sleeping_;
+
+  // The pending jobs scheduled with a tag, for UnSchedule()
+  std::mutex tags_mu_;
+  std::unordered_map<void*, std::unordered_set<Job*>> tagged_jobs_;
+};
+
+}  // namespace ROCKSDB_NAMESPACE
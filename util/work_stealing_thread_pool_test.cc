@@ -0,0 +1,230 @@
+//  Copyright (c) Meta Platforms, Inc. and affiliates.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+
+#include "util/work_stealing_thread_pool.h"
+
+#include <atomic>
+#include <condition_variable>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <thread>
+#include <vector>
+
+#include "port/stack_trace.h"
+#include "test_util/testharness.h"
+
+namespace ROCKSDB_NAMESPACE {
+
+namespace {
+// Blocks the jobs calling Wait() until Release()
+class Gate {
+ public:
+  void Wait() {
+    std::unique_lock<std::mutex> lock(mu_);
+    ++num_waiting_;
+    cv_.notify_all();
+    cv_.wait(lock, [this] { return released_; });
+  }
+
+  void WaitForWaiting(int n) {
+    std::unique_lock<std::mutex> lock(mu_);
+    cv_.wait(lock, [&] { return num_waiting_ >= n; });
+  }
+
+  void Release() {
+    std::lock_guard<std::mutex> lock(mu_);
+    released_ = true;
+    cv_.notify_all();
+  }
+
+ private:
+  std::mutex mu_;
+  std::condition_variable cv_;
+  int num_waiting_ = 0;
+  bool released_ = false;
+};
+
+void Increment(void* arg) {
+  static_cast<std::atomic<int>*>(arg)->fetch_add(1);
+}
+}  // anonymous namespace
+
+class WorkStealingThreadPoolTest : public testing::Test {
+ protected:
+  void SetUp() override { pool_.reset(new WorkStealingThreadPool()); }
+
+  std::unique_ptr<WorkStealingThreadPool> pool_;
+};
+
+TEST_F(WorkStealingThreadPoolTest, RunsAllJobs) {
+  pool_->SetBackgroundThreads(4);
+  ASSERT_EQ(4, pool_->GetBackgroundThreads());
+
+  constexpr int kNumJobs = 10000;
+  std::atomic<int> counter{0};
+  std::vector<std::thread> submitters;
+  for (int t = 0; t < 4; ++t) {
+    submitters.emplace_back([&] {
+      for (int i = 0; i < kNumJobs / 4; ++i) {
+        pool_->SubmitJob([&] { counter.fetch_add(1); });
+      }
+    });
+  }
+  for (auto& t : submitters) {
+    t.join();
+  }
+  pool_->WaitForJobsAndJoinAllThreads();
+  ASSERT_EQ(kNumJobs, counter.load());
+  ASSERT_EQ(0U, pool_->GetQueueLen());
+}
+
+TEST_F(WorkStealingThreadPoolTest, FanOutIsStolen) {
+  pool_->SetBackgroundThreads(4);
+
+  // A single job submits all the others to its local deque, and blocks until
+  // three of them run on the other threads
+  constexpr int kNumJobs = 1000;
+  std::atomic<int> counter{0};
+  std::mutex mu;
+  std::set<std::thread::id> thread_ids;
+  Gate gate;
+  pool_->SubmitJob([&] {
+    for (int i = 0; i < kNumJobs; ++i) {
+      pool_->SubmitJob([&, i] {
+        {
+          std::lock_guard<std::mutex> lock(mu);
+          thread_ids.insert(std::this_thread::get_id());
+        }
+        if (i < 3) {
+          gate.Wait();
+        }
+        counter.fetch_add(1);
+      });
+    }
+    gate.WaitForWaiting(3);
+    gate.Release();
+  });
+  // Like ThreadPoolImpl, the threads joining do not wait for the jobs to be
+  // submitted by the running ones
+  while (counter.load() < kNumJobs) {
+    std::this_thread::yield();
+  }
+  pool_->WaitForJobsAndJoinAllThreads();
+  ASSERT_GE(thread_ids.size(), 3U);
+}
+
+TEST_F(WorkStealingThreadPoolTest, UnSchedule) {
+  pool_->SetBackgroundThreads(1);
+
+  // Block the only thread
+  Gate gate;
+  pool_->SubmitJob([&] { gate.Wait(); });
+  gate.WaitForWaiting(1);
+
+  std::atomic<int> ran{0};
+  int tag = 0;
+  int other_tag = 0;
+  int unknown_tag = 0;
+  for (int i = 0; i < 5; ++i) {
+    pool_->Schedule(&Increment, &ran, &tag, nullptr);
+  }
+  pool_->Schedule(&Increment, &ran, &tag, &Increment);
+  pool_->Schedule(&Increment, &ran, &other_tag, nullptr);
+  ASSERT_EQ(7U, pool_->GetQueueLen());
+
+  ASSERT_EQ(0, pool_->UnSchedule(&unknown_tag));
+  ASSERT_EQ(6, pool_->UnSchedule(&tag));
+  // The unschedule function is called with the same argument
+  ASSERT_EQ(1, ran.load());
+  ASSERT_EQ(1U, pool_->GetQueueLen());
+  ASSERT_EQ(0, pool_->UnSchedule(&tag));
+
+  gate.Release();
+  pool_->WaitForJobsAndJoinAllThreads();
+  ASSERT_EQ(2, ran.load());
+}
+
+TEST_F(WorkStealingThreadPoolTest, SetBackgroundThreads) {
+  // Jobs wait for a thread
+  std::atomic<int> counter{0};
+  for (int i = 0; i < 10; ++i) {
+    pool_->Schedule(&Increment, &counter, nullptr, nullptr);
+  }
+  ASSERT_EQ(10U, pool_->GetQueueLen());
+  ASSERT_EQ(0, counter.load());
+
+  pool_->SetBackgroundThreads(8);
+  while (pool_->GetQueueLen() > 0) {
+    std::this_thread::yield();
+  }
+
+  // Parked threads over the limit leave the jobs to the others
+  pool_->SetBackgroundThreads(1);
+  Gate gate;
+  pool_->SubmitJob([&] { gate.Wait(); });
+  gate.WaitForWaiting(1);
+  for (int i = 0; i < 10; ++i) {
+    pool_->Schedule(&Increment, &counter, nullptr, nullptr);
+  }
+  ASSERT_EQ(10U, pool_->GetQueueLen());
+
+  pool_->SetBackgroundThreads(2);
+  while (pool_->GetQueueLen() > 0) {
+    std::this_thread::yield();
+  }
+  gate.Release();
+  pool_->WaitForJobsAndJoinAllThreads();
+  ASSERT_EQ(20, counter.load());
+}
+
+TEST_F(WorkStealingThreadPoolTest, JoinAllThreadsDiscardsJobs) {
+  pool_->SetBackgroundThreads(1);
+  Gate gate;
+  pool_->SubmitJob([&] { gate.Wait(); });
+  gate.WaitForWaiting(1);
+
+  std::atomic<int> counter{0};
+  for (int i = 0; i < 10; ++i) {
+    pool_->Schedule(&Increment, &counter, &counter, nullptr);
+  }
+  std::thread releaser([&] {
+    while (pool_->GetBackgroundThreads() > 0) {
+      std::this_thread::yield();
+    }
+    gate.Release();
+  });
+  pool_->JoinAllThreads();
+  releaser.join();
+  // Only the running job completed
+  ASSERT_EQ(0, counter.load());
+  ASSERT_EQ(0U, pool_->GetQueueLen());
+  ASSERT_EQ(0, pool_->UnSchedule(&counter));
+
+  // The pool can be used again
+  pool_->SetBackgroundThreads(2);
+  pool_->Schedule(&Increment, &counter, nullptr, nullptr);
+  pool_->WaitForJobsAndJoinAllThreads();
+  ASSERT_EQ(1, counter.load());
+}
+
+TEST_F(WorkStealingThreadPoolTest, Factory) {
+  std::unique_ptr<ThreadPool> pool(NewWorkStealingThreadPool(3));
+  ASSERT_EQ(3, pool->GetBackgroundThreads());
+  std::atomic<int> counter{0};
+  for (int i = 0; i < 100; ++i) {
+    pool->SubmitJob([&] { counter.fetch_add(1); });
+  }
+  pool->WaitForJobsAndJoinAllThreads();
+  ASSERT_EQ(100, counter.load());
+}
+
+}  // namespace ROCKSDB_NAMESPACE
+
+int main(int argc, char** argv) {
+  ROCKSDB_NAMESPACE::port::InstallStackTraceHandler();
+  ::testing::InitGoogleTest(&argc, argv);
+  return RUN_ALL_TESTS();
+}
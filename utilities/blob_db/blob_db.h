@@ -166,6 +166,12 @@ class BlobDB : public StackableDB {
 
   Status Write(const WriteOptions& opts, WriteBatch* updates) override = 0;
 
+  // Writes synchronously with Write(), which extracts the large values
+  void WriteAsync(const WriteOptions& opts, WriteBatch* updates,
+                  std::function<void(const Status&)> callback) override {
+    DB::WriteAsync(opts, updates, std::move(callback));
+  }
+
   using ROCKSDB_NAMESPACE::StackableDB::NewIterator;
   Iterator* NewIterator(const ReadOptions& options) override = 0;
   Iterator* NewIterator(const ReadOptions& options,
@@ -72,6 +72,8 @@ class BlobDBIterator : public Iterator {
     }
   }
 
+  void StartSeek(const Slice& target) override { iter_->StartSeek(target); }
+
   void SeekForPrev(const Slice& target) override {
     StopWatch seek_sw(clock_, statistics_, BLOB_DB_SEEK_MICROS);
     RecordTick(statistics_, BLOB_DB_NUM_SEEK);
@@ -6,6 +6,7 @@
 
 #include "utilities/transactions/lock/lock_manager.h"
 
+#include "utilities/transactions/lock/point/per_key_point_lock_manager.h"
 #include "utilities/transactions/lock/point/point_lock_manager.h"
 
 namespace ROCKSDB_NAMESPACE {
@@ -17,6 +18,8 @@ std::shared_ptr<LockManager> NewLockManager(PessimisticTransactionDB* db,
     // A custom lock manager was provided in options
     auto mgr = opt.lock_mgr_handle->getLockManager();
     return std::shared_ptr<LockManager>(opt.lock_mgr_handle, mgr);
+  } else if (opt.use_per_key_point_lock_mgr) {
+    return std::shared_ptr<LockManager>(new PerKeyPointLockManager(db, opt));
   } else {
     // Use a point lock manager by default
     return std::shared_ptr<LockManager>(new PointLockManager(db, opt));
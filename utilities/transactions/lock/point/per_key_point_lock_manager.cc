@@ -0,0 +1,584 @@
+//  Copyright (c) Meta Platforms, Inc. and affiliates.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+
+#include "utilities/transactions/lock/point/per_key_point_lock_manager.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cinttypes>
+#include <mutex>
+#include <vector>
+
+#include "monitoring/perf_context_imp.h"
+#include "rocksdb/utilities/transaction_db_mutex.h"
+#include "test_util/sync_point.h"
+#include "util/hash.h"
+#include "util/mutexlock.h"
+#include "util/thread_local.h"
+#include "utilities/transactions/pessimistic_transaction_db.h"
+
+namespace ROCKSDB_NAMESPACE {
+
+// A transaction waiting on a key, queued in the entry of the key
+struct KeyLockWaiter {
+  std::shared_ptr<TransactionDBMutex> mutex;
+  std::shared_ptr<TransactionDBCondVar> cv;
+  // Set under `mutex` by the releases of the key, while the waiter is queued
+  bool signaled = false;
+};
+
+// The lock of a key
+struct KeyLock {
+  enum State : uint8_t { kEmpty, kUsed, kDeleted };
+
+  State state = kEmpty;
+  uint64_t hash = 0;
+  // Kept when the entry is deleted, so that its buffer is reused
+  std::string key;
+  bool exclusive = false;
+  // Empty if the key is only waited on
+  autovector<TransactionID> txn_ids;
+  // Transaction locks are not valid after this time in us
+  uint64_t expiration_time = 0;
+  // Allocated on the first conflict, freed when the last waiter leaves
+  std::unique_ptr<std::vector<KeyLockWaiter*>> waiters;
+};
+
+// An open-addressing table of key locks, with linear probing
+struct ALIGN_AS(CACHE_LINE_SIZE) KeyLockPartition {
+  static constexpr size_t kInitialSize = 16;
+
+  KeyLockPartition() : entries(kInitialSize) {}
+
+  // Returns the entry of `key`, or nullptr if none
+  KeyLock* Find(const std::string& key, uint64_t hash);
+  // REQUIRES: Find(key, hash) == nullptr
+  KeyLock* Insert(const std::string& key, uint64_t hash);
+  // REQUIRES: no holder and no waiter
+  void Erase(KeyLock* entry);
+
+  // Guards the entries and the waiters queued in them
+  SpinMutex mutex;
+  // A power of two in size
+  std::vector<KeyLock> entries;
+  size_t num_used = 0;
+  size_t num_deleted = 0;
+
+ private:
+  void Rehash(size_t new_size);
+};
+
+struct KeyLockTable {
+  explicit KeyLockTable(size_t num_partitions)
+      : num_partitions_(std::max<size_t>(num_partitions, 1)),
+        partitions_(new KeyLockPartition[num_partitions_]) {}
+
+  KeyLockPartition* GetPartition(uint64_t hash) {
+    return &partitions_[FastRange64(hash, num_partitions_)];
+  }
+
+  const size_t num_partitions_;
+  std::unique_ptr<KeyLockPartition[]> partitions_;
+
+  // Count of keys that are currently locked in this column family.
+  // (Only maintained if PointLockManager::max_num_locks_ is positive.)
+  std::atomic<int64_t> lock_cnt{0};
+};
+
+KeyLock* KeyLockPartition::Find(const std::string& key, uint64_t hash) {
+  const size_t mask = entries.size() - 1;
+  for (size_t i = hash & mask;; i = (i + 1) & mask) {
+    KeyLock& entry = entries[i];
+    if (entry.state == KeyLock::kEmpty) {
+      return nullptr;
+    }
+    if (entry.state == KeyLock::kUsed && entry.hash == hash &&
+        entry.key == key) {
+      return &entry;
+    }
+  }
+}
+
+KeyLock* KeyLockPartition::Insert(const std::string& key, uint64_t hash) {
+  // Keep a quarter of the entries empty so that probing stays short, growing
+  // the table only if it's more than half used
+  if ((num_used + num_deleted + 1) * 4 > entries.size() * 3) {
+    Rehash((num_used + 1) * 2 > entries.size() ? entries.size() * 2
+                                               : entries.size());
+  }
+  const size_t mask = entries.size() - 1;
+  size_t i = hash & mask;
+  while (entries[i].state == KeyLock::kUsed) {
+    i = (i + 1) & mask;
+  }
+  KeyLock& entry = entries[i];
+  if (entry.state == KeyLock::kDeleted) {
+    num_deleted--;
+  }
+  num_used++;
+  entry.state = KeyLock::kUsed;
+  entry.hash = hash;
+  entry.key.assign(key);
+  return &entry;
+}
+
+void KeyLockPartition::Erase(KeyLock* entry) {
+  assert(entry->state == KeyLock::kUsed);
+  assert(entry->txn_ids.empty() && entry->waiters == nullptr);
+  const size_t mask = entries.size() - 1;
+  const size_t next = (static_cast<size_t>(entry - entries.data()) + 1) & mask;
+  num_used--;
+  if (entries[next].state == KeyLock::kEmpty) {
+    // No probe goes through this entry
+    entry->state = KeyLock::kEmpty;
+  } else {
+    entry->state = KeyLock::kDeleted;
+    num_deleted++;
+  }
+}
+
+void KeyLockPartition::Rehash(size_t new_size) {
+  std::vector<KeyLock> old_entries(new_size);
+  old_entries.swap(entries);
+  const size_t mask = new_size - 1;
+  for (KeyLock& old_entry : old_entries) {
+    if (old_entry.state != KeyLock::kUsed) {
+      continue;
+    }
+    size_t i = old_entry.hash & mask;
+    while (entries[i].state != KeyLock::kEmpty) {
+      i = (i + 1) & mask;
+    }
+    entries[i] = std::move(old_entry);
+  }
+  num_deleted = 0;
+}
+
+namespace {
+using KeyLockTables = UnorderedMap<uint32_t, std::shared_ptr<KeyLockTable>>;
+
+void UnrefLockTablesCache(void* ptr) {
+  // Called when a thread exits or a ThreadLocalPtr gets destroyed.
+  delete static_cast<KeyLockTables*>(ptr);
+}
+
+// REQUIRES: the partition mutex held
+void SignalWaiters(KeyLock* entry) {
+  if (entry->waiters == nullptr) {
+    return;
+  }
+  for (KeyLockWaiter* waiter : *entry->waiters) {
+    waiter->mutex->Lock().PermitUncheckedError();
+    waiter->signaled = true;
+    waiter->mutex->UnLock();
+    waiter->cv->Notify();
+  }
+}
+
+// REQUIRES: the partition mutex held, the key locked by another transaction
+void AddWaiter(KeyLockPartition* partition, const std::string& key,
+               uint64_t hash, KeyLockWaiter* waiter) {
+  KeyLock* entry = partition->Find(key, hash);
+  assert(entry != nullptr);
+  if (entry->waiters == nullptr) {
+    entry->waiters.reset(new std::vector<KeyLockWaiter*>());
+  }
+  entry->waiters->push_back(waiter);
+}
+
+// REQUIRES: the partition mutex held, `waiter` queued on `key`
+void RemoveWaiter(KeyLockPartition* partition, const std::string& key,
+                  uint64_t hash, KeyLockWaiter* waiter) {
+  KeyLock* entry = partition->Find(key, hash);
+  assert(entry != nullptr && entry->waiters != nullptr);
+  std::vector<KeyLockWaiter*>& waiters = *entry->waiters;
+  auto it = std::find(waiters.begin(), waiters.end(), waiter);
+  assert(it != waiters.end());
+  *it = waiters.back();
+  waiters.pop_back();
+  if (waiters.empty()) {
+    entry->waiters.reset();
+    if (entry->txn_ids.empty()) {
+      partition->Erase(entry);
+    }
+  }
+}
+}  // anonymous namespace
+
+PerKeyPointLockManager::PerKeyPointLockManager(PessimisticTransactionDB* db,
+                                               const TransactionDBOptions& opt)
+    : PointLockManager(db, opt),
+      lock_tables_cache_(new ThreadLocalPtr(&UnrefLockTablesCache)) {}
+
+PerKeyPointLockManager::~PerKeyPointLockManager() = default;
+
+void PerKeyPointLockManager::AddColumnFamily(const ColumnFamilyHandle* cf) {
+  InstrumentedMutexLock l(&lock_map_mutex_);
+
+  if (lock_tables_.find(cf->GetID()) == lock_tables_.end()) {
+    lock_tables_.emplace(cf->GetID(),
+                         std::make_shared<KeyLockTable>(default_num_stripes_));
+  } else {
+    // column_family already exists in lock table
+    assert(false);
+  }
+}
+
+void PerKeyPointLockManager::RemoveColumnFamily(const ColumnFamilyHandle* cf) {
+  // Since the lock table is stored as a shared ptr, concurrent transactions
+  // can still keep using it until they release their references to it.
+  {
+    InstrumentedMutexLock l(&lock_map_mutex_);
+
+    auto lock_tables_iter = lock_tables_.find(cf->GetID());
+    if (lock_tables_iter == lock_tables_.end()) {
+      return;
+    }
+
+    lock_tables_.erase(lock_tables_iter);
+  }  // lock_map_mutex_
+
+  // Clear all thread-local caches
+  autovector<void*> local_caches;
+  lock_tables_cache_->Scrape(&local_caches, nullptr);
+  for (auto cache : local_caches) {
+    delete static_cast<KeyLockTables*>(cache);
+  }
+}
+
+// Same as PointLockManager::GetLockMap()
+std::shared_ptr<KeyLockTable> PerKeyPointLockManager::GetLockTable(
+    ColumnFamilyId column_family_id) {
+  if (lock_tables_cache_->Get() == nullptr) {
+    lock_tables_cache_->Reset(new KeyLockTables());
+  }
+
+  auto lock_tables_cache =
+      static_cast<KeyLockTables*>(lock_tables_cache_->Get());
+
+  auto lock_table_iter = lock_tables_cache->find(column_family_id);
+  if (lock_table_iter != lock_tables_cache->end()) {
+    return lock_table_iter->second;
+  }
+
+  InstrumentedMutexLock l(&lock_map_mutex_);
+
+  lock_table_iter = lock_tables_.find(column_family_id);
+  if (lock_table_iter == lock_tables_.end()) {
+    return std::shared_ptr<KeyLockTable>(nullptr);
+  }
+  std::shared_ptr<KeyLockTable>& lock_table = lock_table_iter->second;
+  lock_tables_cache->insert({column_family_id, lock_table});
+  return lock_table;
+}
+
+Status PerKeyPointLockManager::TryLock(PessimisticTransaction* txn,
+                                       ColumnFamilyId column_family_id,
+                                       const std::string& key, Env* env,
+                                       bool exclusive) {
+  std::shared_ptr<KeyLockTable> table_ptr = GetLockTable(column_family_id);
+  KeyLockTable* table = table_ptr.get();
+  if (table == nullptr) {
+    char msg[255];
+    snprintf(msg, sizeof(msg), "Column family id not found: %" PRIu32,
+             column_family_id);
+
+    return Status::InvalidArgument(msg);
+  }
+
+  const uint64_t hash = GetSliceNPHash64(key);
+  KeyLockPartition* partition = table->GetPartition(hash);
+  Status result;
+  {
+    uint64_t expire_time_hint = 0;
+    autovector<TransactionID> wait_ids;
+    std::lock_guard<SpinMutex> guard(partition->mutex);
+    result = AcquireLocked(table, partition, key, hash, txn->GetID(),
+                           exclusive, txn->GetExpirationTime(), env,
+                           &expire_time_hint, &wait_ids);
+  }
+  if (!result.IsTimedOut() || txn->GetLockTimeout() == 0) {
+    return result;
+  }
+  return AcquireWithTimeout(txn, table, partition, column_family_id, key, hash,
+                            exclusive, env);
+}
+
+Status PerKeyPointLockManager::AcquireWithTimeout(
+    PessimisticTransaction* txn, KeyLockTable* table,
+    KeyLockPartition* partition, ColumnFamilyId column_family_id,
+    const std::string& key, uint64_t hash, bool exclusive, Env* env) {
+  PERF_TIMER_GUARD(key_lock_wait_time);
+  PERF_COUNTER_ADD(key_lock_wait_count, 1);
+  const int64_t timeout = txn->GetLockTimeout();
+  uint64_t end_time = 0;
+  if (timeout > 0) {
+    end_time = env->NowMicros() + timeout;
+  }
+
+  KeyLockWaiter waiter;
+  waiter.mutex = mutex_factory_->AllocateMutex();
+  waiter.cv = mutex_factory_->AllocateCondVar();
+  bool queued = false;
+  bool timed_out = false;
+  Status result;
+  while (true) {
+    uint64_t expire_time_hint = 0;
+    autovector<TransactionID> wait_ids;
+    {
+      std::lock_guard<SpinMutex> guard(partition->mutex);
+      // The lock may have been released since the last attempt
+      result = AcquireLocked(table, partition, key, hash, txn->GetID(),
+                             exclusive, txn->GetExpirationTime(), env,
+                             &expire_time_hint, &wait_ids);
+      if (!result.IsTimedOut() || timed_out) {
+        if (queued) {
+          RemoveWaiter(partition, key, hash, &waiter);
+        }
+        return result;
+      }
+      // Any release of the key from now on signals the waiter
+      if (queued) {
+        waiter.signaled = false;
+      } else {
+        AddWaiter(partition, key, hash, &waiter);
+        queued = true;
+      }
+    }
+
+    // Decide how long to wait
+    int64_t cv_end_time = -1;
+    if (expire_time_hint > 0 && end_time > 0) {
+      cv_end_time = std::min(expire_time_hint, end_time);
+    } else if (expire_time_hint > 0) {
+      cv_end_time = expire_time_hint;
+    } else if (end_time > 0) {
+      cv_end_time = end_time;
+    }
+
+    // We are dependent on a transaction to finish, so perform deadlock
+    // detection.
+    assert(!wait_ids.empty());
+    if (txn->IsDeadlockDetect() &&
+        IncrementWaiters(txn, wait_ids, key, column_family_id, exclusive,
+                         env)) {
+      std::lock_guard<SpinMutex> guard(partition->mutex);
+      RemoveWaiter(partition, key, hash, &waiter);
+      return Status::Busy(Status::SubCode::kDeadlock);
+    }
+    txn->SetWaitingTxn(wait_ids, column_family_id, &key);
+
+    TEST_SYNC_POINT("PerKeyPointLockManager::AcquireWithTimeout:WaitingTxn");
+    result = waiter.mutex->Lock();
+    if (result.ok()) {
+      if (!waiter.signaled) {
+        if (cv_end_time < 0) {
+          // Wait indefinitely
+          result = waiter.cv->Wait(waiter.mutex);
+        } else {
+          uint64_t now = env->NowMicros();
+          if (static_cast<uint64_t>(cv_end_time) > now) {
+            result = waiter.cv->WaitFor(waiter.mutex, cv_end_time - now);
+          }
+        }
+      }
+      waiter.mutex->UnLock();
+    }
+
+    txn->ClearWaitingTxn();
+    if (txn->IsDeadlockDetect()) {
+      DecrementWaiters(txn, wait_ids);
+    }
+
+    if (!result.ok() && !result.IsTimedOut()) {
+      std::lock_guard<SpinMutex> guard(partition->mutex);
+      RemoveWaiter(partition, key, hash, &waiter);
+      return result;
+    }
+    // Waking up at the expiration of the lock only retries, even a timed out
+    // wait makes one more attempt
+    timed_out = end_time > 0 && env->NowMicros() >= end_time;
+  }
+}
+
+Status PerKeyPointLockManager::AcquireLocked(
+    KeyLockTable* table, KeyLockPartition* partition, const std::string& key,
+    uint64_t hash, TransactionID txn_id, bool exclusive,
+    uint64_t expiration_time, Env* env, uint64_t* expire_time,
+    autovector<TransactionID>* txn_ids) {
+  assert(txn_ids->empty());
+  KeyLock* entry = partition->Find(key, hash);
+  if (entry != nullptr && !entry->txn_ids.empty()) {
+    assert(entry->txn_ids.size() == 1 || !entry->exclusive);
+    if (entry->exclusive || exclusive) {
+      if (entry->txn_ids.size() == 1 && entry->txn_ids[0] == txn_id) {
+        // The list contains one txn and we're it, so just take it.
+        entry->exclusive = exclusive;
+        entry->expiration_time = expiration_time;
+      } else if (IsLockExpired(txn_id, entry->txn_ids, entry->expiration_time,
+                               env, expire_time)) {
+        // lock is expired, can steal it
+        entry->txn_ids.clear();
+        entry->txn_ids.push_back(txn_id);
+        entry->exclusive = exclusive;
+        entry->expiration_time = expiration_time;
+        // lock_cnt does not change
+      } else {
+        *txn_ids = entry->txn_ids;
+        return Status::TimedOut(Status::SubCode::kLockTimeout);
+      }
+    } else if (std::find(entry->txn_ids.begin(), entry->txn_ids.end(),
+                         txn_id) == entry->txn_ids.end()) {
+      // We are requesting shared access to a shared lock, so just grant it.
+      entry->txn_ids.push_back(txn_id);
+      // Using std::max means that expiration time never goes down even when
+      // a transaction is removed from the list. The correct solution would be
+      // to track expiry for every transaction, but this would also work for
+      // now.
+      entry->expiration_time =
+          std::max(entry->expiration_time, expiration_time);
+    }
+    return Status::OK();
+  }
+
+  // Lock not held.
+  // Check lock limit
+  if (max_num_locks_ > 0 &&
+      table->lock_cnt.load(std::memory_order_acquire) >= max_num_locks_) {
+    return Status::Busy(Status::SubCode::kLockLimit);
+  }
+  if (entry == nullptr) {
+    entry = partition->Insert(key, hash);
+  }
+  entry->exclusive = exclusive;
+  entry->txn_ids.push_back(txn_id);
+  entry->expiration_time = expiration_time;
+
+  // Maintain lock count if there is a limit on the number of locks
+  if (max_num_locks_ > 0) {
+    table->lock_cnt++;
+  }
+  return Status::OK();
+}
+
+void PerKeyPointLockManager::UnLockKey(PessimisticTransaction* txn,
+                                       KeyLockTable* table,
+                                       const std::string& key, Env* env) {
+#ifdef NDEBUG
+  (void)env;
+#endif
+  const uint64_t hash = GetSliceNPHash64(key);
+  KeyLockPartition* partition = table->GetPartition(hash);
+  std::lock_guard<SpinMutex> guard(partition->mutex);
+  KeyLock* entry = partition->Find(key, hash);
+  if (entry == nullptr || entry->txn_ids.empty()) {
+    // This key is either not locked or locked by someone else.  This should
+    // only happen if the unlocking transaction has expired.
+    assert(txn->GetExpirationTime() > 0 &&
+           txn->GetExpirationTime() < env->NowMicros());
+    return;
+  }
+  autovector<TransactionID>& txns = entry->txn_ids;
+  auto txn_it = std::find(txns.begin(), txns.end(), txn->GetID());
+  if (txn_it == txns.end()) {
+    return;
+  }
+  if (txns.size() > 1) {
+    *txn_it = txns.back();
+  }
+  txns.pop_back();
+  if (!txns.empty()) {
+    return;
+  }
+
+  if (max_num_locks_ > 0) {
+    // Maintain lock count if there is a limit on the number of locks.
+    assert(table->lock_cnt.load(std::memory_order_relaxed) > 0);
+    table->lock_cnt--;
+  }
+  if (entry->waiters == nullptr) {
+    partition->Erase(entry);
+  } else {
+    SignalWaiters(entry);
+  }
+}
+
+void PerKeyPointLockManager::UnLock(PessimisticTransaction* txn,
+                                    ColumnFamilyId column_family_id,
+                                    const std::string& key, Env* env) {
+  std::shared_ptr<KeyLockTable> table_ptr = GetLockTable(column_family_id);
+  if (table_ptr == nullptr) {
+    // Column Family must have been dropped.
+    return;
+  }
+  UnLockKey(txn, table_ptr.get(), key, env);
+}
+
+void PerKeyPointLockManager::UnLock(PessimisticTransaction* txn,
+                                    const LockTracker& tracker, Env* env) {
+  std::unique_ptr<LockTracker::ColumnFamilyIterator> cf_it(
+      tracker.GetColumnFamilyIterator());
+  assert(cf_it != nullptr);
+  while (cf_it->HasNext()) {
+    ColumnFamilyId cf = cf_it->Next();
+    std::shared_ptr<KeyLockTable> table_ptr = GetLockTable(cf);
+    if (table_ptr == nullptr) {
+      // Column Family must have been dropped.
+      continue;
+    }
+    std::unique_ptr<LockTracker::KeyIterator> key_it(
+        tracker.GetKeyIterator(cf));
+    assert(key_it != nullptr);
+    while (key_it->HasNext()) {
+      UnLockKey(txn, table_ptr.get(), key_it->Next(), env);
+    }
+  }
+}
+
+PointLockManager::PointLockStatus PerKeyPointLockManager::GetPointLockStatus() {
+  PointLockStatus data;
+  // Lock order here is important. The correct order is lock_map_mutex_, then
+  // for every column family ID in ascending order lock every partition in
+  // ascending order.
+  InstrumentedMutexLock l(&lock_map_mutex_);
+
+  std::vector<uint32_t> cf_ids;
+  for (const auto& table : lock_tables_) {
+    cf_ids.push_back(table.first);
+  }
+  std::sort(cf_ids.begin(), cf_ids.end());
+
+  for (auto i : cf_ids) {
+    KeyLockTable* table = lock_tables_[i].get();
+    for (size_t j = 0; j < table->num_partitions_; j++) {
+      KeyLockPartition& partition = table->partitions_[j];
+      partition.mutex.lock();
+      for (const KeyLock& entry : partition.entries) {
+        if (entry.state != KeyLock::kUsed || entry.txn_ids.empty()) {
+          continue;
+        }
+        struct KeyLockInfo info;
+        info.exclusive = entry.exclusive;
+        info.key = entry.key;
+        for (const auto& id : entry.txn_ids) {
+          info.ids.push_back(id);
+        }
+        data.insert({i, info});
+      }
+    }
+  }
+
+  // Unlock everything. Unlocking order is not important.
+  for (auto i : cf_ids) {
+    KeyLockTable* table = lock_tables_[i].get();
+    for (size_t j = 0; j < table->num_partitions_; j++) {
+      table->partitions_[j].mutex.unlock();
+    }
+  }
+
+  return data;
+}
+
+}  // namespace ROCKSDB_NAMESPACE
@@ -0,0 +1,86 @@
+//  Copyright (c) Meta Platforms, Inc. and affiliates.
+//  This source code is licensed under both the GPLv2 (found in the
+//  COPYING file in the root directory) and Apache 2.0 License
+//  (found in the LICENSE.Apache file in the root directory).
+
+#pragma once
+
+#include <memory>
+#include <string>
+
+#include "utilities/transactions/lock/point/point_lock_manager.h"
+
+namespace ROCKSDB_NAMESPACE {
+
+struct KeyLockPartition;
+struct KeyLockTable;
+
+// A PointLockManager keeping the locks of a column family in a table of
+// per-key entries rather than in mutex-guarded stripes of maps, see
+// TransactionDBOptions::use_per_key_point_lock_mgr.
+//
+// The table is split into partitions of open-addressing entries, each
+// guarded by a SpinMutex that is only held to look up, grant or release a
+// lock, never while waiting. The entries and their key buffers are reused, so
+// locking a key that isn't contended usually doesn't allocate. A transaction
+// waiting on a key queues itself in the entry of the key, allocating the
+// queue on the first conflict, and is only woken up by the releases of that
+// key. Deadlock detection is the same as PointLockManager's.
+class PerKeyPointLockManager : public PointLockManager {
+ public:
+  PerKeyPointLockManager(PessimisticTransactionDB* db,
+                         const TransactionDBOptions& opt);
+  // No copying allowed
+  PerKeyPointLockManager(const PerKeyPointLockManager&) = delete;
+  PerKeyPointLockManager& operator=(const PerKeyPointLockManager&) = delete;
+
+  ~PerKeyPointLockManager() override;
+
+  void AddColumnFamily(const ColumnFamilyHandle* cf) override;
+  void RemoveColumnFamily(const ColumnFamilyHandle* cf) override;
+
+  using PointLockManager::TryLock;
+  Status TryLock(PessimisticTransaction* txn, ColumnFamilyId column_family_id,
+                 const std::string& key, Env* env, bool exclusive) override;
+
+  using PointLockManager::UnLock;
+  void UnLock(PessimisticTransaction* txn, const LockTracker& tracker,
+              Env* env) override;
+  void UnLock(PessimisticTransaction* txn, ColumnFamilyId column_family_id,
+              const std::string& key, Env* env) override;
+
+  PointLockStatus GetPointLockStatus() override;
+
+ private:
+  std::shared_ptr<KeyLockTable> GetLockTable(ColumnFamilyId column_family_id);
+
+  // Waits for the lock of `key` until it's acquired or the lock timeout of
+  // `txn` expires
+  Status AcquireWithTimeout(PessimisticTransaction* txn, KeyLockTable* table,
+                            KeyLockPartition* partition,
+                            ColumnFamilyId column_family_id,
+                            const std::string& key, uint64_t hash,
+                            bool exclusive, Env* env);
+
+  // Tries to lock `key` for `txn_id`. On a conflict, returns TimedOut and
+  // sets `*txn_ids` to the holders, and `*expire_time` to the expiration time
+  // of the lock in microseconds or 0 if no expiration.
+  // REQUIRES: the partition mutex held
+  Status AcquireLocked(KeyLockTable* table, KeyLockPartition* partition,
+                       const std::string& key, uint64_t hash,
+                       TransactionID txn_id, bool exclusive,
+                       uint64_t expiration_time, Env* env,
+                       uint64_t* expire_time,
+                       autovector<TransactionID>* txn_ids);
+
+  void UnLockKey(PessimisticTransaction* txn, KeyLockTable* table,
+                 const std::string& key, Env* env);
+
+  // Map of ColumnFamilyId to lock table, guarded by lock_map_mutex_
+  UnorderedMap<uint32_t, std::shared_ptr<KeyLockTable>> lock_tables_;
+
+  // Thread-local cache of entries in lock_tables_
+  std::unique_ptr<ThreadLocalPtr> lock_tables_cache_;
+};
+
+}  // namespace ROCKSDB_NAMESPACE
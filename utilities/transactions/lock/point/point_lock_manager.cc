@@ -193,18 +193,26 @@ std::shared_ptr<LockMap> PointLockManager::GetLockMap(
 bool PointLockManager::IsLockExpired(TransactionID txn_id,
                                      const LockInfo& lock_info, Env* env,
                                      uint64_t* expire_time) {
-  if (lock_info.expiration_time == 0) {
+  return IsLockExpired(txn_id, lock_info.txn_ids, lock_info.expiration_time,
+                       env, expire_time);
+}
+
+bool PointLockManager::IsLockExpired(TransactionID txn_id,
+                                     const autovector<TransactionID>& txn_ids,
+                                     uint64_t expiration_time, Env* env,
+                                     uint64_t* expire_time) {
+  if (expiration_time == 0) {
     *expire_time = 0;
     return false;
   }
 
   auto now = env->NowMicros();
-  bool expired = lock_info.expiration_time <= now;
+  bool expired = expiration_time <= now;
   if (!expired) {
     // return how many microseconds until lock will be expired
-    *expire_time = lock_info.expiration_time;
+    *expire_time = expiration_time;
   } else {
-    for (auto id : lock_info.txn_ids) {
+    for (auto id : txn_ids) {
       if (txn_id == id) {
         continue;
       }
@@ -153,7 +153,7 @@ class PointLockManager : public LockManager {
 
   void Resize(uint32_t new_size) override;
 
- private:
+ protected:
   PessimisticTransactionDB* txn_db_impl_;
 
   // Default number of lock map stripes per column family
@@ -193,6 +193,10 @@ class PointLockManager : public LockManager {
 
   bool IsLockExpired(TransactionID txn_id, const LockInfo& lock_info, Env* env,
                      uint64_t* wait_time);
+  // Same as above, for a lock held by `txn_ids` until `expiration_time`
+  bool IsLockExpired(TransactionID txn_id,
+                     const autovector<TransactionID>& txn_ids,
+                     uint64_t expiration_time, Env* env, uint64_t* wait_time);
 
   std::shared_ptr<LockMap> GetLockMap(uint32_t column_family_id);
 
@@ -6,6 +6,9 @@
 
 #include "utilities/transactions/lock/point/point_lock_manager_test.h"
 
+#include "util/random.h"
+#include "utilities/transactions/lock/point/per_key_point_lock_manager.h"
+
 namespace ROCKSDB_NAMESPACE {
 
 // This test is not applicable for Range Lock manager as Range Lock Manager
@@ -157,8 +160,57 @@ TEST_F(PointLockManagerTest, DeadlockDepthExceeded) {
   delete txn1;
 }
 
+void PerKeyPointLockManagerTestSetup(PointLockManagerTest* self) {
+  self->PointLockManagerTest::SetUp();
+  TransactionDBOptions txn_opt;
+  txn_opt.transaction_lock_timeout = 0;
+  self->locker_.reset(new PerKeyPointLockManager(
+      static_cast<PessimisticTransactionDB*>(self->db_), txn_opt));
+  self->wait_sync_point_name_ =
+      "PerKeyPointLockManager::AcquireWithTimeout:WaitingTxn";
+}
+
+TEST_P(AnyLockManagerTest, ConcurrentExclusiveLocks) {
+  // Tests that contended exclusive locks are mutually exclusive, and that
+  // every waiter is eventually granted the lock.
+  MockColumnFamilyHandle cf(1);
+  locker_->AddColumnFamily(&cf);
+  constexpr int kNumThreads = 8;
+  constexpr int kNumKeys = 3;
+  constexpr int kNumIters = 200;
+  std::vector<int> counters(kNumKeys, 0);
+  std::vector<port::Thread> threads;
+  for (int i = 0; i < kNumThreads; i++) {
+    threads.emplace_back([&, i]() {
+      TransactionOptions txn_opt;
+      txn_opt.lock_timeout = 1000000;
+      auto txn = NewTxn(txn_opt);
+      Random rnd(301 + i);
+      for (int j = 0; j < kNumIters; j++) {
+        const int k = static_cast<int>(rnd.Uniform(kNumKeys));
+        const std::string key = "k" + std::to_string(k);
+        ASSERT_OK(locker_->TryLock(txn, 1, key, env_, true));
+        counters[k]++;
+        locker_->UnLock(txn, 1, key, env_);
+      }
+      delete txn;
+    });
+  }
+  for (auto& t : threads) {
+    t.join();
+  }
+  int total = 0;
+  for (int counter : counters) {
+    total += counter;
+  }
+  ASSERT_EQ(total, kNumThreads * kNumIters);
+  ASSERT_TRUE(locker_->GetPointLockStatus().empty());
+}
+
 INSTANTIATE_TEST_CASE_P(PointLockManager, AnyLockManagerTest,
                         ::testing::Values(nullptr));
+INSTANTIATE_TEST_CASE_P(PerKeyPointLockManager, AnyLockManagerTest,
+                        ::testing::Values(PerKeyPointLockManagerTestSetup));
 
 }  // namespace ROCKSDB_NAMESPACE
 
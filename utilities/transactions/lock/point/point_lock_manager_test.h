@@ -77,6 +77,7 @@ class PointLockManagerTest : public testing::Test {
   std::shared_ptr<LockManager> locker_;
   const char* wait_sync_point_name_;
   friend void PointLockManagerTestExternalSetup(PointLockManagerTest*);
+  friend void PerKeyPointLockManagerTestSetup(PointLockManagerTest*);
 
  private:
   std::string db_dir_;
@@ -88,6 +88,11 @@ class OptimisticTransactionDBImpl : public OptimisticTransactionDB {
     return OptimisticTransactionDB::Write(write_opts, batch);
   }
 
+  void WriteAsync(const WriteOptions& write_opts, WriteBatch* batch,
+                  std::function<void(const Status&)> callback) override {
+    DB::WriteAsync(write_opts, batch, std::move(callback));
+  }
+
   OccValidationPolicy GetValidatePolicy() const { return validate_policy_; }
 
   port::Mutex& GetLockBucket(const Slice& key, uint64_t seed) {
@@ -65,6 +65,11 @@ class PessimisticTransactionDB : public TransactionDB {
 
   using TransactionDB::Write;
   Status Write(const WriteOptions& opts, WriteBatch* updates) override;
+  // Writes synchronously with Write(), which locks the keys
+  void WriteAsync(const WriteOptions& opts, WriteBatch* updates,
+                  std::function<void(const Status&)> callback) override {
+    DB::WriteAsync(opts, updates, std::move(callback));
+  }
   inline Status WriteWithConcurrencyControl(const WriteOptions& opts,
                                             WriteBatch* updates) {
     Status s;
@@ -6,8 +6,10 @@
 
 #include "utilities/transactions/transaction_util.h"
 
+#include <algorithm>
 #include <cinttypes>
 #include <string>
+#include <utility>
 #include <vector>
 
 #include "db/db_impl/db_impl.h"
@@ -169,21 +171,38 @@ Status TransactionUtil::CheckKeysForConflicts(DBImpl* db_impl,
 
     SequenceNumber earliest_seq =
         db_impl->GetEarliestMemTableSequenceNumber(sv, true);
-
-    // For each of the keys in this transaction, check to see if someone has
-    // written to this key since the start of the transaction.
+    // The lookups of CheckKey() don't see writes after this sequence number,
+    // so a key tracked at or after it can't conflict
+    const SequenceNumber last_seq = db_impl->GetLatestSequenceNumber();
+
+    // Gather the keys that may have been written since they were tracked, and
+    // check them in key order so that consecutive lookups go through mostly
+    // the same memtable nodes and SST blocks
+    std::vector<std::pair<const std::string*, SequenceNumber>> keys;
     std::unique_ptr<LockTracker::KeyIterator> key_it(
         tracker.GetKeyIterator(cf));
     assert(key_it != nullptr);
     while (key_it->HasNext()) {
       const std::string& key = key_it->Next();
       PointLockStatus status = tracker.GetPointLockStatus(cf, key);
-      const SequenceNumber key_seq = status.seq;
+      if (status.seq < last_seq) {
+        keys.emplace_back(&key, status.seq);
+      }
+    }
+    const Comparator* const ucmp = sv->cfd->user_comparator();
+    std::sort(keys.begin(), keys.end(),
+              [ucmp](const std::pair<const std::string*, SequenceNumber>& a,
+                     const std::pair<const std::string*, SequenceNumber>& b) {
+                return ucmp->Compare(*a.first, *b.first) < 0;
+              });
 
+    // For each of the keys in this transaction, check to see if someone has
+    // written to this key since the start of the transaction.
+    for (const auto& key : keys) {
       // TODO: support timestamp-based conflict checking.
       // CheckKeysForConflicts() is currently used only by optimistic
       // transactions.
-      result = CheckKey(db_impl, sv, earliest_seq, key_seq, key,
+      result = CheckKey(db_impl, sv, earliest_seq, key.second, *key.first,
                         /*read_ts=*/nullptr, cache_only);
       if (!result.ok()) {
         break;
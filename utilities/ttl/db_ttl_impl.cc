@@ -219,6 +219,23 @@ bool TtlCompactionFilter::Filter(int level, const Slice& key,
   return false;
 }
 
+void TtlCompactionFilter::FilterBatch(
+    int /*level*/, const std::vector<BatchEntry>& entries,
+    std::vector<Decision>* decisions,
+    std::vector<std::string>* /*new_values*/) const {
+  int64_t curtime = 0;
+  const bool has_curtime = ttl_ > 0 && clock_->GetCurrentTime(&curtime).ok();
+  for (size_t i = 0; i < entries.size(); i++) {
+    if (has_curtime &&
+        DBWithTTLImpl::IsStale(entries[i].existing_value, ttl_, curtime)) {
+      (*decisions)[i] = Decision::kRemove;
+    } else if (user_comp_filter() == nullptr) {
+      (*decisions)[i] = Decision::kKeep;
+    }
+    // Otherwise FilterV3() calls Filter(), which runs the user's filter
+  }
+}
+
 Status TtlCompactionFilter::PrepareOptions(
     const ConfigOptions& config_options) {
   if (clock_ == nullptr) {
@@ -449,6 +466,13 @@ bool DBWithTTLImpl::IsStale(const Slice& value, int32_t ttl,
   if (!clock->GetCurrentTime(&curtime).ok()) {
     return false;  // Treat the data as fresh if could not get current time
   }
+  return IsStale(value, ttl, curtime);
+}
+
+bool DBWithTTLImpl::IsStale(const Slice& value, int32_t ttl, int64_t curtime) {
+  if (ttl <= 0) {  // Data is fresh if TTL is non-positive
+    return false;
+  }
   /* int32_t may overflow when timestamp_value + ttl
    * for example ttl = 86400 * 365 * 15
    * convert timestamp_value to int64_t
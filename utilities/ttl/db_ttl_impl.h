@@ -73,6 +73,12 @@ class DBWithTTLImpl : public DBWithTTL {
 
   Status Write(const WriteOptions& opts, WriteBatch* updates) override;
 
+  // Writes synchronously with Write(), which appends the timestamps
+  void WriteAsync(const WriteOptions& opts, WriteBatch* updates,
+                  std::function<void(const Status&)> callback) override {
+    DB::WriteAsync(opts, updates, std::move(callback));
+  }
+
   using StackableDB::NewIterator;
   Iterator* NewIterator(const ReadOptions& _read_options,
                         ColumnFamilyHandle* column_family) override;
@@ -80,6 +86,7 @@ class DBWithTTLImpl : public DBWithTTL {
   DB* GetBaseDB() override { return db_; }
 
   static bool IsStale(const Slice& value, int32_t ttl, SystemClock* clock);
+  static bool IsStale(const Slice& value, int32_t ttl, int64_t curtime);
 
   static Status AppendTS(const Slice& val, std::string* val_with_ts,
                          SystemClock* clock);
@@ -119,6 +126,8 @@ class TtlIterator : public Iterator {
 
   void Seek(const Slice& target) override { iter_->Seek(target); }
 
+  void StartSeek(const Slice& target) override { iter_->StartSeek(target); }
+
   void SeekForPrev(const Slice& target) override { iter_->SeekForPrev(target); }
 
   void Next() override { iter_->Next(); }
@@ -156,6 +165,13 @@ class TtlCompactionFilter : public LayeredCompactionFilterBase {
   bool Filter(int level, const Slice& key, const Slice& old_val,
               std::string* new_val, bool* value_changed) const override;
 
+  // The batches look up the current time once for all their keys
+  size_t GetFilterBatchSize() const override { return kFilterBatchSize; }
+  void FilterBatch(int level, const std::vector<BatchEntry>& entries,
+                   std::vector<Decision>* decisions,
+                   std::vector<std::string>* new_values) const override;
+  static constexpr size_t kFilterBatchSize = 64;
+
   const char* Name() const override { return kClassName(); }
   static const char* kClassName() { return "TtlCompactionFilter"; }
   bool IsInstanceOf(const std::string& name) const override {
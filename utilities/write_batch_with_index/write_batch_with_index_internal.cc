@@ -641,21 +641,43 @@ int WriteBatchEntryComparator::operator()(
     return 1;
   }
 
-  Slice key1, key2;
-  if (entry1->search_key == nullptr) {
-    key1 = Slice(write_batch_->Data().data() + entry1->key_offset,
-                 entry1->key_size);
-  } else {
-    key1 = *(entry1->search_key);
-  }
-  if (entry2->search_key == nullptr) {
-    key2 = Slice(write_batch_->Data().data() + entry2->key_offset,
-                 entry2->key_size);
+  const int prefix_order =
+      entry1->column_family < cf_key_prefix_orders_.size()
+          ? cf_key_prefix_orders_[entry1->column_family]
+          : default_key_prefix_order_;
+  const size_t key_size1 = entry1->search_key == nullptr
+                               ? entry1->key_size
+                               : entry1->search_key->size();
+  const size_t key_size2 = entry2->search_key == nullptr
+                               ? entry2->key_size
+                               : entry2->search_key->size();
+  int cmp = 0;
+  if (prefix_order != 0 && entry1->key_prefix != entry2->key_prefix) {
+    return entry1->key_prefix < entry2->key_prefix ? -prefix_order
+                                                   : prefix_order;
+  } else if (prefix_order != 0 && key_size1 <= sizeof(uint64_t) &&
+             key_size2 <= sizeof(uint64_t)) {
+    // Both keys are within their equal prefixes, so the shorter one is a
+    // prefix of the other
+    if (key_size1 != key_size2) {
+      cmp = key_size1 < key_size2 ? -prefix_order : prefix_order;
+    }
   } else {
-    key2 = *(entry2->search_key);
+    Slice key1, key2;
+    if (entry1->search_key == nullptr) {
+      key1 = Slice(write_batch_->Data().data() + entry1->key_offset,
+                   entry1->key_size);
+    } else {
+      key1 = *(entry1->search_key);
+    }
+    if (entry2->search_key == nullptr) {
+      key2 = Slice(write_batch_->Data().data() + entry2->key_offset,
+                   entry2->key_size);
+    } else {
+      key2 = *(entry2->search_key);
+    }
+    cmp = CompareKey(entry1->column_family, key1, key2);
   }
-
-  int cmp = CompareKey(entry1->column_family, key1, key2);
   if (cmp != 0) {
     return cmp;
   } else if (entry1->offset > entry2->offset) {
@@ -666,6 +688,19 @@ int WriteBatchEntryComparator::operator()(
   return 0;
 }
 
+int8_t WriteBatchEntryComparator::KeyPrefixOrder(
+    const Comparator* comparator) {
+  // The timestamps are stripped from the keys of the index
+  if (comparator == BytewiseComparator() ||
+      comparator == BytewiseComparatorWithU64Ts()) {
+    return 1;
+  } else if (comparator == ReverseBytewiseComparator() ||
+             comparator == ReverseBytewiseComparatorWithU64Ts()) {
+    return -1;
+  }
+  return 0;
+}
+
 int WriteBatchEntryComparator::CompareKey(uint32_t column_family,
                                           const Slice& key1,
                                           const Slice& key2) const {
@@ -4,6 +4,7 @@
 //  (found in the LICENSE.Apache file in the root directory).
 #pragma once
 
+#include <cstring>
 #include <limits>
 #include <string>
 #include <vector>
@@ -19,6 +20,7 @@
 #include "rocksdb/slice.h"
 #include "rocksdb/status.h"
 #include "rocksdb/utilities/write_batch_with_index.h"
+#include "util/math.h"
 
 namespace ROCKSDB_NAMESPACE {
 
@@ -82,11 +84,13 @@ class BaseDeltaIterator : public Iterator {
 
 // Key used by skip list, as the binary searchable index of WriteBatchWithIndex.
 struct WriteBatchIndexEntry {
-  WriteBatchIndexEntry(size_t o, uint32_t c, size_t ko, size_t ksz)
+  WriteBatchIndexEntry(size_t o, uint32_t c, size_t ko, size_t ksz,
+                       uint64_t kp)
       : offset(o),
         column_family(c),
         key_offset(ko),
         key_size(ksz),
+        key_prefix(kp),
         search_key(nullptr) {}
   // Create a dummy entry as the search key. This index entry won't be backed
   // by an entry from the write batch, but a pointer to the search key. Or a
@@ -104,10 +108,22 @@ struct WriteBatchIndexEntry {
         column_family(_column_family),
         key_offset(0),
         key_size(is_seek_to_first ? kFlagMinInCf : 0),
+        key_prefix(_search_key != nullptr ? KeyPrefix(*_search_key) : 0),
         search_key(_search_key) {
     assert(_search_key != nullptr || is_seek_to_first);
   }
 
+  // Returns the first 8 bytes of `key` as a big-endian integer, padded with
+  // zeros. If the prefixes of two keys differ, they order the keys the same
+  // way as a bytewise comparison of the keys.
+  static uint64_t KeyPrefix(const Slice& key) {
+    char buf[sizeof(uint64_t)] = {};
+    memcpy(buf, key.data(), std::min(key.size(), sizeof(buf)));
+    uint64_t prefix;
+    memcpy(&prefix, buf, sizeof(prefix));
+    return port::kLittleEndian ? EndianSwapValue(prefix) : prefix;
+  }
+
   // If this flag appears in the key_size, it indicates a
   // key that is smaller than any other entry for the same column family.
   static const size_t kFlagMinInCf = std::numeric_limits<size_t>::max();
@@ -134,6 +150,9 @@ struct WriteBatchIndexEntry {
                            // SeekToFirst() to the beginning of the column
                            // family. We use the flag here to save a boolean
                            // in the struct.
+  uint64_t key_prefix;     // KeyPrefix() of the key, so that bytewise
+                           // comparisons don't have to read the write batch
+                           // unless the keys share their first 8 bytes.
 
   const Slice* search_key;  // if not null, instead of reading keys from
                             // write batch, use it to compare. This is used
@@ -157,7 +176,9 @@ class WriteBatchEntryComparator {
  public:
   WriteBatchEntryComparator(const Comparator* _default_comparator,
                             const ReadableWriteBatch* write_batch)
-      : default_comparator_(_default_comparator), write_batch_(write_batch) {}
+      : default_comparator_(_default_comparator),
+        default_key_prefix_order_(KeyPrefixOrder(_default_comparator)),
+        write_batch_(write_batch) {}
   // Compare a and b. Return a negative value if a is less than b, 0 if they
   // are equal, and a positive value if a is greater than b
   int operator()(const WriteBatchIndexEntry* entry1,
@@ -170,8 +191,15 @@ class WriteBatchEntryComparator {
                           const Comparator* comparator) {
     if (column_family_id >= cf_comparators_.size()) {
       cf_comparators_.resize(column_family_id + 1, nullptr);
+      cf_key_prefix_orders_.resize(column_family_id + 1,
+                                   default_key_prefix_order_);
+    }
+    if (cf_comparators_[column_family_id] != comparator) {
+      cf_comparators_[column_family_id] = comparator;
+      cf_key_prefix_orders_[column_family_id] =
+          comparator != nullptr ? KeyPrefixOrder(comparator)
+                                : default_key_prefix_order_;
     }
-    cf_comparators_[column_family_id] = comparator;
   }
 
   const Comparator* default_comparator() { return default_comparator_; }
@@ -182,8 +210,15 @@ class WriteBatchEntryComparator {
   const Comparator* GetComparator(uint32_t column_family) const;
 
  private:
+  // Returns 1 if `comparator` orders keys bytewise, -1 if in reverse bytewise
+  // order, or 0 if WriteBatchIndexEntry::key_prefix can't order its keys.
+  static int8_t KeyPrefixOrder(const Comparator* comparator);
+
   const Comparator* const default_comparator_;
+  const int8_t default_key_prefix_order_;
   std::vector<const Comparator*> cf_comparators_;
+  // KeyPrefixOrder() of cf_comparators_, or of the default comparator
+  std::vector<int8_t> cf_key_prefix_orders_;
   const ReadableWriteBatch* const write_batch_;
 };
 
@@ -11,6 +11,7 @@
 
 #include <map>
 #include <memory>
+#include <set>
 
 #include "db/column_family.h"
 #include "db/wide/wide_columns_helper.h"
@@ -804,6 +805,52 @@ TEST_P(WriteBatchWithIndexTest, TestWBWIIterator) {
   AssertIterEqual(iter2.get(), {"a", "b", "d", "f"});
 }
 
+TEST_P(WriteBatchWithIndexTest, TestKeyPrefixOrder) {
+  // Keys sharing their first 8 bytes, shorter than 8 bytes, or differing
+  // only by trailing zeros are ordered like their comparator would.
+  ColumnFamilyHandleImplDummy cf1(1, BytewiseComparator());
+  ColumnFamilyHandleImplDummy cf2(2, ReverseBytewiseComparator());
+  const std::string alphabet("\0\x01a\xff", 4);
+  Random rnd(301);
+  std::set<std::string> keys;
+  for (int i = 0; i < 500; i++) {
+    std::string key;
+    const int len = static_cast<int>(rnd.Uniform(13));
+    for (int j = 0; j < len; j++) {
+      key.push_back(alphabet[rnd.Uniform(static_cast<int>(alphabet.size()))]);
+    }
+    keys.insert(key);
+    ASSERT_OK(batch_->Put(&cf1, key, key));
+    ASSERT_OK(batch_->Put(&cf2, key, key));
+  }
+
+  std::vector<std::string> sorted(keys.begin(), keys.end());
+  for (auto* cf : {&cf1, &cf2}) {
+    if (cf == &cf2) {
+      std::reverse(sorted.begin(), sorted.end());
+    }
+    std::unique_ptr<WBWIIterator> iter(batch_->NewIterator(cf));
+    iter->SeekToFirst();
+    for (const auto& key : sorted) {
+      ASSERT_TRUE(iter->Valid());
+      ASSERT_EQ(key, iter->Entry().key.ToString());
+      iter->Next();
+      if (!GetParam()) {
+        // Not overwriting the keys, each of them has an entry per Put
+        while (iter->Valid() && iter->Entry().key == key) {
+          iter->Next();
+        }
+      }
+    }
+    ASSERT_FALSE(iter->Valid());
+    for (const auto& key : sorted) {
+      iter->Seek(key);
+      ASSERT_TRUE(iter->Valid());
+      ASSERT_EQ(key, iter->Entry().key.ToString());
+    }
+  }
+}
+
 TEST_P(WriteBatchWithIndexTest, TestRandomIteraratorWithBase) {
   std::vector<std::string> source_strings = {"a", "b", "c", "d", "e",
                                              "f", "g", "h", "i", "j"};